@@ -77,6 +77,8 @@ typedef struct css_computed_content_item {
 
 css_error css_computed_style_destroy(css_computed_style *style);
 
+css_computed_style *css_computed_style_ref(css_computed_style *style);
+
 css_error css_computed_style_compose(
 		const css_computed_style *restrict parent,
 		const css_computed_style *restrict child,
@@ -42,6 +42,16 @@ typedef struct css_select_results {
 	css_computed_style *styles[CSS_PSEUDO_ELEMENT_COUNT];
 } css_select_results;
 
+/**
+ * Statistics of the selections in a context
+ */
+typedef struct css_select_stats {
+	uint64_t n_elements;	/**< Number of nodes selected for */
+	uint64_t n_shared;	/**< Number of nodes sharing a style */
+	uint64_t n_examined;	/**< Number of selector chains examined */
+	uint64_t n_matched;	/**< Number of selector chains matched */
+} css_select_stats;
+
 typedef enum css_select_handler_version {
 	CSS_SELECT_HANDLER_VERSION_1 = 1
 } css_select_handler_version;
@@ -216,6 +226,9 @@ css_error css_select_ctx_count_sheets(css_select_ctx *ctx, uint32_t *count);
 css_error css_select_ctx_get_sheet(css_select_ctx *ctx, uint32_t index,
 		const css_stylesheet **sheet);
 
+css_error css_select_ctx_get_stats(css_select_ctx *ctx,
+		css_select_stats *stats, bool reset);
+
 css_error css_select_default_style(css_select_ctx *ctx,
 		css_select_handler *handler, void *pw,
 		css_computed_style **style);
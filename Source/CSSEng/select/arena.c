@@ -6,16 +6,24 @@
  * Copyright 2015 Michael Drake <tlsa@netsurf-browser.org>
  */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "select/arena.h"
 #include "select/arena_hash.h"
 #include "select/computed.h"
 
-#define TU_SIZE 3037
 #define TS_SIZE 5101
 
-struct css_computed_style *table_s[TS_SIZE];
+/* The table grows when the average length of the chains exceeds this */
+#define TS_MAX_LOAD 2
+
+static struct css_computed_style *table_s_initial[TS_SIZE];
+
+/* The bins of the interned styles; the `bin` of a style keeps its hash */
+static struct css_computed_style **table_s = table_s_initial;
+static uint32_t ts_size = TS_SIZE;
+static uint32_t nr_styles;
 
 
 static inline uint32_t css__arena_hash_style(struct css_computed_style *s)
@@ -35,11 +43,18 @@ static inline bool arena__compare_computed_content_item(
 		return false;
 	}
 
-	if (a->type != b->type) {
-		return false;
+	/* The list is terminated by an item of CSS_COMPUTED_CONTENT_NONE */
+	while (a->type != CSS_COMPUTED_CONTENT_NONE &&
+			b->type != CSS_COMPUTED_CONTENT_NONE) {
+		if (memcmp(a, b, sizeof(struct css_computed_content_item)) != 0) {
+			return false;
+		}
+
+		a++;
+		b++;
 	}
 
-	return memcmp(a, b, sizeof(struct css_computed_content_item)) == 0;
+	return a->type == b->type;
 }
 
 
@@ -56,14 +71,20 @@ static inline bool arena__compare_css_computed_counter(
 		return false;
 	}
 
-	if (a->value == b->value &&
-			lwc_string_isequal(a->name, b->name,
-					&match) == lwc_error_ok &&
-			match == true) {
-		return true;
+	/* The list is terminated by a counter without name */
+	while (a->name != NULL && b->name != NULL) {
+		if (a->value != b->value ||
+				lwc_string_isequal(a->name, b->name,
+					&match) != lwc_error_ok ||
+				match == false) {
+			return false;
+		}
+
+		a++;
+		b++;
 	}
 
-	return false;
+	return a->name == b->name;
 }
 
 static inline bool arena__compare_string_list(
@@ -145,6 +166,43 @@ bool css__arena_style_is_equal(
 }
 
 
+/* Doubles the bins of the table, or goes back to the initial ones */
+static void arena__resize_table(uint32_t size)
+{
+	struct css_computed_style **table;
+
+	if (size == TS_SIZE) {
+		table = table_s_initial;
+		memset(table, 0, sizeof(table_s_initial));
+	} else {
+		table = calloc(size, sizeof(struct css_computed_style *));
+		if (table == NULL) {
+			/* Keep the longer chains */
+			return;
+		}
+	}
+
+	for (uint32_t i = 0; i < ts_size; i++) {
+		struct css_computed_style *l = table_s[i];
+
+		while (l != NULL) {
+			struct css_computed_style *next = l->next;
+			uint32_t index = l->bin % size;
+
+			l->next = table[index];
+			table[index] = l;
+			l = next;
+		}
+	}
+
+	if (table_s != table_s_initial) {
+		free(table_s);
+	}
+
+	table_s = table;
+	ts_size = size;
+}
+
 /* Internally exported function, documented in src/select/arena.h */
 css_error css__arena_intern_style(struct css_computed_style **style)
 {
@@ -158,8 +216,8 @@ css_error css__arena_intern_style(struct css_computed_style **style)
 
 	/* Need to intern the style block */
 	hash = css__arena_hash_style(s);
-	index = hash % TS_SIZE;
-	s->bin = index;
+	index = hash % ts_size;
+	s->bin = hash;
 
 	if (table_s[index] == NULL) {
 		/* Can just insert */
@@ -182,6 +240,7 @@ css_error css__arena_intern_style(struct css_computed_style **style)
 			css_computed_style_destroy(s);
 			existing->count++;
 			*style = existing;
+			return CSS_OK;
 		} else {
 			/* Add to list */
 			s->next = table_s[index];
@@ -190,6 +249,11 @@ css_error css__arena_intern_style(struct css_computed_style **style)
 		}
 	}
 
+	nr_styles++;
+	if (nr_styles > ts_size * TS_MAX_LOAD) {
+		arena__resize_table(ts_size * 2 + 1);
+	}
+
 	return CSS_OK;
 }
 
@@ -197,35 +261,29 @@ css_error css__arena_intern_style(struct css_computed_style **style)
 /* Internally exported function, documented in src/select/arena.h */
 enum css_error css__arena_remove_style(struct css_computed_style *style)
 {
-	uint32_t index = style->bin;
+	uint32_t index = style->bin % ts_size;
+	struct css_computed_style *l = table_s[index];
+	struct css_computed_style *prev = NULL;
+
+	/* The style itself is in the chain, no need to compare the values */
+	while (l != NULL && l != style) {
+		prev = l;
+		l = l->next;
+	}
 
-	if (table_s[index] == NULL) {
+	if (l == NULL) {
 		return CSS_BADPARM;
+	}
 
+	if (prev != NULL) {
+		prev->next = l->next;
 	} else {
-		/* Check for existing */
-		struct css_computed_style *l = table_s[index];
-		struct css_computed_style *existing = NULL;
-		struct css_computed_style *prev = NULL;
-
-		do {
-			if (css__arena_style_is_equal(l, style)) {
-				existing = l;
-				break;
-			}
-			prev = l;
-			l = l->next;
-		} while (l != NULL);
+		table_s[index] = l->next;
+	}
 
-		if (existing != NULL) {
-			if (prev != NULL) {
-				prev->next = existing->next;
-			} else {
-				table_s[index] = existing->next;
-			}
-		} else {
-			return CSS_BADPARM;
-		}
+	nr_styles--;
+	if (nr_styles == 0 && table_s != table_s_initial) {
+		arena__resize_table(TS_SIZE);
 	}
 
 	return CSS_OK;
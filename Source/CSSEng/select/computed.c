@@ -83,6 +83,18 @@ css_error css__computed_style_create(css_computed_style **result)
 	return CSS_OK;
 }
 
+/**
+ * Take a new reference to a computed style
+ *
+ * \param style  The style to take a new reference to
+ * \return The new computed style reference; release it with
+ *         css_computed_style_destroy()
+ */
+css_computed_style *css_computed_style_ref(css_computed_style *style)
+{
+	return css__computed_style_ref(style);
+}
+
 /**
  * Destroy a computed style
  *
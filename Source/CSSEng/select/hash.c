@@ -28,6 +28,13 @@ typedef struct hash_t {
 	hash_entry *slots;
 } hash_t;
 
+/* The chain of the universal selectors requiring an attribute */
+typedef struct attr_bucket {
+	css_qname qname;
+
+	hash_entry head;
+} attr_bucket;
+
 struct css_selector_hash {
 	hash_t elements;
 
@@ -35,6 +42,12 @@ struct css_selector_hash {
 
 	hash_t ids;
 
+	/* Buckets by the attribute names, in the order of insertion.
+	 * There are few distinct attribute names in style sheets, so the
+	 * buckets are searched linearly. */
+	attr_bucket *attributes;
+	uint32_t n_attributes;
+
 	hash_entry universal;
 
 	size_t hash_size;
@@ -44,6 +57,9 @@ static hash_entry empty_slot;
 
 static inline lwc_string *_class_name(const css_selector *selector);
 static inline lwc_string *_id_name(const css_selector *selector);
+static inline const css_qname *_attribute_qname(const css_selector *selector);
+static hash_entry *_attribute_chain(css_selector_hash *hash,
+		const css_qname *qname, bool create);
 static css_error _insert_into_chain(css_selector_hash *ctx, hash_entry *head,
 		const css_selector *selector);
 static css_error _remove_from_chain(css_selector_hash *ctx, hash_entry *head,
@@ -208,6 +224,16 @@ css_error css__selector_hash_destroy(css_selector_hash *hash)
 	}
 	free(hash->ids.slots);
 
+	/* Attribute buckets */
+	for (i = 0; i < hash->n_attributes; i++) {
+		for (d = hash->attributes[i].head.next; d != NULL; d = e) {
+			e = d->next;
+
+			free(d);
+		}
+	}
+	free(hash->attributes);
+
 	/* Universal chain */
 	for (d = hash->universal.next; d != NULL; d = e) {
 		e = d->next;
@@ -232,6 +258,8 @@ css_error css__selector_hash_insert(css_selector_hash *hash,
 {
 	uint32_t index, mask;
 	lwc_string *name;
+	const css_qname *qname;
+	hash_entry *head;
 	css_error error;
 
 	if (hash == NULL || selector == NULL)
@@ -260,6 +288,13 @@ css_error css__selector_hash_insert(css_selector_hash *hash,
 
 		error = _insert_into_chain(hash, &hash->elements.slots[index],
 				selector);
+	} else if ((qname = _attribute_qname(selector)) != NULL) {
+		/* Universal with an attribute */
+		head = _attribute_chain(hash, qname, true);
+		if (head == NULL)
+			return CSS_NOMEM;
+
+		error = _insert_into_chain(hash, head, selector);
 	} else {
 		/* Universal chain */
 		error = _insert_into_chain(hash, &hash->universal, selector);
@@ -280,6 +315,8 @@ css_error css__selector_hash_remove(css_selector_hash *hash,
 {
 	uint32_t index, mask;
 	lwc_string *name;
+	const css_qname *qname;
+	hash_entry *head;
 	css_error error;
 
 	if (hash == NULL || selector == NULL)
@@ -308,6 +345,13 @@ css_error css__selector_hash_remove(css_selector_hash *hash,
 
 		error = _remove_from_chain(hash, &hash->elements.slots[index],
 				selector);
+	} else if ((qname = _attribute_qname(selector)) != NULL) {
+		/* Universal with an attribute */
+		head = _attribute_chain(hash, qname, false);
+		if (head == NULL)
+			return CSS_INVALID;
+
+		error = _remove_from_chain(hash, head, selector);
 	} else {
 		/* Universal chain */
 		error = _remove_from_chain(hash, &hash->universal, selector);
@@ -595,6 +639,73 @@ css_error css__selector_hash_find_universal(css_selector_hash *hash,
 	return CSS_OK;
 }
 
+/**
+ * Count the attribute buckets of a hash
+ *
+ * \param hash  Hash to consider
+ * \return The number of the attribute buckets
+ */
+uint32_t css__selector_hash_count_attributes(css_selector_hash *hash)
+{
+	return (hash == NULL) ? 0 : hash->n_attributes;
+}
+
+/**
+ * Find the first universal selector requiring an attribute
+ *
+ * \param hash      Hash to search
+ * \param index     Index of the attribute bucket
+ * \param qname     Pointer to location to receive the attribute name
+ * \param iterator  Pointer to location to receive iterator function
+ * \param matched   Pointer to location to receive selector
+ * \return CSS_OK on success, appropriate error otherwise
+ *
+ * If nothing matches, CSS_OK will be returned and **matched == NULL.
+ * The caller has to check the node has the attribute before matching
+ * the selectors; the selectors of a bucket are otherwise universal.
+ */
+css_error css__selector_hash_find_by_attribute(css_selector_hash *hash,
+		const struct css_hash_selection_requirments *req,
+		uint32_t index, const css_qname **qname,
+		css_selector_hash_iterator *iterator,
+		const css_selector ***matched)
+{
+	hash_entry *head;
+
+	if (hash == NULL || req == NULL || index >= hash->n_attributes ||
+			qname == NULL || iterator == NULL || matched == NULL)
+		return CSS_BADPARM;
+
+	head = &hash->attributes[index].head;
+
+	if (head->sel != NULL) {
+		/* Search through chain for first match */
+		while (head != NULL) {
+			if (RULE_HAS_BYTECODE(head) &&
+			    css_bloom_in_bloom(
+					head->sel_chain_bloom,
+					req->node_bloom) &&
+			    mq_rule_good_for_media(head->sel->rule,
+					req->media)) {
+				/* Found a match */
+				break;
+			}
+
+			head = head->next;
+		}
+
+		if (head == NULL)
+			head = &empty_slot;
+	}
+
+	/* All selectors in a bucket are universal; iterate likewise */
+	(*qname) = &hash->attributes[index].qname;
+	(*iterator) = _iterate_universal;
+	(*matched) = (const css_selector **) head;
+
+	return CSS_OK;
+}
+
 /**
  * Determine the memory-resident size of a hash
  *
@@ -673,6 +784,83 @@ lwc_string *_id_name(const css_selector *selector)
 	return name;
 }
 
+/**
+ * Retrieve the first attribute name in a selector, or NULL if none
+ *
+ * \param selector  Selector to consider
+ * \return Pointer to attribute name, or NULL if none
+ */
+const css_qname *_attribute_qname(const css_selector *selector)
+{
+	const css_selector_detail *detail = &selector->data;
+
+	do {
+		switch (detail->type) {
+		case CSS_SELECTOR_ATTRIBUTE:
+		case CSS_SELECTOR_ATTRIBUTE_EQUAL:
+		case CSS_SELECTOR_ATTRIBUTE_DASHMATCH:
+		case CSS_SELECTOR_ATTRIBUTE_INCLUDES:
+		case CSS_SELECTOR_ATTRIBUTE_PREFIX:
+		case CSS_SELECTOR_ATTRIBUTE_SUFFIX:
+		case CSS_SELECTOR_ATTRIBUTE_SUBSTRING:
+			/* Ignore :not([attr]) */
+			if (detail->negate == 0)
+				return &detail->qname;
+			break;
+		default:
+			break;
+		}
+
+		if (detail->next)
+			detail++;
+		else
+			detail = NULL;
+	} while (detail != NULL);
+
+	return NULL;
+}
+
+/**
+ * Find or create the chain of an attribute bucket
+ *
+ * \param hash    Selector hash
+ * \param qname   Attribute name
+ * \param create  Whether to create the bucket if there is none
+ * \return Head of the chain, or NULL if not found or on memory exhaustion.
+ */
+hash_entry *_attribute_chain(css_selector_hash *hash,
+		const css_qname *qname, bool create)
+{
+	attr_bucket *bucket;
+	uint32_t i;
+
+	/* The names are interned, so compare them case sensitively as
+	 * the bucket is probed with the name directly. */
+	for (i = 0; i < hash->n_attributes; i++) {
+		bucket = &hash->attributes[i];
+		if (bucket->qname.name == qname->name &&
+				bucket->qname.ns == qname->ns)
+			return &bucket->head;
+	}
+
+	if (create == false)
+		return NULL;
+
+	bucket = realloc(hash->attributes,
+			(hash->n_attributes + 1) * sizeof(attr_bucket));
+	if (bucket == NULL)
+		return NULL;
+
+	hash->attributes = bucket;
+	bucket = &hash->attributes[hash->n_attributes++];
+	memset(bucket, 0, sizeof(attr_bucket));
+	bucket->qname = *qname;
+
+	hash->hash_size += sizeof(attr_bucket);
+
+	return &bucket->head;
+}
+
 
 /**
  * Add a selector detail to the bloom filter, if the detail is relevant.
@@ -59,6 +59,13 @@ css_error css__selector_hash_find_universal(css_selector_hash *hash,
 		css_selector_hash_iterator *iterator,
 		const struct css_selector ***matched);
 
+uint32_t css__selector_hash_count_attributes(css_selector_hash *hash);
+css_error css__selector_hash_find_by_attribute(css_selector_hash *hash,
+		const struct css_hash_selection_requirments *req,
+		uint32_t index, const css_qname **qname,
+		css_selector_hash_iterator *iterator,
+		const struct css_selector ***matched);
+
 css_error css__selector_hash_size(css_selector_hash *hash, size_t *size);
 
 #endif
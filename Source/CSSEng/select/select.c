@@ -48,6 +48,8 @@ struct css_select_ctx {
 
 	css_select_sheet *sheets;	/**< Array of sheets */
 
+	css_select_stats stats;		/**< Statistics of the selections */
+
 	void *pw;	/**< Client's private selection context */
 
 	/* Useful interned strings */
@@ -111,9 +113,11 @@ typedef struct css_select_rule_source {
 		CSS_SELECT_RULE_SRC_ELEMENT,
 		CSS_SELECT_RULE_SRC_CLASS,
 		CSS_SELECT_RULE_SRC_ID,
-		CSS_SELECT_RULE_SRC_UNIVERSAL
+		CSS_SELECT_RULE_SRC_UNIVERSAL,
+		CSS_SELECT_RULE_SRC_ATTRIBUTE
 	} source;
 	uint32_t class;
+	uint32_t attr;
 } css_select_rule_source;
 
 
@@ -459,6 +463,30 @@ css_error css_select_ctx_get_sheet(css_select_ctx *ctx, uint32_t index,
 	return CSS_OK;
 }
 
+/**
+ * Retrieve the statistics of the selections in a context
+ *
+ * \param ctx    The context to consider
+ * \param stats  Pointer to location to receive the statistics
+ * \param reset  Whether to reset the statistics after retrieving
+ * \return CSS_OK on success, appropriate error otherwise
+ *
+ * The number of the selector chains examined per node can be got by
+ * dividing n_examined by (n_elements - n_shared).
+ */
+css_error css_select_ctx_get_stats(css_select_ctx *ctx,
+		css_select_stats *stats, bool reset)
+{
+	if (ctx == NULL || stats == NULL)
+		return CSS_BADPARM;
+
+	*stats = ctx->stats;
+	if (reset)
+		memset(&ctx->stats, 0, sizeof(ctx->stats));
+
+	return CSS_OK;
+}
+
 
 /**
  * Create a default style on the selection context
@@ -1223,11 +1251,15 @@ css_error css_select_style(css_select_ctx *ctx, void *node,
 		state.node_data->flags |= CSS_NODE_FLAGS_HAS_INLINE_STYLE;
 	}
 
+	ctx->stats.n_elements++;
+
 	/* Check if we can share another node's style */
 	error = css_select_style__get_sharable_node_data(node, &state, &share);
 	if (error != CSS_OK) {
 		goto cleanup;
 	} else if (share != NULL) {
+		ctx->stats.n_shared++;
+
 		css_computed_style **styles = share->partial.styles;
 		for (i = 0; i < CSS_PSEUDO_ELEMENT_COUNT; i++) {
 			state.results->styles[i] =
@@ -2003,7 +2035,8 @@ static css_error select_font_faces_from_sheet(
 
 static inline bool _selectors_pending(const css_selector **node,
 		const css_selector **id, const css_selector ***classes,
-		uint32_t n_classes, const css_selector **univ)
+		uint32_t n_classes, const css_selector **univ,
+		const css_selector ***attrs, uint32_t n_attrs)
 {
 	bool pending = false;
 	uint32_t i;
@@ -2017,6 +2050,9 @@ static inline bool _selectors_pending(const css_selector **node,
 			pending |= *(classes[i]) != NULL;
 	}
 
+	for (i = 0; i < n_attrs; i++)
+		pending |= *(attrs[i]) != NULL;
+
 	return pending;
 }
 
@@ -2050,6 +2086,7 @@ static inline bool _selector_less_specific(const css_selector *ref,
 static const css_selector *_selector_next(const css_selector **node,
 		const css_selector **id, const css_selector ***classes,
 		uint32_t n_classes, const css_selector **univ,
+		const css_selector ***attrs, uint32_t n_attrs,
 		css_select_rule_source *src)
 {
 	const css_selector *ret = NULL;
@@ -2081,9 +2118,64 @@ static const css_selector *_selector_next(const css_selector **node,
 		}
 	}
 
+	for (uint32_t i = 0; i < n_attrs; i++) {
+		if (_selector_less_specific(ret, *(attrs[i]))) {
+			ret = *(attrs[i]);
+			src->source = CSS_SELECT_RULE_SRC_ATTRIBUTE;
+			src->attr = i;
+		}
+	}
+
 	return ret;
 }
 
+static inline void add_node_flags(const void *node,
+		const css_select_state *state, css_node_flags flags);
+
+/**
+ * Find the chains of the attribute buckets applying to the node
+ *
+ * Only the buckets having a candidate selector are probed, so the node
+ * is tainted by the attributes as if the selectors were matched one by
+ * one.
+ */
+static css_error _find_attribute_selectors(const css_stylesheet *sheet,
+		css_select_state *state,
+		const struct css_hash_selection_requirments *req,
+		css_selector_hash_iterator *iterator,
+		const css_selector ***attrs, uint32_t *n_attrs)
+{
+	uint32_t i, n = css__selector_hash_count_attributes(sheet->selectors);
+	const css_selector **selectors;
+	const css_qname *qname;
+	css_error error;
+	bool has;
+
+	*n_attrs = 0;
+	for (i = 0; i < n; i++) {
+		error = css__selector_hash_find_by_attribute(
+				sheet->selectors, req, i, &qname,
+				iterator, &selectors);
+		if (error != CSS_OK)
+			return error;
+
+		if (*selectors == NULL)
+			continue;
+
+		error = state->handler->node_has_attribute(state->pw,
+				state->node, qname, &has);
+		if (error != CSS_OK)
+			return error;
+		add_node_flags(state->node, state,
+				CSS_NODE_FLAGS_TAINT_ATTRIBUTE);
+
+		if (has)
+			attrs[(*n_attrs)++] = selectors;
+	}
+
+	return CSS_OK;
+}
+
 css_error match_selectors_in_sheet(css_select_ctx *ctx,
 		const css_stylesheet *sheet, css_select_state *state,
 		size_t *nr_matched)
@@ -2099,7 +2191,10 @@ css_error match_selectors_in_sheet(css_select_ctx *ctx,
 	css_selector_hash_iterator class_iterator;
 	const css_selector **univ_selectors = &empty_selector;
 	css_selector_hash_iterator univ_iterator;
-	css_select_rule_source src = { CSS_SELECT_RULE_SRC_ELEMENT, 0 };
+	const css_selector ***attr_selectors = NULL;
+	css_selector_hash_iterator attr_iterator;
+	uint32_t n_attrs = 0;
+	css_select_rule_source src = { CSS_SELECT_RULE_SRC_ELEMENT, 0, 0 };
 	struct css_hash_selection_requirments req;
 	css_error error;
 	bool match = false;
@@ -2153,9 +2248,26 @@ css_error match_selectors_in_sheet(css_select_ctx *ctx,
 	if (error != CSS_OK)
 		goto cleanup;
 
+	if (css__selector_hash_count_attributes(sheet->selectors) > 0) {
+		/* Find hash chains for the attributes of node */
+		attr_selectors = malloc(
+			css__selector_hash_count_attributes(sheet->selectors) *
+			sizeof(css_selector **));
+		if (attr_selectors == NULL) {
+			error = CSS_NOMEM;
+			goto cleanup;
+		}
+
+		error = _find_attribute_selectors(sheet, state, &req,
+				&attr_iterator, attr_selectors, &n_attrs);
+		if (error != CSS_OK)
+			goto cleanup;
+	}
+
 	/* Process matching selectors, if any */
 	while (_selectors_pending(node_selectors, id_selectors,
-			class_selectors, n_classes, univ_selectors)) {
+			class_selectors, n_classes, univ_selectors,
+			attr_selectors, n_attrs)) {
 		const css_selector *selector;
 
 		/* Selectors must be matched in ascending order of specificity
@@ -2165,7 +2277,7 @@ css_error match_selectors_in_sheet(css_select_ctx *ctx,
 		 */
 		selector = _selector_next(node_selectors, id_selectors,
 				class_selectors, n_classes, univ_selectors,
-				&src);
+				attr_selectors, n_attrs, &src);
 
 		/* We know there are selectors pending, so should have a
 		 * selector here */
@@ -2175,8 +2287,11 @@ css_error match_selectors_in_sheet(css_select_ctx *ctx,
 		error = match_selector_chain(ctx, selector, state, &match);
 		if (error != CSS_OK)
 			goto cleanup;
-		if (nr_matched && match) {
-			*nr_matched = *nr_matched + 1;
+		ctx->stats.n_examined++;
+		if (match) {
+			ctx->stats.n_matched++;
+			if (nr_matched)
+				*nr_matched = *nr_matched + 1;
 		}
 
 		/* Advance to next selector in whichever chain we extracted
@@ -2202,6 +2317,11 @@ css_error match_selectors_in_sheet(css_select_ctx *ctx,
 			error = class_iterator(&req, class_selectors[src.class],
 					&class_selectors[src.class]);
 			break;
+
+		case CSS_SELECT_RULE_SRC_ATTRIBUTE:
+			error = attr_iterator(&req, attr_selectors[src.attr],
+					&attr_selectors[src.attr]);
+			break;
 		}
 
 		if (error != CSS_OK)
@@ -2212,6 +2332,8 @@ css_error match_selectors_in_sheet(css_select_ctx *ctx,
 cleanup:
 	if (class_selectors != NULL)
 		free(class_selectors);
+	if (attr_selectors != NULL)
+		free(attr_selectors);
 
 	return error;
 }
@@ -180,6 +180,11 @@ typedef struct HLBox_ {
     hl_real_t opacity;
 } HLBox;
 
+typedef struct HLNodeBox_ {
+    void *node;
+    HLBox box;
+} HLNodeBox;
+
 typedef struct HLUsedBackgroundValues_ {
     uint32_t color;
 } HLUsedBackgroundValues;
@@ -463,6 +468,9 @@ typedef struct HLMedia_ {
 
 struct DOMRulerCtxt;
 
+typedef void (*domruler_box_changed_cb)(void *node, const HLBox *box,
+        void *user_data);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -528,6 +536,26 @@ int domruler_layout(struct DOMRulerCtxt *ctxt, void *root_node,
 const HLBox *domruler_get_node_bounding_box(struct DOMRulerCtxt *ctxt,
         void *node);
 
+/**
+ * Get the HLBoxes of all element nodes in a subtree in one call.
+ *
+ * The nodes are stored in the layout order of the last layout: the root
+ * of the subtree first, then its descendants in the document order.
+ *
+ * @param ctxt: the pointer to the DOMRulerCtxt
+ * @param node: the pointer to the root node of the subtree
+ * @param boxes: the array to store the nodes and their boxes; can be NULL
+ *      if @nr_boxes is zero.
+ * @param nr_boxes: the number of the elements in @boxes
+ *
+ * Returns: the number of the element nodes in the subtree, which may be
+ *      larger than @nr_boxes; zero if the node has not been laid out.
+ *
+ * Since: 1.2.2
+ */
+size_t domruler_get_subtree_bounding_boxes(struct DOMRulerCtxt *ctxt,
+        void *node, HLNodeBox *boxes, size_t nr_boxes);
+
 /**
  * Reset the elements cached by the DOMRulerCtxt.
  *
@@ -537,6 +565,41 @@ const HLBox *domruler_get_node_bounding_box(struct DOMRulerCtxt *ctxt,
  */
 void domruler_reset_nodes(struct DOMRulerCtxt *ctxt);
 
+/**
+ * Mark a node as changed, so that its style will be selected again
+ * by the next call of domruler_relayout_dirty(). The descendants of
+ * the node are restyled as well.
+ *
+ * Call this after changing the tag name, id, classes, or attributes of
+ * a node which has been laid out. The nodes inserted into the tree after
+ * the last layout are handled automatically.
+ *
+ * @param ctxt: the pointer to the DOMRulerCtxt
+ * @param node: the pointer to the changed node
+ *
+ * Returns: zero if success; an error code (!=0) otherwise.
+ *
+ * Since: 1.2.2
+ */
+int domruler_set_node_dirty(struct DOMRulerCtxt *ctxt, void *node);
+
+/**
+ * Layout the tree laid out by the last call of domruler_layout() again,
+ * only selecting the styles of the dirty nodes, and reusing the cached
+ * dimensions of the clean nodes.
+ *
+ * @param ctxt: the pointer to the DOMRulerCtxt
+ * @param cb: the callback to call for every node whose HLBox changed
+ *      since the last layout; can be NULL.
+ * @param user_data: the user data passed to @cb.
+ *
+ * Returns: zero if success; an error code (!=0) otherwise.
+ *
+ * Since: 1.2.2
+ */
+int domruler_relayout_dirty(struct DOMRulerCtxt *ctxt,
+        domruler_box_changed_cb cb, void *user_data);
+
 /**
  * Destroy DOMRulerCtxt
  *
@@ -103,6 +103,19 @@ const HLBox *domruler_get_node_bounding_box(struct DOMRulerCtxt *ctxt,
     return layout ? &layout->box_values : NULL;
 }
 
+size_t domruler_get_subtree_bounding_boxes(struct DOMRulerCtxt *ctxt,
+        void *node, HLNodeBox *boxes, size_t nr_boxes)
+{
+    if (!ctxt || !node) {
+        return 0;
+    }
+
+    HLLayoutNode *layout = (HLLayoutNode*)g_hash_table_lookup(ctxt->node_map,
+            (gpointer)node);
+    return layout ? hl_layout_get_subtree_boxes(ctxt, layout, boxes,
+            nr_boxes) : 0;
+}
+
 void domruler_destroy(struct DOMRulerCtxt *ctxt)
 {
     if (!ctxt) {
@@ -116,6 +129,10 @@ void domruler_destroy(struct DOMRulerCtxt *ctxt)
     if (ctxt->node_map) {
         g_hash_table_destroy(ctxt->node_map);
     }
+
+    if (ctxt->layout_order) {
+        free(ctxt->layout_order);
+    }
     free(ctxt);
 }
 
@@ -124,7 +141,36 @@ void domruler_reset_nodes(struct DOMRulerCtxt *ctxt)
 {
     if (ctxt && ctxt->node_map) {
         g_hash_table_remove_all(ctxt->node_map);
+        ctxt->nr_layout_order = 0;
+    }
+}
+
+int domruler_set_node_dirty(struct DOMRulerCtxt *ctxt, void *node)
+{
+    if (!ctxt || !node) {
+        return DOMRULER_BADPARM;
+    }
+
+    HLLayoutNode *layout = (HLLayoutNode*)g_hash_table_lookup(ctxt->node_map,
+            (gpointer)node);
+    if (layout) {
+        /* the id and classes are kept by the layout node */
+        hl_layout_node_reload_origin_names(layout);
+        layout->dirty = true;
     }
+    return DOMRULER_OK;
+}
+
+int domruler_relayout_dirty(struct DOMRulerCtxt *ctxt,
+        domruler_box_changed_cb cb, void *user_data)
+{
+    if (!ctxt || !ctxt->origin_root || !ctxt->origin_op) {
+        return DOMRULER_BADPARM;
+    }
+
+    HLLayoutNode *layout_node = hl_layout_node_from_origin_node(ctxt,
+            ctxt->origin_root);
+    return hl_layout_do_relayout_dirty(ctxt, layout_node, cb, user_data);
 }
 
 int domruler_layout_hldom_elements(struct DOMRulerCtxt *ctxt,
@@ -73,6 +73,12 @@ struct DOMRulerCtxt {
     DOMRulerNodeOp *origin_op;
 
     GHashTable *node_map; // key(origin node pointer) -> value(HLLayoutNode *)
+
+    // element nodes in the layout order of the last layout
+    struct HLLayoutNode **layout_order;
+    size_t nr_layout_order;
+    size_t sz_layout_order;
+    unsigned layout_serial;
 };
 
 typedef void (*cb_free_attach_data) (void *data);
@@ -26,6 +26,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef uint8_t (*css_len_func)(const css_computed_style *style,
         css_fixed *length, css_unit *unit);
@@ -81,6 +82,7 @@ int hl_select_child_style(const css_media *media, css_select_ctx *select_ctx,
     if (ret != DOMRULER_OK) {
         return ret;
     }
+    node->dirty = false;
     HLLayoutNode *child = hl_layout_node_first_child(node);
     while(child) {
         ret = hl_select_child_style(media, select_ctx, child);
@@ -92,6 +94,26 @@ int hl_select_child_style(const css_media *media, css_select_ctx *select_ctx,
     return DOMRULER_OK;
 }
 
+/* Only selects the styles of the dirty nodes and their descendants,
+   because the computed style of a node depends on the one of its parent. */
+static int hl_select_dirty_style(const css_media *media,
+        css_select_ctx *select_ctx, HLLayoutNode *node)
+{
+    if (node->dirty) {
+        return hl_select_child_style(media, select_ctx, node);
+    }
+
+    HLLayoutNode *child = hl_layout_node_first_child(node);
+    while(child) {
+        int ret = hl_select_dirty_style(media, select_ctx, child);
+        if (ret != DOMRULER_OK) {
+            return ret;
+        }
+        child = hl_layout_node_next(child);
+    }
+    return DOMRULER_OK;
+}
+
 
 void hl_calculate_mbp_width(const struct DOMRulerCtxt *len_ctx,
             const css_computed_style *style, unsigned int side,
@@ -522,18 +544,48 @@ int hl_block_find_dimensions(struct DOMRulerCtxt *ctx,
     int max_height = 0;
     int min_height = 0;
 
-    hl_find_dimensions(ctx,
-            container_width,
-            container_height,
-            node,
-            node->computed_style,
-            &width,
-            &height,
-            &max_width,
-            &min_width,
-            &max_height,
-            &min_height
-            );
+    /* The dimensions only depend on the style of the node, the available
+       width and height, and the height of the containing block (for
+       percentage heights); reuse the ones found last time if they are
+       not changed. */
+    HLLayoutNode *parent = hl_layout_node_get_parent(node);
+    int cb_height = parent ? (int)parent->box_values.h : HL_AUTO;
+
+    if (node->dims_cached && node->cached_avail_width == container_width
+            && node->cached_avail_height == container_height
+            && node->cached_cb_height == cb_height) {
+        width = node->cached_dims[0];
+        max_width = node->cached_dims[1];
+        min_width = node->cached_dims[2];
+        height = node->cached_dims[3];
+        max_height = node->cached_dims[4];
+        min_height = node->cached_dims[5];
+    }
+    else {
+        hl_find_dimensions(ctx,
+                container_width,
+                container_height,
+                node,
+                node->computed_style,
+                &width,
+                &height,
+                &max_width,
+                &min_width,
+                &max_height,
+                &min_height
+                );
+
+        node->cached_avail_width = container_width;
+        node->cached_avail_height = container_height;
+        node->cached_cb_height = cb_height;
+        node->cached_dims[0] = width;
+        node->cached_dims[1] = max_width;
+        node->cached_dims[2] = min_width;
+        node->cached_dims[3] = height;
+        node->cached_dims[4] = max_height;
+        node->cached_dims[5] = min_height;
+        node->dims_cached = true;
+    }
     int sw = hl_solve_width(node, container_width, width, 0, 0,
             max_width, min_width);
     int sh = height;
@@ -810,7 +862,64 @@ int hl_layout_node(struct DOMRulerCtxt *ctx, HLLayoutNode *node, int x, int y,
     return DOMRULER_OK;
 }
 
-int hl_layout_do_layout(struct DOMRulerCtxt *ctxt, HLLayoutNode *root)
+/* Reports the nodes whose boxes changed since the last layout, and keeps
+   the current boxes for the next time. The element nodes are also recorded
+   in the layout order, so that the boxes of a subtree can be fetched
+   without looking the nodes up one by one. */
+static size_t hl_report_changed_boxes(struct DOMRulerCtxt *ctxt,
+        HLLayoutNode *node, domruler_box_changed_cb cb, void *user_data)
+{
+    size_t nr_changed = 0;
+    bool is_element = (hl_layout_node_get_type(node) == DOM_ELEMENT_NODE);
+
+    if (is_element) {
+        if (ctxt->nr_layout_order == ctxt->sz_layout_order) {
+            size_t sz = ctxt->sz_layout_order + ctxt->sz_layout_order / 2 + 16;
+            HLLayoutNode **order = (HLLayoutNode **)realloc(
+                    ctxt->layout_order, sizeof(HLLayoutNode *) * sz);
+            if (order) {
+                ctxt->layout_order = order;
+                ctxt->sz_layout_order = sz;
+            }
+        }
+
+        if (ctxt->nr_layout_order < ctxt->sz_layout_order) {
+            node->order_serial = ctxt->layout_serial;
+            node->order_index = ctxt->nr_layout_order;
+            ctxt->layout_order[ctxt->nr_layout_order++] = node;
+        }
+        else {
+            /* out of memory; the subtree can not be queried */
+            node->order_serial = 0;
+        }
+
+        if (!node->box_reported || memcmp(&node->last_box,
+                    &node->box_values, sizeof(HLBox)) != 0) {
+            node->last_box = node->box_values;
+            node->box_reported = true;
+            if (cb) {
+                cb(node->origin, &node->box_values, user_data);
+            }
+            nr_changed++;
+        }
+    }
+
+    HLLayoutNode *child = hl_layout_node_first_child(node);
+    while(child) {
+        nr_changed += hl_report_changed_boxes(ctxt, child, cb, user_data);
+        child = hl_layout_node_next(child);
+    }
+
+    if (is_element) {
+        node->nr_order_descendants = ctxt->nr_layout_order -
+            node->order_index - 1;
+    }
+    return nr_changed;
+}
+
+static int hl_layout_do_layout_ex(struct DOMRulerCtxt *ctxt,
+        HLLayoutNode *root, bool only_dirty,
+        domruler_box_changed_cb cb, void *user_data)
 {
     if (ctxt == NULL || ctxt->css == NULL || ctxt->css->sheet == NULL) {
         return DOMRULER_BADPARM;
@@ -830,7 +939,13 @@ int hl_layout_do_layout(struct DOMRulerCtxt *ctxt, HLLayoutNode *root)
     // create css select context
     css_select_ctx *select_ctx = hl_css_select_ctx_create(ctxt->css);
 
-    int ret = hl_select_child_style(&m, select_ctx, root);
+    int ret;
+    if (only_dirty) {
+        ret = hl_select_dirty_style(&m, select_ctx, root);
+    }
+    else {
+        ret = hl_select_child_style(&m, select_ctx, root);
+    }
     if (ret != DOMRULER_OK) {
         HL_LOGD("%s|select child style failed.|code=%d\n", __func__, ret);
         hl_css_select_ctx_destroy(select_ctx);
@@ -840,7 +955,41 @@ int hl_layout_do_layout(struct DOMRulerCtxt *ctxt, HLLayoutNode *root)
 
     hl_layout_node(ctxt, root, 0, 0, ctxt->width, ctxt->height, 0);
     hl_css_select_ctx_destroy(select_ctx);
+
+    ctxt->nr_layout_order = 0;
+    if (++ctxt->layout_serial == 0) {
+        ctxt->layout_serial = 1;
+    }
+    size_t nr_changed = hl_report_changed_boxes(ctxt, root, cb, user_data);
+    HL_LOGD("%s|changed boxes: %zu\n", __func__, nr_changed);
+    (void)nr_changed;
     return ret;
 }
 
+int hl_layout_do_layout(struct DOMRulerCtxt *ctxt, HLLayoutNode *root)
+{
+    return hl_layout_do_layout_ex(ctxt, root, false, NULL, NULL);
+}
 
+size_t hl_layout_get_subtree_boxes(struct DOMRulerCtxt *ctxt,
+        HLLayoutNode *node, HLNodeBox *boxes, size_t nr_boxes)
+{
+    if (node->order_serial != ctxt->layout_serial ||
+            node->order_serial == 0) {
+        return 0;
+    }
+
+    size_t nr = node->nr_order_descendants + 1;
+    HLLayoutNode **order = ctxt->layout_order + node->order_index;
+    for (size_t i = 0; i < nr && i < nr_boxes; i++) {
+        boxes[i].node = order[i]->origin;
+        boxes[i].box = order[i]->box_values;
+    }
+    return nr;
+}
+
+int hl_layout_do_relayout_dirty(struct DOMRulerCtxt *ctxt, HLLayoutNode *root,
+        domruler_box_changed_cb cb, void *user_data)
+{
+    return hl_layout_do_layout_ex(ctxt, root, true, cb, user_data);
+}
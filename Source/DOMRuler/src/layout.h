@@ -31,7 +31,14 @@ extern "C" {
 
 int hl_computed_z_index(HLLayoutNode *node);
 
+int hl_select_child_style(const css_media *media, css_select_ctx *select_ctx,
+        HLLayoutNode *node);
+
 int hl_layout_do_layout(struct DOMRulerCtxt* ctx, HLLayoutNode *root);
+size_t hl_layout_get_subtree_boxes(struct DOMRulerCtxt *ctxt,
+        HLLayoutNode *node, HLNodeBox *boxes, size_t nr_boxes);
+int hl_layout_do_relayout_dirty(struct DOMRulerCtxt* ctx, HLLayoutNode *root,
+        domruler_box_changed_cb cb, void *user_data);
 int hl_layout_child_node_grid(struct DOMRulerCtxt* ctx, HLLayoutNode *node,
         int level);
 
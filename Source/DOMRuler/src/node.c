@@ -46,6 +46,27 @@ HLLayoutNode *hl_layout_node_create(void)
     return node;
 }
 
+static void hl_layout_node_release_origin_names(HLLayoutNode *node)
+{
+    if (node->inner_tag) {
+        lwc_string_unref(node->inner_tag);
+        node->inner_tag = NULL;
+    }
+    if (node->inner_id) {
+        lwc_string_unref(node->inner_id);
+        node->inner_id = NULL;
+    }
+
+    if (node->inner_classes) {
+        for (int i = 0; i < node->nr_inner_classes; i++) {
+            lwc_string_unref(node->inner_classes[i]);
+        }
+        free(node->inner_classes);
+        node->inner_classes = NULL;
+    }
+    node->nr_inner_classes = 0;
+}
+
 void hl_layout_node_destroy(HLLayoutNode *node)
 {
     if (!node) {
@@ -76,19 +97,7 @@ void hl_layout_node_destroy(HLLayoutNode *node)
         free(node->attach_data);
     }
 
-    if (node->inner_tag) {
-        lwc_string_unref(node->inner_tag);
-    }
-    if (node->inner_id) {
-        lwc_string_unref(node->inner_id);
-    }
-
-    if (node->inner_classes) {
-        for (int i = 0; i < node->nr_inner_classes; i++) {
-            lwc_string_unref(node->inner_classes[i]);
-        }
-        free(node->inner_classes);
-    }
+    hl_layout_node_release_origin_names(node);
     free(node);
 }
 
@@ -465,39 +474,25 @@ void hl_for_each_child(struct DOMRulerCtxt *ctx, HLLayoutNode *node,
 }
 
 // BEGIN: HLLayoutNode  < ----- > Origin Node
-HLLayoutNode *hl_layout_node_from_origin_node(struct DOMRulerCtxt *ctxt,
-        void *origin)
+void hl_layout_node_reload_origin_names(HLLayoutNode *layout)
 {
-    if (!ctxt || !origin) {
-        return NULL;
-    }
-
-    HLLayoutNode *layout = (HLLayoutNode*)g_hash_table_lookup(ctxt->node_map,
-            (gpointer)origin);
-    if (layout) {
-        return layout;
-    }
-
-    layout = hl_layout_node_create();
-    if (!layout) {
-        return NULL;
-    }
-    layout->ctxt = ctxt;
+    hl_layout_node_release_origin_names(layout);
 
     // inner_id
-    const char *id = ctxt->origin_op->get_id(origin);
+    const char *id = layout->ctxt->origin_op->get_id(layout->origin);
     if (id) {
         layout->inner_id = hl_lwc_string_dup(id);
     }
 
     // inner_tag
-    const char *name = ctxt->origin_op->get_name(origin);
+    const char *name = layout->ctxt->origin_op->get_name(layout->origin);
     if (name) {
         layout->inner_tag = hl_lwc_string_dup(name);
     }
     // inner_classes
     char **classes = NULL;
-    int nr_classes = ctxt->origin_op->get_classes(origin, &classes);
+    int nr_classes = layout->ctxt->origin_op->get_classes(layout->origin,
+            &classes);
     if (nr_classes > 0) {
         layout->inner_classes = (lwc_string**)calloc(nr_classes,
                 sizeof(lwc_string*));
@@ -513,10 +508,31 @@ HLLayoutNode *hl_layout_node_from_origin_node(struct DOMRulerCtxt *ctxt,
     else if (classes) {
         free(classes);
     }
+}
 
+HLLayoutNode *hl_layout_node_from_origin_node(struct DOMRulerCtxt *ctxt,
+        void *origin)
+{
+    if (!ctxt || !origin) {
+        return NULL;
+    }
 
-    layout->origin = origin;
+    HLLayoutNode *layout = (HLLayoutNode*)g_hash_table_lookup(ctxt->node_map,
+            (gpointer)origin);
+    if (layout) {
+        return layout;
+    }
+
+    layout = hl_layout_node_create();
+    if (!layout) {
+        return NULL;
+    }
     layout->ctxt = ctxt;
+
+    layout->origin = origin;
+    layout->dirty = true;
+    hl_layout_node_reload_origin_names(layout);
+
     g_hash_table_insert(ctxt->node_map, (gpointer)origin, (gpointer)layout);
     return layout;
 }
@@ -111,6 +111,20 @@ typedef struct HLLayoutNode {
     void *origin;
 
     struct DOMRulerCtxt *ctxt;
+
+    // begin for incremental layout
+    bool dirty;                 // the style needs to be selected again
+    bool box_reported;          // last_box is valid
+    bool dims_cached;           // cached_dims is valid
+    int cached_avail_width;
+    int cached_avail_height;
+    int cached_cb_height;
+    int cached_dims[6];         // (max/min) width, (max/min) height
+    HLBox last_box;             // the box reported by the last layout
+    unsigned order_serial;      // the serial of the layout order recorded
+    size_t order_index;         // the index in the layout order
+    size_t nr_order_descendants;
+    // end for incremental layout
 } HLLayoutNode;
 
 #ifdef __cplusplus
@@ -148,6 +162,7 @@ HLLayoutNode *hl_layout_node_from_origin_node(struct DOMRulerCtxt *ctxt,
         void *origin);
 void *hl_layout_node_to_origin_node(HLLayoutNode *layout,
         DOMRulerNodeOp **op);
+void hl_layout_node_reload_origin_names(HLLayoutNode *layout);
 
 HLNodeType hl_layout_node_get_type(HLLayoutNode *node);
 const char *hl_layout_node_get_name(HLLayoutNode *node);
@@ -304,6 +304,7 @@ int hl_select_node_style(const css_media *media, css_select_ctx *select_ctx,
         }
         node->select_styles = result;
         node->computed_style = result->styles[CSS_PSEUDO_ELEMENT_NONE];
+        node->dims_cached = false;
         hl_computed_node_display(node);
         return DOMRULER_OK;
     }
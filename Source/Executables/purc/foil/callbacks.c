@@ -167,6 +167,7 @@ static int foil_remove_session(pcmcth_session *sess)
     LOG_DEBUG("destroy all windows/widgets created by this session...\n");
     pcutils_kvlist_for_each_safe(sess->workspace->page_owners, sess,
             on_each_ostack);
+    foil_wsp_show_last_plainwin(sess->workspace);
 
     LOG_DEBUG("destroy sorted array for all handles...\n");
     sorted_array_destroy(sess->all_handles);
@@ -334,6 +335,7 @@ static pcmcth_page *foil_create_plainwin(pcmcth_session *sess,
     }
 
     if (plain_win) {
+        foil_widget_from_page(plain_win)->owner = get_endpoint_rid(sess->edpt);
         sorted_array_add(sess->all_handles, PTR2U64(plain_win),
                 INT2PTR(HT_PLAINWIN));
         *retv = PCRDR_SC_OK;
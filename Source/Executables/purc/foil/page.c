@@ -456,10 +456,47 @@ bool foil_page_expose(pcmcth_page *page)
         return false;
     }
 
+    if (page->hidden) {
+        /* keep the dirty rectangle for the exposure when shown */
+        page->paint_deferred = 1;
+        return false;
+    }
+
     foil_widget_expose(widget);
     return true;
 }
 
+bool foil_page_set_hidden(pcmcth_page *page, bool hidden)
+{
+    if (page->hidden == hidden) {
+        return false;
+    }
+
+    page->hidden = hidden;
+    if (hidden) {
+        return true;
+    }
+
+    foil_widget *widget = foil_widget_from_page(page);
+    if (widget->flushed) {
+        /* the screen has been overwritten by other windows */
+        free(widget->flushed);
+        widget->flushed = NULL;
+    }
+
+    if (page->paint_deferred && page->cells) {
+        page->paint_deferred = 0;
+
+        /* the updates while hidden are coalesced into one rendering */
+        if (page->udom)
+            foil_udom_render_to_page(page->udom);
+        foil_rect_set(&page->dirty_rect, 0, 0, page->cols, page->rows);
+        foil_page_expose(page);
+    }
+
+    return true;
+}
+
 pcmcth_workspace *foil_page_get_workspace(pcmcth_page *page)
 {
     pcmcth_workspace *workspace = NULL;
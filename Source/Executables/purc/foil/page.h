@@ -81,6 +81,11 @@ struct pcmcth_page {
     /* Since PURCMC-120 */
     purc_page_ostack_t ostack;
 
+    /* the page is hidden, e.g., covered by another plain window;
+       the rendering is deferred until the page is shown again. */
+    unsigned int hidden:1;
+    unsigned int paint_deferred:1;
+
     pcmcth_udom *udom;
     struct foil_tty_cell **cells;
 };
@@ -121,6 +126,10 @@ bool foil_page_fill_rect(pcmcth_page *page, const foil_rect *rc, uint32_t uc);
 bool foil_page_erase_rect(pcmcth_page *page, const foil_rect *rc);
 bool foil_page_expose(pcmcth_page *page);
 
+/* Hides or shows the page; returns false if the visibility is not changed.
+   The deferred rendering is done when the page is shown. */
+bool foil_page_set_hidden(pcmcth_page *page, bool hidden);
+
 #ifdef __cplusplus
 }
 #endif
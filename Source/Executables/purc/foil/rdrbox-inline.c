@@ -31,6 +31,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 static void inline_data_cleaner(void *data)
 {
@@ -48,6 +49,165 @@ static void inline_data_cleaner(void *data)
     }
 }
 
+/* NOTE: The rendering tree of a subtree is rebuilt from scratch when its
+   element changed, so the same text is converted to Unicode and analysed
+   for break opportunities again and again. We cache the paragraphs of the
+   recently used text runs here; the key is the text and the properties
+   the analysis depends on. The available width is not a part of the key,
+   because it is only used when laying out the lines. */
+#define NR_CACHED_RUNS          128
+#define MAX_LEN_CACHED_RUN      1024
+
+struct cached_para {
+    uint32_t *ucs;
+    size_t nr_ucs;
+    foil_break_oppo_t *break_oppos;
+};
+
+struct cached_run {
+    char *text;
+    size_t len;
+    uint64_t hash;
+    uint32_t props;
+
+    unsigned nr_paras;
+    struct cached_para *paras;
+};
+
+static struct cached_run cached_runs[NR_CACHED_RUNS];
+
+static uint64_t text_run_hash(const char *text, size_t len, uint32_t props)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL ^ props;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static uint32_t text_run_props(const foil_rdrbox *box, uint8_t lbp)
+{
+    return box->lang_code | (box->text_transform << 8) |
+        (box->word_break << 10) | (lbp << 12) | (box->white_space << 16);
+}
+
+static void clear_cached_run(struct cached_run *run)
+{
+    for (unsigned i = 0; i < run->nr_paras; i++) {
+        free(run->paras[i].ucs);
+        free(run->paras[i].break_oppos);
+    }
+
+    free(run->paras);
+    free(run->text);
+    memset(run, 0, sizeof(*run));
+}
+
+static struct cached_run *
+find_cached_run(const char *text, size_t len, uint64_t hash, uint32_t props)
+{
+    struct cached_run *run = cached_runs + (hash % NR_CACHED_RUNS);
+    if (run->text && run->hash == hash && run->props == props &&
+            run->len == len && memcmp(run->text, text, len) == 0)
+        return run;
+
+    return NULL;
+}
+
+static void keep_cached_run(const char *text, size_t len, uint64_t hash,
+        uint32_t props, struct _inline_box_data *inline_data)
+{
+    struct cached_run *run = cached_runs + (hash % NR_CACHED_RUNS);
+    clear_cached_run(run);
+
+    run->text = malloc(len);
+    run->paras = calloc(inline_data->nr_paras, sizeof(run->paras[0]));
+    if (run->text == NULL || run->paras == NULL)
+        goto failed;
+
+    memcpy(run->text, text, len);
+    run->len = len;
+    run->hash = hash;
+    run->props = props;
+
+    struct text_paragraph *p;
+    list_for_each_entry(p, &inline_data->paras, ln) {
+        struct cached_para *cp = run->paras + run->nr_paras;
+
+        cp->ucs = malloc(sizeof(uint32_t) * p->nr_ucs);
+        cp->break_oppos = malloc(sizeof(foil_break_oppo_t) * (p->nr_ucs + 1));
+        if (cp->ucs == NULL || cp->break_oppos == NULL) {
+            free(cp->ucs);
+            free(cp->break_oppos);
+            goto failed;
+        }
+
+        memcpy(cp->ucs, p->ucs, sizeof(uint32_t) * p->nr_ucs);
+        memcpy(cp->break_oppos, p->break_oppos,
+                sizeof(foil_break_oppo_t) * (p->nr_ucs + 1));
+        cp->nr_ucs = p->nr_ucs;
+        run->nr_paras++;
+    }
+
+    return;
+
+failed:
+    /* the cache is only an optimization; just drop the entry */
+    clear_cached_run(run);
+}
+
+static bool init_inline_data_from_cache(foil_rdrbox *box,
+        const struct cached_run *run)
+{
+    struct _inline_box_data *inline_data = box->inline_data;
+
+    for (unsigned i = 0; i < run->nr_paras; i++) {
+        const struct cached_para *cp = run->paras + i;
+
+        struct text_paragraph *seg;
+        seg = calloc(1, sizeof(*seg));
+        if (seg == NULL)
+            goto failed;
+
+        seg->ucs = malloc(sizeof(uint32_t) * cp->nr_ucs);
+        seg->break_oppos = malloc(sizeof(foil_break_oppo_t) *
+                (cp->nr_ucs + 1));
+        if (seg->ucs == NULL || seg->break_oppos == NULL) {
+            free(seg->ucs);
+            free(seg->break_oppos);
+            free(seg);
+            goto failed;
+        }
+
+        memcpy(seg->ucs, cp->ucs, sizeof(uint32_t) * cp->nr_ucs);
+        memcpy(seg->break_oppos, cp->break_oppos,
+                sizeof(foil_break_oppo_t) * (cp->nr_ucs + 1));
+        seg->nr_ucs = cp->nr_ucs;
+
+        list_add_tail(&seg->ln, &inline_data->paras);
+        inline_data->nr_paras++;
+    }
+
+    if (inline_data->nr_paras > 0)
+        box->extra_data_cleaner = inline_data_cleaner;
+    return true;
+
+failed:
+    if (inline_data->nr_paras > 0)
+        box->extra_data_cleaner = inline_data_cleaner;
+    return false;
+}
+
+void foil_rdrbox_inline_cache_cleanup(void)
+{
+    for (unsigned i = 0; i < NR_CACHED_RUNS; i++) {
+        if (cached_runs[i].text)
+            clear_cached_run(cached_runs + i);
+    }
+}
+
 bool foil_rdrbox_init_inline_data(foil_create_ctxt *ctxt,
         foil_rdrbox *box, const char *text, size_t len)
 {
@@ -59,6 +219,23 @@ bool foil_rdrbox_init_inline_data(foil_create_ctxt *ctxt,
     struct _inline_box_data *inline_data = box->inline_data;
     assert(inline_data && inline_data->nr_paras == 0);
 
+    // break oppos
+    uint8_t lbp = box->line_break;
+    if (lbp == FOIL_RDRBOX_LINE_BREAK_AUTO)
+        lbp = FOIL_RDRBOX_LINE_BREAK_NORMAL;
+
+    uint32_t props = text_run_props(box, lbp);
+    uint64_t hash = 0;
+    if (len <= MAX_LEN_CACHED_RUN) {
+        hash = text_run_hash(text, len, props);
+
+        const struct cached_run *run;
+        run = find_cached_run(text, len, hash, props);
+        if (run)
+            return init_inline_data_from_cache(box, run);
+    }
+
+    const char *start = text;
     while (left > 0) {
         uint32_t *ucs;
         size_t nr_ucs;
@@ -80,11 +257,6 @@ bool foil_rdrbox_init_inline_data(foil_create_ctxt *ctxt,
             seg->ucs = ucs;
             seg->nr_ucs = nr_ucs;
 
-            // break oppos
-            uint8_t lbp = box->line_break;
-            if (lbp == FOIL_RDRBOX_LINE_BREAK_AUTO)
-                lbp = FOIL_RDRBOX_LINE_BREAK_NORMAL;
-
             foil_ustr_get_breaks(box->lang_code, box->text_transform,
                     box->word_break, lbp, ucs, nr_ucs, &seg->break_oppos);
             if (seg->break_oppos == NULL) {
@@ -103,6 +275,9 @@ bool foil_rdrbox_init_inline_data(foil_create_ctxt *ctxt,
     if (inline_data->nr_paras > 0)
         box->extra_data_cleaner = inline_data_cleaner;
 
+    if (len <= MAX_LEN_CACHED_RUN && inline_data->nr_paras > 0)
+        keep_cached_run(start, len, hash, props, inline_data);
+
     return true;
 
 failed:
@@ -160,6 +160,7 @@ struct _inline_fmt_ctxt *foil_rdrbox_inline_fmt_ctxt_new(void);
 void foil_rdrbox_block_box_cleanup(struct _block_box_data *data);
 void foil_rdrbox_list_item_cleanup(struct _list_item_data *data);
 void foil_rdrbox_inline_block_box_cleanup(struct _inline_block_data *data);
+void foil_rdrbox_inline_cache_cleanup(void);
 
 static inline struct _inline_fmt_ctxt *
 foil_rdrbox_inline_fmt_ctxt(foil_rdrbox *box)
@@ -72,14 +72,57 @@ int foil_rdrbox_module_init(pcmcth_renderer *rdr)
     return 0;
 }
 
+/* NOTE: A subtree of the rendering tree is deleted and created again when
+   the content of its element changed. We keep the structures of the boxes
+   deleted recently in a free list, and reuse them for the new boxes, so
+   that a rebuilding does not need to call the allocator for every box. */
+#define MAX_FREE_BOXES      256
+
+static foil_rdrbox *free_boxes;
+static unsigned nr_free_boxes;
+
 void foil_rdrbox_module_cleanup(pcmcth_renderer *rdr)
 {
     (void)rdr;
+
+    while (free_boxes) {
+        foil_rdrbox *box = free_boxes;
+        free_boxes = box->next;
+        free(box);
+    }
+    nr_free_boxes = 0;
+
+    foil_rdrbox_inline_cache_cleanup();
+}
+
+static foil_rdrbox *alloc_box(void)
+{
+    foil_rdrbox *box = free_boxes;
+    if (box) {
+        free_boxes = box->next;
+        nr_free_boxes--;
+        memset(box, 0, sizeof(*box));
+        return box;
+    }
+
+    return calloc(1, sizeof(*box));
+}
+
+static void free_box(foil_rdrbox *box)
+{
+    if (nr_free_boxes < MAX_FREE_BOXES) {
+        box->next = free_boxes;
+        free_boxes = box;
+        nr_free_boxes++;
+    }
+    else {
+        free(box);
+    }
 }
 
 foil_rdrbox *foil_rdrbox_new(uint8_t type)
 {
-    foil_rdrbox *box = calloc(1, sizeof(*box));
+    foil_rdrbox *box = alloc_box();
     if (box == NULL)
         goto failed;
 
@@ -138,7 +181,7 @@ foil_rdrbox *foil_rdrbox_new(uint8_t type)
 
 failed:
     if (box)
-        free(box);
+        free_box(box);
     return NULL;
 }
 
@@ -375,7 +418,7 @@ void foil_rdrbox_delete(foil_rdrbox *box)
         foil_rdrbox_block_fmt_ctxt_delete(box->block_fmt_ctxt);
     }
 
-    free(box);
+    free_box(box);
 }
 
 void foil_rdrbox_append_child(foil_rdrbox *to, foil_rdrbox *box)
@@ -470,6 +513,18 @@ void foil_rdrbox_remove_from_tree(foil_rdrbox *box)
     box->prev = NULL;
 }
 
+void foil_rdrbox_mark_dirty(foil_rdrbox *box, unsigned bits)
+{
+    box->dirty |= bits;
+
+    /* the ancestors of an ancestor having the bits have them already */
+    foil_rdrbox *parent = box->parent;
+    while (parent && (parent->dirty_descendants & bits) != bits) {
+        parent->dirty_descendants |= bits;
+        parent = parent->parent;
+    }
+}
+
 void foil_rdrbox_delete_deep(foil_rdrbox *root)
 {
     foil_rdrbox *tmp;
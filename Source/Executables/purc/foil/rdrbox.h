@@ -215,6 +215,13 @@ enum {
     FOIL_RDRBOX_USE_MIN_HEIGHT,
 };
 
+/* the dirty bits of a box; see foil_rdrbox_mark_dirty() */
+enum {
+    FOIL_RDRBOX_DIRTY_STYLE     = 0x01,     // the style to be reselected
+    FOIL_RDRBOX_DIRTY_LAYOUT    = 0x02,     // the subtree to be relaid out
+    FOIL_RDRBOX_DIRTY_PAINT     = 0x04,     // the subtree to be repainted
+};
+
 enum {
     FOIL_RDRBOX_TYPE_INLINE = 0,
     FOIL_RDRBOX_TYPE_BLOCK,
@@ -401,6 +408,10 @@ struct foil_rdrbox {
     uint32_t is_height_resolved:1;
     // Indicates that the computed z-index value is `auto`.
     uint32_t is_zidx_auto:1;
+    // The dirty bits of this box.
+    uint32_t dirty:3;
+    // The dirty bits of the descendants of this box.
+    uint32_t dirty_descendants:3;
 
     /* Used values of non-inherited properties */
     uint32_t type:4;
@@ -592,6 +603,10 @@ void foil_rdrbox_insert_before(foil_rdrbox *to, foil_rdrbox *box);
 void foil_rdrbox_insert_after(foil_rdrbox *to, foil_rdrbox *box);
 void foil_rdrbox_remove_from_tree(foil_rdrbox *box);
 
+/* Marks the box dirty, and marks the ancestors as having dirty descendants,
+   so an update only visits the paths to the dirty boxes. */
+void foil_rdrbox_mark_dirty(foil_rdrbox *box, unsigned bits);
+
 static inline foil_rdrbox *
 foil_rdrbox_get_root(foil_rdrbox *box)
 {
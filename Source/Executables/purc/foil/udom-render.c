@@ -803,7 +803,10 @@ render_rdrbox_with_stacking_ctxt(struct foil_render_ctxt *rdr_ctxt,
 
 void foil_udom_render_to_page(pcmcth_udom *udom)
 {
-    (void)udom;
+    if (udom->page->hidden) {
+        udom->page->paint_deferred = 1;
+        return;
+    }
 
     foil_render_ctxt rdr_ctxt = { .udom = udom, .fp = NULL };
 
@@ -816,6 +819,12 @@ void foil_udom_render_to_page(pcmcth_udom *udom)
 
 void foil_udom_invalidate_rdrbox(pcmcth_udom *udom, foil_rdrbox *box)
 {
+    if (udom->page->hidden) {
+        /* the whole page will be rendered when it is shown */
+        udom->page->paint_deferred = 1;
+        return;
+    }
+
     struct foil_stacking_context *stacking_ctxt = NULL;
     foil_rdrbox *parent = box;
 
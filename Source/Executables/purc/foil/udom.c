@@ -38,6 +38,25 @@
 
 static css_stylesheet *def_ua_sheet;
 
+/* NOTE: The author style sheets are cached by the hash of their text, so
+   the pages using the same style sheets (e.g., the pages of an app) are
+   loaded without lexing and parsing the style sheets again. A style sheet
+   is immutable once its data are done, so it can be shared by the selection
+   contexts of the uDOMs. */
+#define NR_CACHED_SHEETS        8
+
+struct cached_sheet {
+    css_stylesheet *sheet;
+    char           *text;
+    size_t          len;
+    uint64_t        hash;
+    unsigned        nr_users;
+    unsigned        last_used;
+};
+
+static struct cached_sheet cached_sheets[NR_CACHED_SHEETS];
+static unsigned sheet_ticks;
+
 /* copy from https://www.w3.org/TR/2011/REC-CSS2-20110607/sample.html#q22.0 */
 static const char *def_style_sheet = ""
     "html, address,"
@@ -184,16 +203,154 @@ int foil_udom_module_init(pcmcth_renderer *rdr)
 
 void foil_udom_module_cleanup(pcmcth_renderer *rdr)
 {
+    for (int i = 0; i < NR_CACHED_SHEETS; i++) {
+        struct cached_sheet *cs = cached_sheets + i;
+        if (cs->sheet) {
+            css_stylesheet_destroy(cs->sheet);
+            free(cs->text);
+            memset(cs, 0, sizeof(*cs));
+        }
+    }
+
     if (def_ua_sheet)
         css_stylesheet_destroy(def_ua_sheet);
 
     foil_rdrbox_module_cleanup(rdr);
 }
 
+static uint64_t css_text_hash(const char *text, size_t len)
+{
+    /* FNV-1a */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static css_stylesheet *parse_author_sheet(const char *css, size_t len)
+{
+    css_stylesheet *sheet;
+    css_stylesheet_params params;
+    css_error err;
+
+    memset(&params, 0, sizeof(params));
+    params.params_version = CSS_STYLESHEET_PARAMS_VERSION_1;
+    params.level = CSS_LEVEL_DEFAULT;
+    params.charset = FOIL_DEF_CHARSET;
+    params.url = "foo";
+    params.title = "foo";
+    params.resolve = resolve_url;
+
+    err = css_stylesheet_create(&params, &sheet);
+    if (err != CSS_OK) {
+        LOG_ERROR("Failed to create author style sheet: %d\n", err);
+        return NULL;
+    }
+
+    err = css_stylesheet_append_data(sheet, (const unsigned char *)css, len);
+    if (err != CSS_OK && err != CSS_NEEDDATA) {
+        LOG_WARN("Failed to append css data: %d\n", err);
+    }
+
+    css_stylesheet_data_done(sheet);
+    return sheet;
+}
+
+static css_stylesheet *get_author_sheet(const char *css, size_t len)
+{
+    uint64_t hash = css_text_hash(css, len);
+    struct cached_sheet *slot = NULL;
+
+    for (int i = 0; i < NR_CACHED_SHEETS; i++) {
+        struct cached_sheet *cs = cached_sheets + i;
+
+        if (cs->sheet == NULL) {
+            if (slot == NULL)
+                slot = cs;
+            continue;
+        }
+
+        if (cs->hash == hash && cs->len == len &&
+                memcmp(cs->text, css, len) == 0) {
+            cs->nr_users++;
+            cs->last_used = ++sheet_ticks;
+            return cs->sheet;
+        }
+
+        /* prefer a free slot, then the least recently used one */
+        if (cs->nr_users == 0 && (slot == NULL ||
+                    (slot->sheet && cs->last_used < slot->last_used)))
+            slot = cs;
+    }
+
+    css_stylesheet *sheet = parse_author_sheet(css, len);
+    if (sheet == NULL)
+        return NULL;
+
+    /* the sheet is owned by the uDOM if there is no slot */
+    char *text;
+    if (slot && (text = malloc(len))) {
+        if (slot->sheet) {
+            css_stylesheet_destroy(slot->sheet);
+            free(slot->text);
+        }
+
+        memcpy(text, css, len);
+        slot->sheet = sheet;
+        slot->text = text;
+        slot->len = len;
+        slot->hash = hash;
+        slot->nr_users = 1;
+        slot->last_used = ++sheet_ticks;
+    }
+
+    return sheet;
+}
+
+static void release_author_sheet(css_stylesheet *sheet)
+{
+    for (int i = 0; i < NR_CACHED_SHEETS; i++) {
+        struct cached_sheet *cs = cached_sheets + i;
+        if (cs->sheet == sheet) {
+            assert(cs->nr_users > 0);
+            cs->nr_users--;
+            return;
+        }
+    }
+
+    css_stylesheet_destroy(sheet);
+}
+
 extern css_select_handler foil_css_select_handler;
 
+static void
+release_composed_styles(struct foil_composed_styles *cache)
+{
+    if (cache->parent) {
+        css_computed_style_destroy(cache->parent);
+        cache->parent = NULL;
+    }
+
+    for (int i = 0; i < CSS_PSEUDO_ELEMENT_COUNT; i++) {
+        if (cache->partial[i]) {
+            css_computed_style_destroy(cache->partial[i]);
+            cache->partial[i] = NULL;
+        }
+        if (cache->composed[i]) {
+            css_computed_style_destroy(cache->composed[i]);
+            cache->composed[i] = NULL;
+        }
+    }
+}
+
 static void udom_cleanup(pcmcth_udom *udom)
 {
+    release_composed_styles(&udom->last_composed);
+
     if (udom->elem2nodedata) {
         size_t n = sorted_array_count(udom->elem2nodedata);
 
@@ -215,7 +372,8 @@ static void udom_cleanup(pcmcth_udom *udom)
     if (udom->base)
         pcutils_broken_down_url_delete(udom->base);
     if (udom->author_sheet)
-        css_stylesheet_destroy(udom->author_sheet);
+        release_author_sheet(udom->author_sheet);
+    pcutils_mystring_free(&udom->author_css);
     if (udom->select_ctx)
         css_select_ctx_destroy(udom->select_ctx);
     if (udom->root_stk_ctxt) {
@@ -403,11 +561,9 @@ static void load_css(struct pcmcth_udom *udom, const char *href)
     }
 
     if (css) {
-        css_error err;
-        err = css_stylesheet_append_data(udom->author_sheet,
-                (const unsigned char *)css, length);
-        if (err != CSS_OK && err != CSS_NEEDDATA) {
-            LOG_WARN("Failed to append css data from file: %d\n", err);
+        if (length > 0 && pcutils_mystring_append_mchar(&udom->author_css,
+                    (const unsigned char *)css, length)) {
+            LOG_WARN("Failed to append css data from file: %s\n", href);
         }
 
         free(css);
@@ -494,11 +650,9 @@ head_walker(purc_document_t doc, pcdoc_element_t element, void *ctxt)
 
                 if (pcdoc_text_content_get_text(doc, child.text_node,
                             &text, &len) == 0 && len > 0) {
-                    css_error err;
-                    err = css_stylesheet_append_data(udom->author_sheet,
-                            (const unsigned char *)text, len);
-                    if (err != CSS_OK && err != CSS_NEEDDATA) {
-                        LOG_ERROR("Failed to append css data: %d\n", err);
+                    if (pcutils_mystring_append_mchar(&udom->author_css,
+                            (const unsigned char *)text, len)) {
+                        LOG_ERROR("Failed to append css data\n");
                         return -1;
                     }
                 }
@@ -536,6 +690,46 @@ done:
     return 0;
 }
 
+/* Uses the composed styles in the cache if the partial styles and the
+   parent style are the same ones, because the composition only depends
+   on them. */
+static bool
+reuse_composed_styles(struct foil_composed_styles *cache,
+        css_computed_style *parent, css_select_results *result)
+{
+    if (cache->parent == NULL || cache->parent != parent)
+        return false;
+
+    for (int i = 0; i < CSS_PSEUDO_ELEMENT_COUNT; i++) {
+        if (cache->partial[i] != result->styles[i])
+            return false;
+    }
+
+    for (int i = 0; i < CSS_PSEUDO_ELEMENT_COUNT; i++) {
+        if (result->styles[i]) {
+            css_computed_style_destroy(result->styles[i]);
+            result->styles[i] = css_computed_style_ref(cache->composed[i]);
+        }
+    }
+
+    return true;
+}
+
+static void
+keep_composed_styles(struct foil_composed_styles *cache,
+        css_computed_style *parent, css_computed_style **partial,
+        css_select_results *result)
+{
+    release_composed_styles(cache);
+
+    cache->parent = css_computed_style_ref(parent);
+    for (int i = 0; i < CSS_PSEUDO_ELEMENT_COUNT; i++) {
+        /* the references to the partial styles are taken over */
+        cache->partial[i] = partial[i];
+        cache->composed[i] = css_computed_style_ref(result->styles[i]);
+    }
+}
+
 static css_select_results *
 select_element_style(const css_media *media, css_select_ctx *select_ctx,
         pcmcth_udom *udom, pcdoc_element_t element,
@@ -544,6 +738,8 @@ select_element_style(const css_media *media, css_select_ctx *select_ctx,
     // prepare inline style
     css_error err;
     css_stylesheet* inline_sheet = NULL;
+    css_computed_style *parent_style = NULL;
+    css_computed_style *partial[CSS_PSEUDO_ELEMENT_COUNT] = { NULL };
     const char* value;
     size_t len;
 
@@ -599,6 +795,16 @@ select_element_style(const css_media *media, css_select_ctx *select_ctx,
         goto failed;
     }
 
+    if (parent_box && parent_box->computed_style) {
+        parent_style = parent_box->computed_style;
+        if (reuse_composed_styles(&udom->last_composed, parent_style,
+                    result))
+            goto done;
+
+        for (int i = 0; i < CSS_PSEUDO_ELEMENT_COUNT; i++)
+            partial[i] = css_computed_style_ref(result->styles[i]);
+    }
+
     /* XXX: css_computed_style_compose() of CSSEng just clones the values for
        `inherit` for complex properties, e.g., `counter-reset` and
        `counter-increment`.
@@ -655,12 +861,23 @@ select_element_style(const css_media *media, css_select_ctx *select_ctx,
         result->styles[pseudo_element] = composed;
     }
 
+    if (parent_style) {
+        keep_composed_styles(&udom->last_composed, parent_style, partial,
+                result);
+    }
+
+done:
     if (inline_sheet) {
         css_stylesheet_destroy(inline_sheet);
     }
     return result;
 
 failed:
+    for (int i = 0; i < CSS_PSEUDO_ELEMENT_COUNT; i++) {
+        if (partial[i])
+            css_computed_style_destroy(partial[i]);
+    }
+
     if (inline_sheet) {
         css_stylesheet_destroy(inline_sheet);
     }
@@ -1194,6 +1411,11 @@ foil_udom_load_edom(pcmcth_page *page, purc_variant_t edom, int *retv)
     purc_document_type_k doc_type;
     pcmcth_udom *udom = NULL;
 
+    /* NOTE: time the phases of loading, so we can tell where a big page
+       spends its time. */
+    struct timespec ts_start, ts_boxes, ts_layout;
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
     edom_doc = purc_variant_native_get_entity(edom);
     assert(edom_doc);
 
@@ -1230,36 +1452,22 @@ foil_udom_load_edom(pcmcth_page *page, purc_variant_t edom, int *retv)
     pcdoc_element_t head;
     head = purc_document_head(edom_doc);
     if (head) {
-        css_error err;
-
-        css_stylesheet_params params;
-        memset(&params, 0, sizeof(params));
-        params.params_version = CSS_STYLESHEET_PARAMS_VERSION_1;
-        params.level = CSS_LEVEL_DEFAULT;
-        params.charset = FOIL_DEF_CHARSET;
-        params.url = "foo";
-        params.title = "foo";
-        params.resolve = resolve_url;
-
-        err = css_stylesheet_create(&params, &udom->author_sheet);
-        if (err != CSS_OK) {
-            *retv = PCRDR_SC_INSUFFICIENT_STORAGE;
-            LOG_ERROR("Failed to create default user agent sheet: %d\n", err);
-            goto failed;
-        }
-
         size_t n;
         pcdoc_travel_descendant_elements(edom_doc, head, head_walker,
                 udom, &n);
 
-        size_t sz;
-        css_stylesheet_size(udom->author_sheet, &sz);
-        if (sz == 0) {
-            css_stylesheet_destroy(udom->author_sheet);
-            udom->author_sheet = NULL;
-        }
-        else {
-            css_stylesheet_data_done(udom->author_sheet);
+        if (udom->author_css.nr_bytes > 0) {
+            css_error err;
+
+            udom->author_sheet = get_author_sheet(udom->author_css.buff,
+                    udom->author_css.nr_bytes);
+            pcutils_mystring_free(&udom->author_css);
+            pcutils_mystring_init(&udom->author_css);
+            if (udom->author_sheet == NULL) {
+                *retv = PCRDR_SC_INSUFFICIENT_STORAGE;
+                goto failed;
+            }
+
             err = css_select_ctx_append_sheet(udom->select_ctx,
                     udom->author_sheet, CSS_ORIGIN_AUTHOR, NULL);
             if (err != CSS_OK) {
@@ -1285,6 +1493,7 @@ foil_udom_load_edom(pcmcth_page *page, purc_variant_t edom, int *retv)
     LOG_DEBUG("Calling normalize_rdrtree...\n");
     if (normalize_rdrtree(&ctxt, udom->initial_cblock))
         goto failed;
+    clock_gettime(CLOCK_MONOTONIC, &ts_boxes);
 
     /* determine the geometries of boxes and lay out the boxes */
     foil_layout_ctxt layout_ctxt = { udom, udom->initial_cblock };
@@ -1299,6 +1508,7 @@ foil_udom_load_edom(pcmcth_page *page, purc_variant_t edom, int *retv)
 
     LOG_DEBUG("Calling layout_rdrtree...\n");
     layout_rdrtree(&layout_ctxt, udom->initial_cblock);
+    clock_gettime(CLOCK_MONOTONIC, &ts_layout);
 
 #ifndef NDEBUG
     dump_udom(udom);
@@ -1319,6 +1529,16 @@ foil_udom_load_edom(pcmcth_page *page, purc_variant_t edom, int *retv)
 
     foil_udom_render_to_page(udom);
     foil_page_expose(page);
+
+    css_select_stats stats;
+    css_select_ctx_get_stats(udom->select_ctx, &stats, true);
+    LOG_INFO("Loaded eDOM: %u elements styled (%.1f selector chains "
+            "examined per element); boxes in %.3fs, layout in %.3fs, "
+            "rendering in %.3fs\n", (unsigned)stats.n_elements,
+            stats.n_elements ? (double)stats.n_examined / stats.n_elements : 0,
+            purc_get_elapsed_seconds(&ts_start, &ts_boxes),
+            purc_get_elapsed_seconds(&ts_boxes, &ts_layout),
+            purc_get_elapsed_seconds(&ts_layout, NULL));
     return udom;
 
 failed:
@@ -1397,7 +1617,7 @@ failed:
 
 static void reset_rdrbox_layout_info(pcmcth_udom *udom, foil_rdrbox *box)
 {
-    (void)udom;
+    udom->nr_relaid_boxes++;
     box->is_width_resolved = 0;
     box->is_height_resolved = 0;
     box->is_in_normal_flow = 0;
@@ -1682,6 +1902,11 @@ failed:
 
 static void reset_rdrbox_layout_deep(pcmcth_udom *udom, foil_rdrbox *box)
 {
+    /* a box never laid out, e.g. one made by rebuild_subtree(), has nothing
+       to reset, and nor have its descendants. */
+    if (!box->is_width_resolved && !box->is_height_resolved)
+        return;
+
     reset_rdrbox_layout_info(udom, box);
 
     foil_rdrbox *child = box->first;
@@ -1790,13 +2015,28 @@ again:
 }
 
 
-static int on_update_style(pcmcth_udom *udom, foil_rdrbox *rdrbox,
-    pcdoc_element_t ref_elem, int op)
+/* the ancestors are being visited, so the bits are set directly */
+static void mark_children_style_dirty(foil_rdrbox *box)
+{
+    foil_rdrbox *child = box->first;
+    while (child) {
+        if (child->is_anonymous) {
+            mark_children_style_dirty(child);
+            box->dirty_descendants |= FOIL_RDRBOX_DIRTY_STYLE;
+        }
+        else if (!child->is_pseudo && child->computed_style) {
+            child->dirty |= FOIL_RDRBOX_DIRTY_STYLE;
+            box->dirty_descendants |= FOIL_RDRBOX_DIRTY_STYLE;
+        }
+        child = child->next;
+    }
+}
+
+/* reselects the style of the box, and marks the box or its container dirty
+   according to the changes; the child boxes are marked style-dirty, since
+   they may inherit the changed properties. */
+static int restyle_rdrbox(pcmcth_udom *udom, foil_rdrbox *rdrbox)
 {
-    (void)ref_elem;
-    (void)op;
-    int r = PCRDR_SC_NOT_IMPLEMENTED;
-    foil_rdrbox *render_box = rdrbox;
     pcdoc_element *ancestor = rdrbox->owner;
     css_select_results *result = NULL;
     foil_layout_ctxt layout_ctxt = { udom, udom->initial_cblock };
@@ -1811,7 +2051,6 @@ static int on_update_style(pcmcth_udom *udom, foil_rdrbox *rdrbox,
     css_computed_style *style = result->styles[CSS_PSEUDO_ELEMENT_NONE];
 
     if (css_computed_style_is_equal(style, rdrbox->computed_style)) {
-        r = PCRDR_SC_OK;
         goto done;
     }
     foil_create_ctxt ctxt = { udom,
@@ -1839,42 +2078,147 @@ static int on_update_style(pcmcth_udom *udom, foil_rdrbox *rdrbox,
     if (!crux_changed) {
         /* sizing, border property */
         pre_layout_rdrtree(&layout_ctxt, rdrbox);
-        goto render;
+        foil_rdrbox_mark_dirty(rdrbox, FOIL_RDRBOX_DIRTY_PAINT);
+    }
+    else {
+        foil_rdrbox_mark_dirty(get_rdrbox_container(udom, rdrbox),
+                FOIL_RDRBOX_DIRTY_LAYOUT);
     }
 
-    render_box = get_rdrbox_container(udom, rdrbox);
-
-    render_box = relayout_rdrtree(&layout_ctxt, render_box, render_box->ctnt_rect);
-
-render:
-    foil_udom_invalidate_rdrbox(udom, render_box);
-    r = PCRDR_SC_OK;
+    mark_children_style_dirty(rdrbox);
 
 done:
+    css_select_results_destroy(result);
+    return 0;
+
+failed:
     if (result) {
         css_select_results_destroy(result);
     }
+    return -1;
+}
+
+static void clear_dirty_bits(foil_rdrbox *box, unsigned bits)
+{
+    box->dirty &= ~bits;
+    if (box->dirty_descendants & bits) {
+        box->dirty_descendants &= ~bits;
+
+        foil_rdrbox *child = box->first;
+        while (child) {
+            clear_dirty_bits(child, bits);
+            child = child->next;
+        }
+    }
+}
+
+static int restyle_dirty_rdrtree(pcmcth_udom *udom, foil_rdrbox *box)
+{
+    int r = 0;
+
+    if (box->dirty & FOIL_RDRBOX_DIRTY_STYLE) {
+        box->dirty &= ~FOIL_RDRBOX_DIRTY_STYLE;
+        if (restyle_rdrbox(udom, box))
+            r = -1;
+    }
+
+    if (box->dirty_descendants & FOIL_RDRBOX_DIRTY_STYLE) {
+        box->dirty_descendants &= ~FOIL_RDRBOX_DIRTY_STYLE;
+
+        foil_rdrbox *child = box->first;
+        while (child) {
+            if (restyle_dirty_rdrtree(udom, child))
+                r = -1;
+            child = child->next;
+        }
+    }
+
     return r;
+}
 
-failed:
-    if (result) {
-        css_select_results_destroy(result);
+static void relayout_dirty_rdrtree(foil_layout_ctxt *ctxt, foil_rdrbox *box)
+{
+    if (box->dirty & FOIL_RDRBOX_DIRTY_LAYOUT) {
+        /* the box laid out may be a container of the dirty one,
+           if the size of the dirty one changed. */
+        foil_rdrbox *laid = relayout_rdrtree(ctxt, box, box->ctnt_rect);
+        if (laid == ctxt->udom->initial_cblock->first)
+            laid = ctxt->udom->initial_cblock;
+
+        clear_dirty_bits(laid, FOIL_RDRBOX_DIRTY_LAYOUT);
+        clear_dirty_bits(box, FOIL_RDRBOX_DIRTY_LAYOUT);
+        foil_rdrbox_mark_dirty(laid, FOIL_RDRBOX_DIRTY_PAINT);
+        return;
     }
 
-    return PCRDR_SC_SERVICE_UNAVAILABLE;
+    if (box->dirty_descendants & FOIL_RDRBOX_DIRTY_LAYOUT) {
+        box->dirty_descendants &= ~FOIL_RDRBOX_DIRTY_LAYOUT;
+
+        foil_rdrbox *child = box->first;
+        while (child) {
+            relayout_dirty_rdrtree(ctxt, child);
+            child = child->next;
+        }
+    }
 }
 
-static int on_rebuild_subtree(pcmcth_udom *udom, foil_rdrbox *rdrbox)
+static void repaint_dirty_rdrtree(pcmcth_udom *udom, foil_rdrbox *box)
 {
-    foil_rect orc = rdrbox->ctnt_rect;
+    if (box->dirty & FOIL_RDRBOX_DIRTY_PAINT) {
+        /* the whole subtree is repainted */
+        clear_dirty_bits(box, FOIL_RDRBOX_DIRTY_PAINT);
+        udom->nr_repainted_boxes++;
+        foil_udom_invalidate_rdrbox(udom,
+                box == udom->initial_cblock ? box->first : box);
+        return;
+    }
 
-    rebuild_subtree(udom, rdrbox);
+    if (box->dirty_descendants & FOIL_RDRBOX_DIRTY_PAINT) {
+        box->dirty_descendants &= ~FOIL_RDRBOX_DIRTY_PAINT;
 
+        foil_rdrbox *child = box->first;
+        while (child) {
+            repaint_dirty_rdrtree(udom, child);
+            child = child->next;
+        }
+    }
+}
+
+/*
+ * Handles the dirty boxes in three passes: reselects the styles of the
+ * style-dirty boxes, relays out the layout-dirty subtrees, then repaints
+ * the paint-dirty subtrees. Every pass only visits the paths to the dirty
+ * boxes, and a subtree relaid out or repainted once is clean in the pass.
+ */
+static int flush_dirty_rdrboxes(pcmcth_udom *udom)
+{
+    foil_rdrbox *root = udom->initial_cblock;
     foil_layout_ctxt layout_ctxt = { udom, udom->initial_cblock };
-    rdrbox = relayout_rdrtree(&layout_ctxt, rdrbox, orc);
+    int r = restyle_dirty_rdrtree(udom, root);
+
+    relayout_dirty_rdrtree(&layout_ctxt, root);
+    repaint_dirty_rdrtree(udom, root);
+
+    return r ? PCRDR_SC_SERVICE_UNAVAILABLE : PCRDR_SC_OK;
+}
+
+static int on_update_style(pcmcth_udom *udom, foil_rdrbox *rdrbox,
+    pcdoc_element_t ref_elem, int op)
+{
+    (void)ref_elem;
+    (void)op;
+
+    foil_rdrbox_mark_dirty(rdrbox, FOIL_RDRBOX_DIRTY_STYLE);
+    return flush_dirty_rdrboxes(udom);
+}
+
+static int on_rebuild_subtree(pcmcth_udom *udom, foil_rdrbox *rdrbox)
+{
+    /* the new child boxes are styled when they are made */
+    rebuild_subtree(udom, rdrbox);
 
-    foil_udom_invalidate_rdrbox(udom, rdrbox);
-    return PCRDR_SC_OK;
+    foil_rdrbox_mark_dirty(rdrbox, FOIL_RDRBOX_DIRTY_LAYOUT);
+    return flush_dirty_rdrboxes(udom);
 }
 
 static int on_displace_text_content(pcmcth_udom *udom, foil_rdrbox *rdrbox,
@@ -2069,6 +2413,13 @@ int foil_udom_update_rdrbox(pcmcth_udom *udom, foil_rdrbox *rdrbox,
     element = purc_variant_native_get_entity(ref_info);
     assert(element);
 
+    /* NOTE: count the elements restyled and the boxes relaid out by this
+       update, so we can tell how far a change spreads. */
+    css_select_stats stats;
+    css_select_ctx_get_stats(udom->select_ctx, &stats, true);
+    udom->nr_relaid_boxes = 0;
+    udom->nr_repainted_boxes = 0;
+
     if (strncasecmp(property, "attr.", 5) == 0) {
         const char *attr = property + 5;
         if (strcasecmp(attr, "style") == 0) {
@@ -2093,6 +2444,11 @@ int foil_udom_update_rdrbox(pcmcth_udom *udom, foil_rdrbox *rdrbox,
         LOG_WARN("Unknown property: %s\n", property);
     }
 
+    css_select_ctx_get_stats(udom->select_ctx, &stats, true);
+    LOG_DEBUG("Updated %s: %u elements restyled (%u selector chains "
+            "examined), %u boxes relaid out, %u subtrees repainted\n",
+            property, (unsigned)stats.n_elements, (unsigned)stats.n_examined,
+            udom->nr_relaid_boxes, udom->nr_repainted_boxes);
     return r;
 }
 
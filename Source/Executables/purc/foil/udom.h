@@ -36,6 +36,15 @@
 
 #define FOIL_DEF_RGNRCHEAP_SZ   16
 
+/* The styles composed for the last selected element. CSSEng interns the
+   computed styles, so the elements having the same partial styles and the
+   same parent style (e.g., the sibling list items) share the same styles. */
+struct foil_composed_styles {
+    css_computed_style *parent;
+    css_computed_style *partial[CSS_PSEUDO_ELEMENT_COUNT];
+    css_computed_style *composed[CSS_PSEUDO_ELEMENT_COUNT];
+};
+
 struct pcmcth_udom {
     /* the page in which the uDOM located */
     pcmcth_page *page;
@@ -51,9 +60,12 @@ struct pcmcth_udom {
 
     struct purc_broken_down_url *base;
 
-    /* author-defined style sheet */
+    /* author-defined style sheet; shared with the other uDOMs */
     css_stylesheet *author_sheet;
 
+    /* the text of the author-defined style sheet when loading */
+    struct pcutils_mystring author_css;
+
     /* CSS selection context */
     css_select_ctx *select_ctx;
 
@@ -83,6 +95,14 @@ struct pcmcth_udom {
 
     /* the pointer to the stacking context created by the root element */
     struct foil_stacking_context *root_stk_ctxt;
+
+    /* the cache of the last composed styles */
+    struct foil_composed_styles last_composed;
+
+    /* the number of the boxes relaid out by the current update */
+    unsigned nr_relaid_boxes;
+    /* the number of the subtrees repainted by the current update */
+    unsigned nr_repainted_boxes;
 };
 
 typedef struct foil_stacking_context {
@@ -192,6 +192,8 @@ void foil_widget_delete(foil_widget *widget)
         widget->ops->clean(widget);
     if (widget->data)
         free(widget->data);
+    if (widget->flushed)
+        free(widget->flushed);
     foil_widget_remove_from_tree(widget);
     foil_page_content_cleanup(&widget->page);
     if (widget->name)
@@ -435,6 +437,46 @@ make_escape_string_line_mode(const struct pcmcth_page *page,
     return mystr.buff;
 }
 
+static inline bool
+is_same_cell(const struct foil_tty_cell *a, const struct foil_tty_cell *b)
+{
+    return a->uc == b->uc && a->attrs == b->attrs &&
+        a->latter_half == b->latter_half &&
+        a->fgc == b->fgc && a->bgc == b->bgc;
+}
+
+/*
+ * Returns the cells of the viewport last flushed to the terminal, and
+ * sets @valid to indicate whether the contents are still on the screen.
+ * The contents are invalid if the viewport changed after the last flush.
+ */
+static struct foil_tty_cell *get_flushed_cells(foil_widget *widget,
+        bool *valid)
+{
+    if (widget->flushed && widget->fvx == widget->vx &&
+            widget->fvy == widget->vy && widget->fvw == widget->vw &&
+            widget->fvh == widget->vh) {
+        *valid = true;
+        return widget->flushed;
+    }
+
+    *valid = false;
+    if (widget->flushed)
+        free(widget->flushed);
+
+    widget->flushed = NULL;
+    if (widget->vw > 0 && widget->vh > 0) {
+        widget->flushed = calloc((size_t)widget->vw * widget->vh,
+                sizeof(struct foil_tty_cell));
+    }
+
+    widget->fvx = widget->vx;
+    widget->fvy = widget->vy;
+    widget->fvw = widget->vw;
+    widget->fvh = widget->vh;
+    return widget->flushed;
+}
+
 static void print_dirty_page_area_line_mode(foil_widget *widget)
 {
     pcmcth_page *page = &widget->page;
@@ -459,18 +501,51 @@ static void print_dirty_page_area_line_mode(foil_widget *widget)
         return;
     }
 
+    bool valid;
+    struct foil_tty_cell *flushed = get_flushed_cells(widget, &valid);
+
     char buf[64];
-    int w = foil_rect_width(&dirty);
     for (int y = dirty.top; y < dirty.bottom; y++) {
         int x = dirty.left;
+        int end = dirty.right;
 
-        int rel_col = x - widget->vx;
         int rel_row = widget->vh - y + widget->vy;
         if (rel_row > widget->vh)
             continue;
 
-        struct foil_tty_cell *cell = page->cells[y] + x;
-        char *escaped_str = make_escape_string_line_mode(page, cell, w);
+        /* NOTE: write the changed span of the line only, which cuts down
+           the bytes written to a slow terminal a lot, e.g., when only
+           a counter in a line changed. */
+        struct foil_tty_cell *line = page->cells[y];
+        struct foil_tty_cell *shadow = NULL;
+        if (flushed) {
+            shadow = flushed + (size_t)(y - widget->vy) * widget->vw -
+                widget->vx;
+        }
+
+        if (shadow && valid) {
+            while (x < end && is_same_cell(line + x, shadow + x))
+                x++;
+            while (end > x && is_same_cell(line + end - 1, shadow + end - 1))
+                end--;
+            if (x == end)
+                continue;
+
+            /* do not split a wide character */
+            if (line[x].latter_half && x > widget->vx)
+                x--;
+            if (end < widget->vx + widget->vw && end < page->cols &&
+                    line[end].latter_half)
+                end++;
+        }
+
+        if (shadow)
+            memcpy(shadow + x, line + x, sizeof(*line) * (end - x));
+
+        int rel_col = x - widget->vx;
+        struct foil_tty_cell *cell = line + x;
+        char *escaped_str = make_escape_string_line_mode(page, cell,
+                end - x);
 
         LOG_DEBUG("move curosr %d rows up and %d colunms right\n",
                 rel_row, rel_col);
@@ -96,8 +96,17 @@ struct foil_widget {
     char               *title;
     void               *user_data;
 
+    /* the instance of the endpoint which created this widget,
+       to which the events of this widget are sent */
+    purc_atom_t         owner;
+
     void                   *data;
     struct foil_widget_ops *ops;
+
+    /* the cells of the viewport last flushed to the terminal, and the
+       viewport when flushed; used to write the changed cells only. */
+    struct foil_tty_cell   *flushed;
+    int                     fvx, fvy, fvw, fvh;
 };
 
 #define WSP_WIDGET_FLAG_NAME      0x00000001
@@ -183,6 +183,61 @@ void foil_wsp_convert_style(void *workspace, void *session,
     style->flags |= WSP_WIDGET_FLAG_TOOLKIT;
 }
 
+/*
+ * Only the last plain window in the workspace is visible on the terminal;
+ * the others are hidden, so that their renderings are deferred, and the
+ * owners are told to throttle the coroutines in them.
+ */
+static void notify_visibility(foil_widget *widget, const char *event)
+{
+    if (widget->owner == 0)
+        return;
+
+    pcrdr_msg *msg = pcrdr_make_void_message();
+    if (msg == NULL)
+        goto failed;
+
+    msg->type = PCRDR_MSG_TYPE_EVENT;
+    msg->target = PCRDR_MSG_TARGET_PLAINWINDOW;
+    msg->targetValue = PTR2U64(&widget->page);
+    msg->eventName = purc_variant_make_string_static(event, false);
+    /* TODO: use real URI for the sourceURI */
+    msg->sourceURI =
+        purc_variant_make_string_static(PCRDR_APP_RENDERER, false);
+    msg->elementType = PCRDR_MSG_ELEMENT_TYPE_VOID;
+    msg->property = PURC_VARIANT_INVALID;
+    msg->dataType = PCRDR_MSG_DATA_TYPE_VOID;
+
+    if (purc_inst_move_message(widget->owner, msg) == 0) {
+        /* the endpoint may have gone */
+        LOG_WARN("Failed to send %s event to %u\n", event, widget->owner);
+    }
+
+    pcrdr_release_message(msg);
+    return;
+
+failed:
+    LOG_ERROR("Failed when notify the owner about the visibility: %s\n",
+                    purc_get_error_message(purc_get_last_error()));
+}
+
+static void set_plainwin_hidden(foil_widget *plainwin, bool hidden)
+{
+    if (plainwin->type != WSP_WIDGET_TYPE_PLAINWINDOW)
+        return;
+
+    if (foil_page_set_hidden(&plainwin->page, hidden)) {
+        notify_visibility(plainwin, hidden ? PCRDR_EVENT_HIDE :
+                PCRDR_EVENT_SHOW);
+    }
+}
+
+void foil_wsp_show_last_plainwin(pcmcth_workspace *workspace)
+{
+    if (workspace->root->last)
+        set_plainwin_hidden(workspace->root->last, false);
+}
+
 static pcmcth_page *
 create_plainwin(pcmcth_workspace *workspace, pcmcth_session *sess,
         void *init_arg, const struct foil_widget_info *style)
@@ -198,6 +253,8 @@ create_plainwin(pcmcth_workspace *workspace, pcmcth_session *sess,
             WSP_WIDGET_TYPE_PLAINWINDOW, WSP_WIDGET_BORDER_NONE,
             style->name, style->title, &rc);
     if (plainwin) {
+        if (workspace->root->last)
+            set_plainwin_hidden(workspace->root->last, true);
         foil_widget_append_child(workspace->root, plainwin);
         return &plainwin->page;
     }
@@ -228,10 +285,10 @@ static int
 destroy_plainwin(pcmcth_workspace *workspace, pcmcth_session *sess,
         foil_widget *plainwin)
 {
-    (void)workspace;
     (void)sess;
 
     foil_widget_delete(plainwin);
+    foil_wsp_show_last_plainwin(workspace);
     return PCRDR_SC_OK;
 }
 
@@ -85,6 +85,10 @@ static inline foil_block_heap_p foil_wsp_rgnrc_heap(pcmcth_workspace *wsp)
 foil_widget *foil_wsp_find_widget(void *workspace, void *session,
         const char *id);
 
+/* Shows the last plain window, e.g., after the windows above it were
+   destroyed; the other plain windows are hidden. */
+void foil_wsp_show_last_plainwin(pcmcth_workspace *workspace);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,10 @@
 #include <sys/types.h>
 #include <pwd.h>
 #include <grp.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
 
 #include "config.h"
 #include "foil.h"
@@ -60,6 +64,9 @@
 #define DEF_RDR_URI_SOCKET      "unix://" PCRDR_PURCMC_US_PATH
 #define DEF_RDR_URI_WEBSOCKET   "ws://localhost:" PCRDR_PURCMC_WS_PORT
 
+/* the default capacity of the ring buffer of the tracing spans */
+#define DEF_TRACE_EVENTS        "65536"
+
 #define KEY_FLAG_REQUEST        "request"
 
 #define KEY_URLS                "urls"
@@ -154,6 +161,8 @@ static void print_usage(FILE *fp)
         "        The renderer uri or shortname:\n"
         "            - For the renderer comm method `headless`,\n"
         "              the default value is `file:///dev/null`.\n"
+        "              Append `?mode=null` to acknowledge every request at once\n"
+        "              without any state or log, e.g., for benchmarking.\n"
         "            - For the renderer comm method `thread`,\n"
         "              the default value is the first available one:\n"
         "              `foil` if Foil is enabled, otherwise `seeker`.\n"
@@ -198,6 +207,27 @@ static void print_usage(FILE *fp)
         "  -v --verbose\n"
         "        Execute the program(s) with verbose output.\n"
         "\n"
+        "  -t --trace=< trace_file >\n"
+        "        Record the tracing spans of the hot paths of all runners and\n"
+        "        write them into the file in the Chrome trace JSON format,\n"
+        "        which can be loaded by `chrome://tracing` or Perfetto UI.\n"
+        "\n"
+        "  -p --profile=< profile_file >\n"
+        "        Profile the elements executed by all runners and append the\n"
+        "        counters of the elements to the file when a runner exits, or\n"
+        "        when `purc` receives SIGUSR2.\n"
+        "\n"
+        "  -b --bench=< runs | seconds`s` >\n"
+        "        Run in the benchmark mode: run the programs in fresh coroutines\n"
+        "        for the given times, e.g., `--bench=100`, or for the given seconds,\n"
+        "        e.g., `--bench=10s`, after a warm-up run; then print the time,\n"
+        "        the memory and the scheduler statistics. The renderer URI\n"
+        "        defaults to `file:///dev/null?mode=null` in this mode.\n"
+        "\n"
+        "  -n --bench-runners=< runners >\n"
+        "        Run the benchmark across the given number of runners\n"
+        "        in parallel (default: 1).\n"
+        "\n"
         "  -C --copying\n"
         "        Display detailed copying information and exit.\n"
         "\n"
@@ -247,10 +277,24 @@ struct my_opts {
     pcutils_array_t *contents;
     char *app_info;
 
+    const char *trace;
+    const char *profile;
+
+    /* the benchmark mode: run the programs for the given times or seconds,
+       across the given number of runners */
+    size_t bench_runs;
+    double bench_seconds;
+    size_t bench_runners;
+
     bool parallel;
     bool verbose;
 };
 
+static inline bool is_bench_mode(const struct my_opts *opts)
+{
+    return opts->bench_runs || opts->bench_seconds > 0;
+}
+
 static const char *archedata_header =
 "{"
     "'app': $OPTS.app,"
@@ -437,7 +481,7 @@ static bool validate_url(struct my_opts *opts, const char *url)
 
 static int read_option_args(struct my_opts *opts, int argc, char **argv)
 {
-    static const char short_options[] = "a:r:d:c:u:j:q:P:L:T:A:s:S:R:U:G:lvCVh";
+    static const char short_options[] = "a:r:d:c:u:j:q:P:L:T:A:s:S:R:U:G:t:p:b:n:lvCVh";
     static const struct option long_opts[] = {
         { "app"                         , required_argument , NULL , 'a' },
         { "runner"                      , required_argument , NULL , 'r' },
@@ -455,6 +499,10 @@ static int read_option_args(struct my_opts *opts, int argc, char **argv)
         { "chroot"                      , required_argument , NULL , 'R' },
         { "setuser"                     , required_argument , NULL , 'U' },
         { "setgroup"                    , required_argument , NULL , 'G' },
+        { "trace"                       , required_argument , NULL , 't' },
+        { "profile"                     , required_argument , NULL , 'p' },
+        { "bench"                       , required_argument , NULL , 'b' },
+        { "bench-runners"               , required_argument , NULL , 'n' },
         { "parallel"                    , no_argument       , NULL , 'l' },
         { "verbose"                     , no_argument       , NULL , 'v' },
         { "copying"                     , no_argument       , NULL , 'C' },
@@ -608,6 +656,37 @@ static int read_option_args(struct my_opts *opts, int argc, char **argv)
             opts->verbose = true;
             break;
 
+        case 't':
+            opts->trace = optarg;
+            break;
+
+        case 'p':
+            opts->profile = optarg;
+            break;
+
+        case 'b': {
+            char *end;
+            double d = strtod(optarg, &end);
+            if (end == optarg || d <= 0)
+                goto bad_arg;
+            if (strcmp(end, "s") == 0)
+                opts->bench_seconds = d;
+            else if (*end == '\0' && d == (size_t)d)
+                opts->bench_runs = (size_t)d;
+            else
+                goto bad_arg;
+            break;
+        }
+
+        case 'n': {
+            char *end;
+            unsigned long n = strtoul(optarg, &end, 10);
+            if (*end || n == 0 || n > 1024)
+                goto bad_arg;
+            opts->bench_runners = n;
+            break;
+        }
+
         case '?':
             fprintf(stderr, "Run with `-h` option for usage.\n");
             return -1;
@@ -1463,6 +1542,360 @@ run_programs_sequentially(struct my_opts *opts, purc_variant_t request)
     return nr_executed > 0;
 }
 
+#define BENCH_INFO_NAME     "bench-data"
+
+/* the default renderer URI in the benchmark mode: acknowledge every request
+   at once, so that the renderer is not measured. */
+#define DEF_RDR_URI_BENCH   DEF_RDR_URI_HEADLESS "?mode=null"
+
+struct bench_runner {
+    pthread_t th;
+    unsigned idx;
+
+    struct my_opts *opts;
+    unsigned int modules;
+    const purc_instance_extra_info *extra_info;
+    const char *request;        // in EJSON; NULL for the runner 0
+    purc_variant_t request_vrt; // the request of the runner 0
+
+    double *samples;            // the time of every run in milliseconds
+    size_t nr_samples;
+    size_t sz_samples;
+    double elapsed;             // the time of all runs in seconds
+
+    uint64_t nr_steps;
+    size_t nr_exited;
+    size_t nr_terminated;
+    size_t sz_mem_base;         // the memory of the variants after warm-up
+    size_t sz_mem_final;
+    size_t sz_mem_peak;
+
+    bool failed;
+};
+
+static int bench_cond_handler(purc_cond_k event, purc_coroutine_t cor,
+        void *data)
+{
+    (void)cor;
+    (void)data;
+
+    struct bench_runner *runner = NULL;
+    purc_get_local_data(BENCH_INFO_NAME, (uintptr_t *)(void *)&runner, NULL);
+    assert(runner);
+
+    if (event == PURC_COND_COR_EXITED)
+        runner->nr_exited++;
+    else if (event == PURC_COND_COR_TERMINATED)
+        runner->nr_terminated++;
+
+    return 0;
+}
+
+static uint64_t bench_get_nr_steps(void)
+{
+    uint64_t nr_steps = 0;
+    purc_variant_t metrics = purc_get_instance_metrics();
+    if (metrics) {
+        purc_variant_t v = purc_variant_object_get_by_ckey(metrics, "steps");
+        if (v)
+            purc_variant_cast_to_ulongint(v, &nr_steps, false);
+        purc_variant_unref(metrics);
+    }
+
+    return nr_steps;
+}
+
+/* Runs all programs once in fresh coroutines. */
+static void bench_run_once(purc_vdom_t *vdoms, size_t nr_vdoms,
+        purc_variant_t request)
+{
+    for (size_t i = 0; i < nr_vdoms; i++) {
+        purc_schedule_vdom(vdoms[i], 0, request, PCRDR_PAGE_TYPE_PLAINWIN,
+                NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+
+    purc_run((purc_cond_handler)bench_cond_handler);
+}
+
+static bool bench_add_sample(struct bench_runner *runner, double ms)
+{
+    if (runner->nr_samples == runner->sz_samples) {
+        size_t sz = runner->sz_samples ? runner->sz_samples * 2 : 256;
+        double *samples = realloc(runner->samples, sizeof(double) * sz);
+        if (samples == NULL)
+            return false;
+
+        runner->samples = samples;
+        runner->sz_samples = sz;
+    }
+
+    runner->samples[runner->nr_samples++] = ms;
+    return true;
+}
+
+static void bench_run_programs(struct bench_runner *runner)
+{
+    struct my_opts *opts = runner->opts;
+    purc_variant_t request = runner->request_vrt;
+
+    if (request == PURC_VARIANT_INVALID) {
+        request = purc_variant_make_from_json_string(runner->request,
+                strlen(runner->request));
+        if (request == PURC_VARIANT_INVALID) {
+            runner->failed = true;
+            return;
+        }
+    }
+
+    purc_vdom_t *vdoms = calloc(opts->urls->length, sizeof(purc_vdom_t));
+    if (vdoms == NULL) {
+        runner->failed = true;
+        goto done;
+    }
+
+    for (size_t i = 0; i < opts->urls->length; i++) {
+        const char *url = opts->urls->list[i];
+        vdoms[i] = load_hvml(url);
+        if (vdoms[i] == NULL) {
+            fprintf(stderr, "Failed to load HVML from %s: %s\n", url,
+                    purc_get_error_message(purc_get_last_error()));
+            runner->failed = true;
+            goto done;
+        }
+    }
+
+    purc_set_local_data(BENCH_INFO_NAME, (uintptr_t)runner, NULL);
+
+    /* warm up the caches and the pools; not counted */
+    bench_run_once(vdoms, opts->urls->length, request);
+    runner->nr_exited = runner->nr_terminated = 0;
+    runner->sz_mem_base = purc_variant_usage_stat()->sz_total_mem;
+
+    uint64_t nr_steps = bench_get_nr_steps();
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t n = 0; ; n++) {
+        if (opts->bench_runs && n >= opts->bench_runs)
+            break;
+        if (opts->bench_seconds &&
+                purc_get_elapsed_seconds(&start, NULL) >= opts->bench_seconds)
+            break;
+
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        bench_run_once(vdoms, opts->urls->length, request);
+        if (!bench_add_sample(runner,
+                    purc_get_elapsed_seconds(&ts, NULL) * 1000)) {
+            runner->failed = true;
+            break;
+        }
+    }
+    runner->elapsed = purc_get_elapsed_seconds(&start, NULL);
+
+    runner->nr_steps = bench_get_nr_steps() - nr_steps;
+    runner->sz_mem_final = purc_variant_usage_stat()->sz_total_mem;
+    runner->sz_mem_peak = purc_variant_usage_stat()->sz_max_mem;
+
+    purc_remove_local_data(BENCH_INFO_NAME);
+
+done:
+    if (vdoms)
+        free(vdoms);
+    if (runner->request_vrt == PURC_VARIANT_INVALID)
+        purc_variant_unref(request);
+}
+
+static void *bench_runner_entry(void *arg)
+{
+    struct bench_runner *runner = arg;
+    struct my_opts *opts = runner->opts;
+    char name[PURC_LEN_RUNNER_NAME + 1];
+
+    snprintf(name, sizeof(name), "%s-%u", opts->run, runner->idx);
+    if (purc_init_ex(runner->modules, opts->app ? opts->app : DEF_APP_NAME,
+                name, runner->extra_info) != PURC_ERROR_OK) {
+        runner->failed = true;
+        return NULL;
+    }
+
+    bench_run_programs(runner);
+    purc_cleanup();
+    return NULL;
+}
+
+static char *bench_serialize_request(purc_variant_t request)
+{
+    purc_rwstream_t stm = purc_rwstream_new_buffer(256, 0);
+    if (stm == NULL)
+        return NULL;
+
+    char *ejson = NULL;
+    if (purc_variant_serialize(request, stm, 0, MY_VRT_OPTS, NULL) >= 0 &&
+            purc_rwstream_write(stm, "", 1) == 1) {
+        ejson = purc_rwstream_get_mem_buffer_ex(stm, NULL, NULL, true);
+    }
+
+    purc_rwstream_destroy(stm);
+    return ejson;
+}
+
+static int cmp_samples(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    if (da == db)
+        return 0;
+    return (da < db) ? -1 : 1;
+}
+
+static double percentile(const double *sorted, size_t nr, double p)
+{
+    return sorted[(size_t)(p * (nr - 1) + 0.5)];
+}
+
+static bool bench_report(struct my_opts *opts,
+        struct bench_runner *runners, size_t nr_runners)
+{
+    size_t nr_samples = 0, nr_exited = 0, nr_terminated = 0;
+    uint64_t nr_steps = 0;
+    double elapsed = 0;
+    size_t sz_mem_peak = 0;
+    ssize_t sz_mem_growth = 0;
+    bool failed = false;
+
+    for (size_t i = 0; i < nr_runners; i++) {
+        struct bench_runner *runner = runners + i;
+        if (runner->failed) {
+            fprintf(stderr, "The benchmark failed in runner #%u.\n",
+                    runner->idx);
+            failed = true;
+            continue;
+        }
+
+        nr_samples += runner->nr_samples;
+        nr_exited += runner->nr_exited;
+        nr_terminated += runner->nr_terminated;
+        nr_steps += runner->nr_steps;
+        if (runner->elapsed > elapsed)
+            elapsed = runner->elapsed;
+        if (runner->sz_mem_peak > sz_mem_peak)
+            sz_mem_peak = runner->sz_mem_peak;
+        sz_mem_growth +=
+            (ssize_t)runner->sz_mem_final - (ssize_t)runner->sz_mem_base;
+
+        if (opts->verbose) {
+            fprintf(stdout, "Runner #%u: %u runs in %.3f s\n", runner->idx,
+                    (unsigned)runner->nr_samples, runner->elapsed);
+        }
+    }
+
+    if (nr_samples == 0)
+        return false;
+
+    double *all = malloc(sizeof(double) * nr_samples);
+    if (all == NULL)
+        return false;
+
+    double sum = 0;
+    for (size_t i = 0, n = 0; i < nr_runners; i++) {
+        for (size_t j = 0; j < runners[i].nr_samples; j++) {
+            all[n++] = runners[i].samples[j];
+            sum += runners[i].samples[j];
+        }
+    }
+    qsort(all, nr_samples, sizeof(double), cmp_samples);
+
+    double avg = sum / nr_samples;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(stdout, "\nBenchmark: %u runs of %u program(s) across "
+            "%u runner(s) in %.3f s\n", (unsigned)nr_samples,
+            (unsigned)opts->urls->length, (unsigned)nr_runners, elapsed);
+    fprintf(stdout, "  time per run (ms): min %.3f, avg %.3f, "
+            "p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n", all[0], avg,
+            percentile(all, nr_samples, 0.5),
+            percentile(all, nr_samples, 0.9),
+            percentile(all, nr_samples, 0.99), all[nr_samples - 1]);
+    fprintf(stdout, "  throughput: %.1f runs/s\n",
+            elapsed > 0 ? nr_samples / elapsed : 0);
+    fprintf(stdout, "  scheduler: %llu steps, %.1f steps per run, "
+            "%.1f steps/s; %u coroutines exited, %u terminated\n",
+            (unsigned long long)nr_steps, (double)nr_steps / nr_samples,
+            elapsed > 0 ? nr_steps / elapsed : 0,
+            (unsigned)nr_exited, (unsigned)nr_terminated);
+    fprintf(stdout, "  memory: variants peak %.1f KiB, variants growth "
+            "%.1f KiB, max RSS %ld KiB\n", sz_mem_peak / 1024.0,
+            sz_mem_growth / 1024.0, (long)usage.ru_maxrss);
+
+    free(all);
+    return !failed && nr_terminated == 0;
+}
+
+/*
+ * Runs the programs repeatedly in fresh coroutines of one or more runners,
+ * and reports the time, the memory, and the scheduler statistics.
+ * The runner 0 is the current instance; the others run in their own threads.
+ */
+static bool run_benchmark(struct my_opts *opts, unsigned int modules,
+        const purc_instance_extra_info *extra_info, purc_variant_t request)
+{
+    size_t nr_runners = opts->bench_runners ? opts->bench_runners : 1;
+    struct bench_runner *runners = calloc(nr_runners, sizeof(*runners));
+    if (runners == NULL)
+        return false;
+
+    char *ejson = NULL;
+    if (nr_runners > 1 && (ejson = bench_serialize_request(request)) == NULL) {
+        fprintf(stderr, "Failed to serialize the request data\n");
+        free(runners);
+        return false;
+    }
+
+    for (size_t i = 0; i < nr_runners; i++) {
+        runners[i].idx = i;
+        runners[i].opts = opts;
+        runners[i].modules = modules;
+        runners[i].extra_info = extra_info;
+        runners[i].request = ejson;
+    }
+    runners[0].request_vrt = request;
+
+    if (opts->verbose) {
+        fprintf(stdout, "\nBenchmarking %u program(s) across %u runner(s)...\n",
+                (unsigned)opts->urls->length, (unsigned)nr_runners);
+    }
+
+    for (size_t i = 1; i < nr_runners; i++) {
+        if (pthread_create(&runners[i].th, NULL, bench_runner_entry,
+                    runners + i)) {
+            fprintf(stderr, "Failed to create the thread for runner #%u\n",
+                    (unsigned)i);
+            nr_runners = i;
+            break;
+        }
+    }
+
+    bench_run_programs(runners);
+
+    for (size_t i = 1; i < nr_runners; i++)
+        pthread_join(runners[i].th, NULL);
+
+    bool success = bench_report(opts, runners, nr_runners);
+
+    for (size_t i = 0; i < nr_runners; i++) {
+        if (runners[i].samples)
+            free(runners[i].samples);
+    }
+    if (ejson)
+        free(ejson);
+    free(runners);
+    return success;
+}
+
 #ifndef NDEBUG
 #include "util/unistring.h"
 
@@ -1793,6 +2226,12 @@ static int drop_root_privilege(const struct my_opts *opts)
     return 0;
 }
 
+static void profile_signal_handler(int sig)
+{
+    (void)sig;
+    purc_request_profile_dump();
+}
+
 int main(int argc, char** argv)
 {
     int ret;
@@ -1811,6 +2250,13 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
+    if (opts->app_info && is_bench_mode(opts)) {
+        fprintf(stderr, "%s: the benchmark mode does not support "
+                "the app description.\n", argv[0]);
+        my_opts_delete(opts);
+        return EXIT_FAILURE;
+    }
+
     if (opts->app_info == NULL &&
             (opts->urls == NULL || opts->urls->length == 0)) {
         fprintf(stderr, "%s: no valid HVML program specified.\n", argv[0]);
@@ -1897,7 +2343,8 @@ int main(int argc, char** argv)
 
         extra_info.renderer_comm = PURC_RDRCOMM_HEADLESS;
         if (opts->rdr_uri == NULL) {
-            opts->rdr_uri = strdup(DEF_RDR_URI_HEADLESS);
+            opts->rdr_uri = strdup(is_bench_mode(opts) ?
+                    DEF_RDR_URI_BENCH : DEF_RDR_URI_HEADLESS);
         }
 
     }
@@ -1972,6 +2419,27 @@ int main(int argc, char** argv)
 
     extra_info.renderer_uri = opts->rdr_uri;
 
+    /* Since 0.9.22: the tracing applies to the instances of all runners. */
+    if (opts->trace) {
+        if (getenv(PURC_ENVV_TRACE_EVENTS) == NULL)
+            setenv(PURC_ENVV_TRACE_EVENTS, DEF_TRACE_EVENTS, 1);
+        setenv(PURC_ENVV_TRACE_FILE, opts->trace, 1);
+        unlink(opts->trace);
+    }
+
+    /* Since 0.9.22: the profiling applies to the instances of all runners,
+       and SIGUSR2 asks them to dump the profile while running. */
+    if (opts->profile) {
+        setenv(PURC_ENVV_PROFILE_FILE, opts->profile, 1);
+        unlink(opts->profile);
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = profile_signal_handler;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        sigaction(SIGUSR2, &sa, NULL);
+    }
 
     ret = purc_init_ex(modules, opts->app ? opts->app : DEF_APP_NAME,
             opts->run, &extra_info);
@@ -2017,7 +2485,7 @@ int main(int argc, char** argv)
 
     run_info.dump_stm = purc_rwstream_new_for_dump(stdout, cb_stdio_write);
 
-    if (opts->app_info == NULL && opts->parallel) {
+    if (opts->app_info == NULL && opts->parallel && !is_bench_mode(opts)) {
         if (!construct_app_info(opts)) {
             my_opts_delete(opts);
             goto failed;
@@ -2038,6 +2506,9 @@ int main(int argc, char** argv)
         }
 
     }
+    else if (is_bench_mode(opts)) {
+        success = run_benchmark(opts, modules, &extra_info, request);
+    }
     else {
         assert(!opts->parallel);
         success = run_programs_sequentially(opts, request);
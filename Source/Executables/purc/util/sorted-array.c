@@ -107,8 +107,23 @@ int sorted_array_add(struct sorted_array *sa, uint64_t sortv, void *data)
 {
     ssize_t i, idx;
     ssize_t low, high, mid;
+    bool append = false;
 
-    if (!(sa->flags & SAFLAG_DUPLCATE_SORTV)) {
+    /* NOTE: the members are mostly added in order (e.g., the elements
+       when building the rendering tree), so check the last one first
+       to avoid the searches and the moves. */
+    if (sa->nr_members == 0) {
+        append = true;
+    }
+    else {
+        int cmp = sa->cmp_fn(sortv, sa->members[sa->nr_members - 1].sortv);
+        if (sa->flags & SAFLAG_ORDER_DESC)
+            append = (cmp < 0);
+        else
+            append = (cmp > 0);
+    }
+
+    if (!append && !(sa->flags & SAFLAG_DUPLCATE_SORTV)) {
         if (sorted_array_find(sa, sortv, NULL) >= 0) {
             return -1;
         }
@@ -119,7 +134,8 @@ int sorted_array_add(struct sorted_array *sa, uint64_t sortv, void *data)
     }
 
     if ((sa->nr_members + 1) >= sa->sz_array) {
-        size_t new_sz = sa->sz_array + SASZ_DEFAULT;
+        /* grow geometrically to keep the adding amortized constant */
+        size_t new_sz = sa->sz_array + (sa->sz_array >> 1) + SASZ_DEFAULT;
         struct sorted_array_member *old_members = sa->members;
 
         sa->members = realloc(sa->members,
@@ -132,6 +148,11 @@ int sorted_array_add(struct sorted_array *sa, uint64_t sortv, void *data)
         sa->sz_array = new_sz;
     }
 
+    if (append) {
+        idx = sa->nr_members;
+        goto done;
+    }
+
     low = 0;
     high = sa->nr_members - 1;
     while (low <= high) {
@@ -172,6 +193,7 @@ int sorted_array_add(struct sorted_array *sa, uint64_t sortv, void *data)
         sa->members[i].data = sa->members[i - 1].data;
     }
 
+done:
     sa->members[idx].sortv = sortv;
     sa->members[idx].data = data;
 
@@ -23,6 +23,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#define _GNU_SOURCE
 #include "config.h"
 #include "private/instance.h"
 #include "private/errors.h"
@@ -37,6 +38,7 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <dirent.h>
 #include <fcntl.h>
@@ -51,6 +53,8 @@
 #if OS(LINUX)
 #include <mntent.h>
 #include <sys/vfs.h>
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
 #endif
 
 #if OS(DARWIN)
@@ -209,38 +213,86 @@ static inline int strcmp_len (const char *str1, const char *str2, size_t *real_l
     return 0;
 }
 
+/*
+ * Copies the data in the kernel by copy_file_range(2) (which may clone the
+ * extents on a file system like Btrfs and XFS) or sendfile(2) on Linux,
+ * and leaves the rest to the caller if neither is supported for the files.
+ * Both calls advance the file offsets, so the caller can go on copying
+ * by read(2) and write(2). Returns the number of bytes copied.
+ */
+static size_t copy_in_kernel (int fd_in, int fd_out, size_t size)
+{
+    size_t copied = 0;
+
+#if OS(LINUX) && defined(SYS_copy_file_range)
+    while (copied < size) {
+        ssize_t n = syscall(SYS_copy_file_range, fd_in, NULL, fd_out, NULL,
+                size - copied, 0);
+        if (n <= 0)
+            break;
+        copied += n;
+    }
+#endif
+
+#if OS(LINUX)
+    while (copied < size) {
+        ssize_t n = sendfile(fd_out, fd_in, NULL, size - copied);
+        if (n <= 0)
+            break;
+        copied += n;
+    }
+#endif
+
+    (void)fd_in;
+    (void)fd_out;
+    return copied;
+}
+
 static bool filecopy (const char *infile, const char *outfile)
 {
     #define FLCPY_BFSZ  8192
 
     char buffer[FLCPY_BFSZ];
-    size_t sz_read = 0;
-    FILE *in  = fopen (infile, "rb");
-    FILE *out = fopen (outfile,"wb");
-
-    if (NULL == in || NULL == out) {
-        if (in)
-            fclose (in);
-        if (out)
-            fclose (out);
+    ssize_t sz_read = 0;
+    struct stat st;
+    bool ret = false;
+
+    int in = open (infile, O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return false;
+
+    int out = open (outfile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (out < 0) {
+        close (in);
         return false;
     }
 
-    while ((sz_read = fread (buffer, 1, FLCPY_BFSZ, in)) == FLCPY_BFSZ) {
-        if (sz_read != fwrite (buffer, 1, sz_read, out)) {
-            fclose (out);
-            fclose (in);
-            return false;
+    if (fstat (in, &st) == 0 && S_ISREG (st.st_mode)) {
+        size_t copied = copy_in_kernel (in, out, st.st_size);
+        if (copied == (size_t)st.st_size) {
+            ret = true;
+            goto done;
         }
     }
-    if (sz_read != fwrite (buffer, 1, sz_read, out)) {
-        fclose (out);
-        fclose (in);
+
+    /* copy the left (or all for a special file) in the user space */
+    while ((sz_read = read (in, buffer, FLCPY_BFSZ)) > 0) {
+        if (write (out, buffer, sz_read) != sz_read)
+            goto done;
+    }
+    ret = (sz_read == 0);
+
+done:
+    if (!ret) {
+        int err = errno;
+        close (out);
+        close (in);
+        errno = err;
         return false;
     }
 
-    fclose (out);
-    fclose (in);
+    close (out);
+    close (in);
     return true;
 }
 
@@ -3151,6 +3203,87 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/* The memory-mapped region of a file; owned by a native entity. */
+struct mapped_file {
+    void       *addr;
+    size_t      len;
+};
+
+static void on_mapped_file_release (void *native_entity)
+{
+    struct mapped_file *mapped = native_entity;
+
+    munmap (mapped->addr, mapped->len);
+    free (mapped);
+}
+
+/*
+ * Maps the contents of the file and makes a byte sequence or a string
+ * refers to the mapped pages without copying them. The mapping is
+ * released when the last variant refering to it is released.
+ */
+static purc_variant_t
+map_file_contents (int fd, int64_t offset, size_t sz_contents,
+        bool opt_binary, bool opt_check_encoding)
+{
+    static const struct purc_native_ops ops = {
+        .on_release = on_mapped_file_release,
+    };
+
+    size_t pagesize = (size_t)sysconf (_SC_PAGESIZE);
+    size_t delta = (size_t)offset % pagesize;
+    size_t map_len = delta + sz_contents;
+    purc_variant_t owner, retv;
+    struct mapped_file *mapped;
+    uint8_t *addr;
+
+    addr = mmap (NULL, map_len, PROT_READ, MAP_PRIVATE, fd, offset - delta);
+    if (addr == MAP_FAILED) {
+        PC_ERROR("Failed to map file (%d): %s\n", fd, strerror(errno));
+        purc_set_error (PURC_ERROR_BAD_SYSTEM_CALL);
+        return PURC_VARIANT_INVALID;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    /* the advices are not flags; give them one by one */
+    madvise (addr, map_len, MADV_SEQUENTIAL);
+    madvise (addr, map_len, MADV_WILLNEED);
+#endif
+
+    mapped = malloc (sizeof (*mapped));
+    if (mapped == NULL) {
+        munmap (addr, map_len);
+        purc_set_error (PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    mapped->addr = addr;
+    mapped->len = map_len;
+    owner = purc_variant_make_native_entity (mapped, &ops, "mappedFile");
+    if (owner == PURC_VARIANT_INVALID) {
+        on_mapped_file_release (mapped);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (opt_binary) {
+        retv = purc_variant_make_byte_sequence_view (owner,
+                addr + delta, sz_contents);
+    }
+    else if (map_len % pagesize) {
+        /* the terminating null byte is in the zero-filled tail page */
+        retv = purc_variant_make_string_view (owner,
+                (const char *)addr + delta, sz_contents, opt_check_encoding);
+    }
+    else {
+        /* no room for the terminating null byte; make a copy */
+        retv = purc_variant_make_string_ex ((const char *)addr + delta,
+                sz_contents, opt_check_encoding);
+    }
+
+    purc_variant_unref (owner);
+    return retv;
+}
+
 static purc_variant_t
 file_contents_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -3161,6 +3294,7 @@ file_contents_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     purc_variant_t ret_var = PURC_VARIANT_INVALID;
     bool        opt_binary = false;
     bool        opt_check_encoding = false;
+    bool        opt_mmap = false;
 
     struct stat filestat;
     size_t      filesize;
@@ -3237,6 +3371,10 @@ file_contents_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
                 set_silent = true;
                 continue;
             }
+            if (strncmp2ltr(keyword, "mmap", kwlen) == 0) {
+                opt_mmap = true;
+                continue;
+            }
 
             // Unknown options
             purc_set_error(PURC_ERROR_INVALID_VALUE);
@@ -3286,12 +3424,30 @@ file_contents_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        PC_ERROR("Failed to open file %s: %s\n", filename, strerror(errno));
+        purc_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
+        goto failed;
+    }
+
+    if (opt_mmap && S_ISREG(filestat.st_mode)) {
+        ret_var = map_file_contents(fd, offset, sz_contents,
+                opt_binary, opt_check_encoding);
+        if (ret_var == PURC_VARIANT_INVALID)
+            goto failed;
+
+        close(fd);
+        return ret_var;
+    }
+
     if (opt_binary) {
         contents = malloc(sz_contents);
     }
     else {
         contents = malloc(sz_contents + 1);
-        contents[sz_contents] = 0x0;
+        if (contents)
+            contents[sz_contents] = 0x0;
     }
 
     if (contents == NULL) {
@@ -3299,13 +3455,6 @@ file_contents_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
-    fd = open(filename, O_RDONLY);
-    if (fd < 0) {
-        PC_ERROR("Failed to open file %s: %s\n", filename, strerror(errno));
-        purc_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
-        goto failed;
-    }
-
     if (offset > 0) {
         if (lseek(fd, offset, SEEK_SET) == -1) {
            PC_ERROR("Failed to seek %lld to file %s (%d): %s\n",
@@ -3689,6 +3838,593 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/*
+ * The walker behind $FS.walk(): it lists a directory (and its descendants
+ * if `recursive` is given) lazily, one entry per call of PURC_NATIVE_PROP_NEXT,
+ * so it can be used as the source of `iterate` without building an array.
+ *
+ * NOTE: The wildcards are matched against the names before stating, and
+ * an entry is stated only if a field other than `type` is wanted (or the
+ * file system does not report the type); on Linux, the entries are read
+ * by getdents64(2), and only the wanted fields are asked by statx(2).
+ */
+#if OS(LINUX) && defined(SYS_getdents64)
+#   define WALK_USE_GETDENTS64      1
+#else
+#   define WALK_USE_GETDENTS64      0
+#endif
+
+#if OS(LINUX) && defined(STATX_BASIC_STATS)
+#   define WALK_USE_STATX           1
+#else
+#   define WALK_USE_STATX           0
+#endif
+
+#define WALK_DIRENT_BUF_SIZE        (32 * 1024)
+#define WALK_DEF_OPTIONS            "type"
+
+#if WALK_USE_GETDENTS64
+struct walk_dirent64 {
+    uint64_t        d_ino;
+    int64_t         d_off;
+    unsigned short  d_reclen;
+    unsigned char   d_type;
+    char            d_name[];
+};
+#endif
+
+struct walk_dir {
+    struct walk_dir        *parent;
+    int                     fd;
+#if WALK_USE_GETDENTS64
+    char                   *buf;
+    size_t                  len;
+    size_t                  pos;
+#else
+    DIR                    *dirp;
+#endif
+    /* the length of the relative path of this directory in walker->path,
+       including the trailing '/' */
+    size_t                  prefix_len;
+};
+
+struct fs_walker {
+    struct walk_dir        *top;        // the innermost open directory
+    struct wildcard_list   *wildcards;
+    char                   *fields;     // the fields for make_object_from_stat
+    size_t                  fields_len;
+    unsigned int            stat_mask;  // the mask for statx(2)
+    bool                    need_stat;
+    bool                    want_type;
+    bool                    all_fields;
+    bool                    recursive;
+    char                    path[PATH_MAX + 1];
+};
+
+static void free_wildcard_list(struct wildcard_list *wildcard)
+{
+    while (wildcard) {
+        struct wildcard_list *next = wildcard->next;
+        free(wildcard->wildcard);
+        free(wildcard);
+        wildcard = next;
+    }
+}
+
+/* makes the list of the wildcards separated by ';' */
+static bool make_wildcard_list(const char *filter, struct wildcard_list **list)
+{
+    struct wildcard_list **tail = list;
+    size_t length = 0;
+    const char *head = pcutils_get_next_token(filter, ";", &length);
+
+    *list = NULL;
+    while (head) {
+        struct wildcard_list *node = calloc(1, sizeof(*node));
+        if (node == NULL || (node->wildcard = strndup(head, length)) == NULL) {
+            free(node);
+            free_wildcard_list(*list);
+            *list = NULL;
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        pcdvobjs_remove_space(node->wildcard);
+        if (node->wildcard[0]) {
+            *tail = node;
+            tail = &node->next;
+        }
+        else {
+            free_wildcard_list(node);
+        }
+
+        head = pcutils_get_next_token(head + length + 1, ";", &length);
+    }
+
+    return true;
+}
+
+static bool match_wildcard_list(struct wildcard_list *wildcard,
+        const char *name)
+{
+    if (wildcard == NULL)
+        return true;
+
+    for (; wildcard; wildcard = wildcard->next) {
+        if (wildcard_cmp(name, wildcard->wildcard))
+            return true;
+    }
+
+    return false;
+}
+
+/* parses the options of $FS.walk(), and determines what to stat */
+static bool walker_parse_options(struct fs_walker *walker,
+        const char *options, size_t options_len)
+{
+    const char *all_options = options;
+    size_t all_options_len = options_len;
+
+    static const struct {
+        const char     *field;
+        unsigned int    mask;
+    } fields[] = {
+#if WALK_USE_STATX
+        { "dev",            0 },
+        { "inode",          STATX_INO },
+        { "mode_digits",    STATX_MODE },
+        { "mode_alphas",    STATX_MODE },
+        { "nlink",          STATX_NLINK },
+        { "uid",            STATX_UID },
+        { "gid",            STATX_GID },
+        { "rdev",           0 },
+        { "size",           STATX_SIZE },
+        { "blksize",        0 },
+        { "blocks",         STATX_BLOCKS },
+        { "atime",          STATX_ATIME },
+        { "mtime",          STATX_MTIME },
+        { "ctime",          STATX_CTIME },
+#else
+        { "dev",            0 }, { "inode",        0 },
+        { "mode_digits",    0 }, { "mode_alphas",  0 },
+        { "nlink",          0 }, { "uid",          0 },
+        { "gid",            0 }, { "rdev",         0 },
+        { "size",           0 }, { "blksize",      0 },
+        { "blocks",         0 }, { "atime",        0 },
+        { "mtime",          0 }, { "ctime",        0 },
+#endif
+    };
+
+    size_t opt_len = 0;
+    const char *opt = pcutils_get_next_token_len(options, options_len,
+            _KW_DELIMITERS, &opt_len);
+    while (opt) {
+        if (opt_len == 9 && strncasecmp(opt, "recursive", opt_len) == 0) {
+            walker->recursive = true;
+        }
+        else if (opt_len == 4 && strncasecmp(opt, "type", opt_len) == 0) {
+            walker->want_type = true;
+        }
+        else if (opt_len == 3 && strncasecmp(opt, "all", opt_len) == 0) {
+            walker->want_type = true;
+            walker->need_stat = true;
+            walker->all_fields = true;
+        }
+        else {
+            size_t i;
+            for (i = 0; i < PCA_TABLESIZE(fields); i++) {
+                if (strlen(fields[i].field) == opt_len &&
+                        strncasecmp(opt, fields[i].field, opt_len) == 0)
+                    break;
+            }
+
+            if (i == PCA_TABLESIZE(fields)) {
+                purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
+                        "unknown option: %.*s", (int)opt_len, opt);
+                return false;
+            }
+
+            walker->need_stat = true;
+            walker->stat_mask |= fields[i].mask;
+        }
+
+        options_len -= opt + opt_len - options;
+        options = opt + opt_len;
+        opt = pcutils_get_next_token_len(options, options_len,
+                _KW_DELIMITERS, &opt_len);
+    }
+
+    /* NOTE: make_object_from_stat() ignores `recursive` */
+    if (walker->all_fields) {
+        walker->fields = strdup("dev inode type mode_digits mode_alphas nlink "
+                "uid gid size rdev blksize blocks atime ctime mtime");
+    }
+    else {
+        walker->fields = strndup(all_options, all_options_len);
+    }
+
+    if (walker->fields == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    walker->fields_len = strlen(walker->fields);
+    return true;
+}
+
+static void walker_pop_dir(struct fs_walker *walker)
+{
+    struct walk_dir *dir = walker->top;
+
+    walker->top = dir->parent;
+#if WALK_USE_GETDENTS64
+    close(dir->fd);
+    free(dir->buf);
+#else
+    closedir(dir->dirp);
+#endif
+    free(dir);
+}
+
+static bool walker_push_dir(struct fs_walker *walker, int fd,
+        size_t prefix_len)
+{
+    struct walk_dir *dir = calloc(1, sizeof(*dir));
+    if (dir == NULL) {
+        close(fd);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    dir->fd = fd;
+#if WALK_USE_GETDENTS64
+    dir->buf = malloc(WALK_DIRENT_BUF_SIZE);
+    if (dir->buf == NULL) {
+        close(fd);
+        free(dir);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+#else
+    dir->dirp = fdopendir(fd);
+    if (dir->dirp == NULL) {
+        close(fd);
+        free(dir);
+        set_purc_error_by_errno();
+        return false;
+    }
+#endif
+
+    dir->prefix_len = prefix_len;
+    dir->parent = walker->top;
+    walker->top = dir;
+    return true;
+}
+
+/* reads the next entry; returns 1 if got one, 0 at the end, -1 if failed */
+static int walk_dir_read(struct walk_dir *dir, const char **name,
+        unsigned char *type)
+{
+#if WALK_USE_GETDENTS64
+    if (dir->pos >= dir->len) {
+        long n = syscall(SYS_getdents64, dir->fd, dir->buf,
+                WALK_DIRENT_BUF_SIZE);
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            return 0;
+        dir->len = (size_t)n;
+        dir->pos = 0;
+    }
+
+    struct walk_dirent64 *ent = (struct walk_dirent64 *)(dir->buf + dir->pos);
+    dir->pos += ent->d_reclen;
+    *name = ent->d_name;
+    *type = ent->d_type;
+#else
+    errno = 0;
+    struct dirent *ent = readdir(dir->dirp);
+    if (ent == NULL)
+        return errno ? -1 : 0;
+    *name = ent->d_name;
+    *type = ent->d_type;
+#endif
+    return 1;
+}
+
+static int walk_stat(struct fs_walker *walker, int dirfd, const char *name,
+        struct stat *st)
+{
+#if WALK_USE_STATX
+    struct statx stx;
+    unsigned int mask = walker->all_fields ? STATX_BASIC_STATS :
+        (walker->stat_mask | STATX_TYPE);
+    if (statx(dirfd, name, AT_SYMLINK_NOFOLLOW, mask, &stx))
+        return -1;
+
+    memset(st, 0, sizeof(*st));
+    st->st_dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+    st->st_ino = stx.stx_ino;
+    st->st_mode = stx.stx_mode;
+    st->st_nlink = stx.stx_nlink;
+    st->st_uid = stx.stx_uid;
+    st->st_gid = stx.stx_gid;
+    st->st_rdev = makedev(stx.stx_rdev_major, stx.stx_rdev_minor);
+    st->st_size = stx.stx_size;
+    st->st_blksize = stx.stx_blksize;
+    st->st_blocks = stx.stx_blocks;
+    st->st_atim.tv_sec = stx.stx_atime.tv_sec;
+    st->st_atim.tv_nsec = stx.stx_atime.tv_nsec;
+    st->st_mtim.tv_sec = stx.stx_mtime.tv_sec;
+    st->st_mtim.tv_nsec = stx.stx_mtime.tv_nsec;
+    st->st_ctim.tv_sec = stx.stx_ctime.tv_sec;
+    st->st_ctim.tv_nsec = stx.stx_ctime.tv_nsec;
+    return 0;
+#else
+    UNUSED_PARAM(walker);
+    return fstatat(dirfd, name, st, AT_SYMLINK_NOFOLLOW);
+#endif
+}
+
+static const char *type_of_dirent(unsigned char d_type)
+{
+    switch (d_type) {
+        case DT_BLK:  return "b";
+        case DT_CHR:  return "c";
+        case DT_DIR:  return "d";
+        case DT_FIFO: return "p";
+        case DT_LNK:  return "l";
+        case DT_REG:  return "-";
+        case DT_SOCK: return "s";
+        default:      break;
+    }
+
+    return "X";
+}
+
+static purc_variant_t
+walker_make_entry(struct fs_walker *walker, const char *name,
+        unsigned char d_type, const struct stat *st)
+{
+    purc_variant_t retv, val = PURC_VARIANT_INVALID;
+
+    if (st) {
+        retv = make_object_from_stat(st, walker->fields, walker->fields_len);
+    }
+    else {
+        retv = purc_variant_make_object_0();
+        if (retv && walker->want_type) {
+            val = purc_variant_make_string_static(type_of_dirent(d_type),
+                    false);
+            if (val == PURC_VARIANT_INVALID ||
+                    !purc_variant_object_set_by_static_ckey(retv, "type", val))
+                goto failed;
+            purc_variant_unref(val);
+        }
+    }
+
+    if (retv == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    val = purc_variant_make_string(name, false);
+    if (val == PURC_VARIANT_INVALID ||
+            !purc_variant_object_set_by_static_ckey(retv, "name", val))
+        goto failed;
+    purc_variant_unref(val);
+
+    val = purc_variant_make_string(walker->path, false);
+    if (val == PURC_VARIANT_INVALID ||
+            !purc_variant_object_set_by_static_ckey(retv, "path", val))
+        goto failed;
+    purc_variant_unref(val);
+
+    return retv;
+
+failed:
+    if (val)
+        purc_variant_unref(val);
+    purc_variant_unref(retv);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+on_walker_next(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t* argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    struct fs_walker *walker = native_entity;
+
+    while (walker->top) {
+        struct walk_dir *dir = walker->top;
+        const char *name;
+        unsigned char d_type;
+
+        int r = walk_dir_read(dir, &name, &d_type);
+        if (r < 0) {
+            set_purc_error_by_errno();
+            goto failed;
+        }
+        else if (r == 0) {
+            walker_pop_dir(walker);
+            continue;
+        }
+
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+            continue;
+
+        size_t name_len = strlen(name);
+        if (dir->prefix_len + name_len >= sizeof(walker->path)) {
+            purc_set_error(PURC_ERROR_TOO_LONG);
+            goto failed;
+        }
+        memcpy(walker->path + dir->prefix_len, name, name_len + 1);
+
+        bool matched = match_wildcard_list(walker->wildcards, name);
+        bool descend = walker->recursive && d_type == DT_DIR;
+
+        struct stat st, *pst = NULL;
+        if ((matched && (walker->need_stat ||
+                        (walker->want_type && d_type == DT_UNKNOWN))) ||
+                (walker->recursive && d_type == DT_UNKNOWN)) {
+            if (walk_stat(walker, dir->fd, name, &st)) {
+                /* NOTE: the entry may be removed after it was read */
+                continue;
+            }
+
+            pst = &st;
+            if (d_type == DT_UNKNOWN)
+                d_type = IFTODT(st.st_mode);
+            descend = walker->recursive && S_ISDIR(st.st_mode);
+        }
+
+        purc_variant_t retv = PURC_VARIANT_INVALID;
+        if (matched) {
+            retv = walker_make_entry(walker, name, d_type,
+                    walker->need_stat ? pst : NULL);
+            if (retv == PURC_VARIANT_INVALID)
+                goto failed;
+        }
+
+        if (descend && dir->prefix_len + name_len + 1 < sizeof(walker->path)) {
+            /* NOTE: symbolic links are not followed to avoid loops */
+            int fd = openat(dir->fd, name,
+                    O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (fd >= 0) {
+                walker->path[dir->prefix_len + name_len] = '/';
+                walker->path[dir->prefix_len + name_len + 1] = '\0';
+                if (!walker_push_dir(walker, fd,
+                            dir->prefix_len + name_len + 1)) {
+                    if (retv)
+                        purc_variant_unref(retv);
+                    goto failed;
+                }
+            }
+        }
+
+        if (retv)
+            return retv;
+    }
+
+    return purc_variant_make_null();
+
+failed:
+    /* NOTE: not false, which would be taken as an entry by `iterate` */
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_undefined();
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_nvariant_method
+walker_property_getter(void* native_entity, const char* key_name)
+{
+    UNUSED_PARAM(native_entity);
+
+    if (key_name && (strcmp(key_name, PURC_NATIVE_PROP_NEXT) == 0 ||
+                strcmp(key_name, "next") == 0)) {
+        return on_walker_next;
+    }
+
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+}
+
+static void
+walker_on_release(void *native_entity)
+{
+    struct fs_walker *walker = native_entity;
+
+    while (walker->top)
+        walker_pop_dir(walker);
+    free_wildcard_list(walker->wildcards);
+    free(walker->fields);
+    free(walker);
+}
+
+static purc_variant_t
+walk_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+
+    static const struct purc_native_ops ops = {
+        .property_getter = walker_property_getter,
+        .on_release = walker_on_release,
+    };
+
+    struct fs_walker *walker = NULL;
+    purc_variant_t retv;
+
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto failed;
+    }
+
+    const char *pathname = purc_variant_get_string_const(argv[0]);
+    if (NULL == pathname) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        goto failed;
+    }
+
+    const char *filter = NULL;
+    if (nr_args > 1 && !purc_variant_is_null(argv[1])) {
+        filter = purc_variant_get_string_const(argv[1]);
+        if (NULL == filter) {
+            purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+            goto failed;
+        }
+    }
+
+    const char *options = WALK_DEF_OPTIONS;
+    size_t options_len = sizeof(WALK_DEF_OPTIONS) - 1;
+    if (nr_args > 2) {
+        options = purc_variant_get_string_const_ex(argv[2], &options_len);
+        if (NULL == options) {
+            purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+            goto failed;
+        }
+    }
+
+    walker = calloc(1, sizeof(*walker));
+    if (walker == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    if (!walker_parse_options(walker, options, options_len))
+        goto failed;
+
+    if (filter && !make_wildcard_list(filter, &walker->wildcards))
+        goto failed;
+
+    int fd = open(pathname, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        set_purc_error_by_errno();
+        goto failed;
+    }
+
+    if (!walker_push_dir(walker, fd, 0))
+        goto failed;
+
+    retv = purc_variant_make_native_entity(walker, &ops, "fsWalker");
+    if (retv == PURC_VARIANT_INVALID)
+        goto failed;
+
+    return retv;
+
+failed:
+    if (walker)
+        walker_on_release(walker);
+
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t pcdvobjs_create_fs(void)
 {
     static struct purc_dvobj_method method [] = {
@@ -3723,7 +4459,8 @@ static purc_variant_t pcdvobjs_create_fs(void)
         {"rm",            rm_getter, NULL},// beyond documentation
         {"file_contents", file_contents_getter, file_contents_setter},
         {"opendir",       opendir_getter, NULL},
-        {"closedir",      closedir_getter, NULL}
+        {"closedir",      closedir_getter, NULL},
+        {"walk",          walk_getter, NULL},
     };
 
     return purc_dvobj_make_from_methods (method, PCA_TABLESIZE(method));
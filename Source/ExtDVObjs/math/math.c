@@ -31,6 +31,8 @@
 #include "mathlib.h"
 
 #include <strings.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #ifndef __USE_GNU
 #define __USE_GNU                       /* for M_PIl when using glibc */
@@ -138,6 +140,254 @@ struct const_struct {
         return PURC_VARIANT_INVALID; \
     }
 
+/*
+ * The element-wise operations on arrays (or tuples) of numbers.
+ *
+ * The numbers are loaded into a plain vector of double first; the elements
+ * of a packed array of numbers are used in place without boxing. So the
+ * loops run over contiguous doubles and can be vectorized by the compiler.
+ * The result is a packed array of numbers.
+ */
+struct num_vector {
+    const double   *v;
+    size_t          n;
+    double         *buf;    /* not NULL if allocated */
+};
+
+static inline bool
+is_num_vector(purc_variant_t x)
+{
+    return x != PURC_VARIANT_INVALID &&
+        (purc_variant_is_array(x) || purc_variant_is_tuple(x));
+}
+
+static bool
+load_num_vector(purc_variant_t x, struct num_vector *vec)
+{
+    pcvrnt_packed_type_k type = PCVRNT_PACKED_NONE;
+    const void *packed = NULL;
+    size_t n = 0;
+
+    vec->buf = NULL;
+    if (purc_variant_is_array(x))
+        packed = purc_variant_array_get_packed(x, &type, &n);
+
+    if (packed && type == PCVRNT_PACKED_NUMBER) {
+        vec->v = packed;
+        vec->n = n;
+        return true;
+    }
+
+    if (packed == NULL && !purc_variant_linear_container_size(x, &n)) {
+        purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
+        return false;
+    }
+
+    vec->buf = malloc(sizeof(double) * (n ? n : 1));
+    if (vec->buf == NULL) {
+        purc_set_error (PURC_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    if (packed && type == PCVRNT_PACKED_LONGINT) {
+        const int64_t *i64 = packed;
+        for (size_t i = 0; i < n; i++)
+            vec->buf[i] = (double)i64[i];
+    }
+    else if (packed && type == PCVRNT_PACKED_ULONGINT) {
+        const uint64_t *u64 = packed;
+        for (size_t i = 0; i < n; i++)
+            vec->buf[i] = (double)u64[i];
+    }
+    else {
+        for (size_t i = 0; i < n; i++) {
+            purc_variant_t v = purc_variant_linear_container_get(x, i);
+            if (v == PURC_VARIANT_INVALID ||
+                    !(purc_variant_is_type (v, PURC_VARIANT_TYPE_NUMBER) ||
+                      purc_variant_is_type (v, PURC_VARIANT_TYPE_LONGINT) ||
+                      purc_variant_is_type (v, PURC_VARIANT_TYPE_ULONGINT) ||
+                      purc_variant_is_type (v, PURC_VARIANT_TYPE_LONGDOUBLE))) {
+                free(vec->buf);
+                vec->buf = NULL;
+                purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
+                return false;
+            }
+            purc_variant_cast_to_number (v, vec->buf + i, false);
+        }
+    }
+
+    vec->v = vec->buf;
+    vec->n = n;
+    return true;
+}
+
+/* loads a vector or a number which will be broadcast to the vector */
+static bool
+load_num_vector_or_scalar(purc_variant_t x, struct num_vector *vec,
+        double *scalar)
+{
+    if (is_num_vector(x))
+        return load_num_vector(x, vec);
+
+    if ((x == PURC_VARIANT_INVALID) ||
+            !(purc_variant_is_type (x, PURC_VARIANT_TYPE_NUMBER)  ||
+              purc_variant_is_type (x, PURC_VARIANT_TYPE_LONGINT) ||
+              purc_variant_is_type (x, PURC_VARIANT_TYPE_ULONGINT) ||
+              purc_variant_is_type (x, PURC_VARIANT_TYPE_LONGDOUBLE))) {
+        purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
+        return false;
+    }
+
+    purc_variant_cast_to_number (x, scalar, false);
+    vec->v = scalar;
+    vec->n = 1;
+    vec->buf = NULL;
+    return true;
+}
+
+static inline void
+free_num_vector(struct num_vector *vec)
+{
+    if (vec->buf)
+        free(vec->buf);
+}
+
+/* checks the floating-point exceptions like GET_EXCEPTION, then makes
+   a packed array of the numbers and frees them */
+static purc_variant_t
+make_num_vector(double *r, size_t n)
+{
+    int err = PURC_ERROR_OK;
+
+    for (size_t i = 0; i < n; i++) {
+        if (isnan (r[i])) {
+            err = PURC_ERROR_INVALID_FLOAT;
+            break;
+        }
+    }
+
+    if (err == PURC_ERROR_OK) {
+        if (fetestexcept (FE_DIVBYZERO))
+            err = PURC_ERROR_DIVBYZERO;
+        else if (fetestexcept (FE_OVERFLOW))
+            err = PURC_ERROR_OVERFLOW;
+        else if (fetestexcept (FE_UNDERFLOW))
+            err = PURC_ERROR_UNDERFLOW;
+        else if (fetestexcept (FE_INVALID))
+            err = PURC_ERROR_INVALID_FLOAT;
+    }
+
+    purc_variant_t ret_var = PURC_VARIANT_INVALID;
+    if (err)
+        purc_set_error (err);
+    else
+        ret_var = purc_variant_make_packed_array (PCVRNT_PACKED_NUMBER, r, n);
+
+    free(r);
+    return ret_var;
+}
+
+static purc_variant_t
+map_unary(purc_variant_t x, double (*f)(double))
+{
+    struct num_vector a;
+    if (!load_num_vector(x, &a))
+        return PURC_VARIANT_INVALID;
+
+    double *r = malloc(sizeof(double) * (a.n ? a.n : 1));
+    if (r == NULL) {
+        free_num_vector(&a);
+        purc_set_error (PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    feclearexcept(FE_ALL_EXCEPT);
+    for (size_t i = 0; i < a.n; i++)
+        r[i] = f(a.v[i]);
+
+    free_num_vector(&a);
+    return make_num_vector(r, a.n);
+}
+
+enum {
+    VEC_OP_ADD,
+    VEC_OP_SUB,
+    VEC_OP_MUL,
+    VEC_OP_DIV,
+    VEC_OP_FUNC,
+};
+
+/* NOTE: a stride of zero broadcasts a number to the vector */
+#define VEC_LOOP(expr) do {                                             \
+        for (size_t i = 0; i < n; i++) {                                \
+            double p = a.v[i * sa], q = b.v[i * sb];                    \
+            r[i] = expr;                                                \
+        }                                                               \
+    } while (0)
+
+static purc_variant_t
+map_binary(purc_variant_t x, purc_variant_t y, int op,
+        double (*f)(double, double))
+{
+    struct num_vector a, b;
+    double sa_scalar, sb_scalar;
+
+    if (!load_num_vector_or_scalar(x, &a, &sa_scalar))
+        return PURC_VARIANT_INVALID;
+    if (!load_num_vector_or_scalar(y, &b, &sb_scalar)) {
+        free_num_vector(&a);
+        return PURC_VARIANT_INVALID;
+    }
+
+    size_t sa = (a.v == &sa_scalar) ? 0 : 1;
+    size_t sb = (b.v == &sb_scalar) ? 0 : 1;
+    size_t n = sa ? a.n : b.n;
+    double *r = NULL;
+
+    if (sa && sb && a.n != b.n) {
+        purc_set_error (PURC_ERROR_INVALID_VALUE);
+        goto done;
+    }
+
+    r = malloc(sizeof(double) * (n ? n : 1));
+    if (r == NULL) {
+        purc_set_error (PURC_ERROR_OUT_OF_MEMORY);
+        goto done;
+    }
+
+    feclearexcept(FE_ALL_EXCEPT);
+    switch (op) {
+    case VEC_OP_ADD:
+        VEC_LOOP(p + q);
+        break;
+    case VEC_OP_SUB:
+        VEC_LOOP(p - q);
+        break;
+    case VEC_OP_MUL:
+        VEC_LOOP(p * q);
+        break;
+    case VEC_OP_DIV:
+        VEC_LOOP(p / q);
+        break;
+    default:
+        VEC_LOOP(f(p, q));
+        break;
+    }
+
+done:
+    free_num_vector(&a);
+    free_num_vector(&b);
+    return r ? make_num_vector(r, n) : PURC_VARIANT_INVALID;
+}
+
+#define MAP_IF_VECTOR(x, f) \
+    if (is_num_vector (x)) \
+        return map_unary (x, f);
+
+#define MAP_IF_VECTORS(x, y, op, f) \
+    if (is_num_vector (x) || is_num_vector (y)) \
+        return map_binary (x, y, op, f);
+
 static purc_variant_t
 pi_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -395,6 +645,7 @@ add_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     long double number2 = 0.0;
 
     GET_PARAM_NUMBER(2);
+    MAP_IF_VECTORS (argv[0], argv[1], VEC_OP_ADD, NULL);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
     GET_VARIANT_NUMBER_TYPE (argv[1]);
 
@@ -439,6 +690,7 @@ sub_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     long double number2 = 0.0;
 
     GET_PARAM_NUMBER(2);
+    MAP_IF_VECTORS (argv[0], argv[1], VEC_OP_SUB, NULL);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
     GET_VARIANT_NUMBER_TYPE (argv[1]);
 
@@ -483,6 +735,7 @@ mul_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     long double number2 = 0.0;
 
     GET_PARAM_NUMBER(2);
+    MAP_IF_VECTORS (argv[0], argv[1], VEC_OP_MUL, NULL);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
     GET_VARIANT_NUMBER_TYPE (argv[1]);
 
@@ -527,6 +780,7 @@ div_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     long double number2 = 0.0;
 
     GET_PARAM_NUMBER(2);
+    MAP_IF_VECTORS (argv[0], argv[1], VEC_OP_DIV, NULL);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
     GET_VARIANT_NUMBER_TYPE (argv[1]);
 
@@ -559,6 +813,193 @@ div_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 }
 
 
+/* NOTE: four partial results let the compiler vectorize the reductions
+   without reordering the additions itself */
+static double
+sum_vector(const double *v, size_t n)
+{
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        s0 += v[i];
+        s1 += v[i + 1];
+        s2 += v[i + 2];
+        s3 += v[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += v[i];
+
+    return (s0 + s1) + (s2 + s3);
+}
+
+static double
+dot_vectors(const double *a, const double *b, size_t n)
+{
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += a[i] * b[i];
+
+    return (s0 + s1) + (s2 + s3);
+}
+
+static double
+min_vector(const double *v, size_t n)
+{
+    double m = v[0];
+    for (size_t i = 1; i < n; i++)
+        m = (v[i] < m) ? v[i] : m;
+    return m;
+}
+
+static double
+max_vector(const double *v, size_t n)
+{
+    double m = v[0];
+    for (size_t i = 1; i < n; i++)
+        m = (v[i] > m) ? v[i] : m;
+    return m;
+}
+
+enum {
+    VEC_REDUCE_SUM,
+    VEC_REDUCE_MEAN,
+    VEC_REDUCE_MIN,
+    VEC_REDUCE_MAX,
+};
+
+static purc_variant_t
+reduce_vector(size_t nr_args, purc_variant_t *argv, int op)
+{
+    purc_variant_t ret_var = PURC_VARIANT_INVALID;
+    struct num_vector a;
+    double number = 0.0;
+
+    GET_PARAM_NUMBER(1);
+    if (!is_num_vector (argv[0])) {
+        purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (!load_num_vector (argv[0], &a))
+        return PURC_VARIANT_INVALID;
+
+    if (a.n == 0 && op != VEC_REDUCE_SUM) {
+        free_num_vector (&a);
+        purc_set_error (PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    feclearexcept(FE_ALL_EXCEPT);
+    switch (op) {
+    case VEC_REDUCE_SUM:
+        number = sum_vector (a.v, a.n);
+        break;
+    case VEC_REDUCE_MEAN:
+        number = sum_vector (a.v, a.n) / a.n;
+        break;
+    case VEC_REDUCE_MIN:
+        number = min_vector (a.v, a.n);
+        break;
+    case VEC_REDUCE_MAX:
+        number = max_vector (a.v, a.n);
+        break;
+    }
+
+    free_num_vector (&a);
+    GET_EXCEPTION_OR_CREATE_VARIANT(number, 0);
+    return ret_var;
+}
+
+static purc_variant_t
+sum_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(call_flags);
+
+    return reduce_vector (nr_args, argv, VEC_REDUCE_SUM);
+}
+
+static purc_variant_t
+mean_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(call_flags);
+
+    return reduce_vector (nr_args, argv, VEC_REDUCE_MEAN);
+}
+
+static purc_variant_t
+min_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(call_flags);
+
+    return reduce_vector (nr_args, argv, VEC_REDUCE_MIN);
+}
+
+static purc_variant_t
+max_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(call_flags);
+
+    return reduce_vector (nr_args, argv, VEC_REDUCE_MAX);
+}
+
+static purc_variant_t
+dot_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(call_flags);
+
+    purc_variant_t ret_var = PURC_VARIANT_INVALID;
+    struct num_vector a, b;
+    double number;
+
+    GET_PARAM_NUMBER(2);
+    if (!is_num_vector (argv[0]) || !is_num_vector (argv[1])) {
+        purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (!load_num_vector (argv[0], &a))
+        return PURC_VARIANT_INVALID;
+    if (!load_num_vector (argv[1], &b)) {
+        free_num_vector (&a);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (a.n != b.n) {
+        free_num_vector (&a);
+        free_num_vector (&b);
+        purc_set_error (PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    feclearexcept(FE_ALL_EXCEPT);
+    number = dot_vectors (a.v, b.v, a.n);
+    free_num_vector (&a);
+    free_num_vector (&b);
+
+    GET_EXCEPTION_OR_CREATE_VARIANT(number, 0);
+    return ret_var;
+}
+
+
 static purc_variant_t
 sin_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -570,6 +1011,7 @@ sin_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], sin);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -591,6 +1033,7 @@ cos_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], cos);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -611,6 +1054,7 @@ tan_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], tan);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -631,6 +1075,7 @@ sinh_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], sinh);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -652,6 +1097,7 @@ cosh_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], cosh);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -672,6 +1118,7 @@ tanh_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], tanh);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -692,6 +1139,7 @@ asin_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], asin);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -714,6 +1162,7 @@ acos_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], acos);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -735,6 +1184,7 @@ atan_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], atan);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -757,6 +1207,7 @@ asinh_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], asinh);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -779,6 +1230,7 @@ acosh_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], acosh);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -800,6 +1252,7 @@ atanh_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], atanh);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -1076,6 +1529,7 @@ sqrt_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], sqrt);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -1118,6 +1572,7 @@ fmod_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number2 = 0.0;
 
     GET_PARAM_NUMBER(2);
+    MAP_IF_VECTORS (argv[0], argv[1], VEC_OP_FUNC, fmod);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
     GET_VARIANT_NUMBER_TYPE (argv[1]);
 
@@ -1164,6 +1619,7 @@ fabs_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     purc_variant_t ret_var = PURC_VARIANT_INVALID;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], fabs);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     int type = purc_variant_get_type (argv[0]);
@@ -1211,6 +1667,7 @@ log_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], log);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -1253,6 +1710,7 @@ log10_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], log10);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -1296,6 +1754,7 @@ pow_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number2 = 0.0;
 
     GET_PARAM_NUMBER(2);
+    MAP_IF_VECTORS (argv[0], argv[1], VEC_OP_FUNC, pow);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
     GET_VARIANT_NUMBER_TYPE (argv[1]);
 
@@ -1343,6 +1802,7 @@ exp_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], exp);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -1385,6 +1845,7 @@ floor_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], floor);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -1427,6 +1888,7 @@ ceil_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     double number = 0.0;
 
     GET_PARAM_NUMBER(1);
+    MAP_IF_VECTOR (argv[0], ceil);
     GET_VARIANT_NUMBER_TYPE (argv[0]);
 
     purc_variant_cast_to_number (argv[0], &number, false);
@@ -1458,6 +1920,137 @@ ceil_l_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     return ret_var;
 }
 
+/*
+ * The compiled expressions cached by the text, so an expression evaluated
+ * again and again is parsed only once. The cache is shared by all instances
+ * in the process; an entry is released when it is replaced or when the last
+ * compiled expression entity using it is released.
+ */
+struct cached_prog {
+    atomic_uint     refc;
+    bool            is_long_double;
+    void           *prog;
+    size_t          hash;
+    char            text[0];
+};
+
+#define NR_CACHED_PROGS     128
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct cached_prog *cached_progs[NR_CACHED_PROGS];
+
+static size_t
+hash_text(const char *text, size_t len)
+{
+    /* FNV-1a */
+    size_t hash = 0x811c9dc5;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 0x01000193;
+    }
+
+    return hash;
+}
+
+static void
+unref_cached_prog(struct cached_prog *cp)
+{
+    if (atomic_fetch_sub(&cp->refc, 1) == 1) {
+        if (cp->is_long_double)
+            math_prog_free_l(cp->prog);
+        else
+            math_prog_free(cp->prog);
+        free(cp);
+    }
+}
+
+static struct cached_prog *
+get_cached_prog(bool is_long_double, const char *text)
+{
+    size_t len = strlen(text);
+    size_t hash = hash_text(text, len);
+    hash = hash * 2 + (is_long_double ? 1 : 0);
+
+    struct cached_prog **slot = cached_progs + hash % NR_CACHED_PROGS;
+    struct cached_prog *cp;
+
+    pthread_mutex_lock(&cache_lock);
+    cp = *slot;
+    if (cp && cp->hash == hash && strcmp(cp->text, text) == 0) {
+        atomic_fetch_add(&cp->refc, 1);
+        pthread_mutex_unlock(&cache_lock);
+        return cp;
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    /* NOTE: compile the expression out of the lock */
+    void *prog;
+    if (is_long_double)
+        prog = math_compile_l(text);
+    else
+        prog = math_compile(text);
+    if (prog == NULL)
+        return NULL;
+
+    cp = malloc(sizeof(*cp) + len + 1);
+    if (cp == NULL) {
+        if (is_long_double)
+            math_prog_free_l(prog);
+        else
+            math_prog_free(prog);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    /* one reference for the cache, and one for the caller */
+    atomic_init(&cp->refc, 2);
+    cp->is_long_double = is_long_double;
+    cp->prog = prog;
+    cp->hash = hash;
+    memcpy(cp->text, text, len + 1);
+
+    pthread_mutex_lock(&cache_lock);
+    struct cached_prog *old = *slot;
+    *slot = cp;
+    pthread_mutex_unlock(&cache_lock);
+
+    if (old)
+        unref_cached_prog(old);
+    return cp;
+}
+
+static void
+clear_cached_progs(void)
+{
+    pthread_mutex_lock(&cache_lock);
+    for (size_t i = 0; i < NR_CACHED_PROGS; i++) {
+        if (cached_progs[i]) {
+            unref_cached_prog(cached_progs[i]);
+            cached_progs[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+static purc_variant_t
+exec_cached_prog(struct cached_prog *cp, purc_variant_t param)
+{
+    if (!cp->is_long_double) {
+        double v = 0;
+        int r = math_exec(cp->prog, &v, param);
+        if (r)
+            return PURC_VARIANT_INVALID;
+        return purc_variant_make_number(v);
+    }
+    else {
+        long double v = 0;
+        int r = math_exec_l(cp->prog, &v, param);
+        if (r)
+            return PURC_VARIANT_INVALID;
+        return purc_variant_make_longdouble(v);
+    }
+}
+
 static purc_variant_t
 internal_eval_getter (int is_long_double, purc_variant_t root,
     size_t nr_args, purc_variant_t *argv, bool silently)
@@ -1484,20 +2077,142 @@ internal_eval_getter (int is_long_double, purc_variant_t root,
 
     purc_variant_t param = nr_args >=2 ? argv[1] : PURC_VARIANT_INVALID;
 
-    if (!is_long_double) {
-        double v = 0;
-        int r = math_eval(input, &v, param);
-        if (r)
+    struct cached_prog *cp = get_cached_prog(is_long_double, input);
+    if (cp == NULL)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t ret = exec_cached_prog(cp, param);
+    unref_cached_prog(cp);
+    return ret;
+}
+
+static purc_variant_t
+compiled_eval_getter (void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+    UNUSED_PARAM(call_flags);
+
+    struct cached_prog *cp = native_entity;
+    purc_variant_t param = PURC_VARIANT_INVALID;
+
+    if (nr_args > 0) {
+        param = argv[0];
+        if (param == PURC_VARIANT_INVALID ||
+                !(purc_variant_is_object(param) ||
+                    purc_variant_is_array(param))) {
+            purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
             return PURC_VARIANT_INVALID;
-        return purc_variant_make_number(v);
+        }
     }
-    else {
-        long double v = 0;
-        int r = math_eval_l(input, &v, param);
-        if (r)
+
+    return exec_cached_prog(cp, param);
+}
+
+static purc_variant_t
+compiled_vars_getter (void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+    UNUSED_PARAM(call_flags);
+
+    struct cached_prog *cp = native_entity;
+    purc_variant_t ret = purc_variant_make_array_0();
+    if (ret == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    for (size_t i = 0; ; i++) {
+        const char *var;
+        if (cp->is_long_double)
+            var = math_prog_var_l(cp->prog, i);
+        else
+            var = math_prog_var(cp->prog, i);
+        if (var == NULL)
+            break;
+
+        purc_variant_t name = purc_variant_make_string(var, false);
+        if (name == PURC_VARIANT_INVALID ||
+                !purc_variant_array_append(ret, name)) {
+            if (name)
+                purc_variant_unref(name);
+            purc_variant_unref(ret);
             return PURC_VARIANT_INVALID;
-        return purc_variant_make_longdouble(v);
+        }
+        purc_variant_unref(name);
+    }
+
+    return ret;
+}
+
+static purc_nvariant_method
+compiled_property_getter (void *native_entity, const char *property_name)
+{
+    UNUSED_PARAM(native_entity);
+
+    if (property_name == NULL || strcmp(property_name, "eval") == 0)
+        return compiled_eval_getter;
+    else if (strcmp(property_name, "vars") == 0)
+        return compiled_vars_getter;
+
+    purc_set_error (PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+}
+
+static void
+compiled_on_release (void *native_entity)
+{
+    unref_cached_prog(native_entity);
+}
+
+static purc_variant_t
+internal_compile_getter (int is_long_double, size_t nr_args,
+        purc_variant_t *argv)
+{
+    static struct purc_native_ops compiled_ops = {
+        .property_getter = compiled_property_getter,
+        .on_release = compiled_on_release,
+    };
+
+    if (nr_args < 1) {
+        purc_set_error (PURC_ERROR_ARGUMENT_MISSED);
+        return PURC_VARIANT_INVALID;
+    }
+
+    const char *input = purc_variant_get_string_const(argv[0]);
+    if (!input) {
+        purc_set_error (PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
     }
+
+    struct cached_prog *cp = get_cached_prog(is_long_double, input);
+    if (cp == NULL)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t ret;
+    ret = purc_variant_make_native_entity(cp, &compiled_ops, "mathExpression");
+    if (ret == PURC_VARIANT_INVALID)
+        unref_cached_prog(cp);
+    return ret;
+}
+
+static purc_variant_t
+compile_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(call_flags);
+    return internal_compile_getter(0, nr_args, argv);
+}
+
+static purc_variant_t
+compile_l_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(call_flags);
+    return internal_compile_getter(1, nr_args, argv);
 }
 
 static purc_variant_t
@@ -1549,6 +2264,8 @@ void __attribute__ ((destructor)) math_fini(void)
         pcutils_map_destroy (const_map);
         const_map = NULL;
     }
+
+    clear_cached_progs();
 }
 
 // todo: release const_map
@@ -1621,6 +2338,8 @@ static purc_variant_t pcdvobjs_create_math (void)
         {"const_l", const_l_getter, NULL},
         {"eval",    eval_getter, NULL},
         {"eval_l",  eval_l_getter, NULL},
+        {"compile", compile_getter, NULL},
+        {"compile_l", compile_l_getter, NULL},
         {"sin",     sin_getter, NULL},
         {"sin_l",   sin_l_getter, NULL},
         {"cos",     cos_getter, NULL},
@@ -1666,6 +2385,11 @@ static purc_variant_t pcdvobjs_create_math (void)
         {"sub",     sub_getter, NULL},
         {"mul",     mul_getter, NULL},
         {"div",     div_getter, NULL},
+        {"sum",     sum_getter, NULL},
+        {"mean",    mean_getter, NULL},
+        {"min",     min_getter, NULL},
+        {"max",     max_getter, NULL},
+        {"dot",     dot_getter, NULL},
     };
 
     return purc_dvobj_make_from_methods (method, PCA_TABLESIZE(method));
@@ -54,6 +54,46 @@ int
 math_eval_l(const char *input, long double *d, purc_variant_t param)
 __attribute__((visibility("hidden")));
 
+/* the compiled expressions; see parsers/math.y */
+struct math_prog;
+struct math_prog_l;
+
+struct math_prog *
+math_compile(const char *input)
+__attribute__((visibility("hidden")));
+
+struct math_prog_l *
+math_compile_l(const char *input)
+__attribute__((visibility("hidden")));
+
+/* binds the variables by name if param is an object, or by position
+   if param is an array, then evaluates the compiled expression */
+int
+math_exec(const struct math_prog *prog, double *d, purc_variant_t param)
+__attribute__((visibility("hidden")));
+
+int
+math_exec_l(const struct math_prog_l *prog, long double *d,
+        purc_variant_t param)
+__attribute__((visibility("hidden")));
+
+/* gets the name of the variable at the position; NULL if out of range */
+const char *
+math_prog_var(const struct math_prog *prog, size_t idx)
+__attribute__((visibility("hidden")));
+
+const char *
+math_prog_var_l(const struct math_prog_l *prog, size_t idx)
+__attribute__((visibility("hidden")));
+
+void
+math_prog_free(struct math_prog *prog)
+__attribute__((visibility("hidden")));
+
+void
+math_prog_free_l(struct math_prog_l *prog)
+__attribute__((visibility("hidden")));
+
 int
 math_voi(double *r, double (*f)(void))
 __attribute__((visibility("hidden")));
@@ -38,6 +38,11 @@
 
         #define VALUE_TYPE     double
         #define FUNC_NAME      math_eval
+        #define PROG_TYPE      math_prog
+        #define COMPILE_FUNC   math_compile
+        #define EXEC_FUNC      math_exec
+        #define FREE_FUNC      math_prog_free
+        #define VAR_FUNC       math_prog_var
 
         #define STRTOD         strtod
         #define CAST_TO_NUMBER purc_variant_cast_to_number
@@ -89,6 +94,11 @@
 
         #define VALUE_TYPE     long double
         #define FUNC_NAME      math_eval_l
+        #define PROG_TYPE      math_prog_l
+        #define COMPILE_FUNC   math_compile_l
+        #define EXEC_FUNC      math_exec_l
+        #define FREE_FUNC      math_prog_free_l
+        #define VAR_FUNC       math_prog_var_l
 
         #define STRTOD         strtold
         #define CAST_TO_NUMBER purc_variant_cast_to_longdouble
@@ -136,15 +146,55 @@
 
     #endif
 
-    struct internal_value {
-        VALUE_TYPE      d;
+    /* the instructions of a compiled expression, run on a stack */
+    enum math_op {
+        MATH_OP_NUM,        /* push the number */
+        MATH_OP_VAR,        /* push the value bound to the slot */
+        MATH_OP_NEG,
+        MATH_OP_ADD,
+        MATH_OP_SUB,
+        MATH_OP_MUL,
+        MATH_OP_DIV,
+        MATH_OP_VOI,        /* push the result of the function */
+        MATH_OP_UNI,        /* replace the top with the result */
+        MATH_OP_BIN,        /* replace the top two with the result */
+    };
+
+    struct math_inst {
+        enum math_op        op;
+        union {
+            VALUE_TYPE      d;
+            size_t          slot;
+            VALUE_TYPE    (*voi_func)(void);
+            VALUE_TYPE    (*uni_func)(VALUE_TYPE a);
+            VALUE_TYPE    (*bin_func)(VALUE_TYPE a, VALUE_TYPE b);
+        };
+    };
+
+    /* a variable (a parameter) of the expression */
+    struct math_slot {
+        char               *name;
+        /* the pre-defined constant used if the parameter is not given;
+           -1 if there is none */
+        int                 pre_defined;
+    };
+
+    struct PROG_TYPE {
+        struct math_inst   *insts;
+        size_t              nr_insts;
+        size_t              sz_insts;
+
+        struct math_slot   *slots;
+        size_t              nr_slots;
+
+        /* the depth of the stack when running the instructions */
+        size_t              depth;
+        size_t              max_depth;
     };
 
     struct internal_param {
-        purc_variant_t param;
-        purc_variant_t variables;
-        VALUE_TYPE     d;
-        unsigned int   divide_by_zero:1;
+        struct PROG_TYPE   *prog;
+        unsigned int        out_of_memory:1;
     };
 
     struct math_token {
@@ -166,115 +216,52 @@
     // introduce yylex decl for later use
     #include <math.h>
 
-    #define SET(_r, _a) do {                           \
-            _r->d = _a.d;                              \
+    #define EMIT(_inst) do {                                        \
+        if (emit(param, (_inst)))                                   \
+            YYABORT;                                                \
     } while (0)
 
-    #define NEG(_r, _a) do {                           \
-            _r.d = -_a.d;                              \
+    #define EMIT_OP(_op) do {                                       \
+        struct math_inst _i = { .op = _op };                        \
+        EMIT(&_i);                                                  \
     } while (0)
 
-    #define ADD(_r, _a, _b) do {                       \
-            _r.d = _a.d + _b.d;                        \
+    #define EMIT_BY_NUM(_a) do {                                    \
+        /* TODO: strtod sort of func */                             \
+        struct math_inst _i = { .op = MATH_OP_NUM };                \
+        char *_s = (char*)_a.text;                                  \
+        const char _c = _s[_a.leng];                                \
+        char *endptr = NULL;                                        \
+        _s[_a.leng] = '\0';                                         \
+        _i.d = STRTOD(_s, &endptr);                                 \
+        _s[_a.leng] = _c;                                           \
+        if (endptr && *endptr)                                      \
+            YYABORT;                                                \
+        EMIT(&_i);                                                  \
     } while (0)
 
-    #define SUB(_r, _a, _b) do {                       \
-            _r.d = _a.d - _b.d;                        \
+    #define EMIT_BY_VAR(_a, _pre) do {                              \
+        struct math_inst _i = { .op = MATH_OP_VAR };                \
+        if (bind_slot(param, _a.text, _a.leng, _pre, &_i.slot))     \
+            YYABORT;                                                \
+        EMIT(&_i);                                                  \
     } while (0)
 
-    #define MUL(_r, _a, _b) do {                       \
-            _r.d = _a.d * _b.d;                        \
+    #define EMIT_BY_PRE_DEFINED(_a, _s) do {                        \
+        struct math_token _t = { _s, sizeof(_s) - 1 };              \
+        EMIT_BY_VAR(_t, _a);                                        \
     } while (0)
 
-    #define DIV(_r, _a, _b, _loc) do {                        \
-            int f = fpclassify(_b.d);                         \
-            if (f & FP_ZERO) {                                \
-                param->divide_by_zero = 1;                    \
-                yyerror(_loc,arg,param,"Divide by zero");     \
-                YYERROR;                                      \
-            }                                                 \
-            _r.d = _a.d / _b.d;                               \
+    #define EMIT_BY_FUNC(_op, _member, _f) do {                     \
+        struct math_inst _i = { .op = _op };                        \
+        _i._member = _f;                                            \
+        EMIT(&_i);                                                  \
     } while (0)
 
-    #define SET_BY_NUM(_r, _a) do {                                 \
-            /* TODO: strtod sort of func */                         \
-            char *_s = (char*)_a.text;                              \
-            const char _c = _s[_a.leng];                            \
-            char *endptr = NULL;                                    \
-            _s[_a.leng] = '\0';                                     \
-            _r.d = STRTOD(_s, &endptr);                             \
-            _s[_a.leng] = _c;                                       \
-            if (endptr && *endptr)                                  \
-                YYABORT;                                            \
-    } while (0)
-
-    #define SET_BY_VAR(_r, _a) do {                                      \
-        purc_variant_t _v;                                               \
-        char *_s = (char*)_a.text;                                       \
-        const char _c = _s[_a.leng];                                     \
-        if (param->variables) {                                          \
-            _s[_a.leng] = '\0';                                          \
-            _v = purc_variant_object_get_by_ckey(param->variables, _s);  \
-            _s[_a.leng] = _c;                                            \
-            if (_v) {                                                    \
-                bool ok = CAST_TO_NUMBER(_v, &_r.d, false);              \
-                if (ok)                                                  \
-                    break;                                               \
-            }                                                            \
-        }                                                                \
-        if (param->param && purc_variant_is_object(param->param)) {      \
-            _s[_a.leng] = '\0';                                          \
-            _v = purc_variant_object_get_by_ckey(param->param, _s);      \
-            _s[_a.leng] = _c;                                            \
-            if (_v) {                                                    \
-                bool ok = CAST_TO_NUMBER(_v, &_r.d, false);              \
-                if (ok)                                                  \
-                    break;                                               \
-            }                                                            \
-        }                                                                \
-        YYABORT;                                                         \
-    } while (0)
-
-    #define SET_BY_PRE_DEFINED(_r, _a, _s) do {                          \
-        purc_variant_t _v;                                               \
-        if (param->variables) {                                          \
-            _v = purc_variant_object_get_by_ckey(param->variables, _s);  \
-            if (_v) {                                                    \
-                bool ok = CAST_TO_NUMBER(_v, &_r.d, false);              \
-                if (ok)                                                  \
-                    break;                                               \
-            }                                                            \
-        }                                                                \
-        if (param->param && purc_variant_is_object(param->param)) {      \
-            _v = purc_variant_object_get_by_ckey(param->param, _s);      \
-            if (_v) {                                                    \
-                bool ok = CAST_TO_NUMBER(_v, &_r.d, false);              \
-                fprintf(stderr, "_s: %s; ok: %d\n", _s, ok); \
-                if (ok)                                                  \
-                    break;                                               \
-            }                                                            \
-        }                                                                \
-        _r.d = PRE_DEFINED(_a);                                          \
-        purc_clr_error();                                                \
-    } while (0)
-
-    #define EVAL_BY_VOI_FUNC(_r, _f) do {                                \
-        int r = VOI_FUNC(&_r.d, _f);                                     \
-        if (r)                                                           \
-            YYABORT;                                                     \
-    } while (0)
-
-    #define EVAL_BY_UNI_FUNC(_r, _f, _a) do {                            \
-        int r = UNI_FUNC(&_r.d, _f, _a.d);                               \
-        if (r)                                                           \
-            YYABORT;                                                     \
-    } while (0)
-
-    #define EVAL_BY_BIN_FUNC(_r, _f, _a, _b) do {                        \
-        int r = BIN_FUNC(&_r.d, _f, _a.d, _b.d);                         \
-        if (r)                                                           \
-            YYABORT;                                                     \
-    } while (0)
+    static int emit(struct internal_param *param,
+            const struct math_inst *inst);
+    static int bind_slot(struct internal_param *param,
+            const char *name, size_t len, int pre_defined, size_t *slot);
 
     static void yyerror(
         YYLTYPE *yylloc,                   // match %define locations
@@ -299,7 +286,6 @@
 %parse-param { struct internal_param *param }
 
 %union { struct math_token token; }
-%union { struct internal_value v; }
 %union { VALUE_TYPE (*voi_func)(void); }
 %union { VALUE_TYPE (*uni_func)(VALUE_TYPE a); }
 %union { VALUE_TYPE (*bin_func)(VALUE_TYPE a, VALUE_TYPE b); }
@@ -320,7 +306,6 @@
 %token PI E LN2 LN10 LOG2E LOG10E SQRT1_2 SQRT2
 
 %token <token> NUMBER VAR
-%nterm <v> exp term pre_defined
 %nterm <voi_func> voi_func
 %nterm <uni_func> uni_func
 %nterm <bin_func> bin_func
@@ -334,38 +319,38 @@ input:
 ;
 
 statement:
-  exp         { SET(param, $1); }
+  exp
 ;
 
 exp:
   term
-| exp '+' exp   { ADD($$, $1, $3); }
-| exp '-' exp   { SUB($$, $1, $3); }
-| exp '*' exp   { MUL($$, $1, $3); }
-| exp '/' exp   { DIV($$, $1, $3, &(@3)); }
-| exp '^' exp   { EVAL_BY_BIN_FUNC($$, POW, $1, $3); }
-| '-' exp %prec NEG { NEG($$, $2); }
+| exp '+' exp   { EMIT_OP(MATH_OP_ADD); }
+| exp '-' exp   { EMIT_OP(MATH_OP_SUB); }
+| exp '*' exp   { EMIT_OP(MATH_OP_MUL); }
+| exp '/' exp   { EMIT_OP(MATH_OP_DIV); }
+| exp '^' exp   { EMIT_BY_FUNC(MATH_OP_BIN, bin_func, POW); }
+| '-' exp %prec NEG { EMIT_OP(MATH_OP_NEG); }
 ;
 
 term:
-  NUMBER      { SET_BY_NUM($$, $1); }
-| VAR         { SET_BY_VAR($$, $1); }
-| pre_defined { $$ = $1; }
-| voi_func '(' ')' { EVAL_BY_VOI_FUNC($$, $1); }
-| uni_func '(' exp ')' { EVAL_BY_UNI_FUNC($$, $1, $3); }
-| bin_func '(' exp ',' exp ')' { EVAL_BY_BIN_FUNC($$, $1, $3, $5); }
-| '(' exp ')' { $$ = $2; }
+  NUMBER      { EMIT_BY_NUM($1); }
+| VAR         { EMIT_BY_VAR($1, -1); }
+| pre_defined
+| voi_func '(' ')' { EMIT_BY_FUNC(MATH_OP_VOI, voi_func, $1); }
+| uni_func '(' exp ')' { EMIT_BY_FUNC(MATH_OP_UNI, uni_func, $1); }
+| bin_func '(' exp ',' exp ')' { EMIT_BY_FUNC(MATH_OP_BIN, bin_func, $1); }
+| '(' exp ')'
 ;
 
 pre_defined:
-  PI          { SET_BY_PRE_DEFINED($$, MATH_PI,      "PI"); }
-| E           { SET_BY_PRE_DEFINED($$, MATH_E,       "E"); }
-| LN2         { SET_BY_PRE_DEFINED($$, MATH_LN2,     "LN2"); }
-| LN10        { SET_BY_PRE_DEFINED($$, MATH_LN10,    "LN10"); }
-| LOG2E       { SET_BY_PRE_DEFINED($$, MATH_LOG2E,   "LOG2E"); }
-| LOG10E      { SET_BY_PRE_DEFINED($$, MATH_LOG10E,  "LOG10E"); }
-| SQRT1_2     { SET_BY_PRE_DEFINED($$, MATH_SQRT1_2, "SQRT1_2"); }
-| SQRT2       { SET_BY_PRE_DEFINED($$, MATH_SQRT2,   "SQRT2"); }
+  PI          { EMIT_BY_PRE_DEFINED(MATH_PI,      "PI"); }
+| E           { EMIT_BY_PRE_DEFINED(MATH_E,       "E"); }
+| LN2         { EMIT_BY_PRE_DEFINED(MATH_LN2,     "LN2"); }
+| LN10        { EMIT_BY_PRE_DEFINED(MATH_LN10,    "LN10"); }
+| LOG2E       { EMIT_BY_PRE_DEFINED(MATH_LOG2E,   "LOG2E"); }
+| LOG10E      { EMIT_BY_PRE_DEFINED(MATH_LOG10E,  "LOG10E"); }
+| SQRT1_2     { EMIT_BY_PRE_DEFINED(MATH_SQRT1_2, "SQRT1_2"); }
+| SQRT2       { EMIT_BY_PRE_DEFINED(MATH_SQRT2,   "SQRT2"); }
 
 
 voi_func:
@@ -428,35 +413,283 @@ yyerror(
         errsg);
 }
 
-int FUNC_NAME(const char *input, VALUE_TYPE *d, purc_variant_t param)
+static int
+emit(struct internal_param *param, const struct math_inst *inst)
+{
+    struct PROG_TYPE *prog = param->prog;
+
+    if (prog->nr_insts == prog->sz_insts) {
+        size_t sz = prog->sz_insts ? prog->sz_insts * 2 : 8;
+        struct math_inst *insts;
+        insts = realloc(prog->insts, sizeof(*insts) * sz);
+        if (insts == NULL) {
+            param->out_of_memory = 1;
+            return -1;
+        }
+
+        prog->insts = insts;
+        prog->sz_insts = sz;
+    }
+
+    switch (inst->op) {
+    case MATH_OP_NUM:
+    case MATH_OP_VAR:
+    case MATH_OP_VOI:
+        prog->depth++;
+        if (prog->depth > prog->max_depth)
+            prog->max_depth = prog->depth;
+        break;
+
+    case MATH_OP_ADD:
+    case MATH_OP_SUB:
+    case MATH_OP_MUL:
+    case MATH_OP_DIV:
+    case MATH_OP_BIN:
+        prog->depth--;
+        break;
+
+    case MATH_OP_NEG:
+    case MATH_OP_UNI:
+        break;
+    }
+
+    prog->insts[prog->nr_insts++] = *inst;
+    return 0;
+}
+
+/* finds or adds the slot of the variable */
+static int
+bind_slot(struct internal_param *param, const char *name, size_t len,
+        int pre_defined, size_t *slot)
+{
+    struct PROG_TYPE *prog = param->prog;
+
+    for (size_t i = 0; i < prog->nr_slots; i++) {
+        if (strncmp(prog->slots[i].name, name, len) == 0 &&
+                prog->slots[i].name[len] == '\0') {
+            *slot = i;
+            return 0;
+        }
+    }
+
+    struct math_slot *slots;
+    slots = realloc(prog->slots, sizeof(*slots) * (prog->nr_slots + 1));
+    if (slots == NULL)
+        goto failed;
+    prog->slots = slots;
+
+    char *dup = strndup(name, len);
+    if (dup == NULL)
+        goto failed;
+
+    slots[prog->nr_slots].name = dup;
+    slots[prog->nr_slots].pre_defined = pre_defined;
+    *slot = prog->nr_slots++;
+    return 0;
+
+failed:
+    param->out_of_memory = 1;
+    return -1;
+}
+
+void FREE_FUNC(struct PROG_TYPE *prog)
+{
+    for (size_t i = 0; i < prog->nr_slots; i++) {
+        free(prog->slots[i].name);
+    }
+    free(prog->slots);
+    free(prog->insts);
+    free(prog);
+}
+
+struct PROG_TYPE *COMPILE_FUNC(const char *input)
 {
     struct internal_param ud = {0};
-    ud.param = param;
-    ud.variables = PURC_VARIANT_INVALID;
+    ud.prog = calloc(1, sizeof(*ud.prog));
+    if (ud.prog == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
 
     yyscan_t arg = {0};
     yylex_init(&arg);
     // yyset_in(in, arg);
     // yyset_debug(debug, arg);
-    yyset_extra(param, arg);
     yy_scan_string(input, arg);
-    int ret =yyparse(arg, &ud);
-    if (ud.variables) {
-        purc_variant_unref(ud.variables);
-        ud.variables = PURC_VARIANT_INVALID;
-    }
+    int ret = yyparse(arg, &ud);
     yylex_destroy(arg);
-    if (ret==0 && d) {
-        *d = ud.d;
+
+    if (ret) {
+        FREE_FUNC(ud.prog);
+        purc_set_error(ud.out_of_memory ?
+                PURC_ERROR_OUT_OF_MEMORY : PURC_ERROR_INTERNAL_FAILURE);
+        return NULL;
     }
-    else {
-        if (ud.divide_by_zero) {
-            purc_set_error(PURC_ERROR_OVERFLOW);
-        }
-        else {
-            purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+
+    return ud.prog;
+}
+
+const char *VAR_FUNC(const struct PROG_TYPE *prog, size_t idx)
+{
+    if (idx < prog->nr_slots)
+        return prog->slots[idx].name;
+    return NULL;
+}
+
+/* the number of the slots or the stack items put on the stack of C */
+#define NR_ON_STACK     16
+
+/* binds the slots by name (an object) or by position (an array) */
+static int
+bind_params(const struct PROG_TYPE *prog, purc_variant_t param,
+        VALUE_TYPE *vals)
+{
+    bool is_object = param && purc_variant_is_object(param);
+    bool is_array = param && purc_variant_is_array(param);
+    size_t nr_params = 0;
+    if (is_array)
+        purc_variant_array_size(param, &nr_params);
+
+    for (size_t i = 0; i < prog->nr_slots; i++) {
+        const struct math_slot *slot = prog->slots + i;
+        purc_variant_t v = PURC_VARIANT_INVALID;
+
+        if (is_object)
+            v = purc_variant_object_get_by_ckey(param, slot->name);
+        else if (is_array && i < nr_params)
+            v = purc_variant_array_get(param, i);
+
+        if (v && CAST_TO_NUMBER(v, vals + i, false))
+            continue;
+
+        if (slot->pre_defined < 0)
+            return -1;
+
+        vals[i] = PRE_DEFINED(slot->pre_defined);
+        purc_clr_error();
+    }
+
+    return 0;
+}
+
+static int
+run_insts(const struct PROG_TYPE *prog, const VALUE_TYPE *vals,
+        VALUE_TYPE *stack, VALUE_TYPE *d, bool *divide_by_zero)
+{
+    VALUE_TYPE *top = stack - 1;
+
+    for (size_t i = 0; i < prog->nr_insts; i++) {
+        const struct math_inst *inst = prog->insts + i;
+
+        switch (inst->op) {
+        case MATH_OP_NUM:
+            *++top = inst->d;
+            break;
+
+        case MATH_OP_VAR:
+            *++top = vals[inst->slot];
+            break;
+
+        case MATH_OP_NEG:
+            *top = -*top;
+            break;
+
+        case MATH_OP_ADD:
+            top[-1] = top[-1] + top[0];
+            top--;
+            break;
+
+        case MATH_OP_SUB:
+            top[-1] = top[-1] - top[0];
+            top--;
+            break;
+
+        case MATH_OP_MUL:
+            top[-1] = top[-1] * top[0];
+            top--;
+            break;
+
+        case MATH_OP_DIV:
+            if (fpclassify(top[0]) & FP_ZERO) {
+                *divide_by_zero = true;
+                return -1;
+            }
+            top[-1] = top[-1] / top[0];
+            top--;
+            break;
+
+        case MATH_OP_VOI:
+            top++;
+            if (VOI_FUNC(top, inst->voi_func))
+                return -1;
+            break;
+
+        case MATH_OP_UNI:
+            if (UNI_FUNC(top, inst->uni_func, *top))
+                return -1;
+            break;
+
+        case MATH_OP_BIN:
+            if (BIN_FUNC(top - 1, inst->bin_func, top[-1], top[0]))
+                return -1;
+            top--;
+            break;
         }
     }
+
+    /* the value of an empty expression is zero */
+    *d = (top < stack) ? 0 : *top;
+    return 0;
+}
+
+int EXEC_FUNC(const struct PROG_TYPE *prog, VALUE_TYPE *d,
+        purc_variant_t param)
+{
+    VALUE_TYPE vals_on_stack[NR_ON_STACK];
+    VALUE_TYPE stack_on_stack[NR_ON_STACK];
+    VALUE_TYPE *vals = vals_on_stack;
+    VALUE_TYPE *stack = stack_on_stack;
+    bool divide_by_zero = false;
+    int ret = -1;
+
+    if (prog->nr_slots > NR_ON_STACK)
+        vals = malloc(sizeof(VALUE_TYPE) * prog->nr_slots);
+    if (prog->max_depth > NR_ON_STACK)
+        stack = malloc(sizeof(VALUE_TYPE) * prog->max_depth);
+    if (vals == NULL || stack == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto done;
+    }
+
+    VALUE_TYPE v;
+    if (bind_params(prog, param, vals) == 0 &&
+            run_insts(prog, vals, stack, &v, &divide_by_zero) == 0) {
+        if (d)
+            *d = v;
+        ret = 0;
+    }
+    else if (divide_by_zero) {
+        purc_set_error(PURC_ERROR_OVERFLOW);
+    }
+    else {
+        purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+    }
+
+done:
+    if (vals && vals != vals_on_stack)
+        free(vals);
+    if (stack && stack != stack_on_stack)
+        free(stack);
     return ret ? 1 : 0;
 }
 
+int FUNC_NAME(const char *input, VALUE_TYPE *d, purc_variant_t param)
+{
+    struct PROG_TYPE *prog = COMPILE_FUNC(input);
+    if (prog == NULL)
+        return 1;
+
+    int ret = EXEC_FUNC(prog, d, param);
+    FREE_FUNC(prog);
+    return ret;
+}
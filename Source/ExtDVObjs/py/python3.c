@@ -29,12 +29,16 @@
 
 #include "config.h"
 #include "private/map.h"
+#include "private/list.h"
 #include "private/dvobjs.h"
 #include "private/instance.h"
 #include "private/atom-buckets.h"
 #include "private/debug.h"
 #include "purc-variant.h"
 #include "purc-errors.h"
+#include "purc-runloop.h"
+
+#include <pthread.h>
 
 #define PY_DVOBJ_VERNAME        "0.1.0"
 #define PY_DVOBJ_VERCODE        0
@@ -58,6 +62,7 @@
 #define PY_KEY_EVAL         "eval"
 #define PY_KEY_ENTITY       "entity"
 #define PY_KEY_HANDLE       "__handle_python__"
+#define PY_KEY_ASYNC        "async"
 
 #define PY_INFO_VERSION     "version"
 #define PY_INFO_PLATFORM    "platform"
@@ -121,13 +126,52 @@ static inline PyObject* Py_XNewRef(PyObject *obj)
 
 #endif /* PY_VERSION_HEX < 0x030a0000 */
 
+struct pyasync_worker;
+
 struct dvobj_pyinfo {
     pcutils_map             *reserved_symbols;  // the reserved symbols.
     PyObject                *locals;            // the local variables.
     purc_variant_t          root;               // the root variant, i.e., $PY itself
     struct pcvar_listener   *listener;          // the listener
+    struct pyasync_worker   *worker;            // the worker for async calls
 };
 
+/*
+ * The runner thread holds the GIL all the time, unless there is any
+ * asynchronous call running on the worker thread. In that case, it
+ * releases the GIL when it goes back to the run loop, and takes the GIL
+ * back when it enters Python again; so every entry called by PurC must
+ * call py_hold_gil() before using any Python API.
+ */
+static PyThreadState *py_saved_tstate;
+static size_t py_nr_async_calls;
+static bool py_release_scheduled;
+
+static void py_release_gil(void *ctxt)
+{
+    UNUSED_PARAM(ctxt);
+
+    py_release_scheduled = false;
+    if (py_nr_async_calls > 0 && py_saved_tstate == NULL)
+        py_saved_tstate = PyEval_SaveThread();
+}
+
+static void py_hold_gil(void)
+{
+    if (py_saved_tstate) {
+        PyEval_RestoreThread(py_saved_tstate);
+        py_saved_tstate = NULL;
+    }
+
+    if (py_nr_async_calls > 0 && !py_release_scheduled) {
+        purc_runloop_t runloop = purc_runloop_get_current();
+        if (runloop) {
+            py_release_scheduled = true;
+            purc_runloop_dispatch(runloop, py_release_gil, NULL);
+        }
+    }
+}
+
 static inline struct dvobj_pyinfo *get_pyinfo_from_root(purc_variant_t root)
 {
     purc_variant_t v;
@@ -406,6 +450,130 @@ static void handle_python_error(struct dvobj_pyinfo *pyinfo)
     PyErr_Clear();
 }
 
+/*
+ * The Python object which exports the bytes of an HVML byte sequence
+ * through the buffer protocol; it holds a reference of the variant,
+ * so the memoryview made from it refers to the bytes without copying.
+ */
+struct pybsequence {
+    PyObject_HEAD
+    purc_variant_t  bsequence;
+};
+
+static int pybsequence_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+    struct pybsequence *obj = (struct pybsequence *)self;
+    const unsigned char *bytes;
+    size_t length;
+
+    bytes = purc_variant_get_bytes_const(obj->bsequence, &length);
+    /* the byte sequence is immutable; fails for a writable request */
+    return PyBuffer_FillInfo(view, self, (void *)bytes, (Py_ssize_t)length,
+            1, flags);
+}
+
+static void pybsequence_dealloc(PyObject *self)
+{
+    struct pybsequence *obj = (struct pybsequence *)self;
+    purc_variant_unref(obj->bsequence);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PyBufferProcs pybsequence_as_buffer = {
+    .bf_getbuffer = pybsequence_getbuffer,
+    .bf_releasebuffer = NULL,
+};
+
+static PyTypeObject pybsequence_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "hvml.bsequence",
+    .tp_basicsize = sizeof(struct pybsequence),
+    .tp_dealloc = pybsequence_dealloc,
+    .tp_as_buffer = &pybsequence_as_buffer,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "The bytes of an HVML byte sequence.",
+};
+
+static PyObject *make_memoryview_from_bsequence(purc_variant_t v)
+{
+    struct pybsequence *obj;
+
+    obj = PyObject_New(struct pybsequence, &pybsequence_type);
+    if (obj == NULL)
+        return NULL;
+
+    obj->bsequence = purc_variant_ref(v);
+    PyObject *view = PyMemoryView_FromObject((PyObject *)obj);
+    Py_DECREF(obj);
+    return view;
+}
+
+/*
+ * The native entity owning a buffer exported by a Python object, e.g.,
+ * a memoryview, an array.array, or a NumPy array. The export keeps
+ * the memory of the Python object alive (and not resizable) until the
+ * byte sequences refering to it are released.
+ */
+#define PY_NATIVE_BUFFER        "pyBuffer"
+
+static void on_release_pybuffer(void* native_entity)
+{
+    py_hold_gil();
+    Py_buffer *view = native_entity;
+    PyBuffer_Release(view);
+    free(view);
+}
+
+static purc_variant_t make_bsequence_from_pybuffer(PyObject *pyobj)
+{
+    static const struct purc_native_ops ops = {
+        .on_release = on_release_pybuffer,
+    };
+
+    if (PyMemoryView_Check(pyobj)) {
+        /* a memoryview made by us for a whole byte sequence: give it back */
+        Py_buffer *mv = PyMemoryView_GET_BUFFER(pyobj);
+        if (mv->obj && Py_TYPE(mv->obj) == &pybsequence_type) {
+            purc_variant_t v = ((struct pybsequence *)mv->obj)->bsequence;
+            const unsigned char *bytes;
+            size_t length;
+
+            bytes = purc_variant_get_bytes_const(v, &length);
+            if (mv->buf == bytes && (size_t)mv->len == length)
+                return purc_variant_ref(v);
+        }
+    }
+
+    Py_buffer *view = malloc(sizeof(*view));
+    if (view == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* only a contiguous buffer can be referred to by a byte sequence */
+    if (PyObject_GetBuffer(pyobj, view, PyBUF_SIMPLE)) {
+        PyErr_Clear();
+        free(view);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (view->len == 0) {
+        on_release_pybuffer(view);
+        return purc_variant_make_byte_sequence_empty();
+    }
+
+    purc_variant_t owner, v;
+    owner = purc_variant_make_native_entity(view, &ops, PY_NATIVE_BUFFER);
+    if (owner == PURC_VARIANT_INVALID) {
+        on_release_pybuffer(view);
+        return PURC_VARIANT_INVALID;
+    }
+
+    v = purc_variant_make_byte_sequence_view(owner, view->buf, view->len);
+    purc_variant_unref(owner);
+    return v;
+}
+
 static PyObject *make_pyobj_from_variant(struct dvobj_pyinfo *pyinfo,
         purc_variant_t v)
 {
@@ -474,8 +642,11 @@ static PyObject *make_pyobj_from_variant(struct dvobj_pyinfo *pyinfo,
         const unsigned char* bytes;
         size_t length;
         bytes = purc_variant_get_bytes_const(v, &length);
-        pyobj = PyByteArray_FromStringAndSize((const char *)bytes,
-                length);
+        if (length > 0)
+            pyobj = make_memoryview_from_bsequence(v);
+        else
+            pyobj = PyByteArray_FromStringAndSize((const char *)bytes,
+                    length);
         break;
     }
 
@@ -739,13 +910,27 @@ static purc_variant_t convert_pyobj_to_variant(struct dvobj_pyinfo *pyinfo,
         char *buffer;
         Py_ssize_t length;
         PyBytes_AsStringAndSize(pyobj, &buffer, &length);
-        v = purc_variant_make_byte_sequence(buffer, length);
+        if (length > 0) {
+            /* Python bytes are immutable; refer to them directly */
+            purc_variant_t owner = make_variant_from_pyobj(pyobj);
+            if (owner == PURC_VARIANT_INVALID)
+                goto failed;
+            v = purc_variant_make_byte_sequence_view(owner, buffer, length);
+            purc_variant_unref(owner);
+        }
+        else
+            v = purc_variant_make_byte_sequence_empty();
     }
     else if (PyByteArray_Check(pyobj)) {
+        /* copy it; an export would prevent the bytearray from resizing */
         char *buffer = PyByteArray_AS_STRING(pyobj);
         Py_ssize_t length = PyByteArray_GET_SIZE(pyobj);
         v = purc_variant_make_byte_sequence(buffer, length);
     }
+    else if (PyObject_CheckBuffer(pyobj) &&
+            (v = make_bsequence_from_pybuffer(pyobj))) {
+        // do nothing.
+    }
     else if (PyUnicode_Check(pyobj)) {
         const char *c_str;
         c_str = PyUnicode_AsUTF8(pyobj);
@@ -972,6 +1157,359 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/*
+ * An asynchronous call of a callable PyObject. It is made on the runner
+ * thread, run on the worker thread, and delivered back to the runner
+ * thread by the run loop, where the result is fired as a `callState`
+ * event on the native entity returned by the `async` method:
+ *
+ *  - `callState:success`: the event data is the result.
+ *  - `callState:except`: the event data is the name of the exception.
+ *
+ * The call is freed when both the result is delivered (or dropped)
+ * and the native entity is released.
+ */
+#define PY_NATIVE_ASYNC_CALL    "pyAsyncCall"
+
+enum {
+    PYASYNC_QUEUED = 0,
+    PYASYNC_RUNNING,
+    PYASYNC_DONE,
+    PYASYNC_DELIVERED,
+};
+
+struct pyasync_call {
+    struct list_head        ln;
+    struct pyasync_worker  *worker;     // NULL if the worker has gone
+    purc_runloop_t          runloop;
+    purc_atom_t             cid;
+    purc_variant_t          observed;   // NULL if the entity is released
+
+    PyObject               *callable;
+    PyObject               *args;
+    PyObject               *result;
+    PyObject               *exc_type;
+    PyObject               *exc_value;
+    PyObject               *exc_tb;
+    int                     state;
+};
+
+struct pyasync_worker {
+    struct dvobj_pyinfo    *pyinfo;
+    pthread_t               thread;
+    pthread_mutex_t         lock;
+    pthread_cond_t          cond;
+    struct list_head        queued;     // the calls not started yet
+    struct list_head        done;       // the calls not delivered yet
+    bool                    quit;
+};
+
+static void pyasync_clear_call(struct pyasync_call *call)
+{
+    Py_CLEAR(call->callable);
+    Py_CLEAR(call->args);
+    Py_CLEAR(call->result);
+    Py_CLEAR(call->exc_type);
+    Py_CLEAR(call->exc_value);
+    Py_CLEAR(call->exc_tb);
+}
+
+static void pyasync_on_delivered(void *ctxt)
+{
+    struct pyasync_call *call = ctxt;
+    struct pyasync_worker *worker = call->worker;
+
+    if (worker == NULL) {
+        /* the worker has gone along with the Python interpreter */
+        call->state = PYASYNC_DELIVERED;
+        if (call->observed == NULL)
+            free(call);
+        return;
+    }
+
+    py_hold_gil();
+
+    pthread_mutex_lock(&worker->lock);
+    list_del(&call->ln);
+    pthread_mutex_unlock(&worker->lock);
+    py_nr_async_calls--;
+
+    if (call->observed && call->cid) {
+        purc_variant_t data;
+        const char *sub_type;
+
+        if (call->result) {
+            sub_type = MSG_SUB_TYPE_SUCCESS;
+            data = make_variant_from_pyobj(call->result);
+        }
+        else {
+            struct dvobj_pyinfo *pyinfo = worker->pyinfo;
+
+            /* map the exception as a synchronous call does */
+            sub_type = MSG_SUB_TYPE_EXCEPT;
+            PyErr_Restore(call->exc_type, call->exc_value, call->exc_tb);
+            call->exc_type = call->exc_value = call->exc_tb = NULL;
+            handle_python_error(pyinfo);
+            purc_clr_error();
+
+            data = purc_variant_object_get_by_ckey(pyinfo->root,
+                    PY_KEY_EXCEPT);
+            if (data)
+                purc_variant_ref(data);
+        }
+
+        pcintr_coroutine_post_event(call->cid,
+                PCRDR_MSG_EVENT_REDUCE_OPT_KEEP, call->observed,
+                MSG_TYPE_CALL_STATE, sub_type,
+                data ? data : PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+        if (data)
+            purc_variant_unref(data);
+    }
+
+    pyasync_clear_call(call);
+    call->state = PYASYNC_DELIVERED;
+    if (call->observed == NULL)
+        free(call);
+}
+
+static void *pyasync_worker_entry(void *arg)
+{
+    struct pyasync_worker *worker = arg;
+
+    pthread_mutex_lock(&worker->lock);
+    while (true) {
+        while (!worker->quit && list_empty(&worker->queued))
+            pthread_cond_wait(&worker->cond, &worker->lock);
+        if (worker->quit)
+            break;
+
+        struct pyasync_call *call;
+        call = list_first_entry(&worker->queued, struct pyasync_call, ln);
+        list_del(&call->ln);
+        call->state = PYASYNC_RUNNING;
+        pthread_mutex_unlock(&worker->lock);
+
+        PyGILState_STATE gstate = PyGILState_Ensure();
+        call->result = PyObject_Call(call->callable, call->args, NULL);
+        if (call->result == NULL)
+            PyErr_Fetch(&call->exc_type, &call->exc_value, &call->exc_tb);
+        PyGILState_Release(gstate);
+
+        pthread_mutex_lock(&worker->lock);
+        call->state = PYASYNC_DONE;
+        list_add_tail(&call->ln, &worker->done);
+        purc_runloop_dispatch(call->runloop, pyasync_on_delivered, call);
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    return NULL;
+}
+
+static struct pyasync_worker *pyasync_get_worker(struct dvobj_pyinfo *pyinfo)
+{
+    if (pyinfo->worker)
+        return pyinfo->worker;
+
+    struct pyasync_worker *worker = calloc(1, sizeof(*worker));
+    if (worker == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    worker->pyinfo = pyinfo;
+    list_head_init(&worker->queued);
+    list_head_init(&worker->done);
+    pthread_mutex_init(&worker->lock, NULL);
+    pthread_cond_init(&worker->cond, NULL);
+    if (pthread_create(&worker->thread, NULL, pyasync_worker_entry, worker)) {
+        pthread_cond_destroy(&worker->cond);
+        pthread_mutex_destroy(&worker->lock);
+        free(worker);
+        purc_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
+        return NULL;
+    }
+
+    pyinfo->worker = worker;
+    return worker;
+}
+
+/* Stops the worker; called with the GIL held before finalizing Python. */
+static void pyasync_destroy_worker(struct pyasync_worker *worker)
+{
+    pthread_mutex_lock(&worker->lock);
+    worker->quit = true;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+
+    /* the running call needs the GIL to finish */
+    Py_BEGIN_ALLOW_THREADS
+    pthread_join(worker->thread, NULL);
+    Py_END_ALLOW_THREADS
+
+    struct pyasync_call *call, *tmp;
+    list_for_each_entry_safe(call, tmp, &worker->queued, ln) {
+        list_del(&call->ln);
+        pyasync_clear_call(call);
+        call->state = PYASYNC_DELIVERED;
+        py_nr_async_calls--;
+        if (call->observed == NULL)
+            free(call);
+    }
+
+    /* the delivering callbacks will free the calls */
+    list_for_each_entry_safe(call, tmp, &worker->done, ln) {
+        list_del(&call->ln);
+        pyasync_clear_call(call);
+        call->worker = NULL;
+        py_nr_async_calls--;
+    }
+
+    pthread_cond_destroy(&worker->cond);
+    pthread_mutex_destroy(&worker->lock);
+    free(worker);
+}
+
+static bool pyasync_on_observe(void *native_entity,
+        const char *event_name, const char *event_subname)
+{
+    UNUSED_PARAM(event_subname);
+    struct pyasync_call *call = native_entity;
+
+    if (strcmp(event_name, MSG_TYPE_CALL_STATE))
+        return false;
+
+    /* fire the event to the coroutine which observes the call */
+    pcintr_coroutine_t co = pcintr_get_coroutine();
+    if (co)
+        call->cid = co->cid;
+    return true;
+}
+
+static bool pyasync_on_forget(void *native_entity,
+        const char *event_name, const char *event_subname)
+{
+    UNUSED_PARAM(native_entity);
+    UNUSED_PARAM(event_name);
+    UNUSED_PARAM(event_subname);
+    return true;
+}
+
+static void pyasync_on_release(void *native_entity)
+{
+    struct pyasync_call *call = native_entity;
+    struct pyasync_worker *worker = call->worker;
+
+    call->observed = NULL;
+    if (call->state == PYASYNC_DELIVERED) {
+        free(call);
+        return;
+    }
+
+    /* the delivering callback will free the call */
+    if (worker == NULL)
+        return;
+
+    /* cancel the call if it is not started yet */
+    pthread_mutex_lock(&worker->lock);
+    if (call->state == PYASYNC_QUEUED) {
+        list_del(&call->ln);
+        pthread_mutex_unlock(&worker->lock);
+
+        py_hold_gil();
+        pyasync_clear_call(call);
+        py_nr_async_calls--;
+        free(call);
+        return;
+    }
+    pthread_mutex_unlock(&worker->lock);
+}
+
+/*
+ * This getter calls a callable PyObject on the worker thread, and returns
+ * a native entity immediately, which can be observed for the result:
+ *
+    <init as 'job' with $PY.global.my_func.async(3, 5) />
+    <observe on $job for 'callState:success'>
+        ...
+    </observe>
+ */
+static purc_variant_t pycallable_async_getter(void* native_entity,
+        const char *property_name,
+        size_t nr_args, purc_variant_t* argv, unsigned call_flags)
+{
+    static struct purc_native_ops ops = {
+        .on_observe = pyasync_on_observe,
+        .on_forget = pyasync_on_forget,
+        .on_release = pyasync_on_release,
+    };
+
+    UNUSED_PARAM(property_name);
+    py_hold_gil();
+
+    PyObject *pyobj = native_entity;
+    assert(PyCallable_Check(pyobj));
+
+    struct dvobj_pyinfo *pyinfo = get_pyinfo();
+    struct pyasync_worker *worker = pyasync_get_worker(pyinfo);
+    if (worker == NULL)
+        goto failed;
+
+    PyObject *args = PyTuple_New(nr_args);
+    if (args == NULL)
+        goto failed_python;
+
+    for (size_t i = 0; i < nr_args; i++) {
+        PyObject *pymbr = make_pyobj_from_variant(pyinfo, argv[i]);
+        if (pymbr == NULL) {
+            Py_DECREF(args);
+            goto failed;
+        }
+
+        PyTuple_SET_ITEM(args, i, pymbr);
+    }
+
+    struct pyasync_call *call = calloc(1, sizeof(*call));
+    if (call == NULL) {
+        Py_DECREF(args);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    purc_variant_t ret = purc_variant_make_native_entity(call, &ops,
+            PY_NATIVE_ASYNC_CALL);
+    if (ret == PURC_VARIANT_INVALID) {
+        Py_DECREF(args);
+        free(call);
+        goto failed;
+    }
+
+    pcintr_coroutine_t co = pcintr_get_coroutine();
+    call->worker = worker;
+    call->runloop = purc_runloop_get_current();
+    call->cid = co ? co->cid : 0;
+    call->observed = ret;
+    call->callable = Py_NewRef(pyobj);
+    call->args = args;
+    call->state = PYASYNC_QUEUED;
+
+    pthread_mutex_lock(&worker->lock);
+    list_add_tail(&call->ln, &worker->queued);
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+
+    /* let the worker take the GIL when we go back to the run loop */
+    py_nr_async_calls++;
+    py_hold_gil();
+    return ret;
+
+failed_python:
+    handle_python_error(pyinfo);
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_undefined();
+    return PURC_VARIANT_INVALID;
+}
+
 /*
  * This self setter returns the result of a callable PyObject by using the
  * first variant (must be an HVML object) as the keyword arguments.
@@ -1107,6 +1645,9 @@ failed:
  * If there is no argument, it converts the PyObject to the HVML representation:
  *
  *  - Python Bytes and ByteArray: an HVML byte sequence.
+ *  - Other Python object supports the contiguous buffer protocol, e.g.,
+ *    memoryview or a NumPy array: an HVML byte sequence refers to the
+ *    memory of the object.
  *  - Python string: an HVML string.
  *  - Python list: an HVML array.
  *  - Python dictionary: an HVML object.
@@ -1121,6 +1662,7 @@ static purc_variant_t pyobject_self_getter(void* native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     UNUSED_PARAM(nr_args);
     UNUSED_PARAM(argv);
     UNUSED_PARAM(property_name);
@@ -1338,6 +1880,7 @@ static purc_variant_t pyobject_self_setter(void* native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     UNUSED_PARAM(property_name);
     PyObject *pyobj = native_entity;
     struct dvobj_pyinfo *pyinfo = get_pyinfo();
@@ -1409,6 +1952,7 @@ static purc_variant_t pyobject_method_getter(void* native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo();
 
     PyObject *pyobj = native_entity;
@@ -1482,6 +2026,7 @@ static purc_variant_t pyobject_method_setter(void* native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo();
     PyObject *pyobj = native_entity;
 
@@ -1550,6 +2095,7 @@ static purc_variant_t pyobject_callable_getter(void* native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     assert(native_entity);
     assert(property_name);
     PyObject *pyobj = native_entity;
@@ -1563,6 +2109,7 @@ static purc_variant_t pyobject_callable_setter(void* native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     assert(native_entity);
     assert(property_name);
     PyObject *pyobj = native_entity;
@@ -1576,6 +2123,7 @@ static purc_variant_t pyobject_attr_getter(void* native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     UNUSED_PARAM(nr_args);
     UNUSED_PARAM(argv);
 
@@ -1613,6 +2161,7 @@ static purc_variant_t pydict_item_getter(void *native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     PyObject *dict = (PyObject *)native_entity;
     UNUSED_PARAM(nr_args);
     UNUSED_PARAM(argv);
@@ -1651,6 +2200,7 @@ static purc_variant_t pydict_item_setter(void *native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo();
     PyObject *dict = (PyObject *)native_entity;
     assert(PyDict_Check(dict));
@@ -1694,6 +2244,7 @@ failed:
 static purc_nvariant_method
 pyobject_property_getter_getter(void* native_entity, const char* property_name)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo();
     PyObject *pyobj = (PyObject *)native_entity;
     assert(pyobj);
@@ -1701,6 +2252,11 @@ pyobject_property_getter_getter(void* native_entity, const char* property_name)
     if (property_name == NULL) {
         return pyobject_self_getter;
     }
+    else if (strcmp(property_name, PY_KEY_ASYNC) == 0 &&
+            PyCallable_Check(pyobj)) {
+        /* `async` is a keyword of Python, so never be an attribute */
+        return pycallable_async_getter;
+    }
     else {
         PyObject *val = PyObject_GetAttrString(pyobj, property_name);
         if (val == NULL && !PyDict_Check(pyobj)) {
@@ -1730,6 +2286,7 @@ pyobject_property_getter_getter(void* native_entity, const char* property_name)
 static purc_nvariant_method
 pyobject_property_setter_getter(void* native_entity, const char* property_name)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo();
     PyObject *pyobj = (PyObject *)native_entity;
     assert(pyobj);
@@ -1767,6 +2324,7 @@ pyobject_property_setter_getter(void* native_entity, const char* property_name)
 
 static void on_release_pyobject(void* native_entity)
 {
+    py_hold_gil();
     PyObject *pyobj = native_entity;
     Py_DECREF(pyobj);
 }
@@ -1920,6 +2478,7 @@ failed:
 static purc_variant_t run_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     UNUSED_PARAM(root);
 
     enum {
@@ -2155,6 +2714,7 @@ failed:
 static purc_variant_t import_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo_from_root(root);
     PyObject *fromlist = NULL, *aliaselist = NULL;
     purc_variant_t val = PURC_VARIANT_INVALID;
@@ -2406,6 +2966,7 @@ failed:
 static purc_variant_t pythonize_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo_from_root(root);
     PyObject *result = NULL;
 
@@ -2473,6 +3034,7 @@ failed:
 static purc_variant_t stringify_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo_from_root(root);
     PyObject *result = NULL;
 
@@ -2530,6 +3092,7 @@ failed:
 static purc_variant_t code_eval_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo();
     PyObject *def_globals, *def_locals;
 
@@ -2603,6 +3166,7 @@ failed:
 static purc_variant_t code_entity_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     UNUSED_PARAM(nr_args);
     UNUSED_PARAM(argv);
     UNUSED_PARAM(call_flags);
@@ -2616,6 +3180,7 @@ static purc_variant_t code_entity_getter(purc_variant_t root,
 static purc_variant_t compile_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
+    py_hold_gil();
     struct dvobj_pyinfo *pyinfo = get_pyinfo_from_root(root);
     PyObject *pycode = NULL, *locals = NULL;
     purc_variant_t ret = PURC_VARIANT_INVALID, val = PURC_VARIANT_INVALID;
@@ -2868,6 +3433,7 @@ fatal:
 static bool on_py_being_released(purc_variant_t src, pcvar_op_t op,
         void *ctxt, size_t nr_args, purc_variant_t *argv)
 {
+    py_hold_gil();
     UNUSED_PARAM(nr_args);
     UNUSED_PARAM(argv);
 
@@ -2875,6 +3441,8 @@ static bool on_py_being_released(purc_variant_t src, pcvar_op_t op,
         struct dvobj_pyinfo *pyinfo = ctxt;
 
         purc_variant_revoke_listener(src, pyinfo->listener);
+        if (pyinfo->worker)
+            pyasync_destroy_worker(pyinfo->worker);
         Py_DECREF(pyinfo->locals);
 
         assert(Py_IsInitialized());
@@ -2900,6 +3468,9 @@ static purc_variant_t create_py(void)
     if (!Py_IsInitialized()) {
         Py_Initialize();
     }
+    else {
+        py_hold_gil();
+    }
 
     if (keywords2atoms[0].atom == 0) {
         for (size_t i = 0; i < PCA_TABLESIZE(keywords2atoms); i++) {
@@ -2912,6 +3483,9 @@ static purc_variant_t create_py(void)
     purc_variant_t py = PURC_VARIANT_INVALID;
     purc_variant_t val = PURC_VARIANT_INVALID;
 
+    if (PyType_Ready(&pybsequence_type) < 0)
+        goto fatal;
+
     PyObject *m = PyImport_AddModule("__main__");
     if (m == NULL)
         goto fatal;
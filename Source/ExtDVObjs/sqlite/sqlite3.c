@@ -28,6 +28,7 @@
 
 #include "config.h"
 #include "private/map.h"
+#include "private/list.h"
 #include "private/dvobjs.h"
 #include "private/instance.h"
 #include "private/atom-buckets.h"
@@ -42,6 +43,9 @@
 
 #define SQLITE_DEFAULT_TIMEOUT      5
 
+/* the max number of the idle prepared statements cached by a connection */
+#define SQLITE_STMT_CACHE_SIZE      16
+
 #define STR(x)                      #x
 #define STR2(x)                     STR(x)
 #define SQLITE_DVOBJ_VERCODE_STR    STR2(SQLITE_DVOBJ_VERCODE)
@@ -59,6 +63,7 @@
 #define SQLITE_KEY_FETCHONE         "fetchone"
 #define SQLITE_KEY_FETCHMANY        "fetchmany"
 #define SQLITE_KEY_FETCHALL         "fetchall"
+#define SQLITE_KEY_ROWS             "rows"
 #define SQLITE_KEY_ROWCOUNT         "rowcount"
 #define SQLITE_KEY_LASTROWID        "lastrowid"
 #define SQLITE_KEY_DESCRIPTION      "description"
@@ -86,11 +91,28 @@ struct dvobj_sqlite_info {
     struct pcvar_listener   *listener;          // the listener
 };
 
+/* a prepared statement which can be reused by the SQL text */
+struct sqlite_cached_stmt {
+    struct list_head            ln;                 // the node in LRU list
+    sqlite3_stmt                *st;
+    bool                        is_dml;
+
+    /* the column names made on the first fetch as object */
+    int                         nr_cols;
+    purc_variant_t              *col_names;
+
+    char                        sql[0];
+};
+
 struct dvobj_sqlite_connection {
     purc_variant_t              root;               // the root variant, itself
     sqlite3                     *db;
     char                        *db_name;
     struct pcvar_listener       *listener;          // the listener
+
+    /* the idle prepared statements, most recently used first */
+    struct list_head            stmts;
+    size_t                      nr_stmts;
 };
 
 struct dvobj_sqlite_cursor {
@@ -104,6 +126,7 @@ struct dvobj_sqlite_cursor {
     struct dvobj_sqlite_connection  *conn;
     struct pcvar_listener           *listener;          // the listener
     sqlite3_stmt                    *st;
+    struct sqlite_cached_stmt       *cached;            // owns st if not NULL
 };
 
 static bool is_conn_closed(struct dvobj_sqlite_connection *conn)
@@ -197,10 +220,155 @@ lstrip_sql(const char *sql)
     return NULL;
 }
 
+static void
+free_cached_stmt(struct sqlite_cached_stmt *cst)
+{
+    if (cst->col_names) {
+        for (int i = 0; i < cst->nr_cols; i++) {
+            purc_variant_unref(cst->col_names[i]);
+        }
+        free(cst->col_names);
+    }
+    sqlite3_finalize(cst->st);
+    free(cst);
+}
+
+/* takes the idle statement prepared for the SQL out of the cache */
+static struct sqlite_cached_stmt *
+conn_take_cached_stmt(struct dvobj_sqlite_connection *conn, const char *sql)
+{
+    struct sqlite_cached_stmt *cst;
+    list_for_each_entry(cst, &conn->stmts, ln) {
+        if (strcmp(cst->sql, sql) == 0) {
+            list_del(&cst->ln);
+            conn->nr_stmts--;
+            return cst;
+        }
+    }
+
+    return NULL;
+}
+
+/* puts the statement back to the cache; evicts the least recently used one
+   if the cache is full */
+static void
+conn_put_cached_stmt(struct dvobj_sqlite_connection *conn,
+        struct sqlite_cached_stmt *cst)
+{
+    if (is_conn_closed(conn)) {
+        free_cached_stmt(cst);
+        return;
+    }
+
+    sqlite3_reset(cst->st);
+    sqlite3_clear_bindings(cst->st);
+    list_add(&cst->ln, &conn->stmts);
+    conn->nr_stmts++;
+
+    if (conn->nr_stmts > SQLITE_STMT_CACHE_SIZE) {
+        cst = list_last_entry(&conn->stmts, struct sqlite_cached_stmt, ln);
+        list_del(&cst->ln);
+        conn->nr_stmts--;
+        free_cached_stmt(cst);
+    }
+}
+
+static void
+conn_clear_cached_stmts(struct dvobj_sqlite_connection *conn)
+{
+    struct sqlite_cached_stmt *cst, *tmp;
+    list_for_each_entry_safe(cst, tmp, &conn->stmts, ln) {
+        list_del(&cst->ln);
+        free_cached_stmt(cst);
+    }
+    conn->nr_stmts = 0;
+}
+
+/* releases the statement of the cursor, and returns it to the cache */
+static void
+cursor_release_st(struct dvobj_sqlite_cursor *cursor)
+{
+    if (cursor->cached) {
+        conn_put_cached_stmt(cursor->conn, cursor->cached);
+        cursor->cached = NULL;
+    }
+    else if (cursor->st) {
+        sqlite3_reset(cursor->st);
+        sqlite3_finalize(cursor->st);
+    }
+    cursor->st = NULL;
+}
+
+/*
+ * Gets the column names of the cached statement of the cursor; makes them
+ * if they are not made yet or the columns were changed after the statement
+ * was re-prepared by SQLite. Returns NULL if the statement is not cached.
+ */
+static purc_variant_t *
+cursor_get_col_names(struct dvobj_sqlite_cursor *cursor, int nr_cols)
+{
+    struct sqlite_cached_stmt *cst = cursor->cached;
+    if (cst == NULL) {
+        return NULL;
+    }
+
+    if (cst->col_names && cst->nr_cols == nr_cols) {
+        int i;
+        for (i = 0; i < nr_cols; i++) {
+            const char *name = sqlite3_column_name(cst->st, i);
+            if (name == NULL || strcmp(name,
+                        purc_variant_get_string_const(cst->col_names[i])))
+                break;
+        }
+
+        if (i == nr_cols) {
+            return cst->col_names;
+        }
+    }
+
+    if (cst->col_names) {
+        for (int i = 0; i < cst->nr_cols; i++) {
+            purc_variant_unref(cst->col_names[i]);
+        }
+        free(cst->col_names);
+        cst->col_names = NULL;
+        cst->nr_cols = 0;
+    }
+
+    purc_variant_t *names = calloc(nr_cols, sizeof(purc_variant_t));
+    if (names == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; i < nr_cols; i++) {
+        const char *name = sqlite3_column_name(cst->st, i);
+        if (name == NULL ||
+                !(names[i] = purc_variant_make_string_interned(name, true))) {
+            while (i > 0) {
+                purc_variant_unref(names[--i]);
+            }
+            free(names);
+            return NULL;
+        }
+    }
+
+    cst->col_names = names;
+    cst->nr_cols = nr_cols;
+    return names;
+}
+
 static inline int
 cursor_create_st(struct dvobj_sqlite_cursor *cursor, const char *sql)
 {
     struct dvobj_sqlite_connection *conn = cursor->conn;
+    struct sqlite_cached_stmt *cst = conn_take_cached_stmt(conn, sql);
+    if (cst) {
+        cursor->st = cst->st;
+        cursor->cached = cst;
+        cursor->is_dml = cst->is_dml;
+        return 0;
+    }
+
     sqlite3 *db = conn->db;
     size_t size = strlen(sql);
     int max_length = sqlite3_limit(db, SQLITE_LIMIT_SQL_LENGTH, -1);
@@ -239,6 +407,15 @@ cursor_create_st(struct dvobj_sqlite_cursor *cursor, const char *sql)
     cursor->st = stmt;
     cursor->is_dml = is_dml;
 
+    /* NOTE: the statement is not cached if it fails to allocate the entry */
+    cst = calloc(1, sizeof(*cst) + size + 1);
+    if (cst) {
+        cst->st = stmt;
+        cst->is_dml = is_dml;
+        memcpy(cst->sql, sql, size + 1);
+        cursor->cached = cst;
+    }
+
     return 0;
 
 error:
@@ -367,16 +544,50 @@ out:
     return rc;
 }
 
+/* the options of executemany() */
+struct sqlite_exec_opts {
+    /* roll back the changes made by this call if any of the rows fails */
+    bool                        atomic;
+    /* commits the transaction every `chunk` rows; 0 for never */
+    uint64_t                    chunk;
+};
+
+#define SQLITE_SAVEPOINT_EXECMANY   "purc_executemany"
+
+static inline int
+conn_exec_stmt(struct dvobj_sqlite_connection *conn, const char *sql);
+
+/* commits the rows done, and begins the transaction for the next chunk */
+static int
+cursor_commit_chunk(struct dvobj_sqlite_cursor *cursor, bool atomic)
+{
+    struct dvobj_sqlite_connection *conn = cursor->conn;
+
+    /* NOTE: COMMIT fails if the statement is still running */
+    sqlite3_reset(cursor->st);
+    if ((atomic && conn_exec_stmt(conn,
+                    "RELEASE " SQLITE_SAVEPOINT_EXECMANY) < 0) ||
+            conn_exec_stmt(conn, "COMMIT") < 0 ||
+            conn_exec_stmt(conn, "BEGIN") < 0 ||
+            (atomic && conn_exec_stmt(conn,
+                    "SAVEPOINT " SQLITE_SAVEPOINT_EXECMANY) < 0)) {
+        purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
+                "sqlite error message is %s", sqlite3_errmsg(conn->db));
+        return -1;
+    }
+
+    return 0;
+}
+
 static inline int
 cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
-        const char *sql, purc_variant_t param)
+        const char *sql, purc_variant_t param,
+        const struct sqlite_exec_opts *opts)
 {
-    (void) cursor;
-    (void) multiple;
-    (void) sql;
-    (void) param;
     int rc;
     int ret = -1;
+    bool in_savepoint = false;
+    long committed_rowcount = 0;
     purc_variant_t param_array = PURC_VARIANT_INVALID;
     if (!check_cursor(cursor)) {
         goto failed;
@@ -411,12 +622,8 @@ cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
         cursor->description = PURC_VARIANT_INVALID;
     }
 
-    /* reset stmt : FIXME */
-    if (cursor->st) {
-        sqlite3_reset(cursor->st);
-        sqlite3_finalize(cursor->st);
-        cursor->st = NULL;
-    }
+    /* return the last statement to the cache */
+    cursor_release_st(cursor);
 
     rc = cursor_create_st(cursor, sql);
     if (rc != 0) {
@@ -435,8 +642,20 @@ cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
 
     assert(!sqlite3_stmt_busy(cursor->st));
 
+    if (opts && opts->atomic) {
+        if (conn_exec_stmt(cursor->conn,
+                    "SAVEPOINT " SQLITE_SAVEPOINT_EXECMANY) < 0) {
+            purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
+                    "sqlite error message is %s",
+                    sqlite3_errmsg(cursor->conn->db));
+            goto failed;
+        }
+        in_savepoint = true;
+    }
+
     nr_param_array = purc_variant_array_get_size(param_array);
     for (ssize_t i = 0; i < nr_param_array; i++) {
+
         purc_variant_t val = purc_variant_array_get(param_array, i);
         if (!purc_variant_is_array(val)) {
             purc_set_error_with_info(PURC_ERROR_WRONG_DATA_TYPE,
@@ -445,8 +664,7 @@ cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
         }
 
         /* bind param */
-        ret = bind_parameters(cursor, val);
-        if (ret != 0) {
+        if (bind_parameters(cursor, val) != 0) {
             goto failed;
         }
 
@@ -460,14 +678,15 @@ cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
 
         int numcols = sqlite3_column_count(cursor->st);
         if (cursor->description == PURC_VARIANT_INVALID && numcols > 0) {
-            cursor->description = purc_variant_make_tuple(numcols, NULL);
+            purc_variant_t *names = cursor_get_col_names(cursor, numcols);
+            cursor->description = purc_variant_make_tuple(numcols, names);
             if (!cursor->description) {
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
                 goto failed;
             }
-            for (i = 0; i < numcols; i++) {
+            for (int j = 0; names == NULL && j < numcols; j++) {
                 const char *colname;
-                colname = sqlite3_column_name(cursor->st, i);
+                colname = sqlite3_column_name(cursor->st, j);
                 if (colname == NULL) {
                     purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
                     goto failed;
@@ -476,7 +695,7 @@ cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
                 if (!val) {
                     goto failed;
                 }
-                purc_variant_tuple_set(cursor->description, i, val);
+                purc_variant_tuple_set(cursor->description, j, val);
                 purc_variant_unref(val);
             }
         }
@@ -487,13 +706,44 @@ cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
             }
             sqlite3_reset(cursor->st);
         }
+
+        if (opts && opts->chunk && (uint64_t)(i + 1) % opts->chunk == 0 &&
+                i + 1 < nr_param_array) {
+            if (cursor_commit_chunk(cursor, opts->atomic) < 0) {
+                /* the savepoint is gone if it fails to begin again */
+                in_savepoint = in_savepoint &&
+                    sqlite3_get_autocommit(cursor->conn->db) == 0;
+                goto failed;
+            }
+            committed_rowcount = cursor->rowcount;
+        }
     }
 
     if (!multiple) {
         cursor->lastrowid = sqlite3_last_insert_rowid(cursor->conn->db);
     }
 
+    ret = 0;
+
 failed:
+    if (in_savepoint) {
+        if (ret != 0) {
+            /* undo the rows done after the last commit, but keep the error */
+            struct pcinst *inst = pcinst_current();
+            int errcode = inst ? inst->errcode : 0;
+
+            sqlite3_reset(cursor->st);
+            conn_exec_stmt(cursor->conn,
+                    "ROLLBACK TO " SQLITE_SAVEPOINT_EXECMANY);
+            if (cursor->is_dml)
+                cursor->rowcount = committed_rowcount;
+
+            if (inst)
+                inst->errcode = errcode;
+        }
+        conn_exec_stmt(cursor->conn, "RELEASE " SQLITE_SAVEPOINT_EXECMANY);
+    }
+
     cursor->locked = 0;
 
     if (param_array) {
@@ -1349,13 +1599,13 @@ static purc_variant_t build_column_name(struct dvobj_sqlite_cursor *cursor,
     (void) name_mapping;
     purc_variant_t val = PURC_VARIANT_INVALID;
     if (!name_mapping) {
-        val = purc_variant_make_string(name, true);
+        val = purc_variant_make_string_interned(name, true);
         goto out;
     }
 
     purc_variant_t v = purc_variant_object_get_by_ckey(name_mapping, name);
     if (!v) {
-        val = purc_variant_make_string(name, true);
+        val = purc_variant_make_string_interned(name, true);
         goto out;
     }
 
@@ -1437,6 +1687,13 @@ static purc_variant_t cursor_fetch_one_row_as_object(
         goto fatal;
     }
 
+    /* NOTE: use the column names cached for the statement if possible,
+       so the keys are not made for every row */
+    purc_variant_t *names = NULL;
+    if (!name_mapping) {
+        names = cursor_get_col_names(cursor, nr_cols);
+    }
+
     sqlite3_stmt *st = cursor->st;
     for (int i = 0; i < nr_cols; i++) {
         const char *col_name = sqlite3_column_name(st, i);
@@ -1444,7 +1701,12 @@ static purc_variant_t cursor_fetch_one_row_as_object(
             pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
             goto fatal;
         }
-        key = build_column_name(cursor, i, col_name, name_mapping);
+        if (names) {
+            key = purc_variant_ref(names[i]);
+        }
+        else {
+            key = build_column_name(cursor, i, col_name, name_mapping);
+        }
         if (!key) {
             goto fatal;
         }
@@ -1532,16 +1794,12 @@ static purc_variant_t cursor_iterator_next(struct dvobj_sqlite_cursor *cursor,
         if (cursor->is_dml) {
             cursor->rowcount = (long)sqlite3_changes(cursor->conn->db);
         }
-        sqlite3_reset(cursor->st);
-        sqlite3_finalize(cursor->st);
-        cursor->st = NULL;
+        cursor_release_st(cursor);
     }
     else if (rc != SQLITE_ROW) {
         purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
                 "sqlite error message is %s", sqlite3_errmsg(cursor->conn->db));
-        sqlite3_reset(cursor->st);
-        sqlite3_finalize(cursor->st);
-        cursor->st = NULL;
+        cursor_release_st(cursor);
         purc_variant_unref(row);
         row = PURC_VARIANT_INVALID;
     }
@@ -1550,6 +1808,128 @@ failed:
     return row;
 }
 
+/* fetches the left rows as an object which maps the column names to
+   the arrays of the column values */
+static purc_variant_t cursor_fetch_all_as_columns(
+        struct dvobj_sqlite_cursor *cursor, purc_variant_t name_mapping,
+        purc_variant_t type_conversion)
+{
+    purc_variant_t result = PURC_VARIANT_INVALID;
+    purc_variant_t *columns = NULL;
+    const char **col_names = NULL;
+    int nr_cols = 0;
+
+    if (!check_cursor(cursor)) {
+        goto out;
+    }
+
+    if (cursor->st == NULL ||
+            (nr_cols = sqlite3_data_count(cursor->st)) <= 0) {
+        result = purc_variant_make_null();
+        goto out;
+    }
+
+    columns = calloc(nr_cols, sizeof(purc_variant_t));
+    col_names = calloc(nr_cols, sizeof(const char *));
+    if (columns == NULL || col_names == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out;
+    }
+
+    for (int i = 0; i < nr_cols; i++) {
+        col_names[i] = sqlite3_column_name(cursor->st, i);
+        columns[i] = purc_variant_make_array_0();
+        if (col_names[i] == NULL || columns[i] == PURC_VARIANT_INVALID) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto out;
+        }
+    }
+
+    /* Prevent recursive use of cursors. */
+    cursor->locked = 1;
+
+    int rc;
+    do {
+        for (int i = 0; i < nr_cols; i++) {
+            purc_variant_t val = build_column_value(cursor, i, col_names[i],
+                    type_conversion);
+            if (!val) {
+                cursor->locked = 0;
+                goto out;
+            }
+
+            bool ok = purc_variant_array_append(columns[i], val);
+            purc_variant_unref(val);
+            if (!ok) {
+                cursor->locked = 0;
+                goto out;
+            }
+        }
+    } while ((rc = sqlite3_step(cursor->st)) == SQLITE_ROW);
+
+    cursor->locked = 0;
+
+    if (rc != SQLITE_DONE) {
+        purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
+                "sqlite error message is %s", sqlite3_errmsg(cursor->conn->db));
+        cursor_release_st(cursor);
+        goto out;
+    }
+
+    if (cursor->is_dml) {
+        cursor->rowcount = (long)sqlite3_changes(cursor->conn->db);
+    }
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (!obj) {
+        cursor_release_st(cursor);
+        goto out;
+    }
+
+    purc_variant_t *names = NULL;
+    if (!name_mapping) {
+        names = cursor_get_col_names(cursor, nr_cols);
+    }
+
+    for (int i = 0; i < nr_cols; i++) {
+        purc_variant_t key;
+        if (names) {
+            key = purc_variant_ref(names[i]);
+        }
+        else {
+            key = build_column_name(cursor, i, col_names[i], name_mapping);
+        }
+
+        if (!key || !purc_variant_object_set(obj, key, columns[i])) {
+            if (key) {
+                purc_variant_unref(key);
+            }
+            purc_variant_unref(obj);
+            cursor_release_st(cursor);
+            goto out;
+        }
+        purc_variant_unref(key);
+    }
+
+    /* NOTE: the column names are gone once the statement is released */
+    cursor_release_st(cursor);
+    result = obj;
+
+out:
+    if (columns) {
+        for (int i = 0; i < nr_cols; i++) {
+            if (columns[i]) {
+                purc_variant_unref(columns[i]);
+            }
+        }
+        free(columns);
+    }
+    if (col_names) {
+        free(col_names);
+    }
+    return result;
+}
+
 static inline struct dvobj_sqlite_cursor *
 get_cursor_from_root(purc_variant_t root)
 {
@@ -1598,10 +1978,7 @@ static bool on_sqlite_cursor_being_released(purc_variant_t src, pcvar_op_t op,
 
     if (op == PCVAR_OPERATION_RELEASING) {
         struct dvobj_sqlite_cursor *cursor = ctxt;
-        if (cursor->st) {
-            sqlite3_reset(cursor->st);
-            sqlite3_finalize(cursor->st);
-        }
+        cursor_release_st(cursor);
         destroy_cursor(cursor);
     }
 
@@ -1640,7 +2017,7 @@ static purc_variant_t cursor_execute_getter(purc_variant_t root,
     }
 
     int rc = cursor_exec_query(cursor, false, sql,
-            nr_args > 1 ? argv[1] : PURC_VARIANT_INVALID);
+            nr_args > 1 ? argv[1] : PURC_VARIANT_INVALID, NULL);
     if (rc == 0) {
         ret = true;
     }
@@ -1649,6 +2026,46 @@ failed:
     return purc_variant_make_boolean(ret);
 }
 
+/* parses the options of executemany(): `{ atomic: <boolean>, chunk: <ulong> }`;
+   null for the default options */
+static int parse_exec_opts(purc_variant_t options,
+        struct sqlite_exec_opts *opts)
+{
+    if (purc_variant_is_null(options)) {
+        return 0;
+    }
+
+    if (!purc_variant_is_object(options)) {
+        purc_set_error_with_info(PURC_ERROR_WRONG_DATA_TYPE,
+                "invalid options type '%s'",
+                purc_variant_typename(purc_variant_get_type(options)));
+        return -1;
+    }
+
+    purc_variant_t val;
+    val = purc_variant_object_get_by_ckey(options, "atomic");
+    if (val) {
+        if (!purc_variant_is_boolean(val)) {
+            purc_set_error_with_info(PURC_ERROR_WRONG_DATA_TYPE,
+                    "invalid type of option 'atomic'");
+            return -1;
+        }
+        opts->atomic = purc_variant_is_true(val);
+    }
+
+    val = purc_variant_object_get_by_ckey(options, "chunk");
+    if (val) {
+        if (!purc_variant_cast_to_ulongint(val, &opts->chunk, false)) {
+            purc_set_error_with_info(PURC_ERROR_WRONG_DATA_TYPE,
+                    "invalid type of option 'chunk'");
+            return -1;
+        }
+    }
+
+    purc_clr_error();
+    return 0;
+}
+
 static purc_variant_t cursor_executemany_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
@@ -1680,8 +2097,12 @@ static purc_variant_t cursor_executemany_getter(purc_variant_t root,
         goto failed;
     }
 
-    int rc = cursor_exec_query(cursor, true, sql,
-            nr_args > 1 ? argv[1] : PURC_VARIANT_INVALID);
+    struct sqlite_exec_opts opts = { false, 0 };
+    if (nr_args > 2 && parse_exec_opts(argv[2], &opts) != 0) {
+        goto failed;
+    }
+
+    int rc = cursor_exec_query(cursor, true, sql, argv[1], &opts);
     if (rc == 0) {
         ret = true;
     }
@@ -1690,9 +2111,11 @@ failed:
     return purc_variant_make_boolean(ret);
 }
 
+/* NOTE: *result_type will be PURC_VARIANT_TYPE_ARRAY for `columns`, which is
+   allowed only if `columnar` is true */
 static int parse_fetch_params(size_t nr_args, purc_variant_t *argv,
-        purc_variant_type *result_type, purc_variant_t *name_mapping,
-        purc_variant_t *type_conversion)
+        bool columnar, purc_variant_type *result_type,
+        purc_variant_t *name_mapping, purc_variant_t *type_conversion)
 {
     purc_variant_t val;
     if (nr_args > 0) {
@@ -1710,6 +2133,9 @@ static int parse_fetch_params(size_t nr_args, purc_variant_t *argv,
         else if (strcasecmp(type, "object") == 0) {
             *result_type = PURC_VARIANT_TYPE_OBJECT;
         }
+        else if (columnar && strcasecmp(type, "columns") == 0) {
+            *result_type = PURC_VARIANT_TYPE_ARRAY;
+        }
         else {
             purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
                     "invalid result type '%s'", type);
@@ -1772,8 +2198,8 @@ static purc_variant_t cursor_fetchone_getter(purc_variant_t root,
         goto failed;
     }
 
-    int rc = parse_fetch_params(nr_args, argv, &result_type, &name_mapping,
-            &type_conversion);
+    int rc = parse_fetch_params(nr_args, argv, false, &result_type,
+            &name_mapping, &type_conversion);
     if (rc != 0) {
         goto failed;
     }
@@ -1835,7 +2261,7 @@ static purc_variant_t cursor_fetchmany_getter(purc_variant_t root,
         goto out;
     }
 
-    int rc = parse_fetch_params(nr_args - 1, argv + 1, &result_type,
+    int rc = parse_fetch_params(nr_args - 1, argv + 1, false, &result_type,
             &name_mapping, &type_conversion);
     if (rc != 0) {
         goto failed;
@@ -1898,12 +2324,21 @@ static purc_variant_t cursor_fetchall_getter(purc_variant_t root,
         goto failed;
     }
 
-    int rc = parse_fetch_params(nr_args, argv, &result_type, &name_mapping,
-            &type_conversion);
+    int rc = parse_fetch_params(nr_args, argv, true, &result_type,
+            &name_mapping, &type_conversion);
     if (rc != 0) {
         goto failed;
     }
 
+    if (result_type == PURC_VARIANT_TYPE_ARRAY) {
+        val = cursor_fetch_all_as_columns(cursor, name_mapping,
+                type_conversion);
+        if (!val) {
+            goto failed;
+        }
+        goto out;
+    }
+
     val = cursor_iterator_next(cursor, result_type, name_mapping,
             type_conversion);
 
@@ -1941,6 +2376,132 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/* the native entity returned by $SQLiteCursor.rows() */
+struct sqlite_rows {
+    purc_variant_t                  cursor_root;
+    purc_variant_type               result_type;
+    purc_variant_t                  name_mapping;
+    purc_variant_t                  type_conversion;
+};
+
+static purc_variant_t rows_next_getter(void *native_entity,
+        const char *property_name, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    (void) property_name;
+    (void) nr_args;
+    (void) argv;
+
+    struct sqlite_rows *rows = native_entity;
+    struct dvobj_sqlite_cursor *cursor;
+    cursor = get_cursor_from_root(rows->cursor_root);
+    if (!check_cursor(cursor)) {
+        goto failed;
+    }
+
+    /* NOTE: the statement is released after the last row is fetched */
+    if (cursor->st == NULL) {
+        return purc_variant_make_null();
+    }
+
+    purc_variant_t val = cursor_iterator_next(cursor, rows->result_type,
+            rows->name_mapping, rows->type_conversion);
+    if (val) {
+        return val;
+    }
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY) {
+        return purc_variant_make_undefined();
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_nvariant_method rows_property_getter(void *native_entity,
+        const char *property_name)
+{
+    (void) native_entity;
+
+    if (property_name && strcmp(property_name, PURC_NATIVE_PROP_NEXT) == 0) {
+        return rows_next_getter;
+    }
+
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+}
+
+static void rows_on_release(void *native_entity)
+{
+    struct sqlite_rows *rows = native_entity;
+
+    purc_variant_unref(rows->cursor_root);
+    if (rows->name_mapping) {
+        purc_variant_unref(rows->name_mapping);
+    }
+    if (rows->type_conversion) {
+        purc_variant_unref(rows->type_conversion);
+    }
+    free(rows);
+}
+
+/* returns a native entity which pulls the rows one by one for `iterate` */
+static purc_variant_t cursor_rows_getter(purc_variant_t root,
+            size_t nr_args, purc_variant_t* argv, unsigned call_flags)
+{
+    static struct purc_native_ops rows_ops = {
+        .property_getter = rows_property_getter,
+        .on_release = rows_on_release,
+    };
+
+    purc_variant_type result_type = PURC_VARIANT_TYPE_TUPLE;
+    purc_variant_t name_mapping = PURC_VARIANT_INVALID;
+    purc_variant_t type_conversion = PURC_VARIANT_INVALID;
+    struct sqlite_rows *rows;
+    purc_variant_t val;
+
+    struct dvobj_sqlite_cursor *cursor = get_cursor_from_root(root);
+    if (!check_cursor(cursor)) {
+        goto failed;
+    }
+
+    int rc = parse_fetch_params(nr_args, argv, false, &result_type,
+            &name_mapping, &type_conversion);
+    if (rc != 0) {
+        goto failed;
+    }
+
+    rows = calloc(1, sizeof(*rows));
+    if (rows == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    rows->cursor_root = purc_variant_ref(root);
+    rows->result_type = result_type;
+    if (name_mapping) {
+        rows->name_mapping = purc_variant_ref(name_mapping);
+    }
+    if (type_conversion) {
+        rows->type_conversion = purc_variant_ref(type_conversion);
+    }
+
+    val = purc_variant_make_native_entity(rows, &rows_ops, "sqliteRows");
+    if (val == PURC_VARIANT_INVALID) {
+        rows_on_release(rows);
+        goto failed;
+    }
+
+    return val;
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY) {
+        return purc_variant_make_undefined();
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t cursor_close_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
@@ -1967,11 +2528,7 @@ static purc_variant_t cursor_close_getter(purc_variant_t root,
         goto out;
     }
 
-    if (cursor->st) {
-        sqlite3_reset(cursor->st);
-        sqlite3_finalize(cursor->st);
-        cursor->st = NULL;
-    }
+    cursor_release_st(cursor);
 
     cursor->closed = true;
     ret = true;
@@ -2032,6 +2589,7 @@ create_cursor_variant(struct dvobj_sqlite_connection *sqlite_conn)
         { SQLITE_KEY_FETCHONE,          cursor_fetchone_getter,         NULL },
         { SQLITE_KEY_FETCHMANY,         cursor_fetchmany_getter,        NULL },
         { SQLITE_KEY_FETCHALL,          cursor_fetchall_getter,         NULL },
+        { SQLITE_KEY_ROWS,              cursor_rows_getter,             NULL },
         { SQLITE_KEY_CLOSE,             cursor_close_getter,            NULL },
         { SQLITE_KEY_ROWCOUNT,          cursor_rowcount_getter,         NULL },
         { SQLITE_KEY_LASTROWID,         cursor_lastrowid_getter,        NULL },
@@ -2129,6 +2687,7 @@ create_connection(struct dvobj_sqlite_info *sqlite_info, const char *db_name,
     }
 
     connection->db = db;
+    list_head_init(&connection->stmts);
 
     return connection;
 
@@ -2148,6 +2707,7 @@ static bool on_sqlite_connection_being_released(purc_variant_t src, pcvar_op_t o
     if (op == PCVAR_OPERATION_RELEASING) {
         struct dvobj_sqlite_connection *connection = ctxt;
         purc_variant_revoke_listener(src, connection->listener);
+        conn_clear_cached_stmts(connection);
         if (connection->db) {
             sqlite3_close_v2(connection->db);
         }
@@ -2286,6 +2846,7 @@ static purc_variant_t conn_close_getter(purc_variant_t root,
         goto out;
     }
 
+    conn_clear_cached_stmts(conn);
     int rc = sqlite3_close_v2(conn->db);
     if (rc == SQLITE_OK) {
         ret = true;
@@ -2500,6 +3061,69 @@ fatal:
     return PURC_VARIANT_INVALID;
 }
 
+static const char *connect_pragma_values[][7] = {
+    { "journal_mode", "delete", "truncate", "persist", "memory", "wal", "off" },
+    { "synchronous", "off", "normal", "full", "extra", NULL, NULL },
+};
+
+/* applies the pragmas given in the options of connect() */
+static int apply_connect_pragmas(struct dvobj_sqlite_connection *conn,
+        purc_variant_t options)
+{
+    if (purc_variant_is_null(options)) {
+        return 0;
+    }
+
+    if (!purc_variant_is_object(options)) {
+        purc_set_error_with_info(PURC_ERROR_WRONG_DATA_TYPE,
+                "invalid options type '%s'",
+                purc_variant_typename(purc_variant_get_type(options)));
+        return -1;
+    }
+
+    for (size_t i = 0; i < PCA_TABLESIZE(connect_pragma_values); i++) {
+        const char *pragma = connect_pragma_values[i][0];
+        purc_variant_t val = purc_variant_object_get_by_ckey(options, pragma);
+        if (val == PURC_VARIANT_INVALID) {
+            continue;
+        }
+
+        const char *value = purc_variant_get_string_const(val);
+        if (value == NULL) {
+            purc_set_error_with_info(PURC_ERROR_WRONG_DATA_TYPE,
+                    "invalid type of option '%s'", pragma);
+            return -1;
+        }
+
+        size_t j;
+        for (j = 1; j < PCA_TABLESIZE(connect_pragma_values[i]) &&
+                connect_pragma_values[i][j]; j++) {
+            if (strcasecmp(value, connect_pragma_values[i][j]) == 0)
+                break;
+        }
+
+        if (j == PCA_TABLESIZE(connect_pragma_values[i]) ||
+                connect_pragma_values[i][j] == NULL) {
+            purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
+                    "invalid value of option '%s': %s", pragma, value);
+            return -1;
+        }
+
+        /* NOTE: the value is one from the table, so it is safe to format */
+        char sql[64];
+        snprintf(sql, sizeof(sql), "PRAGMA %s=%s",
+                pragma, connect_pragma_values[i][j]);
+        if (conn_exec_stmt(conn, sql) < 0) {
+            purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
+                    "sqlite error message is %s", sqlite3_errmsg(conn->db));
+            return -1;
+        }
+    }
+
+    purc_clr_error();
+    return 0;
+}
+
 static purc_variant_t connect_getter(purc_variant_t root,
             size_t nr_args, purc_variant_t* argv, unsigned call_flags)
 {
@@ -2568,6 +3192,11 @@ static purc_variant_t connect_getter(purc_variant_t root,
             PCVAR_OPERATION_RELEASING, on_sqlite_connection_being_released,
             sqlite_connection);
 
+    /* NOTE: the journal mode can not be changed inside a transaction */
+    if (nr_args > 1 && apply_connect_pragmas(sqlite_connection, argv[1]) < 0) {
+        goto failed;
+    }
+
     if (conn_exec_stmt(sqlite_connection, "BEGIN") < 0) {
         purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
                 "sqlite error message is %s",
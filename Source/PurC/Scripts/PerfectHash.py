@@ -0,0 +1,115 @@
+#
+# Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+#
+# This file is a part of Purring Cat 2, a HVML parser and interpreter.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+
+"""
+Make perfect hash tables (hash and displace) for a static set of names.
+
+The hash functions must be kept in sync with pcutils_perfect_hash_key() and
+pcutils_perfect_hash_slot() in 'include/private/utils.h':
+
+    key  = FNV-1a (32-bit) of the name in lower case
+    slot = fmix32(key ^ disps[key % nr_disps]) % nr_slots
+
+The names are compared case-insensitively, so two names which differ only
+in case can not be in the same table.
+"""
+
+FNV_PRIME_32B = 0x01000193
+FNV_INIT_32B  = 0x811c9dc5
+
+MAX_DISP = 0xFFFF
+
+def hash_key(name):
+    hval = FNV_INIT_32B
+    for c in name.encode().lower():
+        hval ^= c
+        hval = (hval * FNV_PRIME_32B) & 0xFFFFFFFF
+    return hval
+
+def fmix32(v):
+    v ^= v >> 16
+    v = (v * 0x85ebca6b) & 0xFFFFFFFF
+    v ^= v >> 13
+    v = (v * 0xc2b2ae35) & 0xFFFFFFFF
+    v ^= v >> 16
+    return v
+
+def hash_slot(key, disps, nr_slots):
+    return fmix32(key ^ disps[key % len(disps)]) % nr_slots
+
+def try_make(keys, nr_disps, nr_slots):
+    groups = [[] for i in range(nr_disps)]
+    for idx, key in enumerate(keys):
+        groups[key % nr_disps].append(idx)
+
+    disps = [0] * nr_disps
+    slots = [None] * nr_slots
+    order = sorted(range(nr_disps), key=lambda g: len(groups[g]), reverse=True)
+    for g in order:
+        if len(groups[g]) == 0:
+            break
+
+        for d in range(0, MAX_DISP + 1):
+            taken = []
+            for idx in groups[g]:
+                s = fmix32(keys[idx] ^ d) % nr_slots
+                if slots[s] is not None or s in taken:
+                    break
+                taken.append(s)
+
+            if len(taken) == len(groups[g]):
+                disps[g] = d
+                for idx, s in zip(groups[g], taken):
+                    slots[s] = idx
+                break
+        else:
+            return None
+
+    return disps, slots
+
+def make(names):
+    """
+    Returns (disps, slots) for the list of names; `slots[i]` is the index
+    of the name in `names` which is placed at slot #i, or None.
+    Raises an exception if no table can be made.
+    """
+    lower_names = [n.lower() for n in names]
+    if len(set(lower_names)) != len(lower_names):
+        raise Exception('names differ only in case: {}'.format(names))
+
+    keys = [hash_key(n) for n in names]
+    if len(set(keys)) != len(keys):
+        raise Exception('hash collision in names: {}'.format(names))
+
+    nr = max(len(names), 1)
+    for nr_slots in range(nr, 2 * nr + 1):
+        nr_disps = max(1, nr_slots // 4)
+        while nr_disps <= nr_slots:
+            result = try_make(keys, nr_disps, nr_slots)
+            if result is not None:
+                return result
+            nr_disps *= 2
+
+    raise Exception('failed to make the perfect hash table')
+
+def c_array(values, fmt, per_line=8, indent='    '):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ', '.join(fmt(v) for v in values[i:i + per_line]) + ',')
+    return '\n'.join(lines)
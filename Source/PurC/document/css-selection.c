@@ -114,66 +114,27 @@ node_classes(void *pw, void *n, lwc_string ***classes, uint32_t *n_classes)
     purc_document_t doc = (purc_document_t)pw;
     pcdoc_element_t ele = n;
 
-    lwc_string **my_classes = NULL;
-    uint32_t nr_classes = 0;
-    char *cloned = NULL;
-
-    const char *value;
-    size_t len;
-    value = pcdoc_element_class(doc, ele, &len);
-    if (value == NULL) {
-        goto done;
-    }
-
-    cloned = strndup(value, len);
-    if (cloned == NULL)
+    lwc_string * const *cached;
+    size_t nr_classes;
+    if (pcdoc_element_get_classes(doc, ele, &cached, &nr_classes))
         goto failed;
 
-    char *str;
-    char *saveptr;
-    char *klass;
-    for (str = cloned; ; str = NULL) {
-        klass = strtok_r(str, CLASS_SEPARATOR, &saveptr);
-        if (klass) {
-            nr_classes++;
-            my_classes = (lwc_string **)realloc(my_classes,
-                    sizeof(lwc_string *) * nr_classes);
-            if (my_classes == NULL)
-                goto failed;
-
-            lwc_error ec =
-                lwc_intern_string(klass, strlen(klass),
-                        my_classes + nr_classes - 1);
-            if (ec == lwc_error_oom) {
-                nr_classes--;
-                break;
-            }
-        }
-        else {
-            break;
-        }
-    }
+    lwc_string **my_classes = NULL;
+    if (nr_classes > 0) {
+        /* NOTE: the array will be destroyed by libcss */
+        my_classes = malloc(sizeof(lwc_string *) * nr_classes);
+        if (my_classes == NULL)
+            goto failed;
 
-done:
-    if (cloned)
-        free(cloned);
+        for (size_t i = 0; i < nr_classes; i++)
+            my_classes[i] = lwc_string_ref(cached[i]);
+    }
 
     *classes = my_classes;
-    *n_classes = nr_classes;
+    *n_classes = (uint32_t)nr_classes;
     return CSS_OK;
 
 failed:
-    if (cloned)
-        free(cloned);
-
-    if (my_classes && nr_classes > 0) {
-        for (uint32_t i = 0; i < nr_classes; i++) {
-            lwc_string_destroy(my_classes[i]);
-        }
-
-        free(my_classes);
-    }
-
     *classes = NULL;
     *n_classes = 0;
     return CSS_NOMEM;
@@ -468,32 +429,16 @@ node_has_class(void *pw, void *n, lwc_string *name, bool *match)
     pcdoc_element_t ele = n;
     *match = false;
 
-    const char *str1;
-    size_t len1;
-    str1 = pcdoc_element_class(doc, ele, &len1);
-    if (str1) {
-        const char *str2 = lwc_string_data(name);
-        size_t len2 = lwc_string_length(name);
-
-        char *haystack = strndup(str1, len1);
-
-        char *str;
-        char *saveptr;
-        char *klass;
-        for (str = haystack; ; str = NULL) {
-            klass = strtok_r(str, CLASS_SEPARATOR, &saveptr);
-            if (klass == NULL) {
-                break;
-            }
-
-            /* to match values caseinsensitively */
-            if (klass && strncasecmp(klass, str2, len2) == 0) {
-                *match = true;
-                break;
-            }
-        }
+    lwc_string * const *classes;
+    size_t nr_classes;
+    if (pcdoc_element_get_classes(doc, ele, &classes, &nr_classes))
+        return CSS_OK;
 
-        free(haystack);
+    for (size_t i = 0; i < nr_classes; i++) {
+        /* to match values caseinsensitively */
+        if (lwc_string_caseless_isequal(classes[i], name, match) ==
+                lwc_error_ok && *match)
+            break;
     }
 
     return CSS_OK;
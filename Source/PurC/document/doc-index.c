@@ -0,0 +1,408 @@
+/**
+ * @file doc-index.c
+ * @date 2026/10/14
+ * @brief The indexes of the elements by id, class, and tag for selecting.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "purc-document.h"
+#include "purc-errors.h"
+
+#include "private/document.h"
+
+#include <ctype.h>
+
+#define CLASS_SEPARATOR " \f\n\r\t\v"
+#define SPACE_CHARS     " \f\n\r\t"
+
+#define NR_INDEX_MAPS   (PCDOC_INDEX_KEY_TAG - PCDOC_INDEX_KEY_NONE)
+
+/*
+ * The indexes map the lower-cased ids, class names, and tag names to
+ * the arrays of the elements in the document order. They are built in
+ * one pass of the document, and remain valid as long as the age of
+ * the document is not changed by a change of the structure or the
+ * indexed attributes (see pcdoc_index_keep()).
+ */
+struct pcdoc_index {
+    unsigned        age;        /* the age of the document when built */
+    unsigned        miss_age;   /* the age of the document when missed */
+    unsigned        built:1;
+    unsigned        missed:1;
+
+    pcutils_uomap  *maps[NR_INDEX_MAPS];
+};
+
+static inline bool
+is_ident_char(unsigned char c)
+{
+    return isalnum(c) || c == '-' || c == '_' || c >= 0x80;
+}
+
+/* skips a block started by @p till the closing character out of quotes */
+static const char *
+skip_block(const char *p, const char *end, char open, char close)
+{
+    int depth = 0;
+    char quote = 0;
+
+    for (; p < end; p++) {
+        char c = *p;
+        if (quote) {
+            if (c == '\\' && p + 1 < end)
+                p++;
+            else if (c == quote)
+                quote = 0;
+        }
+        else if (c == '"' || c == '\'') {
+            quote = c;
+        }
+        else if (c == open) {
+            depth++;
+        }
+        else if (c == close && --depth == 0) {
+            return p + 1;
+        }
+    }
+
+    return NULL;
+}
+
+static char *
+lower_key(const char *key, size_t len)
+{
+    char *lower = strndup(key, len);
+    if (lower) {
+        for (size_t i = 0; i < len; i++)
+            lower[i] = tolower((unsigned char)lower[i]);
+    }
+
+    return lower;
+}
+
+char *
+pcdoc_index_key_from_selector(const char *selector, pcdoc_index_key_k *type)
+{
+    const char *end = selector + strlen(selector);
+    while (end > selector && strchr(SPACE_CHARS, end[-1]))
+        end--;
+
+    /* find the start of the rightmost compound */
+    const char *compound = selector;
+    int depth = 0;
+    char quote = 0;
+    for (const char *p = selector; p < end; p++) {
+        char c = *p;
+        if (quote) {
+            if (c == '\\' && p + 1 < end)
+                p++;
+            else if (c == quote)
+                quote = 0;
+            continue;
+        }
+
+        if (c == '"' || c == '\'') {
+            quote = c;
+        }
+        else if (c == '(' || c == '[') {
+            depth++;
+        }
+        else if (c == ')' || c == ']') {
+            if (depth > 0)
+                depth--;
+        }
+        else if (c == '\\') {
+            /* NOTE: the escaped identifiers are not supported. */
+            return NULL;
+        }
+        else if (depth == 0) {
+            if (c == ',')
+                return NULL;
+            if (c == '>' || c == '+' || c == '~' || strchr(SPACE_CHARS, c))
+                compound = p + 1;
+        }
+    }
+
+    const char *p = compound;
+    const char *keys[NR_INDEX_MAPS] = { NULL };
+    size_t lens[NR_INDEX_MAPS] = { 0 };
+
+    if (p < end && is_ident_char(*p)) {
+        keys[PCDOC_INDEX_KEY_TAG - 1] = p;
+        while (p < end && is_ident_char(*p))
+            p++;
+        lens[PCDOC_INDEX_KEY_TAG - 1] = p - keys[PCDOC_INDEX_KEY_TAG - 1];
+    }
+    else if (p < end && *p == '*') {
+        p++;
+    }
+
+    while (p < end) {
+        if (*p == '#' || *p == '.') {
+            int i = (*p == '#') ? PCDOC_INDEX_KEY_ID - 1 :
+                PCDOC_INDEX_KEY_CLASS - 1;
+            const char *start = ++p;
+            while (p < end && is_ident_char(*p))
+                p++;
+            if (p == start)
+                return NULL;
+            if (keys[i] == NULL) {
+                keys[i] = start;
+                lens[i] = p - start;
+            }
+        }
+        else if (*p == '[') {
+            p = skip_block(p, end, '[', ']');
+        }
+        else if (*p == ':') {
+            while (p < end && *p == ':')
+                p++;
+            while (p < end && is_ident_char(*p))
+                p++;
+            if (p < end && *p == '(')
+                p = skip_block(p, end, '(', ')');
+        }
+        else {
+            /* the namespace prefix and so on */
+            return NULL;
+        }
+
+        if (p == NULL)
+            return NULL;
+    }
+
+    /* use the most selective one */
+    for (int i = 0; i < NR_INDEX_MAPS; i++) {
+        if (keys[i]) {
+            *type = (pcdoc_index_key_k)(i + 1);
+            return lower_key(keys[i], lens[i]);
+        }
+    }
+
+    return NULL;
+}
+
+static void
+free_elem_array(void *val)
+{
+    pcutils_arrlist_free((struct pcutils_arrlist *)val);
+}
+
+static struct pcdoc_index *
+index_new(void)
+{
+    struct pcdoc_index *index = calloc(1, sizeof(*index));
+    if (index == NULL)
+        return NULL;
+
+    for (int i = 0; i < NR_INDEX_MAPS; i++) {
+        index->maps[i] = pcutils_uomap_create(copy_key_string,
+                free_key_string, NULL, free_elem_array,
+                pchash_fnv1a_str_hash, comp_key_string, false, false);
+        if (index->maps[i] == NULL)
+            goto failed;
+    }
+
+    return index;
+
+failed:
+    for (int i = 0; i < NR_INDEX_MAPS; i++) {
+        if (index->maps[i])
+            pcutils_uomap_destroy(index->maps[i]);
+    }
+    free(index);
+    return NULL;
+}
+
+static int
+index_add(struct pcdoc_index *index, pcdoc_index_key_k type,
+        const char *key, size_t len, pcdoc_element_t elem)
+{
+    char *lower = lower_key(key, len);
+    if (lower == NULL)
+        return -1;
+
+    pcutils_uomap *map = index->maps[type - 1];
+    pcutils_uomap_entry *entry = pcutils_uomap_find(map, lower);
+    struct pcutils_arrlist *elems;
+    int ret = -1;
+
+    if (entry) {
+        elems = pcutils_uomap_entry_val(entry);
+
+        /* the duplicate class names of an element */
+        size_t nr = pcutils_arrlist_length(elems);
+        if (nr > 0 && pcutils_arrlist_get_idx(elems, nr - 1) == elem) {
+            ret = 0;
+            goto done;
+        }
+    }
+    else {
+        elems = pcutils_arrlist_new_ex(NULL, 4);
+        if (elems == NULL)
+            goto done;
+
+        if (pcutils_uomap_insert(map, lower, elems)) {
+            pcutils_arrlist_free(elems);
+            goto done;
+        }
+    }
+
+    ret = pcutils_arrlist_append(elems, elem);
+
+done:
+    free(lower);
+    return ret;
+}
+
+static int
+index_classes(struct pcdoc_index *index, const char *value, size_t len,
+        pcdoc_element_t elem)
+{
+    char *haystack = strndup(value, len);
+    if (haystack == NULL)
+        return -1;
+
+    int ret = 0;
+    char *str;
+    char *saveptr;
+    char *token;
+    for (str = haystack; ; str = NULL) {
+        token = strtok_r(str, CLASS_SEPARATOR, &saveptr);
+        if (token == NULL)
+            break;
+
+        if (index_add(index, PCDOC_INDEX_KEY_CLASS, token, strlen(token),
+                    elem)) {
+            ret = -1;
+            break;
+        }
+    }
+
+    free(haystack);
+    return ret;
+}
+
+static int
+index_elem_cb(purc_document_t doc, pcdoc_element_t elem, void *ctxt)
+{
+    struct pcdoc_index *index = ctxt;
+    const char *value;
+    size_t len;
+
+    if (pcdoc_element_get_tag_name(doc, elem, &value, &len,
+                NULL, NULL, NULL, NULL) == 0 && value && len > 0) {
+        if (index_add(index, PCDOC_INDEX_KEY_TAG, value, len, elem))
+            return PCDOC_TRAVEL_STOP;
+    }
+
+    value = pcdoc_element_id(doc, elem, &len);
+    if (value && len > 0) {
+        if (index_add(index, PCDOC_INDEX_KEY_ID, value, len, elem))
+            return PCDOC_TRAVEL_STOP;
+    }
+
+    value = pcdoc_element_class(doc, elem, &len);
+    if (value && len > 0) {
+        if (index_classes(index, value, len, elem))
+            return PCDOC_TRAVEL_STOP;
+    }
+
+    return PCDOC_TRAVEL_GOON;
+}
+
+static void
+index_clear(struct pcdoc_index *index)
+{
+    for (int i = 0; i < NR_INDEX_MAPS; i++)
+        pcutils_uomap_clear(index->maps[i]);
+    index->built = 0;
+}
+
+static int
+index_build(purc_document_t doc, struct pcdoc_index *index)
+{
+    index_clear(index);
+
+    if (pcdoc_travel_descendant_elements(doc, NULL, index_elem_cb,
+                index, NULL)) {
+        index_clear(index);
+        return -1;
+    }
+
+    index->built = 1;
+    index->age = doc->age;
+    return 0;
+}
+
+int
+pcdoc_index_lookup(purc_document_t doc, pcdoc_selector_t selector,
+        struct pcutils_arrlist **candidates)
+{
+    if (selector->key == NULL || doc->ops->travel == NULL)
+        return -1;
+
+    struct pcdoc_index *index = doc->index;
+    if (index == NULL) {
+        if ((index = index_new()) == NULL)
+            return -1;
+        doc->index = index;
+    }
+
+    if (!index->built || index->age != doc->age) {
+        /* NOTE: the indexes are only (re)built when the document is
+           selected the second time in the same age, so a document
+           changed between every two selections costs no more than
+           travelling it. */
+        if (!index->missed || index->miss_age != doc->age) {
+            index->missed = 1;
+            index->miss_age = doc->age;
+            return -1;
+        }
+
+        if (index_build(doc, index))
+            return -1;
+    }
+
+    pcutils_uomap_entry *entry;
+    entry = pcutils_uomap_find(index->maps[selector->key_type - 1],
+            selector->key);
+    *candidates = entry ? pcutils_uomap_entry_val(entry) : NULL;
+    return 0;
+}
+
+void
+pcdoc_index_keep(purc_document_t doc)
+{
+    struct pcdoc_index *index = doc->index;
+    if (index && index->built && index->age + 1 == doc->age)
+        index->age = doc->age;
+}
+
+void
+pcdoc_index_delete(purc_document_t doc)
+{
+    struct pcdoc_index *index = doc->index;
+    if (index) {
+        for (int i = 0; i < NR_INDEX_MAPS; i++)
+            pcutils_uomap_destroy(index->maps[i]);
+        free(index);
+        doc->index = NULL;
+    }
+}
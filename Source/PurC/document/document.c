@@ -26,6 +26,7 @@
 #include "purc-errors.h"
 
 #include "private/document.h"
+#include "private/instance.h"
 #include "private/stringbuilder.h"
 #include "csseng/csseng.h"
 
@@ -146,6 +147,16 @@ purc_document_get_refc(purc_document_t doc)
     return doc->refc;
 }
 
+static void
+document_cleanup(purc_document_t doc)
+{
+    pcdoc_index_delete(doc);
+    if (doc->class_lists) {
+        pcutils_uomap_destroy(doc->class_lists);
+        doc->class_lists = NULL;
+    }
+}
+
 purc_document_t
 purc_document_ref(purc_document_t doc)
 {
@@ -160,6 +171,7 @@ purc_document_unref(purc_document_t doc)
 
     unsigned int refc = doc->refc;
     if (refc == 0) {
+        document_cleanup(doc);
         doc->ops->destroy(doc);
     }
 
@@ -178,36 +190,166 @@ unsigned int
 purc_document_delete(purc_document_t doc)
 {
     unsigned int refc = doc->refc;
+    document_cleanup(doc);
     doc->ops->destroy(doc);
     return refc;
 }
 
+int
+purc_document_get_mem_stat(purc_document_t doc,
+        struct purc_document_mem_stat *stat)
+{
+    if (doc == NULL || stat == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (doc->ops->get_mem_stat == NULL) {
+        purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return -1;
+    }
+
+    memset(stat, 0, sizeof(*stat));
+    return doc->ops->get_mem_stat(doc, stat);
+}
+
 pcdoc_element_t
 purc_document_special_elem(purc_document_t doc, pcdoc_special_elem_k elem)
 {
     return doc->ops->special_elem(doc, elem);
 }
 
+/* whether an operation on the content keeps the child elements */
+static inline bool
+is_op_to_add(pcdoc_operation_k op)
+{
+    return op == PCDOC_OP_APPEND || op == PCDOC_OP_PREPEND ||
+        op == PCDOC_OP_INSERTBEFORE || op == PCDOC_OP_INSERTAFTER;
+}
+
+static int
+forget_class_list_cb(purc_document_t doc, pcdoc_element_t element, void *ctxt)
+{
+    if (element != ctxt)
+        pcutils_uomap_erase(doc->class_lists, element);
+    return PCDOC_TRAVEL_GOON;
+}
+
+/*
+ * Forgets the cached class lists of the descendants of @elem, and the one
+ * of @elem itself if @self is true, before they are destroyed; otherwise
+ * a new element allocated at the same address would get a stale one.
+ */
+static void
+forget_class_lists(purc_document_t doc, pcdoc_element_t elem, bool self)
+{
+    if (doc->class_lists == NULL ||
+            pcutils_uomap_get_size(doc->class_lists) == 0)
+        return;
+
+    if (self)
+        pcutils_uomap_erase(doc->class_lists, elem);
+    pcdoc_travel_descendant_elements(doc, elem, forget_class_list_cb,
+            elem, NULL);
+}
+
+static void
+select_descendants(purc_document_t doc, pcdoc_element_t ancestor,
+        pcdoc_selector_t selector, pcdoc_elem_coll_t coll);
+
+/*
+ * A collection queried from the document is pending till its members
+ * are accessed: only the first element is looked for if only the first
+ * one is wanted, e.g., by `$DOC.query(...).attr(...)`. The pending
+ * collections of a document are materialized before the document is
+ * changed, so that they are still the snapshots in the age they were
+ * created or updated.
+ */
+static void
+coll_set_pending(purc_document_t doc, pcdoc_elem_coll_t coll)
+{
+    if (doc->lazy_colls.next == NULL)
+        list_head_init(&doc->lazy_colls);
+
+    if (!coll->pending) {
+        coll->pending = 1;
+        list_add_tail(&coll->ln, &doc->lazy_colls);
+    }
+
+    coll->first_found = 0;
+    coll->first = NULL;
+}
+
+static void
+coll_materialize(purc_document_t doc, pcdoc_elem_coll_t coll)
+{
+    list_del(&coll->ln);
+    coll->pending = 0;
+    coll->first_found = 0;
+    coll->first = NULL;
+
+    if (coll->nr_elems > 0) {
+        struct pcutils_arrlist *elems = pcutils_arrlist_new_ex(NULL, 4);
+        if (elems == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return;
+        }
+
+        pcutils_arrlist_free(coll->elems);
+        coll->elems = elems;
+        coll->nr_elems = 0;
+    }
+
+    select_descendants(doc, coll->ancestor, coll->selector, coll);
+}
+
+static inline void
+coll_ensure_elems(pcdoc_elem_coll_t coll)
+{
+    if (coll->pending)
+        coll_materialize(coll->doc, coll);
+}
+
+/* called by all the operations changing the document before the age bumps */
+static void
+document_changing(purc_document_t doc)
+{
+    if (doc->lazy_colls.next == NULL)
+        return;
+
+    while (!list_empty(&doc->lazy_colls)) {
+        coll_materialize(doc, list_first_entry(&doc->lazy_colls,
+                    struct pcdoc_elem_coll, ln));
+    }
+}
+
 pcdoc_element_t
 pcdoc_element_new_element(purc_document_t doc,
         pcdoc_element_t elem, pcdoc_operation_k op,
         const char *tag, bool self_close)
 {
+    document_changing(doc);
     doc->age++;
+    if (!is_op_to_add(op))
+        forget_class_lists(doc, elem, op == PCDOC_OP_ERASE);
     return doc->ops->operate_element(doc, elem, op, tag, self_close);
 }
 
 void
 pcdoc_element_clear(purc_document_t doc, pcdoc_element_t elem)
 {
+    document_changing(doc);
     doc->age++;
+    forget_class_lists(doc, elem, false);
     doc->ops->operate_element(doc, elem, PCDOC_OP_CLEAR, NULL, 0);
 }
 
 void
 pcdoc_element_erase(purc_document_t doc, pcdoc_element_t elem)
 {
+    document_changing(doc);
     doc->age++;
+    forget_class_lists(doc, elem, true);
     doc->ops->operate_element(doc, elem, PCDOC_OP_ERASE, NULL, 0);
 }
 
@@ -216,7 +358,12 @@ pcdoc_element_new_text_content(purc_document_t doc,
         pcdoc_element_t elem, pcdoc_operation_k op,
         const char *text, size_t len)
 {
+    document_changing(doc);
     doc->age++;
+    if (is_op_to_add(op))
+        pcdoc_index_keep(doc);
+    else
+        forget_class_lists(doc, elem, false);
     return doc->ops->new_text_content(doc, elem, op, text, len);
 }
 
@@ -225,7 +372,12 @@ pcdoc_element_set_data_content(purc_document_t doc,
         pcdoc_element_t elem, pcdoc_operation_k op,
         purc_variant_t data)
 {
+    document_changing(doc);
     doc->age++;
+    if (is_op_to_add(op))
+        pcdoc_index_keep(doc);
+    else
+        forget_class_lists(doc, elem, false);
     if (doc->ops->new_data_content)
         return doc->ops->new_data_content(doc, elem, op, data);
 
@@ -238,10 +390,42 @@ pcdoc_element_new_content(purc_document_t doc,
         pcdoc_element_t elem, pcdoc_operation_k op,
         const char *content, size_t len)
 {
+    document_changing(doc);
     doc->age++;
+    if (!is_op_to_add(op))
+        forget_class_lists(doc, elem, false);
     return doc->ops->new_content(doc, elem, op, content, len);
 }
 
+pcdoc_node
+pcdoc_element_new_tpl_content(purc_document_t doc,
+        pcdoc_element_t elem, pcdoc_operation_k op,
+        struct pcdoc_tpl_content *content)
+{
+    pcdoc_node node = { .type = PCDOC_NODE_VOID, .data = NULL };
+
+    if (doc->ops->new_tpl_content == NULL || content->uncompilable ||
+            (content->compiler && content->compiler != doc->ops))
+        return node;
+
+    document_changing(doc);
+    doc->age++;
+    if (!is_op_to_add(op))
+        forget_class_lists(doc, elem, false);
+    return doc->ops->new_tpl_content(doc, elem, op, content);
+}
+
+void
+pcdoc_tpl_content_release(struct pcdoc_tpl_content *content)
+{
+    if (content->compiled && content->compiler->free_tpl_compiled)
+        content->compiler->free_tpl_compiled(content->compiled);
+
+    content->compiled = NULL;
+    content->compiler = NULL;
+    content->uncompilable = false;
+}
+
 int
 pcdoc_element_get_tag_name(purc_document_t doc, pcdoc_element_t elem,
         const char **local_name, size_t *local_len,
@@ -259,7 +443,12 @@ pcdoc_element_set_attribute(purc_document_t doc,
         pcdoc_element_t elem, pcdoc_operation_k op,
         const char *name, const char *val, size_t len)
 {
+    document_changing(doc);
     doc->age++;
+    if (name && strcasecmp(name, "id") && strcasecmp(name, "class"))
+        pcdoc_index_keep(doc);
+    else if (name && doc->class_lists && strcasecmp(name, "class") == 0)
+        pcutils_uomap_erase(doc->class_lists, elem);
     if (doc->ops->set_attribute) {
         return doc->ops->set_attribute(doc, elem, op, name, val, len);
     }
@@ -299,42 +488,132 @@ pcdoc_element_get_special_attr(purc_document_t doc, pcdoc_element_t elem,
 
 #define CLASS_SEPARATOR " \f\n\r\t\v"
 
+/* the class names of an element interned, in the order of appearance */
+struct pcdoc_class_list {
+    size_t          nr_classes;
+    lwc_string     *classes[];
+};
+
+static void
+free_class_list(void *val)
+{
+    struct pcdoc_class_list *list = val;
+    for (size_t i = 0; i < list->nr_classes; i++)
+        lwc_string_unref(list->classes[i]);
+    free(list);
+}
+
+static struct pcdoc_class_list *
+class_list_new(purc_document_t doc, pcdoc_element_t elem)
+{
+    const char *value;
+    size_t len;
+    value = pcdoc_element_class(doc, elem, &len);
+
+    size_t nr = 0;
+    const char *end = value ? value + len : NULL;
+    for (const char *p = value; p < end; ) {
+        p += strspn(p, CLASS_SEPARATOR);
+        if (p >= end)
+            break;
+        p += strcspn(p, CLASS_SEPARATOR);
+        nr++;
+    }
+
+    struct pcdoc_class_list *list;
+    list = malloc(sizeof(*list) + sizeof(lwc_string *) * nr);
+    if (list == NULL)
+        goto failed;
+
+    list->nr_classes = 0;
+    for (const char *p = value; list->nr_classes < nr; ) {
+        p += strspn(p, CLASS_SEPARATOR);
+        size_t n = strcspn(p, CLASS_SEPARATOR);
+        /* NOTE: the value may not be terminated by a separator or null */
+        if (p + n > end)
+            n = end - p;
+
+        if (lwc_intern_string(p, n, list->classes + list->nr_classes)
+                != lwc_error_ok) {
+            free_class_list(list);
+            goto failed;
+        }
+        list->nr_classes++;
+        p += n;
+    }
+
+    return list;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
+}
+
+static struct pcdoc_class_list *
+get_class_list(purc_document_t doc, pcdoc_element_t elem)
+{
+    if (doc->class_lists == NULL) {
+        doc->class_lists = pcutils_uomap_create(NULL, NULL, NULL,
+                free_class_list, pchash_fnv1a_ptr_hash, pchash_ptr_equal,
+                false, false);
+        if (doc->class_lists == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return NULL;
+        }
+    }
+
+    pcutils_uomap_entry *entry = pcutils_uomap_find(doc->class_lists, elem);
+    if (entry)
+        return pcutils_uomap_entry_val(entry);
+
+    struct pcdoc_class_list *list = class_list_new(doc, elem);
+    if (list && pcutils_uomap_insert(doc->class_lists, elem, list)) {
+        free_class_list(list);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        list = NULL;
+    }
+
+    return list;
+}
+
+int
+pcdoc_element_get_classes(purc_document_t doc, pcdoc_element_t elem,
+        lwc_string * const **classes, size_t *nr_classes)
+{
+    struct pcdoc_class_list *list = get_class_list(doc, elem);
+    if (list == NULL)
+        return -1;
+
+    *classes = list->classes;
+    *nr_classes = list->nr_classes;
+    return 0;
+}
+
 int
 pcdoc_element_has_class(purc_document_t doc, pcdoc_element_t elem,
         const char *klass, bool *found)
 {
-    const char *value;
-    size_t len;
+    lwc_string * const *classes;
+    size_t nr_classes;
 
     // must be a valid attribute name (without space characters)
     if (!purc_is_valid_identifier(klass))
         return -1;
 
     *found = false;
-    value = pcdoc_element_class(doc, elem, &len);
-    if (value == NULL) {
-        return 0;
-    }
-
-    char *haystack = strndup(value, len);
+    if (pcdoc_element_get_classes(doc, elem, &classes, &nr_classes))
+        return -1;
 
-    char *str;
-    char *saveptr;
-    char *token;
-    for (str = haystack; ; str = NULL) {
-        token = strtok_r(str, CLASS_SEPARATOR, &saveptr);
+    size_t len = strlen(klass);
+    for (size_t i = 0; i < nr_classes; i++) {
         /* to match class name caseinsensitively */
-        if (token) {
-            if (strcasecmp(token, klass) == 0) {
-                *found = true;
-                break;
-            }
-        }
-        else
+        if (lwc_string_length(classes[i]) == len &&
+                strncasecmp(lwc_string_data(classes[i]), klass, len) == 0) {
+            *found = true;
             break;
+        }
     }
 
-    free(haystack);
     return 0;
 }
 
@@ -715,6 +994,12 @@ selector_delete(pcdoc_selector_t selector)
         if (selector->id) {
             free(selector->id);
         }
+        if (selector->key) {
+            free(selector->key);
+        }
+        if (selector->text) {
+            free(selector->text);
+        }
         free(selector);
     }
 }
@@ -729,21 +1014,39 @@ pcdoc_selector_ref(pcdoc_selector_t selector)
 static void
 pcdoc_selector_unref(pcdoc_selector_t selector)
 {
-    if (selector->refc <= 1) {
+    assert(selector->refc > 0);
+
+    /* the cached selector is freed when it is evicted */
+    if (--selector->refc == 0 && !selector->cached) {
         selector_delete(selector);
     }
-    else {
-        selector->refc--;
-    }
 }
 
-pcdoc_selector_t
-pcdoc_selector_new(const char *selector)
+/*
+ * NOTE: the selectors used by `$DOC.query()`, the element collections and
+ * `observe` are compiled once per instance, like the regular expressions;
+ * a program uses a few distinct selectors, so a list in LRU order is
+ * enough for the lookup. The compiled selector does not depend on the type
+ * of the document.
+ */
+#define MAX_CACHED_SELECTORS    32
+
+static void
+uncache_selector(struct pcinst *inst, pcdoc_selector_t selector)
+{
+    list_del(&selector->ln);
+    inst->nr_selectors--;
+    selector->cached = false;
+
+    /* the selector being used is freed when it is released */
+    if (selector->refc == 0)
+        selector_delete(selector);
+}
+
+static pcdoc_selector_t
+selector_compile(const char *selector)
 {
     pcdoc_selector_t ret = NULL;
-    if (!selector) {
-        goto out;
-    }
 
     ret = (pcdoc_selector_t) calloc(1, sizeof(*ret));
     if (!ret) {
@@ -759,8 +1062,9 @@ pcdoc_selector_new(const char *selector)
         if (err != CSS_OK) {
             goto out_clear_ret;
         }
-    }
 
+        ret->key = pcdoc_index_key_from_selector(selector, &ret->key_type);
+    }
 
     ret->refc = 1;
     goto out;
@@ -773,6 +1077,46 @@ out:
     return ret;
 }
 
+pcdoc_selector_t
+pcdoc_selector_new(const char *selector)
+{
+    if (!selector) {
+        return NULL;
+    }
+
+    struct pcinst *inst = pcinst_current();
+    bool use_cache = inst && inst->selectors.next;
+    pcdoc_selector_t ret;
+
+    if (use_cache) {
+        list_for_each_entry(ret, &inst->selectors, ln) {
+            if (strcmp(ret->text, selector) == 0) {
+                list_move(&ret->ln, &inst->selectors);
+                inst->nr_selector_hits++;
+                return pcdoc_selector_ref(ret);
+            }
+        }
+    }
+
+    ret = selector_compile(selector);
+    if (ret && use_cache) {
+        inst->nr_selector_misses++;
+        if ((ret->text = strdup(selector)) == NULL)
+            return ret;
+
+        if (inst->nr_selectors >= MAX_CACHED_SELECTORS) {
+            uncache_selector(inst, list_last_entry(&inst->selectors,
+                        struct pcdoc_selector, ln));
+        }
+
+        list_add(&ret->ln, &inst->selectors);
+        inst->nr_selectors++;
+        ret->cached = true;
+    }
+
+    return ret;
+}
+
 int
 pcdoc_selector_delete(pcdoc_selector_t selector)
 {
@@ -780,6 +1124,43 @@ pcdoc_selector_delete(pcdoc_selector_t selector)
     return 0;
 }
 
+size_t
+pcdoc_selector_cache_trim(size_t nr_keep)
+{
+    struct pcinst *inst = pcinst_current();
+    size_t nr_uncached = 0;
+
+    if (inst == NULL || inst->selectors.next == NULL)
+        return 0;
+
+    while (inst->nr_selectors > nr_keep) {
+        uncache_selector(inst, list_last_entry(&inst->selectors,
+                    struct pcdoc_selector, ln));
+        nr_uncached++;
+    }
+
+    return nr_uncached;
+}
+
+int
+pcdoc_selector_cache_get_stat(size_t *nr_cached,
+        size_t *nr_hits, size_t *nr_misses)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return -1;
+    }
+
+    if (nr_cached)
+        *nr_cached = inst->nr_selectors;
+    if (nr_hits)
+        *nr_hits = inst->nr_selector_hits;
+    if (nr_misses)
+        *nr_misses = inst->nr_selector_misses;
+    return 0;
+}
+
 struct travel_elem_id {
     pcdoc_element_t elem;
     const char     *id;
@@ -854,6 +1235,66 @@ travel_find_elem_cb(purc_document_t doc, pcdoc_element_t element, void *ctxt)
     return PCDOC_TRAVEL_GOON;
 }
 
+/* whether @elem is @ancestor itself or a descendant of it */
+static bool
+is_in_scope(purc_document_t doc, pcdoc_element_t ancestor,
+        pcdoc_element_t elem)
+{
+    pcdoc_node node;
+    node.type = PCDOC_NODE_ELEMENT;
+    node.elem = elem;
+
+    while (node.elem) {
+        if (node.elem == ancestor)
+            return true;
+        node.elem = doc->ops->get_parent(doc, node);
+    }
+
+    return false;
+}
+
+/*
+ * Matches the candidates got from the indexes in the scope of @ancestor:
+ * appends the matched ones to @coll, or returns the first one if @coll
+ * is NULL.
+ */
+static pcdoc_element_t
+match_candidates(purc_document_t doc, pcdoc_element_t ancestor,
+        struct pcutils_arrlist *candidates, pcdoc_selector_t selector,
+        pcdoc_elem_coll_t coll)
+{
+    if (candidates == NULL)
+        return NULL;
+
+    pcdoc_element_t root = doc->ops->special_elem(doc,
+            PCDOC_SPECIAL_ELEM_ROOT);
+    size_t nr = pcutils_arrlist_length(candidates);
+
+    doc->root4select = ancestor;
+    for (size_t i = 0; i < nr; i++) {
+        pcdoc_element_t elem = pcutils_arrlist_get_idx(candidates, i);
+        if (ancestor != root && !is_in_scope(doc, ancestor, elem))
+            continue;
+
+        bool match = false;
+        css_element_selector_match(selector->selector, elem,
+                &purc_document_css_select_handler, doc, &match);
+        if (!match)
+            continue;
+
+        if (coll == NULL) {
+            doc->root4select = NULL;
+            return elem;
+        }
+
+        pcutils_arrlist_append(coll->elems, elem);
+        coll->nr_elems++;
+    }
+    doc->root4select = NULL;
+
+    return NULL;
+}
+
 pcdoc_element_t
 pcdoc_find_element_in_descendants(purc_document_t doc,
         pcdoc_element_t ancestor, pcdoc_selector_t selector)
@@ -874,6 +1315,12 @@ pcdoc_find_element_in_descendants(purc_document_t doc,
         goto out;
     }
 
+    struct pcutils_arrlist *candidates;
+    if (pcdoc_index_lookup(doc, selector, &candidates) == 0) {
+        ret = match_candidates(doc, ancestor, candidates, selector, NULL);
+        goto out;
+    }
+
     struct travel_find_elem data = {
         .selector = selector,
         .elem = NULL
@@ -920,6 +1367,10 @@ element_collection_unref(purc_document_t doc, pcdoc_elem_coll_t coll)
     UNUSED_PARAM(doc);
 
     if (coll->refc <= 1) {
+        if (coll->pending) {
+            list_del(&coll->ln);
+        }
+
         if (coll->selector) {
             pcdoc_selector_unref(coll->selector);
         }
@@ -956,6 +1407,27 @@ travel_select_elem_cb(purc_document_t doc, pcdoc_element_t element, void *ctxt)
     return PCDOC_TRAVEL_GOON;
 }
 
+static void
+select_descendants(purc_document_t doc, pcdoc_element_t ancestor,
+        pcdoc_selector_t selector, pcdoc_elem_coll_t coll)
+{
+    if (ancestor == NULL) {
+        ancestor = doc->ops->special_elem(doc,
+                PCDOC_SPECIAL_ELEM_ROOT);
+    }
+
+    struct pcutils_arrlist *candidates;
+    if (pcdoc_index_lookup(doc, selector, &candidates) == 0) {
+        match_candidates(doc, ancestor, candidates, selector, coll);
+        return;
+    }
+
+    doc->root4select = ancestor;
+    pcdoc_travel_descendant_elements(doc, ancestor, travel_select_elem_cb,
+            coll, NULL);
+    doc->root4select = NULL;
+}
+
 pcdoc_elem_coll_t
 pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
         pcdoc_element_t ancestor, pcdoc_selector_t selector)
@@ -968,12 +1440,12 @@ pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
     }
 
     coll->doc_age = doc->age;
-    if (ancestor == NULL) {
-        ancestor = doc->ops->special_elem(doc,
-                PCDOC_SPECIAL_ELEM_ROOT);
-    }
-
     if (selector->id) {
+        if (ancestor == NULL) {
+            ancestor = doc->ops->special_elem(doc,
+                    PCDOC_SPECIAL_ELEM_ROOT);
+        }
+
         coll->type = PCDOC_ELEM_COLL_TYPE_DOC_SELECT;
         pcdoc_element_t elem  = pcdoc_get_element_by_id_in_descendants(doc,
                 ancestor, selector->id + 1);
@@ -985,10 +1457,7 @@ pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
         goto out;
     }
 
-    doc->root4select = ancestor;
-    pcdoc_travel_descendant_elements(doc, ancestor, travel_select_elem_cb,
-            coll, NULL);
-    doc->root4select = NULL;
+    coll_set_pending(doc, coll);
 out:
     return coll;
 }
@@ -1011,6 +1480,7 @@ pcdoc_elem_coll_select(purc_document_t doc,
     }
 
     if (doc->ops->elem_coll_select) {
+        coll_ensure_elems(elem_coll);
         if (!doc->ops->elem_coll_select(doc, elem_coll, ancestor, selector)) {
             pcdoc_elem_coll_delete(doc, coll);
             coll = NULL;
@@ -1019,7 +1489,17 @@ pcdoc_elem_coll_select(purc_document_t doc,
     }
     coll->doc_age = elem_coll->doc_age;
 
+    coll_ensure_elems(elem_coll);
     size_t nr_elems = elem_coll->nr_elems;
+    struct pcutils_arrlist *candidates;
+    if (pcdoc_index_lookup(doc, selector, &candidates) == 0) {
+        for (size_t i = 0; i < nr_elems; i++) {
+            pcdoc_element_t elem = pcdoc_elem_coll_get(doc, elem_coll, i);
+            match_candidates(doc, elem, candidates, selector, coll);
+        }
+        goto out;
+    }
+
     for (size_t i = 0; i < nr_elems; i++) {
         pcdoc_element_t elem = pcdoc_elem_coll_get(doc, elem_coll, i);
         doc->root4select = elem;
@@ -1040,6 +1520,7 @@ pcdoc_elem_coll_filter(purc_document_t doc,
             selector, PCDOC_ELEM_COLL_TYPE_COLL_FILTER);
 
     if (doc->ops->elem_coll_filter) {
+        coll_ensure_elems(elem_coll);
         if (!doc->ops->elem_coll_filter(doc, dst_coll, elem_coll, selector)) {
             pcdoc_elem_coll_delete(doc, dst_coll);
             dst_coll = NULL;
@@ -1061,7 +1542,11 @@ pcdoc_elem_coll_count(purc_document_t doc,
         pcdoc_elem_coll_t elem_coll)
 {
     UNUSED_PARAM(doc);
-    return elem_coll ? elem_coll->nr_elems : 0;
+    if (elem_coll == NULL)
+        return 0;
+
+    coll_ensure_elems(elem_coll);
+    return elem_coll->nr_elems;
 }
 
 pcdoc_element_t
@@ -1070,7 +1555,27 @@ pcdoc_elem_coll_get(purc_document_t doc,
 {
     UNUSED_PARAM(doc);
     pcdoc_element_t elem = NULL;
-    if (!elem_coll || idx >= elem_coll->nr_elems) {
+    if (!elem_coll) {
+        goto out;
+    }
+
+    if (elem_coll->pending) {
+        if (idx == 0) {
+            /* NOTE: only look for the first element */
+            if (!elem_coll->first_found) {
+                elem_coll->first = pcdoc_find_element_in_descendants(
+                        elem_coll->doc, elem_coll->ancestor,
+                        elem_coll->selector);
+                elem_coll->first_found = 1;
+            }
+            elem = elem_coll->first;
+            goto out;
+        }
+
+        coll_materialize(elem_coll->doc, elem_coll);
+    }
+
+    if (idx >= elem_coll->nr_elems) {
         goto out;
     }
 
@@ -1085,6 +1590,10 @@ pcdoc_elem_coll_sub(purc_document_t doc,
 {
     UNUSED_PARAM(doc);
     pcdoc_elem_coll_t coll = NULL;
+    if (elem_coll) {
+        coll_ensure_elems(elem_coll);
+    }
+
     if (!elem_coll || (size_t)offset >= elem_coll->nr_elems ||
             length > (elem_coll->nr_elems - offset)) {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
@@ -1126,6 +1635,8 @@ pcdoc_elem_coll_travel(purc_document_t doc, pcdoc_elem_coll_t elem_coll,
         goto out;
     }
 
+    coll_ensure_elems(elem_coll);
+
     size_t i;
     pcdoc_element_t elem;
     for (i = 0; i < elem_coll->nr_elems; i++) {
@@ -1147,30 +1658,13 @@ out:
 int
 elem_coll_update_query(pcdoc_elem_coll_t elem_coll)
 {
-    int ret = -1;
-
-    if (!elem_coll->selector) {
-        ret = 0;
-        goto out;
-    }
-
-    pcdoc_elem_coll_t new_coll = pcdoc_elem_coll_new_from_descendants(
-            elem_coll->doc, elem_coll->ancestor, elem_coll->selector);
-    if (!new_coll) {
-        goto out;
+    if (elem_coll->selector) {
+        /* NOTE: re-select the elements only when they are accessed */
+        coll_set_pending(elem_coll->doc, elem_coll);
     }
 
-    struct pcutils_arrlist *elems = elem_coll->elems;
-    elem_coll->elems = new_coll->elems;
-    new_coll->elems = elems;
-
-    elem_coll->nr_elems = new_coll->nr_elems;
     elem_coll->doc_age = elem_coll->doc->age;
-    pcdoc_elem_coll_delete(new_coll->doc, new_coll);
-    ret = 0;
-
-out:
-    return ret;
+    return 0;
 }
 
 int
@@ -1183,6 +1677,7 @@ elem_coll_update_sub(pcdoc_elem_coll_t elem_coll)
         goto out;
     }
 
+    coll_ensure_elems(parent_coll);
     pcutils_arrlist_free(elem_coll->elems);
     elem_coll->elems = pcutils_arrlist_new_ex(NULL, 4);
     if (!elem_coll->elems) {
@@ -1232,6 +1727,7 @@ elem_coll_update_select(pcdoc_elem_coll_t elem_coll)
     elem_coll->nr_elems = 0;
 
     purc_document_t doc = parent_coll->doc;
+    coll_ensure_elems(parent_coll);
     size_t nr_elems = parent_coll->nr_elems;
     for (size_t i = 0; i < nr_elems; i++) {
         pcdoc_element_t elem = pcdoc_elem_coll_get(doc, parent_coll, i);
@@ -1324,3 +1820,39 @@ out:
     return coll;
 }
 
+
+static int document_init_instance(struct pcinst* inst,
+        const purc_instance_extra_info* extra_info)
+{
+    UNUSED_PARAM(extra_info);
+
+    list_head_init(&inst->selectors);
+    inst->nr_selectors = 0;
+    inst->nr_selector_hits = 0;
+    inst->nr_selector_misses = 0;
+    return 0;
+}
+
+static void document_cleanup_instance(struct pcinst* inst)
+{
+    PC_DEBUG("Selectors got from the cache: %u hits, %u misses\n",
+            (unsigned)inst->nr_selector_hits,
+            (unsigned)inst->nr_selector_misses);
+
+    pcdoc_selector_t selector, tmp;
+    list_for_each_entry_safe(selector, tmp, &inst->selectors, ln) {
+        uncache_selector(inst, selector);
+    }
+
+    /* NOTE: the selectors compiled by the later cleanups are not cached */
+    inst->selectors.next = inst->selectors.prev = NULL;
+}
+
+struct pcmodule _module_document = {
+    .id              = PURC_HAVE_DOM,
+    .module_inited   = 0,
+
+    .init_once       = NULL,
+    .init_instance   = document_init_instance,
+    .cleanup_instance = document_cleanup_instance,
+};
@@ -33,7 +33,9 @@
 #include "private/str.h"
 #include "private/map.h"
 #include "private/hash.h"
+#include "private/mraw.h"
 #include "private/dom.h"
+#include "html/parser.h"
 
 #include "ns_const.h"
 
@@ -250,93 +252,66 @@ failed:
     return root;
 }
 
+/*
+ * NOTE: the subtree operations move the children of @holder, which is
+ * the div element built by the fast fragment parser or by the tree
+ * builder; the holder is destroyed by the caller.
+ */
 static void
 dom_append_subtree_to_element(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+        pcdom_node_t *holder)
 {
     pcdom_node_t *parent = pcdom_interface_node(element);
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->first_child) {
-            pcdom_node_t *child = div->first_child;
-            pcdom_node_remove(child);
-            pcdom_node_append_child(parent, child);
-        }
+    while (holder->first_child) {
+        pcdom_node_t *child = holder->first_child;
+        pcdom_node_remove(child);
+        pcdom_node_append_child(parent, child);
     }
-
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
 }
 
 static void
 dom_prepend_subtree_to_element(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+        pcdom_node_t *holder)
 {
     pcdom_node_t *parent = pcdom_interface_node(element);
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->last_child) {
-            pcdom_node_t *child = div->last_child;
-            pcdom_node_remove(child);
-            pcdom_node_prepend_child(parent, child);
-        }
+    while (holder->last_child) {
+        pcdom_node_t *child = holder->last_child;
+        pcdom_node_remove(child);
+        pcdom_node_prepend_child(parent, child);
     }
-
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
 }
 
 static void
 dom_insert_subtree_before_element(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+        pcdom_node_t *holder)
 {
     pcdom_node_t *to = pcdom_interface_node(element);
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->last_child) {
-            pcdom_node_t *child = div->last_child;
-            pcdom_node_remove(child);
-            pcdom_node_insert_before(to, child);
-        }
+    while (holder->last_child) {
+        pcdom_node_t *child = holder->last_child;
+        pcdom_node_remove(child);
+        pcdom_node_insert_before(to, child);
     }
-
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
 }
 
 static void
 dom_insert_subtree_after_element(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+        pcdom_node_t *holder)
 {
     pcdom_node_t *to = pcdom_interface_node(element);
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->first_child) {
-            pcdom_node_t *child = div->first_child;
-            pcdom_node_remove(child);
-            pcdom_node_insert_after(to, child);
-        }
+    while (holder->first_child) {
+        pcdom_node_t *child = holder->first_child;
+        pcdom_node_remove(child);
+        pcdom_node_insert_after(to, child);
     }
-
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
 }
 
 static void
 dom_displace_content_by_subtree(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+        pcdom_node_t *holder)
 {
     pcdom_node_t *parent = pcdom_interface_node(element);
 
@@ -344,23 +319,11 @@ dom_displace_content_by_subtree(pcdom_element_t *element,
         pcdom_node_destroy_deep(parent->first_child);
     }
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->first_child) {
-            pcdom_node_t *child = div->first_child;
-            pcdom_node_remove(child);
-            pcdom_node_append_child(parent, child);
-        }
-    }
-
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
+    dom_append_subtree_to_element(element, holder);
 }
 
 typedef void (*dom_subtree_op)(pcdom_element_t *element,
-        pcdom_node_t *subtree);
+        pcdom_node_t *holder);
 
 static const dom_subtree_op dom_subtree_ops[] = {
     dom_append_subtree_to_element,
@@ -385,18 +348,33 @@ static pcdoc_node new_content(purc_document_t doc,
 
     pcdom_document_t *dom_doc = pcdom_interface_document(doc->impl);
     pcdom_element_t *dom_elem = pcdom_interface_element(elem);
-    pcdom_node_t *subtree = dom_parse_fragment(dom_doc, dom_elem,
-            content, length ? length : strlen(content));
+    if (length == 0)
+        length = strlen(content);
 
-    pcdom_node_t *dom_node = subtree->first_child->first_child;
+    /* NOTE: try the fast path first, e.g., for a templated row */
+    pcdom_node_t *subtree = NULL;
+    pcdom_node_t *holder = pchtml_html_parse_simple_fragment(dom_doc,
+            dom_elem, content, length);
+    if (holder == NULL) {
+        subtree = dom_parse_fragment(dom_doc, dom_elem, content, length);
+        if (subtree)
+            holder = subtree->first_child;
+    }
 
-    if (subtree) {
-        dom_subtree_ops[op](dom_elem, subtree);
+    pcdom_node_t *dom_node = NULL;
+    if (holder) {
+        dom_node = holder->first_child;
+        dom_subtree_ops[op](dom_elem, holder);
     }
     else {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
     }
 
+    if (subtree)
+        pcdom_node_destroy_deep(subtree);
+    else if (holder)
+        pcdom_node_destroy_deep(holder);
+
     node.type = PCDOC_NODE_ELEMENT;
     node.elem = (pcdoc_element_t)dom_node;
 
@@ -404,6 +382,50 @@ done:
     return node;
 }
 
+static pcdoc_node new_tpl_content(purc_document_t doc,
+            pcdoc_element_t elem, pcdoc_operation_k op,
+            struct pcdoc_tpl_content *content)
+{
+    pcdoc_node node = { .type = PCDOC_NODE_VOID, .data = NULL };
+
+    if (UNLIKELY(op >= PCA_TABLESIZE(dom_subtree_ops)))
+        goto done;
+
+    pcdom_document_t *dom_doc = pcdom_interface_document(doc->impl);
+    pcdom_element_t *dom_elem = pcdom_interface_element(elem);
+
+    if (content->compiled == NULL) {
+        content->compiled = pchtml_fragment_tpl_compile(dom_doc,
+                content->pieces, content->piece_lens, content->nr_slots);
+        if (content->compiled == NULL) {
+            /* never try it again */
+            content->uncompilable = true;
+            goto done;
+        }
+        content->compiler = doc->ops;
+    }
+
+    pcdom_node_t *holder = pchtml_fragment_tpl_instantiate(content->compiled,
+            dom_doc, dom_elem, content->values, content->value_lens);
+    if (holder == NULL)
+        goto done;
+
+    pcdom_node_t *dom_node = holder->first_child;
+    dom_subtree_ops[op](dom_elem, holder);
+    pcdom_node_destroy_deep(holder);
+
+    node.type = PCDOC_NODE_ELEMENT;
+    node.elem = (pcdoc_element_t)dom_node;
+
+done:
+    return node;
+}
+
+static void free_tpl_compiled(void *compiled)
+{
+    pchtml_fragment_tpl_destroy((pchtml_fragment_tpl_t *)compiled);
+}
+
 static inline int
 dom_set_element_attribute(pcdom_element_t *element,
         const char* name, const char* value, size_t length)
@@ -990,6 +1012,23 @@ out:
     return ret;
 }
 
+static int get_mem_stat(purc_document_t doc,
+        struct purc_document_mem_stat *stat)
+{
+    pcdom_document_t *dom_doc = pcdom_interface_document(doc->impl);
+    struct pcutils_mraw_stat mraw_stat = { 0 };
+
+    pcutils_mraw_get_stat(dom_doc->mraw, &mraw_stat);
+    pcutils_mraw_get_stat(dom_doc->text, &mraw_stat);
+
+    stat->nr_chunks = mraw_stat.nr_chunks;
+    stat->sz_reserved = mraw_stat.sz_reserved;
+    stat->sz_allocated = mraw_stat.sz_allocated;
+    stat->nr_free_blocks = mraw_stat.nr_free_blocks;
+    stat->sz_free = mraw_stat.sz_free;
+    return 0;
+}
+
 struct purc_document_ops _pcdoc_html_ops = {
     .create = create,
     .destroy = destroy,
@@ -997,6 +1036,8 @@ struct purc_document_ops _pcdoc_html_ops = {
     .new_text_content = new_text_content,
     .new_data_content = NULL,
     .new_content = new_content,
+    .new_tpl_content = new_tpl_content,
+    .free_tpl_compiled = free_tpl_compiled,
     .set_attribute = set_attribute,
     .special_elem = special_elem,
     .get_tag_name = get_tag_name,
@@ -1024,5 +1065,6 @@ struct purc_document_ops _pcdoc_html_ops = {
     .get_elem_by_id = get_elem_by_id,
     .elem_coll_select = NULL,
     .elem_coll_filter = NULL,
+    .get_mem_stat = get_mem_stat,
 };
 
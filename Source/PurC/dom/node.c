@@ -80,31 +80,27 @@ pcdom_node_destroy_deep(pcdom_node_t *root)
     pcdom_node_t *tmp;
     pcdom_node_t *node = root;
 
+    /* NOTE: only the root is unlinked; the descendants are destroyed
+       in post order without being unlinked one by one. */
+    pcdom_node_remove(root);
+
     while (node != NULL) {
         if (node->first_child != NULL) {
-            node = node->first_child;
+            tmp = node->first_child;
+            node->first_child = NULL;
+            node->last_child = NULL;
+            node = tmp;
+            continue;
         }
-        else {
-            while(node != root && node->next == NULL) {
-                tmp = node->parent;
-
-                pcdom_node_destroy(node);
-
-                node = tmp;
-            }
-
-            if (node == root) {
-                pcdom_node_destroy(node);
-
-                break;
-            }
-
-            tmp = node->next;
 
-            pcdom_node_destroy(node);
-
-            node = tmp;
+        if (node == root) {
+            pcdom_document_destroy_interface(node);
+            break;
         }
+
+        tmp = (node->next != NULL) ? node->next : node->parent;
+        pcdom_document_destroy_interface(node);
+        node = tmp;
     }
 
     return NULL;
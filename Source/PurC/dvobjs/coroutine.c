@@ -545,6 +545,182 @@ curator_getter(purc_variant_t root,
     return purc_variant_make_ulongint(cor->curator);
 }
 
+static purc_variant_t
+priority_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+    UNUSED_PARAM(call_flags);
+
+    pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+    return purc_variant_make_string_static(
+            pcintr_coroutine_get_priority_name(cor), false);
+}
+
+static purc_variant_t
+priority_setter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    const char *name;
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto failed;
+    }
+
+    if ((name = purc_variant_get_string_const(argv[0])) == NULL) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        goto failed;
+    }
+
+    pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+    if (pcintr_coroutine_set_priority_by_name(cor, name)) {
+        goto failed;
+    }
+
+    return purc_variant_make_boolean(true);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+stats_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+    const struct pcvariant_usage *usage = &cor->vusage;
+
+    static const char *keys[] = {
+        "nrValues",
+        "memUsed",
+        "memSoftLimit",
+        "memHardLimit",
+    };
+
+    /* NOTE: the counters are net values, so they may be negative
+       if the coroutine released variants allocated by others. */
+    int64_t items[] = {
+        (int64_t)usage->nr_values,
+        (int64_t)usage->sz_mem,
+        (int64_t)usage->soft_limit,
+        (int64_t)usage->hard_limit,
+    };
+
+    purc_variant_t ret = purc_variant_make_object_0();
+    if (ret == PURC_VARIANT_INVALID) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    for (size_t i = 0; i < PCA_TABLESIZE(keys); i++) {
+        purc_variant_t val = purc_variant_make_longint(items[i]);
+        if (val) {
+            purc_variant_object_set_by_static_ckey(ret, keys[i], val);
+            purc_variant_unref(val);
+        }
+        else {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto failed;
+        }
+    }
+
+    purc_variant_t val = purc_variant_make_boolean(usage->soft_reached);
+    purc_variant_object_set_by_static_ckey(ret, "softLimitReached", val);
+    purc_variant_unref(val);
+    return ret;
+
+failed:
+    if (ret)
+        purc_variant_unref(ret);
+
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_null();
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+mem_soft_limit_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+    UNUSED_PARAM(call_flags);
+
+    pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+    return purc_variant_make_ulongint(cor->vusage.soft_limit);
+}
+
+static purc_variant_t
+mem_soft_limit_setter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto failed;
+    }
+
+    /* zero for no limit */
+    uint64_t u64;
+    if (purc_variant_cast_to_ulongint(argv[0], &u64, false) &&
+            u64 <= SSIZE_MAX) {
+        pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+        cor->vusage.soft_limit = (size_t)u64;
+        cor->vusage.soft_reached = false;
+        return purc_variant_make_ulongint(u64);
+    }
+
+    purc_set_error(PURC_ERROR_INVALID_VALUE);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+mem_hard_limit_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+    UNUSED_PARAM(call_flags);
+
+    pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+    return purc_variant_make_ulongint(cor->vusage.hard_limit);
+}
+
+static purc_variant_t
+mem_hard_limit_setter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto failed;
+    }
+
+    /* zero for no limit */
+    uint64_t u64;
+    if (purc_variant_cast_to_ulongint(argv[0], &u64, false) &&
+            u64 <= SSIZE_MAX) {
+        pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+        cor->vusage.hard_limit = (size_t)u64;
+        return purc_variant_make_ulongint(u64);
+    }
+
+    purc_set_error(PURC_ERROR_INVALID_VALUE);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t static_variable_getter(void* native_entity,
         const char *property_name,
         size_t nr_args, purc_variant_t* argv, unsigned call_flags)
@@ -883,6 +1059,12 @@ purc_dvobj_coroutine_new(pcintr_coroutine_t cor)
         { "uri",     uri_getter,     NULL },
         { "token",   token_getter,   token_setter },
         { "curator", curator_getter, NULL },
+        { "priority", priority_getter, priority_setter },
+        { "stats",   stats_getter,   NULL },
+        { "memSoftLimit",
+            mem_soft_limit_getter, mem_soft_limit_setter },
+        { "memHardLimit",
+            mem_hard_limit_getter, mem_hard_limit_setter },
     };
 
     retv = purc_dvobj_make_from_methods(method, PCA_TABLESIZE(method));
@@ -29,10 +29,12 @@
 
 #include "private/variant.h"
 #include "private/errors.h"
+#include "private/ejson.h"
 #include "private/atom-buckets.h"
 #include "private/dvobjs.h"
 #include "private/utils.h"
 #include "private/utf8.h"
+#include "private/regex.h"
 #include "helper.h"
 
 #include <assert.h>
@@ -609,13 +611,17 @@ parse_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
+    purc_variant_t retv;
+    if (pcejson_parse_plain(&retv, string, length,
+                PCEJSON_DEFAULT_DEPTH) == 0)
+        return retv;
+
     struct purc_ejson_parsing_tree *ptree;
     ptree = purc_variant_ejson_parse_string(string, length);
     if (ptree == NULL) {
         goto failed;
     }
 
-    purc_variant_t retv;
     retv = purc_ejson_parsing_tree_evalute(ptree, NULL, NULL,
             (call_flags & PCVRT_CALL_FLAG_SILENTLY));
     purc_ejson_parsing_tree_destroy(ptree);
@@ -628,6 +634,84 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+static purc_variant_t
+serialize_binary_getter(purc_variant_t root, size_t nr_args,
+        purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(call_flags);
+
+    purc_variant_t vrt;
+    if (nr_args == 0) {
+        vrt = purc_variant_make_undefined();
+    }
+    else {
+        vrt = purc_variant_ref(argv[0]);
+    }
+
+    purc_rwstream_t my_stream;
+    ssize_t n;
+
+    my_stream = purc_rwstream_new_buffer(LEN_INI_SERIALIZE_BUF,
+            LEN_MAX_SERIALIZE_BUF);
+    n = purc_variant_serialize_binary(vrt, my_stream);
+    purc_variant_unref(vrt);
+
+    if (n == -1) {
+        purc_rwstream_destroy(my_stream);
+        goto fatal;
+    }
+
+    void *buf = NULL;
+    size_t sz_content, sz_buffer;
+    buf = purc_rwstream_get_mem_buffer_ex(my_stream,
+            &sz_content, &sz_buffer, true);
+    purc_rwstream_destroy(my_stream);
+
+    return purc_variant_make_byte_sequence_reuse_buff(buf,
+            sz_content, sz_buffer);
+
+fatal:
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+parse_binary_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto failed;
+    }
+
+    const unsigned char *bytes;
+    size_t nr_bytes;
+    bytes = purc_variant_get_bytes_const(argv[0], &nr_bytes);
+    if (bytes == NULL) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        goto failed;
+    }
+
+    purc_rwstream_t my_stream;
+    my_stream = purc_rwstream_new_from_mem((void *)bytes, nr_bytes);
+    if (my_stream == NULL)
+        goto failed;
+
+    purc_variant_t retv = purc_variant_load_from_binary(my_stream);
+    purc_rwstream_destroy(my_stream);
+    if (retv == PURC_VARIANT_INVALID)
+        goto failed;
+    return retv;
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_undefined();
+
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t
 isequal_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -846,84 +930,277 @@ fatal:
 typedef purc_real_t (*fn_fetch_real)(const unsigned char *bytes);
 typedef bool (*fn_dump_real)(unsigned char *dst, purc_real_t real, bool force);
 
+/* whether the bytes of a little/big endian real need to be swapped */
+#if CPU(LITTLE_ENDIAN)
+#   define SWAP_LE      false
+#   define SWAP_BE      true
+#elif CPU(BIG_ENDIAN)
+#   define SWAP_LE      true
+#   define SWAP_BE      false
+#else
+#   error "Unsupported endian"
+#endif
+
 static const struct real_info {
     uint8_t         length;         // unit length in bytes
     uint8_t         real_type;      // EJSON real type
+    bool            swap;           // in the foreign byte order
     fn_fetch_real   fetcher;        // fetcher
     fn_dump_real    dumper;         // dumper
 } real_info[] = {
-    { 1,  PURC_VARIANT_TYPE_LONGINT,
+    { 1,  PURC_VARIANT_TYPE_LONGINT, false,
         purc_fetch_i8,              purc_dump_i8       },  // "i8"
-    { 2,  PURC_VARIANT_TYPE_LONGINT,
+    { 2,  PURC_VARIANT_TYPE_LONGINT, false,
         purc_fetch_i16,             purc_dump_i16      },  // "i16"
-    { 4,  PURC_VARIANT_TYPE_LONGINT,
+    { 4,  PURC_VARIANT_TYPE_LONGINT, false,
         purc_fetch_i32,             purc_dump_i32      },  // "i32"
-    { 8,  PURC_VARIANT_TYPE_LONGINT,
+    { 8,  PURC_VARIANT_TYPE_LONGINT, false,
         purc_fetch_i64,             purc_dump_i64      },  // "i64"
-    { 2,  PURC_VARIANT_TYPE_LONGINT,
+    { 2,  PURC_VARIANT_TYPE_LONGINT, SWAP_LE,
         purc_fetch_i16le,           purc_dump_i16le    },  // "i16le"
-    { 4,  PURC_VARIANT_TYPE_LONGINT,
+    { 4,  PURC_VARIANT_TYPE_LONGINT, SWAP_LE,
         purc_fetch_i32le,           purc_dump_i32le    },  // "i32le"
-    { 8,  PURC_VARIANT_TYPE_LONGINT,
+    { 8,  PURC_VARIANT_TYPE_LONGINT, SWAP_LE,
         purc_fetch_i64le,           purc_dump_i64le    },  // "i64le"
-    { 2,  PURC_VARIANT_TYPE_LONGINT,
+    { 2,  PURC_VARIANT_TYPE_LONGINT, SWAP_BE,
         purc_fetch_i16be,           purc_dump_i16be    },  // "i16be"
-    { 4,  PURC_VARIANT_TYPE_LONGINT,
+    { 4,  PURC_VARIANT_TYPE_LONGINT, SWAP_BE,
         purc_fetch_i32be,           purc_dump_i32be    },  // "i32be"
-    { 8,  PURC_VARIANT_TYPE_LONGINT,
+    { 8,  PURC_VARIANT_TYPE_LONGINT, SWAP_BE,
         purc_fetch_i64be,           purc_dump_i64be    },  // "i64be"
-    { 1,  PURC_VARIANT_TYPE_ULONGINT,
+    { 1,  PURC_VARIANT_TYPE_ULONGINT, false,
         purc_fetch_u8,              purc_dump_u8       },  // "u8"
-    { 2,  PURC_VARIANT_TYPE_ULONGINT,
+    { 2,  PURC_VARIANT_TYPE_ULONGINT, false,
         purc_fetch_u16,             purc_dump_u16      },  // "u16"
-    { 4,  PURC_VARIANT_TYPE_ULONGINT,
+    { 4,  PURC_VARIANT_TYPE_ULONGINT, false,
         purc_fetch_u32,             purc_dump_u32      },  // "u32"
-    { 8,  PURC_VARIANT_TYPE_ULONGINT,
+    { 8,  PURC_VARIANT_TYPE_ULONGINT, false,
         purc_fetch_u64,             purc_dump_u64      },  // "u64"
-    { 2,  PURC_VARIANT_TYPE_ULONGINT,
+    { 2,  PURC_VARIANT_TYPE_ULONGINT, SWAP_LE,
         purc_fetch_u16le,           purc_dump_u16le    },  // "u16le"
-    { 4,  PURC_VARIANT_TYPE_ULONGINT,
+    { 4,  PURC_VARIANT_TYPE_ULONGINT, SWAP_LE,
         purc_fetch_u32le,           purc_dump_u32le    },  // "u32le"
-    { 8,  PURC_VARIANT_TYPE_ULONGINT,
+    { 8,  PURC_VARIANT_TYPE_ULONGINT, SWAP_LE,
         purc_fetch_u64le,           purc_dump_u64le    },  // "u64le"
-    { 2,  PURC_VARIANT_TYPE_ULONGINT,
+    { 2,  PURC_VARIANT_TYPE_ULONGINT, SWAP_BE,
         purc_fetch_u16be,           purc_dump_u16be    },  // "u16be"
-    { 4,  PURC_VARIANT_TYPE_ULONGINT,
+    { 4,  PURC_VARIANT_TYPE_ULONGINT, SWAP_BE,
         purc_fetch_u32be,           purc_dump_u32be    },  // "u32be"
-    { 8,  PURC_VARIANT_TYPE_ULONGINT,
+    { 8,  PURC_VARIANT_TYPE_ULONGINT, SWAP_BE,
         purc_fetch_u64be,           purc_dump_u64be    },  // "u64be"
-    { 2,  PURC_VARIANT_TYPE_NUMBER,
+    { 2,  PURC_VARIANT_TYPE_NUMBER, false,
         purc_fetch_f16,             purc_dump_f16      },  // "f16"
-    { 4,  PURC_VARIANT_TYPE_NUMBER,
+    { 4,  PURC_VARIANT_TYPE_NUMBER, false,
         purc_fetch_f32,             purc_dump_f32      },  // "f32"
-    { 8,  PURC_VARIANT_TYPE_NUMBER,
+    { 8,  PURC_VARIANT_TYPE_NUMBER, false,
         purc_fetch_f64,             purc_dump_f64      },  // "f64"
-    { 12, PURC_VARIANT_TYPE_LONGDOUBLE,
+    { 12, PURC_VARIANT_TYPE_LONGDOUBLE, false,
         purc_fetch_f96,             purc_dump_f96      },  // "f96"
-    { 16, PURC_VARIANT_TYPE_LONGDOUBLE,
+    { 16, PURC_VARIANT_TYPE_LONGDOUBLE, false,
         purc_fetch_f128,            purc_dump_f128     },  // "f128"
-    { 2,  PURC_VARIANT_TYPE_NUMBER,
+    { 2,  PURC_VARIANT_TYPE_NUMBER, SWAP_LE,
         purc_fetch_f16le,           purc_dump_f16le    },  // "f16le"
-    { 4,  PURC_VARIANT_TYPE_NUMBER,
+    { 4,  PURC_VARIANT_TYPE_NUMBER, SWAP_LE,
         purc_fetch_f32le,           purc_dump_f32le    },  // "f32le"
-    { 8,  PURC_VARIANT_TYPE_NUMBER,
+    { 8,  PURC_VARIANT_TYPE_NUMBER, SWAP_LE,
         purc_fetch_f64le,           purc_dump_f64le    },  // "f64le"
-    { 12, PURC_VARIANT_TYPE_LONGDOUBLE,
+    { 12, PURC_VARIANT_TYPE_LONGDOUBLE, SWAP_LE,
         purc_fetch_f96le,           purc_dump_f96le    },  // "f96le"
-    { 16, PURC_VARIANT_TYPE_LONGDOUBLE,
+    { 16, PURC_VARIANT_TYPE_LONGDOUBLE, SWAP_LE,
         purc_fetch_f128le,          purc_dump_f128le   },  // "f128le"
-    { 2,  PURC_VARIANT_TYPE_NUMBER,
+    { 2,  PURC_VARIANT_TYPE_NUMBER, SWAP_BE,
         purc_fetch_f16be,           purc_dump_f16be    },  // "f16be"
-    { 4,  PURC_VARIANT_TYPE_NUMBER,
+    { 4,  PURC_VARIANT_TYPE_NUMBER, SWAP_BE,
         purc_fetch_f32be,           purc_dump_f32be    },  // "f32be"
-    { 8,  PURC_VARIANT_TYPE_NUMBER,
+    { 8,  PURC_VARIANT_TYPE_NUMBER, SWAP_BE,
         purc_fetch_f64be,           purc_dump_f64be    },  // "f64be"
-    { 12, PURC_VARIANT_TYPE_LONGDOUBLE,
+    { 12, PURC_VARIANT_TYPE_LONGDOUBLE, SWAP_BE,
         purc_fetch_f96be,           purc_dump_f96be    },  // "f96be"
-    { 16, PURC_VARIANT_TYPE_LONGDOUBLE,
+    { 16, PURC_VARIANT_TYPE_LONGDOUBLE, SWAP_BE,
         purc_fetch_f128be,          purc_dump_f128be   },  // "f128be"
 };
 
+/*
+ * The bulk converters of the reals fit in 8 bytes but f16, used when
+ * a format is repeated. Every unit is loaded by memcpy() and swapped by
+ * a built-in in a loop with no call, so that the compiler can vectorize
+ * the loop.
+ */
+#define BULK_FETCH(utype, bswap, expr)                                  \
+    for (size_t i = 0; i < quantity; i++) {                             \
+        utype u;                                                        \
+        memcpy(&u, bytes + sizeof(utype) * i, sizeof(utype));           \
+        if (swap)                                                       \
+            u = bswap(u);                                               \
+        expr;                                                           \
+    }
+
+#define NO_SWAP(u)  (u)
+
+/* Returns false if the format is not supported. */
+static bool
+fetch_reals_in_bulk(const struct real_info *info, const unsigned char *bytes,
+        size_t quantity, uint64_t *elems)
+{
+    bool swap = info->swap;
+    bool is_signed = (info->real_type == PURC_VARIANT_TYPE_LONGINT);
+
+    switch (info->length) {
+    case 1:
+        if (is_signed) {
+            BULK_FETCH(uint8_t, NO_SWAP,
+                    elems[i] = (uint64_t)(int64_t)(int8_t)u)
+        }
+        else {
+            BULK_FETCH(uint8_t, NO_SWAP, elems[i] = u)
+        }
+        break;
+
+    case 2:
+        if (info->real_type == PURC_VARIANT_TYPE_NUMBER)
+            return false;   // f16
+        if (is_signed) {
+            BULK_FETCH(uint16_t, __builtin_bswap16,
+                    elems[i] = (uint64_t)(int64_t)(int16_t)u)
+        }
+        else {
+            BULK_FETCH(uint16_t, __builtin_bswap16, elems[i] = u)
+        }
+        break;
+
+    case 4:
+        if (info->real_type == PURC_VARIANT_TYPE_NUMBER) {
+            BULK_FETCH(uint32_t, __builtin_bswap32,
+                    float f; memcpy(&f, &u, sizeof(f));
+                    double d = f; memcpy(elems + i, &d, sizeof(d)))
+        }
+        else if (is_signed) {
+            BULK_FETCH(uint32_t, __builtin_bswap32,
+                    elems[i] = (uint64_t)(int64_t)(int32_t)u)
+        }
+        else {
+            BULK_FETCH(uint32_t, __builtin_bswap32, elems[i] = u)
+        }
+        break;
+
+    case 8:
+        /* the bits of i64, u64, and f64 are kept as they are */
+        BULK_FETCH(uint64_t, __builtin_bswap64, elems[i] = u)
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+#define BULK_DUMP(utype, bswap, expr)                                   \
+    for (size_t i = 0; i < quantity; i++) {                             \
+        utype u;                                                        \
+        expr;                                                           \
+        if (swap)                                                       \
+            u = bswap(u);                                               \
+        memcpy(dst + sizeof(utype) * i, &u, sizeof(utype));             \
+    }
+
+/* Clamps `v` into [lo, hi], and counts the clamped ones in `nr_clamped`. */
+#define CLAMP(v, lo, hi)                                                \
+    ((v) > (hi) ? (nr_clamped++, (hi)) :                                \
+        ((v) < (lo) ? (nr_clamped++, (lo)) : (v)))
+
+#define UCLAMP(v, hi)                                                   \
+    ((v) > (hi) ? (nr_clamped++, (hi)) : (v))
+
+/* Returns 1 if the reals are dumped, 0 if the format or the type of the
+   packed elements is not supported, or -1 if a real is out of range and
+   not `force`. */
+static int
+dump_reals_in_bulk(const struct real_info *info, unsigned char *dst,
+        pcvrnt_packed_type_k type, const void *packed, size_t quantity,
+        bool force)
+{
+    bool swap = info->swap;
+    size_t nr_clamped = 0;
+
+    switch (info->real_type) {
+    case PURC_VARIANT_TYPE_LONGINT: {
+        if (type != PCVRNT_PACKED_LONGINT)
+            return 0;
+
+        const int64_t *src = packed;
+        switch (info->length) {
+        case 1:
+            BULK_DUMP(uint8_t, NO_SWAP,
+                    u = (uint8_t)(int8_t)CLAMP(src[i], INT8_MIN, INT8_MAX))
+            break;
+        case 2:
+            BULK_DUMP(uint16_t, __builtin_bswap16,
+                    u = (uint16_t)(int16_t)CLAMP(src[i], INT16_MIN, INT16_MAX))
+            break;
+        case 4:
+            BULK_DUMP(uint32_t, __builtin_bswap32,
+                    u = (uint32_t)(int32_t)CLAMP(src[i], INT32_MIN, INT32_MAX))
+            break;
+        default:
+            BULK_DUMP(uint64_t, __builtin_bswap64, u = (uint64_t)src[i])
+            break;
+        }
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_ULONGINT: {
+        if (type != PCVRNT_PACKED_ULONGINT)
+            return 0;
+
+        const uint64_t *src = packed;
+        switch (info->length) {
+        case 1:
+            BULK_DUMP(uint8_t, NO_SWAP,
+                    u = (uint8_t)UCLAMP(src[i], UINT8_MAX))
+            break;
+        case 2:
+            BULK_DUMP(uint16_t, __builtin_bswap16,
+                    u = (uint16_t)UCLAMP(src[i], UINT16_MAX))
+            break;
+        case 4:
+            BULK_DUMP(uint32_t, __builtin_bswap32,
+                    u = (uint32_t)UCLAMP(src[i], UINT32_MAX))
+            break;
+        default:
+            BULK_DUMP(uint64_t, __builtin_bswap64, u = src[i])
+            break;
+        }
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_NUMBER: {
+        if (type != PCVRNT_PACKED_NUMBER)
+            return 0;
+
+        const double *src = packed;
+        switch (info->length) {
+        case 4:
+            BULK_DUMP(uint32_t, __builtin_bswap32,
+                    float f = (float)src[i]; memcpy(&u, &f, sizeof(u)))
+            break;
+        case 8:
+            BULK_DUMP(uint64_t, __builtin_bswap64,
+                    memcpy(&u, src + i, sizeof(u)))
+            break;
+        default:
+            return 0;       // f16
+        }
+        break;
+    }
+
+    default:
+        return 0;
+    }
+
+    return (nr_clamped && !force) ? -1 : 1;
+}
+
 static purc_variant_t
 fetchreal_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -1085,14 +1362,61 @@ purc_dvobj_unpack_real(const unsigned char *bytes, size_t nr_bytes,
             case PURC_VARIANT_TYPE_ULONGINT:
                 return purc_variant_make_ulongint(real.u64);
             case PURC_VARIANT_TYPE_NUMBER:
-                return purc_variant_make_ulongint(real.d);
+                return purc_variant_make_number(real.d);
             case PURC_VARIANT_TYPE_LONGDOUBLE:
-                return purc_variant_make_ulongint(real.ld);
+                return purc_variant_make_longdouble(real.ld);
             default:
                 assert(0);
                 break;
         }
     }
+    else if (real_info[real_id].real_type != PURC_VARIANT_TYPE_LONGDOUBLE) {
+        /* the reals fit in 8 bytes are returned in a packed array */
+        pcvrnt_packed_type_k type;
+        switch (real_info[real_id].real_type) {
+            case PURC_VARIANT_TYPE_LONGINT:
+                type = PCVRNT_PACKED_LONGINT;
+                break;
+            case PURC_VARIANT_TYPE_ULONGINT:
+                type = PCVRNT_PACKED_ULONGINT;
+                break;
+            default:
+                type = PCVRNT_PACKED_NUMBER;
+                break;
+        }
+
+        /* all members of purc_real_t but `ld' are 8-byte long */
+        uint64_t *elems = malloc(sizeof(uint64_t) * quantity);
+        if (elems == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto fatal;
+        }
+
+        if (!fetch_reals_in_bulk(real_info + real_id, bytes, quantity,
+                    elems)) {
+            for (size_t i = 0; i < quantity; i++) {
+                purc_real_t real = real_info[real_id].fetcher(bytes);
+                switch (type) {
+                    case PCVRNT_PACKED_LONGINT:
+                        memcpy(elems + i, &real.i64, sizeof(uint64_t));
+                        break;
+                    case PCVRNT_PACKED_ULONGINT:
+                        elems[i] = real.u64;
+                        break;
+                    default:
+                        memcpy(elems + i, &real.d, sizeof(uint64_t));
+                        break;
+                }
+
+                bytes += real_info[real_id].length;
+            }
+        }
+
+        purc_variant_t retv;
+        retv = purc_variant_make_packed_array(type, elems, quantity);
+        free(elems);
+        return retv;
+    }
     else {
         purc_variant_t retv;
 
@@ -1102,28 +1426,12 @@ purc_dvobj_unpack_real(const unsigned char *bytes, size_t nr_bytes,
         }
 
         for (size_t i = 0; i < quantity; i++) {
-            purc_variant_t vrt = PURC_VARIANT_INVALID;
             purc_real_t real = real_info[real_id].fetcher(bytes);
-            switch (real_info[real_id].real_type) {
-                case PURC_VARIANT_TYPE_LONGINT:
-                    vrt = purc_variant_make_longint(real.i64);
-                    break;
-                case PURC_VARIANT_TYPE_ULONGINT:
-                    vrt = purc_variant_make_ulongint(real.u64);
-                    break;
-                case PURC_VARIANT_TYPE_NUMBER:
-                    vrt = purc_variant_make_ulongint(real.d);
-                    break;
-                case PURC_VARIANT_TYPE_LONGDOUBLE:
-                    vrt = purc_variant_make_ulongint(real.ld);
-                    break;
-                default:
-                    assert(0);
-                    break;
-            }
-
-            if (vrt == PURC_VARIANT_INVALID)
+            purc_variant_t vrt = purc_variant_make_longdouble(real.ld);
+            if (vrt == PURC_VARIANT_INVALID) {
+                purc_variant_unref(retv);
                 goto fatal;
+            }
 
             bool ok = purc_variant_array_append(retv, vrt);
             purc_variant_unref(vrt);
@@ -1565,6 +1873,27 @@ purc_dvobj_pack_real(struct pcdvobj_bytes_buff *bf, purc_variant_t item,
     }
 
     enum purc_variant_type vt = purc_variant_get_type(item);
+
+    /* the elements of a packed array are dumped without boxing them */
+    pcvrnt_packed_type_k packed_type;
+    size_t nr_packed;
+    const void *packed = NULL;
+    if (vt == PURC_VARIANT_TYPE_ARRAY)
+        packed = purc_variant_array_get_packed(item, &packed_type, &nr_packed);
+    if (packed && nr_packed >= quantity) {
+        int ret = dump_reals_in_bulk(real_info + real_id,
+                bf->bytes + bf->nr_bytes, packed_type, packed, quantity,
+                silently);
+        if (ret < 0) {
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            goto failed;
+        }
+        else if (ret > 0) {
+            bf->nr_bytes += real_info[real_id].length * quantity;
+            return 0;
+        }
+    }
+
     bool is_linear_container = ((vt == PURC_VARIANT_TYPE_ARRAY) ||
             (vt == PURC_VARIANT_TYPE_SET) || (vt == PURC_VARIANT_TYPE_TUPLE));
     for (size_t n = 0; n < quantity; n++) {
@@ -1936,9 +2265,11 @@ shuffle_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         ssize_t sz = purc_variant_array_get_size(argv[0]);
 
         if (sz > 1) {
-            struct pcutils_array_list *al = variant_array_get_data(argv[0]);
-            struct pcutils_array_list_node *p;
-            array_list_for_each(al, p) {
+            variant_arr_t data = pcvariant_array_writable_data(argv[0]);
+            if (data == NULL)
+                goto failed;
+
+            for (size_t idx = 0; idx < data->nr; idx++) {
 
                 size_t new_idx;
                 if (sz < RAND_MAX) {
@@ -1949,8 +2280,11 @@ shuffle_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
                     new_idx = new_idx * sz / RAND_MAX;
                 }
 
-                if (new_idx != p->idx)
-                    pcutils_array_list_swap(al, p->idx, new_idx);
+                if (new_idx != idx) {
+                    purc_variant_t tmp = data->vals[idx];
+                    data->vals[idx] = data->vals[new_idx];
+                    data->vals[new_idx] = tmp;
+                }
             }
         }
     }
@@ -2828,8 +3162,7 @@ match_members_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 
     purc_variant_t retv = PURC_VARIANT_INVALID;
     GPatternSpec *glib_pattern = NULL;
-    regex_t reg_matcher;
-    bool reg_compiled = false;
+    const regex_t *reg_matcher = NULL;
 
     const char *options = NULL;
     size_t options_len;
@@ -2947,15 +3280,15 @@ match_members_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         }
 
         int ret;
-        if ((ret = regcomp(&reg_matcher, regexp, REG_EXTENDED | REG_NOSUB))) {
+        reg_matcher = pcregex_cache_get(regexp,
+                REG_EXTENDED | REG_NOSUB, &ret);
+        if (reg_matcher == NULL) {
             if (ret == REG_ESPACE)
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             else
                 purc_set_error(PURC_ERROR_INVALID_VALUE);
             goto failed;
         }
-
-        reg_compiled = true;
     }
 
     retv = purc_variant_make_array_0();
@@ -2987,7 +3320,7 @@ match_members_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
             break;
 
         case MATCHING_REGEXP:
-            if (variant_matches_regexp(&reg_matcher, member, &matched)) {
+            if (variant_matches_regexp(reg_matcher, member, &matched)) {
                 goto failed;
             }
             break;
@@ -3042,16 +3375,16 @@ match_members_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 
     if (glib_pattern)
         g_pattern_spec_free(glib_pattern);
-    if (reg_compiled)
-        regfree(&reg_matcher);
+    if (reg_matcher)
+        pcregex_cache_release(reg_matcher);
 
     return retv;
 
 failed:
     if (glib_pattern)
         g_pattern_spec_free(glib_pattern);
-    if (reg_compiled)
-        regfree(&reg_matcher);
+    if (reg_matcher)
+        pcregex_cache_release(reg_matcher);
     if (retv)
         purc_variant_unref(retv);
 
@@ -3068,8 +3401,7 @@ match_properties_getter(purc_variant_t root, size_t nr_args, purc_variant_t *arg
 
     purc_variant_t retv = PURC_VARIANT_INVALID;
     GPatternSpec *glib_pattern = NULL;
-    regex_t reg_matcher;
-    bool reg_compiled = false;
+    const regex_t *reg_matcher = NULL;
 
     const char *options = NULL;
     size_t options_len;
@@ -3187,15 +3519,15 @@ match_properties_getter(purc_variant_t root, size_t nr_args, purc_variant_t *arg
 
         /* TODO: flags */
         int ret;
-        if ((ret = regcomp(&reg_matcher, regexp, REG_EXTENDED | REG_NOSUB))) {
+        reg_matcher = pcregex_cache_get(regexp,
+                REG_EXTENDED | REG_NOSUB, &ret);
+        if (reg_matcher == NULL) {
             if (ret == REG_ESPACE)
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             else
                 purc_set_error(PURC_ERROR_INVALID_VALUE);
             goto failed;
         }
-
-        reg_compiled = true;
     }
 
     retv = purc_variant_make_array_0();
@@ -3230,7 +3562,7 @@ match_properties_getter(purc_variant_t root, size_t nr_args, purc_variant_t *arg
             break;
 
         case MATCHING_REGEXP:
-            if (variant_matches_regexp(&reg_matcher, key, &matched)) {
+            if (variant_matches_regexp(reg_matcher, key, &matched)) {
                 goto failed;
             }
             break;
@@ -3286,16 +3618,16 @@ match_properties_getter(purc_variant_t root, size_t nr_args, purc_variant_t *arg
 
     if (glib_pattern)
         g_pattern_spec_free(glib_pattern);
-    if (reg_compiled)
-        regfree(&reg_matcher);
+    if (reg_matcher)
+        pcregex_cache_release(reg_matcher);
 
     return retv;
 
 failed:
     if (glib_pattern)
         g_pattern_spec_free(glib_pattern);
-    if (reg_compiled)
-        regfree(&reg_matcher);
+    if (reg_matcher)
+        pcregex_cache_release(reg_matcher);
     if (retv)
         purc_variant_unref(retv);
 
@@ -3316,6 +3648,8 @@ purc_variant_t purc_dvobj_data_new(void)
         { "stringify",  stringify_getter, NULL },
         { "serialize",  serialize_getter, NULL },
         { "parse",      parse_getter, NULL },
+        { "serialize_binary",   serialize_binary_getter, NULL },
+        { "parse_binary",       parse_binary_getter, NULL },
         { "isequal",    isequal_getter, NULL },
         { "compare",    compare_getter, NULL },
         { "fetchstr",   fetchstr_getter, NULL },
@@ -31,6 +31,7 @@
 #include "private/errors.h"
 #include "private/atom-buckets.h"
 #include "private/dvobjs.h"
+#include "private/list.h"
 
 #include "purc-variant.h"
 #include "purc-dvobjs.h"
@@ -149,56 +150,16 @@ static const char *timeformats[] = {
     _TF_w3c,
 };
 
-static char *set_tz(const char *timezone)
-{
-    char *tz_old = NULL;
-
-    if (timezone) {
-        char *env = getenv("TZ");
-        if (env)
-            tz_old = strdup(env);
-
-        if (env == NULL || strcmp(env, timezone)) {
-            /* change timezone temporarily. */
-            char new_timezone[strlen(timezone) + 1];
-            strcpy(new_timezone, ":");
-            strcat(new_timezone, timezone);
-            setenv("TZ", new_timezone, 1);
-            tzset();
-        }
-    }
-
-    return tz_old;
-}
-
-static void unset_tz(char *tz_old)
-{
-    if (tz_old) {
-        if (strcmp(getenv("TZ"), tz_old)) {
-            // restore old timezone.
-            setenv("TZ", tz_old, 1);
-            tzset();
-        }
-        free(tz_old);
-    }
-}
-
 static void get_local_broken_down_time(struct tm *result,
         time_t sec, const char *timezone)
 {
-    char *tz_old = set_tz(timezone);
-    localtime_r(&sec, result);
-    unset_tz(tz_old);
+    pcdvobjs_timezone_localtime(timezone, sec, result);
 }
 
 static time_t get_time_from_broken_down_time(struct tm *tm,
         const char *timezone)
 {
-    char *tz_old = set_tz(timezone);
-    time_t t = mktime(tm);
-    unset_tz(tz_old);
-
-    return t;
+    return pcdvobjs_timezone_mktime(timezone, tm);
 }
 
 #define DEF_LEN_ABBR_NAME       32
@@ -467,30 +428,164 @@ on_found(const char *needle, size_t len, void *ctxt, size_t *rep_len)
     return result;
 }
 
+/*
+ * NOTE: the clock widgets and the loggers format the time with the same
+ * formats again and again; the buffer sizes estimated and the flags of
+ * the formats are kept in a small cache in LRU order per instance, and
+ * the time is formatted into a buffer reused.
+ */
+#define MAX_CACHED_TIMEFORMATS      16
+
+struct cached_timeformat {
+    struct list_head                ln;
+    char                           *format;
+    size_t                          sz_buff;
+    /* whether there is any brace to handle */
+    unsigned int                    has_braces:1;
+    /* %s depends on `TZ` */
+    unsigned int                    needs_tz:1;
+};
+
+static bool uses_specifier(const char *timeformat, int specifier)
+{
+    while (*timeformat) {
+        if (timeformat[0] == '%' && timeformat[1] != '\0') {
+            if ((timeformat[1] == 'E' || timeformat[1] == 'O') &&
+                    timeformat[2] != '\0')
+                timeformat++;
+            if (timeformat[1] == specifier)
+                return true;
+            timeformat++;
+        }
+        timeformat++;
+    }
+
+    return false;
+}
+
+static void
+compile_timeformat(struct cached_timeformat *tf, const char *timeformat)
+{
+    tf->sz_buff = estimate_buffer_size(timeformat);
+    tf->has_braces = (strpbrk(timeformat, "{}") != NULL);
+    tf->needs_tz = uses_specifier(timeformat, 's');
+}
+
+static void
+uncache_timeformat(struct pcinst *inst, struct cached_timeformat *tf)
+{
+    list_del(&tf->ln);
+    inst->nr_timeformats--;
+
+    free(tf->format);
+    free(tf);
+}
+
+static const struct cached_timeformat *
+find_timeformat(struct pcinst *inst, const char *timeformat)
+{
+    struct cached_timeformat *tf;
+
+    list_for_each_entry(tf, &inst->timeformats, ln) {
+        if (strcmp(tf->format, timeformat) == 0) {
+            list_move(&tf->ln, &inst->timeformats);
+            return tf;
+        }
+    }
+
+    tf = calloc(1, sizeof(*tf));
+    if (tf == NULL || (tf->format = strdup(timeformat)) == NULL) {
+        free(tf);
+        return NULL;
+    }
+
+    compile_timeformat(tf, timeformat);
+    if (inst->nr_timeformats >= MAX_CACHED_TIMEFORMATS) {
+        uncache_timeformat(inst,
+                list_last_entry(&inst->timeformats,
+                    struct cached_timeformat, ln));
+    }
+
+    list_add(&tf->ln, &inst->timeformats);
+    inst->nr_timeformats++;
+    return tf;
+}
+
+void pcdvobjs_datetime_init_instance(struct pcinst *inst)
+{
+    list_head_init(&inst->timeformats);
+    inst->nr_timeformats = 0;
+    inst->tfmt_buff = NULL;
+    inst->sz_tfmt_buff = 0;
+}
+
+void pcdvobjs_datetime_cleanup_instance(struct pcinst *inst)
+{
+    if (inst->timeformats.next) {
+        struct cached_timeformat *tf, *tmp;
+        list_for_each_entry_safe(tf, tmp, &inst->timeformats, ln) {
+            uncache_timeformat(inst, tf);
+        }
+        inst->timeformats.next = inst->timeformats.prev = NULL;
+    }
+
+    free(inst->tfmt_buff);
+    inst->tfmt_buff = NULL;
+    inst->sz_tfmt_buff = 0;
+}
+
 static purc_variant_t
 format_broken_down_time(const char *timeformat, const struct tm *tm,
         suseconds_t usec, const char *timezone)
 {
-    size_t max;
+    struct pcinst *inst = pcinst_current();
+    struct cached_timeformat tmp;
+    const struct cached_timeformat *tf = NULL;
     char *result = NULL;
+    size_t max;
+
+    if (inst && inst->timeformats.next)
+        tf = find_timeformat(inst, timeformat);
+    if (tf == NULL) {
+        compile_timeformat(&tmp, timeformat);
+        tf = &tmp;
+    }
 
-    max = estimate_buffer_size(timeformat);
+    max = tf->sz_buff;
     // PC_DEBUG("buffer size for %s: %lu\n", timeformat, max);
 
-    result = malloc(max+1);
+    bool reused = (tf != &tmp);
+    if (reused) {
+        if (inst->sz_tfmt_buff < max + 1) {
+            char *buff = realloc(inst->tfmt_buff, max + 1);
+            if (buff) {
+                inst->tfmt_buff = buff;
+                inst->sz_tfmt_buff = max + 1;
+            }
+        }
+        result = (inst->sz_tfmt_buff >= max + 1) ? inst->tfmt_buff : NULL;
+    }
+    else {
+        result = malloc(max+1);
+    }
+
     if (result == NULL) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return PURC_VARIANT_INVALID;
     }
 
-    char *tz_old = set_tz(timezone);
-    if (strftime(result, max, timeformat, tm) == 0) {
+    /* the timezone is carried by the broken-down time except for %s */
+    char *tz_old = tf->needs_tz ? pcdvobjs_timezone_set(timezone) : NULL;
+    size_t len = strftime(result, max, timeformat, tm);
+    pcdvobjs_timezone_restore(tz_old);
+    if (len == 0) {
         // should not occur.
         PC_ERROR("Too small buffer to format time\n");
         purc_set_error(PURC_ERROR_TOO_SMALL_BUFF);
+        if (!reused)
+            free(result);
         return PURC_VARIANT_INVALID;
     }
-    unset_tz(tz_old);
 
     // PC_DEBUG("formated time: %s\n", result);
 
@@ -543,9 +638,14 @@ format_broken_down_time(const char *timeformat, const struct tm *tm,
 #endif                   /* } */
 #endif
 
-    handle_braces(result, max, on_found, &usec);
+    if (tf->has_braces) {
+        handle_braces(result, max, on_found, &usec);
+        len = strlen(result);
+    }
 
-    return purc_variant_make_string_reuse_buff(result, max, false);
+    if (!reused)
+        return purc_variant_make_string_reuse_buff(result, max, false);
+    return purc_variant_make_string_ex(result, len, false);
 }
 
 static purc_variant_t
@@ -640,7 +740,7 @@ time_prt_getter(purc_variant_t root,
                 goto failed;
             }
 
-            if (!pcdvobjs_is_valid_timezone(tz)) {
+            if (!pcdvobjs_timezone_check(tz)) {
                 goto failed;
             }
 
@@ -936,7 +1036,7 @@ localtime_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
             goto failed;
         }
 
-        if (!pcdvobjs_is_valid_timezone(tz)) {
+        if (!pcdvobjs_timezone_check(tz)) {
             goto failed;
         }
 
@@ -1000,7 +1100,7 @@ fmttime_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
             goto failed;
         }
 
-        if (!pcdvobjs_is_valid_timezone(tz)) {
+        if (!pcdvobjs_timezone_check(tz)) {
             goto failed;
         }
 
@@ -1034,7 +1134,7 @@ get_broken_down_time(purc_variant_t bdtime, struct tm *tm, suseconds_t *usec)
     if ((timezone = purc_variant_get_string_const(val)) == NULL) {
         goto failed;
     }
-    if (!pcdvobjs_is_valid_timezone(timezone)) {
+    if (!pcdvobjs_timezone_check(timezone)) {
         goto failed;
     }
 
@@ -1141,10 +1241,8 @@ get_broken_down_time(purc_variant_t bdtime, struct tm *tm, suseconds_t *usec)
     if (number < 0)
         tm->tm_isdst = -1;
 
-    char *tz_old = set_tz(timezone);
-    time_t t = mktime(tm);
-    localtime_r(&t, tm);
-    unset_tz(tz_old);
+    /* normalize the broken-down time */
+    pcdvobjs_timezone_mktime(timezone, tm);
 
     return timezone;
 
@@ -1185,7 +1283,7 @@ fmtbdtime_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
             goto failed;
         }
 
-        if (!pcdvobjs_is_valid_timezone(timezone)) {
+        if (!pcdvobjs_timezone_check(timezone)) {
             goto failed;
         }
     }
@@ -1222,7 +1320,7 @@ mktime_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
-    if (!pcdvobjs_is_valid_timezone(timezone)) {
+    if (!pcdvobjs_timezone_check(timezone)) {
         goto failed;
     }
 
@@ -30,6 +30,7 @@
 #include "private/dvobjs.h"
 #include "private/atom-buckets.h"
 #include "purc-variant.h"
+#include "helper.h"
 
 #include <time.h>
 #include <limits.h>
@@ -169,16 +170,20 @@ int pcdvobjs_global_keyword_id(const char *keyword, size_t length)
 static int _init_instance(struct pcinst* inst,
         const purc_instance_extra_info* extra_info)
 {
-    UNUSED_PARAM(inst);
     UNUSED_PARAM(extra_info);
     srand(time(NULL));
 
+    pcdvobjs_logical_init_instance(inst);
+    pcdvobjs_timezone_init_instance(inst);
+    pcdvobjs_datetime_init_instance(inst);
     return 0;
 }
 
 static void _cleanup_instance(struct pcinst* inst)
 {
-    UNUSED_PARAM(inst);
+    pcdvobjs_logical_cleanup_instance(inst);
+    pcdvobjs_timezone_cleanup_instance(inst);
+    pcdvobjs_datetime_cleanup_instance(inst);
 }
 
 static int _init_once(void)
@@ -57,7 +57,8 @@ count_getter(void *entity, const char *property_name,
     UNUSED_PARAM(call_flags);
 
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    return purc_variant_make_ulongint(elem_coll->nr_elems);
+    return purc_variant_make_ulongint(
+            pcdoc_elem_coll_count(elem_coll->doc, elem_coll));
 }
 
 static purc_variant_t
@@ -147,8 +148,10 @@ attr_getter(void *entity, const char *property_name,
     UNUSED_PARAM(call_flags);
 
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    if (elem_coll && elem_coll->nr_elems) {
-        pcdoc_element_t elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, 0);
+    /* NOTE: only the first element is found for a lazy collection */
+    pcdoc_element_t elem = elem_coll ?
+        pcdoc_elem_coll_get(elem_coll->doc, elem_coll, 0) : NULL;
+    if (elem) {
         return pcdvobjs_element_attr_getter(elem_coll->doc, elem,
             nr_args, argv, (call_flags & PCVRT_CALL_FLAG_SILENTLY));
     }
@@ -194,7 +197,7 @@ attr_setter(void *entity, const char *property_name,
     }
 
     ret = 0;
-    size_t len = elem_coll->nr_elems;
+    size_t len = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     for (size_t i = 0; i < len; i++) {
         pcdoc_element_t elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
         purc_variant_t k, v;
@@ -242,7 +245,7 @@ remove_attr_setter(void *entity, const char *property_name,
     ret = 0;
     const char *name = purc_variant_get_string_const(argv[0]);
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    size_t len = elem_coll->nr_elems;
+    size_t len = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     for (size_t i = 0; i < len; i++) {
         pcdoc_element_t elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
         pcintr_util_set_attribute(elem_coll->doc, elem,
@@ -263,12 +266,11 @@ contents_getter(void *entity, const char *property_name,
     purc_variant_t ret = PURC_VARIANT_INVALID;
     pcdoc_element_t elem = NULL;
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    size_t nr_elems = elem_coll->nr_elems;
-    if (nr_elems == 0) {
+    elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, 0);
+    if (elem == NULL) {
         goto out;
     }
 
-    elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, 0);
     ret = pcdvobjs_element_content_getter(elem_coll->doc, elem,
             nr_args, argv, (call_flags & PCVRT_CALL_FLAG_SILENTLY));
 out:
@@ -297,7 +299,7 @@ contents_setter(void *entity, const char *property_name,
 
     const char *content = purc_variant_get_string_const(argv[0]);
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    size_t len = elem_coll->nr_elems;
+    size_t len = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     for (size_t i = 0; i < len; i++) {
         pcdoc_element_t elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
         pcintr_util_new_content(elem_coll->doc, elem, PCDOC_OP_DISPLACE,
@@ -318,12 +320,11 @@ text_content_getter(void *entity, const char *property_name,
     purc_variant_t ret = PURC_VARIANT_INVALID;
     pcdoc_element_t elem = NULL;
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    size_t nr_elems = elem_coll->nr_elems;
-    if (nr_elems == 0) {
+    elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, 0);
+    if (elem == NULL) {
         goto out;
     }
 
-    elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, 0);
     ret = pcdvobjs_element_text_content_getter(elem_coll->doc, elem,
             nr_args, argv, (call_flags & PCVRT_CALL_FLAG_SILENTLY));
 out:
@@ -352,7 +353,7 @@ text_content_setter(void *entity, const char *property_name,
 
     const char *content = purc_variant_get_string_const(argv[0]);
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    size_t len = elem_coll->nr_elems;
+    size_t len = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     for (size_t i = 0; i < len; i++) {
         pcdoc_element_t elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
         pcintr_util_new_text_content(elem_coll->doc, elem, PCDOC_OP_DISPLACE,
@@ -374,12 +375,11 @@ data_content_getter(void *entity, const char *property_name,
     purc_variant_t ret = PURC_VARIANT_INVALID;
     pcdoc_element_t elem = NULL;
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    size_t nr_elems = elem_coll->nr_elems;
-    if (nr_elems == 0) {
+    elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, 0);
+    if (elem == NULL) {
         goto out;
     }
 
-    elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, 0);
     ret = pcdvobjs_element_data_content_getter(elem_coll->doc, elem,
             nr_args, argv, (call_flags & PCVRT_CALL_FLAG_SILENTLY));
 out:
@@ -403,7 +403,7 @@ data_content_setter(void *entity, const char *property_name,
     }
 
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    size_t len = elem_coll->nr_elems;
+    size_t len = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     for (size_t i = 0; i < len; i++) {
         pcdoc_element_t elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
         pcintr_util_set_data_content(elem_coll->doc, elem, PCDOC_OP_DISPLACE,
@@ -427,7 +427,7 @@ has_class_getter(void *entity, const char *property_name,
     bool has_class = false;
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
     pcdoc_element_t elem = NULL;
-    size_t nr_elems = elem_coll->nr_elems;
+    size_t nr_elems = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     for (size_t i = 0; i < nr_elems; i++) {
         elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
 
@@ -527,7 +527,7 @@ add_class_setter(void *entity, const char *property_name,
 
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
     pcdoc_element_t elem = NULL;
-    size_t nr_elems = elem_coll->nr_elems;
+    size_t nr_elems = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     size_t nr_param = purc_variant_array_get_size(param);
 
     ret = 0;
@@ -610,7 +610,7 @@ remove_class_setter(void *entity, const char *property_name,
 
     pcdoc_element_t elem = NULL;
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) entity;
-    size_t nr_elems = elem_coll->nr_elems;
+    size_t nr_elems = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     size_t nr_param = purc_variant_array_get_size(param);
 
     ret = 0;
@@ -798,7 +798,7 @@ cleaner(void *native_entity, unsigned call_flags)
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) native_entity;
 
     pcdoc_element_t elem = NULL;
-    size_t len = elem_coll->nr_elems;
+    size_t len = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     for (size_t i = 0; i < len; i++) {
         elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
         if (!elem) {
@@ -818,7 +818,7 @@ eraser(void *native_entity, unsigned call_flags)
     pcdoc_elem_coll_t elem_coll = (pcdoc_elem_coll_t) native_entity;
 
     pcdoc_element_t elem = NULL;
-    size_t len = elem_coll->nr_elems;
+    size_t len = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
     size_t nr_erase = 0;
     for (size_t i = 0; i < len; i++) {
         elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
@@ -857,9 +857,10 @@ did_matched(void *native_entity, purc_variant_t val)
         }
     }
 
-    if (comp && elem_coll->nr_elems) {
+    size_t nr_elems = pcdoc_elem_coll_count(elem_coll->doc, elem_coll);
+    if (comp && nr_elems) {
         pcdoc_element_t elem = NULL;
-        for (size_t i = 0; i < elem_coll->nr_elems; i++) {
+        for (size_t i = 0; i < nr_elems; i++) {
             elem = pcdoc_elem_coll_get(elem_coll->doc, elem_coll, i);
             if (elem == comp) {
                 ret = true;
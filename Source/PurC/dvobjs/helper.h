@@ -29,6 +29,8 @@
 #include "private/debug.h"
 #include "purc-variant.h"
 
+#include <time.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif  /* __cplusplus */
@@ -50,6 +52,46 @@ const char *pcdvobjs_remove_space (char * buffer) WTF_INTERNAL;
 int pcdvobjs_logical_parse(const char *input,
         struct pcdvobjs_logical_param *param) WTF_INTERNAL;
 
+/* a logical expression compiled by pcdvobjs_logical_compile() */
+struct pcdvobjs_logical_prog;
+
+/* Returns NULL if the expression is bad or out of memory. */
+struct pcdvobjs_logical_prog *
+pcdvobjs_logical_compile(const char *input) WTF_INTERNAL;
+
+/* Evaluates the compiled expression with the parameter in the same way as
+   pcdvobjs_logical_parse(). */
+int pcdvobjs_logical_exec(const struct pcdvobjs_logical_prog *prog,
+        struct pcdvobjs_logical_param *param) WTF_INTERNAL;
+
+void pcdvobjs_logical_free(struct pcdvobjs_logical_prog *prog) WTF_INTERNAL;
+
+struct pcinst;
+void pcdvobjs_logical_init_instance(struct pcinst *inst) WTF_INTERNAL;
+void pcdvobjs_logical_cleanup_instance(struct pcinst *inst) WTF_INTERNAL;
+
+/* Changes `TZ` temporarily; returns the old one which should be restored
+   by pcdvobjs_timezone_restore(). */
+char *pcdvobjs_timezone_set(const char *timezone) WTF_INTERNAL;
+void pcdvobjs_timezone_restore(char *tz_old) WTF_INTERNAL;
+
+/* Checks the timezone like pcdvobjs_is_valid_timezone(), but the result
+   is cached. */
+bool pcdvobjs_timezone_check(const char *timezone) WTF_INTERNAL;
+
+/* Like localtime_r() and mktime() in the timezone but without changing
+   `TZ`; NULL for the local timezone. */
+void pcdvobjs_timezone_localtime(const char *timezone, time_t t,
+        struct tm *tm) WTF_INTERNAL;
+time_t pcdvobjs_timezone_mktime(const char *timezone, struct tm *tm)
+    WTF_INTERNAL;
+
+void pcdvobjs_timezone_init_instance(struct pcinst *inst) WTF_INTERNAL;
+void pcdvobjs_timezone_cleanup_instance(struct pcinst *inst) WTF_INTERNAL;
+
+void pcdvobjs_datetime_init_instance(struct pcinst *inst) WTF_INTERNAL;
+void pcdvobjs_datetime_cleanup_instance(struct pcinst *inst) WTF_INTERNAL;
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
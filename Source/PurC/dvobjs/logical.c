@@ -26,35 +26,29 @@
 #include "private/errors.h"
 #include "private/dvobjs.h"
 #include "private/utils.h"
+#include "private/regex.h"
+#include "private/list.h"
 #include "purc-variant.h"
 #include "helper.h"
 
 #include <math.h>
 #include <regex.h>
+#include <string.h>
 
 static bool reg_cmp(const char *buf1, const char *buf2)
 {
-    regex_t reg;
-
     assert(buf1);
     assert(buf2);
 
-    if (regcomp(&reg, buf1, REG_EXTENDED | REG_NOSUB) < 0) {
-        goto error;
-    }
-
-    if (regexec(&reg, buf2, 0, NULL, 0) == REG_NOMATCH) {
-        goto error_free;
+    const regex_t *reg = pcregex_cache_get(buf1, REG_EXTENDED | REG_NOSUB,
+            NULL);
+    if (reg == NULL) {
+        return false;
     }
 
-    regfree(&reg);
-    return true;
-
-error_free:
-    regfree(&reg);
-
-error:
-    return false;
+    bool matched = (regexec(reg, buf2, 0, NULL, 0) != REG_NOMATCH);
+    pcregex_cache_release(reg);
+    return matched;
 }
 
 static purc_variant_t
@@ -773,6 +767,111 @@ fatal:
     return PURC_VARIANT_INVALID;
 }
 
+/*
+ * NOTE: the expressions of $L.eval are usually the conditions evaluated
+ * again and again in loops; they are compiled once per instance, and
+ * a small cache in LRU order is enough, like the one of the regexes.
+ */
+#define MAX_CACHED_LOGICALS     32
+
+struct cached_logical {
+    struct list_head                ln;
+    char                           *exp;
+    /* NULL if the expression is bad */
+    struct pcdvobjs_logical_prog   *prog;
+};
+
+static void
+uncache_logical(struct pcinst *inst, struct cached_logical *entry)
+{
+    list_del(&entry->ln);
+    inst->nr_logicals--;
+
+    if (entry->prog)
+        pcdvobjs_logical_free(entry->prog);
+    free(entry->exp);
+    free(entry);
+}
+
+static struct cached_logical *
+find_logical(struct pcinst *inst, const char *exp)
+{
+    struct cached_logical *entry;
+
+    list_for_each_entry(entry, &inst->logicals, ln) {
+        if (strcmp(entry->exp, exp) == 0) {
+            list_move(&entry->ln, &inst->logicals);
+            inst->nr_logical_hits++;
+            return entry;
+        }
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL || (entry->exp = strdup(exp)) == NULL) {
+        free(entry);
+        return NULL;
+    }
+
+    entry->prog = pcdvobjs_logical_compile(exp);
+
+    inst->nr_logical_misses++;
+    if (inst->nr_logicals >= MAX_CACHED_LOGICALS) {
+        uncache_logical(inst,
+                list_last_entry(&inst->logicals, struct cached_logical, ln));
+    }
+
+    list_add(&entry->ln, &inst->logicals);
+    inst->nr_logicals++;
+    return entry;
+}
+
+static int
+eval_logical(const char *exp, struct pcdvobjs_logical_param *param)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->logicals.next == NULL)
+        return pcdvobjs_logical_parse(exp, param);
+
+    struct cached_logical *entry = find_logical(inst, exp);
+    if (entry == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    if (entry->prog == NULL) {
+        param->result = 0;
+        return 1;
+    }
+
+    return pcdvobjs_logical_exec(entry->prog, param);
+}
+
+void pcdvobjs_logical_init_instance(struct pcinst *inst)
+{
+    list_head_init(&inst->logicals);
+    inst->nr_logicals = 0;
+    inst->nr_logical_hits = 0;
+    inst->nr_logical_misses = 0;
+}
+
+void pcdvobjs_logical_cleanup_instance(struct pcinst *inst)
+{
+    if (inst->logicals.next == NULL)
+        return;
+
+    PC_DEBUG("Logical expressions got from the cache: %u hits, %u misses\n",
+            (unsigned)inst->nr_logical_hits,
+            (unsigned)inst->nr_logical_misses);
+
+    struct cached_logical *entry, *tmp;
+    list_for_each_entry_safe(entry, tmp, &inst->logicals, ln) {
+        uncache_logical(inst, entry);
+    }
+
+    /* NOTE: the expressions evaluated by the later cleanups are not cached */
+    inst->logicals.next = inst->logicals.prev = NULL;
+}
+
 static purc_variant_t
 eval_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -800,7 +899,8 @@ eval_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         (nr_args > 1) ? argv[1] : PURC_VARIANT_INVALID,
         PURC_VARIANT_INVALID
     };
-    pcdvobjs_logical_parse(exp, &myparam);
+    if (eval_logical(exp, &myparam) < 0)
+        goto failed;
 
     return purc_variant_make_boolean(myparam.result);
 
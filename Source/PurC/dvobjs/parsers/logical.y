@@ -33,6 +33,39 @@
     #define YYSTYPE       LOGICAL_YYSTYPE
     #define YYLTYPE       LOGICAL_YYLTYPE
 
+    /* the instructions of a compiled expression, run on a stack */
+    enum logical_op {
+        LOGICAL_OP_NUM,     /* push the number */
+        LOGICAL_OP_VAR,     /* push the numerified value of the variable */
+        LOGICAL_OP_NOT,     /* replace the top with the result */
+        LOGICAL_OP_GE,      /* replace the top two with the result */
+        LOGICAL_OP_LE,
+        LOGICAL_OP_EQ,
+        LOGICAL_OP_NE,
+        LOGICAL_OP_AND,
+        LOGICAL_OP_OR,
+        LOGICAL_OP_GT,
+        LOGICAL_OP_LT,
+    };
+
+    struct logical_inst {
+        enum logical_op     op;
+        union {
+            double          d;
+            char           *name;
+        };
+    };
+
+    struct pcdvobjs_logical_prog {
+        struct logical_inst    *insts;
+        size_t                  nr_insts;
+        size_t                  sz_insts;
+
+        /* the depth of the stack when running the instructions */
+        size_t                  depth;
+        size_t                  max_depth;
+    };
+
     #ifndef YY_TYPEDEF_YY_SCANNER_T
     #define YY_TYPEDEF_YY_SCANNER_T
     typedef void* yyscan_t;
@@ -48,10 +81,36 @@
     static void yyerror(
         YYLTYPE *yylloc,                   // match %define locations
         yyscan_t arg,                      // match %param
-        struct pcdvobjs_logical_param *param, // match %parse-param
+        struct pcdvobjs_logical_prog *param, // match %parse-param
         const char *errsg
     );
 
+    static int emit(struct pcdvobjs_logical_prog *prog,
+            const struct logical_inst *inst)
+    {
+        if (prog->nr_insts == prog->sz_insts) {
+            size_t sz = prog->sz_insts ? prog->sz_insts * 2 : 8;
+            struct logical_inst *insts = realloc(prog->insts,
+                    sizeof(*insts) * sz);
+            if (insts == NULL)
+                return -1;
+            prog->insts = insts;
+            prog->sz_insts = sz;
+        }
+
+        prog->insts[prog->nr_insts++] = *inst;
+
+        /* a binary operator pops two and pushes one */
+        if (inst->op == LOGICAL_OP_NUM || inst->op == LOGICAL_OP_VAR) {
+            if (++prog->depth > prog->max_depth)
+                prog->max_depth = prog->depth;
+        }
+        else if (inst->op != LOGICAL_OP_NOT) {
+            prog->depth--;
+        }
+        return 0;
+    }
+
     static double ge(double l, double r)
     {
         bool eq = pcutils_equal_doubles(l, r);
@@ -116,61 +175,47 @@
         return (FP_ZERO == fpclassify(d)) ? false : true;
     }
 
-    #define EVAL_FREE(v) do {            \
-    } while (0)
-
-    #define EVAL_SET(_a) do {                          \
-        param->result = eval_boolean(_a);              \
-    } while (0)
-
-    #define EVAL_APPLY_1(_f, _r, _a) do {                            \
-        _r = _f(_a);                                                 \
+    #define EMIT(_inst) do {                                         \
+        if (emit(param, (_inst)))                                    \
+            YYABORT;                                                 \
     } while (0)
 
-    #define EVAL_APPLY_2(_f, _r, _a, _b) do {                        \
-        _r = _f(_a, _b);                                             \
+    #define EMIT_OP(_op) do {                                        \
+        struct logical_inst _i = { .op = _op };                      \
+        EMIT(&_i);                                                   \
     } while (0)
 
-    #define EVAL_INT(_r, _a) do {                                    \
+    #define EMIT_INT(_a) do {                                        \
+        struct logical_inst _i = { .op = LOGICAL_OP_NUM };           \
         char   *ptr = (char*)_a[1];                                  \
         size_t  sz  = _a[0];                                         \
         char c  = ptr[sz];                                           \
         ptr[sz] = '\0';                                              \
-        long long ll = atoll(ptr);                                   \
+        _i.d = atoll(ptr);                                           \
         ptr[sz] = c;                                                 \
-        _r = ll;                                                     \
+        EMIT(&_i);                                                   \
     } while (0)
 
-    #define EVAL_NUM(_r, _a) do {                                    \
+    #define EMIT_NUM(_a) do {                                        \
+        struct logical_inst _i = { .op = LOGICAL_OP_NUM };           \
         char   *ptr = (char*)_a[1];                                  \
         size_t  sz  = _a[0];                                         \
         char c  = ptr[sz];                                           \
         ptr[sz] = '\0';                                              \
-        double d = atof(ptr);                                        \
+        _i.d = atof(ptr);                                            \
         ptr[sz] = c;                                                 \
-        _r = d;                                                      \
+        EMIT(&_i);                                                   \
     } while (0)
 
-    #define EVAL_VAR(_r, _a) do {                                    \
-        if (!param->variables)                                       \
+    #define EMIT_VAR(_a) do {                                        \
+        struct logical_inst _i = { .op = LOGICAL_OP_VAR };           \
+        _i.name = strndup((const char*)_a[1], _a[0]);                \
+        if (_i.name == NULL)                                         \
+            YYABORT;                                                 \
+        if (emit(param, &_i)) {                                      \
+            free(_i.name);                                           \
             YYABORT;                                                 \
-        char   *ptr = (char*)_a[1];                                  \
-        size_t  sz  = _a[0];                                         \
-        char c  = ptr[sz];                                           \
-        ptr[sz] = '\0';                                              \
-        purc_variant_t _v;                                           \
-        _v = purc_variant_object_get_by_ckey(param->variables, ptr); \
-        ptr[sz] = c;                                                 \
-        if (_v == PURC_VARIANT_INVALID) {                            \
-            if (!param->v && !purc_variant_is_object(param->v))      \
-                YYABORT;                                             \
-            ptr[sz] = '\0';                                          \
-            _v = purc_variant_object_get_by_ckey(param->v, ptr);     \
-            ptr[sz] = c;                                             \
-            if (_v == PURC_VARIANT_INVALID)                          \
-                YYABORT;                                             \
         }                                                            \
-        _r = purc_variant_numerify(_v);                             \
     } while (0)
 }
 
@@ -184,12 +229,9 @@
 %verbose
 
 %param { yyscan_t arg }
-%parse-param { struct pcdvobjs_logical_param *param }
+%parse-param { struct pcdvobjs_logical_prog *param }
 
 %union { uintptr_t  sz_ptr[2]; }
-%union { double v; }
-
-%destructor { EVAL_FREE($$); } <v>
 
 /* declare tokens */
 /*
@@ -211,7 +253,7 @@
 %precedence NEG               /* ! */
 %left GE LE EQ NE '>' '<'     /* relational operators */
 
-%nterm <v> term exp
+%nterm term exp
 
 %% /* The grammar follows. */
 
@@ -222,27 +264,27 @@ input:
 ;
 
 statement:
-  exp                { EVAL_SET($1); }
+  exp
 ;
 
 exp:
   term
-| exp GE exp         { EVAL_APPLY_2(ge, $$, $1, $3); }
-| exp LE exp         { EVAL_APPLY_2(le, $$, $1, $3); }
-| exp EQ exp         { EVAL_APPLY_2(eq, $$, $1, $3); }
-| exp NE exp         { EVAL_APPLY_2(ne, $$, $1, $3); }
-| exp AND exp        { EVAL_APPLY_2(and, $$, $1, $3); }
-| exp OR exp         { EVAL_APPLY_2(or, $$, $1, $3); }
-| exp '>' exp        { EVAL_APPLY_2(gt, $$, $1, $3); }
-| exp '<' exp        { EVAL_APPLY_2(lt, $$, $1, $3); }
-| '!' exp %prec NEG  { EVAL_APPLY_1(not, $$, $2); }
+| exp GE exp         { EMIT_OP(LOGICAL_OP_GE); }
+| exp LE exp         { EMIT_OP(LOGICAL_OP_LE); }
+| exp EQ exp         { EMIT_OP(LOGICAL_OP_EQ); }
+| exp NE exp         { EMIT_OP(LOGICAL_OP_NE); }
+| exp AND exp        { EMIT_OP(LOGICAL_OP_AND); }
+| exp OR exp         { EMIT_OP(LOGICAL_OP_OR); }
+| exp '>' exp        { EMIT_OP(LOGICAL_OP_GT); }
+| exp '<' exp        { EMIT_OP(LOGICAL_OP_LT); }
+| '!' exp %prec NEG  { EMIT_OP(LOGICAL_OP_NOT); }
 ;
 
 term:
-  INT                { EVAL_INT($$, $1); }
-| NUM                { EVAL_NUM($$, $1); }
-| VAR                { EVAL_VAR($$, $1); }
-| '(' exp ')'        { $$ = $2; }
+  INT                { EMIT_INT($1); }
+| NUM                { EMIT_NUM($1); }
+| VAR                { EMIT_VAR($1); }
+| '(' exp ')'
 ;
 
 %%
@@ -252,7 +294,7 @@ static void
 yyerror(
     YYLTYPE *yylloc,                   // match %define locations
     yyscan_t arg,                      // match %param
-    struct pcdvobjs_logical_param *param, // match %parse-param
+    struct pcdvobjs_logical_prog *param, // match %parse-param
     const char *errsg
 )
 {
@@ -266,23 +308,160 @@ yyerror(
         errsg);
 }
 
-int pcdvobjs_logical_parse(const char *input,
-        struct pcdvobjs_logical_param *param)
+void pcdvobjs_logical_free(struct pcdvobjs_logical_prog *prog)
+{
+    for (size_t i = 0; i < prog->nr_insts; i++) {
+        if (prog->insts[i].op == LOGICAL_OP_VAR)
+            free(prog->insts[i].name);
+    }
+
+    free(prog->insts);
+    free(prog);
+}
+
+struct pcdvobjs_logical_prog *pcdvobjs_logical_compile(const char *input)
 {
+    struct pcdvobjs_logical_prog *prog = calloc(1, sizeof(*prog));
+    if (prog == NULL)
+        return NULL;
+
     yyscan_t arg = {0};
 
     yylex_init(&arg);
     // yyset_in(in, arg);
     // yyset_debug(debug, arg);
-    yyset_extra(param, arg);
+    yyset_extra(prog, arg);
     yy_scan_string(input, arg);
-    int ret =yyparse(arg, param);
+    int ret = yyparse(arg, prog);
     yylex_destroy(arg);
+
+    if (ret) {
+        pcdvobjs_logical_free(prog);
+        return NULL;
+    }
+
+    return prog;
+}
+
+static purc_variant_t
+get_variable(struct pcdvobjs_logical_param *param, const char *name)
+{
+    purc_variant_t v = PURC_VARIANT_INVALID;
+
+    if (param->variables)
+        v = purc_variant_object_get_by_ckey(param->variables, name);
+
+    if (v == PURC_VARIANT_INVALID && param->v &&
+            purc_variant_is_object(param->v))
+        v = purc_variant_object_get_by_ckey(param->v, name);
+
+    return v;
+}
+
+int pcdvobjs_logical_exec(const struct pcdvobjs_logical_prog *prog,
+        struct pcdvobjs_logical_param *param)
+{
+    double local[16];
+    double *stack = local;
+    size_t top = 0;
+    int ret = 0;
+
+    param->result = 0;
+    if (prog->nr_insts == 0)
+        goto done;
+
+    if (prog->max_depth > PCA_TABLESIZE(local)) {
+        stack = malloc(sizeof(double) * prog->max_depth);
+        if (stack == NULL) {
+            ret = 1;
+            goto done;
+        }
+    }
+
+    for (size_t i = 0; i < prog->nr_insts; i++) {
+        const struct logical_inst *inst = prog->insts + i;
+
+        if (inst->op == LOGICAL_OP_NUM) {
+            stack[top++] = inst->d;
+            continue;
+        }
+        else if (inst->op == LOGICAL_OP_VAR) {
+            purc_variant_t v = get_variable(param, inst->name);
+            if (v == PURC_VARIANT_INVALID) {
+                ret = 1;
+                goto done;
+            }
+            stack[top++] = purc_variant_numerify(v);
+            continue;
+        }
+        else if (inst->op == LOGICAL_OP_NOT) {
+            stack[top - 1] = not(stack[top - 1]);
+            continue;
+        }
+
+        double r = stack[--top];
+        double *l = stack + top - 1;
+        switch (inst->op) {
+        case LOGICAL_OP_GE:
+            *l = ge(*l, r);
+            break;
+        case LOGICAL_OP_LE:
+            *l = le(*l, r);
+            break;
+        case LOGICAL_OP_EQ:
+            *l = eq(*l, r);
+            break;
+        case LOGICAL_OP_NE:
+            *l = ne(*l, r);
+            break;
+        case LOGICAL_OP_AND:
+            *l = and(*l, r);
+            break;
+        case LOGICAL_OP_OR:
+            *l = or(*l, r);
+            break;
+        case LOGICAL_OP_GT:
+            *l = gt(*l, r);
+            break;
+        case LOGICAL_OP_LT:
+            *l = lt(*l, r);
+            break;
+        default:
+            assert(0);
+            break;
+        }
+    }
+
+    assert(top == 1);
+    param->result = eval_boolean(stack[0]);
+
+done:
+    if (stack != local)
+        free(stack);
+
     if (param->variables) {
         purc_variant_unref(param->variables);
         param->variables = NULL;
     }
 
-    return ret ? 1 : 0;
+    return ret;
+}
+
+int pcdvobjs_logical_parse(const char *input,
+        struct pcdvobjs_logical_param *param)
+{
+    struct pcdvobjs_logical_prog *prog = pcdvobjs_logical_compile(input);
+    if (prog == NULL) {
+        param->result = 0;
+        if (param->variables) {
+            purc_variant_unref(param->variables);
+            param->variables = NULL;
+        }
+        return 1;
+    }
+
+    int ret = pcdvobjs_logical_exec(prog, param);
+    pcdvobjs_logical_free(prog);
+    return ret;
 }
 
@@ -198,6 +198,21 @@ uri_getter(purc_variant_t root,
     return purc_variant_make_string(inst->endpoint_name, false);
 }
 
+static purc_variant_t
+metrics_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    purc_variant_t v = purc_get_instance_metrics();
+    if (v == PURC_VARIANT_INVALID && (call_flags & PCVRT_CALL_FLAG_SILENTLY))
+        return purc_variant_make_null();
+
+    return v;
+}
+
 static purc_variant_t
 auto_switching_rdr_getter(purc_variant_t root,
         size_t nr_args, purc_variant_t *argv, unsigned call_flags)
@@ -303,17 +318,51 @@ chan_setter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         }
     }
 
+    /* the flavor is only used when opening a new channel */
+    int flavor = -1;
+    if (nr_args > 2) {
+        const char *str = purc_variant_get_string_const(argv[2]);
+        if (str == NULL) {
+            pcinst_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+            goto failed;
+        }
+
+        if (strcmp(str, PCCHAN_FLAVOR_LOCAL) == 0)
+            flavor = 0;
+        else if (strcmp(str, PCCHAN_FLAVOR_SHARED) == 0)
+            flavor = 1;
+        else {
+            pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+            goto failed;
+        }
+    }
+
     PC_DEBUG("chan_setter(%s, %u)\n", chan_name, cap);
 
     pcchan_t chan = pcchan_retrieve(chan_name);
-    if (chan) {
+    if (chan && pcchan_capability(chan) > 0) {
+        if (flavor >= 0 && flavor != (chan->shared != NULL)) {
+            pcinst_set_error(PURC_ERROR_EXISTS);
+            goto failed;
+        }
+
+        if (!pcchan_ctrl(chan, cap)) {
+            // error set by pcchan_ctrl()
+            goto failed;
+        }
+    }
+    else if (chan && flavor <= 0) {
+        // reopen the closed channel
         if (!pcchan_ctrl(chan, cap)) {
             // error set by pcchan_ctrl()
             goto failed;
         }
     }
     else {
-        chan = pcchan_open(chan_name, cap);
+        if (flavor == 1)
+            chan = pcchan_open_shared(chan_name, cap);
+        else
+            chan = pcchan_open(chan_name, cap);
         if (chan == NULL) {
             // error set by pcchan_open()
             goto failed;
@@ -344,6 +393,7 @@ purc_dvobj_runner_new(void)
         { "runLabel",           runner_label_getter,    NULL },
         { "rid",                rid_getter,             NULL },
         { "uri",                uri_getter,             NULL },
+        { "metrics",            metrics_getter,         NULL },
         { "autoSwitchingRdr",
             auto_switching_rdr_getter, auto_switching_rdr_setter },
         { "chan",               chan_getter,            chan_setter },
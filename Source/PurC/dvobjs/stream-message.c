@@ -34,6 +34,7 @@
 #include "private/dvobjs.h"
 #include "private/list.h"
 #include "private/interpreter.h"
+#include "private/uring.h"
 
 #include <errno.h>
 
@@ -61,6 +62,12 @@
 #define EVENT_TYPE_CLOSE                    "close"
 #define EVENT_TYPE_ERROR                    "error"
 #   define EVENT_SUBTYPE_MESSAGE            "message"
+#define EVENT_TYPE_CONGESTED                "congested"
+#define EVENT_TYPE_WRITABLE                 "writable"
+
+/* the default high watermark of the pending data; the low one is
+   a quarter of the high one by default */
+#define DEF_HIGH_WATERMARK          (SOCK_THROTTLE_THLD / 2)
 
 /* The frame operation codes for UnixSocket */
 typedef enum us_opcode {
@@ -119,6 +126,15 @@ struct stream_extended_data {
     size_t              sz_pending;
     struct list_head    pending;
 
+    /* the watermarks of the pending data for back-pressure */
+    size_t              sz_high_watermark;
+    size_t              sz_low_watermark;
+    bool                congested;
+
+    /* fields for the writes submitted to io_uring; see uring.c */
+    bool                use_uring;
+    uintptr_t           uring_req;          /* the write in flight */
+
     /* current frame header */
     us_frame_header     header;
     size_t              sz_header;
@@ -189,6 +205,11 @@ static void cleanup_extension(struct pcdvobjs_stream *stream)
             stream->monitor4w = 0;
         }
 
+        if (ext->uring_req) {
+            pcintr_uring_cancel(ext->uring_req);
+            ext->uring_req = 0;
+        }
+
         if (stream->fd4r >= 0) {
             close(stream->fd4r);
         }
@@ -211,6 +232,34 @@ static void cleanup_extension(struct pcdvobjs_stream *stream)
 
 }
 
+/*
+ * Fires a `congested` event when the pending data reach the high watermark,
+ * and a `writable` event when they drop to the low watermark, so that the
+ * producers can slow down before the stream is throttled.
+ */
+static void us_check_watermarks(struct pcdvobjs_stream *stream)
+{
+    struct stream_extended_data *ext = stream->ext0.data;
+    const char *event;
+
+    if (!ext->congested && ext->sz_pending >= ext->sz_high_watermark) {
+        ext->congested = true;
+        event = EVENT_TYPE_CONGESTED;
+    }
+    else if (ext->congested && ext->sz_pending <= ext->sz_low_watermark) {
+        ext->congested = false;
+        event = EVENT_TYPE_WRITABLE;
+    }
+    else {
+        return;
+    }
+
+    pcintr_coroutine_post_event(stream->cid,
+            PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, stream->observed,
+            event, NULL,
+            purc_variant_make_ulongint(ext->sz_pending), PURC_VARIANT_INVALID);
+}
+
 /*
  * Queue new data.
  *
@@ -244,6 +293,7 @@ static bool us_queue_data(struct pcdvobjs_stream *stream,
         ext->status |= US_THROTTLING;
     }
 
+    us_check_watermarks(stream);
     return true;
 }
 
@@ -298,6 +348,10 @@ static ssize_t us_write_pending(struct pcdvobjs_stream *stream)
                 pending->szdata - pending->szsent);
 
         if (bytes > 0) {
+            total_bytes += bytes;
+            ext->sz_pending -= bytes;
+            us_update_mem_stats(ext);
+
             pending->szsent += bytes;
             if (pending->szsent >= pending->szdata) {
                 list_del(p);
@@ -306,10 +360,6 @@ static ssize_t us_write_pending(struct pcdvobjs_stream *stream)
             else {
                 break;
             }
-
-            total_bytes += bytes;
-            ext->sz_pending -= bytes;
-            us_update_mem_stats(ext);
         }
         else if (bytes == -1 && errno == EPIPE) {
             ext->status = US_ERR_IO | US_CLOSING;
@@ -320,12 +370,139 @@ static ssize_t us_write_pending(struct pcdvobjs_stream *stream)
         }
     }
 
+    us_check_watermarks(stream);
     return total_bytes;
 
 failed:
     return -1;
 }
 
+static bool us_handle_writes(int fd, purc_runloop_io_event event,
+        void *ctxt);
+static void us_on_written(void *ctxt, const char *data, size_t len,
+        ssize_t result);
+
+/*
+ * Submit a write to io_uring. The bytes in flight are counted in
+ * `sz_pending`, so the throttling works as for the queued data.
+ *
+ * Returns true if the write is submitted.
+ */
+static bool us_uring_submit(struct pcdvobjs_stream *stream,
+        const char *buf, size_t len)
+{
+    struct stream_extended_data *ext = stream->ext0.data;
+
+    ext->uring_req = pcintr_uring_write(stream->fd4w, buf, len,
+            us_on_written, stream);
+    if (ext->uring_req == 0)
+        return false;
+
+    ext->status |= US_SENDING;
+    return true;
+}
+
+/*
+ * Fall back to the writes driven by the readiness of the socket, when a
+ * write can not be submitted to io_uring. The unsubmitted data are put at
+ * the head of the pending list to keep the order.
+ */
+static void us_uring_fallback(struct pcdvobjs_stream *stream,
+        const char *buf, size_t len)
+{
+    struct stream_extended_data *ext = stream->ext0.data;
+
+    ext->use_uring = false;
+    if (len > 0) {
+        us_pending_data *pending_data;
+        pending_data = malloc(sizeof(us_pending_data) + len);
+        if (pending_data == NULL) {
+            us_clear_pending_data(ext);
+            ext->status = US_ERR_OOM | US_CLOSING;
+            return;
+        }
+
+        memcpy(pending_data->data, buf, len);
+        pending_data->szdata = len;
+        pending_data->szsent = 0;
+        list_add(&pending_data->list, &ext->pending);
+        ext->sz_pending += len;
+        ext->status |= US_SENDING;
+    }
+
+    stream->monitor4w = purc_runloop_add_fd_monitor(
+            purc_runloop_get_current(), stream->fd4w, PCRUNLOOP_IO_OUT,
+            us_handle_writes, stream);
+    if (stream->monitor4w == 0) {
+        us_clear_pending_data(ext);
+        ext->status = US_ERR_IO | US_CLOSING;
+    }
+}
+
+/*
+ * The callback of a write submitted to io_uring. Only one write of a
+ * stream is in flight, so the next one is submitted here.
+ */
+static void us_on_written(void *ctxt, const char *data, size_t len,
+        ssize_t result)
+{
+    struct pcdvobjs_stream *stream = ctxt;
+    struct stream_extended_data *ext = stream->ext0.data;
+
+    ext->uring_req = 0;
+    if (result == -EAGAIN || result == -EINTR) {
+        result = 0;
+    }
+    else if (result < 0) {
+        us_clear_pending_data(ext);
+        ext->status = US_ERR_IO | US_CLOSING;
+        goto done;
+    }
+
+    if ((size_t)result < len) {
+        /* did not write all of it; submit the rest before the others */
+        ext->sz_pending -= result;
+        if (!us_uring_submit(stream, data + result, len - result)) {
+            ext->sz_pending -= len - result;
+            us_uring_fallback(stream, data + result, len - result);
+        }
+    }
+    else {
+        ext->sz_pending -= len;
+        if (!list_empty(&ext->pending)) {
+            us_pending_data *pending;
+            pending = list_first_entry(&ext->pending, us_pending_data, list);
+            if (us_uring_submit(stream, (const char *)pending->data,
+                        pending->szdata)) {
+                list_del(&pending->list);
+                free(pending);
+            }
+            else {
+                us_uring_fallback(stream, NULL, 0);
+            }
+        }
+    }
+    us_update_mem_stats(ext);
+    us_check_watermarks(stream);
+
+    if (ext->uring_req == 0 && list_empty(&ext->pending)) {
+        ext->status &= ~US_SENDING;
+    }
+
+done:
+    if (ext->status & US_ERR_ANY) {
+        stream->ext0.msg_ops->on_error(stream, us_status_to_pcerr(ext));
+    }
+
+    if ((ext->status & US_CLOSING) && !(ext->status & US_SENDING)) {
+        pcintr_coroutine_post_event(stream->cid,
+                PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, stream->observed,
+                EVENT_TYPE_CLOSE, NULL,
+                PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+        cleanup_extension(stream);
+    }
+}
+
 /*
  * A wrapper of the system call write or send.
  *
@@ -338,6 +515,24 @@ static ssize_t us_write_sock(struct pcdvobjs_stream *stream,
     struct stream_extended_data *ext = stream->ext0.data;
     ssize_t bytes = 0;
 
+    if (ext->use_uring) {
+        /* keep one write in flight to keep the order of the data */
+        if (ext->uring_req == 0 && list_empty(&ext->pending)) {
+            if (us_uring_submit(stream, buffer, len)) {
+                ext->sz_pending += len;
+                us_update_mem_stats(ext);
+                us_check_watermarks(stream);
+                return len;
+            }
+
+            us_uring_fallback(stream, NULL, 0);
+        }
+        else {
+            us_queue_data(stream, buffer, len);
+            return bytes;
+        }
+    }
+
     /* attempt to send the whole buffer */
     if (list_empty(&ext->pending)) {
         bytes = us_write_data(stream, buffer, len);
@@ -1061,11 +1256,41 @@ static const struct purc_native_ops msg_entity_ops = {
     .on_release = on_release,
 };
 
+static size_t us_get_size_opt(purc_variant_t opts, const char *key,
+        size_t def)
+{
+    uint64_t u64;
+    purc_variant_t v;
+
+    if (opts == PURC_VARIANT_INVALID || !purc_variant_is_object(opts)) {
+        return def;
+    }
+
+    v = purc_variant_object_get_by_ckey(opts, key);
+    if (v == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return def;
+    }
+
+    if (!purc_variant_cast_to_ulongint(v, &u64, false) || u64 == 0) {
+        return def;
+    }
+
+    return u64;
+}
+
+/*
+ * The extra options:
+ *
+ *  - `highWatermark`: the size of the pending data in bytes to fire
+ *    a `congested` event; it can not exceed the throttle threshold.
+ *  - `lowWatermark`: the size of the pending data in bytes to fire
+ *    a `writable` event after a `congested` one.
+ */
 const struct purc_native_ops *
 dvobjs_extend_stream_by_message(struct pcdvobjs_stream *stream,
         const struct purc_native_ops *super_ops, purc_variant_t extra_opts)
 {
-    (void)extra_opts;
     struct stream_extended_data *ext = NULL;
     struct stream_messaging_ops *msg_ops = NULL;
 
@@ -1092,6 +1317,15 @@ dvobjs_extend_stream_by_message(struct pcdvobjs_stream *stream,
     list_head_init(&ext->pending);
     ext->sz_header = sizeof(ext->header);
 
+    ext->sz_high_watermark = us_get_size_opt(extra_opts, "highWatermark",
+            DEF_HIGH_WATERMARK);
+    if (ext->sz_high_watermark > SOCK_THROTTLE_THLD)
+        ext->sz_high_watermark = SOCK_THROTTLE_THLD;
+    ext->sz_low_watermark = us_get_size_opt(extra_opts, "lowWatermark",
+            ext->sz_high_watermark / 4);
+    if (ext->sz_low_watermark >= ext->sz_high_watermark)
+        ext->sz_low_watermark = ext->sz_high_watermark / 4;
+
     strcpy(stream->ext0.signature, STREAM_EXT_SIG_MSG);
 
     msg_ops = calloc(1, sizeof(*msg_ops));
@@ -1127,18 +1361,23 @@ dvobjs_extend_stream_by_message(struct pcdvobjs_stream *stream,
         goto failed;
     }
 
-    stream->monitor4w = purc_runloop_add_fd_monitor(
-            purc_runloop_get_current(), stream->fd4w, PCRUNLOOP_IO_OUT,
-            us_handle_writes, stream);
-    if (stream->monitor4w) {
-        pcintr_coroutine_t co = pcintr_get_coroutine();
-        if (co) {
-            stream->cid = co->cid;
+    /* NOTE: The writes are submitted to io_uring if it is available,
+       so the socket is not monitored for writing. */
+    ext->use_uring = pcintr_uring_available();
+    if (!ext->use_uring) {
+        stream->monitor4w = purc_runloop_add_fd_monitor(
+                purc_runloop_get_current(), stream->fd4w, PCRUNLOOP_IO_OUT,
+                us_handle_writes, stream);
+        if (stream->monitor4w) {
+            pcintr_coroutine_t co = pcintr_get_coroutine();
+            if (co) {
+                stream->cid = co->cid;
+            }
+        }
+        else {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto failed;
         }
-    }
-    else {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto failed;
     }
 
     /* destroy rwstreams */
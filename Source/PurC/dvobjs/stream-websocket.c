@@ -31,9 +31,11 @@
 #include "purc-dvobjs.h"
 
 #include "private/debug.h"
+#include "private/resolver.h"
 #include "private/dvobjs.h"
 #include "private/list.h"
 #include "private/interpreter.h"
+#include "private/utils.h"
 
 #include <errno.h>
 
@@ -44,8 +46,10 @@
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <netdb.h>
+#include <zlib.h>
 
 #if defined(__linux__) || defined(__CYGWIN__)
 #  include <endian.h>
@@ -104,6 +108,27 @@
 /* 512 KiB throttle threshold per stream */
 #define SOCK_THROTTLE_THLD          (1024 * 512)
 
+/* header(16b) + Extended payload length(64b) + mask(32b) */
+#define MAX_FRAME_HEADER_SIZE       (2 + 8 + 4)
+
+/* the size of the buffer to read frames from the socket */
+#define READ_BUFFER_SIZE            (1024 * 4)
+
+/* the maximum number of pending data written by one writev() */
+#define MAX_PENDING_IOVS            64
+
+/* the messages smaller than this are sent without compression */
+#define MIN_DEFLATE_MESSAGE_SIZE    64
+
+/* the size of the header of the memory allocated for zlib */
+#define ZALLOC_HEADER_SIZE          16
+
+/* the tail removed from a compressed message; see RFC 7692 */
+#define DEFLATE_TAIL                "\x00\x00\xff\xff"
+#define DEFLATE_TAIL_SIZE           4
+
+#define FRAME_RSV1                  0x40
+
 #define PING_NO_RESPONSE_SECONDS            30
 #define MAX_PINGS_TO_FORCE_CLOSING          3
 
@@ -113,6 +138,12 @@
 #define EVENT_TYPE_CLOSE                    "close"
 #define EVENT_TYPE_ERROR                    "error"
 #   define EVENT_SUBTYPE_MESSAGE            "message"
+#define EVENT_TYPE_CONGESTED                "congested"
+#define EVENT_TYPE_WRITABLE                 "writable"
+
+/* the default high watermark of the pending data; the low one is
+   a quarter of the high one by default */
+#define DEF_HIGH_WATERMARK          (SOCK_THROTTLE_THLD / 2)
 
 /* The frame operation codes for WebSocket */
 typedef enum ws_opcode {
@@ -147,6 +178,15 @@ typedef struct ws_frame_header {
 #define WS_ERR_IO               0x00000102
 #define WS_ERR_MSG              0x00000104
 
+/* The parameters of the extension permessage-deflate; see RFC 7692 */
+struct ws_deflate_params {
+    bool                enabled;
+    bool                client_no_context_takeover;
+    bool                server_no_context_takeover;
+    int                 client_max_window_bits;
+    int                 server_max_window_bits;
+};
+
 typedef struct ws_pending_data {
     struct list_head list;
 
@@ -173,6 +213,15 @@ struct stream_extended_data {
     size_t              sz_pending;
     struct list_head    pending;
 
+    /* the watermarks of the pending data for back-pressure */
+    size_t              sz_high_watermark;
+    size_t              sz_low_watermark;
+    bool                congested;
+
+    /* the serializer of the container being sent as a fragmented message */
+    purc_variant_serializer_t ser;
+    bool                ser_started;
+
     /* current frame header */
     ws_frame_header     header;
     char                header_buf[2];
@@ -196,11 +245,23 @@ struct stream_extended_data {
     size_t              sz_payload;         /* total size of current payload */
     size_t              sz_read_payload;    /* read size of current payload */
     char               *payload;            /* payload data */
+
+    /* fields for permessage-deflate; the streams are NULL if disabled */
+    struct ws_deflate_params deflate;
+    z_stream           *zdeflate;
+    z_stream           *zinflate;
+    size_t              sz_zlib_mem;        /* memory allocated by zlib */
+    bool                msg_compressed;     /* current message compressed */
+
+    /* the data read from the socket but not parsed yet */
+    size_t              rpos;
+    size_t              nr_rbytes;
+    char                rbuf[READ_BUFFER_SIZE];
 };
 
 static inline void ws_update_mem_stats(struct stream_extended_data *ext)
 {
-    ext->sz_used_mem = ext->sz_pending + ext->sz_message;
+    ext->sz_used_mem = ext->sz_pending + ext->sz_message + ext->sz_zlib_mem;
     if (ext->sz_used_mem > ext->sz_peak_used_mem)
         ext->sz_peak_used_mem = ext->sz_used_mem;
 }
@@ -234,6 +295,217 @@ static void ws_clear_pending_data(struct stream_extended_data *ext)
     ws_update_mem_stats(ext);
 }
 
+/* The allocators for zlib, which count the memory used by the streams. */
+static voidpf ws_zalloc(voidpf opaque, uInt items, uInt size)
+{
+    struct stream_extended_data *ext = opaque;
+    size_t sz = (size_t)items * size;
+
+    char *p = malloc(ZALLOC_HEADER_SIZE + sz);
+    if (p == NULL)
+        return Z_NULL;
+
+    memcpy(p, &sz, sizeof(sz));
+    ext->sz_zlib_mem += sz;
+    ws_update_mem_stats(ext);
+    return p + ZALLOC_HEADER_SIZE;
+}
+
+static void ws_zfree(voidpf opaque, voidpf address)
+{
+    struct stream_extended_data *ext = opaque;
+    char *p = (char *)address - ZALLOC_HEADER_SIZE;
+    size_t sz;
+
+    memcpy(&sz, p, sizeof(sz));
+    ext->sz_zlib_mem -= sz;
+    free(p);
+}
+
+static void ws_deflate_cleanup(struct stream_extended_data *ext)
+{
+    if (ext->zdeflate) {
+        deflateEnd(ext->zdeflate);
+        free(ext->zdeflate);
+        ext->zdeflate = NULL;
+    }
+
+    if (ext->zinflate) {
+        inflateEnd(ext->zinflate);
+        free(ext->zinflate);
+        ext->zinflate = NULL;
+    }
+}
+
+/*
+ * Sets up the zlib streams for the negotiated parameters.
+ *
+ * Returns 0 on success, -1 on failure.
+ */
+static int ws_deflate_init(struct stream_extended_data *ext)
+{
+    struct ws_deflate_params *deflate = &ext->deflate;
+
+    /* NOTE: zlib can not make a raw deflate stream with a window of 256
+       bytes, so the messages are sent uncompressed if the server asks
+       for it; a message may be sent uncompressed at any time. */
+    if (deflate->client_max_window_bits >= 9) {
+        ext->zdeflate = calloc(1, sizeof(z_stream));
+        if (ext->zdeflate == NULL)
+            goto failed;
+
+        ext->zdeflate->zalloc = ws_zalloc;
+        ext->zdeflate->zfree = ws_zfree;
+        ext->zdeflate->opaque = ext;
+        if (deflateInit2(ext->zdeflate, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                    -deflate->client_max_window_bits, 8,
+                    Z_DEFAULT_STRATEGY) != Z_OK) {
+            free(ext->zdeflate);
+            ext->zdeflate = NULL;
+            goto failed;
+        }
+    }
+
+    ext->zinflate = calloc(1, sizeof(z_stream));
+    if (ext->zinflate == NULL)
+        goto failed;
+
+    ext->zinflate->zalloc = ws_zalloc;
+    ext->zinflate->zfree = ws_zfree;
+    ext->zinflate->opaque = ext;
+    if (inflateInit2(ext->zinflate,
+                -deflate->server_max_window_bits) != Z_OK) {
+        free(ext->zinflate);
+        ext->zinflate = NULL;
+        goto failed;
+    }
+
+    return 0;
+
+failed:
+    ws_deflate_cleanup(ext);
+    return -1;
+}
+
+/*
+ * Compresses a part of a message. The output of each part ends at a byte
+ * boundary, so it can be sent in a frame; the tail of the last part is
+ * removed.
+ *
+ * Returns the compressed data, which should be freed by the caller, or
+ * NULL on failure.
+ */
+static char *ws_deflate_data(struct stream_extended_data *ext,
+        const char *data, size_t sz, bool fin, size_t *sz_out)
+{
+    z_stream *zs = ext->zdeflate;
+    size_t sz_buf = deflateBound(zs, sz) + DEFLATE_TAIL_SIZE + 8;
+    char *buf = malloc(sz_buf);
+    if (buf == NULL)
+        return NULL;
+
+    zs->next_in = (Bytef *)data;
+    zs->avail_in = sz;
+    *sz_out = 0;
+    do {
+        if (*sz_out == sz_buf) {
+            char *tmp = realloc(buf, sz_buf * 2);
+            if (tmp == NULL)
+                goto failed;
+            buf = tmp;
+            sz_buf *= 2;
+        }
+
+        zs->next_out = (Bytef *)buf + *sz_out;
+        zs->avail_out = sz_buf - *sz_out;
+        if (deflate(zs, Z_SYNC_FLUSH) == Z_STREAM_ERROR)
+            goto failed;
+        *sz_out = sz_buf - zs->avail_out;
+    } while (zs->avail_out == 0);
+
+    if (fin) {
+        if (*sz_out >= DEFLATE_TAIL_SIZE && memcmp(buf + *sz_out -
+                    DEFLATE_TAIL_SIZE, DEFLATE_TAIL, DEFLATE_TAIL_SIZE) == 0)
+            *sz_out -= DEFLATE_TAIL_SIZE;
+        if (ext->deflate.client_no_context_takeover)
+            deflateReset(zs);
+    }
+
+    return buf;
+
+failed:
+    free(buf);
+    deflateReset(zs);
+    return NULL;
+}
+
+/*
+ * Decompresses a whole message, which is limited to MAX_INMEM_MESSAGE_SIZE.
+ *
+ * Returns the decompressed data with room for a terminating null byte,
+ * which should be freed by the caller, or NULL on failure.
+ */
+static char *ws_inflate_message(struct stream_extended_data *ext,
+        const char *data, size_t sz, size_t *sz_out)
+{
+    z_stream *zs = ext->zinflate;
+    size_t sz_buf = MIN(sz * 4 + 64, MAX_INMEM_MESSAGE_SIZE + 1);
+    char *buf = malloc(sz_buf);
+    int part = 0;
+    int ret;
+
+    if (buf == NULL)
+        return NULL;
+
+    *sz_out = 0;
+    zs->next_in = (Bytef *)data;
+    zs->avail_in = sz;
+    do {
+        if (zs->avail_in == 0 && part == 0) {
+            zs->next_in = (Bytef *)DEFLATE_TAIL;
+            zs->avail_in = DEFLATE_TAIL_SIZE;
+            part = 1;
+        }
+
+        if (*sz_out + 1 >= sz_buf) {
+            if (sz_buf > MAX_INMEM_MESSAGE_SIZE) {
+                PC_ERROR("Too large decompressed message\n");
+                goto failed;
+            }
+
+            char *tmp = realloc(buf, MIN(sz_buf * 2,
+                        MAX_INMEM_MESSAGE_SIZE + 1));
+            if (tmp == NULL)
+                goto failed;
+            buf = tmp;
+            sz_buf = MIN(sz_buf * 2, MAX_INMEM_MESSAGE_SIZE + 1);
+        }
+
+        /* keep one byte for the terminating null byte */
+        zs->next_out = (Bytef *)buf + *sz_out;
+        zs->avail_out = sz_buf - *sz_out - 1;
+        ret = inflate(zs, Z_SYNC_FLUSH);
+        if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END) {
+            PC_ERROR("Failed to decompress message: %d\n", ret);
+            goto failed;
+        }
+        *sz_out = sz_buf - 1 - zs->avail_out;
+
+        /* the last block of the stream; the rest is ignored */
+        if (ret == Z_STREAM_END)
+            break;
+    } while (zs->avail_in > 0 || part == 0 || zs->avail_out == 0);
+
+    if (ext->deflate.server_no_context_takeover || ret == Z_STREAM_END)
+        inflateReset(zs);
+    return buf;
+
+failed:
+    free(buf);
+    inflateReset(zs);
+    return NULL;
+}
+
 static void cleanup_extension(struct pcdvobjs_stream *stream)
 {
     struct stream_extended_data *ext = stream->ext0.data;
@@ -267,6 +539,9 @@ static void cleanup_extension(struct pcdvobjs_stream *stream)
         stream->fd4w = -1;
 
         ws_clear_pending_data(ext);
+        ws_deflate_cleanup(ext);
+        if (ext->ser)
+            purc_variant_serializer_destroy(ext->ser);
         if (ext->message)
             free(ext->message);
         free(ext);
@@ -278,6 +553,34 @@ static void cleanup_extension(struct pcdvobjs_stream *stream)
 
 }
 
+/*
+ * Fires a `congested` event when the pending data reach the high watermark,
+ * and a `writable` event when they drop to the low watermark, so that the
+ * producers can slow down before the stream is throttled.
+ */
+static void ws_check_watermarks(struct pcdvobjs_stream *stream)
+{
+    struct stream_extended_data *ext = stream->ext0.data;
+    const char *event;
+
+    if (!ext->congested && ext->sz_pending >= ext->sz_high_watermark) {
+        ext->congested = true;
+        event = EVENT_TYPE_CONGESTED;
+    }
+    else if (ext->congested && ext->sz_pending <= ext->sz_low_watermark) {
+        ext->congested = false;
+        event = EVENT_TYPE_WRITABLE;
+    }
+    else {
+        return;
+    }
+
+    pcintr_coroutine_post_event(stream->cid,
+            PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, stream->observed,
+            event, NULL,
+            purc_variant_make_ulongint(ext->sz_pending), PURC_VARIANT_INVALID);
+}
+
 /*
  * Queue new data.
  *
@@ -311,6 +614,7 @@ static bool ws_queue_data(struct pcdvobjs_stream *stream,
         ext->status |= WS_THROTTLING;
     }
 
+    ws_check_watermarks(stream);
     return true;
 }
 
@@ -320,6 +624,12 @@ static ssize_t ws_write(int fd, const void *buf, size_t length)
     return write(fd, buf, length);
 }
 
+static ssize_t ws_writev(int fd, const struct iovec *iov, int iovcnt)
+{
+    /* TODO : ssl support */
+    return writev(fd, iov, iovcnt);
+}
+
 static ssize_t ws_read(int fd, void *buf, size_t length)
 {
     /* TODO : ssl support */
@@ -369,36 +679,62 @@ static ssize_t ws_write_pending(struct pcdvobjs_stream *stream)
     ssize_t total_bytes = 0;
     struct list_head *p, *n;
 
-    list_for_each_safe(p, n, &ext->pending) {
-        ssize_t bytes;
-        ws_pending_data *pending = (ws_pending_data *)p;
+    /* NOTE: The pending data, which may be many small messages queued
+       while the socket was not writable, are written by one writev(). */
+    while (!list_empty(&ext->pending)) {
+        struct iovec iov[MAX_PENDING_IOVS];
+        size_t sz_iov = 0;
+        int nr_iov = 0;
 
-        bytes = ws_write(stream->fd4w, pending->data + pending->szsent,
-                pending->szdata - pending->szsent);
+        list_for_each(p, &ext->pending) {
+            ws_pending_data *pending = (ws_pending_data *)p;
+            if (nr_iov == MAX_PENDING_IOVS)
+                break;
 
+            iov[nr_iov].iov_base = pending->data + pending->szsent;
+            iov[nr_iov].iov_len = pending->szdata - pending->szsent;
+            sz_iov += iov[nr_iov].iov_len;
+            nr_iov++;
+        }
+
+        ssize_t bytes = ws_writev(stream->fd4w, iov, nr_iov);
         if (bytes > 0) {
-            pending->szsent += bytes;
-            if (pending->szsent >= pending->szdata) {
+            size_t left = bytes;
+            list_for_each_safe(p, n, &ext->pending) {
+                ws_pending_data *pending = (ws_pending_data *)p;
+                size_t sz = pending->szdata - pending->szsent;
+                if (left < sz) {
+                    pending->szsent += left;
+                    break;
+                }
+
+                left -= sz;
                 list_del(p);
                 free(p);
-            }
-            else {
-                break;
+                if (left == 0)
+                    break;
             }
 
             total_bytes += bytes;
             ext->sz_pending -= bytes;
             ws_update_mem_stats(ext);
+
+            if ((size_t)bytes < sz_iov)
+                break;
+        }
+        else if (bytes == -1 && errno == EINTR) {
+            continue;
         }
         else if (bytes == -1 && errno == EPIPE) {
             ext->status = WS_ERR_IO | WS_CLOSING;
             goto failed;
         }
-        else if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        else {
             break;
         }
     }
 
+    ws_check_watermarks(stream);
     return total_bytes;
 
 failed:
@@ -445,106 +781,160 @@ static ssize_t ws_write_sock(struct pcdvobjs_stream *stream,
 static ssize_t ws_read_socket(struct pcdvobjs_stream *stream,
         void *buff, size_t sz)
 {
+    struct stream_extended_data *ext = stream->ext0.data;
     ssize_t bytes;
 
+    /* NOTE: The socket is read in blocks, so that the small pieces of
+       the frames, e.g., the headers and the masks, are taken from the
+       buffer without a system call for each. */
+    if (ext->nr_rbytes == 0) {
+        char *dst = (sz >= sizeof(ext->rbuf)) ? buff : ext->rbuf;
+        size_t sz_dst = (sz >= sizeof(ext->rbuf)) ? sz : sizeof(ext->rbuf);
+
 again:
-    bytes = ws_read(stream->fd4r, buff, sz);
-    if (bytes == -1) {
-        if (errno == EINTR) {
-            goto again;
+        bytes = ws_read(stream->fd4r, dst, sz_dst);
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                goto again;
+            }
+            else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
         }
-        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return 0;
+
+        if (bytes <= 0 || dst == buff) {
+            return bytes;
         }
+
+        ext->rpos = 0;
+        ext->nr_rbytes = bytes;
     }
 
+    bytes = MIN(sz, ext->nr_rbytes);
+    memcpy(buff, ext->rbuf + ext->rpos, bytes);
+    ext->rpos += bytes;
+    ext->nr_rbytes -= bytes;
     return bytes;
 }
 
-static int ws_send_data_frame(struct pcdvobjs_stream *stream, int fin, int opcode,
-        const void *data, ssize_t sz)
+/*
+ * Copies the payload and masks it; `dst` may be the same as `src` to
+ * unmask a payload in place.
+ */
+static void ws_mask_copy(char *dst, const char *src, size_t sz,
+        const unsigned char *mask)
 {
-    int ret = PCRDR_ERROR_IO;
-    int mask_int = 0;
-    size_t size = sz;
-    char *buf = NULL;
-    char *p = NULL;
-    size_t nr_buf = 0;
-    ws_frame_header header;
-    unsigned char mask[4] = { 0 };
-
-    if (sz <= 0) {
-        PC_DEBUG ("Invalid data size %ld.\n", sz);
-        goto out;
+    unsigned char mask8[sizeof(uint64_t)];
+    uint64_t mask64;
+    size_t i;
+
+    for (i = 0; i < sizeof(mask8); i++) {
+        mask8[i] = mask[i % 4];
     }
+    memcpy(&mask64, mask8, sizeof(mask64));
 
-    header.fin = fin;
-    header.rsv = 0;
-    header.op = opcode;
-    header.mask = 1; /* client must 1 */
+    /* NOTE: The payload is masked by words, and the compiler may vectorize
+       the loop further; memcpy() is used for the unaligned accesses. */
+    for (i = 0; i + sizeof(mask64) <= sz; i += sizeof(mask64)) {
+        uint64_t v;
+        memcpy(&v, src + i, sizeof(v));
+        v ^= mask64;
+        memcpy(dst + i, &v, sizeof(v));
+    }
 
-    srand(time(NULL));
-    mask_int = rand();
-    memcpy(mask, &mask_int, 4);
+    for (; i < sz; i++) {
+        dst[i] = src[i] ^ mask[i % 4];
+    }
+}
 
-    size = sz;
-    if (size > 0xffff) {
+static size_t ws_frame_size(size_t sz)
+{
+    if (sz > 0xffff) {
         /* header(16b) + Extended payload length(64b) + mask(32b) + data */
-        nr_buf = 2 + 8 + 4 + sz;
-        header.sz_payload = 127;
+        return 2 + 8 + 4 + sz;
     }
-    else if (size > 125) {
+    else if (sz > 125) {
         /* header(16b) + Extended payload length(16b) + mask(32b) + data */
-        nr_buf = 2 + 2 + 4 + sz;
-        header.sz_payload = 126;
-    }
-    else {
-        /* header(16b) + data + mask(32b) */
-        nr_buf = 2 + 4 + sz;
-        header.sz_payload = sz;
+        return 2 + 2 + 4 + sz;
     }
 
-    buf = malloc(nr_buf + 1);
-    buf[0] = 0;
-    buf[1] = 0;
-    if (fin) {
-        buf[0] |= 0x80;
-    }
-    buf[0] |= (0xff & opcode);
-    buf[1] = 0x80 | header.sz_payload;
+    /* header(16b) + mask(32b) + data */
+    return 2 + 4 + sz;
+}
+
+/*
+ * Builds a masked frame in the buffer, which must have room for
+ * ws_frame_size(sz) bytes.
+ *
+ * Returns the size of the frame.
+ */
+static size_t ws_build_frame(char *buf, int fin, int rsv, int opcode,
+        const char *data, size_t sz)
+{
+    unsigned char mask[4];
+    int mask_int = rand();
+    char *p;
+
+    memcpy(mask, &mask_int, 4);
+
+    buf[0] = fin ? 0x80 : 0;
+    buf[0] |= rsv;
+    buf[0] |= (0x0f & opcode);
 
     p = buf + 2;
-    if (header.sz_payload == 127) {
+    if (sz > 0xffff) {
         uint64_t v = htobe64(sz);
+        buf[1] = 0x80 | 127;
         memcpy(p, &v, 8);
         p = p + 8;
     }
-    else if (header.sz_payload == 126) {
+    else if (sz > 125) {
         uint16_t v = htobe16(sz);
+        buf[1] = 0x80 | 126;
         memcpy(p, &v, 2);
         p = p + 2;
     }
+    else {
+        buf[1] = 0x80 | sz;
+    }
 
     /* mask */
-    memcpy(p, &mask, 4);
-
-    /* payload */
+    memcpy(p, mask, 4);
     p = p + 4;
-    memcpy(p, data, sz);
 
-    /* mask payload */
-    for (ssize_t i = 0; i < sz; i++) {
-        p[i] ^= mask[i % 4] & 0xff;
+    /* masked payload */
+    ws_mask_copy(p, data, sz, mask);
+    return p + sz - buf;
+}
+
+static int ws_send_data_frame(struct pcdvobjs_stream *stream, int fin,
+        int rsv, int opcode, const void *data, ssize_t sz)
+{
+    char frame[MAX_FRAME_HEADER_SIZE + MAX_FRAME_PAYLOAD_SIZE];
+    char *buf = frame;
+    size_t nr_buf;
+
+    /* NOTE: the last frame of a fragmented message may be empty */
+    if (sz < 0 || (sz == 0 && opcode != WS_OPCODE_CONTINUATION)) {
+        PC_DEBUG ("Invalid data size %ld.\n", sz);
+        return PCRDR_ERROR_IO;
+    }
+
+    nr_buf = ws_frame_size(sz);
+    if (nr_buf > sizeof(frame)) {
+        buf = malloc(nr_buf);
+        if (buf == NULL) {
+            return PCRDR_ERROR_NOMEM;
+        }
     }
 
+    nr_buf = ws_build_frame(buf, fin, rsv, opcode, data, sz);
     ws_write_sock(stream, buf, nr_buf);
-    ret = 0;
 
-out:
-    if (buf) {
+    if (buf != frame) {
         free(buf);
     }
-    return ret;
+    return 0;
 }
 
 enum {
@@ -703,6 +1093,9 @@ static int try_to_read_payload(struct pcdvobjs_stream *stream)
     ssize_t n;
 
     char *buf = (char *)ext->payload;
+    if (ext->sz_payload == 0) {
+        return READ_WHOLE;
+    }
     assert(ext->sz_payload > ext->sz_read_payload);
 
     n = ws_read_socket(stream, buf + ext->sz_read_payload,
@@ -738,8 +1131,9 @@ static int try_to_read_frame(struct pcdvobjs_stream *stream)
     ws_frame_header *header = &ext->header;
     int retv;
 
-    /* read extended payload length */
-    if (header->sz_ext_payload == 0) {
+    /* read extended payload length; the payload buffer is allocated
+       once the length is known, even if the payload is empty */
+    if (ext->payload == NULL) {
         retv = try_to_read_ext_payload_length(stream);
         if (retv != READ_WHOLE) {
             return retv;
@@ -766,7 +1160,12 @@ static int try_to_read_frame(struct pcdvobjs_stream *stream)
     }
 
     /* read websocket payload */
-    return try_to_read_payload(stream);
+    retv = try_to_read_payload(stream);
+    if (retv == READ_WHOLE && header->mask) {
+        ws_mask_copy(ext->payload, ext->payload, ext->sz_payload,
+                (const unsigned char *)ext->mask);
+    }
+    return retv;
 }
 
 static bool
@@ -835,6 +1234,22 @@ ws_handle_reads(int fd, purc_runloop_io_event event, void *ctxt)
                 break;
             }
 
+            /* only the first frame of a data message may be compressed */
+            if (ext->header.rsv & FRAME_RSV1) {
+                if (ext->zinflate == NULL ||
+                        (ext->header.op != WS_OPCODE_TEXT &&
+                         ext->header.op != WS_OPCODE_BIN)) {
+                    PC_ERROR("Unexpected RSV1 in frame: %d\n", ext->header.op);
+                    ext->status = WS_ERR_MSG | WS_CLOSING;
+                    goto failed;
+                }
+            }
+
+            if (ext->header.op == WS_OPCODE_TEXT ||
+                    ext->header.op == WS_OPCODE_BIN) {
+                ext->msg_compressed = (ext->header.rsv & FRAME_RSV1) != 0;
+            }
+
             PC_INFO("Got a frame header: %d\n", ext->header.op);
         }
         else if (ext->status & WS_WAITING4PAYLOAD) {
@@ -881,45 +1296,51 @@ ws_handle_reads(int fd, purc_runloop_io_event event, void *ctxt)
                     continue;
                 }
 
-                /* whole message */
-                switch (ext->header.op) {
-                case WS_OPCODE_PING:
+                if (ext->msg_compressed && (ext->msg_type == MT_TEXT ||
+                            ext->msg_type == MT_BINARY)) {
+                    size_t sz;
+                    char *msg = ws_inflate_message(ext, ext->message,
+                            ext->sz_message, &sz);
+                    if (msg == NULL) {
+                        ext->status = WS_ERR_MSG | WS_CLOSING;
+                        goto failed;
+                    }
+
+                    free(ext->message);
+                    ext->message = msg;
+                    ext->sz_message = sz;
+                    ext->msg_compressed = false;
+                    ws_update_mem_stats(ext);
+                }
+
+                /* whole message; the opcode of the last frame of a
+                   fragmented message is WS_OPCODE_CONTINUATION */
+                switch (ext->msg_type) {
+                case MT_PING:
                     retv = stream->ext0.msg_ops->on_message(stream, MT_PING, NULL, 0);
                     break;
 
-                case WS_OPCODE_PONG:
+                case MT_PONG:
                     retv = stream->ext0.msg_ops->on_message(stream, MT_PONG, NULL, 0);
                     break;
 
-                case WS_OPCODE_CLOSE:
-                    retv = stream->ext0.msg_ops->on_message(stream, MT_CLOSE, NULL, 0);
-                    ext->status = WS_CLOSING;
-                    break;
+                case MT_CLOSE:
+                    /* the extension is cleaned up by on_message() */
+                    stream->ext0.msg_ops->on_message(stream, MT_CLOSE, NULL, 0);
+                    return false;
 
-                case WS_OPCODE_TEXT:
+                case MT_TEXT:
                     ext->message[ext->sz_message] = 0;
                     ext->sz_message++;
                     PC_INFO("Got a text payload: %s\n", ext->message);
 
                     retv = stream->ext0.msg_ops->on_message(stream,
                             ext->msg_type, ext->message, ext->sz_message);
-                    free(ext->message);
-                    ext->message = NULL;
-                    ext->sz_message = 0;
-                    ext->sz_read_payload = 0;
-                    ext->sz_read_message = 0;
-                    ws_update_mem_stats(ext);
                     break;
 
-                case WS_OPCODE_BIN:
+                case MT_BINARY:
                     retv = stream->ext0.msg_ops->on_message(stream,
                             ext->msg_type, ext->message, ext->sz_message);
-                    free(ext->message);
-                    ext->message = NULL;
-                    ext->sz_message = 0;
-                    ext->sz_read_payload = 0;
-                    ext->sz_read_message = 0;
-                    ws_update_mem_stats(ext);
                     break;
 
                 default:
@@ -929,7 +1350,18 @@ ws_handle_reads(int fd, purc_runloop_io_event event, void *ctxt)
                     goto failed;
                     break;
                 }
-                break;
+
+                free(ext->message);
+                ext->message = NULL;
+                ext->sz_message = 0;
+                ext->sz_read_payload = 0;
+                ext->sz_read_message = 0;
+                ext->status &= ~WS_WAITING4PAYLOAD;
+                ws_update_mem_stats(ext);
+
+                /* NOTE: go on with the next frame, which may have been
+                   read into the buffer already. */
+                continue;
             }
         }
     } while (true);
@@ -951,6 +1383,58 @@ closing:
     return false;
 }
 
+/*
+ * Sends the serialized data of the container being sent in frames, until
+ * the socket can not accept more data without queueing, so that only the
+ * data of one frame may be kept in the pending list.
+ */
+static void ws_pump_serializer(struct pcdvobjs_stream *stream)
+{
+    struct stream_extended_data *ext = stream->ext0.data;
+    char buf[MAX_FRAME_PAYLOAD_SIZE];
+
+    while (ext->ser && list_empty(&ext->pending) &&
+            !(ext->status & WS_ERR_ANY)) {
+        ssize_t sz = purc_variant_serializer_read(ext->ser, buf, sizeof(buf));
+        if (sz < 0) {
+            /* the message can not be completed; close the connection */
+            purc_variant_serializer_destroy(ext->ser);
+            ext->ser = NULL;
+            ext->status = WS_ERR_OOM | WS_CLOSING;
+            break;
+        }
+
+        int fin = purc_variant_serializer_is_done(ext->ser);
+        int opcode = ext->ser_started ? WS_OPCODE_CONTINUATION : WS_OPCODE_TEXT;
+        int rsv = 0;
+        if (ext->zdeflate) {
+            /* the frames are compressed as the parts of one message */
+            size_t sz_zdata;
+            char *zdata = ws_deflate_data(ext, buf, sz, fin, &sz_zdata);
+            if (zdata == NULL) {
+                purc_variant_serializer_destroy(ext->ser);
+                ext->ser = NULL;
+                ext->status = WS_ERR_OOM | WS_CLOSING;
+                break;
+            }
+
+            rsv = ext->ser_started ? 0 : FRAME_RSV1;
+            ext->ser_started = true;
+            ws_send_data_frame(stream, fin, rsv, opcode, zdata, sz_zdata);
+            free(zdata);
+        }
+        else {
+            ext->ser_started = true;
+            ws_send_data_frame(stream, fin, rsv, opcode, buf, sz);
+        }
+
+        if (fin) {
+            purc_variant_serializer_destroy(ext->ser);
+            ext->ser = NULL;
+        }
+    }
+}
+
 static bool
 ws_handle_writes(int fd, purc_runloop_io_event event, void *ctxt)
 {
@@ -969,6 +1453,10 @@ ws_handle_writes(int fd, purc_runloop_io_event event, void *ctxt)
     }
 
     ws_write_pending(stream);
+    if (ext->ser && list_empty(&ext->pending)) {
+        ws_pump_serializer(stream);
+    }
+
     if (list_empty(&ext->pending)) {
         ext->status &= ~WS_SENDING;
     }
@@ -1084,44 +1572,62 @@ static int send_data(struct pcdvobjs_stream *stream,
         return PURC_ERROR_TOO_LARGE_ENTITY;
     }
 
-    if ((ext->status & WS_THROTTLING) || ws_can_send_data(ext, sz)) {
+    /* do not interleave the frames of a message being serialized */
+    if (ext->ser || (ext->status & WS_THROTTLING) ||
+            ws_can_send_data(ext, sz)) {
         return PURC_ERROR_AGAIN;
     }
 
     ext->status = WS_OK;
 
+    /* NOTE: The compressed message is never larger than the throttle
+       allows, since deflate() expands the data by a few bytes at most. */
+    char *zdata = NULL;
+    int rsv = 0;
+    if (ext->zdeflate && sz >= MIN_DEFLATE_MESSAGE_SIZE) {
+        zdata = ws_deflate_data(ext, data, sz, true, &sz);
+        if (zdata == NULL) {
+            return PURC_ERROR_OUT_OF_MEMORY;
+        }
+
+        data = zdata;
+        rsv = FRAME_RSV1;
+    }
+
     if (sz > MAX_FRAME_PAYLOAD_SIZE) {
-        unsigned int left = sz;
-        int fin;
-        int opcode;
-        size_t sz_payload;
+        /* NOTE: The frames of a fragmented message are built in one buffer
+           and written by one system call. */
+        size_t frames = (sz + MAX_FRAME_PAYLOAD_SIZE - 1) /
+            MAX_FRAME_PAYLOAD_SIZE;
+        char *buf = malloc(sz + frames * MAX_FRAME_HEADER_SIZE);
+        if (buf == NULL) {
+            free(zdata);
+            return PURC_ERROR_OUT_OF_MEMORY;
+        }
 
+        size_t left = sz;
+        size_t nr_buf = 0;
+        int opcode = WS_OPCODE_TEXT;
         do {
-            if (left == sz) {
-                fin = 0;
-                opcode = WS_OPCODE_TEXT;
-                sz_payload = PCRDR_MAX_FRAME_PAYLOAD_SIZE;
-                left -= PCRDR_MAX_FRAME_PAYLOAD_SIZE;
-            }
-            else if (left > PCRDR_MAX_FRAME_PAYLOAD_SIZE) {
-                fin = 0;
-                opcode = WS_OPCODE_CONTINUATION;
-                sz_payload = PCRDR_MAX_FRAME_PAYLOAD_SIZE;
-                left -= PCRDR_MAX_FRAME_PAYLOAD_SIZE;
-            }
-            else {
-                fin = 1;
-                opcode = WS_OPCODE_CONTINUATION;
-                sz_payload = left;
-                left = 0;
-            }
+            size_t sz_payload = MIN(left, MAX_FRAME_PAYLOAD_SIZE);
+            left -= sz_payload;
 
-            ws_send_data_frame(stream, fin, opcode, data, sz_payload);
+            nr_buf += ws_build_frame(buf + nr_buf, left == 0, rsv, opcode,
+                    data, sz_payload);
+            opcode = WS_OPCODE_CONTINUATION;
+            rsv = 0;
             data += sz_payload;
         } while (left > 0);
+
+        ws_write_sock(stream, buf, nr_buf);
+        free(buf);
     }
     else {
-        ws_send_data_frame(stream, 1, WS_OPCODE_TEXT, data, sz);
+        ws_send_data_frame(stream, 1, rsv, WS_OPCODE_TEXT, data, sz);
+    }
+
+    if (zdata) {
+        free(zdata);
     }
 
     if (ext->status & WS_ERR_ANY) {
@@ -1132,6 +1638,43 @@ static int send_data(struct pcdvobjs_stream *stream,
     return PURC_ERROR_OK;
 }
 
+/*
+ * Send a container as a text message in JSON; the message is serialized
+ * incrementally and sent in frames when the socket is writable, so that
+ * a large container can be sent without serializing it in memory first.
+ *
+ * return zero on success; none-zero on error.
+ */
+static int send_container(struct pcdvobjs_stream *stream,
+        purc_variant_t value)
+{
+    struct stream_extended_data *ext = stream->ext0.data;
+
+    if (ext == NULL) {
+        return PURC_ERROR_ENTITY_GONE;
+    }
+
+    if (ext->ser || (ext->status & WS_THROTTLING)) {
+        return PURC_ERROR_AGAIN;
+    }
+
+    ext->ser = purc_variant_serializer_new(value, PCVRNT_SERIALIZE_OPT_PLAIN);
+    if (ext->ser == NULL) {
+        return purc_get_last_error();
+    }
+
+    ext->ser_started = false;
+    ext->status = WS_OK;
+    ws_pump_serializer(stream);
+
+    if (ext->status & WS_ERR_ANY) {
+        PC_ERROR("Error when sending data: %s\n", strerror(errno));
+        return ws_status_to_pcerr(ext);
+    }
+
+    return PURC_ERROR_OK;
+}
+
 static int on_error(struct pcdvobjs_stream *stream, int errcode)
 {
     purc_variant_t data = purc_variant_make_object_0();
@@ -1227,6 +1770,15 @@ send_getter(void *entity, const char *property_name,
         text_or_binary = false;
         data = purc_variant_get_bytes_const(argv[0], &len);
     }
+    else if (purc_variant_is_container(argv[0])) {
+        int retv;
+        if ((retv = send_container(stream, argv[0]))) {
+            purc_set_error(retv);
+            goto failed;
+        }
+
+        return purc_variant_make_boolean(true);
+    }
 
     if (data == NULL) {
         purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
@@ -1342,11 +1894,104 @@ static const struct purc_native_ops msg_entity_ops = {
     .on_release = on_release,
 };
 
+static int ws_handshake(int fd, const char *host_name, const char *port,
+        struct ws_deflate_params *deflate);
+
+static bool ws_get_bool_opt(purc_variant_t opts, const char *key, bool def)
+{
+    purc_variant_t v = purc_variant_object_get_by_ckey(opts, key);
+    if (v == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return def;
+    }
+
+    return purc_variant_booleanize(v);
+}
+
+static size_t ws_get_size_opt(purc_variant_t opts, const char *key,
+        size_t def)
+{
+    uint64_t u64;
+    purc_variant_t v;
+
+    if (opts == PURC_VARIANT_INVALID || !purc_variant_is_object(opts)) {
+        return def;
+    }
+
+    v = purc_variant_object_get_by_ckey(opts, key);
+    if (v == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return def;
+    }
+
+    if (!purc_variant_cast_to_ulongint(v, &u64, false) || u64 == 0) {
+        return def;
+    }
+
+    return u64;
+}
+
+static int ws_get_window_bits_opt(purc_variant_t opts, const char *key)
+{
+    int32_t bits;
+    purc_variant_t v = purc_variant_object_get_by_ckey(opts, key);
+    if (v == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return 15;
+    }
+
+    if (!purc_variant_cast_to_int32(v, &bits, false) || bits < 9) {
+        return 9;
+    }
+
+    return bits > 15 ? 15 : bits;
+}
+
+/*
+ * Gets the parameters of permessage-deflate to offer from the extra
+ * options of the stream; see dvobjs_extend_stream_by_websocket() for
+ * the other options:
+ *
+ *  - `permessageDeflate`: offer the extension; false by default.
+ *  - `clientMaxWindowBits`, `serverMaxWindowBits`: the base-2 logarithm
+ *    of the LZ77 window size, from 9 to 15; 15 by default.
+ *  - `clientNoContextTakeover`, `serverNoContextTakeover`: reset the
+ *    compression context after each message; false by default.
+ */
+static void ws_get_deflate_opts(purc_variant_t opts,
+        struct ws_deflate_params *deflate)
+{
+    memset(deflate, 0, sizeof(*deflate));
+    deflate->client_max_window_bits = 15;
+    deflate->server_max_window_bits = 15;
+
+    if (opts == PURC_VARIANT_INVALID || !purc_variant_is_object(opts)) {
+        return;
+    }
+
+    deflate->enabled = ws_get_bool_opt(opts, "permessageDeflate", false);
+    deflate->client_no_context_takeover = ws_get_bool_opt(opts,
+            "clientNoContextTakeover", false);
+    deflate->server_no_context_takeover = ws_get_bool_opt(opts,
+            "serverNoContextTakeover", false);
+    deflate->client_max_window_bits = ws_get_window_bits_opt(opts,
+            "clientMaxWindowBits");
+    deflate->server_max_window_bits = ws_get_window_bits_opt(opts,
+            "serverMaxWindowBits");
+}
+
+/*
+ * The extra options besides the ones of permessage-deflate:
+ *
+ *  - `highWatermark`: the size of the pending data in bytes to fire
+ *    a `congested` event; it can not exceed the throttle threshold.
+ *  - `lowWatermark`: the size of the pending data in bytes to fire
+ *    a `writable` event after a `congested` one.
+ */
 const struct purc_native_ops *
 dvobjs_extend_stream_by_websocket(struct pcdvobjs_stream *stream,
         const struct purc_native_ops *super_ops, purc_variant_t extra_opts)
 {
-    (void)extra_opts;
     struct stream_extended_data *ext = NULL;
     struct stream_messaging_ops *msg_ops = NULL;
 
@@ -1357,22 +2002,49 @@ dvobjs_extend_stream_by_websocket(struct pcdvobjs_stream *stream,
         goto failed;
     }
 
-    if (fcntl(stream->fd4r, F_SETFL,
-                fcntl(stream->fd4r, F_GETFL, 0) | O_NONBLOCK) == -1) {
-        PC_ERROR("Unable to set socket as non-blocking: %s.", strerror(errno));
-        purc_set_error(PURC_EXCEPT_IO_FAILURE);
+    ext = calloc(1, sizeof(*ext));
+    if (ext == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto failed;
     }
 
-    ext = calloc(1, sizeof(*ext));
-    if (ext == NULL) {
+    /* NOTE: The handshake is done here rather than when connecting, so that
+       the extensions can be negotiated with the extra options. */
+    char s_port[10];
+    snprintf(s_port, sizeof(s_port), "%d", stream->url->port);
+    ws_get_deflate_opts(extra_opts, &ext->deflate);
+    if (ws_handshake(stream->fd4r, stream->url->host, s_port,
+                &ext->deflate) != 0) {
+        purc_set_error(PURC_ERROR_CONNECTION_REFUSED);
+        goto failed;
+    }
+
+    if (ext->deflate.enabled && ws_deflate_init(ext) != 0) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto failed;
     }
 
+    if (fcntl(stream->fd4r, F_SETFL,
+                fcntl(stream->fd4r, F_GETFL, 0) | O_NONBLOCK) == -1) {
+        PC_ERROR("Unable to set socket as non-blocking: %s.", strerror(errno));
+        purc_set_error(PURC_EXCEPT_IO_FAILURE);
+        goto failed;
+    }
+
     list_head_init(&ext->pending);
     ext->sz_header = sizeof(ext->header_buf);
+
+    ext->sz_high_watermark = ws_get_size_opt(extra_opts, "highWatermark",
+            DEF_HIGH_WATERMARK);
+    if (ext->sz_high_watermark > SOCK_THROTTLE_THLD)
+        ext->sz_high_watermark = SOCK_THROTTLE_THLD;
+    ext->sz_low_watermark = ws_get_size_opt(extra_opts, "lowWatermark",
+            ext->sz_high_watermark / 4);
+    if (ext->sz_low_watermark >= ext->sz_high_watermark)
+        ext->sz_low_watermark = ext->sz_high_watermark / 4;
     memset(ext->header_buf, 0, ext->sz_header);
+    ext->sz_mask = sizeof(ext->mask);
+    srand(time(NULL));
 
     strcpy(stream->ext0.signature, STREAM_EXT_SIG_MSG);
 
@@ -1447,47 +2119,24 @@ failed:
 
     if (msg_ops)
         free(msg_ops);
-    if (ext)
+    if (ext) {
+        ws_deflate_cleanup(ext);
         free(ext);
+    }
 
     return NULL;
 }
 
+/* NOTE: The addresses of the host are kept in the cache of the resolver,
+   and a warm connection made by $STREAM.preconnect() is taken if there is. */
 static int ws_open_connection(const char *host, const char *port)
 {
-    int fd = -1;
-    struct addrinfo *addrinfo;
-    struct addrinfo *p;
-    struct addrinfo hints = { 0 };
-
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    if (0 != getaddrinfo(host, port, &hints, &addrinfo)) {
-        PC_DEBUG ("Error while getting address info (%s:%s)\n",
-                host, port);
-        goto out;
-    }
-
-    for (p = addrinfo; p != NULL; p = p->ai_next) {
-        if((fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol)) == -1) {
-            continue;
-        }
-
-        if (connect(fd, p->ai_addr, p->ai_addrlen) == -1) {
-            close(fd);
-            continue;
-        }
-        break;
-    }
-    freeaddrinfo(addrinfo);
-
-    if (p == NULL) {
+    int fd = pcutils_resolver_connect(host, port);
+    if (fd < 0) {
         PC_DEBUG ("Connect to websocket server failed! (%s:%s)\n",
                 host, port);
-        goto out;
     }
 
-out:
     return fd;
 }
 
@@ -1500,7 +2149,82 @@ static void ws_sha1_digest(const char *s, int len, unsigned char *digest)
   pcutils_sha1_end(&sha, digest);
 }
 
-static int ws_verify_handshake(const char *ws_key, char *header)
+/*
+ * Parses the value of the header Sec-WebSocket-Extensions in the response
+ * of the handshake. Only permessage-deflate is offered; the parameters
+ * accepted by the server are not greater than the offered ones.
+ *
+ * Returns 0 on success, -1 if the response is not acceptable.
+ */
+static int ws_accept_deflate(const char *value,
+        struct ws_deflate_params *deflate)
+{
+    char *dup = strdup(value);
+    char *saveptr = NULL;
+    char *token;
+    bool first = true;
+    int ret = -1;
+
+    if (dup == NULL || strchr(dup, ',')) {
+        goto out;
+    }
+
+    int client_bits = deflate->client_max_window_bits;
+    int server_bits = 15;
+    for (token = strtok_r(dup, ";", &saveptr); token;
+            token = strtok_r(NULL, ";", &saveptr)) {
+        while (*token == ' ' || *token == '\t')
+            token++;
+        size_t len = strlen(token);
+        while (len > 0 && (token[len - 1] == ' ' || token[len - 1] == '\t'))
+            token[--len] = '\0';
+
+        if (first) {
+            if (strcasecmp(token, "permessage-deflate"))
+                goto out;
+            first = false;
+        }
+        else if (strcasecmp(token, "server_no_context_takeover") == 0) {
+            deflate->server_no_context_takeover = true;
+        }
+        else if (strcasecmp(token, "client_no_context_takeover") == 0) {
+            deflate->client_no_context_takeover = true;
+        }
+        else if (strncasecmp(token, "server_max_window_bits=", 23) == 0) {
+            server_bits = atoi(token + 23);
+            if (server_bits < 8 || server_bits > 15 ||
+                    server_bits > deflate->server_max_window_bits)
+                goto out;
+        }
+        else if (strncasecmp(token, "client_max_window_bits=", 23) == 0) {
+            int bits = atoi(token + 23);
+            if (bits < 8 || bits > 15)
+                goto out;
+            if (bits < client_bits)
+                client_bits = bits;
+        }
+        else {
+            goto out;
+        }
+    }
+
+    if (!first) {
+        deflate->client_max_window_bits = client_bits;
+        /* NOTE: zlib inflates a raw stream with a window of 512 bytes at
+           least, which also works for a window of 256 bytes. */
+        deflate->server_max_window_bits = server_bits < 9 ? 9 : server_bits;
+        ret = 0;
+    }
+
+out:
+    if (dup) {
+        free(dup);
+    }
+    return ret;
+}
+
+static int ws_verify_handshake(const char *ws_key, char *header,
+        struct ws_deflate_params *deflate)
 {
     (void) header;
     int ret = -1;
@@ -1525,6 +2249,7 @@ static int ws_verify_handshake(const char *ws_key, char *header)
     bool valid_accept = false;
     bool valid_upgrade = false;
     bool valid_connection = false;
+    bool accepted_deflate = false;
 
     while (line) {
         if ((next = strstr (line, "\r\n")) != NULL) {
@@ -1570,6 +2295,15 @@ static int ws_verify_handshake(const char *ws_key, char *header)
                     strcmp(p + 1, encode) == 0) {
                     valid_accept = true;
             }
+            else if (p && strcasecmp(tmp, "Sec-WebSocket-Extensions:") == 0) {
+                /* an extension not offered fails the connection */
+                if (!deflate->enabled || accepted_deflate ||
+                        ws_accept_deflate(p + 1, deflate) != 0) {
+                    PC_DEBUG ("Unexpected extensions: %s\n", p + 1);
+                    goto out;
+                }
+                accepted_deflate = true;
+            }
         }
 
         free (tmp);
@@ -1601,6 +2335,8 @@ static int ws_verify_handshake(const char *ws_key, char *header)
         goto out;
     }
 
+    /* the server may decline the extension */
+    deflate->enabled = accepted_deflate;
     ret = 0;
 out:
     if (tmp) {
@@ -1617,7 +2353,8 @@ out:
     return ret;
 }
 
-static int ws_handshake(int fd, const char *host_name, const char *port )
+static int ws_handshake(int fd, const char *host_name, const char *port,
+        struct ws_deflate_params *deflate)
 {
     int ret = -1;
 
@@ -1629,6 +2366,30 @@ static int ws_handshake(int fd, const char *host_name, const char *port )
     }
     char *ws_key =  pcutils_b64_encode_alloc ((unsigned char *) key, WS_KEY_LEN);
     char req_headers[1024] = { 0 };
+    char extensions[256] = { 0 };
+
+    if (deflate->enabled) {
+        char client_bits[8] = { 0 };
+        char server_bits[32] = { 0 };
+        if (deflate->client_max_window_bits < 15) {
+            snprintf(client_bits, sizeof(client_bits), "=%d",
+                    deflate->client_max_window_bits);
+        }
+        if (deflate->server_max_window_bits < 15) {
+            snprintf(server_bits, sizeof(server_bits),
+                    "; server_max_window_bits=%d",
+                    deflate->server_max_window_bits);
+        }
+
+        snprintf(extensions, sizeof(extensions),
+                "Sec-WebSocket-Extensions: permessage-deflate"
+                "; client_max_window_bits%s%s%s%s\r\n",
+                client_bits, server_bits,
+                deflate->client_no_context_takeover ?
+                    "; client_no_context_takeover" : "",
+                deflate->server_no_context_takeover ?
+                    "; server_no_context_takeover" : "");
+    }
 
     snprintf(req_headers, 1024,
             "GET / HTTP/1.1\r\n"
@@ -1636,8 +2397,9 @@ static int ws_handshake(int fd, const char *host_name, const char *port )
             "Connection: Upgrade\r\n"
             "Host: %s:%s\r\n"
             "Sec-WebSocket-Key: %s\r\n"
+            "%s"
             "Sec-WebSocket-Version: 13\r\n\r\n",
-            host_name, port, ws_key);
+            host_name, port, ws_key, extensions);
 
     /* send to server */
     ws_write(fd, req_headers, strlen(req_headers));
@@ -1646,7 +2408,7 @@ static int ws_handshake(int fd, const char *host_name, const char *port )
 
     char *p = buf;
     while (true) {
-        if (ws_read(fd, p, 1) != 1) {
+        if (p - buf >= (ptrdiff_t)sizeof(buf) - 1 || ws_read(fd, p, 1) != 1) {
             PC_DEBUG ("Error receiving data during handshake\n");
             goto out;
         }
@@ -1656,7 +2418,7 @@ static int ws_handshake(int fd, const char *host_name, const char *port )
         }
     }
 
-    ret = ws_verify_handshake(ws_key, buf);
+    ret = ws_verify_handshake(ws_key, buf, deflate);
 
 out:
     if (ws_key) {
@@ -1676,14 +2438,11 @@ int dvobjs_extend_stream_websocket_connect(const char *host_name, int port)
 
     sprintf(s_port, "%d", port);
 
+    /* the handshake is done when extending the stream */
     if ((fd = ws_open_connection(host_name, s_port)) < 0) {
         goto failed;
     }
 
-    if (ws_handshake(fd, host_name, s_port) != 0) {
-        goto failed;
-    }
-
     return fd;
 
 failed:
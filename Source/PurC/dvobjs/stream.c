@@ -35,9 +35,12 @@
 #include "private/dvobjs.h"
 #include "private/atom-buckets.h"
 #include "private/interpreter.h"
+#include "private/ejson.h"
+#include "private/resolver.h"
 
 #include <errno.h>
 
+#include <poll.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -47,8 +50,22 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 
+#if OS(LINUX)
+#include <sys/sendfile.h>
+#endif
+
 #define BUFFER_SIZE                 1024
 
+/* NOTE: The writes to pipes and FIFOs are buffered and flushed at the end
+   of each writing method, e.g., writelines() issues one write() for all
+   lines. The reads are not buffered by the rwstream, so the readable
+   events of the file descriptor still tell whether there is data. */
+#define WRITE_BUFFER_SIZE           4096
+
+/* the size of the chunks copied by $STREAM.transfer() if the kernel can not
+   transfer the data between the file descriptors directly */
+#define TRANSFER_CHUNK_SIZE         (1024 * 64)
+
 #define ENDIAN_PLATFORM             0
 #define ENDIAN_LITTLE               1
 #define ENDIAN_BIG                  2
@@ -118,6 +135,10 @@ enum {
     K_KW_writelines,
 #define _KW_readbytes               "readbytes"
     K_KW_readbytes,
+#define _KW_readjson                "readjson"
+    K_KW_readjson,
+#define _KW_readjsonlines           "readjsonlines"
+    K_KW_readjsonlines,
 #define _KW_writebytes              "writebytes"
     K_KW_writebytes,
 #define _KW_writeeof                "writeeof"
@@ -130,6 +151,10 @@ enum {
     K_KW_close,
 #define _KW_tcp                     "tcp"
     K_KW_tcp,
+#define _KW_gzip                    "gzip"
+    K_KW_gzip,
+#define _KW_base64                  "base64"
+    K_KW_base64,
 };
 
 static struct keyword_to_atom {
@@ -159,12 +184,16 @@ static struct keyword_to_atom {
     { _KW_readlines, 0},            // readlines
     { _KW_writelines, 0},           // writelines
     { _KW_readbytes, 0},            // readbytes
+    { _KW_readjson, 0},             // readjson
+    { _KW_readjsonlines, 0},        // readjsonlines
     { _KW_writebytes, 0},           // writebytes
     { _KW_writeeof, 0},             // writeeof
     { _KW_status, 0},               // status
     { _KW_seek, 0},                 // seek
     { _KW_close, 0},                // close
     { _KW_tcp, 0},                // tcp
+    { _KW_gzip, 0},                 // gzip
+    { _KW_base64, 0},               // base64
 };
 
 static struct pcdvobjs_stream *
@@ -186,8 +215,21 @@ dvobjs_stream_new(enum pcdvobjs_stream_type type,
     return stream;
 }
 
+static void json_reader_delete(struct stream_json_reader *reader);
+static void line_reader_delete(struct stream_line_reader *reader);
+
 static void native_stream_close(struct pcdvobjs_stream *stream)
 {
+    if (stream->json) {
+        json_reader_delete(stream->json);
+        stream->json = NULL;
+    }
+
+    if (stream->lines) {
+        line_reader_delete(stream->lines);
+        stream->lines = NULL;
+    }
+
     if (stream->stm4r) {
         purc_rwstream_destroy(stream->stm4r);
     }
@@ -379,6 +421,7 @@ failed:
     if (silently) {
         if (bf.bytes) {
             write_length = purc_rwstream_write(rwstream, bf.bytes, bf.nr_bytes);
+            purc_rwstream_flush(rwstream);
             free(bf.bytes);
             bf.bytes = NULL;
         }
@@ -394,49 +437,153 @@ out:
     return PURC_VARIANT_INVALID;
 }
 
-#define LINE_FLAG           "\n"
-static int read_lines(purc_rwstream_t stream, int line_num,
-        purc_variant_t array)
+/*
+ * The reader of lines for readlines. The bytes read from the stream but not
+ * returned yet are kept in a buffer per stream, so a line split by two reads
+ * is still got as one. The buffer grows to hold the longest line.
+ */
+struct stream_line_reader {
+    size_t          pos;
+    size_t          nr_pending;
+    size_t          sz_buf;
+    char           *buf;
+};
+
+static void line_reader_delete(struct stream_line_reader *reader)
 {
-    unsigned char buffer[BUFFER_SIZE];
-    ssize_t read_size = 0;
-    size_t length = 0;
-    const char *head = NULL;
-    const char *end = NULL;
+    free(reader->buf);
+    free(reader);
+}
 
-    while (line_num) {
-        read_size = purc_rwstream_read(stream, buffer, BUFFER_SIZE);
-        if (read_size < 0)
-            break;
+/* Takes the pending bytes, e.g., for readbytes. */
+static size_t line_reader_take(struct stream_line_reader *reader,
+        void *buf, size_t count)
+{
+    if (count > reader->nr_pending)
+        count = reader->nr_pending;
 
-        end = (const char*)(buffer + read_size);
+    memcpy(buf, reader->buf + reader->pos, count);
+    reader->pos += count;
+    reader->nr_pending -= count;
+    return count;
+}
 
-        head = pcutils_get_next_token_len((const char*)buffer, read_size,
-                LINE_FLAG, &length);
-        while (head && head < end) {
-            purc_variant_t var = purc_variant_make_string_ex(head, length,
-                    false);
-            if (!var) {
-                return -1;
-            }
-            if (!purc_variant_array_append(array, var)) {
-                purc_variant_unref(var);
-                return -1;
-            }
-            purc_variant_unref(var);
-            line_num --;
+/*
+ * Reads more bytes into the buffer. Returns 0 if there is nothing to read
+ * for now, 1 if got some bytes, or 2 if reached the end of the stream.
+ */
+static int line_reader_fill(struct pcdvobjs_stream *stream,
+        struct stream_line_reader *reader, bool *short_read)
+{
+    /* NOTE: after a short read, only read again if there are bytes ready;
+       otherwise, a pipe whose writer is still alive would block the call. */
+    if (*short_read && stream->fd4r >= 0) {
+        struct pollfd pfd = { stream->fd4r, POLLIN, 0 };
+        if (poll(&pfd, 1, 0) <= 0)
+            return 0;
+    }
 
-            if (line_num == 0)
-                break;
+    if (reader->pos > 0) {
+        memmove(reader->buf, reader->buf + reader->pos, reader->nr_pending);
+        reader->pos = 0;
+    }
 
-            head = pcutils_get_next_token_len(head + length, end - head - length,
-                LINE_FLAG, &length);
+    if (reader->nr_pending == reader->sz_buf) {
+        size_t sz_buf = reader->sz_buf ? reader->sz_buf * 2 : BUFFER_SIZE;
+        char *buf = realloc(reader->buf, sz_buf);
+        if (buf == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
         }
-        if (read_size < BUFFER_SIZE)           // to the end
-            break;
+        reader->buf = buf;
+        reader->sz_buf = sz_buf;
+    }
+
+    size_t room = reader->sz_buf - reader->nr_pending;
+    ssize_t n = purc_rwstream_read(stream->stm4r,
+            reader->buf + reader->nr_pending, room);
+    if (n < 0) {
+        /* no more data for now, e.g., EAGAIN */
+        return 0;
+    }
+    else if (n == 0) {
+        return 2;
+    }
+
+    reader->nr_pending += n;
+    if ((size_t)n < room)
+        *short_read = true;
+    return 1;
+}
+
+static int append_line(purc_variant_t array, const char *line, size_t len)
+{
+    purc_variant_t var = purc_variant_make_string_ex(line, len, false);
+    if (!var) {
+        return -1;
+    }
+
+    bool ok = purc_variant_array_append(array, var);
+    purc_variant_unref(var);
+    return ok ? 0 : -1;
+}
 
-        if (line_num == 0)
+/* reads at most `line_num` lines from the stream; empty lines are skipped */
+static int read_lines(struct pcdvobjs_stream *stream, size_t line_num,
+        purc_variant_t array)
+{
+    struct stream_line_reader *reader = stream->lines;
+    size_t scanned = 0;
+    bool short_read = false;
+
+    if (reader == NULL) {
+        reader = calloc(1, sizeof(*reader));
+        if (reader == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        stream->lines = reader;
+    }
+
+    while (line_num) {
+        const char *head = reader->buf + reader->pos;
+        const char *lf = NULL;
+
+        /* the bytes scanned before have no line feed */
+        if (reader->nr_pending > scanned)
+            lf = memchr(head + scanned, '\n', reader->nr_pending - scanned);
+
+        if (lf) {
+            size_t len = lf - head;
+            if (len > 0) {
+                if (append_line(array, head, len))
+                    return -1;
+                line_num--;
+            }
+
+            reader->pos += len + 1;
+            reader->nr_pending -= len + 1;
+            scanned = 0;
+            continue;
+        }
+
+        scanned = reader->nr_pending;
+        int ret = line_reader_fill(stream, reader, &short_read);
+        if (ret < 0)
+            return -1;
+        else if (ret == 0)
             break;
+        else if (ret == 2) {
+            /* the last line has no line feed */
+            if (reader->nr_pending > 0) {
+                if (append_line(array, reader->buf + reader->pos,
+                            reader->nr_pending))
+                    return -1;
+                reader->pos = 0;
+                reader->nr_pending = 0;
+            }
+            break;
+        }
     }
 
     return 0;
@@ -448,21 +595,21 @@ readlines_getter(void *native_entity, const char *property_name,
 {
     UNUSED_PARAM(property_name);
     struct pcdvobjs_stream *stream;
-    purc_rwstream_t rwstream = NULL;
+    purc_variant_t ret_var = PURC_VARIANT_INVALID;
     int64_t line_num = 0;
+
     if (native_entity == NULL) {
         purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
         goto out;
     }
 
     stream = get_stream(native_entity);
-    rwstream = stream->stm4r;
-    if (rwstream == NULL) {
+    if (stream->stm4r == NULL) {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
         goto out;
     }
 
-    purc_variant_t ret_var = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+    ret_var = purc_variant_make_array(0, PURC_VARIANT_INVALID);
     if (!ret_var) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto out;
@@ -480,7 +627,7 @@ readlines_getter(void *native_entity, const char *property_name,
     }
 
     if (line_num > 0) {
-        int ret = read_lines(rwstream, line_num, ret_var);
+        int ret = read_lines(stream, line_num, ret_var);
         if (ret != 0) {
             goto out;
         }
@@ -489,8 +636,11 @@ readlines_getter(void *native_entity, const char *property_name,
     return ret_var;
 
 out:
-    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
-        return ret_var;
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY) {
+        if (ret_var)
+            return ret_var;
+        return purc_variant_make_array(0, PURC_VARIANT_INVALID);
+    }
 
     if (ret_var) {
         purc_variant_unref(ret_var);
@@ -581,6 +731,7 @@ writelines_getter(void *native_entity, const char *property_name,
         }
     }
 
+    purc_rwstream_flush(rwstream);
     return purc_variant_make_ulongint(nr_write);
 
 out:
@@ -634,7 +785,18 @@ readbytes_getter(void *native_entity, const char *property_name,
             goto out;
         }
 
-        size = purc_rwstream_read(rwstream, content, byte_num);
+        /* the bytes buffered by readlines come first */
+        if (stream->lines) {
+            size = line_reader_take(stream->lines, content, byte_num);
+        }
+
+        if (size < byte_num) {
+            ssize_t n = purc_rwstream_read(rwstream, content + size,
+                    byte_num - size);
+            if (n > 0)
+                size += n;
+        }
+
         if (size > 0) {
             ret_var = purc_variant_make_byte_sequence_reuse_buff(content,
                     size, size);
@@ -654,6 +816,350 @@ out:
     return PURC_VARIANT_INVALID;
 }
 
+/*
+ * The reader of JSON records for readjson and readjsonlines. The records
+ * are the top-level values, the elements of the top-level array, or the
+ * lines of NDJSON. They are built from the events of the SAX parser, so
+ * the whole text is never held in memory; the parser and the buffer are
+ * reused by all calls on the same stream.
+ */
+enum json_records_mode {
+    JSON_RECORDS_VALUE,
+    JSON_RECORDS_ELEMENT,
+    JSON_RECORDS_LINE,
+};
+
+struct stream_json_reader {
+    struct pcejson_sax *sax;
+
+    enum json_records_mode mode;
+    bool            eof;
+
+    /* the records got by the current call and the max number of them */
+    purc_variant_t  records;
+    size_t          max_records;
+
+    /* the containers being built and the pending keys of objects;
+       the slot of the top-level array is not used in elements mode */
+    uint32_t        depth;
+    purc_variant_t  containers[PCEJSON_DEFAULT_DEPTH];
+    purc_variant_t  keys[PCEJSON_DEFAULT_DEPTH];
+
+    /* the bytes read from the stream but not consumed yet */
+    size_t          pos;
+    size_t          nr_pending;
+    char            buf[BUFFER_SIZE];
+};
+
+static int json_reader_add(struct stream_json_reader *reader,
+        purc_variant_t v)
+{
+    uint32_t base = (reader->mode == JSON_RECORDS_ELEMENT) ? 1 : 0;
+
+    if (reader->depth <= base) {
+        if (!purc_variant_array_append(reader->records, v))
+            return -1;
+        /* suspend the parser once got enough records */
+        return ((size_t)purc_variant_array_get_size(reader->records) >=
+                reader->max_records) ? 1 : 0;
+    }
+
+    uint32_t level = reader->depth - 1;
+    purc_variant_t parent = reader->containers[level];
+    if (purc_variant_is_object(parent)) {
+        bool ok = purc_variant_object_set(parent, reader->keys[level], v);
+        purc_variant_unref(reader->keys[level]);
+        reader->keys[level] = PURC_VARIANT_INVALID;
+        return ok ? 0 : -1;
+    }
+
+    return purc_variant_array_append(parent, v) ? 0 : -1;
+}
+
+static int json_reader_start(struct stream_json_reader *reader,
+        purc_variant_t container)
+{
+    if (container == PURC_VARIANT_INVALID)
+        return -1;
+
+    reader->containers[reader->depth++] = container;
+    return 0;
+}
+
+static int json_reader_end(struct stream_json_reader *reader)
+{
+    purc_variant_t container = reader->containers[--reader->depth];
+    reader->containers[reader->depth] = PURC_VARIANT_INVALID;
+    if (container == PURC_VARIANT_INVALID)      // the top-level array
+        return 0;
+
+    int r = json_reader_add(reader, container);
+    purc_variant_unref(container);
+    return r;
+}
+
+static int on_json_start_object(void *ctxt)
+{
+    return json_reader_start(ctxt, purc_variant_make_object_0());
+}
+
+static int on_json_start_array(void *ctxt)
+{
+    struct stream_json_reader *reader = ctxt;
+    if (reader->mode == JSON_RECORDS_ELEMENT && reader->depth == 0) {
+        reader->containers[reader->depth++] = PURC_VARIANT_INVALID;
+        return 0;
+    }
+
+    return json_reader_start(reader,
+            purc_variant_make_array_0());
+}
+
+static int on_json_end(void *ctxt)
+{
+    return json_reader_end(ctxt);
+}
+
+static int on_json_key(void *ctxt, const char *key, size_t len)
+{
+    struct stream_json_reader *reader = ctxt;
+    purc_variant_t k = purc_variant_make_string_ex(key, len, false);
+    if (k == PURC_VARIANT_INVALID)
+        return -1;
+
+    reader->keys[reader->depth - 1] = k;
+    return 0;
+}
+
+static int on_json_value(void *ctxt, purc_variant_t value)
+{
+    return json_reader_add(ctxt, value);
+}
+
+static const struct pcejson_sax_handlers json_reader_handlers = {
+    on_json_start_object,
+    on_json_end,
+    on_json_start_array,
+    on_json_end,
+    on_json_key,
+    on_json_value,
+};
+
+static struct stream_json_reader *json_reader_new(enum json_records_mode mode)
+{
+    struct stream_json_reader *reader = calloc(1, sizeof(*reader));
+    if (reader == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    reader->sax = pcejson_sax_new(&json_reader_handlers, reader,
+            PCEJSON_DEFAULT_DEPTH, (mode == JSON_RECORDS_LINE) ?
+            PCEJSON_SAX_FLAG_LINES : PCEJSON_SAX_FLAG_MULTIPLE);
+    if (reader->sax == NULL) {
+        free(reader);
+        return NULL;
+    }
+
+    reader->mode = mode;
+    return reader;
+}
+
+static void json_reader_delete(struct stream_json_reader *reader)
+{
+    for (uint32_t i = 0; i < reader->depth; i++) {
+        if (reader->containers[i])
+            purc_variant_unref(reader->containers[i]);
+        if (reader->keys[i])
+            purc_variant_unref(reader->keys[i]);
+    }
+
+    pcejson_sax_delete(reader->sax);
+    free(reader);
+}
+
+/* reads at most `max` records from the stream */
+static int json_reader_read(struct pcdvobjs_stream *stream,
+        enum json_records_mode mode, purc_variant_t records, size_t max)
+{
+    struct stream_json_reader *reader = stream->json;
+    purc_rwstream_t rwstream = stream->stm4r;
+    int ret = 0;
+
+    /* NOTE: the mode takes effect only when the reader is created */
+    if (reader == NULL) {
+        reader = json_reader_new(mode);
+        if (reader == NULL)
+            return -1;
+        stream->json = reader;
+    }
+    else if (reader->mode != mode &&
+            (reader->mode == JSON_RECORDS_LINE || mode == JSON_RECORDS_LINE)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    reader->records = records;
+    reader->max_records = max;
+
+    while ((size_t)purc_variant_array_get_size(records) < max) {
+        if (reader->nr_pending == 0) {
+            if (reader->eof)
+                break;
+
+            ssize_t n = purc_rwstream_read(rwstream, reader->buf,
+                    sizeof(reader->buf));
+            if (n < 0) {
+                /* no more data for now, e.g., EAGAIN */
+                break;
+            }
+            else if (n == 0) {
+                reader->eof = true;
+                ret = pcejson_sax_end(reader->sax);
+                break;
+            }
+
+            reader->pos = 0;
+            reader->nr_pending = n;
+        }
+
+        ssize_t consumed = pcejson_sax_feed(reader->sax,
+                reader->buf + reader->pos, reader->nr_pending);
+        if (consumed < 0) {
+            ret = -1;
+            break;
+        }
+
+        reader->pos += consumed;
+        reader->nr_pending -= consumed;
+    }
+
+    reader->records = PURC_VARIANT_INVALID;
+    return ret;
+}
+
+static purc_variant_t
+readjson_getter(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+    struct pcdvobjs_stream *stream;
+    purc_rwstream_t rwstream = NULL;
+    purc_variant_t ret_var = PURC_VARIANT_INVALID;
+    uint64_t max = 1;
+    enum json_records_mode mode = JSON_RECORDS_VALUE;
+
+    if (native_entity == NULL) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        goto out;
+    }
+
+    stream = get_stream(native_entity);
+    rwstream = stream->stm4r;
+    if (rwstream == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
+    }
+
+    if (nr_args > 0 && argv[0] != PURC_VARIANT_INVALID &&
+            (!purc_variant_cast_to_ulongint(argv[0], &max, false) ||
+             max == 0)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
+    }
+
+    if (nr_args > 1) {
+        const char *kw = purc_variant_get_string_const(argv[1]);
+        if (kw == NULL) {
+            purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+            goto out;
+        }
+
+        if (strcmp(kw, "element") == 0)
+            mode = JSON_RECORDS_ELEMENT;
+        else if (strcmp(kw, "value")) {
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            goto out;
+        }
+    }
+
+    ret_var = purc_variant_make_array_0();
+    if (ret_var == PURC_VARIANT_INVALID) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out;
+    }
+
+    if (json_reader_read(stream, mode, ret_var, max))
+        goto out;
+
+    return ret_var;
+
+out:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY) {
+        if (ret_var)
+            return ret_var;
+        return purc_variant_make_array_0();
+    }
+
+    if (ret_var)
+        purc_variant_unref(ret_var);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+readjsonlines_getter(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+    struct pcdvobjs_stream *stream;
+    purc_variant_t ret_var = PURC_VARIANT_INVALID;
+    uint64_t max = 0;
+
+    if (native_entity == NULL) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        goto out;
+    }
+
+    stream = get_stream(native_entity);
+    if (stream->stm4r == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
+    }
+
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto out;
+    }
+
+    if (argv[0] != PURC_VARIANT_INVALID &&
+            !purc_variant_cast_to_ulongint(argv[0], &max, false)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
+    }
+
+    ret_var = purc_variant_make_array_0();
+    if (ret_var == PURC_VARIANT_INVALID) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out;
+    }
+
+    if (max > 0 && json_reader_read(stream, JSON_RECORDS_LINE, ret_var, max))
+        goto out;
+
+    return ret_var;
+
+out:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY) {
+        if (ret_var)
+            return ret_var;
+        return purc_variant_make_array_0();
+    }
+
+    if (ret_var)
+        purc_variant_unref(ret_var);
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t
 writebytes_getter(void *native_entity, const char *property_name,
         size_t nr_args, purc_variant_t *argv, unsigned call_flags)
@@ -701,6 +1207,7 @@ writebytes_getter(void *native_entity, const char *property_name,
     }
     if (buffer && bsize) {
         ssize_t nr_write = purc_rwstream_write(rwstream, buffer, bsize);
+        purc_rwstream_flush(rwstream);
         return purc_variant_make_ulongint(nr_write);
     }
 
@@ -886,6 +1393,14 @@ seek_getter(void *native_entity, const char *property_name,
         whence = SEEK_END;
     }
 
+    /* NOTE: the bytes buffered by readlines are not read by the user yet */
+    if (stream->lines) {
+        if (whence == SEEK_CUR)
+            byte_num -= stream->lines->nr_pending;
+        stream->lines->pos = 0;
+        stream->lines->nr_pending = 0;
+    }
+
     off = purc_rwstream_seek(rwstream, byte_num, (int)whence);
     if (off == -1) {
         goto out;
@@ -1073,6 +1588,12 @@ property_getter(void *entity, const char *name)
     else if (atom == keywords2atoms[K_KW_readbytes].atom) {
         return readbytes_getter;
     }
+    else if (atom == keywords2atoms[K_KW_readjson].atom) {
+        return readjson_getter;
+    }
+    else if (atom == keywords2atoms[K_KW_readjsonlines].atom) {
+        return readjsonlines_getter;
+    }
     else if (atom == keywords2atoms[K_KW_writebytes].atom) {
         return writebytes_getter;
     }
@@ -1460,7 +1981,8 @@ struct pcdvobjs_stream *create_pipe_stream(struct purc_broken_down_url *url,
         goto out_close_fd;
     }
 
-    stream->stm4w = purc_rwstream_new_from_unix_fd(pipefd_stdin[1]);
+    stream->stm4w = purc_rwstream_new_from_unix_fd_buffered(pipefd_stdin[1],
+            0, WRITE_BUFFER_SIZE);
     if (stream->stm4w == NULL) {
         goto out_free_stream;
     }
@@ -1531,7 +2053,8 @@ struct pcdvobjs_stream *create_fifo_stream(struct purc_broken_down_url *url,
         goto out_close_fd;
     }
 
-    stream->stm4r = purc_rwstream_new_from_unix_fd(fd);
+    stream->stm4r = purc_rwstream_new_from_unix_fd_buffered(fd, 0,
+            WRITE_BUFFER_SIZE);
     if (stream->stm4r == NULL) {
         goto out_free_stream;
     }
@@ -1682,6 +2205,125 @@ out_close_fd:
     return NULL;
 }
 
+#define MAX_NR_FILTERS  8
+
+/* NOTE: The filters are listed in the order they apply to the data written,
+   e.g., `gzip base64` compresses the data and then encodes them in base64;
+   so the last one is the nearest to the file, and the data read are decoded
+   in the reverse order. The filters apply to the files, the pipes, and
+   the FIFOs only. A file or a FIFO opened for both reading and
+   writing shares one rwstream, which can not be filtered in both
+   directions. */
+static int
+apply_filters(struct pcdvobjs_stream *stream, purc_variant_t option,
+        purc_variant_t extra_opts)
+{
+    if (extra_opts == PURC_VARIANT_INVALID ||
+            !purc_variant_is_object(extra_opts)) {
+        return 0;
+    }
+
+    purc_variant_t tmp = purc_variant_object_get_by_ckey(extra_opts,
+            "filters");
+    if (tmp == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return 0;
+    }
+
+    size_t parts_len;
+    const char *parts = purc_variant_get_string_const_ex(tmp, &parts_len);
+    if (parts == NULL) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        return -1;
+    }
+
+    pcrws_filter_k filters[MAX_NR_FILTERS];
+    size_t nr_filters = 0;
+    size_t length = 0;
+    const char *part = pcutils_get_next_token_len(parts, parts_len,
+            _KW_DELIMITERS, &length);
+    while (part && length > 0) {
+        purc_atom_t atom = 0;
+        if (length <= MAX_LEN_KEYWORD) {
+            char kw[length + 1];
+            strncpy(kw, part, length);
+            kw[length]= '\0';
+            atom = purc_atom_try_string_ex(STREAM_ATOM_BUCKET, kw);
+        }
+
+        if (nr_filters == MAX_NR_FILTERS) {
+            purc_set_error(PURC_ERROR_TOO_MANY);
+            return -1;
+        }
+
+        if (atom != 0 && atom == keywords2atoms[K_KW_gzip].atom) {
+            filters[nr_filters++] = PCRWS_FILTER_GZIP;
+        }
+        else if (atom != 0 && atom == keywords2atoms[K_KW_base64].atom) {
+            filters[nr_filters++] = PCRWS_FILTER_BASE64;
+        }
+        else {
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            return -1;
+        }
+
+        parts_len -= part + length - parts;
+        parts = part + length;
+        part = pcutils_get_next_token_len(parts, parts_len,
+                _KW_DELIMITERS, &length);
+    }
+
+    if (nr_filters == 0) {
+        return 0;
+    }
+
+    bool for_read = stream->stm4r != NULL;
+    bool for_write = stream->stm4w != NULL;
+    if (stream->stm4r == stream->stm4w) {
+        int flags = parse_open_option(option);
+        if (flags == -1) {
+            return -1;
+        }
+
+        switch (flags & O_ACCMODE) {
+        case O_RDONLY:
+            for_write = false;
+            stream->stm4w = NULL;
+            break;
+        case O_WRONLY:
+            for_read = false;
+            stream->stm4r = NULL;
+            break;
+        default:
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            return -1;
+        }
+    }
+
+    for (size_t i = nr_filters; i > 0; i--) {
+        if (for_read) {
+            purc_rwstream_t rws = purc_rwstream_new_filter(stream->stm4r,
+                    filters[i - 1], false);
+            if (rws == NULL) {
+                return -1;
+            }
+            stream->stm4r = rws;
+        }
+
+        if (for_write) {
+            purc_rwstream_t rws = purc_rwstream_new_filter(stream->stm4w,
+                    filters[i - 1], true);
+            if (rws == NULL) {
+                return -1;
+            }
+            stream->stm4w = rws;
+        }
+    }
+
+    stream->filtered = true;
+    return 0;
+}
+
 static purc_variant_t
 stream_open_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -1816,6 +2458,15 @@ stream_open_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto out_free_url;
     }
 
+    if ((stream->type == STREAM_TYPE_FILE || stream->type == STREAM_TYPE_PIPE
+                || stream->type == STREAM_TYPE_FIFO) &&
+            apply_filters(stream, option,
+                nr_args > 3 ? argv[3] : PURC_VARIANT_INVALID)) {
+        /* the url is owned by the stream */
+        dvobjs_stream_delete(stream);
+        goto out;
+    }
+
     // setup a callback for `on_release` to destroy the stream automatically
     ret_var = purc_variant_make_native_entity(stream, ops, entity_name);
     if (ret_var) {
@@ -1833,6 +2484,62 @@ out:
     return PURC_VARIANT_INVALID;
 }
 
+/*
+ * $STREAM.preconnect(<string: tcp://host:port>) resolves the host and
+ * connects to it in background, so that a later $STREAM.open() of the same
+ * host and port takes the warm connection instead of waiting for the DNS
+ * lookup and the TCP handshake.
+ */
+static purc_variant_t
+stream_preconnect_getter(purc_variant_t root, size_t nr_args,
+        purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+
+    struct purc_broken_down_url *url = NULL;
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto out;
+    }
+
+    if (!purc_variant_is_string(argv[0])) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        goto out;
+    }
+
+    url = pcutils_broken_down_url_new();
+    if (url == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out;
+    }
+
+    if (!pcutils_url_break_down(url, purc_variant_get_string_const(argv[0]))
+            || url->host == NULL || url->port <= 0 || url->port > 65535 ||
+            purc_atom_try_string_ex(STREAM_ATOM_BUCKET, url->schema) !=
+            keywords2atoms[K_KW_tcp].atom) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
+    }
+
+    char s_port[10];
+    snprintf(s_port, sizeof(s_port), "%d", url->port);
+    if (pcutils_resolver_preconnect(url->host, s_port)) {
+        goto out;
+    }
+
+    pcutils_broken_down_url_delete(url);
+    return purc_variant_make_boolean(true);
+
+out:
+    if (url)
+        pcutils_broken_down_url_delete(url);
+
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t
 stream_close_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -1860,6 +2567,331 @@ out:
     return PURC_VARIANT_INVALID;
 }
 
+/* writes all bytes, waiting for the file descriptor if it is non-blocking */
+static ssize_t transfer_write_all(int fd, const char *buf, size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(fd, buf + done, len - done);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd = { fd, POLLOUT, 0 };
+                poll(&pfd, 1, -1);
+                continue;
+            }
+
+            purc_set_error(purc_error_from_errno(errno));
+            return -1;
+        }
+        done += n;
+    }
+
+    return done;
+}
+
+/*
+ * Copies the data in chunks. If the destination would block, the bytes
+ * read but not written are put back by seeking the source; they are
+ * written anyway if the source is not seekable.
+ */
+static ssize_t transfer_by_copy(int dst_fd, int src_fd, size_t count)
+{
+    char *buf = malloc(TRANSFER_CHUNK_SIZE);
+    if (buf == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    size_t done = 0;
+    while (count == 0 || done < count) {
+        size_t len = TRANSFER_CHUNK_SIZE;
+        if (count && count - done < len)
+            len = count - done;
+
+        ssize_t n = read(src_fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK && done == 0) {
+                purc_set_error(purc_error_from_errno(errno));
+                free(buf);
+                return -1;
+            }
+            break;
+        }
+        else if (n == 0) {
+            break;
+        }
+
+        ssize_t w = write(dst_fd, buf, n);
+        if (w == n) {
+            done += n;
+            continue;
+        }
+
+        if (w < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                purc_set_error(purc_error_from_errno(errno));
+                free(buf);
+                return done ? (ssize_t)done : -1;
+            }
+            w = 0;
+        }
+
+        done += w;
+        if (lseek(src_fd, w - n, SEEK_CUR) == -1) {
+            if (transfer_write_all(dst_fd, buf + w, n - w) > 0)
+                done += n - w;
+        }
+        break;
+    }
+
+    free(buf);
+    return done;
+}
+
+/* Transfers the data in the kernel; returns -1 with ENOSYS if not possible. */
+static ssize_t transfer_in_kernel(int dst_fd, int src_fd, size_t count)
+{
+#if OS(LINUX)
+    bool use_splice = false;
+    size_t done = 0;
+
+    while (count == 0 || done < count) {
+        size_t len = count ? count - done : 0x7ffff000;
+        ssize_t n;
+
+        if (use_splice)
+            n = splice(src_fd, NULL, dst_fd, NULL, len, SPLICE_F_MOVE);
+        else
+            n = sendfile(dst_fd, src_fd, NULL, len);
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if ((errno == EINVAL || errno == ENOSYS) && done == 0) {
+                if (!use_splice) {
+                    /* splice() works if one of them is a pipe */
+                    use_splice = true;
+                    continue;
+                }
+                errno = ENOSYS;
+                return -1;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+
+            if (done == 0) {
+                purc_set_error(purc_error_from_errno(errno));
+                return -1;
+            }
+            break;
+        }
+        else if (n == 0) {
+            break;
+        }
+
+        done += n;
+    }
+
+    return done;
+#else
+    UNUSED_PARAM(dst_fd);
+    UNUSED_PARAM(src_fd);
+    UNUSED_PARAM(count);
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/*
+ * Sends the data as one binary message over the messaging layer of
+ * the destination, so the data is queued if the socket would block.
+ */
+static ssize_t transfer_as_message(struct pcdvobjs_stream *dst,
+        struct pcdvobjs_stream *src, size_t count)
+{
+    struct stream_line_reader *lines = src->lines;
+    size_t nr_pending = lines ? lines->nr_pending : 0;
+    int src_fd = src->fd4r;
+    struct stat st;
+
+    /* a regular file is read with pread(), so nothing is lost on failure */
+    off_t offset = -1;
+    if (fstat(src_fd, &st) == 0 && S_ISREG(st.st_mode))
+        offset = lseek(src_fd, 0, SEEK_CUR);
+
+    if (count == 0) {
+        if (offset >= 0)
+            count = (st.st_size > offset) ? st.st_size - offset : 0;
+        else
+            count = TRANSFER_CHUNK_SIZE;
+        count += nr_pending;
+    }
+
+    if (count == 0)
+        return 0;
+
+    char *buf = malloc(count);
+    if (buf == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    size_t len = (nr_pending < count) ? nr_pending : count;
+    if (len)
+        memcpy(buf, lines->buf + lines->pos, len);
+
+    while (len < count) {
+        ssize_t n;
+        if (offset >= 0)
+            n = pread(src_fd, buf + len, count - len,
+                    offset + len - nr_pending);
+        else
+            n = read(src_fd, buf + len, count - len);
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK && len == 0) {
+                purc_set_error(purc_error_from_errno(errno));
+                goto failed;
+            }
+            break;
+        }
+        else if (n == 0) {
+            break;
+        }
+
+        len += n;
+        /* do not wait for more data from a pipe or a socket */
+        if (offset < 0)
+            break;
+    }
+
+    int ret = dst->ext0.msg_ops->send_data(dst, false, buf, len);
+    if (ret) {
+        purc_set_error(ret);
+        goto failed;
+    }
+
+    if (nr_pending) {
+        size_t taken = (nr_pending < len) ? nr_pending : len;
+        lines->pos += taken;
+        lines->nr_pending -= taken;
+    }
+    if (offset >= 0 && len > nr_pending)
+        lseek(src_fd, offset + len - nr_pending, SEEK_SET);
+
+    free(buf);
+    return len;
+
+failed:
+    free(buf);
+    return -1;
+}
+
+/*
+ * $STREAM.transfer(<native/stream $dst>, <native/stream $src>
+ *      [, <ulongint $count = 0>]) ulongint
+ *
+ * Transfers at most `count` bytes (all if zero) from `src` to `dst` without
+ * making any byte sequence, and returns the number of bytes transferred.
+ */
+static purc_variant_t
+stream_transfer_getter(purc_variant_t root, size_t nr_args,
+        purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    struct pcdvobjs_stream *dst, *src;
+    uint64_t count = 0;
+    size_t done = 0;
+
+    if (nr_args < 2) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto out;
+    }
+
+    if (!purc_variant_is_native(argv[0]) || !purc_variant_is_native(argv[1])) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        goto out;
+    }
+
+    if (nr_args > 2 && argv[2] != PURC_VARIANT_INVALID &&
+            !purc_variant_cast_to_ulongint(argv[2], &count, false)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
+    }
+
+    dst = purc_variant_native_get_entity(argv[0]);
+    src = purc_variant_native_get_entity(argv[1]);
+    if (dst == src || src->stm4r == NULL || src->fd4r < 0) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
+    }
+
+    /* the data are moved between the file descriptors directly */
+    if (src->filtered || dst->filtered) {
+        purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+        goto out;
+    }
+
+    ssize_t n;
+    if (dst->ext0.msg_ops && dst->ext0.msg_ops->send_data) {
+        n = transfer_as_message(dst, src, count);
+        if (n < 0)
+            goto out;
+        return purc_variant_make_ulongint(n);
+    }
+
+    if (dst->stm4w == NULL || dst->fd4w < 0) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
+    }
+
+    /* NOTE: the bytes buffered in the user space go first */
+    purc_rwstream_flush(dst->stm4w);
+    if (src->lines && src->lines->nr_pending) {
+        struct stream_line_reader *lines = src->lines;
+        size_t len = lines->nr_pending;
+        if (count && count < len)
+            len = count;
+
+        if (transfer_write_all(dst->fd4w, lines->buf + lines->pos, len) < 0)
+            goto out;
+
+        lines->pos += len;
+        lines->nr_pending -= len;
+        done = len;
+        if (count && done == count)
+            return purc_variant_make_ulongint(done);
+    }
+
+    size_t left = count ? count - done : 0;
+    n = transfer_in_kernel(dst->fd4w, src->fd4r, left);
+    if (n < 0 && errno == ENOSYS) {
+        n = transfer_by_copy(dst->fd4w, src->fd4r, left);
+    }
+
+    if (n < 0) {
+        if (done == 0)
+            goto out;
+    }
+    else {
+        done += n;
+    }
+
+    return purc_variant_make_ulongint(done);
+
+out:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_ulongint(done);
+
+    return PURC_VARIANT_INVALID;
+}
+
 static bool add_stdio_property(purc_variant_t v)
 {
     static const struct purc_native_ops ops = {
@@ -1929,7 +2961,9 @@ purc_variant_t purc_dvobj_stream_new(void)
 {
     static struct purc_dvobj_method  stream[] = {
         { "open",   stream_open_getter,     NULL },
+        { "preconnect", stream_preconnect_getter, NULL },
         { "close",  stream_close_getter,    NULL },
+        { "transfer", stream_transfer_getter, NULL },
     };
 
     if (keywords2atoms[0].atom == 0) {
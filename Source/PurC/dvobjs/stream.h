@@ -47,6 +47,7 @@ enum pcdvobjs_stream_type {
 
 struct pcdvobjs_stream;
 struct stream_extended_data;
+struct stream_json_reader;
 
 enum stream_message_type {
     MT_UNKNOWN = 0,
@@ -95,6 +96,10 @@ typedef struct pcdvobjs_stream {
 
     pid_t cpid;                 /* only for pipe, the pid of child */
     purc_atom_t cid;
+    bool filtered;              /* stm4r or stm4w is a filter rwstream */
+
+    struct stream_json_reader *json;    /* the reader for readjson */
+    struct stream_line_reader *lines;   /* the reader for readlines */
 
     struct stream_extended ext0;   /* for presentation layer */
     struct stream_extended ext1;   /* for application layer */
@@ -22,6 +22,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#define _GNU_SOURCE
 #include "config.h"
 
 #include "private/errors.h"
@@ -31,29 +32,14 @@
 #include "purc-variant.h"
 #include "helper.h"
 
-static const char * get_next_segment (const char *data,
-        const char *delim, size_t *length)
+/* NOTE: memmem() of glibc uses the two-way algorithm with the SIMD
+   filters, and does not rescan the haystack for the terminating null byte
+   as strstr() does. */
+static inline const char *
+find_substring(const char *haystack, size_t len_haystack,
+        const char *needle, size_t len_needle)
 {
-    const char *head = NULL;
-    char *temp = NULL;
-
-    *length = 0;
-
-    if ((*data == 0x00) || (*delim == 0x00))
-        return NULL;
-
-    head = data;
-
-    temp = strstr (head, delim);
-
-    if (temp) {
-        *length =  temp - head;
-    }
-    else {
-        *length = strlen (head);
-    }
-
-    return head;
+    return memmem(haystack, len_haystack, needle, len_needle);
 }
 
 static purc_variant_t
@@ -148,7 +134,8 @@ contains_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         result  = pcutils_strcasestr(haystack, needle) != NULL;
     }
     else {
-        result = strstr(haystack, needle) != NULL;
+        result = find_substring(haystack, len_haystack,
+                needle, len_needle) != NULL;
     }
 
     return purc_variant_make_boolean(result);
@@ -273,57 +260,28 @@ join_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     UNUSED_PARAM(root);
     UNUSED_PARAM(call_flags);
 
-    purc_rwstream_t rwstream;
-    rwstream = purc_rwstream_new_buffer(LEN_INI_PRINT_BUF, LEN_MAX_PRINT_BUF);
-    if (rwstream == NULL) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto fatal;
-    }
-
+    /* the first pass computes the exact length of the result */
+    size_t len = 0;
     for (size_t i = 0; i < nr_args; i++) {
-#if 0
-        const char *str;
-        size_t len_str;
-
-        str = purc_variant_get_string_const_ex(argv[i], &len_str);
-        if (str) {
-            ssize_t nr_wrotten = purc_rwstream_write(rwstream, str, len_str);
-            if (nr_wrotten < 0 || (size_t)nr_wrotten < len_str) {
-                purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-                goto fatal;
-            }
-        }
-        else if (call_flags & PCVRT_CALL_FLAG_SILENTLY) {
-            // do nothing
-        }
-        else {
-            purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
-            goto fatal;
-        }
-#else
-        if (purc_variant_stringify(rwstream, argv[i], 0, NULL) < 0) {
-            goto fatal;
-        }
-#endif
+        ssize_t n = purc_variant_stringify_length(argv[i], 0);
+        if (n < 0)
+            return PURC_VARIANT_INVALID;
+        len += n;
     }
 
-    if (purc_rwstream_write(rwstream, "", 1) < 1) {
-        goto fatal;
+    char *buf = malloc(len + 1);
+    if (buf == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
     }
 
-    size_t sz_buffer = 0;
-    size_t sz_content = 0;
-    char *content = NULL;
-    content = purc_rwstream_get_mem_buffer_ex(rwstream,
-            &sz_content, &sz_buffer, true);
-    purc_rwstream_destroy(rwstream);
-
-    return purc_variant_make_string_reuse_buff(content, sz_buffer, false);
+    char *p = buf;
+    for (size_t i = 0; i < nr_args; i++) {
+        p += purc_variant_stringify_to_buff(p, len + 1 - (p - buf),
+                argv[i], 0);
+    }
 
-fatal:
-    if (rwstream)
-        purc_rwstream_destroy(rwstream);
-    return PURC_VARIANT_INVALID;
+    return purc_variant_make_string_reuse_buff(buf, len + 1, false);
 }
 
 static purc_variant_t
@@ -625,7 +583,6 @@ explode_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 
     purc_variant_t ret_var = PURC_VARIANT_INVALID;
     purc_variant_t val = PURC_VARIANT_INVALID;
-    char *buf = NULL;
 
     if ((argv == NULL) || (nr_args < 2)) {
         purc_set_error (PURC_ERROR_ARGUMENT_MISSED);
@@ -643,33 +600,39 @@ explode_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         return PURC_VARIANT_INVALID;
     }
 
-    const char *source = purc_variant_get_string_const (argv[0]);
-    const char *delim = purc_variant_get_string_const (argv[1]);
-    size_t len_delim = purc_variant_string_size (argv[1]) - 1;
-    size_t length = 0;
-    const char *head = get_next_segment (source, delim, &length);
+    size_t len_source, len_delim;
+    const char *source = purc_variant_get_string_const_ex (argv[0],
+            &len_source);
+    const char *delim = purc_variant_get_string_const_ex (argv[1],
+            &len_delim);
 
-    ret_var = purc_variant_make_array (0, PURC_VARIANT_INVALID);
+    ret_var = purc_variant_make_array_0 ();
+    if (ret_var == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
 
-    while (head) {
-        buf = malloc (length + 1);
-        if (buf == NULL) {
-            purc_set_error (PURC_ERROR_OUT_OF_MEMORY);
+    if (len_source == 0 || len_delim == 0)
+        return ret_var;
+
+    /* NOTE: the trailing empty segment is not returned. */
+    const char *end = source + len_source;
+    const char *head = source;
+    while (head < end) {
+        const char *found = find_substring (head, end - head,
+                delim, len_delim);
+        size_t length = found ? (size_t)(found - head) : (size_t)(end - head);
+
+        val = purc_variant_make_string_ex (head, length, false);
+        if (val == PURC_VARIANT_INVALID ||
+                !purc_variant_array_append (ret_var, val)) {
+            PURC_VARIANT_SAFE_CLEAR (val);
             purc_variant_unref (ret_var);
             return PURC_VARIANT_INVALID;
         }
-
-        strncpy (buf, head, length + 1);
-        *(buf + length)= 0x00;
-        val = purc_variant_make_string_reuse_buff (buf, length, true);
-        purc_variant_array_append (ret_var, val);
         purc_variant_unref (val);
 
-        if (*(head + length) != 0x00)
-            head = get_next_segment (head + length + len_delim,
-                    delim, &length);
-        else
+        if (found == NULL)
             break;
+        head = found + len_delim;
     }
 
     return ret_var;
@@ -771,8 +734,6 @@ replace_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     UNUSED_PARAM(root);
     UNUSED_PARAM(call_flags);
 
-    purc_variant_t ret_var = PURC_VARIANT_INVALID;
-
     if ((argv == NULL) || (nr_args < 3)) {
         purc_set_error (PURC_ERROR_ARGUMENT_MISSED);
         return PURC_VARIANT_INVALID;
@@ -795,49 +756,56 @@ replace_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         return PURC_VARIANT_INVALID;
     }
 
-    size_t len_delim = purc_variant_string_size (argv[0]) - 1;
-    if (len_delim == 0) {
-        purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
-        return PURC_VARIANT_INVALID;
-    }
-    len_delim = purc_variant_string_size (argv[1]) - 1;
-    if (len_delim == 0) {
+    size_t len_source, len_delim, len_replace;
+    const char *source = purc_variant_get_string_const_ex (argv[0],
+            &len_source);
+    const char *delim = purc_variant_get_string_const_ex (argv[1],
+            &len_delim);
+    const char *replace = purc_variant_get_string_const_ex (argv[2],
+            &len_replace);
+    if (len_source == 0 || len_delim == 0) {
         purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
         return PURC_VARIANT_INVALID;
     }
 
-    const char *source = purc_variant_get_string_const (argv[0]);
-    const char *delim = purc_variant_get_string_const (argv[1]);
-    const char *replace = purc_variant_get_string_const (argv[2]);
-    purc_rwstream_t rwstream = purc_rwstream_new_buffer (32, STREAM_SIZE);
+    /* count the occurrences first to allocate the result only once */
+    const char *end = source + len_source;
+    const char *p = source;
+    size_t nr_found = 0;
+    while ((p = find_substring (p, end - p, delim, len_delim))) {
+        nr_found++;
+        p += len_delim;
+    }
 
-    size_t len_replace = purc_variant_string_size (argv[2]) - 1;
-    size_t length = 0;
-    const char *head = get_next_segment (source, delim, &length);
+    if (nr_found == 0)
+        return purc_variant_ref (argv[0]);
 
-    while (head) {
-        purc_rwstream_write (rwstream, head, length);
+    size_t len_new = len_source - nr_found * len_delim +
+        nr_found * len_replace;
+    if (len_new == 0)
+        return purc_variant_make_string_static ("", false);
 
-        if (*(head + length) != 0x00) {
-            purc_rwstream_write (rwstream, replace, len_replace);
-            head = get_next_segment (head + length + len_delim,
-                    delim, &length);
-        } else
-            break;
+    char *buf = malloc (len_new + 1);
+    if (buf == NULL) {
+        purc_set_error (PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
     }
 
-    size_t rw_size = 0;
-    const char *rw_string = purc_rwstream_get_mem_buffer (rwstream, &rw_size);
-
-    if ((rw_size == 0) || (rw_string == NULL))
-        ret_var = PURC_VARIANT_INVALID;
-    else {
-        ret_var = purc_variant_make_string (rw_string, false);
+    char *q = buf;
+    const char *head = source;
+    while (nr_found--) {
+        const char *found = find_substring (head, end - head,
+                delim, len_delim);
+        memcpy (q, head, found - head);
+        q += found - head;
+        memcpy (q, replace, len_replace);
+        q += len_replace;
+        head = found + len_delim;
     }
+    memcpy (q, head, end - head);
+    buf[len_new] = 0x00;
 
-    purc_rwstream_destroy (rwstream);
-
-    return ret_var;
+    return purc_variant_make_string_reuse_buff (buf, len_new + 1, false);
 }
 
 static purc_variant_t
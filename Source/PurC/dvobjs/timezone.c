@@ -0,0 +1,766 @@
+/*
+ * @file timezone.c
+ * @date 2026/10/14
+ * @brief The cached rules of the timezones used by $DATETIME.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "helper.h"
+
+#include "private/instance.h"
+#include "private/errors.h"
+#include "private/dvobjs.h"
+#include "private/list.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * NOTE: switching the timezone through `TZ` and tzset() for every call
+ * of $DATETIME is slow, and not safe for the runners in other threads.
+ * The rules of a timezone are loaded from its TZif file once per instance
+ * instead, and the broken-down times are computed from the rules, with
+ * `tm_gmtoff` and `tm_zone` filled for strftime(). We fall back to `TZ`
+ * only if the file can not be parsed, or there is no instance.
+ */
+#define MAX_CACHED_TIMEZONES    8
+
+/* the size of a TZif file at most */
+#define MAX_TZIF_SIZE           (1024 * 1024)
+
+#define LEN_MAX_TZ_ABBR         16
+
+#define SECS_PER_DAY            86400
+#define SECS_PER_HOUR           3600
+
+#if HAVE(TM_GMTOFF) && HAVE(TM_ZONE)
+#define USE_TIMEZONE_RULES      1
+#endif
+
+struct tz_type {
+    int32_t                         utoff;
+    bool                            isdst;
+    const char                     *abbr;
+};
+
+/* the date of a transition in a POSIX TZ string */
+struct tz_date {
+    char                            kind;   // 'J', 'N', or 'M'
+    int                             mon, week, day;
+    int32_t                         secs;   // the local time of the day
+};
+
+struct cached_timezone {
+    struct list_head                ln;
+    char                           *name;
+
+    /* false if the file can not be parsed; use `TZ` then */
+    bool                            has_rules;
+
+    size_t                          nr_times;
+    int64_t                        *times;
+    uint8_t                        *idxs;
+    size_t                          nr_types;
+    struct tz_type                 *types;
+    char                           *abbrs;
+
+    /* the rule for the times after the last transition */
+    bool                            has_footer;
+    bool                            has_dst;
+    struct tz_type                  std, dst;
+    struct tz_date                  start, end;
+    char                            std_abbr[LEN_MAX_TZ_ABBR];
+    char                            dst_abbr[LEN_MAX_TZ_ABBR];
+};
+
+char *pcdvobjs_timezone_set(const char *timezone)
+{
+    char *tz_old = NULL;
+
+    if (timezone) {
+        char *env = getenv("TZ");
+        if (env)
+            tz_old = strdup(env);
+
+        if (env == NULL || strcmp(env, timezone)) {
+            /* change timezone temporarily. */
+            char new_timezone[strlen(timezone) + 2];
+            strcpy(new_timezone, ":");
+            strcat(new_timezone, timezone);
+            setenv("TZ", new_timezone, 1);
+            tzset();
+        }
+    }
+
+    return tz_old;
+}
+
+void pcdvobjs_timezone_restore(char *tz_old)
+{
+    if (tz_old) {
+        if (strcmp(getenv("TZ"), tz_old)) {
+            // restore old timezone.
+            setenv("TZ", tz_old, 1);
+            tzset();
+        }
+        free(tz_old);
+    }
+}
+
+#if USE_TIMEZONE_RULES
+
+static inline int64_t floor_div(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    if ((a % b) != 0 && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+
+static inline bool is_leap_year(int64_t y)
+{
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+static int month_length(int64_t y, int mon)
+{
+    static const int lengths[] = {
+        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+    };
+
+    if (mon == 2 && is_leap_year(y))
+        return 29;
+    return lengths[mon - 1];
+}
+
+/* the days since 1970-01-01 of a date in the proleptic Gregorian calendar;
+   the month is in the range of 1 to 12. */
+static int64_t days_from_civil(int64_t y, int mon, int mday)
+{
+    y -= (mon <= 2);
+    int64_t era = floor_div(y, 400);
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (mon + (mon > 2 ? -3 : 9)) + 2) / 5 + mday - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civil_from_days(int64_t days, int64_t *y, int *mon, int *mday)
+{
+    days += 719468;
+    int64_t era = floor_div(days, 146097);
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+
+    *mday = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *mon = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *y = yoe + era * 400 + (*mon <= 2);
+}
+
+/* 1970-01-01 is a Thursday */
+static inline int weekday_of_days(int64_t days)
+{
+    return (int)((days % 7 + 11) % 7);
+}
+
+static inline uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+        ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline int64_t be64(const uint8_t *p)
+{
+    return (int64_t)(((uint64_t)be32(p) << 32) | be32(p + 4));
+}
+
+static const char *parse_tz_abbr(const char *p, char *buf)
+{
+    size_t n = 0;
+
+    if (*p == '<') {
+        p++;
+        while (*p && *p != '>') {
+            if (n < LEN_MAX_TZ_ABBR - 1)
+                buf[n++] = *p;
+            p++;
+        }
+        if (*p != '>')
+            return NULL;
+        p++;
+    }
+    else {
+        while (purc_isalpha(*p)) {
+            if (n < LEN_MAX_TZ_ABBR - 1)
+                buf[n++] = *p;
+            p++;
+        }
+    }
+
+    buf[n] = '\0';
+    return n ? p : NULL;
+}
+
+/* [+-]hh[:mm[:ss]] */
+static const char *parse_tz_secs(const char *p, int32_t *secs)
+{
+    int sign = 1;
+    if (*p == '+' || *p == '-') {
+        if (*p == '-')
+            sign = -1;
+        p++;
+    }
+
+    if (!purc_isdigit(*p))
+        return NULL;
+
+    int32_t v = 0;
+    for (int part = 0; part < 3; part++) {
+        int32_t n = 0;
+        while (purc_isdigit(*p) && n < 1000) {
+            n = n * 10 + (*p - '0');
+            p++;
+        }
+
+        v += n * (part == 0 ? SECS_PER_HOUR : (part == 1 ? 60 : 1));
+        if (part == 2 || *p != ':' || !purc_isdigit(p[1]))
+            break;
+        p++;
+    }
+
+    *secs = sign * v;
+    return p;
+}
+
+/* Jn, n, or Mm.w.d, with an optional /time */
+static const char *parse_tz_date(const char *p, struct tz_date *date)
+{
+    char *end;
+
+    if (*p == 'M') {
+        date->kind = 'M';
+        date->mon = (int)strtol(p + 1, &end, 10);
+        if (*end != '.')
+            return NULL;
+        date->week = (int)strtol(end + 1, &end, 10);
+        if (*end != '.')
+            return NULL;
+        date->day = (int)strtol(end + 1, &end, 10);
+        if (date->mon < 1 || date->mon > 12 || date->week < 1 ||
+                date->week > 5 || date->day < 0 || date->day > 6)
+            return NULL;
+    }
+    else {
+        date->kind = 'N';
+        if (*p == 'J') {
+            date->kind = 'J';
+            p++;
+        }
+
+        if (!purc_isdigit(*p))
+            return NULL;
+        date->day = (int)strtol(p, &end, 10);
+        if (date->day > 365 || (date->kind == 'J' && date->day < 1))
+            return NULL;
+    }
+
+    p = end;
+    date->secs = 2 * SECS_PER_HOUR;
+    if (*p == '/') {
+        p = parse_tz_secs(p + 1, &date->secs);
+    }
+
+    return p;
+}
+
+/* parses the POSIX TZ string in the footer of a TZif file */
+static bool parse_footer(struct cached_timezone *tz, const char *p)
+{
+    int32_t secs;
+
+    if ((p = parse_tz_abbr(p, tz->std_abbr)) == NULL ||
+            (p = parse_tz_secs(p, &secs)) == NULL)
+        return false;
+
+    /* the offset of POSIX is positive to the west of Greenwich */
+    tz->std.utoff = -secs;
+    tz->std.isdst = false;
+    tz->std.abbr = tz->std_abbr;
+
+    if (*p) {
+        if ((p = parse_tz_abbr(p, tz->dst_abbr)) == NULL)
+            return false;
+
+        tz->dst.utoff = tz->std.utoff + SECS_PER_HOUR;
+        if (*p && *p != ',') {
+            if ((p = parse_tz_secs(p, &secs)) == NULL)
+                return false;
+            tz->dst.utoff = -secs;
+        }
+        tz->dst.isdst = true;
+        tz->dst.abbr = tz->dst_abbr;
+
+        if (*p == ',') {
+            if ((p = parse_tz_date(p + 1, &tz->start)) == NULL ||
+                    *p != ',' ||
+                    (p = parse_tz_date(p + 1, &tz->end)) == NULL)
+                return false;
+        }
+        else {
+            /* the default rule of POSIX: M3.2.0,M11.1.0 */
+            tz->start = (struct tz_date){ 'M', 3, 2, 0, 2 * SECS_PER_HOUR };
+            tz->end = (struct tz_date){ 'M', 11, 1, 0, 2 * SECS_PER_HOUR };
+        }
+        tz->has_dst = true;
+    }
+
+    if (*p)
+        return false;
+
+    tz->has_footer = true;
+    return true;
+}
+
+/* the local time in seconds since the epoch of a transition in a year */
+static int64_t date_in_year(int64_t y, const struct tz_date *date)
+{
+    int64_t days;
+
+    if (date->kind == 'M') {
+        days = days_from_civil(y, date->mon, 1);
+        int mday = 1 + (date->day - weekday_of_days(days) + 7) % 7 +
+            (date->week - 1) * 7;
+        int len = month_length(y, date->mon);
+        while (mday > len)
+            mday -= 7;
+        days += mday - 1;
+    }
+    else {
+        days = days_from_civil(y, 1, 1);
+        if (date->kind == 'J') {
+            /* Julian day of 1 to 365; February 29 is never counted */
+            days += date->day - 1;
+            if (is_leap_year(y) && date->day >= 60)
+                days++;
+        }
+        else {
+            days += date->day;
+        }
+    }
+
+    return days * SECS_PER_DAY + date->secs;
+}
+
+static const struct tz_type *
+footer_type(const struct cached_timezone *tz, int64_t t)
+{
+    if (!tz->has_dst)
+        return &tz->std;
+
+    int64_t y;
+    int mon, mday;
+    civil_from_days(floor_div(t + tz->std.utoff, SECS_PER_DAY),
+            &y, &mon, &mday);
+
+    int64_t start = date_in_year(y, &tz->start) - tz->std.utoff;
+    int64_t end = date_in_year(y, &tz->end) - tz->dst.utoff;
+    if (start < end)
+        return (t >= start && t < end) ? &tz->dst : &tz->std;
+
+    /* the southern hemisphere */
+    return (t >= end && t < start) ? &tz->std : &tz->dst;
+}
+
+static const struct tz_type *
+find_type(const struct cached_timezone *tz, int64_t t)
+{
+    if (tz->nr_times == 0)
+        return tz->has_footer ? footer_type(tz, t) : &tz->types[0];
+
+    if (t < tz->times[0])
+        return &tz->types[0];
+
+    if (t >= tz->times[tz->nr_times - 1] && tz->has_footer)
+        return footer_type(tz, t);
+
+    /* the last transition not after the time */
+    size_t low = 0, high = tz->nr_times;
+    while (high - low > 1) {
+        size_t mid = (low + high) / 2;
+        if (tz->times[mid] <= t)
+            low = mid;
+        else
+            high = mid;
+    }
+
+    return &tz->types[tz->idxs[low]];
+}
+
+/* Finds the type nearest to the time with the other daylight saving time
+   than the one in effect at the time. */
+static const struct tz_type *
+find_other_type(const struct cached_timezone *tz, int64_t t)
+{
+    const struct tz_type *type = find_type(tz, t);
+
+    /* the transitions around within a year */
+    for (int i = 1; i <= 12; i++) {
+        const struct tz_type *other;
+        other = find_type(tz, t + i * 30LL * SECS_PER_DAY);
+        if (other->isdst != type->isdst)
+            return other;
+        other = find_type(tz, t - i * 30LL * SECS_PER_DAY);
+        if (other->isdst != type->isdst)
+            return other;
+    }
+
+    /* the history */
+    size_t idx = 0;
+    while (idx < tz->nr_times && tz->times[idx] <= t)
+        idx++;
+
+    for (size_t i = 0; i < tz->nr_times; i++) {
+        if (idx + i < tz->nr_times &&
+                tz->types[tz->idxs[idx + i]].isdst != type->isdst)
+            return &tz->types[tz->idxs[idx + i]];
+        if (i < idx && tz->types[tz->idxs[idx - i - 1]].isdst != type->isdst)
+            return &tz->types[tz->idxs[idx - i - 1]];
+    }
+
+    if (tz->has_dst)
+        return type->isdst ? &tz->std : &tz->dst;
+    return NULL;
+}
+
+static void
+break_down(const struct tz_type *type, int64_t t, struct tm *tm)
+{
+    int64_t local = t + type->utoff;
+    int64_t days = floor_div(local, SECS_PER_DAY);
+    int64_t secs = local - days * SECS_PER_DAY;
+    int64_t y;
+    int mon, mday;
+
+    civil_from_days(days, &y, &mon, &mday);
+
+    tm->tm_sec = (int)(secs % 60);
+    tm->tm_min = (int)(secs / 60 % 60);
+    tm->tm_hour = (int)(secs / SECS_PER_HOUR);
+    tm->tm_mday = mday;
+    tm->tm_mon = mon - 1;
+    tm->tm_year = (int)(y - 1900);
+    tm->tm_wday = weekday_of_days(days);
+    tm->tm_yday = (int)(days - days_from_civil(y, 1, 1));
+    tm->tm_isdst = type->isdst ? 1 : 0;
+    tm->tm_gmtoff = type->utoff;
+    tm->tm_zone = (char *)type->abbr;
+}
+
+static bool load_rules(struct cached_timezone *tz, const uint8_t *data,
+        size_t len)
+{
+    if (len < 44 || memcmp(data, "TZif", 4))
+        return false;
+
+    int version = data[4];
+    size_t time_size = 4;
+    const uint8_t *p = data;
+
+    for (int pass = 0; ; pass++) {
+        if ((size_t)(p - data) + 44 > len || memcmp(p, "TZif", 4))
+            return false;
+
+        size_t isutcnt = be32(p + 20);
+        size_t isstdcnt = be32(p + 24);
+        size_t leapcnt = be32(p + 28);
+        size_t timecnt = be32(p + 32);
+        size_t typecnt = be32(p + 36);
+        size_t charcnt = be32(p + 40);
+        size_t size = timecnt * (time_size + 1) + typecnt * 6 + charcnt +
+            leapcnt * (time_size + 4) + isstdcnt + isutcnt;
+
+        p += 44;
+        if ((size_t)(p - data) + size > len)
+            return false;
+
+        if (pass == 0 && version >= '2') {
+            /* skip the data block of version 1 */
+            p += size;
+            time_size = 8;
+            continue;
+        }
+
+        if (typecnt == 0 || typecnt > 256 || charcnt == 0)
+            return false;
+
+        tz->times = malloc(sizeof(int64_t) * (timecnt ? timecnt : 1));
+        tz->idxs = malloc(timecnt ? timecnt : 1);
+        tz->types = malloc(sizeof(struct tz_type) * typecnt);
+        tz->abbrs = malloc(charcnt + 1);
+        if (tz->times == NULL || tz->idxs == NULL || tz->types == NULL ||
+                tz->abbrs == NULL)
+            return false;
+
+        for (size_t i = 0; i < timecnt; i++) {
+            tz->times[i] = (time_size == 8) ? be64(p) : (int32_t)be32(p);
+            p += time_size;
+        }
+
+        for (size_t i = 0; i < timecnt; i++) {
+            if (p[i] >= typecnt)
+                return false;
+            tz->idxs[i] = p[i];
+        }
+        p += timecnt;
+
+        const uint8_t *types = p;
+        p += typecnt * 6;
+        memcpy(tz->abbrs, p, charcnt);
+        tz->abbrs[charcnt] = '\0';
+        p += charcnt;
+
+        for (size_t i = 0; i < typecnt; i++) {
+            tz->types[i].utoff = (int32_t)be32(types + i * 6);
+            tz->types[i].isdst = types[i * 6 + 4] != 0;
+            if (types[i * 6 + 5] >= charcnt)
+                return false;
+            tz->types[i].abbr = tz->abbrs + types[i * 6 + 5];
+        }
+
+        tz->nr_times = timecnt;
+        tz->nr_types = typecnt;
+        p += leapcnt * (time_size + 4) + isstdcnt + isutcnt;
+        break;
+    }
+
+    /* the footer of version 2+: "\n<POSIX TZ string>\n" */
+    if (time_size == 8 && (size_t)(p - data) < len && *p == '\n') {
+        const uint8_t *start = p + 1;
+        const uint8_t *end = memchr(start, '\n', len - (start - data));
+        if (end && end > start) {
+            char footer[end - start + 1];
+            memcpy(footer, start, end - start);
+            footer[end - start] = '\0';
+            if (!parse_footer(tz, footer)) {
+                tz->has_footer = false;
+                tz->has_dst = false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void load_timezone(struct cached_timezone *tz)
+{
+    char path[sizeof(PURC_SYS_TZ_DIR) + strlen(tz->name)];
+    strcpy(path, PURC_SYS_TZ_DIR);
+    strcat(path, tz->name);
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+        return;
+
+    uint8_t *data = malloc(MAX_TZIF_SIZE);
+    if (data) {
+        size_t len = fread(data, 1, MAX_TZIF_SIZE, fp);
+        if (len > 0 && len < MAX_TZIF_SIZE)
+            tz->has_rules = load_rules(tz, data, len);
+        free(data);
+    }
+    fclose(fp);
+}
+
+#else   /* USE_TIMEZONE_RULES */
+
+static void load_timezone(struct cached_timezone *tz)
+{
+    /* strftime() can not get the timezone from the broken-down time */
+    tz->has_rules = false;
+}
+
+#endif  /* !USE_TIMEZONE_RULES */
+
+static void
+uncache_timezone(struct pcinst *inst, struct cached_timezone *tz)
+{
+    list_del(&tz->ln);
+    inst->nr_timezones--;
+
+    free(tz->times);
+    free(tz->idxs);
+    free(tz->types);
+    free(tz->abbrs);
+    free(tz->name);
+    free(tz);
+}
+
+/* Returns the cached timezone, or NULL if there is no instance, or the
+   timezone is invalid (the error is set then). */
+static struct cached_timezone *
+find_timezone(const char *timezone, bool *valid)
+{
+    struct pcinst *inst = pcinst_current();
+    struct cached_timezone *tz;
+
+    *valid = true;
+    if (inst == NULL || inst->timezones.next == NULL) {
+        *valid = pcdvobjs_is_valid_timezone(timezone);
+        return NULL;
+    }
+
+    list_for_each_entry(tz, &inst->timezones, ln) {
+        if (strcmp(tz->name, timezone) == 0) {
+            list_move(&tz->ln, &inst->timezones);
+            inst->nr_timezone_hits++;
+            return tz;
+        }
+    }
+
+    if (!pcdvobjs_is_valid_timezone(timezone)) {
+        *valid = false;
+        return NULL;
+    }
+
+    tz = calloc(1, sizeof(*tz));
+    if (tz == NULL || (tz->name = strdup(timezone)) == NULL) {
+        free(tz);
+        return NULL;
+    }
+
+    load_timezone(tz);
+    if (!tz->has_rules) {
+        free(tz->times);
+        free(tz->idxs);
+        free(tz->types);
+        free(tz->abbrs);
+        tz->times = NULL;
+        tz->idxs = NULL;
+        tz->types = NULL;
+        tz->abbrs = NULL;
+    }
+
+    inst->nr_timezone_misses++;
+    if (inst->nr_timezones >= MAX_CACHED_TIMEZONES) {
+        uncache_timezone(inst,
+                list_last_entry(&inst->timezones, struct cached_timezone, ln));
+    }
+
+    list_add(&tz->ln, &inst->timezones);
+    inst->nr_timezones++;
+    return tz;
+}
+
+bool pcdvobjs_timezone_check(const char *timezone)
+{
+    bool valid;
+    find_timezone(timezone, &valid);
+    return valid;
+}
+
+void pcdvobjs_timezone_localtime(const char *timezone, time_t t,
+        struct tm *tm)
+{
+    if (timezone) {
+        bool valid;
+        struct cached_timezone *tz = find_timezone(timezone, &valid);
+#if USE_TIMEZONE_RULES
+        if (tz && tz->has_rules) {
+            break_down(find_type(tz, t), t, tm);
+            return;
+        }
+#else
+        UNUSED_PARAM(tz);
+#endif
+    }
+
+    char *tz_old = pcdvobjs_timezone_set(timezone);
+    localtime_r(&t, tm);
+    pcdvobjs_timezone_restore(tz_old);
+}
+
+time_t pcdvobjs_timezone_mktime(const char *timezone, struct tm *tm)
+{
+    if (timezone) {
+        bool valid;
+        struct cached_timezone *tz = find_timezone(timezone, &valid);
+#if USE_TIMEZONE_RULES
+        if (tz && tz->has_rules) {
+            int64_t y = tm->tm_year + 1900LL + floor_div(tm->tm_mon, 12);
+            int mon = (int)(tm->tm_mon - floor_div(tm->tm_mon, 12) * 12);
+            int64_t local = (days_from_civil(y, mon + 1, 1) + tm->tm_mday - 1)
+                * SECS_PER_DAY + tm->tm_hour * (int64_t)SECS_PER_HOUR +
+                tm->tm_min * 60 + tm->tm_sec;
+
+            /* two rounds are enough to settle the offset */
+            const struct tz_type *type = find_type(tz, local);
+            type = find_type(tz, local - type->utoff);
+            int64_t t = local - type->utoff;
+            type = find_type(tz, t);
+
+            if (tm->tm_isdst >= 0 && type->isdst != (tm->tm_isdst > 0)) {
+                /* like mktime(), take the local time as the one with the
+                   daylight saving time given */
+                const struct tz_type *other = find_other_type(tz, t);
+                if (other)
+                    t = local - other->utoff;
+            }
+
+            break_down(find_type(tz, t), t, tm);
+            return (time_t)t;
+        }
+#else
+        UNUSED_PARAM(tz);
+#endif
+    }
+
+    char *tz_old = pcdvobjs_timezone_set(timezone);
+    time_t t = mktime(tm);
+    pcdvobjs_timezone_restore(tz_old);
+    return t;
+}
+
+void pcdvobjs_timezone_init_instance(struct pcinst *inst)
+{
+    list_head_init(&inst->timezones);
+    inst->nr_timezones = 0;
+    inst->nr_timezone_hits = 0;
+    inst->nr_timezone_misses = 0;
+}
+
+void pcdvobjs_timezone_cleanup_instance(struct pcinst *inst)
+{
+    if (inst->timezones.next == NULL)
+        return;
+
+    PC_DEBUG("Timezones got from the cache: %u hits, %u misses\n",
+            (unsigned)inst->nr_timezone_hits,
+            (unsigned)inst->nr_timezone_misses);
+
+    struct cached_timezone *tz, *tmp;
+    list_for_each_entry_safe(tz, tmp, &inst->timezones, ln) {
+        uncache_timezone(inst, tz);
+    }
+    inst->timezones.next = inst->timezones.prev = NULL;
+}
@@ -42,6 +42,12 @@
 #include <stdlib.h>
 #endif
 
+#if CPU(X86_SSE2)
+#include <emmintrin.h>
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
 #define ERROR_BUF_SIZE  100
 #define NR_CONSUMED_LIST_LIMIT   10
 
@@ -478,3 +484,1277 @@ int pcejson_set_state_param_string(struct pcejson *parser)
     return pcejson_set_state(parser, EJSON_TKZ_STATE_PARAM_STRING);
 }
 
+
+/*
+ * The direct builder for plain JSON.
+ *
+ * NOTE: the builder never reports an error; when it meets anything it
+ * does not handle (expressions, eJSON extensions, or malformed texts),
+ * it gives up and the caller falls back to the full parser, which will
+ * produce either the result or the error.
+ */
+struct plain_builder {
+    const char     *p;
+    const char     *end;
+    uint32_t        depth;
+    uint32_t        max_depth;
+
+    /* the buffer for unescaping strings */
+    struct pcutils_mystring scratch;
+};
+
+static purc_variant_t
+plain_value(struct plain_builder *bld);
+
+static inline bool
+plain_is_ws(unsigned char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/*
+ * Returns the length of the leading run of whitespaces in `str`. The SIMD
+ * paths check 16 bytes at a time; the tail (and the whole text on other
+ * CPUs) is checked byte by byte.
+ */
+static size_t
+plain_ws_run(const unsigned char *str, size_t len)
+{
+    size_t pos = 0;
+
+    /* NOTE: most runs are a single space or a short indentation */
+    if (len == 0 || !plain_is_ws(str[0]))
+        return 0;
+
+#if CPU(X86_SSE2)
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i ht = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + pos));
+        __m128i m = _mm_cmpeq_epi8(v, sp);
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, ht));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, lf));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, cr));
+
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(m) & 0xFFFF;
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+    const uint8x16_t sp = vdupq_n_u8(' ');
+    const uint8x16_t ht = vdupq_n_u8('\t');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    const uint8x16_t cr = vdupq_n_u8('\r');
+
+    for (; pos + 16 <= len; pos += 16) {
+        uint8x16_t v = vld1q_u8(str + pos);
+        uint8x16_t m = vceqq_u8(v, sp);
+        m = vorrq_u8(m, vceqq_u8(v, ht));
+        m = vorrq_u8(m, vceqq_u8(v, lf));
+        m = vorrq_u8(m, vceqq_u8(v, cr));
+
+        if (vminvq_u8(m) == 0)
+            break;      /* locate the byte in the scalar loop below */
+    }
+#endif
+
+    for (; pos < len; pos++) {
+        if (!plain_is_ws(str[pos]))
+            break;
+    }
+
+    return pos;
+}
+
+static inline void
+plain_skip_ws(struct plain_builder *bld)
+{
+    bld->p += plain_ws_run((const unsigned char *)bld->p, bld->end - bld->p);
+}
+
+static inline bool
+plain_is_special(unsigned char c)
+{
+    /* `$` may start an expression in a double-quoted string */
+    return c == '"' || c == '\\' || c == '$' || c < 0x20;
+}
+
+/*
+ * Returns the length of the leading run of ordinary bytes in the body of
+ * a string, i.e., not a quote, a backslash, a `$`, or a control character.
+ * Clears `ascii` if there is any non-ASCII byte in the run.
+ */
+static size_t
+plain_string_run(const unsigned char *str, size_t len, bool *ascii)
+{
+    size_t pos = 0;
+
+#if CPU(X86_SSE2)
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i dollar = _mm_set1_epi8('$');
+
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + pos));
+        /* v <= 0x1F (unsigned) iff min(v, 0x1F) == v */
+        __m128i m = _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl), v);
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, quote));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, bslash));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, dollar));
+
+        unsigned mask = (unsigned)_mm_movemask_epi8(m);
+        unsigned high = (unsigned)_mm_movemask_epi8(v);
+        if (mask) {
+            unsigned n = __builtin_ctz(mask);
+            if (high & ((1U << n) - 1))
+                *ascii = false;
+            return pos + n;
+        }
+
+        if (high)
+            *ascii = false;
+    }
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+    const uint8x16_t ctrl = vdupq_n_u8(0x20);
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t bslash = vdupq_n_u8('\\');
+    const uint8x16_t dollar = vdupq_n_u8('$');
+
+    for (; pos + 16 <= len; pos += 16) {
+        uint8x16_t v = vld1q_u8(str + pos);
+        uint8x16_t m = vcltq_u8(v, ctrl);
+        m = vorrq_u8(m, vceqq_u8(v, quote));
+        m = vorrq_u8(m, vceqq_u8(v, bslash));
+        m = vorrq_u8(m, vceqq_u8(v, dollar));
+
+        if (vmaxvq_u8(m))
+            break;      /* locate the byte in the scalar loop below */
+
+        if (vmaxvq_u8(v) >= 0x80)
+            *ascii = false;
+    }
+#endif
+
+    for (; pos < len; pos++) {
+        if (plain_is_special(str[pos]))
+            break;
+        if (str[pos] >= 0x80)
+            *ascii = false;
+    }
+
+    return pos;
+}
+
+/* a number or a keyword must be followed by one of these characters */
+static inline bool
+plain_is_delimiter(struct plain_builder *bld)
+{
+    if (bld->p >= bld->end)
+        return true;
+
+    switch (*bld->p) {
+    case ' ': case '\t': case '\n': case '\r':
+    case ',': case ']': case '}': case '\0':
+        return true;
+    }
+
+    return false;
+}
+
+static int
+plain_hex4(const char *p, uint32_t *uc)
+{
+    *uc = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        *uc <<= 4;
+        if (is_ascii_digit(c))
+            *uc += c - '0';
+        else if (is_ascii_upper_hex_digit(c))
+            *uc += c - 'A' + 10;
+        else if (is_ascii_lower_hex_digit(c))
+            *uc += c - 'a' + 10;
+        else
+            return -1;
+    }
+
+    return 0;
+}
+
+static purc_variant_t
+plain_string(struct plain_builder *bld)
+{
+    const char *start = ++bld->p;   // skip the opening quote
+    const char *run = start;
+    bool escaped = false;
+    bool ascii = true;
+
+    bld->scratch.nr_bytes = 0;
+    while (bld->p < bld->end) {
+        bld->p += plain_string_run((const unsigned char *)bld->p,
+                bld->end - bld->p, &ascii);
+        if (bld->p >= bld->end)
+            break;
+
+        unsigned char c = *bld->p;
+        if (c == '"')
+            break;
+
+        if (c != '\\')
+            return PURC_VARIANT_INVALID;
+
+        if (pcutils_mystring_append_mchar(&bld->scratch,
+                    (const unsigned char *)run, bld->p - run))
+            return PURC_VARIANT_INVALID;
+
+        if (++bld->p >= bld->end)
+            return PURC_VARIANT_INVALID;
+
+        uint32_t uc;
+        switch (*bld->p) {
+        case '"':
+        case '\\':
+        case '/':
+            uc = *bld->p;
+            break;
+        case 'b':
+            uc = '\b';
+            break;
+        case 'f':
+            uc = '\f';
+            break;
+        case 'n':
+            uc = '\n';
+            break;
+        case 'r':
+            uc = '\r';
+            break;
+        case 't':
+            uc = '\t';
+            break;
+        case 'u':
+            if (bld->end - bld->p < 5 || plain_hex4(bld->p + 1, &uc) ||
+                    uc == 0 || (uc & 0xFFFFF800) == 0xD800)
+                return PURC_VARIANT_INVALID;
+            bld->p += 4;
+            break;
+        default:
+            return PURC_VARIANT_INVALID;
+        }
+
+        if (pcutils_mystring_append_uchar(&bld->scratch, uc, 1))
+            return PURC_VARIANT_INVALID;
+
+        run = ++bld->p;
+        escaped = true;
+    }
+
+    if (bld->p >= bld->end)
+        return PURC_VARIANT_INVALID;
+
+    const char *str = start;
+    size_t len = bld->p - start;
+    if (escaped) {
+        if (pcutils_mystring_append_mchar(&bld->scratch,
+                    (const unsigned char *)run, bld->p - run))
+            return PURC_VARIANT_INVALID;
+        str = bld->scratch.buff;
+        len = bld->scratch.nr_bytes;
+    }
+    bld->p++;   // skip the closing quote
+
+    if (!ascii && !pcutils_string_check_utf8_len(str, len, NULL, NULL))
+        return PURC_VARIANT_INVALID;
+
+    return purc_variant_make_string_ex(str, len, false);
+}
+
+static purc_variant_t
+plain_number(struct plain_builder *bld)
+{
+    const char *start = bld->p;
+
+    if (*bld->p == '-')
+        bld->p++;
+
+    if (bld->p < bld->end && *bld->p == '0') {
+        bld->p++;
+    }
+    else if (bld->p < bld->end && is_ascii_digit(*bld->p)) {
+        while (bld->p < bld->end && is_ascii_digit(*bld->p))
+            bld->p++;
+    }
+    else {
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (bld->p < bld->end && *bld->p == '.') {
+        bld->p++;
+        if (bld->p >= bld->end || !is_ascii_digit(*bld->p))
+            return PURC_VARIANT_INVALID;
+        while (bld->p < bld->end && is_ascii_digit(*bld->p))
+            bld->p++;
+    }
+
+    if (bld->p < bld->end && (*bld->p == 'e' || *bld->p == 'E')) {
+        bld->p++;
+        if (bld->p < bld->end && (*bld->p == '+' || *bld->p == '-'))
+            bld->p++;
+        if (bld->p >= bld->end || !is_ascii_digit(*bld->p))
+            return PURC_VARIANT_INVALID;
+        while (bld->p < bld->end && is_ascii_digit(*bld->p))
+            bld->p++;
+    }
+
+    /* eJSON suffixes like `L` and `UL` are left to the full parser */
+    if (!plain_is_delimiter(bld))
+        return PURC_VARIANT_INVALID;
+
+    /* pcutils_strtod() needs a null-terminated string */
+    bld->scratch.nr_bytes = 0;
+    if (pcutils_mystring_append_mchar(&bld->scratch,
+                (const unsigned char *)start, bld->p - start) ||
+            pcutils_mystring_append_mchar(&bld->scratch,
+                (const unsigned char *)"", 1))
+        return PURC_VARIANT_INVALID;
+
+    return purc_variant_make_number(pcutils_strtod(bld->scratch.buff, NULL));
+}
+
+static purc_variant_t
+plain_keyword(struct plain_builder *bld, const char *keyword, size_t len)
+{
+    if ((size_t)(bld->end - bld->p) < len || memcmp(bld->p, keyword, len))
+        return PURC_VARIANT_INVALID;
+
+    bld->p += len;
+    if (!plain_is_delimiter(bld))
+        return PURC_VARIANT_INVALID;
+
+    if (keyword[0] == 'n')
+        return purc_variant_make_null();
+    return purc_variant_make_boolean(keyword[0] == 't');
+}
+
+static purc_variant_t
+plain_array(struct plain_builder *bld)
+{
+    if (++bld->depth > bld->max_depth)
+        return PURC_VARIANT_INVALID;
+
+    bld->p++;   // skip `[`
+    purc_variant_t array = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+    if (array == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    plain_skip_ws(bld);
+    if (bld->p < bld->end && *bld->p == ']') {
+        bld->p++;
+        goto done;
+    }
+
+    while (true) {
+        purc_variant_t v = plain_value(bld);
+        if (v == PURC_VARIANT_INVALID)
+            goto failed;
+
+        bool ok = purc_variant_array_append(array, v);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
+
+        plain_skip_ws(bld);
+        if (bld->p >= bld->end)
+            goto failed;
+        if (*bld->p == ']') {
+            bld->p++;
+            break;
+        }
+        if (*bld->p != ',')
+            goto failed;
+        bld->p++;
+    }
+
+done:
+    bld->depth--;
+    return array;
+
+failed:
+    purc_variant_unref(array);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+plain_object(struct plain_builder *bld)
+{
+    if (++bld->depth > bld->max_depth)
+        return PURC_VARIANT_INVALID;
+
+    bld->p++;   // skip `{`
+    purc_variant_t object = purc_variant_make_object(0,
+            PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+    if (object == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    plain_skip_ws(bld);
+    if (bld->p < bld->end && *bld->p == '}') {
+        bld->p++;
+        goto done;
+    }
+
+    while (true) {
+        plain_skip_ws(bld);
+        if (bld->p >= bld->end || *bld->p != '"')
+            goto failed;
+
+        purc_variant_t k = plain_string(bld);
+        if (k == PURC_VARIANT_INVALID)
+            goto failed;
+
+        plain_skip_ws(bld);
+        if (bld->p >= bld->end || *bld->p != ':') {
+            purc_variant_unref(k);
+            goto failed;
+        }
+        bld->p++;
+
+        purc_variant_t v = plain_value(bld);
+        if (v == PURC_VARIANT_INVALID) {
+            purc_variant_unref(k);
+            goto failed;
+        }
+
+        bool ok = purc_variant_object_set(object, k, v);
+        purc_variant_unref(k);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
+
+        plain_skip_ws(bld);
+        if (bld->p >= bld->end)
+            goto failed;
+        if (*bld->p == '}') {
+            bld->p++;
+            break;
+        }
+        if (*bld->p != ',')
+            goto failed;
+        bld->p++;
+    }
+
+done:
+    bld->depth--;
+    return object;
+
+failed:
+    purc_variant_unref(object);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+plain_value(struct plain_builder *bld)
+{
+    plain_skip_ws(bld);
+    if (bld->p >= bld->end)
+        return PURC_VARIANT_INVALID;
+
+    switch (*bld->p) {
+    case '{':
+        return plain_object(bld);
+    case '[':
+        return plain_array(bld);
+    case '"':
+        return plain_string(bld);
+    case 't':
+        return plain_keyword(bld, "true", 4);
+    case 'f':
+        return plain_keyword(bld, "false", 5);
+    case 'n':
+        return plain_keyword(bld, "null", 4);
+    default:
+        if (*bld->p == '-' || is_ascii_digit(*bld->p))
+            return plain_number(bld);
+        break;
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
+int pcejson_parse_plain(purc_variant_t *value, const char *json, size_t sz,
+        uint32_t depth)
+{
+    struct plain_builder bld = { json, json + sz, 0, depth, { NULL, 0, 0 } };
+
+    *value = plain_value(&bld);
+    if (*value != PURC_VARIANT_INVALID) {
+        plain_skip_ws(&bld);
+        if (bld.p < bld.end && *bld.p != '\0') {
+            purc_variant_unref(*value);
+            *value = PURC_VARIANT_INVALID;
+        }
+    }
+
+    pcutils_mystring_free(&bld.scratch);
+    return (*value == PURC_VARIANT_INVALID) ? -1 : 0;
+}
+
+/*
+ * The event-based (SAX-style) parser for plain JSON.
+ *
+ * Unlike the direct builder, the parser keeps all of its state in
+ * `struct pcejson_sax`, so the input can be fed in arbitrary pieces.
+ */
+enum {
+    SAX_VALUE = 0,          // expecting a value
+    SAX_VALUE_OR_END,       // expecting a value or `]` (just after `[`)
+    SAX_KEY,                // expecting a key (just after `,`)
+    SAX_KEY_OR_END,         // expecting a key or `}` (just after `{`)
+    SAX_COLON,
+    SAX_AFTER_VALUE,        // expecting `,`, `]`, or `}`
+    SAX_STRING,
+    SAX_STRING_ESCAPE,
+    SAX_STRING_UNICODE,
+    SAX_NUMBER,
+    SAX_KEYWORD,
+    SAX_DONE,               // the single top-level value is done
+    SAX_FAILED,
+};
+
+struct pcejson_sax {
+    const struct pcejson_sax_handlers *handlers;
+    void           *ctxt;
+    unsigned        flags;
+
+    int             state;
+    uint32_t        depth;
+    uint32_t        max_depth;
+    char           *containers;     // `{` or `[` for every level
+
+    /* the token being parsed */
+    struct pcutils_mystring token;
+    bool            is_key;
+    bool            ascii;
+    unsigned        nr_hex;
+    uint32_t        uc;
+    uint32_t        high_surrogate;
+    const char     *keyword;
+    unsigned        kw_pos;
+
+    /* a top-level value is done on the current line (FLAG_LINES) */
+    bool            line_done;
+};
+
+struct pcejson_sax *
+pcejson_sax_new(const struct pcejson_sax_handlers *handlers, void *ctxt,
+        uint32_t depth, unsigned flags)
+{
+    struct pcejson_sax *sax = calloc(1, sizeof(*sax));
+    if (sax == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    sax->containers = malloc(depth ? depth : 1);
+    if (sax->containers == NULL) {
+        free(sax);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    if (flags & PCEJSON_SAX_FLAG_LINES)
+        flags |= PCEJSON_SAX_FLAG_MULTIPLE;
+
+    sax->handlers = handlers;
+    sax->ctxt = ctxt;
+    sax->flags = flags;
+    sax->max_depth = depth;
+    sax->state = SAX_VALUE;
+    pcutils_mystring_init(&sax->token);
+    return sax;
+}
+
+void pcejson_sax_delete(struct pcejson_sax *sax)
+{
+    pcutils_mystring_free(&sax->token);
+    free(sax->containers);
+    free(sax);
+}
+
+static inline int
+sax_fail(struct pcejson_sax *sax, int err)
+{
+    sax->state = SAX_FAILED;
+    purc_set_error(err);
+    return -1;
+}
+
+static inline void
+sax_after_value(struct pcejson_sax *sax)
+{
+    if (sax->depth > 0) {
+        sax->state = SAX_AFTER_VALUE;
+    }
+    else if (sax->flags & PCEJSON_SAX_FLAG_MULTIPLE) {
+        sax->state = SAX_VALUE;
+        sax->line_done = true;
+    }
+    else {
+        sax->state = SAX_DONE;
+    }
+}
+
+/* skips the whitespaces; a record must not span lines in FLAG_LINES */
+static const char *
+sax_skip_ws(struct pcejson_sax *sax, const char *p, const char *end)
+{
+    size_t n = plain_ws_run((const unsigned char *)p, end - p);
+
+    if ((sax->flags & PCEJSON_SAX_FLAG_LINES) && memchr(p, '\n', n)) {
+        if (sax->depth > 0) {
+            sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_CHARACTER);
+            return NULL;
+        }
+        sax->line_done = false;
+    }
+
+    return p + n;
+}
+
+static int
+sax_emit_value(struct pcejson_sax *sax, purc_variant_t v)
+{
+    if (v == PURC_VARIANT_INVALID)
+        return sax_fail(sax, PURC_ERROR_OUT_OF_MEMORY);
+
+    sax_after_value(sax);
+
+    int r = 0;
+    if (sax->handlers->value)
+        r = sax->handlers->value(sax->ctxt, v);
+    purc_variant_unref(v);
+
+    if (r < 0)
+        sax->state = SAX_FAILED;
+    return r;
+}
+
+static int
+sax_open(struct pcejson_sax *sax, char kind)
+{
+    if (sax->depth >= sax->max_depth)
+        return sax_fail(sax, PCEJSON_ERROR_MAX_DEPTH_EXCEEDED);
+
+    sax->containers[sax->depth++] = kind;
+
+    int r = 0;
+    if (kind == '{') {
+        sax->state = SAX_KEY_OR_END;
+        if (sax->handlers->start_object)
+            r = sax->handlers->start_object(sax->ctxt);
+    }
+    else {
+        sax->state = SAX_VALUE_OR_END;
+        if (sax->handlers->start_array)
+            r = sax->handlers->start_array(sax->ctxt);
+    }
+
+    if (r < 0)
+        sax->state = SAX_FAILED;
+    return r;
+}
+
+static int
+sax_close(struct pcejson_sax *sax, char kind)
+{
+    if (sax->depth == 0 || sax->containers[sax->depth - 1] != kind)
+        return sax_fail(sax, kind == '{' ?
+                PCEJSON_ERROR_UNEXPECTED_RIGHT_BRACE :
+                PCEJSON_ERROR_UNEXPECTED_RIGHT_BRACKET);
+
+    sax->depth--;
+    sax_after_value(sax);
+
+    int r = 0;
+    if (kind == '{') {
+        if (sax->handlers->end_object)
+            r = sax->handlers->end_object(sax->ctxt);
+    }
+    else {
+        if (sax->handlers->end_array)
+            r = sax->handlers->end_array(sax->ctxt);
+    }
+
+    if (r < 0)
+        sax->state = SAX_FAILED;
+    return r;
+}
+
+static int
+sax_begin_value(struct pcejson_sax *sax, char c)
+{
+    sax->token.nr_bytes = 0;
+
+    switch (c) {
+    case '{':
+    case '[':
+        return sax_open(sax, c);
+
+    case '"':
+        sax->state = SAX_STRING;
+        sax->is_key = false;
+        sax->ascii = true;
+        return 0;
+
+    case 't':
+        sax->keyword = "true";
+        break;
+    case 'f':
+        sax->keyword = "false";
+        break;
+    case 'n':
+        sax->keyword = "null";
+        break;
+
+    default:
+        if (c == '-' || is_ascii_digit(c)) {
+            if (pcutils_mystring_append_mchar(&sax->token,
+                        (const unsigned char *)&c, 1))
+                return sax_fail(sax, PURC_ERROR_OUT_OF_MEMORY);
+            sax->state = SAX_NUMBER;
+            return 0;
+        }
+        return sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_CHARACTER);
+    }
+
+    sax->kw_pos = 1;
+    sax->state = SAX_KEYWORD;
+    return 0;
+}
+
+static int
+sax_end_string(struct pcejson_sax *sax)
+{
+    const char *str = sax->token.buff ? sax->token.buff : "";
+    size_t len = sax->token.nr_bytes;
+
+    if (sax->high_surrogate ||
+            (!sax->ascii && !pcutils_string_check_utf8_len(str, len,
+                NULL, NULL)))
+        return sax_fail(sax, PCEJSON_ERROR_BAD_JSON);
+
+    if (!sax->is_key)
+        return sax_emit_value(sax, purc_variant_make_string_ex(str, len,
+                    false));
+
+    sax->state = SAX_COLON;
+
+    int r = 0;
+    if (sax->handlers->key)
+        r = sax->handlers->key(sax->ctxt, str, len);
+    if (r < 0)
+        sax->state = SAX_FAILED;
+    return r;
+}
+
+/* checks the grammar of a JSON number */
+static bool
+sax_is_number(const char *s, const char *end)
+{
+    if (s < end && *s == '-')
+        s++;
+
+    if (s < end && *s == '0')
+        s++;
+    else if (s < end && is_ascii_digit(*s))
+        while (s < end && is_ascii_digit(*s))
+            s++;
+    else
+        return false;
+
+    if (s < end && *s == '.') {
+        if (++s >= end || !is_ascii_digit(*s))
+            return false;
+        while (s < end && is_ascii_digit(*s))
+            s++;
+    }
+
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        if (++s < end && (*s == '+' || *s == '-'))
+            s++;
+        if (s >= end || !is_ascii_digit(*s))
+            return false;
+        while (s < end && is_ascii_digit(*s))
+            s++;
+    }
+
+    return s == end;
+}
+
+static int
+sax_end_number(struct pcejson_sax *sax)
+{
+    const char *s = sax->token.buff;
+    if (!sax_is_number(s, s + sax->token.nr_bytes))
+        return sax_fail(sax, PCEJSON_ERROR_BAD_JSON_NUMBER);
+
+    /* pcutils_strtod() needs a null-terminated string */
+    if (pcutils_mystring_append_mchar(&sax->token,
+                (const unsigned char *)"", 1))
+        return sax_fail(sax, PURC_ERROR_OUT_OF_MEMORY);
+
+    double d = pcutils_strtod(sax->token.buff, NULL);
+    return sax_emit_value(sax, purc_variant_make_number(d));
+}
+
+static int
+sax_end_unicode(struct pcejson_sax *sax)
+{
+    uint32_t uc = sax->uc;
+
+    if (sax->high_surrogate) {
+        if (uc < 0xDC00 || uc > 0xDFFF)
+            return sax_fail(sax, PCEJSON_ERROR_BAD_JSON_STRING_ESCAPE_ENTITY);
+        uc = 0x10000 + ((sax->high_surrogate - 0xD800) << 10) +
+            (uc - 0xDC00);
+        sax->high_surrogate = 0;
+    }
+    else if (uc >= 0xD800 && uc <= 0xDBFF) {
+        sax->high_surrogate = uc;
+        sax->state = SAX_STRING;
+        return 0;
+    }
+    else if (uc == 0 || (uc >= 0xDC00 && uc <= 0xDFFF)) {
+        return sax_fail(sax, PCEJSON_ERROR_BAD_JSON_STRING_ESCAPE_ENTITY);
+    }
+
+    if (pcutils_mystring_append_uchar(&sax->token, uc, 1))
+        return sax_fail(sax, PURC_ERROR_OUT_OF_MEMORY);
+
+    sax->ascii = false;
+    sax->state = SAX_STRING;
+    return 0;
+}
+
+static int
+sax_escape(struct pcejson_sax *sax, char c)
+{
+    /* a high surrogate must be followed by the escaped low one */
+    if (sax->high_surrogate && c != 'u')
+        return sax_fail(sax, PCEJSON_ERROR_BAD_JSON_STRING_ESCAPE_ENTITY);
+
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+        break;
+    case 'b':
+        c = '\b';
+        break;
+    case 'f':
+        c = '\f';
+        break;
+    case 'n':
+        c = '\n';
+        break;
+    case 'r':
+        c = '\r';
+        break;
+    case 't':
+        c = '\t';
+        break;
+    case 'u':
+        sax->nr_hex = 0;
+        sax->uc = 0;
+        sax->state = SAX_STRING_UNICODE;
+        return 0;
+    default:
+        return sax_fail(sax, PCEJSON_ERROR_BAD_JSON_STRING_ESCAPE_ENTITY);
+    }
+
+    if (pcutils_mystring_append_mchar(&sax->token,
+                (const unsigned char *)&c, 1))
+        return sax_fail(sax, PURC_ERROR_OUT_OF_MEMORY);
+
+    sax->state = SAX_STRING;
+    return 0;
+}
+
+ssize_t pcejson_sax_feed(struct pcejson_sax *sax, const char *buf, size_t len)
+{
+    const char *p = buf;
+    const char *end = buf + len;
+    int r = 0;
+
+    while (p < end && r == 0) {
+        char c = *p;
+
+        switch (sax->state) {
+        case SAX_FAILED:
+            return -1;
+
+        case SAX_DONE:
+            if (!plain_is_ws(c))
+                return sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_CHARACTER);
+            p = sax_skip_ws(sax, p, end);
+            break;
+
+        case SAX_VALUE:
+        case SAX_VALUE_OR_END:
+            if (plain_is_ws(c)) {
+                if ((p = sax_skip_ws(sax, p, end)) == NULL)
+                    return -1;
+            }
+            else if (c == ']' && sax->state == SAX_VALUE_OR_END) {
+                p++;
+                r = sax_close(sax, '[');
+            }
+            else if (sax->depth == 0 && sax->line_done &&
+                    (sax->flags & PCEJSON_SAX_FLAG_LINES)) {
+                /* only one record on a line */
+                return sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_CHARACTER);
+            }
+            else {
+                p++;
+                r = sax_begin_value(sax, c);
+            }
+            break;
+
+        case SAX_KEY:
+        case SAX_KEY_OR_END:
+            if (plain_is_ws(c)) {
+                if ((p = sax_skip_ws(sax, p, end)) == NULL)
+                    return -1;
+            }
+            else if (c == '}' && sax->state == SAX_KEY_OR_END) {
+                p++;
+                r = sax_close(sax, '{');
+            }
+            else if (c == '"') {
+                p++;
+                sax->token.nr_bytes = 0;
+                sax->is_key = true;
+                sax->ascii = true;
+                sax->state = SAX_STRING;
+            }
+            else {
+                return sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_JSON_KEY_NAME);
+            }
+            break;
+
+        case SAX_COLON:
+            if (plain_is_ws(c)) {
+                if ((p = sax_skip_ws(sax, p, end)) == NULL)
+                    return -1;
+            }
+            else if (c == ':') {
+                p++;
+                sax->state = SAX_VALUE;
+            }
+            else {
+                return sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_CHARACTER);
+            }
+            break;
+
+        case SAX_AFTER_VALUE:
+            if (plain_is_ws(c)) {
+                if ((p = sax_skip_ws(sax, p, end)) == NULL)
+                    return -1;
+            }
+            else if (c == ',') {
+                p++;
+                sax->state = (sax->containers[sax->depth - 1] == '{') ?
+                    SAX_KEY : SAX_VALUE;
+            }
+            else if (c == ']' || c == '}') {
+                p++;
+                r = sax_close(sax, c == ']' ? '[' : '{');
+            }
+            else {
+                return sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_CHARACTER);
+            }
+            break;
+
+        case SAX_STRING: {
+            size_t n = 0;
+            if (!sax->high_surrogate)
+                n = plain_string_run((const unsigned char *)p, end - p,
+                        &sax->ascii);
+            if (n > 0) {
+                if (pcutils_mystring_append_mchar(&sax->token,
+                            (const unsigned char *)p, n))
+                    return sax_fail(sax, PURC_ERROR_OUT_OF_MEMORY);
+                p += n;
+                break;
+            }
+
+            p++;
+            if (sax->high_surrogate && c != '\\')
+                return sax_fail(sax,
+                        PCEJSON_ERROR_BAD_JSON_STRING_ESCAPE_ENTITY);
+
+            if (c == '"') {
+                r = sax_end_string(sax);
+            }
+            else if (c == '\\') {
+                sax->state = SAX_STRING_ESCAPE;
+            }
+            else if (c == '$') {
+                /* no expression in the texts fed to the SAX parser */
+                if (pcutils_mystring_append_mchar(&sax->token,
+                            (const unsigned char *)&c, 1))
+                    return sax_fail(sax, PURC_ERROR_OUT_OF_MEMORY);
+            }
+            else {
+                return sax_fail(sax, PCEJSON_ERROR_BAD_JSON);
+            }
+            break;
+        }
+
+        case SAX_STRING_ESCAPE:
+            p++;
+            r = sax_escape(sax, c);
+            break;
+
+        case SAX_STRING_UNICODE:
+            p++;
+            if (is_ascii_digit(c))
+                sax->uc = (sax->uc << 4) + (c - '0');
+            else if (c >= 'A' && c <= 'F')
+                sax->uc = (sax->uc << 4) + (c - 'A' + 10);
+            else if (c >= 'a' && c <= 'f')
+                sax->uc = (sax->uc << 4) + (c - 'a' + 10);
+            else
+                return sax_fail(sax,
+                        PCEJSON_ERROR_BAD_JSON_STRING_ESCAPE_ENTITY);
+
+            if (++sax->nr_hex == 4)
+                r = sax_end_unicode(sax);
+            break;
+
+        case SAX_NUMBER:
+            if (is_ascii_digit(c) || c == '.' || c == 'e' || c == 'E' ||
+                    c == '+' || c == '-') {
+                if (pcutils_mystring_append_mchar(&sax->token,
+                            (const unsigned char *)&c, 1))
+                    return sax_fail(sax, PURC_ERROR_OUT_OF_MEMORY);
+                p++;
+            }
+            else {
+                /* leave the delimiter to the next state */
+                r = sax_end_number(sax);
+            }
+            break;
+
+        case SAX_KEYWORD:
+            if (c != sax->keyword[sax->kw_pos])
+                return sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_JSON_KEYWORD);
+
+            p++;
+            if (sax->keyword[++sax->kw_pos] == '\0') {
+                if (sax->keyword[0] == 'n')
+                    r = sax_emit_value(sax, purc_variant_make_null());
+                else
+                    r = sax_emit_value(sax,
+                            purc_variant_make_boolean(sax->keyword[0] == 't'));
+            }
+            break;
+        }
+    }
+
+    if (r < 0)
+        return -1;
+    return p - buf;
+}
+
+int pcejson_sax_end(struct pcejson_sax *sax)
+{
+    if (sax->state == SAX_NUMBER && sax_end_number(sax) < 0)
+        return -1;
+
+    if (sax->state == SAX_FAILED)
+        return -1;
+
+    if (sax->state == SAX_DONE ||
+            (sax->state == SAX_VALUE && sax->depth == 0 &&
+             (sax->flags & PCEJSON_SAX_FLAG_MULTIPLE)))
+        return 0;
+
+    return sax_fail(sax, PCEJSON_ERROR_UNEXPECTED_EOF);
+}
+
+/*
+ * The builder of a variant from a plain JSON text fed in parts. It is
+ * driven by the events of the SAX parser, so only the containers being
+ * built are kept, never the text.
+ */
+struct pcejson_builder {
+    struct pcejson_sax *sax;
+
+    purc_variant_t  result;
+
+    /* the containers being built and the pending keys of objects */
+    uint32_t        depth;
+    purc_variant_t *containers;
+    purc_variant_t *keys;
+
+    /* the error met when fed, reported again by the end */
+    int             err;
+};
+
+static int builder_add(struct pcejson_builder *bld, purc_variant_t v)
+{
+    if (bld->depth == 0) {
+        bld->result = purc_variant_ref(v);
+        return 0;
+    }
+
+    uint32_t level = bld->depth - 1;
+    purc_variant_t parent = bld->containers[level];
+    if (purc_variant_is_object(parent)) {
+        bool ok = purc_variant_object_set(parent, bld->keys[level], v);
+        purc_variant_unref(bld->keys[level]);
+        bld->keys[level] = PURC_VARIANT_INVALID;
+        return ok ? 0 : -1;
+    }
+
+    return purc_variant_array_append(parent, v) ? 0 : -1;
+}
+
+static int builder_start(struct pcejson_builder *bld,
+        purc_variant_t container)
+{
+    if (container == PURC_VARIANT_INVALID)
+        return -1;
+
+    /* the SAX parser has checked the depth */
+    bld->containers[bld->depth++] = container;
+    return 0;
+}
+
+static int on_builder_start_object(void *ctxt)
+{
+    return builder_start(ctxt, purc_variant_make_object_0());
+}
+
+static int on_builder_start_array(void *ctxt)
+{
+    return builder_start(ctxt, purc_variant_make_array_0());
+}
+
+static int on_builder_end(void *ctxt)
+{
+    struct pcejson_builder *bld = ctxt;
+    purc_variant_t container = bld->containers[--bld->depth];
+    bld->containers[bld->depth] = PURC_VARIANT_INVALID;
+
+    int r = builder_add(bld, container);
+    purc_variant_unref(container);
+    return r;
+}
+
+static int on_builder_key(void *ctxt, const char *key, size_t len)
+{
+    struct pcejson_builder *bld = ctxt;
+    purc_variant_t k = purc_variant_make_string_ex(key, len, false);
+    if (k == PURC_VARIANT_INVALID)
+        return -1;
+
+    bld->keys[bld->depth - 1] = k;
+    return 0;
+}
+
+static int on_builder_value(void *ctxt, purc_variant_t value)
+{
+    return builder_add(ctxt, value);
+}
+
+static const struct pcejson_sax_handlers builder_handlers = {
+    on_builder_start_object,
+    on_builder_end,
+    on_builder_start_array,
+    on_builder_end,
+    on_builder_key,
+    on_builder_value,
+};
+
+struct pcejson_builder *
+pcejson_builder_new(uint32_t depth)
+{
+    struct pcejson_builder *bld = calloc(1, sizeof(*bld));
+    if (bld == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    bld->containers = calloc(depth ? depth : 1, sizeof(purc_variant_t));
+    bld->keys = calloc(depth ? depth : 1, sizeof(purc_variant_t));
+    if (bld->containers == NULL || bld->keys == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    bld->sax = pcejson_sax_new(&builder_handlers, bld, depth, 0);
+    if (bld->sax == NULL)
+        goto failed;
+
+    return bld;
+
+failed:
+    free(bld->containers);
+    free(bld->keys);
+    free(bld);
+    return NULL;
+}
+
+void pcejson_builder_delete(struct pcejson_builder *bld)
+{
+    for (uint32_t i = 0; i < bld->depth; i++) {
+        if (bld->containers[i])
+            purc_variant_unref(bld->containers[i]);
+        if (bld->keys[i])
+            purc_variant_unref(bld->keys[i]);
+    }
+
+    if (bld->result)
+        purc_variant_unref(bld->result);
+
+    pcejson_sax_delete(bld->sax);
+    free(bld->containers);
+    free(bld->keys);
+    free(bld);
+}
+
+int pcejson_builder_feed(struct pcejson_builder *bld,
+        const char *buf, size_t len)
+{
+    if (bld->err)
+        return -1;
+
+    /* no handler suspends the parsing, so all bytes are consumed */
+    if (pcejson_sax_feed(bld->sax, buf, len) < 0) {
+        bld->err = purc_get_last_error();
+        if (bld->err == PURC_ERROR_OK)
+            bld->err = PURC_ERROR_INVALID_VALUE;
+        return -1;
+    }
+    return 0;
+}
+
+purc_variant_t pcejson_builder_end(struct pcejson_builder *bld)
+{
+    if (bld->err) {
+        purc_set_error(bld->err);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (pcejson_sax_end(bld->sax) < 0)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t result = bld->result;
+    bld->result = PURC_VARIANT_INVALID;
+    return result;
+}
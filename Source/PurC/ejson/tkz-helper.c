@@ -39,7 +39,7 @@
 #include <stdlib.h>
 #endif
 
-#define NR_CONSUMED_LIST_LIMIT   128
+#define NR_CONSUMED_LIST_LIMIT   128     /* must be a power of 2 */
 #define MIN_BUFFER_CAPACITY      32
 
 #if HAVE(GLIB)
@@ -50,11 +50,18 @@
 #define    PCHVML_FREE(p)     free(p)
 #endif
 
+/*
+ * The consumed characters are kept in a ring, so that the last ones can be
+ * reconsumed without any allocation: the `nr_consumed` entries before `end`
+ * are the consumed ones, the oldest first, and the `nr_reconsume` entries
+ * from `end` on are the ones to be reconsumed, the next first.
+ */
 struct tkz_reader {
     purc_rwstream_t rws;
-    struct list_head reconsume_list;
-    struct list_head consumed_list;
-    size_t nr_consumed_list;
+    struct tkz_uc ring[NR_CONSUMED_LIST_LIMIT];
+    size_t end;
+    size_t nr_consumed;
+    size_t nr_reconsume;
 
     struct tkz_uc curr_uc;
     int line;
@@ -65,6 +72,8 @@ struct tkz_reader {
     int hee_column;
 };
 
+#define RING_INDEX(i)   ((i) & (NR_CONSUMED_LIST_LIMIT - 1))
+
 
 struct tkz_unihan_area {
     uint32_t begin;
@@ -111,8 +120,6 @@ struct tkz_reader *tkz_reader_new(int hee_line, int hee_column)
     if (!reader) {
         return NULL;
     }
-    INIT_LIST_HEAD(&reader->reconsume_list);
-    INIT_LIST_HEAD(&reader->consumed_list);
     reader->line = 1;
     reader->column = 0;
     reader->consumed = 0;
@@ -151,69 +158,15 @@ tkz_reader_read_from_rwstream(struct tkz_reader *reader)
     return &reader->curr_uc;
 }
 
-static struct tkz_uc*
-tkz_reader_read_from_reconsume_list(struct tkz_reader *reader)
-{
-    struct tkz_uc *puc = list_entry(reader->reconsume_list.next,
-            struct tkz_uc, list);
-    reader->curr_uc = *puc;
-    list_del_init(&puc->list);
-    tkz_uc_destroy(puc);
-    return &reader->curr_uc;
-}
-
-#define print_uc_list(uc_list, tag)                                         \
-    do {                                                                    \
-        PC_DEBUG("begin print %s list\n|", tag);                            \
-        struct list_head *p, *n;                                            \
-        list_for_each_safe(p, n, uc_list) {                                 \
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);        \
-            PC_DEBUG("%c", puc->character);                                 \
-        }                                                                   \
-        PC_DEBUG("|\nend print %s list\n", tag);                            \
-    } while(0)
-
-#define PRINT_CONSUMED_LIST(reader)    \
-        print_uc_list(&reader->consumed_list, "consumed")
-
-#define PRINT_RECONSUM_LIST(reader)    \
-        print_uc_list(&reader->reconsume_list, "reconsume")
-
-static bool
-tkz_reader_add_consumed(struct tkz_reader *reader, struct tkz_uc *uc)
-{
-    struct tkz_uc *p = tkz_uc_new();
-    if (!p) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return false;
-    }
-
-    *p = *uc;
-    list_add_tail(&p->list, &reader->consumed_list);
-    reader->nr_consumed_list++;
-
-    if (reader->nr_consumed_list > NR_CONSUMED_LIST_LIMIT) {
-        struct tkz_uc *first = list_first_entry(
-                &reader->consumed_list, struct tkz_uc, list);
-        list_del_init(&first->list);
-        tkz_uc_destroy(first);
-        reader->nr_consumed_list--;
-    }
-    return true;
-}
-
 bool tkz_reader_reconsume_last_char(struct tkz_reader *reader)
 {
-    if (!reader->nr_consumed_list) {
+    if (!reader->nr_consumed) {
         return true;
     }
 
-    struct tkz_uc *last = list_last_entry(
-            &reader->consumed_list, struct tkz_uc, list);
-    list_del_init(&last->list);
-    reader->nr_consumed_list--;
-
-    list_add(&last->list, &reader->reconsume_list);
+    reader->end = RING_INDEX(reader->end - 1);
+    reader->nr_consumed--;
+    reader->nr_reconsume++;
     return true;
 }
 
@@ -224,18 +177,21 @@ struct tkz_uc *tkz_reader_current(struct tkz_reader *reader)
 
 struct tkz_uc *tkz_reader_next_char(struct tkz_reader *reader)
 {
-    struct tkz_uc *ret = NULL;
-    if (list_empty(&reader->reconsume_list)) {
-        ret = tkz_reader_read_from_rwstream(reader);
+    struct tkz_uc *slot = &reader->ring[reader->end];
+    if (reader->nr_reconsume) {
+        reader->curr_uc = *slot;
+        reader->nr_reconsume--;
     }
     else {
-        ret = tkz_reader_read_from_reconsume_list(reader);
+        /* overwrites the oldest one when the ring is full */
+        *slot = *tkz_reader_read_from_rwstream(reader);
     }
 
-    if (tkz_reader_add_consumed(reader, ret)) {
-        return ret;
+    reader->end = RING_INDEX(reader->end + 1);
+    if (reader->nr_consumed < NR_CONSUMED_LIST_LIMIT) {
+        reader->nr_consumed++;
     }
-    return NULL;
+    return &reader->curr_uc;
 }
 
 int tkz_reader_hee_line(struct tkz_reader *reader)
@@ -251,17 +207,6 @@ int tkz_reader_hee_column(struct tkz_reader *reader)
 void tkz_reader_destroy(struct tkz_reader *reader)
 {
     if (reader) {
-        struct list_head *p, *n;
-        list_for_each_safe(p, n, &reader->reconsume_list) {
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);
-            list_del_init(&puc->list);
-            tkz_uc_destroy(puc);
-        }
-        list_for_each_safe(p, n, &reader->consumed_list) {
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);
-            list_del_init(&puc->list);
-            tkz_uc_destroy(puc);
-        }
         PCHVML_FREE(reader);
     }
 }
@@ -2216,7 +2216,7 @@ BEGIN_STATE(EJSON_TKZ_STATE_AFTER_VALUE_NUMBER)
             SET_ERR(PCEJSON_ERROR_BAD_JSON_NUMBER);
             RETURN_AND_STOP_PARSE();
         }
-        double d = strtod(
+        double d = pcutils_strtod(
                 tkz_buffer_get_bytes(parser->temp_buffer), NULL);
         top->node = pcvcm_node_new_number(d);
         update_tkz_stack(parser);
@@ -39,156 +39,63 @@ struct pcexec_exe_filter_inst {
 
     struct exe_filter_param        param;
 
-    purc_variant_t              result_set;
-};
-
-// clear internal data except `input`
-static inline void
-reset(struct pcexec_exe_filter_inst *exe_filter_inst)
-{
-    struct exe_filter_param *param = &exe_filter_inst->param;
-    exe_filter_param_reset(param);
-    pcexecutor_inst_reset(&exe_filter_inst->super);
-    PCEXE_CLR_VAR(exe_filter_inst->result_set);
-}
-
-static inline bool
-init_result_set_with_object(struct pcexec_exe_filter_inst *exe_filter_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_filter_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t k, v;
-    foreach_key_value_in_variant_object(input, k, v)
-        purc_variant_t arr = purc_variant_make_array(2, k, v);
-        if (arr == PURC_VARIANT_INVALID) {
-            ok = false;
-            break;
-        }
-        if (!purc_variant_array_append(result_set, arr)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_filter_inst->result_set);
-        exe_filter_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-init_result_set_with_array(struct pcexec_exe_filter_inst *exe_filter_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_filter_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t v;
-    size_t idx;
-    foreach_value_in_variant_array(input, v, idx)
-        (void)idx;
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_filter_inst->result_set);
-        exe_filter_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-init_result_set_with_set(struct pcexec_exe_filter_inst *exe_filter_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_filter_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t v;
-    // FIXME: document-order or content-order?
-    foreach_value_in_variant_set(input, v)
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
+    struct pcexe_obj_cursor     cursor;     // for an object input
 
-    if (ok) {
-        PCEXE_CLR_VAR(exe_filter_inst->result_set);
-        exe_filter_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
+    struct pcexec_rule         *cached;     // the parsed rule
+    struct filter_rule         *rule;       // the AST of the parsed rule
+};
 
+/*
+ * NOTE: the items are fetched from the input one by one, instead of copying
+ * the whole input to an array when the rule is parsed; `k` is set only for
+ * an object.
+ */
 static inline bool
-init_result_set(struct pcexec_exe_filter_inst *exe_filter_inst,
-        purc_variant_t result_set)
+get_item(struct pcexec_exe_filter_inst *exe_filter_inst, size_t idx,
+        purc_variant_t *k, purc_variant_t *v)
 {
-    purc_exec_inst_t inst = &exe_filter_inst->super;
-    purc_variant_t input = inst->input;
+    purc_variant_t input = exe_filter_inst->super.input;
 
     switch (purc_variant_get_type(input)) {
         case PURC_VARIANT_TYPE_OBJECT:
-            return init_result_set_with_object(exe_filter_inst, result_set);
+            return pcexe_obj_cursor_get(&exe_filter_inst->cursor, input,
+                    idx, k, v);
         case PURC_VARIANT_TYPE_ARRAY:
-            return init_result_set_with_array(exe_filter_inst, result_set);
+            *v = purc_variant_array_get(input, idx);
+            break;
         case PURC_VARIANT_TYPE_SET:
-            return init_result_set_with_set(exe_filter_inst, result_set);
+            *v = purc_variant_set_get_by_index(input, idx);
+            break;
         default:
             PC_ASSERT(0);
             return false;
     }
 
-    bool ok = true;
-    purc_variant_t k, v;
-    foreach_key_value_in_variant_object(input, k, v)
-        if (!purc_variant_array_append(result_set, k)) {
-            ok = false;
-            break;
-        }
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_filter_inst->result_set);
-        exe_filter_inst->result_set = result_set;
-        purc_variant_ref(result_set);
+    if (*v == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return false;
     }
-
-    return ok;
+    return true;
 }
 
-static inline bool
-prepare_result_set(struct pcexec_exe_filter_inst *exe_filter_inst)
+// clear internal data except `input`
+static inline void
+reset(struct pcexec_exe_filter_inst *exe_filter_inst)
 {
-    purc_variant_t result_set;
-    result_set = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (result_set == PURC_VARIANT_INVALID) {
-        return false;
-    }
-
-    bool ok = init_result_set(exe_filter_inst, result_set);
-    purc_variant_unref(result_set);
+    struct exe_filter_param *param = &exe_filter_inst->param;
+    exe_filter_param_reset(param);
+    pcexecutor_inst_reset(&exe_filter_inst->super);
+    pcexecutor_release_parsed_rule(exe_filter_inst->cached);
+    exe_filter_inst->cached = NULL;
+    exe_filter_inst->rule = NULL;
+    pcexe_obj_cursor_release(&exe_filter_inst->cursor);
+}
 
-    return ok;
+static void
+release_parsed_rule(void *ast)
+{
+    filter_rule_release((struct filter_rule *)ast);
+    free(ast);
 }
 
 static inline bool
@@ -197,23 +104,41 @@ parse_rule(struct pcexec_exe_filter_inst *exe_filter_inst,
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
 
-    struct exe_filter_param param = {0};
-    int r = exe_filter_parse(rule, strlen(rule), &param);
     if (inst->err_msg) {
         free(inst->err_msg);
         inst->err_msg = NULL;
     }
 
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
-        return false;
+    /* NOTE: parse the rule only if it is not in the cache of the instance */
+    struct pcexec_rule *cached = pcexecutor_find_parsed_rule("FILTER", rule);
+    if (cached == NULL) {
+        struct exe_filter_param param = {0};
+        int r = exe_filter_parse(rule, strlen(rule), &param);
+        if (r) {
+            inst->err_msg = param.err_msg;
+            param.err_msg = NULL;
+            return false;
+        }
+
+        struct filter_rule *ast = malloc(sizeof(*ast));
+        if (ast == NULL) {
+            exe_filter_param_reset(&param);
+            pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+            return false;
+        }
+
+        *ast = param.rule;
+        cached = pcexecutor_cache_parsed_rule("FILTER", rule, ast,
+                release_parsed_rule);
+        if (cached == NULL)
+            return false;
     }
 
-    exe_filter_param_reset(&exe_filter_inst->param);
-    exe_filter_inst->param = param;
+    pcexecutor_release_parsed_rule(exe_filter_inst->cached);
+    exe_filter_inst->cached = cached;
+    exe_filter_inst->rule = pcexecutor_parsed_rule_ast(cached);
 
-    return prepare_result_set(exe_filter_inst);
+    return true;
 }
 
 int
@@ -238,13 +163,12 @@ filter_rule_eval(struct filter_rule *rule, purc_variant_t val, bool *result)
 
 static inline bool
 check_item_with_object(struct pcexec_exe_filter_inst *exe_filter_inst,
-    const int curr, purc_variant_t item, bool *result)
+    const int curr, purc_variant_t k, purc_variant_t v, bool *result)
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
     purc_exec_iter_t it = &inst->it;
-    struct filter_rule *rule = &exe_filter_inst->param.rule;
+    struct filter_rule *rule = exe_filter_inst->rule;
 
-    purc_variant_t v = purc_variant_array_get(item, 1);
     PC_ASSERT(v != PURC_VARIANT_INVALID);
 
     if (filter_rule_eval(rule, v, result)) {
@@ -255,7 +179,6 @@ check_item_with_object(struct pcexec_exe_filter_inst *exe_filter_inst,
     if (!result)
         return false;
 
-    purc_variant_t k = purc_variant_array_get(item, 0);
     PC_ASSERT(k != PURC_VARIANT_INVALID);
 
     purc_variant_t val = PURC_VARIANT_INVALID;
@@ -288,7 +211,7 @@ check_item_with_array(struct pcexec_exe_filter_inst *exe_filter_inst,
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
     purc_exec_iter_t it = &inst->it;
-    struct filter_rule *rule = &exe_filter_inst->param.rule;
+    struct filter_rule *rule = exe_filter_inst->rule;
 
     if (filter_rule_eval(rule, item, result)) {
         // TODO: exception
@@ -326,14 +249,15 @@ check_item_with_set(struct pcexec_exe_filter_inst *exe_filter_inst,
 
 static inline bool
 check_item(struct pcexec_exe_filter_inst *exe_filter_inst,
-    const int curr, purc_variant_t item, bool *result)
+    const int curr, purc_variant_t k, purc_variant_t item, bool *result)
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
     purc_variant_t input = inst->input;
 
     switch (purc_variant_get_type(input)) {
         case PURC_VARIANT_TYPE_OBJECT:
-            return check_item_with_object(exe_filter_inst, curr, item, result);
+            return check_item_with_object(exe_filter_inst, curr, k, item,
+                    result);
         case PURC_VARIANT_TYPE_ARRAY:
             return check_item_with_array(exe_filter_inst, curr, item, result);
         case PURC_VARIANT_TYPE_SET:
@@ -357,22 +281,15 @@ check_curr(struct pcexec_exe_filter_inst *exe_filter_inst)
         return false;
     }
 
-    purc_variant_t result_set = exe_filter_inst->result_set;
-    size_t nr;
-    if (!purc_variant_array_size(result_set, &nr)) {
-        pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
-        return false;
-    }
-
     bool result = false;
     while (!result) {
-        if ((size_t)curr >= nr) {
+        purc_variant_t k = PURC_VARIANT_INVALID, item;
+        if (!get_item(exe_filter_inst, curr, &k, &item)) {
             pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
             return false;
         }
 
-        purc_variant_t item = purc_variant_array_get(result_set, curr);
-        if (!check_item(exe_filter_inst, curr, item, &result)) {
+        if (!check_item(exe_filter_inst, curr, k, item, &result)) {
             // TODO: exception
             PC_ASSERT(0);
             return false;
@@ -39,7 +39,12 @@ struct pcexec_exe_key_inst {
 
     struct exe_key_param        param;
 
-    purc_variant_t              result_set;
+    /* NOTE: the properties are got from the input one by one, instead of
+       copying all of them to an array when the rule is parsed */
+    struct pcexe_obj_cursor     cursor;
+
+    struct pcexec_rule         *cached;     // the parsed rule
+    struct key_rule            *rule;       // the AST of the parsed rule
 };
 
 // clear internal data except `input`
@@ -49,51 +54,17 @@ reset(struct pcexec_exe_key_inst *exe_key_inst)
     struct exe_key_param *param = &exe_key_inst->param;
     exe_key_param_reset(param);
     pcexecutor_inst_reset(&exe_key_inst->super);
-    PCEXE_CLR_VAR(exe_key_inst->result_set);
+    pcexecutor_release_parsed_rule(exe_key_inst->cached);
+    exe_key_inst->cached = NULL;
+    exe_key_inst->rule = NULL;
+    pcexe_obj_cursor_release(&exe_key_inst->cursor);
 }
 
-static inline bool
-init_result_set(struct pcexec_exe_key_inst *exe_key_inst,
-        purc_variant_t result_set)
+static void
+release_parsed_rule(void *ast)
 {
-    purc_exec_inst_t inst = &exe_key_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t k, v;
-    foreach_key_value_in_variant_object(input, k, v)
-        if (!purc_variant_array_append(result_set, k)) {
-            ok = false;
-            break;
-        }
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_key_inst->result_set);
-        exe_key_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-prepare_result_set(struct pcexec_exe_key_inst *exe_key_inst)
-{
-    purc_variant_t result_set;
-    result_set = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (result_set == PURC_VARIANT_INVALID) {
-        return false;
-    }
-
-    bool ok = init_result_set(exe_key_inst, result_set);
-    purc_variant_unref(result_set);
-
-    return ok;
+    key_rule_release((struct key_rule *)ast);
+    free(ast);
 }
 
 static inline bool
@@ -102,23 +73,41 @@ parse_rule(struct pcexec_exe_key_inst *exe_key_inst,
 {
     purc_exec_inst_t inst = &exe_key_inst->super;
 
-    struct exe_key_param param = {0};
-    int r = exe_key_parse(rule, strlen(rule), &param);
     if (inst->err_msg) {
         free(inst->err_msg);
         inst->err_msg = NULL;
     }
 
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
-        return false;
+    /* NOTE: parse the rule only if it is not in the cache of the instance */
+    struct pcexec_rule *cached = pcexecutor_find_parsed_rule("KEY", rule);
+    if (cached == NULL) {
+        struct exe_key_param param = {0};
+        int r = exe_key_parse(rule, strlen(rule), &param);
+        if (r) {
+            inst->err_msg = param.err_msg;
+            param.err_msg = NULL;
+            return false;
+        }
+
+        struct key_rule *ast = malloc(sizeof(*ast));
+        if (ast == NULL) {
+            exe_key_param_reset(&param);
+            pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+            return false;
+        }
+
+        *ast = param.rule;
+        cached = pcexecutor_cache_parsed_rule("KEY", rule, ast,
+                release_parsed_rule);
+        if (cached == NULL)
+            return false;
     }
 
-    exe_key_param_reset(&exe_key_inst->param);
-    exe_key_inst->param = param;
+    pcexecutor_release_parsed_rule(exe_key_inst->cached);
+    exe_key_inst->cached = cached;
+    exe_key_inst->rule = pcexecutor_parsed_rule_ast(cached);
 
-    return prepare_result_set(exe_key_inst);
+    return true;
 }
 
 int
@@ -139,7 +128,7 @@ check_curr(struct pcexec_exe_key_inst *exe_key_inst)
 {
     purc_exec_inst_t inst = &exe_key_inst->super;
     purc_exec_iter_t it = &inst->it;
-    struct key_rule *rule = &exe_key_inst->param.rule;
+    struct key_rule *rule = exe_key_inst->rule;
 
     int curr = (int)it->curr;
 
@@ -148,34 +137,25 @@ check_curr(struct pcexec_exe_key_inst *exe_key_inst)
         return false;
     }
 
-    purc_variant_t result_set = exe_key_inst->result_set;
-    size_t nr;
-    if (!purc_variant_array_size(result_set, &nr)) {
-        pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
-        return false;
-    }
-
     bool result = false;
     while (!result) {
-        if ((size_t)curr >= nr) {
+        purc_variant_t k, v;
+        if (!pcexe_obj_cursor_get(&exe_key_inst->cursor, inst->input,
+                    curr, &k, &v)) {
             pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
             return false;
         }
 
-        purc_variant_t k = purc_variant_array_get(result_set, curr);
         if (key_rule_eval(rule, k, &result)) {
             // TODO: exception
             PC_ASSERT(0);
             return false;
         }
         if (!result) {
-            curr += 2;
+            curr += 1;
             continue;
         }
 
-        purc_variant_t v = purc_variant_array_get(result_set, curr+1);
-        PC_ASSERT(v != PURC_VARIANT_INVALID);
-
         purc_variant_t val = PURC_VARIANT_INVALID;
 
         switch (rule->for_clause) {
@@ -221,7 +201,7 @@ fetch_next(struct pcexec_exe_key_inst *exe_key_inst)
 {
     purc_exec_inst_t inst = &exe_key_inst->super;
     purc_exec_iter_t it = &inst->it;
-    it->curr += 2;
+    it->curr += 1;
     if (check_curr(exe_key_inst)) {
         return it;
     }
@@ -41,7 +41,8 @@ struct pcexec_exe_range_inst {
 
     struct exe_range_param        param;
 
-    purc_variant_t              result_set;
+    struct pcexec_rule         *cached;     // the parsed rule
+    struct range_rule          *rule;       // the AST of the parsed rule
 };
 
 // clear internal data except `input`
@@ -51,113 +52,39 @@ reset(struct pcexec_exe_range_inst *exe_range_inst)
     struct exe_range_param *param = &exe_range_inst->param;
     exe_range_param_reset(param);
     pcexecutor_inst_reset(&exe_range_inst->super);
-    PCEXE_CLR_VAR(exe_range_inst->result_set);
+    pcexecutor_release_parsed_rule(exe_range_inst->cached);
+    exe_range_inst->cached = NULL;
+    exe_range_inst->rule = NULL;
 }
 
-static inline bool
-init_result_set_with_array(struct pcexec_exe_range_inst *exe_range_inst,
-        purc_variant_t result_set)
+/*
+ * NOTE: the items are fetched from the input by the index, instead of
+ * copying the whole input to an array when the rule is parsed.
+ */
+static inline size_t
+nr_items(purc_variant_t input)
 {
-    purc_exec_inst_t inst = &exe_range_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t v;
-    size_t idx;
-    foreach_value_in_variant_array(input, v, idx)
-        (void)idx;
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_range_inst->result_set);
-        exe_range_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
+    size_t nr = 0;
+    if (purc_variant_is_array(input))
+        purc_variant_array_size(input, &nr);
+    else
+        purc_variant_set_size(input, &nr);
+    return nr;
 }
 
-static inline bool
-init_result_set_with_set(struct pcexec_exe_range_inst *exe_range_inst,
-        purc_variant_t result_set)
+static inline purc_variant_t
+get_item(purc_variant_t input, size_t idx)
 {
-    purc_exec_inst_t inst = &exe_range_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t v;
-    // FIXME: document-order or content-order?
-    foreach_value_in_variant_set(input, v)
-        bool ok = purc_variant_array_append(result_set, v);
-        if (!ok)
-            break;
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_range_inst->result_set);
-        exe_range_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
+    if (purc_variant_is_array(input))
+        return purc_variant_array_get(input, idx);
+    return purc_variant_set_get_by_index(input, idx);
 }
 
-static inline bool
-init_result_set(struct pcexec_exe_range_inst *exe_range_inst,
-        purc_variant_t result_set)
+static void
+release_parsed_rule(void *ast)
 {
-    purc_exec_inst_t inst = &exe_range_inst->super;
-    purc_variant_t input = inst->input;
-
-    switch (purc_variant_get_type(input)) {
-        case PURC_VARIANT_TYPE_ARRAY:
-            return init_result_set_with_array(exe_range_inst, result_set);
-        case PURC_VARIANT_TYPE_SET:
-            return init_result_set_with_set(exe_range_inst, result_set);
-        default:
-            PC_ASSERT(0);
-            return false;
-    }
-
-    bool ok = true;
-    purc_variant_t k, v;
-    foreach_key_value_in_variant_object(input, k, v)
-        if (!purc_variant_array_append(result_set, k)) {
-            ok = false;
-            break;
-        }
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_range_inst->result_set);
-        exe_range_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-prepare_result_set(struct pcexec_exe_range_inst *exe_range_inst)
-{
-    purc_variant_t result_set;
-    result_set = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (result_set == PURC_VARIANT_INVALID) {
-        return false;
-    }
-
-    bool ok = init_result_set(exe_range_inst, result_set);
-    purc_variant_unref(result_set);
-
-    return ok;
+    range_rule_release((struct range_rule *)ast);
+    free(ast);
 }
 
 static inline bool
@@ -166,23 +93,41 @@ parse_rule(struct pcexec_exe_range_inst *exe_range_inst,
 {
     purc_exec_inst_t inst = &exe_range_inst->super;
 
-    struct exe_range_param param = {0};
-    int r = exe_range_parse(rule, strlen(rule), &param);
     if (inst->err_msg) {
         free(inst->err_msg);
         inst->err_msg = NULL;
     }
 
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
-        return false;
+    /* NOTE: parse the rule only if it is not in the cache of the instance */
+    struct pcexec_rule *cached = pcexecutor_find_parsed_rule("RANGE", rule);
+    if (cached == NULL) {
+        struct exe_range_param param = {0};
+        int r = exe_range_parse(rule, strlen(rule), &param);
+        if (r) {
+            inst->err_msg = param.err_msg;
+            param.err_msg = NULL;
+            return false;
+        }
+
+        struct range_rule *ast = malloc(sizeof(*ast));
+        if (ast == NULL) {
+            exe_range_param_reset(&param);
+            pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+            return false;
+        }
+
+        *ast = param.rule;
+        cached = pcexecutor_cache_parsed_rule("RANGE", rule, ast,
+                release_parsed_rule);
+        if (cached == NULL)
+            return false;
     }
 
-    exe_range_param_reset(&exe_range_inst->param);
-    exe_range_inst->param = param;
+    pcexecutor_release_parsed_rule(exe_range_inst->cached);
+    exe_range_inst->cached = cached;
+    exe_range_inst->rule = pcexecutor_parsed_rule_ast(cached);
 
-    return prepare_result_set(exe_range_inst);
+    return true;
 }
 
 static inline bool
@@ -190,8 +135,7 @@ check_curr(struct pcexec_exe_range_inst *exe_range_inst)
 {
     purc_exec_inst_t inst = &exe_range_inst->super;
     purc_exec_iter_t it = &inst->it;
-    struct exe_range_param *param = &exe_range_inst->param;
-    struct range_rule *rule = &param->rule;
+    struct range_rule *rule = exe_range_inst->rule;
 
     int curr = (int)it->curr;
 
@@ -200,13 +144,7 @@ check_curr(struct pcexec_exe_range_inst *exe_range_inst)
         return false;
     }
 
-    purc_variant_t result_set = exe_range_inst->result_set;
-    size_t nr;
-    if (!purc_variant_array_size(result_set, &nr)) {
-        pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
-        return false;
-    }
-
+    size_t nr = nr_items(inst->input);
     if (nr == 0) {
         return false;
     }
@@ -230,7 +168,7 @@ check_curr(struct pcexec_exe_range_inst *exe_range_inst)
         }
     }
 
-    purc_variant_t item = purc_variant_array_get(result_set, curr);
+    purc_variant_t item = get_item(inst->input, curr);
     PCEXE_CLR_VAR(inst->value);
     inst->value = item;
     purc_variant_ref(item);
@@ -244,8 +182,7 @@ fetch_begin(struct pcexec_exe_range_inst *exe_range_inst)
 {
     purc_exec_inst_t inst = &exe_range_inst->super;
     purc_exec_iter_t it = &inst->it;
-    struct exe_range_param *param = &exe_range_inst->param;
-    struct range_rule *rule = &param->rule;
+    struct range_rule *rule = exe_range_inst->rule;
     it->curr = rule->from;
     if (check_curr(exe_range_inst)) {
         return it;
@@ -258,8 +195,7 @@ fetch_next(struct pcexec_exe_range_inst *exe_range_inst)
 {
     purc_exec_inst_t inst = &exe_range_inst->super;
     purc_exec_iter_t it = &inst->it;
-    struct exe_range_param *param = &exe_range_inst->param;
-    struct range_rule *rule = &param->rule;
+    struct range_rule *rule = exe_range_inst->rule;
     int advance = 1;
     if (isfinite(rule->advance))
         advance = rule->advance;
@@ -72,6 +72,12 @@ exe_sql_parse_rule(purc_exec_inst_t inst, const char* rule)
 
     // TODO: parse rule and eval to selected_keys
 
+    /* NOTE: the grammar in parsers/exe_sql.y only validates the syntax and
+     * builds no AST yet, so there is no planner to choose an access path.
+     * When it is added, a `WHERE` equality on the unique key of a set input
+     * should use purc_variant_set_get_member_by_key_values(), which looks
+     * up the tree of the set, instead of scanning all members. */
+
     UNUSED_PARAM(inst);
     UNUSED_PARAM(rule);
 
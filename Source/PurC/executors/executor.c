@@ -179,16 +179,24 @@ static int _init_instance(struct pcinst *inst,
 
     inst->executor_heap->debug_flex = 0;
     inst->executor_heap->debug_bison = 0;
+    list_head_init(&inst->executor_heap->rules);
 
     PC_ASSERT(purc_get_last_error() == 0);
     return 0;
 }
 
+static void clear_rule_cache(struct pcexecutor_heap *heap);
+
 static void _cleanup_instance(struct pcinst *inst)
 {
     if (!inst->executor_heap)
         return;
 
+    struct pcexec_rule_cache_stat *stat = &inst->executor_heap->rule_stat;
+    PC_DEBUG("Parsed executor rules: %u hits, %u misses\n",
+            (unsigned)stat->nr_hits, (unsigned)stat->nr_misses);
+
+    clear_rule_cache(inst->executor_heap);
     free(inst->executor_heap);
     inst->executor_heap = NULL;
 }
@@ -424,4 +432,164 @@ pcexecutor_get_rule_name(const char *rule)
     return atom;
 }
 
+/*
+ * NOTE: the parsed rules are cached per instance, so that the rule of an
+ * executor used in a loop or an event handler is parsed only once. The
+ * cache is keyed by the rule text, which names the executor as well; the
+ * name is checked for the executors registered by the others.
+ *
+ * A cached rule is shared by the executor instances by reference and is
+ * read-only. The least recently used rule is removed from the cache when
+ * it is full; it is released when the last instance using it releases it.
+ */
+#define MAX_CACHED_RULES        64
+
+struct pcexec_rule {
+    struct list_head        ln;         // in pcexecutor_heap.rules
+    const char             *name;       // the name of the executor
+    char                   *text;
+    unsigned int            refc;
+
+    void                   *ast;
+    pcexec_rule_release_fn  release;
+};
+
+static void
+unref_rule(struct pcexec_rule *cached)
+{
+    if (--cached->refc == 0) {
+        if (cached->release)
+            cached->release(cached->ast);
+        free(cached->text);
+        free(cached);
+    }
+}
+
+static void
+uncache_rule(struct pcexecutor_heap *heap, struct pcexec_rule *cached)
+{
+    pcutils_uomap_erase(heap->rule_map, cached->text);
+    list_del(&cached->ln);
+    heap->rule_stat.nr_rules--;
+    unref_rule(cached);
+}
+
+static void
+clear_rule_cache(struct pcexecutor_heap *heap)
+{
+    struct pcexec_rule *p, *n;
+    list_for_each_entry_safe(p, n, &heap->rules, ln) {
+        uncache_rule(heap, p);
+    }
+
+    if (heap->rule_map) {
+        pcutils_uomap_destroy(heap->rule_map);
+        heap->rule_map = NULL;
+    }
+}
+
+static inline struct pcexecutor_heap *
+executor_heap(void)
+{
+    struct pcinst *inst = pcinst_current();
+    return inst ? inst->executor_heap : NULL;
+}
 
+struct pcexec_rule *
+pcexecutor_find_parsed_rule(const char *name, const char *rule)
+{
+    struct pcexecutor_heap *heap = executor_heap();
+    if (heap == NULL || heap->rule_map == NULL)
+        goto miss;
+
+    pcutils_uomap_entry *entry = pcutils_uomap_find(heap->rule_map, rule);
+    if (entry == NULL)
+        goto miss;
+
+    struct pcexec_rule *cached = pcutils_uomap_entry_val(entry);
+    if (strcmp(cached->name, name))
+        goto miss;
+
+    heap->rule_stat.nr_hits++;
+    list_move(&cached->ln, &heap->rules);
+    cached->refc++;
+    return cached;
+
+miss:
+    if (heap)
+        heap->rule_stat.nr_misses++;
+    return NULL;
+}
+
+struct pcexec_rule *
+pcexecutor_cache_parsed_rule(const char *name, const char *rule,
+        void *ast, pcexec_rule_release_fn release)
+{
+    struct pcexecutor_heap *heap = executor_heap();
+    struct pcexec_rule *cached = calloc(1, sizeof(*cached));
+    if (cached == NULL || (cached->text = strdup(rule)) == NULL)
+        goto failed;
+
+    cached->name = name;
+    cached->ast = ast;
+    cached->release = release;
+    cached->refc = 1;
+
+    if (heap == NULL)
+        return cached;
+
+    if (heap->rule_map == NULL) {
+        heap->rule_map = pcutils_uomap_create(NULL, NULL, NULL, NULL,
+                pchash_fnv1a_str_hash, comp_key_string, false, false);
+        if (heap->rule_map == NULL)
+            return cached;
+    }
+
+    /* replace the one of another executor having the same text */
+    pcutils_uomap_entry *entry = pcutils_uomap_find(heap->rule_map, rule);
+    if (entry) {
+        uncache_rule(heap, pcutils_uomap_entry_val(entry));
+    }
+    else if (heap->rule_stat.nr_rules >= MAX_CACHED_RULES) {
+        uncache_rule(heap, list_last_entry(&heap->rules,
+                    struct pcexec_rule, ln));
+    }
+
+    /* NOTE: not fatal if failed; the rule is just not cached */
+    if (pcutils_uomap_insert(heap->rule_map, cached->text, cached) == 0) {
+        list_add(&cached->ln, &heap->rules);
+        cached->refc++;
+        heap->rule_stat.nr_rules++;
+    }
+    return cached;
+
+failed:
+    free(cached);
+    if (release)
+        release(ast);
+    pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+    return NULL;
+}
+
+void
+pcexecutor_release_parsed_rule(struct pcexec_rule *cached)
+{
+    if (cached)
+        unref_rule(cached);
+}
+
+void *
+pcexecutor_parsed_rule_ast(struct pcexec_rule *cached)
+{
+    return cached->ast;
+}
+
+void
+pcexecutor_get_rule_cache_stat(struct pcexec_rule_cache_stat *stat)
+{
+    struct pcexecutor_heap *heap = executor_heap();
+    if (heap)
+        *stat = heap->rule_stat;
+    else
+        memset(stat, 0, sizeof(*stat));
+}
@@ -28,6 +28,7 @@
 #include "private/debug.h"
 #include "private/errors.h"
 #include "private/variant.h"
+#include "private/regex.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -459,6 +460,49 @@ pcexe_cache_set(purc_variant_t input, bool asc_desc)
     return cache;
 }
 
+/*
+ * NOTE: the cursor keeps an iterator of the object, so that getting the
+ * properties one by one in order costs O(1) each. The iterator is made
+ * again if the object was changed or a former property is asked for.
+ */
+bool
+pcexe_obj_cursor_get(struct pcexe_obj_cursor *cursor, purc_variant_t obj,
+        size_t idx, purc_variant_t *k, purc_variant_t *v)
+{
+    uint32_t gen = pcvariant_object_generation(obj);
+
+    if (cursor->it == NULL || cursor->pos > idx || cursor->gen != gen) {
+        pcexe_obj_cursor_release(cursor);
+        cursor->it = pcvrnt_object_iterator_create_begin(obj);
+        cursor->pos = 0;
+        cursor->gen = gen;
+    }
+
+    while (cursor->it && cursor->pos < idx) {
+        if (!pcvrnt_object_iterator_next(cursor->it)) {
+            pcexe_obj_cursor_release(cursor);
+            break;
+        }
+        cursor->pos++;
+    }
+
+    if (cursor->it == NULL)
+        return false;
+
+    *k = pcvrnt_object_iterator_get_key(cursor->it);
+    *v = pcvrnt_object_iterator_get_value(cursor->it);
+    return true;
+}
+
+void
+pcexe_obj_cursor_release(struct pcexe_obj_cursor *cursor)
+{
+    if (cursor->it) {
+        pcvrnt_object_iterator_release(cursor->it);
+        cursor->it = NULL;
+    }
+}
+
 purc_variant_t
 pcexe_make_cache(purc_variant_t input, bool asc_desc)
 {
@@ -862,9 +906,9 @@ string_pattern_expression_reset(struct string_pattern_expression *spexp)
             break;
         case STRING_PATTERN_REGEXP:
             free(spexp->regexp.regexp);
-            if (spexp->regexp.reg_valid) {
-                regfree(&spexp->regexp.reg);
-                spexp->regexp.reg_valid = 0;
+            if (spexp->regexp.reg) {
+                pcregex_cache_release(spexp->regexp.reg);
+                spexp->regexp.reg = NULL;
             }
             break;
     }
@@ -1210,12 +1254,11 @@ regular_expression_init_reg(struct regular_expression *rexp)
 
     // TODO: other flags
 
-    int r = regcomp(&rexp->reg, rexp->regexp, cflags);
-    if (r)
+    rexp->reg = pcregex_cache_get(rexp->regexp, cflags, NULL);
+    if (rexp->reg == NULL)
         return -1;
 
     rexp->eflags = eflags;
-    rexp->reg_valid = 1;
 
     return 0;
 }
@@ -1234,13 +1277,13 @@ regular_expression_eval(struct regular_expression *rexp,
     const char *s = buf;
     r = -1;
 
-    if (!rexp->reg_valid) {
+    if (rexp->reg == NULL) {
         if (regular_expression_init_reg(rexp))
             goto end;
     }
 
     r = 0;
-    v = regexec(&rexp->reg, s, 0, NULL, rexp->eflags);
+    v = regexec(rexp->reg, s, 0, NULL, rexp->eflags);
 
     if (result)
         *result = (v == 0) ? true : false;
@@ -120,6 +120,20 @@ char* pcexe_strlist_to_str(struct pcexe_strlist *list);
 purc_variant_t
 pcexe_make_cache(purc_variant_t input, bool asc_desc);
 
+/* the cursor to get the properties of an object by the index in order */
+struct pcexe_obj_cursor {
+    struct pcvrnt_object_iterator *it;
+    size_t                          pos;    // the index of `it`
+    uint32_t                        gen;    // the generation of the object
+};
+
+bool
+pcexe_obj_cursor_get(struct pcexe_obj_cursor *cursor, purc_variant_t obj,
+        size_t idx, purc_variant_t *k, purc_variant_t *v);
+
+void
+pcexe_obj_cursor_release(struct pcexe_obj_cursor *cursor);
+
 // typedef unsigned char     matching_flags;
 #define MATCHING_FLAG_C 0x01
 #define MATCHING_FLAG_I 0x02
@@ -211,8 +225,7 @@ struct regular_expression
     unsigned char           flags;
 
     int                     eflags;
-    regex_t                 reg;
-    unsigned int            reg_valid:1;
+    const regex_t          *reg;        // got from the cache of regexes
 };
 
 enum STRING_PATTERN_TYPE {
@@ -0,0 +1,221 @@
+/*
+ * @file fetcher-cache.cpp
+ * @date 2026/10/14
+ * @brief The response cache shared by the local and the remote fetchers.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "fetcher-cache.h"
+#include "private/list.h"
+
+#include <wtf/Lock.h>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* NOTE: The cache only lives in memory. The responses are kept in the order
+   of the last use, and the least recently used ones are evicted when the
+   total size exceeds the quota. A response larger than a quarter of the
+   quota is never cached, so that one big resource can not flush all
+   the others. */
+struct cache_entry {
+    struct list_head    ln;
+
+    char       *uri;
+    char       *mime_type;
+    char       *etag;
+    char       *last_modified;
+    time_t      expires;
+
+    void       *content;
+    size_t      sz_content;
+};
+
+static Lock s_cache_lock;
+static LIST_HEAD(s_entries);
+static size_t s_quota;
+static size_t s_sz_used;
+
+static inline size_t entry_size(const struct cache_entry *entry)
+{
+    return sizeof(*entry) + entry->sz_content;
+}
+
+static void destroy_entry(struct cache_entry *entry)
+{
+    list_del(&entry->ln);
+    s_sz_used -= entry_size(entry);
+
+    free(entry->uri);
+    free(entry->mime_type);
+    free(entry->etag);
+    free(entry->last_modified);
+    free(entry->content);
+    free(entry);
+}
+
+static struct cache_entry *find_entry(const char *uri)
+{
+    struct cache_entry *entry;
+    list_for_each_entry(entry, &s_entries, ln) {
+        if (strcmp(entry->uri, uri) == 0) {
+            /* move to the head as the most recently used one */
+            list_move(&entry->ln, &s_entries);
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+void pcfetcher_cache_init(size_t quota)
+{
+    auto locker = holdLock(s_cache_lock);
+    s_quota = quota > SIZE_MAX / 1024 ? SIZE_MAX : quota * 1024;
+}
+
+void pcfetcher_cache_term(void)
+{
+    auto locker = holdLock(s_cache_lock);
+
+    struct cache_entry *p, *n;
+    list_for_each_entry_safe(p, n, &s_entries, ln) {
+        destroy_entry(p);
+    }
+    s_quota = 0;
+}
+
+bool pcfetcher_cache_accepts(size_t sz_content)
+{
+    auto locker = holdLock(s_cache_lock);
+    return sz_content > 0 && sz_content <= s_quota / 4;
+}
+
+bool pcfetcher_cache_lookup(const char *uri, bool *fresh,
+        char **etag, char **last_modified)
+{
+    auto locker = holdLock(s_cache_lock);
+
+    struct cache_entry *entry = find_entry(uri);
+    if (entry == NULL) {
+        return false;
+    }
+
+    if (fresh) {
+        *fresh = time(NULL) < entry->expires;
+    }
+    if (etag) {
+        *etag = entry->etag ? strdup(entry->etag) : NULL;
+    }
+    if (last_modified) {
+        *last_modified = entry->last_modified ?
+            strdup(entry->last_modified) : NULL;
+    }
+    return true;
+}
+
+purc_rwstream_t pcfetcher_cache_make_response(const char *uri,
+        time_t expires, struct pcfetcher_resp_header *resp_header)
+{
+    auto locker = holdLock(s_cache_lock);
+
+    struct cache_entry *entry = find_entry(uri);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    purc_rwstream_t rws = purc_rwstream_new_buffer(entry->sz_content + 1,
+            INT_MAX);
+    if (rws == NULL) {
+        return NULL;
+    }
+
+    if (purc_rwstream_write(rws, entry->content, entry->sz_content) !=
+            (ssize_t)entry->sz_content) {
+        purc_rwstream_destroy(rws);
+        return NULL;
+    }
+    purc_rwstream_seek(rws, 0, SEEK_SET);
+
+    if (expires != PCFETCHER_CACHE_KEEP_EXPIRES) {
+        entry->expires = expires;
+    }
+
+    if (resp_header) {
+        resp_header->ret_code = 200;
+        resp_header->mime_type = entry->mime_type ?
+            strdup(entry->mime_type) : NULL;
+        resp_header->sz_resp = entry->sz_content;
+    }
+    return rws;
+}
+
+void pcfetcher_cache_store(const char *uri, const char *mime_type,
+        const void *content, size_t sz_content, time_t expires,
+        const char *etag, const char *last_modified)
+{
+    auto locker = holdLock(s_cache_lock);
+
+    struct cache_entry *entry = find_entry(uri);
+    if (entry) {
+        destroy_entry(entry);
+    }
+
+    if (sz_content == 0 || sz_content > s_quota / 4) {
+        return;
+    }
+
+    entry = (struct cache_entry *)calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        return;
+    }
+
+    entry->uri = strdup(uri);
+    entry->mime_type = mime_type ? strdup(mime_type) : NULL;
+    entry->etag = etag ? strdup(etag) : NULL;
+    entry->last_modified = last_modified ? strdup(last_modified) : NULL;
+    entry->content = malloc(sz_content);
+    if (entry->uri == NULL || entry->content == NULL) {
+        free(entry->uri);
+        free(entry->mime_type);
+        free(entry->etag);
+        free(entry->last_modified);
+        free(entry->content);
+        free(entry);
+        return;
+    }
+
+    memcpy(entry->content, content, sz_content);
+    entry->sz_content = sz_content;
+    entry->expires = expires;
+
+    list_add(&entry->ln, &s_entries);
+    s_sz_used += entry_size(entry);
+
+    /* evict the least recently used ones */
+    while (s_sz_used > s_quota) {
+        struct cache_entry *last;
+        last = list_last_entry(&s_entries, struct cache_entry, ln);
+        destroy_entry(last);
+    }
+}
+
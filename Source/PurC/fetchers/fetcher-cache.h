@@ -0,0 +1,81 @@
+/*
+ * @file fetcher-cache.h
+ * @date 2026/10/14
+ * @brief The response cache shared by the local and the remote fetchers.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PURC_FETCHER_CACHE_H
+#define PURC_FETCHER_CACHE_H
+
+#include "purc.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <time.h>
+
+/* Use this as the expiry time to keep the one of the cached response. */
+#define PCFETCHER_CACHE_KEEP_EXPIRES    ((time_t)-1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+/* Sets the quota of the cache in KiB; zero disables the cache. */
+void pcfetcher_cache_init(size_t quota);
+
+/* Removes all responses from the cache and disables it. */
+void pcfetcher_cache_term(void);
+
+/* Checks whether a response of the size can be kept in the cache. */
+bool pcfetcher_cache_accepts(size_t sz_content);
+
+/*
+ * Looks up the response of the URI. Returns false if there is no such one.
+ * Otherwise, returns whether the response is still fresh in @fresh, and
+ * the copies of its validators in @etag and @last_modified (NULL if the
+ * response has not the validator); the caller should free them.
+ */
+bool pcfetcher_cache_lookup(const char *uri, bool *fresh,
+        char **etag, char **last_modified);
+
+/*
+ * Makes a memory stream containing a copy of the cached response of
+ * the URI, and fills the response header. If @expires is not
+ * PCFETCHER_CACHE_KEEP_EXPIRES, the expiry time of the response will be
+ * updated, e.g., after a successful revalidation.
+ */
+purc_rwstream_t pcfetcher_cache_make_response(const char *uri,
+        time_t expires, struct pcfetcher_resp_header *resp_header);
+
+/*
+ * Keeps a successful response of the URI in the cache, replacing the old
+ * one if there is. The response is fresh until @expires; it has to be
+ * revalidated with @etag or @last_modified after that.
+ */
+void pcfetcher_cache_store(const char *uri, const char *mime_type,
+        const void *content, size_t sz_content, time_t expires,
+        const char *etag, const char *last_modified);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif /* not defined PURC_FETCHER_CACHE_H */
+
@@ -0,0 +1,423 @@
+/*
+ * @file fetcher-coalesce.cpp
+ * @date 2026/10/14
+ * @brief Coalescing the identical requests in flight of the remote fetcher.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "private/fetcher.h"
+#include "private/list.h"
+#include "fetcher-internal.h"
+
+#include <wtf/Lock.h>
+#include <wtf/RunLoop.h>
+#include <wtf/text/CString.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/* NOTE: A GET request without parameters is a flight. Until the first chunk
+   of its response arrives, an identical request issued by any instance
+   sharing the remote fetcher joins the flight as a waiter instead of sending
+   a new one. The response is handed to the first requester (the leader) as
+   is, and a copy of every chunk is dispatched to the run loop of each
+   waiter. The requests of a session having cookies only join the flights
+   of the same session, because the cookies are sent with the request. */
+struct flight_waiter {
+    struct list_head    ln;
+
+    purc_variant_t      req_id;
+    struct pcfetcher_session *session;
+    pcfetcher_response_handler handler;
+    void               *ctxt;
+    pcfetcher_progress_tracker tracker;
+    void               *tracker_ctxt;
+    RunLoop            *runloop;
+};
+
+struct flight {
+    struct list_head    ln;
+
+    char               *key;
+    struct pcfetcher_session *session;  // NULL if it can be shared
+    purc_variant_t      req_id;
+    bool                started;
+
+    // the leader
+    struct pcfetcher_session *leader_session;
+    pcfetcher_response_handler handler;
+    void               *ctxt;
+    pcfetcher_progress_tracker tracker;
+    void               *tracker_ctxt;
+    RunLoop            *runloop;
+    bool                leader_cancelled;
+
+    struct list_head    waiters;
+};
+
+static Lock s_flight_lock;
+static LIST_HEAD(s_flights);
+
+String pcfetcher_build_uri(const char *base_url,  const char *url);
+
+static char *make_flight_key(struct pcfetcher_session *session,
+        const char *url, enum pcfetcher_method method, purc_variant_t params)
+{
+    if (method != PCFETCHER_METHOD_GET) {
+        return NULL;
+    }
+
+    size_t sz = 0;
+    if (params && (!purc_variant_object_size(params, &sz) || sz > 0)) {
+        return NULL;
+    }
+
+    String uri;
+    if (session->base_url) {
+        uri = pcfetcher_build_uri(session->base_url, url);
+    }
+    else {
+        uri.append(url);
+    }
+    return strdup(uri.utf8().data());
+}
+
+static struct flight *find_flight(const char *key,
+        struct pcfetcher_session *session)
+{
+    struct flight *flight;
+    list_for_each_entry(flight, &s_flights, ln) {
+        if (!flight->started && strcmp(flight->key, key) == 0 &&
+                flight->session == session) {
+            return flight;
+        }
+    }
+
+    return NULL;
+}
+
+/* Dispatches a copy of the chunk to the run loop of the waiter; the waiter
+   is destroyed after it got the last chunk. The chunks dispatched are
+   handled in order, so the waiter lives as long as any one is pending. */
+static void dispatch_to_waiter(struct flight_waiter *waiter,
+        enum pcfetcher_resp_type type, const char *data, size_t sz_data)
+{
+    bool last = false;
+    int ret_code = 0;
+    size_t sz_resp = 0;
+    CString mime_type;
+    CString chunk;
+    struct pcfetcher_load_metrics metrics;
+    bool has_metrics = false;
+
+    switch (type) {
+    case PCFETCHER_RESP_TYPE_ERROR:
+        last = true;
+        FALLTHROUGH;
+    case PCFETCHER_RESP_TYPE_HEADER:
+    {
+        const struct pcfetcher_resp_header *header =
+            (const struct pcfetcher_resp_header *)data;
+        ret_code = header->ret_code;
+        sz_resp = header->sz_resp;
+        if (header->mime_type) {
+            mime_type = header->mime_type;
+        }
+        break;
+    }
+
+    case PCFETCHER_RESP_TYPE_DATA:
+        chunk = CString(data, sz_data);
+        break;
+
+    case PCFETCHER_RESP_TYPE_FINISH:
+        last = true;
+        if (data && sz_data == sizeof(metrics)) {
+            memcpy(&metrics, data, sizeof(metrics));
+            has_metrics = true;
+        }
+        break;
+    }
+
+    waiter->runloop->dispatch([waiter, type, last, ret_code, sz_resp,
+            mime_type, chunk, metrics, has_metrics] {
+            struct pcfetcher_resp_header header;
+            header.ret_code = ret_code;
+            header.mime_type = (char *)mime_type.data();
+            header.sz_resp = sz_resp;
+
+            const char *data = NULL;
+            size_t sz_data = 0;
+            switch (type) {
+            case PCFETCHER_RESP_TYPE_HEADER:
+            case PCFETCHER_RESP_TYPE_ERROR:
+                data = (const char *)&header;
+                break;
+            case PCFETCHER_RESP_TYPE_DATA:
+                data = chunk.data();
+                sz_data = chunk.length();
+                break;
+            case PCFETCHER_RESP_TYPE_FINISH:
+                if (has_metrics) {
+                    data = (const char *)&metrics;
+                    sz_data = sizeof(metrics);
+                }
+                break;
+            }
+
+            waiter->handler(waiter->session, waiter->req_id,
+                    waiter->ctxt, type, data, sz_data);
+            if (last) {
+                free(waiter);
+            }
+        }
+    );
+}
+
+static void on_flight_response(struct pcfetcher_session *session,
+        purc_variant_t request_id, void *ctxt,
+        enum pcfetcher_resp_type type, const char *data, size_t sz_data)
+{
+    UNUSED_PARAM(session);
+    struct flight *flight = (struct flight *)ctxt;
+    bool last = (type == PCFETCHER_RESP_TYPE_ERROR ||
+            type == PCFETCHER_RESP_TYPE_FINISH);
+
+    bool leader_cancelled;
+    {
+        auto locker = holdLock(s_flight_lock);
+        flight->started = true;
+
+        struct flight_waiter *p, *n;
+        list_for_each_entry_safe(p, n, &flight->waiters, ln) {
+            if (last) {
+                list_del(&p->ln);
+            }
+            dispatch_to_waiter(p, type, data, sz_data);
+        }
+
+        leader_cancelled = flight->leader_cancelled;
+        if (last) {
+            list_del_init(&flight->ln);
+        }
+    }
+
+    if (!leader_cancelled) {
+        flight->handler(flight->leader_session, request_id, flight->ctxt,
+                type, data, sz_data);
+    }
+
+    if (last) {
+        purc_variant_unref(flight->req_id);
+        free(flight->key);
+        free(flight);
+    }
+}
+
+static void on_flight_progress(struct pcfetcher_session *session,
+        purc_variant_t request_id, void *ctxt, double progress)
+{
+    UNUSED_PARAM(session);
+    struct flight *flight = (struct flight *)ctxt;
+
+    bool leader_cancelled;
+    {
+        auto locker = holdLock(s_flight_lock);
+
+        struct flight_waiter *p;
+        list_for_each_entry(p, &flight->waiters, ln) {
+            if (p->tracker == NULL) {
+                continue;
+            }
+
+            struct flight_waiter *waiter = p;
+            p->runloop->dispatch([waiter, progress] {
+                    waiter->tracker(waiter->session, waiter->req_id,
+                            waiter->tracker_ctxt, progress);
+                }
+            );
+        }
+
+        leader_cancelled = flight->leader_cancelled;
+    }
+
+    if (!leader_cancelled && flight->tracker) {
+        flight->tracker(flight->leader_session, request_id,
+                flight->tracker_ctxt, progress);
+    }
+}
+
+purc_variant_t pcfetcher_coalesce_request_async(
+        struct pcfetcher_session *session,
+        struct pcfetcher* fetcher,
+        const char* url,
+        enum pcfetcher_method method,
+        purc_variant_t params,
+        uint32_t timeout,
+        pcfetcher_response_handler handler,
+        void* ctxt,
+        pcfetcher_progress_tracker tracker,
+        void* tracker_ctxt)
+{
+    char *key = make_flight_key(session, url, method, params);
+    if (key == NULL) {
+        return fetcher->request_async(session, fetcher, url, method,
+                params, timeout, handler, ctxt, tracker, tracker_ctxt);
+    }
+
+    struct pcfetcher_session *owner =
+        list_empty(&session->cookies) ? NULL : session;
+
+    auto locker = holdLock(s_flight_lock);
+    struct flight *flight = find_flight(key, owner);
+    if (flight) {
+        free(key);
+
+        struct flight_waiter *waiter =
+            (struct flight_waiter *)calloc(1, sizeof(*waiter));
+        if (waiter == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return PURC_VARIANT_INVALID;
+        }
+
+        waiter->req_id = purc_variant_make_native(waiter, NULL);
+        if (waiter->req_id == PURC_VARIANT_INVALID) {
+            free(waiter);
+            return PURC_VARIANT_INVALID;
+        }
+
+        waiter->session = session;
+        waiter->handler = handler;
+        waiter->ctxt = ctxt;
+        waiter->tracker = tracker;
+        waiter->tracker_ctxt = tracker_ctxt;
+        waiter->runloop = &RunLoop::current();
+        list_add_tail(&waiter->ln, &flight->waiters);
+        return waiter->req_id;
+    }
+
+    flight = (struct flight *)calloc(1, sizeof(*flight));
+    if (flight == NULL) {
+        free(key);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    flight->key = key;
+    flight->session = owner;
+    flight->leader_session = session;
+    flight->handler = handler;
+    flight->ctxt = ctxt;
+    flight->tracker = tracker;
+    flight->tracker_ctxt = tracker_ctxt;
+    flight->runloop = &RunLoop::current();
+    list_head_init(&flight->waiters);
+
+    /* the fetcher does not call the handler before returning */
+    flight->req_id = fetcher->request_async(session, fetcher, url, method,
+            params, timeout, on_flight_response, flight,
+            on_flight_progress, flight);
+    if (flight->req_id == PURC_VARIANT_INVALID) {
+        free(flight->key);
+        free(flight);
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* keep the identifier valid even if the leader has released it */
+    purc_variant_ref(flight->req_id);
+    list_add_tail(&flight->ln, &s_flights);
+    return flight->req_id;
+}
+
+bool pcfetcher_coalesce_cancel_async(struct pcfetcher* fetcher,
+        purc_variant_t request)
+{
+    struct pcfetcher_resp_header header = { };
+    header.ret_code = RESP_CODE_USER_CANCEL;
+
+    purc_variant_t to_cancel = PURC_VARIANT_INVALID;
+    {
+        auto locker = holdLock(s_flight_lock);
+
+        struct flight *flight, *found = NULL;
+        struct flight_waiter *waiter = NULL;
+        list_for_each_entry(flight, &s_flights, ln) {
+            if (flight->req_id == request) {
+                found = flight;
+                break;
+            }
+
+            struct flight_waiter *p;
+            list_for_each_entry(p, &flight->waiters, ln) {
+                if (p->req_id == request) {
+                    waiter = p;
+                    break;
+                }
+            }
+
+            if (waiter) {
+                found = flight;
+                break;
+            }
+        }
+
+        if (found == NULL) {
+            return false;
+        }
+
+        if (waiter) {
+            /* the last chunk for the waiter is the error of cancelling */
+            list_del(&waiter->ln);
+            dispatch_to_waiter(waiter, PCFETCHER_RESP_TYPE_ERROR,
+                    (const char *)&header, 0);
+            if (found->leader_cancelled && list_empty(&found->waiters)) {
+                to_cancel = found->req_id;
+            }
+        }
+        else if (found->leader_cancelled) {
+            /* cancelled already */
+        }
+        else if (!list_empty(&found->waiters)) {
+            /* keep the request for the waiters */
+            found->leader_cancelled = true;
+            pcfetcher_response_handler handler = found->handler;
+            struct pcfetcher_session *session = found->leader_session;
+            void *ctxt = found->ctxt;
+            found->runloop->dispatch([handler, session, request, ctxt] {
+                    struct pcfetcher_resp_header header = { };
+                    header.ret_code = RESP_CODE_USER_CANCEL;
+                    handler(session, request, ctxt,
+                            PCFETCHER_RESP_TYPE_ERROR,
+                            (const char *)&header, 0);
+                }
+            );
+        }
+        else {
+            /* the leader gets the error from the fetcher as usual */
+            to_cancel = found->req_id;
+        }
+    }
+
+    if (to_cancel) {
+        fetcher->cancel_async(fetcher, to_cancel);
+    }
+    return true;
+}
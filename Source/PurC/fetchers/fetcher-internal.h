@@ -85,6 +85,7 @@ struct pcfetcher {
 struct pcfetcher_callback_info {
     struct pcfetcher_session *session;
     struct pcfetcher_resp_header header;
+    struct pcfetcher_load_metrics metrics;
     purc_rwstream_t rws;
     purc_variant_t req_id;
     volatile bool dispatched;
@@ -139,6 +140,14 @@ void pcfetcher_local_cancel_async(struct pcfetcher* fetcher,
 int pcfetcher_local_check_response(struct pcfetcher* fetcher,
         uint32_t timeout_ms);
 
+/* Counts a finished request to the origin in the statistics of the
+   connection pool; see pcfetcher_foreach_origin_stats(). */
+void pcfetcher_stats_record(const char *origin, bool reused, bool secure,
+        bool http2);
+
+/* Removes all statistics of the origins. */
+void pcfetcher_stats_reset(void);
+
 #if ENABLE(REMOTE_FETCHER)
 
 struct pcfetcher* pcfetcher_remote_init(size_t max_conns, size_t cache_quota);
@@ -189,6 +198,22 @@ int pcfetcher_remote_check_response(struct pcfetcher* fetcher,
 
 #endif // ENABLE(REMOTE_FETCHER)
 
+purc_variant_t pcfetcher_coalesce_request_async(
+        struct pcfetcher_session *session,
+        struct pcfetcher* fetcher,
+        const char* url,
+        enum pcfetcher_method method,
+        purc_variant_t params,
+        uint32_t timeout,
+        pcfetcher_response_handler handler,
+        void* ctxt,
+        pcfetcher_progress_tracker tracker,
+        void* tracker_ctxt);
+
+/* Returns false if the request is not a coalesced one. */
+bool pcfetcher_coalesce_cancel_async(struct pcfetcher* fetcher,
+        purc_variant_t request);
+
 struct pcfetcher_callback_info *pcfetcher_create_callback_info();
 void pcfetcher_destroy_callback_info(struct pcfetcher_callback_info *info);
 
@@ -25,18 +25,25 @@
 #include "config.h"
 
 #include "fetcher-internal.h"
+#include "fetcher-cache.h"
+#include "private/rwstream.h"
 
 #include <wtf/URL.h>
 #include <wtf/RunLoop.h>
+#include <wtf/WorkQueue.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <stdlib.h>
 
 struct pcfetcher_local {
     struct pcfetcher base;
+
+    /* the queue to open and map the files for the asynchronous requests */
+    WorkQueue *io_queue;
 };
 
 struct mime_type {
@@ -94,6 +101,8 @@ struct pcfetcher* pcfetcher_local_init(size_t max_conns, size_t cache_quota)
     fetcher->cancel_async = pcfetcher_local_cancel_async;
     fetcher->check_response = pcfetcher_local_check_response;
 
+    local->io_queue = &WorkQueue::create("PcFetcherLocal_IOQueue").leakRef();
+
     return fetcher;
 }
 
@@ -104,12 +113,91 @@ int pcfetcher_local_term(struct pcfetcher* fetcher)
     }
 
     struct pcfetcher_local* local = (struct pcfetcher_local*)fetcher;
+    if (local->io_queue) {
+        local->io_queue->deref();
+    }
     free(local);
     return 0;
 }
 
-#define ASYNC_DELAY         0.05
-#define ASYNC_BUF_SIZE      4096
+#define ASYNC_BUF_SIZE      (64 * 1024)
+
+String pcfetcher_build_uri(const char *base_url,  const char *url);
+
+static CString local_file_path(struct pcfetcher_session *session,
+        const char *url)
+{
+    String uri;
+    if (session->base_url) {
+        uri = pcfetcher_build_uri(session->base_url, url);
+    }
+    else {
+        uri.append(url);
+    }
+
+    PurCWTF::URL wurl(URL(), uri);
+    if (!wurl.isLocalFile()) {
+        return CString();
+    }
+
+    return wurl.path().utf8();
+}
+
+static purc_rwstream_t local_file_load(const char *file,
+        struct pcfetcher_resp_header *resp_header);
+
+/* NOTE: Sends the contents in chunks, one chunk per iteration of the run
+   loop, so that a big file does not stall the other work of the instance.
+   The chunks of a memory stream (a cached or a mapped file) are passed
+   to the handler directly without copying. */
+static void send_next_chunk(RunLoop *runloop,
+        struct pcfetcher_callback_info *info, size_t nr_sent)
+{
+    if (info->cancelled) {
+        pcfetcher_destroy_callback_info(info);
+        return;
+    }
+
+    size_t nr_bytes = info->header.sz_resp;
+    size_t sz_mem = 0;
+    const char *mem = (const char *)purc_rwstream_get_mem_buffer(info->rws,
+            &sz_mem);
+
+    char buf[ASYNC_BUF_SIZE];
+    const char *content = NULL;
+    ssize_t sz_content = 0;
+    if (mem) {
+        nr_bytes = sz_mem;
+        if (nr_sent < sz_mem) {
+            content = mem + nr_sent;
+            sz_content = std::min(sz_mem - nr_sent, (size_t)ASYNC_BUF_SIZE);
+        }
+    }
+    else {
+        content = buf;
+        sz_content = purc_rwstream_read(info->rws, buf, sizeof(buf));
+    }
+
+    if (sz_content > 0) {
+        nr_sent += sz_content;
+        if (info->tracker) {
+            double progress = nr_bytes ? (double)nr_sent / nr_bytes : 1.0;
+            info->tracker(info->session, info->req_id,
+                    info->tracker_ctxt, progress > 1.0 ? 1.0 : progress);
+        }
+        info->handler(info->session, info->req_id, info->ctxt,
+                PCFETCHER_RESP_TYPE_DATA, content, sz_content);
+
+        runloop->dispatch([runloop, info, nr_sent] {
+                send_next_chunk(runloop, info, nr_sent);
+        });
+        return;
+    }
+
+    info->handler(info->session, info->req_id, info->ctxt,
+            PCFETCHER_RESP_TYPE_FINISH, NULL, 0);
+    pcfetcher_destroy_callback_info(info);
+}
 
 purc_variant_t pcfetcher_local_request_async(
         struct pcfetcher_session *session,
@@ -123,21 +211,20 @@ purc_variant_t pcfetcher_local_request_async(
         pcfetcher_progress_tracker tracker,
         void* tracker_ctxt)
 {
-    UNUSED_PARAM(fetcher);
-    UNUSED_PARAM(url);
     UNUSED_PARAM(method);
     UNUSED_PARAM(params);
     UNUSED_PARAM(timeout);
-    UNUSED_PARAM(handler);
-    UNUSED_PARAM(ctxt);
 
     if (!fetcher || !url || !handler) {
         return PURC_VARIANT_INVALID;
     }
 
+    struct pcfetcher_local* local = (struct pcfetcher_local*)fetcher;
     struct pcfetcher_callback_info *info = pcfetcher_create_callback_info();
-    info->rws = pcfetcher_local_request_sync(session, fetcher, url, method,
-            params, timeout, &info->header);
+    if (info == NULL) {
+        return PURC_VARIANT_INVALID;
+    }
+
     info->handler = handler;
     info->session = session;
     info->ctxt = ctxt;
@@ -145,62 +232,39 @@ purc_variant_t pcfetcher_local_request_async(
     info->tracker_ctxt = tracker_ctxt;
     info->req_id = purc_variant_make_native(info, NULL);
 
-    if (!info->rws) {
-        info->header.ret_code = 404;
-    }
-
-    purc_rwstream_seek(info->rws, 0, SEEK_END);
-    size_t nr_bytes = purc_rwstream_tell(info->rws);
-    purc_rwstream_seek(info->rws, 0, SEEK_SET);
-
+    /* NOTE: The file is opened and mapped on the I/O queue; only
+       the delivery of the contents happens on the run loop of the
+       instance. */
     RunLoop *runloop = &RunLoop::current();
+    CString path = local_file_path(session, url);
+    char *file = path.isNull() ? NULL : strdup(path.data());
+    local->io_queue->dispatch([runloop, info, file] {
+        if (file) {
+            info->rws = local_file_load(file, &info->header);
+            free(file);
+        }
 
-    size_t nr_buf = ASYNC_BUF_SIZE;
-    double progress = 0.0;
-    double delay = 0.0;
-    size_t nr_send = 0;
-    ssize_t read_size = 0;
+        runloop->dispatch([runloop, info] {
+            if (info->cancelled) {
+                pcfetcher_destroy_callback_info(info);
+                return;
+            }
 
-    runloop->dispatchAfter(Seconds(ASYNC_DELAY), [info] {
-        info->handler(info->session, info->req_id, info->ctxt,
-                PCFETCHER_RESP_TYPE_HEADER,
-                (const char *)&info->header, 0);
-    });
-    while (true) {
-        char *buf = (char *)malloc(nr_buf + 1);
-        if ((read_size = purc_rwstream_read(info->rws, buf, nr_buf)) <= 0) {
-            free(buf);
-            break;
-        }
-        buf[read_size] = 0;
-        delay += ASYNC_DELAY;
-        nr_send += read_size;
-        progress = (double)nr_send / nr_bytes;
-
-        runloop->dispatchAfter(Seconds(delay), [content=buf, sz_content=read_size,
-                progress, info] {
-                if (info->cancelled) {
-                    return;
-                }
-                if (info->tracker) {
-                    info->tracker(info->session, info->req_id,
-                            info->tracker_ctxt, progress);
-                }
+            if (info->rws == NULL) {
+                info->header.ret_code = 404;
                 info->handler(info->session, info->req_id, info->ctxt,
-                        PCFETCHER_RESP_TYPE_DATA,
-                        content, sz_content);
-                free(content);
-
-                if (progress == 1.0) {
-                    info->handler(info->session, info->req_id, info->ctxt,
-                            PCFETCHER_RESP_TYPE_FINISH,
-                            NULL, 0);
-                    pcfetcher_destroy_callback_info(info);
-                }
+                        PCFETCHER_RESP_TYPE_ERROR,
+                        (const char *)&info->header, 0);
+                pcfetcher_destroy_callback_info(info);
+                return;
+            }
+
+            info->handler(info->session, info->req_id, info->ctxt,
+                    PCFETCHER_RESP_TYPE_HEADER,
+                    (const char *)&info->header, 0);
+            send_next_chunk(runloop, info, 0);
         });
-
-
-    }
+    });
 
     return info->req_id;
 }
@@ -212,7 +276,72 @@ off_t filesize(const char* filename)
     return statbuf.st_size;
 }
 
-String pcfetcher_build_uri(const char *base_url,  const char *url);
+static purc_rwstream_t local_file_load(const char *file,
+        struct pcfetcher_resp_header *resp_header)
+{
+    /* NOTE: The modification time and the size of a local file act as its
+       entity tag, so a cached copy is revalidated by calling stat() only. */
+    struct stat st;
+    if (stat(file, &st) == 0 && S_ISREG(st.st_mode)) {
+        char etag[64];
+        snprintf(etag, sizeof(etag), "%llx-%llx",
+                (unsigned long long)st.st_mtime,
+                (unsigned long long)st.st_size);
+
+        char *cached_etag = NULL;
+        if (pcfetcher_cache_lookup(file, NULL, &cached_etag, NULL)) {
+            bool valid = cached_etag && strcmp(cached_etag, etag) == 0;
+            free(cached_etag);
+
+            purc_rwstream_t rws = NULL;
+            if (valid) {
+                rws = pcfetcher_cache_make_response(file,
+                        PCFETCHER_CACHE_KEEP_EXPIRES, resp_header);
+            }
+            if (rws) {
+                return rws;
+            }
+        }
+
+        if (pcfetcher_cache_accepts(st.st_size)) {
+            size_t length;
+            char *content = purc_load_file_contents(file, &length);
+            if (content) {
+                pcfetcher_cache_store(file, get_mime(file), content, length,
+                        0, etag, NULL);
+                free(content);
+
+                purc_rwstream_t rws = pcfetcher_cache_make_response(file,
+                        PCFETCHER_CACHE_KEEP_EXPIRES, resp_header);
+                if (rws) {
+                    return rws;
+                }
+            }
+        }
+
+        /* NOTE: A large file is mapped into memory instead of being read
+           through a stdio stream. */
+        if (st.st_size >= PCRWSTREAM_MMAP_MIN_SIZE) {
+            purc_rwstream_t rws = purc_rwstream_new_from_mmap(file);
+            if (rws) {
+                resp_header->ret_code = 200;
+                resp_header->sz_resp = st.st_size;
+                resp_header->mime_type = strdup(get_mime(file));
+                return rws;
+            }
+        }
+    }
+
+    purc_rwstream_t rws = purc_rwstream_new_from_file(file, "r");
+    if (rws) {
+        resp_header->ret_code = 200;
+        resp_header->sz_resp = filesize(file);
+        resp_header->mime_type = strdup(get_mime(file));
+        return rws;
+    }
+
+    return NULL;
+}
 
 purc_rwstream_t pcfetcher_local_request_sync(
         struct pcfetcher_session *session,
@@ -223,47 +352,23 @@ purc_rwstream_t pcfetcher_local_request_sync(
         uint32_t timeout,
         struct pcfetcher_resp_header *resp_header)
 {
-    UNUSED_PARAM(fetcher);
-    UNUSED_PARAM(url);
     UNUSED_PARAM(method);
     UNUSED_PARAM(params);
     UNUSED_PARAM(timeout);
-    UNUSED_PARAM(resp_header);
 
-    if (!fetcher || !url) {
+    if (!fetcher || !url || !resp_header) {
         return NULL;
     }
 
-    String uri;
-    if (session->base_url) {
-        uri = pcfetcher_build_uri(session->base_url, url);
-    }
-    else {
-        uri.append(url);
-    }
-
-    PurCWTF::URL wurl(URL(), uri);
-    if (!wurl.isLocalFile()) {
+    CString path = local_file_path(session, url);
+    if (path.isNull()) {
         resp_header->ret_code = 404;
         resp_header->sz_resp = 0;
         resp_header->mime_type = NULL;
         return NULL;
     }
 
-    const StringView path = wurl.path();
-    const CString& cpath = path.utf8();
-
-    const char* file = cpath.data();
-
-    purc_rwstream_t rws = purc_rwstream_new_from_file(file, "r");
-    if (rws && resp_header) {
-        resp_header->ret_code = 200;
-        resp_header->sz_resp = filesize(file);
-        resp_header->mime_type = strdup(get_mime(file));
-        return rws;
-    }
-
-    return NULL;
+    return local_file_load(path.data(), resp_header);
 }
 
 void pcfetcher_local_cancel_async(struct pcfetcher* fetcher,
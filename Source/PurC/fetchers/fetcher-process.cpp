@@ -35,6 +35,9 @@
 
 #include <wtf/RunLoop.h>
 
+#include <limits.h>
+#include <stdlib.h>
+
 using namespace PurCFetcher;
 
 PcFetcherProcess::PcFetcherProcess(struct pcfetcher* fetcher,
@@ -102,9 +105,45 @@ void PcFetcherProcess::terminate()
         m_processLauncher->terminateProcess();
 }
 
+#define PURC_ENVV_FETCHER_MAX_CONNS_PER_HOST "PURC_FETCHER_MAX_CONNS_PER_HOST"
+#define PURC_ENVV_FETCHER_IDLE_TIMEOUT  "PURC_FETCHER_IDLE_TIMEOUT"
+#define PURC_ENVV_FETCHER_DISABLE_HTTP2 "PURC_FETCHER_DISABLE_HTTP2"
+
+static unsigned env_to_unsigned(const char *name, unsigned def_value)
+{
+    const char *env = getenv(name);
+    if (env == NULL || env[0] == '\0')
+        return def_value;
+
+    char *end;
+    unsigned long v = strtoul(env, &end, 10);
+    if (*end != '\0' || v > UINT_MAX)
+        return def_value;
+    return (unsigned)v;
+}
+
 void PcFetcherProcess::initFetcherProcess()
 {
     NetworkProcessCreationParameters parameters;
+
+    /* NOTE: The fetcher process keeps the idle connections alive for reuse
+       by the following requests to the same origin, and multiplexes the
+       requests over one connection if the server speaks HTTP/2. The total
+       number of the connections is bounded by max_conns of the fetcher. */
+    auto& session = parameters.defaultDataStoreParameters.networkSessionParameters;
+    if (m_fetcher->max_conns > 0 && m_fetcher->max_conns < UINT_MAX)
+        session.maxConnections = (unsigned)m_fetcher->max_conns;
+    session.maxConnectionsPerHost = env_to_unsigned(
+            PURC_ENVV_FETCHER_MAX_CONNS_PER_HOST, session.maxConnectionsPerHost);
+    if (session.maxConnectionsPerHost == 0)
+        session.maxConnectionsPerHost = 1;
+    if (session.maxConnectionsPerHost > session.maxConnections)
+        session.maxConnectionsPerHost = session.maxConnections;
+    session.connectionIdleTimeout = env_to_unsigned(
+            PURC_ENVV_FETCHER_IDLE_TIMEOUT, session.connectionIdleTimeout);
+    if (getenv(PURC_ENVV_FETCHER_DISABLE_HTTP2))
+        session.http2Enabled = false;
+
     send(Messages::NetworkProcess::InitializeNetworkProcess(parameters), 0);
 }
 
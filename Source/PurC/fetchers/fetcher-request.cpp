@@ -29,12 +29,14 @@
 #include "fetcher-request.h"
 #include "fetcher-process.h"
 #include "fetcher-messages.h"
+#include "fetcher-cache.h"
 
 #include "NetworkResourceLoadParameters.h"
 #include "ResourceError.h"
 #include "ResourceResponse.h"
 #include "Cookie.h"
 
+#include "private/debug.h"
 #include "private/url.h"
 
 #include <wtf/RunLoop.h>
@@ -432,6 +434,22 @@ purc_variant_t PcFetcherRequest::requestAsync(
         return NULL;
     }
 
+    purc_variant_t req_id = purc_variant_make_native(this, NULL);
+    m_callback->req_id = req_id;
+
+    /* NOTE: The responses of the asynchronous GET requests are cached as
+       well, so that a resource prefetched before is delivered from the
+       cache without another request. */
+    if (method == PCFETCHER_METHOD_GET) {
+        m_cacheKey = wurl->string().utf8();
+        if (lookupCache(request) &&
+                respondFromCache(PCFETCHER_CACHE_KEEP_EXPIRES)) {
+            return req_id;
+        }
+    }
+
+    m_origin = wurl->protocolHostAndPort().utf8();
+    m_url = wurl->string().utf8();
     setCookie(session, wurl->host().toString().utf8().data(),
             wurl->path().toString().utf8().data());
 
@@ -452,8 +470,7 @@ purc_variant_t PcFetcherRequest::requestAsync(
             Messages::NetworkConnectionToWebProcess::ScheduleResourceLoad(
                 loadParameters), 0);
 
-    m_callback->req_id = purc_variant_make_native(this, NULL);
-    return m_callback->req_id;
+    return req_id;
 }
 
 purc_rwstream_t PcFetcherRequest::requestSync(
@@ -485,6 +502,24 @@ purc_rwstream_t PcFetcherRequest::requestSync(
         return NULL;
     }
 
+    /* NOTE: Only the responses of GET requests are cached. A fresh one is
+       returned without a request; a stale one is revalidated with the
+       conditional headers, and reused if the server answers 304. */
+    if (method == PCFETCHER_METHOD_GET) {
+        m_cacheKey = wurl->string().utf8();
+        if (lookupCache(request)) {
+            purc_rwstream_t rws = pcfetcher_cache_make_response(
+                    m_cacheKey.data(), PCFETCHER_CACHE_KEEP_EXPIRES,
+                    resp_header);
+            if (rws) {
+                m_fetcherProcess->requestFinished(this);
+                return rws;
+            }
+        }
+    }
+
+    m_origin = wurl->protocolHostAndPort().utf8();
+    m_url = wurl->string().utf8();
     setCookie(session, wurl->host().toString().utf8().data(),
             wurl->path().toString().utf8().data());
 
@@ -492,7 +527,6 @@ purc_rwstream_t PcFetcherRequest::requestSync(
     request.setHTTPMethod(transMethod(method));
     request.setTimeoutInterval(timeout);
 
-
     m_req_id = ProcessIdentifier::generate().toUInt64();
     NetworkResourceLoadParameters loadParameters;
     loadParameters.identifier = m_req_id;
@@ -501,6 +535,10 @@ purc_rwstream_t PcFetcherRequest::requestSync(
     loadParameters.webPageID = PageIdentifier::generate();
     loadParameters.webFrameID = FrameIdentifier::generate();
     loadParameters.parentPID = getpid();
+    /* NOTE: The caller waits for the whole body anyway, so let the fetcher
+       process buffer it; then a large body arrives in one shared memory
+       rather than in many small chunks over the socket. */
+    loadParameters.maximumBufferingTime = Seconds(timeout);
 
     m_connection->send(
             Messages::NetworkConnectionToWebProcess::ScheduleResourceLoad(
@@ -515,6 +553,37 @@ purc_rwstream_t PcFetcherRequest::requestSync(
             return NULL;
         }
 
+        adoptMappedBody();
+
+        if (m_revalidating && m_callback->header.ret_code == 304) {
+            if (m_callback->header.mime_type) {
+                free(m_callback->header.mime_type);
+                m_callback->header.mime_type = NULL;
+            }
+            purc_rwstream_t cached_rws = pcfetcher_cache_make_response(
+                    m_cacheKey.data(), m_cacheExpires, &m_callback->header);
+            if (cached_rws) {
+                if (m_callback->rws) {
+                    purc_rwstream_destroy(m_callback->rws);
+                }
+                m_callback->rws = cached_rws;
+            }
+        }
+        else if (m_cacheable && !m_cacheKey.isNull() &&
+                m_callback->header.ret_code == 200 && m_callback->rws) {
+            size_t sz_content = 0;
+            size_t sz_buffer = 0;
+            void *content = purc_rwstream_get_mem_buffer_ex(m_callback->rws,
+                    &sz_content, &sz_buffer, false);
+            if (content && pcfetcher_cache_accepts(sz_content)) {
+                pcfetcher_cache_store(m_cacheKey.data(),
+                        m_callback->header.mime_type, content, sz_content,
+                        m_cacheExpires,
+                        m_etag.length() ? m_etag.data() : NULL,
+                        m_lastModified.length() ? m_lastModified.data() : NULL);
+            }
+        }
+
         if (!m_callback->header.sz_resp && m_callback->rws) {
             size_t sz_content = 0;
             size_t sz_buffer = 0;
@@ -647,6 +716,138 @@ void PcFetcherRequest::didReceiveSyncMessage(IPC::Connection& connection,
     UNUSED_PARAM(replyEncoder);
 }
 
+/* Looks up the cached response of the request. Returns true if there is
+   a fresh one; otherwise, adds the conditional headers to the request
+   to revalidate the stale one if there is. */
+bool PcFetcherRequest::lookupCache(ResourceRequest& request)
+{
+    bool fresh = false;
+    char *etag = NULL;
+    char *lastModified = NULL;
+
+    m_revalidating = false;
+    if (!pcfetcher_cache_lookup(m_cacheKey.data(), &fresh, &etag,
+                &lastModified)) {
+        return false;
+    }
+
+    if (!fresh) {
+        if (etag) {
+            request.setHTTPHeaderField(HTTPHeaderName::IfNoneMatch,
+                    String::fromUTF8(etag));
+        }
+        if (lastModified) {
+            request.setHTTPHeaderField(HTTPHeaderName::IfModifiedSince,
+                    String::fromUTF8(lastModified));
+        }
+        m_revalidating = true;
+    }
+
+    free(etag);
+    free(lastModified);
+    return fresh;
+}
+
+/* Delivers the cached response to the handler of an asynchronous request
+   on the run loop, as if it was received from the network; the caller
+   should hold the callback lock. */
+bool PcFetcherRequest::respondFromCache(time_t expires)
+{
+    struct pcfetcher_callback_info *info = m_callback;
+    if (info->header.mime_type) {
+        free(info->header.mime_type);
+        info->header.mime_type = NULL;
+    }
+
+    purc_rwstream_t rws = pcfetcher_cache_make_response(m_cacheKey.data(),
+            expires, &info->header);
+    if (rws == NULL) {
+        return false;
+    }
+
+    if (info->rws) {
+        purc_rwstream_destroy(info->rws);
+    }
+    info->rws = rws;
+
+    m_callback = NULL;
+    m_runloop->dispatch([info, request=this] {
+            info->handler(info->session, info->req_id, info->ctxt,
+                    PCFETCHER_RESP_TYPE_HEADER,
+                    (const char *)&info->header, 0);
+
+            size_t sz_content = 0;
+            const char *content = (const char *)
+                purc_rwstream_get_mem_buffer(info->rws, &sz_content);
+            if (content && sz_content) {
+                info->handler(info->session, info->req_id, info->ctxt,
+                        PCFETCHER_RESP_TYPE_DATA, content, sz_content);
+            }
+            if (info->tracker) {
+                info->tracker(info->session, info->req_id, info->tracker_ctxt,
+                        1.0);
+            }
+
+            info->handler(info->session, info->req_id, info->ctxt,
+                    PCFETCHER_RESP_TYPE_FINISH,
+                    NULL, 0);
+            pcfetcher_destroy_callback_info(info);
+            request->m_fetcherProcess->requestFinished(request);
+            }
+        );
+    return true;
+}
+
+/* Determines whether the response can be cached and how long it is fresh,
+   according to Cache-Control, Expires, and the validators (RFC 7234). */
+void PcFetcherRequest::evaluateCachingPolicy(
+        const PurCFetcher::ResourceResponse& response)
+{
+    m_cacheable = false;
+    m_cacheExpires = 0;
+    m_etag = response.httpHeaderField(HTTPHeaderName::ETag).utf8();
+    m_lastModified =
+        response.httpHeaderField(HTTPHeaderName::LastModified).utf8();
+
+    int code = response.httpStatusCode();
+    if ((code != 200 && code != 304) || response.cacheControlContainsNoStore())
+        return;
+
+    time_t now = time(NULL);
+    if (response.cacheControlContainsNoCache()) {
+        m_cacheExpires = now;
+    }
+    else if (auto maxAge = response.cacheControlMaxAge()) {
+        double age = 0;
+        if (auto ageValue = response.age())
+            age = ageValue->seconds();
+        m_cacheExpires = now + (time_t)(maxAge->seconds() - age);
+    }
+    else if (auto expires = response.expires()) {
+        double delta = expires->secondsSinceEpoch().seconds();
+        if (auto date = response.date())
+            delta -= date->secondsSinceEpoch().seconds();
+        else
+            delta -= now;
+        m_cacheExpires = now + (time_t)delta;
+    }
+    else if (auto lastModified = response.lastModified()) {
+        /* heuristic freshness: 10% of the time since the last change */
+        double delta = 0;
+        if (auto date = response.date())
+            delta = (date->secondsSinceEpoch() -
+                    lastModified->secondsSinceEpoch()).seconds() / 10;
+        m_cacheExpires = now + (delta > 0 ? (time_t)delta : 0);
+    }
+    else {
+        m_cacheExpires = now;
+    }
+
+    /* a stale response without validators is useless */
+    m_cacheable = m_cacheExpires > now || m_etag.length() > 0 ||
+        m_lastModified.length() > 0;
+}
+
 void PcFetcherRequest::didReceiveResponse(
         const PurCFetcher::ResourceResponse& response,
         bool needsContinueDidReceiveResponseMessage)
@@ -669,8 +870,13 @@ void PcFetcherRequest::didReceiveResponse(
     const CString &utf8 = response.mimeType().utf8();
     m_callback->header.mime_type = strdup((const char*)utf8.data());
     m_callback->header.sz_resp = response.expectedContentLength();
+
+    if (!m_cacheKey.isNull()) {
+        evaluateCachingPolicy(response);
+    }
     if (m_callback->rws) {
         purc_rwstream_destroy(m_callback->rws);
+        m_callback->rws = NULL;
     }
 
     size_t init;
@@ -684,8 +890,22 @@ void PcFetcherRequest::didReceiveResponse(
     }
     m_bytesReceived = 0;
     m_progressValue = initialProgressValue;
+    m_mappedBody = nullptr;
 
     if (m_is_async) {
+        if (m_revalidating && m_callback->header.ret_code == 304) {
+            /* the cached response will be delivered when finished */
+            return;
+        }
+
+        /* keep a copy of the body to put it in the cache when finished */
+        long long expected = (long long)m_callback->header.sz_resp;
+        if (m_cacheable && m_callback->header.ret_code == 200 &&
+                (expected <= 0 || pcfetcher_cache_accepts(expected))) {
+            m_callback->rws = purc_rwstream_new_buffer(
+                    expected > 0 ? expected : DEF_RWS_SIZE, INT_MAX);
+        }
+
         struct pcfetcher_callback_info *info = m_callback;
         m_runloop->dispatch([info] {
                     info->handler(info->session, info->req_id, info->ctxt,
@@ -733,16 +953,38 @@ void PcFetcherRequest::didReceiveSharedBuffer(
 
     if (m_is_async) {
         struct pcfetcher_callback_info *info = m_callback;
-        size_t nr_bytes = data.size();
-        char *buf = (char *)malloc(nr_bytes);
-        memcpy(buf, data.data(), nr_bytes);
-        m_runloop->dispatch([info, progress=m_progressValue, buf, nr_bytes] {
-                info->handler(info->session, info->req_id, info->ctxt,
-                        PCFETCHER_RESP_TYPE_DATA,
-                        (const char *)buf, nr_bytes);
-                free(buf);
+        RefPtr<SharedBuffer::DataSegment> segment = singleSegment(data);
+        if (segment) {
+            /* NOTE: The segment is immutable and may be the shared memory
+               mapped by the decoder, so it is handed to the handler
+               without a copy. */
+            m_runloop->dispatch([info, segment] {
+                    info->handler(info->session, info->req_id, info->ctxt,
+                            PCFETCHER_RESP_TYPE_DATA,
+                            (const char *)segment->data(), segment->size());
                 }
             );
+        }
+        else {
+            size_t nr_bytes = data.size();
+            char *buf = (char *)malloc(nr_bytes);
+            memcpy(buf, data.data(), nr_bytes);
+            m_runloop->dispatch([info, buf, nr_bytes] {
+                    info->handler(info->session, info->req_id, info->ctxt,
+                            PCFETCHER_RESP_TYPE_DATA,
+                            (const char *)buf, nr_bytes);
+                    free(buf);
+                }
+            );
+        }
+
+        if (m_callback->rws) {
+            purc_rwstream_write(m_callback->rws, data.data(), data.size());
+            if (!pcfetcher_cache_accepts(m_bytesReceived)) {
+                purc_rwstream_destroy(m_callback->rws);
+                m_callback->rws = NULL;
+            }
+        }
 
         if (m_callback->tracker) {
             struct pcfetcher_callback_info *info = m_callback;
@@ -756,20 +998,135 @@ void PcFetcherRequest::didReceiveSharedBuffer(
         }
     }
     else {
-        purc_rwstream_write(m_callback->rws, data.data(), data.size());
+        /* NOTE: Keep the first chunk as is; if it turns out to be the whole
+           body, it will be returned as a stream over the segment. */
+        RefPtr<SharedBuffer::DataSegment> segment;
+        if (m_bytesReceived == (long long)data.size()) {
+            segment = singleSegment(data);
+        }
+
+        if (segment) {
+            m_mappedBody = WTFMove(segment);
+        }
+        else {
+            flushMappedBody();
+            purc_rwstream_write(m_callback->rws, data.data(), data.size());
+        }
+    }
+}
+
+/* Returns the only data segment of the buffer if there is. */
+RefPtr<SharedBuffer::DataSegment> PcFetcherRequest::singleSegment(
+        const IPC::SharedBufferDataReference& data)
+{
+    const RefPtr<SharedBuffer>& buffer = data.buffer();
+    if (!buffer || buffer->isEmpty() || !buffer->hasOneSegment()) {
+        return nullptr;
+    }
+
+    return buffer->begin()->segment.ptr();
+}
+
+/* Copies the body kept as is to the stream of the response. */
+void PcFetcherRequest::flushMappedBody()
+{
+    if (m_mappedBody && m_callback->rws) {
+        purc_rwstream_write(m_callback->rws, m_mappedBody->data(),
+                m_mappedBody->size());
     }
+    m_mappedBody = nullptr;
+}
+
+static void release_segment(void *ctxt, void *mem, size_t sz)
+{
+    UNUSED_PARAM(mem);
+    UNUSED_PARAM(sz);
+    static_cast<SharedBuffer::DataSegment *>(ctxt)->deref();
+}
+
+/* Makes the stream of the response over the body kept as is. */
+void PcFetcherRequest::adoptMappedBody()
+{
+    if (!m_mappedBody) {
+        return;
+    }
+
+    SharedBuffer::DataSegment *segment = m_mappedBody.get();
+    purc_rwstream_t rws = purc_rwstream_new_from_mem_ex(
+            (void *)segment->data(), segment->size(), release_segment, segment);
+    if (rws == NULL) {
+        flushMappedBody();
+        return;
+    }
+
+    m_mappedBody.leakRef();
+    if (m_callback->rws) {
+        purc_rwstream_destroy(m_callback->rws);
+    }
+    m_callback->rws = rws;
+}
+
+static inline double elapsedMilliseconds(Seconds start, Seconds end)
+{
+    if (start < 0_s || end < 0_s) {
+        return -1;
+    }
+    return (end - start).milliseconds();
+}
+
+/* Converts the metrics reported by the fetcher process; the timings of it
+   are relative to the start of the request. */
+static void fillLoadMetrics(struct pcfetcher_load_metrics *metrics,
+        const NetworkLoadMetrics& networkLoadMetrics)
+{
+    metrics->dns_time = elapsedMilliseconds(
+            networkLoadMetrics.domainLookupStart,
+            networkLoadMetrics.domainLookupEnd);
+    metrics->connect_time = elapsedMilliseconds(
+            networkLoadMetrics.connectStart,
+            networkLoadMetrics.connectEnd);
+    metrics->tls_time = elapsedMilliseconds(
+            networkLoadMetrics.secureConnectionStart,
+            networkLoadMetrics.connectEnd);
+    metrics->first_byte = elapsedMilliseconds(0_s,
+            networkLoadMetrics.responseStart);
+    metrics->total_time = elapsedMilliseconds(0_s,
+            networkLoadMetrics.responseEnd);
+    metrics->reused = networkLoadMetrics.isReusedConnection;
+
+    CString protocol = networkLoadMetrics.protocol.utf8();
+    strncpy(metrics->protocol, protocol.data(), sizeof(metrics->protocol) - 1);
+    metrics->protocol[sizeof(metrics->protocol) - 1] = 0;
 }
 
 void PcFetcherRequest::didFinishResourceLoad(
         const NetworkLoadMetrics& networkLoadMetrics)
 {
-    UNUSED_PARAM(networkLoadMetrics);
+    /* NOTE: The request needed no new connection if it was sent over
+       a kept-alive one of the pool in the fetcher process. */
+    pcfetcher_stats_record(m_origin.data(),
+            networkLoadMetrics.isReusedConnection,
+            networkLoadMetrics.secureConnectionStart >= 0_s,
+            networkLoadMetrics.protocol == "h2");
+
     auto locker = holdLock(m_callbackLock);
     m_progressValue = 1.0;
     if (m_callback == NULL) {
         return;
     }
 
+    /* NOTE: The timings are logged for every request, so that a slow
+       upstream can be identified from the log of the instance. */
+    struct pcfetcher_load_metrics *metrics = &m_callback->metrics;
+    fillLoadMetrics(metrics, networkLoadMetrics);
+    PC_INFO("Fetched %s (%d, %s%s): dns %.1f ms, connect %.1f ms, "
+            "tls %.1f ms, first byte %.1f ms, total %.1f ms\n",
+            m_url.data(), m_callback->header.ret_code,
+            metrics->protocol[0] ? metrics->protocol : "unknown",
+            metrics->reused ? ", reused" : "",
+            metrics->dns_time, metrics->connect_time, metrics->tls_time,
+            metrics->first_byte, metrics->total_time);
+
     if (!m_is_async) {
         wakeUp();
         return;
@@ -788,12 +1145,33 @@ void PcFetcherRequest::didFinishResourceLoad(
         return;
     }
 
+    if (m_revalidating && m_callback->header.ret_code == 304 &&
+            respondFromCache(m_cacheExpires)) {
+        return;
+    }
+
+    if (m_callback->rws) {
+        size_t sz_content = 0;
+        size_t sz_buffer = 0;
+        void *content = purc_rwstream_get_mem_buffer_ex(m_callback->rws,
+                &sz_content, &sz_buffer, false);
+        if (content && pcfetcher_cache_accepts(sz_content)) {
+            pcfetcher_cache_store(m_cacheKey.data(),
+                    m_callback->header.mime_type, content, sz_content,
+                    m_cacheExpires,
+                    m_etag.length() ? m_etag.data() : NULL,
+                    m_lastModified.length() ? m_lastModified.data() : NULL);
+        }
+        purc_rwstream_destroy(m_callback->rws);
+        m_callback->rws = NULL;
+    }
+
     struct pcfetcher_callback_info *info = m_callback;
     m_callback = NULL;
     m_runloop->dispatch([info, request=this] {
             info->handler(info->session, info->req_id, info->ctxt,
                     PCFETCHER_RESP_TYPE_FINISH,
-                    NULL, 0);
+                    (const char *)&info->metrics, sizeof(info->metrics));
             pcfetcher_destroy_callback_info(info);
             request->m_fetcherProcess->requestFinished(request);
             }
@@ -112,6 +112,9 @@ protected:
     void didReceiveSyncMessage(IPC::Connection&, IPC::Decoder&,
             std::unique_ptr<IPC::Encoder>&);
 
+    bool lookupCache(ResourceRequest&);
+    bool respondFromCache(time_t expires);
+    void evaluateCachingPolicy(const PurCFetcher::ResourceResponse&);
     void didReceiveResponse(const PurCFetcher::ResourceResponse&, bool);
     void didReceiveSharedBuffer(IPC::SharedBufferDataReference&&,
             int64_t encodedDataLength);
@@ -120,6 +123,11 @@ protected:
     void willSendRequest(ResourceRequest&&,
             IPC::FormDataReference&& requestBody, ResourceResponse&&);
 
+    RefPtr<SharedBuffer::DataSegment> singleSegment(
+            const IPC::SharedBufferDataReference& data);
+    void flushMappedBody();
+    void adoptMappedBody();
+
 private:
     uint64_t m_sessionId;
     uint64_t m_req_id;
@@ -141,6 +149,24 @@ private:
     long long m_bytesReceived {0};
     double m_progressValue;
 
+    // the key of the response in the cache; null if it is not cacheable
+    CString m_cacheKey;
+    bool m_revalidating {false};
+
+    // the origin of the request for the statistics of the connections
+    CString m_origin;
+    // the URL of the request for the log of the timings
+    CString m_url;
+
+    // the first chunk of the body of a synchronous request kept as is
+    RefPtr<SharedBuffer::DataSegment> m_mappedBody;
+
+    // the caching policy of the response received
+    bool m_cacheable {false};
+    time_t m_cacheExpires {0};
+    CString m_etag;
+    CString m_lastModified;
+
 };
 
 
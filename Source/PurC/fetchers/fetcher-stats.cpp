@@ -0,0 +1,115 @@
+/*
+ * @file fetcher-stats.cpp
+ * @date 2026/10/14
+ * @brief The statistics of the connection pool of the remote fetcher.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "private/fetcher.h"
+#include "private/list.h"
+#include "fetcher-internal.h"
+
+#include <wtf/Lock.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/* NOTE: The statistics are gathered from the load metrics of the finished
+   requests reported by the remote fetcher process, so no extra message is
+   needed to query the connection pool of the process. */
+struct origin_entry {
+    struct list_head    ln;
+    struct pcfetcher_origin_stats stats;
+};
+
+static Lock s_stats_lock;
+static LIST_HEAD(s_origins);
+
+void pcfetcher_stats_record(const char *origin, bool reused, bool secure,
+        bool http2)
+{
+    if (origin == NULL || origin[0] == '\0')
+        return;
+
+    auto locker = holdLock(s_stats_lock);
+
+    struct origin_entry *entry = NULL, *p;
+    list_for_each_entry(p, &s_origins, ln) {
+        if (strcmp(p->stats.origin, origin) == 0) {
+            entry = p;
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        entry = (struct origin_entry *)calloc(1, sizeof(*entry));
+        if (entry == NULL)
+            return;
+
+        entry->stats.origin = strdup(origin);
+        if (entry->stats.origin == NULL) {
+            free(entry);
+            return;
+        }
+        list_add_tail(&entry->ln, &s_origins);
+    }
+
+    entry->stats.nr_requests++;
+    if (reused) {
+        entry->stats.nr_reused++;
+    }
+    else {
+        entry->stats.nr_connects++;
+        if (secure)
+            entry->stats.nr_tls_handshakes++;
+    }
+    if (http2)
+        entry->stats.nr_http2++;
+}
+
+void pcfetcher_stats_reset(void)
+{
+    auto locker = holdLock(s_stats_lock);
+
+    struct origin_entry *p, *n;
+    list_for_each_entry_safe(p, n, &s_origins, ln) {
+        list_del(&p->ln);
+        free((char *)p->stats.origin);
+        free(p);
+    }
+}
+
+size_t pcfetcher_foreach_origin_stats(pcfetcher_origin_stats_cb cb,
+        void *ctxt)
+{
+    auto locker = holdLock(s_stats_lock);
+
+    size_t n = 0;
+    struct origin_entry *p;
+    list_for_each_entry(p, &s_origins, ln) {
+        n++;
+        if (cb && cb(&p->stats, ctxt))
+            break;
+    }
+
+    return n;
+}
+
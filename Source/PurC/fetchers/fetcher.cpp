@@ -26,12 +26,15 @@
 
 #include "private/fetcher.h"
 #include "private/instance.h"
+#include "private/trace.h"
 
 #include "fetcher-internal.h"
+#include "fetcher-cache.h"
 
 #include <wtf/Lock.h>
 #include <wtf/URL.h>
 
+#include <atomic>
 #include <unistd.h>
 
 static Lock s_fetcher_lock;
@@ -283,8 +286,22 @@ purc_variant_t pcfetcher_request_async(
         void* tracker_ctxt)
 {
     struct pcfetcher* fetcher = get_fetcher();
-    return fetcher ? fetcher->request_async(session, fetcher, url, method,
-            params, timeout, handler, ctxt, tracker, tracker_ctxt) : PURC_VARIANT_INVALID;
+    if (fetcher == NULL)
+        return PURC_VARIANT_INVALID;
+
+    uint64_t span = pctrace_begin();
+    purc_variant_t ret;
+    if (fetcher == s_remote_fetcher) {
+        /* the remote fetcher is shared by all instances */
+        ret = pcfetcher_coalesce_request_async(session, fetcher, url, method,
+                params, timeout, handler, ctxt, tracker, tracker_ctxt);
+    }
+    else {
+        ret = fetcher->request_async(session, fetcher, url, method,
+                params, timeout, handler, ctxt, tracker, tracker_ctxt);
+    }
+    pctrace_end(span, PCTRACE_CAT_FETCHER, "request_async");
+    return ret;
 }
 
 purc_rwstream_t pcfetcher_request_sync(
@@ -296,10 +313,56 @@ purc_rwstream_t pcfetcher_request_sync(
         struct pcfetcher_resp_header *resp_header)
 {
     struct pcfetcher* fetcher = get_fetcher();
-    return fetcher ? fetcher->request_sync(session, fetcher, url, method,
-            params, timeout, resp_header) : NULL;
+    if (fetcher == NULL)
+        return NULL;
+
+    uint64_t span = pctrace_begin();
+    purc_rwstream_t ret = fetcher->request_sync(session, fetcher, url, method,
+            params, timeout, resp_header);
+    pctrace_end(span, PCTRACE_CAT_FETCHER, "request_sync");
+    return ret;
+}
+
+static void on_prefetch_response(struct pcfetcher_session *session,
+        purc_variant_t request_id, void *ctxt,
+        enum pcfetcher_resp_type type, const char *data, size_t sz_data)
+{
+    UNUSED_PARAM(session);
+    UNUSED_PARAM(ctxt);
+    UNUSED_PARAM(data);
+    UNUSED_PARAM(sz_data);
+
+    /* the response has been kept in the cache by the fetcher */
+    if (type == PCFETCHER_RESP_TYPE_ERROR ||
+            type == PCFETCHER_RESP_TYPE_FINISH) {
+        purc_variant_unref(request_id);
+    }
 }
 
+int pcfetcher_prefetch(struct pcfetcher_session *session, const char *url,
+        uint32_t timeout)
+{
+    struct pcfetcher* fetcher = s_remote_fetcher;
+    if (fetcher == NULL || url == NULL) {
+        return -1;
+    }
+
+    bool fresh = false;
+    if (pcfetcher_cache_lookup(url, &fresh, NULL, NULL) && fresh) {
+        return 0;
+    }
+
+    if (pcfetcher_get_nr_pending_requests() >= fetcher->max_conns) {
+        return -1;
+    }
+
+    uint64_t span = pctrace_begin();
+    purc_variant_t ret = fetcher->request_async(session, fetcher, url,
+            PCFETCHER_METHOD_GET, PURC_VARIANT_INVALID, timeout,
+            on_prefetch_response, NULL, NULL, NULL);
+    pctrace_end(span, PCTRACE_CAT_FETCHER, "prefetch");
+    return ret == PURC_VARIANT_INVALID ? -1 : 0;
+}
 
 int pcfetcher_check_response(uint32_t timeout_ms)
 {
@@ -311,15 +374,32 @@ int pcfetcher_check_response(uint32_t timeout_ms)
 void pcfetcher_cancel_async(purc_variant_t request)
 {
     struct pcfetcher* fetcher = get_fetcher();
-    if (fetcher) {
+    if (fetcher == NULL) {
+        return;
+    }
+
+    if (fetcher != s_remote_fetcher ||
+            !pcfetcher_coalesce_cancel_async(fetcher, request)) {
         fetcher->cancel_async(fetcher, request);
     }
 }
 
+/* NOTE: a callback info lives as long as its request is in flight. */
+static std::atomic<size_t> s_nr_callback_infos { 0 };
+
+size_t pcfetcher_get_nr_pending_requests(void)
+{
+    return s_nr_callback_infos.load(std::memory_order_relaxed);
+}
+
 struct pcfetcher_callback_info *pcfetcher_create_callback_info()
 {
-    return (struct pcfetcher_callback_info*) calloc(1,
+    struct pcfetcher_callback_info *info;
+    info = (struct pcfetcher_callback_info*) calloc(1,
             sizeof(struct pcfetcher_callback_info));
+    if (info)
+        s_nr_callback_infos.fetch_add(1, std::memory_order_relaxed);
+    return info;
 }
 
 void pcfetcher_destroy_callback_info(struct pcfetcher_callback_info *info)
@@ -334,9 +414,64 @@ void pcfetcher_destroy_callback_info(struct pcfetcher_callback_info *info)
         purc_rwstream_destroy(info->rws);
     }
     free(info);
+    s_nr_callback_infos.fetch_sub(1, std::memory_order_relaxed);
 }
 
-String pcfetcher_build_uri(const char *base_url,  const char *url)
+/*
+ * The base URLs parsed and the URIs resolved recently in this thread, that
+ * is, in this instance; an HVML program tends to fetch the same resources
+ * relative to the same base again and again, for example, when polling an
+ * API. The entries are replaced in turn.
+ */
+#define NR_PARSED_BASES         4
+#define NR_RESOLVED_URIS        32
+
+struct parsed_base {
+    CString         base_url;
+    PurCWTF::URL    uri;
+};
+
+struct resolved_uri {
+    CString         base_url;
+    CString         url;
+    String          result;
+};
+
+static thread_local struct parsed_base s_parsed_bases[NR_PARSED_BASES];
+static thread_local unsigned s_next_parsed_base;
+static thread_local struct resolved_uri s_resolved_uris[NR_RESOLVED_URIS];
+static thread_local unsigned s_next_resolved_uri;
+
+static inline bool is_same(const CString &cached, const char *str)
+{
+    return !cached.isNull() && strcmp(cached.data(), str) == 0;
+}
+
+static const PurCWTF::URL &parse_base_url(const char *base_url)
+{
+    for (size_t i = 0; i < NR_PARSED_BASES; i++) {
+        if (is_same(s_parsed_bases[i].base_url, base_url))
+            return s_parsed_bases[i].uri;
+    }
+
+    struct parsed_base &slot =
+        s_parsed_bases[s_next_parsed_base++ % NR_PARSED_BASES];
+    slot.base_url = CString(base_url);
+    slot.uri = PurCWTF::URL(URL(), base_url);
+    return slot.uri;
+}
+
+/* Called when an instance is cleaned up in its thread. */
+static void clear_uri_caches(void)
+{
+    for (size_t i = 0; i < NR_PARSED_BASES; i++)
+        s_parsed_bases[i] = parsed_base();
+    for (size_t i = 0; i < NR_RESOLVED_URIS; i++)
+        s_resolved_uris[i] = resolved_uri();
+}
+
+/* `cacheable` is set false if the result depends on the working directory. */
+static String build_uri(const char *base_url, const char *url, bool *cacheable)
 {
     PurCWTF::URL u(URL(), url);
     if (u.isValid()) {
@@ -346,9 +481,10 @@ String pcfetcher_build_uri(const char *base_url,  const char *url)
     size_t nr = strlen(url);
     char buf[PATH_MAX + nr + 2];
 
-    PurCWTF::URL uri(URL(), base_url);
+    PurCWTF::URL uri = parse_base_url(base_url);
     if (uri.isLocalFile() && uri.host().isEmpty() && (uri.path() == "/") &&
             u.protocol().isEmpty() && url[0] != '/') {
+        *cacheable = false;
         if (getcwd(buf, sizeof(buf)) != NULL) {
             strcat(buf, "/");
             strcat(buf, url);
@@ -378,6 +514,27 @@ String pcfetcher_build_uri(const char *base_url,  const char *url)
     return result;
 }
 
+String pcfetcher_build_uri(const char *base_url,  const char *url)
+{
+    for (size_t i = 0; i < NR_RESOLVED_URIS; i++) {
+        struct resolved_uri &entry = s_resolved_uris[i];
+        if (is_same(entry.url, url) && is_same(entry.base_url, base_url))
+            return entry.result;
+    }
+
+    bool cacheable = true;
+    String result = build_uri(base_url, url, &cacheable);
+    if (cacheable) {
+        struct resolved_uri &slot =
+            s_resolved_uris[s_next_resolved_uri++ % NR_RESOLVED_URIS];
+        slot.base_url = CString(base_url);
+        slot.url = CString(url);
+        slot.result = result;
+    }
+
+    return result;
+}
+
 static int _local_init_once(void)
 {
     return 0;
@@ -391,6 +548,7 @@ static int _local_init_instance(struct pcinst* curr_inst,
     if (!s_local_fetcher) {
         s_local_fetcher = pcfetcher_local_init(curr_inst->max_conns,
                 curr_inst->cache_quota);
+        pcfetcher_cache_init(curr_inst->cache_quota);
     }
 
     return 0;
@@ -400,9 +558,12 @@ static void _local_cleanup_instance(struct pcinst* curr_inst)
 {
     UNUSED_PARAM(curr_inst);
 
+    clear_uri_caches();
+
     if (s_local_fetcher) {
         s_local_fetcher->term(s_local_fetcher);
         s_local_fetcher = NULL;
+        pcfetcher_cache_term();
     }
 }
 
@@ -432,6 +593,7 @@ static int _remote_init_instance(struct pcinst* curr_inst,
                 curr_inst->cache_quota);
         if (!s_remote_fetcher)
             return PURC_ERROR_OUT_OF_MEMORY;
+        pcfetcher_cache_init(curr_inst->cache_quota);
     }
 #else
     UNUSED_PARAM(curr_inst);
@@ -444,9 +606,13 @@ static void _remote_cleanup_instance(struct pcinst* curr_inst)
 {
     UNUSED_PARAM(curr_inst);
 
+    clear_uri_caches();
+
     if (s_remote_fetcher) {
         s_remote_fetcher->term(s_remote_fetcher);
         s_remote_fetcher = NULL;
+        pcfetcher_cache_term();
+        pcfetcher_stats_reset();
     }
 }
 
@@ -25,6 +25,7 @@
 
 #include "config.h"
 #include "Connection.h"
+#include "DataReference.h"
 #include "MessageFlags.h"
 
 #include <memory>
@@ -711,6 +712,11 @@ void Connection::processIncomingMessage(std::unique_ptr<Decoder> message)
 {
     ASSERT(message->messageReceiverName() != ReceiverName::Invalid);
 
+    if (message->messageName() == MessageName::BatchedMessages) {
+        processIncomingBatchedMessages(*message);
+        return;
+    }
+
     if (message->messageName() == MessageName::SyncMessageReply) {
         processIncomingSyncReply(WTFMove(message));
         return;
@@ -878,6 +884,56 @@ bool Connection::canSendOutgoingMessages() const
     return m_isConnected && platformCanSendOutgoingMessages();
 }
 
+// NOTE: The small messages queued in a burst are sent in one batch, so that
+// they cost one system call rather than one for each. A batch is kept small
+// enough to be sent inline, not through a shared memory.
+static const size_t batchedMessagesMaxSize = 3072;
+static const size_t batchedMessagesMaxAmount = 64;
+
+static bool canBeBatched(const Encoder& encoder)
+{
+    return !encoder.hasAttachments() && encoder.bufferSize() <= batchedMessagesMaxSize / 4;
+}
+
+std::unique_ptr<Encoder> Connection::takeOutgoingMessages()
+{
+    std::unique_ptr<Encoder> message = m_outgoingMessages.takeFirst();
+    if (!canBeBatched(*message) || m_outgoingMessages.isEmpty() || !canBeBatched(*m_outgoingMessages.first()))
+        return message;
+
+    Vector<std::unique_ptr<Encoder>> messages;
+    size_t size = message->bufferSize();
+    messages.append(WTFMove(message));
+    while (!m_outgoingMessages.isEmpty() && messages.size() < batchedMessagesMaxAmount) {
+        const Encoder& next = *m_outgoingMessages.first();
+        if (!canBeBatched(next) || size + next.bufferSize() > batchedMessagesMaxSize)
+            break;
+        size += next.bufferSize();
+        messages.append(m_outgoingMessages.takeFirst());
+    }
+
+    auto batch = makeUnique<Encoder>(MessageName::BatchedMessages, 0);
+    batch->reserveCapacity(size + messages.size() * 2 * sizeof(uint64_t));
+    *batch << static_cast<uint64_t>(messages.size());
+    for (auto& batched : messages)
+        batch->encodeVariableLengthByteArray(DataReference(batched->buffer(), batched->bufferSize()));
+    return batch;
+}
+
+void Connection::processIncomingBatchedMessages(Decoder& decoder)
+{
+    uint64_t count;
+    if (!decoder.decode(count))
+        return;
+
+    for (uint64_t i = 0; i < count; ++i) {
+        std::unique_ptr<Decoder> message = Decoder::unwrapBatched(decoder);
+        if (!message || message->messageReceiverName() == ReceiverName::Invalid)
+            return;
+        processIncomingMessage(WTFMove(message));
+    }
+}
+
 void Connection::sendOutgoingMessages()
 {
     if (!canSendOutgoingMessages())
@@ -890,7 +946,7 @@ void Connection::sendOutgoingMessages()
             auto locker = holdLock(m_outgoingMessagesMutex);
             if (m_outgoingMessages.isEmpty())
                 break;
-            message = m_outgoingMessages.takeFirst();
+            message = takeOutgoingMessages();
         }
 
         if (!sendOutgoingMessage(WTFMove(message)))
@@ -5183,6 +5183,8 @@ const char* description(MessageName name)
         return "IPC::InitializeConnection";
     case MessageName::LegacySessionState:
         return "IPC::LegacySessionState";
+    case MessageName::BatchedMessages:
+        return "IPC::BatchedMessages";
     }
     ASSERT_NOT_REACHED();
     return "<invalid message name>";
@@ -8676,6 +8678,7 @@ ReceiverName receiverName(MessageName messageName)
     case MessageName::SyncMessageReply:
     case MessageName::InitializeConnection:
     case MessageName::LegacySessionState:
+    case MessageName::BatchedMessages:
         return ReceiverName::IPC;
     }
     ASSERT_NOT_REACHED();
@@ -13836,6 +13839,8 @@ bool isValidMessageName(MessageName messageName)
         return true;
     if (messageName == IPC::MessageName::LegacySessionState)
         return true;
+    if (messageName == IPC::MessageName::BatchedMessages)
+        return true;
     return false;
 };
 
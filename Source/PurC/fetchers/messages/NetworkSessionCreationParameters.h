@@ -63,6 +63,13 @@ struct NetworkSessionCreationParameters {
     bool preventsSystemHTTPProxyAuthentication { false };
 
     ResourceLoadStatisticsParameters resourceLoadStatisticsParameters;
+
+    // The connection pool of the session; an idle connection is kept alive
+    // for reuse until connectionIdleTimeout (in seconds, 0 for no limit).
+    unsigned maxConnections { 17 };
+    unsigned maxConnectionsPerHost { 6 };
+    unsigned connectionIdleTimeout { 0 };
+    bool http2Enabled { true };
 };
 
 } // namespace PurCFetcher
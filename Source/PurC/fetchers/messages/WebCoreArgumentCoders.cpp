@@ -30,6 +30,7 @@
 #include "DataReference.h"
 #include "SharedBufferDataReference.h"
 #include "SharedBuffer.h"
+#include "SharedMemory.h"
 #include "ResourceError.h"
 #include "ResourceRequest.h"
 #include "ResourceResponse.h"
@@ -48,6 +49,12 @@
 namespace IPC {
 using namespace PurCFetcher;
 
+#if USE(UNIX_DOMAIN_SOCKETS)
+// A buffer at least this large is sent in a shared memory of its own,
+// so that the receiver maps it instead of copying it out of the message.
+static const uint64_t sharedMemoryBufferThreshold = 256 * 1024;
+#endif
+
 static void encodeSharedBuffer(Encoder& encoder, const SharedBuffer* buffer)
 {
     uint64_t bufferSize = buffer ? buffer->size() : 0;
@@ -55,19 +62,46 @@ static void encodeSharedBuffer(Encoder& encoder, const SharedBuffer* buffer)
     if (!bufferSize)
         return;
 
+    RefPtr<SharedMemory> sharedMemoryBuffer;
 #if USE(UNIX_DOMAIN_SOCKETS)
-    // Do not use shared memory for SharedBuffer encoding in Unix, because it's easy to reach the
+    // Do not use shared memory for the small SharedBuffers in Unix, because it's easy to reach the
     // maximum number of file descriptors open per process when sending large data in small chunks
     // over the IPC. ConnectionUnix.cpp already uses shared memory to send any IPC message that is
     // too large. See https://bugs.webkit.org/show_bug.cgi?id=208571.
-    for (const auto& element : *buffer)
-        encoder.encodeFixedLengthData(reinterpret_cast<const uint8_t*>(element.segment->data()), element.segment->size(), 1);
+    if (bufferSize >= sharedMemoryBufferThreshold)
+        sharedMemoryBuffer = SharedMemory::allocate(buffer->size());
+    bool inSharedMemory = !!sharedMemoryBuffer;
+    encoder << inSharedMemory;
+    if (!inSharedMemory) {
+        for (const auto& element : *buffer)
+            encoder.encodeFixedLengthData(reinterpret_cast<const uint8_t*>(element.segment->data()), element.segment->size(), 1);
+        return;
+    }
 #else
+    sharedMemoryBuffer = SharedMemory::allocate(buffer->size());
+#endif
+
     SharedMemory::Handle handle;
-    auto sharedMemoryBuffer = SharedMemory::allocate(buffer->size());
-    memcpy(sharedMemoryBuffer->data(), buffer->data(), buffer->size());
+    auto* destination = static_cast<uint8_t*>(sharedMemoryBuffer->data());
+    for (const auto& element : *buffer) {
+        memcpy(destination, element.segment->data(), element.segment->size());
+        destination += element.segment->size();
+    }
     sharedMemoryBuffer->createHandle(handle, SharedMemory::Protection::ReadOnly);
     encoder << handle;
+}
+
+static Ref<SharedBuffer> wrapSharedMemory(Ref<SharedMemory>&& sharedMemoryBuffer, size_t size)
+{
+#if USE(GLIB)
+    // Keep the memory mapped as long as the buffer refers to it instead of copying it.
+    SharedMemory* sharedMemory = &sharedMemoryBuffer.leakRef();
+    GRefPtr<GBytes> bytes = adoptGRef(g_bytes_new_with_free_func(sharedMemory->data(), size, [](gpointer data) {
+        static_cast<SharedMemory*>(data)->deref();
+    }, sharedMemory));
+    return SharedBuffer::create(bytes.get());
+#else
+    return SharedBuffer::create(static_cast<unsigned char*>(sharedMemoryBuffer->data()), size);
 #endif
 }
 
@@ -81,31 +115,37 @@ static WARN_UNUSED_RETURN bool decodeSharedBuffer(Decoder& decoder, RefPtr<Share
         return true;
 
 #if USE(UNIX_DOMAIN_SOCKETS)
-    if (!decoder.bufferIsLargeEnoughToContain<uint8_t>(bufferSize))
+    bool inSharedMemory = false;
+    if (!decoder.decode(inSharedMemory))
         return false;
 
-    Vector<uint8_t> data;
-    data.grow(bufferSize);
-    if (!decoder.decodeFixedLengthData(data.data(), data.size(), 1))
-        return false;
+    if (!inSharedMemory) {
+        if (!decoder.bufferIsLargeEnoughToContain<uint8_t>(bufferSize))
+            return false;
+
+        Vector<uint8_t> data;
+        data.grow(bufferSize);
+        if (!decoder.decodeFixedLengthData(data.data(), data.size(), 1))
+            return false;
+
+        buffer = SharedBuffer::create(WTFMove(data));
+        return true;
+    }
+#endif
 
-    buffer = SharedBuffer::create(WTFMove(data));
-#else
     SharedMemory::Handle handle;
     if (!decoder.decode(handle))
         return false;
 
-    // SharedMemory::Handle::size() is rounded up to the nearest page.
-    if (bufferSize > handle.size())
-        return false;
-
     auto sharedMemoryBuffer = SharedMemory::map(handle, SharedMemory::Protection::ReadOnly);
     if (!sharedMemoryBuffer)
         return false;
 
-    buffer = SharedBuffer::create(static_cast<unsigned char*>(sharedMemoryBuffer->data()), bufferSize);
-#endif
+    // The size of the shared memory is rounded up to the nearest page.
+    if (bufferSize > sharedMemoryBuffer->size())
+        return false;
 
+    buffer = wrapSharedMemory(sharedMemoryBuffer.releaseNonNull(), bufferSize);
     return true;
 }
 
@@ -165,8 +205,30 @@ bool ArgumentCoder<ResourceError>::decode(Decoder& decoder, ResourceError& resou
     return true;
 }
 
+static size_t estimatedEncodedSize(const String& string)
+{
+    // The length, the flag of 8-bit, the characters, and the padding.
+    return sizeof(uint32_t) + sizeof(bool) + string.length() * (string.is8Bit() ? 1 : 2) + sizeof(uint64_t);
+}
+
+// Estimates the size of the encoded request, so that the encoder allocates its buffer once.
+static size_t estimatedEncodedSize(const ResourceRequest& resourceRequest)
+{
+    static const size_t fixedFieldsSize = 128;
+
+    size_t size = fixedFieldsSize;
+    size += estimatedEncodedSize(resourceRequest.url().string());
+    size += estimatedEncodedSize(resourceRequest.firstPartyForCookies().string());
+    size += estimatedEncodedSize(resourceRequest.httpMethod());
+    size += estimatedEncodedSize(resourceRequest.cachePartition());
+    for (const auto& header : resourceRequest.httpHeaderFields())
+        size += sizeof(uint64_t) + estimatedEncodedSize(header.key) + estimatedEncodedSize(header.value);
+    return size;
+}
+
 void ArgumentCoder<ResourceRequest>::encode(Encoder& encoder, const ResourceRequest& resourceRequest)
 {
+    encoder.reserveCapacity(estimatedEncodedSize(resourceRequest));
     encoder << resourceRequest.cachePartition();
     encoder << resourceRequest.hiddenFromInspector();
 
@@ -0,0 +1,1042 @@
+/**
+ * @file fragment.c
+ * @date 2026/10/14
+ * @brief The fast path to parse the simple and well-formed HTML fragments.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc-utils.h"
+#include "private/dom.h"
+#include "html/parser.h"
+
+#include <string.h>
+#include <strings.h>
+
+#define MAX_DEPTH           32
+#define MAX_REF_LEN         8
+
+/*
+ * The fragment is parsed by the fast path only if the tree builder would
+ * build the same tree: every element is closed explicitly and in order,
+ * and no element closes or moves another one implicitly. The elements
+ * not listed here, except the custom elements, go to the tree builder.
+ */
+enum {
+    TAG_VOID        = 0x01,     /* an element without content and end tag */
+    TAG_PHRASING    = 0x02,     /* does not close an open p element */
+    TAG_LIST        = 0x04,     /* ul, ol, and menu: the scope of li */
+    TAG_LI          = 0x08,
+    TAG_HEADING     = 0x10,
+    TAG_P           = 0x20,
+    TAG_A           = 0x40,
+    TAG_CONTEXT     = 0x80,     /* can contain the fragment */
+    TAG_NO_START    = 0x100,    /* can only be the context element */
+};
+
+struct tag_info {
+    const char *name;
+    unsigned    flags;
+};
+
+/* sorted by the name */
+static const struct tag_info tag_infos[] = {
+    { "a",          TAG_PHRASING | TAG_A | TAG_CONTEXT },
+    { "abbr",       TAG_PHRASING | TAG_CONTEXT },
+    { "address",    TAG_CONTEXT },
+    { "article",    TAG_CONTEXT },
+    { "aside",      TAG_CONTEXT },
+    { "b",          TAG_PHRASING | TAG_CONTEXT },
+    { "bdi",        TAG_PHRASING | TAG_CONTEXT },
+    { "bdo",        TAG_PHRASING | TAG_CONTEXT },
+    { "blockquote", TAG_CONTEXT },
+    { "body",       TAG_CONTEXT | TAG_NO_START },
+    { "br",         TAG_VOID | TAG_PHRASING },
+    { "cite",       TAG_PHRASING | TAG_CONTEXT },
+    { "code",       TAG_PHRASING | TAG_CONTEXT },
+    { "data",       TAG_PHRASING | TAG_CONTEXT },
+    { "dfn",        TAG_PHRASING | TAG_CONTEXT },
+    { "div",        TAG_CONTEXT },
+    { "em",         TAG_PHRASING | TAG_CONTEXT },
+    { "figcaption", TAG_CONTEXT },
+    { "figure",     TAG_CONTEXT },
+    { "footer",     TAG_CONTEXT },
+    { "h1",         TAG_HEADING | TAG_CONTEXT },
+    { "h2",         TAG_HEADING | TAG_CONTEXT },
+    { "h3",         TAG_HEADING | TAG_CONTEXT },
+    { "h4",         TAG_HEADING | TAG_CONTEXT },
+    { "h5",         TAG_HEADING | TAG_CONTEXT },
+    { "h6",         TAG_HEADING | TAG_CONTEXT },
+    { "header",     TAG_CONTEXT },
+    { "hr",         TAG_VOID },
+    { "i",          TAG_PHRASING | TAG_CONTEXT },
+    { "img",        TAG_VOID | TAG_PHRASING },
+    { "input",      TAG_VOID | TAG_PHRASING },
+    { "kbd",        TAG_PHRASING | TAG_CONTEXT },
+    { "label",      TAG_PHRASING | TAG_CONTEXT },
+    { "li",         TAG_LI | TAG_CONTEXT },
+    { "main",       TAG_CONTEXT },
+    { "mark",       TAG_PHRASING | TAG_CONTEXT },
+    { "menu",       TAG_LIST | TAG_CONTEXT },
+    { "nav",        TAG_CONTEXT },
+    { "ol",         TAG_LIST | TAG_CONTEXT },
+    { "p",          TAG_P | TAG_CONTEXT },
+    { "q",          TAG_PHRASING | TAG_CONTEXT },
+    { "s",          TAG_PHRASING | TAG_CONTEXT },
+    { "samp",       TAG_PHRASING | TAG_CONTEXT },
+    { "section",    TAG_CONTEXT },
+    { "small",      TAG_PHRASING | TAG_CONTEXT },
+    { "span",       TAG_PHRASING | TAG_CONTEXT },
+    { "strong",     TAG_PHRASING | TAG_CONTEXT },
+    { "sub",        TAG_PHRASING | TAG_CONTEXT },
+    { "sup",        TAG_PHRASING | TAG_CONTEXT },
+    { "time",       TAG_PHRASING | TAG_CONTEXT },
+    { "u",          TAG_PHRASING | TAG_CONTEXT },
+    { "ul",         TAG_LIST | TAG_CONTEXT },
+    { "var",        TAG_PHRASING | TAG_CONTEXT },
+    { "wbr",        TAG_VOID | TAG_PHRASING },
+};
+
+/* the custom elements are handled as the ordinary ones by the tree builder */
+static const struct tag_info custom_tag_info = {
+    NULL, TAG_PHRASING | TAG_CONTEXT
+};
+
+struct fragment_parser {
+    pcdom_document_t       *doc;
+
+    const char             *names[MAX_DEPTH];
+    size_t                  name_lens[MAX_DEPTH];
+    unsigned                flags[MAX_DEPTH];
+    pcdom_node_t           *nodes[MAX_DEPTH];
+    int                     depth;
+
+    /* the buffer for the texts with character references */
+    unsigned char          *buf;
+    size_t                  buf_len;
+    size_t                  buf_size;
+};
+
+static inline bool
+is_ascii_alpha(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static inline bool
+is_ascii_alnum(unsigned char c)
+{
+    return is_ascii_alpha(c) || (c >= '0' && c <= '9');
+}
+
+static inline bool
+is_html_space(unsigned char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\f';
+}
+
+static const struct tag_info *
+find_tag_info(const char *name, size_t len)
+{
+    size_t low = 0, high = PCA_TABLESIZE(tag_infos);
+
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        const char *key = tag_infos[mid].name;
+        int diff = strncasecmp(name, key, len);
+        if (diff == 0 && key[len] != '\0')
+            diff = -1;
+
+        if (diff == 0)
+            return tag_infos + mid;
+        else if (diff < 0)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+
+    if (memchr(name, '-', len))
+        return &custom_tag_info;
+
+    return NULL;
+}
+
+static bool
+buf_append(struct fragment_parser *parser, const void *data, size_t len)
+{
+    if (parser->buf_len + len > parser->buf_size) {
+        size_t size = parser->buf_size ? parser->buf_size * 2 : 256;
+        while (size < parser->buf_len + len)
+            size *= 2;
+
+        unsigned char *buf = realloc(parser->buf, size);
+        if (buf == NULL)
+            return false;
+
+        parser->buf = buf;
+        parser->buf_size = size;
+    }
+
+    memcpy(parser->buf + parser->buf_len, data, len);
+    parser->buf_len += len;
+    return true;
+}
+
+/*
+ * Decodes the character reference at @p which points to '&'; returns
+ * the pointer after the reference, or NULL if it needs the tree builder.
+ * Only the references terminated by ';' are decoded here.
+ */
+static const char *
+decode_char_ref(struct fragment_parser *parser, const char *p, const char *end)
+{
+    static const struct {
+        const char *name;
+        uint32_t    uc;
+    } refs[] = {
+        { "amp",    '&' },
+        { "apos",   '\'' },
+        { "gt",     '>' },
+        { "lt",     '<' },
+        { "nbsp",   0xA0 },
+        { "quot",   '"' },
+    };
+
+    const char *start = ++p;
+    uint32_t uc = 0;
+
+    if (p < end && *p == '#') {
+        bool hex = false;
+        p++;
+        if (p < end && (*p == 'x' || *p == 'X')) {
+            hex = true;
+            p++;
+        }
+
+        start = p;
+        while (p < end && p - start < MAX_REF_LEN) {
+            unsigned char c = *p;
+            if (c >= '0' && c <= '9')
+                uc = uc * (hex ? 16 : 10) + (c - '0');
+            else if (hex && ((c | 0x20) >= 'a' && (c | 0x20) <= 'f'))
+                uc = uc * 16 + ((c | 0x20) - 'a' + 10);
+            else
+                break;
+            p++;
+        }
+
+        if (p == start || p >= end || *p != ';')
+            return NULL;
+
+        /* leave the replacements and the controls to the tree builder */
+        if (uc > 0x10FFFF || (uc >= 0xD800 && uc <= 0xDFFF) ||
+                (uc < 0x20 && !is_html_space((unsigned char)uc)) ||
+                (uc >= 0x7F && uc <= 0x9F))
+            return NULL;
+    }
+    else {
+        if (p >= end || !is_ascii_alnum(*p)) {
+            /* not a character reference */
+            return buf_append(parser, "&", 1) ? start : NULL;
+        }
+
+        while (p < end && is_ascii_alnum(*p) && p - start < MAX_REF_LEN)
+            p++;
+
+        if (p >= end || *p != ';')
+            return NULL;
+
+        size_t len = p - start;
+        size_t i;
+        for (i = 0; i < PCA_TABLESIZE(refs); i++) {
+            if (strlen(refs[i].name) == len &&
+                    memcmp(refs[i].name, start, len) == 0) {
+                uc = refs[i].uc;
+                break;
+            }
+        }
+
+        if (i == PCA_TABLESIZE(refs))
+            return NULL;
+    }
+
+    unsigned char utf8[8];
+    unsigned n = pcutils_unichar_to_utf8(uc, utf8);
+    return buf_append(parser, utf8, n) ? p + 1 : NULL;
+}
+
+/*
+ * Decodes the text or the attribute value in [@p, @end) to the buffer;
+ * returns false if it needs the tree builder.
+ */
+static bool
+decode_text(struct fragment_parser *parser, const char *p, const char *end)
+{
+    parser->buf_len = 0;
+
+    while (p < end) {
+        const char *amp = memchr(p, '&', end - p);
+        const char *stop = amp ? amp : end;
+
+        if (memchr(p, '\0', stop - p) || memchr(p, '\r', stop - p))
+            return false;
+
+        if (stop > p && !buf_append(parser, p, stop - p))
+            return false;
+
+        if (amp == NULL)
+            break;
+
+        if ((p = decode_char_ref(parser, amp, end)) == NULL)
+            return false;
+    }
+
+    return true;
+}
+
+static bool
+add_text(struct fragment_parser *parser, const char *p, const char *end)
+{
+    if (!decode_text(parser, p, end))
+        return false;
+
+    pcdom_text_t *text = pcdom_document_create_text_node(parser->doc,
+            parser->buf, parser->buf_len);
+    if (text == NULL)
+        return false;
+
+    pcdom_node_append_child(parser->nodes[parser->depth],
+            pcdom_interface_node(text));
+    return true;
+}
+
+/* checks whether a start tag would close or move any open element */
+static bool
+is_start_tag_simple(struct fragment_parser *parser, unsigned flags)
+{
+    if (flags & TAG_NO_START)
+        return false;
+
+    if (!(flags & TAG_VOID) && parser->depth + 1 >= MAX_DEPTH)
+        return false;
+
+    if ((flags & TAG_HEADING) && (parser->flags[parser->depth] & TAG_HEADING))
+        return false;
+
+    for (int i = parser->depth; i > 0; i--) {
+        unsigned open = parser->flags[i];
+
+        if ((open & TAG_P) && !(flags & TAG_PHRASING))
+            return false;
+        if ((open & TAG_A) && (flags & TAG_A))
+            return false;
+        if (flags & TAG_LI) {
+            if (open & TAG_LI)
+                return false;
+            if (open & TAG_LIST)
+                flags &= ~TAG_LI;
+        }
+    }
+
+    return true;
+}
+
+static const char *
+parse_start_tag(struct fragment_parser *parser, const char *p, const char *end)
+{
+    const char *name = p;
+    while (p < end && (is_ascii_alnum(*p) || *p == '-'))
+        p++;
+
+    size_t name_len = p - name;
+    if (p >= end || !(is_html_space(*p) || *p == '/' || *p == '>'))
+        return NULL;
+
+    const struct tag_info *info = find_tag_info(name, name_len);
+    if (info == NULL || !is_start_tag_simple(parser, info->flags))
+        return NULL;
+
+    pcdom_element_t *elem = pcdom_document_create_element(parser->doc,
+            (const unsigned char *)name, name_len, NULL, false);
+    if (elem == NULL)
+        return NULL;
+
+    pcdom_node_t *node = pcdom_interface_node(elem);
+    pcdom_node_append_child(parser->nodes[parser->depth], node);
+
+    while (true) {
+        while (p < end && is_html_space(*p))
+            p++;
+        if (p >= end)
+            return NULL;
+
+        if (*p == '>') {
+            p++;
+            break;
+        }
+
+        if (*p == '/') {
+            /* the slash of a non-void element is ignored by the tree builder */
+            if (!(info->flags & TAG_VOID) || p + 1 >= end || p[1] != '>')
+                return NULL;
+            p += 2;
+            break;
+        }
+
+        const char *attr = p;
+        while (p < end && !is_html_space(*p) && *p != '/' && *p != '>' &&
+                *p != '=') {
+            if (*p == '"' || *p == '\'' || *p == '<' || *p == '\0')
+                return NULL;
+            p++;
+        }
+
+        size_t attr_len = p - attr;
+        if (attr_len == 0)
+            return NULL;
+
+        while (p < end && is_html_space(*p))
+            p++;
+
+        const char *value = p;
+        const char *value_end = p;
+        if (p < end && *p == '=') {
+            p++;
+            while (p < end && is_html_space(*p))
+                p++;
+            if (p >= end)
+                return NULL;
+
+            if (*p == '"' || *p == '\'') {
+                const char *quote = memchr(p + 1, *p, end - p - 1);
+                if (quote == NULL)
+                    return NULL;
+                value = p + 1;
+                value_end = quote;
+                p = quote + 1;
+            }
+            else {
+                value = p;
+                while (p < end && !is_html_space(*p) && *p != '>') {
+                    if (*p == '"' || *p == '\'' || *p == '<' || *p == '=' ||
+                            *p == '`')
+                        return NULL;
+                    p++;
+                }
+                value_end = p;
+                if (value == value_end)
+                    return NULL;
+            }
+        }
+
+        if (!decode_text(parser, value, value_end))
+            return NULL;
+
+        /* the first one wins for the duplicate attributes */
+        if (pcdom_element_attr_is_exist(elem,
+                    (const unsigned char *)attr, attr_len) == NULL &&
+                pcdom_element_set_attribute(elem,
+                    (const unsigned char *)attr, attr_len,
+                    parser->buf ? parser->buf : (const unsigned char *)"",
+                    parser->buf_len) == NULL)
+            return NULL;
+    }
+
+    if (!(info->flags & TAG_VOID)) {
+        int depth = ++parser->depth;
+        parser->names[depth] = name;
+        parser->name_lens[depth] = name_len;
+        parser->flags[depth] = info->flags;
+        parser->nodes[depth] = node;
+    }
+
+    return p;
+}
+
+static const char *
+parse_end_tag(struct fragment_parser *parser, const char *p, const char *end)
+{
+    const char *name = p;
+    while (p < end && (is_ascii_alnum(*p) || *p == '-'))
+        p++;
+
+    size_t name_len = p - name;
+    while (p < end && is_html_space(*p))
+        p++;
+    if (p >= end || *p != '>')
+        return NULL;
+
+    /* only the end tag of the current element */
+    int depth = parser->depth;
+    if (depth == 0 || parser->name_lens[depth] != name_len ||
+            strncasecmp(parser->names[depth], name, name_len))
+        return NULL;
+
+    parser->depth--;
+    return p + 1;
+}
+
+static bool
+is_simple_context(pcdom_element_t *context)
+{
+    size_t len;
+
+    if (pcdom_interface_node(context)->ns != PCHTML_NS_HTML)
+        return false;
+
+    const unsigned char *ctxt_name = pcdom_element_local_name(context, &len);
+    const struct tag_info *info = ctxt_name ?
+        find_tag_info((const char *)ctxt_name, len) : NULL;
+    return info && (info->flags & TAG_CONTEXT);
+}
+
+static pcdom_node_t *
+parse_simple_fragment(pcdom_document_t *document,
+        const char *fragment, size_t length)
+{
+    struct fragment_parser parser = { .doc = document };
+    pcdom_node_t *holder = NULL;
+
+    pcdom_element_t *div = pcdom_document_create_element(document,
+            (const unsigned char *)"div", 3, NULL, false);
+    if (div == NULL)
+        goto failed;
+
+    holder = pcdom_interface_node(div);
+    parser.nodes[0] = holder;
+
+    const char *p = fragment;
+    const char *end = fragment + length;
+    while (p < end) {
+        const char *lt = memchr(p, '<', end - p);
+        const char *stop = lt ? lt : end;
+
+        if (stop > p && !add_text(&parser, p, stop))
+            goto fallback;
+
+        if (lt == NULL)
+            break;
+
+        p = lt + 1;
+        if (p < end && is_ascii_alpha(*p))
+            p = parse_start_tag(&parser, p, end);
+        else if (p + 1 < end && *p == '/' && is_ascii_alpha(p[1]))
+            p = parse_end_tag(&parser, p + 1, end);
+        else
+            p = NULL;   /* comments, bogus tags, or a bare '<' */
+
+        if (p == NULL)
+            goto fallback;
+    }
+
+    if (parser.depth != 0)
+        goto fallback;
+
+    free(parser.buf);
+    return holder;
+
+fallback:
+    free(parser.buf);
+    pcdom_node_destroy_deep(holder);
+
+failed:
+    return NULL;
+}
+
+pcdom_node_t *
+pchtml_html_parse_simple_fragment(pcdom_document_t *document,
+        pcdom_element_t *context, const char *fragment, size_t length)
+{
+    if (!is_simple_context(context))
+        return NULL;
+
+    return parse_simple_fragment(document, fragment, length);
+}
+
+/*
+ * The fragment template: a fragment with slots, compiled once to the
+ * operations building the nodes. The skeleton, in which every slot is
+ * replaced by SLOT_MARK, is parsed by the fast path above; the template
+ * is instantiated only if every value of the slots would be parsed as a
+ * part of the same text or attribute value, so that the tree built is the
+ * one parsed from the fragment with the values.
+ */
+#define SLOT_MARK           '\x01'
+
+enum {
+    SLOT_IN_TEXT,
+    SLOT_IN_UNQUOTED,
+    SLOT_IN_DQUOTED,
+    SLOT_IN_SQUOTED,
+};
+
+enum {
+    TPL_OP_ELEMENT,     /* creates an element and enters it */
+    TPL_OP_ATTR,        /* sets an attribute of the current element */
+    TPL_OP_TEXT,        /* appends a text to the current element */
+    TPL_OP_LEAVE,       /* leaves the current element */
+};
+
+struct tpl_op {
+    unsigned                type;
+    bool                    unquoted;   /* an unquoted attribute value */
+    size_t                  name;       /* the offset of the name in strs */
+    size_t                  name_len;
+    size_t                  first_part;
+    size_t                  nr_parts;
+};
+
+struct tpl_part {
+    size_t                  off;        /* the static text in strs */
+    size_t                  len;
+    ssize_t                 slot;       /* the slot, or -1 for static text */
+};
+
+struct pchtml_fragment_tpl {
+    size_t                  nr_slots;
+    unsigned char          *slot_kinds;
+    size_t                  next_slot;  /* used when compiling */
+
+    struct tpl_op          *ops;
+    size_t                  nr_ops;
+    size_t                  sz_ops;
+
+    struct tpl_part        *parts;
+    size_t                  nr_parts;
+    size_t                  sz_parts;
+
+    char                   *strs;
+    size_t                  strs_len;
+    size_t                  strs_size;
+};
+
+static void *
+tpl_grow(void *array, size_t *size, size_t nr, size_t unit)
+{
+    if (nr < *size)
+        return array;
+
+    size_t new_size = *size ? *size * 2 : 16;
+    void *p = realloc(array, new_size * unit);
+    if (p)
+        *size = new_size;
+    return p;
+}
+
+static bool
+tpl_add_str(struct pchtml_fragment_tpl *tpl, const void *str, size_t len,
+        size_t *off)
+{
+    if (tpl->strs_len + len > tpl->strs_size) {
+        size_t size = tpl->strs_size ? tpl->strs_size * 2 : 256;
+        while (size < tpl->strs_len + len)
+            size *= 2;
+
+        char *strs = realloc(tpl->strs, size);
+        if (strs == NULL)
+            return false;
+
+        tpl->strs = strs;
+        tpl->strs_size = size;
+    }
+
+    memcpy(tpl->strs + tpl->strs_len, str, len);
+    *off = tpl->strs_len;
+    tpl->strs_len += len;
+    return true;
+}
+
+static struct tpl_op *
+tpl_add_op(struct pchtml_fragment_tpl *tpl, unsigned type)
+{
+    struct tpl_op *ops = tpl_grow(tpl->ops, &tpl->sz_ops, tpl->nr_ops,
+            sizeof(*ops));
+    if (ops == NULL)
+        return NULL;
+
+    tpl->ops = ops;
+    struct tpl_op *op = ops + tpl->nr_ops++;
+    memset(op, 0, sizeof(*op));
+    op->type = type;
+    op->first_part = tpl->nr_parts;
+    return op;
+}
+
+static bool
+tpl_add_part(struct pchtml_fragment_tpl *tpl, const unsigned char *str,
+        size_t len, ssize_t slot)
+{
+    struct tpl_part *parts = tpl_grow(tpl->parts, &tpl->sz_parts,
+            tpl->nr_parts, sizeof(*parts));
+    if (parts == NULL)
+        return false;
+
+    tpl->parts = parts;
+    struct tpl_part *part = parts + tpl->nr_parts++;
+    part->off = 0;
+    part->len = len;
+    part->slot = slot;
+    return len == 0 || tpl_add_str(tpl, str, len, &part->off);
+}
+
+/* splits a text or an attribute value of the skeleton to the parts */
+static bool
+tpl_split(struct pchtml_fragment_tpl *tpl, struct tpl_op *op,
+        const unsigned char *str, size_t len, bool in_text)
+{
+    const unsigned char *end = str + len;
+
+    while (str < end) {
+        const unsigned char *mark = memchr(str, SLOT_MARK, end - str);
+        const unsigned char *stop = mark ? mark : end;
+
+        if (stop > str && !tpl_add_part(tpl, str, stop - str, -1))
+            return false;
+
+        if (mark == NULL)
+            break;
+
+        size_t slot = tpl->next_slot++;
+        if (slot >= tpl->nr_slots ||
+                (tpl->slot_kinds[slot] == SLOT_IN_TEXT) != in_text ||
+                !tpl_add_part(tpl, NULL, 0, slot))
+            return false;
+
+        if (tpl->slot_kinds[slot] == SLOT_IN_UNQUOTED)
+            op->unquoted = true;
+        str = mark + 1;
+    }
+
+    op->nr_parts = tpl->nr_parts - op->first_part;
+    return true;
+}
+
+static bool
+tpl_compile_node(struct pchtml_fragment_tpl *tpl, pcdom_node_t *node)
+{
+    struct tpl_op *op;
+    size_t len;
+
+    if (node->type == PCDOM_NODE_TYPE_TEXT) {
+        pcdom_text_t *text = pcdom_interface_text(node);
+        op = tpl_add_op(tpl, TPL_OP_TEXT);
+        return op && tpl_split(tpl, op, text->char_data.data.data,
+                text->char_data.data.length, true);
+    }
+
+    if (node->type != PCDOM_NODE_TYPE_ELEMENT)
+        return false;
+
+    pcdom_element_t *elem = pcdom_interface_element(node);
+    const unsigned char *name = pcdom_element_qualified_name(elem, &len);
+    if ((op = tpl_add_op(tpl, TPL_OP_ELEMENT)) == NULL ||
+            !tpl_add_str(tpl, name, len, &op->name))
+        return false;
+    op->name_len = len;
+
+    pcdom_attr_t *attr = pcdom_element_first_attribute(elem);
+    while (attr) {
+        name = pcdom_attr_qualified_name(attr, &len);
+        if (memchr(name, SLOT_MARK, len) ||
+                (op = tpl_add_op(tpl, TPL_OP_ATTR)) == NULL ||
+                !tpl_add_str(tpl, name, len, &op->name))
+            return false;
+        op->name_len = len;
+
+        const unsigned char *value = pcdom_attr_value(attr, &len);
+        if (!tpl_split(tpl, op, value, len, false))
+            return false;
+
+        attr = pcdom_element_next_attribute(attr);
+    }
+
+    for (pcdom_node_t *child = node->first_child; child; child = child->next) {
+        if (!tpl_compile_node(tpl, child))
+            return false;
+    }
+
+    return tpl_add_op(tpl, TPL_OP_LEAVE) != NULL;
+}
+
+/* determines the kinds of the slots in the skeleton parsed by the fast path */
+static void
+tpl_scan_slots(struct pchtml_fragment_tpl *tpl, const char *skel, size_t len)
+{
+    bool in_tag = false;
+    char quote = 0;
+    size_t slot = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = skel[i];
+
+        if (c == SLOT_MARK) {
+            if (!in_tag)
+                tpl->slot_kinds[slot++] = SLOT_IN_TEXT;
+            else if (quote == '"')
+                tpl->slot_kinds[slot++] = SLOT_IN_DQUOTED;
+            else if (quote == '\'')
+                tpl->slot_kinds[slot++] = SLOT_IN_SQUOTED;
+            else
+                tpl->slot_kinds[slot++] = SLOT_IN_UNQUOTED;
+        }
+        else if (!in_tag) {
+            in_tag = (c == '<');
+        }
+        else if (quote) {
+            if (c == quote)
+                quote = 0;
+        }
+        else if (c == '"' || c == '\'') {
+            quote = c;
+        }
+        else if (c == '>') {
+            in_tag = false;
+        }
+    }
+}
+
+void
+pchtml_fragment_tpl_destroy(pchtml_fragment_tpl_t *tpl)
+{
+    if (tpl) {
+        free(tpl->slot_kinds);
+        free(tpl->ops);
+        free(tpl->parts);
+        free(tpl->strs);
+        free(tpl);
+    }
+}
+
+pchtml_fragment_tpl_t *
+pchtml_fragment_tpl_compile(pcdom_document_t *document,
+        const char *const *pieces, const size_t *lens, size_t nr_slots)
+{
+    pchtml_fragment_tpl_t *tpl = NULL;
+    pcdom_node_t *holder = NULL;
+    char *skel = NULL;
+    size_t len = nr_slots;
+
+    for (size_t i = 0; i <= nr_slots; i++) {
+        if (memchr(pieces[i], SLOT_MARK, lens[i]))
+            goto failed;
+        len += lens[i];
+    }
+
+    if ((skel = malloc(len + 1)) == NULL)
+        goto failed;
+
+    char *p = skel;
+    for (size_t i = 0; i <= nr_slots; i++) {
+        memcpy(p, pieces[i], lens[i]);
+        p += lens[i];
+        if (i < nr_slots)
+            *p++ = SLOT_MARK;
+    }
+    *p = '\0';
+
+    holder = parse_simple_fragment(document, skel, len);
+    if (holder == NULL)
+        goto failed;
+
+    tpl = calloc(1, sizeof(*tpl));
+    if (tpl == NULL)
+        goto failed;
+
+    tpl->nr_slots = nr_slots;
+    if (nr_slots && (tpl->slot_kinds = malloc(nr_slots)) == NULL)
+        goto failed;
+    tpl_scan_slots(tpl, skel, len);
+
+    for (pcdom_node_t *n = holder->first_child; n; n = n->next) {
+        if (!tpl_compile_node(tpl, n))
+            goto failed;
+    }
+
+    /* a slot is lost, e.g., in a duplicate attribute */
+    if (tpl->next_slot != nr_slots)
+        goto failed;
+
+    pcdom_node_destroy_deep(holder);
+    free(skel);
+    return tpl;
+
+failed:
+    if (holder)
+        pcdom_node_destroy_deep(holder);
+    free(skel);
+    pchtml_fragment_tpl_destroy(tpl);
+    return NULL;
+}
+
+/* checks whether the value would be parsed as a part of the slot */
+static bool
+is_slot_value_simple(unsigned kind, const char *value, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = value[i];
+
+        switch (c) {
+        case '\0':
+        case '\r':
+        case '&':
+            return false;
+
+        case '<':
+            if (kind == SLOT_IN_TEXT || kind == SLOT_IN_UNQUOTED)
+                return false;
+            break;
+
+        case '"':
+            if (kind == SLOT_IN_DQUOTED || kind == SLOT_IN_UNQUOTED)
+                return false;
+            break;
+
+        case '\'':
+            if (kind == SLOT_IN_SQUOTED || kind == SLOT_IN_UNQUOTED)
+                return false;
+            break;
+
+        case '>':
+        case '=':
+        case '`':
+            if (kind == SLOT_IN_UNQUOTED)
+                return false;
+            break;
+
+        default:
+            if (kind == SLOT_IN_UNQUOTED && is_html_space(c))
+                return false;
+            break;
+        }
+    }
+
+    return true;
+}
+
+static bool
+tpl_build_value(struct fragment_parser *parser,
+        const pchtml_fragment_tpl_t *tpl, const struct tpl_op *op,
+        const char *const *values, const size_t *lens)
+{
+    parser->buf_len = 0;
+
+    for (size_t i = 0; i < op->nr_parts; i++) {
+        const struct tpl_part *part = tpl->parts + op->first_part + i;
+        bool ok;
+
+        if (part->slot < 0)
+            ok = buf_append(parser, tpl->strs + part->off, part->len);
+        else
+            ok = buf_append(parser, values[part->slot], lens[part->slot]);
+
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+pcdom_node_t *
+pchtml_fragment_tpl_instantiate(const pchtml_fragment_tpl_t *tpl,
+        pcdom_document_t *document, pcdom_element_t *context,
+        const char *const *values, const size_t *lens)
+{
+    struct fragment_parser parser = { .doc = document };
+    /* a void element may be one level deeper than the others */
+    pcdom_node_t *nodes[MAX_DEPTH + 1];
+    int depth = 0;
+
+    if (!is_simple_context(context))
+        return NULL;
+
+    for (size_t i = 0; i < tpl->nr_slots; i++) {
+        if (!is_slot_value_simple(tpl->slot_kinds[i], values[i], lens[i]))
+            return NULL;
+    }
+
+    pcdom_element_t *div = pcdom_document_create_element(document,
+            (const unsigned char *)"div", 3, NULL, false);
+    if (div == NULL)
+        return NULL;
+    nodes[0] = pcdom_interface_node(div);
+
+    for (size_t i = 0; i < tpl->nr_ops; i++) {
+        const struct tpl_op *op = tpl->ops + i;
+
+        switch (op->type) {
+        case TPL_OP_ELEMENT:
+        {
+            pcdom_element_t *elem = pcdom_document_create_element(document,
+                    (const unsigned char *)tpl->strs + op->name, op->name_len,
+                    NULL, false);
+            if (elem == NULL)
+                goto failed;
+
+            pcdom_node_append_child(nodes[depth], pcdom_interface_node(elem));
+            nodes[++depth] = pcdom_interface_node(elem);
+            break;
+        }
+
+        case TPL_OP_ATTR:
+            if (!tpl_build_value(&parser, tpl, op, values, lens))
+                goto failed;
+
+            /* an empty unquoted value is not an attribute value at all */
+            if (op->unquoted && parser.buf_len == 0)
+                goto failed;
+
+            if (pcdom_element_set_attribute(
+                        pcdom_interface_element(nodes[depth]),
+                        (const unsigned char *)tpl->strs + op->name,
+                        op->name_len,
+                        parser.buf ? parser.buf : (const unsigned char *)"",
+                        parser.buf_len) == NULL)
+                goto failed;
+            break;
+
+        case TPL_OP_TEXT:
+            if (!tpl_build_value(&parser, tpl, op, values, lens))
+                goto failed;
+
+            /* no text node for the empty text between the tags */
+            if (parser.buf_len) {
+                pcdom_text_t *text = pcdom_document_create_text_node(
+                        document, parser.buf, parser.buf_len);
+                if (text == NULL)
+                    goto failed;
+                pcdom_node_append_child(nodes[depth],
+                        pcdom_interface_node(text));
+            }
+            break;
+
+        case TPL_OP_LEAVE:
+            depth--;
+            break;
+        }
+    }
+
+    free(parser.buf);
+    return nodes[0];
+
+failed:
+    free(parser.buf);
+    pcdom_node_destroy_deep(nodes[0]);
+    return NULL;
+}
@@ -542,25 +542,9 @@ serializer_callback(const unsigned char  *data, size_t len, void *ctxt)
 {
     struct serializer_data *ud = (struct serializer_data*)ctxt;
 
-    char buf[1024];
-    size_t nr = sizeof(buf);
-    buf[0] = '\0';
-    char *p = pcutils_snprintf(buf, &nr, "%.*s", (int)len, (const char *)data);
-    PC_ASSERT((int64_t)nr>=0);
-    ud->nr += nr;
-
-    if (p == NULL) {
-        if (ud->oom == 0) {
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        }
-        ud->oom = -1;
-        return PCHTML_STATUS_OK;
-    }
-
-    ud->oom = ud->writer(p, nr, ud->oom, ud->ctxt);
-
-    if (p != buf)
-        free(p);
+    /* NOTE: the runs are passed to the writer without being copied. */
+    ud->nr += len;
+    ud->oom = ud->writer((const char *)data, len, ud->oom, ud->ctxt);
 
     return PCHTML_STATUS_OK;
 }
@@ -102,6 +102,42 @@ pchtml_html_parser_state(pchtml_html_parser_t *parser)
 }
 
 
+/*
+ * Parses a simple and well-formed fragment in the context of @context
+ * without the tree builder. Returns a div element holding the nodes
+ * parsed, or NULL if the fragment or the context needs the tree builder.
+ */
+pcdom_node_t *
+pchtml_html_parse_simple_fragment(pcdom_document_t *document,
+        pcdom_element_t *context, const char *fragment,
+        size_t length) WTF_INTERNAL;
+
+/* The fragment template: a fragment with the slots, compiled once. */
+typedef struct pchtml_fragment_tpl pchtml_fragment_tpl_t;
+
+/*
+ * Compiles the fragment made of the @nr_slots + 1 static @pieces and the
+ * slots between them. Returns NULL if the fragment, with the slots as parts
+ * of the texts or of the attribute values, needs the tree builder.
+ */
+pchtml_fragment_tpl_t *
+pchtml_fragment_tpl_compile(pcdom_document_t *document,
+        const char *const *pieces, const size_t *lens,
+        size_t nr_slots) WTF_INTERNAL;
+
+void
+pchtml_fragment_tpl_destroy(pchtml_fragment_tpl_t *tpl) WTF_INTERNAL;
+
+/*
+ * Builds the nodes of the template with the values of the slots in the
+ * context of @context. Returns a div element holding the nodes built, or
+ * NULL if the context or any value needs the fragment to be parsed.
+ */
+pcdom_node_t *
+pchtml_fragment_tpl_instantiate(const pchtml_fragment_tpl_t *tpl,
+        pcdom_document_t *document, pcdom_element_t *context,
+        const char *const *values, const size_t *lens) WTF_INTERNAL;
+
 #ifdef __cplusplus
 }       /* __cplusplus */
 #endif
@@ -43,6 +43,12 @@
 #define PCHTML_TOKENIZER_CHARS_MAP
 #include "str_res.h"
 
+#if CPU(X86_SSE2)
+#include <emmintrin.h>
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
 #define html_serialize_send(data, len, ctx)                                 \
     do {                                                                    \
         status = cb((const unsigned char *) data, len, ctx);                \
@@ -252,6 +258,101 @@ const char *pchtml_get_character_entity(uint32_t uc)
     return NULL;
 }
 
+/*
+ * The bytes which may start a character to escape: the ASCII ones with
+ * entities, the lead bytes of U+00A0 (0xC2) and U+200B-U+2063 (0xE2),
+ * and NUL or all C0 controls if @with_ctrls is true. Other bytes are
+ * always written as they are.
+ */
+static inline bool
+is_escape_candidate(unsigned char c, bool with_ctrls)
+{
+    switch (c) {
+    case '"':
+    case '&':
+    case '\'':
+    case '<':
+    case '>':
+    case 0xC2:
+    case 0xE2:
+        return true;
+    default:
+        break;
+    }
+
+    return with_ctrls ? (c < 0x20) : (c == 0);
+}
+
+/*
+ * Returns the length of the leading run of bytes in @str which contains
+ * no escape candidate, so that the run can be sent by one callback.
+ * The SIMD paths check 16 bytes at a time.
+ */
+static size_t
+clean_run_length(const unsigned char *str, size_t len, bool with_ctrls)
+{
+    size_t pos = 0;
+
+#if CPU(X86_SSE2)
+    const __m128i ctrl = _mm_set1_epi8(with_ctrls ? 0x1F : 0x00);
+    const __m128i quot = _mm_set1_epi8('"');
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i apos = _mm_set1_epi8('\'');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i lead2 = _mm_set1_epi8((char)0xC2);
+    const __m128i lead3 = _mm_set1_epi8((char)0xE2);
+
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + pos));
+        /* v <= ctrl (unsigned) iff min(v, ctrl) == v */
+        __m128i m = _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl), v);
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, quot));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, amp));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, apos));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, lt));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, gt));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, lead2));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, lead3));
+
+        int mask = _mm_movemask_epi8(m);
+        if (mask)
+            return pos + __builtin_ctz((unsigned)mask);
+    }
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+    const uint8x16_t ctrl = vdupq_n_u8(with_ctrls ? 0x20 : 0x01);
+    const uint8x16_t quot = vdupq_n_u8('"');
+    const uint8x16_t amp = vdupq_n_u8('&');
+    const uint8x16_t apos = vdupq_n_u8('\'');
+    const uint8x16_t lt = vdupq_n_u8('<');
+    const uint8x16_t gt = vdupq_n_u8('>');
+    const uint8x16_t lead2 = vdupq_n_u8(0xC2);
+    const uint8x16_t lead3 = vdupq_n_u8(0xE2);
+
+    for (; pos + 16 <= len; pos += 16) {
+        uint8x16_t v = vld1q_u8(str + pos);
+        uint8x16_t m = vcltq_u8(v, ctrl);
+        m = vorrq_u8(m, vceqq_u8(v, quot));
+        m = vorrq_u8(m, vceqq_u8(v, amp));
+        m = vorrq_u8(m, vceqq_u8(v, apos));
+        m = vorrq_u8(m, vceqq_u8(v, lt));
+        m = vorrq_u8(m, vceqq_u8(v, gt));
+        m = vorrq_u8(m, vceqq_u8(v, lead2));
+        m = vorrq_u8(m, vceqq_u8(v, lead3));
+
+        if (vmaxvq_u8(m))
+            break;      /* locate the byte in the scalar loop below */
+    }
+#endif
+
+    for (; pos < len; pos++) {
+        if (is_escape_candidate(str[pos], with_ctrls))
+            break;
+    }
+
+    return pos;
+}
+
 static int
 html_escape_unichar(uint32_t uc, pchtml_html_serialize_cb_f cb, void *ctx)
 {
@@ -726,6 +827,14 @@ html_serialize_send_escaping_attribute_string(
 
     const unsigned char *end = data + len;
     while (data != end) {
+        size_t n = clean_run_length(data, end - data, false);
+        if (n > 0) {
+            html_serialize_send(data, n, ctx);
+            data += n;
+            if (data == end)
+                break;
+        }
+
         const unsigned char *next =
             (const unsigned char *)pcutils_utf8_next_char(data);
         uint32_t uc = pcutils_utf8_to_unichar(data);
@@ -751,6 +860,14 @@ html_serialize_send_escaping_string(const unsigned char *data,
     const unsigned char *end = data + len;
 
     while (data != end) {
+        size_t n = clean_run_length(data, end - data, false);
+        if (n > 0) {
+            html_serialize_send(data, n, ctx);
+            data += n;
+            if (data == end)
+                break;
+        }
+
         const unsigned char *next =
             (const unsigned char *)pcutils_utf8_next_char(data);
         uint32_t uc = pcutils_utf8_to_unichar(data);
@@ -1532,6 +1649,14 @@ html_serialize_pretty_send_escaping_string(
     }
 
     while (data != end) {
+        size_t n = clean_run_length(data, end - data, true);
+        if (n > 0) {
+            html_serialize_send(data, n, ctx);
+            data += n;
+            if (data == end)
+                break;
+        }
+
         const unsigned char *next =
             (const unsigned char *)pcutils_utf8_next_char(data);
         uint32_t uc = pcutils_utf8_to_unichar(data);
@@ -293,15 +293,13 @@ element_attr_syntax_detection(struct pcvdom_element *elem, const char *name,
 static struct pcvdom_element*
 create_element(struct pcvdom_gen *gen, struct pchvml_token *token)
 {
-    UNUSED_PARAM(gen);
-
     int r = 0;
 
     const char *tag = pchvml_token_get_name(token);
     size_t nr_attrs = pchvml_token_get_attr_size(token);
 
     struct pcvdom_element *elem = NULL;
-    elem = pcvdom_element_create_c(tag);
+    elem = pcvdom_document_create_element_c(gen->doc, tag);
     if (!elem)
         goto end;
 
@@ -321,7 +319,7 @@ create_element(struct pcvdom_gen *gen, struct pchvml_token *token)
         }
 
         struct pcvdom_attr *vattr;
-        vattr = pcvdom_attr_create(name, op, vcm);
+        vattr = pcvdom_document_create_attr(gen->doc, name, op, vcm);
 
         if (!vattr) {
             r = -1;
@@ -360,7 +358,7 @@ create_head(struct pcvdom_gen *gen, struct pchvml_token *token)
     if (gen->doc->head)
         return -1;
 
-    elem = pcvdom_element_create_c("head");
+    elem = pcvdom_document_create_element_c(gen->doc, "head");
 
     if (!elem) {
         /* PURC_ERROR_OUT_OF_MEMORY */
@@ -410,7 +408,7 @@ create_body(struct pcvdom_gen *gen, struct pchvml_token *token)
     }
 
     if (!elem) {
-        elem = pcvdom_element_create_c("body");
+        elem = pcvdom_document_create_element_c(gen->doc, "body");
     }
 
     if (!elem) {
@@ -533,7 +531,7 @@ create_comment(struct pcvdom_gen *gen, struct pchvml_token *token)
     text = pchvml_token_get_text(token);
 
     struct pcvdom_comment *comment;
-    comment = pcvdom_comment_create(text);
+    comment = pcvdom_document_create_comment(gen->doc, text);
 
     if (!comment)
         return -1;
@@ -639,7 +637,7 @@ create_empty_hvml(struct pcvdom_gen *gen, struct pchvml_token *token)
 {
     int r = 0;
     struct pcvdom_element *elem = NULL;
-    elem = pcvdom_element_create_c("hvml");
+    elem = pcvdom_document_create_element_c(gen->doc, "hvml");
 
     if (!elem) {
         FAIL_RET(purc_get_last_error());
@@ -23,19 +23,21 @@
 """
 Make HVML attrs table:
     1. Read 'data/attrs.txt' file.
-    5. Generate the hvml-attr-static-list table.
-    5. Write code to 'hvml-attr-static-list.inc'.
+    2. Generate the perfect hash table of the attributes.
+    3. Write code to 'hvml-attr-static-list.inc'.
 """
 
 import os, sys
 import time
 import re
+import traceback
 
 # Find and append run script run dir to module search path
 ABS_PATH = os.path.dirname(os.path.abspath(__file__))
 sys.path.append("{}/../Scripts/".format(ABS_PATH))
 
 import LXB
+import PerfectHash
 
 WITHOUT_PRINT = 0
 
@@ -123,37 +125,6 @@ def scan_src_file(f_inc):
 
     return attr_info
 
-def str2key_simple (_str):
-    _bytes = _str.encode()
-    _len = len (_str)
-    return _bytes[0] * _bytes [_len - 1]
-
-def calc_hash_degree (attr_info, nr_slots):
-
-    degrees = []
-    for i in range (0, nr_slots):
-        degrees.append (0)
-
-    min_degree = nr_slots
-    max_degree = 0
-
-    for attr in attr_info:
-        slot_idx = attr_info[attr]['key'] % nr_slots
-        degrees [slot_idx] += 1
-
-    nr_zeros = 0
-    for d in degrees:
-        if d > max_degree:
-            max_degree = d
-        if d < min_degree:
-            min_degree = d
-        if d == 0:
-            nr_zeros += 1
-
-    if not WITHOUT_PRINT:
-        print("%s: min/max hash degree: (%d, %d) / %d; zero slots: %d; %d" % (TOOL_NAME, min_degree, max_degree, nr_slots, nr_zeros, nr_zeros * max_degree))
-    return nr_zeros * max_degree
-
 def make_attr_type(attr_token):
     attr_id = attr_token.upper()
     attr_id = attr_id.replace('-', '_')
@@ -161,7 +132,7 @@ def make_attr_type(attr_token):
 
     return "PCHVML_ATTR_TYPE_" + attr_id;
 
-def generate_static_attr_table (attr_info, str2key):
+def generate_static_attr_table (attr_info):
     attr_tokens = list(attr_info.keys())
 
     for attr in attr_tokens:
@@ -172,58 +143,25 @@ def generate_static_attr_table (attr_info, str2key):
 
     attr_types = {}
     for attr in attr_info:
-        attr_info[attr]['key'] = str2key (attr)
-        if not WITHOUT_PRINT:
-            print("%s: key of attribute name %s: 0x%x" % (TOOL_NAME, attr, attr_info[attr]['key'], ))
-
         attr_types[attr_info[attr]['type']] = 1
         if 'duplicated' in attr_info[attr].keys():
             if not WITHOUT_PRINT:
                 print("%s: duplicated attr: %s" % (TOOL_NAME, attr_info[attr]['duplicated'], ))
 
-    nr_attrs = len (attr_info)
-    min_degree = nr_attrs * nr_attrs
-    best_slots = 0
-    for nr_slots in range (nr_attrs, 2 * nr_attrs):
-        d = calc_hash_degree (attr_info, nr_slots)
-        if d < min_degree:
-            min_degree = d
-            best_slots = nr_slots
+    attrs = list(attr_info.keys())
+    disps, slots = PerfectHash.make (attrs)
 
     if not WITHOUT_PRINT:
-        print("%s: find the best number of slots: %d" % (TOOL_NAME, best_slots))
+        print("%s: %d attributes in %d slots with %d displacements" % (TOOL_NAME, len (attrs), len (slots), len (disps)))
 
     attr_table = []
-    for i in range (0, best_slots):
-        attr_table.append ({})
-
-    last_slot = best_slots
-    for attr in attr_info:
-        idx = attr_info[attr]['key'] % best_slots
-        if attr_table[idx]:
-            while attr_table[idx]['next'] and attr_table[idx]['next'] > 0:
-                idx = attr_table[idx]['next']
-            attr_table[idx]['next'] = last_slot
-            attr_table.append ({})
-            attr_table[last_slot]['attr'] = attr
-            attr_table[last_slot]['next'] = 0
-            last_slot += 1
+    for slot in slots:
+        if slot is None:
+            attr_table.append (None)
         else:
-            attr_table[idx]['attr'] = attr
-            attr_table[idx]['next'] = 0
-
-    idx = 0
-    for attr_slot in attr_table:
-        if attr_slot:
-            if not WITHOUT_PRINT:
-                print("%s: slot #%d: %s; next: %d" % (TOOL_NAME, idx, attr_slot['attr'], attr_slot['next']))
-        else:
-            if not WITHOUT_PRINT:
-                print("%s: slot #%d: no attr" % (TOOL_NAME, idx))
-
-        idx += 1
+            attr_table.append (attrs[slot])
 
-    return attr_types, best_slots, attr_table
+    return attr_types, disps, attr_table
 
 def write_attr_header (tmpl, dst, buf):
     lxb_temp = LXB.Temp(tmpl, dst)
@@ -232,19 +170,20 @@ def write_attr_header (tmpl, dst, buf):
     lxb_temp.build()
     lxb_temp.save()
 
-def write_static_attr_tables (tmpl_file, save_to, attr_info, best_slots, attr_table):
+def write_static_attr_tables (tmpl_file, save_to, attr_info, disps, attr_table):
     lxb_temp = LXB.Temp(tmpl_file, save_to)
-    lxb_temp.pattern_append("%%BEST_SLOTS%%", '{}'.format(best_slots))
+    lxb_temp.pattern_append("%%NR_DISPS%%", '{}'.format(len (disps)))
+    lxb_temp.pattern_append("%%NR_SLOTS%%", '{}'.format(len (attr_table)))
+    lxb_temp.pattern_append("%%PCHVML_ATTR_STATIC_DISPS%%",
+            PerfectHash.c_array (disps, lambda d: '{}'.format(d)))
 
     buf = []
     idx = 0
-    for attr_slot in attr_table:
-        if attr_slot:
-            key = str2key_simple (attr_slot['attr'])
-            buf.append("   // hash value of this attr: 0x%08x, slot index: %d" % (key, key % best_slots, ))
-            buf.append("   { \"%s\", %s, %d}, // %d" % (attr_slot['attr'], make_attr_type (attr_info[attr_slot['attr']]['type']), attr_slot['next'], idx))
+    for attr in attr_table:
+        if attr:
+            buf.append("   { \"%s\", %s }, // %d" % (attr, make_attr_type (attr_info[attr]['type']), idx))
         else:
-            buf.append("   { NULL, 0, 0}, // %d" % (idx))
+            buf.append("   { NULL, 0 }, // %d" % (idx))
         idx += 1
     lxb_temp.pattern_append("%%PCHVML_ATTR_STATIC_LIST_INDEX_RECORDS%%", '\n'.join(buf))
 
@@ -294,7 +233,7 @@ if __name__ == "__main__":
 
     if not WITHOUT_PRINT:
         print("Generating static attr table...")
-    attr_types, best_slots, attr_table = generate_static_attr_table (attr_info, str2key_simple)
+    attr_types, disps, attr_table = generate_static_attr_table (attr_info)
     if not WITHOUT_PRINT:
         print("DONE")
 
@@ -304,7 +243,7 @@ if __name__ == "__main__":
     if not WITHOUT_PRINT:
         print("Writting HVML static attr table to dst file %s..." % dst)
     try:
-        write_static_attr_tables (tmpl, dst, attr_info, best_slots, attr_table)
+        write_static_attr_tables (tmpl, dst, attr_info, disps, attr_table)
     except:
         if not WITHOUT_PRINT:
             print("FAILED")
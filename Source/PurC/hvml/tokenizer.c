@@ -676,6 +676,52 @@ is_content_text_finished(struct pcejson *ejson, uint32_t character)
     return false;
 }
 
+/*
+ * Consumes a run of the characters which need no transition of the state
+ * at once, and appends them to the temporary buffer. The run ends before
+ * the EOF, an invalid character, a character in `stops`, or a comma
+ * following another comma; that character is left to be reconsumed, so
+ * that it goes through the checks in pchvml_next_token() as usual.
+ *
+ * If `ws_first` is not NULL, the trailing whitespace characters are counted
+ * in `parser->nr_whitespace`, and the first of them is copied to `ws_first`.
+ */
+static void
+append_run_to_temp_buffer(struct pchvml_parser *parser,
+        const char *stops, size_t nr_stops, struct tkz_uc *ws_first)
+{
+    struct tkz_uc *uc;
+    while ((uc = tkz_reader_next_char(parser->reader))) {
+        uint32_t c = uc->character;
+        if (is_eof(c) || c == TKZ_INVALID_CHARACTER ||
+                (c < 0x80 && memchr(stops, c, nr_stops))) {
+            break;
+        }
+
+        if (is_separator(c)) {
+            if (c == ',' && parser->prev_separator == ',') {
+                break;
+            }
+            parser->prev_separator = c;
+        }
+        else if (!is_whitespace(c)) {
+            parser->prev_separator = 0;
+        }
+
+        if (ws_first) {
+            if (!is_whitespace(c)) {
+                parser->nr_whitespace = 0;
+            }
+            else if (parser->nr_whitespace++ == 0) {
+                *ws_first = *uc;
+            }
+        }
+        tkz_buffer_append(parser->temp_buffer, c);
+    }
+
+    tkz_reader_reconsume_last_char(parser->reader);
+}
+
 PCHVML_NEXT_TOKEN_BEGIN
 
 
@@ -1857,6 +1903,7 @@ BEGIN_STATE(TKZ_STATE_TEMPLATE_DATA)
         hee_column = parser->curr_uc->column;
     }
     APPEND_TO_TEMP_BUFFER(character);
+    append_run_to_temp_buffer(parser, "<", 1, NULL);
     ADVANCE_TO(TKZ_STATE_TEMPLATE_DATA);
 END_STATE()
 
@@ -1962,6 +2009,9 @@ BEGIN_STATE(TKZ_STATE_ATTRIBUTE_VALUE_DOUBLE_QUOTED)
             hee_column = parser->curr_uc->column;
         }
         APPEND_TO_TEMP_BUFFER(character);
+        if (parser->nr_quoted == 1) {
+            append_run_to_temp_buffer(parser, "\"", 1, NULL);
+        }
         ADVANCE_TO(TKZ_STATE_ATTRIBUTE_VALUE_DOUBLE_QUOTED);
     }
     if (character == '&') {
@@ -2010,6 +2060,9 @@ BEGIN_STATE(TKZ_STATE_ATTRIBUTE_VALUE_SINGLE_QUOTED)
     }
     if (parser->nr_quoted < 2) {
         APPEND_TO_TEMP_BUFFER(character);
+        if (parser->nr_quoted == 1) {
+            append_run_to_temp_buffer(parser, "'", 1, NULL);
+        }
         ADVANCE_TO(TKZ_STATE_ATTRIBUTE_VALUE_SINGLE_QUOTED);
     }
     if (character == '&') {
@@ -2126,6 +2179,7 @@ BEGIN_STATE(TKZ_STATE_CONTENT_TEXT)
         parser->nr_whitespace = 0;
     }
     APPEND_TO_TEMP_BUFFER(character);
+    append_run_to_temp_buffer(parser, "<&", 2, &multi_token_first_uc);
     ADVANCE_TO(TKZ_STATE_CONTENT_TEXT);
 END_STATE()
 
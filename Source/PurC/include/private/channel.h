@@ -32,6 +32,13 @@
 
 #define PCCHAN_MAX_LEN_NAME     63
 
+/* the flavors of a channel */
+#define PCCHAN_FLAVOR_LOCAL     "local"
+#define PCCHAN_FLAVOR_SHARED    "shared"
+
+/* the lock-free ring of a channel shared by runners; see channel.c */
+struct pcchan_shared;
+
 struct pcchan {
     /* the name of the channel */
     char           *name;
@@ -56,6 +63,10 @@ struct pcchan {
 
     /* the buffer for variants. */
     purc_variant_t  *data;
+
+    /* the ring shared with other runners; NULL for a local channel,
+       in which case the data above are not used. */
+    struct pcchan_shared *shared;
 };
 
 typedef struct pcchan *pcchan_t;
@@ -65,6 +76,14 @@ PCA_EXTERN_C_BEGIN
 pcchan_t
 pcchan_open(const char *chan_name, unsigned int cap) WTF_INTERNAL;
 
+/* Opens a channel which can be shared by the runners of the process;
+   attaches the current instance to the channel if it was opened by
+   another runner, and the capacity of the existing channel is kept. */
+pcchan_t
+pcchan_open_shared(const char *chan_name, unsigned int cap) WTF_INTERNAL;
+
+/* Retrieves the channel of the current instance, or attaches the current
+   instance to the shared channel opened by another runner. */
 pcchan_t
 pcchan_retrieve(const char *chan_name) WTF_INTERNAL;
 
@@ -74,9 +93,22 @@ pcchan_ctrl(pcchan_t chan, unsigned int new_cap) WTF_INTERNAL;
 void
 pcchan_destroy(pcchan_t chan) WTF_INTERNAL;
 
+/* Closes all channels of the current instance and detaches the instance
+   from the shared channels; called before the instance is recycled. */
+void
+pcchan_close_all(void) WTF_INTERNAL;
+
+/* Resumes the coroutines of the current instance waiting for a shared
+   channel; called when another runner wakes up this instance. */
+int
+pcchan_wake_up(const char *chan_name) WTF_INTERNAL;
+
 purc_variant_t
 pcchan_make_entity(pcchan_t chan) WTF_INTERNAL;
 
+unsigned int
+pcchan_shared_length(struct pcchan_shared *shared) WTF_INTERNAL;
+
 static inline unsigned int
 pcchan_capability(pcchan_t chan) {
     return chan->qsize;
@@ -84,6 +116,8 @@ pcchan_capability(pcchan_t chan) {
 
 static inline unsigned int
 pcchan_length(pcchan_t chan) {
+    if (chan->shared)
+        return pcchan_shared_length(chan->shared);
     return chan->qcount;
 }
 
@@ -36,6 +36,7 @@
 #include "private/debug.h"
 #include "private/errors.h"
 #include "private/map.h"
+#include "private/list.h"
 
 struct pcdoc_travel_info {
     pcdoc_node_type_k type;
@@ -51,6 +52,25 @@ struct pcdoc_travel_attrs_info {
 
 typedef int (*pcdoc_node_cb)(purc_document_t doc, void *node, void *ctxt);
 
+/*
+ * The content made of the static pieces in the target markup language and
+ * the values of the slots between them, e.g., the expansion of a template.
+ * The document may compile the pieces once, and then build the nodes from
+ * the values of the slots directly.
+ */
+struct pcdoc_tpl_content {
+    size_t                      nr_slots;
+    const char                **pieces;     // nr_slots + 1 pieces
+    size_t                     *piece_lens;
+    const char                **values;     // nr_slots values
+    size_t                     *value_lens;
+
+    /* the compiled pieces, and the operations which compiled them */
+    struct purc_document_ops   *compiler;
+    void                       *compiled;
+    bool                        uncompilable;
+};
+
 struct purc_document_ops {
     purc_document_t (*create)(const char *content, size_t length);
     void (*destroy)(purc_document_t doc);
@@ -71,6 +91,13 @@ struct purc_document_ops {
             pcdoc_element_t elem, pcdoc_operation_k op,
             const char *content, size_t length);
 
+    // nullable; returns a void node if the content needs to be parsed
+    pcdoc_node (*new_tpl_content)(purc_document_t doc,
+            pcdoc_element_t elem, pcdoc_operation_k op,
+            struct pcdoc_tpl_content *content);
+    // nullable; frees the pieces compiled by `new_tpl_content`
+    void (*free_tpl_compiled)(void *compiled);
+
     int (*set_attribute)(purc_document_t doc,
             pcdoc_element_t elem, pcdoc_operation_k op,
             const char *name, const char *val, size_t len);
@@ -145,6 +172,9 @@ struct purc_document_ops {
     int (*elem_coll_filter)(purc_document_t doc,
             pcdoc_elem_coll_t dst_coll,
             pcdoc_elem_coll_t src_coll, pcdoc_selector_t selector);
+
+    int (*get_mem_stat)(purc_document_t doc,
+            struct purc_document_mem_stat *stat);
 };
 
 struct pcdoc_elem_content {
@@ -172,6 +202,15 @@ struct purc_document {
     pcdoc_element_t root4select;
     struct purc_document_ops *ops;
 
+    /* the lazily built indexes of the elements for selecting */
+    struct pcdoc_index *index;
+
+    /* the cached class lists of the elements: element -> class list */
+    pcutils_uomap *class_lists;
+
+    /* the lazy element collections not materialized yet; see document.c */
+    struct list_head lazy_colls;
+
     void *impl;
 };
 
@@ -196,6 +235,14 @@ struct pcdoc_elem_coll {
 
     unsigned    refc;
     unsigned    doc_age;
+
+    /* the elements are not materialized yet */
+    unsigned    pending:1;
+    /* the first element has been found for the pending collection */
+    unsigned    first_found:1;
+    pcdoc_element_t first;
+    struct list_head ln;
+
     size_t      select_begin;
     size_t      select_size;
     size_t      nr_elems;
@@ -205,11 +252,27 @@ struct pcdoc_elem_coll {
     struct pcutils_arrlist *elems;
 };
 
+typedef enum {
+    PCDOC_INDEX_KEY_NONE = 0,
+    PCDOC_INDEX_KEY_ID,
+    PCDOC_INDEX_KEY_CLASS,
+    PCDOC_INDEX_KEY_TAG,
+} pcdoc_index_key_k;
+
 struct css_element_selector;
 struct pcdoc_selector {
     struct css_element_selector *selector;
     char       *id;
+
+    /* the key (in lower case) of the rightmost compound for the indexes */
+    char       *key;
+    pcdoc_index_key_k key_type;
+
+    /* the source text and the node in the LRU cache; see document.c */
+    char       *text;
+    struct list_head ln;
     unsigned    refc;
+    bool        cached;
 };
 
 
@@ -225,6 +288,46 @@ purc_document_t
 pcdoc_document_new(purc_document_type_k type,
         const char *content, size_t nr_content);
 
+/* Extracts the key for the indexes from the rightmost compound of
+   the selector; returns NULL if the selector can not use the indexes. */
+char *
+pcdoc_index_key_from_selector(const char *selector,
+        pcdoc_index_key_k *type) WTF_INTERNAL;
+
+/* Returns 0 and the candidates (nullable) in the document order
+   if the indexes can be used for the selector, otherwise -1. */
+int
+pcdoc_index_lookup(purc_document_t doc, pcdoc_selector_t selector,
+        struct pcutils_arrlist **candidates) WTF_INTERNAL;
+
+/* Keeps the indexes valid after a change not touching the indexed keys. */
+void
+pcdoc_index_keep(purc_document_t doc) WTF_INTERNAL;
+
+void
+pcdoc_index_delete(purc_document_t doc) WTF_INTERNAL;
+
+/* Re-selects the elements of a collection after the document changed;
+   returns 0 on success. */
+int
+pcdoc_elem_coll_update(pcdoc_elem_coll_t elem_coll) WTF_INTERNAL;
+
+/* Inserts or replaces the content of an element with a templated content;
+   returns a void node if the content should be given as a whole instead. */
+pcdoc_node
+pcdoc_element_new_tpl_content(purc_document_t doc,
+        pcdoc_element_t elem, pcdoc_operation_k op,
+        struct pcdoc_tpl_content *content) WTF_INTERNAL;
+
+/* Frees the compiled pieces of a templated content. */
+void
+pcdoc_tpl_content_release(struct pcdoc_tpl_content *content) WTF_INTERNAL;
+
+/* Removes the least recently used selectors from the cache of the current
+   instance except `nr_keep` ones; returns the number of the ones removed. */
+size_t
+pcdoc_selector_cache_trim(size_t nr_keep) WTF_INTERNAL;
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -78,6 +78,80 @@ int pcejson_set_state(struct pcejson *parser, int state);
 
 int pcejson_set_state_param_string(struct pcejson *parser);
 
+/*
+ * Build the variant directly from a plain JSON text, without creating
+ * the VCM tree. Returns 0 on success; returns -1 if the text is not plain
+ * JSON (e.g. having expressions or eJSON extensions) or is malformed, in
+ * which case the caller should fall back to pcejson_parse().
+ */
+int pcejson_parse_plain (purc_variant_t *value, const char *json, size_t sz,
+                   uint32_t depth);
+
+/*
+ * The event-based (SAX-style) parser for plain JSON, which can be fed with
+ * partial buffers. A handler returns 0 to continue, a positive value to
+ * suspend the parsing after the event, or a negative value to abort.
+ * A handler can be NULL. The strings passed to `key` are not
+ * null-terminated, and the variants passed to `value` are scalars which
+ * should be referenced by the handler if it wants to keep them.
+ */
+struct pcejson_sax_handlers {
+    int (*start_object)(void *ctxt);
+    int (*end_object)(void *ctxt);
+    int (*start_array)(void *ctxt);
+    int (*end_array)(void *ctxt);
+    int (*key)(void *ctxt, const char *key, size_t len);
+    int (*value)(void *ctxt, purc_variant_t value);
+};
+
+/* accept a sequence of top-level values */
+#define PCEJSON_SAX_FLAG_MULTIPLE       0x0001
+/* accept newline-delimited top-level values (NDJSON); implies MULTIPLE */
+#define PCEJSON_SAX_FLAG_LINES          0x0002
+
+struct pcejson_sax;
+
+struct pcejson_sax *
+pcejson_sax_new (const struct pcejson_sax_handlers *handlers, void *ctxt,
+                   uint32_t depth, unsigned flags);
+
+void pcejson_sax_delete (struct pcejson_sax *sax);
+
+/*
+ * Feed the parser with the next part of the text. Returns the number of
+ * bytes consumed, which is less than `len` only if a handler suspended the
+ * parsing; the caller should feed the rest later. Returns -1 on error.
+ */
+ssize_t pcejson_sax_feed (struct pcejson_sax *sax, const char *buf, size_t len);
+
+/*
+ * Tell the parser there is no more input. Returns 0 if the text is
+ * complete, or -1 on error.
+ */
+int pcejson_sax_end (struct pcejson_sax *sax);
+
+/*
+ * The builder of a variant from a plain JSON text which can be fed with
+ * partial buffers, e.g., the chunks of a response as they arrive. Only the
+ * containers being built are kept in memory, not the text.
+ */
+struct pcejson_builder;
+
+struct pcejson_builder *
+pcejson_builder_new (uint32_t depth);
+
+void pcejson_builder_delete (struct pcejson_builder *builder);
+
+/* Feed the builder with the next part of the text; returns 0 or -1. */
+int pcejson_builder_feed (struct pcejson_builder *builder,
+                   const char *buf, size_t len);
+
+/*
+ * Tell the builder there is no more input. Returns the variant built,
+ * or PURC_VARIANT_INVALID if the text is incomplete or malformed.
+ */
+purc_variant_t pcejson_builder_end (struct pcejson_builder *builder);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
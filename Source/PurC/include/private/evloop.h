@@ -0,0 +1,105 @@
+/*
+ * @file evloop.h
+ * @date 2026/10/14
+ * @brief The native epoll backend of the run loop.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PURC_PRIVATE_EVLOOP_H
+#define PURC_PRIVATE_EVLOOP_H
+
+#include "config.h"
+
+#include "purc-macros.h"
+#include "purc-runloop.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * The event loop multiplexes the file descriptors monitored, the timers,
+ * and the functions dispatched from other threads of a run loop onto one
+ * epoll instance, and the run loop only monitors the epoll instance.
+ * It is available only if PurC is built with ENABLE_EPOLL_RUNLOOP.
+ */
+struct pcintr_evloop;
+
+/* the handles of the monitors of an event loop are tagged by the lowest bit,
+   so that they can be told from the ones of the run loop. */
+#define PCINTR_EVLOOP_HANDLE_TAG    ((uintptr_t)1)
+
+static inline bool pcintr_evloop_is_handle(uintptr_t handle)
+{
+    return (handle & PCINTR_EVLOOP_HANDLE_TAG) != 0;
+}
+
+PCA_EXTERN_C_BEGIN
+
+/*
+ * Creates the event loop of a run loop; called in the thread of the run
+ * loop. Returns NULL if the event loop is not available.
+ */
+struct pcintr_evloop *pcintr_evloop_create(purc_runloop_t runloop)
+    WTF_INTERNAL;
+
+/* Destroys an event loop; the pending functions and timers are discarded. */
+void pcintr_evloop_destroy(struct pcintr_evloop *evloop) WTF_INTERNAL;
+
+/* Finds the event loop of a run loop; it can be called in any thread. */
+struct pcintr_evloop *pcintr_evloop_find(purc_runloop_t runloop)
+    WTF_INTERNAL;
+
+/* Returns the epoll file descriptor, which the run loop should monitor. */
+int pcintr_evloop_fd(struct pcintr_evloop *evloop) WTF_INTERNAL;
+
+/* Handles the ready events; called when the epoll file descriptor is
+   readable. */
+void pcintr_evloop_handle_events(struct pcintr_evloop *evloop)
+    WTF_INTERNAL;
+
+/*
+ * Monitors a file descriptor. Returns the handle of the monitor, or 0 if
+ * the file descriptor can not be monitored by epoll, e.g., a regular file.
+ */
+uintptr_t pcintr_evloop_add_fd_monitor(struct pcintr_evloop *evloop, int fd,
+        purc_runloop_io_event event, purc_runloop_io_callback callback,
+        void *ctxt) WTF_INTERNAL;
+
+void pcintr_evloop_remove_fd_monitor(struct pcintr_evloop *evloop,
+        uintptr_t handle) WTF_INTERNAL;
+
+/* Dispatches a function to the event loop; it can be called in any thread
+   for it does not take any lock. Returns 0 on success, or -1 on failure. */
+int pcintr_evloop_dispatch(struct pcintr_evloop *evloop,
+        purc_runloop_func func, void *ctxt) WTF_INTERNAL;
+
+/* Calls the function once after the time; called in the thread of the event
+   loop. Returns 0 on success, or -1 on failure. */
+int pcintr_evloop_dispatch_after(struct pcintr_evloop *evloop, long time_ms,
+        purc_runloop_func func, void *ctxt) WTF_INTERNAL;
+
+/* Calls the callback every interval until it returns false; called in the
+   thread of the event loop. Returns 0 on success, or -1 on failure. */
+int pcintr_evloop_set_timeout(struct pcintr_evloop *evloop,
+        purc_runloop_timeout_callback callback, void *ctxt,
+        uint32_t interval) WTF_INTERNAL;
+
+PCA_EXTERN_C_END
+
+#endif  /* PURC_PRIVATE_EVLOOP_H */
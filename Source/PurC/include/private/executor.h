@@ -31,6 +31,7 @@
 #include "purc-errors.h"
 #include "purc-executor.h"
 
+#include "private/list.h"
 #include "private/map.h"
 
 PCA_EXTERN_C_BEGIN
@@ -98,9 +99,20 @@ int pcexec_register_ops(pcexec_ops_t ops);
 int pcexec_get_by_rule(const char *rule, pcexec_ops_t ops);
 
 
+struct pcexec_rule_cache_stat {
+    size_t              nr_hits;
+    size_t              nr_misses;
+    size_t              nr_rules;       // the rules in the cache
+};
+
 struct pcexecutor_heap {
     unsigned int       debug_flex:1;
     unsigned int       debug_bison:1;
+
+    /* the parsed rules, the most recently used first; see executor.c */
+    struct list_head   rules;
+    pcutils_uomap     *rule_map;        // rule text to the parsed rule
+    struct pcexec_rule_cache_stat rule_stat;
 };
 
 // 用于迭代的迭代器
@@ -140,6 +152,34 @@ int pcexecutor_get_by_rule(const char *rule, pcexec_ops_t ops);
 purc_atom_t
 pcexecutor_get_rule_name(const char *rule);
 
+/* the parsed rule of an executor, shared by its instances in a thread */
+struct pcexec_rule;
+
+typedef void (*pcexec_rule_release_fn)(void *ast);
+
+/* Finds the parsed rule of the executor named by @name for the rule text
+   in the cache of the current instance, and holds a reference of it;
+   NULL if not cached. */
+struct pcexec_rule *
+pcexecutor_find_parsed_rule(const char *name, const char *rule);
+
+/* Puts the parsed rule (@ast) to the cache, which takes the ownership of
+   @ast, and returns the cached rule with a reference held; NULL if
+   failed, when @ast has been released. */
+struct pcexec_rule *
+pcexecutor_cache_parsed_rule(const char *name, const char *rule,
+        void *ast, pcexec_rule_release_fn release);
+
+/* Releases the reference of the parsed rule got by the functions above. */
+void
+pcexecutor_release_parsed_rule(struct pcexec_rule *cached);
+
+void *
+pcexecutor_parsed_rule_ast(struct pcexec_rule *cached);
+
+void
+pcexecutor_get_rule_cache_stat(struct pcexec_rule_cache_stat *stat);
+
 
 PCA_EXTERN_C_END
 
@@ -66,6 +66,46 @@ bool pcfetcher_is_init(void);
 
 void pcfetcher_cancel_async(purc_variant_t request);
 
+/* gets the number of the requests in flight in the process */
+size_t pcfetcher_get_nr_pending_requests(void);
+
+/*
+ * Fetches the remote resource of the URL in background to have its response
+ * in the cache of the fetcher. Returns 0 if the request was issued or the
+ * response is fresh in the cache; -1 if there is no remote fetcher, or
+ * the fetcher has max_conns requests in flight.
+ */
+int pcfetcher_prefetch(struct pcfetcher_session *session, const char *url,
+        uint32_t timeout);
+
+struct pcfetcher_origin_stats {
+    /* the origin such as `https://example.com:8080` */
+    const char *origin;
+    /* the number of the requests finished */
+    size_t nr_requests;
+    /* the number of the requests sent over a kept-alive connection */
+    size_t nr_reused;
+    /* the number of the requests needing a new connection */
+    size_t nr_connects;
+    /* the number of the new connections needing a TLS handshake */
+    size_t nr_tls_handshakes;
+    /* the number of the requests served over HTTP/2 */
+    size_t nr_http2;
+};
+
+/* Returns true to stop the iteration. */
+typedef bool (*pcfetcher_origin_stats_cb)(
+        const struct pcfetcher_origin_stats *stats, void *ctxt);
+
+/*
+ * Calls @cb for the statistics of the connection pool of every origin
+ * the remote fetcher has requested, in the order of the first request.
+ * Returns the number of the origins visited. The callback is called with
+ * a lock held; it should not call into the fetcher.
+ */
+size_t pcfetcher_foreach_origin_stats(pcfetcher_origin_stats_cb cb,
+        void *ctxt);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -61,10 +61,17 @@
 extern "C" {
 #endif
 
+/** Sort the entries in a slot; for the chained table only */
+#define PCHASH_FLAG_SORTED      0x0001
+
+/** Use open addressing with group probing instead of chaining */
+#define PCHASH_FLAG_OPEN        0x0002
+
 /* hash functions */
 uint32_t pchash_default_str_hash(const void *k);
 uint32_t pchash_perlish_str_hash(const void *k);
 uint32_t pchash_fnv1a_str_hash(const void *k);
+uint32_t pchash_fast_str_hash(const void *k);
 uint32_t pchash_default_ptr_hash(const void *k);
 uint32_t pchash_fnv1a_ptr_hash(const void *k);
 uint32_t pchash_fnv1a_u32_hash(const void *k);
@@ -127,8 +134,27 @@ struct pchash_table {
     /** the read-write lock if multiple threads enabled */
     purc_rwlock     rwlock;
 
-    /** The table slots. */
+    /** The table slots; for the chained table only. */
     struct list_head *table;
+
+    /* The following fields are for the open-addressing table only. */
+
+    /** The control bytes of the slots. */
+    uint8_t *ctrl;
+    /** The entries in the slots. */
+    struct pchash_entry **slots;
+    /** The number of the empty slots can be used before growing. */
+    size_t growth_left;
+
+    /** The old slots being moved to the new ones while growing. */
+    uint8_t *old_ctrl;
+    struct pchash_entry **old_slots;
+    size_t old_size;
+    /** The index of the next group of the old slots to move. */
+    size_t migrated;
+
+    /** All entries in the order of insertion. */
+    struct list_head entries;
 };
 
 typedef struct pchash_table pchash_table;
@@ -158,6 +184,28 @@ pchash_table_new(size_t size,
         pchash_hash_fn hash_fn, pchash_keycmp_fn keycmp_fn,
         bool threads, bool sorted);
 
+/**
+ * Create a new hash table with the flags.
+ *
+ * Same as pchash_table_new(), but the kind of the table is selected by
+ * @flags, which is the bitwise OR of PCHASH_FLAG_SORTED and
+ * PCHASH_FLAG_OPEN.
+ *
+ * An open-addressing table (PCHASH_FLAG_OPEN) keeps the pointers to the
+ * entries in a flat array and probes a group of slots at a time. When it
+ * grows, the entries are moved to the new array a few groups per insertion
+ * or erasure instead of all at once. It can not be sorted.
+ *
+ * @return On success, a pointer to the new hash table is returned.
+ *     On error, a null pointer is returned.
+ */
+struct pchash_table *
+pchash_table_new_ex(size_t size,
+        pchash_copy_key_fn copy_key, pchash_free_key_fn free_key,
+        pchash_copy_val_fn copy_val, pchash_free_val_fn free_val,
+        pchash_hash_fn hash_fn, pchash_keycmp_fn keycmp_fn,
+        bool threads, unsigned flags);
+
 /**
  * Convenience function to create a new hash table with char keys
  * by using the pchash_fnv1a_str_hash() hash function.
@@ -405,6 +453,13 @@ int pchash_table_erase_entry(struct pchash_table *t, pchash_entry_t e);
  */
 int pchash_table_erase(struct pchash_table *t, const void *k);
 
+/**
+ * Check whether the table is an open-addressing one.
+ */
+static inline bool pchash_table_is_open(const struct pchash_table *t) {
+    return (t->flags & PCHASH_FLAG_OPEN) != 0;
+}
+
 /**
  * Get the count of the entries in the table.
  * @return The count of entries of the table.
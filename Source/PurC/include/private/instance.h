@@ -91,6 +91,9 @@ struct pcinst {
     /* the FILE object for logging (-1: use syslog; NULL: disabled) */
     FILE                   *fp_log;
 
+    /* the ring buffer for the asynchronous log; NULL if disabled; see log.c */
+    struct pclog_ring      *log_ring;
+
     /* data bound to the current session, e.g, the statbuf of the random
        number generator (using unordered map) */
     pcutils_uomap          *local_data_map;
@@ -115,6 +118,55 @@ struct pcinst {
 
     /* Since 0.9.17 */
     purc_variant_t         app_manifest;
+
+    /* the recycled messages linked by the headers; see move-buffer.c */
+    struct list_head       *free_msgs;
+    size_t                  nr_free_msgs;
+    size_t                  nr_msg_hits;
+    size_t                  nr_msg_misses;
+
+    /* the cached compiled regular expressions in LRU order; see regex.c */
+    struct list_head        regexes;
+    size_t                  nr_regexes;
+    size_t                  nr_regex_hits;
+    size_t                  nr_regex_misses;
+
+    /* the cached compiled logical expressions in LRU order;
+       see dvobjs/logical.c */
+    struct list_head        logicals;
+    size_t                  nr_logicals;
+    size_t                  nr_logical_hits;
+    size_t                  nr_logical_misses;
+
+    /* the cached rules of the timezones and the compiled time formats
+       in LRU order; see dvobjs/timezone.c and dvobjs/datetime.c */
+    struct list_head        timezones;
+    size_t                  nr_timezones;
+    size_t                  nr_timezone_hits;
+    size_t                  nr_timezone_misses;
+    struct list_head        timeformats;
+    size_t                  nr_timeformats;
+    /* the buffer reused to format the times */
+    char                   *tfmt_buff;
+    size_t                  sz_tfmt_buff;
+
+    /* the cached compiled selectors in LRU order; see document.c */
+    struct list_head        selectors;
+    size_t                  nr_selectors;
+    size_t                  nr_selector_hits;
+    size_t                  nr_selector_misses;
+
+    /* the ring buffer of the tracing spans; NULL if disabled; see trace.c */
+    struct pctrace_ring    *trace;
+
+    /* the io_uring of the run loop; NULL if not available; see uring.c */
+    struct pcintr_uring    *uring;
+    unsigned int            uring_tried:1;
+
+    /* the epoll event loop of the run loop; NULL if not available, and
+       the monitor of it on the run loop; see evloop.c */
+    struct pcintr_evloop   *evloop;
+    uintptr_t               evloop_monitor;
 };
 
 PCA_EXTERN_C_BEGIN
@@ -133,6 +185,15 @@ pcinst_get_session_variables(const char* name)
 struct pcrdr_msg *pcinst_get_message(void) WTF_INTERNAL;
 void pcinst_put_message(struct pcrdr_msg *msg) WTF_INTERNAL;
 
+/* gets the numbers of the messages got from the pool of the current
+   instance (hits) and the ones newly allocated (misses) */
+void pcinst_get_message_pool_stat(size_t *nr_hits, size_t *nr_misses)
+    WTF_INTERNAL;
+
+/* frees the recycled messages of the current instance except `nr_keep`
+   ones; returns the size of the memory freed */
+size_t pcinst_trim_message_pool(size_t nr_keep) WTF_INTERNAL;
+
 int
 pcinst_broadcast_event(pcrdr_msg_event_reduce_opt reduce_op,
         purc_variant_t source_uri, purc_variant_t observed,
@@ -141,6 +202,9 @@ pcinst_broadcast_event(pcrdr_msg_event_reduce_opt reduce_op,
 
 void pcinst_clear_error(struct pcinst *inst) WTF_INTERNAL;
 
+/* writes the pending messages and stops the asynchronous log */
+void pcinst_stop_async_log(struct pcinst *inst) WTF_INTERNAL;
+
 purc_atom_t
 pcinst_endpoint_get(char *endpoint_name, size_t sz,
         const char *app_name, const char *runner_name) WTF_INTERNAL;
@@ -154,6 +218,12 @@ pcinst_dump_err_info(void) WTF_INTERNAL;
 purc_variant_t
 pcinst_load_app_manifest(const char *app_name) WTF_INTERNAL;
 
+/* gets the entry of the runner in the manifest of the app, without loading
+   the manifest for the current instance; the caller should unref it */
+purc_variant_t
+pcinst_get_runner_manifest(const char *app_name, const char *runner_name)
+    WTF_INTERNAL;
+
 purc_variant_t
 pcinst_get_runner_label(const char *runner_name, const char *locale) WTF_INTERNAL;
 
@@ -41,6 +41,7 @@
 #include "private/timer.h"
 #include "private/sorted-array.h"
 #include "private/avl.h"
+#include "private/variant.h"
 
 #define PCINTR_MOVE_BUFFER_SIZE 64
 #define CRTN_TOKEN_LEN          15
@@ -64,7 +65,9 @@
 #define MSG_TYPE_RESPONSE             "response"
 #define MSG_TYPE_FETCHER_STATE        "fetcherState"
 #define MSG_TYPE_REQUEST_CHAN         "requestChan"
+#define MSG_TYPE_WAKEUP_CHAN          "wakeupChan"
 #define MSG_TYPE_NEW_RENDERER         "newRenderer"
+#define MSG_TYPE_EXPIRED              "expired"
 
 
 #define MSG_SUB_TYPE_ASTERISK         "*"
@@ -80,9 +83,12 @@
 #define MSG_SUB_TYPE_PAGE_SUPPRESSED  "pageSuppressed"
 #define MSG_SUB_TYPE_PAGE_RELOADED    "pageReloaded"
 #define MSG_SUB_TYPE_PAGE_CLOSED      "pageClosed"
+#define MSG_SUB_TYPE_PAGE_HIDDEN      "pageHidden"
+#define MSG_SUB_TYPE_PAGE_SHOWN       "pageShown"
 #define MSG_SUB_TYPE_CONN_LOST        "connLost"
 #define MSG_SUB_TYPE_OBSERVING        "observing"
 #define MSG_SUB_TYPE_PROGRESS         "progress"
+#define MSG_SUB_TYPE_TIMING           "timing"
 #define MSG_SUB_TYPE_NEW_RENDERER     "newRenderer"
 
 #define CRTN_TOKEN_MAIN               "_main"
@@ -123,6 +129,57 @@ struct pcintr_cancel {
     struct list_head             node;
 };
 
+#define PCINTR_NR_CRTN_PRIORITIES   \
+    (PURC_CRTN_PRIORITY_HIGH - PURC_CRTN_PRIORITY_LOW + 1)
+
+/* the default and the maximal time quanta of the normal priority */
+#define DEF_SCHED_QUANTUM_US        5000
+#define MAX_SCHED_QUANTUM_US        1000000
+
+/* the latencies from being ready to running of a priority class */
+struct pcintr_sched_stat {
+    uint64_t            nr_samples;
+    uint64_t            total_us;
+    uint64_t            max_us;
+};
+
+struct pcintr_profiler;
+
+/* the size classes of the frame pool: 64, 128, ..., 2048 bytes */
+#define PCINTR_FRAME_POOL_NR_CLASSES    6
+
+/* the free lists of the stack frames and the contexts of the elements */
+struct pcintr_frame_pool {
+    void               *free_blocks[PCINTR_FRAME_POOL_NR_CLASSES];
+    uint32_t            nr_free[PCINTR_FRAME_POOL_NR_CLASSES];
+    uint64_t            nr_allocs;      // all allocations
+    uint64_t            nr_reused;      // the ones taken from a free list
+    uint64_t            nr_oversized;   // the ones too large to be pooled
+    uint64_t            nr_in_use;
+    uint64_t            max_in_use;
+};
+
+/* the levels of trimming the memory when the instance is idle */
+enum pcintr_idle_trim_level {
+    PCINTR_IDLE_TRIM_POOLS = 0,     // the free lists of the pools
+    PCINTR_IDLE_TRIM_CACHES,        // plus the caches
+    PCINTR_IDLE_TRIM_ALL,           // plus returning memory to the system
+};
+
+/* the policy and the statistics of trimming the memory when idle */
+struct pcintr_idle_trim {
+    uint32_t            after_ms;       // 0 if disabled
+    int                 level;
+    uint64_t            last_steps;     // heap->nr_steps seen last time
+    double              idle_since;
+    bool                trimmed;        // in the current idle period
+
+    uint64_t            nr_trims;
+    uint64_t            sz_freed;       // the memory freed from the pools
+    uint64_t            nr_uncached;    // the entries removed from caches
+    uint64_t            nr_sys_trims;   // the times memory returned
+};
+
 struct pcintr_heap {
     // owner instance
     struct pcinst      *owner;
@@ -146,7 +203,20 @@ struct pcintr_heap {
     pcintr_timer_t     *event_timer;    // 10ms
 
     purc_cond_handler   cond_handler;
+    struct pcintr_sched_stat sched_stats[PCINTR_NR_CRTN_PRIORITIES];
+    uint32_t            sched_quantum_us;   // for the normal priority
+    uint32_t            sched_max_steps;    // 0 for no limit
+    uint32_t            sched_rounds;       // decides the class first served
+    uint64_t            nr_steps;   // the steps run by all coroutines
+    int                 pool_slot;  // -1 if not a worker of the runner pool
+    uint32_t            vars_gen;   // bumped when a named variable is
+                                    // added or removed; see var-mgr.c
+    struct pcintr_profiler *profiler;   // NULL if never enabled
+    struct pcintr_frame_pool frame_pool;
+    struct pcintr_idle_trim idle_trim;
     unsigned int        keep_alive:1;
+    unsigned int        profiling:1;
+    unsigned int        shutdown_asked:1;
     double              timestamp;
 };
 
@@ -204,6 +274,8 @@ struct pcintr_stack {
     struct list_head              frames;
     // the number of stack frames.
     size_t                        nr_frames;
+    // the serial of the last pushed frame.
+    uint64_t                      last_frame_serial;
 
     // the pointer to the vDOM tree.
     purc_vdom_t                   vdom;
@@ -256,6 +328,23 @@ struct pcintr_stack {
     /* create by hvml <observe on...> */
     struct list_head              hvml_observers;
 
+    /* the observers using the default matcher indexed by the event type,
+       and the others which have to be checked for every event */
+    pcutils_uomap                *observer_index;
+    struct list_head              intr_wildcards;
+    struct list_head              hvml_wildcards;
+    uint64_t                      observer_seq;
+
+    /* the observers of the eDOM elements using the default matcher, and
+       the index of them by the element, which is rebuilt lazily when the
+       observers or the document change */
+    struct list_head              intr_elem_observers;
+    struct list_head              hvml_elem_observers;
+    pcutils_uomap                *elem_observer_index;
+    purc_document_t               elem_index_doc;
+    unsigned                      elem_index_age;
+    bool                          elem_index_dirty;
+
     // async request ids (array)
     purc_variant_t                async_request_ids;
 
@@ -347,6 +436,8 @@ struct pcintr_coroutine {
 
     struct pcinst_msg_queue    *mq;     /* message queue */
     struct list_head            tasks;  /* one event with multiple observers */
+    struct list_head            futures;    /* results of the children */
+    struct list_head            changes;    /* coalesced change events */
 
     /* $CRTN  begin */
     /** The target as a null-terminated string. */
@@ -367,11 +458,20 @@ struct pcintr_coroutine {
 
     /** The default timeout value for remote requests or channel operations. */
     struct timespec             timeout;
+
+    /** The memory usage of variants and the quotas. */
+    struct pcvariant_usage      vusage;
     /* $CRTN  end */
 
     struct pcintr_timers       *timers;     // $TIMERS
     struct pcvarmgr            *variables;  // coroutine level named variable
+    pcutils_uomap              *vcm_consts; // values of constant vcm nodes
+    struct pcvcm_inline_cache  *vcm_ics;    // inline caches of vcm getters
+    struct pcintr_var_slot     *var_slots;  // resolved named variables
+    struct pcvcm_eval_ctxt_pool *vcm_ctxt_pool; // recycled vcm contexts
     struct pcfetcher_session   *fetcher_session;
+    purc_variant_t              rdr_batch;  // coalesced DOM operations
+    struct pcintr_mutation_log *mutation_log;   // the operations sent
 
     /* AVL node for the AVL tree sorted by stopped timeout */
     struct avl_node             avl;
@@ -380,9 +480,17 @@ struct pcintr_coroutine {
     unsigned long               run_idx;
     time_t                      stopped_timeout;
 
+    /* for scheduling; see execute_one_step() in scheduler.c */
+    int                         priority;       // purc_crtn_priority_k
+    int64_t                     sched_deficit;  // in microseconds
+    struct timespec             ready_since;
+
     /* misc. flags go here */
     uint32_t                    is_main:1;
     uint32_t                    sending_document_by_url:1;
+    uint32_t                    ready_stamped:1;
+    uint32_t                    pool_counted:1; // in the load of the worker
+    uint32_t                    page_hidden:1;  // the renderer hid the page
 };
 
 enum purc_symbol_var {
@@ -472,6 +580,8 @@ struct pcintr_stack_frame {
     enum pcintr_stack_frame_next_step next_step;
 
     pcintr_stack_t     owner;
+    // the serial of the frame, unique in the stack.
+    uint64_t           serial;
 
     purc_variant_t     except_templates;
     purc_variant_t     error_templates;
@@ -536,6 +646,12 @@ struct pcintr_observer {
     // the arraylist containing this struct pointer
     struct list_head* list;
 
+    // the link in the index of the stack, and the order of registration
+    struct list_head    index_node;
+    uint64_t            seq;
+    // whether it is in the list of the element observers
+    bool                on_elements;
+
     // callback when revoke observer
     observer_on_revoke_fn on_revoke;
     void *on_revoke_data;
@@ -557,6 +673,9 @@ extern time_t g_purc_run_monotonic_ms;
 
 bool pcintr_bind_builtin_runner_variables(void);
 
+/* drops all runner-level variables and binds the built-in ones again */
+bool pcintr_reset_runner_variables(void);
+
 struct pcintr_heap* pcintr_get_heap(void);
 
 pcintr_stack_t pcintr_get_stack(void);
@@ -671,6 +790,22 @@ pcintr_get_scope_variable(purc_coroutine_t cor, pcvdom_element_t elem,
 purc_variant_t
 pcintr_find_named_var(pcintr_stack_t stack, const char* name);
 
+struct pcintr_var_slot;
+
+/* Gets the slots caching the resolutions of the named variables in
+   the stack, which are created on demand. */
+struct pcintr_var_slot *
+pcintr_get_var_slots(pcintr_stack_t stack);
+
+/* Like pcintr_find_named_var(), but caches the resolution of the name in
+   the slot for the vcm node having the stamp. */
+purc_variant_t
+pcintr_find_named_var_cached(pcintr_stack_t stack, const char* name,
+        struct pcintr_var_slot *slots, uint64_t stamp);
+
+void
+pcintr_var_slots_destroy(struct pcintr_var_slot *slots);
+
 purc_variant_t
 pcintr_get_symbolized_var (pcintr_stack_t stack, unsigned int number,
         char symbol);
@@ -700,6 +835,10 @@ pcintr_timers_init(purc_coroutine_t cor);
 void
 pcintr_timers_destroy(struct pcintr_timers* timers);
 
+/* throttles or unthrottles all the timers in $TIMERS of a coroutine */
+void
+pcintr_timers_throttle(struct pcintr_timers* timers, bool throttled);
+
 bool
 pcintr_is_timers(purc_coroutine_t cor, purc_variant_t v);
 
@@ -777,6 +916,14 @@ pcintr_util_new_content(purc_document_t doc,
         const char *content, size_t len, purc_variant_t data_type,
         bool sync_to_rdr, bool no_return);
 
+/* Same as pcintr_util_new_content(), but builds the nodes from the values
+   of the slots if @content is the last expansion of the template @tpl. */
+pcdoc_node
+pcintr_util_new_tpl_content(purc_document_t doc,
+        pcdoc_element_t elem, pcdoc_operation_k op,
+        purc_variant_t tpl, purc_variant_t content, purc_variant_t data_type,
+        bool sync_to_rdr, bool no_return);
+
 pcdoc_data_node_t
 pcintr_util_set_data_content(purc_document_t doc,
         pcdoc_element_t elem, pcdoc_operation_k op,
@@ -888,6 +1035,19 @@ pcintr_coroutine_get_token(pcintr_coroutine_t cor);
 int
 pcintr_coroutine_set_token(pcintr_coroutine_t cor, const char *token);
 
+const char *
+pcintr_coroutine_get_priority_name(pcintr_coroutine_t cor);
+
+int
+pcintr_coroutine_set_priority(pcintr_coroutine_t cor, int priority);
+
+int
+pcintr_coroutine_set_priority_by_name(pcintr_coroutine_t cor,
+        const char *name);
+
+const struct pcintr_sched_stat *
+pcintr_get_sched_stat(struct pcinst *inst, int priority);
+
 pcintr_coroutine_t
 pcintr_get_first_crtn(struct pcinst *inst);
 
@@ -0,0 +1,109 @@
+/*
+ * @file lock-stats.h
+ * @date 2026/10/14
+ * @brief The contention statistics of the mutexes and the rwlocks.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PURC_PRIVATE_LOCK_STATS_H
+#define PURC_PRIVATE_LOCK_STATS_H
+
+#include "config.h"
+
+#if ENABLE(LOCK_STATS)
+
+#include "purc-macros.h"
+#include "private/list.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* the wait time is counted in buckets of [2^(n-1), 2^n) microseconds;
+   the last bucket holds the longer waits. */
+#define PCLOCK_NR_WAIT_BUCKETS      16
+
+/* the number of the distinct holders kept for a lock */
+#define PCLOCK_NR_BLOCKERS          4
+
+enum pclock_kind {
+    PCLOCK_KIND_MUTEX,
+    PCLOCK_KIND_RWLOCK,
+};
+
+struct pclock_blocker {
+    long                    tid;    // the thread which held the lock
+    uint64_t                nr;     // the times it blocked the others
+};
+
+/*
+ * The statistics of a lock. The counters of the fast path are updated
+ * atomically, because the readers of a rwlock may update them at the same
+ * time; the rest is updated only by the waiters under `lock`.
+ */
+struct pclock_stats {
+    struct list_head        list;   // in the registry of all locks
+    const char             *name;
+    enum pclock_kind        kind;
+
+    atomic_uint_fast64_t    nr_acquired;
+    atomic_long             holder; // the exclusive holder; 0 for none
+
+    pthread_mutex_t         lock;
+    uint64_t                nr_contended;
+    uint64_t                wait_ns;
+    uint64_t                max_wait_ns;
+    uint64_t                buckets[PCLOCK_NR_WAIT_BUCKETS];
+    struct pclock_blocker   blockers[PCLOCK_NR_BLOCKERS];
+};
+
+/* The native implementations with the statistics; the native lock must be
+   the first member, so that it can be used where the lock is expected. */
+struct pclock_mutex {
+    pthread_mutex_t         impl;
+    struct pclock_stats     stats;
+};
+
+struct pclock_rwlock {
+    pthread_rwlock_t        impl;
+    struct pclock_stats     stats;
+};
+
+PCA_EXTERN_C_BEGIN
+
+void pclock_stats_register(struct pclock_stats *stats,
+        enum pclock_kind kind) WTF_INTERNAL;
+
+void pclock_stats_unregister(struct pclock_stats *stats) WTF_INTERNAL;
+
+/* Returns the identifier of the calling thread. */
+long pclock_self(void) WTF_INTERNAL;
+
+/* Returns the monotonic time in nanoseconds. */
+uint64_t pclock_now_ns(void) WTF_INTERNAL;
+
+/* Records a wait of `ns` nanoseconds on a lock held by `blocker`. */
+void pclock_stats_record_wait(struct pclock_stats *stats, long blocker,
+        uint64_t ns) WTF_INTERNAL;
+
+PCA_EXTERN_C_END
+
+#endif  /* ENABLE(LOCK_STATS) */
+
+#endif  /* PURC_PRIVATE_LOCK_STATS_H */
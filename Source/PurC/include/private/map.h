@@ -51,6 +51,7 @@ extern "C" {
 uint32_t pchash_default_str_hash(const void *k);
 uint32_t pchash_perlish_str_hash(const void *k);
 uint32_t pchash_fnv1a_str_hash(const void *k);
+uint32_t pchash_fast_str_hash(const void *k);
 uint32_t pchash_default_ptr_hash(const void *k);
 uint32_t pchash_fnv1a_ptr_hash(const void *k);
 uint32_t pchash_fnv1a_u32_hash(const void *k);
@@ -168,6 +169,19 @@ static inline pcutils_uomap* pcutils_uomap_create(
             (comp_key == NULL) ? pchash_str_equal : comp_key, threads, sorted);
 }
 
+/* creates an un-ordered map based on the open-addressing hash table */
+static inline pcutils_uomap* pcutils_uomap_create_open(
+        copy_key_fn copy_key, free_key_fn free_key,
+        copy_val_fn copy_val, free_val_fn free_val,
+        hash_key_fn hash_key, comp_key_fn comp_key, bool threads)
+{
+    return pchash_table_new_ex(0, copy_key, free_key,
+            copy_val, free_val,
+            (hash_key == NULL) ? pchash_fnv1a_str_hash : hash_key,
+            (comp_key == NULL) ? pchash_str_equal : comp_key, threads,
+            PCHASH_FLAG_OPEN);
+}
+
 static inline int pcutils_uomap_destroy(pcutils_uomap* map)
 {
     pchash_table_delete(map);
@@ -43,20 +43,76 @@
 
 #define PCUTILS_MEM_ALIGN_STEP sizeof(void *)
 
-#define pcutils_malloc(sz)       malloc(sz)
-#define pcutils_realloc(ptr, sz) realloc(ptr, sz)
-#define pcutils_calloc(n, sz)    calloc(n, sz)
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* true if an allocator is set by purc_set_allocator() */
+extern bool pcutils_allocator_hooked;
+
+void *pcutils_hooked_malloc(size_t sz);
+void *pcutils_hooked_calloc(size_t n, size_t sz);
+void *pcutils_hooked_realloc(void *ptr, size_t sz);
+void pcutils_hooked_free(void *ptr);
+
+/*
+ * The memory allocated by the following functions must be freed by
+ * pcutils_free(), and vice versa; the memory from strdup() of the C
+ * library, or passed by the callers of the public API, must not.
+ */
+static inline void *
+pcutils_malloc(size_t sz)
+{
+    if (pcutils_allocator_hooked)
+        return pcutils_hooked_malloc(sz);
+    return malloc(sz);
+}
+
+static inline void *
+pcutils_calloc(size_t n, size_t sz)
+{
+    if (pcutils_allocator_hooked)
+        return pcutils_hooked_calloc(n, sz);
+    return calloc(n, sz);
+}
+
+static inline void *
+pcutils_realloc(void *ptr, size_t sz)
+{
+    if (pcutils_allocator_hooked)
+        return pcutils_hooked_realloc(ptr, sz);
+    return realloc(ptr, sz);
+}
 
-static inline void*
+static inline void *
 pcutils_free(void *ptr)
 {
-    free(ptr);
+    if (pcutils_allocator_hooked)
+        pcutils_hooked_free(ptr);
+    else
+        free(ptr);
     return NULL;
 }
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+/* The statistics of the allocations made via the allocator set by
+   purc_set_allocator() in the current thread; the bytes are counted only
+   if the allocator has the `size` hook. */
+struct pcutils_allocator_stat {
+    uint64_t nr_allocs;
+    uint64_t nr_frees;
+    uint64_t sz_allocated;
+    uint64_t sz_freed;
+};
+
+/* Gets the statistics of the current thread; returns false if no
+   allocator is set. */
+bool
+pcutils_allocator_stat_get(struct pcutils_allocator_stat *stat);
+
+/* Prevents the allocator from being changed; called when the first
+   instance is initialized. */
+void
+pcutils_allocator_freeze(void) WTF_INTERNAL;
 
 typedef struct pcutils_mem_chunk pcutils_mem_chunk_t;
 typedef struct pcutils_mem pcutils_mem_t;
@@ -79,6 +135,26 @@ struct pcutils_mem {
 };
 
 
+/*
+ * The statistics of the allocations made by the current thread; only the
+ * variant counter is maintained unless PurC is built with ENABLE_ALLOC_STATS,
+ * which wraps malloc(), calloc(), realloc(), and free() of the C library
+ * (glibc only). It is for the allocation regression tests.
+ */
+struct pcutils_alloc_stat {
+    uint64_t nr_allocs;     // the calls to malloc(), calloc(), and realloc()
+    uint64_t nr_frees;      // the calls to free() with a non-NULL pointer
+    uint64_t sz_allocs;     // the bytes requested by the allocations
+    uint64_t nr_variants;   // the variants allocated by the variant heap
+};
+
+/*
+ * Gets the cumulative counters of the current thread; the callers should
+ * compare two snapshots. Returns false if the allocations are not counted.
+ */
+bool
+pcutils_alloc_stat_get(struct pcutils_alloc_stat *stat);
+
 pcutils_mem_t *
 pcutils_mem_create(void) WTF_INTERNAL;
 
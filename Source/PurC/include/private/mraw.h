@@ -59,6 +59,19 @@ struct pcutils_mraw {
     pcutils_bst_t *cache;
 };
 
+/* the statistics of a mraw; the values are accumulated */
+struct pcutils_mraw_stat {
+    size_t nr_chunks;       /* the number of the chunks */
+    size_t sz_reserved;     /* the total size of the chunks */
+    size_t sz_allocated;    /* the size used in the chunks */
+    size_t nr_free_blocks;  /* the number of the blocks freed to reuse */
+    size_t sz_free;         /* the total size of the blocks freed */
+};
+
+void
+pcutils_mraw_get_stat(pcutils_mraw_t *mraw,
+        struct pcutils_mraw_stat *stat) WTF_INTERNAL;
+
 /*
  * Inline functions
  */
@@ -29,9 +29,15 @@
 
 #include "config.h"
 
+#ifdef __cplusplus
+#include <atomic>
+using std::atomic_uint;
+#else
 #include <stdatomic.h>
+#endif
 
 #include "private/list.h"
+#include "private/map.h"
 #include "purc-pcrdr.h"
 
 #define MSG_QS_REQ      0x10000000
@@ -39,6 +45,24 @@
 #define MSG_QS_EVENT    0x40000000
 #define MSG_QS_VOID     0x80000000
 
+/*
+ * The lanes of the events. An event is taken from the first lane in the
+ * order set by PURC_ENVV_EVENT_LANES which is not empty, unless the oldest
+ * event of another lane has waited for PCINST_MSG_LANE_MAX_DELAY.
+ */
+enum pcinst_msg_lane {
+    PCINST_MSG_LANE_INPUT = 0,  // on the elements of the DOM, from renderer
+    PCINST_MSG_LANE_RENDERER,   // the other events about the renderer
+    PCINST_MSG_LANE_TIMER,      // the timers expired
+    PCINST_MSG_LANE_DATA,       // the changes of the observed data
+    PCINST_MSG_LANE_OTHER,      // all others
+
+    PCINST_MSG_LANE_NR,
+};
+
+/* in microseconds */
+#define PCINST_MSG_LANE_MAX_DELAY   100000
+
 struct pcinst_msg_hdr {
     atomic_uint             owner;
     struct list_head        ln;
@@ -48,11 +72,23 @@ struct pcinst_msg_queue {
     struct purc_rwlock  lock;
     struct list_head    req_msgs;
     struct list_head    res_msgs;
-    struct list_head    event_msgs;
+    struct list_head    event_msgs[PCINST_MSG_LANE_NR];
     struct list_head    void_msgs;
 
+    /* the pending reducible events indexed by the key of is_event_match();
+       created on demand */
+    pcutils_uomap      *reducible_events;
+
     uint64_t            state;
     size_t              nr_msgs;
+
+    /* the statistics of the reduced events */
+    size_t              nr_ignored;
+    size_t              nr_overlaid;
+
+    /* the depths of the lanes of the events, and the peaks */
+    size_t              nr_events[PCINST_MSG_LANE_NR];
+    size_t              max_events[PCINST_MSG_LANE_NR];
 };
 
 /* Make sure the size of `struct list_head` is two times of sizeof(void *) */
@@ -89,6 +125,10 @@ pcinst_msg_queue_get_event_by_element(struct pcinst_msg_queue *queue,
 size_t
 pcinst_msg_queue_count(struct pcinst_msg_queue *queue);
 
+/* returns the name of the lane, e.g., `input` */
+const char *
+pcinst_msg_lane_name(enum pcinst_msg_lane lane);
+
 PCA_EXTERN_C_END
 
 #endif /* not defined PURC_PRIVATE_MSG_QUEUE_H */
@@ -87,6 +87,17 @@ struct renderer_capabilities {
        0 for not supported, -1 for unlimited */
     int    plainWindow;
 
+    /* the max number of DOM operations in one batch request;
+       0 for not supported */
+    int    dom_batch;
+
+    /* the version of the binary framing supported;
+       0 for not supported */
+    int    binary_framing;
+
+    /* whether the large packets can be compressed in the zlib format */
+    int    compression;
+
     /* the element selectors supported */
     unsigned    selectors;
 
@@ -102,6 +113,30 @@ struct pcrdr_conn;
 extern "C" {
 #endif  /* __cplusplus */
 
+/*
+ * Parses a text packet in a buffer allocated by malloc(), whose size is
+ * @sz_buff. For a large text data, the buffer may be taken over by the data
+ * of the message to avoid copying; @buff_taken returns whether it is taken.
+ */
+int
+pcrdr_parse_packet_in_buffer(char *packet, size_t sz_buff, size_t sz_packet,
+        pcrdr_msg **msg, bool *buff_taken) WTF_INTERNAL;
+
+/*
+ * Checks, makes, and restores a compressed packet. The buffer returned
+ * should be released by free(); the one restored is null-terminated.
+ */
+bool
+pcrdr_is_compressed_packet(const void *packet, size_t sz_packet) WTF_INTERNAL;
+
+void *
+pcrdr_compress_packet(const void *packet, size_t sz_packet,
+        size_t *sz_compressed) WTF_INTERNAL;
+
+char *
+pcrdr_decompress_packet(const void *packet, size_t sz_packet,
+        size_t *sz_original) WTF_INTERNAL;
+
 struct renderer_capabilities *
 pcrdr_parse_renderer_capabilities(const char *data) WTF_INTERNAL;
 
@@ -27,6 +27,8 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <regex.h>
 
 enum pcregex_compile_flags {
     PCREGEX_CASELESS          = 1 << 0,
@@ -75,6 +77,27 @@ struct pcregex_match_info;
 extern "C" {
 #endif  /* __cplusplus */
 
+/*
+ * Gets the POSIX regular expression compiled from the pattern with the
+ * flags of regcomp() from the cache of the current instance; the pattern
+ * is compiled and cached if it is not there.
+ *
+ * Returns NULL on failure and sets the return value of regcomp() to `err`
+ * if it is not NULL. The returned object is shared and read-only, and
+ * must be released by calling pcregex_cache_release().
+ */
+const regex_t *pcregex_cache_get(const char *pattern, int cflags, int *err);
+
+void pcregex_cache_release(const regex_t *re);
+
+/* Gets the statistics of the cache of the current instance. */
+void pcregex_cache_get_stat(size_t *nr_hits, size_t *nr_misses);
+
+/* Removes the least recently used entries from the cache of the current
+   instance except `nr_keep` ones; returns the number of the entries
+   removed. */
+size_t pcregex_cache_trim(size_t nr_keep);
+
 
 /*
  * Scans for a match in string for pattern
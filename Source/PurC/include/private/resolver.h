@@ -0,0 +1,62 @@
+/*
+ * @file resolver.h
+ * @date 2026/10/14
+ * @brief The interfaces of the host resolver and the warm connections.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PURC_PRIVATE_RESOLVER_H
+#define PURC_PRIVATE_RESOLVER_H
+
+#include "purc-macros.h"
+
+#include <stdbool.h>
+
+/* the time in seconds to keep the addresses of a host resolved */
+#define PCUTILS_RESOLVER_TTL            60
+
+/* the time in seconds to keep a warm connection not taken */
+#define PCUTILS_RESOLVER_WARM_TIMEOUT   30
+
+/* the maximum number of the warm connections */
+#define PCUTILS_RESOLVER_MAX_WARM       8
+
+PCA_EXTERN_C_BEGIN
+
+/*
+ * Opens a TCP connection to the host. A warm connection made by
+ * pcutils_resolver_preconnect() is taken if there is one; otherwise,
+ * the addresses kept in the cache are tried before resolving the host
+ * on the calling thread.
+ *
+ * Returns the file descriptor of the socket, or -1 on failure.
+ */
+int pcutils_resolver_connect(const char *host, const char *port);
+
+/*
+ * Resolves the host and connects to it on a worker thread, and keeps the
+ * connection for pcutils_resolver_connect().
+ *
+ * Returns 0 if the connection is started, or -1 on failure.
+ */
+int pcutils_resolver_preconnect(const char *host, const char *port);
+
+PCA_EXTERN_C_END
+
+#endif  /* PURC_PRIVATE_RESOLVER_H */
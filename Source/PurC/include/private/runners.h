@@ -64,6 +64,14 @@ enum {
 
 #define PCRUN_EVENT_inst_stopped            "inst:stopped"
 
+/* the runner names of the workers in the runner pool are `_pool<slot>` */
+#define PCRUN_POOL_RUNNER_PREFIX    "_pool"
+#define PCRUN_POOL_MAX_WORKERS      64
+
+/* the runner names of the instances in the instance pool are `_inst<seq>` */
+#define PCRUN_INST_POOL_RUNNER_PREFIX   "_inst"
+#define PCRUN_INST_POOL_MAX_IDLE        256
+
 struct instmgr_info {
     purc_atom_t     rid_main;
     unsigned        nr_insts;
@@ -86,9 +94,46 @@ pcrun_create_inst_thread(const char *app_name, const char *runner_name,
 void
 pcrun_instmgr_handle_message(void *ctxt) WTF_INTERNAL;
 
+/* binds the current thread to the CPUs (`0-3,8`), and sets the NUMA node
+   preferred for the memory allocated by it (a decimal or `local`); the
+   arguments are nullable. Returns 0 on success, or -1 if any of them is
+   bad or can not be applied. */
+int
+pcrun_place_current_thread(const char *cpu_affinity, const char *numa_node)
+    WTF_INTERNAL;
+
 void
 pcrun_notify_instmgr(const char* event, purc_atom_t inst_crtn_id) WTF_INTERNAL;
 
+int
+pcrun_pool_init_once(void) WTF_INTERNAL;
+
+/* returns the slot of the least loaded worker and puts its runner name
+   to the buffer (PURC_LEN_RUNNER_NAME + 1), or -1 if there is no pool.  */
+int
+pcrun_pool_pick_worker(char *runner_name) WTF_INTERNAL;
+
+/* returns the slot of a worker by its runner name, or -1 */
+int
+pcrun_pool_slot_of_runner(const char *runner_name) WTF_INTERNAL;
+
+void
+pcrun_pool_update_load(int slot, bool increase) WTF_INTERNAL;
+
+/* called by a new instance of the instance pool to join the idle ones;
+   `atom` is 0 if the instance failed to start */
+void
+pcrun_inst_pool_join(const char *runner_name, purc_atom_t atom) WTF_INTERNAL;
+
+/* called by an instance of the instance pool when all its coroutines
+   exited; returns true if it is reset and idle again */
+bool
+pcrun_inst_pool_recycle(purc_atom_t atom) WTF_INTERNAL;
+
+/* called by an instance of the instance pool before it stops */
+void
+pcrun_inst_pool_leave(purc_atom_t atom) WTF_INTERNAL;
+
 PCA_EXTERN_C_END
 
 #endif /* not defined PURC_PRIVATE_RUNNERS_H */
@@ -25,5 +25,21 @@
 #ifndef PURC_PRIVATE_RWSTREAM_H
 #define PURC_PRIVATE_RWSTREAM_H
 
+#include "purc-rwstream.h"
+
+/* a regular file not smaller than this is mapped into memory for reading */
+#define PCRWSTREAM_MMAP_MIN_SIZE    (64 * 1024)
+
+PCA_EXTERN_C_BEGIN
+
+/*
+ * Creates a read-only stream for the file. A regular file not smaller than
+ * PCRWSTREAM_MMAP_MIN_SIZE is mapped into memory; the others, or if failed
+ * to map the file, are read through stdio.
+ */
+purc_rwstream_t pcrwstream_new_for_reading(const char *file) WTF_INTERNAL;
+
+PCA_EXTERN_C_END
+
 #endif /* not defined PURC_PRIVATE_RWSTREAM_H */
 
@@ -80,6 +80,17 @@ int
 pcutils_stringbuilder_snprintf(struct pcutils_stringbuilder *sb,
     const char *fmt, ...);
 
+/* Appends the bytes to the chunks; the bytes may contain null characters.
+   Returns 0 on success, -1 if out of memory. */
+int
+pcutils_stringbuilder_append(struct pcutils_stringbuilder *sb,
+        const void *data, size_t len);
+
+/* Copies the contents (`sb->total` bytes, without a terminating null
+   character) to `dst`. */
+void
+pcutils_stringbuilder_copy(struct pcutils_stringbuilder *sb, void *dst);
+
 char*
 pcutils_stringbuilder_build(struct pcutils_stringbuilder *sb);
 
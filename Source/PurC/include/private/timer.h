@@ -34,6 +34,13 @@
 #include "purc-runloop.h"
 
 typedef void* pcintr_timer_t;
+
+/* use the timer slack of the run loop */
+#define PCINTR_TIMER_SLACK_DEFAULT  ((uint32_t)-1)
+
+/* the minimal interval of a throttled timer, in milliseconds */
+#define PCINTR_TIMER_THROTTLED_INTERVAL     1000
+
 typedef void (*pcintr_timer_fire_func)(pcintr_timer_t timer, const char* id,
         void *data);
 
@@ -49,6 +56,20 @@ pcintr_timer_set_interval(pcintr_timer_t timer, uint32_t interval);
 uint32_t
 pcintr_timer_get_interval(pcintr_timer_t timer);
 
+void
+pcintr_timer_set_slack(pcintr_timer_t timer, uint32_t slack);
+
+uint32_t
+pcintr_timer_get_slack(pcintr_timer_t timer);
+
+/* a throttled timer fires once per PCINTR_TIMER_THROTTLED_INTERVAL at most;
+   an active timer is rescheduled from now on when the setting changes. */
+void
+pcintr_timer_set_throttled(pcintr_timer_t timer, bool throttled);
+
+bool
+pcintr_timer_is_throttled(pcintr_timer_t timer);
+
 void
 pcintr_timer_start(pcintr_timer_t timer);
 
@@ -61,6 +82,11 @@ pcintr_timer_stop(pcintr_timer_t timer);
 void
 pcintr_timer_destroy(pcintr_timer_t timer);
 
+/* gets the numbers of the timers created and armed on a run loop */
+void
+pcintr_timer_get_stat(purc_runloop_t runloop, size_t *nr_timers,
+        size_t *nr_active);
+
 PCA_EXTERN_C_END
 
 #endif /* not defined PURC_PRIVATE_TIMER_H */
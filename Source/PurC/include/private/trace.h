@@ -0,0 +1,52 @@
+/*
+ * @file trace.h
+ * @date 2026/10/14
+ * @brief The interfaces for the tracing spans of the hot paths.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PURC_PRIVATE_TRACE_H
+#define PURC_PRIVATE_TRACE_H
+
+#include "purc-macros.h"
+
+#include <stdint.h>
+
+/* the categories of the spans */
+#define PCTRACE_CAT_SCHED       "sched"
+#define PCTRACE_CAT_RDR         "rdr"
+#define PCTRACE_CAT_FETCHER     "fetcher"
+#define PCTRACE_CAT_VCM         "vcm"
+
+PCA_EXTERN_C_BEGIN
+
+/*
+ * Begins a span: returns the timestamp in microseconds, or 0 if
+ * the tracing is not enabled for the current instance.
+ *
+ * A span is recorded as a complete event in the ring buffer of the instance
+ * by pctrace_end(); the category and the name must be static strings.
+ */
+uint64_t pctrace_begin(void);
+
+void pctrace_end(uint64_t begin, const char *cat, const char *name);
+
+PCA_EXTERN_C_END
+
+#endif  /* PURC_PRIVATE_TRACE_H */
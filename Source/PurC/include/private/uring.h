@@ -0,0 +1,76 @@
+/*
+ * @file uring.h
+ * @date 2026/10/14
+ * @brief The interfaces of the io_uring backend of the run loop.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PURC_PRIVATE_URING_H
+#define PURC_PRIVATE_URING_H
+
+#include "purc-macros.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* the number of the entries of the submission queue */
+#define PCINTR_URING_ENTRIES        64
+
+struct pcintr_uring;
+
+/*
+ * The callback called in the run loop when a write completed. `data` and
+ * `len` are the copy of the data submitted; `result` is the number of
+ * bytes written, or a negative errno on failure.
+ */
+typedef void (*pcintr_uring_cb)(void *ctxt, const char *data, size_t len,
+        ssize_t result);
+
+PCA_EXTERN_C_BEGIN
+
+/*
+ * Checks whether the io_uring backend can be used by the current instance.
+ * The ring is set up by the first call; it is not available if PurC is
+ * built without ENABLE_IO_URING, or if the kernel does not support it.
+ */
+bool pcintr_uring_available(void) WTF_INTERNAL;
+
+/*
+ * Writes a copy of the data to the file descriptor asynchronously.
+ * The writes submitted in one iteration of the run loop are submitted to
+ * the kernel with one system call.
+ *
+ * Returns the handle of the request, or 0 if the request can not be
+ * submitted, e.g., too many requests in flight.
+ */
+uintptr_t pcintr_uring_write(int fd, const void *buf, size_t len,
+        pcintr_uring_cb cb, void *ctxt) WTF_INTERNAL;
+
+/* Detaches the callback from a request; the request still completes. */
+void pcintr_uring_cancel(uintptr_t handle) WTF_INTERNAL;
+
+/* Tears down the ring of an instance; called when cleaning up it. */
+void pcintr_uring_destroy(struct pcintr_uring *uring) WTF_INTERNAL;
+
+PCA_EXTERN_C_END
+
+#endif  /* PURC_PRIVATE_URING_H */
+
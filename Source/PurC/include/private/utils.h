@@ -115,6 +115,39 @@ pcutils_hash_hash(const unsigned char *key, size_t key_size)
     return hash;
 }
 
+/*
+ * The hash functions of the perfect hash tables generated at build time
+ * by Scripts/PerfectHash.py; keep them in sync with the script.
+ *
+ * The key is the FNV-1a hash of the name in lower case, and the slot of
+ * the name in the table is given by the displacement of the key.
+ */
+static inline uint32_t
+pcutils_perfect_hash_key(const char *name, size_t length)
+{
+    uint32_t v = 0x811c9dc5;
+    for (size_t i = 0; i < length; i++) {
+        v ^= (unsigned char)purc_tolower(name[i]);
+        v *= 0x01000193;
+    }
+
+    return v;
+}
+
+static inline size_t
+pcutils_perfect_hash_slot(uint32_t key, const uint16_t *disps,
+        size_t nr_disps, size_t nr_slots)
+{
+    uint32_t v = key ^ disps[key % nr_disps];
+    v ^= v >> 16;
+    v *= 0x85ebca6b;
+    v ^= v >> 13;
+    v *= 0xc2b2ae35;
+    v ^= v >> 16;
+
+    return v % nr_slots;
+}
+
 /*
  * calloc_a(size_t len, [void **addr, size_t len,...], NULL)
  *
@@ -131,6 +164,22 @@ extern "C" {
 
 void *pcutils_calloc_a(size_t len, ...) WTF_INTERNAL;
 
+/* The CPU features used by the accelerated implementations. */
+#define PCUTILS_CPU_SSE42           0x0001  /* x86: SSE4.2 (CRC-32C) */
+#define PCUTILS_CPU_PCLMUL          0x0002  /* x86: PCLMULQDQ and SSE4.1 */
+#define PCUTILS_CPU_SHA             0x0004  /* x86: SHA extensions */
+#define PCUTILS_CPU_CRC32           0x0008  /* ARMv8: CRC32 instructions */
+#define PCUTILS_CPU_AVX2            0x0010  /* x86: AVX2 enabled by the OS */
+
+/* Returns the CPU features (PCUTILS_CPU_XXX) detected at runtime. */
+unsigned pcutils_cpu_features(void) WTF_INTERNAL;
+
+/*
+ * Returns a fast non-cryptographic 64-bit hash of the bytes (wyhash).
+ * The value may vary between platforms, so never persist it.
+ */
+uint64_t pcutils_hash_bytes(const void *data, size_t len, uint64_t seed);
+
 typedef enum {
     PURC_K_ALGO_CRC32_UNKNOWN = -1,
 
@@ -198,6 +247,24 @@ int pcutils_parse_uint64(const char *buf, size_t len, uint64_t *retval);
 int pcutils_parse_double(const char *buf, size_t len, double *retval);
 int pcutils_parse_long_double(const char *buf, size_t len, long double *retval);
 
+/* The size of buffer which is enough for pcutils_dtoa_shortest(). */
+#define PCUTILS_DTOA_BUFF_SIZE      32
+
+/*
+ * Formats a double like `printf("%.*g", min_precision, d)` does, but uses
+ * the shortest digits which read back to the same double, so the result
+ * may have more significant digits than min_precision (at most 17).
+ * The decimal point is always '.', regardless of the current locale.
+ * Returns the length of the result.
+ */
+int pcutils_dtoa_shortest(double d, int min_precision, char *buf);
+
+/*
+ * Same as strtod(3), but converts the most common decimal numbers
+ * without calling strtod(3).
+ */
+double pcutils_strtod(const char *str, char **end);
+
 #define DECL_MYSTRING(name) struct pcutils_mystring name = { NULL, 0, 0 }
 
 #ifdef __cplusplus
@@ -36,10 +36,36 @@
 struct pcvarmgr;
 typedef struct pcvarmgr*  pcvarmgr_t;
 
+/* the constructor of a variable bound lazily; see pcvarmgr_add_lazy() */
+typedef purc_variant_t (*pcvarmgr_ctor_f)(void);
+
+struct pcvarmgr_lazy_var {
+    const char             *name;
+    pcvarmgr_ctor_f         ctor;
+};
+
+/* the constructor with a context; see pcvarmgr_add_lazy_ex() */
+typedef purc_variant_t (*pcvarmgr_ctor_ex_f)(void *ctxt);
+typedef void (*pcvarmgr_free_ctxt_f)(void *ctxt);
+
+/* the slot of a variable bound lazily; pending if ctor or ctor_ex is set */
+struct pcvarmgr_lazy_slot {
+    const char             *name;
+    pcvarmgr_ctor_f         ctor;
+    pcvarmgr_ctor_ex_f      ctor_ex;
+    void                   *ctxt;
+    pcvarmgr_free_ctxt_f    free_ctxt;
+};
+
 struct pcvarmgr {
     purc_variant_t object;
     struct pcvar_listener *listener;
 
+    /* the variables not made yet; the constructors are NULL if made or
+       rebound */
+    struct pcvarmgr_lazy_slot *lazy_vars;
+    size_t                    nr_lazy_vars;
+
     struct rb_node            node;
     struct pcvdom_node       *vdom_node;
 };
@@ -55,6 +81,24 @@ int pcvarmgr_destroy(pcvarmgr_t mgr);
 bool pcvarmgr_add(pcvarmgr_t mgr, const char* name,
         purc_variant_t variant);
 
+/*
+ * Binds the variable which will be made by calling `ctor` on the first
+ * access via pcvarmgr_get(), e.g., the built-in dynamic objects. The name
+ * must be a static string. The constructor is dropped if the variable is
+ * bound or removed before that.
+ */
+bool pcvarmgr_add_lazy(pcvarmgr_t mgr, const char* name, pcvarmgr_ctor_f ctor);
+
+/*
+ * Same as pcvarmgr_add_lazy(), but `ctor_ex` is called with `ctxt`, and
+ * `free_ctxt` (if not NULL) is called when the variable is made, rebound or
+ * removed, or the manager is destroyed. The name must be valid as long as
+ * the context, e.g., a string in the context.
+ */
+bool pcvarmgr_add_lazy_ex(pcvarmgr_t mgr, const char* name,
+        pcvarmgr_ctor_ex_f ctor_ex, void *ctxt,
+        pcvarmgr_free_ctxt_f free_ctxt);
+
 purc_variant_t pcvarmgr_get(pcvarmgr_t mgr, const char* name);
 
 bool pcvarmgr_remove_ex(pcvarmgr_t mgr, const char* name, bool silently);
@@ -67,6 +111,10 @@ static inline bool pcvarmgr_remove(pcvarmgr_t mgr, const char* name)
 bool pcvarmgr_dispatch_except(pcvarmgr_t mgr, const char* name,
         const char* except);
 
+/* Makes the element of the events on the named variable of the manager */
+purc_variant_t pcvarmgr_build_event_observed(const char *name,
+        pcvarmgr_t mgr);
+
 PCA_EXTERN_C_END
 
 #endif /* not defined PURC_PRIVATE_VAR_MGR_H */
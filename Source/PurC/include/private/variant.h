@@ -40,6 +40,16 @@ PCA_EXTERN_C_BEGIN
 #define PCVRNT_FLAG_NOFREE          PCVRNT_FLAG_CONSTANT
 #define PCVRNT_FLAG_EXTRA_SIZE      (0x01 << 1)  // when use extra space
 #define PCVRNT_FLAG_STRING_STATIC   (0x01 << 2)  // make_string_static
+#define PCVRNT_FLAG_STRING_HASHED   (0x01 << 3)  // str_hash is valid
+#define PCVRNT_FLAG_TRAILING        (0x01 << 4)  // extra space is trailing
+#define PCVRNT_FLAG_STRING_VIEW     (0x01 << 5)  // make_string_view
+#define PCVRNT_FLAG_LISTENED        (0x01 << 6)  // container has listeners
+
+/* The size of the space following a variant in the same chunk, which is used
+   to store a string or a byte sequence not fitting in the variant itself. */
+#ifndef PCVRNT_SZ_TRAILING
+#define PCVRNT_SZ_TRAILING          48
+#endif
 
 #define PVT(t)          (PURC_VARIANT_TYPE##t)
 #define IS_CONTAINER(t) (t == PURC_VARIANT_TYPE_OBJECT || \
@@ -124,6 +134,10 @@ struct purc_variant {
 
         /* the list node for reserved variants. */
         struct list_head    reserved;
+
+        /* the cached hash value for string (no listener on a string);
+           valid only if PCVRNT_FLAG_STRING_HASHED is set. */
+        uint32_t            str_hash;
     };
 
     /* value */
@@ -193,6 +207,33 @@ struct purc_variant {
 
 #define USE_LOOP_BUFFER_FOR_RESERVED    0
 
+// the kinds of the fixed-size chunks allocated from the slabs
+enum pcvariant_slab_kind {
+    PCVARIANT_SLAB_VARIANT = 0,     // struct purc_variant
+    PCVARIANT_SLAB_VARIANT_EX,      // plus PCVRNT_SZ_TRAILING bytes
+    PCVARIANT_SLAB_OBJ_NODE,        // struct obj_node
+    PCVARIANT_SLAB_SET_NODE,        // struct set_node
+
+    PCVARIANT_SLAB_NR,
+};
+
+struct pcvariant_slabs;
+
+/* The memory usage of the variants attributed to a coroutine. The counters
+   are net values: a variant is charged to the coroutine running when it is
+   allocated and credited to the one running when it is released. */
+struct pcvariant_usage {
+    ssize_t             nr_values;
+    ssize_t             sz_mem;
+
+    // the quotas of memory in bytes; zero for no limit.
+    size_t              soft_limit;
+    size_t              hard_limit;
+
+    // whether the soft limit has been reached.
+    bool                soft_reached;
+};
+
 struct pcvariant_heap {
     // the constant values.
     struct purc_variant v_undefined;
@@ -211,19 +252,94 @@ struct pcvariant_heap {
 #else
     struct list_head    v_reserved;
 #endif
+
+    // the slabs for the variants and the nodes of containers.
+    struct pcvariant_slabs *slabs;
+
+    // the cache of interned string variants (string -> variant).
+    pcutils_uomap      *interned;
+
+    // the memory usage of the running coroutine; NULL if there is none.
+    struct pcvariant_usage *usage;
+
+    // the number of variants allocated ever; used by the profiler.
+    size_t              nr_allocs;
+
+    // the depth of deferring the revalidation of the sets, and the
+    // containers mutated meanwhile in the sets (variant -> variant).
+    int                 defer_depth;
+    bool                defer_conflict;
+    pcutils_map        *deferred;
 };
 
 // internal interfaces for moving variant.
 purc_variant_t pcvariant_move_heap_in(purc_variant_t v) WTF_INTERNAL;
 purc_variant_t pcvariant_move_heap_out(purc_variant_t v) WTF_INTERNAL;
 
+/* Moves the valid ones of @n variants in/out in one pass;
+   the invalid ones are skipped. */
+int pcvariant_move_heap_in_n(purc_variant_t *vs, size_t n) WTF_INTERNAL;
+void pcvariant_move_heap_out_n(purc_variant_t *vs, size_t n) WTF_INTERNAL;
+
 void pcvariant_use_move_heap(void) WTF_INTERNAL;
 void pcvariant_use_norm_heap(void) WTF_INTERNAL;
 
+/* Serializes a variant in the binary format of
+   purc_variant_serialize_binary(), but fails with PURC_ERROR_NOT_SUPPORTED
+   on a dynamic or a native value, which can not be restored. */
+ssize_t
+pcvariant_serialize_binary_strict(purc_variant_t value,
+        purc_rwstream_t stream) WTF_INTERNAL;
+
+/*
+ * Defers the revalidation of the sets on the mutations of their members.
+ * Instead of checking the unique keys and repositioning a member on each
+ * mutation, the members mutated are checked and repositioned once when
+ * the outermost pcvariant_end_deferred_revalidation() is called, or when
+ * a set having such members is looked up.
+ *
+ * The end returns -1 with PURC_ERROR_DUPLICATED if any mutated member
+ * conflicted with another one; the conflicting members have been removed
+ * from the sets then.
+ */
+void pcvariant_begin_deferred_revalidation(void) WTF_INTERNAL;
+int pcvariant_end_deferred_revalidation(void) WTF_INTERNAL;
+
+/* Sets/gets the memory usage to which the variants allocated or released
+   in the normal heap of the current instance are attributed. */
+void pcvariant_set_usage(struct pcvariant_usage *usage);
+struct pcvariant_usage *pcvariant_get_usage(void);
+
+/* Makes a string variant for a key of object; the string will be interned
+   if it is short and the cache of the interned strings is not full. */
+purc_variant_t
+pcvariant_make_key_string(const char *str_utf8,
+        bool check_encoding) WTF_INTERNAL;
+
+/* Frees the reserved variants of the current heap except `nr_keep` ones;
+   returns the size of the memory freed. */
+size_t pcvariant_trim_reserved(size_t nr_keep) WTF_INTERNAL;
+
 purc_variant *pcvariant_alloc(void) WTF_INTERNAL;
 purc_variant *pcvariant_alloc_0(void) WTF_INTERNAL;
 void pcvariant_free(purc_variant *v) WTF_INTERNAL;
 
+int pcvariant_slab_init_once(void) WTF_INTERNAL;
+int pcvariant_snapshot_init_once(void) WTF_INTERNAL;
+
+/* Attaches the slabs to or detaches the slabs from a variant heap. */
+int pcvariant_slab_attach(struct pcvariant_heap *heap) WTF_INTERNAL;
+void pcvariant_slab_detach(struct pcvariant_heap *heap) WTF_INTERNAL;
+
+/* Allocates a chunk from or frees a chunk to the slab of the current heap. */
+void *pcvariant_slab_alloc(enum pcvariant_slab_kind kind) WTF_INTERNAL;
+void *pcvariant_slab_alloc_0(enum pcvariant_slab_kind kind) WTF_INTERNAL;
+void pcvariant_slab_free(enum pcvariant_slab_kind kind,
+        void *chunk) WTF_INTERNAL;
+
+/* Updates the statistics of the slabs in the stat of the heap. */
+void pcvariant_slab_stat(struct pcvariant_heap *heap) WTF_INTERNAL;
+
 struct pcinst;
 struct tuple_node;
 
@@ -233,7 +349,9 @@ struct pcvar_rev_update_edge {
         // where to locate in parent
         struct set_node             *set_me;
         struct obj_node             *obj_me;
-        struct arr_node             *arr_me;
+        // an array has only one edge to a child however many times the
+        // child occurs in it, so this is the array itself.
+        purc_variant_t               arr_me;
         struct tuple_node           *tuple_me;
     };
 };
@@ -246,6 +364,10 @@ struct set_node {
     struct pcutils_array_list_node       alnode;
     purc_variant_t   val;  // actual variant-element
     char             md5[33];
+
+    bool             hash_exact;
+    uint32_t         hash;  // hash value of the unique-key values
+    struct set_node *hnext; // next node in the same bucket of the index
 };
 
 struct variant_set {
@@ -253,9 +375,15 @@ struct variant_set {
     const char            **keynames;
     size_t                  nr_keynames;
     bool                    caseless;
+    bool                    deferred;   // members to be repositioned
     struct rb_root          elems;  // multiple-variant-elements stored in set
     struct pcutils_array_list al;    // struct set_node
 
+    // hash index over the unique-key values of the elements
+    struct set_node       **buckets;
+    size_t                  nr_buckets;
+    size_t                  nr_inexact; // number of nodes with inexact hash
+
     // key: arr_node/obj_node/set_node
     // val: parent
     pcutils_map                     *rev_update_chain;
@@ -270,25 +398,49 @@ struct obj_node {
     purc_variant_t   val;
 };
 
+/* the number of properties stored in the inline nodes of an object */
+#define OBJ_INLINE_NODES        8
+
 struct variant_obj {
     struct rb_root          kvs;  // struct obj_node*
     size_t                  size;
 
+    // bumped whenever a property is added, removed or replaced, so that the
+    // inline caches of the vcm evaluator can tell the object has changed.
+    uint32_t                gen;
+
+    // the hash index of the properties; key: the key string, val: obj_node.
+    // It is created only when the object holds many properties, and the
+    // red-black tree is always kept for the ordered traversal.
+    pcutils_uomap                  *index;
+
     // key: arr_node/obj_node/set_node
     // val: parent
     pcutils_map                     *rev_update_chain;
+
+    // the bitmap of the inline nodes being used.
+    uint8_t                         inline_used;
+
+    // the nodes allocated along with the object, so that a small object
+    // needs no extra allocation for its properties.
+    struct obj_node                 inline_nodes[OBJ_INLINE_NODES];
 };
 
 // internal struct used by variant-arr
 typedef struct variant_arr      *variant_arr_t;
 
-struct arr_node {
-    struct pcutils_array_list_node       node;
-    purc_variant_t   val;
-};
-
 struct variant_arr {
-    struct pcutils_array_list     al;  // struct arr_node*
+    purc_variant_t                *vals;    // the elements stored contiguously
+    size_t                          nr;     // the number of elements
+    size_t                          sz;     // the capacity of `vals`
+
+    // the numbers packed in 8 bytes each; when the packed array is accessed
+    // by element, they are boxed to `vals` and `packed` becomes NULL.
+    void                           *packed;
+    pcvrnt_packed_type_k            packed_type;
+
+    // the number of arrays sharing `vals` (copy-on-write); NULL if private.
+    size_t                         *sharers;
 
     // key: arr_node/obj_node/set_node
     // val: parent
@@ -317,6 +469,42 @@ int pcvariant_array_sort(purc_variant_t value, void *ud,
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud));
 
+#define PCVRNT_SORT_CASELESS        0x20000000
+
+enum pcvariant_sort_key_type {
+    PCVRNT_SORT_KEY_NONE = 0,       /* equal to any other key */
+    PCVRNT_SORT_KEY_NUMBER,
+    PCVRNT_SORT_KEY_STRING,
+};
+
+/* a sort key extracted from a member once for all comparisons */
+struct pcvariant_sort_key {
+    int                 type;
+    double              d;
+    char               *s;          /* freed by the sort engine */
+};
+
+/* fills the keys of a member; returns 0 on success */
+typedef int (*pcvariant_sort_key_f)(purc_variant_t member,
+        struct pcvariant_sort_key *keys, void *ud);
+
+/* the key from numerifying the value; a missing value is taken as 0 */
+void pcvariant_sort_key_number(struct pcvariant_sort_key *key,
+        purc_variant_t value);
+/* the key from stringifying the value; returns -1 if out of memory */
+int pcvariant_sort_key_string(struct pcvariant_sort_key *key,
+        purc_variant_t value);
+
+/*
+ * Sorts the members of an array or a set stably by the keys extracted
+ * by `extract`, which are compared in order. The flags can contain
+ * PCVRNT_SORT_DESC and PCVRNT_SORT_CASELESS.
+ */
+int pcvariant_array_sort_by_keys(purc_variant_t value, size_t nr_keys,
+        pcvariant_sort_key_f extract, void *ud, unsigned int flags);
+int pcvariant_set_sort_by_keys(purc_variant_t value, size_t nr_keys,
+        pcvariant_sort_key_f extract, void *ud, unsigned int flags);
+
 int pcvariant_diff(purc_variant_t l, purc_variant_t r);
 int pcvariant_diff_ex(purc_variant_t l, purc_variant_t r,
         enum pcvrnt_compare_method opt);
@@ -369,6 +557,20 @@ char* pcvariant_serialize_alloc(char *buf, size_t sz, purc_variant_t val);
 
 char* pcvariant_to_string(purc_variant_t v);
 
+/* Returns the hash value of a string variant, which is computed on the first
+   call and cached in the variant. The value is same as the result of
+   pchash_fast_str_hash() for the string. */
+uint32_t pcvariant_string_hash(purc_variant_t string);
+
+/* Continues the hash value `hash` over the string used to compare `v` by
+   purc_variant_compare_ex() with PCVRNT_COMPARE_METHOD_CASE or
+   PCVRNT_COMPARE_METHOD_CASELESS, so the variants equal under the method
+   always have the same hash value. If `caseless` is true and the string
+   contains non-ASCII characters, `*exact` will be set to false: in this case
+   two equal variants may have different hash values. */
+uint32_t pcvariant_compare_hash(purc_variant_t v, uint32_t hash,
+        bool caseless, bool *exact);
+
 purc_variant_t pcvariant_make_object(size_t nr_kvs, ...);
 
 WTF_ATTRIBUTE_PRINTF(1, 2)
@@ -408,6 +610,13 @@ pcvariant_is_in_set (purc_variant_t set, purc_variant_t value)
 purc_variant_t
 pcvariant_object_shallow_copy(purc_variant_t obj);
 
+/* Returns the generation of the properties of an object; see variant_obj. */
+static inline uint32_t
+pcvariant_object_generation(purc_variant_t obj)
+{
+    return ((struct variant_obj *)obj->sz_ptr[1])->gen;
+}
+
 bool
 pcvariant_object_clear(purc_variant_t object, bool silently);
 
@@ -478,6 +687,30 @@ bool
 pcvariant_array_insert_another_after(purc_variant_t array, int idx,
         purc_variant_t another, bool silently);
 
+/* the entry of a shared library of dynamic objects (EXOBJ_LOAD_ENTRY) */
+typedef purc_variant_t (*pcvariant_dvobj_load_f)(const char *var_name,
+        int *ver_code);
+
+struct pcvariant_dvobj_lib;
+
+/*
+ * Opens the shared library of the dynamic objects like
+ * purc_variant_load_dvobj_from_so() does. The library is opened only once
+ * in the process and never closed.
+ */
+struct pcvariant_dvobj_lib *
+pcvariant_open_dvobj_lib(const char *so_name, const char *var_name)
+    WTF_INTERNAL;
+
+/* makes the dynamic object `var_name` from the library */
+purc_variant_t
+pcvariant_load_dvobj(struct pcvariant_dvobj_lib *lib, const char *var_name)
+    WTF_INTERNAL;
+
+/* opens the library in advance; can be called without any instance */
+bool
+pcvariant_preload_dvobj_lib(const char *so_name) WTF_INTERNAL;
+
 PCA_EXTERN_C_END
 
 #define PURC_VARIANT_SAFE_CLEAR(_v)             \
@@ -497,67 +730,58 @@ do {                                            \
  *  in an interation.
  */
 
-// purc_variant_t _arr;
-#define variant_array_get_data(_arr)        \
-    &(((variant_arr_t)_arr->sz_ptr[1])->al)
-
-// purc_variant_t _arr;
-// struct arr_node *_p;
-#define foreach_in_variant_array(_arr, _p)                               \
-    array_list_for_each_entry(variant_array_get_data(_arr),              \
-            _p, node)
-
-// purc_variant_t _arr;
-// struct arr_node *_p, *_n;
-#define foreach_in_variant_array_safe(_arr, _p, _n)                      \
-    array_list_for_each_entry_safe(variant_array_get_data(_arr),         \
-            _p, _n, node)
+// boxes the packed elements if there are; returns the data of the array.
+variant_arr_t pcvariant_array_boxed_data(purc_variant_t arr);
 
-// purc_variant_t _arr;
-// struct arr_node *_p;
-#define foreach_in_variant_array_reverse(_arr, _p)                       \
-    array_list_for_each_entry_reverse(variant_array_get_data(_arr),      \
-            _p, node)
+// like pcvariant_array_boxed_data(), but also makes the elements private
+// to the array, so that `vals` can be changed in place; NULL on failure.
+variant_arr_t pcvariant_array_writable_data(purc_variant_t arr);
 
 // purc_variant_t _arr;
-// struct arr_node *_p, *_n;
-#define foreach_in_variant_array_reverse_safe(_arr, _p, _n)              \
-    array_list_for_each_entry_reverse_safe(variant_array_get_data(_arr), \
-            _p, _n, node)
+#define variant_array_get_data(_arr)        \
+    pcvariant_array_boxed_data(_arr)
 
+/*
+ * In the following loops, `_data->vals[_i]` refers to the slot of
+ * the current element.
+ */
 #define foreach_value_in_variant_array(_arr, _val, _idx)              \
     do {                                                              \
-        struct arr_node *_p;                                          \
-        foreach_in_variant_array(_arr, _p) {                          \
-            _val = _p->val;                                           \
-            _idx = _p->node.idx;                                      \
+        variant_arr_t _data = variant_array_get_data(_arr);           \
+        size_t _i;                                                    \
+        for (_i = 0; _i < _data->nr &&                                \
+                (_idx = _i, _val = _data->vals[_i], 1); _i++) {       \
      /* } */                                                          \
  /* } while (0) */
 
+// the current element can be removed in the loop.
 #define foreach_value_in_variant_array_safe(_arr, _val, _idx)      \
     do {                                                           \
-        struct arr_node *_p, *_n;                                  \
-        foreach_in_variant_array_safe(_arr, _p, _n) {              \
-            _val = _p->val;                                        \
-            _idx = _p->node.idx;                                   \
+        variant_arr_t _data = variant_array_get_data(_arr);        \
+        size_t _i, _nr = 0;                                        \
+        for (_i = 0; _i < _data->nr && (_nr = _data->nr,           \
+                    _idx = _i, _val = _data->vals[_i], 1);         \
+                _i += (_data->nr < _nr) ? 0 : 1) {                 \
      /* } */                                                       \
  /* } while (0) */
 
 #define foreach_value_in_variant_array_reverse(_arr, _val, _idx)      \
     do {                                                              \
-        struct arr_node *_p;                                          \
-        foreach_in_variant_array_reverse(_arr, _p) {                  \
-            _val = _p->val;                                           \
-            _idx = _p->node.idx;                                      \
+        variant_arr_t _data = variant_array_get_data(_arr);           \
+        size_t _i;                                                    \
+        for (_i = _data->nr; _i > 0 &&                                \
+                (_idx = _i - 1, _val = _data->vals[_i - 1], 1); _i--) { \
      /* } */                                                          \
  /* } while (0) */
 
+// the current element can be removed in the loop.
 #define foreach_value_in_variant_array_reverse_safe(_arr, _val, _idx)   \
     do {                                                                \
-        struct arr_node *_p, *_n;                                       \
-        foreach_in_variant_array_reverse_safe(_arr, _p, _n) {           \
-            _val = _p->val;                                             \
-            _idx = _p->node.idx;                                        \
+        variant_arr_t _data = variant_array_get_data(_arr);             \
+        size_t _i;                                                      \
+        for (_i = _data->nr; _i > 0 &&                                  \
+                (_idx = _i - 1, _val = _data->vals[_i - 1], 1);         \
+                _i = (_i - 1 < _data->nr) ? _i - 1 : _data->nr) {       \
      /* } */                                                            \
  /* } while (0) */
 
@@ -103,6 +103,15 @@ enum pcvcm_node_type {
 #define PCVCM_NODE_TYPE_NR \
     (PCVCM_NODE_TYPE_LAST - PCVCM_NODE_TYPE_FIRST + 1)
 
+/* the constness of a node, determined by pcvcm_node_compile() */
+enum pcvcm_node_const {
+    PCVCM_NODE_CONST_UNKNOWN = 0,
+    PCVCM_NODE_CONST_NO,
+    PCVCM_NODE_CONST_YES,
+};
+
+struct pcvcm_bytecode;
+
 struct pcvcm_node {
     struct pctree_node tree_node;
     enum pcvcm_node_type type;
@@ -111,6 +120,11 @@ struct pcvcm_node {
     int32_t   idx;
     int32_t   nr_nodes; /* nr_nodes of the tree */
     bool is_closed;
+    uint8_t const_state;    /* one of enum pcvcm_node_const */
+    /* the unique stamp of a node whose evaluation is cached: the root of
+       a constant subtree, or an element getter having an inline cache */
+    uint64_t stamp;
+    struct pcvcm_bytecode *bytecode;    /* the compiled tree (root only) */
     union {
         bool        b;
         double      d;
@@ -261,6 +275,41 @@ char *pcvcm_node_serialize(struct pcvcm_node *node, size_t *nr_bytes);
  */
 void pcvcm_node_destroy(struct pcvcm_node *root);
 
+/*
+ * Marks the subtrees of root which refer to no variable as constant,
+ * so that the evaluator can evaluate them once and cache the results.
+ * The values are cached per coroutine, because a vdom, and so the vcm
+ * trees in it, may be shared by the instances.
+ */
+void pcvcm_node_compile(struct pcvcm_node *root);
+
+/*
+ * Assigns the indices of the nodes of a tree and compiles it; the evaluator
+ * does this on the first evaluation, if the tree has not been prepared.
+ */
+void pcvcm_node_prepare(struct pcvcm_node *tree);
+
+struct pcvcm_inline_cache;
+
+/* Destroys the inline caches of the element getters of a coroutine. */
+void pcvcm_inline_caches_destroy(struct pcvcm_inline_cache *ics);
+
+struct pcvcm_eval_ctxt_pool;
+
+struct pcvcm_eval_pool_stat {
+    size_t          nr_hits;        /* the contexts reused from the pool */
+    size_t          nr_misses;      /* the contexts allocated */
+};
+
+/* Destroys the pool of evaluation contexts of a coroutine. */
+void pcvcm_eval_ctxt_pool_destroy(struct pcvcm_eval_ctxt_pool *pool);
+
+/*
+ * Gets the statistics of the pool of evaluation contexts of the running
+ * coroutine. Returns -1 if there is no pool.
+ */
+int pcvcm_eval_get_pool_stat(struct pcvcm_eval_pool_stat *stat);
+
 
 typedef purc_variant_t(*find_var_fn) (void *ctxt, const char *name);
 
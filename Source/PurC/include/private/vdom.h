@@ -122,6 +122,28 @@ pcvdom_attr_create_simple(const char *key, struct pcvcm_node *vcm);
 void
 pcvdom_attr_destroy(struct pcvdom_attr *attr);
 
+// The nodes and the attributes created by the following functions are
+// allocated in the arena of the document, along with their strings; they
+// can only be attached to the tree of that document, and their memory is
+// released when the document is destroyed. The names which are not
+// pre-defined are interned as atoms.
+struct pcvdom_element*
+pcvdom_document_create_element_c(struct pcvdom_document *doc,
+        const char *tag_name);
+
+struct pcvdom_content*
+pcvdom_document_create_content(struct pcvdom_document *doc,
+        struct pcvcm_node *vcm_content);
+
+struct pcvdom_comment*
+pcvdom_document_create_comment(struct pcvdom_document *doc,
+        const char *text);
+
+struct pcvdom_attr*
+pcvdom_document_create_attr(struct pcvdom_document *doc,
+        const char *key, enum pchvml_attr_operator op,
+        struct pcvcm_node *vcm);
+
 // doc/dom construction api
 int
 pcvdom_document_set_doctype(struct pcvdom_document *doc,
@@ -321,6 +343,30 @@ purc_variant_t
 pcvdom_tokenwised_eval_attr(enum pchvml_attr_operator op,
         purc_variant_t l, purc_variant_t r);
 
+/*
+ * Prepares all the VCM trees of a vDOM for evaluation, so that the vDOM
+ * is no longer changed when it is shared by the instances.
+ */
+void
+pcvdom_document_prepare(struct pcvdom_document *doc);
+
+/*
+ * Writes the binary form of a vDOM to out, which can be loaded back by
+ * pcvdom_document_from_binary() without parsing the HVML program.
+ * The binary form is only valid on the same machine and the same version
+ * of PurC. Returns 0 on success.
+ */
+int
+pcvdom_document_to_binary(struct pcvdom_document *doc, purc_rwstream_t out);
+
+/*
+ * Rebuilds a vDOM from the binary form in buf. Returns NULL and sets
+ * PURC_ERROR_BAD_ENCODING if the binary form is malformed or written by
+ * a different version.
+ */
+struct pcvdom_document*
+pcvdom_document_from_binary(const void *buf, size_t len);
+
 #define PRINT_VDOM_NODE(_node)      \
     pcvdom_util_node_serialize(_node, pcvdom_util_fprintf, NULL)
 
@@ -302,6 +302,42 @@ purc_document_impl_entity(purc_document_t doc, purc_document_type_k *type);
 PCA_EXPORT unsigned int
 purc_document_delete(purc_document_t doc);
 
+/** The statistics of the memory used by a document. */
+struct purc_document_mem_stat {
+    /** The number of the memory chunks allocated for the nodes and texts. */
+    size_t nr_chunks;
+    /** The total size of the chunks in bytes. */
+    size_t sz_reserved;
+    /** The size used in the chunks in bytes, including the blocks freed. */
+    size_t sz_allocated;
+    /** The number of the blocks freed and kept for reuse. */
+    size_t nr_free_blocks;
+    /** The total size of the blocks freed and kept for reuse in bytes. */
+    size_t sz_free;
+};
+
+/**
+ * purc_document_get_mem_stat:
+ *
+ * Gets the statistics of the memory used by a document.
+ *
+ * @doc: The pointer to a document.
+ * @stat: The pointer to a purc_document_mem_stat structure to receive
+ *      the statistics.
+ *
+ * The memory of the nodes destroyed by erasing or clearing an element is
+ * kept by the document, and reused for the new nodes. The statistics help
+ * to tell the memory retained by the document from the memory in use.
+ *
+ * Returns: 0 for success, -1 for failure; the error code will be
+ *  %PURC_ERROR_NOT_SUPPORTED if the document type does not support it.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT int
+purc_document_get_mem_stat(purc_document_t doc,
+        struct purc_document_mem_stat *stat);
+
 typedef enum {
     PCDOC_SPECIAL_ELEM_ROOT = 0,
     PCDOC_SPECIAL_ELEM_HEAD,
@@ -729,6 +765,31 @@ PCA_EXPORT int
 pcdoc_element_has_class(purc_document_t doc, pcdoc_element_t elem,
         const char *klass, bool *found);
 
+struct lwc_string_s;
+
+/**
+ * pcdoc_element_get_classes:
+ *
+ * @doc: The pointer to the document.
+ * @elem: The pointer to the element.
+ * @classes: The pointer to a buffer to return the array of the class names
+ *  interned as lwc_string of CSSEng.
+ * @nr_classes: The pointer to a size_t buffer to return the number of
+ *  the class names.
+ *
+ * Gets the class names defined for the specified element. The class names
+ * are parsed once and cached in the document, until the `class` attribute
+ * of the element is changed or the element is removed. The array is owned
+ * by the document, and is only valid until the next change of the document.
+ *
+ * Returns: 0 for success, -1 for failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT int
+pcdoc_element_get_classes(purc_document_t doc, pcdoc_element_t elem,
+        struct lwc_string_s * const **classes, size_t *nr_classes);
+
 /**
  * pcdoc_attribute_cb:
  *
@@ -1272,7 +1333,9 @@ purc_document_serialize_contents_to_stream(purc_document_t doc,
  *
  * @char: the css selector.
  *
- * Creates a new selector.
+ * Creates a new selector. In an instance, the compiled selectors are cached
+ * in LRU order, and the same selector is returned for the same text; it
+ * is shared and read-only, and must be released by pcdoc_selector_delete().
  *
  * Returns: the pointer to the selector or %NULL on failure.
  *
@@ -1292,6 +1355,27 @@ pcdoc_selector_new(const char *selector);
 PCA_EXPORT int
 pcdoc_selector_delete(pcdoc_selector_t selector);
 
+/**
+ * pcdoc_selector_cache_get_stat:
+ *
+ * @nr_cached (nullable): The pointer to a size_t buffer to return
+ *  the number of the selectors cached.
+ * @nr_hits (nullable): The pointer to a size_t buffer to return
+ *  the number of the selectors got from the cache.
+ * @nr_misses (nullable): The pointer to a size_t buffer to return
+ *  the number of the selectors compiled.
+ *
+ * Gets the statistics of the cache of the compiled selectors in
+ * the current instance.
+ *
+ * Returns: 0 for success, -1 for no instance.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT int
+pcdoc_selector_cache_get_stat(size_t *nr_cached,
+        size_t *nr_hits, size_t *nr_misses);
+
 
 /**
  * pcdoc_get_element_by_id_in_descendants:
@@ -47,6 +47,22 @@ struct pcfetcher_resp_header {
     size_t sz_resp;
 };
 
+/*
+ * The timings of a request loaded over the network, in milliseconds since
+ * the request was started; a timing is negative if it does not apply, e.g.,
+ * there is no DNS lookup or TLS handshake for a reused connection.
+ * Since: 0.9.22
+ */
+struct pcfetcher_load_metrics {
+    double dns_time;        /* the time taken by the DNS lookup */
+    double connect_time;    /* the time taken to connect, including TLS */
+    double tls_time;        /* the time taken by the TLS handshake */
+    double first_byte;      /* the time when the first byte arrived */
+    double total_time;      /* the time when the last byte arrived */
+    bool reused;            /* whether a kept-alive connection was reused */
+    char protocol[16];      /* the protocol, e.g., `http/1.1` or `h2` */
+};
+
 PCA_EXTERN_C_BEGIN
 
 struct pcfetcher_session;
@@ -55,7 +71,7 @@ struct pcfetcher_session;
  * pcfetcher_init:
  *
  * @max_conns: The maximum number of connections.
- * @cache_quota: The cache limit.
+ * @cache_quota: The limit of the response cache in KiB; zero disables it.
  *
  * Init data fetcher of the current PurC instance.
  *
@@ -232,6 +248,12 @@ enum pcfetcher_resp_type {
     PCFETCHER_RESP_TYPE_FINISH
 };
 
+/*
+ * NOTE: For PCFETCHER_RESP_TYPE_HEADER and PCFETCHER_RESP_TYPE_ERROR, @data
+ * points to a `struct pcfetcher_resp_header`. For PCFETCHER_RESP_TYPE_FINISH,
+ * @data points to a `struct pcfetcher_load_metrics` and @sz_data is the size
+ * of it if the response was loaded over the network; otherwise, @data is NULL.
+ */
 typedef void (*pcfetcher_response_handler)(
         struct pcfetcher_session *session,
         purc_variant_t request_id,
@@ -400,6 +400,8 @@ char *purc_load_file_contents(const char *file, size_t *length);
 
 #define PURC_ENVV_LOG_ENABLE        "PURC_LOG_ENABLE"
 #define PURC_ENVV_LOG_SYSLOG        "PURC_LOG_SYSLOG"
+#define PURC_ENVV_LOG_ASYNC         "PURC_LOG_ASYNC"
+#define PURC_ENVV_LOG_RATE_LIMIT    "PURC_LOG_RATE_LIMIT"
 
 #define PURC_LOG_FILE_PATH_FORMAT   "/var/tmp/purc-%s-%s.log"
 
@@ -481,6 +483,41 @@ purc_enable_log_ex(unsigned levels, purc_log_facility_k facility);
 PCA_EXPORT unsigned
 purc_get_log_levels(void);
 
+/**
+ * Enables or disables the asynchronous log for the current PurC instance.
+ *
+ * In the asynchronous mode, the messages are formatted into a ring buffer
+ * of the instance without any lock, and written to the log facility by
+ * a writer thread. A message is dropped if the ring buffer is full, or if
+ * more than @rate_limit messages with the same tag are logged in a second.
+ * The pending messages are written before the asynchronous log is disabled,
+ * the log facility is changed, or the instance is cleaned up.
+ *
+ * @param enable: @true to enable the asynchronous log, @false to disable it.
+ * @param rate_limit: The maximal number of messages with the same tag
+ *      in a second; 0 for no limit.
+ *
+ * Returns: @true for success, otherwise @false.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT bool
+purc_enable_log_async(bool enable, unsigned rate_limit);
+
+/**
+ * Gets the number of messages dropped by the asynchronous log of
+ * the current PurC instance.
+ *
+ * @param nr_limited: The pointer to a buffer to receive the number of
+ *      the messages dropped by the rate limit; nullable.
+ *
+ * Returns: The number of messages dropped since the ring buffer is full.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT size_t
+purc_get_log_dropped(size_t *nr_limited);
+
 /**
  * Enable or disable the log facility for the current PurC instance.
  *
@@ -46,6 +46,14 @@
 #define PCRDR_PURCMC_PROTOCOL_VERSION           160
 #define PCRDR_PURCMC_MINIMAL_PROTOCOL_VERSION   160
 
+/* the version of the binary framing, negotiated via `binaryFraming` */
+#define PCRDR_BINARY_FRAMING_VERSION            1
+
+/* the compression of the packets, negotiated via `compression` */
+#define PCRDR_COMPRESSION_DEFLATE               "deflate"
+/* the min size of a packet to compress */
+#define PCRDR_MIN_SIZE_COMPRESSION              4096
+
 #define PCRDR_PURCMC_US_NAME                "purcmc.sock"
 #define PCRDR_PURCMC_US_PATH                "/var/tmp/" PCRDR_PURCMC_US_NAME
 #define PCRDR_PURCMC_WS_PORT                "7702"
@@ -55,6 +63,10 @@
 #define PCRDR_PURCMC_DNSSD_TYPE_WSS         "_purcmc._tcp,wss"
 
 #define PCRDR_HEADLESS_LOGFILE_PATH_FORMAT      "/var/tmp/purc-%s-%s-msg.log"
+/* the query option in the URI of the headless renderer for the null mode,
+   e.g., `file:///dev/null?mode=null`, in which every request is
+   acknowledged at once without any state or log */
+#define PCRDR_HEADLESS_NULL_MODE_OPTION         "mode=null"
 
 #define PCRDR_NOT_AVAILABLE             "<N/A>"
 
@@ -94,6 +106,10 @@
 #define PCRDR_EVENT_NEW_RENDERER                "newRenderer"
 #define PCRDR_EVENT_FAILED_SWITCHING_RENDERER   "failedSwitchingRenderer"
 
+/* the events of a plain window or a widget when it is hidden or shown */
+#define PCRDR_EVENT_HIDE                        "hide"
+#define PCRDR_EVENT_SHOW                        "show"
+
 /* operations from interpreter to render */
 typedef enum {
     PCRDR_K_OPERATION_FIRST = 0,
@@ -169,6 +185,10 @@ typedef enum {
 #define PCRDR_NR_OPERATIONS \
     (PCRDR_K_OPERATION_LAST - PCRDR_K_OPERATION_FIRST + 1)
 
+/* the request carrying a batch of the DOM operations above; only sent
+   to the renderer which declares the capability `domBatch` */
+#define PCRDR_OPERATION_BATCH               "batch"
+
 /* operations from renderer to interpreter */
 typedef enum {
     PCRDR_K_OP2INTR_FIRST = 0,
@@ -176,9 +196,12 @@ typedef enum {
 #define PCRDR_OP2INTR_SUPPRESSPAGE   "suppressPage"
     PCRDR_K_OP2INTR_RELOADPAGE,
 #define PCRDR_OP2INTR_RELOADPAGE     "reloadPage"
+    /* the data is the sequence number of the last DOM operation applied */
+    PCRDR_K_OP2INTR_RESYNCPAGE,
+#define PCRDR_OP2INTR_RESYNCPAGE     "resyncPage"
 
     /* XXX: change this when you append a new operation */
-    PCRDR_K_OP2INTR_LAST = PCRDR_K_OP2INTR_RELOADPAGE,
+    PCRDR_K_OP2INTR_LAST = PCRDR_K_OP2INTR_RESYNCPAGE,
 } pcrdr_op2intr_k;
 
 /* reserved names for workspace */
@@ -968,6 +991,52 @@ typedef ssize_t (*pcrdr_cb_write)(void *ctxt, const void *buf, size_t count);
 PCA_EXPORT int
 pcrdr_serialize_message(const pcrdr_msg *msg, pcrdr_cb_write fn, void *ctxt);
 
+/**
+ * Check whether a packet is in the binary framing.
+ *
+ * @param packet: the pointer to the packet.
+ * @param sz_packet: the size of the packet.
+ *
+ * Returns: %true if the packet starts with the magic of the binary framing
+ * and is not shorter than the fixed header.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT bool
+pcrdr_is_binary_packet(const void *packet, size_t sz_packet);
+
+/**
+ * Parse a packet in the binary framing and make a corresponding message.
+ *
+ * @param packet: the pointer to the packet.
+ * @param sz_packet: the size of the packet.
+ * @param msg: The pointer to a pointer to return the parsed message structure.
+ *
+ * Returns: -1 for error; zero means everything is ok.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT int
+pcrdr_parse_binary_packet(const void *packet, size_t sz_packet,
+        pcrdr_msg **msg);
+
+/**
+ * Serialize a message in the binary framing: a fixed header with the
+ * integer fields and the lengths, the strings, and the data, in which
+ * the data in JSON type are serialized in the binary format of variant.
+ *
+ * @param msg: the pointer to the message to serialize.
+ * @param fn: the callback to write the bytes.
+ * @param ctxt: the context will be passed to fn.
+ *
+ * Returns: zero means everything is ok; otherwise an error code.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT int
+pcrdr_serialize_message_binary(const pcrdr_msg *msg,
+        pcrdr_cb_write fn, void *ctxt);
+
 /**
  * Serialize a message to buffer.
  *
@@ -1207,6 +1276,20 @@ PCA_EXPORT pcrdr_msg *
 pcrdr_headless_connect(const char* renderer_uri,
         const char* app_name, const char* runner_name, pcrdr_conn** conn);
 
+/**
+ * Gets the numbers of the requests received by a headless renderer.
+ *
+ * @param conn: the connection to the headless renderer.
+ *
+ * Returns: The array of the numbers indexed by the operation identifiers,
+ *  i.e., `PCRDR_K_OPERATION_XXX`, which has `PCRDR_NR_OPERATIONS` elements;
+ *  NULL if the connection is not to a headless renderer.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT const uint64_t *
+pcrdr_headless_request_counts(pcrdr_conn* conn);
+
 /**
  * Connect to a thread renderer.
  *
@@ -1340,6 +1423,21 @@ PCA_EXPORT int
 pcrdr_socket_send_text_packet(pcrdr_conn *conn,
         const char *text, size_t txt_len);
 
+/**
+ * Send a binary packet to the socket-based renderer.
+ *
+ * @param conn: the pointer to the renderer connection.
+ * @param data: the pointer to the data to send.
+ * @param len: the length to send.
+ *
+ * Returns: -1 for error; zero means everything is ok.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT int
+pcrdr_socket_send_binary_packet(pcrdr_conn *conn,
+        const void *data, size_t len);
+
 /**@}*/
 
 /**
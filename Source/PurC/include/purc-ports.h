@@ -27,6 +27,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 
 #include "purc-macros.h"
 
@@ -46,6 +47,15 @@ void purc_mutex_init (purc_mutex *mutex);
 PCA_EXPORT
 void purc_mutex_clear (purc_mutex *mutex);
 
+/*
+ * Sets the name of a mutex shown by purc_lock_stats_dump(); `name` must be
+ * a static string. It is a no-op unless built with ENABLE_LOCK_STATS.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT
+void purc_mutex_set_name (purc_mutex *mutex, const char *name);
+
 PCA_EXPORT
 void purc_mutex_lock  (purc_mutex *mutex);
 
@@ -61,6 +71,15 @@ void purc_rwlock_init (purc_rwlock  *rw_lock);
 PCA_EXPORT
 void purc_rwlock_clear (purc_rwlock *rw_lock);
 
+/*
+ * Sets the name of a rwlock shown by purc_lock_stats_dump(); `name` must be
+ * a static string. It is a no-op unless built with ENABLE_LOCK_STATS.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT
+void purc_rwlock_set_name (purc_rwlock *rw_lock, const char *name);
+
 PCA_EXPORT
 void purc_rwlock_writer_lock (purc_rwlock *rw_lock);
 
@@ -79,6 +98,21 @@ bool purc_rwlock_reader_trylock (purc_rwlock *rw_lock);
 PCA_EXPORT
 void purc_rwlock_reader_unlock (purc_rwlock *rw_lock);
 
+/*
+ * Dumps the contention statistics of the named locks and the contended
+ * anonymous ones to `fp`, sorted by the total wait time: the acquisitions,
+ * the contended acquisitions, the total and the maximal wait time, the
+ * threads which held the lock most often when the others waited, and the
+ * histogram of the wait time. Resets the statistics if `reset` is true.
+ *
+ * Returns the number of the locks dumped, or -1 if PurC is not built with
+ * ENABLE_LOCK_STATS.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT
+int purc_lock_stats_dump (FILE *fp, bool reset);
+
 unsigned int pcutils_sleep(unsigned int seconds);
 int pcutils_usleep(unsigned long long usec);
 
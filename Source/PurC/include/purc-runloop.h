@@ -186,6 +186,21 @@ PCA_EXPORT
 void purc_runloop_set_timeout(purc_runloop_t runloop,
         purc_runloop_timeout_callback callback, void *ctxt, uint32_t interval);
 
+/**
+ * Set the default timer slack of the runloop: the timers on the runloop
+ * may fire up to the slack later than their deadlines, so that the timers
+ * with nearby deadlines are fired by a single wakeup.
+ *
+ * @param runloop: the runloop, or %NULL for the current one
+ * @param slack: the timer slack in milliseconds; 0 for no slack.
+ *
+ * Returns: void
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT
+void purc_runloop_set_timer_slack(purc_runloop_t runloop, uint32_t slack);
+
 PCA_EXTERN_C_END
 
 #endif /* not defined PURC_RUNLOOP_H */
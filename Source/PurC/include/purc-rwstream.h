@@ -70,6 +70,48 @@ purc_rwstream_t purc_rwstream_new_buffer (size_t sz_init, size_t sz_max);
  */
 PCA_EXPORT purc_rwstream_t purc_rwstream_new_from_mem (void* mem, size_t sz);
 
+typedef void (*pcrws_cb_release)(void *ctxt, void *mem, size_t sz);
+
+/**
+ * Creates a new purc_rwstream_t for the given memory buffer, and calls
+ * the release callback when destroying the rwstream object, e.g.,
+ * to unmap a memory-mapped file.
+ *
+ * @param mem: pointer to memory buffer
+ * @param sz:  size of memory buffer
+ * @param release: (nullable): the callback to release the memory buffer
+ * @param ctxt: the context passed to the release callback
+ *
+ * @return A purc_rwstream_t on success, @NULL on failure and the error code
+ *         is set to indicate the error. The error code:
+ *  - @PURC_ERROR_INVALID_VALUE: Invalid value
+ *  - @PURC_ERROR_OUT_OF_MEMORY: Out of memory
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_rwstream_t
+purc_rwstream_new_from_mem_ex (void* mem, size_t sz,
+        pcrws_cb_release release, void *ctxt);
+
+/**
+ * Creates a new read-only purc_rwstream_t by mapping the given regular file
+ * into memory. The kernel is advised that the contents will be accessed
+ * sequentially; the mapping is released when the rwstream is destroyed.
+ *
+ * @param file: the path of the regular file to map
+ *
+ * @return A purc_rwstream_t on success, @NULL on failure and the error code
+ *         is set to indicate the error. The error code:
+ *  - @PURC_ERROR_INVALID_VALUE: Not a regular file
+ *  - @PURC_ERROR_NOT_SUPPORTED: Not supported on this platform
+ *  - @PURC_ERROR_OUT_OF_MEMORY: Out of memory
+ *  - Other errors mapped from errno if failed to open or map the file.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_rwstream_t
+purc_rwstream_new_from_mmap (const char* file);
+
 /**
  * Creates a new purc_rwstream_t for the given file and mode.
  *
@@ -120,6 +162,66 @@ PCA_EXPORT purc_rwstream_t purc_rwstream_new_from_fp (FILE* fp);
 PCA_EXPORT purc_rwstream_t
 purc_rwstream_new_from_unix_fd (int fd);
 
+/**
+ * Creates a new purc_rwstream_t for the given file descriptor (Unix), which
+ * buffers the bytes read from and written to the file descriptor in the
+ * user space.
+ *
+ * A read calls read() at most once, and only if the read buffer is empty.
+ * The written bytes are kept until the write buffer is full, or
+ * the stream is flushed by calling purc_rwstream_flush(), sought, or
+ * destroyed. The stream does not close the file descriptor.
+ *
+ * @param fd: file descriptor
+ * @param sz_rbuf: the size of the read buffer; zero for no read buffer.
+ * @param sz_wbuf: the size of the write buffer; zero for no write buffer.
+ *
+ * @return A purc_rwstream_t on success, @NULL on failure and the error code
+ *         is set to indicate the error. The error code:
+ *  - @PURC_ERROR_OUT_OF_MEMORY: Out of memory
+ *  - @PURC_ERROR_NOT_IMPLEMENTED: Not implemented
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_rwstream_t
+purc_rwstream_new_from_unix_fd_buffered (int fd, size_t sz_rbuf,
+        size_t sz_wbuf);
+
+typedef enum {
+    PCRWS_FILTER_GZIP = 0,
+    PCRWS_FILTER_BASE64,
+} pcrws_filter_k;
+
+/**
+ * Creates a new purc_rwstream_t which transforms the data read from or
+ * written to another stream through a codec, without buffering the whole
+ * data in memory. The filters can be stacked by using a filter stream as
+ * the base stream of another one.
+ *
+ * A filter stream for reading decodes the data read from the base stream;
+ * the gzip filter also accepts the zlib format and the concatenated gzip
+ * members. A filter stream for writing encodes the data before writing
+ * them to the base stream; the trailer of the encoded data is written
+ * when the filter stream is destroyed. A filter stream can not be sought.
+ *
+ * @param base: the base stream; the filter stream takes the ownership of
+ *      it, and destroys it when the filter stream is destroyed. On failure,
+ *      the base stream is left untouched.
+ * @param filter: the codec, one of #pcrws_filter_k.
+ * @param for_write: %true to encode the data written; %false to decode
+ *      the data read.
+ *
+ * @return A purc_rwstream_t on success, @NULL on failure and the error code
+ *         is set to indicate the error. The error code:
+ *  - @PURC_ERROR_INVALID_VALUE: Invalid value
+ *  - @PURC_ERROR_OUT_OF_MEMORY: Out of memory
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_rwstream_t
+purc_rwstream_new_filter (purc_rwstream_t base, pcrws_filter_k filter,
+        bool for_write);
+
 /**
  * Creates a new purc_rwstream_t for the given socket on Windows (Win32 && GLIB).
  * The socket must be in blocking mode, otherwise the socket will be set in
@@ -347,6 +449,24 @@ PCA_EXPORT ssize_t purc_rwstream_flush (purc_rwstream_t rws);
 PCA_EXPORT ssize_t purc_rwstream_dump_to_another (purc_rwstream_t in,
         purc_rwstream_t out, ssize_t count);
 
+/**
+ * Encodes the bytes in base64 and writes the characters to the rwstream
+ * chunk by chunk, without a buffer for the whole encoded string.
+ *
+ * @param rws: pointer to purc_rwstream_t to write
+ * @param src: the pointer to the bytes
+ * @param len: the number of the bytes
+ *
+ * @return the number of characters written, which is less than the length
+ *  of the encoded string (including the padding characters) if the rwstream
+ *  failed to write all of them; -1 if nothing was written, and the error code
+ *  is set as purc_rwstream_write() does.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT ssize_t
+purc_rwstream_write_base64 (purc_rwstream_t rws, const void *src, size_t len);
+
 /**
  * Get the pointer and size of the rwstream whose type is memory (Created by
  * purc_rwstream_new_buffer or purc_rwstream_new_from_mem).
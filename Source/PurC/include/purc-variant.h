@@ -271,6 +271,34 @@ purc_variant_make_string(const char* str_utf8, bool check_encoding);
 PCA_EXPORT purc_variant_t
 purc_variant_make_string_static(const char* str_utf8, bool check_encoding);
 
+/**
+ * purc_variant_make_string_view:
+ *
+ * @owner (nullable): The variant which owns the buffer containing the string,
+ *      e.g., a byte sequence or a native entity wrapping a memory region.
+ * @str_utf8: The pointer to a string in the buffer
+ *      which is encoded in UTF-8.
+ * @len: The length of the string in bytes; note that the byte
+ *      at `str_utf8[len]` must be a null byte.
+ * @check_encoding: Whether to check the encoding.
+ *
+ * Creates a variant which refers to a string in a buffer owned by @owner
+ * without copying it. The new variant holds a reference of @owner (if
+ * it is valid) to keep the buffer alive, and releases the reference when
+ * it is released.
+ *
+ * If the string is short enough to be stored in the variant itself,
+ * or it is not null-terminated at @len, this function makes a copy of
+ * the string like purc_variant_make_string_ex().
+ *
+ * Returns: A variant refers to the string, or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_string_view(purc_variant_t owner, const char* str_utf8,
+        size_t len, bool check_encoding);
+
 /**
  * purc_variant_make_string_reuse_buff:
  *
@@ -313,6 +341,30 @@ PCA_EXPORT purc_variant_t
 purc_variant_make_string_ex(const char* str_utf8, size_t len,
         bool check_encoding);
 
+/**
+ * purc_variant_make_string_interned:
+ *
+ * @str_utf8: The pointer to a null-terminated string
+ *      which is encoded in UTF-8.
+ * @check_encoding: Whether to check the encoding.
+ *
+ * Gets a shared immutable string variant for the specified string.
+ * The string is kept in the default atom bucket, and the variant
+ * is cached by the current instance, so the calls with the same string
+ * return the same variant until the instance exits. It is useful for
+ * the strings used repeatedly, e.g., the keys of objects.
+ *
+ * Note that the variant returned is a normal string variant; you should
+ * release it by calling purc_variant_unref() as usual.
+ *
+ * Returns: A string variant holding the interned string,
+ *      or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_string_interned(const char* str_utf8, bool check_encoding);
+
 /**
  * purc_variant_get_string_const_ex:
  *
@@ -521,6 +573,28 @@ purc_variant_make_byte_sequence(const void* bytes, size_t nr_bytes);
 PCA_EXPORT purc_variant_t
 purc_variant_make_byte_sequence_static(const void* bytes, size_t nr_bytes);
 
+/**
+ * purc_variant_make_byte_sequence_view:
+ *
+ * @owner (nullable): The variant which owns the buffer containing the bytes,
+ *      e.g., a native entity wrapping a memory-mapped file.
+ * @bytes: The pointer to the bytes in the buffer.
+ * @nr_bytes: The number of the bytes.
+ *
+ * Creates a bsequence variant which refers to the bytes in a buffer owned
+ * by @owner without copying them. The new variant holds a reference of
+ * @owner (if it is valid) to keep the buffer alive, and releases the
+ * reference when it is released.
+ *
+ * Returns: A bsequence variant refers to the bytes,
+ *      or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_byte_sequence_view(purc_variant_t owner, const void* bytes,
+        size_t nr_bytes);
+
 /**
  * purc_variant_make_byte_sequence_reuse_buff:
  *
@@ -737,6 +811,19 @@ struct purc_native_ops {
     const void *priv_ops;
 };
 
+/**
+ * PURC_NATIVE_PROP_NEXT:
+ *
+ * The name of the property by which a native entity acts as an iterable
+ * source of the `iterate` element. The getter of the property is called
+ * without any argument, and returns the next item, or `null` or `undefined`
+ * if there is no more item. So the items are pulled one by one instead of
+ * being materialized in a container.
+ *
+ * Since: 0.9.22
+ */
+#define PURC_NATIVE_PROP_NEXT       "__next"
+
 /**
  * purc_variant_make_native_entity:
  *
@@ -862,6 +949,53 @@ purc_variant_make_array_0(void)
     return purc_variant_make_array(0, PURC_VARIANT_INVALID);
 }
 
+typedef enum pcvrnt_packed_type {
+    PCVRNT_PACKED_NONE = 0,
+    PCVRNT_PACKED_NUMBER,
+    PCVRNT_PACKED_LONGINT,
+    PCVRNT_PACKED_ULONGINT,
+} pcvrnt_packed_type_k;
+
+/**
+ * purc_variant_make_packed_array:
+ *
+ * @type: The type of the elements, one of %PCVRNT_PACKED_NUMBER (double),
+ *  %PCVRNT_PACKED_LONGINT (int64_t), or %PCVRNT_PACKED_ULONGINT (uint64_t).
+ * @elems: The pointer to @nr elements of @type; %NULL for zeros.
+ * @nr: The number of the elements.
+ *
+ * Creates an array variant which holds the numbers in a packed vector,
+ * 8 bytes per element. The packed array behaves like an ordinary array
+ * made of number, longint, or ulongint variants; the elements will be
+ * boxed to variants once the array is accessed or changed by element.
+ *
+ * Returns: An array variant or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_packed_array(pcvrnt_packed_type_k type,
+        const void *elems, size_t nr);
+
+/**
+ * purc_variant_array_get_packed:
+ *
+ * @array: An array variant.
+ * @type: The buffer to return the type of the packed elements.
+ * @nr: The buffer to return the number of the packed elements (nullable).
+ *
+ * Gets the packed elements of @array without boxing them.
+ *
+ * Returns: The pointer to the packed elements, or %NULL if @array is not
+ *  an array or the elements of @array are not (or no longer) packed;
+ *  in the latter case, @type will be %PCVRNT_PACKED_NONE.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT const void *
+purc_variant_array_get_packed(purc_variant_t array,
+        pcvrnt_packed_type_k *type, size_t *nr);
+
 /**
  * purc_variant_array_append:
  *
@@ -1658,6 +1792,33 @@ purc_variant_make_set_by_ckey_ex(size_t sz, const char* unique_key,
             unique_key ? purc_variant_get_string_const(unique_key) : NULL,  \
             false, PURC_VARIANT_INVALID)
 
+/**
+ * purc_variant_make_set_by_members:
+ *
+ * @sz: The number of the variants in @members.
+ * @unique_key (nullable): The unique keys specified in a null-terminated
+ *      string. If there are multiple keys, use whitespaces to separate them.
+ *      If it is %NULL, this function will create a generic set.
+ * @caseless: Compare values in case-insensitively or not.
+ * @members: The array of the variants to be added to the new set.
+ *
+ * Creates a set variant by using the variants in @members as the initial
+ * members and the unique keys specified by @unique_key. The duplicated
+ * variants are handled in the same way as purc_variant_make_set_by_ckey_ex():
+ * a later variant overwrites the earlier one.
+ *
+ * Unlike calling purc_variant_set_add() for every variant, this function
+ * builds the constraints of the members once after all members are added,
+ * so it is the preferred way to create a set with a large number of members.
+ *
+ * Returns: A set variant on success, or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_set_by_members(size_t sz, const char *unique_key,
+        bool caseless, purc_variant_t *members);
+
 /**
  * purc_variant_set_add:
  *
@@ -2807,16 +2968,174 @@ PCA_EXPORT ssize_t
 purc_variant_serialize(purc_variant_t value, purc_rwstream_t stream,
         int indent_level, unsigned int flags, size_t *len_expected);
 
+typedef struct purc_variant_serializer *purc_variant_serializer_t;
+
+/**
+ * purc_variant_serializer_new:
+ *
+ * @value: A variant value to be serialized.
+ * @flags: The serialization flags.
+ *
+ * Creates an incremental serializer for @value, which produces the same
+ * data as purc_variant_serialize() with the initial indent level 0, but in
+ * chunks of the size given by the caller. The memory used by the serializer
+ * does not depend on the size of the whole serialized data, so it can be
+ * used to send a large variant via a non-blocking stream.
+ *
+ * The serializer holds a reference of @value; note that the value and its
+ * descendants must not be changed until the serializer is destroyed.
+ * %PCVRNT_SERIALIZE_OPT_IGNORE_ERRORS is ignored.
+ *
+ * Returns: A new serializer, or %NULL on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_variant_serializer_t
+purc_variant_serializer_new(purc_variant_t value, unsigned int flags);
+
+/**
+ * purc_variant_serializer_read:
+ *
+ * @ser: The serializer.
+ * @buf: The buffer to receive the serialized data.
+ * @sz: The size of the buffer.
+ *
+ * Reads the next chunk of the serialized data from the serializer.
+ *
+ * Returns: The number of bytes stored in @buf, which is less than @sz only
+ * if all data have been read; 0 if there is no more data; -1 on error,
+ * and the error code is set to indicate the cause of the error.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT ssize_t
+purc_variant_serializer_read(purc_variant_serializer_t ser,
+        void *buf, size_t sz);
+
+/**
+ * purc_variant_serializer_is_done:
+ *
+ * @ser: The serializer.
+ *
+ * Checks whether all the serialized data have been read from @ser.
+ *
+ * Returns: @true if there is no more data, otherwise @false.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT bool
+purc_variant_serializer_is_done(purc_variant_serializer_t ser);
+
+/**
+ * purc_variant_serializer_destroy:
+ *
+ * @ser: The serializer.
+ *
+ * Destroys the serializer and releases the reference of the value.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT void
+purc_variant_serializer_destroy(purc_variant_serializer_t ser);
+
+/**
+ * purc_variant_serialize_binary:
+ *
+ * @value: A variant value to be serialized.
+ * @stream: A stream to which the serialized data write.
+ *
+ * Serializes a variant value to a purc_rwstream_t object in the compact
+ * binary format of PurC, which keeps the exact type of every value,
+ * including byte sequences, long integers, long doubles, tuples, and
+ * the unique keys of sets. A dynamic or a native variant is serialized
+ * as %null.
+ *
+ * The data can be loaded by calling purc_variant_load_from_binary().
+ * Note that a long double can only be loaded on an architecture having
+ * the same format of long double.
+ *
+ * Returns: The size of the serialized data written to the stream;
+ * On error, -1 is returned, and error code is set to indicate
+ * the cause of the error.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT ssize_t
+purc_variant_serialize_binary(purc_variant_t value, purc_rwstream_t stream);
+
+/**
+ * purc_variant_load_from_binary:
+ *
+ * @stream: A purc_rwstream_t stream.
+ *
+ * Creates a variant from a stream which contains the data serialized by
+ * purc_variant_serialize_binary().
+ *
+ * Returns: A variant on success, or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_load_from_binary(purc_rwstream_t stream);
+
+/**
+ * purc_variant_serialize_snapshot:
+ *
+ * @value: A variant value to be serialized.
+ * @stream: A stream to which the snapshot write.
+ *
+ * Serializes a variant value to a purc_rwstream_t object as a read-only
+ * snapshot, which can be loaded by calling purc_variant_load_snapshot().
+ * The snapshot uses the binary format of purc_variant_serialize_binary(),
+ * with a header and the strings terminated by null bytes.
+ *
+ * Returns: The size of the snapshot written to the stream;
+ * On error, -1 is returned, and error code is set to indicate
+ * the cause of the error.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT ssize_t
+purc_variant_serialize_snapshot(purc_variant_t value, purc_rwstream_t stream);
+
+/**
+ * purc_variant_load_snapshot:
+ *
+ * @file: The path to a snapshot file made by
+ *      purc_variant_serialize_snapshot().
+ *
+ * Loads a variant from a snapshot file. The file is mapped into memory
+ * once in the process and kept mapped until the process exits; the strings
+ * and the byte sequences in the variant refer to the mapped memory directly
+ * instead of copies, so the memory is shared by all instances, and by
+ * all processes loading the same file via the page cache.
+ *
+ * Note that the snapshot file must not be changed in place while it is
+ * being used; replace it with a new file instead.
+ *
+ * Returns: A variant on success, or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_load_snapshot(const char *file);
+
 
 #define PURC_ENVV_DVOBJS_PATH   "PURC_DVOBJS_PATH"
 
+/* The environment variable to specify the number of chunks in a slab block
+   of the variant allocator; use 0 to disable the slab allocator. */
+#define PURC_ENVV_VARIANT_SLAB_SIZE     "PURC_VARIANT_SLAB_SIZE"
+
 /**
  * purc_variant_load_dvobj_from_so:
  *
  * @so_name: The name of the shared library.
  * @var_name: The name of the dynamic variant to load.
  *
- * Loads a dynamic variant from the given shared library.
+ * Loads a dynamic variant from the given shared library. The shared
+ * library is searched and opened only once in the process, and the later
+ * calls for the same library reuse it.
  *
  * Returns: A dynamic variant on success, or %PURC_VARIANT_INVALID on failure.
 .*
@@ -2830,7 +3149,8 @@ purc_variant_load_dvobj_from_so(const char *so_name, const char *dvobj_name);
  *
  * @value: A dynamic variant returned by purc_variant_load_dvobj_from_so().
  *
- * Unloads a dynamic variant.
+ * Unloads a dynamic variant. The shared library is kept open for the
+ * later loads.
  *
  * Returns: %true for success, %false on failure.
 .*
@@ -3254,6 +3574,14 @@ struct purc_variant_stat {
     size_t sz_total_mem;
     size_t nr_reserved;
     size_t nr_max_reserved;
+
+    /* Since 0.9.22: the statistics of the slab allocator */
+    size_t nr_slab_blocks;      // the number of memory blocks of the slabs
+    size_t sz_slab_mem;         // the size of all memory blocks
+    size_t nr_slab_cached;      // the number of free chunks cached
+
+    /* Since 0.9.22: the peak of sz_total_mem */
+    size_t sz_max_mem;
 };
 
 /**
@@ -3334,6 +3662,47 @@ purc_variant_stringify_buff(char *buff, size_t sz_buff, purc_variant_t value);
 PCA_EXPORT ssize_t
 purc_variant_stringify_alloc(char **strp, purc_variant_t value);
 
+/**
+ * purc_variant_stringify_length:
+ *
+ * @value: The variant value to be stringified.
+ * @flags: The stringifing flags.
+ *
+ * Computes the exact length of the stringified data of a variant value
+ * without writing them anywhere, so that the caller can prepare a buffer
+ * large enough for purc_variant_stringify_to_buff().
+ *
+ * Returns: The length of the stringified data in bytes (not including
+ *      the terminating null byte), or -1 on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT ssize_t
+purc_variant_stringify_length(purc_variant_t value, unsigned int flags);
+
+/**
+ * purc_variant_stringify_to_buff:
+ *
+ * @buff: The pointer to the buffer to store the result (nullable if
+ *      @sz_buff is 0).
+ * @sz_buff: The size of the buffer, including the terminating null byte.
+ * @value: The variant value to be stringified.
+ * @flags: The stringifing flags.
+ *
+ * Stringifies a variant value directly to a buffer, including the members
+ * of the containers, without any intermediate allocation. Like snprintf(),
+ * the result is truncated if the buffer is not large enough, and it is
+ * always null-terminated if @sz_buff is not 0.
+ *
+ * Returns: The length of the whole stringified data in bytes, which may be
+ *      not less than @sz_buff if the result was truncated, or -1 on failure.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT ssize_t
+purc_variant_stringify_to_buff(char *buff, size_t sz_buff,
+        purc_variant_t value, unsigned int flags);
+
 /**
  * A flag for the purc_variant_stringify() function which causes
  * the function ignores the output errors.
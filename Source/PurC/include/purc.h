@@ -113,6 +113,21 @@ typedef struct purc_instance_extra_info {
      */
     unsigned int    allow_scaling_by_density:1;
 
+    /**
+     * The CPUs to which the thread of the instance is bound, in the form
+     * of a list like `0-3,8`; null for no binding (Since 0.9.22).
+     * Only used by purc_inst_create_or_get().
+     */
+    const char      *cpu_affinity;
+
+    /**
+     * The NUMA node preferred for the memory allocated by the thread of
+     * the instance, in decimal, or `local` for the node of the CPU on which
+     * the thread runs; null for the default policy (Since 0.9.22).
+     * Only used by purc_inst_create_or_get().
+     */
+    const char      *numa_node;
+
 } purc_instance_extra_info;
 
 PCA_EXTERN_C_BEGIN
@@ -153,6 +168,74 @@ PCA_EXTERN_C_BEGIN
             PURC_HAVE_FETCHER)
 #define PURC_MODULE_ALL         0xFFFF
 
+/**
+ * purc_allocator:
+ *
+ * The structure defines the hooks of a memory allocator, e.g., one based on
+ * mimalloc or jemalloc. Every hook gets the context of the current thread,
+ * which is set by calling purc_set_allocator_context(), or @ctxt if the
+ * thread has not set one. Note that the memory may be freed or reallocated
+ * in a thread other than the one allocated it, e.g., a variant moved to
+ * another instance.
+ *
+ * Since: 0.9.22
+ */
+typedef struct purc_allocator {
+    /** Allocates the memory; mandatory. */
+    void *(*malloc)(void *ctxt, size_t size);
+
+    /** Allocates the memory filled with zero; nullable. */
+    void *(*calloc)(void *ctxt, size_t nmemb, size_t size);
+
+    /** Resizes the memory; mandatory. */
+    void *(*realloc)(void *ctxt, void *ptr, size_t size);
+
+    /** Frees the memory; mandatory. */
+    void (*free)(void *ctxt, void *ptr);
+
+    /** Returns the usable size of the memory; nullable. If it is given,
+        the bytes allocated and freed are counted for every instance. */
+    size_t (*size)(void *ctxt, const void *ptr);
+
+    /** The default context. */
+    void *ctxt;
+} purc_allocator;
+
+/**
+ * purc_set_allocator:
+ *
+ * @allocator (nullable): The pointer to the #purc_allocator structure
+ *      defining the hooks; %NULL for the allocator of the C library.
+ *
+ * Sets the allocator used by PurC for the memory of the variants, the
+ * documents (DOM), and the helpers. It must be called before the first
+ * PurC instance is initialized in the process, because the memory must
+ * be freed by the allocator which allocated it. The structure is copied.
+ *
+ * Returns: %true for success; %false if any instance has been initialized,
+ *      or any mandatory hook is missing.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT bool
+purc_set_allocator(const purc_allocator *allocator);
+
+/**
+ * purc_set_allocator_context:
+ *
+ * @ctxt (nullable): The context passed to the hooks of the allocator in
+ *      the current thread, e.g., the arena or the heap of the runner;
+ *      %NULL for the default one.
+ *
+ * Sets the context of the allocator for the current thread.
+ *
+ * Returns: The old context of the current thread.
+ *
+ * Since: 0.9.22
+ */
+PCA_EXPORT void *
+purc_set_allocator_context(void *ctxt);
+
 /**
  * purc_init_ex:
  *
@@ -378,6 +461,11 @@ purc_get_runner_variable(const char *name);
 struct pcvdom_document;
 typedef struct pcvdom_document *purc_vdom_t;
 
+/* The environment variable to specify the directory in which the loaded
+   vDOMs are cached in the binary form, so that a new process can load an
+   HVML program without parsing it; the disk cache is disabled if unset. */
+#define PURC_ENVV_VDOM_CACHE_DIR        "PURC_VDOM_CACHE_DIR"
+
 /**
  * purc_load_hvml_from_string:
  *
@@ -447,6 +535,65 @@ purc_load_hvml_from_rwstream(purc_rwstream_t stream);
 PCA_EXPORT struct pcrdr_conn *
 purc_get_conn_to_renderer(void);
 
+/**
+ * purc_crtn_priority_k:
+ *
+ * The scheduling priority of a coroutine. The ready coroutines of a higher
+ * priority run first and have a larger time quantum in a scheduling round.
+ *
+ * Since: 0.9.22
+ */
+typedef enum purc_crtn_priority {
+#define PURC_CRTN_PRIORITY_NAME_LOW     "low"
+    PURC_CRTN_PRIORITY_LOW = -1,
+#define PURC_CRTN_PRIORITY_NAME_NORMAL  "normal"
+    PURC_CRTN_PRIORITY_NORMAL = 0,
+#define PURC_CRTN_PRIORITY_NAME_HIGH    "high"
+    PURC_CRTN_PRIORITY_HIGH = 1,
+} purc_crtn_priority_k;
+
+/* The environment variables to tune the scheduler: the time quantum in
+   microseconds of a coroutine of the normal priority in a scheduling round
+   (5000 by default), and the maximal number of steps it runs in a quantum
+   (0 by default for no limit). */
+#define PURC_ENVV_SCHED_QUANTUM         "PURC_SCHED_QUANTUM"
+#define PURC_ENVV_SCHED_MAX_STEPS       "PURC_SCHED_MAX_STEPS"
+
+/* The environment variables to tune trimming the memory of an idle
+   instance: the seconds the instance keeps idle before trimming (10 by
+   default, 0 for never), and the level of trimming: `pools` to shrink the
+   free lists of the variants, the messages, and the stack frames to low
+   watermarks; `caches` to also shrink the caches of the compiled regular
+   expressions and selectors and remove the expired vDOMs; `all` (default)
+   to also return the free memory of the heap to the system. */
+#define PURC_ENVV_IDLE_TRIM             "PURC_IDLE_TRIM"
+#define PURC_ENVV_IDLE_TRIM_LEVEL       "PURC_IDLE_TRIM_LEVEL"
+
+/* The environment variable to order the lanes of the events in the message
+   queues of the coroutines, e.g., `input,renderer,other,timer,data` (the
+   default); the lanes not listed follow in the default order. Use `fifo`
+   to take the events in the order they arrive. */
+#define PURC_ENVV_EVENT_LANES           "PURC_EVENT_LANES"
+
+/* The environment variables to enable the tracing spans of the hot paths:
+   the capacity of the ring buffer of every instance (0 by default for no
+   tracing), and the file to which the instances append their spans in the
+   JSON array format of Chrome trace when they are cleaned up. */
+#define PURC_ENVV_TRACE_EVENTS          "PURC_TRACE_EVENTS"
+#define PURC_ENVV_TRACE_FILE            "PURC_TRACE_FILE"
+
+/* The environment variable to enable the element-level profiler of every
+   instance: the file to which the instances append the counters of the
+   elements when they exit or purc_request_profile_dump() is called. */
+#define PURC_ENVV_PROFILE_FILE          "PURC_PROFILE_FILE"
+
+/* The environment variable to enable the runner pool: the number of the
+   worker runners which run the detached child coroutines (`call` with
+   `concurrently` or `load` with `asynchronously`, and without `within`),
+   or `auto` for the number of the online processors; 0 by default for no
+   pool. */
+#define PURC_ENVV_RUNNER_POOL           "PURC_RUNNER_POOL"
+
 /**
  * purc_renderer_extra_info:
  *
@@ -491,6 +638,14 @@ typedef struct purc_renderer_extra_info {
 
     /** The page groups to add to the layout DOM */
     const char *page_groups;
+
+    /**
+     * The scheduling priority of the coroutine (purc_crtn_priority_k);
+     * zero for the normal priority.
+     *
+     * Since: 0.9.22
+     */
+    int priority;
 } purc_renderer_extra_info;
 
 /**
@@ -682,6 +837,160 @@ purc_coroutine_get_variable(purc_coroutine_t cor, const char *name);
 PCA_EXPORT int
 purc_coroutine_dump_stack(purc_coroutine_t cor, purc_rwstream_t stm);
 
+/**
+ * purc_enable_profiler:
+ *
+ * @enable: %true to enable the profiler, %false to disable it.
+ *
+ * Enables or disables the element-level profiler of the coroutines in
+ * the current instance. When enabled, the time and the number of variants
+ * allocated in every step of a coroutine are charged to the element being
+ * executed, and the ones in evaluating an attribute are charged to
+ * the attribute. Disabling the profiler keeps the data collected.
+ *
+ * Returns: 0 for success, -1 for failure.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT int
+purc_enable_profiler(bool enable);
+
+/* dumps the self time in microseconds (default) */
+#define PURC_PROFILE_TIME       0x0000
+/* dumps the number of variants allocated */
+#define PURC_PROFILE_ALLOCS     0x0001
+/* Since 0.9.22: dumps the counters of the elements instead of the folded
+   paths: the times executed, the steps, the total, self, and attribute
+   evaluation (VCM) time in microseconds, and the variants allocated. */
+#define PURC_PROFILE_ELEMENTS   0x0002
+
+/**
+ * purc_dump_profile:
+ *
+ * @stm: The stream to dump the profile.
+ * @flags: %PURC_PROFILE_TIME or %PURC_PROFILE_ALLOCS.
+ *
+ * Dumps the data collected by the profiler of the current instance to
+ * a stream in the folded stack format (one `hvml;body;iterate;@on 123`
+ * line for a path), which can be fed to the flame graph tools directly.
+ *
+ * Returns: 0 for success, -1 for failure.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT int
+purc_dump_profile(purc_rwstream_t stm, unsigned int flags);
+
+/**
+ * purc_reset_profile:
+ *
+ * Discards the data collected by the profiler of the current instance.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT void
+purc_reset_profile(void);
+
+/**
+ * purc_request_profile_dump:
+ *
+ * Requests all instances profiling with %PURC_ENVV_PROFILE_FILE set to
+ * append the counters of the elements (see %PURC_PROFILE_ELEMENTS) to the
+ * file in their next scheduling round. It is async-signal-safe and can be
+ * called in a signal handler.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT void
+purc_request_profile_dump(void);
+
+/**
+ * purc_enable_tracing:
+ *
+ * @nr_events: The capacity of the ring buffer of the spans; 0 to disable
+ *      the tracing.
+ *
+ * Enables or disables the tracing spans of the hot paths (the scheduler,
+ * the renderer I/O, the fetcher requests, and the evaluation of VCM trees)
+ * for the current instance. When the ring buffer is full, the oldest spans
+ * are overwritten. The spans recorded are discarded when the tracing is
+ * disabled or enabled again.
+ *
+ * The tracing can also be enabled for all instances by the environment
+ * variable %PURC_ENVV_TRACE_EVENTS.
+ *
+ * Returns: 0 for success, -1 for failure.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT int
+purc_enable_tracing(size_t nr_events);
+
+/**
+ * purc_dump_trace:
+ *
+ * @stm: The stream to dump the spans.
+ *
+ * Dumps the spans recorded for the current instance to a stream as
+ * a Chrome trace JSON object, which can be loaded by `chrome://tracing`
+ * or Perfetto UI. The timestamps come from the monotonic clock, so
+ * the traces of different runners in a process can be correlated.
+ *
+ * Returns: 0 for success, -1 for failure.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT int
+purc_dump_trace(purc_rwstream_t stm);
+
+/**
+ * purc_get_instance_metrics:
+ *
+ * Collects a snapshot of the runtime metrics of the current instance:
+ *
+ *  - `coroutines`: the numbers of the coroutines by state (`total`,
+ *    `ready`, `running`, `stopped`, `observing`, `exited`, `terminated`);
+ *  - `steps`: the number of the steps run by the coroutines so far;
+ *  - `messages`: the number of the messages in the queues of the coroutines;
+ *  - `moveBuffer`: the number of the messages held in the move buffer;
+ *  - `eventLanes`: the events pending in the message queues of the
+ *    coroutines by the lanes (`input`, `renderer`, `timer`, `data`,
+ *    `other`), each with the current `depth` and the `peak` depth of
+ *    the queues;
+ *  - `framePool`: the statistics of the pool of the stack frames and the
+ *    contexts of the elements (`allocs`, `reused`, `oversized`, `inUse`,
+ *    `peakInUse`, `cached`);
+ *  - `idleTrim`: the statistics of trimming the memory when the instance
+ *    is idle (`trims`, `released` in bytes from the pools,
+ *    `cachesReleased` as the entries removed from the caches,
+ *    `mallocTrims`);
+ *  - `variants`: the statistics of the variant heap (`values`, `memory`,
+ *    `peakMemory`, `reserved`, `slabBlocks`, `slabMemory`);
+ *  - `allocator`: the statistics of the allocations made by the current
+ *    thread via the allocator set by purc_set_allocator() (`allocs`,
+ *    `frees`, and `allocated` and `freed` in bytes if the allocator has
+ *    the `size` hook), or null if no allocator is set;
+ *  - `renderer`: the statistics of the connection to the renderer, or
+ *    null if there is no connection;
+ *  - `timers`: the numbers of the timers created and armed (`total`,
+ *    `armed`) on the run loop of the instance;
+ *  - `fetcherRequests`: the number of the fetcher requests in flight in
+ *    the process;
+ *  - `fetcherOrigins`: the statistics of the connection pool of the remote
+ *    fetcher by origin (`requests`, `reused`, `connects`, `tlsHandshakes`,
+ *    `http2`);
+ *  - `selectorCache`: the statistics of the cache of the compiled CSS
+ *    selectors (`cached`, `hits`, `misses`).
+ *
+ * The same snapshot is available to HVML programs as `$RUNNER.metrics`.
+ *
+ * Returns: An object variant on success, %PURC_VARIANT_INVALID on failure.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT purc_variant_t
+purc_get_instance_metrics(void);
+
 struct purc_cor_run_info {
     unsigned long   run_idx;
     purc_variant_t  result;
@@ -951,6 +1260,13 @@ purc_get_app_icon_url(const char *display_density, const char *locale);
  * Creates a new PurC instance or gets the atom value of the existing
  * PurC instance.
  *
+ * The thread of the new instance is named after the runner, and placed
+ * by `cpu_affinity` and `numa_node` of @extra_info. If both are null, the
+ * placement is taken from the entry of the runner in `runners` of the app
+ * manifest, if any, e.g., `{ "name": "worker0", "cpuAffinity": "0-3",
+ * "numaNode": 0 }`. A placement which can not be applied is logged and
+ * ignored.
+ *
  * Returns: The atom representing the new PurC instance, 0 for error.
  *
  * Since 0.2.0
@@ -1013,6 +1329,52 @@ purc_inst_schedule_vdom(purc_atom_t inst, purc_vdom_t vdom,
         purc_renderer_extra_info *extra_rdr_info,
         const char *entry);
 
+/**
+ * purc_inst_pool_prepare:
+ *
+ * @min_idle: The number of the idle instances to make at once and to keep
+ *      in the pool.
+ * @max_idle: The maximal number of the idle instances in the pool; an
+ *      instance finishing its work is cleaned up if the pool is full.
+ * @cond_handler (nullable): A pointer to the condition handler for the
+ *      instances in the pool.
+ * @extra_info (nullable): A pointer to the extra information for the
+ *      instances in the pool; it must be valid as long as the pool is used.
+ *
+ * Prepares the pool of the idle instances of the app of the current
+ * instance, whose runner names are `_inst<seq>`. An instance taken by
+ * purc_inst_pool_take() runs the vDOMs scheduled by purc_inst_schedule_vdom();
+ * when all of its coroutines exited, the runner-level variables of the
+ * instance are reset, and the instance goes back to the pool.
+ *
+ * Calling this function again changes the limits of the pool; the surplus
+ * idle instances are asked to shutdown, e.g., call it with 0 for both
+ * @min_idle and @max_idle before quitting, since the idle instances keep
+ * the main runner alive.
+ *
+ * Returns: The number of the idle instances in the pool, -1 for error.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT int
+purc_inst_pool_prepare(size_t min_idle, size_t max_idle,
+        purc_cond_handler cond_handler,
+        const purc_instance_extra_info *extra_info);
+
+/**
+ * purc_inst_pool_take:
+ *
+ * Takes an idle instance from the pool prepared by
+ * purc_inst_pool_prepare(), or makes a new one if there is no idle instance.
+ * The pool is refilled to `min_idle` instances in the background.
+ *
+ * Returns: The atom representing the instance, 0 for error.
+ *
+ * Since 0.9.22
+ */
+PCA_EXPORT purc_atom_t
+purc_inst_pool_take(void);
+
 #define PURC_EVENT_TARGET_SELF          0
 #define PURC_EVENT_TARGET_BROADCAST     ((purc_atom_t)-1)
 
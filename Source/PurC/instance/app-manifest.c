@@ -30,6 +30,9 @@
 #include "private/instance.h"
 #include "private/debug.h"
 
+#include <pthread.h>
+#include <unistd.h>
+
 #define FALLBACK_LOCALE     "en_US"
 #define FALLBACK_DENSITY    "hdpi"
 
@@ -37,6 +40,7 @@
 #define KEY_DESC            "description"
 #define KEY_ICON            "icon"
 #define KEY_RUNNERS         "runners"
+#define KEY_DVOBJS          "dvobjs"
 
 static const char *label_for_unlabeled_app =
     "{"
@@ -64,6 +68,61 @@ static const char *label_for_unlabeled_runner =
         "zh: '未標記'"
     "}";
 
+static void *
+preload_dvobjs_worker(void *arg)
+{
+    char **names = arg;
+
+    for (size_t i = 0; names[i]; i++) {
+        pcvariant_preload_dvobj_lib(names[i]);
+        free(names[i]);
+    }
+
+    free(names);
+    return NULL;
+}
+
+/*
+ * Opens the shared libraries of the dynamic objects listed by the manifest
+ * (e.g., `"dvobjs": ["FS", "MATH"]`) in a background thread, so that the
+ * `load` elements of the app will find them in the cache.
+ */
+static void
+preload_dvobjs(purc_variant_t dvobjs)
+{
+    size_t nr, n = 0;
+    if (!purc_variant_array_size(dvobjs, &nr) || nr == 0)
+        return;
+
+    char **names = calloc(nr + 1, sizeof(char *));
+    if (names == NULL)
+        return;
+
+    for (size_t i = 0; i < nr; i++) {
+        const char *name = purc_variant_get_string_const(
+                purc_variant_array_get(dvobjs, i));
+        if (name && name[0]) {
+            names[n] = strdup(name);
+            if (names[n] == NULL)
+                break;
+            n++;
+        }
+    }
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = n ? pthread_create(&thread, &attr, preload_dvobjs_worker, names)
+        : -1;
+    pthread_attr_destroy(&attr);
+    if (ret) {
+        for (size_t i = 0; i < n; i++)
+            free(names[i]);
+        free(names);
+    }
+}
+
 purc_variant_t
 pcinst_load_app_manifest(const char *app_name)
 {
@@ -159,12 +218,59 @@ pcinst_load_app_manifest(const char *app_name)
         purc_variant_unref(fallback);
     }
 
+    v = purc_variant_object_get_by_ckey(manifest, KEY_DVOBJS);
+    if (v != PURC_VARIANT_INVALID) {
+        preload_dvobjs(v);
+    }
+
     return manifest;
 
 failed:
     return PURC_VARIANT_INVALID;
 }
 
+purc_variant_t
+pcinst_get_runner_manifest(const char *app_name, const char *runner_name)
+{
+    char path_buf[(sizeof(PURC_PATH_APP_MANIFEST) + PURC_LEN_APP_NAME)];
+
+    int n = snprintf(path_buf, sizeof(path_buf), PURC_PATH_APP_MANIFEST,
+            app_name);
+    if (n < 0 || (size_t)n >= sizeof(path_buf))
+        return PURC_VARIANT_INVALID;
+
+    if (access(path_buf, R_OK))
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t manifest = purc_variant_load_from_json_file(path_buf);
+    if (manifest == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t runner = PURC_VARIANT_INVALID;
+    purc_variant_t runners = purc_variant_object_get_by_ckey(manifest,
+            KEY_RUNNERS);
+    size_t nr;
+    if (runners && purc_variant_array_size(runners, &nr)) {
+        for (size_t i = 0; i < nr; i++) {
+            purc_variant_t val = purc_variant_array_get(runners, i);
+            purc_variant_t name = purc_variant_is_object(val) ?
+                purc_variant_object_get_by_ckey(val, "name") : NULL;
+            const char *str = name ? purc_variant_get_string_const(name) :
+                NULL;
+            if (str && strcasecmp(runner_name, str) == 0) {
+                runner = purc_variant_ref(val);
+                break;
+            }
+        }
+    }
+
+    purc_clr_error(); /* clr NoSuchKey */
+    purc_variant_unref(manifest);
+    return runner;
+}
+
 purc_variant_t
 purc_get_app_manifest(void)
 {
@@ -235,11 +235,14 @@ struct pcmodule _module_errmsg = {
 };
 
 extern struct pcmodule _module_atom;
+extern struct pcmodule _module_regex;
 extern struct pcmodule _module_keywords;
 extern struct pcmodule _module_runloop;
 extern struct pcmodule _module_rwstream;
+extern struct pcmodule _module_trace;
 extern struct pcmodule _module_dom;
 extern struct pcmodule _module_html;
+extern struct pcmodule _module_document;
 extern struct pcmodule _module_variant;
 extern struct pcmodule _module_mvheap;
 extern struct pcmodule _module_mvbuf;
@@ -260,10 +263,13 @@ struct pcmodule* _pc_modules[] = {
     &_module_keywords,
 
     &_module_errmsg,
+    &_module_regex,
 
     &_module_rwstream,
+    &_module_trace,
     &_module_dom,
     &_module_html,
+    &_module_document,
 
     &_module_variant,
     &_module_mvheap,
@@ -287,6 +293,8 @@ struct pcmodule* _pc_modules[] = {
 static bool _init_ok = false;
 static void _init_once(void)
 {
+    pcutils_allocator_freeze();
+
 #if 0
      __purc_locale_c = newlocale(LC_ALL_MASK, "C", (locale_t)0);
     atexit(free_locale_c);
@@ -360,6 +368,14 @@ static void enable_log_on_demand(void)
     }
 
     purc_enable_log_ex(log_mask, use_syslog);
+
+    if ((env_value = getenv(PURC_ENVV_LOG_ASYNC)) &&
+            (*env_value == '1' || strcasecmp(env_value, "true") == 0)) {
+        unsigned long rate_limit = 0;
+        if ((env_value = getenv(PURC_ENVV_LOG_RATE_LIMIT)))
+            rate_limit = strtoul(env_value, NULL, 10);
+        purc_enable_log_async(true, (unsigned)rate_limit);
+    }
 }
 
 static int init_modules(struct pcinst *curr_inst,
@@ -417,6 +433,7 @@ static void cleanup_instance(struct pcinst *curr_inst)
         curr_inst->local_data_map = NULL;
     }
 
+    pcinst_stop_async_log(curr_inst);
     if (curr_inst->fp_log && curr_inst->fp_log != LOG_FILE_SYSLOG) {
         fclose(curr_inst->fp_log);
         curr_inst->fp_log = NULL;
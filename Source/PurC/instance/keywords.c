@@ -24,19 +24,34 @@
 
 #include "keywords.h"
 #include "private/debug.h"
+#include "private/utils.h"
+
+#include <string.h>
 
 struct pchvml_keyword_cfg {
     purc_atom_t                 atom;
     const char                 *keyword;
 };
 
+#define KEYWORD_NO_SLOT     UINT16_MAX
+
+/* NOTE: The perfect hash table of the keywords in a bucket is generated at
+   build time; the slots are the indices in `keywords`. */
+struct pchvml_keyword_phash {
+    enum pcatom_bucket          bucket;
+    const uint16_t             *disps;
+    size_t                      nr_disps;
+    const uint16_t             *slots;
+    size_t                      nr_slots;
+};
+
 static void
 keywords_bucket_init(struct pchvml_keyword_cfg *cfgs,
         size_t start, size_t end, enum pcatom_bucket bucket)
 {
     struct pchvml_keyword_cfg *cfg = cfgs + start;
     for (size_t i=start; i<end; ++i) {
-        cfg->atom = purc_atom_from_string_ex(bucket, cfg->keyword);
+        cfg->atom = purc_atom_from_static_string_ex(bucket, cfg->keyword);
         PC_ASSERT(cfg->atom);
         ++cfg;
     }
@@ -57,6 +72,23 @@ purc_atom_t pchvml_keyword(enum pchvml_keyword_enum keyword)
 purc_atom_t pchvml_keyword_try_string(enum pcatom_bucket bucket,
         const char *keyword)
 {
+    for (size_t i = 0; i < PCA_TABLESIZE(keywords_phash); i++) {
+        const struct pchvml_keyword_phash *phash = keywords_phash + i;
+        if (phash->bucket != bucket)
+            continue;
+
+        uint32_t key = pcutils_perfect_hash_key(keyword, strlen(keyword));
+        size_t idx = pcutils_perfect_hash_slot(key, phash->disps,
+                phash->nr_disps, phash->nr_slots);
+        uint16_t slot = phash->slots[idx];
+        if (slot != KEYWORD_NO_SLOT &&
+                strcmp(keywords[slot].keyword, keyword) == 0) {
+            return keywords[slot].atom;
+        }
+        break;
+    }
+
+    /* not a keyword; the string may be added to the bucket by others */
     return purc_atom_try_string_ex(bucket, keyword);
 }
 
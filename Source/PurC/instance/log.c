@@ -34,12 +34,426 @@
 
 #include "private/instance.h"
 #include "private/ports.h"
+#include "private/list.h"
+#include "private/utils.h"
 
 #include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
 
 static unsigned global_log_levels = PURC_LOG_MASK_DEFAULT;
 static FILE *global_log_fp = NULL;
 
+static struct {
+    const char *tag;
+    int         sys_level;
+} level_info[] = {
+    { PURC_LOG_LEVEL_EMERG,     LOG_EMERG },
+    { PURC_LOG_LEVEL_ALERT,     LOG_ALERT },
+    { PURC_LOG_LEVEL_CRIT,      LOG_CRIT },
+    { PURC_LOG_LEVEL_ERR,       LOG_ERR },
+    { PURC_LOG_LEVEL_WARNING,   LOG_WARNING },
+    { PURC_LOG_LEVEL_NOTICE,    LOG_NOTICE },
+    { PURC_LOG_LEVEL_INFO,      LOG_INFO },
+    { PURC_LOG_LEVEL_DEBUG,     LOG_DEBUG },
+};
+
+/* Make sure the number of log level tags matches the number of log levels */
+#define _COMPILE_TIME_ASSERT(name, x)               \
+       typedef int _dummy_ ## name[(x) * 2 - 1]
+
+_COMPILE_TIME_ASSERT(levels,
+        PCA_TABLESIZE(level_info) == PURC_LOG_LEVEL_nr);
+
+#undef _COMPILE_TIME_ASSERT
+
+/*
+ * NOTE: In the asynchronous mode, the messages of an instance are formatted
+ * on the thread of the instance into a single-producer/single-consumer ring
+ * buffer, and a writer thread shared by all instances writes them to the
+ * log facility. The thread of an instance never blocks on I/O or on a lock
+ * when logging; if the ring buffer is full, the message is dropped.
+ */
+
+/* the size of the ring buffer of an instance; must be a power of two */
+#define LOG_RING_SIZE           (64 * 1024)
+
+/* the maximal length of a formatted message */
+#define LOG_MSG_MAX             1024
+
+/* the number of tags whose rates are tracked */
+#define LOG_NR_RATES            16
+
+/* the writer thread wakes up to write the pending messages in this interval,
+   or when a ring buffer is filled more than LOG_RING_WAKEUP bytes */
+#define LOG_WRITER_INTERVAL     50      /* ms */
+#define LOG_RING_WAKEUP         (LOG_RING_SIZE / 4)
+
+/* the level of a record for padding to the end of the ring buffer */
+#define LOG_LEVEL_PADDING       ((uint32_t)-1)
+
+struct log_record {
+    uint32_t            level;
+    uint32_t            len;
+    char                text[];
+};
+
+#define LOG_RECORD_SIZE(len)    \
+    ((sizeof(struct log_record) + (len) + 7) & ~(size_t)7)
+
+struct log_rate {
+    const char         *tag;
+    time_t              second;
+    unsigned            nr;
+};
+
+struct pclog_ring {
+    struct list_head    node;
+
+    /* the log facility; changed by the instance only when the ring buffer
+       is empty */
+    FILE               *fp;
+    const char         *ident;
+
+    /* the maximal number of messages with the same tag in one second */
+    unsigned            rate_limit;
+    struct log_rate     rates[LOG_NR_RATES];
+
+    /* the messages dropped since the ring buffer is full or rate limited */
+    size_t              nr_dropped;
+    size_t              nr_limited;
+
+    /* the number of dropped messages reported; used by the writer */
+    size_t              nr_reported;
+
+    /* the producer (the instance) writes head, the consumer writes tail */
+    size_t              head;
+    size_t              tail;
+
+    char                buf[LOG_RING_SIZE];
+};
+
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_wakeup = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t log_drained = PTHREAD_COND_INITIALIZER;
+
+/* serializes starting and stopping the writer thread */
+static pthread_mutex_t log_writer_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static LIST_HEAD(log_rings);
+static pthread_t log_writer;
+static bool log_running;
+static bool log_idle;
+
+static void write_log_text(struct pclog_ring *ring, uint32_t level,
+        const char *text, size_t len)
+{
+    FILE *fp = ring->fp;
+
+    if (fp == NULL)
+        return;
+
+    if (fp == LOG_FILE_SYSLOG) {
+#if HAVE(VSYSLOG)
+        openlog(ring->ident, LOG_PID, LOG_USER);
+        syslog(LOG_INFO | level_info[level].sys_level, "%.*s",
+                (int)len, text);
+        return;
+#else
+        fp = stdout;
+#endif
+    }
+
+    fwrite(text, 1, len, fp);
+}
+
+/* writes the pending messages of a ring; returns whether wrote any */
+static bool drain_ring(struct pclog_ring *ring)
+{
+    size_t tail = ring->tail;
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    size_t nr_dropped;
+    bool wrote = false;
+
+    while (tail != head) {
+        size_t pos = tail & (LOG_RING_SIZE - 1);
+        struct log_record *rec = (struct log_record *)(ring->buf + pos);
+
+        if (rec->level == LOG_LEVEL_PADDING) {
+            tail += LOG_RING_SIZE - pos;
+        }
+        else {
+            write_log_text(ring, rec->level, rec->text, rec->len);
+            tail += LOG_RECORD_SIZE(rec->len);
+        }
+
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+        wrote = true;
+    }
+
+    nr_dropped = __atomic_load_n(&ring->nr_dropped, __ATOMIC_RELAXED) +
+        __atomic_load_n(&ring->nr_limited, __ATOMIC_RELAXED);
+    if (nr_dropped != ring->nr_reported) {
+        char text[128];
+        int n = snprintf(text, sizeof(text), "%s %s >> %zu messages dropped\n",
+                ring->ident, PURC_LOG_LEVEL_WARNING,
+                nr_dropped - ring->nr_reported);
+        if (n > 0 && (size_t)n < sizeof(text))
+            write_log_text(ring, PURC_LOG_WARNING, text, n);
+        ring->nr_reported = nr_dropped;
+        wrote = true;
+    }
+
+    if (wrote && ring->fp && ring->fp != LOG_FILE_SYSLOG && ring->fp != stderr)
+        fflush(ring->fp);
+
+    return wrote;
+}
+
+static void *log_writer_entry(void *arg)
+{
+    struct pclog_ring *ring;
+    bool busy;
+
+    (void)arg;
+
+    pthread_mutex_lock(&log_lock);
+    while (log_running) {
+        busy = false;
+        list_for_each_entry(ring, &log_rings, node) {
+            if (drain_ring(ring))
+                busy = true;
+        }
+
+        pthread_cond_broadcast(&log_drained);
+        if (busy)
+            continue;
+
+        __atomic_store_n(&log_idle, true, __ATOMIC_RELAXED);
+        if (log_running) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += LOG_WRITER_INTERVAL * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&log_wakeup, &log_lock, &ts);
+        }
+        __atomic_store_n(&log_idle, false, __ATOMIC_RELAXED);
+    }
+
+    list_for_each_entry(ring, &log_rings, node) {
+        drain_ring(ring);
+    }
+    pthread_cond_broadcast(&log_drained);
+    pthread_mutex_unlock(&log_lock);
+    return NULL;
+}
+
+/* waits until the writer thread wrote all messages in the ring */
+static void flush_ring(struct pclog_ring *ring)
+{
+    pthread_mutex_lock(&log_lock);
+    while (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) != ring->head) {
+        pthread_cond_signal(&log_wakeup);
+        pthread_cond_wait(&log_drained, &log_lock);
+    }
+    pthread_mutex_unlock(&log_lock);
+}
+
+static bool is_rate_limited(struct pclog_ring *ring, const char *tag)
+{
+    struct log_rate *rate = NULL, *oldest = ring->rates;
+    time_t second = pcutils_get_monotoic_time_ms() / 1000;
+
+    for (int i = 0; i < LOG_NR_RATES; i++) {
+        struct log_rate *r = ring->rates + i;
+
+        if (r->tag && (r->tag == tag || strcmp(r->tag, tag) == 0)) {
+            rate = r;
+            break;
+        }
+
+        if (r->tag == NULL || r->second < oldest->second)
+            oldest = r;
+    }
+
+    if (rate == NULL) {
+        rate = oldest;
+        rate->tag = tag;
+        rate->second = second;
+        rate->nr = 0;
+    }
+    else if (rate->second != second) {
+        rate->second = second;
+        rate->nr = 0;
+    }
+
+    return ++rate->nr > ring->rate_limit;
+}
+
+static void write_log_record(struct pclog_ring *ring, purc_log_level_k level,
+        const char *tag, const char *msg, va_list ap)
+    PCA_ATTRIBUTE_PRINTF(4, 0);
+
+static void write_log_record(struct pclog_ring *ring, purc_log_level_k level,
+        const char *tag, const char *msg, va_list ap)
+{
+    char text[LOG_MSG_MAX];
+    size_t len = 0, need, pos, room, used;
+    int n;
+
+    if (ring->rate_limit && is_rate_limited(ring, tag)) {
+        __atomic_store_n(&ring->nr_limited, ring->nr_limited + 1,
+                __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (ring->fp != LOG_FILE_SYSLOG) {
+        n = snprintf(text, sizeof(text), "%s %s >> ", ring->ident, tag);
+        if (n > 0)
+            len = MIN((size_t)n, sizeof(text) - 1);
+    }
+
+    n = vsnprintf(text + len, sizeof(text) - len, msg, ap);
+    if (n > 0)
+        len = MIN(len + n, sizeof(text) - 1);
+
+    /* NOTE: a record never wraps around the end of the ring buffer */
+    need = LOG_RECORD_SIZE(len);
+    pos = ring->head & (LOG_RING_SIZE - 1);
+    room = LOG_RING_SIZE - pos;
+    if (room >= need)
+        room = 0;
+
+    used = ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (LOG_RING_SIZE - used < room + need) {
+        __atomic_store_n(&ring->nr_dropped, ring->nr_dropped + 1,
+                __ATOMIC_RELAXED);
+        goto wakeup;
+    }
+
+    if (room) {
+        ((struct log_record *)(ring->buf + pos))->level = LOG_LEVEL_PADDING;
+        pos = 0;
+    }
+
+    struct log_record *rec = (struct log_record *)(ring->buf + pos);
+    rec->level = level;
+    rec->len = (uint32_t)len;
+    memcpy(rec->text, text, len);
+    __atomic_store_n(&ring->head, ring->head + room + need, __ATOMIC_RELEASE);
+    used += room + need;
+
+wakeup:
+    /* NOTE: the writer thread wakes up by itself in LOG_WRITER_INTERVAL;
+       do not make a system call for every message. */
+    if (used >= LOG_RING_WAKEUP &&
+            __atomic_load_n(&log_idle, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&log_lock);
+        pthread_cond_signal(&log_wakeup);
+        pthread_mutex_unlock(&log_lock);
+    }
+}
+
+static struct pclog_ring *start_async_log(struct pcinst *inst,
+        unsigned rate_limit)
+{
+    struct pclog_ring *ring = calloc(1, sizeof(*ring));
+    if (ring == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    ring->fp = inst->fp_log;
+    ring->ident = inst->endpoint_atom ?
+        purc_atom_to_string(inst->endpoint_atom) : "[unknown]";
+    ring->rate_limit = rate_limit;
+
+    pthread_mutex_lock(&log_writer_lock);
+    pthread_mutex_lock(&log_lock);
+    if (list_empty(&log_rings)) {
+        log_running = true;
+        if (pthread_create(&log_writer, NULL, log_writer_entry, NULL)) {
+            log_running = false;
+            pthread_mutex_unlock(&log_lock);
+            pthread_mutex_unlock(&log_writer_lock);
+            free(ring);
+            purc_set_error(PURC_ERROR_SYS_FAULT);
+            return NULL;
+        }
+    }
+    list_add_tail(&ring->node, &log_rings);
+    pthread_mutex_unlock(&log_lock);
+    pthread_mutex_unlock(&log_writer_lock);
+
+    return ring;
+}
+
+void pcinst_stop_async_log(struct pcinst *inst)
+{
+    struct pclog_ring *ring = inst->log_ring;
+    bool stop;
+
+    if (ring == NULL)
+        return;
+
+    flush_ring(ring);
+
+    pthread_mutex_lock(&log_writer_lock);
+    pthread_mutex_lock(&log_lock);
+    drain_ring(ring);
+    list_del(&ring->node);
+    stop = list_empty(&log_rings);
+    if (stop) {
+        log_running = false;
+        pthread_cond_signal(&log_wakeup);
+    }
+    pthread_mutex_unlock(&log_lock);
+
+    if (stop)
+        pthread_join(log_writer, NULL);
+    pthread_mutex_unlock(&log_writer_lock);
+
+    inst->log_ring = NULL;
+    free(ring);
+}
+
+bool purc_enable_log_async(bool enable, unsigned rate_limit)
+{
+    struct pcinst* inst = pcinst_current();
+    if (inst == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return false;
+    }
+
+    if (!enable) {
+        pcinst_stop_async_log(inst);
+        return true;
+    }
+
+    if (inst->log_ring) {
+        inst->log_ring->rate_limit = rate_limit;
+        return true;
+    }
+
+    inst->log_ring = start_async_log(inst, rate_limit);
+    return inst->log_ring != NULL;
+}
+
+size_t purc_get_log_dropped(size_t *nr_limited)
+{
+    struct pcinst* inst = pcinst_current();
+    struct pclog_ring *ring = inst ? inst->log_ring : NULL;
+
+    if (nr_limited)
+        *nr_limited = ring ? ring->nr_limited : 0;
+
+    return ring ? ring->nr_dropped : 0;
+}
+
 unsigned purc_get_log_levels(void)
 {
     struct pcinst* inst = pcinst_current();
@@ -78,6 +492,12 @@ bool purc_enable_log_ex(unsigned levels, purc_log_facility_k facility)
         return true;
     }
 
+    /* the writer thread may be still writing the messages to fp_log */
+    if (inst->log_ring) {
+        flush_ring(inst->log_ring);
+        inst->log_ring->fp = NULL;
+    }
+
     if (inst->fp_log &&
             (inst->fp_log != LOG_FILE_SYSLOG &&
              inst->fp_log != stdout && inst->fp_log != stderr)) {
@@ -134,29 +554,6 @@ bool purc_enable_log_ex(unsigned levels, purc_log_facility_k facility)
     return true;
 }
 
-static struct {
-    const char *tag;
-    int         sys_level;
-} level_info[] = {
-    { PURC_LOG_LEVEL_EMERG,     LOG_EMERG },
-    { PURC_LOG_LEVEL_ALERT,     LOG_ALERT },
-    { PURC_LOG_LEVEL_CRIT,      LOG_CRIT },
-    { PURC_LOG_LEVEL_ERR,       LOG_ERR },
-    { PURC_LOG_LEVEL_WARNING,   LOG_WARNING },
-    { PURC_LOG_LEVEL_NOTICE,    LOG_NOTICE },
-    { PURC_LOG_LEVEL_INFO,      LOG_INFO },
-    { PURC_LOG_LEVEL_DEBUG,     LOG_DEBUG },
-};
-
-/* Make sure the number of log level tags matches the number of log levels */
-#define _COMPILE_TIME_ASSERT(name, x)               \
-       typedef int _dummy_ ## name[(x) * 2 - 1]
-
-_COMPILE_TIME_ASSERT(levels,
-        PCA_TABLESIZE(level_info) == PURC_LOG_LEVEL_nr);
-
-#undef _COMPILE_TIME_ASSERT
-
 void purc_log_with_tag(purc_log_level_k level, const char *tag,
         const char *msg, va_list ap)
 {
@@ -169,6 +566,17 @@ void purc_log_with_tag(purc_log_level_k level, const char *tag,
             return;
         }
         fp = inst->fp_log;
+
+        if (inst->log_ring) {
+            if (inst->log_ring->fp != fp) {
+                /* the facility changed; use it for the new messages only */
+                flush_ring(inst->log_ring);
+                inst->log_ring->fp = fp;
+            }
+
+            write_log_record(inst->log_ring, level, tag, msg, ap);
+            return;
+        }
     }
     else {
         if ((global_log_levels & (0x01U << level)) == 0) {
@@ -24,9 +24,16 @@
 Make HVML keywords table:
     1. Read 'data/keywords.txt' file.
     2. Generate the keywords.h and keywords.inc
+    3. Generate the perfect hash tables of the keywords in every bucket
 """
 
 import argparse
+import os, sys
+
+ABS_PATH = os.path.dirname(os.path.abspath(__file__))
+sys.path.append("{}/../Scripts/".format(ABS_PATH))
+
+import PerfectHash
 
 def read_cfgs_fin(fin):
     cfgs = {}
@@ -83,6 +90,41 @@ def gen_keywords_bucket_init(prefix, start, end):
     #   keywords_bucket_init(keywords, start, end, ATOM_BUCKET_<PREFIX>)
     return "    keywords_bucket_init(keywords, %s, %s, ATOM_BUCKET_%s)" % (start, end, prefix.upper())
 
+def gen_keywords_perfect_hash(fout, cfgs):
+    # generate for every prefix:
+    #   keywords_<prefix>_disps[] and keywords_<prefix>_slots[]
+    # and the table of them indexed by the bucket:
+    #   { ATOM_BUCKET_<PREFIX>, disps, nr_disps, slots, nr_slots }
+    start = 0
+    tables = []
+    for prefix in cfgs:
+        kws = cfgs[prefix]
+        disps, slots = PerfectHash.make(kws)
+
+        name = "keywords_%s" % prefix.lower()
+        fout.write("static const uint16_t %s_disps[] = {\n" % name)
+        fout.write("%s\n" % PerfectHash.c_array(disps, lambda d: '%d' % d))
+        fout.write("};\n\n")
+
+        values = []
+        for slot in slots:
+            if slot is None:
+                values.append("KEYWORD_NO_SLOT")
+            else:
+                values.append("%d" % (start + slot))
+        fout.write("static const uint16_t %s_slots[] = {\n" % name)
+        fout.write("%s\n" % PerfectHash.c_array(values, lambda v: v))
+        fout.write("};\n\n")
+
+        tables.append("    { ATOM_BUCKET_%s, %s_disps, PCA_TABLESIZE(%s_disps),\n"
+                "        %s_slots, PCA_TABLESIZE(%s_slots) }" %
+                (prefix.upper(), name, name, name, name))
+        start += len(kws)
+
+    fout.write("static const struct pchvml_keyword_phash keywords_phash[] = {\n")
+    fout.write("%s,\n" % ',\n'.join(tables))
+    fout.write("};\n")
+
 def process_header_fn(fout, fin, cfgs):
     line_no = 1
     line = fin.readline()
@@ -147,6 +189,8 @@ def process_source_fn(fout, fin, cfgs):
                 s = gen_keywords_bucket_init(prefix, start, end)
                 fout.write("%s;\n" % s)
                 start = end
+        elif s == "%%keywords_perfect_hash%%":
+            gen_keywords_perfect_hash(fout, cfgs)
         else:
             fout.write(line)
         line_no = line_no + 1
@@ -29,6 +29,8 @@
 
 #include "purc-pcrdr.h"
 #include "purc-errors.h"
+#include "purc-runloop.h"
+#include "purc-rwstream.h"
 
 /* this feature needs C11 (stdatomic.h) or above */
 #if HAVE(STDATOMIC_H)
@@ -39,6 +41,7 @@
 #include "private/utils.h"
 #include "private/ports.h"
 #include "private/debug.h"
+#include "private/variant.h"
 
 #include <stdatomic.h>
 #include <assert.h>
@@ -49,13 +52,24 @@
 
 #define NR_DEF_MAX_MSGS     4
 
+/*
+ * The producers push the messages to the inbox, a lock-free stack linked by
+ * `ln.next` of the message headers. The owner instance, the only consumer,
+ * takes the whole inbox at once and appends it in the order of arrival to
+ * `msgs`, which is only accessed by the owner and needs no lock.
+ */
 struct pcinst_move_buffer {
-    struct purc_rwlock  lock;
+    _Atomic(struct list_head *) inbox;
+    /* the number of messages reserved by the producers and not taken away */
+    atomic_size_t       nr_reserved;
+
     struct list_head    msgs;
+    size_t              nr_msgs;
 
+    /* the run loop of the owner, waked up when the inbox becomes non-empty */
+    purc_runloop_t      runloop;
     unsigned int        flags;
     size_t              max_nr_msgs;
-    size_t              nr_msgs;
 };
 
 /* the header of the struct pcrdr_msg */
@@ -96,6 +110,7 @@ static int mvbuf_init_once(void)
     purc_rwlock_init(&mb_lock);
     if (mb_lock.native_impl == NULL)
         goto fail_lock;
+    purc_rwlock_set_name(&mb_lock, "move-buffer");
 
     mb_atom2buff_map = pcutils_sorted_array_create(SAFLAG_DEFAULT, 0,
             NULL, NULL);
@@ -118,6 +133,56 @@ fail_lock:
     return -1;
 }
 
+/* the maximal number of the recycled messages kept by an instance */
+#define NR_MAX_FREE_MSGS    64
+
+static pcrdr_msg *
+alloc_message(void)
+{
+#if HAVE(GLIB)
+    return (pcrdr_msg *)g_slice_alloc0(sizeof(pcrdr_msg));
+#else
+    return (pcrdr_msg *)calloc(1, sizeof(pcrdr_msg));
+#endif
+}
+
+static void
+free_message(pcrdr_msg *msg)
+{
+#if HAVE(GLIB)
+    g_slice_free1(sizeof(pcrdr_msg), (gpointer)msg);
+#else
+    free(msg);
+#endif
+}
+
+/*
+ * A message is recycled to the pool of the instance releasing it, which may
+ * not be the one having got it. A recycled message has been reset to zeros
+ * except for the link in the header.
+ */
+static void
+recycle_message(pcrdr_msg *msg)
+{
+    for (int i = 0; i < PCRDR_NR_MSG_VARIANTS; i++) {
+        if (msg->variants[i]) {
+            purc_variant_unref(msg->variants[i]);
+        }
+    }
+
+    struct pcinst* inst = pcinst_current();
+    if (inst && inst->nr_free_msgs < NR_MAX_FREE_MSGS) {
+        struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)msg;
+        memset(msg, 0, sizeof(*msg));
+        hdr->ln.next = inst->free_msgs;
+        inst->free_msgs = &hdr->ln;
+        inst->nr_free_msgs++;
+    }
+    else {
+        free_message(msg);
+    }
+}
+
 pcrdr_msg *
 pcinst_get_message(void)
 {
@@ -129,11 +194,19 @@ pcinst_get_message(void)
         return NULL;
     }
 
-#if HAVE(GLIB)
-    msg = (pcrdr_msg *)g_slice_alloc0(sizeof(pcrdr_msg));
-#else
-    msg = (pcrdr_msg *)calloc(1, sizeof(pcrdr_msg));
-#endif
+    if (inst->free_msgs) {
+        struct list_head *p = inst->free_msgs;
+        inst->free_msgs = p->next;
+        inst->nr_free_msgs--;
+        inst->nr_msg_hits++;
+
+        p->next = NULL;
+        msg = (pcrdr_msg *)list_entry(p, struct pcrdr_msg_hdr, ln);
+    }
+    else {
+        msg = alloc_message();
+        inst->nr_msg_misses++;
+    }
 
     if (msg) {
         struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)msg;
@@ -155,20 +228,64 @@ pcinst_put_message(pcrdr_msg *msg)
 
     PC_DEBUG("The old refcnt of message in %s: %u\n", __func__, refcnt);
     if (refcnt == 1) {
-        PC_DEBUG("Freeing message in %s: %p\n", __func__, msg);
+        PC_DEBUG("Recycling message in %s: %p\n", __func__, msg);
+        recycle_message(msg);
+    }
+}
 
-        for (int i = 0; i < PCRDR_NR_MSG_VARIANTS; i++) {
-            if (msg->variants[i]) {
-                purc_variant_unref(msg->variants[i]);
-            }
-        }
+size_t
+pcinst_trim_message_pool(size_t nr_keep)
+{
+    struct pcinst* inst = pcinst_current();
+    size_t nr_freed = 0;
 
-#if HAVE(GLIB)
-        g_slice_free1(sizeof(pcrdr_msg), (gpointer)msg);
-#else
-        free(msg);
-#endif
+    while (inst && inst->free_msgs && inst->nr_free_msgs > nr_keep) {
+        struct list_head *p = inst->free_msgs;
+        inst->free_msgs = p->next;
+        inst->nr_free_msgs--;
+
+        free_message((pcrdr_msg *)list_entry(p, struct pcrdr_msg_hdr, ln));
+        nr_freed++;
+    }
+
+    return nr_freed * sizeof(pcrdr_msg);
+}
+
+void
+pcinst_get_message_pool_stat(size_t *nr_hits, size_t *nr_misses)
+{
+    struct pcinst* inst = pcinst_current();
+    *nr_hits = inst ? inst->nr_msg_hits : 0;
+    *nr_misses = inst ? inst->nr_msg_misses : 0;
+}
+
+static int mvbuf_init_instance(struct pcinst* inst,
+        const purc_instance_extra_info* extra_info)
+{
+    UNUSED_PARAM(extra_info);
+
+    inst->free_msgs = NULL;
+    inst->nr_free_msgs = 0;
+    inst->nr_msg_hits = 0;
+    inst->nr_msg_misses = 0;
+    return 0;
+}
+
+static void mvbuf_cleanup_instance(struct pcinst* inst)
+{
+    PC_DEBUG("Messages got from the pool: %u hits, %u misses\n",
+            (unsigned)inst->nr_msg_hits, (unsigned)inst->nr_msg_misses);
+
+    struct list_head *p = inst->free_msgs, *next;
+    while (p) {
+        next = p->next;
+        free_message((pcrdr_msg *)list_entry(p, struct pcrdr_msg_hdr, ln));
+        p = next;
     }
+
+    /* NOTE: the messages released by the later cleanups are freed directly */
+    inst->free_msgs = NULL;
+    inst->nr_free_msgs = NR_MAX_FREE_MSGS;
 }
 
 purc_atom_t
@@ -198,18 +315,15 @@ purc_inst_create_move_buffer(unsigned int flags, size_t max_msgs)
         goto done;
     }
 
-    purc_rwlock_init(&mb->lock);
-    if (mb->lock.native_impl == NULL) {
-        errcode = PURC_ERROR_BAD_SYSTEM_CALL;
-        goto done;
-    }
-
     if (pcutils_sorted_array_add(mb_atom2buff_map,
                 (void *)(uintptr_t)atom, mb, NULL) < 0) {
         errcode = PURC_ERROR_OUT_OF_MEMORY;
         goto done;
     }
 
+    atomic_init(&mb->inbox, NULL);
+    atomic_init(&mb->nr_reserved, 0);
+    mb->runloop = purc_runloop_get_current();
     mb->flags = flags;
     mb->nr_msgs = 0;
     mb->max_nr_msgs = (max_msgs > 0) ? max_msgs : NR_DEF_MAX_MSGS;
@@ -220,10 +334,6 @@ done:
 
     if (errcode) {
         if (mb) {
-            if (mb->lock.native_impl) {
-                purc_rwlock_clear(&mb->lock);
-            }
-
             free(mb);
         }
 
@@ -234,6 +344,63 @@ done:
     return atom;
 }
 
+/* called by the producers; fails if the buffer is full */
+static bool
+reserve_message(struct pcinst_move_buffer *mb)
+{
+    size_t n = atomic_fetch_add(&mb->nr_reserved, 1);
+    if (n >= mb->max_nr_msgs) {
+        atomic_fetch_sub(&mb->nr_reserved, 1);
+        return false;
+    }
+
+    return true;
+}
+
+/* called by the producers after reserve_message() */
+static void
+push_message(struct pcinst_move_buffer *mb, pcrdr_msg *msg)
+{
+    struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)msg;
+    struct list_head *head = atomic_load_explicit(&mb->inbox,
+            memory_order_relaxed);
+
+    do {
+        hdr->ln.next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&mb->inbox, &head,
+                &hdr->ln, memory_order_release, memory_order_relaxed));
+
+    if (head == NULL)
+        purc_runloop_wakeup(mb->runloop);
+}
+
+/* called by the owner to move the messages in the inbox to the list */
+static void
+drain_inbox(struct pcinst_move_buffer *mb)
+{
+    if (atomic_load_explicit(&mb->inbox, memory_order_relaxed) == NULL)
+        return;
+
+    struct list_head *p = atomic_exchange_explicit(&mb->inbox, NULL,
+            memory_order_acquire);
+
+    /* the inbox is in the reverse order of arrival */
+    struct list_head *first = NULL, *next;
+    while (p) {
+        next = p->next;
+        p->next = first;
+        first = p;
+        p = next;
+    }
+
+    while (first) {
+        next = first->next;
+        list_add_tail(first, &mb->msgs);
+        mb->nr_msgs++;
+        first = next;
+    }
+}
+
 static void
 pcinst_grind_message(pcrdr_msg *msg)
 {
@@ -242,18 +409,8 @@ pcinst_grind_message(pcrdr_msg *msg)
     PC_DEBUG("refcnt of message in %s: %u\n", __func__, refcnt);
 
     if (refcnt == 1) {
-        PC_DEBUG("Freeing message in %s: %p\n", __func__, msg);
-
-        for (int i = 0; i < PCRDR_NR_MSG_VARIANTS; i++) {
-            if (msg->variants[i])
-                purc_variant_unref(msg->variants[i]);
-        }
-
-#if HAVE(GLIB)
-        g_slice_free1(sizeof(pcrdr_msg), (gpointer)msg);
-#else
-        free(msg);
-#endif
+        PC_DEBUG("Recycling message in %s: %p\n", __func__, msg);
+        recycle_message(msg);
     }
     else {
         PC_ERROR("Grinding a message refc > 1: %p (%u)\n", msg, refcnt);
@@ -281,8 +438,10 @@ purc_inst_destroy_move_buffer(void)
         goto done;
     }
 
+    /* no producer can reach the buffer while holding the writer lock */
+    drain_inbox(mb);
+
     struct list_head *p, *n;
-    purc_rwlock_writer_lock(&mb->lock);
     pcvariant_use_move_heap();
     list_for_each_safe(p, n, &mb->msgs) {
 
@@ -297,10 +456,8 @@ purc_inst_destroy_move_buffer(void)
         nr++;
     }
     pcvariant_use_norm_heap();
-    purc_rwlock_writer_unlock(&mb->lock);
 
     pcutils_sorted_array_remove(mb_atom2buff_map, (void *)(uintptr_t)atom);
-    purc_rwlock_clear(&mb->lock);
     free(mb);
 
 done:
@@ -314,6 +471,114 @@ done:
     return nr;
 }
 
+/*
+ * The data of a broadcast message is frozen once in the binary format of
+ * variant, and each recipient but the last one gets an envelope whose data
+ * is a native variant referring to the shared frozen payload, instead of a
+ * deep clone made in the move heap. The recipient restores its own copy of
+ * the data when taking the envelope away, so a change made by a recipient
+ * never affects the others.
+ */
+struct frozen_payload {
+    atomic_uint         refc;
+    size_t              len;
+    void               *bytes;
+};
+
+static void
+frozen_payload_unref(struct frozen_payload *frozen)
+{
+    if (atomic_fetch_sub(&frozen->refc, 1) == 1) {
+        free(frozen->bytes);
+        free(frozen);
+    }
+}
+
+static void
+on_release_frozen_payload(void *native_entity)
+{
+    frozen_payload_unref(native_entity);
+}
+
+static struct purc_native_ops frozen_payload_ops = {
+    .on_release = on_release_frozen_payload,
+};
+
+static struct frozen_payload *
+freeze_payload(purc_variant_t data)
+{
+    struct frozen_payload *frozen = NULL;
+    purc_rwstream_t rws = purc_rwstream_new_buffer(0, 0);
+    if (rws == NULL)
+        goto failed;
+
+    /* NOTE: the data containing dynamic or native values is cloned instead */
+    if (pcvariant_serialize_binary_strict(data, rws) < 0)
+        goto failed;
+
+    if ((frozen = malloc(sizeof(*frozen))) == NULL)
+        goto failed;
+
+    atomic_init(&frozen->refc, 1);
+    frozen->bytes = purc_rwstream_get_mem_buffer_ex(rws, &frozen->len,
+            NULL, true);
+    if (frozen->bytes == NULL)
+        goto failed;
+
+    purc_rwstream_destroy(rws);
+    return frozen;
+
+failed:
+    free(frozen);
+    if (rws)
+        purc_rwstream_destroy(rws);
+    purc_clr_error();
+    return NULL;
+}
+
+static pcrdr_msg *
+make_envelope(pcrdr_msg *msg, struct frozen_payload *frozen)
+{
+    pcrdr_msg *envelope = pcrdr_clone_message(msg);
+    if (envelope == NULL)
+        return NULL;
+
+    purc_variant_t data = purc_variant_make_native(frozen, &frozen_payload_ops);
+    if (data) {
+        atomic_fetch_add(&frozen->refc, 1);
+        purc_variant_unref(envelope->data);
+        envelope->data = data;
+    }
+
+    return envelope;
+}
+
+/* restores the data of an envelope in the heap of the current instance */
+static void
+thaw_payload(pcrdr_msg *msg)
+{
+    struct frozen_payload *frozen;
+    frozen = purc_variant_native_get_entity(msg->data);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mem(frozen->bytes,
+            frozen->len);
+    purc_variant_t data = PURC_VARIANT_INVALID;
+    if (rws) {
+        data = purc_variant_load_from_binary(rws);
+        purc_rwstream_destroy(rws);
+    }
+
+    if (data == PURC_VARIANT_INVALID) {
+        PC_ERROR("failed to restore the data of a broadcast message: %p\n",
+                msg);
+        purc_clr_error();
+        data = purc_variant_make_null();
+    }
+
+    purc_variant_unref(msg->data);
+    msg->data = data;
+}
+
 static void
 do_move_message(struct pcinst* inst, pcrdr_msg *msg)
 {
@@ -322,9 +587,8 @@ do_move_message(struct pcinst* inst, pcrdr_msg *msg)
     atomic_fetch_add(&hdr->refcnt, 1);
     hdr->origin = inst->endpoint_atom;
 
-    for (int i = 0; i < PCRDR_NR_MSG_VARIANTS; i++) {
-        if (msg->variants[i])
-            msg->variants[i] = pcvariant_move_heap_in(msg->variants[i]);
+    if (pcvariant_move_heap_in_n(msg->variants, PCRDR_NR_MSG_VARIANTS)) {
+        PC_ERROR("failed to move in some variants of a message: %p\n", msg);
     }
 }
 
@@ -332,9 +596,11 @@ static void
 do_take_message(struct pcinst* inst, pcrdr_msg *msg)
 {
     (void)inst;
-    for (int i = 0; i < PCRDR_NR_MSG_VARIANTS; i++) {
-        if (msg->variants[i])
-            msg->variants[i] = pcvariant_move_heap_out(msg->variants[i]);
+    pcvariant_move_heap_out_n(msg->variants, PCRDR_NR_MSG_VARIANTS);
+
+    if (msg->data && purc_variant_is_native(msg->data) &&
+            purc_variant_native_get_ops(msg->data) == &frozen_payload_ops) {
+        thaw_payload(msg);
     }
 }
 
@@ -364,28 +630,27 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
             goto done;
         }
 
-        if (mb->nr_msgs >= mb->max_nr_msgs) {
+        if (!reserve_message(mb)) {
             errcode = PURC_ERROR_TOO_SMALL_BUFF;
             goto done;
         }
 
         do_move_message(inst, msg);
-
-        purc_rwlock_writer_lock(&mb->lock);
-        struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)msg;
-        list_add_tail(&hdr->ln, &mb->msgs);
-        mb->nr_msgs++;
-        purc_rwlock_writer_unlock(&mb->lock);
-
+        push_message(mb, msg);
         nr++;
     }
     else {
         size_t count = pcutils_sorted_array_count(mb_atom2buff_map);
 
+        struct frozen_payload *frozen = NULL;
+        if (count > 1 && msg->data && IS_CONTAINER(msg->data->type)) {
+            frozen = freeze_payload(msg->data);
+        }
+
         for (size_t i = 0; i < count; i++) {
             pcutils_sorted_array_get(mb_atom2buff_map, i, (void **)&mb);
             if (mb->flags & PCINST_MOVE_BUFFER_BROADCAST &&
-                    mb->nr_msgs < mb->max_nr_msgs) {
+                    reserve_message(mb)) {
 
                 pcrdr_msg *my_msg;
 
@@ -394,26 +659,29 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
                     do_move_message(inst, msg);
                 }
                 else {
-                    my_msg = pcrdr_clone_message(msg);
+                    if (frozen)
+                        my_msg = make_envelope(msg, frozen);
+                    else
+                        my_msg = pcrdr_clone_message(msg);
                     if (my_msg) {
                         do_move_message(inst, my_msg);
                         pcrdr_release_message(my_msg);
                     }
                     else {
+                        atomic_fetch_sub(&mb->nr_reserved, 1);
                         PC_ERROR("failed to clone message to broadcast: %p\n",
                                 msg);
                         break;
                     }
                 }
 
-                purc_rwlock_writer_lock(&mb->lock);
-                struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)my_msg;
-                list_add_tail(&hdr->ln, &mb->msgs);
-                mb->nr_msgs++;
-                purc_rwlock_writer_unlock(&mb->lock);
+                push_message(mb, my_msg);
                 nr++;
             }
         }
+
+        if (frozen)
+            frozen_payload_unref(frozen);
     }
 
 done:
@@ -446,7 +714,8 @@ purc_inst_holding_messages_count(size_t *nr)
         goto done;
     }
 
-    /* no need to lock the buffer */
+    /* only the owner accesses the list */
+    drain_inbox(mb);
     *nr = mb->nr_msgs;
 
 done:
@@ -478,7 +747,7 @@ purc_inst_retrieve_message(size_t index)
         goto done;
     }
 
-    purc_rwlock_reader_lock(&mb->lock);
+    drain_inbox(mb);
     if (index < mb->nr_msgs) {
         struct list_head *p;
         struct pcrdr_msg_hdr *hdr;
@@ -494,7 +763,6 @@ purc_inst_retrieve_message(size_t index)
             i++;
         }
     }
-    purc_rwlock_reader_unlock(&mb->lock);
 
 done:
     purc_rwlock_reader_unlock(&mb_lock);
@@ -527,8 +795,17 @@ purc_inst_take_away_message(size_t index)
         goto done;
     }
 
-    purc_rwlock_writer_lock(&mb->lock);
-    if (index < mb->nr_msgs) {
+    drain_inbox(mb);
+    if (index == 0 && mb->nr_msgs > 0) {
+        /* the fast path for taking the messages in the order of arrival */
+        struct pcrdr_msg_hdr *hdr;
+        hdr = list_first_entry(&mb->msgs, struct pcrdr_msg_hdr, ln);
+        msg = (pcrdr_msg *)hdr;
+        list_del(&hdr->ln);
+        hdr->ln.next = hdr->ln.prev = NULL; /* mark as not linked */
+        mb->nr_msgs--;
+    }
+    else if (index < mb->nr_msgs) {
         struct list_head *p, *n;
         struct pcrdr_msg_hdr *hdr;
         size_t i = 0;
@@ -549,10 +826,11 @@ purc_inst_take_away_message(size_t index)
     else {
         errcode = PURC_ERROR_NOT_EXISTS;
     }
-    purc_rwlock_writer_unlock(&mb->lock);
 
-    if (msg)
+    if (msg) {
+        atomic_fetch_sub(&mb->nr_reserved, 1);
         do_take_message(inst, msg);
+    }
 
 done:
     purc_rwlock_reader_unlock(&mb_lock);
@@ -611,6 +889,20 @@ pcinst_put_message(pcrdr_msg *msg)
 #endif
 }
 
+size_t
+pcinst_trim_message_pool(size_t nr_keep)
+{
+    UNUSED_PARAM(nr_keep);
+    return 0;
+}
+
+void
+pcinst_get_message_pool_stat(size_t *nr_hits, size_t *nr_misses)
+{
+    *nr_hits = 0;
+    *nr_misses = 0;
+}
+
 size_t
 purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
 {
@@ -650,6 +942,11 @@ struct pcmodule _module_mvbuf = {
     .module_inited   = 0,
 
     .init_once       = mvbuf_init_once,
+#if HAVE(STDATOMIC_H)
+    .init_instance   = mvbuf_init_instance,
+    .cleanup_instance = mvbuf_cleanup_instance,
+#else
     .init_instance   = NULL,
+#endif
 };
 
@@ -30,13 +30,94 @@
 #include "private/utils.h"
 #include "private/variant.h"
 #include "private/msg-queue.h"
+#include "private/debug.h"
 
 #if HAVE(GLIB)
     #include <gmodule.h>
 #endif
 
+#include <pthread.h>
 #include <sys/time.h>
 
+static const char *lane_names[PCINST_MSG_LANE_NR] = {
+    "input",
+    "renderer",
+    "timer",
+    "data",
+    "other",
+};
+
+/* the lanes in the order to take the events */
+static enum pcinst_msg_lane lane_order[PCINST_MSG_LANE_NR] = {
+    PCINST_MSG_LANE_INPUT,
+    PCINST_MSG_LANE_RENDERER,
+    PCINST_MSG_LANE_OTHER,
+    PCINST_MSG_LANE_TIMER,
+    PCINST_MSG_LANE_DATA,
+};
+
+/* all events in one lane if true */
+static bool lanes_fifo;
+
+static pthread_once_t lanes_once = PTHREAD_ONCE_INIT;
+
+static int
+lane_by_name(const char *name, size_t len)
+{
+    for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+        if (strlen(lane_names[i]) == len &&
+                strncmp(lane_names[i], name, len) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+static void
+init_lanes_from_env(void)
+{
+    const char *env = getenv(PURC_ENVV_EVENT_LANES);
+    if (env == NULL || env[0] == '\0')
+        return;
+
+    if (strcmp(env, "fifo") == 0) {
+        lanes_fifo = true;
+        return;
+    }
+
+    enum pcinst_msg_lane order[PCINST_MSG_LANE_NR];
+    bool listed[PCINST_MSG_LANE_NR] = { };
+    size_t n = 0;
+
+    const char *p = env;
+    while (*p) {
+        size_t len = strcspn(p, ",");
+        int lane = lane_by_name(p, len);
+        if (lane >= 0 && !listed[lane]) {
+            order[n++] = (enum pcinst_msg_lane)lane;
+            listed[lane] = true;
+        }
+
+        p += len;
+        if (*p == ',')
+            p++;
+    }
+
+    /* the lanes not listed follow in the default order */
+    for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+        if (!listed[lane_order[i]])
+            order[n++] = lane_order[i];
+    }
+
+    memcpy(lane_order, order, sizeof(lane_order));
+}
+
+const char *
+pcinst_msg_lane_name(enum pcinst_msg_lane lane)
+{
+    return (lane < PCINST_MSG_LANE_NR) ? lane_names[lane] : NULL;
+}
+
 struct pcinst_msg_queue *
 pcinst_msg_queue_create(void)
 {
@@ -53,14 +134,24 @@ pcinst_msg_queue_create(void)
         errcode = PURC_ERROR_BAD_SYSTEM_CALL;
         goto done;
     }
+    purc_rwlock_set_name(&queue->lock, "msg-queue");
 
+    queue->reducible_events = NULL;
     queue->state = 0;
     queue->nr_msgs = 0;
+    queue->nr_ignored = 0;
+    queue->nr_overlaid = 0;
     list_head_init(&queue->req_msgs);
     list_head_init(&queue->res_msgs);
-    list_head_init(&queue->event_msgs);
+    for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+        list_head_init(&queue->event_msgs[i]);
+        queue->nr_events[i] = 0;
+        queue->max_events[i] = 0;
+    }
     list_head_init(&queue->void_msgs);
 
+    pthread_once(&lanes_once, init_lanes_from_env);
+
 done:
 
     if (errcode) {
@@ -101,10 +192,24 @@ pcinst_msg_queue_destroy(struct pcinst_msg_queue *queue)
 
     nr += grind_msg_list(&queue->req_msgs);
     nr += grind_msg_list(&queue->res_msgs);
-    nr += grind_msg_list(&queue->event_msgs);
+    for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+        nr += grind_msg_list(&queue->event_msgs[i]);
+        queue->nr_events[i] = 0;
+    }
     nr += grind_msg_list(&queue->void_msgs);
     queue->nr_msgs -= nr;
 
+    if (queue->reducible_events) {
+        pcutils_uomap_destroy(queue->reducible_events);
+        queue->reducible_events = NULL;
+    }
+
+    if (queue->nr_ignored || queue->nr_overlaid) {
+        PC_DEBUG("Events reduced in queue %p: %u ignored, %u overlaid\n",
+                queue, (unsigned)queue->nr_ignored,
+                (unsigned)queue->nr_overlaid);
+    }
+
     purc_rwlock_writer_unlock(&queue->lock);
 
     purc_rwlock_clear(&queue->lock);
@@ -126,6 +231,67 @@ is_event_match(pcrdr_msg *left, pcrdr_msg *right)
     return false;
 }
 
+/* the hash of a variant, consistent with purc_variant_is_equal_to() for
+   the types used as the element values and the event names */
+static uint32_t
+hash_variant(purc_variant_t v)
+{
+    if (v == PURC_VARIANT_INVALID)
+        return 0;
+
+    enum purc_variant_type type = purc_variant_get_type(v);
+    uint64_t u64 = 0;
+    switch (type) {
+    case PURC_VARIANT_TYPE_STRING:
+    case PURC_VARIANT_TYPE_ATOMSTRING:
+        return pchash_fnv1a_str_hash(purc_variant_get_string_const(v));
+
+    case PURC_VARIANT_TYPE_ULONGINT:
+        purc_variant_cast_to_ulongint(v, &u64, false);
+        break;
+
+    case PURC_VARIANT_TYPE_LONGINT: {
+        int64_t i64 = 0;
+        purc_variant_cast_to_longint(v, &i64, false);
+        u64 = (uint64_t)i64;
+        break;
+    }
+
+    default:
+        return (uint32_t)type;
+    }
+
+    return (uint32_t)(u64 ^ (u64 >> 32)) ^ (uint32_t)type;
+}
+
+static uint32_t
+hash_event(const void *key)
+{
+    const pcrdr_msg *msg = key;
+    uint32_t hash = hash_variant(msg->eventName);
+    hash = hash * 31 + hash_variant(msg->elementValue);
+    hash = hash * 31 + (uint32_t)msg->target;
+    hash = hash * 31 + (uint32_t)(msg->targetValue ^ (msg->targetValue >> 32));
+    return hash;
+}
+
+static int
+comp_event(const void *key1, const void *key2)
+{
+    return is_event_match((pcrdr_msg *)key1, (pcrdr_msg *)key2) ? 0 : 1;
+}
+
+/* called when a pending event leaves the queue */
+static void
+unindex_event(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
+{
+    if (msg->type == PCRDR_MSG_TYPE_EVENT &&
+            msg->reduceOpt != PCRDR_MSG_EVENT_REDUCE_OPT_KEEP &&
+            queue->reducible_events) {
+        pcutils_uomap_erase(queue->reducible_events, msg);
+    }
+}
+
 static uint64_t
 get_timestamp_us(void)
 {
@@ -134,44 +300,132 @@ get_timestamp_us(void)
     return (uint64_t)now.tv_sec * 1000000 + now.tv_usec;
 }
 
+static bool
+is_event_type(const char *name, size_t len, const char *type)
+{
+    return strlen(type) == len && strncmp(name, type, len) == 0;
+}
+
+/* the events on the elements are posted by the handler of the renderer
+   with the native entities of the elements or the `#id` strings */
+static bool
+is_on_element(purc_variant_t elem)
+{
+    if (elem == PURC_VARIANT_INVALID)
+        return false;
+
+    if (purc_variant_is_native(elem))
+        return purc_variant_native_get_ops(elem) == NULL;
+
+    if (purc_variant_is_string(elem)) {
+        const char *str = purc_variant_get_string_const(elem);
+        return str && str[0] == '#';
+    }
+
+    return false;
+}
+
+static enum pcinst_msg_lane
+lane_of_event(const pcrdr_msg *msg)
+{
+    if (lanes_fifo || msg->eventName == PURC_VARIANT_INVALID ||
+            !purc_variant_is_string(msg->eventName))
+        return PCINST_MSG_LANE_OTHER;
+
+    if (is_on_element(msg->elementValue))
+        return PCINST_MSG_LANE_INPUT;
+
+    const char *name = purc_variant_get_string_const(msg->eventName);
+    size_t len = strcspn(name, ":");
+    if (is_event_type(name, len, MSG_TYPE_EXPIRED))
+        return PCINST_MSG_LANE_TIMER;
+
+    if (is_event_type(name, len, MSG_TYPE_CHANGE) ||
+            is_event_type(name, len, MSG_TYPE_GROW) ||
+            is_event_type(name, len, MSG_TYPE_SHRINK))
+        return PCINST_MSG_LANE_DATA;
+
+    if (is_event_type(name, len, MSG_TYPE_RDR_STATE) ||
+            is_event_type(name, len, MSG_TYPE_NEW_RENDERER))
+        return PCINST_MSG_LANE_RENDERER;
+
+    return PCINST_MSG_LANE_OTHER;
+}
+
+static void
+add_event(struct pcinst_msg_queue *queue, pcrdr_msg *msg, bool tail)
+{
+    struct pcinst_msg_hdr *hdr = (struct pcinst_msg_hdr *)msg;
+    enum pcinst_msg_lane lane = lane_of_event(msg);
+
+    if (tail) {
+        list_add_tail(&hdr->ln, &queue->event_msgs[lane]);
+    }
+    else {
+        list_add(&hdr->ln, &queue->event_msgs[lane]);
+    }
+
+    queue->state |= MSG_QS_EVENT;
+    queue->nr_msgs++;
+    if (++queue->nr_events[lane] > queue->max_events[lane])
+        queue->max_events[lane] = queue->nr_events[lane];
+}
+
+static void
+del_event(struct pcinst_msg_queue *queue, pcrdr_msg *msg,
+        enum pcinst_msg_lane lane)
+{
+    struct pcinst_msg_hdr *hdr = (struct pcinst_msg_hdr *)msg;
+
+    list_del(&hdr->ln);
+    unindex_event(queue, msg);
+    queue->nr_msgs--;
+    queue->nr_events[lane]--;
+}
+
 int
 reduce_event(struct pcinst_msg_queue *queue, pcrdr_msg *msg, bool tail)
 {
-    struct pcinst_msg_hdr *hdr;
-    struct list_head *p, *n;
-    list_for_each_safe(p, n, &queue->event_msgs) {
-        hdr = list_entry(p, struct pcinst_msg_hdr, ln);
-        pcrdr_msg *orig = (pcrdr_msg*) hdr;
-        if (is_event_match(orig, msg)) {
-            if (msg->reduceOpt == PCRDR_MSG_EVENT_REDUCE_OPT_IGNORE) {
-                pcrdr_release_message(msg);
-                return 0;
-            }
-            // OVERLAY : data
-            if (orig->data) {
-                purc_variant_unref(orig->data);
-                orig->data = PURC_VARIANT_INVALID;
-            }
-            if (msg->data) {
-                orig->data = msg->data;
-                purc_variant_ref(orig->data);
-            }
+    if (queue->reducible_events == NULL) {
+        queue->reducible_events = pcutils_uomap_create(NULL, NULL, NULL, NULL,
+                hash_event, comp_event, false, false);
+    }
+
+    pcutils_uomap_entry *entry = NULL;
+    if (queue->reducible_events) {
+        entry = pcutils_uomap_find(queue->reducible_events, msg);
+    }
+
+    if (entry) {
+        pcrdr_msg *orig = (pcrdr_msg *)pcutils_uomap_entry_key(entry);
+        if (msg->reduceOpt == PCRDR_MSG_EVENT_REDUCE_OPT_IGNORE) {
+            queue->nr_ignored++;
             pcrdr_release_message(msg);
             return 0;
         }
+        // OVERLAY : data
+        if (orig->data) {
+            purc_variant_unref(orig->data);
+            orig->data = PURC_VARIANT_INVALID;
+        }
+        if (msg->data) {
+            orig->data = msg->data;
+            purc_variant_ref(orig->data);
+        }
+        queue->nr_overlaid++;
+        pcrdr_release_message(msg);
+        return 0;
+    }
+
+    /* NOTE: not indexed if failed to create the index; never reduced */
+    if (queue->reducible_events &&
+            pcutils_uomap_insert(queue->reducible_events, msg, NULL)) {
+        purc_clr_error();
     }
 
-    hdr = (struct pcinst_msg_hdr *)msg;
     /* keep timestamp */
     msg->resultValue = get_timestamp_us();
-    if (tail) {
-        list_add_tail(&hdr->ln, &queue->event_msgs);
-    }
-    else {
-        list_add(&hdr->ln, &queue->event_msgs);
-    }
-    queue->state |= MSG_QS_EVENT;
-    queue->nr_msgs++;
+    add_event(queue, msg, tail);
 
     return 0;
 }
@@ -203,13 +457,10 @@ pcinst_msg_queue_append(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
         break;
 
     case PCRDR_MSG_TYPE_EVENT:
-        queue->state |= MSG_QS_EVENT;
         if (msg->reduceOpt == PCRDR_MSG_EVENT_REDUCE_OPT_KEEP) {
             /* keep timestamp */
             msg->resultValue = get_timestamp_us();
-            list_add_tail(&hdr->ln, &queue->event_msgs);
-            queue->state |= MSG_QS_EVENT;
-            queue->nr_msgs++;
+            add_event(queue, msg, true);
         }
         else {
             reduce_event(queue, msg, true);
@@ -254,11 +505,8 @@ pcinst_msg_queue_prepend(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
         break;
 
     case PCRDR_MSG_TYPE_EVENT:
-        queue->state |= MSG_QS_EVENT;
         if (msg->reduceOpt == PCRDR_MSG_EVENT_REDUCE_OPT_KEEP) {
-            list_add(&hdr->ln, &queue->event_msgs);
-            queue->state |= MSG_QS_EVENT;
-            queue->nr_msgs++;
+            add_event(queue, msg, false);
         }
         else {
             reduce_event(queue, msg, false);
@@ -277,9 +525,11 @@ pcinst_msg_queue_prepend(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
 }
 
 static pcrdr_msg *
-get_msg(struct pcinst_msg_queue *queue, struct list_head *msgs)
+get_msg(struct pcinst_msg_queue *queue, struct list_head *msgs,
+        uint64_t flag)
 {
     if (list_empty(msgs)) {
+        queue->state &= ~flag;
         return NULL;
     }
     struct pcinst_msg_hdr *hdr = list_first_entry(msgs,
@@ -288,8 +538,63 @@ get_msg(struct pcinst_msg_queue *queue, struct list_head *msgs)
     list_del(&hdr->ln);
     queue->nr_msgs--;
     if (list_empty(msgs)) {
-        queue->state &= ~MSG_QS_RES;
+        queue->state &= ~flag;
+    }
+    return msg;
+}
+
+static pcrdr_msg *
+first_event(struct pcinst_msg_queue *queue, enum pcinst_msg_lane lane)
+{
+    struct list_head *msgs = &queue->event_msgs[lane];
+    if (list_empty(msgs))
+        return NULL;
+
+    return (pcrdr_msg *)list_first_entry(msgs, struct pcinst_msg_hdr, ln);
+}
+
+/* takes the event from the first lane in order, unless the oldest event
+   of a later lane has waited too long */
+static pcrdr_msg *
+get_event(struct pcinst_msg_queue *queue)
+{
+    pcrdr_msg *msg = NULL;
+    enum pcinst_msg_lane from = PCINST_MSG_LANE_NR;
+    uint64_t now = 0;
+
+    for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+        enum pcinst_msg_lane lane = lane_order[i];
+        pcrdr_msg *first = first_event(queue, lane);
+        if (first == NULL)
+            continue;
+
+        if (msg == NULL) {
+            msg = first;
+            from = lane;
+            continue;
+        }
+
+        if (now == 0)
+            now = get_timestamp_us();
+        if (first->resultValue + PCINST_MSG_LANE_MAX_DELAY < now &&
+                first->resultValue < msg->resultValue) {
+            msg = first;
+            from = lane;
+        }
+    }
+
+    if (msg == NULL) {
+        queue->state &= ~MSG_QS_EVENT;
+        return NULL;
     }
+
+    del_event(queue, msg, from);
+    for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+        if (!list_empty(&queue->event_msgs[i]))
+            return msg;
+    }
+
+    queue->state &= ~MSG_QS_EVENT;
     return msg;
 }
 
@@ -299,28 +604,28 @@ pcinst_msg_queue_get_msg(struct pcinst_msg_queue *queue)
     purc_rwlock_writer_lock(&queue->lock);
     pcrdr_msg *msg = NULL;
     if (queue->state & MSG_QS_RES) {
-        msg = get_msg(queue, &queue->res_msgs);
+        msg = get_msg(queue, &queue->res_msgs, MSG_QS_RES);
         if (msg) {
             goto done;
         }
     }
 
     if (queue->state & MSG_QS_REQ) {
-        msg = get_msg(queue, &queue->req_msgs);
+        msg = get_msg(queue, &queue->req_msgs, MSG_QS_REQ);
         if (msg) {
             goto done;
         }
     }
 
     if (queue->state & MSG_QS_EVENT) {
-        msg = get_msg(queue, &queue->event_msgs);
+        msg = get_event(queue);
         if (msg) {
             goto done;
         }
     }
 
     if (queue->state & MSG_QS_VOID) {
-        msg = get_msg(queue, &queue->void_msgs);
+        msg = get_msg(queue, &queue->void_msgs, MSG_QS_VOID);
         if (msg) {
             goto done;
         }
@@ -339,18 +644,21 @@ pcinst_msg_queue_get_event_by_element(struct pcinst_msg_queue *queue,
     pcrdr_msg *msg = NULL;
     purc_rwlock_writer_lock(&queue->lock);
 
-    struct list_head *msgs = &queue->event_msgs;
-    struct list_head *p, *n;
-    list_for_each_safe(p, n, msgs) {
-        struct pcinst_msg_hdr *hdr;
-        hdr = list_entry(p, struct pcinst_msg_hdr, ln);
-        pcrdr_msg *m = (pcrdr_msg*) hdr;
-        if (purc_variant_is_equal_to(m->requestId, request_id) &&
-                purc_variant_is_equal_to(m->elementValue, element_value) &&
-                purc_variant_is_equal_to(m->eventName, event_name)) {
-            msg = m;
-            list_del(&hdr->ln);
-            break;
+    for (int i = 0; i < PCINST_MSG_LANE_NR && msg == NULL; i++) {
+        struct list_head *msgs = &queue->event_msgs[i];
+        struct list_head *p, *n;
+        list_for_each_safe(p, n, msgs) {
+            struct pcinst_msg_hdr *hdr;
+            hdr = list_entry(p, struct pcinst_msg_hdr, ln);
+            pcrdr_msg *m = (pcrdr_msg*) hdr;
+            if (purc_variant_is_equal_to(m->requestId, request_id) &&
+                    purc_variant_is_equal_to(m->elementValue,
+                        element_value) &&
+                    purc_variant_is_equal_to(m->eventName, event_name)) {
+                msg = m;
+                del_event(queue, msg, (enum pcinst_msg_lane)i);
+                break;
+            }
         }
     }
 
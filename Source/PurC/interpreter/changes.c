@@ -0,0 +1,218 @@
+/*
+ * @file changes.c
+ * @date 2026/10/14
+ * @brief The change events of the observed variables coalesced in a step.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "internal.h"
+
+#include "private/errors.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "private/var-mgr.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define KEY_COUNT               "count"
+
+/*
+ * The listeners of the observed containers and named variables do not post
+ * an event for every mutation; the mutations made in a step of the running
+ * coroutine are kept here, the ones on the same variable with the same
+ * event merged, and the events are posted when the coroutine leaves the
+ * running state. The data of an event is an object, in which `count` is the
+ * number of the mutations merged.
+ */
+struct pcintr_change {
+    struct list_head            ln;         // in pcintr_coroutine::changes
+    purc_atom_t                 cid;        // the coroutine to notify
+    pcrdr_msg_event_reduce_opt  reduce_op;
+
+    /* the container mutated, or the named variable of the manager */
+    purc_variant_t              source;
+    pcvarmgr_t                  mgr;
+    char                       *name;
+
+    /* static strings */
+    const char                 *type;
+    const char                 *sub_type;
+
+    size_t                      count;
+};
+
+static bool
+is_same_change(struct pcintr_change *change, purc_atom_t cid,
+        purc_variant_t source, pcvarmgr_t mgr, const char *name,
+        const char *type, const char *sub_type)
+{
+    if (change->cid != cid || change->source != source ||
+            change->mgr != mgr || change->type != type ||
+            change->sub_type != sub_type)
+        return false;
+
+    if (name)
+        return change->name && strcmp(change->name, name) == 0;
+    return change->name == NULL;
+}
+
+static struct pcintr_change *
+find_change(pcintr_coroutine_t co, purc_atom_t cid,
+        purc_variant_t source, pcvarmgr_t mgr, const char *name,
+        const char *type, const char *sub_type)
+{
+    struct pcintr_change *p;
+
+    /* the last one first, for a loop usually mutates the same variable */
+    list_for_each_entry_reverse(p, &co->changes, ln) {
+        if (is_same_change(p, cid, source, mgr, name, type, sub_type))
+            return p;
+    }
+
+    return NULL;
+}
+
+static void
+free_change(struct pcintr_change *change)
+{
+    list_del(&change->ln);
+    PURC_VARIANT_SAFE_CLEAR(change->source);
+    if (change->name)
+        free(change->name);
+    free(change);
+}
+
+static int
+post_change(purc_atom_t cid, pcrdr_msg_event_reduce_opt reduce_op,
+        purc_variant_t source, pcvarmgr_t mgr, const char *name,
+        const char *type, const char *sub_type, size_t count)
+{
+    purc_variant_t elem;
+    if (mgr) {
+        elem = pcvarmgr_build_event_observed(name, mgr);
+    }
+    else {
+        elem = purc_variant_ref(source);
+    }
+
+    if (elem == PURC_VARIANT_INVALID)
+        return -1;
+
+    purc_variant_t data = purc_variant_make_object_0();
+    if (data) {
+        purc_variant_t v = purc_variant_make_ulongint(count);
+        if (v) {
+            purc_variant_object_set_by_static_ckey(data, KEY_COUNT, v);
+            purc_variant_unref(v);
+        }
+    }
+
+    int ret = pcintr_coroutine_post_event(cid, reduce_op, elem,
+            type, sub_type, data, PURC_VARIANT_INVALID);
+    PURC_VARIANT_SAFE_CLEAR(data);
+    purc_variant_unref(elem);
+    return ret;
+}
+
+static int
+queue_change(purc_atom_t cid, pcrdr_msg_event_reduce_opt reduce_op,
+        purc_variant_t source, pcvarmgr_t mgr, const char *name,
+        const char *type, const char *sub_type)
+{
+    pcintr_coroutine_t co = pcintr_get_coroutine();
+    if (co == NULL || co->changes.next == NULL) {
+        /* not in a step; post it right now */
+        return post_change(cid, reduce_op, source, mgr, name,
+                type, sub_type, 1);
+    }
+
+    struct pcintr_change *change = find_change(co, cid, source, mgr, name,
+            type, sub_type);
+    if (change) {
+        change->count++;
+        return 0;
+    }
+
+    change = calloc(1, sizeof(*change));
+    if (change == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    if (name) {
+        change->name = strdup(name);
+        if (change->name == NULL) {
+            free(change);
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+    }
+
+    change->cid = cid;
+    change->reduce_op = reduce_op;
+    change->source = source ? purc_variant_ref(source) : PURC_VARIANT_INVALID;
+    change->mgr = mgr;
+    change->type = type;
+    change->sub_type = sub_type;
+    change->count = 1;
+    list_add_tail(&change->ln, &co->changes);
+    return 0;
+}
+
+int
+pcintr_post_variant_change(purc_atom_t cid, purc_variant_t source,
+        const char *type)
+{
+    return queue_change(cid, PCRDR_MSG_EVENT_REDUCE_OPT_IGNORE,
+            source, NULL, NULL, type, NULL);
+}
+
+int
+pcintr_post_named_var_change(purc_atom_t cid, pcvarmgr_t mgr,
+        const char *name, const char *sub_type)
+{
+    return queue_change(cid, PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY,
+            PURC_VARIANT_INVALID, mgr, name, MSG_TYPE_CHANGE, sub_type);
+}
+
+void
+pcintr_flush_changes(pcintr_coroutine_t co)
+{
+    struct pcintr_change *p, *n;
+
+    /* NOTE: posting an event does not mutate any variable */
+    list_for_each_entry_safe(p, n, &co->changes, ln) {
+        post_change(p->cid, p->reduce_op, p->source, p->mgr, p->name,
+                p->type, p->sub_type, p->count);
+        free_change(p);
+    }
+}
+
+void
+pcintr_destroy_changes(pcintr_coroutine_t co)
+{
+    if (co->changes.next == NULL)
+        return;
+
+    pcintr_flush_changes(co);
+}
@@ -31,9 +31,13 @@
 #include "private/channel.h"
 #include "private/instance.h"
 #include "private/interpreter.h"
+#include "private/variant.h"
+#include "internal.h"
 
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #define MSG_TYPE_SENDABLE       "sendable"
 #define MSG_TYPE_RECEIVABLE     "receivable"
@@ -113,10 +117,411 @@ out:
     return ret;
 }
 
+/*
+ * The shared channels.
+ *
+ * A shared channel is a bounded MPMC ring of variants living in the move
+ * heap, which can be used by the coroutines of different runners without
+ * any lock and any message: a sender reserves the free cells of a batch
+ * with a single CAS on the send position, fills them, and publishes them
+ * by advancing the sequence numbers of the cells; a receiver does the same
+ * with the receive position.
+ *
+ * Every runner attaching to a shared channel has a local `struct pcchan`
+ * in its map as a proxy, which holds the lists of the waiting coroutines of
+ * the runner. A runner is woken up by a MSG_TYPE_WAKEUP_CHAN event only when
+ * it has coroutines waiting for the channel, so a producer does not post
+ * any event for the items received by a busy consumer.
+ */
+
+/* the number of the variants of a batch buffered on the stack */
+#define NR_BATCH_ON_STACK       16
+
+struct pcchan_cell {
+    /* the cell is free for the sender at position `seq`, and ready
+       for the receiver at position `seq - 1`. */
+    atomic_uint_fast64_t    seq;
+    purc_variant_t          vrt;
+};
+
+struct pcchan_waiters {
+    purc_atom_t    *atoms;
+    size_t          nr;
+    size_t          sz;
+};
+
+struct pcchan_shared {
+    struct pcchan_shared   *next;
+
+    /* the instances attached to this channel; guarded by shared_lock */
+    unsigned int            refc;
+    unsigned int            qsize;
+    atomic_bool             closed;
+
+    /* the numbers of the runners waiting to send and to receive */
+    atomic_size_t           nr_send_waiters;
+    atomic_size_t           nr_recv_waiters;
+
+    /* guards the waiters */
+    pthread_mutex_t         lock;
+    struct pcchan_waiters   send_waiters;
+    struct pcchan_waiters   recv_waiters;
+
+    /* keep the positions of the senders and the receivers apart */
+    char                    _pad0[64];
+    atomic_uint_fast64_t    sendx;
+    char                    _pad1[64];
+    atomic_uint_fast64_t    recvx;
+    char                    _pad2[64];
+
+    struct pcchan_cell     *cells;
+    char                    name[];
+};
+
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct pcchan_shared *shared_chans;
+
+/* finds an open shared channel and references it; call with shared_lock */
+static struct pcchan_shared *
+find_shared(const char *chan_name)
+{
+    struct pcchan_shared *shared;
+    for (shared = shared_chans; shared; shared = shared->next) {
+        if (strcmp(shared->name, chan_name) == 0) {
+            shared->refc++;
+            return shared;
+        }
+    }
+
+    return NULL;
+}
+
+static struct pcchan_shared *
+attach_shared(const char *chan_name, unsigned int cap)
+{
+    struct pcchan_shared *shared;
+
+    pthread_mutex_lock(&shared_lock);
+    shared = find_shared(chan_name);
+    if (shared || cap == 0)
+        goto done;
+
+    size_t len = strlen(chan_name);
+    shared = calloc(1, sizeof(*shared) + len + 1);
+    if (shared == NULL)
+        goto done;
+
+    shared->cells = calloc(cap, sizeof(struct pcchan_cell));
+    if (shared->cells == NULL) {
+        free(shared);
+        shared = NULL;
+        goto done;
+    }
+
+    for (unsigned int i = 0; i < cap; i++) {
+        atomic_init(&shared->cells[i].seq, i);
+    }
+    atomic_init(&shared->sendx, 0);
+    atomic_init(&shared->recvx, 0);
+    atomic_init(&shared->closed, false);
+    atomic_init(&shared->nr_send_waiters, 0);
+    atomic_init(&shared->nr_recv_waiters, 0);
+    pthread_mutex_init(&shared->lock, NULL);
+
+    memcpy(shared->name, chan_name, len + 1);
+    shared->qsize = cap;
+    shared->refc = 1;
+    shared->next = shared_chans;
+    shared_chans = shared;
+
+done:
+    pthread_mutex_unlock(&shared_lock);
+    return shared;
+}
+
+/* removes the shared channel from the list, so no one can attach to it */
+static void
+unlink_shared(struct pcchan_shared *shared)
+{
+    struct pcchan_shared **pp;
+    for (pp = &shared_chans; *pp; pp = &(*pp)->next) {
+        if (*pp == shared) {
+            *pp = shared->next;
+            shared->next = NULL;
+            break;
+        }
+    }
+}
+
+static void
+release_shared(struct pcchan_shared *shared)
+{
+    pthread_mutex_lock(&shared_lock);
+    assert(shared->refc > 0);
+    unsigned int refc = --shared->refc;
+    if (refc == 0)
+        unlink_shared(shared);
+    pthread_mutex_unlock(&shared_lock);
+
+    if (refc > 0)
+        return;
+
+    /* the variants left in the ring live in the move heap */
+    uint64_t pos = atomic_load(&shared->recvx);
+    uint64_t end = atomic_load(&shared->sendx);
+    pcvariant_use_move_heap();
+    for (; pos < end; pos++) {
+        purc_variant_t vrt = shared->cells[pos % shared->qsize].vrt;
+        if (vrt)
+            purc_variant_unref(vrt);
+    }
+    pcvariant_use_norm_heap();
+
+    pthread_mutex_destroy(&shared->lock);
+    free(shared->send_waiters.atoms);
+    free(shared->recv_waiters.atoms);
+    free(shared->cells);
+    free(shared);
+}
+
+unsigned int
+pcchan_shared_length(struct pcchan_shared *shared)
+{
+    uint64_t recvx = atomic_load_explicit(&shared->recvx,
+            memory_order_relaxed);
+    uint64_t sendx = atomic_load_explicit(&shared->sendx,
+            memory_order_relaxed);
+
+    if (sendx <= recvx)
+        return 0;
+    if (sendx - recvx > shared->qsize)
+        return shared->qsize;
+    return (unsigned int)(sendx - recvx);
+}
+
+/*
+ * Reserves @n free cells for sending in one go.
+ * Returns false if there are not so many free cells.
+ */
+static bool
+reserve_cells_to_send(struct pcchan_shared *shared, size_t n,
+        uint64_t *pos_reserved)
+{
+    uint64_t pos = atomic_load_explicit(&shared->sendx, memory_order_relaxed);
+
+    for (;;) {
+        size_t i;
+        uint64_t seq = 0;
+        for (i = 0; i < n; i++) {
+            struct pcchan_cell *cell = shared->cells +
+                (pos + i) % shared->qsize;
+            seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+            if (seq != pos + i)
+                break;
+        }
+
+        if (i == n) {
+            if (atomic_compare_exchange_weak_explicit(&shared->sendx,
+                        &pos, pos + n,
+                        memory_order_relaxed, memory_order_relaxed)) {
+                *pos_reserved = pos;
+                return true;
+            }
+        }
+        else if ((int64_t)(seq - (pos + i)) < 0) {
+            /* not received yet: the ring is full */
+            return false;
+        }
+        else {
+            /* another sender went ahead */
+            pos = atomic_load_explicit(&shared->sendx, memory_order_relaxed);
+        }
+    }
+
+    return false;
+}
+
+static void
+publish_cells(struct pcchan_shared *shared, uint64_t pos,
+        purc_variant_t *vrts, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        struct pcchan_cell *cell = shared->cells + (pos + i) % shared->qsize;
+        cell->vrt = vrts[i];
+        atomic_store_explicit(&cell->seq, pos + i + 1, memory_order_release);
+    }
+}
+
+/*
+ * Takes at most @max_n ready cells in one go.
+ * Returns the number of the variants taken, zero if the ring is empty.
+ */
+static size_t
+take_cells(struct pcchan_shared *shared, purc_variant_t *vrts, size_t max_n)
+{
+    uint64_t pos = atomic_load_explicit(&shared->recvx, memory_order_relaxed);
+    size_t n;
+
+    for (;;) {
+        uint64_t seq = 0;
+        for (n = 0; n < max_n; n++) {
+            struct pcchan_cell *cell = shared->cells +
+                (pos + n) % shared->qsize;
+            seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+            if (seq != pos + n + 1)
+                break;
+        }
+
+        if (n > 0) {
+            if (atomic_compare_exchange_weak_explicit(&shared->recvx,
+                        &pos, pos + n,
+                        memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if ((int64_t)(seq - (pos + 1)) < 0) {
+            /* not sent yet: the ring is empty */
+            return 0;
+        }
+        else {
+            /* another receiver went ahead */
+            pos = atomic_load_explicit(&shared->recvx, memory_order_relaxed);
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        struct pcchan_cell *cell = shared->cells + (pos + i) % shared->qsize;
+        vrts[i] = cell->vrt;
+        cell->vrt = PURC_VARIANT_INVALID;
+        atomic_store_explicit(&cell->seq, pos + i + shared->qsize,
+                memory_order_release);
+    }
+
+    return n;
+}
+
+static void
+add_waiter(struct pcchan_shared *shared, struct pcchan_waiters *waiters,
+        atomic_size_t *nr_waiters, purc_atom_t atom)
+{
+    pthread_mutex_lock(&shared->lock);
+
+    size_t i;
+    for (i = 0; i < waiters->nr; i++) {
+        if (waiters->atoms[i] == atom)
+            break;
+    }
+
+    if (i == waiters->nr) {
+        if (waiters->nr == waiters->sz) {
+            size_t sz = waiters->sz ? waiters->sz * 2 : 4;
+            purc_atom_t *atoms = realloc(waiters->atoms, sizeof(*atoms) * sz);
+            if (atoms) {
+                waiters->atoms = atoms;
+                waiters->sz = sz;
+            }
+        }
+
+        /* NOTE: the waiter will be woken up only by the timeout
+           if it can not be recorded. */
+        if (waiters->nr < waiters->sz) {
+            waiters->atoms[waiters->nr++] = atom;
+        }
+    }
+
+    atomic_store(nr_waiters, waiters->nr);
+    pthread_mutex_unlock(&shared->lock);
+}
+
+static int
+post_wake_up(purc_atom_t rid, const char *chan_name)
+{
+    struct pcinst *inst = pcinst_current();
+    int ret = -1;
+
+    purc_variant_t source_uri = purc_variant_make_string(
+            inst->endpoint_name, false);
+    purc_variant_t request_id = pcintr_request_id_create(
+            PCINTR_REQUEST_ID_TYPE_CHAN, rid, 0, chan_name);
+    if (source_uri && request_id) {
+        ret = pcintr_post_event_by_ctype(rid, 0,
+                PCRDR_MSG_EVENT_REDUCE_OPT_KEEP, source_uri, request_id,
+                MSG_TYPE_WAKEUP_CHAN, NULL, PURC_VARIANT_INVALID,
+                request_id);
+    }
+
+    if (request_id)
+        purc_variant_unref(request_id);
+    if (source_uri)
+        purc_variant_unref(source_uri);
+    return ret;
+}
+
+/* wakes up the runners waiting for the channel; the caller must have
+   changed the ring (or closed the channel) before calling this. */
+static void
+wake_up_waiters(struct pcchan_shared *shared, struct pcchan_waiters *waiters,
+        atomic_size_t *nr_waiters)
+{
+    /* pairs with the fence in wait_for_shared() */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(nr_waiters, memory_order_relaxed) == 0)
+        return;
+
+    pthread_mutex_lock(&shared->lock);
+    purc_atom_t *atoms = waiters->atoms;
+    size_t nr = waiters->nr;
+    waiters->atoms = NULL;
+    waiters->nr = 0;
+    waiters->sz = 0;
+    atomic_store(nr_waiters, 0);
+    pthread_mutex_unlock(&shared->lock);
+
+    struct pcinst *inst = pcinst_current();
+    for (size_t i = 0; i < nr; i++) {
+        if (atoms[i] == inst->endpoint_atom)
+            pcchan_wake_up(shared->name);
+        else if (post_wake_up(atoms[i], shared->name))
+            /* the runner may have exited */
+            PC_DEBUG("failed to wake up runner %u for channel: %s\n",
+                    (unsigned)atoms[i], shared->name);
+    }
+
+    free(atoms);
+}
+
+/*
+ * Records the current runner as a waiter of the channel for sending @n
+ * variants or for receiving. Returns true if
+ * the channel became ready before the runner was recorded, in which case
+ * the caller should try again rather than wait.
+ */
+static bool
+wait_for_shared(struct pcchan_shared *shared, bool to_send, size_t n)
+{
+    struct pcinst *inst = pcinst_current();
+
+    if (to_send)
+        add_waiter(shared, &shared->send_waiters, &shared->nr_send_waiters,
+                inst->endpoint_atom);
+    else
+        add_waiter(shared, &shared->recv_waiters, &shared->nr_recv_waiters,
+                inst->endpoint_atom);
+
+    /* pairs with the fence in wake_up_waiters() */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    unsigned int len = pcchan_shared_length(shared);
+    return to_send ? (len + n <= shared->qsize) : (len > 0);
+}
+
 void
 pcchan_destroy(pcchan_t chan)
 {
-    if (chan->qsize > 0) {
+    if (chan->shared) {
+        /* other runners may still use the shared channel */
+        release_shared(chan->shared);
+    }
+    else if (chan->qsize > 0) {
         PC_WARN("destroying a channel not closed: %s (%u)\n",
                 chan->name, chan->qcount);
     }
@@ -194,6 +599,157 @@ pcchan_open(const char *chan_name, unsigned int cap)
     return chan;
 }
 
+/* makes the proxy of a shared channel for the current instance, or reuses
+   the closed channel of the same name; the reference of @shared is taken */
+static pcchan_t
+attach_proxy(pcintr_heap_t heap, const char *chan_name,
+        struct pcchan_shared *shared)
+{
+    pcutils_map_entry* entry;
+    pcchan_t chan;
+
+    entry = pcutils_map_find(heap->name_chan_map, chan_name);
+    if (entry) {
+        chan = entry->val;
+        assert(chan->qsize == 0 && chan->shared == NULL);
+        free(chan->data);
+        chan->data = NULL;
+    }
+    else {
+        chan = calloc(1, sizeof(*chan));
+        if (chan == NULL)
+            goto failed;
+
+        chan->name = strdup(chan_name);
+        if (chan->name == NULL ||
+                pcutils_map_insert(heap->name_chan_map, chan->name, chan)) {
+            free(chan->name);
+            free(chan);
+            goto failed;
+        }
+        chan->refc = 0;
+    }
+
+    chan->shared = shared;
+    chan->qsize = shared->qsize;
+    chan->qcount = 0;
+    chan->sendx = 0;
+    chan->recvx = 0;
+    list_head_init(&chan->send_crtns);
+    list_head_init(&chan->recv_crtns);
+    return chan;
+
+failed:
+    release_shared(shared);
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
+}
+
+pcchan_t
+pcchan_open_shared(const char *chan_name, unsigned int cap)
+{
+    struct pcinst* inst = pcinst_current();
+    if (UNLIKELY(inst == NULL || inst->intr_heap == NULL)) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return NULL;
+    }
+
+    if (UNLIKELY(chan_name == NULL || chan_name[0] == '\0' || cap == 0)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    pcintr_heap_t heap = inst->intr_heap;
+    pcutils_map_entry* entry;
+
+    entry = pcutils_map_find(heap->name_chan_map, chan_name);
+    if (entry && ((pcchan_t)entry->val)->qsize > 0) {
+        purc_set_error(PURC_ERROR_EXISTS);
+        return NULL;
+    }
+
+    struct pcchan_shared *shared = attach_shared(chan_name, cap);
+    if (shared == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    return attach_proxy(heap, chan_name, shared);
+}
+
+/* resumes at most @nr coroutines in the list */
+static void
+resume_waiting_crtns(struct list_head *crtns, size_t nr)
+{
+    struct list_head *p, *n;
+    list_for_each_safe(p, n, crtns) {
+        if (nr == 0)
+            break;
+
+        struct pcintr_coroutine *crtn;
+        crtn = list_entry(p, struct pcintr_coroutine, ln_stopped);
+        pcintr_resume_coroutine(crtn);
+
+        list_del(p);
+        nr--;
+    }
+}
+
+/* detaches the channel from the shared one, and wakes up all waiting
+   coroutines, which will get PURC_ERROR_ENTITY_GONE. */
+static void
+detach_shared(pcchan_t chan)
+{
+    release_shared(chan->shared);
+    chan->shared = NULL;
+    chan->qsize = 0;
+
+    resume_waiting_crtns(&chan->send_crtns, SIZE_MAX);
+    resume_waiting_crtns(&chan->recv_crtns, SIZE_MAX);
+}
+
+/* checks whether the shared channel was closed by another runner */
+static inline void
+check_shared_closed(pcchan_t chan)
+{
+    if (chan->shared && atomic_load(&chan->shared->closed))
+        detach_shared(chan);
+}
+
+static void
+close_shared(struct pcchan_shared *shared)
+{
+    pthread_mutex_lock(&shared_lock);
+    unlink_shared(shared);
+    pthread_mutex_unlock(&shared_lock);
+
+    atomic_store(&shared->closed, true);
+    wake_up_waiters(shared, &shared->send_waiters, &shared->nr_send_waiters);
+    wake_up_waiters(shared, &shared->recv_waiters, &shared->nr_recv_waiters);
+}
+
+int
+pcchan_wake_up(const char *chan_name)
+{
+    struct pcinst* inst = pcinst_current();
+    if (UNLIKELY(inst == NULL || inst->intr_heap == NULL)) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return -1;
+    }
+
+    pcutils_map_entry* entry;
+    entry = pcutils_map_find(inst->intr_heap->name_chan_map, chan_name);
+    if (entry) {
+        pcchan_t chan = entry->val;
+
+        /* the coroutines will try again */
+        resume_waiting_crtns(&chan->send_crtns, SIZE_MAX);
+        resume_waiting_crtns(&chan->recv_crtns, SIZE_MAX);
+    }
+
+    return 0;
+}
+
 static unsigned int
 discard_data(pcchan_t chan)
 {
@@ -214,27 +770,45 @@ discard_data(pcchan_t chan)
         nr++;
     }
 
-    struct list_head *p, *n;
-    list_for_each_safe(p, n, &chan->send_crtns) {
+    /* wake up all waiting coroutines */
+    resume_waiting_crtns(&chan->send_crtns, SIZE_MAX);
+    resume_waiting_crtns(&chan->recv_crtns, SIZE_MAX);
 
-        struct pcintr_coroutine *crtn;
-        crtn = list_entry(p, struct pcintr_coroutine, ln_stopped);
-        pcintr_resume_coroutine(crtn);
+    return nr;
+}
 
-        list_del(p);
-    }
+void
+pcchan_close_all(void)
+{
+    struct pcinst* inst = pcinst_current();
+    if (inst == NULL || inst->intr_heap == NULL)
+        return;
 
-    /* wake up all waiting coroutines */
-    list_for_each_safe(p, n, &chan->recv_crtns) {
+    pcintr_heap_t heap = inst->intr_heap;
+    struct pcutils_map_entry *entry;
+    struct pcutils_map_iterator it;
 
-        struct pcintr_coroutine *crtn;
-        crtn = list_entry(p, struct pcintr_coroutine, ln_stopped);
-        pcintr_resume_coroutine(crtn);
+    it = pcutils_map_it_begin_first(heap->name_chan_map);
+    while ((entry = pcutils_map_it_value(&it))) {
+        pcchan_t chan = entry->val;
+        pcutils_map_it_next(&it);
 
-        list_del(p);
-    }
+        if (chan->shared) {
+            /* other runners may still use the shared channel */
+            detach_shared(chan);
+        }
+        else if (chan->qsize > 0) {
+            discard_data(chan);
+            chan->qsize = 0;
+            chan->recvx = 0;
+            chan->sendx = 0;
+        }
 
-    return nr;
+        /* the channel bound to a living entity is erased on its release */
+        if (chan->refc == 0)
+            pcutils_map_erase_entry_nolock(heap->name_chan_map, entry);
+    }
+    pcutils_map_it_end(&it);
 }
 
 bool
@@ -251,7 +825,26 @@ pcchan_ctrl(pcchan_t chan, unsigned int new_cap)
     assert(entry);
 #endif
 
-    if (new_cap == 0) {
+    if (chan->shared) {
+        if (new_cap == 0) {
+            close_shared(chan->shared);
+            if (chan->refc == 0) {
+                int r = pcutils_map_erase(heap->name_chan_map, chan->name);
+                PC_ASSERT(r == 0);
+            }
+            else {
+                detach_shared(chan);
+            }
+        }
+        else if (new_cap != chan->shared->qsize) {
+            /* NOTE: the ring may be being used by other runners. */
+            purc_set_error_with_info(PURC_ERROR_NOT_SUPPORTED,
+                    "can not change the capacity of shared channel '%s'",
+                    chan->name);
+            goto failed;
+        }
+    }
+    else if (new_cap == 0) {
         if (chan->refc == 0) {
             // no native entity variant bound to this channel
             int r = pcutils_map_erase(heap->name_chan_map, chan->name);
@@ -303,7 +896,7 @@ pcchan_t
 pcchan_retrieve(const char *chan_name)
 {
     struct pcinst* inst;
-    const pcutils_map_entry* entry = NULL;
+    pcutils_map_entry* entry = NULL;
 
     if (UNLIKELY((inst = pcinst_current()) == NULL ||
                 inst->intr_heap == NULL)) {
@@ -318,6 +911,24 @@ pcchan_retrieve(const char *chan_name)
 
     pcintr_heap_t heap = inst->intr_heap;
     if ((entry = pcutils_map_find(heap->name_chan_map, chan_name))) {
+        pcchan_t chan = entry->val;
+        check_shared_closed(chan);
+        if (chan->qsize > 0)
+            return chan;
+
+        if (chan->refc == 0) {
+            pcutils_map_erase(heap->name_chan_map, chan->name);
+            entry = NULL;
+        }
+    }
+
+    /* the shared channel may be opened by another runner */
+    struct pcchan_shared *shared = attach_shared(chan_name, 0);
+    if (shared) {
+        return attach_proxy(heap, chan_name, shared);
+    }
+
+    if (entry) {
         return entry->val;
     }
 
@@ -325,6 +936,66 @@ pcchan_retrieve(const char *chan_name)
     return NULL;
 }
 
+/* Returns 1 if sent, 0 if there are not enough free slots,
+   or -1 on failure. */
+static int
+send_to_local(pcchan_t chan, purc_variant_t *argv, size_t nr_args)
+{
+    if (chan->qcount + nr_args > chan->qsize)
+        return 0;
+
+    for (size_t i = 0; i < nr_args; i++) {
+        chan->data[chan->sendx] = purc_variant_ref(argv[i]);
+        chan->sendx++;
+        if (chan->sendx == chan->qsize)
+            chan->sendx = 0;
+        chan->qcount++;
+    }
+
+    post_event(chan, MSG_TYPE_RECEIVABLE, NULL, PURC_VARIANT_INVALID);
+
+    // if there are coroutines waiting to receive, resume them.
+    resume_waiting_crtns(&chan->recv_crtns, nr_args);
+    return 1;
+}
+
+static int
+send_to_shared(pcchan_t chan, purc_variant_t *argv, size_t nr_args)
+{
+    struct pcchan_shared *shared = chan->shared;
+    purc_variant_t buf[NR_BATCH_ON_STACK];
+    purc_variant_t *vrts = buf;
+
+    if (nr_args > NR_BATCH_ON_STACK) {
+        vrts = malloc(sizeof(purc_variant_t) * nr_args);
+        if (vrts == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+    }
+
+    int ret = 0;
+    uint64_t pos;
+    if (reserve_cells_to_send(shared, nr_args, &pos)) {
+        for (size_t i = 0; i < nr_args; i++) {
+            vrts[i] = purc_variant_ref(argv[i]);
+        }
+
+        /* move all variants of the batch in one go; the ones failed to
+           move are left invalid and skipped by the receivers. */
+        ret = pcvariant_move_heap_in_n(vrts, nr_args) ? -1 : 1;
+        publish_cells(shared, pos, vrts, nr_args);
+
+        post_event(chan, MSG_TYPE_RECEIVABLE, NULL, PURC_VARIANT_INVALID);
+        wake_up_waiters(shared, &shared->recv_waiters,
+                &shared->nr_recv_waiters);
+    }
+
+    if (vrts != buf)
+        free(vrts);
+    return ret;
+}
+
 static purc_variant_t
 send_getter(void *native_entity, const char *property_name,
         size_t nr_args, purc_variant_t *argv, unsigned call_flags)
@@ -359,35 +1030,46 @@ send_getter(void *native_entity, const char *property_name,
         goto failed;
     }
 
+    check_shared_closed(chan);
     if (chan->qsize == 0) {
         purc_set_error(PURC_ERROR_ENTITY_GONE);
         goto failed;
     }
 
-    if (purc_variant_is_undefined(argv[0])) {
-        purc_set_error(PURC_ERROR_INVALID_VALUE);
-        goto failed;
+    for (size_t i = 0; i < nr_args; i++) {
+        if (purc_variant_is_undefined(argv[i])) {
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            goto failed;
+        }
     }
 
-    if (chan->qcount < chan->qsize) {
-        chan->data[chan->sendx] = purc_variant_ref(argv[0]);
-        chan->sendx++;
-        if (chan->sendx == chan->qsize)
-            chan->sendx = 0;
-        chan->qcount++;
+    /* the values of a batch are sent all or none */
+    if (nr_args > chan->qsize) {
+        purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
+                "too many values (%u) for channel '%s' of capacity %u",
+                (unsigned)nr_args, chan->name, chan->qsize);
+        goto failed;
+    }
 
-        post_event(chan, MSG_TYPE_RECEIVABLE, NULL, PURC_VARIANT_INVALID);
+    bool waited = false;
+    int ret;
+again:
+    if (chan->shared)
+        ret = send_to_shared(chan, argv, nr_args);
+    else
+        ret = send_to_local(chan, argv, nr_args);
 
-        // if there is any coroutine waiting to receive, resume the first one.
-        if (!list_empty(&chan->recv_crtns)) {
-            pcintr_coroutine_t crtn = list_first_entry(&chan->recv_crtns,
-                    struct pcintr_coroutine, ln_stopped);
-            pcintr_resume_coroutine(crtn);
-            list_del(&crtn->ln_stopped);
-        }
+    if (ret < 0) {
+        goto failed;
     }
-    else {
+    else if (ret == 0) {
         if (crtn) {
+            if (chan->shared && !waited) {
+                waited = true;
+                if (wait_for_shared(chan->shared, true, nr_args))
+                    goto again;
+            }
+
             // stop the current coroutine
             pcintr_stop_coroutine(crtn, &crtn->timeout);
             list_add_tail(&crtn->ln_stopped, &chan->send_crtns);
@@ -406,16 +1088,70 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/* Returns the number of the variants received. */
+static size_t
+recv_from_local(pcchan_t chan, purc_variant_t *vrts, size_t max_n)
+{
+    size_t n = 0;
+
+    while (chan->qcount > 0 && n < max_n) {
+        vrts[n++] = chan->data[chan->recvx];
+        chan->recvx++;
+        if (chan->recvx == chan->qsize)
+            chan->recvx = 0;
+        chan->qcount--;
+    }
+
+    if (n > 0) {
+        post_event(chan, MSG_TYPE_SENDABLE, NULL, PURC_VARIANT_INVALID);
+
+        // if there are coroutines waiting to send, resume them.
+        resume_waiting_crtns(&chan->send_crtns, n);
+    }
+
+    return n;
+}
+
+static size_t
+recv_from_shared(pcchan_t chan, purc_variant_t *vrts, size_t max_n)
+{
+    struct pcchan_shared *shared = chan->shared;
+    size_t n;
+
+    do {
+        n = take_cells(shared, vrts, max_n);
+        if (n == 0)
+            break;
+
+        pcvariant_move_heap_out_n(vrts, n);
+        wake_up_waiters(shared, &shared->send_waiters,
+                &shared->nr_send_waiters);
+
+        /* skip the variants failed to move in */
+        size_t i, j;
+        for (i = 0, j = 0; i < n; i++) {
+            if (vrts[i] != PURC_VARIANT_INVALID)
+                vrts[j++] = vrts[i];
+        }
+        n = j;
+    } while (n == 0);
+
+    if (n > 0)
+        post_event(chan, MSG_TYPE_SENDABLE, NULL, PURC_VARIANT_INVALID);
+
+    return n;
+}
+
 static purc_variant_t
 recv_getter(void *native_entity, const char *property_name,
         size_t nr_args, purc_variant_t *argv, unsigned call_flags)
 {
     UNUSED_PARAM(property_name);
-    UNUSED_PARAM(nr_args);
-    UNUSED_PARAM(argv);
 
     pcchan_t chan = native_entity;
     pcintr_coroutine_t crtn = pcintr_get_coroutine();
+    purc_variant_t buf[NR_BATCH_ON_STACK];
+    purc_variant_t *vrts = buf;
 
     if (call_flags & PCVRT_CALL_FLAG_AGAIN &&
             call_flags & PCVRT_CALL_FLAG_TIMEOUT) {
@@ -437,41 +1173,79 @@ recv_getter(void *native_entity, const char *property_name,
         goto failed;
     }
 
+    /* recv(<count>) receives a batch of at most <count> values */
+    uint64_t max_n = 0;
+    if (nr_args > 0) {
+        if (!purc_variant_cast_to_ulongint(argv[0], &max_n, false) ||
+                max_n == 0) {
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            goto failed;
+        }
+    }
+
+    check_shared_closed(chan);
     if (chan->qsize == 0) {
         purc_set_error(PURC_ERROR_ENTITY_GONE);
         goto failed;
     }
 
-    purc_variant_t vrt = PURC_VARIANT_INVALID;
-    if (chan->qcount > 0) {
-        vrt = chan->data[chan->recvx];
-        chan->recvx++;
-        if (chan->recvx == chan->qsize)
-            chan->recvx = 0;
-        chan->qcount--;
-
-        post_event(chan, MSG_TYPE_SENDABLE, NULL, PURC_VARIANT_INVALID);
-
-        // if there is any coroutine waiting to send, resume the first one.
-        if (!list_empty(&chan->send_crtns)) {
-            pcintr_coroutine_t crtn = list_first_entry(&chan->send_crtns,
-                    struct pcintr_coroutine, ln_stopped);
-            pcintr_resume_coroutine(crtn);
-            list_del(&crtn->ln_stopped);
+    size_t sz = (max_n == 0) ? 1 : (size_t)MIN(max_n, chan->qsize);
+    if (sz > NR_BATCH_ON_STACK) {
+        vrts = malloc(sizeof(purc_variant_t) * sz);
+        if (vrts == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto failed;
         }
     }
-    else {
+
+    bool waited = false;
+    size_t n;
+again:
+    if (chan->shared)
+        n = recv_from_shared(chan, vrts, sz);
+    else
+        n = recv_from_local(chan, vrts, sz);
+
+    if (n == 0) {
         if (crtn) {
+            if (chan->shared && !waited) {
+                waited = true;
+                if (wait_for_shared(chan->shared, false, 0))
+                    goto again;
+            }
+
             // stop the current coroutine
             pcintr_stop_coroutine(crtn, &crtn->timeout);
             list_add_tail(&crtn->ln_stopped, &chan->recv_crtns);
         }
 
+        if (vrts != buf)
+            free(vrts);
         purc_set_error(PURC_ERROR_AGAIN);
         return PURC_VARIANT_INVALID;
     }
 
-    return vrt;
+    purc_variant_t retv;
+    if (max_n == 0) {
+        assert(n == 1);
+        retv = vrts[0];
+    }
+    else {
+        retv = purc_variant_make_array_0();
+        for (size_t i = 0; i < n; i++) {
+            if (retv && !purc_variant_array_append(retv, vrts[i])) {
+                purc_variant_unref(retv);
+                retv = PURC_VARIANT_INVALID;
+            }
+            purc_variant_unref(vrts[i]);
+        }
+    }
+
+    if (vrts != buf)
+        free(vrts);
+    if (retv == PURC_VARIANT_INVALID)
+        goto failed;
+    return retv;
 
 failed:
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
@@ -489,6 +1263,7 @@ cap_getter(void *native_entity, const char *property_name,
     UNUSED_PARAM(argv);
 
     pcchan_t chan = native_entity;
+    check_shared_closed(chan);
     if (chan->qsize == 0) {
         purc_set_error(PURC_ERROR_ENTITY_GONE);
         goto failed;
@@ -512,12 +1287,13 @@ len_getter(void *native_entity, const char *property_name,
     UNUSED_PARAM(argv);
 
     pcchan_t chan = native_entity;
+    check_shared_closed(chan);
     if (chan->qsize == 0) {
         purc_set_error(PURC_ERROR_ENTITY_GONE);
         goto failed;
     }
 
-    return purc_variant_make_ulongint(chan->qcount);
+    return purc_variant_make_ulongint(pcchan_length(chan));
 
 failed:
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
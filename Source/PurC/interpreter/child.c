@@ -33,6 +33,7 @@
 #include "private/instance.h"
 #include "private/utils.h"
 #include "private/variant.h"
+#include "private/runners.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -218,6 +219,28 @@ out:
     return cid;
 }
 
+purc_atom_t
+pcintr_schedule_detached_child_co(purc_vdom_t vdom, purc_atom_t curator,
+        purc_variant_t request, const char *body_id)
+{
+    char runner_name[PURC_LEN_RUNNER_NAME + 1];
+    int slot = pcrun_pool_pick_worker(runner_name);
+    if (slot >= 0) {
+        purc_atom_t cid = pcintr_schedule_child_co(vdom, curator,
+                runner_name, NULL, request, body_id, true);
+        if (cid)
+            return cid;
+
+        /* NOTE: not fatal; fall back to the current runner */
+        PC_WARN("failed to schedule the child in the pool worker %s\n",
+                runner_name);
+        purc_clr_error();
+    }
+
+    return pcintr_schedule_child_co(vdom, curator, NULL, NULL, request,
+            body_id, false);
+}
+
 purc_atom_t
 pcintr_schedule_child_co_from_string(const char *hvml, purc_atom_t curator,
         const char *runner, const char *rdr_target, purc_variant_t request,
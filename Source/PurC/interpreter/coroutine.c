@@ -303,6 +303,69 @@ out:
     return ret;
 }
 
+static const char *priority_names[] = {
+    PURC_CRTN_PRIORITY_NAME_LOW,
+    PURC_CRTN_PRIORITY_NAME_NORMAL,
+    PURC_CRTN_PRIORITY_NAME_HIGH,
+};
+
+/* make sure the number of the names matches the number of priorities */
+#define _COMPILE_TIME_ASSERT(name, x)               \
+       typedef int _dummy_ ## name[(x) * 2 - 1]
+_COMPILE_TIME_ASSERT(priorities,
+        PCA_TABLESIZE(priority_names) == PCINTR_NR_CRTN_PRIORITIES);
+#undef _COMPILE_TIME_ASSERT
+
+const char *
+pcintr_coroutine_get_priority_name(pcintr_coroutine_t cor)
+{
+    return priority_names[cor->priority - PURC_CRTN_PRIORITY_LOW];
+}
+
+int
+pcintr_coroutine_set_priority(pcintr_coroutine_t cor, int priority)
+{
+    if (priority < PURC_CRTN_PRIORITY_LOW ||
+            priority > PURC_CRTN_PRIORITY_HIGH) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (cor->priority != priority) {
+        cor->priority = priority;
+        /* NOTE: the credit or the debt was earned with the old quantum */
+        cor->sched_deficit = 0;
+    }
+    return 0;
+}
+
+int
+pcintr_coroutine_set_priority_by_name(pcintr_coroutine_t cor,
+        const char *name)
+{
+    for (size_t i = 0; i < PCA_TABLESIZE(priority_names); i++) {
+        if (strcmp(name, priority_names[i]) == 0) {
+            return pcintr_coroutine_set_priority(cor,
+                    PURC_CRTN_PRIORITY_LOW + (int)i);
+        }
+    }
+
+    purc_set_error(PURC_ERROR_INVALID_VALUE);
+    return -1;
+}
+
+const struct pcintr_sched_stat *
+pcintr_get_sched_stat(struct pcinst *inst, int priority)
+{
+    if (inst->intr_heap == NULL || priority < PURC_CRTN_PRIORITY_LOW ||
+            priority > PURC_CRTN_PRIORITY_HIGH) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    return inst->intr_heap->sched_stats + priority - PURC_CRTN_PRIORITY_LOW;
+}
+
 pcintr_coroutine_t
 pcintr_get_first_crtn(struct pcinst *inst)
 {
@@ -508,3 +571,24 @@ pcintr_reload_crtn_doc(struct pcinst *inst, pcintr_coroutine_t co_revoked,
     return true;
 }
 
+bool
+pcintr_resync_crtn_doc(struct pcinst *inst, uint64_t ctrn_handle,
+        uint64_t last_seq, uint64_t *seq)
+{
+    pcintr_coroutine_t co = (pcintr_coroutine_t)(uintptr_t)ctrn_handle;
+    pcintr_heap_t heap = inst->intr_heap;
+    if (!pcutils_sorted_array_find(heap->loaded_crtn_handles,
+                co, NULL, NULL)) {
+        purc_log_warn("Not a loaded coroutine: %p\n", co);
+        return false;
+    }
+
+    if (!pcintr_rdr_page_control_resync(inst, &co->stack, last_seq)) {
+        return false;
+    }
+
+    /* NOTE: the log restarts if the page was loaded again */
+    *seq = pcintr_mutation_log_last_seq(co);
+    return true;
+}
+
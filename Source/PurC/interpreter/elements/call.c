@@ -85,7 +85,7 @@ ctxt_for_call_destroy(struct ctxt_for_call *ctxt)
                     ctxt->endpoint_name_within);
             ctxt->endpoint_atom_within = 0;
         }
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -229,12 +229,24 @@ post_process(pcintr_coroutine_t co, struct pcintr_stack_frame *frame)
         return -1;
     }
 
-    purc_atom_t child_cid = pcintr_schedule_child_co(vdom, co->cid,
-            runner_name, NULL, request, NULL, true);
+    purc_atom_t child_cid;
+    if (runner_name == NULL) {
+        child_cid = pcintr_schedule_detached_child_co(vdom, co->cid,
+                request, NULL);
+    }
+    else {
+        child_cid = pcintr_schedule_child_co(vdom, co->cid,
+                runner_name, NULL, request, NULL, true);
+    }
     purc_variant_unref(request);
 
     ctxt->call_id =  pcintr_crtn_observed_create(child_cid);
 
+    if (child_cid && !ctxt->synchronously &&
+            pcintr_future_create(co, child_cid)) {
+        return -1;
+    }
+
     if (as) {
         pcintr_bind_named_variable(&co->stack, frame, as, ctxt->at, false,
                 false, ctxt->call_id);
@@ -465,7 +477,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_call *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_call*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_call*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
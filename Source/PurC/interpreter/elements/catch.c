@@ -53,7 +53,7 @@ ctxt_for_catch_destroy(struct ctxt_for_catch *ctxt)
     if (ctxt) {
         PURC_VARIANT_SAFE_CLEAR(ctxt->for_var);
 
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -181,7 +181,7 @@ _after_pushed(pcintr_stack_t stack, pcvdom_element_t pos,
 
     struct ctxt_for_catch *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_catch*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_catch*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
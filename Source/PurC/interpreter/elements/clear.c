@@ -46,7 +46,7 @@ ctxt_for_clear_destroy(struct ctxt_for_clear *ctxt)
 {
     if (ctxt) {
         PURC_VARIANT_SAFE_CLEAR(ctxt->on);
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -114,7 +114,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_clear *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_clear*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_clear*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -154,6 +154,12 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
         {
             const char *s = purc_variant_get_string_const(ctxt->on);
             purc_document_t doc = stack->doc;
+            if (purc_document_type(doc) == PCDOC_K_TYPE_VOID) {
+                /* NOTE: nothing to clear in a void document */
+                ret = purc_variant_make_boolean(true);
+                break;
+            }
+
             purc_variant_t elems = pcdvobjs_elements_by_css(doc, s);
             if (!elems) {
                 ret = purc_variant_make_boolean(false);
@@ -77,7 +77,7 @@ ctxt_for_define_destroy(struct ctxt_for_define *ctxt)
             purc_rwstream_destroy(ctxt->resp);
             ctxt->resp = NULL;
         }
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -623,7 +623,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_define *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_define*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_define*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -50,7 +50,7 @@ ctxt_for_erase_destroy(struct ctxt_for_erase *ctxt)
     if (ctxt) {
         PURC_VARIANT_SAFE_CLEAR(ctxt->on);
         PURC_VARIANT_SAFE_CLEAR(ctxt->at);
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -146,6 +146,11 @@ element_erase(pcintr_stack_t stack, purc_variant_t on, purc_variant_t at,
     purc_variant_t ret = PURC_VARIANT_INVALID;
     const char *s = purc_variant_get_string_const(on);
     purc_document_t doc = stack->doc;
+    if (purc_document_type(doc) == PCDOC_K_TYPE_VOID) {
+        /* NOTE: nothing to erase in a void document */
+        return purc_variant_make_ulongint(0);
+    }
+
     purc_variant_t elems = pcdvobjs_elements_by_css(doc, s);
     if (!elems) {
         ret = purc_variant_make_ulongint(0);
@@ -350,7 +355,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_erase *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_erase*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_erase*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -48,7 +48,7 @@ ctxt_for_error_destroy(struct ctxt_for_error *ctxt)
     if (ctxt) {
         PURC_VARIANT_SAFE_CLEAR(ctxt->type);
         PURC_VARIANT_SAFE_CLEAR(ctxt->contents);
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -129,7 +129,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_error *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_error*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_error*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
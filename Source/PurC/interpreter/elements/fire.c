@@ -65,7 +65,7 @@ ctxt_for_fire_destroy(struct ctxt_for_fire *ctxt)
             free(ctxt->sub_type);
             ctxt->sub_type = NULL;
         }
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -237,7 +237,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_fire *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_fire*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_fire*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
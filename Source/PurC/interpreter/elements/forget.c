@@ -65,7 +65,7 @@ ctxt_for_forget_destroy(struct ctxt_for_forget *ctxt)
             free(ctxt->sub_type);
             ctxt->sub_type = NULL;
         }
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -207,7 +207,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_forget *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_forget*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_forget*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -43,7 +43,7 @@ static void
 ctxt_for_head_destroy(struct ctxt_for_head *ctxt)
 {
     if (ctxt) {
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -90,7 +90,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_head *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_head*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_head*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -74,7 +74,7 @@ ctxt_for_hvml_destroy(struct ctxt_for_hvml *ctxt)
             ctxt->mime_type = NULL;
         }
 
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -456,7 +456,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_hvml *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_hvml*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_hvml*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
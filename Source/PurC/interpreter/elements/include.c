@@ -50,7 +50,7 @@ ctxt_for_include_destroy(struct ctxt_for_include *ctxt)
     if (ctxt) {
         PURC_VARIANT_SAFE_CLEAR(ctxt->with);
         PURC_VARIANT_SAFE_CLEAR(ctxt->on);
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -196,7 +196,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_include *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_include*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_include*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -47,7 +47,7 @@ ctxt_for_inherit_destroy(struct ctxt_for_inherit *ctxt)
     if (ctxt) {
         PURC_VARIANT_SAFE_CLEAR(ctxt->href);
         PURC_VARIANT_SAFE_CLEAR(ctxt->on);
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -120,7 +120,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_inherit *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_inherit*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_inherit*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
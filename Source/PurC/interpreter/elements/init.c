@@ -29,6 +29,7 @@
 
 #include "private/debug.h"
 #include "private/dvobjs.h"
+#include "private/ejson.h"
 #include "purc-runloop.h"
 
 #include "../ops.h"
@@ -77,6 +78,7 @@ struct ctxt_for_init {
     int                           err;
     purc_rwstream_t               resp;
     char                         *mime_type;
+    struct pcejson_builder       *json;
 
     enum VIA                      via;
     purc_variant_t                v_for;
@@ -119,7 +121,11 @@ ctxt_for_init_destroy(struct ctxt_for_init *ctxt)
             free(ctxt->mime_type);
             ctxt->mime_type = NULL;
         }
-        free(ctxt);
+        if (ctxt->json) {
+            pcejson_builder_delete(ctxt->json);
+            ctxt->json = NULL;
+        }
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -150,29 +156,38 @@ _bind_src(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
     return ret;
 }
 
-static int
-_init_set_with(purc_variant_t set, purc_variant_t arr)
+static purc_variant_t
+_make_set_with(const char *unique_key, bool caseless, purc_variant_t arr)
 {
     if (!purc_variant_is_array(arr)) {
         purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
                 "array is required to initialize uniq-set");
-        return -1;
+        return PURC_VARIANT_INVALID;
     }
 
-    purc_variant_t v;
-    size_t idx;
-    foreach_value_in_variant_array(arr, v, idx) {
-        UNUSED_PARAM(idx);
+    size_t sz = purc_variant_array_get_size(arr);
+    purc_variant_t *members = NULL;
+    if (sz > 0) {
+        members = (purc_variant_t *)malloc(sizeof(*members) * sz);
+        if (members == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return PURC_VARIANT_INVALID;
+        }
 
-        ssize_t r;
-        r = purc_variant_set_add(set, v, PCVRNT_CR_METHOD_OVERWRITE);
-        if (r == -1) {
-            return -1;
+        purc_variant_t v;
+        size_t idx;
+        foreach_value_in_variant_array(arr, v, idx) {
+            members[idx] = v;
         }
+        end_foreach;
     }
-    end_foreach;
 
-    return 0;
+    /* build the set in one go rather than adding the members one by one */
+    purc_variant_t set;
+    set = purc_variant_make_set_by_members(sz, unique_key, caseless, members);
+    free(members);
+
+    return set;
 }
 
 static purc_variant_t
@@ -184,18 +199,7 @@ _generate_src(purc_variant_t against, bool uniquely, bool caseless,
         if (against != PURC_VARIANT_INVALID) {
             s_against = purc_variant_get_string_const(against);
         }
-        purc_variant_t set;
-        set = purc_variant_make_set_by_ckey_ex(0, s_against, caseless,
-                PURC_VARIANT_INVALID);
-        if (set == PURC_VARIANT_INVALID)
-            return PURC_VARIANT_INVALID;
-
-        if (_init_set_with(set, val)) {
-            purc_variant_unref(set);
-            return PURC_VARIANT_INVALID;
-        }
-
-        return set;
+        return _make_set_with(s_against, caseless, val);
     }
     else {
         return purc_variant_ref(val);
@@ -537,6 +541,26 @@ attr_found_val(struct pcintr_stack_frame *frame,
     return 0;
 }
 
+/*
+ * NOTE: The body of a successful JSON response is fed to the builder as its
+ * chunks arrive, so a large dataset is being built while it is downloaded,
+ * and the text of it is never held in memory.
+ */
+static struct pcejson_builder *
+json_builder_for_response(const struct pcfetcher_resp_header *resp_header)
+{
+    if (resp_header->ret_code != 200 || resp_header->mime_type == NULL ||
+            strcasecmp(resp_header->mime_type, MIME_TYPE_APP_JSON) != 0) {
+        return NULL;
+    }
+
+    /* fall back to buffering the body if failed */
+    struct pcejson_builder *builder =
+        pcejson_builder_new(PCEJSON_DEFAULT_DEPTH);
+    purc_clr_error();
+    return builder;
+}
+
 static void on_sync_complete(
         struct pcfetcher_session *session,
         purc_variant_t request_id,
@@ -562,6 +586,7 @@ static void on_sync_complete(
         if (resp_header->mime_type) {
             ctxt->mime_type = strdup(resp_header->mime_type);
         }
+        ctxt->json = json_builder_for_response(resp_header);
         PC_DEBUG("load_async|callback|ret_code=%d\n", resp_header->ret_code);
         PC_DEBUG("load_async|callback|mime_type=%s\n", resp_header->mime_type);
         PC_DEBUG("load_async|callback|sz_resp=%ld\n", resp_header->sz_resp);
@@ -570,6 +595,11 @@ static void on_sync_complete(
 
     case PCFETCHER_RESP_TYPE_DATA:
     {
+        if (ctxt->json) {
+            /* an error is reported when the builder ends */
+            pcejson_builder_feed(ctxt->json, data, sz_data);
+            break;
+        }
         if (ctxt->resp == NULL) {
             ctxt->resp = purc_rwstream_new_buffer(sz_data, 0);
         }
@@ -726,6 +756,18 @@ out:
     return ret;
 }
 
+/* returns the variant built from the body */
+static purc_variant_t
+build_variant(purc_rwstream_t resp, struct pcejson_builder *json,
+        const char *mime)
+{
+    if (json) {
+        return pcejson_builder_end(json);
+    }
+
+    return build_variant_by_mime(resp, mime);
+}
+
 static int
 observer_handle(pcintr_coroutine_t cor, struct pcintr_observer *observer,
         pcrdr_msg *msg, const char *type, const char *sub_type, void *data)
@@ -752,7 +794,7 @@ observer_handle(pcintr_coroutine_t cor, struct pcintr_observer *observer,
         goto out;
     }
 
-    if (!ctxt->resp || ctxt->ret_code != 200) {
+    if ((!ctxt->resp && !ctxt->json) || ctxt->ret_code != 200) {
         if (frame->silently) {
             frame->next_step = NEXT_STEP_ON_POPPING;
             goto out;
@@ -764,7 +806,8 @@ observer_handle(pcintr_coroutine_t cor, struct pcintr_observer *observer,
         goto out;
     }
 
-    purc_variant_t ret = build_variant_by_mime(ctxt->resp, ctxt->mime_type);
+    purc_variant_t ret = build_variant(ctxt->resp, ctxt->json,
+            ctxt->mime_type);
     if (ret == PURC_VARIANT_INVALID) {
         frame->next_step = NEXT_STEP_ON_POPPING;
         goto out;
@@ -871,6 +914,7 @@ struct load_data {
     int                       err;
     purc_rwstream_t           resp;
     char                     *mime_type;
+    struct pcejson_builder   *json;
 
     purc_variant_t            as;
     purc_variant_t            at;
@@ -898,6 +942,10 @@ static void load_data_release(struct load_data *data)
             free(data->mime_type);
             data->mime_type = NULL;
         }
+        if (data->json) {
+            pcejson_builder_delete(data->json);
+            data->json = NULL;
+        }
     }
 }
 
@@ -919,7 +967,7 @@ static void on_async_resume_on_frame_pseudo(pcintr_coroutine_t co,
     if (data->ret_code == RESP_CODE_USER_STOP)
         return;
 
-    if (!data->resp || data->ret_code != 200) {
+    if ((!data->resp && !data->json) || data->ret_code != 200) {
         if (frame->silently) {
             return;
         }
@@ -930,7 +978,8 @@ static void on_async_resume_on_frame_pseudo(pcintr_coroutine_t co,
         return;
     }
 
-    purc_variant_t ret = build_variant_by_mime(data->resp, data->mime_type);
+    purc_variant_t ret = build_variant(data->resp, data->json,
+            data->mime_type);
     if (ret == PURC_VARIANT_INVALID)
         return;
 
@@ -1032,6 +1081,7 @@ static void on_async_complete(
         if (resp_header->mime_type) {
             ld->mime_type = strdup(resp_header->mime_type);
         }
+        ld->json = json_builder_for_response(resp_header);
         PC_DEBUG("load_async|callback|ret_code=%d\n", resp_header->ret_code);
         PC_DEBUG("load_async|callback|mime_type=%s\n", resp_header->mime_type);
         PC_DEBUG("load_async|callback|sz_resp=%ld\n", resp_header->sz_resp);
@@ -1040,6 +1090,11 @@ static void on_async_complete(
 
     case PCFETCHER_RESP_TYPE_DATA:
     {
+        if (ld->json) {
+            /* an error is reported when the builder ends */
+            pcejson_builder_feed(ld->json, data, sz_data);
+            break;
+        }
         if (ld->resp == NULL) {
             ld->resp = purc_rwstream_new_buffer(sz_data, 0);
         }
@@ -1276,7 +1331,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_init *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_init*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_init*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
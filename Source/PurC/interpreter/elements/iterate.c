@@ -99,6 +99,7 @@ struct ctxt_for_iterate {
 
     unsigned int                  stop:1;
     unsigned int                  by_rule:1;
+    unsigned int                  by_native:1;
     unsigned int                  nosetotail:1;
     unsigned int                  is_rerun:1;
     enum step_for_iterate         step;
@@ -121,7 +122,7 @@ ctxt_for_iterate_destroy(struct ctxt_for_iterate *ctxt)
         PURC_VARIANT_SAFE_CLEAR(ctxt->with);
         PURC_VARIANT_SAFE_CLEAR(ctxt->val_from_func);
 
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -368,6 +369,59 @@ post_process_by_external_func(struct ctxt_for_iterate *ctxt,
     return ctxt;
 }
 
+/* pulls the next item from a native entity by PURC_NATIVE_PROP_NEXT;
+   returns false if failed */
+static bool
+pull_from_native(struct ctxt_for_iterate *ctxt,
+        struct pcintr_stack_frame *frame)
+{
+    purc_variant_t on = ctxt->on;
+    struct purc_native_ops *ops = purc_variant_native_get_ops(on);
+    void *entity = purc_variant_native_get_entity(on);
+
+    /* NOTE: rerun_native() fails if there is no current item */
+    PURC_VARIANT_SAFE_CLEAR(ctxt->val_from_func);
+
+    purc_nvariant_method next = NULL;
+    if (ops && ops->property_getter)
+        next = ops->property_getter(entity, PURC_NATIVE_PROP_NEXT);
+    if (next == NULL) {
+        purc_set_error_with_info(PURC_ERROR_NOT_SUPPORTED,
+                "native entity '%s' is not iterable",
+                purc_variant_native_get_name(on));
+        return false;
+    }
+
+    purc_variant_t v = next(entity, PURC_NATIVE_PROP_NEXT, 0, NULL,
+            frame->silently ? PCVRT_CALL_FLAG_SILENTLY : 0);
+    if (v == PURC_VARIANT_INVALID)
+        return false;
+
+    if (purc_variant_is_undefined(v) || purc_variant_is_null(v)) {
+        purc_variant_unref(v);
+        ctxt->stop = true;
+    }
+    else {
+        ctxt->val_from_func = v;
+    }
+
+    return true;
+}
+
+static struct ctxt_for_iterate*
+first_iterate_by_native(struct ctxt_for_iterate *ctxt,
+        struct pcintr_stack_frame *frame)
+{
+    ctxt->by_native = 1;
+    if (!pull_from_native(ctxt, frame))
+        return NULL;
+
+    if (!ctxt->stop)
+        pcintr_set_question_var(frame, ctxt->val_from_func);
+
+    return ctxt;
+}
+
 static struct ctxt_for_iterate *
 first_iterate_by_executor(pcintr_coroutine_t co, struct pcintr_stack_frame *frame)
 {
@@ -383,6 +437,10 @@ first_iterate_by_executor(pcintr_coroutine_t co, struct pcintr_stack_frame *fram
     }
     purc_variant_t with = ctxt->with;
 
+    /* NOTE: a native entity is iterated by itself unless a rule is given */
+    if (purc_variant_is_native(on) && !ctxt->rule_attr)
+        return first_iterate_by_native(ctxt, frame);
+
     const char *rule = purc_variant_get_string_const(ctxt->evalued_rule);
     if (!rule)
         return ctxt;
@@ -478,6 +536,23 @@ rerun_external_func(struct ctxt_for_iterate *ctxt,
     return r ? false : true;
 }
 
+static bool
+rerun_native(struct ctxt_for_iterate *ctxt,
+        struct pcintr_stack_frame *frame, pcintr_stack_t stack)
+{
+    purc_variant_t value = ctxt->val_from_func;
+    if (value == PURC_VARIANT_INVALID)
+        return false;
+
+    int r;
+    r = pcintr_set_question_var(frame, value);
+    if (r == 0) {
+        pcintr_set_input_var(stack, value);
+    }
+
+    return r ? false : true;
+}
+
 static int
 rerun_iterate_by_executor(pcintr_coroutine_t co, struct pcintr_stack_frame *frame)
 {
@@ -491,6 +566,10 @@ rerun_iterate_by_executor(pcintr_coroutine_t co, struct pcintr_stack_frame *fram
         return -1;
 
     pcintr_stack_t stack = &co->stack;
+    if (ctxt->by_native) {
+        return rerun_native(ctxt, frame, stack) ? 0 : -1;
+    }
+
     bool b = false;
     switch (ctxt->ops.type) {
         case PCEXEC_TYPE_INTERNAL:
@@ -910,7 +989,7 @@ prepare(pcintr_stack_t stack, struct pcintr_stack_frame *frame)
     UNUSED_PARAM(frame);
     struct ctxt_for_iterate *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_iterate*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_iterate*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return PURC_ERROR_OUT_OF_MEMORY;
@@ -1116,16 +1195,24 @@ on_popping_internal_rule(struct ctxt_for_iterate *ctxt, pcintr_stack_t stack,
         return false;
     }
 
+    /* NOTE: pass NULL for an unchanged rule, so that the executor goes on
+       without parsing the rule and preparing the items again */
+    bool changed = true;
+    const char *rule = purc_variant_get_string_const(val);
+    if (rule && ctxt->evalued_rule) {
+        const char *last = purc_variant_get_string_const(ctxt->evalued_rule);
+        changed = (last == NULL || strcmp(last, rule) != 0);
+    }
+
     PURC_VARIANT_SAFE_CLEAR(ctxt->evalued_rule);
     ctxt->evalued_rule = val;
 
-    const char *rule = purc_variant_get_string_const(ctxt->evalued_rule);
     if (!rule)
         return true;
 
     purc_exec_ops_t ops = ctxt->ops.internal_ops;
 
-    it = ops->it_next(exec_inst, it, rule);
+    it = ops->it_next(exec_inst, it, changed ? rule : NULL);
 
     ctxt->it = it;
     if (!it) {
@@ -1184,6 +1271,14 @@ after_iterate_by_executor(pcintr_stack_t stack,
 {
     UNUSED_PARAM(frame);
 
+    if (ctxt->by_native) {
+        if (!pull_from_native(ctxt, frame)) {
+            ctxt->stop = true;
+            return purc_get_last_error();
+        }
+        return 0;
+    }
+
     switch (ctxt->ops.type) {
         case PCEXEC_TYPE_INTERNAL:
             ctxt->stop = on_popping_internal_rule(ctxt, stack, frame);
@@ -98,7 +98,7 @@ ctxt_for_load_destroy(struct ctxt_for_load *ctxt)
                     ctxt->endpoint_name_within);
             ctxt->endpoint_atom_within = 0;
         }
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -238,14 +238,25 @@ post_process(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
     const char *as = ctxt->as ? purc_variant_get_string_const(ctxt->as) : NULL;
     const char *onto = ctxt->onto ?
         purc_variant_get_string_const(ctxt->onto) : NULL;
-    purc_atom_t child_cid = pcintr_schedule_child_co(vdom, co->cid,
-            runner_name, onto, ctxt->with, body_id, false);
+    purc_atom_t child_cid;
+    if (runner_name == NULL && onto == NULL && !ctxt->synchronously) {
+        child_cid = pcintr_schedule_detached_child_co(vdom, co->cid,
+                ctxt->with, body_id);
+    }
+    else {
+        child_cid = pcintr_schedule_child_co(vdom, co->cid,
+                runner_name, onto, ctxt->with, body_id, false);
+    }
 
     if (!child_cid)
         return -1;
 
     ctxt->request_id = pcintr_crtn_observed_create(child_cid);
 
+    if (!ctxt->synchronously && pcintr_future_create(co, child_cid)) {
+        return -1;
+    }
+
     if (as) {
         pcintr_bind_named_variable(&co->stack, frame, as, ctxt->at, false,
                 false, ctxt->request_id);
@@ -581,6 +592,10 @@ static void on_fetch_async_resume_on_frame_pseudo(pcintr_coroutine_t co,
         purc_atom_t child_cid = pcintr_schedule_child_co(vdom, co->cid,
                 runner_name, onto, data->with, NULL, false);
 
+        if (child_cid) {
+            pcintr_future_create(co, child_cid);
+        }
+
         if (child_cid && as) {
             purc_variant_t request_id = pcintr_crtn_observed_create(child_cid);
             pcintr_bind_named_variable(&co->stack, frame, as, data->at, false,
@@ -996,7 +1011,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_load *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_load*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_load*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -60,7 +60,7 @@ ctxt_for_match_destroy(struct ctxt_for_match *ctxt)
         PURC_VARIANT_SAFE_CLEAR(ctxt->with);
 
         match_for_param_reset(&ctxt->param);
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -240,7 +240,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_match *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_match*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_match*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
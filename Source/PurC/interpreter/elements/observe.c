@@ -73,7 +73,7 @@ ctxt_for_observe_destroy(struct ctxt_for_observe *ctxt)
             free(ctxt->sub_type);
             ctxt->sub_type = NULL;
         }
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -108,10 +108,7 @@ bool base_variant_msg_listener(purc_variant_t source, pcvar_op_t msg_type,
     }
 
     pcintr_stack_t stack = (pcintr_stack_t)ctxt;
-    pcintr_coroutine_post_event(stack->co->cid,
-            PCRDR_MSG_EVENT_REDUCE_OPT_IGNORE,
-            source, smsg, NULL, PURC_VARIANT_INVALID,
-            PURC_VARIANT_INVALID);
+    pcintr_post_variant_change(stack->co->cid, source, smsg);
 
     return true;
 }
@@ -635,7 +632,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_observe *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_observe*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_observe*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -53,7 +53,7 @@ ctxt_for_reduce_destroy(struct ctxt_for_reduce *ctxt)
         PURC_VARIANT_SAFE_CLEAR(ctxt->on);
         PURC_VARIANT_SAFE_CLEAR(ctxt->with);
 
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -290,7 +290,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_reduce *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_reduce*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_reduce*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -49,6 +49,9 @@
 
 #define LEN_BUFF_LONGLONGINT    128
 
+/* the operation to wait for the results of the child coroutines */
+#define REQUEST_TO_AWAIT        "await"
+
 struct ctxt_for_request {
     struct pcvdom_node           *curr;
 
@@ -73,7 +76,7 @@ ctxt_for_request_destroy(struct ctxt_for_request *ctxt)
         PURC_VARIANT_SAFE_CLEAR(ctxt->as);
         PURC_VARIANT_SAFE_CLEAR(ctxt->with);
         PURC_VARIANT_SAFE_CLEAR(ctxt->request_id);
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -642,6 +645,10 @@ post_process(pcintr_coroutine_t co, struct pcintr_stack_frame *frame)
     else if (is_rdr(on)) {
         ret = request_rdr(co, frame, on);
     }
+    else if (purc_variant_is_array(on) &&
+            strcmp(purc_variant_get_string_const(to), REQUEST_TO_AWAIT) == 0) {
+        ret = pcintr_await_futures(co, frame, on);
+    }
     else {
         purc_set_error(PURC_ERROR_NOT_SUPPORTED);
         ret = -1;
@@ -829,7 +836,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_request *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_request*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_request*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -63,7 +63,7 @@ ctxt_for_sleep_destroy(struct ctxt_for_sleep *ctxt)
         }
         PURC_VARIANT_SAFE_CLEAR(ctxt->element_value);
 
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -392,7 +392,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_sleep *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_sleep*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_sleep*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
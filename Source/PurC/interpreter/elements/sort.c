@@ -92,7 +92,7 @@ ctxt_for_sort_destroy(struct ctxt_for_sort *ctxt)
             pcintr_unload_module(ctxt->handle);
             ctxt->handle = NULL;
         }
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -292,105 +292,43 @@ split_key(const char *key)
 }
 
 static int
-comp_number(double l, double r, bool ascendingly)
-{
-    if (ascendingly) {
-        return (l > r) ? 1 : (l < r ? -1 : 0);
-    }
-    return (l > r) ? -1 : (l < r ? 1 : 0);
-}
-
-static int
-comp_string(const char *l, const char *r, bool ascendingly, bool casesensitively)
-{
-    if (!l || !r) {
-        return 0;
-    }
-    int ret = casesensitively ? strcmp(l, r) : strcasecmp(l, r);
-    return ascendingly ? ret : -ret;
-}
-
-static char *
-variant_to_string(purc_variant_t v)
-{
-    if (!v) {
-        return NULL;
-    }
-
-    char *buf = NULL;
-    int total = purc_variant_stringify_alloc(&buf, v);
-    if (total < 0) {
-        return NULL;
-    }
-    return buf;
-}
-
-static int
-comp_raw(purc_variant_t l, purc_variant_t r, bool by_number,
-        bool ascendingly, bool casesensitively)
-{
-    if (by_number) {
-        double dl = l ? purc_variant_numerify(l) : 0.0f;
-        double dr = r ? purc_variant_numerify(r) : 0.0f;
-        return comp_number(dl, dr, ascendingly);
-    }
-
-    char *buf_l = variant_to_string(l);
-    char *buf_r = variant_to_string(r);
-    int ret = comp_string(buf_l, buf_r, ascendingly, casesensitively);
-
-    if (buf_l) {
-        free(buf_l);
-    }
-    if (buf_r) {
-        free(buf_r);
-    }
-
-    return ret;
-}
-
-static int
-comp_by_key(purc_variant_t l, purc_variant_t r, const char *key, bool by_number,
-        bool ascendingly, bool casesensitively)
-{
-    purc_variant_t lv = PURC_VARIANT_INVALID;
-    purc_variant_t rv = PURC_VARIANT_INVALID;
-    if (purc_variant_is_object(l)) {
-        lv = purc_variant_object_get_by_ckey(l, key);
-        purc_clr_error();
-    }
-
-    if (purc_variant_is_object(r)) {
-        rv = purc_variant_object_get_by_ckey(r, key);
-        purc_clr_error();
-    }
-
-    return comp_raw(lv, rv, by_number, ascendingly, casesensitively);
-}
-
-static int
-sort_cmp(purc_variant_t l, purc_variant_t r, void *data)
+extract_keys(purc_variant_t member, struct pcvariant_sort_key *keys,
+        void *data)
 {
     struct ctxt_for_sort *ctxt = data;
     size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
     for (size_t i = 0; i < nr_keys; i++) {
         struct sort_key *key = pcutils_arrlist_get_idx(ctxt->keys, i);
-        int ret = 0;
-        if (key->key == NULL) {
-            ret = comp_raw(l, r, key->by_number, ctxt->ascendingly,
-                    ctxt->casesensitively);
+        purc_variant_t v = member;
+        if (key->key) {
+            v = PURC_VARIANT_INVALID;
+            if (purc_variant_is_object(member)) {
+                v = purc_variant_object_get_by_ckey(member, key->key);
+                purc_clr_error();
+            }
         }
-        else {
-            ret = comp_by_key(l, r, key->key, key->by_number,
-                    ctxt->ascendingly, ctxt->casesensitively);
+
+        if (key->by_number) {
+            pcvariant_sort_key_number(keys + i, v);
         }
-        if (ret != 0) {
-            return ret;
+        else if (pcvariant_sort_key_string(keys + i, v)) {
+            return -1;
         }
     }
     return 0;
 }
 
+static unsigned int
+sort_flags(struct ctxt_for_sort *ctxt)
+{
+    unsigned int flags = 0;
+    if (!ctxt->ascendingly)
+        flags |= PCVRNT_SORT_DESC;
+    if (!ctxt->casesensitively)
+        flags |= PCVRNT_SORT_CASELESS;
+    return flags;
+}
+
 static bool
 sort_as_number(purc_variant_t val)
 {
@@ -457,7 +395,9 @@ sort_array(struct ctxt_for_sort *ctxt, purc_variant_t array,
             }
         }
     }
-    pcvariant_array_sort(array, ctxt, sort_cmp);
+    /* NOTE: the keys are extracted once instead of in every comparison */
+    pcvariant_array_sort_by_keys(array, pcutils_arrlist_length(ctxt->keys),
+            extract_keys, ctxt, sort_flags(ctxt));
 }
 
 
@@ -510,7 +450,9 @@ sort_set(struct ctxt_for_sort *ctxt, purc_variant_t set, purc_variant_t against)
             }
         }
     }
-    pcvariant_set_sort(set, ctxt, sort_cmp);
+    /* NOTE: the keys are extracted once instead of in every comparison */
+    pcvariant_set_sort_by_keys(set, pcutils_arrlist_length(ctxt->keys),
+            extract_keys, ctxt, sort_flags(ctxt));
 }
 
 static int
@@ -594,7 +536,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_sort *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_sort*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_sort*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
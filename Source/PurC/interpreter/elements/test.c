@@ -63,7 +63,7 @@ ctxt_for_test_destroy(struct ctxt_for_test *ctxt)
         PURC_VARIANT_SAFE_CLEAR(ctxt->on);
         PURC_VARIANT_SAFE_CLEAR(ctxt->with);
 
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -262,7 +262,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_test *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_test*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_test*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -45,7 +45,7 @@ ctxt_for_undefined_destroy(struct ctxt_for_undefined *ctxt)
 {
     if (ctxt) {
         PURC_VARIANT_SAFE_CLEAR(ctxt->href);
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -185,7 +185,8 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_undefined *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_undefined*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_undefined*)pcintr_frame_pool_alloc(
+                sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -83,6 +83,8 @@ struct ctxt_for_update {
 
     purc_variant_t                literal;
     purc_variant_t                template_data_type;
+    /* the template expanded to the source, if any */
+    purc_variant_t                template;
 
     purc_variant_t                sync_id;
     purc_variant_t                params;
@@ -100,7 +102,8 @@ static int
 update_elements(pcintr_stack_t stack, purc_variant_t elems,
         purc_variant_t pos, enum update_action action,
         purc_variant_t src, pcintr_attribute_op attr_op_eval,
-        purc_variant_t template_data_type, enum update_action operator);
+        purc_variant_t template_data_type, purc_variant_t template,
+        enum update_action operator);
 
 static int
 update_container(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
@@ -120,13 +123,14 @@ ctxt_for_update_destroy(struct ctxt_for_update *ctxt)
         PURC_VARIANT_SAFE_CLEAR(ctxt->with);
         PURC_VARIANT_SAFE_CLEAR(ctxt->literal);
         PURC_VARIANT_SAFE_CLEAR(ctxt->template_data_type);
+        PURC_VARIANT_SAFE_CLEAR(ctxt->template);
         PURC_VARIANT_SAFE_CLEAR(ctxt->sync_id);
         PURC_VARIANT_SAFE_CLEAR(ctxt->params);
         if (ctxt->resp) {
             purc_rwstream_destroy(ctxt->resp);
             ctxt->resp = NULL;
         }
-        free(ctxt);
+        pcintr_frame_pool_free(ctxt);
     }
 }
 
@@ -147,12 +151,14 @@ get_source_by_with(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
         return with;
     }
     else if (purc_variant_is_native(with)) {
+        struct ctxt_for_update *ctxt;
+        ctxt = (struct ctxt_for_update*)frame->ctxt;
         purc_variant_t type = pcintr_template_get_type(with);
         if (type) {
-            struct ctxt_for_update *ctxt;
-            ctxt = (struct ctxt_for_update*)frame->ctxt;
             ctxt->template_data_type = purc_variant_ref(type);
         }
+        PURC_VARIANT_SAFE_CLEAR(ctxt->template);
+        ctxt->template = purc_variant_ref(with);
         return pcintr_template_expansion(with);
     }
     else {
@@ -1518,11 +1524,78 @@ is_no_return()
     return conn && (conn->prot != PURC_RDRCOMM_THREAD);
 }
 
+/*
+ * NOTE: an element whose attribute or text content is not changed by a
+ * displacement is skipped, so that no operation is sent to the renderer
+ * for it when the same data are updated to many elements.
+ */
+static bool
+is_same_attr(purc_document_t doc, pcdoc_element_t target, const char *name,
+        const char *val, size_t len)
+{
+    const char *origin = NULL;
+    size_t origin_len = 0;
+    if (pcdoc_element_get_attribute(doc, target, name, &origin, &origin_len)
+            || origin == NULL) {
+        purc_clr_error();
+        return false;
+    }
+
+    return origin_len == len && memcmp(origin, val, len) == 0;
+}
+
+static bool
+is_same_text_content(purc_document_t doc, pcdoc_element_t target,
+        const char *text, size_t len)
+{
+    pcdoc_node node = pcdoc_element_first_child(doc, target);
+    if (node.type == PCDOC_NODE_VOID)
+        return len == 0;
+
+    if (node.type != PCDOC_NODE_TEXT ||
+            pcdoc_node_next_sibling(doc, node).type != PCDOC_NODE_VOID)
+        return false;
+
+    const char *origin;
+    size_t origin_len;
+    if (pcdoc_text_content_get_text(doc, node.text_node, &origin,
+                &origin_len)) {
+        purc_clr_error();
+        return false;
+    }
+
+    return origin_len == len && memcmp(origin, text, len) == 0;
+}
+
+static int
+set_elem_text_content(pcintr_stack_t stack, pcdoc_element_t target,
+        pcdoc_operation_k op, const char *text, size_t len)
+{
+    if (op == PCDOC_OP_DISPLACE &&
+            is_same_text_content(stack->doc, target, text, len))
+        return 0;
+
+    pcintr_util_new_text_content(stack->doc, target, op, text, len, true,
+            is_no_return());
+    return 0;
+}
+
+static int
+displace_attr_value(pcintr_stack_t stack, pcdoc_element_t target,
+        const char *name, const char *val, size_t len)
+{
+    if (is_same_attr(stack->doc, target, name, val, len))
+        return 0;
+
+    return pcintr_util_set_attribute(stack->doc, target,
+            PCDOC_OP_DISPLACE, name, val, len, true, is_no_return());
+}
+
 static int
 update_elem_child(pcintr_stack_t stack, pcdoc_element_t target,
         enum update_action action, purc_variant_t src,
         pcintr_attribute_op attr_op_eval, purc_variant_t template_data_type,
-        enum update_action operator)
+        purc_variant_t template, enum update_action operator)
 {
     UNUSED_PARAM(stack);
     UNUSED_PARAM(action);
@@ -1546,7 +1619,13 @@ update_elem_child(pcintr_stack_t stack, pcdoc_element_t target,
     UNUSED_PARAM(attr_op_eval);
 
     pcdoc_operation_k op = convert_operation(operator);
-    if (op != PCDOC_OP_UNKNOWN) {
+    if (op != PCDOC_OP_UNKNOWN && template && purc_variant_is_string(src)) {
+        /* build the nodes from the values of the slots if possible */
+        pcintr_util_new_tpl_content(stack->doc, target, op, template, src,
+                template_data_type, true, is_no_return());
+        return 0;
+    }
+    else if (op != PCDOC_OP_UNKNOWN) {
         pcintr_util_new_content(stack->doc, target, op, s, 0,
                 template_data_type, true, is_no_return());
         if (t)
@@ -1579,16 +1658,13 @@ update_elem_content(pcintr_stack_t stack, pcdoc_element_t target,
         size_t len;
         const char *s = purc_variant_get_string_const_ex(src, &len);
 
-        pcintr_util_new_text_content(stack->doc, target, op, s, len, true,
-                is_no_return());
-        return 0;
+        return set_elem_text_content(stack, target, op, s, len);
     }
     else {
         char *buf = NULL;
         int total = purc_variant_stringify_alloc(&buf, src);
         if (buf) {
-            pcintr_util_new_text_content(stack->doc, target, op, buf, total, true,
-                    is_no_return());
+            set_elem_text_content(stack, target, op, buf, total);
             free(buf);
             return 0;
         }
@@ -1632,8 +1708,7 @@ displace_elem_attr(pcintr_stack_t stack, pcdoc_element_t target,
             return -1;
         }
 
-        r = pcintr_util_set_attribute(stack->doc, target,
-                PCDOC_OP_DISPLACE, pos, s, sz, true, is_no_return());
+        r = displace_attr_value(stack, target, pos, s, sz);
         purc_variant_unref(v);
     }
     else {
@@ -1642,8 +1717,7 @@ displace_elem_attr(pcintr_stack_t stack, pcdoc_element_t target,
             purc_variant_unref(v);
             return -1;
         }
-        r = pcintr_util_set_attribute(stack->doc, target,
-                PCDOC_OP_DISPLACE, pos, s, strlen(s), true, is_no_return());
+        r = displace_attr_value(stack, target, pos, s, strlen(s));
         purc_variant_unref(v);
         free(s);
     }
@@ -1664,9 +1738,10 @@ update_elem_attr(pcintr_stack_t stack, pcdoc_element_t target,
         return -1;
     }
     char *sv = pcvariant_to_string(src);
+    if (sv == NULL)
+        return -1;
 
-    pcintr_util_set_attribute(stack->doc, target,
-            PCDOC_OP_DISPLACE, pos, sv, 0, true, is_no_return());
+    displace_attr_value(stack, target, pos, sv, strlen(sv));
     free(sv);
 
     return 0;
@@ -1676,7 +1751,7 @@ static int
 update_elem(pcintr_stack_t stack, pcdoc_element_t target,
         purc_variant_t pos, enum update_action action, purc_variant_t src,
         pcintr_attribute_op attr_op_eval, purc_variant_t template_data_type,
-        enum update_action operator)
+        purc_variant_t template, enum update_action operator)
 {
     const char *s_pos = NULL;
     if (pos != PURC_VARIANT_INVALID) {
@@ -1685,7 +1760,7 @@ update_elem(pcintr_stack_t stack, pcdoc_element_t target,
 
     if (!s_pos || strcmp(s_pos, AT_KEY_CONTENT) == 0) {
         return update_elem_child(stack, target, action, src, attr_op_eval,
-                template_data_type, operator);
+                template_data_type, template, operator);
     }
     if (strcmp(s_pos, AT_KEY_TEXT_CONTENT) == 0) {
         return update_elem_content(stack, target, action, src, attr_op_eval, operator);
@@ -1702,7 +1777,8 @@ int
 update_elements(pcintr_stack_t stack, purc_variant_t elems,
         purc_variant_t pos, enum update_action action,
         purc_variant_t src, pcintr_attribute_op attr_op_eval,
-        purc_variant_t template_data_type, enum update_action operator)
+        purc_variant_t template_data_type, purc_variant_t template,
+        enum update_action operator)
 {
     size_t idx = 0;
     while (1) {
@@ -1711,7 +1787,7 @@ update_elements(pcintr_stack_t stack, purc_variant_t elems,
         if (!target)
             break;
         int r = update_elem(stack, target, pos, action, src, attr_op_eval,
-                template_data_type, operator);
+                template_data_type, template, operator);
         if (r)
             return -1;
     }
@@ -1794,13 +1870,13 @@ process_elem_coll(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
     switch (nr_dst_pos) {
     case 0:
         ret = update_elements(&co->stack, dst, pos, action, src, attr_op_eval,
-                template_data_type, ctxt->action);
+                template_data_type, ctxt->template, ctxt->action);
         break;
 
     case 1:
         pos = purc_variant_array_get(dst_pos, 0);
         ret = update_elements(&co->stack, dst, pos, action, src, attr_op_eval,
-                template_data_type, ctxt->action);
+                template_data_type, ctxt->template, ctxt->action);
         break;
 
     default:
@@ -1820,7 +1896,8 @@ process_elem_coll(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
             }
 
             ret = update_elements(&co->stack, dst, new_pos, action, new_src,
-                    attr_op_eval, template_data_type, ctxt->action);
+                    attr_op_eval, template_data_type, ctxt->template,
+                    ctxt->action);
             if (ret) {
                 goto out;
             }
@@ -1845,6 +1922,9 @@ process_container(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
     purc_variant_t pos = PURC_VARIANT_INVALID;
     size_t nr_dst_pos = dst_pos ? purc_variant_array_get_size(dst_pos) : 0;
 
+    /* the members of sets may be updated in bulk; revalidate the sets once */
+    pcvariant_begin_deferred_revalidation();
+
     switch (nr_dst_pos) {
     case 0:
         ret = update_container(co, frame, dst, pos, action, src, attr_op_eval,
@@ -1884,6 +1964,8 @@ process_container(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
     }
 
 out:
+    if (pcvariant_end_deferred_revalidation())
+        ret = -1;
     return ret;
 }
 
@@ -1949,6 +2031,12 @@ process(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
         purc_document_t doc = co->stack.doc;
         purc_variant_t elems;
 
+        /* NOTE: nothing matches in a void document; do not make the
+           element collection for it. */
+        if (purc_document_type(doc) == PCDOC_K_TYPE_VOID) {
+            goto out;
+        }
+
         size_t op_len = 0;
         const char *op = pcutils_trim_spaces(s, &op_len);
         if (op && op[0] == '>') {
@@ -2273,7 +2361,7 @@ after_pushed(pcintr_stack_t stack, pcvdom_element_t pos)
 
     struct ctxt_for_update *ctxt = frame->ctxt;
     if (!ctxt) {
-        ctxt = (struct ctxt_for_update*)calloc(1, sizeof(*ctxt));
+        ctxt = (struct ctxt_for_update*)pcintr_frame_pool_alloc(sizeof(*ctxt));
         if (!ctxt) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return NULL;
@@ -0,0 +1,745 @@
+/*
+ * @file evloop.c
+ * @date 2026/10/14
+ * @brief The native epoll backend of the run loop.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc-runloop.h"
+#include "private/debug.h"
+#include "private/evloop.h"
+#include "private/list.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if ENABLE(EPOLL_RUNLOOP) && OS(LINUX)
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+/* the events handled by one call of epoll_wait() at most */
+#define MAX_EVENTS              64
+
+/* NOTE: The data of the epoll events are the file descriptors; the eventfd
+   and the timerfd are told from the monitored ones by their numbers. */
+
+struct fd_monitor {
+    struct list_head        ln;         // in fd_entry::monitors
+    struct list_head        ln_dead;    // in pcintr_evloop::dead_monitors
+    int                     fd;
+    uint32_t                events;     // PCRUNLOOP_IO_*
+    bool                    removed;
+    purc_runloop_io_callback callback;
+    void                   *ctxt;
+};
+
+/* all monitors of a file descriptor share its epoll registration */
+struct fd_entry {
+    struct list_head        monitors;
+    uint32_t                events;     // the union of the monitors
+};
+
+struct task {
+    struct task            *next;
+    purc_runloop_func       func;
+    void                   *ctxt;
+};
+
+struct timer {
+    size_t                  heap_idx;
+    uint64_t                deadline;   // in nanoseconds, monotonic
+    uint32_t                interval;   // in milliseconds; 0 for one-shot
+    purc_runloop_func       func;
+    purc_runloop_timeout_callback callback;
+    void                   *ctxt;
+};
+
+struct pcintr_evloop {
+    /* the run loop owning this; NULL if the event loop is destroyed */
+    _Atomic(purc_runloop_t) runloop;
+    struct pcintr_evloop   *next;       // in the registry; never removed
+
+    int                     epfd;
+    int                     evfd;       // signalled by the dispatchers
+    int                     tmfd;       // armed for the earliest timer
+
+    /* the file descriptors monitored, indexed by the numbers */
+    struct fd_entry       **fds;
+    size_t                  sz_fds;
+
+    /* the monitors removed when handling the events; freed after that */
+    struct list_head        dead_monitors;
+    bool                    handling;
+
+    /* the functions dispatched from any thread, in the reverse order */
+    _Atomic(struct task *)  tasks;
+
+    /* the min-heap of the timers by the deadlines */
+    struct timer          **timers;
+    size_t                  nr_timers;
+    size_t                  sz_timers;
+    uint64_t                armed;      // the deadline of tmfd; 0 for none
+};
+
+/* The event loops of all run loops, which can be looked up by the threads
+   dispatching functions without a lock. An event loop destroyed is kept
+   in the registry, and is reused by the next run loop. The run loop of an
+   event loop being set up or torn down is -1. */
+static _Atomic(struct pcintr_evloop *) registry;
+
+static uint32_t to_epoll_events(uint32_t event)
+{
+    uint32_t events = 0;
+    if (event & PCRUNLOOP_IO_IN)
+        events |= EPOLLIN;
+    if (event & PCRUNLOOP_IO_PRI)
+        events |= EPOLLPRI;
+    if (event & PCRUNLOOP_IO_OUT)
+        events |= EPOLLOUT;
+    /* EPOLLERR and EPOLLHUP are always reported */
+    return events;
+}
+
+static uint32_t to_runloop_io_event(uint32_t events)
+{
+    uint32_t event = 0;
+    if (events & EPOLLIN)
+        event |= PCRUNLOOP_IO_IN;
+    if (events & EPOLLPRI)
+        event |= PCRUNLOOP_IO_PRI;
+    if (events & EPOLLOUT)
+        event |= PCRUNLOOP_IO_OUT;
+    if (events & EPOLLERR)
+        event |= PCRUNLOOP_IO_ERR;
+    if (events & EPOLLHUP)
+        event |= PCRUNLOOP_IO_HUP;
+    return event;
+}
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int watch_fd(struct pcintr_evloop *evloop, int fd, uint32_t events)
+{
+    struct epoll_event ev = { .events = events, .data = { .fd = fd } };
+    return epoll_ctl(evloop->epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+struct pcintr_evloop *pcintr_evloop_create(purc_runloop_t runloop)
+{
+    struct pcintr_evloop *evloop;
+
+    /* reuse an event loop destroyed */
+    for (evloop = atomic_load(&registry); evloop; evloop = evloop->next) {
+        purc_runloop_t none = NULL;
+        if (atomic_compare_exchange_strong(&evloop->runloop, &none,
+                    (purc_runloop_t)-1))
+            break;
+    }
+
+    bool reused = (evloop != NULL);
+    if (!reused) {
+        evloop = calloc(1, sizeof(*evloop));
+        if (evloop == NULL)
+            return NULL;
+    }
+
+    evloop->epfd = epoll_create1(EPOLL_CLOEXEC);
+    evloop->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    evloop->tmfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    list_head_init(&evloop->dead_monitors);
+    atomic_store(&evloop->tasks, NULL);
+    if (evloop->epfd < 0 || evloop->evfd < 0 || evloop->tmfd < 0 ||
+            watch_fd(evloop, evloop->evfd, EPOLLIN) ||
+            watch_fd(evloop, evloop->tmfd, EPOLLIN)) {
+        PC_WARN("Failed to set up the epoll event loop: %s\n",
+                strerror(errno));
+        goto failed;
+    }
+
+    atomic_store(&evloop->runloop, runloop);
+    if (!reused) {
+        struct pcintr_evloop *head = atomic_load(&registry);
+        do {
+            evloop->next = head;
+        } while (!atomic_compare_exchange_weak(&registry, &head, evloop));
+    }
+
+    return evloop;
+
+failed:
+    if (evloop->epfd >= 0)
+        close(evloop->epfd);
+    if (evloop->evfd >= 0)
+        close(evloop->evfd);
+    if (evloop->tmfd >= 0)
+        close(evloop->tmfd);
+    evloop->epfd = evloop->evfd = evloop->tmfd = -1;
+
+    if (reused)
+        atomic_store(&evloop->runloop, NULL);
+    else
+        free(evloop);
+    return NULL;
+}
+
+static void free_dead_monitors(struct pcintr_evloop *evloop)
+{
+    struct fd_monitor *p, *n;
+    list_for_each_entry_safe(p, n, &evloop->dead_monitors, ln_dead) {
+        list_del(&p->ln_dead);
+        free(p);
+    }
+}
+
+void pcintr_evloop_destroy(struct pcintr_evloop *evloop)
+{
+    /* no more dispatching to this */
+    atomic_store(&evloop->runloop, (purc_runloop_t)-1);
+
+    struct task *task = atomic_exchange(&evloop->tasks, NULL);
+    while (task) {
+        struct task *next = task->next;
+        free(task);
+        task = next;
+    }
+
+    for (size_t i = 0; i < evloop->nr_timers; i++)
+        free(evloop->timers[i]);
+    free(evloop->timers);
+    evloop->timers = NULL;
+    evloop->nr_timers = evloop->sz_timers = 0;
+    evloop->armed = 0;
+
+    for (size_t fd = 0; fd < evloop->sz_fds; fd++) {
+        struct fd_entry *entry = evloop->fds[fd];
+        if (entry == NULL)
+            continue;
+
+        struct fd_monitor *p, *n;
+        list_for_each_entry_safe(p, n, &entry->monitors, ln) {
+            list_del(&p->ln);
+            if (!p->removed)
+                free(p);
+        }
+        free(entry);
+    }
+    free(evloop->fds);
+    evloop->fds = NULL;
+    evloop->sz_fds = 0;
+    free_dead_monitors(evloop);
+
+    close(evloop->epfd);
+    close(evloop->evfd);
+    close(evloop->tmfd);
+    evloop->epfd = evloop->evfd = evloop->tmfd = -1;
+
+    /* now it can be reused */
+    atomic_store(&evloop->runloop, NULL);
+}
+
+struct pcintr_evloop *pcintr_evloop_find(purc_runloop_t runloop)
+{
+    if (runloop == NULL)
+        return NULL;
+
+    struct pcintr_evloop *evloop;
+    for (evloop = atomic_load(&registry); evloop; evloop = evloop->next) {
+        if (atomic_load(&evloop->runloop) == runloop)
+            return evloop;
+    }
+
+    return NULL;
+}
+
+int pcintr_evloop_fd(struct pcintr_evloop *evloop)
+{
+    return evloop->epfd;
+}
+
+static int update_fd_entry(struct pcintr_evloop *evloop, int fd,
+        struct fd_entry *entry, bool is_new)
+{
+    uint32_t events = 0;
+    struct fd_monitor *p;
+    list_for_each_entry(p, &entry->monitors, ln) {
+        if (!p->removed)
+            events |= p->events;
+    }
+
+    if (!is_new && events == entry->events)
+        return 0;
+
+    struct epoll_event ev = {
+        .events = to_epoll_events(events), .data = { .fd = fd } };
+    int r;
+    if (is_new) {
+        r = epoll_ctl(evloop->epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+    else {
+        r = epoll_ctl(evloop->epfd, EPOLL_CTL_MOD, fd, &ev);
+        /* the file descriptor was closed and the number reused */
+        if (r && errno == ENOENT)
+            r = epoll_ctl(evloop->epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    if (r == 0)
+        entry->events = events;
+    return r;
+}
+
+uintptr_t pcintr_evloop_add_fd_monitor(struct pcintr_evloop *evloop, int fd,
+        purc_runloop_io_event event, purc_runloop_io_callback callback,
+        void *ctxt)
+{
+    if (fd < 0 || fd == evloop->evfd || fd == evloop->tmfd)
+        return 0;
+
+    if ((size_t)fd >= evloop->sz_fds) {
+        size_t sz = evloop->sz_fds ? evloop->sz_fds : 64;
+        while (sz <= (size_t)fd)
+            sz <<= 1;
+
+        struct fd_entry **fds = realloc(evloop->fds, sizeof(*fds) * sz);
+        if (fds == NULL)
+            return 0;
+        memset(fds + evloop->sz_fds, 0,
+                sizeof(*fds) * (sz - evloop->sz_fds));
+        evloop->fds = fds;
+        evloop->sz_fds = sz;
+    }
+
+    struct fd_monitor *monitor = calloc(1, sizeof(*monitor));
+    if (monitor == NULL)
+        return 0;
+    monitor->fd = fd;
+    monitor->events = event;
+    monitor->callback = callback;
+    monitor->ctxt = ctxt;
+
+    struct fd_entry *entry = evloop->fds[fd];
+    bool is_new = (entry == NULL);
+    if (is_new) {
+        entry = calloc(1, sizeof(*entry));
+        if (entry == NULL) {
+            free(monitor);
+            return 0;
+        }
+        list_head_init(&entry->monitors);
+    }
+
+    list_add_tail(&monitor->ln, &entry->monitors);
+    if (update_fd_entry(evloop, fd, entry, is_new)) {
+        /* e.g., EPERM for a regular file */
+        list_del(&monitor->ln);
+        free(monitor);
+        if (is_new)
+            free(entry);
+        return 0;
+    }
+
+    evloop->fds[fd] = entry;
+    return (uintptr_t)monitor | PCINTR_EVLOOP_HANDLE_TAG;
+}
+
+static void release_fd_entry(struct pcintr_evloop *evloop, int fd)
+{
+    struct fd_entry *entry = evloop->fds[fd];
+    if (!list_empty(&entry->monitors))
+        return;
+
+    /* NOTE: it fails if the file descriptor has been closed */
+    epoll_ctl(evloop->epfd, EPOLL_CTL_DEL, fd, NULL);
+    free(entry);
+    evloop->fds[fd] = NULL;
+}
+
+void pcintr_evloop_remove_fd_monitor(struct pcintr_evloop *evloop,
+        uintptr_t handle)
+{
+    struct fd_monitor *monitor = (struct fd_monitor *)
+        (handle & ~PCINTR_EVLOOP_HANDLE_TAG);
+    if (monitor == NULL || monitor->removed)
+        return;
+
+    int fd = monitor->fd;
+    struct fd_entry *entry = evloop->fds[fd];
+
+    if (evloop->handling) {
+        /* keep the list intact for the monitors being called */
+        monitor->removed = true;
+        list_add_tail(&monitor->ln_dead, &evloop->dead_monitors);
+        update_fd_entry(evloop, fd, entry, false);
+        return;
+    }
+
+    list_del(&monitor->ln);
+    free(monitor);
+    if (list_empty(&entry->monitors))
+        release_fd_entry(evloop, fd);
+    else
+        update_fd_entry(evloop, fd, entry, false);
+}
+
+int pcintr_evloop_dispatch(struct pcintr_evloop *evloop,
+        purc_runloop_func func, void *ctxt)
+{
+    struct task *task = malloc(sizeof(*task));
+    if (task == NULL)
+        return -1;
+    task->func = func;
+    task->ctxt = ctxt;
+
+    struct task *head = atomic_load(&evloop->tasks);
+    do {
+        task->next = head;
+    } while (!atomic_compare_exchange_weak(&evloop->tasks, &head, task));
+
+    /* only the first one since the last drain signals the event loop */
+    if (head == NULL) {
+        uint64_t one = 1;
+        if (write(evloop->evfd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+            return -1;
+    }
+
+    return 0;
+}
+
+static void run_tasks(struct pcintr_evloop *evloop)
+{
+    uint64_t count;
+    if (read(evloop->evfd, &count, sizeof(count)) < 0)
+        return;
+
+    struct task *task = atomic_exchange(&evloop->tasks, NULL);
+
+    /* the tasks were pushed in the reverse order */
+    struct task *fifo = NULL;
+    while (task) {
+        struct task *next = task->next;
+        task->next = fifo;
+        fifo = task;
+        task = next;
+    }
+
+    while (fifo) {
+        struct task *next = fifo->next;
+        fifo->func(fifo->ctxt);
+        free(fifo);
+        fifo = next;
+    }
+}
+
+static inline bool timer_before(const struct timer *a, const struct timer *b)
+{
+    return a->deadline < b->deadline;
+}
+
+static void heap_swap(struct timer **heap, size_t i, size_t j)
+{
+    struct timer *t = heap[i];
+    heap[i] = heap[j];
+    heap[j] = t;
+    heap[i]->heap_idx = i;
+    heap[j]->heap_idx = j;
+}
+
+static void heap_up(struct timer **heap, size_t i)
+{
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!timer_before(heap[i], heap[parent]))
+            break;
+        heap_swap(heap, i, parent);
+        i = parent;
+    }
+}
+
+static void heap_down(struct timer **heap, size_t nr, size_t i)
+{
+    for (;;) {
+        size_t l = 2 * i + 1, r = l + 1, min = i;
+        if (l < nr && timer_before(heap[l], heap[min]))
+            min = l;
+        if (r < nr && timer_before(heap[r], heap[min]))
+            min = r;
+        if (min == i)
+            break;
+        heap_swap(heap, i, min);
+        i = min;
+    }
+}
+
+static void arm_timerfd(struct pcintr_evloop *evloop)
+{
+    uint64_t deadline = evloop->nr_timers ? evloop->timers[0]->deadline : 0;
+    if (deadline == evloop->armed)
+        return;
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (deadline) {
+        its.it_value.tv_sec = deadline / 1000000000ULL;
+        its.it_value.tv_nsec = deadline % 1000000000ULL;
+    }
+
+    if (timerfd_settime(evloop->tmfd, TFD_TIMER_ABSTIME, &its, NULL) == 0)
+        evloop->armed = deadline;
+}
+
+static int add_timer(struct pcintr_evloop *evloop, struct timer *timer)
+{
+    if (evloop->nr_timers == evloop->sz_timers) {
+        size_t sz = evloop->sz_timers ? evloop->sz_timers * 2 : 16;
+        struct timer **timers = realloc(evloop->timers, sizeof(*timers) * sz);
+        if (timers == NULL)
+            return -1;
+        evloop->timers = timers;
+        evloop->sz_timers = sz;
+    }
+
+    timer->heap_idx = evloop->nr_timers++;
+    evloop->timers[timer->heap_idx] = timer;
+    heap_up(evloop->timers, timer->heap_idx);
+
+    if (timer->heap_idx == 0)
+        arm_timerfd(evloop);
+    return 0;
+}
+
+static struct timer *pop_timer(struct pcintr_evloop *evloop)
+{
+    struct timer **heap = evloop->timers;
+    struct timer *timer = heap[0];
+
+    evloop->nr_timers--;
+    if (evloop->nr_timers) {
+        heap[0] = heap[evloop->nr_timers];
+        heap[0]->heap_idx = 0;
+        heap_down(heap, evloop->nr_timers, 0);
+    }
+
+    return timer;
+}
+
+static void fire_timers(struct pcintr_evloop *evloop)
+{
+    uint64_t count;
+    if (read(evloop->tmfd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        return;
+
+    /* the timerfd is disarmed once expired */
+    evloop->armed = 0;
+
+    uint64_t now = now_ns();
+    while (evloop->nr_timers && evloop->timers[0]->deadline <= now) {
+        struct timer *timer = pop_timer(evloop);
+
+        bool again = false;
+        if (timer->callback)
+            again = timer->callback(timer->ctxt);
+        else
+            timer->func(timer->ctxt);
+
+        if (again) {
+            timer->deadline = now + timer->interval * 1000000ULL;
+            if (add_timer(evloop, timer) == 0)
+                continue;
+        }
+        free(timer);
+    }
+
+    arm_timerfd(evloop);
+}
+
+int pcintr_evloop_dispatch_after(struct pcintr_evloop *evloop, long time_ms,
+        purc_runloop_func func, void *ctxt)
+{
+    struct timer *timer = calloc(1, sizeof(*timer));
+    if (timer == NULL)
+        return -1;
+
+    /* NOTE: the deadline 0 stands for no timer armed */
+    timer->deadline = now_ns() + (time_ms > 0 ? time_ms : 0) * 1000000ULL + 1;
+    timer->func = func;
+    timer->ctxt = ctxt;
+    if (add_timer(evloop, timer)) {
+        free(timer);
+        return -1;
+    }
+    return 0;
+}
+
+int pcintr_evloop_set_timeout(struct pcintr_evloop *evloop,
+        purc_runloop_timeout_callback callback, void *ctxt, uint32_t interval)
+{
+    struct timer *timer = calloc(1, sizeof(*timer));
+    if (timer == NULL)
+        return -1;
+
+    timer->deadline = now_ns() + interval * 1000000ULL + 1;
+    timer->interval = interval;
+    timer->callback = callback;
+    timer->ctxt = ctxt;
+    if (add_timer(evloop, timer)) {
+        free(timer);
+        return -1;
+    }
+    return 0;
+}
+
+static void call_monitors(struct pcintr_evloop *evloop, int fd,
+        uint32_t events)
+{
+    if ((size_t)fd >= evloop->sz_fds || evloop->fds[fd] == NULL)
+        return;
+
+    uint32_t event = to_runloop_io_event(events);
+    struct fd_entry *entry = evloop->fds[fd];
+    struct fd_monitor *p;
+    list_for_each_entry(p, &entry->monitors, ln) {
+        /* the errors and the hang-ups are reported to all monitors */
+        uint32_t mine = event & (p->events |
+                PCRUNLOOP_IO_ERR | PCRUNLOOP_IO_HUP);
+        if (!p->removed && mine)
+            p->callback(fd, (purc_runloop_io_event)mine, p->ctxt);
+    }
+}
+
+void pcintr_evloop_handle_events(struct pcintr_evloop *evloop)
+{
+    struct epoll_event events[MAX_EVENTS];
+    int n = epoll_wait(evloop->epfd, events, MAX_EVENTS, 0);
+    if (n <= 0)
+        return;
+
+    evloop->handling = true;
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        if (fd == evloop->evfd)
+            run_tasks(evloop);
+        else if (fd == evloop->tmfd)
+            fire_timers(evloop);
+        else
+            call_monitors(evloop, fd, events[i].events);
+    }
+    evloop->handling = false;
+
+    /* unlink the monitors removed by the callbacks */
+    struct fd_monitor *p, *q;
+    list_for_each_entry_safe(p, q, &evloop->dead_monitors, ln_dead) {
+        int fd = p->fd;
+        list_del(&p->ln);
+        list_del(&p->ln_dead);
+        free(p);
+        release_fd_entry(evloop, fd);
+    }
+}
+
+#else   /* ENABLE(EPOLL_RUNLOOP) && OS(LINUX) */
+
+struct pcintr_evloop *pcintr_evloop_create(purc_runloop_t runloop)
+{
+    UNUSED_PARAM(runloop);
+    return NULL;
+}
+
+void pcintr_evloop_destroy(struct pcintr_evloop *evloop)
+{
+    UNUSED_PARAM(evloop);
+}
+
+struct pcintr_evloop *pcintr_evloop_find(purc_runloop_t runloop)
+{
+    UNUSED_PARAM(runloop);
+    return NULL;
+}
+
+int pcintr_evloop_fd(struct pcintr_evloop *evloop)
+{
+    UNUSED_PARAM(evloop);
+    return -1;
+}
+
+void pcintr_evloop_handle_events(struct pcintr_evloop *evloop)
+{
+    UNUSED_PARAM(evloop);
+}
+
+uintptr_t pcintr_evloop_add_fd_monitor(struct pcintr_evloop *evloop, int fd,
+        purc_runloop_io_event event, purc_runloop_io_callback callback,
+        void *ctxt)
+{
+    UNUSED_PARAM(evloop);
+    UNUSED_PARAM(fd);
+    UNUSED_PARAM(event);
+    UNUSED_PARAM(callback);
+    UNUSED_PARAM(ctxt);
+    return 0;
+}
+
+void pcintr_evloop_remove_fd_monitor(struct pcintr_evloop *evloop,
+        uintptr_t handle)
+{
+    UNUSED_PARAM(evloop);
+    UNUSED_PARAM(handle);
+}
+
+int pcintr_evloop_dispatch(struct pcintr_evloop *evloop,
+        purc_runloop_func func, void *ctxt)
+{
+    UNUSED_PARAM(evloop);
+    UNUSED_PARAM(func);
+    UNUSED_PARAM(ctxt);
+    return -1;
+}
+
+int pcintr_evloop_dispatch_after(struct pcintr_evloop *evloop, long time_ms,
+        purc_runloop_func func, void *ctxt)
+{
+    UNUSED_PARAM(evloop);
+    UNUSED_PARAM(time_ms);
+    UNUSED_PARAM(func);
+    UNUSED_PARAM(ctxt);
+    return -1;
+}
+
+int pcintr_evloop_set_timeout(struct pcintr_evloop *evloop,
+        purc_runloop_timeout_callback callback, void *ctxt, uint32_t interval)
+{
+    UNUSED_PARAM(evloop);
+    UNUSED_PARAM(callback);
+    UNUSED_PARAM(ctxt);
+    UNUSED_PARAM(interval);
+    return -1;
+}
+
+#endif  /* !ENABLE(EPOLL_RUNLOOP) || !OS(LINUX) */
@@ -0,0 +1,173 @@
+/*
+ * @file frame-pool.c
+ * @date 2026/10/14
+ * @brief The pool of the stack frames and the contexts of the elements.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "internal.h"
+
+#include "private/errors.h"
+#include "private/instance.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the size of the smallest class; the size doubles from a class to next */
+#define MIN_CLASS_SIZE          64
+
+/* the blocks kept in the free list of a size class at most */
+#define MAX_FREE_BLOCKS         64
+
+/*
+ * Every block is allocated on the heap individually, with a header holding
+ * its size class, so that it can be freed to the pool of any instance, or
+ * to the heap when there is no pool any longer.
+ */
+union block_header {
+    union block_header *next;   // in a free list
+    size_t              cls;    // in use
+    long double         align;  // keep the payload aligned
+};
+
+static inline size_t size_class(size_t size)
+{
+    size_t cls = 0;
+    size_t sz = MIN_CLASS_SIZE;
+    while (sz < size && cls < PCINTR_FRAME_POOL_NR_CLASSES) {
+        sz <<= 1;
+        cls++;
+    }
+
+    return cls;
+}
+
+static inline struct pcintr_frame_pool *current_pool(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->intr_heap == NULL)
+        return NULL;
+    return &inst->intr_heap->frame_pool;
+}
+
+void *
+pcintr_frame_pool_alloc(size_t size)
+{
+    struct pcintr_frame_pool *pool = current_pool();
+    size_t cls = size_class(size);
+    union block_header *hdr = NULL;
+
+    if (cls < PCINTR_FRAME_POOL_NR_CLASSES) {
+        if (pool && pool->free_blocks[cls]) {
+            hdr = pool->free_blocks[cls];
+            pool->free_blocks[cls] = hdr->next;
+            pool->nr_free[cls]--;
+            pool->nr_reused++;
+        }
+        else {
+            hdr = malloc(sizeof(*hdr) + (MIN_CLASS_SIZE << cls));
+        }
+    }
+    else {
+        hdr = malloc(sizeof(*hdr) + size);
+        if (pool)
+            pool->nr_oversized++;
+    }
+
+    if (hdr == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    hdr->cls = cls;
+    memset(hdr + 1, 0, size);
+
+    if (pool) {
+        pool->nr_allocs++;
+        if (++pool->nr_in_use > pool->max_in_use)
+            pool->max_in_use = pool->nr_in_use;
+    }
+    return hdr + 1;
+}
+
+void
+pcintr_frame_pool_free(void *p)
+{
+    if (p == NULL)
+        return;
+
+    union block_header *hdr = (union block_header *)p - 1;
+    size_t cls = hdr->cls;
+
+    struct pcintr_frame_pool *pool = current_pool();
+    if (pool) {
+        /* the block may be allocated by another instance */
+        if (pool->nr_in_use)
+            pool->nr_in_use--;
+
+        if (cls < PCINTR_FRAME_POOL_NR_CLASSES &&
+                pool->nr_free[cls] < MAX_FREE_BLOCKS) {
+            hdr->next = pool->free_blocks[cls];
+            pool->free_blocks[cls] = hdr;
+            pool->nr_free[cls]++;
+            return;
+        }
+    }
+
+    free(hdr);
+}
+
+size_t
+pcintr_frame_pool_trim(struct pcintr_frame_pool *pool, size_t nr_keep)
+{
+    size_t sz_freed = 0;
+
+    for (size_t i = 0; i < PCINTR_FRAME_POOL_NR_CLASSES; i++) {
+        while (pool->nr_free[i] > nr_keep) {
+            union block_header *hdr = pool->free_blocks[i];
+            pool->free_blocks[i] = hdr->next;
+            pool->nr_free[i]--;
+
+            free(hdr);
+            sz_freed += sizeof(*hdr) + (MIN_CLASS_SIZE << i);
+        }
+    }
+
+    return sz_freed;
+}
+
+void
+pcintr_frame_pool_cleanup(struct pcintr_frame_pool *pool)
+{
+    for (size_t i = 0; i < PCINTR_FRAME_POOL_NR_CLASSES; i++) {
+        union block_header *hdr = pool->free_blocks[i];
+        while (hdr) {
+            union block_header *next = hdr->next;
+            free(hdr);
+            hdr = next;
+        }
+
+        pool->free_blocks[i] = NULL;
+        pool->nr_free[i] = 0;
+    }
+}
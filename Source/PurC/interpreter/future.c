@@ -0,0 +1,265 @@
+/*
+ * @file future.c
+ * @date 2026/10/14
+ * @brief The results of the child coroutines scheduled asynchronously.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "internal.h"
+
+#include "private/errors.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+
+/*
+ * A future is created by the parent for every child coroutine scheduled
+ * without `synchronously` by `call` or `load`, and settled by the
+ * `callState` event of the child, no matter whether the parent observes
+ * it or not. `request` with `to "await"` waits for a set of futures and
+ * consumes them.
+ */
+struct pcintr_future {
+    struct list_head            ln;         // in pcintr_coroutine::futures
+    purc_atom_t                 cid;        // the child coroutine
+    unsigned int                settled:1;
+    unsigned int                failed:1;
+    purc_variant_t              result;     // the result or the exception
+};
+
+static struct pcintr_future *
+find_future(pcintr_coroutine_t co, purc_atom_t cid)
+{
+    struct pcintr_future *p;
+
+    if (co->futures.next == NULL)
+        return NULL;
+
+    list_for_each_entry(p, &co->futures, ln) {
+        if (p->cid == cid)
+            return p;
+    }
+
+    return NULL;
+}
+
+static void
+free_future(struct pcintr_future *future)
+{
+    list_del(&future->ln);
+    PURC_VARIANT_SAFE_CLEAR(future->result);
+    free(future);
+}
+
+int
+pcintr_future_create(pcintr_coroutine_t co, purc_atom_t cid)
+{
+    if (find_future(co, cid))
+        return 0;
+
+    struct pcintr_future *future = calloc(1, sizeof(*future));
+    if (future == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    future->cid = cid;
+    list_add_tail(&future->ln, &co->futures);
+    return 0;
+}
+
+void
+pcintr_future_settle(pcintr_coroutine_t co, const pcrdr_msg *msg,
+        const char *type, const char *sub_type)
+{
+    if (type == NULL || strcmp(type, MSG_TYPE_CALL_STATE) ||
+            msg->elementValue == PURC_VARIANT_INVALID ||
+            !pcintr_is_crtn_observed(msg->elementValue))
+        return;
+
+    purc_atom_t cid = pcintr_crtn_observed_get_cid(msg->elementValue);
+    struct pcintr_future *future = find_future(co, cid);
+    if (future == NULL || future->settled)
+        return;
+
+    future->settled = 1;
+    future->failed = (sub_type && strcmp(sub_type, MSG_SUB_TYPE_EXCEPT) == 0);
+    future->result = msg->data ?
+        purc_variant_ref(msg->data) : purc_variant_make_undefined();
+}
+
+void
+pcintr_destroy_futures(pcintr_coroutine_t co)
+{
+    struct pcintr_future *p, *n;
+
+    if (co->futures.next == NULL)
+        return;
+
+    list_for_each_entry_safe(p, n, &co->futures, ln) {
+        free_future(p);
+    }
+}
+
+/* returns 1 and sets `$?` if all the futures are settled, 0 if not yet,
+   or -1 on failure. */
+static int
+complete_await(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
+        purc_variant_t awaited)
+{
+    size_t nr = purc_variant_array_get_size(awaited);
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_array_get(awaited, i);
+        struct pcintr_future *future = find_future(co,
+                pcintr_crtn_observed_get_cid(v));
+        /* NOTE: checked when the await starts */
+        PC_ASSERT(future);
+        if (!future->settled)
+            return 0;
+    }
+
+    purc_variant_t results = purc_variant_make_array_0();
+    if (results == PURC_VARIANT_INVALID)
+        return -1;
+
+    const char *except = NULL;
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_array_get(awaited, i);
+        struct pcintr_future *future = find_future(co,
+                pcintr_crtn_observed_get_cid(v));
+        if (future->failed && except == NULL)
+            except = purc_variant_get_string_const(future->result);
+
+        if (!purc_variant_array_append(results, future->result)) {
+            purc_variant_unref(results);
+            return -1;
+        }
+    }
+
+    pcintr_set_question_var(frame, results);
+    purc_variant_unref(results);
+
+    if (except) {
+        purc_set_error_with_info(PURC_ERROR_UNKNOWN,
+                "sub coroutine failed with except: %s", except);
+    }
+
+    /* the futures are consumed by the await */
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_array_get(awaited, i);
+        struct pcintr_future *future = find_future(co,
+                pcintr_crtn_observed_get_cid(v));
+        if (future)
+            free_future(future);
+    }
+
+    return 1;
+}
+
+static bool
+is_await_match(pcintr_coroutine_t co, struct pcintr_observer *observer,
+        pcrdr_msg *msg, purc_variant_t observed, const char *type,
+        const char *sub_type)
+{
+    UNUSED_PARAM(co);
+    UNUSED_PARAM(observed);
+    UNUSED_PARAM(sub_type);
+
+    if (msg == NULL || type == NULL || strcmp(type, MSG_TYPE_CALL_STATE) ||
+            msg->elementValue == PURC_VARIANT_INVALID ||
+            !pcintr_is_crtn_observed(msg->elementValue))
+        return false;
+
+    purc_atom_t cid = pcintr_crtn_observed_get_cid(msg->elementValue);
+    size_t nr = purc_variant_array_get_size(observer->observed);
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_array_get(observer->observed, i);
+        if (pcintr_crtn_observed_get_cid(v) == cid)
+            return true;
+    }
+
+    return false;
+}
+
+static int
+await_handle(pcintr_coroutine_t co, struct pcintr_observer *observer,
+        pcrdr_msg *msg, const char *type, const char *sub_type, void *data)
+{
+    UNUSED_PARAM(type);
+    UNUSED_PARAM(sub_type);
+
+    pcintr_set_current_co(co);
+
+    struct pcintr_stack_frame *frame = (struct pcintr_stack_frame *)data;
+    if (complete_await(co, frame, observer->observed)) {
+        /* NOTE: the observer is not removed automatically */
+        pcintr_revoke_observer(observer);
+        pcintr_resume(co, msg);
+    }
+
+    pcintr_set_current_co(NULL);
+    return 0;
+}
+
+int
+pcintr_await_futures(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
+        purc_variant_t awaited)
+{
+    size_t nr;
+    if (!purc_variant_array_size(awaited, &nr) || nr == 0) {
+        purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
+                "no coroutine to await");
+        return -1;
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_array_get(awaited, i);
+        if (!pcintr_is_crtn_observed(v)) {
+            purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
+                    "not a coroutine to await");
+            return -1;
+        }
+
+        purc_atom_t cid = pcintr_crtn_observed_get_cid(v);
+        if (find_future(co, cid) == NULL) {
+            purc_set_error_with_info(PURC_ERROR_ENTITY_NOT_FOUND,
+                    "no result of coroutine %s to await",
+                    purc_atom_to_string(cid));
+            return -1;
+        }
+    }
+
+    int r = complete_await(co, frame, awaited);
+    if (r)
+        return (r > 0) ? 0 : -1;
+
+    return pcintr_yield(
+            CO_STAGE_FIRST_RUN | CO_STAGE_OBSERVING,
+            CO_STATE_STOPPED,
+            awaited,
+            MSG_TYPE_CALL_STATE,
+            MSG_SUB_TYPE_ASTERISK,
+            is_await_match,
+            await_handle,
+            frame,
+            false);
+}
@@ -25,12 +25,21 @@
 #include "purc.h"
 
 #include "private/hvml.h"
+#include "private/list.h"
 #include "private/map.h"
 #include "private/fetcher.h"
 #include "private/ports.h"
+#include "private/rwstream.h"
 #include "../hvml/hvml-gen.h"
 
 #include <time.h>
+#include <pthread.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 purc_vdom_t
 purc_load_hvml_from_rwstream(purc_rwstream_t stm)
@@ -93,6 +102,11 @@ end:
  * by emoving some vDOMs according to LRU.
  *
  * By now, we keep all vDOMs until the program exits.
+ *
+ * NOTE: the cache is shared by all instances in the process. A vDOM is not
+ * changed once it is cached, because its VCM trees are prepared before it
+ * is published (see pcvdom_document_prepare()). The entry of a program
+ * keyed by its contents never expires; the one keyed by the URL does.
  */
 static size_t total_orig_size;
 static pcutils_map* md5_vdom_map;
@@ -171,13 +185,8 @@ cache_vdom(unsigned char *md5, unsigned expire_after, size_t length,
 {
     struct vdom_entry *entry = calloc(1, sizeof(*entry));
 
-    time_t expire;
-    if (expire_after)
-       expire = purc_monotonic_time_after(expire_after);
-    else
-       expire = purc_monotonic_time_after(3600);
-
-    entry->expire = expire;
+    /* zero for an entry keyed by the contents, which never expires */
+    entry->expire = expire_after ? purc_monotonic_time_after(expire_after) : 0;
     entry->length = length;
     entry->vdom = vdom;
 
@@ -199,7 +208,7 @@ static purc_vdom_t find_vdom_in_cache(unsigned char *md5)
     if (entry) {
         time_t t = purc_get_monotoic_time();
         struct vdom_entry *vdom_entry = entry->val;
-        if (t >= vdom_entry->expire) {
+        if (vdom_entry->expire && t >= vdom_entry->expire) {
             pcutils_map_erase_entry_nolock(md5_vdom_map, entry);
         }
         else {
@@ -213,6 +222,205 @@ static purc_vdom_t find_vdom_in_cache(unsigned char *md5)
     return vdom;
 }
 
+size_t pcintr_loader_purge_expired(void)
+{
+    size_t nr_purged = 0;
+    time_t t = purc_get_monotoic_time();
+
+    pcutils_map_lock(md5_vdom_map);
+
+    struct pcutils_map_entry *entry;
+    struct pcutils_map_iterator it = pcutils_map_it_begin_first(md5_vdom_map);
+    while ((entry = pcutils_map_it_value(&it))) {
+        struct vdom_entry *vdom_entry = entry->val;
+        pcutils_map_it_next(&it);
+
+        if (vdom_entry->expire && t >= vdom_entry->expire) {
+            pcutils_map_erase_entry_nolock(md5_vdom_map, entry);
+            nr_purged++;
+        }
+    }
+    pcutils_map_it_end(&it);
+
+    pcutils_map_unlock(md5_vdom_map);
+    return nr_purged;
+}
+
+/*
+ * NOTE: when PURC_ENVV_VDOM_CACHE_DIR is set, a vDOM parsed from the
+ * contents is also written to the directory in the binary form, named by
+ * the MD5 digest of the contents. The file is written to a temporary one
+ * and then renamed, so that the processes sharing the directory always see
+ * a complete one; a file failed to load is removed, and written again.
+ */
+#define VDOM_FILE_SUFFIX        ".vdom"
+
+static bool
+vdom_file_path(char *path, size_t sz, const unsigned char *md5)
+{
+    const char *dir = getenv(PURC_ENVV_VDOM_CACHE_DIR);
+    if (dir == NULL || dir[0] == 0)
+        return false;
+
+    char hex[PCUTILS_MD5_DIGEST_SIZE * 2 + 1];
+    pcutils_bin2hex(md5, PCUTILS_MD5_DIGEST_SIZE, hex, false);
+
+    int n = snprintf(path, sz, "%s/%s" VDOM_FILE_SUFFIX, dir, hex);
+    return n > 0 && (size_t)n < sz;
+}
+
+static purc_vdom_t
+load_vdom_from_disk(const unsigned char *md5)
+{
+    char path[PATH_MAX];
+    if (!vdom_file_path(path, sizeof(path), md5))
+        return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    purc_vdom_t vdom = NULL;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (buf != MAP_FAILED) {
+            vdom = pcvdom_document_from_binary(buf, st.st_size);
+            munmap(buf, st.st_size);
+        }
+    }
+    close(fd);
+
+    if (vdom == NULL) {
+        /* not an error; the program will be parsed and cached again */
+        purc_clr_error();
+        unlink(path);
+    }
+    return vdom;
+}
+
+static void
+store_vdom_to_disk(const unsigned char *md5, purc_vdom_t vdom)
+{
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX + 8];
+    if (!vdom_file_path(path, sizeof(path), md5))
+        return;
+
+    purc_rwstream_t out = purc_rwstream_new_buffer(4096, 0);
+    if (out == NULL)
+        goto failed;
+
+    if (pcvdom_document_to_binary(vdom, out))
+        goto failed;
+
+    size_t sz;
+    const char *buf = purc_rwstream_get_mem_buffer(out, &sz);
+    if (buf == NULL)
+        goto failed;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+    int fd = mkstemp(tmp_path);
+    if (fd < 0)
+        goto failed;
+
+    size_t written = 0;
+    while (written < sz) {
+        ssize_t n = write(fd, buf + written, sz - written);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        written += n;
+    }
+    close(fd);
+
+    if (written < sz || rename(tmp_path, path)) {
+        unlink(tmp_path);
+    }
+
+failed:
+    if (out)
+        purc_rwstream_destroy(out);
+    /* not an error; the vDOM is only not cached on disk */
+    purc_clr_error();
+}
+
+/* parses the contents, or loads the vDOM from the disk cache */
+static purc_vdom_t
+load_vdom_from_contents(purc_rwstream_t in, const unsigned char *md5)
+{
+    purc_vdom_t vdom = load_vdom_from_disk(md5);
+    if (vdom == NULL) {
+        vdom = purc_load_hvml_from_rwstream(in);
+        if (vdom) {
+            store_vdom_to_disk(md5, vdom);
+        }
+    }
+    return vdom;
+}
+
+/*
+ * NOTE: the threads loading the same program at the same time wait for the
+ * first one instead of parsing the program again; so the runners executing
+ * the same program share one vDOM.
+ */
+struct loading_entry {
+    struct list_head ln;
+    unsigned char md5[PCUTILS_MD5_DIGEST_SIZE];
+};
+
+static pthread_mutex_t loading_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t loading_cond = PTHREAD_COND_INITIALIZER;
+static LIST_HEAD(loading_list);
+
+static bool is_being_loaded(const unsigned char *md5)
+{
+    struct loading_entry *p;
+    list_for_each_entry(p, &loading_list, ln) {
+        if (memcmp(p->md5, md5, PCUTILS_MD5_DIGEST_SIZE) == 0)
+            return true;
+    }
+    return false;
+}
+
+/* returns the cached vDOM, or NULL if the caller is to load it */
+static purc_vdom_t
+find_or_begin_loading(unsigned char *md5, struct loading_entry *loading)
+{
+    purc_vdom_t vdom = find_vdom_in_cache(md5);
+    if (vdom)
+        return vdom;
+
+    pthread_mutex_lock(&loading_lock);
+    while ((vdom = find_vdom_in_cache(md5)) == NULL && is_being_loaded(md5))
+        pthread_cond_wait(&loading_cond, &loading_lock);
+
+    if (vdom == NULL) {
+        memcpy(loading->md5, md5, PCUTILS_MD5_DIGEST_SIZE);
+        list_add_tail(&loading->ln, &loading_list);
+    }
+    pthread_mutex_unlock(&loading_lock);
+    return vdom;
+}
+
+static void end_loading(struct loading_entry *loading)
+{
+    pthread_mutex_lock(&loading_lock);
+    list_del(&loading->ln);
+    pthread_cond_broadcast(&loading_cond);
+    pthread_mutex_unlock(&loading_lock);
+}
+
+static void
+publish_vdom(unsigned char *md5, unsigned expire_after, size_t length,
+        purc_vdom_t vdom)
+{
+    pcvdom_document_prepare(vdom);
+    cache_vdom(md5, expire_after, length, vdom);
+}
+
 purc_vdom_t
 purc_load_hvml_from_string(const char* string)
 {
@@ -227,22 +435,20 @@ purc_load_hvml_from_string(const char* string)
 
     pcutils_md5digest(string, md5);
 
-    vdom = find_vdom_in_cache(md5);
+    struct loading_entry loading;
+    vdom = find_or_begin_loading(md5, &loading);
     if (vdom == NULL) {
         purc_rwstream_t in;
         in = purc_rwstream_new_from_mem((void*)string, length);
-        if (!in) {
-            goto failed;
-        }
-
-        if ((vdom = purc_load_hvml_from_rwstream(in))) {
-            cache_vdom(md5, 0, length, vdom);
+        if (in) {
+            if ((vdom = load_vdom_from_contents(in, md5))) {
+                publish_vdom(md5, 0, length, vdom);
+            }
+            purc_rwstream_destroy(in);
         }
-
-        purc_rwstream_destroy(in);
+        end_loading(&loading);
     }
 
-failed:
     return vdom;
 }
 
@@ -258,24 +464,21 @@ purc_load_hvml_from_file(const char* file)
         return NULL;
     }
 
-    vdom = find_vdom_in_cache(md5);
+    struct loading_entry loading;
+    vdom = find_or_begin_loading(md5, &loading);
     if (vdom == NULL) {
         purc_rwstream_t in;
-        in = purc_rwstream_new_from_file(file, "r");
-        if (!in) {
-            goto failed;
-        }
-
-        if ((vdom = purc_load_hvml_from_rwstream(in))) {
-            cache_vdom(md5, 0, length, vdom);
+        in = pcrwstream_new_for_reading(file);
+        if (in) {
+            if ((vdom = load_vdom_from_contents(in, md5))) {
+                publish_vdom(md5, 0, length, vdom);
+            }
+            purc_rwstream_destroy(in);
         }
-        purc_rwstream_destroy(in);
+        end_loading(&loading);
     }
 
     return vdom;
-
-failed:
-    return NULL;
 }
 
 purc_vdom_t
@@ -293,7 +496,8 @@ purc_load_hvml_from_url(const char* url)
 
     pcutils_md5digest(url, md5);
 
-    vdom = find_vdom_in_cache(md5);
+    struct loading_entry loading;
+    vdom = find_or_begin_loading(md5, &loading);
     if (vdom == NULL) {
         struct pcfetcher_resp_header resp_header = {0};
         struct pcfetcher_session *session = pcfetcher_session_create(NULL);
@@ -306,10 +510,26 @@ purc_load_hvml_from_url(const char* url)
                 &resp_header);
 
         if (resp_header.ret_code == 200) {
-            vdom = purc_load_hvml_from_rwstream(resp);
+            /* the disk cache is keyed by the contents instead of the URL */
+            size_t sz_content = 0;
+            const char *content = purc_rwstream_get_mem_buffer(resp,
+                    &sz_content);
+            if (content && sz_content) {
+                unsigned char content_md5[PCUTILS_MD5_DIGEST_SIZE];
+                pcutils_md5_ctxt ctx;
+                pcutils_md5_begin(&ctx);
+                pcutils_md5_hash(&ctx, content, sz_content);
+                pcutils_md5_end(&ctx, content_md5);
+                vdom = load_vdom_from_contents(resp, content_md5);
+            }
+            else {
+                purc_clr_error();
+                vdom = purc_load_hvml_from_rwstream(resp);
+            }
             if (vdom) {
-                size_t length = purc_rwstream_tell(resp);
-                cache_vdom(md5, 60, length, vdom);
+                size_t length = sz_content ? sz_content :
+                    (size_t)purc_rwstream_tell(resp);
+                publish_vdom(md5, 60, length, vdom);
             }
             purc_rwstream_destroy(resp);
         }
@@ -318,6 +538,7 @@ purc_load_hvml_from_url(const char* url)
             free(resp_header.mime_type);
         }
         pcfetcher_session_destroy(session);
+        end_loading(&loading);
     }
 
     return vdom;
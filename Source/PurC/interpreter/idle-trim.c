@@ -0,0 +1,126 @@
+/*
+ * @file idle-trim.c
+ * @date 2026/10/14
+ * @brief Trimming the memory of an instance when it is idle.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "internal.h"
+
+#include "private/debug.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "private/variant.h"
+#include "private/document.h"
+#include "private/regex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if HAVE(MALLOC_TRIM)
+#include <malloc.h>
+#endif
+
+#define DEF_IDLE_TRIM_AFTER     10      // seconds
+#define MAX_IDLE_TRIM_AFTER     86400
+
+/* the low watermarks of the pools and the caches */
+#define LOW_RESERVED_VARIANTS   8
+#define LOW_FREE_MESSAGES       8
+#define LOW_FREE_FRAMES         4       // of every size class
+#define LOW_CACHED_REGEXES      8
+#define LOW_CACHED_SELECTORS    8
+
+void
+pcintr_idle_trim_init_from_env(struct pcintr_heap *heap)
+{
+    struct pcintr_idle_trim *trim = &heap->idle_trim;
+
+    trim->after_ms = DEF_IDLE_TRIM_AFTER * 1000;
+    const char *env = getenv(PURC_ENVV_IDLE_TRIM);
+    if (env) {
+        long secs = strtol(env, NULL, 10);
+        if (secs <= 0)
+            trim->after_ms = 0;
+        else if (secs <= MAX_IDLE_TRIM_AFTER)
+            trim->after_ms = (uint32_t)secs * 1000;
+    }
+
+    trim->level = PCINTR_IDLE_TRIM_ALL;
+    if ((env = getenv(PURC_ENVV_IDLE_TRIM_LEVEL))) {
+        if (strcmp(env, "pools") == 0)
+            trim->level = PCINTR_IDLE_TRIM_POOLS;
+        else if (strcmp(env, "caches") == 0)
+            trim->level = PCINTR_IDLE_TRIM_CACHES;
+    }
+}
+
+static void
+trim_memory(struct pcintr_heap *heap)
+{
+    struct pcintr_idle_trim *trim = &heap->idle_trim;
+
+    size_t sz_freed = pcvariant_trim_reserved(LOW_RESERVED_VARIANTS);
+    sz_freed += pcinst_trim_message_pool(LOW_FREE_MESSAGES);
+    sz_freed += pcintr_frame_pool_trim(&heap->frame_pool, LOW_FREE_FRAMES);
+    trim->sz_freed += sz_freed;
+
+    size_t nr_uncached = 0;
+    if (trim->level >= PCINTR_IDLE_TRIM_CACHES) {
+        nr_uncached += pcregex_cache_trim(LOW_CACHED_REGEXES);
+        nr_uncached += pcdoc_selector_cache_trim(LOW_CACHED_SELECTORS);
+        nr_uncached += pcintr_loader_purge_expired();
+        trim->nr_uncached += nr_uncached;
+    }
+
+#if HAVE(MALLOC_TRIM)
+    if (trim->level >= PCINTR_IDLE_TRIM_ALL && malloc_trim(0))
+        trim->nr_sys_trims++;
+#endif
+
+    trim->nr_trims++;
+    PC_INFO("Trimmed the idle instance: %zu bytes freed, %zu uncached\n",
+            sz_freed, nr_uncached);
+}
+
+void
+pcintr_idle_trim_check(struct pcinst *inst, double now)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+    struct pcintr_idle_trim *trim = &heap->idle_trim;
+
+    if (trim->after_ms == 0)
+        return;
+
+    /* a new idle period starts if any step was run since the last check */
+    if (heap->nr_steps != trim->last_steps) {
+        trim->last_steps = heap->nr_steps;
+        trim->idle_since = now;
+        trim->trimmed = false;
+        return;
+    }
+
+    if (!trim->trimmed && now - trim->idle_since >= trim->after_ms) {
+        trim_memory(heap);
+        trim->trimmed = true;
+    }
+}
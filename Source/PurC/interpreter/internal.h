@@ -57,6 +57,9 @@
 #define PCINTR_LEN_HVML_RUN_RES               4
 #define PCINTR_HVML_RUN_CURR_ID               "-"
 #define PCINTR_RDR_NORETURN_REQUEST_ID        "-"
+/* NOTE: never sent; the request is sent with a generated identifier and
+   the response is handled asynchronously without waiting for it. */
+#define PCINTR_RDR_PIPELINED_REQUEST_ID       "+"
 
 #define PCINTR_EXCLAMATION_EVENT_NAME         "_eventName"
 #define PCINTR_EXCLAMATION_EVENT_SUB_NAME     "_eventSubName"
@@ -67,6 +70,15 @@ struct pcvdom_template {
     struct pcvcm_node            *vcm;
     bool                          to_free;
     purc_variant_t                type;
+
+    /* the compiled vcm: the static pieces and the slots between them;
+       1 for compiled, -1 for not compilable, and 0 for not yet. */
+    int                           compiled;
+    struct pcvcm_node           **slots;
+    char                         *pieces_buf;
+    struct pcdoc_tpl_content      content;
+    /* the last expansion, to which the values of the content refer */
+    purc_variant_t                last;
 };
 
 struct pcintr_observer_task {
@@ -85,6 +97,23 @@ struct pcintr_observer_task {
     purc_variant_t                observed;   /* msg->elementValue && native */
 };
 
+struct pcintr_elem_observers;
+
+/* visits the candidate observers of an event type in registration order */
+struct pcintr_observer_iterator {
+    struct list_head             *indexed;
+    struct list_head             *wildcards;
+    struct list_head             *next_indexed;
+    struct list_head             *next_wildcard;
+
+    /* the element observers: all of them, or those of the element only */
+    struct list_head             *elements;
+    struct list_head             *next_element;
+    struct pcintr_elem_observers *elem_bucket;
+    size_t                        next_elem_idx;
+    enum pcintr_observer_source   source;
+};
+
 enum VIA {
     VIA_UNDEFINED,
     VIA_LOAD,
@@ -127,6 +156,59 @@ PCA_EXTERN_C_BEGIN
 void
 pcintr_destroy_observer_list(struct list_head *observer_list);
 
+void
+pcintr_destroy_observer_index(pcintr_stack_t stack);
+
+void
+pcintr_observer_iterator_init(struct pcintr_observer_iterator *it,
+        pcintr_stack_t stack, enum pcintr_observer_source source,
+        const char *type);
+
+/* Creates the future of a child coroutine scheduled asynchronously. */
+int
+pcintr_future_create(pcintr_coroutine_t co, purc_atom_t cid);
+
+/* Settles the future of the child if the message is its `callState`. */
+void
+pcintr_future_settle(pcintr_coroutine_t co, const pcrdr_msg *msg,
+        const char *type, const char *sub_type);
+
+void
+pcintr_destroy_futures(pcintr_coroutine_t co);
+
+/* Post the change events of the mutations on an observed container or a
+   named variable; the ones in a step are merged and posted at the end. */
+int
+pcintr_post_variant_change(purc_atom_t cid, purc_variant_t source,
+        const char *type);
+
+int
+pcintr_post_named_var_change(purc_atom_t cid, struct pcvarmgr *mgr,
+        const char *name, const char *sub_type);
+
+/* Posts the change events coalesced in the step of the coroutine. */
+void
+pcintr_flush_changes(pcintr_coroutine_t co);
+
+void
+pcintr_destroy_changes(pcintr_coroutine_t co);
+
+/* Waits for the results of the child coroutines in the array `awaited`,
+   and sets `$?` of the frame to the array of the results. */
+int
+pcintr_await_futures(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
+        purc_variant_t awaited);
+
+/* Like pcintr_observer_iterator_init(), but visits only the element
+   observers which may match the element of the event (`elem_value`). */
+void
+pcintr_observer_iterator_init_ex(struct pcintr_observer_iterator *it,
+        pcintr_stack_t stack, enum pcintr_observer_source source,
+        const char *type, purc_variant_t elem_value);
+
+struct pcintr_observer *
+pcintr_observer_iterator_next(struct pcintr_observer_iterator *it);
+
 struct pcintr_stack_frame_normal *
 pcintr_push_stack_frame_normal(pcintr_stack_t stack);
 
@@ -340,6 +422,40 @@ pcintr_rdr_page_control_register(struct pcinst *inst, pcintr_stack_t stack);
 bool
 pcintr_rdr_page_control_revoke(struct pcinst *inst, pcintr_stack_t stack);
 
+/* Sends the operations after `last_seq` to the renderer which keeps the
+   DOM of the page, or loads the page again if the log has wrapped. */
+bool
+pcintr_rdr_page_control_resync(struct pcinst *inst, pcintr_stack_t stack,
+        uint64_t last_seq);
+
+/* the number of the eDOM operations kept in the log of a page */
+#define PCINTR_MUTATION_LOG_SIZE    1024
+
+/* Restarts the log of the operations when the page is loaded. */
+int
+pcintr_mutation_log_reset(pcintr_coroutine_t co);
+
+/* Logs an item of `batch` and sets its `seq`; returns the sequence number,
+   or 0 if the page has never been loaded. */
+uint64_t
+pcintr_mutation_log_append(pcintr_coroutine_t co, purc_variant_t op);
+
+uint64_t
+pcintr_mutation_log_last_seq(pcintr_coroutine_t co);
+
+/* Returns the array of the operations after `last_seq`, or
+   PURC_VARIANT_INVALID if they are not all in the log. */
+purc_variant_t
+pcintr_mutation_log_since(pcintr_coroutine_t co, uint64_t last_seq);
+
+/* Restores the handles of the page loaded if they were cleared; returns
+   false if the coroutine is attached to another DOM. */
+bool
+pcintr_mutation_log_restore_page(pcintr_coroutine_t co);
+
+void
+pcintr_mutation_log_destroy(pcintr_coroutine_t co);
+
 int
 pcintr_doc_op_to_rdr_op(pcdoc_operation_k op);
 
@@ -377,6 +493,10 @@ pcintr_rdr_send_dom_req_simple_raw(pcintr_stack_t stack,
         const char *property, pcrdr_msg_data_type data_type,
         const char *data, size_t len);
 
+/* sends the coalesced DOM operations of the coroutine as a batch request */
+void
+pcintr_rdr_flush_dom_batch(pcintr_coroutine_t co);
+
 purc_variant_t
 pcintr_rdr_call_method(pcintr_stack_t stack, const char *request_id,
         const char *css_selector, const char *method, purc_variant_t arg);
@@ -454,6 +574,12 @@ pcintr_schedule_child_co(purc_vdom_t vdom, purc_atom_t curator,
         const char *runner, const char *rdr_target, purc_variant_t request,
         const char *body_id, bool create_runner);
 
+/* schedules a detached child coroutine onto the least loaded worker of
+   the runner pool if there is one, or onto the current runner */
+purc_atom_t
+pcintr_schedule_detached_child_co(purc_vdom_t vdom, purc_atom_t curator,
+        purc_variant_t request, const char *body_id);
+
 purc_atom_t
 pcintr_schedule_child_co_from_string(const char *hvml, purc_atom_t curator,
         const char *runner, const char *rdr_target, purc_variant_t request,
@@ -610,10 +736,86 @@ bool
 pcintr_reload_crtn_doc(struct pcinst *inst, pcintr_coroutine_t co_revoked,
         uint64_t ctrn_handle);
 
+/* Resyncs the page of a loaded coroutine from the operation after `last_seq`;
+   `seq` returns the sequence number of the last operation then. */
+bool
+pcintr_resync_crtn_doc(struct pcinst *inst, uint64_t ctrn_handle,
+        uint64_t last_seq, uint64_t *seq);
+
 int
 pcintr_common_handle_attr_in(pcintr_coroutine_t co,
         struct pcintr_stack_frame *frame);
 
+/* the element-level profiler; called only if heap->profiling is set. */
+void
+pcintr_profiler_begin_step(struct pcintr_heap *heap, pcintr_coroutine_t co);
+
+void
+pcintr_profiler_end_step(struct pcintr_heap *heap, pcintr_coroutine_t co);
+
+void
+pcintr_profiler_begin_attr(struct pcintr_heap *heap);
+
+void
+pcintr_profiler_end_attr(struct pcintr_heap *heap,
+        struct pcintr_stack_frame *frame, const char *attr_name);
+
+void
+pcintr_profiler_destroy(struct pcintr_profiler *profiler);
+
+/* enables the profiler if PURC_ENVV_PROFILE_FILE is set */
+void
+pcintr_profiler_init_from_env(struct pcintr_heap *heap);
+
+/* the times purc_request_profile_dump() called */
+unsigned int
+pcintr_profiler_dump_requests(void);
+
+/* dumps the element counters to the profile file if requested;
+   called only if heap->profiler is not NULL. */
+void
+pcintr_profiler_check_requests(struct pcintr_heap *heap);
+
+void
+pcintr_profiler_dump_at_exit(struct pcintr_heap *heap);
+
+/* writes the counters of an element to a stack dump */
+void
+pcintr_profiler_dump_element(struct pcintr_heap *heap,
+        pcvdom_element_t elem, purc_rwstream_t stm);
+
+/* Allocates zeroed memory for a stack frame or the context of an element
+   from the frame pool of the current instance; the memory must be freed
+   by pcintr_frame_pool_free(). */
+void *
+pcintr_frame_pool_alloc(size_t size);
+
+void
+pcintr_frame_pool_free(void *p);
+
+/* frees the blocks kept in the free lists of the pool */
+void
+pcintr_frame_pool_cleanup(struct pcintr_frame_pool *pool);
+
+/* frees the blocks in the free lists of the pool except `nr_keep` ones of
+   every size class; returns the size of the memory freed */
+size_t
+pcintr_frame_pool_trim(struct pcintr_frame_pool *pool, size_t nr_keep);
+
+/* removes the expired vDOMs from the cache; returns the number removed */
+size_t
+pcintr_loader_purge_expired(void);
+
+/* sets the policy of trimming the memory when idle by PURC_ENVV_IDLE_TRIM
+   and PURC_ENVV_IDLE_TRIM_LEVEL */
+void
+pcintr_idle_trim_init_from_env(struct pcintr_heap *heap);
+
+/* trims the memory if the instance has been idle long enough; called when
+   the idle event is broadcast */
+void
+pcintr_idle_trim_check(struct pcinst *inst, double now);
+
 PCA_EXTERN_C_END
 
 #endif  /* PURC_INTERPRETER_INTERNAL_H */
@@ -123,7 +123,7 @@ stack_frame_pseudo_destroy(struct pcintr_stack_frame_pseudo *frame_pseudo)
         return;
 
     stack_frame_pseudo_release(frame_pseudo);
-    free(frame_pseudo);
+    pcintr_frame_pool_free(frame_pseudo);
 }
 
 static void
@@ -142,7 +142,7 @@ stack_frame_normal_destroy(struct pcintr_stack_frame_normal *frame_normal)
         return;
 
     stack_frame_normal_release(frame_normal);
-    free(frame_normal);
+    pcintr_frame_pool_free(frame_normal);
 }
 
 static int
@@ -295,6 +295,7 @@ stack_release(pcintr_stack_t stack)
 
     pcintr_destroy_observer_list(&stack->intr_observers);
     pcintr_destroy_observer_list(&stack->hvml_observers);
+    pcintr_destroy_observer_index(stack);
 
     if (stack->doc) {
         purc_document_unref(stack->doc);
@@ -378,6 +379,9 @@ coroutine_release(pcintr_coroutine_t co)
             pcfetcher_session_destroy(co->fetcher_session);
         }
 
+        /* NOTE: the page has gone if the batch is not flushed yet. */
+        PURC_VARIANT_SAFE_CLEAR(co->rdr_batch);
+
         if (co->target_workspace) {
             free(co->target_workspace);
         }
@@ -456,6 +460,30 @@ coroutine_release(pcintr_coroutine_t co)
             pcintr_timers_destroy(co->timers);
             co->timers = NULL;
         }
+
+        if (co->vcm_consts) {
+            pcutils_uomap_destroy(co->vcm_consts);
+            co->vcm_consts = NULL;
+        }
+
+        if (co->vcm_ics) {
+            pcvcm_inline_caches_destroy(co->vcm_ics);
+            co->vcm_ics = NULL;
+        }
+
+        if (co->var_slots) {
+            pcintr_var_slots_destroy(co->var_slots);
+            co->var_slots = NULL;
+        }
+
+        if (co->vcm_ctxt_pool) {
+            pcvcm_eval_ctxt_pool_destroy(co->vcm_ctxt_pool);
+            co->vcm_ctxt_pool = NULL;
+        }
+
+        pcintr_destroy_futures(co);
+        pcintr_destroy_changes(co);
+        pcintr_mutation_log_destroy(co);
     }
 }
 
@@ -463,6 +491,10 @@ static void
 coroutine_destroy(pcintr_coroutine_t co)
 {
     if (co) {
+        if (pcvariant_get_usage() == &co->vusage)
+            pcvariant_set_usage(NULL);
+        if (co->pool_counted)
+            pcrun_pool_update_load(co->owner->pool_slot, false);
         coroutine_release(co);
         free(co);
     }
@@ -474,6 +506,10 @@ stack_init(pcintr_stack_t stack)
     list_head_init(&stack->frames);
     list_head_init(&stack->intr_observers);
     list_head_init(&stack->hvml_observers);
+    list_head_init(&stack->intr_wildcards);
+    list_head_init(&stack->hvml_wildcards);
+    list_head_init(&stack->intr_elem_observers);
+    list_head_init(&stack->hvml_elem_observers);
     stack->scoped_variables = RB_ROOT;
 
     stack->mode = STACK_VDOM_BEFORE_HVML;
@@ -514,6 +550,25 @@ static void _cleanup_instance(struct pcinst* inst)
         heap->event_timer = NULL;
     }
 
+    for (int i = 0; i < PCINTR_NR_CRTN_PRIORITIES; i++) {
+        const struct pcintr_sched_stat *stat = heap->sched_stats + i;
+        if (stat->nr_samples) {
+            PC_DEBUG("Scheduling latency of priority %d: "
+                    "%llu samples, avg %llu us, max %llu us\n",
+                    i + PURC_CRTN_PRIORITY_LOW,
+                    (unsigned long long)stat->nr_samples,
+                    (unsigned long long)(stat->total_us / stat->nr_samples),
+                    (unsigned long long)stat->max_us);
+        }
+    }
+
+    if (heap->profiler) {
+        pcintr_profiler_dump_at_exit(heap);
+        pcintr_profiler_destroy(heap->profiler);
+        heap->profiler = NULL;
+        heap->profiling = 0;
+    }
+
     if (heap->name_chan_map) {
         pcutils_map_destroy(heap->name_chan_map);
         heap->name_chan_map = NULL;
@@ -529,6 +584,7 @@ static void _cleanup_instance(struct pcinst* inst)
         heap->loaded_crtn_handles = NULL;
     }
 
+    pcintr_frame_pool_cleanup(&heap->frame_pool);
     free(heap);
     inst->intr_heap = NULL;
 }
@@ -607,6 +663,23 @@ static int _init_instance(struct pcinst* inst,
     pcintr_timer_set_interval(heap->event_timer, EVENT_TIMER_INTRVAL);
     pcintr_timer_start(heap->event_timer);
 
+    heap->sched_quantum_us = DEF_SCHED_QUANTUM_US;
+    const char *env = getenv(PURC_ENVV_SCHED_QUANTUM);
+    if (env) {
+        long us = strtol(env, NULL, 10);
+        if (us > 0 && us <= MAX_SCHED_QUANTUM_US)
+            heap->sched_quantum_us = (uint32_t)us;
+    }
+
+    if ((env = getenv(PURC_ENVV_SCHED_MAX_STEPS))) {
+        long steps = strtol(env, NULL, 10);
+        if (steps > 0 && steps <= UINT32_MAX)
+            heap->sched_max_steps = (uint32_t)steps;
+    }
+
+    heap->pool_slot = pcrun_pool_slot_of_runner(inst->runner_name);
+    pcintr_profiler_init_from_env(heap);
+    pcintr_idle_trim_init_from_env(heap);
     return 0;
 }
 
@@ -614,6 +687,9 @@ static int _init_once(void)
 {
     init_ops();
 
+    if (pcrun_pool_init_once())
+        return -1;
+
     return pcintr_init_loader_once();
 }
 
@@ -658,6 +734,14 @@ coroutine_set_current_with_location(struct pcintr_coroutine *co,
     UNUSED_PARAM(func);
 
     struct pcintr_heap *heap = pcintr_get_heap();
+
+    /* the step of the running coroutine ends */
+    pcintr_coroutine_t last = heap->running_coroutine;
+    if (last && last != co && last->changes.next &&
+            !list_empty(&last->changes)) {
+        pcintr_flush_changes(last);
+    }
+
     if (co) {
 #if 0           /* { */
         fprintf(stderr, "%s[%d]: %s(): %s\n",
@@ -676,6 +760,7 @@ coroutine_set_current_with_location(struct pcintr_coroutine *co,
     }
 
     heap->running_coroutine = co;
+    pcvariant_set_usage(co ? &co->vusage : NULL);
 }
 
 #define coroutine_set_current(co) \
@@ -885,10 +970,8 @@ static struct pcintr_stack_frame_pseudo*
 stack_frame_pseudo_create(pcintr_stack_t stack)
 {
     struct pcintr_stack_frame_pseudo *frame_pseudo;
-    frame_pseudo = (struct pcintr_stack_frame_pseudo*)calloc(1,
-            sizeof(*frame_pseudo));
+    frame_pseudo = pcintr_frame_pool_alloc(sizeof(*frame_pseudo));
     if (!frame_pseudo) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
 
@@ -937,6 +1020,7 @@ push_stack_frame_pseudo(pcintr_stack_t stack,
 
         list_add_tail(&frame->node, &stack->frames);
         ++stack->nr_frames;
+        frame->serial = ++stack->last_frame_serial;
 
         return frame_pseudo;
     } while (0);
@@ -989,10 +1073,8 @@ static struct pcintr_stack_frame_normal*
 stack_frame_normal_create(pcintr_stack_t stack)
 {
     struct pcintr_stack_frame_normal *frame_normal;
-    frame_normal = (struct pcintr_stack_frame_normal*)calloc(1,
-            sizeof(*frame_normal));
+    frame_normal = pcintr_frame_pool_alloc(sizeof(*frame_normal));
     if (!frame_normal) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
 
@@ -1023,6 +1105,7 @@ pcintr_push_stack_frame_normal(pcintr_stack_t stack)
 
     list_add_tail(&frame->node, &stack->frames);
     ++stack->nr_frames;
+    frame->serial = ++stack->last_frame_serial;
 
     do {
         if (init_symvals_with_vals(&frame_normal->frame))
@@ -1792,6 +1875,8 @@ coroutine_create(purc_vdom_t vdom, pcintr_coroutine_t parent,
     list_head_init(&co->ln_stopped);
     list_head_init(&co->registered_cancels);
     list_head_init(&co->tasks);
+    list_head_init(&co->futures);
+    list_head_init(&co->changes);
 
     co->mq = pcinst_msg_queue_create();
     if (!co->mq) {
@@ -1842,6 +1927,10 @@ coroutine_create(purc_vdom_t vdom, pcintr_coroutine_t parent,
     co->stopped_timeout = -1;
     co->avl.key = co;
     co->sending_document_by_url = 1;    // 0.9.18
+    if (heap->pool_slot >= 0) {
+        pcrun_pool_update_load(heap->pool_slot, true);
+        co->pool_counted = 1;
+    }
     return co;
 
 fail_clr_fetcher_session:
@@ -1866,6 +1955,66 @@ set_body_entry(pcintr_stack_t stack, const char *body_id)
     stack->body_id = strdup(body_id);
 }
 
+/* NOTE: The remote resources referred by the static `from` attributes of
+   `init` and the static `src` attributes of `archetype` are requested in
+   advance and concurrently, so that the elements find the responses in the
+   cache of the fetcher when they are executed. Relative URLs and the
+   requests having parameters are skipped, for they depend on the
+   evaluation. */
+static const char *
+static_remote_url(struct pcvdom_element *elem, const char *key)
+{
+    struct pcvdom_attr *attr = pcvdom_element_find_attr(elem, key);
+    if (attr == NULL || attr->val == NULL ||
+            attr->val->type != PCVCM_NODE_TYPE_STRING) {
+        return NULL;
+    }
+
+    const char *url = (const char *)attr->val->sz_ptr[1];
+    if (strncmp(url, "http://", 7) && strncmp(url, "https://", 8)) {
+        return NULL;
+    }
+    return url;
+}
+
+static int
+prefetch_element(struct pcvdom_element *top, struct pcvdom_element *elem,
+        void *ctx)
+{
+    UNUSED_PARAM(top);
+    pcintr_coroutine_t co = (pcintr_coroutine_t)ctx;
+
+    const char *url = NULL;
+    if (elem->tag_id == PCHVML_TAG_INIT) {
+        if (!pcvdom_element_find_attr(elem, "with") &&
+                !pcvdom_element_find_attr(elem, "via")) {
+            url = static_remote_url(elem, "from");
+        }
+    }
+    else if (elem->tag_id == PCHVML_TAG_ARCHETYPE) {
+        if (!pcvdom_element_find_attr(elem, "param") &&
+                !pcvdom_element_find_attr(elem, "method")) {
+            url = static_remote_url(elem, "src");
+        }
+    }
+
+    /* stop when the fetcher has as many requests as it allows in flight */
+    if (url && pcfetcher_prefetch(co->fetcher_session, url,
+                co->timeout.tv_sec)) {
+        return -1;
+    }
+    return 0;
+}
+
+static void
+prefetch_resources(pcintr_coroutine_t co)
+{
+    struct pcvdom_element *root = pcvdom_document_get_root(co->vdom);
+    if (root) {
+        pcvdom_element_traverse(root, co, prefetch_element);
+    }
+}
+
 purc_coroutine_t
 purc_schedule_vdom(purc_vdom_t vdom,
         purc_atom_t curator, purc_variant_t request,
@@ -1918,6 +2067,11 @@ purc_schedule_vdom(purc_vdom_t vdom,
         if (extra_info->toolkit_style) {
             co->toolkit_style = purc_variant_ref(extra_info->toolkit_style);
         }
+        if (extra_info->priority &&
+                pcintr_coroutine_set_priority(co, extra_info->priority)) {
+            /* NOTE: not fatal; keep the normal priority */
+            purc_clr_error();
+        }
     }
 
     /* Attach to rdr only if the document needs rdr,
@@ -2013,6 +2167,7 @@ purc_schedule_vdom(purc_vdom_t vdom,
         goto failed;
     }
 
+    prefetch_resources(co);
     init_frame_for_co(co);
     return co;
 
@@ -2243,6 +2398,75 @@ destroy_load_async_data(struct load_async_data *data)
     }
 }
 
+static purc_variant_t
+make_load_metrics(const struct pcfetcher_load_metrics *metrics)
+{
+    static const char *keys[] = {
+        "dnsTime", "connectTime", "tlsTime", "firstByte", "totalTime",
+    };
+    const double timings[] = {
+        metrics->dns_time, metrics->connect_time, metrics->tls_time,
+        metrics->first_byte, metrics->total_time,
+    };
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    for (size_t i = 0; i < PCA_TABLESIZE(keys); i++) {
+        purc_variant_t v = purc_variant_make_number(timings[i]);
+        if (v == PURC_VARIANT_INVALID ||
+                !purc_variant_object_set_by_static_ckey(obj, keys[i], v)) {
+            PURC_VARIANT_SAFE_CLEAR(v);
+            goto failed;
+        }
+        purc_variant_unref(v);
+    }
+
+    purc_variant_t v = purc_variant_make_boolean(metrics->reused);
+    purc_variant_object_set_by_static_ckey(obj, "reused", v);
+    purc_variant_unref(v);
+
+    v = purc_variant_make_string(metrics->protocol, false);
+    if (v == PURC_VARIANT_INVALID ||
+            !purc_variant_object_set_by_static_ckey(obj, "protocol", v)) {
+        PURC_VARIANT_SAFE_CLEAR(v);
+        goto failed;
+    }
+    purc_variant_unref(v);
+    return obj;
+
+failed:
+    purc_variant_unref(obj);
+    return PURC_VARIANT_INVALID;
+}
+
+/* NOTE: The timings of a request loaded over the network are posted to
+   the destination of the progress events as `change:timing`, right before
+   the request is finished. */
+static void
+post_load_metrics(struct load_async_data *load,
+        const struct pcfetcher_load_metrics *metrics)
+{
+    if (!load->progress_event_dest || !load->requesting_stack) {
+        return;
+    }
+
+    purc_variant_t payload = make_load_metrics(metrics);
+    if (payload == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return;
+    }
+
+    pcintr_coroutine_post_event(load->requesting_stack->co->cid,
+            PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY,
+            load->progress_event_dest, MSG_TYPE_CHANGE,
+            MSG_SUB_TYPE_TIMING, payload,
+            PURC_VARIANT_INVALID);
+    purc_variant_unref(payload);
+}
+
 static void
 on_load_async_done(
         struct pcfetcher_session *session,
@@ -2252,6 +2476,10 @@ on_load_async_done(
 {
     struct load_async_data *load;
     load = (struct load_async_data*)ctxt;
+    if (type == PCFETCHER_RESP_TYPE_FINISH && data &&
+            sz_data == sizeof(struct pcfetcher_load_metrics)) {
+        post_load_metrics(load, (const struct pcfetcher_load_metrics *)data);
+    }
     load->handler(session, request_id, load->ctxt, type, data, sz_data);
     if (type == PCFETCHER_RESP_TYPE_ERROR ||
             type == PCFETCHER_RESP_TYPE_FINISH) {
@@ -2458,6 +2686,50 @@ end:
     return ret;
 }
 
+/* the context of a dynamic object loaded by `load` but not made yet */
+struct dynamic_variant_ctxt {
+    struct pcvariant_dvobj_lib *lib;
+    char                       *var_name;
+    char                        bind_name[];
+};
+
+static void
+free_dynamic_variant_ctxt(void *ctxt)
+{
+    struct dynamic_variant_ctxt *dv = ctxt;
+    free(dv->var_name);
+    free(dv);
+}
+
+static purc_variant_t
+make_dynamic_variant(void *ctxt)
+{
+    struct dynamic_variant_ctxt *dv = ctxt;
+    struct pcinst *inst = pcinst_current();
+
+    if (!inst->dvobjs) {
+        inst->dvobjs = pcutils_array_create();
+        if (!inst->dvobjs) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
+    purc_variant_t v = pcvariant_load_dvobj(dv->lib, dv->var_name);
+    if (v == PURC_VARIANT_INVALID) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* the reference is owned by inst->dvobjs; one more for the variable */
+    if (pcutils_array_push(inst->dvobjs, v)) {
+        purc_variant_unload_dvobj(v);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return purc_variant_ref(v);
+}
+
 bool
 pcintr_load_dynamic_variant(pcintr_coroutine_t cor, const char *so_name,
     const char *var_name, const char *bind_name)
@@ -2468,30 +2740,31 @@ pcintr_load_dynamic_variant(pcintr_coroutine_t cor, const char *so_name,
         return true;
     }
 
-    purc_variant_t v = purc_variant_load_dvobj_from_so(so_name, var_name);
-    if (v == PURC_VARIANT_INVALID) {
+    /* NOTE: the library is opened here to report a missing one at once,
+       but the object is made on the first access to the variable */
+    struct pcvariant_dvobj_lib *lib;
+    lib = pcvariant_open_dvobj_lib(so_name, var_name);
+    if (lib == NULL) {
         return false;
     }
 
-    struct pcinst *inst = pcinst_current();
-    if (!inst->dvobjs) {
-        inst->dvobjs = pcutils_array_create();
-        if (!inst->dvobjs) {
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            goto out;
-        }
+    size_t len = strlen(bind_name);
+    struct dynamic_variant_ctxt *dv = malloc(sizeof(*dv) + len + 1);
+    if (dv == NULL || (dv->var_name = strdup(var_name)) == NULL) {
+        free(dv);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return false;
     }
+    dv->lib = lib;
+    memcpy(dv->bind_name, bind_name, len + 1);
 
-    if (!purc_bind_runner_variable(bind_name, v)) {
-        goto out;
+    if (!pcvarmgr_add_lazy_ex(pcinst_get_variables(), dv->bind_name,
+                make_dynamic_variant, dv, free_dynamic_variant_ctxt)) {
+        free_dynamic_variant_ctxt(dv);
+        return false;
     }
 
-    pcutils_array_push(inst->dvobjs, v);
     return true;
-
-out:
-    purc_variant_unload_dvobj(v);
-    return false;
 }
 
 static struct pcvdom_template*
@@ -2513,6 +2786,17 @@ template_cleaner(struct pcvdom_template *tpl)
     if (!tpl)
         return;
 
+    if (tpl->compiled > 0) {
+        pcdoc_tpl_content_release(&tpl->content);
+        free(tpl->slots);
+        free(tpl->pieces_buf);
+        memset(&tpl->content, 0, sizeof(tpl->content));
+        tpl->slots = NULL;
+        tpl->pieces_buf = NULL;
+    }
+    tpl->compiled = 0;
+    PURC_VARIANT_SAFE_CLEAR(tpl->last);
+
     if (tpl->vcm && tpl->to_free) {
         pcvcm_node_destroy(tpl->vcm);
     }
@@ -2521,6 +2805,88 @@ template_cleaner(struct pcvdom_template *tpl)
     tpl->to_free = false;
 }
 
+static inline bool
+is_static_piece(struct pcvcm_node *node)
+{
+    return node->type == PCVCM_NODE_TYPE_STRING;
+}
+
+/*
+ * Compiles the vcm of a template, if it is a string or a concatenated one,
+ * to the static pieces and the slots between them: only the slots are
+ * evaluated when the template is expanded, and the document can build the
+ * nodes of the expansion from the values of the slots directly.
+ */
+static void
+template_compile(struct pcvdom_template *tpl)
+{
+    struct pcvcm_node *vcm = tpl->vcm;
+    struct pcvcm_node *first, *child;
+    size_t nr_slots = 0, sz_pieces = 0;
+
+    tpl->compiled = -1;
+    if (vcm->type == PCVCM_NODE_TYPE_STRING) {
+        first = vcm;
+        sz_pieces = vcm->sz_ptr[0];
+    }
+    else if (vcm->type == PCVCM_NODE_TYPE_FUNC_CONCAT_STRING) {
+        first = pcvcm_node_first_child(vcm);
+        for (child = first; child; child = (struct pcvcm_node *)
+                pctree_node_next(&child->tree_node)) {
+            if (is_static_piece(child))
+                sz_pieces += child->sz_ptr[0];
+            else
+                nr_slots++;
+        }
+    }
+    else {
+        return;
+    }
+
+    /* the slots, the pieces, and the values in one block */
+    size_t sz = sizeof(struct pcvcm_node *) * nr_slots +
+        (sizeof(const char *) + sizeof(size_t)) * (nr_slots * 2 + 1);
+    void *block = calloc(1, sz);
+    char *buf = malloc(sz_pieces + 1);
+    if (block == NULL || buf == NULL) {
+        free(block);
+        free(buf);
+        return;
+    }
+
+    struct pcdoc_tpl_content *content = &tpl->content;
+    tpl->slots = block;
+    tpl->pieces_buf = buf;
+    content->nr_slots = nr_slots;
+    content->pieces = (const char **)(tpl->slots + nr_slots);
+    content->piece_lens = (size_t *)(content->pieces + nr_slots + 1);
+    content->values = (const char **)(content->piece_lens + nr_slots + 1);
+    content->value_lens = (size_t *)(content->values + nr_slots);
+
+    /* the adjacent static pieces are merged */
+    size_t n = 0;
+    content->pieces[0] = buf;
+    for (child = first; child; child = (struct pcvcm_node *)
+            pctree_node_next(&child->tree_node)) {
+        if (is_static_piece(child)) {
+            if (child->sz_ptr[0])
+                memcpy(buf, (const char *)child->sz_ptr[1], child->sz_ptr[0]);
+            buf += child->sz_ptr[0];
+            content->piece_lens[n] += child->sz_ptr[0];
+        }
+        else {
+            tpl->slots[n++] = child;
+            content->pieces[n] = buf;
+        }
+
+        if (child == vcm)
+            break;
+    }
+    *buf = '\0';
+
+    tpl->compiled = 1;
+}
+
 static void
 template_destroy(struct pcvdom_template *tpl)
 {
@@ -3342,12 +3708,93 @@ template_walker(struct pcvcm_node *vcm, void *ctxt)
     return 0;
 }
 
+static purc_variant_t
+template_expand_compiled(struct pcvdom_template *tpl, pcintr_stack_t stack)
+{
+    struct pcdoc_tpl_content *content = &tpl->content;
+    size_t nr_slots = content->nr_slots;
+    purc_variant_t vals[nr_slots + 1];
+    size_t len = 0;
+    size_t i;
+
+    PURC_VARIANT_SAFE_CLEAR(tpl->last);
+
+    /* the values are stringified into the expansion directly after
+       the exact length is known */
+    for (i = 0; i < nr_slots; i++) {
+        // TODO: silently
+        vals[i] = pcvcm_eval(tpl->slots[i], stack, false);
+        if (vals[i] == PURC_VARIANT_INVALID)
+            goto failed;
+
+        ssize_t n = purc_variant_stringify_length(vals[i], 0);
+        if (n < 0) {
+            purc_variant_unref(vals[i]);
+            goto failed;
+        }
+
+        content->value_lens[i] = n;
+        len += n;
+    }
+
+    for (i = 0; i <= nr_slots; i++)
+        len += content->piece_lens[i];
+
+    char *buf = malloc(len + 1);
+    if (buf == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    char *p = buf;
+    for (i = 0; i <= nr_slots; i++) {
+        memcpy(p, content->pieces[i], content->piece_lens[i]);
+        p += content->piece_lens[i];
+        if (i == nr_slots)
+            break;
+
+        /* the values refer to the expansion */
+        if (content->value_lens[i])
+            purc_variant_stringify_to_buff(p, content->value_lens[i] + 1,
+                    vals[i], 0);
+        content->values[i] = p;
+        p += content->value_lens[i];
+        purc_variant_unref(vals[i]);
+    }
+    *p = '\0';
+
+    purc_variant_t v = purc_variant_make_string_reuse_buff(buf, len + 1,
+            false);
+    if (v == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    /* NOTE: the buffer is truncated and moved if the expansion contains
+       an invalid character; the values do not refer to it any more. */
+    if (purc_variant_get_string_const(v) == buf &&
+            purc_variant_string_size(v) == (ssize_t)len)
+        tpl->last = purc_variant_ref(v);
+    return v;
+
+failed:
+    while (i > 0)
+        purc_variant_unref(vals[--i]);
+    return PURC_VARIANT_INVALID;
+}
+
 purc_variant_t
 pcintr_template_expansion(purc_variant_t val)
 {
     pcintr_stack_t stack = pcintr_get_stack();
     PC_ASSERT(stack);
 
+    struct pcvdom_template *tpl = NULL;
+    if (check_template_variant(val) == 0)
+        tpl = (struct pcvdom_template*)purc_variant_native_get_entity(val);
+    if (tpl && tpl->vcm && tpl->compiled == 0)
+        template_compile(tpl);
+    if (tpl && tpl->compiled > 0)
+        return template_expand_compiled(tpl, stack);
+
     struct template_walk_data ud = {
         .stack        = stack,
         .r            = 0,
@@ -3391,12 +3838,35 @@ pcintr_coroutine_set_state_with_location(pcintr_coroutine_t co,
     UNUSED_PARAM(file);
     UNUSED_PARAM(line);
     UNUSED_PARAM(func);
+    if (state == CO_STATE_READY && co->state != CO_STATE_READY &&
+            co->state != CO_STATE_RUNNING) {
+        /* for the scheduling latency; after a step, the coroutine is
+           stamped by the scheduler when its quantum ends */
+        clock_gettime(CLOCK_MONOTONIC, &co->ready_since);
+        co->ready_stamped = 1;
+    }
     co->state = state;
 }
 
+/*
+ * NOTE: A void document has no nodes at all, so the wrappers below do not
+ * buffer the text content, serialize the new nodes, or compose the requests
+ * to the renderer for it; they only call the document operations to keep
+ * the results as before.
+ */
+static inline bool
+is_void_doc(purc_document_t doc)
+{
+    return purc_document_type(doc) == PCDOC_K_TYPE_VOID;
+}
+
 int
 insert_cached_text_node(purc_document_t doc, bool sync_to_rdr)
 {
+    if (is_void_doc(doc)) {
+        return 0;
+    }
+
     // insert catched text node
     pcintr_stack_t stack = pcintr_get_stack();
     pcdoc_operation_k op = PCDOC_OP_APPEND;
@@ -3441,7 +3911,7 @@ pcintr_util_new_element(purc_document_t doc, pcdoc_element_t elem,
     insert_cached_text_node(doc, sync_to_rdr);
 
     new_elem = pcdoc_element_new_element(doc, elem, op, tag, self_close);
-    if (new_elem && sync_to_rdr) {
+    if (new_elem && sync_to_rdr && !is_void_doc(doc)) {
         unsigned opt = 0;
         purc_rwstream_t out = NULL;
         out = purc_rwstream_new_buffer(BUFF_MIN, BUFF_MAX);
@@ -3514,6 +3984,11 @@ pcintr_util_new_text_content(purc_document_t doc, pcdoc_element_t elem,
 {
     UNUSED_PARAM(op);
     UNUSED_PARAM(sync_to_rdr);
+    if (is_void_doc(doc)) {
+        pcdoc_element_new_text_content(doc, elem, op, txt, len);
+        return 0;
+    }
+
     pcintr_stack_t stack = pcintr_get_stack();
     if (stack->curr_edom_elem != elem) {
         insert_cached_text_node(doc, sync_to_rdr);
@@ -3554,16 +4029,14 @@ pcintr_util_new_text_content(purc_document_t doc, pcdoc_element_t elem,
     return 0;
 }
 
-pcdoc_node
-pcintr_util_new_content(purc_document_t doc,
-        pcdoc_element_t elem, pcdoc_operation_k op,
-        const char *content, size_t len, purc_variant_t data_type,
+static void
+sync_new_content(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_operation_k op, pcdoc_node node, purc_variant_t data_type,
         bool sync_to_rdr, bool no_return)
 {
-    pcdoc_node node;
-    insert_cached_text_node(doc, sync_to_rdr);
-
-    node = pcdoc_element_new_content(doc, elem, op, content, len);
+    if (is_void_doc(doc)) {
+        return;
+    }
 
     pcrdr_msg_data_type type = doc->def_text_type;
     if (data_type) {
@@ -3580,7 +4053,7 @@ pcintr_util_new_content(purc_document_t doc,
         purc_rwstream_t out = NULL;
         out = purc_rwstream_new_buffer(BUFF_MIN, BUFF_MAX);
         if (out == NULL) {
-            goto out;
+            return;
         }
 
         opt |= PCDOC_SERIALIZE_OPT_UNDEF;
@@ -3592,7 +4065,7 @@ pcintr_util_new_content(purc_document_t doc,
         opt, out);
         if (0 != sret) {
             purc_rwstream_destroy(out);
-            goto out;
+            return;
         }
 
         size_t sz_content = 0;
@@ -3611,11 +4084,50 @@ pcintr_util_new_content(purc_document_t doc,
                 request_id, elem, ref_elem, "content", type, p, sz_content);
         purc_rwstream_destroy(out);
     }
+}
 
-out:
+pcdoc_node
+pcintr_util_new_content(purc_document_t doc,
+        pcdoc_element_t elem, pcdoc_operation_k op,
+        const char *content, size_t len, purc_variant_t data_type,
+        bool sync_to_rdr, bool no_return)
+{
+    pcdoc_node node;
+    insert_cached_text_node(doc, sync_to_rdr);
+
+    node = pcdoc_element_new_content(doc, elem, op, content, len);
+    sync_new_content(doc, elem, op, node, data_type, sync_to_rdr, no_return);
     return node;
 }
 
+pcdoc_node
+pcintr_util_new_tpl_content(purc_document_t doc,
+        pcdoc_element_t elem, pcdoc_operation_k op,
+        purc_variant_t tpl, purc_variant_t content, purc_variant_t data_type,
+        bool sync_to_rdr, bool no_return)
+{
+    struct pcvdom_template *t = NULL;
+    if (tpl && check_template_variant(tpl) == 0)
+        t = (struct pcvdom_template*)purc_variant_native_get_entity(tpl);
+
+    if (t && t->compiled > 0 && t->last && t->last == content &&
+            !is_void_doc(doc)) {
+        insert_cached_text_node(doc, sync_to_rdr);
+
+        pcdoc_node node = pcdoc_element_new_tpl_content(doc, elem, op,
+                &t->content);
+        if (node.type != PCDOC_NODE_VOID) {
+            sync_new_content(doc, elem, op, node, data_type, sync_to_rdr,
+                    no_return);
+            return node;
+        }
+    }
+
+    return pcintr_util_new_content(doc, elem, op,
+            purc_variant_get_string_const(content), 0, data_type,
+            sync_to_rdr, no_return);
+}
+
 pcdoc_data_node_t
 pcintr_util_set_data_content(purc_document_t doc,
         pcdoc_element_t elem, pcdoc_operation_k op,
@@ -3637,6 +4149,9 @@ pcintr_util_set_attribute(purc_document_t doc,
     if (pcdoc_element_set_attribute(doc, elem, op, name, val, len))
         return -1;
 
+    if (is_void_doc(doc))
+        return 0;
+
     pcintr_stack_t stack = pcintr_get_stack();
     if (sync_to_rdr && stack && stack->co->target_page_handle) {
         char property[strlen(name) + 8];
@@ -3735,13 +4250,23 @@ pcintr_stack_frame_eval_attr_and_content_full(pcintr_stack_t stack,
                 if (!attr->val) {
                     val = purc_variant_make_undefined();
                 }
-                else if (stack->vcm_ctxt) {
-                    val = pcvcm_eval_again(attr->val, stack, frame->silently,
-                            stack->timeout);
-                    stack->timeout = false;
-                }
                 else {
-                    val = pcvcm_eval(attr->val, stack, frame->silently);
+                    struct pcintr_heap *heap = pcintr_get_heap();
+                    bool profiling = heap->profiling;
+                    if (profiling)
+                        pcintr_profiler_begin_attr(heap);
+
+                    if (stack->vcm_ctxt) {
+                        val = pcvcm_eval_again(attr->val, stack,
+                                frame->silently, stack->timeout);
+                        stack->timeout = false;
+                    }
+                    else {
+                        val = pcvcm_eval(attr->val, stack, frame->silently);
+                    }
+
+                    if (profiling)
+                        pcintr_profiler_end_attr(heap, frame, attr->key);
                 }
                 ret = purc_get_last_error();
                 if (!val) {
@@ -0,0 +1,425 @@
+/*
+ * @file metrics.c
+ * @date 2026/10/14
+ * @brief The snapshot of the runtime metrics of an instance.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "purc-document.h"
+#include "internal.h"
+
+#include "private/errors.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "private/msg-queue.h"
+#include "private/timer.h"
+#include "private/fetcher.h"
+#include "private/mem.h"
+
+struct crtn_counts {
+    size_t nr_ready;
+    size_t nr_running;
+    size_t nr_stopped;
+    size_t nr_observing;
+    size_t nr_exited;
+    size_t nr_terminated;
+    size_t nr_total;
+    size_t nr_msgs;
+    size_t nr_events[PCINST_MSG_LANE_NR];
+    size_t max_events[PCINST_MSG_LANE_NR];
+};
+
+static void
+count_crtns(struct list_head *crtns, struct crtn_counts *counts)
+{
+    pcintr_coroutine_t co;
+    list_for_each_entry(co, crtns, ln) {
+        counts->nr_total++;
+        switch ((int)co->state) {
+        case CO_STATE_READY:
+            counts->nr_ready++;
+            break;
+        case CO_STATE_RUNNING:
+            counts->nr_running++;
+            break;
+        case CO_STATE_STOPPED:
+            counts->nr_stopped++;
+            break;
+        case CO_STATE_OBSERVING:
+            counts->nr_observing++;
+            break;
+        case CO_STATE_EXITED:
+            counts->nr_exited++;
+            break;
+        case CO_STATE_TERMINATED:
+            counts->nr_terminated++;
+            break;
+        default:
+            break;
+        }
+
+        if (co->mq) {
+            purc_rwlock_reader_lock(&co->mq->lock);
+            counts->nr_msgs += co->mq->nr_msgs;
+            for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+                counts->nr_events[i] += co->mq->nr_events[i];
+                if (co->mq->max_events[i] > counts->max_events[i])
+                    counts->max_events[i] = co->mq->max_events[i];
+            }
+            purc_rwlock_reader_unlock(&co->mq->lock);
+        }
+    }
+}
+
+static bool
+set_number(purc_variant_t obj, const char *key, uint64_t u)
+{
+    purc_variant_t v = purc_variant_make_ulongint(u);
+    if (v == PURC_VARIANT_INVALID)
+        return false;
+
+    bool ok = purc_variant_object_set_by_static_ckey(obj, key, v);
+    purc_variant_unref(v);
+    return ok;
+}
+
+static bool
+set_object(purc_variant_t obj, const char *key, purc_variant_t v)
+{
+    if (v == PURC_VARIANT_INVALID)
+        return false;
+
+    bool ok = purc_variant_object_set_by_static_ckey(obj, key, v);
+    purc_variant_unref(v);
+    return ok;
+}
+
+static purc_variant_t
+make_crtns_metrics(const struct crtn_counts *counts)
+{
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "total", counts->nr_total) ||
+            !set_number(obj, "ready", counts->nr_ready) ||
+            !set_number(obj, "running", counts->nr_running) ||
+            !set_number(obj, "stopped", counts->nr_stopped) ||
+            !set_number(obj, "observing", counts->nr_observing) ||
+            !set_number(obj, "exited", counts->nr_exited) ||
+            !set_number(obj, "terminated", counts->nr_terminated)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_lane_metrics(size_t depth, size_t peak)
+{
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "depth", depth) ||
+            !set_number(obj, "peak", peak)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_lanes_metrics(const struct crtn_counts *counts)
+{
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+        if (!set_object(obj, pcinst_msg_lane_name(i),
+                    make_lane_metrics(counts->nr_events[i],
+                        counts->max_events[i]))) {
+            purc_variant_unref(obj);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_variants_metrics(const struct purc_variant_stat *stat)
+{
+    if (stat == NULL)
+        return purc_variant_make_null();
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "values", stat->nr_total_values) ||
+            !set_number(obj, "memory", stat->sz_total_mem) ||
+            !set_number(obj, "peakMemory", stat->sz_max_mem) ||
+            !set_number(obj, "reserved", stat->nr_reserved) ||
+            !set_number(obj, "slabBlocks", stat->nr_slab_blocks) ||
+            !set_number(obj, "slabMemory", stat->sz_slab_mem)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_allocator_metrics(void)
+{
+    struct pcutils_allocator_stat stat;
+    if (!pcutils_allocator_stat_get(&stat))
+        return purc_variant_make_null();
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "allocs", stat.nr_allocs) ||
+            !set_number(obj, "frees", stat.nr_frees) ||
+            !set_number(obj, "allocated", stat.sz_allocated) ||
+            !set_number(obj, "freed", stat.sz_freed)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_frame_pool_metrics(const struct pcintr_heap *heap)
+{
+    if (heap == NULL)
+        return purc_variant_make_null();
+
+    const struct pcintr_frame_pool *pool = &heap->frame_pool;
+    uint64_t nr_cached = 0;
+    for (size_t i = 0; i < PCINTR_FRAME_POOL_NR_CLASSES; i++)
+        nr_cached += pool->nr_free[i];
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "allocs", pool->nr_allocs) ||
+            !set_number(obj, "reused", pool->nr_reused) ||
+            !set_number(obj, "oversized", pool->nr_oversized) ||
+            !set_number(obj, "inUse", pool->nr_in_use) ||
+            !set_number(obj, "peakInUse", pool->max_in_use) ||
+            !set_number(obj, "cached", nr_cached)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_idle_trim_metrics(const struct pcintr_heap *heap)
+{
+    if (heap == NULL)
+        return purc_variant_make_null();
+
+    const struct pcintr_idle_trim *trim = &heap->idle_trim;
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "trims", trim->nr_trims) ||
+            !set_number(obj, "released", trim->sz_freed) ||
+            !set_number(obj, "cachesReleased", trim->nr_uncached) ||
+            !set_number(obj, "mallocTrims", trim->nr_sys_trims)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_renderer_metrics(pcrdr_conn *conn)
+{
+    if (conn == NULL)
+        return purc_variant_make_null();
+
+    const struct pcrdr_conn_stats *stats = pcrdr_conn_stats(conn);
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "requestsSent", stats->nr_requests_sent) ||
+            !set_number(obj, "requestsRecv", stats->nr_requests_recv) ||
+            !set_number(obj, "responsesSent", stats->nr_responses_sent) ||
+            !set_number(obj, "responsesRecv", stats->nr_responses_recv) ||
+            !set_number(obj, "eventsSent", stats->nr_events_sent) ||
+            !set_number(obj, "eventsRecv", stats->nr_events_recv) ||
+            !set_number(obj, "bytesSent", stats->bytes_sent) ||
+            !set_number(obj, "bytesRecv", stats->bytes_recv)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_timers_metrics(purc_runloop_t runloop)
+{
+    size_t nr_timers = 0, nr_active = 0;
+    if (runloop)
+        pcintr_timer_get_stat(runloop, &nr_timers, &nr_active);
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "total", nr_timers) ||
+            !set_number(obj, "armed", nr_active)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+static purc_variant_t
+make_selectors_metrics(void)
+{
+    size_t nr_cached = 0, nr_hits = 0, nr_misses = 0;
+    pcdoc_selector_cache_get_stat(&nr_cached, &nr_hits, &nr_misses);
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_number(obj, "cached", nr_cached) ||
+            !set_number(obj, "hits", nr_hits) ||
+            !set_number(obj, "misses", nr_misses)) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
+
+struct origins_ctxt {
+    purc_variant_t  obj;
+    bool            failed;
+};
+
+static bool
+set_origin_metrics(const struct pcfetcher_origin_stats *stats, void *ctxt)
+{
+    struct origins_ctxt *origins = (struct origins_ctxt *)ctxt;
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID) {
+        origins->failed = true;
+        return true;
+    }
+
+    if (!set_number(obj, "requests", stats->nr_requests) ||
+            !set_number(obj, "reused", stats->nr_reused) ||
+            !set_number(obj, "connects", stats->nr_connects) ||
+            !set_number(obj, "tlsHandshakes", stats->nr_tls_handshakes) ||
+            !set_number(obj, "http2", stats->nr_http2) ||
+            !purc_variant_object_set_by_ckey(origins->obj, stats->origin,
+                obj)) {
+        origins->failed = true;
+    }
+
+    purc_variant_unref(obj);
+    return origins->failed;
+}
+
+static purc_variant_t
+make_fetcher_origins_metrics(void)
+{
+    struct origins_ctxt ctxt = { purc_variant_make_object_0(), false };
+    if (ctxt.obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    pcfetcher_foreach_origin_stats(set_origin_metrics, &ctxt);
+    if (ctxt.failed) {
+        purc_variant_unref(ctxt.obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return ctxt.obj;
+}
+
+purc_variant_t
+purc_get_instance_metrics(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct crtn_counts counts = { 0 };
+    struct pcintr_heap *heap = inst->intr_heap;
+    if (heap) {
+        count_crtns(&heap->crtns, &counts);
+        count_crtns(&heap->stopped_crtns, &counts);
+    }
+
+    size_t nr_moving = 0;
+    purc_inst_holding_messages_count(&nr_moving);
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_object(obj, "coroutines", make_crtns_metrics(&counts)) ||
+            !set_number(obj, "steps", heap ? heap->nr_steps : 0) ||
+            !set_number(obj, "messages", counts.nr_msgs) ||
+            !set_number(obj, "moveBuffer", nr_moving) ||
+            !set_object(obj, "eventLanes", make_lanes_metrics(&counts)) ||
+            !set_object(obj, "framePool", make_frame_pool_metrics(heap)) ||
+            !set_object(obj, "idleTrim", make_idle_trim_metrics(heap)) ||
+            !set_object(obj, "variants",
+                make_variants_metrics(purc_variant_usage_stat())) ||
+            !set_object(obj, "allocator", make_allocator_metrics()) ||
+            !set_object(obj, "renderer",
+                make_renderer_metrics(inst->conn_to_rdr)) ||
+            !set_object(obj, "timers",
+                make_timers_metrics(inst->running_loop)) ||
+            !set_number(obj, "fetcherRequests",
+                pcfetcher_get_nr_pending_requests()) ||
+            !set_object(obj, "fetcherOrigins",
+                make_fetcher_origins_metrics()) ||
+            !set_object(obj, "selectorCache", make_selectors_metrics())) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return obj;
+}
@@ -30,6 +30,7 @@
 #include "private/instance.h"
 #include "private/msg-queue.h"
 #include "private/interpreter.h"
+#include "private/channel.h"
 #include "private/regex.h"
 #include "private/pcrdr.h"
 
@@ -389,7 +390,11 @@ dispatch_inst_event_from_move_buffer(struct pcinst *inst,
 
     case PCINTR_REQUEST_ID_TYPE_CHAN:
     {
-        ret = pcintr_chan_post(res, msg->data);
+        const char *event = purc_variant_get_string_const(msg->eventName);
+        if (event && strcmp(event, MSG_TYPE_WAKEUP_CHAN) == 0)
+            ret = pcchan_wake_up(res);
+        else
+            ret = pcintr_chan_post(res, msg->data);
         break;
     }
 
@@ -431,6 +436,36 @@ find_vdom_by_target_window(uint64_t handle, pcintr_stack_t *pstack)
     return NULL;
 }
 
+/* the page is shared by all the coroutines loaded in it */
+static void
+set_page_hidden(uint64_t handle, bool hidden)
+{
+    pcintr_heap_t heap = pcintr_get_heap();
+    if (heap == NULL) {
+        return;
+    }
+
+    size_t count = pcutils_sorted_array_count(heap->loaded_crtn_handles);
+    for (size_t i = 0; i < count; i++) {
+        pcintr_coroutine_t co = (pcintr_coroutine_t)pcutils_sorted_array_get(
+                heap->loaded_crtn_handles, i, NULL);
+        if (handle != co->target_page_handle || co->page_hidden == hidden) {
+            continue;
+        }
+
+        co->page_hidden = hidden;
+        pcintr_timers_throttle(co->timers, hidden);
+
+        purc_variant_t hvml = purc_variant_make_ulongint(co->cid);
+        pcintr_coroutine_post_event(co->cid,
+                PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY,
+                hvml, MSG_TYPE_RDR_STATE,
+                hidden ? MSG_SUB_TYPE_PAGE_HIDDEN : MSG_SUB_TYPE_PAGE_SHOWN,
+                PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+        purc_variant_unref(hvml);
+    }
+}
+
 static bool
 is_crtn_observe_event(struct pcinst *inst,
         pcintr_coroutine_t co, const pcrdr_msg *msg, purc_variant_t source,
@@ -439,19 +474,21 @@ is_crtn_observe_event(struct pcinst *inst,
     UNUSED_PARAM(inst);
     purc_variant_t observed = source;
 
-    struct pcintr_observer *observer, *next;
-    struct list_head *list = &co->stack.hvml_observers;
+    struct pcintr_observer_iterator it;
+    struct pcintr_observer *observer;
+    enum pcintr_observer_source from = OBSERVER_SOURCE_HVML;
 
 again:
-    list_for_each_entry_safe(observer, next, list, node) {
+    pcintr_observer_iterator_init_ex(&it, &co->stack, from, type, observed);
+    while ((observer = pcintr_observer_iterator_next(&it))) {
         if (observer->is_match(co, observer, (pcrdr_msg *)msg, observed,
                     type, sub_type)) {
             return true;
         }
     }
 
-    if (list != &co->stack.intr_observers) {
-        list = &co->stack.intr_observers;
+    if (from != OBSERVER_SOURCE_INTR) {
+        from = OBSERVER_SOURCE_INTR;
         goto again;
     }
 
@@ -485,6 +522,12 @@ on_plainwindow_event(struct pcinst *inst, const pcrdr_msg *msg,
                 PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
         purc_variant_unref(hvml);
     }
+    else if (strcmp(event, PCRDR_EVENT_HIDE) == 0) {
+        set_page_hidden((uint64_t)msg->targetValue, true);
+    }
+    else if (strcmp(event, PCRDR_EVENT_SHOW) == 0) {
+        set_page_hidden((uint64_t)msg->targetValue, false);
+    }
 }
 
 static void
@@ -516,6 +559,12 @@ on_widget_event(struct pcinst *inst, const pcrdr_msg *msg,
                 PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
         purc_variant_unref(hvml);
     }
+    else if (strcmp(event, PCRDR_EVENT_HIDE) == 0) {
+        set_page_hidden((uint64_t)msg->targetValue, true);
+    }
+    else if (strcmp(event, PCRDR_EVENT_SHOW) == 0) {
+        set_page_hidden((uint64_t)msg->targetValue, false);
+    }
 }
 
 static void
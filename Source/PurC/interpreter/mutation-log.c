@@ -0,0 +1,186 @@
+/*
+ * @file mutation-log.c
+ * @date 2026/10/14
+ * @brief The log of the eDOM operations sent to the renderer for a page.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "internal.h"
+
+#include "private/errors.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define KEY_SEQ                 "seq"
+
+/*
+ * The log is (re)started when the page of the coroutine is loaded, and
+ * keeps the last PCINTR_MUTATION_LOG_SIZE operations on the eDOM, which
+ * are numbered from 1 after the load, one for each operation. The items
+ * of a `batch` request carry the numbers as `seq`; a renderer which
+ * does not support `batch` can count the operations instead.
+ *
+ * A renderer which keeps the DOM of the page, e.g., reconnecting after
+ * the connection was lost, can send `resyncPage` with the number of the
+ * last operation it applied, and gets the operations after it only.
+ */
+struct pcintr_mutation_log {
+    purc_variant_t             *ops;        // the ring of the operations
+    uint64_t                    first_seq;  // of the oldest one kept
+    uint64_t                    next_seq;
+
+    /* the handles of the page when loaded */
+    uint64_t                    workspace_handle;
+    uint64_t                    page_handle;
+    uint64_t                    dom_handle;
+};
+
+static void
+clear_ops(struct pcintr_mutation_log *log)
+{
+    for (uint64_t seq = log->first_seq; seq < log->next_seq; seq++) {
+        PURC_VARIANT_SAFE_CLEAR(log->ops[seq % PCINTR_MUTATION_LOG_SIZE]);
+    }
+}
+
+int
+pcintr_mutation_log_reset(pcintr_coroutine_t co)
+{
+    struct pcintr_mutation_log *log = co->mutation_log;
+    if (log == NULL) {
+        log = calloc(1, sizeof(*log));
+        if (log == NULL)
+            goto failed;
+
+        log->ops = calloc(PCINTR_MUTATION_LOG_SIZE, sizeof(purc_variant_t));
+        if (log->ops == NULL) {
+            free(log);
+            goto failed;
+        }
+        co->mutation_log = log;
+    }
+    else {
+        clear_ops(log);
+    }
+
+    log->first_seq = log->next_seq = 1;
+    log->workspace_handle = co->target_workspace_handle;
+    log->page_handle = co->target_page_handle;
+    log->dom_handle = co->target_dom_handle;
+    return 0;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return -1;
+}
+
+uint64_t
+pcintr_mutation_log_append(pcintr_coroutine_t co, purc_variant_t op)
+{
+    struct pcintr_mutation_log *log = co->mutation_log;
+    if (log == NULL)
+        return 0;
+
+    uint64_t seq = log->next_seq;
+    purc_variant_t v = purc_variant_make_ulongint(seq);
+    if (v == PURC_VARIANT_INVALID)
+        return 0;
+    bool ok = purc_variant_object_set_by_static_ckey(op, KEY_SEQ, v);
+    purc_variant_unref(v);
+    if (!ok)
+        return 0;
+
+    size_t slot = seq % PCINTR_MUTATION_LOG_SIZE;
+    if (seq - log->first_seq == PCINTR_MUTATION_LOG_SIZE) {
+        /* wrapped; drop the oldest one */
+        PURC_VARIANT_SAFE_CLEAR(log->ops[slot]);
+        log->first_seq++;
+    }
+
+    log->ops[slot] = purc_variant_ref(op);
+    log->next_seq++;
+    return seq;
+}
+
+uint64_t
+pcintr_mutation_log_last_seq(pcintr_coroutine_t co)
+{
+    return co->mutation_log ? co->mutation_log->next_seq - 1 : 0;
+}
+
+purc_variant_t
+pcintr_mutation_log_since(pcintr_coroutine_t co, uint64_t last_seq)
+{
+    struct pcintr_mutation_log *log = co->mutation_log;
+
+    /* NOTE: a full load is needed if the log has wrapped */
+    if (log == NULL || last_seq + 1 < log->first_seq ||
+            last_seq >= log->next_seq)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t ops = purc_variant_make_array_0();
+    if (ops == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    for (uint64_t seq = last_seq + 1; seq < log->next_seq; seq++) {
+        if (!purc_variant_array_append(ops,
+                    log->ops[seq % PCINTR_MUTATION_LOG_SIZE])) {
+            purc_variant_unref(ops);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
+    return ops;
+}
+
+bool
+pcintr_mutation_log_restore_page(pcintr_coroutine_t co)
+{
+    struct pcintr_mutation_log *log = co->mutation_log;
+    if (log == NULL || log->dom_handle == 0)
+        return false;
+
+    if (co->target_dom_handle == 0) {
+        /* the handles were cleared when the connection was lost */
+        co->target_workspace_handle = log->workspace_handle;
+        co->target_page_handle = log->page_handle;
+        co->target_dom_handle = log->dom_handle;
+    }
+
+    return co->target_dom_handle == log->dom_handle;
+}
+
+void
+pcintr_mutation_log_destroy(pcintr_coroutine_t co)
+{
+    struct pcintr_mutation_log *log = co->mutation_log;
+    if (log == NULL)
+        return;
+
+    clear_ops(log);
+    free(log->ops);
+    free(log);
+    co->mutation_log = NULL;
+}
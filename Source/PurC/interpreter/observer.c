@@ -30,6 +30,8 @@
 #include "private/msg-queue.h"
 #include "private/interpreter.h"
 #include "private/regex.h"
+#include "private/document.h"
+#include "private/dvobjs.h"
 
 #include <sys/time.h>
 
@@ -42,6 +44,10 @@ release_observer(struct pcintr_observer *observer)
         return;
 
     list_del(&observer->node);
+    list_del(&observer->index_node);
+    if (observer->on_elements) {
+        observer->stack->elem_index_dirty = true;
+    }
 
     if (observer->on_revoke) {
         observer->on_revoke(observer, observer->on_revoke_data);
@@ -80,6 +86,138 @@ free_observer(struct pcintr_observer *observer)
     free(observer);
 }
 
+static bool
+is_match_default(pcintr_coroutine_t co, struct pcintr_observer *observer,
+        pcrdr_msg *msg, purc_variant_t observed, const char *type,
+        const char *sub_type);
+
+/* the observers of an event type using the default matcher */
+struct observer_bucket {
+    struct list_head    intr_observers;
+    struct list_head    hvml_observers;
+};
+
+static void
+free_observer_bucket(void *val)
+{
+    /* NOTE: the observers have been freed with the lists of the stack */
+    free(val);
+}
+
+/* the element observers of an element, of both sources, in the order of
+   registration */
+struct pcintr_elem_observers {
+    size_t                      nr;
+    size_t                      sz;
+    struct pcintr_observer    **observers;
+};
+
+static void
+free_elem_observers(void *val)
+{
+    struct pcintr_elem_observers *bucket = val;
+    free(bucket->observers);
+    free(bucket);
+}
+
+void
+pcintr_destroy_observer_index(pcintr_stack_t stack)
+{
+    if (stack->observer_index) {
+        pcutils_uomap_destroy(stack->observer_index);
+        stack->observer_index = NULL;
+    }
+
+    if (stack->elem_observer_index) {
+        pcutils_uomap_destroy(stack->elem_observer_index);
+        stack->elem_observer_index = NULL;
+    }
+}
+
+static struct observer_bucket *
+find_observer_bucket(pcintr_stack_t stack, const char *type, bool create)
+{
+    pcutils_uomap_entry *entry = NULL;
+    if (stack->observer_index) {
+        entry = pcutils_uomap_find(stack->observer_index, type);
+        if (entry) {
+            return pcutils_uomap_entry_val(entry);
+        }
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    if (stack->observer_index == NULL) {
+        stack->observer_index = pcutils_uomap_create_open(copy_key_string,
+                free_key_string, NULL, free_observer_bucket,
+                NULL, NULL, false);
+        if (stack->observer_index == NULL) {
+            return NULL;
+        }
+    }
+
+    struct observer_bucket *bucket = malloc(sizeof(*bucket));
+    if (bucket == NULL) {
+        return NULL;
+    }
+
+    list_head_init(&bucket->intr_observers);
+    list_head_init(&bucket->hvml_observers);
+    if (pcutils_uomap_insert(stack->observer_index, type, bucket)) {
+        free(bucket);
+        return NULL;
+    }
+
+    /* NOTE: a bucket is kept even when it becomes empty, because it may be
+       in use by an iterator when its last observer is revoked */
+    return bucket;
+}
+
+/* whether the observer observes the elements in the document of the stack,
+   so that it can be indexed by the elements */
+static bool
+is_on_elements(pcintr_stack_t stack, struct pcintr_observer *observer)
+{
+    purc_variant_t observed = observer->observed;
+    if (stack->doc == NULL || !purc_variant_is_native(observed)) {
+        return false;
+    }
+
+    struct purc_native_ops *ops = purc_variant_native_get_ops(observed);
+    if (ops == NULL || ops->property_getter == NULL ||
+            !pcdvobjs_is_elements(observed)) {
+        return false;
+    }
+
+    pcdoc_elem_coll_t coll = purc_variant_native_get_entity(observed);
+    return coll->doc == stack->doc;
+}
+
+static struct list_head *
+index_list_of(pcintr_stack_t stack, struct pcintr_observer *observer)
+{
+    struct observer_bucket *bucket = NULL;
+
+    /* only the default matcher is known to require the same type */
+    if (observer->is_match == is_match_default) {
+        if (is_on_elements(stack, observer)) {
+            observer->on_elements = true;
+            stack->elem_index_dirty = true;
+            return (observer->source == OBSERVER_SOURCE_INTR) ?
+                &stack->intr_elem_observers : &stack->hvml_elem_observers;
+        }
+
+        bucket = find_observer_bucket(stack, observer->type, true);
+    }
+
+    if (observer->source == OBSERVER_SOURCE_INTR) {
+        return bucket ? &bucket->intr_observers : &stack->intr_wildcards;
+    }
+    return bucket ? &bucket->hvml_observers : &stack->hvml_wildcards;
+}
+
 static void
 add_observer_into_list(pcintr_stack_t stack, struct list_head *list,
         struct pcintr_observer* observer)
@@ -87,6 +225,9 @@ add_observer_into_list(pcintr_stack_t stack, struct list_head *list,
     observer->list = list;
     list_add_tail(&observer->node, list);
 
+    observer->seq = stack->observer_seq++;
+    list_add_tail(&observer->index_node, index_list_of(stack, observer));
+
     // TODO:
     PC_ASSERT(stack);
     PC_ASSERT(stack->co->waits >= 0);
@@ -333,12 +474,256 @@ pcintr_revoke_observer(struct pcintr_observer* observer)
     free_observer(observer);
 }
 
+static int
+append_elem_observer(pcintr_stack_t stack, pcdoc_element_t elem,
+        struct pcintr_observer *observer)
+{
+    struct pcintr_elem_observers *bucket;
+    pcutils_uomap_entry *entry;
+
+    entry = pcutils_uomap_find(stack->elem_observer_index, elem);
+    if (entry) {
+        bucket = pcutils_uomap_entry_val(entry);
+    }
+    else {
+        bucket = calloc(1, sizeof(*bucket));
+        if (bucket == NULL) {
+            return -1;
+        }
+
+        if (pcutils_uomap_insert(stack->elem_observer_index, elem, bucket)) {
+            free(bucket);
+            return -1;
+        }
+    }
+
+    if (bucket->nr && bucket->observers[bucket->nr - 1] == observer) {
+        return 0;
+    }
+
+    if (bucket->nr == bucket->sz) {
+        size_t sz = bucket->sz ? bucket->sz * 2 : 4;
+        struct pcintr_observer **observers = realloc(bucket->observers,
+                sizeof(*observers) * sz);
+        if (observers == NULL) {
+            return -1;
+        }
+        bucket->observers = observers;
+        bucket->sz = sz;
+    }
+
+    bucket->observers[bucket->nr++] = observer;
+    return 0;
+}
+
+static int
+reset_elem_observers(void *key, void *val, void *ud)
+{
+    UNUSED_PARAM(key);
+    UNUSED_PARAM(ud);
+    ((struct pcintr_elem_observers *)val)->nr = 0;
+    return 0;
+}
+
+/* returns false if the index can not be used for the time being */
+static bool
+update_elem_observer_index(pcintr_stack_t stack)
+{
+    purc_document_t doc = stack->doc;
+    if (doc == NULL) {
+        return false;
+    }
+
+    if (stack->elem_observer_index && !stack->elem_index_dirty &&
+            stack->elem_index_doc == doc && stack->elem_index_age == doc->age) {
+        return true;
+    }
+
+    if (stack->elem_observer_index == NULL) {
+        stack->elem_observer_index = pcutils_uomap_create_open(NULL, NULL,
+                NULL, free_elem_observers, pchash_default_ptr_hash,
+                pchash_ptr_equal, false);
+        if (stack->elem_observer_index == NULL) {
+            return false;
+        }
+    }
+    else {
+        /* NOTE: the buckets are kept, because they may be in use by an
+           iterator when the index is rebuilt */
+        pcutils_uomap_traverse(stack->elem_observer_index, NULL,
+                reset_elem_observers);
+    }
+
+    /* the index is rebuilt again if it fails here */
+    stack->elem_index_dirty = true;
+
+    struct list_head *lists[] = {
+        &stack->hvml_elem_observers,
+        &stack->intr_elem_observers,
+    };
+
+    for (size_t i = 0; i < PCA_TABLESIZE(lists); i++) {
+        struct pcintr_observer *p;
+        list_for_each_entry(p, lists[i], index_node) {
+            pcdoc_elem_coll_t coll = purc_variant_native_get_entity(
+                    p->observed);
+            /* the document of the stack was replaced */
+            if (coll->doc != doc) {
+                return false;
+            }
+
+            if (doc->age > coll->doc_age && pcdoc_elem_coll_update(coll)) {
+                return false;
+            }
+
+            ssize_t nr_elems = pcdoc_elem_coll_count(doc, coll);
+            for (ssize_t j = 0; j < nr_elems; j++) {
+                pcdoc_element_t elem = pcdoc_elem_coll_get(doc, coll, j);
+                if (elem && append_elem_observer(stack, elem, p)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    stack->elem_index_dirty = false;
+    stack->elem_index_doc = doc;
+    stack->elem_index_age = doc->age;
+    return true;
+}
+
+void
+pcintr_observer_iterator_init(struct pcintr_observer_iterator *it,
+        pcintr_stack_t stack, enum pcintr_observer_source source,
+        const char *type)
+{
+    struct observer_bucket *bucket = NULL;
+    if (type) {
+        bucket = find_observer_bucket(stack, type, false);
+    }
+
+    if (source == OBSERVER_SOURCE_INTR) {
+        it->indexed = bucket ? &bucket->intr_observers : NULL;
+        it->wildcards = &stack->intr_wildcards;
+    }
+    else {
+        it->indexed = bucket ? &bucket->hvml_observers : NULL;
+        it->wildcards = &stack->hvml_wildcards;
+    }
+
+    it->next_indexed = it->indexed ? it->indexed->next : NULL;
+    it->next_wildcard = it->wildcards->next;
+
+    /* all element observers are visited */
+    it->source = source;
+    it->elements = (source == OBSERVER_SOURCE_INTR) ?
+        &stack->intr_elem_observers : &stack->hvml_elem_observers;
+    it->next_element = it->elements->next;
+    it->elem_bucket = NULL;
+    it->next_elem_idx = 0;
+}
+
+void
+pcintr_observer_iterator_init_ex(struct pcintr_observer_iterator *it,
+        pcintr_stack_t stack, enum pcintr_observer_source source,
+        const char *type, purc_variant_t elem_value)
+{
+    pcintr_observer_iterator_init(it, stack, source, type);
+    if (list_empty(it->elements)) {
+        return;
+    }
+
+    /* a selector is matched by every element observer */
+    if (elem_value && purc_variant_is_string(elem_value)) {
+        return;
+    }
+
+    /* only a native entity can be matched by the elements */
+    if (elem_value == PURC_VARIANT_INVALID ||
+            !purc_variant_is_native(elem_value)) {
+        it->elements = NULL;
+        return;
+    }
+
+    /* the native handle of an element, e.g., from the renderer */
+    if (purc_variant_native_get_ops(elem_value) == NULL &&
+            update_elem_observer_index(stack)) {
+        void *entity = purc_variant_native_get_entity(elem_value);
+        pcutils_uomap_entry *entry;
+        entry = pcutils_uomap_find(stack->elem_observer_index, entity);
+        it->elements = NULL;
+        it->elem_bucket = entry ? pcutils_uomap_entry_val(entry) : NULL;
+    }
+}
+
+static struct pcintr_observer *
+peek_element_observer(struct pcintr_observer_iterator *it)
+{
+    if (it->elem_bucket) {
+        while (it->next_elem_idx < it->elem_bucket->nr) {
+            struct pcintr_observer *p;
+            p = it->elem_bucket->observers[it->next_elem_idx];
+            if (p->source == it->source) {
+                return p;
+            }
+            it->next_elem_idx++;
+        }
+    }
+    else if (it->elements && it->next_element != it->elements) {
+        return list_entry(it->next_element, struct pcintr_observer,
+                index_node);
+    }
+
+    return NULL;
+}
+
+/* like list_for_each_entry_safe(), the returned observer can be revoked */
+struct pcintr_observer *
+pcintr_observer_iterator_next(struct pcintr_observer_iterator *it)
+{
+    struct pcintr_observer *indexed = NULL, *wildcard = NULL, *element;
+
+    if (it->indexed && it->next_indexed != it->indexed) {
+        indexed = list_entry(it->next_indexed, struct pcintr_observer,
+                index_node);
+    }
+    if (it->next_wildcard != it->wildcards) {
+        wildcard = list_entry(it->next_wildcard, struct pcintr_observer,
+                index_node);
+    }
+    element = peek_element_observer(it);
+
+    /* merge the lists by the order of registration */
+    if (element && (indexed == NULL || element->seq < indexed->seq) &&
+            (wildcard == NULL || element->seq < wildcard->seq)) {
+        if (it->elem_bucket) {
+            it->next_elem_idx++;
+        }
+        else {
+            it->next_element = it->next_element->next;
+        }
+        return element;
+    }
+    if (indexed && (wildcard == NULL || indexed->seq < wildcard->seq)) {
+        it->next_indexed = it->next_indexed->next;
+        return indexed;
+    }
+    if (wildcard) {
+        it->next_wildcard = it->next_wildcard->next;
+    }
+    return wildcard;
+}
+
 static void
-revoke_observer_from_list(pcintr_coroutine_t co, struct list_head *list,
+revoke_observer_from_list(pcintr_coroutine_t co,
+        enum pcintr_observer_source source,
         purc_variant_t observed, const char *type, const char *sub_type)
 {
-    struct pcintr_observer *p, *n;
-    list_for_each_entry_safe(p, n, list, node) {
+    struct pcintr_observer_iterator it;
+    struct pcintr_observer *p;
+
+    pcintr_observer_iterator_init(&it, &co->stack, source, type);
+    while ((p = pcintr_observer_iterator_next(&it))) {
         if (p->is_match(co, p, NULL, observed, type, sub_type)) {
             pcintr_revoke_observer(p);
             break;
@@ -350,9 +735,9 @@ void
 pcintr_revoke_observer_ex(pcintr_stack_t stack, purc_variant_t observed,
         const char *type, const char *sub_type)
 {
-    revoke_observer_from_list(stack->co, &stack->hvml_observers, observed,
+    revoke_observer_from_list(stack->co, OBSERVER_SOURCE_HVML, observed,
             type, sub_type);
-    revoke_observer_from_list(stack->co, &stack->intr_observers, observed,
+    revoke_observer_from_list(stack->co, OBSERVER_SOURCE_INTR, observed,
             type, sub_type);
 }
 
@@ -0,0 +1,133 @@
+/*
+ * @file placement.c
+ * @date 2026/10/14
+ * @brief The CPU affinity and the NUMA node of the threads of instances.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include "config.h"
+
+#include "purc.h"
+
+#include "private/runners.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if HAVE(PTHREAD_SETAFFINITY_NP)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if HAVE(LINUX_MEMPOLICY_H)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define MAX_NUMA_NODES      1024
+
+#if HAVE(PTHREAD_SETAFFINITY_NP)
+/* parses a CPU list like `0-3,8,10-11` */
+static int parse_cpu_list(const char *list, cpu_set_t *set)
+{
+    CPU_ZERO(set);
+
+    const char *p = list;
+    while (*p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE)
+            return -1;
+
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            p++;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first || last >= CPU_SETSIZE)
+                return -1;
+            p = end;
+        }
+
+        for (long cpu = first; cpu <= last; cpu++)
+            CPU_SET(cpu, set);
+
+        if (*p == ',')
+            p++;
+        else if (*p)
+            return -1;
+    }
+
+    return CPU_COUNT(set) ? 0 : -1;
+}
+#endif
+
+static int bind_cpus(const char *cpu_affinity)
+{
+#if HAVE(PTHREAD_SETAFFINITY_NP)
+    cpu_set_t set;
+    if (parse_cpu_list(cpu_affinity, &set))
+        return -1;
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) ? -1 : 0;
+#else
+    (void)cpu_affinity;
+    return -1;
+#endif
+}
+
+static int prefer_numa_node(const char *numa_node)
+{
+#if HAVE(LINUX_MEMPOLICY_H) && defined(SYS_set_mempolicy)
+    if (strcmp(numa_node, "local") == 0)
+        return syscall(SYS_set_mempolicy, MPOL_LOCAL, NULL, 0) ? -1 : 0;
+
+    char *end;
+    long node = strtol(numa_node, &end, 10);
+    if (end == numa_node || *end || node < 0 || node >= MAX_NUMA_NODES)
+        return -1;
+
+    unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = { };
+    mask[node / (8 * sizeof(unsigned long))] =
+        1UL << (node % (8 * sizeof(unsigned long)));
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask,
+            MAX_NUMA_NODES + 1) ? -1 : 0;
+#else
+    (void)numa_node;
+    return -1;
+#endif
+}
+
+int
+pcrun_place_current_thread(const char *cpu_affinity, const char *numa_node)
+{
+    int ret = 0;
+
+    /* bind to the CPUs first, so that `local` means the node of them */
+    if (cpu_affinity && bind_cpus(cpu_affinity))
+        ret = -1;
+
+    if (numa_node && prefer_numa_node(numa_node))
+        ret = -1;
+
+    return ret;
+}
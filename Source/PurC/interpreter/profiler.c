@@ -0,0 +1,614 @@
+/*
+ * @file profiler.c
+ * @date 2026/10/14
+ * @brief The element-level profiler of the coroutines.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "internal.h"
+
+#include "private/errors.h"
+#include "private/instance.h"
+#include "private/variant.h"
+#include "private/map.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_PROFILE_PATH        512
+#define MAX_ELEMENT_DESC        96
+
+/*
+ * The profiler charges the time and the variants allocated by a step of
+ * a coroutine to the folded path of the element on the bottom frame, e.g.,
+ * `hvml;body;iterate;update`, and the ones spent in evaluating an
+ * attribute of an element to the path of the element with the attribute
+ * name appended, e.g., `hvml;body;iterate;@on`. The time of the step
+ * excludes the one of the attributes evaluated in the step.
+ */
+struct profile_entry {
+    uint64_t        nr_samples;
+    uint64_t        self_ns;
+    uint64_t        nr_allocs;
+};
+
+/*
+ * The counters of a vDOM element, which are kept besides the folded paths
+ * to find the hot elements of a loop: the times the element was executed
+ * (pushed onto the stack), the steps run on it, the self time of the steps,
+ * and the time spent in evaluating its attributes (VCM).
+ *
+ * NOTE: the path and the start tag are copied, because the vDOM may be
+ * released before the counters are dumped.
+ */
+struct element_counters {
+    char           *path;
+    char           *desc;
+    uint64_t        nr_execs;
+    uint64_t        nr_steps;
+    uint64_t        self_ns;
+    uint64_t        vcm_ns;
+    uint64_t        nr_allocs;
+};
+
+struct pcintr_profiler {
+    pcutils_uomap  *entries;        // folded path -> struct profile_entry
+    pcutils_uomap  *elements;       // element -> struct element_counters
+
+    // the counters of the element on the bottom frame of the current step
+    struct element_counters *step_elem;
+    unsigned int    dump_gen;       // the dump requests handled
+
+    char            step_path[MAX_PROFILE_PATH];
+    uint64_t        step_begin_ns;
+    size_t          step_begin_allocs;
+
+    uint64_t        attr_begin_ns;
+    size_t          attr_begin_allocs;
+    unsigned int    attr_depth;
+
+    // the time and the allocations of the attributes in the current step.
+    uint64_t        attrs_ns;
+    size_t          attrs_allocs;
+};
+
+static inline uint64_t
+get_monotonic_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec * 1000000000ULL + (uint64_t)tp.tv_nsec;
+}
+
+static inline size_t
+get_nr_allocs(void)
+{
+    struct pcinst *inst = pcinst_current();
+    return (inst && inst->variant_heap) ? inst->variant_heap->nr_allocs : 0;
+}
+
+static size_t
+build_path(struct pcintr_stack_frame *frame, char *buf, size_t sz)
+{
+    const char *tags[MAX_PROFILE_PATH / 2];
+    size_t nr_tags = 0;
+
+    for (; frame && nr_tags < PCA_TABLESIZE(tags);
+            frame = pcintr_stack_frame_get_parent(frame)) {
+        if (frame->pos && frame->pos->tag_name)
+            tags[nr_tags++] = frame->pos->tag_name;
+    }
+
+    size_t len = 0;
+    buf[0] = 0;
+    while (nr_tags > 0 && len < sz - 1) {
+        int n = snprintf(buf + len, sz - len, "%s%s",
+                len ? ";" : "", tags[--nr_tags]);
+        if (n < 0)
+            break;
+        len += (size_t)n;
+    }
+
+    if (len >= sz)
+        len = sz - 1;
+    else if (len == 0)
+        len = snprintf(buf, sz, "(coroutine)");
+    return len;
+}
+
+static void
+charge(struct pcintr_profiler *profiler, const char *path,
+        uint64_t ns, size_t nr_allocs)
+{
+    pcutils_uomap_entry *entry = pcutils_uomap_find(profiler->entries, path);
+    struct profile_entry *pe;
+
+    if (entry) {
+        pe = pcutils_uomap_entry_val(entry);
+    }
+    else {
+        pe = calloc(1, sizeof(*pe));
+        if (pe == NULL)
+            return;
+
+        if (pcutils_uomap_insert(profiler->entries, path, pe)) {
+            free(pe);
+            return;
+        }
+    }
+
+    pe->nr_samples++;
+    pe->self_ns += ns;
+    pe->nr_allocs += nr_allocs;
+}
+
+static void
+free_profile_entry(void *val)
+{
+    free(val);
+}
+
+static void
+free_element_counters(void *val)
+{
+    struct element_counters *ec = val;
+    free(ec->path);
+    free(ec->desc);
+    free(ec);
+}
+
+struct desc_buff {
+    char   *buf;
+    size_t  len;
+};
+
+static int
+desc_write(const char *buf, size_t len, void *ctxt)
+{
+    struct desc_buff *desc = ctxt;
+    for (size_t i = 0; i < len && desc->len < MAX_ELEMENT_DESC - 1; i++) {
+        /* keep the start tag in one line */
+        char c = buf[i];
+        if (c == '\n' || c == '\r' || c == '\t')
+            c = ' ';
+        if (c == ' ' && desc->len > 0 && desc->buf[desc->len - 1] == ' ')
+            continue;
+        desc->buf[desc->len++] = c;
+    }
+    return 0;
+}
+
+static struct element_counters *
+get_element_counters(struct pcintr_profiler *profiler,
+        struct pcintr_stack_frame *frame)
+{
+    pcvdom_element_t elem = frame->pos;
+    pcutils_uomap_entry *entry = pcutils_uomap_find(profiler->elements, elem);
+    if (entry)
+        return pcutils_uomap_entry_val(entry);
+
+    struct element_counters *ec = calloc(1, sizeof(*ec));
+    if (ec == NULL)
+        return NULL;
+
+    char path[MAX_PROFILE_PATH];
+    build_path(frame, path, sizeof(path));
+    ec->path = strdup(path);
+
+    char buf[MAX_ELEMENT_DESC];
+    struct desc_buff desc = { buf, 0 };
+    pcvdom_util_node_serialize_alone(&elem->node, desc_write, &desc);
+    while (desc.len > 0 && buf[desc.len - 1] == ' ')
+        desc.len--;
+    buf[desc.len] = 0;
+    ec->desc = strdup(buf);
+
+    if (ec->path == NULL || ec->desc == NULL ||
+            pcutils_uomap_insert(profiler->elements, elem, ec)) {
+        free_element_counters(ec);
+        return NULL;
+    }
+
+    return ec;
+}
+
+static struct pcintr_profiler *
+profiler_new(void)
+{
+    struct pcintr_profiler *profiler = calloc(1, sizeof(*profiler));
+    if (profiler == NULL)
+        goto failed;
+
+    profiler->entries = pcutils_uomap_create(copy_key_string,
+            free_key_string, NULL, free_profile_entry,
+            pchash_fnv1a_str_hash, comp_key_string, false, false);
+    if (profiler->entries == NULL) {
+        free(profiler);
+        goto failed;
+    }
+
+    profiler->elements = pcutils_uomap_create(NULL, NULL,
+            NULL, free_element_counters,
+            pchash_fnv1a_ptr_hash, pchash_ptr_equal, false, false);
+    if (profiler->elements == NULL) {
+        pcutils_uomap_destroy(profiler->entries);
+        free(profiler);
+        goto failed;
+    }
+
+    profiler->dump_gen = pcintr_profiler_dump_requests();
+    return profiler;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
+}
+
+void
+pcintr_profiler_destroy(struct pcintr_profiler *profiler)
+{
+    if (profiler) {
+        PC_DEBUG("Profiler destroyed with %u paths profiled\n",
+                (unsigned)pcutils_uomap_get_size(profiler->entries));
+        pcutils_uomap_destroy(profiler->entries);
+        pcutils_uomap_destroy(profiler->elements);
+        free(profiler);
+    }
+}
+
+void
+pcintr_profiler_begin_step(struct pcintr_heap *heap, pcintr_coroutine_t co)
+{
+    struct pcintr_profiler *profiler = heap->profiler;
+    struct pcintr_stack_frame *frame;
+
+    frame = pcintr_stack_get_bottom_frame(&co->stack);
+    build_path(frame, profiler->step_path, sizeof(profiler->step_path));
+
+    profiler->step_elem = NULL;
+    if (frame && frame->pos) {
+        profiler->step_elem = get_element_counters(profiler, frame);
+        /* the first step of a frame executes the element once more */
+        if (profiler->step_elem && frame->next_step == NEXT_STEP_AFTER_PUSHED)
+            profiler->step_elem->nr_execs++;
+    }
+
+    profiler->attrs_ns = 0;
+    profiler->attrs_allocs = 0;
+    profiler->attr_depth = 0;
+    profiler->step_begin_allocs = get_nr_allocs();
+    profiler->step_begin_ns = get_monotonic_ns();
+}
+
+void
+pcintr_profiler_end_step(struct pcintr_heap *heap, pcintr_coroutine_t co)
+{
+    UNUSED_PARAM(co);
+    struct pcintr_profiler *profiler = heap->profiler;
+
+    uint64_t ns = get_monotonic_ns() - profiler->step_begin_ns;
+    size_t nr_allocs = get_nr_allocs() - profiler->step_begin_allocs;
+
+    ns = (ns > profiler->attrs_ns) ? ns - profiler->attrs_ns : 0;
+    nr_allocs = (nr_allocs > profiler->attrs_allocs) ?
+        nr_allocs - profiler->attrs_allocs : 0;
+    charge(profiler, profiler->step_path, ns, nr_allocs);
+
+    struct element_counters *ec = profiler->step_elem;
+    if (ec) {
+        ec->nr_steps++;
+        ec->self_ns += ns;
+        ec->nr_allocs += nr_allocs;
+        profiler->step_elem = NULL;
+    }
+}
+
+void
+pcintr_profiler_begin_attr(struct pcintr_heap *heap)
+{
+    struct pcintr_profiler *profiler = heap->profiler;
+
+    /* NOTE: only the outermost evaluation is timed. */
+    if (profiler->attr_depth++ == 0) {
+        profiler->attr_begin_allocs = get_nr_allocs();
+        profiler->attr_begin_ns = get_monotonic_ns();
+    }
+}
+
+void
+pcintr_profiler_end_attr(struct pcintr_heap *heap,
+        struct pcintr_stack_frame *frame, const char *attr_name)
+{
+    struct pcintr_profiler *profiler = heap->profiler;
+
+    if (profiler->attr_depth == 0 || --profiler->attr_depth > 0)
+        return;
+
+    uint64_t ns = get_monotonic_ns() - profiler->attr_begin_ns;
+    size_t nr_allocs = get_nr_allocs() - profiler->attr_begin_allocs;
+    profiler->attrs_ns += ns;
+    profiler->attrs_allocs += nr_allocs;
+
+    char path[MAX_PROFILE_PATH];
+    size_t len = build_path(frame, path, sizeof(path));
+    snprintf(path + len, sizeof(path) - len, ";@%s", attr_name);
+    charge(profiler, path, ns, nr_allocs);
+
+    if (frame && frame->pos) {
+        struct element_counters *ec = get_element_counters(profiler, frame);
+        if (ec) {
+            ec->vcm_ns += ns;
+            ec->nr_allocs += nr_allocs;
+        }
+    }
+}
+
+int
+purc_enable_profiler(bool enable)
+{
+    struct pcintr_heap *heap = pcintr_get_heap();
+    if (heap == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return -1;
+    }
+
+    if (enable && heap->profiler == NULL) {
+        heap->profiler = profiler_new();
+        if (heap->profiler == NULL)
+            return -1;
+    }
+
+    heap->profiling = enable ? 1 : 0;
+    return 0;
+}
+
+void
+purc_reset_profile(void)
+{
+    struct pcintr_heap *heap = pcintr_get_heap();
+    if (heap && heap->profiler) {
+        pcutils_uomap_clear(heap->profiler->entries);
+        pcutils_uomap_clear(heap->profiler->elements);
+        heap->profiler->step_elem = NULL;
+    }
+}
+
+struct dump_ctxt {
+    purc_rwstream_t     stm;
+    unsigned int        flags;
+};
+
+static int
+dump_entry(void *key, void *val, void *ud)
+{
+    struct dump_ctxt *ctxt = ud;
+    const struct profile_entry *pe = val;
+    unsigned long long weight;
+
+    if (ctxt->flags & PURC_PROFILE_ALLOCS)
+        weight = pe->nr_allocs;
+    else
+        weight = pe->self_ns / 1000;
+
+    if (weight == 0)
+        return 0;
+
+    char buf[32];
+    purc_rwstream_write(ctxt->stm, key, strlen(key));
+    int n = snprintf(buf, sizeof(buf), " %llu\n", weight);
+    purc_rwstream_write(ctxt->stm, buf, n);
+    return 0;
+}
+
+static int
+cmp_element_time(const void *a, const void *b)
+{
+    const struct element_counters *ea = *(const struct element_counters **)a;
+    const struct element_counters *eb = *(const struct element_counters **)b;
+    uint64_t ta = ea->self_ns + ea->vcm_ns;
+    uint64_t tb = eb->self_ns + eb->vcm_ns;
+
+    if (ta == tb)
+        return 0;
+    return (ta < tb) ? 1 : -1;
+}
+
+struct collect_ctxt {
+    struct element_counters **all;
+    size_t                    sz;
+    size_t                    nr;
+};
+
+static int
+collect_element(void *key, void *val, void *ud)
+{
+    UNUSED_PARAM(key);
+    struct collect_ctxt *ctxt = ud;
+    if (ctxt->nr < ctxt->sz)
+        ctxt->all[ctxt->nr++] = val;
+    return 0;
+}
+
+/* Dumps the counters of the elements, the hottest first. */
+static void
+dump_elements(struct pcintr_profiler *profiler, purc_rwstream_t stm)
+{
+    size_t nr = pcutils_uomap_get_size(profiler->elements);
+    struct element_counters **all = NULL;
+    if (nr > 0 && (all = malloc(sizeof(*all) * nr)) == NULL)
+        return;
+
+    struct collect_ctxt ctxt = { all, nr, 0 };
+    pcutils_uomap_traverse(profiler->elements, &ctxt, collect_element);
+    nr = ctxt.nr;
+    if (nr > 0)
+        qsort(all, nr, sizeof(*all), cmp_element_time);
+
+    char buf[MAX_PROFILE_PATH + MAX_ELEMENT_DESC + 128];
+    int n = snprintf(buf, sizeof(buf), "# %10s %10s %12s %12s %12s %10s  %s\n",
+            "execs", "steps", "total_us", "self_us", "vcm_us", "variants",
+            "element");
+    purc_rwstream_write(stm, buf, (size_t)n);
+
+    for (size_t i = 0; i < nr; i++) {
+        const struct element_counters *ec = all[i];
+        n = snprintf(buf, sizeof(buf), "  %10llu %10llu %12llu %12llu %12llu "
+                "%10llu  %s %s\n",
+                (unsigned long long)ec->nr_execs,
+                (unsigned long long)ec->nr_steps,
+                (unsigned long long)(ec->self_ns + ec->vcm_ns) / 1000,
+                (unsigned long long)ec->self_ns / 1000,
+                (unsigned long long)ec->vcm_ns / 1000,
+                (unsigned long long)ec->nr_allocs, ec->path, ec->desc);
+        if (n > 0)
+            purc_rwstream_write(stm, buf, strnlen(buf, sizeof(buf)));
+    }
+
+    free(all);
+}
+
+int
+purc_dump_profile(purc_rwstream_t stm, unsigned int flags)
+{
+    struct pcintr_heap *heap = pcintr_get_heap();
+    if (heap == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return -1;
+    }
+
+    if (stm == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (heap->profiler == NULL)
+        return 0;
+
+    if (flags & PURC_PROFILE_ELEMENTS) {
+        dump_elements(heap->profiler, stm);
+    }
+    else {
+        struct dump_ctxt ctxt = { stm, flags };
+        pcutils_uomap_traverse(heap->profiler->entries, &ctxt, dump_entry);
+    }
+
+    return 0;
+}
+
+void
+pcintr_profiler_dump_element(struct pcintr_heap *heap,
+        pcvdom_element_t elem, purc_rwstream_t stm)
+{
+    if (heap->profiler == NULL)
+        return;
+
+    pcutils_uomap_entry *entry;
+    entry = pcutils_uomap_find(heap->profiler->elements, elem);
+    if (entry == NULL)
+        return;
+
+    const struct element_counters *ec = pcutils_uomap_entry_val(entry);
+    char buf[256];
+    int n = snprintf(buf, sizeof(buf), "  PROFILE: executed %llu times, "
+            "%llu steps, self %.3f ms, evaluation %.3f ms, "
+            "%llu variants\n",
+            (unsigned long long)ec->nr_execs,
+            (unsigned long long)ec->nr_steps,
+            ec->self_ns / 1e6, ec->vcm_ns / 1e6,
+            (unsigned long long)ec->nr_allocs);
+    if (n > 0)
+        purc_rwstream_write(stm, buf, strnlen(buf, sizeof(buf)));
+}
+
+/* NOTE: it is changed in the signal handlers, so it must be lock-free. */
+static atomic_uint dump_requests;
+
+void
+purc_request_profile_dump(void)
+{
+    atomic_fetch_add_explicit(&dump_requests, 1, memory_order_relaxed);
+}
+
+unsigned int
+pcintr_profiler_dump_requests(void)
+{
+    return atomic_load_explicit(&dump_requests, memory_order_relaxed);
+}
+
+static void
+dump_to_file(struct pcintr_heap *heap, const char *file, const char *why)
+{
+    purc_rwstream_t stm = purc_rwstream_new_from_file(file, "a");
+    if (stm == NULL) {
+        PC_WARN("Failed to open the profile file: %s\n", file);
+        return;
+    }
+
+    struct pcinst *inst = pcinst_current();
+    char buf[256];
+    int n = snprintf(buf, sizeof(buf), "# The profile of runner `%s/%s` "
+            "(%s)\n", inst ? inst->app_name : "", inst ? inst->runner_name : "",
+            why);
+    if (n > 0)
+        purc_rwstream_write(stm, buf, strnlen(buf, sizeof(buf)));
+
+    dump_elements(heap->profiler, stm);
+    purc_rwstream_write(stm, "\n", 1);
+    purc_rwstream_destroy(stm);
+}
+
+void
+pcintr_profiler_init_from_env(struct pcintr_heap *heap)
+{
+    const char *file = getenv(PURC_ENVV_PROFILE_FILE);
+    if (file == NULL || file[0] == 0)
+        return;
+
+    heap->profiler = profiler_new();
+    if (heap->profiler)
+        heap->profiling = 1;
+}
+
+void
+pcintr_profiler_check_requests(struct pcintr_heap *heap)
+{
+    unsigned int gen = pcintr_profiler_dump_requests();
+    if (gen == heap->profiler->dump_gen)
+        return;
+
+    heap->profiler->dump_gen = gen;
+
+    const char *file = getenv(PURC_ENVV_PROFILE_FILE);
+    if (file && file[0])
+        dump_to_file(heap, file, "requested");
+}
+
+void
+pcintr_profiler_dump_at_exit(struct pcintr_heap *heap)
+{
+    const char *file = getenv(PURC_ENVV_PROFILE_FILE);
+    if (file && file[0])
+        dump_to_file(heap, file, "exited");
+}
@@ -116,6 +116,26 @@ object_set(purc_variant_t object, const char *key, const char *value)
     return true;
 }
 
+static int
+pipelined_response_handler(pcrdr_conn* conn,
+        const char *request_id, int state,
+        void *context, const pcrdr_msg *response_msg)
+{
+    UNUSED_PARAM(conn);
+    UNUSED_PARAM(context);
+
+    if (state != PCRDR_RESPONSE_RESULT) {
+        PC_WARN("No response for the pipelined request %s: %d\n",
+                request_id, state);
+    }
+    else if (response_msg->retCode != PCRDR_SC_OK) {
+        PC_WARN("The pipelined request %s failed: %d\n",
+                request_id, response_msg->retCode);
+    }
+
+    return 0;
+}
+
 pcrdr_msg *pcintr_rdr_send_request_and_wait_response_ex(struct pcrdr_conn *conn,
         pcrdr_msg_target target, uint64_t target_value, const char *operation,
         const char *request_id, pcrdr_msg_element_type element_type,
@@ -124,6 +144,20 @@ pcrdr_msg *pcintr_rdr_send_request_and_wait_response_ex(struct pcrdr_conn *conn,
         int seconds_expected)
 {
     pcrdr_msg *response_msg = NULL;
+
+    /* NOTE: keep the order of the requests of the current coroutine. */
+    pcintr_coroutine_t co = pcintr_get_coroutine();
+    if (co && co->rdr_batch) {
+        pcintr_rdr_flush_dom_batch(co);
+    }
+
+    bool pipelined = false;
+    if (request_id && strcmp(request_id,
+                PCINTR_RDR_PIPELINED_REQUEST_ID) == 0) {
+        pipelined = true;
+        request_id = NULL;
+    }
+
     pcrdr_msg *msg = pcrdr_make_request_message(
             target,                             /* target */
             target_value,                       /* target_value */
@@ -153,6 +187,10 @@ pcrdr_msg *pcintr_rdr_send_request_and_wait_response_ex(struct pcrdr_conn *conn,
     if (request_id && strcmp(request_id, PCINTR_RDR_NORETURN_REQUEST_ID) == 0) {
         pcrdr_send_request(conn, msg, seconds_expected, NULL, NULL);
     }
+    else if (pipelined) {
+        pcrdr_send_request(conn, msg, seconds_expected, NULL,
+                pipelined_response_handler);
+    }
     else {
         pcrdr_send_request_and_wait_response(conn,
                 msg, seconds_expected, &response_msg);
@@ -969,121 +1007,161 @@ check_response_for_suppressed(struct pcinst *inst,
 
 #define PCRDR_TIME_LARGE_EXPECTED       10
 
-static pcrdr_msg *
-rdr_page_control_load_large_page(struct pcrdr_conn *conn,
-        pcintr_coroutine_t co_loaded,
-        pcrdr_msg_target target, uint64_t target_value, const char *elem,
-        pcrdr_msg_data_type data_type,
-        const char *doc_content, size_t len_content)
-{
-    pcrdr_msg *response_msg = NULL;
-    purc_variant_t data = PURC_VARIANT_INVALID;
-    size_t len_wrotten;
-    size_t len_to_write = 0;
+/* the max number of the pipelined writeMore requests in flight */
+#define MAX_PENDING_CHUNKS              4
 
-    // writeBegin
-    const char *start = doc_content;
-    const char *end;
-    pcutils_string_check_utf8_len(start, DEF_LEN_ONE_WRITE, NULL, &end);
-    if (end > start) {
-        len_to_write = end - start;
+/*
+ * The document is serialized to the renderer by chunks, so the first
+ * chunk reaches the renderer before the serialization finishes, and
+ * only one chunk is held in memory. The last chunk is always kept for
+ * writeEnd, or for load if the whole document fits in one chunk.
+ */
+struct page_writer {
+    struct pcrdr_conn      *conn;
+    pcintr_coroutine_t      co_loaded;
+    pcrdr_msg_target        target;
+    uint64_t                target_value;
+    const char             *elem;
+    pcrdr_msg_data_type     data_type;
+
+    size_t                  nr_chunks;  // the number of chunks sent
+    pcrdr_msg              *response;   // the response of load or writeEnd
+    bool                    failed;
+
+    size_t                  len;        // the length of the content held
+    char                    buf[DEF_LEN_ONE_WRITE * 2];
+};
 
-        data = purc_variant_make_string_static(start, false);
-        len_wrotten = len_to_write;
-    }
-    else {
-        LOG_ERROR("No valid character in document content\n");
-        goto failed;
+/* sends a chunk in @len bytes at the head of the buffer */
+static pcrdr_msg *
+send_page_chunk(struct page_writer *writer, const char *operation,
+        size_t len, bool pipelined)
+{
+    purc_variant_t data;
+    data = purc_variant_make_string_ex(writer->buf, len, false);
+    if (data == PURC_VARIANT_INVALID) {
+        writer->failed = true;
+        return NULL;
     }
 
-    response_msg = pcintr_rdr_send_request_and_wait_response_ex(
-            conn, target, target_value, PCRDR_OPERATION_WRITEBEGIN, NULL,
-            PCRDR_MSG_ELEMENT_TYPE_HANDLE, elem, NULL,
-            data_type, data, len_to_write, PCRDR_TIME_LARGE_EXPECTED);
+    pcrdr_msg *response_msg = pcintr_rdr_send_request_and_wait_response_ex(
+            writer->conn, writer->target, writer->target_value, operation,
+            pipelined ? PCINTR_RDR_PIPELINED_REQUEST_ID : NULL,
+            writer->nr_chunks ? PCRDR_MSG_ELEMENT_TYPE_VOID :
+                PCRDR_MSG_ELEMENT_TYPE_HANDLE,
+            writer->nr_chunks ? NULL : writer->elem, NULL,
+            writer->data_type, data, len, PCRDR_TIME_LARGE_EXPECTED);
     purc_variant_unref(data);
+    writer->nr_chunks++;
+
+    writer->len -= len;
+    memmove(writer->buf, writer->buf + len, writer->len);
+
+    if (pipelined)
+        return NULL;
 
     if (response_msg == NULL) {
-        PC_ERROR("Failed to send request to renderer expired=%d\n", PCRDR_TIME_LARGE_EXPECTED);
-        goto failed;
+        PC_ERROR("Failed to send %s to renderer\n", operation);
+        writer->failed = true;
     }
-
-    if (response_msg->retCode != PCRDR_SC_OK) {
-        PC_ERROR("Failed to write content to renderer\n");
-        goto failed;
+    else if (response_msg->retCode != PCRDR_SC_OK) {
+        PC_ERROR("Failed to write content to renderer: %d\n",
+                response_msg->retCode);
+        writer->failed = true;
     }
 
-    check_response_for_suppressed(pcinst_current(), co_loaded, response_msg);
+    return response_msg;
+}
 
-    if (len_wrotten == len_content) {
-        goto done;
+/* waits for the responses of the chunks in flight to apply back-pressure */
+static bool
+wait_for_pending_chunks(struct page_writer *writer)
+{
+    while (pcrdr_conn_pending_requests_count(writer->conn) >=
+            MAX_PENDING_CHUNKS) {
+        if (pcrdr_wait_and_dispatch_message(writer->conn,
+                    PCRDR_TIME_LARGE_EXPECTED * 1000) < 0) {
+            PC_ERROR("Failed to wait for the renderer\n");
+            return false;
+        }
     }
 
-writting:
-    len_to_write = 0;
-    if (len_wrotten + DEF_LEN_ONE_WRITE > len_content) {
-        // writeEnd
-        data = purc_variant_make_string_static(doc_content + len_wrotten,
-                false);
-        response_msg = pcintr_rdr_send_request_and_wait_response_ex(
-                conn, target, target_value, PCRDR_OPERATION_WRITEEND, NULL,
-                PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL, data_type, data, 0,
-                PCRDR_TIME_LARGE_EXPECTED);
-        purc_variant_unref(data);
-        if (response_msg == NULL) {
-            PC_ERROR("Failed to send request to renderer\n");
-            goto failed;
-        }
+    return true;
+}
 
-        if (response_msg->retCode != PCRDR_SC_OK) {
-            PC_ERROR("failed to write content to rdr\n");
-            goto failed;
-        }
+static void
+send_middle_chunk(struct page_writer *writer)
+{
+    const char *end;
+    pcutils_string_check_utf8_len(writer->buf, DEF_LEN_ONE_WRITE, NULL, &end);
+    if (end == writer->buf) {
+        LOG_ERROR("No valid character in document content\n");
+        writer->failed = true;
+        return;
+    }
 
-        goto done;
+    size_t len = end - writer->buf;
+    if (writer->nr_chunks == 0) {
+        /* writeBegin: the response may tell the suppressed coroutine */
+        pcrdr_msg *response_msg = send_page_chunk(writer,
+                PCRDR_OPERATION_WRITEBEGIN, len, false);
+        if (response_msg) {
+            if (!writer->failed)
+                check_response_for_suppressed(pcinst_current(),
+                        writer->co_loaded, response_msg);
+            pcrdr_release_message(response_msg);
+        }
+    }
+    else if (wait_for_pending_chunks(writer)) {
+        send_page_chunk(writer, PCRDR_OPERATION_WRITEMORE, len, true);
     }
     else {
-        // writeMore
-        start = doc_content + len_wrotten;
-        pcutils_string_check_utf8_len(start, DEF_LEN_ONE_WRITE, NULL, &end);
-        if (end > start) {
-            len_to_write = end - start;
-            len_wrotten += len_to_write;
-            data = purc_variant_make_string_static(start, false);
-        }
-        else {
-            PC_WARN("no valid character for rdr\n");
-            goto failed;
-        }
+        writer->failed = true;
+    }
+}
 
-        response_msg = pcintr_rdr_send_request_and_wait_response_ex(
-                conn, target, target_value, PCRDR_OPERATION_WRITEMORE, NULL,
-                PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
-                data_type, data, len_to_write, PCRDR_TIME_LARGE_EXPECTED);
-        purc_variant_unref(data);
-        if (response_msg == NULL) {
-            PC_ERROR("Failed to send request to renderer\n");
-            goto failed;
-        }
+static ssize_t
+write_page_content(void *ctxt, const void *buf, size_t count)
+{
+    struct page_writer *writer = ctxt;
+    const char *p = buf;
+    size_t left = count;
 
-        if (response_msg->retCode != PCRDR_SC_OK) {
-            PC_ERROR("failed to write content to rdr\n");
-            goto failed;
-        }
+    while (left > 0 && !writer->failed) {
+        size_t n = sizeof(writer->buf) - writer->len;
+        if (n > left)
+            n = left;
 
-        if (len_wrotten == len_content) {
-            goto done;
-        }
-        goto writting;
+        memcpy(writer->buf + writer->len, p, n);
+        writer->len += n;
+        p += n;
+        left -= n;
+
+        while (writer->len > DEF_LEN_ONE_WRITE && !writer->failed)
+            send_middle_chunk(writer);
     }
 
-done:
-    return response_msg;
+    return writer->failed ? -1 : (ssize_t)count;
+}
 
-failed:
-    if (response_msg) {
-        pcrdr_release_message(response_msg);
+/* sends the last chunk by writeEnd, or the whole document by load */
+static void
+finish_page_content(struct page_writer *writer)
+{
+    if (writer->failed)
+        return;
+
+    if (writer->nr_chunks == 0) {
+        writer->response = send_page_chunk(writer, PCRDR_OPERATION_LOAD,
+                writer->len, false);
+        if (writer->response && !writer->failed)
+            check_response_for_suppressed(pcinst_current(),
+                    writer->co_loaded, writer->response);
+    }
+    else {
+        writer->response = send_page_chunk(writer, PCRDR_OPERATION_WRITEEND,
+                writer->len, false);
     }
-    return NULL;
 }
 
 bool
@@ -1208,8 +1286,22 @@ pcintr_rdr_page_control_load(struct pcinst *inst, pcintr_stack_t stack)
     else {
         unsigned opt = 0;
 
-        out = purc_rwstream_new_buffer(BUFF_MIN, BUFF_MAX);
+        struct page_writer *writer = calloc(1, sizeof(*writer));
+        if (writer == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto failed;
+        }
+
+        writer->conn = inst->conn_to_rdr;
+        writer->co_loaded = stack->co;
+        writer->target = target;
+        writer->target_value = target_value;
+        writer->elem = elem;
+        writer->data_type = data_type;
+
+        out = purc_rwstream_new_for_dump(writer, write_page_content);
         if (out == NULL) {
+            free(writer);
             goto failed;
         }
 
@@ -1220,49 +1312,21 @@ pcintr_rdr_page_control_load(struct pcinst *inst, pcintr_stack_t stack)
         opt |= PCDOC_SERIALIZE_OPT_WITH_HVML_HANDLE;
 
         if (0 != purc_document_serialize_contents_to_stream(doc, opt, out)) {
-            goto failed;
-        }
-
-        size_t sz_content = 0;
-        size_t sz_buff = 0;
-        char *p = (char*)purc_rwstream_get_mem_buffer_ex(out, &sz_content,
-                &sz_buff, true);
-#if 0
-        FILE *fp = fopen("/tmp/renderer.html", "w");
-        fwrite(p, 1, sz_content, fp);
-        fclose(fp);
-#endif
-        req_data = purc_variant_make_string_reuse_buff(p, sz_content, false);
-        if (req_data == PURC_VARIANT_INVALID) {
-            free(p);
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            goto failed;
+            writer->failed = true;
         }
+        purc_rwstream_destroy(out);
+        out = NULL;
 
-        PC_INFO("rdr page control load, tickcount is %ld to rdr sz_content=%ld\n",
-                pcintr_tick_count(), sz_content);
-        if (sz_content > DEF_LEN_ONE_WRITE) {
-            response_msg = rdr_page_control_load_large_page(inst->conn_to_rdr,
-                    stack->co, target, target_value, elem,
-                    data_type, p, sz_content);
-        }
-        else {
-            response_msg = pcintr_rdr_send_request_and_wait_response(
-                    inst->conn_to_rdr, target, target_value,
-                    PCRDR_OPERATION_LOAD, NULL,
-                    element_type, elem, NULL, data_type, req_data, 0);
-            if (response_msg) {
-                check_response_for_suppressed(inst, stack->co, response_msg);
-            }
-        }
-        PC_INFO("rdr page control load, tickcount is %ld to rdr sz_content=%ld\n",
-                pcintr_tick_count(), sz_content);
-        purc_variant_unref(req_data);
+        finish_page_content(writer);
+        PC_INFO("rdr page control load, tickcount is %ld to rdr chunks=%u\n",
+                pcintr_tick_count(), (unsigned)writer->nr_chunks);
 
-        if (out) {
-            purc_rwstream_destroy(out);
-            out = NULL;
+        if (writer->failed && writer->response) {
+            pcrdr_release_message(writer->response);
+            writer->response = NULL;
         }
+        response_msg = writer->response;
+        free(writer);
     }
 
     if (response_msg == NULL) {
@@ -1283,6 +1347,11 @@ pcintr_rdr_page_control_load(struct pcinst *inst, pcintr_stack_t stack)
         goto failed;
     }
 
+    /* the renderer has got all; restart the log of the operations */
+    if (pcintr_mutation_log_reset(stack->co)) {
+        purc_clr_error();
+    }
+
     PC_INFO("rdr page control load, tickcount is %ld success\n", pcintr_tick_count());
     return true;
 
@@ -1554,6 +1623,13 @@ Note that for different operation, the reference entity varies:
 
 TODO: Currently, we pass element itself.  */
 
+        /* NOTE: the renderer thread refers to the element directly,
+           so we must wait for the response before changing the document. */
+        if (request_id && strcmp(request_id,
+                    PCINTR_RDR_PIPELINED_REQUEST_ID) == 0) {
+            request_id = NULL;
+        }
+
         purc_variant_t req_data = PURC_VARIANT_INVALID;
         if (ref_elem) {
             req_data = purc_variant_make_native(ref_elem, NULL);
@@ -1634,6 +1710,162 @@ out:
     return ret;
 }
 
+static bool
+set_batch_op_string(purc_variant_t op, const char *key,
+        const char *str, size_t len)
+{
+    purc_variant_t v = purc_variant_make_string_ex(str, len, false);
+    if (v == PURC_VARIANT_INVALID)
+        return false;
+
+    bool ok = purc_variant_object_set_by_static_ckey(op, key, v);
+    purc_variant_unref(v);
+    return ok;
+}
+
+/* Makes an item of a `batch` request for the operation. */
+static purc_variant_t
+make_dom_op(int op, pcdoc_element_t element, const char *property,
+        pcrdr_msg_data_type data_type, const char *data, size_t len)
+{
+    const char *operation = rdr_ops[op];
+    if (property && op == PCRDR_K_OPERATION_DISPLACE) {
+        operation = PCRDR_OPERATION_UPDATE;
+    }
+
+    char elem[LEN_BUFF_LONGLONGINT];
+    int n = snprintf(elem, sizeof(elem),
+            "%llx", (unsigned long long int)(uint64_t)element);
+
+    purc_variant_t item = purc_variant_make_object_0();
+    if (item == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    const char *type_name = pcrdr_data_type_name(data_type);
+    bool ok = set_batch_op_string(item, "operation",
+                operation, strlen(operation)) &&
+            set_batch_op_string(item, "elementType", "handle", 6) &&
+            set_batch_op_string(item, "element", elem, (size_t)n) &&
+            (property == NULL || set_batch_op_string(item, "property",
+                property, strlen(property))) &&
+            set_batch_op_string(item, "dataType",
+                type_name, strlen(type_name)) &&
+            set_batch_op_string(item, "data", data, len);
+    if (!ok) {
+        purc_variant_unref(item);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return item;
+}
+
+/*
+ * Appends an operation to the DOM batch of the coroutine; returns false
+ * if the operation can not be coalesced and should be sent at once.
+ */
+static bool
+append_to_dom_batch(pcintr_coroutine_t co, purc_variant_t item)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst->conn_to_rdr == NULL || inst->rdr_caps == NULL ||
+            inst->rdr_caps->dom_batch <= 0 ||
+            pcrdr_conn_type(inst->conn_to_rdr) == CT_MOVE_BUFFER) {
+        return false;
+    }
+
+    if (co->target_page_handle == 0 || co->target_dom_handle == 0 ||
+            co->stack.doc->ldc == 0) {
+        return false;
+    }
+
+    if (co->rdr_batch == PURC_VARIANT_INVALID) {
+        co->rdr_batch = purc_variant_make_array_0();
+        if (co->rdr_batch == PURC_VARIANT_INVALID)
+            return false;
+    }
+
+    bool ok = purc_variant_array_append(co->rdr_batch, item);
+    if (!ok) {
+        /* NOTE: send the queued ones before the failed one. */
+        pcintr_rdr_flush_dom_batch(co);
+        return false;
+    }
+
+    if (purc_variant_array_get_size(co->rdr_batch) >=
+            (ssize_t)inst->rdr_caps->dom_batch) {
+        pcintr_rdr_flush_dom_batch(co);
+    }
+    return true;
+}
+
+void
+pcintr_rdr_flush_dom_batch(pcintr_coroutine_t co)
+{
+    purc_variant_t batch = co->rdr_batch;
+    if (batch == PURC_VARIANT_INVALID)
+        return;
+
+    /* detach the batch first, for sending a request flushes the batch */
+    co->rdr_batch = PURC_VARIANT_INVALID;
+
+    struct pcinst *inst = pcinst_current();
+    if (inst->conn_to_rdr && co->target_dom_handle &&
+            purc_variant_array_get_size(batch) > 0) {
+        pcintr_rdr_send_request_and_wait_response(inst->conn_to_rdr,
+                PCRDR_MSG_TARGET_DOM, co->target_dom_handle,
+                PCRDR_OPERATION_BATCH, PCINTR_RDR_NORETURN_REQUEST_ID,
+                PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+                PCRDR_MSG_DATA_TYPE_JSON, batch, 0);
+    }
+    purc_variant_unref(batch);
+}
+
+bool
+pcintr_rdr_page_control_resync(struct pcinst *inst, pcintr_stack_t stack,
+        uint64_t last_seq)
+{
+    pcintr_coroutine_t co = stack->co;
+    if (inst->conn_to_rdr == NULL) {
+        purc_set_error(PCRDR_ERROR_IO);
+        return false;
+    }
+
+    purc_variant_t ops = PURC_VARIANT_INVALID;
+    if (pcintr_mutation_log_restore_page(co)) {
+        ops = pcintr_mutation_log_since(co, last_seq);
+    }
+
+    if (ops == PURC_VARIANT_INVALID) {
+        PC_INFO("rdr page control resync from %llu: fall back to load\n",
+                (unsigned long long)last_seq);
+        return co->target_page_handle &&
+            pcintr_rdr_page_control_load(inst, stack);
+    }
+
+    bool ok = true;
+    if (purc_variant_array_get_size(ops) > 0) {
+        pcrdr_msg *response_msg;
+        response_msg = pcintr_rdr_send_request_and_wait_response(
+                inst->conn_to_rdr,
+                PCRDR_MSG_TARGET_DOM, co->target_dom_handle,
+                PCRDR_OPERATION_BATCH, NULL,
+                PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+                PCRDR_MSG_DATA_TYPE_JSON, ops, 0);
+
+        ok = response_msg && response_msg->retCode == PCRDR_SC_OK;
+        if (response_msg)
+            pcrdr_release_message(response_msg);
+    }
+    purc_variant_unref(ops);
+
+    if (!ok) {
+        /* the renderer does not keep the DOM or does not support batch */
+        return pcintr_rdr_page_control_load(inst, stack);
+    }
+
+    return true;
+}
+
 bool
 pcintr_rdr_send_dom_req_simple_raw(pcintr_stack_t stack,
         int op, const char *request_id,
@@ -1649,6 +1881,28 @@ pcintr_rdr_send_dom_req_simple_raw(pcintr_stack_t stack,
         data = " ";
         len = 1;
     }
+
+    if (stack) {
+        purc_variant_t item = make_dom_op(op, element, property,
+                data_type, data, len);
+        if (item) {
+            /* NOTE: logged even if the page is not connected */
+            pcintr_mutation_log_append(stack->co, item);
+            bool batched = append_to_dom_batch(stack->co, item);
+            purc_variant_unref(item);
+            if (batched)
+                return true;
+        }
+        else {
+            purc_clr_error();
+        }
+    }
+
+    /* NOTE: the callers do not need the result, so do not wait for it. */
+    if (request_id == NULL) {
+        request_id = PCINTR_RDR_PIPELINED_REQUEST_ID;
+    }
+
     pcrdr_msg *response_msg = pcintr_rdr_send_dom_req_raw(stack, op,
             request_id, PCRDR_MSG_ELEMENT_TYPE_HANDLE, NULL,
             element, ref_elem, property, data_type, data, len);
@@ -28,16 +28,19 @@
 
 #include "purc-runloop.h"
 #include "private/errors.h"
+#include "private/evloop.h"
 #include "private/interpreter.h"
 #include "private/instance.h"
 #include "private/runners.h"
 #include "private/sorted-array.h"
+#include "private/uring.h"
 #include "internal.h"
 
 #include <wtf/Threading.h>
 #include <wtf/RunLoop.h>
 #include <wtf/threads/BinarySemaphore.h>
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -67,10 +70,27 @@ void purc_runloop_wakeup(purc_runloop_t runloop)
     }
 }
 
+/* Returns the event loop of the run loop if it is the one of the current
+   instance; the timers and the monitors are managed in its thread only. */
+static struct pcintr_evloop *own_evloop(purc_runloop_t runloop)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->evloop == NULL)
+        return NULL;
+
+    if (runloop && runloop != purc_runloop_get_current())
+        return NULL;
+    return inst->evloop;
+}
+
 void purc_runloop_dispatch(purc_runloop_t runloop, purc_runloop_func func,
         void* ctxt)
 {
     if (runloop) {
+        struct pcintr_evloop *evloop = pcintr_evloop_find(runloop);
+        if (evloop && pcintr_evloop_dispatch(evloop, func, ctxt) == 0)
+            return;
+
         ((RunLoop*)runloop)->dispatch([func, ctxt]() {
             func(ctxt);
         });
@@ -81,6 +101,11 @@ void purc_runloop_dispatch_after(purc_runloop_t runloop, long time_ms,
         purc_runloop_func func, void *ctxt)
 {
     if (runloop) {
+        struct pcintr_evloop *evloop = own_evloop(runloop);
+        if (evloop && pcintr_evloop_dispatch_after(evloop, time_ms,
+                    func, ctxt) == 0)
+            return;
+
         ((RunLoop*)runloop)->dispatchAfter(
             PurCWTF::Seconds::fromMilliseconds(time_ms),
             [func, ctxt]() {
@@ -158,6 +183,15 @@ uintptr_t purc_runloop_add_fd_monitor(purc_runloop_t runloop, int fd,
     PC_ASSERT(co);
     PC_ASSERT(pcintr_get_runloop() == runloop);
 
+    struct pcintr_evloop *evloop = own_evloop(runloop);
+    if (evloop) {
+        uintptr_t handle = pcintr_evloop_add_fd_monitor(evloop, fd, event,
+                callback, ctxt);
+        /* fall back to the run loop for a file which epoll can not monitor */
+        if (handle)
+            return handle;
+    }
+
     RunLoop *runLoop = (RunLoop*)runloop;
 
     return runLoop->addFdMonitor(fd, to_gio_condition(event),
@@ -172,6 +206,13 @@ uintptr_t purc_runloop_add_fd_monitor(purc_runloop_t runloop, int fd,
 
 void purc_runloop_remove_fd_monitor(purc_runloop_t runloop, uintptr_t handle)
 {
+    if (pcintr_evloop_is_handle(handle)) {
+        struct pcintr_evloop *evloop = own_evloop(runloop);
+        PC_ASSERT(evloop);
+        pcintr_evloop_remove_fd_monitor(evloop, handle);
+        return;
+    }
+
     if (!runloop) {
         runloop = purc_runloop_get_current();
     }
@@ -181,6 +222,11 @@ void purc_runloop_remove_fd_monitor(purc_runloop_t runloop, uintptr_t handle)
 void purc_runloop_set_timeout(purc_runloop_t runloop,
         purc_runloop_timeout_callback callback, void *ctxt, uint32_t interval)
 {
+    struct pcintr_evloop *evloop = own_evloop(runloop);
+    if (evloop && pcintr_evloop_set_timeout(evloop, callback, ctxt,
+                interval) == 0)
+        return;
+
     if (!runloop) {
         runloop = purc_runloop_get_current();
     }
@@ -195,12 +241,30 @@ pcrun_create_inst_thread(const char *app_name, const char *runner_name,
     purc_atom_t atom = 0;
     BinarySemaphore semaphore;
 
+    /* named after the runner for the tools like top(1) and gdb(1); it is
+       truncated to 15 characters on Linux */
+    char th_name[PURC_LEN_RUNNER_NAME + 8];
+    snprintf(th_name, sizeof(th_name), "hvml:%s", runner_name);
+
+    const char *cpus = extra_info ? extra_info->cpu_affinity : NULL;
+    const char *node = extra_info ? extra_info->numa_node : NULL;
+
     RefPtr<Thread> inst_th =
-        Thread::create("hvml-instance", [&] {
+        Thread::create(th_name, [&] {
+                /* placed before initializing the instance, so that its
+                   memory is allocated on the NUMA node preferred */
+                int placed = pcrun_place_current_thread(cpus, node);
+
                 int ret = purc_init_ex(PURC_MODULE_HVML,
                         app_name, runner_name, extra_info);
+                if (ret == PURC_ERROR_OK && placed) {
+                    purc_log_warn("Failed to place runner %s: CPUs %s, "
+                            "NUMA node %s\n", runner_name,
+                            cpus ? cpus : "any", node ? node : "any");
+                }
 
                 if (ret != PURC_ERROR_OK) {
+                    pcrun_inst_pool_join(runner_name, 0);
                     semaphore.signal();
                 }
                 else {
@@ -222,9 +286,15 @@ pcrun_create_inst_thread(const char *app_name, const char *runner_name,
                         cond_handler(PURC_COND_STARTED,
                                 (void *)(uintptr_t)atom, extra_info);
                     }
+                    pcrun_inst_pool_join(runner_name, my_atom);
                     semaphore.signal();
 
-                    purc_run(my_handler);
+                    /* an instance of the instance pool runs again
+                       when it is recycled; see runners.c */
+                    do {
+                        purc_run(my_handler);
+                    } while (pcrun_inst_pool_recycle(my_atom));
+                    pcrun_inst_pool_leave(my_atom);
 
                     pcrun_notify_instmgr(PCRUN_EVENT_inst_stopped, my_atom);
                     if ((my_handler = inst->intr_heap->cond_handler)) {
@@ -322,22 +392,58 @@ static int _init_once(void)
     return 0;
 }
 
+/* The run loop only monitors the epoll file descriptor of the event loop,
+   which handles the monitored file descriptors, the timers, and the
+   functions dispatched. */
+static void init_evloop(struct pcinst* curr_inst)
+{
+    RunLoop& runloop = RunLoop::current();
+    struct pcintr_evloop *evloop = pcintr_evloop_create(&runloop);
+    if (evloop == NULL)
+        return;
+
+    curr_inst->evloop_monitor = runloop.addFdMonitor(pcintr_evloop_fd(evloop),
+            G_IO_IN, [evloop] (gint fd, GIOCondition condition) -> gboolean {
+            UNUSED_PARAM(fd);
+            UNUSED_PARAM(condition);
+            pcintr_evloop_handle_events(evloop);
+            return true;
+        });
+    curr_inst->evloop = evloop;
+}
+
+static void cleanup_evloop(struct pcinst* curr_inst)
+{
+    if (curr_inst->evloop == NULL)
+        return;
+
+    RunLoop::current().removeFdMonitor(curr_inst->evloop_monitor);
+    pcintr_evloop_destroy(curr_inst->evloop);
+    curr_inst->evloop = NULL;
+    curr_inst->evloop_monitor = 0;
+}
+
 static int _init_instance(struct pcinst* curr_inst,
         const purc_instance_extra_info* extra_info)
 {
-    UNUSED_PARAM(curr_inst);
     UNUSED_PARAM(extra_info);
 
     int r;
     r = pthread_once(&_main_once_control, _runloop_init_main);
     PC_ASSERT(r == 0);
 
+    init_evloop(curr_inst);
     return 0;
 }
 
 static void _cleanup_instance(struct pcinst* curr_inst)
 {
-    UNUSED_PARAM(curr_inst);
+    if (curr_inst->uring) {
+        pcintr_uring_destroy(curr_inst->uring);
+        curr_inst->uring = NULL;
+    }
+
+    cleanup_evloop(curr_inst);
 }
 
 struct pcmodule _module_runloop = {
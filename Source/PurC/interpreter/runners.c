@@ -28,6 +28,7 @@
 
 #include "purc.h"
 #include "private/runners.h"
+#include "private/channel.h"
 #include "private/instance.h"
 #include "private/sorted-array.h"
 #include "private/ports.h"
@@ -35,6 +36,10 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <strings.h>
+#include <unistd.h>
 
 static void create_coroutine(const pcrdr_msg *msg, pcrdr_msg *response)
 {
@@ -193,10 +198,12 @@ static void shutdown_instance(purc_atom_t requester,
         if (inst->intr_heap->cond_handler(PURC_COND_SHUTDOWN_ASKED,
                 (void*)msg, NULL) == 0) {
             inst->intr_heap->keep_alive = 0;
+            inst->intr_heap->shutdown_asked = 1;
         }
     }
     else {
         inst->intr_heap->keep_alive = 0;
+        inst->intr_heap->shutdown_asked = 1;
     }
 
     if (inst->intr_heap->keep_alive == 0 && list_empty(&inst->intr_heap->crtns)
@@ -307,6 +314,25 @@ void pcrun_request_handler(pcrdr_conn* conn, const pcrdr_msg *msg)
         else if (strcmp(op, PCRDR_OP2INTR_RELOADPAGE) == 0) {
             pcintr_reload_crtn_doc(inst, NULL, msg->targetValue);
         }
+        else if (strcmp(op, PCRDR_OP2INTR_RESYNCPAGE) == 0) {
+            uint64_t last_seq = 0, seq = 0;
+            int ret_code = PCRDR_SC_OK;
+            if (msg->data == PURC_VARIANT_INVALID ||
+                    !purc_variant_cast_to_ulongint(msg->data, &last_seq, true))
+                ret_code = PCRDR_SC_BAD_REQUEST;
+            else if (!pcintr_resync_crtn_doc(inst, msg->targetValue,
+                        last_seq, &seq))
+                ret_code = PCRDR_SC_INTERNAL_SERVER_ERROR;
+
+            response->type = PCRDR_MSG_TYPE_RESPONSE;
+            response->requestId = purc_variant_ref(msg->requestId);
+            response->sourceURI = purc_variant_make_string(
+                    purc_get_endpoint(NULL), false);
+            response->retCode = ret_code;
+            response->resultValue = seq;
+            response->dataType = PCRDR_MSG_DATA_TYPE_VOID;
+            response->data = PURC_VARIANT_INVALID;
+        }
         else if (strcmp(op, PCRDR_OPERATION_CALLMETHOD) == 0) {
             purc_log_warn("Not implemented operation: %s\n", op);
         }
@@ -379,6 +405,94 @@ pcrun_notify_instmgr(const char* event_name, purc_atom_t inst_crtn_id)
     pcrdr_release_message(event);
 }
 
+/*
+ * The runner pool: the detached child coroutines are spread over the worker
+ * runners named `_pool<slot>`, which are created on demand like the runners
+ * specified by `within`. The load of a worker is the number of coroutines
+ * living in it, maintained by the worker itself.
+ *
+ * NOTE: a coroutine can not move to another worker once it is created,
+ * because its variants belong to the heap of the worker; so the workers
+ * are balanced when a coroutine is placed, instead of stealing the running
+ * ones.
+ */
+static unsigned int pool_nr_workers;
+static atomic_uint  pool_loads[PCRUN_POOL_MAX_WORKERS];
+static atomic_uint  pool_cursor;
+
+int pcrun_pool_init_once(void)
+{
+    const char *env = getenv(PURC_ENVV_RUNNER_POOL);
+    if (env == NULL)
+        return 0;
+
+    long n;
+    if (strcasecmp(env, "auto") == 0) {
+        n = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    else {
+        n = strtol(env, NULL, 10);
+    }
+
+    if (n <= 0)
+        pool_nr_workers = 0;
+    else if (n > PCRUN_POOL_MAX_WORKERS)
+        pool_nr_workers = PCRUN_POOL_MAX_WORKERS;
+    else
+        pool_nr_workers = (unsigned int)n;
+
+    return 0;
+}
+
+int pcrun_pool_pick_worker(char *runner_name)
+{
+    if (pool_nr_workers == 0)
+        return -1;
+
+    /* start from a rotating slot to spread the ties
+       before the new coroutines are counted by the workers */
+    unsigned int start = atomic_fetch_add(&pool_cursor, 1) % pool_nr_workers;
+    unsigned int slot = start;
+    unsigned int min_load = atomic_load(&pool_loads[start]);
+    for (unsigned int i = 1; i < pool_nr_workers && min_load > 0; i++) {
+        unsigned int j = (start + i) % pool_nr_workers;
+        unsigned int load = atomic_load(&pool_loads[j]);
+        if (load < min_load) {
+            min_load = load;
+            slot = j;
+        }
+    }
+
+    snprintf(runner_name, PURC_LEN_RUNNER_NAME + 1,
+            PCRUN_POOL_RUNNER_PREFIX "%u", slot);
+    return (int)slot;
+}
+
+int pcrun_pool_slot_of_runner(const char *runner_name)
+{
+    size_t len = sizeof(PCRUN_POOL_RUNNER_PREFIX) - 1;
+    if (runner_name == NULL ||
+            strncmp(runner_name, PCRUN_POOL_RUNNER_PREFIX, len) ||
+            !purc_isdigit(runner_name[len]))
+        return -1;
+
+    char *end;
+    unsigned long slot = strtoul(runner_name + len, &end, 10);
+    if (*end || slot >= pool_nr_workers)
+        return -1;
+
+    return (int)slot;
+}
+
+void pcrun_pool_update_load(int slot, bool increase)
+{
+    assert(slot >= 0 && slot < PCRUN_POOL_MAX_WORKERS);
+    if (increase)
+        atomic_fetch_add(&pool_loads[slot], 1);
+    else
+        atomic_fetch_sub(&pool_loads[slot], 1);
+}
+
 static void create_instance(struct instmgr_info *mgr_info,
         const pcrdr_msg *request, pcrdr_msg *response)
 {
@@ -474,6 +588,38 @@ static void create_instance(struct instmgr_info *mgr_info,
         info.workspace_layout = purc_variant_get_string_const(tmp);
     }
 
+    tmp = purc_variant_object_get_by_ckey(request->data, "cpuAffinity");
+    if (tmp) {
+        info.cpu_affinity = purc_variant_get_string_const(tmp);
+    }
+
+    tmp = purc_variant_object_get_by_ckey(request->data, "numaNode");
+    if (tmp) {
+        info.numa_node = purc_variant_get_string_const(tmp);
+    }
+
+    /* fall back to the placement of the runner in the app manifest */
+    char numa_node[16];
+    purc_variant_t runner = PURC_VARIANT_INVALID;
+    if (info.cpu_affinity == NULL && info.numa_node == NULL &&
+            (runner = pcinst_get_runner_manifest(app_name, runner_name))) {
+        tmp = purc_variant_object_get_by_ckey(runner, "cpuAffinity");
+        if (tmp) {
+            info.cpu_affinity = purc_variant_get_string_const(tmp);
+        }
+
+        tmp = purc_variant_object_get_by_ckey(runner, "numaNode");
+        uint64_t u64;
+        if (tmp && purc_variant_is_string(tmp)) {
+            info.numa_node = purc_variant_get_string_const(tmp);
+        }
+        else if (tmp && purc_variant_cast_to_ulongint(tmp, &u64, false)) {
+            snprintf(numa_node, sizeof(numa_node), "%u", (unsigned)u64);
+            info.numa_node = numa_node;
+        }
+        purc_clr_error();
+    }
+
     void *th = NULL;
     atom = pcrun_create_inst_thread(app_name, runner_name, cond_handler,
             &info, &th);
@@ -482,6 +628,7 @@ static void create_instance(struct instmgr_info *mgr_info,
                 (void *)(uintptr_t)atom, th, NULL);
         mgr_info->nr_insts++;
     }
+    PURC_VARIANT_SAFE_CLEAR(runner);
 
 done:
     response->type = PCRDR_MSG_TYPE_RESPONSE;
@@ -773,51 +920,33 @@ void pcrun_instmgr_handle_message(void *ctxt)
 }
 
 
-purc_atom_t
-purc_inst_create_or_get(const char *app_name, const char *runner_name,
+/* makes the `createInstance` request to the instance manager */
+static pcrdr_msg *
+make_create_instance_request(purc_atom_t instmgr,
+        const char *app_name, const char *runner_name,
         purc_cond_handler cond_handler,
-        const purc_instance_extra_info* extra_info)
+        const purc_instance_extra_info* extra_info, bool wait)
 {
-    char endpoint_name[PURC_LEN_ENDPOINT_NAME + 1];
-
-    if (!purc_is_valid_app_name(app_name) ||
-            !purc_is_valid_runner_name(runner_name)) {
-        purc_set_error(PURC_ERROR_INVALID_VALUE);
-        return 0;
-    }
-
-    purc_assemble_endpoint_name_ex(PCRDR_LOCALHOST,
-            app_name, runner_name,
-            endpoint_name, sizeof(endpoint_name) - 1);
-    purc_atom_t atom = purc_atom_try_string_ex(PURC_ATOM_BUCKET_DEF,
-            endpoint_name);
-    if (atom != 0) {
-        /* TODO: change the condition handler for an exisiting runner? */
-        return atom;
-    }
-
-    atom = purc_get_instmgr_rid();
-    if (atom == 0) {
-        purc_set_error(PURC_ERROR_NO_INSTANCE);
-        return 0;
-    }
+    /* here we make static string variants for a sync request */
+    purc_variant_t (*make_string)(const char *, bool) =
+        wait ? purc_variant_make_string_static : purc_variant_make_string;
 
     pcrdr_msg *request;
     request = pcrdr_make_request_message(
-            PCRDR_MSG_TARGET_INSTANCE, atom,
-            PCRUN_OPERATION_createInstance, NULL, purc_get_endpoint(NULL),
+            PCRDR_MSG_TARGET_INSTANCE, instmgr,
+            PCRUN_OPERATION_createInstance,
+            wait ? NULL : PCRDR_REQUESTID_NORETURN, purc_get_endpoint(NULL),
             PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
             PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
 
     purc_variant_t data, tmp;
     data = purc_variant_make_object_0();
 
-    /* here we make static string variant because this is a sync request */
-    tmp = purc_variant_make_string_static(app_name, false);
+    tmp = make_string(app_name, false);
     purc_variant_object_set_by_static_ckey(data, "appName", tmp);
     purc_variant_unref(tmp);
 
-    tmp = purc_variant_make_string_static(runner_name, false);
+    tmp = make_string(runner_name, false);
     purc_variant_object_set_by_static_ckey(data, "runnerName", tmp);
     purc_variant_unref(tmp);
 
@@ -841,52 +970,92 @@ purc_inst_create_or_get(const char *app_name, const char *runner_name,
         purc_variant_unref(tmp);
 
         if (extra_info->renderer_uri) {
-            tmp = purc_variant_make_string_static(extra_info->renderer_uri,
-                    false);
+            tmp = make_string(extra_info->renderer_uri, false);
             purc_variant_object_set_by_static_ckey(data, "rendererURI", tmp);
             purc_variant_unref(tmp);
         }
 
         if (extra_info->ssl_cert) {
-            tmp = purc_variant_make_string_static(extra_info->ssl_cert,
-                    false);
+            tmp = make_string(extra_info->ssl_cert, false);
             purc_variant_object_set_by_static_ckey(data, "sslCert", tmp);
             purc_variant_unref(tmp);
         }
 
         if (extra_info->ssl_key) {
-            tmp = purc_variant_make_string_static(extra_info->ssl_key,
-                    false);
+            tmp = make_string(extra_info->ssl_key, false);
             purc_variant_object_set_by_static_ckey(data, "sslKey", tmp);
             purc_variant_unref(tmp);
         }
 
         if (extra_info->workspace_name) {
-            tmp = purc_variant_make_string_static(extra_info->workspace_name,
-                    false);
+            tmp = make_string(extra_info->workspace_name, false);
             purc_variant_object_set_by_static_ckey(data, "workspaceName", tmp);
             purc_variant_unref(tmp);
         }
 
         if (extra_info->workspace_title) {
-            tmp = purc_variant_make_string_static(extra_info->workspace_title,
-                    false);
+            tmp = make_string(extra_info->workspace_title, false);
             purc_variant_object_set_by_static_ckey(data, "workspaceTitle", tmp);
             purc_variant_unref(tmp);
         }
 
         if (extra_info->workspace_layout) {
-            tmp = purc_variant_make_string_static(extra_info->workspace_layout,
-                    false);
+            tmp = make_string(extra_info->workspace_layout, false);
             purc_variant_object_set_by_static_ckey(data, "workspaceLayout", tmp);
             purc_variant_unref(tmp);
         }
-    }
 
-    purc_variant_t request_id = purc_variant_ref(request->requestId);
+        if (extra_info->cpu_affinity) {
+            tmp = make_string(extra_info->cpu_affinity, false);
+            purc_variant_object_set_by_static_ckey(data, "cpuAffinity", tmp);
+            purc_variant_unref(tmp);
+        }
+
+        if (extra_info->numa_node) {
+            tmp = make_string(extra_info->numa_node, false);
+            purc_variant_object_set_by_static_ckey(data, "numaNode", tmp);
+            purc_variant_unref(tmp);
+        }
+    }
 
     request->dataType = PCRDR_MSG_DATA_TYPE_JSON;
     request->data = data;
+    return request;
+}
+
+purc_atom_t
+purc_inst_create_or_get(const char *app_name, const char *runner_name,
+        purc_cond_handler cond_handler,
+        const purc_instance_extra_info* extra_info)
+{
+    char endpoint_name[PURC_LEN_ENDPOINT_NAME + 1];
+
+    if (!purc_is_valid_app_name(app_name) ||
+            !purc_is_valid_runner_name(runner_name)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return 0;
+    }
+
+    purc_assemble_endpoint_name_ex(PCRDR_LOCALHOST,
+            app_name, runner_name,
+            endpoint_name, sizeof(endpoint_name) - 1);
+    purc_atom_t atom = purc_atom_try_string_ex(PURC_ATOM_BUCKET_DEF,
+            endpoint_name);
+    if (atom != 0) {
+        /* TODO: change the condition handler for an exisiting runner? */
+        return atom;
+    }
+
+    atom = purc_get_instmgr_rid();
+    if (atom == 0) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return 0;
+    }
+
+    pcrdr_msg *request = make_create_instance_request(atom,
+            app_name, runner_name, cond_handler, extra_info, true);
+
+    purc_variant_t request_id = purc_variant_ref(request->requestId);
     size_t n = purc_inst_move_message(atom, request);
     pcrdr_release_message(request);
     if (n == 0) {
@@ -920,6 +1089,253 @@ purc_inst_create_or_get(const char *app_name, const char *runner_name,
     return atom;
 }
 
+/*
+ * The instance pool: the idle instances of the app, named `_inst<seq>`,
+ * which are made in advance by purc_inst_pool_prepare() and taken by
+ * purc_inst_pool_take() to run a vDOM. When all coroutines of a taken
+ * instance exited, the instance drops its runner-level variables and
+ * becomes idle again, instead of being cleaned up, unless there are
+ * already `max_idle` idle ones.
+ *
+ * NOTE: the idle instances are in LIFO order, so the most recently used
+ * one, whose memory is likely to be still in the caches, is taken first.
+ */
+static pthread_mutex_t  inst_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static char             inst_pool_app_name[PURC_LEN_APP_NAME + 1];
+static purc_cond_handler inst_pool_cond_handler;
+static const purc_instance_extra_info *inst_pool_extra_info;
+static size_t           inst_pool_min_idle;
+static size_t           inst_pool_max_idle;
+static size_t           inst_pool_nr_pending;   /* requested but not joined */
+static size_t           inst_pool_nr_idle;
+static purc_atom_t      inst_pool_idle[PCRUN_INST_POOL_MAX_IDLE];
+static atomic_uint      inst_pool_seq;
+
+static bool is_inst_pool_runner(const char *runner_name)
+{
+    return runner_name && strncmp(runner_name, PCRUN_INST_POOL_RUNNER_PREFIX,
+            sizeof(PCRUN_INST_POOL_RUNNER_PREFIX) - 1) == 0;
+}
+
+/* asks the instance manager to make a new instance for the pool, which is
+   counted in inst_pool_nr_pending by the caller; waits for the instance
+   if `wait` is true */
+static bool make_pool_instance(bool wait)
+{
+    char app_name[PURC_LEN_APP_NAME + 1];
+    char runner_name[PURC_LEN_RUNNER_NAME + 1];
+    purc_cond_handler cond_handler;
+    const purc_instance_extra_info *extra_info;
+
+    pthread_mutex_lock(&inst_pool_lock);
+    strcpy(app_name, inst_pool_app_name);
+    cond_handler = inst_pool_cond_handler;
+    extra_info = inst_pool_extra_info;
+    pthread_mutex_unlock(&inst_pool_lock);
+
+    snprintf(runner_name, sizeof(runner_name),
+            PCRUN_INST_POOL_RUNNER_PREFIX "%u",
+            atomic_fetch_add(&inst_pool_seq, 1));
+
+    bool ret;
+    if (wait) {
+        ret = purc_inst_create_or_get(app_name, runner_name,
+                cond_handler, extra_info) != 0;
+    }
+    else {
+        purc_atom_t instmgr = purc_get_instmgr_rid();
+        pcrdr_msg *request = make_create_instance_request(instmgr,
+                app_name, runner_name, cond_handler, extra_info, false);
+        ret = purc_inst_move_message(instmgr, request) > 0;
+        pcrdr_release_message(request);
+    }
+
+    /* give up the pending count for the instance */
+    if (!ret) {
+        pcrun_inst_pool_join(runner_name, 0);
+    }
+
+    return ret;
+}
+
+void pcrun_inst_pool_join(const char *runner_name, purc_atom_t atom)
+{
+    if (!is_inst_pool_runner(runner_name))
+        return;
+
+    pthread_mutex_lock(&inst_pool_lock);
+    if (inst_pool_nr_pending > 0)
+        inst_pool_nr_pending--;
+    /* NOTE: a new instance always joins; it may be made for a taker */
+    if (atom && inst_pool_nr_idle < PCRUN_INST_POOL_MAX_IDLE)
+        inst_pool_idle[inst_pool_nr_idle++] = atom;
+    pthread_mutex_unlock(&inst_pool_lock);
+}
+
+bool pcrun_inst_pool_recycle(purc_atom_t atom)
+{
+    struct pcinst *inst = pcinst_current();
+    if (!is_inst_pool_runner(inst->runner_name) ||
+            inst->intr_heap->shutdown_asked)
+        return false;
+
+    pthread_mutex_lock(&inst_pool_lock);
+    bool full = inst_pool_nr_idle >= inst_pool_max_idle;
+    pthread_mutex_unlock(&inst_pool_lock);
+    if (full)
+        return false;
+
+    /* the channels opened by `$RUNNER.chan()` and their queued values,
+       as well as the statistics of the last session, must not be seen
+       by the next one */
+    pcchan_close_all();
+    pcutils_map_clear(inst->intr_heap->token_crtn_map);
+    memset(inst->intr_heap->sched_stats, 0,
+            sizeof(inst->intr_heap->sched_stats));
+    inst->intr_heap->sched_rounds = 0;
+
+    if (!pcintr_reset_runner_variables()) {
+        purc_log_error("Failed to reset the instance: %s\n",
+                purc_get_error_message(purc_get_last_error()));
+        return false;
+    }
+
+    bool ret = false;
+    pthread_mutex_lock(&inst_pool_lock);
+    if (inst_pool_nr_idle < inst_pool_max_idle) {
+        inst_pool_idle[inst_pool_nr_idle++] = atom;
+        ret = true;
+    }
+    pthread_mutex_unlock(&inst_pool_lock);
+
+    return ret;
+}
+
+void pcrun_inst_pool_leave(purc_atom_t atom)
+{
+    pthread_mutex_lock(&inst_pool_lock);
+    for (size_t i = 0; i < inst_pool_nr_idle; i++) {
+        if (inst_pool_idle[i] == atom) {
+            memmove(inst_pool_idle + i, inst_pool_idle + i + 1,
+                    sizeof(inst_pool_idle[0]) * (inst_pool_nr_idle - i - 1));
+            inst_pool_nr_idle--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&inst_pool_lock);
+}
+
+int
+purc_inst_pool_prepare(size_t min_idle, size_t max_idle,
+        purc_cond_handler cond_handler,
+        const purc_instance_extra_info *extra_info)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->intr_heap == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return -1;
+    }
+
+    if (max_idle > PCRUN_INST_POOL_MAX_IDLE)
+        max_idle = PCRUN_INST_POOL_MAX_IDLE;
+    if (min_idle > max_idle)
+        min_idle = max_idle;
+
+    purc_atom_t surplus[PCRUN_INST_POOL_MAX_IDLE];
+    size_t nr_surplus = 0, nr_to_make = 0;
+
+    pthread_mutex_lock(&inst_pool_lock);
+    strcpy(inst_pool_app_name, inst->app_name);
+    inst_pool_cond_handler = cond_handler;
+    inst_pool_extra_info = extra_info;
+    inst_pool_min_idle = min_idle;
+    inst_pool_max_idle = max_idle;
+
+    while (inst_pool_nr_idle > max_idle) {
+        surplus[nr_surplus++] = inst_pool_idle[--inst_pool_nr_idle];
+    }
+
+    if (min_idle > inst_pool_nr_idle + inst_pool_nr_pending) {
+        nr_to_make = min_idle - inst_pool_nr_idle - inst_pool_nr_pending;
+        inst_pool_nr_pending += nr_to_make;
+    }
+    pthread_mutex_unlock(&inst_pool_lock);
+
+    for (size_t i = 0; i < nr_surplus; i++) {
+        purc_inst_ask_to_shutdown(surplus[i]);
+    }
+
+    int ret = 0;
+    for (size_t i = 0; i < nr_to_make; i++) {
+        if (!make_pool_instance(true)) {
+            pthread_mutex_lock(&inst_pool_lock);
+            inst_pool_nr_pending -= nr_to_make - i - 1;
+            pthread_mutex_unlock(&inst_pool_lock);
+            ret = -1;
+            break;
+        }
+    }
+
+    if (ret == 0) {
+        pthread_mutex_lock(&inst_pool_lock);
+        ret = (int)inst_pool_nr_idle;
+        pthread_mutex_unlock(&inst_pool_lock);
+    }
+
+    return ret;
+}
+
+purc_atom_t
+purc_inst_pool_take(void)
+{
+    purc_atom_t atom = 0;
+    size_t nr_to_make = 0;
+
+    for (int i = 0; i < 2 && atom == 0; i++) {
+        pthread_mutex_lock(&inst_pool_lock);
+        if (inst_pool_app_name[0] == 0) {
+            pthread_mutex_unlock(&inst_pool_lock);
+            purc_set_error(PURC_ERROR_NOT_READY);
+            return 0;
+        }
+
+        if (inst_pool_nr_idle > 0)
+            atom = inst_pool_idle[--inst_pool_nr_idle];
+        else
+            inst_pool_nr_pending++;
+        pthread_mutex_unlock(&inst_pool_lock);
+
+        /* the new instance joins the idle ones before returning */
+        if (atom == 0 && !make_pool_instance(true))
+            return 0;
+    }
+
+    if (atom == 0) {
+        purc_set_error(PURC_ERROR_TOO_MANY);
+        return 0;
+    }
+
+    /* refill the pool without waiting for the new instances */
+    pthread_mutex_lock(&inst_pool_lock);
+    if (inst_pool_min_idle > inst_pool_nr_idle + inst_pool_nr_pending) {
+        nr_to_make = inst_pool_min_idle - inst_pool_nr_idle -
+            inst_pool_nr_pending;
+        inst_pool_nr_pending += nr_to_make;
+    }
+    pthread_mutex_unlock(&inst_pool_lock);
+
+    for (size_t i = 0; i < nr_to_make; i++) {
+        if (!make_pool_instance(false)) {
+            pthread_mutex_lock(&inst_pool_lock);
+            inst_pool_nr_pending -= nr_to_make - i - 1;
+            pthread_mutex_unlock(&inst_pool_lock);
+            break;
+        }
+    }
+
+    return atom;
+}
+
 purc_atom_t
 purc_inst_schedule_vdom(purc_atom_t inst, purc_vdom_t vdom,
         purc_atom_t curator, purc_variant_t request,
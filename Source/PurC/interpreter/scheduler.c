@@ -35,6 +35,7 @@
 #include "private/variant.h"
 #include "private/ports.h"
 #include "private/msg-queue.h"
+#include "private/trace.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -45,6 +46,13 @@
 #define IDLE_EVENT_TIMEOUT      100             // ms
 #define TIME_SLIECE             0.005           // s
 
+/* the time is checked once every so many steps in a quantum */
+#define SCHED_CLOCK_STEPS       8
+/* a scheduling round is stopped after this time to dispatch the events */
+#define SCHED_ROUND_BUDGET      0.020           // s
+/* the credit of a coroutine is capped at so many quanta */
+#define SCHED_MAX_CREDITS       2
+
 #define BUILTIN_VAR_CRTN        PURC_PREDEF_VARNAME_CRTN
 
 #define YIELD_EVENT_HANDLER     "_yield_event_handler"
@@ -497,7 +505,20 @@ execute_one_step_for_ready_co(struct pcinst *inst, pcintr_coroutine_t co)
     pcintr_set_current_co(co);
 
     pcintr_coroutine_set_state(co, CO_STATE_RUNNING);
+    struct pcintr_heap *heap = inst->intr_heap;
+    bool profiling = heap->profiling;
+    if (profiling)
+        pcintr_profiler_begin_step(heap, co);
+
+    uint64_t span = pctrace_begin();
     pcintr_execute_one_step_for_ready_co(co);
+    pctrace_end(span, PCTRACE_CAT_SCHED, "step");
+
+    if (co->rdr_batch)
+        pcintr_rdr_flush_dom_batch(co);
+
+    if (profiling)
+        pcintr_profiler_end_step(heap, co);
 
     int err = purc_get_last_error();
     if (err != PURC_ERROR_AGAIN) {
@@ -510,6 +531,107 @@ execute_one_step_for_ready_co(struct pcinst *inst, pcintr_coroutine_t co)
     pcintr_set_current_co(NULL);
 }
 
+/*
+ * Deficit round-robin: every ready coroutine earns the quantum of its
+ * priority in each round (the one of the normal priority halved or doubled
+ * for each level), even if the round ends before its turn, and runs until
+ * it has spent its credit or the maximal steps of a quantum. A step taking
+ * longer leaves a debt, which is paid back in the next rounds; the credit
+ * is capped at SCHED_MAX_CREDITS quanta, and dropped when the coroutine is
+ * no longer ready.
+ *
+ * NOTE: the clock is read once per SCHED_CLOCK_STEPS steps only, so the
+ * cheap steps run in batches with little bookkeeping.
+ */
+static void
+top_up_coroutine_credit(struct pcintr_heap *heap, pcintr_coroutine_t co)
+{
+    int idx = co->priority - PURC_CRTN_PRIORITY_LOW;
+    int64_t quantum = ((int64_t)heap->sched_quantum_us << idx) >> 1;
+
+    co->sched_deficit += quantum;
+    if (co->sched_deficit > quantum * SCHED_MAX_CREDITS) {
+        co->sched_deficit = quantum * SCHED_MAX_CREDITS;
+    }
+}
+
+static void
+run_coroutine_quantum(struct pcinst *inst, pcintr_coroutine_t co)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+    int idx = co->priority - PURC_CRTN_PRIORITY_LOW;
+
+    if (co->sched_deficit <= 0) {
+        return;
+    }
+
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    if (co->ready_stamped) {
+        struct pcintr_sched_stat *stat = heap->sched_stats + idx;
+        double latency = purc_get_elapsed_seconds(&co->ready_since, &begin);
+        uint64_t us = (latency > 0) ? (uint64_t)(latency * 1000000) : 0;
+
+        stat->nr_samples++;
+        stat->total_us += us;
+        if (us > stat->max_us) {
+            stat->max_us = us;
+        }
+        co->ready_stamped = 0;
+    }
+
+    uint32_t steps = 0;
+    struct pcintr_stack_frame *frame;
+    while (co->state == CO_STATE_READY) {
+        frame = pcintr_stack_get_bottom_frame(&co->stack);
+        bool must_yield = frame ? frame->must_yield : false;
+        execute_one_step_for_ready_co(inst, co);
+        steps++;
+        if (must_yield ||
+                (heap->sched_max_steps && steps >= heap->sched_max_steps)) {
+            break;
+        }
+
+        if ((steps % SCHED_CLOCK_STEPS) == 0 &&
+                purc_get_elapsed_seconds(&begin, NULL) * 1000000 >=
+                co->sched_deficit) {
+            break;
+        }
+    }
+
+    heap->nr_steps += steps;
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    co->sched_deficit -= (int64_t)(purc_get_elapsed_seconds(&begin, &end) *
+            1000000);
+    if (co->state == CO_STATE_READY) {
+        /* waiting for the next round */
+        co->ready_since = end;
+        co->ready_stamped = 1;
+    }
+    else if (co->sched_deficit > 0) {
+        co->sched_deficit = 0;
+    }
+}
+
+/* let the next round start after the specific coroutine */
+static void
+rotate_crtns_after(struct pcintr_heap *heap, pcintr_coroutine_t co)
+{
+    pcintr_coroutine_t p;
+
+    /* NOTE: the coroutine may have been stopped in its quantum */
+    list_for_each_entry(p, &heap->crtns, ln) {
+        if (p == co) {
+            list_del(&heap->crtns);
+            list_add(&heap->crtns, &co->ln);
+            break;
+        }
+    }
+}
+
 // execute one step for all ready coroutines of the inst
 // return whether busy
 static bool
@@ -540,33 +662,50 @@ execute_one_step(struct pcinst *inst)
         pcintr_resume_coroutine(co);
     }
 
+    /* all ready coroutines earn their credits before the budget is checked,
+       so the priorities weigh the time but never starve any class */
     crtns = &heap->crtns;
-    list_for_each_entry_safe(p, q, crtns, ln) {
-        pcintr_coroutine_t co = p;
-        if (co->state != CO_STATE_READY) {
-            continue;
+    list_for_each_entry(p, crtns, ln) {
+        if (p->state == CO_STATE_READY) {
+            top_up_coroutine_credit(heap, p);
+        }
+    }
+
+    /* the class served first is rotated in each round, from the highest
+       priority; in a class, the coroutines in the order of the list, which
+       is rotated after each round too */
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    pcintr_coroutine_t last = NULL;
+    int first = PURC_CRTN_PRIORITY_HIGH -
+        (int)(heap->sched_rounds++ % PCINTR_NR_CRTN_PRIORITIES);
+    for (int i = 0; i < PCINTR_NR_CRTN_PRIORITIES; i++) {
+        int prio = first - i;
+        if (prio < PURC_CRTN_PRIORITY_LOW) {
+            prio += PCINTR_NR_CRTN_PRIORITIES;
         }
 
-#if 1
-        struct timespec begin;
-        clock_gettime(CLOCK_MONOTONIC, &begin);
-        struct pcintr_stack_frame *frame;
-        while (co->state == CO_STATE_READY) {
-            frame = pcintr_stack_get_bottom_frame(&co->stack);
-            bool must_yield = frame ? frame->must_yield : false;
-            execute_one_step_for_ready_co(inst, co);
-            if (must_yield) {
-                break;
+        list_for_each_entry_safe(p, q, crtns, ln) {
+            pcintr_coroutine_t co = p;
+            if (co->state != CO_STATE_READY || co->priority != prio) {
+                continue;
             }
-            double diff = purc_get_elapsed_seconds(&begin, NULL);
-            if (diff > TIME_SLIECE) {
-                break;
+
+            if (busy && purc_get_elapsed_seconds(&begin, NULL) >
+                    SCHED_ROUND_BUDGET) {
+                goto done;
             }
+
+            run_coroutine_quantum(inst, co);
+            last = co;
+            busy = true;
         }
-#else
-            execute_one_step_for_ready_co(inst, co);
-#endif
-        busy = true;
+    }
+
+done:
+    if (last) {
+        rotate_crtns_after(heap, last);
     }
 
     return busy;
@@ -598,14 +737,21 @@ check_and_dispatch_event_from_conn(struct pcinst *inst)
 }
 
 static int
-handle_event_by_observer_list(purc_coroutine_t co, struct list_head *list,
+handle_event_by_observer_list(purc_coroutine_t co,
+        enum pcintr_observer_source source,
         pcrdr_msg *msg, const char *event_type,
         const char *event_sub_type, bool *event_observed, bool *busy)
 {
     int ret = PURC_ERROR_INCOMPLETED;
     purc_variant_t observed = msg->elementValue;
-    struct pcintr_observer *observer, *next;
-    list_for_each_entry_safe(observer, next, list, node) {
+    struct pcintr_observer_iterator it;
+    struct pcintr_observer *observer;
+
+    /* only the observers of the event type, the wildcards, and the
+       observers of the element are visited */
+    pcintr_observer_iterator_init_ex(&it, &co->stack, source, event_type,
+            observed);
+    while ((observer = pcintr_observer_iterator_next(&it))) {
         bool match = observer->is_match(co, observer, msg, observed, event_type,
                 event_sub_type);
         if ((co->stage & observer->cor_stage) &&
@@ -672,12 +818,15 @@ again:
 
     // observer
     if (msg) {
+        /* the result of a child is kept even if it is not observed */
+        pcintr_future_settle(co, msg, type, event_sub_type);
+
         int handle_by_inner = handle_event_by_observer_list(co,
-                &co->stack.intr_observers, msg, type, event_sub_type,
+                OBSERVER_SOURCE_INTR, msg, type, event_sub_type,
                 &msg_observed, &busy);
 
         int handle_by_hvml = handle_event_by_observer_list(co,
-                    &co->stack.hvml_observers, msg, type, event_sub_type,
+                    OBSERVER_SOURCE_HVML, msg, type, event_sub_type,
                     &msg_observed, &busy);
 
         if (handle_by_inner == 0 || handle_by_hvml == 0) {
@@ -786,6 +935,9 @@ pcintr_schedule(void *ctxt)
 
 again:
 
+    if (heap->profiler)
+        pcintr_profiler_check_requests(heap);
+
     if (inst->conn_to_rdr_origin) {
         pcrdr_disconnect(inst->conn_to_rdr_origin);
         inst->conn_to_rdr_origin = NULL;
@@ -793,10 +945,17 @@ again:
 
     // 1. exec one step for all ready coroutines and
     // return whether step is busy
+    uint64_t span = pctrace_begin();
     step_is_busy = execute_one_step(inst);
+    /* NOTE: the idle rounds are not recorded to keep the ring buffer */
+    if (step_is_busy)
+        pctrace_end(span, PCTRACE_CAT_SCHED, "execute_one_step");
 
     // 2. dispatch event for observing / stopped coroutines
+    span = pctrace_begin();
     event_is_busy = dispatch_event(inst);
+    if (event_is_busy)
+        pctrace_end(span, PCTRACE_CAT_SCHED, "dispatch_event");
 
     // 3. its busy, goto next scheduler without sleep
     if (step_is_busy || event_is_busy) {
@@ -808,6 +967,7 @@ again:
     double now = pcintr_get_current_time();
     if (now - IDLE_EVENT_TIMEOUT > heap->timestamp) {
         broadcast_idle_event(inst);
+        pcintr_idle_trim_check(inst, now);
         pcintr_update_timestamp(inst);
     }
 
@@ -906,6 +1066,10 @@ dump_stack_frame(pcintr_stack_t stack,
     purc_rwstream_write(stm, buf, strlen(buf));
     pcvdom_util_node_serialize_alone(&elem->node, serial_element, stm);
 
+    struct pcintr_heap *heap = pcintr_get_heap();
+    if (heap)
+        pcintr_profiler_dump_element(heap, elem, stm);
+
     if (frame->pos) {
         snprintf(buf, DUMP_BUF_SIZE, "  ATTRIBUTES:\n");
         purc_rwstream_write(stm, buf, strlen(buf));
@@ -33,58 +33,504 @@
 #include "private/interpreter.h"
 #include "purc-runloop.h"
 
+#include <wtf/HashMap.h>
+#include <wtf/Lock.h>
+#include <wtf/MathExtras.h>
+#include <wtf/MonotonicTime.h>
+#include <wtf/NeverDestroyed.h>
 #include <wtf/RunLoop.h>
 #include <wtf/Seconds.h>
 
 #include <stdlib.h>
 #include <string.h>
 
-class Timer : public PurCWTF::RunLoop::TimerBase {
+/*
+ * All timers of a run loop are multiplexed onto a single RunLoop timer by a
+ * hierarchical timing wheel, instead of creating a source for each timer.
+ *
+ * The wheel has WHEEL_LEVELS levels of WHEEL_SLOTS slots; a slot of level
+ * `l` covers WHEEL_SLOTS^l milliseconds. A timer is put in the lowest level
+ * whose current rotation contains its expiry, and the timers in a slot of an
+ * upper level are moved down (cascaded) when the wheel reaches the slot. The
+ * expired timers are collected in a batch and fired after the wheel moved.
+ *
+ * A timer may fire up to its slack later than its deadline: the expiry is
+ * rounded up to a multiple of the largest power of two not greater than the
+ * slack, so that the timers with nearby deadlines share a wakeup.
+ *
+ * A throttled timer, e.g., one of a coroutine whose page is hidden, fires
+ * at most once per PCINTR_TIMER_THROTTLED_INTERVAL milliseconds, and uses
+ * the interval as its slack at least, so that the throttled timers of all
+ * the hidden pages are batched into a few wakeups.
+ */
+
+#define WHEEL_BITS          6
+#define WHEEL_SLOTS         (1 << WHEEL_BITS)
+#define WHEEL_MASK          (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS        4
+
+#define WHEEL_PENDING       -1
+#define WHEEL_INACTIVE      -2
+
+class TimerWheel;
+
+class Timer {
     public:
-        Timer(const char *id, pcintr_timer_fire_func func, RunLoop& runLoop,
+        Timer(const char *id, pcintr_timer_fire_func func, TimerWheel *wheel,
                 void *data)
-            : TimerBase(runLoop)
-            , m_id(NULL)
+            : m_id(NULL)
             , m_func(func)
             , m_data(data)
+            , m_interval(0)
+            , m_wheel(wheel)
         {
             m_id = id ? strdup(id) : NULL;
         }
 
-        ~Timer()
-        {
-            stop();
-            if (m_id) {
-                free(m_id);
-            }
-        }
+        ~Timer();
 
         void setInterval(uint32_t interval) { m_interval = interval; }
         uint32_t getInterval() { return m_interval; }
+        void setSlack(uint32_t slack) { m_slack = slack; }
+        uint32_t getSlack() { return m_slack; }
+        void setThrottled(bool throttled);
+        bool isThrottled() { return m_throttled; }
         const char *getId() { return m_id; }
         void *getData() { return m_data; }
 
-        virtual void fired()
+        void startRepeating();
+        void startOneShot();
+        void stop();
+        bool isActive() { return m_level != WHEEL_INACTIVE; }
+
+        void fired()
         {
             m_func(this, m_id, m_data);
         }
 
-        virtual void processed(void) {}
-
     private:
+        friend class TimerWheel;
+
         char *m_id;
         pcintr_timer_fire_func m_func;
         void *m_data;
         uint32_t m_interval;
+        uint32_t m_slack { PCINTR_TIMER_SLACK_DEFAULT };
+        bool m_throttled { false };
+
+        TimerWheel *m_wheel;
+        Timer *m_prev { NULL };
+        Timer *m_next { NULL };
+        uint64_t m_deadline { 0 };  // in ticks of the wheel
+        uint64_t m_expire { 0 };    // the deadline rounded by the slack
+        int m_level { WHEEL_INACTIVE };
+        int m_slot { 0 };
+        bool m_repeating { false };
 };
 
+class TimerWheel : public PurCWTF::RunLoop::TimerBase {
+    public:
+        static TimerWheel *acquire(RunLoop& runLoop);
+        void release();
+
+        void schedule(Timer *timer, bool repeating);
+        void cancel(Timer *timer);
+
+        void setSlack(uint32_t slack) { m_slack = slack; }
+        uint32_t getSlack() const { return m_slack; }
+
+        size_t nrTimers() const { return m_nrTimers; }
+        size_t nrActive() const { return m_nrActive; }
+
+        virtual void fired();
+
+    private:
+        TimerWheel(RunLoop& runLoop)
+            : TimerBase(runLoop)
+            , m_runLoop(&runLoop)
+            , m_origin(PurCWTF::MonotonicTime::now())
+        {
+            memset(m_slots, 0, sizeof(m_slots));
+            memset(m_bitmaps, 0, sizeof(m_bitmaps));
+        }
+
+        uint64_t now() const
+        {
+            return (uint64_t)(PurCWTF::MonotonicTime::now() - m_origin)
+                .milliseconds();
+        }
+
+        Timer **headOf(int level, int slot)
+        {
+            return (level == WHEEL_PENDING) ? &m_pending :
+                &m_slots[level][slot];
+        }
+
+        static uint32_t intervalOf(Timer *timer);
+        uint64_t coalesce(Timer *timer) const;
+        void link(Timer *timer, int level, int slot);
+        void unlink(Timer *timer);
+        void insert(Timer *timer);
+        uint64_t nextEvent() const;
+        void advance(uint64_t now);
+        void rearm();
+
+        RunLoop *m_runLoop;
+        PurCWTF::MonotonicTime m_origin;
+        uint64_t m_current { 0 };   // the next tick to process
+        uint64_t m_armed { UINT64_MAX };
+        size_t m_nrTimers { 0 };    // the timers using this wheel
+        size_t m_nrActive { 0 };
+        uint32_t m_slack { 0 };     // for the timers without their own
+
+        Timer *m_slots[WHEEL_LEVELS][WHEEL_SLOTS];
+        uint64_t m_bitmaps[WHEEL_LEVELS];
+        Timer *m_pending { NULL };  // expired, but not fired yet
+};
+
+static PurCWTF::Lock s_wheels_lock;
+static PurCWTF::HashMap<RunLoop*, TimerWheel*>& wheels()
+{
+    static PurCWTF::NeverDestroyed<PurCWTF::HashMap<RunLoop*, TimerWheel*>>
+        map;
+    return map;
+}
+
+TimerWheel *
+TimerWheel::acquire(RunLoop& runLoop)
+{
+    PurCWTF::Locker<PurCWTF::Lock> locker { s_wheels_lock };
+
+    TimerWheel *wheel = wheels().get(&runLoop);
+    if (wheel == NULL) {
+        wheel = new TimerWheel(runLoop);
+        wheels().set(&runLoop, wheel);
+    }
+    wheel->m_nrTimers++;
+    return wheel;
+}
+
+void
+TimerWheel::release()
+{
+    PurCWTF::Locker<PurCWTF::Lock> locker { s_wheels_lock };
+
+    if (--m_nrTimers == 0) {
+        PC_ASSERT(m_nrActive == 0);
+        wheels().remove(m_runLoop);
+        delete this;
+    }
+}
+
+uint32_t
+TimerWheel::intervalOf(Timer *timer)
+{
+    if (timer->m_throttled) {
+        return std::max(timer->m_interval,
+                (uint32_t)PCINTR_TIMER_THROTTLED_INTERVAL);
+    }
+    return timer->m_interval;
+}
+
+uint64_t
+TimerWheel::coalesce(Timer *timer) const
+{
+    uint32_t slack = timer->m_slack;
+    if (slack == PCINTR_TIMER_SLACK_DEFAULT) {
+        slack = m_slack;
+    }
+    if (timer->m_throttled) {
+        slack = std::max(slack, (uint32_t)PCINTR_TIMER_THROTTLED_INTERVAL);
+    }
+    if (slack < 2) {
+        return timer->m_deadline;
+    }
+
+    uint64_t align = (uint64_t)1 << PurCWTF::getMSBSet(slack);
+    return (timer->m_deadline + align - 1) & ~(align - 1);
+}
+
+void
+TimerWheel::link(Timer *timer, int level, int slot)
+{
+    Timer **head = headOf(level, slot);
+
+    timer->m_level = level;
+    timer->m_slot = slot;
+    timer->m_prev = NULL;
+    timer->m_next = *head;
+    if (*head) {
+        (*head)->m_prev = timer;
+    }
+    *head = timer;
+
+    if (level >= 0) {
+        m_bitmaps[level] |= (uint64_t)1 << slot;
+    }
+}
+
+void
+TimerWheel::unlink(Timer *timer)
+{
+    Timer **head = headOf(timer->m_level, timer->m_slot);
+
+    if (timer->m_prev) {
+        timer->m_prev->m_next = timer->m_next;
+    }
+    else {
+        *head = timer->m_next;
+    }
+    if (timer->m_next) {
+        timer->m_next->m_prev = timer->m_prev;
+    }
+
+    if (timer->m_level >= 0 && *head == NULL) {
+        m_bitmaps[timer->m_level] &= ~((uint64_t)1 << timer->m_slot);
+    }
+    timer->m_prev = timer->m_next = NULL;
+    timer->m_level = WHEEL_INACTIVE;
+}
+
+void
+TimerWheel::insert(Timer *timer)
+{
+    uint64_t expire = std::max(timer->m_expire, m_current);
+
+    int level;
+    uint64_t pos = 0;
+    for (level = 0; level < WHEEL_LEVELS; level++) {
+        unsigned shift = WHEEL_BITS * (level + 1);
+        if ((expire >> shift) == (m_current >> shift)) {
+            pos = expire >> (WHEEL_BITS * level);
+            break;
+        }
+    }
+
+    if (level == WHEEL_LEVELS) {
+        /* beyond the rotation of the top level: use it as a hashed wheel,
+           but not farther than one turn, then cascade it again */
+        level = WHEEL_LEVELS - 1;
+        pos = std::min(expire >> (WHEEL_BITS * level),
+                (m_current >> (WHEEL_BITS * level)) + WHEEL_MASK);
+    }
+
+    link(timer, level, (int)(pos & WHEEL_MASK));
+}
+
+uint64_t
+TimerWheel::nextEvent() const
+{
+    uint64_t next = UINT64_MAX;
+
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        if (m_bitmaps[level] == 0) {
+            continue;
+        }
+
+        unsigned shift = WHEEL_BITS * level;
+        uint64_t pos = m_current >> shift;
+        unsigned rot = (unsigned)(pos & WHEEL_MASK);
+
+        /* bit `k` of `bits` is the slot reached after `k` slots */
+        uint64_t bits = m_bitmaps[level];
+        if (rot) {
+            bits = (bits >> rot) | (bits << (WHEEL_SLOTS - rot));
+        }
+        if (m_current & (((uint64_t)1 << shift) - 1)) {
+            /* the current slot of an upper level has been cascaded */
+            bits &= ~(uint64_t)1;
+        }
+        if (bits == 0) {
+            continue;
+        }
+
+        uint64_t tick = (pos + PurCWTF::ctz(bits)) << shift;
+        if (tick < next) {
+            next = tick;
+        }
+    }
+
+    return next;
+}
+
+void
+TimerWheel::advance(uint64_t now)
+{
+    uint64_t tick;
+    while ((tick = nextEvent()) <= now) {
+        m_current = tick;
+
+        /* from the top, so that the cascaded timers expiring at this tick
+           are collected with the ones of the lowest level */
+        for (int level = WHEEL_LEVELS - 1; level >= 0; level--) {
+            unsigned shift = WHEEL_BITS * level;
+            if (tick & (((uint64_t)1 << shift) - 1)) {
+                continue;
+            }
+
+            int slot = (int)((tick >> shift) & WHEEL_MASK);
+            Timer *timer;
+            while ((timer = m_slots[level][slot])) {
+                unlink(timer);
+                if (timer->m_expire <= tick) {
+                    link(timer, WHEEL_PENDING, 0);
+                }
+                else {
+                    insert(timer);
+                }
+            }
+        }
+
+        m_current = tick + 1;
+    }
+
+    /* NOTE: no slot is reached before `now`, so it is safe to skip to it */
+    if (m_current <= now) {
+        m_current = now + 1;
+    }
+}
+
+void
+TimerWheel::rearm()
+{
+    uint64_t next = nextEvent();
+    if (next == m_armed) {
+        return;
+    }
+
+    m_armed = next;
+    if (next == UINT64_MAX) {
+        stop();
+        return;
+    }
+
+    PurCWTF::MonotonicTime when = m_origin +
+        PurCWTF::Seconds::fromMilliseconds((double)next);
+    startOneShot(when - PurCWTF::MonotonicTime::now());
+}
+
+void
+TimerWheel::schedule(Timer *timer, bool repeating)
+{
+    if (timer->isActive()) {
+        cancel(timer);
+    }
+
+    uint64_t now = this->now();
+    if (m_nrActive == 0 && m_current < now) {
+        /* the wheel is empty; just move it to the present */
+        m_current = now;
+    }
+
+    timer->m_repeating = repeating;
+    timer->m_deadline = now + intervalOf(timer);
+    timer->m_expire = coalesce(timer);
+    insert(timer);
+    m_nrActive++;
+
+    rearm();
+}
+
+void
+TimerWheel::cancel(Timer *timer)
+{
+    if (!timer->isActive()) {
+        return;
+    }
+
+    unlink(timer);
+    m_nrActive--;
+    rearm();
+}
+
+void
+TimerWheel::fired()
+{
+    uint64_t now = this->now();
+    m_armed = UINT64_MAX;
+    advance(now);
+
+    /* keep the wheel alive even if the callbacks destroy all the timers */
+    {
+        PurCWTF::Locker<PurCWTF::Lock> locker { s_wheels_lock };
+        m_nrTimers++;
+    }
+
+    /* the callbacks may stop or destroy any timer, including the pending
+       ones, so take them one by one from the pending list */
+    Timer *timer;
+    while ((timer = m_pending)) {
+        unlink(timer);
+        if (timer->m_repeating) {
+            uint64_t interval = std::max(intervalOf(timer), (uint32_t)1);
+            timer->m_deadline += interval;
+            if (timer->m_deadline <= now) {
+                /* skip the missed expirations */
+                timer->m_deadline = now + interval;
+            }
+            timer->m_expire = coalesce(timer);
+            insert(timer);
+        }
+        else {
+            m_nrActive--;
+        }
+        timer->fired();
+    }
+
+    rearm();
+    release();
+}
+
+Timer::~Timer()
+{
+    stop();
+    if (m_id) {
+        free(m_id);
+    }
+    m_wheel->release();
+}
+
+void
+Timer::startRepeating()
+{
+    m_wheel->schedule(this, true);
+}
+
+void
+Timer::startOneShot()
+{
+    m_wheel->schedule(this, false);
+}
+
+void
+Timer::stop()
+{
+    m_wheel->cancel(this);
+}
+
+void
+Timer::setThrottled(bool throttled)
+{
+    if (m_throttled == throttled) {
+        return;
+    }
+
+    m_throttled = throttled;
+    if (isActive()) {
+        /* reschedule it with the new interval from now on */
+        m_wheel->schedule(this, m_repeating);
+    }
+}
+
 pcintr_timer_t
 pcintr_timer_create(purc_runloop_t runloop, const char* id,
         pcintr_timer_fire_func func, void *data)
 {
     RunLoop* loop = runloop ? (RunLoop*)runloop : &RunLoop::current();
-    Timer* timer = new Timer(id, func, *loop, data);
+    TimerWheel* wheel = TimerWheel::acquire(*loop);
+    Timer* timer = new Timer(id, func, wheel, data);
     if (!timer) {
+        wheel->release();
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
@@ -112,9 +558,7 @@ void
 pcintr_timer_start(pcintr_timer_t timer)
 {
     if (timer) {
-        Timer* tm = (Timer*)timer;
-        tm->startRepeating(
-                PurCWTF::Seconds::fromMilliseconds(tm->getInterval()));
+        ((Timer*)timer)->startRepeating();
     }
 }
 
@@ -122,9 +566,7 @@ void
 pcintr_timer_start_oneshot(pcintr_timer_t timer)
 {
     if (timer) {
-        Timer* tm = (Timer*)timer;
-        tm->startOneShot(
-                PurCWTF::Seconds::fromMilliseconds(tm->getInterval()));
+        ((Timer*)timer)->startOneShot();
     }
 }
 
@@ -136,6 +578,61 @@ pcintr_timer_stop(pcintr_timer_t timer)
     }
 }
 
+void
+pcintr_timer_set_slack(pcintr_timer_t timer, uint32_t slack)
+{
+    if (timer) {
+        ((Timer*)timer)->setSlack(slack);
+    }
+}
+
+uint32_t
+pcintr_timer_get_slack(pcintr_timer_t timer)
+{
+    if (timer) {
+        return ((Timer*)timer)->getSlack();
+    }
+    return PCINTR_TIMER_SLACK_DEFAULT;
+}
+
+void
+purc_runloop_set_timer_slack(purc_runloop_t runloop, uint32_t slack)
+{
+    RunLoop* loop = runloop ? (RunLoop*)runloop : &RunLoop::current();
+
+    /* NOTE: the setting lives with the wheel, which is kept as long as there
+       is a timer on the run loop; every instance keeps one */
+    TimerWheel* wheel = TimerWheel::acquire(*loop);
+    wheel->setSlack(slack);
+    wheel->release();
+}
+
+void
+pcintr_timer_get_stat(purc_runloop_t runloop, size_t *nr_timers,
+        size_t *nr_active)
+{
+    RunLoop* loop = runloop ? (RunLoop*)runloop : &RunLoop::current();
+
+    PurCWTF::Locker<PurCWTF::Lock> locker { s_wheels_lock };
+    TimerWheel *wheel = wheels().get(loop);
+    *nr_timers = wheel ? wheel->nrTimers() : 0;
+    *nr_active = wheel ? wheel->nrActive() : 0;
+}
+
+void
+pcintr_timer_set_throttled(pcintr_timer_t timer, bool throttled)
+{
+    if (timer) {
+        ((Timer*)timer)->setThrottled(throttled);
+    }
+}
+
+bool
+pcintr_timer_is_throttled(pcintr_timer_t timer)
+{
+    return timer ? ((Timer*)timer)->isThrottled() : false;
+}
+
 bool
 pcintr_timer_is_active(pcintr_timer_t timer)
 {
@@ -156,6 +653,7 @@ pcintr_timer_destroy(pcintr_timer_t timer)
 #define TIMERS_STR_ID               "id"
 #define TIMERS_STR_INTERVAL         "interval"
 #define TIMERS_STR_ACTIVE           "active"
+#define TIMERS_STR_SLACK            "slack"
 #define TIMERS_STR_YES              "yes"
 #define TIMERS_STR_TIMERS           "TIMERS"
 #define TIMERS_STR_EXPIRED          "expired"
@@ -265,6 +763,24 @@ remove_timer(struct pcintr_timers* timers, const char* id)
     pcutils_map_erase(timers->timers_map, (void*)id);
 }
 
+static void
+update_timer_slack(pcintr_timer_t timer, purc_variant_t timer_var)
+{
+    uint64_t slack = PCINTR_TIMER_SLACK_DEFAULT;
+    purc_variant_t v = purc_variant_object_get_by_ckey(timer_var,
+            TIMERS_STR_SLACK);
+    if (v != PURC_VARIANT_INVALID) {
+        purc_variant_cast_to_ulongint(v, &slack, false);
+        if (slack > UINT32_MAX) {
+            slack = PCINTR_TIMER_SLACK_DEFAULT;
+        }
+    }
+    else {
+        purc_clr_error();
+    }
+    pcintr_timer_set_slack(timer, (uint32_t)slack);
+}
+
 static pcintr_timer_t
 get_inner_timer(purc_coroutine_t cor , purc_variant_t timer_var)
 {
@@ -286,6 +802,10 @@ get_inner_timer(purc_coroutine_t cor , purc_variant_t timer_var)
         return NULL;
     }
 
+    if (cor->page_hidden) {
+        pcintr_timer_set_throttled(timer, true);
+    }
+
     if (!add_timer(cor->timers, idstr, timer)) {
         pcintr_timer_destroy(timer);
         return NULL;
@@ -336,6 +856,8 @@ timer_listener_handler(purc_variant_t source, pcvar_op_t msg_type,
     else {
         purc_clr_error();
     }
+    update_timer_slack(timer, nv);
+
     bool next_active = pcintr_timer_is_active(timer);
     if (active != PURC_VARIANT_INVALID) {
         if (is_euqal(active, TIMERS_STR_YES)) {
@@ -386,6 +908,7 @@ timers_set_grow(purc_variant_t source, pcvar_op_t msg_type,
     uint64_t ret = 0;
     purc_variant_cast_to_ulongint(interval, &ret, false);
     pcintr_timer_set_interval(timer, ret);
+    update_timer_slack(timer, argv[0]);
     if (is_euqal(active, TIMERS_STR_YES)) {
         pcintr_timer_start(timer);
     }
@@ -448,6 +971,8 @@ timers_set_change(purc_variant_t source, pcvar_op_t msg_type,
     else {
         purc_clr_error();
     }
+    update_timer_slack(timer, nv);
+
     bool next_active = pcintr_timer_is_active(timer);
     if (active != PURC_VARIANT_INVALID) {
         if (is_euqal(active, TIMERS_STR_YES)) {
@@ -582,6 +1107,22 @@ pcintr_timers_destroy(struct pcintr_timers* timers)
     }
 }
 
+static int
+throttle_timer(void *key, void *val, void *ud)
+{
+    UNUSED_PARAM(key);
+    pcintr_timer_set_throttled((pcintr_timer_t)val, *(bool *)ud);
+    return 0;
+}
+
+void
+pcintr_timers_throttle(struct pcintr_timers* timers, bool throttled)
+{
+    if (timers && timers->timers_map) {
+        pcutils_map_traverse(timers->timers_map, &throttled, throttle_timer);
+    }
+}
+
 bool
 pcintr_is_timers(purc_coroutine_t cor, purc_variant_t v)
 {
@@ -0,0 +1,415 @@
+/*
+ * @file uring.c
+ * @date 2026/10/14
+ * @brief The io_uring backend of the run loop.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc-runloop.h"
+#include "private/instance.h"
+#include "private/debug.h"
+#include "private/list.h"
+#include "private/uring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if ENABLE(IO_URING) && OS(LINUX)
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/* NOTE: The ring is driven by the raw system calls, so there is no
+   dependency on liburing. Each instance has its own ring, because each
+   instance runs its own run loop. The completions are notified through
+   an eventfd monitored by the run loop, and the requests queued in one
+   iteration are submitted together by a function dispatched to the run
+   loop. A request keeps a copy of the data, so the caller may free its
+   buffer, or cancel the request, at any time. */
+struct pcintr_uring {
+    int                     fd;
+    int                     evfd;
+    uintptr_t               monitor;
+    bool                    flush_scheduled;
+
+    /* the submission queue */
+    unsigned               *sq_head;
+    unsigned               *sq_tail;
+    unsigned               *sq_mask;
+    unsigned               *sq_array;
+    unsigned                sq_entries;
+    unsigned                sq_local_tail;
+    unsigned                nr_unsubmitted;
+    struct io_uring_sqe    *sqes;
+
+    /* the completion queue */
+    unsigned               *cq_head;
+    unsigned               *cq_tail;
+    unsigned               *cq_mask;
+    unsigned                cq_entries;
+    struct io_uring_cqe    *cqes;
+
+    void                   *sq_ring;
+    void                   *cq_ring;
+    size_t                  sz_sq_ring;
+    size_t                  sz_cq_ring;
+    size_t                  sz_sqes;
+
+    size_t                  nr_inflight;
+    struct list_head        requests;
+};
+
+struct uring_request {
+    struct list_head        ln;
+
+    pcintr_uring_cb         cb;     /* NULL if cancelled */
+    void                   *ctxt;
+    size_t                  len;
+    char                    data[0];
+};
+
+static int uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(int fd, unsigned to_submit)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, 0, 0, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, void *arg, unsigned nr)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr);
+}
+
+static void uring_reap(struct pcintr_uring *uring)
+{
+    unsigned head = *uring->cq_head;
+
+    while (head != __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe *cqe = &uring->cqes[head & *uring->cq_mask];
+        struct uring_request *req;
+
+        req = (struct uring_request *)(uintptr_t)cqe->user_data;
+        ssize_t result = cqe->res;
+
+        head++;
+        __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+
+        list_del(&req->ln);
+        uring->nr_inflight--;
+
+        /* the callback may submit more requests */
+        if (req->cb)
+            req->cb(req->ctxt, req->data, req->len, result);
+        free(req);
+    }
+}
+
+static bool on_completions(int fd, purc_runloop_io_event event, void *ctxt)
+{
+    UNUSED_PARAM(event);
+    UNUSED_PARAM(ctxt);
+
+    uint64_t nr;
+    if (read(fd, &nr, sizeof(nr)) < 0 && errno != EAGAIN) {
+        PC_WARN("Failed to read the eventfd of io_uring: %s\n",
+                strerror(errno));
+    }
+
+    struct pcinst *inst = pcinst_current();
+    if (inst && inst->uring) {
+        uring_reap(inst->uring);
+    }
+
+    return true;
+}
+
+static void uring_flush(struct pcintr_uring *uring)
+{
+    if (uring->nr_unsubmitted == 0)
+        return;
+
+    __atomic_store_n(uring->sq_tail, uring->sq_local_tail, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+        ret = uring_enter(uring->fd, uring->nr_unsubmitted);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret > 0) {
+        uring->nr_unsubmitted -= ret;
+    }
+    else if (ret < 0) {
+        PC_WARN("Failed to submit to io_uring: %s\n", strerror(errno));
+    }
+}
+
+static void on_flush(void *ctxt)
+{
+    UNUSED_PARAM(ctxt);
+
+    /* the instance may have been cleaned up */
+    struct pcinst *inst = pcinst_current();
+    if (inst && inst->uring) {
+        inst->uring->flush_scheduled = false;
+        uring_flush(inst->uring);
+    }
+}
+
+static struct pcintr_uring *uring_new(void)
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    int fd = uring_setup(PCINTR_URING_ENTRIES, &p);
+    if (fd < 0) {
+        PC_INFO("io_uring is not available: %s\n", strerror(errno));
+        return NULL;
+    }
+
+    /* the writes to sockets should be polled by the kernel */
+    if (!(p.features & IORING_FEAT_FAST_POLL) ||
+            !(p.features & IORING_FEAT_NODROP)) {
+        PC_INFO("io_uring of this kernel is too old\n");
+        close(fd);
+        return NULL;
+    }
+
+    struct pcintr_uring *uring = calloc(1, sizeof(*uring));
+    if (uring == NULL) {
+        close(fd);
+        return NULL;
+    }
+
+    uring->fd = fd;
+    uring->evfd = -1;
+    list_head_init(&uring->requests);
+
+    uring->sz_sq_ring = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    uring->sz_cq_ring = p.cq_off.cqes +
+        p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (uring->sz_cq_ring > uring->sz_sq_ring)
+            uring->sz_sq_ring = uring->sz_cq_ring;
+        uring->sz_cq_ring = 0;
+    }
+
+    uring->sq_ring = mmap(NULL, uring->sz_sq_ring, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (uring->sq_ring == MAP_FAILED) {
+        uring->sq_ring = NULL;
+        goto failed;
+    }
+
+    if (uring->sz_cq_ring) {
+        uring->cq_ring = mmap(NULL, uring->sz_cq_ring,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                fd, IORING_OFF_CQ_RING);
+        if (uring->cq_ring == MAP_FAILED) {
+            uring->cq_ring = NULL;
+            goto failed;
+        }
+    }
+    else {
+        uring->cq_ring = uring->sq_ring;
+    }
+
+    uring->sz_sqes = p.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(NULL, uring->sz_sqes, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED) {
+        uring->sqes = NULL;
+        goto failed;
+    }
+
+    char *sq = uring->sq_ring;
+    uring->sq_head = (unsigned *)(sq + p.sq_off.head);
+    uring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    uring->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    uring->sq_array = (unsigned *)(sq + p.sq_off.array);
+    uring->sq_entries = p.sq_entries;
+    uring->sq_local_tail = *uring->sq_tail;
+
+    char *cq = uring->cq_ring;
+    uring->cq_head = (unsigned *)(cq + p.cq_off.head);
+    uring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    uring->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    uring->cq_entries = p.cq_entries;
+    uring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    uring->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (uring->evfd < 0 ||
+            uring_register(fd, IORING_REGISTER_EVENTFD, &uring->evfd, 1)) {
+        goto failed;
+    }
+
+    uring->monitor = purc_runloop_add_fd_monitor(purc_runloop_get_current(),
+            uring->evfd, PCRUNLOOP_IO_IN, on_completions, NULL);
+    if (uring->monitor == 0)
+        goto failed;
+
+    return uring;
+
+failed:
+    PC_WARN("Failed to set up io_uring: %s\n", strerror(errno));
+    pcintr_uring_destroy(uring);
+    return NULL;
+}
+
+void pcintr_uring_destroy(struct pcintr_uring *uring)
+{
+    if (uring->monitor)
+        purc_runloop_remove_fd_monitor(NULL, uring->monitor);
+    if (uring->evfd >= 0)
+        close(uring->evfd);
+
+    /* closing the ring waits for the requests in flight */
+    if (uring->sqes)
+        munmap(uring->sqes, uring->sz_sqes);
+    if (uring->cq_ring && uring->cq_ring != uring->sq_ring)
+        munmap(uring->cq_ring, uring->sz_cq_ring);
+    if (uring->sq_ring)
+        munmap(uring->sq_ring, uring->sz_sq_ring);
+    close(uring->fd);
+
+    struct uring_request *p, *n;
+    list_for_each_entry_safe(p, n, &uring->requests, ln) {
+        list_del(&p->ln);
+        free(p);
+    }
+
+    free(uring);
+}
+
+bool pcintr_uring_available(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL)
+        return false;
+
+    /* try to set up the ring only once */
+    if (inst->uring == NULL && !inst->uring_tried) {
+        inst->uring_tried = 1;
+        inst->uring = uring_new();
+    }
+
+    return inst->uring != NULL;
+}
+
+uintptr_t pcintr_uring_write(int fd, const void *buf, size_t len,
+        pcintr_uring_cb cb, void *ctxt)
+{
+    struct pcinst *inst = pcinst_current();
+    struct pcintr_uring *uring = inst ? inst->uring : NULL;
+    if (uring == NULL)
+        return 0;
+
+    /* keep the completion queue from overflowing */
+    if (uring->nr_inflight >= uring->cq_entries)
+        return 0;
+
+    unsigned head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+    if (uring->sq_local_tail - head >= uring->sq_entries) {
+        uring_flush(uring);
+        head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+        if (uring->sq_local_tail - head >= uring->sq_entries)
+            return 0;
+    }
+
+    struct uring_request *req = malloc(sizeof(*req) + len);
+    if (req == NULL)
+        return 0;
+
+    req->cb = cb;
+    req->ctxt = ctxt;
+    req->len = len;
+    memcpy(req->data, buf, len);
+
+    unsigned idx = uring->sq_local_tail & *uring->sq_mask;
+    struct io_uring_sqe *sqe = &uring->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)req->data;
+    sqe->len = len;
+    sqe->off = (uint64_t)-1;    /* use the file position, as write() */
+    sqe->user_data = (uintptr_t)req;
+
+    uring->sq_array[idx] = idx;
+    uring->sq_local_tail++;
+    uring->nr_unsubmitted++;
+
+    list_add_tail(&req->ln, &uring->requests);
+    uring->nr_inflight++;
+
+    if (!uring->flush_scheduled) {
+        uring->flush_scheduled = true;
+        purc_runloop_dispatch(purc_runloop_get_current(), on_flush, NULL);
+    }
+
+    return (uintptr_t)req;
+}
+
+void pcintr_uring_cancel(uintptr_t handle)
+{
+    struct uring_request *req = (struct uring_request *)handle;
+    if (req) {
+        req->cb = NULL;
+        req->ctxt = NULL;
+    }
+}
+
+#else   /* ENABLE(IO_URING) && OS(LINUX) */
+
+bool pcintr_uring_available(void)
+{
+    return false;
+}
+
+uintptr_t pcintr_uring_write(int fd, const void *buf, size_t len,
+        pcintr_uring_cb cb, void *ctxt)
+{
+    UNUSED_PARAM(fd);
+    UNUSED_PARAM(buf);
+    UNUSED_PARAM(len);
+    UNUSED_PARAM(cb);
+    UNUSED_PARAM(ctxt);
+    return 0;
+}
+
+void pcintr_uring_cancel(uintptr_t handle)
+{
+    UNUSED_PARAM(handle);
+}
+
+void pcintr_uring_destroy(struct pcintr_uring *uring)
+{
+    UNUSED_PARAM(uring);
+}
+
+#endif  /* !ENABLE(IO_URING) || !OS(LINUX) */
+
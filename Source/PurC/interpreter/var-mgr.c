@@ -62,7 +62,7 @@ struct pcvarmgr_named_variables_observe {
     pcvdom_element_t elem;
 };
 
-static purc_variant_t
+purc_variant_t
 pcvarmgr_build_event_observed(const char *name, pcvarmgr_t mgr)
 {
     purc_variant_t v = purc_variant_make_object(0, PURC_VARIANT_INVALID,
@@ -127,14 +127,8 @@ static bool mgr_grow_handler(purc_variant_t source, pcvar_op_t msg_type,
     pcvarmgr_t mgr = (pcvarmgr_t)ctxt;
 
     const char* name = purc_variant_get_string_const(argv[0]);
-    purc_variant_t dest = pcvarmgr_build_event_observed(name, mgr);
-    if (dest) {
-        pcintr_coroutine_post_event(stack->co->cid,
-                PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY,
-                dest, MSG_TYPE_CHANGE, MSG_SUB_TYPE_ATTACHED,
-                PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
-        purc_variant_unref(dest);
-    }
+    pcintr_post_named_var_change(stack->co->cid, mgr, name,
+            MSG_SUB_TYPE_ATTACHED);
 
     return true;
 }
@@ -154,14 +148,8 @@ static bool mgr_shrink_handler(purc_variant_t source, pcvar_op_t msg_type,
     pcvarmgr_t mgr = (pcvarmgr_t)ctxt;
 
     const char* name = purc_variant_get_string_const(argv[0]);
-    purc_variant_t dest = pcvarmgr_build_event_observed(name, mgr);
-    if (dest) {
-        pcintr_coroutine_post_event(stack->co->cid,
-                PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY,
-                dest, MSG_TYPE_CHANGE, MSG_SUB_TYPE_DETACHED,
-                PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
-        purc_variant_unref(dest);
-    }
+    pcintr_post_named_var_change(stack->co->cid, mgr, name,
+            MSG_SUB_TYPE_DETACHED);
 
     return true;
 }
@@ -181,26 +169,31 @@ static bool mgr_change_handler(purc_variant_t source, pcvar_op_t msg_type,
     pcvarmgr_t mgr = (pcvarmgr_t)ctxt;
 
     const char* name = purc_variant_get_string_const(argv[0]);
-    purc_variant_t dest = pcvarmgr_build_event_observed(name, mgr);
-    if (dest) {
-        pcintr_coroutine_post_event(stack->co->cid,
-                PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY,
-                dest, MSG_TYPE_CHANGE, MSG_SUB_TYPE_DISPLACED,
-                PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
-        purc_variant_unref(dest);
-    }
+    pcintr_post_named_var_change(stack->co->cid, mgr, name,
+            MSG_SUB_TYPE_DISPLACED);
 
     return true;
 }
 
+static inline void
+bump_vars_gen(void)
+{
+    struct pcintr_heap *heap = pcintr_get_heap();
+    if (heap) {
+        heap->vars_gen++;
+    }
+}
+
 static bool mgr_handler(purc_variant_t source, pcvar_op_t msg_type,
         void* ctxt, size_t nr_args, purc_variant_t* argv)
 {
     switch (msg_type) {
     case PCVAR_OPERATION_GROW:
+        bump_vars_gen();
         return mgr_grow_handler(source, msg_type, ctxt, nr_args, argv);
 
     case PCVAR_OPERATION_SHRINK:
+        bump_vars_gen();
         return mgr_shrink_handler(source, msg_type, ctxt, nr_args, argv);
 
     case PCVAR_OPERATION_CHANGE:
@@ -259,19 +252,150 @@ err_ret:
     return NULL;
 }
 
+static inline bool
+lazy_var_pending(const struct pcvarmgr_lazy_slot *lazy)
+{
+    return lazy->ctor || lazy->ctor_ex;
+}
+
+static void
+drop_lazy_var(struct pcvarmgr_lazy_slot *lazy)
+{
+    if (lazy->ctxt && lazy->free_ctxt)
+        lazy->free_ctxt(lazy->ctxt);
+
+    lazy->ctor = NULL;
+    lazy->ctor_ex = NULL;
+    lazy->ctxt = NULL;
+    lazy->free_ctxt = NULL;
+}
+
 int pcvarmgr_destroy(pcvarmgr_t mgr)
 {
     if (mgr) {
         PC_ASSERT(mgr->node.rb_parent == NULL);
+        /* the address of the manager may be taken by another one */
+        bump_vars_gen();
         if (mgr->listener) {
             purc_variant_revoke_listener(mgr->object, mgr->listener);
         }
         purc_variant_unref(mgr->object);
+        for (size_t i = 0; i < mgr->nr_lazy_vars; i++)
+            drop_lazy_var(mgr->lazy_vars + i);
+        free(mgr->lazy_vars);
         free(mgr);
     }
     return 0;
 }
 
+static struct pcvarmgr_lazy_slot *
+find_lazy_var(pcvarmgr_t mgr, const char* name)
+{
+    for (size_t i = 0; i < mgr->nr_lazy_vars; i++) {
+        struct pcvarmgr_lazy_slot *lazy = mgr->lazy_vars + i;
+        if (lazy_var_pending(lazy) && strcmp(lazy->name, name) == 0)
+            return lazy;
+    }
+
+    return NULL;
+}
+
+static struct pcvarmgr_lazy_slot *
+new_lazy_var(pcvarmgr_t mgr, const char* name)
+{
+    struct pcvarmgr_lazy_slot *lazy = find_lazy_var(mgr, name);
+    if (lazy) {
+        drop_lazy_var(lazy);
+    }
+    else {
+        lazy = realloc(mgr->lazy_vars,
+                sizeof(*lazy) * (mgr->nr_lazy_vars + 1));
+        if (lazy == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return NULL;
+        }
+
+        mgr->lazy_vars = lazy;
+        lazy += mgr->nr_lazy_vars++;
+        memset(lazy, 0, sizeof(*lazy));
+    }
+
+    /* the variable bound with the same name is replaced */
+    purc_variant_object_remove_by_ckey(mgr->object, name, true);
+    lazy->name = name;
+    return lazy;
+}
+
+bool pcvarmgr_add_lazy(pcvarmgr_t mgr, const char* name, pcvarmgr_ctor_f ctor)
+{
+    if (mgr == NULL || name == NULL || ctor == NULL) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        return false;
+    }
+
+    struct pcvarmgr_lazy_slot *lazy = new_lazy_var(mgr, name);
+    if (lazy == NULL)
+        return false;
+
+    lazy->ctor = ctor;
+    return true;
+}
+
+bool pcvarmgr_add_lazy_ex(pcvarmgr_t mgr, const char* name,
+        pcvarmgr_ctor_ex_f ctor_ex, void *ctxt,
+        pcvarmgr_free_ctxt_f free_ctxt)
+{
+    if (mgr == NULL || name == NULL || ctor_ex == NULL) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        return false;
+    }
+
+    struct pcvarmgr_lazy_slot *lazy = new_lazy_var(mgr, name);
+    if (lazy == NULL)
+        return false;
+
+    lazy->ctor_ex = ctor_ex;
+    lazy->ctxt = ctxt;
+    lazy->free_ctxt = free_ctxt;
+    return true;
+}
+
+static purc_variant_t
+make_lazy_var(pcvarmgr_t mgr, const char* name)
+{
+    struct pcvarmgr_lazy_slot *lazy = find_lazy_var(mgr, name);
+    if (lazy == NULL)
+        return PURC_VARIANT_INVALID;
+
+    /* NOTE: the constructor may access or bind the variables */
+    size_t idx = lazy - mgr->lazy_vars;
+    struct pcvarmgr_lazy_slot saved = *lazy;
+    lazy->ctor = NULL;
+    lazy->ctor_ex = NULL;
+
+    purc_variant_t v;
+    if (saved.ctor)
+        v = saved.ctor();
+    else
+        v = saved.ctor_ex(saved.ctxt);
+
+    lazy = mgr->lazy_vars + idx;
+    if (v == PURC_VARIANT_INVALID) {
+        lazy->ctor = saved.ctor;
+        lazy->ctor_ex = saved.ctor_ex;
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* NOTE: the name may be owned by the context or the caller */
+    bool ret = purc_variant_object_set_by_ckey(mgr->object, name, v);
+    purc_variant_unref(v);
+    drop_lazy_var(lazy);
+    if (!ret)
+        return PURC_VARIANT_INVALID;
+
+    return purc_variant_object_get_by_ckey(mgr->object, name);
+}
+
 bool pcvarmgr_add(pcvarmgr_t mgr, const char* name,
         purc_variant_t variant)
 {
@@ -285,6 +409,10 @@ bool pcvarmgr_add(pcvarmgr_t mgr, const char* name,
         return false;
     }
 
+    struct pcvarmgr_lazy_slot *lazy = find_lazy_var(mgr, name);
+    if (lazy)
+        drop_lazy_var(lazy);
+
     purc_variant_t k = purc_variant_make_string(name, true);
     if (k == PURC_VARIANT_INVALID) {
         return false;
@@ -329,6 +457,17 @@ purc_variant_t pcvarmgr_get(pcvarmgr_t mgr, const char* name)
         return v;
     }
 
+    if (mgr->nr_lazy_vars > 0) {
+        purc_clr_error();
+        v = make_lazy_var(mgr, name);
+        if (v) {
+            return v;
+        }
+        else if (purc_get_last_error()) {
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
     purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", name);
     return PURC_VARIANT_INVALID;
 }
@@ -336,6 +475,13 @@ purc_variant_t pcvarmgr_get(pcvarmgr_t mgr, const char* name)
 bool pcvarmgr_remove_ex(pcvarmgr_t mgr, const char* name, bool silently)
 {
     if (name) {
+        struct pcvarmgr_lazy_slot *lazy = find_lazy_var(mgr, name);
+        if (lazy) {
+            /* not made yet */
+            drop_lazy_var(lazy);
+            return true;
+        }
+
         return purc_variant_object_remove_by_ckey(mgr->object,
                 name, silently);
     }
@@ -578,6 +724,136 @@ pcintr_find_named_var(pcintr_stack_t stack, const char* name)
     return PURC_VARIANT_INVALID;
 }
 
+/*
+ * NOTE: the resolutions of the plain names referred by the get_variable
+ * nodes evaluated repeatedly, like `$x` in the body of an `iterate`, are
+ * cached in a direct-mapped table per coroutine, indexed by the stamp of
+ * the node.
+ *
+ * A slot keeps the variable manager in which the name was found, so that
+ * the variable is got by a single lookup instead of the walk over the
+ * scopes. The slot is valid as long as:
+ *
+ *  - the generation of the heap is not changed: it is bumped whenever a
+ *    name is added to or removed from a variable manager, for example by
+ *    pcvarmgr_add() or pcintr_unbind_named_var(), and when a manager is
+ *    destroyed;
+ *  - the bottom frame has the same position and scope, and its parent is
+ *    the same frame (by the serial), so the frames walked are the same.
+ *
+ * The temporary variables are always looked up first, since they are
+ * changed without any notification.
+ */
+#define NR_VAR_SLOTS            64
+
+struct pcintr_var_slot {
+    uint64_t                stamp;      /* the stamp of the vcm node */
+    uint64_t                parent_serial;
+    pcvdom_element_t        pos;
+    pcvdom_element_t        scope;
+    pcvarmgr_t              mgr;        /* where the name was found */
+    uint32_t                gen;
+};
+
+struct pcintr_var_slot *
+pcintr_get_var_slots(pcintr_stack_t stack)
+{
+    pcintr_coroutine_t co = stack->co;
+    if (co->var_slots == NULL) {
+        co->var_slots = calloc(NR_VAR_SLOTS, sizeof(struct pcintr_var_slot));
+    }
+    return co->var_slots;
+}
+
+void
+pcintr_var_slots_destroy(struct pcintr_var_slot *slots)
+{
+    free(slots);
+}
+
+/* the same as pcintr_find_named_var() but the temporary variables */
+static purc_variant_t
+find_named_var_and_mgr(pcintr_stack_t stack,
+        struct pcintr_stack_frame *frame, const char* name, pcvarmgr_t *mgr)
+{
+    purc_coroutine_t cor = stack->co;
+    purc_variant_t v;
+
+    v = _find_named_scope_var(cor, frame, name, mgr);
+    if (v) {
+        return v;
+    }
+
+    v = _find_named_root(cor, frame, name);
+    if (v) {
+        *mgr = pcintr_get_scope_variables(cor,
+                pcvdom_document_get_root(cor->vdom));
+        return v;
+    }
+
+    v = find_cor_level_var(cor, name);
+    if (v) {
+        *mgr = cor->variables;
+        return v;
+    }
+
+    v = find_inst_var(name);
+    if (v) {
+        *mgr = pcinst_get_variables();
+        return v;
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
+purc_variant_t
+pcintr_find_named_var_cached(pcintr_stack_t stack, const char* name,
+        struct pcintr_var_slot *slots, uint64_t stamp)
+{
+    struct pcintr_stack_frame* frame = pcintr_stack_get_bottom_frame(stack);
+    PC_ASSERT(frame);
+
+    purc_variant_t v;
+    v = _find_named_temp_var(frame, name);
+    if (v) {
+        purc_clr_error();
+        return v;
+    }
+
+    struct pcintr_stack_frame *parent = pcintr_stack_frame_get_parent(frame);
+    uint64_t parent_serial = parent ? parent->serial : 0;
+    uint32_t gen = stack->co->owner->vars_gen;
+
+    struct pcintr_var_slot *slot = slots + (stamp % NR_VAR_SLOTS);
+    if (slot->stamp == stamp && slot->gen == gen &&
+            slot->pos == frame->pos && slot->scope == frame->scope &&
+            slot->parent_serial == parent_serial) {
+        v = purc_variant_object_get_by_ckey(slot->mgr->object, name);
+        if (v) {
+            purc_clr_error();
+            return v;
+        }
+    }
+
+    pcvarmgr_t mgr = NULL;
+    v = find_named_var_and_mgr(stack, frame, name, &mgr);
+    if (v) {
+        if (mgr) {
+            slot->stamp = stamp;
+            slot->gen = gen;
+            slot->pos = frame->pos;
+            slot->scope = frame->scope;
+            slot->parent_serial = parent_serial;
+            slot->mgr = mgr;
+        }
+        purc_clr_error();
+        return v;
+    }
+
+    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", name);
+    return PURC_VARIANT_INVALID;
+}
+
 enum purc_symbol_var _to_symbol(char symbol)
 {
     switch (symbol) {
@@ -169,19 +169,24 @@ add_runner_myobj_listener(purc_variant_t runner)
     return ret;
 }
 
+/* the built-in dynamic objects made on the first access */
+static const struct pcvarmgr_lazy_var lazy_dvobjs[] = {
+    { PURC_PREDEF_VARNAME_SYS,          purc_dvobj_system_new },
+    { PURC_PREDEF_VARNAME_L,            purc_dvobj_logical_new },
+    { PURC_PREDEF_VARNAME_STR,          purc_dvobj_string_new },
+    { PURC_PREDEF_VARNAME_URL,          purc_dvobj_url_new },
+    { PURC_PREDEF_VARNAME_DATA,         purc_dvobj_data_new },
+    { PURC_PREDEF_VARNAME_STREAM,       purc_dvobj_stream_new },
+    { PURC_PREDEF_VARNAME_DATETIME,     purc_dvobj_datetime_new },
+    { PURC_PREDEF_VARNAME_RDR,          purc_dvobj_rdr_new },
+};
+
 bool
 pcintr_bind_builtin_runner_variables(void)
 {
     bool ret = false;
     purc_variant_t runner = PURC_VARIANT_INVALID;
 
-    // $SYS
-    purc_variant_t sys = purc_dvobj_system_new();
-    if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_SYS, sys)) {
-        goto out;
-    }
-    purc_variant_unref(sys);
-
     // $RUNNER
     runner = purc_dvobj_runner_new();
     if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_RUNNER, runner)) {
@@ -194,57 +199,15 @@ pcintr_bind_builtin_runner_variables(void)
     }
 #endif
 
-    /* $L, $STR, $URL, $DATA, $STREAM, $DATETIME
-     * are all runner-level variables */
-
-    // $L
-    purc_variant_t l = purc_dvobj_logical_new();
-    if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_L, l)) {
-        goto out;
+    /* $SYS, $L, $STR, $URL, $DATA, $STREAM, $DATETIME, $RDR
+     * are all runner-level variables, and made on the first access */
+    pcvarmgr_t varmgr = pcinst_get_variables();
+    for (size_t i = 0; i < PCA_TABLESIZE(lazy_dvobjs); i++) {
+        if (!pcvarmgr_add_lazy(varmgr, lazy_dvobjs[i].name,
+                    lazy_dvobjs[i].ctor)) {
+            goto out;
+        }
     }
-    purc_variant_unref(l);
-
-    // $STR
-    purc_variant_t str = purc_dvobj_string_new();
-    if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_STR, str)) {
-        goto out;
-    }
-    purc_variant_unref(str);
-
-    // $URL
-    purc_variant_t url = purc_dvobj_url_new();
-    if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_URL, url)) {
-        goto out;
-    }
-    purc_variant_unref(url);
-
-    // $DATA
-    purc_variant_t data = purc_dvobj_data_new();
-    if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_DATA, data)) {
-        goto out;
-    }
-    purc_variant_unref(data);
-
-    // $STREAM
-    purc_variant_t stream = purc_dvobj_stream_new();
-    if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_STREAM, stream)) {
-        goto out;
-    }
-    purc_variant_unref(stream);
-
-    // $DATETIME
-    purc_variant_t dt = purc_dvobj_datetime_new();
-    if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_DATETIME, dt)) {
-        goto out;
-    }
-    purc_variant_unref(dt);
-
-    // $RDR
-    purc_variant_t rdr = purc_dvobj_rdr_new();
-    if (!purc_bind_runner_variable(PURC_PREDEF_VARNAME_RDR, rdr)) {
-        goto out;
-    }
-    purc_variant_unref(rdr);
 
     ret = add_runner_myobj_listener(runner);
 
@@ -255,3 +218,28 @@ out:
     return ret;
 }
 
+bool
+pcintr_reset_runner_variables(void)
+{
+    struct pcinst *inst = pcinst_current();
+    PC_ASSERT(inst);
+
+    if (inst->variables) {
+        pcvarmgr_destroy(inst->variables);
+        inst->variables = NULL;
+    }
+
+    /* the dynamic objects loaded by `load` are bound to the variables */
+    if (inst->dvobjs) {
+        size_t nr = pcutils_array_length(inst->dvobjs);
+        for (size_t i = 0; i < nr; i++) {
+            purc_variant_t v = pcutils_array_get(inst->dvobjs, i);
+            purc_variant_unload_dvobj(v);
+        }
+        pcutils_array_destroy(inst->dvobjs, true);
+        inst->dvobjs = NULL;
+    }
+
+    pcinst_clear_error(inst);
+    return pcintr_bind_builtin_runner_variables();
+}
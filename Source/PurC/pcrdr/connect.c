@@ -29,6 +29,7 @@
 #include "private/kvlist.h"
 #include "private/debug.h"
 #include "private/utils.h"
+#include "private/trace.h"
 #include "connect.h"
 
 #include <stdio.h>
@@ -158,13 +159,87 @@ int pcrdr_conn_set_poll_timeout(pcrdr_conn* conn, int timeout_ms)
 
 size_t pcrdr_conn_pending_requests_count(pcrdr_conn* conn)
 {
-    size_t n = 0;
-    struct pending_request *pr;
-    list_for_each_entry(pr, &conn->pending_requests, list) {
-        n++;
+    return conn->nr_pending_requests;
+}
+
+static int
+time_expected_comp(const void *k1, const void *k2, void *ptr)
+{
+    (void)ptr;
+    time_t t1 = *(const time_t *)k1;
+    time_t t2 = *(const time_t *)k2;
+
+    if (t1 < t2)
+        return -1;
+    return (t1 > t2) ? 1 : 0;
+}
+
+/*
+ * NOTE: the list keeps the order of the pending requests, the map finds
+ * the request matching a response, and the AVL tree finds the requests
+ * timed out; all the three share the same pending request.
+ */
+static int
+add_pending_request(pcrdr_conn *conn, struct pending_request *pr,
+        bool at_head)
+{
+    if (conn->pending_map == NULL) {
+        conn->pending_map = pcutils_uomap_create(NULL, NULL, NULL, NULL,
+                NULL, comp_key_string, false, false);
+        if (conn->pending_map == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+
+        pcutils_avl_init(&conn->pending_avl, time_expected_comp, true, NULL);
     }
 
-    return n;
+    const char *request_id = purc_variant_get_string_const(pr->request_id);
+    if (pcutils_uomap_replace_or_insert(conn->pending_map,
+                request_id, pr, NULL)) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    pr->avl.key = &pr->time_expected;
+    pcutils_avl_insert(&conn->pending_avl, &pr->avl);
+
+    if (at_head)
+        list_add(&pr->list, &conn->pending_requests);
+    else
+        list_add_tail(&pr->list, &conn->pending_requests);
+    conn->nr_pending_requests++;
+    return 0;
+}
+
+static struct pending_request *
+find_pending_request(pcrdr_conn *conn, const char *request_id)
+{
+    if (conn->pending_map == NULL)
+        return NULL;
+
+    pcutils_uomap_entry *entry;
+    entry = pcutils_uomap_find(conn->pending_map, request_id);
+    return entry ? pcutils_uomap_entry_val(entry) : NULL;
+}
+
+static void
+remove_pending_request(pcrdr_conn *conn, struct pending_request *pr)
+{
+    const char *request_id = purc_variant_get_string_const(pr->request_id);
+    pcutils_uomap_entry *entry;
+
+    /* the entry may have been replaced by a request with the same id */
+    entry = pcutils_uomap_find(conn->pending_map, request_id);
+    if (entry && pcutils_uomap_entry_val(entry) == pr)
+        pcutils_uomap_erase_entry_nolock(conn->pending_map, entry);
+
+    pcutils_avl_delete(&conn->pending_avl, &pr->avl);
+    list_del(&pr->list);
+    conn->nr_pending_requests--;
+
+    purc_variant_unref(pr->request_id);
+    free(pr);
 }
 
 int pcrdr_free_connection(pcrdr_conn* conn)
@@ -186,11 +261,15 @@ int pcrdr_free_connection(pcrdr_conn* conn)
                     purc_variant_get_string_const(pr->request_id),
                     PCRDR_RESPONSE_CANCELLED, pr->context, NULL);
         }
-        list_del(&pr->list);
-        purc_variant_unref(pr->request_id);
-        free(pr);
+        remove_pending_request(conn, pr);
     }
 
+    if (conn->pending_map)
+        pcutils_uomap_destroy(conn->pending_map);
+    if (conn->recv_buf)
+        free(conn->recv_buf);
+    if (conn->send_buf)
+        free(conn->send_buf);
     free(conn);
 
     return 0;
@@ -259,7 +338,12 @@ pcrdr_set_handler_for_response_from_extra_source(pcrdr_conn* conn,
         pr->time_expected = purc_get_monotoic_time() + 3600;
     else
         pr->time_expected = purc_get_monotoic_time() + seconds_expected;
-    list_add_tail(&pr->list, &conn->pending_requests);
+
+    if (add_pending_request(conn, pr, false)) {
+        purc_variant_unref(pr->request_id);
+        free(pr);
+        return -1;
+    }
 
     return 0;
 }
@@ -276,7 +360,10 @@ int pcrdr_send_request(pcrdr_conn* conn, pcrdr_msg *request_msg,
     }
 
     conn->stats.nr_requests_sent++;
-    if (conn->send_message(conn, request_msg) < 0) {
+    uint64_t span = pctrace_begin();
+    int ret = conn->send_message(conn, request_msg);
+    pctrace_end(span, PCTRACE_CAT_RDR, "send_request");
+    if (ret < 0) {
         return -1;
     }
 
@@ -317,15 +404,12 @@ static int
 handle_response_message(pcrdr_conn* conn, const pcrdr_msg *msg)
 {
     int retval = -1;
+    const char *request_id = purc_variant_get_string_const(msg->requestId);
 
     if (!list_empty(&conn->pending_requests)) {
-        struct pending_request *pr;
-        pr = list_first_entry(&conn->pending_requests,
-                struct pending_request, list);
+        struct pending_request *pr = find_pending_request(conn, request_id);
 
-        if (variant_strcmp(msg->requestId, pr->request_id) == 0) {
-            const char *request_id =
-                purc_variant_get_string_const(msg->requestId);
+        if (pr) {
             if (pr->response_handler && pr->response_handler(conn,
                         request_id,
                         PCRDR_RESPONSE_RESULT, pr->context, msg) < 0) {
@@ -334,18 +418,15 @@ handle_response_message(pcrdr_conn* conn, const pcrdr_msg *msg)
             }
 
             retval = 0;
-            list_del(&pr->list);
-            purc_variant_unref(pr->request_id);
-            free(pr);
+            remove_pending_request(conn, pr);
         }
-        else if (strcmp("-",
-                    purc_variant_get_string_const(msg->requestId))== 0) {
+        else if (strcmp("-", request_id) == 0) {
             /* FIXME: */
             purc_log_warn("ignore noreturn request\n");
             retval = 0;
         }
         else {
-            purc_log_error("response not matched the first pending request\n");
+            purc_log_error("response not matched any pending request\n");
             purc_set_error(PCRDR_ERROR_UNEXPECTED);
         }
     }
@@ -360,21 +441,23 @@ handle_response_message(pcrdr_conn* conn, const pcrdr_msg *msg)
 static int
 check_timeout_requests(pcrdr_conn *conn)
 {
+    if (conn->pending_map == NULL || avl_is_empty(&conn->pending_avl))
+        return 0;
+
     struct pending_request *pr, *n;
     time_t now = purc_get_monotoic_time();
 
-    list_for_each_entry_safe(pr, n, &conn->pending_requests, list) {
-        if (now >= pr->time_expected) {
-            if (pr->response_handler) {
-                pr->response_handler(conn,
-                    purc_variant_get_string_const(pr->request_id),
-                        PCRDR_RESPONSE_TIMEOUT, pr->context, NULL);
-            }
+    avl_for_each_element_safe(&conn->pending_avl, pr, avl, n) {
+        if (now < pr->time_expected)
+            break;
 
-            list_del(&pr->list);
-            purc_variant_unref(pr->request_id);
-            free(pr);
+        if (pr->response_handler) {
+            pr->response_handler(conn,
+                purc_variant_get_string_const(pr->request_id),
+                    PCRDR_RESPONSE_TIMEOUT, pr->context, NULL);
         }
+
+        remove_pending_request(conn, pr);
     }
 
     return 0;
@@ -482,6 +565,7 @@ int pcrdr_read_and_dispatch_message(pcrdr_conn *conn)
 int pcrdr_wait_and_dispatch_message(pcrdr_conn* conn, int timeout_ms)
 {
     int retval;
+    uint64_t span = pctrace_begin();
 
     /* check extra source first */
     if (conn->source_fn) {
@@ -506,6 +590,7 @@ int pcrdr_wait_and_dispatch_message(pcrdr_conn* conn, int timeout_ms)
     }
 
     check_timeout_requests(conn);
+    pctrace_end(span, PCTRACE_CAT_RDR, "wait_and_dispatch_message");
     return retval;
 }
 
@@ -553,7 +638,11 @@ pcrdr_wait_response_for_specific_request(pcrdr_conn* conn,
         pr->time_expected = purc_get_monotoic_time() + 3600;
     else
         pr->time_expected = purc_get_monotoic_time() + seconds_expected;
-    list_add(&pr->list, &conn->pending_requests);
+    if (add_pending_request(conn, pr, true)) {
+        purc_variant_unref(pr->request_id);
+        free(pr);
+        return -1;
+    }
 
     while (*response_msg == NULL) {
         pcrdr_msg *msg;
@@ -603,9 +692,7 @@ pcrdr_wait_response_for_specific_request(pcrdr_conn* conn,
     }
 
     if (*response_msg == NULL) {
-        list_del(&pr->list);
-        purc_variant_unref(pr->request_id);
-        free(pr);
+        remove_pending_request(conn, pr);
     }
     else if (*response_msg == MSG_POINTER_INVALID) {
         *response_msg = NULL;   /* reset response messge to NULL */
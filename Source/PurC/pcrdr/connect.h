@@ -31,11 +31,15 @@
 
 #include "purc-pcrdr.h"
 #include "private/list.h"
+#include "private/avl.h"
+#include "private/map.h"
 
 #include "purc.h"
 
 struct pending_request {
     struct list_head        list;
+    /* the AVL node for the tree sorted by the expected time */
+    struct avl_node         avl;
 
     purc_variant_t          request_id;
     pcrdr_response_handler  response_handler;
@@ -64,6 +68,11 @@ struct pcrdr_conn {
     int type;
     int fd;
     int timeout_ms;
+    /* whether to send the messages in the binary framing */
+    int binary_framing;
+    /* whether to compress the packets not smaller than
+       PCRDR_MIN_SIZE_COMPRESSION */
+    int compression;
 
     char* srv_host_name;
     char* own_host_name;
@@ -80,6 +89,13 @@ struct pcrdr_conn {
     pcrdr_extra_message_source source_fn;
     void *source_ctxt; /* context for extra message source */
 
+    /* the receive buffer reused for the packets */
+    char *recv_buf;
+    size_t sz_recv_buf;
+    /* the send buffer reused for masking the WebSocket payloads */
+    char *send_buf;
+    size_t sz_send_buf;
+
     char *sticky;       /* websocket sticky package after receive handshake */
     char *sticky_pos;
     size_t nr_sticky;
@@ -89,6 +105,12 @@ struct pcrdr_conn {
 
     /* the pending requests queue */
     struct list_head pending_requests;
+    size_t nr_pending_requests;
+    /* request identifier -> pending request; created on demand */
+    pcutils_uomap *pending_map;
+    /* the pending requests sorted by the expected time;
+       initialized along with the map */
+    struct avl_tree pending_avl;
 
     /* operations */
     int (*wait_message) (pcrdr_conn* conn, int timeout_ms);
@@ -129,9 +129,18 @@ struct result_info {
 };
 
 struct pcrdr_prot_data {
-    // FILE pointer to serialize the message.
+    // FILE pointer to serialize the message; NULL in the null mode.
     FILE                *fp;
 
+    // whether to acknowledge every request without any state or log.
+    bool                 null_mode;
+
+    // the last handle made in the null mode.
+    uint64_t             last_handle;
+
+    // the numbers of the requests by operation.
+    uint64_t             nr_requests[PCRDR_NR_OPERATIONS];
+
     // requestId -> results;
     struct pcutils_kvlist        results;
 
@@ -160,9 +169,17 @@ static struct result_info *result_of_first_request(pcrdr_conn* conn)
     return *data;
 }
 
+static bool has_response(pcrdr_conn* conn)
+{
+    if (conn->prot_data->null_mode)
+        return !list_empty(&conn->pending_requests);
+
+    return result_of_first_request(conn) != NULL;
+}
+
 static int my_wait_message(pcrdr_conn* conn, int timeout_ms)
 {
-    if (result_of_first_request(conn) == NULL) {
+    if (!has_response(conn)) {
         if (timeout_ms > 1000) {
             pcutils_sleep(timeout_ms / 1000);
         }
@@ -205,11 +222,35 @@ static ssize_t write_recv_to_log(void *ctxt, const void *buf, size_t count)
     return -1;
 }
 
+/* acknowledges the first request with a new handle in the null mode */
+static pcrdr_msg *read_null_message(pcrdr_conn* conn)
+{
+    if (list_empty(&conn->pending_requests)) {
+        purc_set_error(PCRDR_ERROR_UNEXPECTED);
+        return NULL;
+    }
+
+    struct pending_request *pr;
+    pr = list_first_entry(&conn->pending_requests,
+            struct pending_request, list);
+
+    pcrdr_msg *msg = pcrdr_make_response_message(
+            purc_variant_get_string_const(pr->request_id), NULL,
+            PCRDR_SC_OK, ++conn->prot_data->last_handle,
+            PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+    if (msg == NULL)
+        purc_set_error(PCRDR_ERROR_NOMEM);
+    return msg;
+}
+
 static pcrdr_msg *my_read_message(pcrdr_conn* conn)
 {
     pcrdr_msg* msg = NULL;
     struct result_info *result;
 
+    if (conn->prot_data->null_mode)
+        return read_null_message(conn);
+
     if ((result = result_of_first_request(conn)) == NULL) {
         purc_log_warn("There is not any result for the first request.\n");
         purc_set_error(PCRDR_ERROR_UNEXPECTED);
@@ -1795,24 +1836,33 @@ _COMPILE_TIME_ASSERT(ops,
         PCA_TABLESIZE(handlers) == PCRDR_NR_OPERATIONS);
 #undef _COMPILE_TIME_ASSERT
 
+/* gets the identifier of the operation of a request and counts it */
+static bool count_request(struct pcrdr_prot_data *prot_data,
+        const pcrdr_msg *msg, unsigned int *op_id)
+{
+    purc_atom_t op_atom;
+
+    op_atom = pcrdr_check_operation(
+            purc_variant_get_string_const(msg->operation));
+    if (op_atom == 0)
+        return false;
+
+    if (pcrdr_operation_from_atom(op_atom, op_id) == NULL)
+        return false;
+
+    prot_data->nr_requests[*op_id]++;
+    return true;
+}
+
 static int evaluate_result(struct pcrdr_prot_data *prot_data,
         const pcrdr_msg *msg)
 {
-    purc_atom_t op_atom;
     struct result_info *result;
 
     result = calloc(1, sizeof(*result));
 
-    op_atom = pcrdr_check_operation(
-            purc_variant_get_string_const(msg->operation));
-    if (op_atom == 0) {
-        result->retCode = PCRDR_SC_BAD_REQUEST;
-        result->resultValue = 0;
-        goto done;
-    }
-
     unsigned int op_id;
-    if (pcrdr_operation_from_atom(op_atom, &op_id) == NULL) {
+    if (!count_request(prot_data, msg, &op_id)) {
         result->retCode = PCRDR_SC_BAD_REQUEST;
         result->resultValue = 0;
         goto done;
@@ -1830,6 +1880,12 @@ done:
 
 static int my_send_message(pcrdr_conn* conn, pcrdr_msg *msg)
 {
+    if (conn->prot_data->null_mode) {
+        unsigned int op_id;
+        count_request(conn->prot_data, msg, &op_id);
+        return 0;
+    }
+
     fputs(">>>STT\n", conn->prot_data->fp);
     if (pcrdr_serialize_message(msg, (pcrdr_cb_write)write_sent_to_log,
                 conn) < 0) {
@@ -1865,7 +1921,8 @@ static int my_disconnect(pcrdr_conn* conn)
     }
 
     pcutils_kvlist_cleanup(&conn->prot_data->results);
-    fclose(conn->prot_data->fp);
+    if (conn->prot_data->fp)
+        fclose(conn->prot_data->fp);
     if (conn->prot_data->session)
         free(conn->prot_data->session);
     free(conn->prot_data);
@@ -1874,11 +1931,22 @@ static int my_disconnect(pcrdr_conn* conn)
 
 #define SCHEMA_LOCAL_FILE  "file://"
 
+const uint64_t *pcrdr_headless_request_counts(pcrdr_conn* conn)
+{
+    if (conn == NULL || conn->prot != PURC_RDRCOMM_HEADLESS) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    return conn->prot_data->nr_requests;
+}
+
 pcrdr_msg *pcrdr_headless_connect(const char* renderer_uri,
         const char* app_name, const char* runner_name, pcrdr_conn** conn)
 {
     char buff[PATH_MAX + 1];
     const char *logfile;
+    const char *query;
     pcrdr_msg *msg = NULL;
     int err_code = PCRDR_ERROR_NOMEM;
 
@@ -1904,8 +1972,29 @@ pcrdr_msg *pcrdr_headless_connect(const char* renderer_uri,
         goto failed;
     }
 
-    if (renderer_uri && strlen(renderer_uri) > sizeof(SCHEMA_LOCAL_FILE)) {
-        logfile = renderer_uri + sizeof(SCHEMA_LOCAL_FILE) - 1;
+    if (renderer_uri && (query = strchr(renderer_uri, '?'))) {
+        if (strcmp(query + 1, PCRDR_HEADLESS_NULL_MODE_OPTION) == 0) {
+            (*conn)->prot_data->null_mode = true;
+        }
+        else {
+            PC_WARN("Unknown option of the headless renderer: %s\n", query);
+        }
+    }
+    else {
+        query = renderer_uri ? renderer_uri + strlen(renderer_uri) : NULL;
+    }
+
+    if (renderer_uri && (size_t)(query - renderer_uri) >
+            sizeof(SCHEMA_LOCAL_FILE)) {
+        size_t len = query - renderer_uri - (sizeof(SCHEMA_LOCAL_FILE) - 1);
+        if (len > PATH_MAX) {
+            purc_set_error(PURC_ERROR_TOO_SMALL_BUFF);
+            goto failed;
+        }
+
+        memcpy(buff, renderer_uri + sizeof(SCHEMA_LOCAL_FILE) - 1, len);
+        buff[len] = 0;
+        logfile = buff;
     }
     else {
         int n = snprintf(buff, sizeof(buff),
@@ -1923,8 +2012,11 @@ pcrdr_msg *pcrdr_headless_connect(const char* renderer_uri,
         logfile = buff;
     }
 
-    (*conn)->prot_data->fp = fopen(logfile, "a");
-    if ((*conn)->prot_data->fp == NULL) {
+    /* NOTE: no log in the null mode; nothing is serialized. */
+    if ((*conn)->prot_data->null_mode) {
+        (*conn)->prot_data->fp = NULL;
+    }
+    else if (((*conn)->prot_data->fp = fopen(logfile, "a")) == NULL) {
         purc_set_error(PURC_ERROR_BAD_STDC_CALL);
         goto failed;
     }
@@ -1939,7 +2031,7 @@ pcrdr_msg *pcrdr_headless_connect(const char* renderer_uri,
         purc_set_error(PCRDR_ERROR_NOMEM);
         goto failed;
     }
-    else {
+    else if ((*conn)->prot_data->fp) {
         fputs("<<<STT\n", (*conn)->prot_data->fp);
         pcrdr_serialize_message(msg, (pcrdr_cb_write)write_recv_to_log,
                 (*conn));
@@ -33,6 +33,7 @@
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
+#include <zlib.h>
 
 pcrdr_msg *pcrdr_make_void_message(void)
 {
@@ -702,7 +703,11 @@ found:
     return key_ops[mid].op;
 }
 
-int pcrdr_parse_packet(char *packet, size_t sz_packet, pcrdr_msg **msg_out)
+/* the min size of a text data for which the packet buffer is taken over */
+#define MIN_SIZE_TAKING_BUFF    PCRDR_DEF_PACKET_BUFF_SIZE
+
+int pcrdr_parse_packet_in_buffer(char *packet, size_t sz_buff,
+        size_t sz_packet, pcrdr_msg **msg_out, bool *buff_taken)
 {
     pcrdr_msg *msg;
 
@@ -711,7 +716,8 @@ int pcrdr_parse_packet(char *packet, size_t sz_packet, pcrdr_msg **msg_out)
     char *saveptr1;
     char *data;
 
-    UNUSED_PARAM(sz_packet);
+    if (buff_taken)
+        *buff_taken = false;
 
     if ((msg = pcinst_get_message()) == NULL) {
         purc_set_error(PCRDR_ERROR_NOMEM);
@@ -769,6 +775,21 @@ int pcrdr_parse_packet(char *packet, size_t sz_packet, pcrdr_msg **msg_out)
             goto failed;
         }
     }
+    else if (buff_taken && sz_buff > 0 &&
+            msg->__data_len >= MIN_SIZE_TAKING_BUFF &&
+            data + msg->__data_len < packet + sz_packet) {
+        /* NOTE: move the text to the head of the buffer and take it over,
+           for a variant can not refer to a slice of a buffer. */
+        memmove(packet, data, msg->__data_len);
+        packet[msg->__data_len] = '\0';
+
+        /* the buffer may be reallocated even if failed */
+        *buff_taken = true;
+        msg->data = purc_variant_make_string_reuse_buff(packet, sz_buff, true);
+        if (msg->data == NULL) {
+            goto failed;
+        }
+    }
     else {  /* for other text types */
         // FIXME: check __data_len ???
         assert(data != NULL /* && msg->__data_len > 0 */);
@@ -792,6 +813,11 @@ failed:
     return -1;
 }
 
+int pcrdr_parse_packet(char *packet, size_t sz_packet, pcrdr_msg **msg_out)
+{
+    return pcrdr_parse_packet_in_buffer(packet, 0, sz_packet, msg_out, NULL);
+}
+
 #define LEN_BUFF_LONGLONGINT    128
 
 static int
@@ -1098,6 +1124,288 @@ size_t pcrdr_serialize_message_to_buffer(const pcrdr_msg *msg,
     return buff_info.n;
 }
 
+/*
+ * The binary framing of a message: a fixed header of 56 bytes
+ * with the integers in little endian, followed by the strings, in the
+ * order of operation (or event name), request identifier, source URI,
+ * element value, and property, without the terminating null characters,
+ * then followed by the data. A zero length means the string is absent.
+ *
+ * The data in JSON type are serialized by purc_variant_serialize_binary();
+ * the data in other types are the text.
+ */
+#define BIN_MAGIC               "\x7fPCB"
+#define BIN_HEADER_SIZE         56
+#define BIN_NR_STRINGS          5
+
+static inline void put_u32(unsigned char *p, uint32_t u)
+{
+    p[0] = (unsigned char)u;
+    p[1] = (unsigned char)(u >> 8);
+    p[2] = (unsigned char)(u >> 16);
+    p[3] = (unsigned char)(u >> 24);
+}
+
+static inline void put_u64(unsigned char *p, uint64_t u)
+{
+    put_u32(p, (uint32_t)u);
+    put_u32(p + 4, (uint32_t)(u >> 32));
+}
+
+static inline uint32_t get_u32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+        ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t get_u64(const unsigned char *p)
+{
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+bool pcrdr_is_binary_packet(const void *packet, size_t sz_packet)
+{
+    return sz_packet >= BIN_HEADER_SIZE &&
+        memcmp(packet, BIN_MAGIC, sizeof(BIN_MAGIC) - 1) == 0;
+}
+
+int pcrdr_serialize_message_binary(const pcrdr_msg *msg,
+        pcrdr_cb_write fn, void *ctxt)
+{
+    const char *strs[BIN_NR_STRINGS];
+    size_t lens[BIN_NR_STRINGS];
+    const char *data = NULL;
+    size_t data_len = 0;
+    char *data_alloc = NULL;
+
+    /* the order matches the one of the variants in the message */
+    for (int i = 0; i < BIN_NR_STRINGS; i++) {
+        strs[i] = NULL;
+        lens[i] = 0;
+        if (msg->variants[i])
+            strs[i] = purc_variant_get_string_const_ex(msg->variants[i],
+                    &lens[i]);
+
+        if (strs[i] == NULL)
+            lens[i] = 0;
+    }
+
+    if (msg->dataType == PCRDR_MSG_DATA_TYPE_VOID) {
+        // do nothing
+    }
+    else if (msg->dataType == PCRDR_MSG_DATA_TYPE_JSON) {
+        purc_rwstream_t buffer = purc_rwstream_new_buffer(
+                PCRDR_MIN_PACKET_BUFF_SIZE, PCRDR_MAX_INMEM_PAYLOAD_SIZE);
+        if (buffer == NULL)
+            return PCRDR_ERROR_NOMEM;
+
+        if (purc_variant_serialize_binary(msg->data, buffer) < 0) {
+            purc_rwstream_destroy(buffer);
+            return purc_get_last_error();
+        }
+
+        data_alloc = purc_rwstream_get_mem_buffer_ex(buffer, &data_len,
+                NULL, true);
+        data = data_alloc;
+        purc_rwstream_destroy(buffer);
+    }
+    else {
+        assert(msg->data != NULL);
+        data = purc_variant_get_string_const_ex(msg->data, &data_len);
+        if (msg->textLen > 0)   /* override by textLen */
+            data_len = msg->textLen;
+    }
+
+    unsigned char header[BIN_HEADER_SIZE] = { 0 };
+    memcpy(header, BIN_MAGIC, sizeof(BIN_MAGIC) - 1);
+    header[4] = PCRDR_BINARY_FRAMING_VERSION;
+    header[5] = (unsigned char)msg->type;
+    header[6] = (unsigned char)msg->target;
+    header[7] = (unsigned char)msg->elementType;
+    header[8] = (unsigned char)msg->dataType;
+    header[9] = (unsigned char)msg->reduceOpt;
+    put_u32(header + 12, msg->retCode);
+    put_u64(header + 16, msg->targetValue);
+    put_u64(header + 24, msg->resultValue);
+    for (int i = 0; i < BIN_NR_STRINGS; i++)
+        put_u32(header + 32 + i * 4, (uint32_t)lens[i]);
+    put_u32(header + 52, (uint32_t)data_len);
+
+    fn(ctxt, header, sizeof(header));
+    for (int i = 0; i < BIN_NR_STRINGS; i++) {
+        if (lens[i] > 0)
+            fn(ctxt, strs[i], lens[i]);
+    }
+
+    if (data && data_len > 0)
+        fn(ctxt, data, data_len);
+
+    if (data_alloc)
+        free(data_alloc);
+    return 0;
+}
+
+int pcrdr_parse_binary_packet(const void *packet, size_t sz_packet,
+        pcrdr_msg **msg_out)
+{
+    const unsigned char *p = packet;
+    pcrdr_msg *msg;
+
+    if (!pcrdr_is_binary_packet(packet, sz_packet) || p[4] != PCRDR_BINARY_FRAMING_VERSION ||
+            p[5] > PCRDR_MSG_TYPE_LAST || p[6] > PCRDR_MSG_TARGET_LAST ||
+            p[7] > PCRDR_MSG_ELEMENT_TYPE_LAST ||
+            p[8] > PCRDR_MSG_DATA_TYPE_LAST ||
+            p[9] > PCRDR_MSG_EVENT_REDUCE_OPT_LAST) {
+        purc_set_error(PCRDR_ERROR_BAD_MESSAGE);
+        return -1;
+    }
+
+    size_t lens[BIN_NR_STRINGS], total = BIN_HEADER_SIZE;
+    for (int i = 0; i < BIN_NR_STRINGS; i++) {
+        lens[i] = get_u32(p + 32 + i * 4);
+        total += lens[i];
+    }
+    size_t data_len = get_u32(p + 52);
+    total += data_len;
+    if (total > sz_packet) {
+        purc_set_error(PCRDR_ERROR_BAD_MESSAGE);
+        return -1;
+    }
+
+    if ((msg = pcinst_get_message()) == NULL) {
+        purc_set_error(PCRDR_ERROR_NOMEM);
+        return -1;
+    }
+
+    msg->type = p[5];
+    msg->target = p[6];
+    msg->elementType = p[7];
+    msg->dataType = p[8];
+    msg->reduceOpt = p[9];
+    msg->retCode = get_u32(p + 12);
+    msg->targetValue = get_u64(p + 16);
+    msg->resultValue = get_u64(p + 24);
+
+    const char *str = (const char *)p + BIN_HEADER_SIZE;
+    for (int i = 0; i < BIN_NR_STRINGS; i++) {
+        if (lens[i] > 0) {
+            msg->variants[i] = purc_variant_make_string_ex(str, lens[i], true);
+            if (msg->variants[i] == PURC_VARIANT_INVALID)
+                goto failed;
+            str += lens[i];
+        }
+    }
+
+    if (msg->dataType == PCRDR_MSG_DATA_TYPE_VOID) {
+        // do nothing
+    }
+    else if (msg->dataType == PCRDR_MSG_DATA_TYPE_JSON) {
+        purc_rwstream_t stm = purc_rwstream_new_from_mem((void *)str,
+                data_len);
+        if (stm == NULL)
+            goto failed;
+
+        msg->data = purc_variant_load_from_binary(stm);
+        purc_rwstream_destroy(stm);
+        if (msg->data == PURC_VARIANT_INVALID)
+            goto failed;
+    }
+    else {
+        msg->data = purc_variant_make_string_ex(str, data_len, true);
+        if (msg->data == PURC_VARIANT_INVALID)
+            goto failed;
+    }
+    msg->__data_len = data_len;
+
+    *msg_out = msg;
+    return 0;
+
+failed:
+    pcrdr_release_message(msg);
+    purc_set_error(PCRDR_ERROR_BAD_MESSAGE);
+    return -1;
+}
+
+/*
+ * A compressed packet: a header of 8 bytes, i.e., the magic and the size of
+ * the original packet in little endian, followed by the original packet,
+ * in either the text or the binary framing, compressed in the zlib format.
+ */
+#define ZIP_MAGIC               "\x7fPCZ"
+#define ZIP_HEADER_SIZE         8
+
+bool pcrdr_is_compressed_packet(const void *packet, size_t sz_packet)
+{
+    return sz_packet > ZIP_HEADER_SIZE &&
+        memcmp(packet, ZIP_MAGIC, sizeof(ZIP_MAGIC) - 1) == 0;
+}
+
+void *pcrdr_compress_packet(const void *packet, size_t sz_packet,
+        size_t *sz_compressed)
+{
+    if (sz_packet > UINT32_MAX) {
+        purc_set_error(PCRDR_ERROR_TOO_LARGE);
+        return NULL;
+    }
+
+    uLongf sz_dest = compressBound((uLong)sz_packet);
+    unsigned char *buf = malloc(ZIP_HEADER_SIZE + sz_dest);
+    if (buf == NULL) {
+        purc_set_error(PCRDR_ERROR_NOMEM);
+        return NULL;
+    }
+
+    if (compress2(buf + ZIP_HEADER_SIZE, &sz_dest, packet, (uLong)sz_packet,
+                Z_DEFAULT_COMPRESSION) != Z_OK) {
+        free(buf);
+        purc_set_error(PCRDR_ERROR_UNEXPECTED);
+        return NULL;
+    }
+
+    memcpy(buf, ZIP_MAGIC, sizeof(ZIP_MAGIC) - 1);
+    put_u32(buf + 4, (uint32_t)sz_packet);
+    *sz_compressed = ZIP_HEADER_SIZE + sz_dest;
+    return buf;
+}
+
+char *pcrdr_decompress_packet(const void *packet, size_t sz_packet,
+        size_t *sz_original)
+{
+    const unsigned char *p = packet;
+
+    if (!pcrdr_is_compressed_packet(packet, sz_packet)) {
+        purc_set_error(PCRDR_ERROR_BAD_MESSAGE);
+        return NULL;
+    }
+
+    /* NOTE: do not trust the size claimed by the peer blindly */
+    uLongf sz_dest = get_u32(p + 4);
+    if (sz_dest == 0 || sz_dest > PCRDR_MAX_INMEM_PAYLOAD_SIZE) {
+        purc_set_error(PCRDR_ERROR_TOO_LARGE);
+        return NULL;
+    }
+
+    /* one more byte for the terminating null character of a text packet */
+    char *buf = malloc(sz_dest + 1);
+    if (buf == NULL) {
+        purc_set_error(PCRDR_ERROR_NOMEM);
+        return NULL;
+    }
+
+    uLongf sz_claimed = sz_dest;
+    if (uncompress((Bytef *)buf, &sz_dest, p + ZIP_HEADER_SIZE,
+                (uLong)(sz_packet - ZIP_HEADER_SIZE)) != Z_OK ||
+            sz_dest != sz_claimed) {
+        free(buf);
+        purc_set_error(PCRDR_ERROR_BAD_MESSAGE);
+        return NULL;
+    }
+
+    buf[sz_dest] = '\0';
+    *sz_original = sz_dest;
+    return buf;
+}
+
 struct renderer_capabilities *
 pcrdr_parse_renderer_capabilities(const char *data)
 {
@@ -1290,6 +1598,16 @@ pcrdr_parse_renderer_capabilities(const char *data)
             else if (strcasecmp(cap, "displayDensity") == 0) {  // Since 160
                 rdr_caps->display_density = strdup(value);
             }
+            else if (strcasecmp(cap, "domBatch") == 0) {
+                rdr_caps->dom_batch = (int)strtol(value, NULL, 10);
+            }
+            else if (strcasecmp(cap, "binaryFraming") == 0) {
+                rdr_caps->binary_framing = (int)strtol(value, NULL, 10);
+            }
+            else if (strcasecmp(cap, "compression") == 0) {
+                rdr_caps->compression =
+                    (strcasecmp(value, PCRDR_COMPRESSION_DEFLATE) == 0);
+            }
             else {
                 PC_WARN("Unknown renderer capability: %s\n", cap);
                 break;
@@ -185,12 +185,26 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/* switches to the binary framing and the compression of the large packets
+   once the session started if negotiated */
+static void enable_binary_framing(struct pcrdr_conn *conn,
+        struct renderer_capabilities *rdr_caps)
+{
+    if (conn->type != CT_UNIX_SOCKET && conn->type != CT_WEB_SOCKET)
+        return;
+
+    if (rdr_caps->binary_framing >= PCRDR_BINARY_FRAMING_VERSION)
+        conn->binary_framing = 1;
+    if (rdr_caps->compression)
+        conn->compression = 1;
+}
+
 static int set_session_args(struct pcinst *inst,
         purc_variant_t session_data, struct pcrdr_conn *conn_to_rdr,
         struct renderer_capabilities *rdr_caps)
 {
     (void) rdr_caps;
-    purc_variant_t vs[22] = { NULL };
+    purc_variant_t vs[26] = { NULL };
     purc_variant_t tmp;
     int n = 0;
 
@@ -229,6 +243,22 @@ static int set_session_args(struct pcinst *inst,
         goto failed;
     }
 
+    /* NOTE: accept the binary framing and the compression only for
+       the socket connections */
+    if (conn_to_rdr->type == CT_UNIX_SOCKET ||
+            conn_to_rdr->type == CT_WEB_SOCKET) {
+        if (rdr_caps->binary_framing >= PCRDR_BINARY_FRAMING_VERSION) {
+            vs[n++] = purc_variant_make_string_static("binaryFraming", false);
+            vs[n++] = purc_variant_make_ulongint(PCRDR_BINARY_FRAMING_VERSION);
+        }
+
+        if (rdr_caps->compression) {
+            vs[n++] = purc_variant_make_string_static("compression", false);
+            vs[n++] = purc_variant_make_string_static(
+                    PCRDR_COMPRESSION_DEFLATE, false);
+        }
+    }
+
     for (int i = 0; i < n >> 1; i++) {
         bool success = purc_variant_object_set(session_data,
                 vs[i * 2], vs[i * 2 + 1]);
@@ -414,6 +444,7 @@ static int connect_to_renderer(struct pcinst *inst,
     int ret_code = response_msg->retCode;
     if (ret_code == PCRDR_SC_OK) {
         inst->rdr_caps->session_handle = response_msg->resultValue;
+        enable_binary_framing(inst->conn_to_rdr, inst->rdr_caps);
     }
 
     pcrdr_release_message(response_msg);
@@ -664,6 +695,7 @@ int pcrdr_switch_renderer(struct pcinst *inst, const char *comm,
     int ret_code = response_msg->retCode;
     if (ret_code == PCRDR_SC_OK) {
         n_rdr_caps->session_handle = response_msg->resultValue;
+        enable_binary_framing(n_conn_to_rdr, n_rdr_caps);
     }
 
     pcrdr_release_message(response_msg);
@@ -26,7 +26,9 @@
 #include "purc-pcrdr.h"
 #include "private/list.h"
 #include "private/debug.h"
+#include "private/resolver.h"
 #include "private/utils.h"
+#include "private/pcrdr.h"
 #include "purc-utils.h"
 #include "connect.h"
 
@@ -46,8 +48,10 @@
 #include <sys/socket.h>
 #include <sys/fcntl.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <sys/time.h>
 #include <netdb.h>
+#include <limits.h>
 
 #if defined(__linux__) || defined(__CYGWIN__)
 #  include <endian.h>
@@ -157,13 +161,44 @@ static inline int conn_read (int fd, void *buff, ssize_t sz)
     return PCRDR_ERROR_IO;
 }
 
-static inline int conn_write (int fd, const void *data, ssize_t sz)
+#ifndef IOV_MAX
+#   define IOV_MAX      1024
+#endif
+
+/*
+ * Writes the buffers in @iov with gather I/O, resuming after partial writes
+ * and interruptions; the vectors in @iov are changed.
+ */
+static int conn_writev (int fd, struct iovec *iov, int nr_iov)
 {
-    if (write (fd, data, sz) == sz) {
-        return 0;
+    while (nr_iov > 0) {
+        ssize_t n = writev (fd, iov, nr_iov > IOV_MAX ? IOV_MAX : nr_iov);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return PCRDR_ERROR_IO;
+        }
+
+        /* skip the vectors written completely */
+        while (nr_iov > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            nr_iov--;
+        }
+
+        if (nr_iov > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
     }
 
-    return PCRDR_ERROR_IO;
+    return 0;
+}
+
+static inline int conn_write (int fd, const void *data, ssize_t sz)
+{
+    struct iovec iov = { (void *)data, sz };
+    return conn_writev (fd, &iov, 1);
 }
 
 static ssize_t ws_write(int fd, const void *buf, size_t length)
@@ -242,91 +277,73 @@ static int ws_send_ctrl_frame(int fd, char code)
     return 0;
 }
 
-static int ws_send_data_frame(int fd, int fin, int opcode,
+/*
+ * Sends a data frame: the payload is masked in the send buffer of the
+ * connection, which is reused, then written along with the header by
+ * gather I/O.
+ */
+static int ws_send_data_frame(pcrdr_conn *conn, int fin, int opcode,
         const void *data, ssize_t sz)
 {
-    int ret = PCRDR_ERROR_IO;
+    unsigned char head[2 + 8 + 4];
+    size_t nr_head;
     int mask_int = 0;
-    size_t size = sz;
-    char *buf = NULL;
-    char *p = NULL;
-    size_t nr_buf = 0;
-    WSFrameHeader header;
     unsigned char mask[4] = { 0 };
 
     if (sz <= 0) {
         PC_DEBUG ("Invalid data size %ld.\n", sz);
-        goto out;
+        return PCRDR_ERROR_IO;
     }
 
-    header.fin = fin;
-    header.rsv = 0;
-    header.op = opcode;
-    header.mask = 1; /* client must 1 */
-
     srand(time(NULL));
     mask_int = rand();
     memcpy(mask, &mask_int, 4);
 
-    size = sz;
-    if (size > 0xffff) {
-        /* header(16b) + Extended payload length(64b) + mask(32b) + data */
-        nr_buf = 2 + 8 + 4 + sz;
-        header.sz_payload = 127;
-    }
-    else if (size > 125) {
-        /* header(16b) + Extended payload length(16b) + mask(32b) + data */
-        nr_buf = 2 + 2 + 4 + sz;
-        header.sz_payload = 126;
-    }
-    else {
-        /* header(16b) + data + mask(32b) */
-        nr_buf = 2 + 4 + sz;
-        header.sz_payload = sz;
-    }
-
-    buf = malloc(nr_buf + 1);
-    buf[0] = 0;
-    buf[1] = 0;
-    if (fin) {
-        buf[0] |= 0x80;
-    }
-    buf[0] |= (0xff & opcode);
-    buf[1] = 0x80 | header.sz_payload;
-
-    p = buf + 2;
-    if (header.sz_payload == 127) {
+    head[0] = (fin ? 0x80 : 0) | (0xff & opcode);
+    if (sz > 0xffff) {
+        /* header(16b) + Extended payload length(64b) + mask(32b) */
         uint64_t v = htobe64(sz);
-        memcpy(p, &v, 8);
-        p = p + 8;
+        head[1] = 0x80 | 127;
+        memcpy(head + 2, &v, 8);
+        nr_head = 2 + 8;
     }
-    else if (header.sz_payload == 126) {
+    else if (sz > 125) {
+        /* header(16b) + Extended payload length(16b) + mask(32b) */
         uint16_t v = htobe16(sz);
-        memcpy(p, &v, 2);
-        p = p + 2;
+        head[1] = 0x80 | 126;
+        memcpy(head + 2, &v, 2);
+        nr_head = 2 + 2;
+    }
+    else {
+        /* header(16b) + mask(32b) */
+        head[1] = 0x80 | (unsigned char)sz;
+        nr_head = 2;
     }
 
     /* mask */
-    memcpy(p, &mask, 4);
+    memcpy(head + nr_head, mask, 4);
+    nr_head += 4;
 
-    /* payload */
-    p = p + 4;
-    memcpy(p, data, sz);
+    if (conn->sz_send_buf < (size_t)sz) {
+        char *buf = realloc(conn->send_buf, sz);
+        if (buf == NULL)
+            return PCRDR_ERROR_NOMEM;
+        conn->send_buf = buf;
+        conn->sz_send_buf = sz;
+    }
 
     /* mask payload */
+    const unsigned char *src = data;
+    unsigned char *dst = (unsigned char *)conn->send_buf;
     for (ssize_t i = 0; i < sz; i++) {
-        p[i] ^= mask[i % 4] & 0xff;
-    }
-
-    if (ws_write(fd, buf, nr_buf) == (ssize_t)nr_buf) {
-        ret = 0;
+        dst[i] = src[i] ^ mask[i % 4];
     }
 
-out:
-    if (buf) {
-        free(buf);
-    }
-    return ret;
+    struct iovec iov[2] = {
+        { head, nr_head },
+        { conn->send_buf, (size_t)sz },
+    };
+    return conn_writev(conn->fd, iov, 2);
 }
 
 static int ws_read_data_frame(pcrdr_conn *conn, WSFrameHeader *header,
@@ -450,6 +467,32 @@ static int my_wait_message (pcrdr_conn* conn, int timeout_ms)
     return select (conn->fd + 1, &rfds, NULL, NULL, NULL);
 }
 
+static int
+read_packet(pcrdr_conn* conn, bool reuse, void **packet, size_t *sz_packet);
+
+static pcrdr_msg *read_compressed_message (const void *packet, size_t sz)
+{
+    pcrdr_msg *msg = NULL;
+    size_t sz_original;
+    char *original = pcrdr_decompress_packet (packet, sz, &sz_original);
+    if (original == NULL)
+        return NULL;
+
+    if (pcrdr_is_binary_packet (original, sz_original)) {
+        pcrdr_parse_binary_packet (original, sz_original, &msg);
+    }
+    else {
+        bool taken = false;
+        pcrdr_parse_packet_in_buffer (original, sz_original + 1, sz_original,
+                &msg, &taken);
+        if (taken)
+            original = NULL;
+    }
+
+    free (original);
+    return msg;
+}
+
 static pcrdr_msg *my_read_message (pcrdr_conn* conn)
 {
     void* packet;
@@ -457,7 +500,7 @@ static pcrdr_msg *my_read_message (pcrdr_conn* conn)
     pcrdr_msg* msg = NULL;
     int err_code = 0, retval;
 
-    retval = pcrdr_socket_read_packet_alloc (conn, &packet, &data_len);
+    retval = read_packet (conn, true, &packet, &data_len);
     if (retval) {
         PC_DEBUG ("Failed to read packet\n");
         goto done;
@@ -469,8 +512,25 @@ static pcrdr_msg *my_read_message (pcrdr_conn* conn)
     }
 
     conn->stats.bytes_recv += data_len;
-    retval = pcrdr_parse_packet (packet, data_len, &msg);
-    free (packet);
+    if (pcrdr_is_compressed_packet (packet, data_len)) {
+        msg = read_compressed_message (packet, data_len);
+        if (msg == NULL)
+            retval = -1;
+    }
+    /* NOTE: the peer may send text packets even if binary framing is on */
+    else if (pcrdr_is_binary_packet (packet, data_len)) {
+        retval = pcrdr_parse_binary_packet (packet, data_len, &msg);
+    }
+    else {
+        bool taken = false;
+        retval = pcrdr_parse_packet_in_buffer (packet, conn->sz_recv_buf,
+                data_len, &msg, &taken);
+        if (taken) {
+            /* the buffer is pinned by the data of the message */
+            conn->recv_buf = NULL;
+            conn->sz_recv_buf = 0;
+        }
+    }
 
     if (retval < 0) {
         err_code = PCRDR_ERROR_BAD_MESSAGE;
@@ -498,15 +558,38 @@ static int my_send_message (pcrdr_conn* conn, pcrdr_msg *msg)
     buffer = purc_rwstream_new_buffer (PCRDR_MIN_PACKET_BUFF_SIZE,
             PCRDR_MAX_INMEM_PAYLOAD_SIZE);
 
-    if (pcrdr_serialize_message (msg,
-                (pcrdr_cb_write)purc_rwstream_write, buffer) < 0) {
+    int ret;
+    if (conn->binary_framing)
+        ret = pcrdr_serialize_message_binary (msg,
+                (pcrdr_cb_write)purc_rwstream_write, buffer);
+    else
+        ret = pcrdr_serialize_message (msg,
+                (pcrdr_cb_write)purc_rwstream_write, buffer);
+    if (ret < 0) {
         goto done;
     }
 
     size_t packet_len;
     const char * packet = purc_rwstream_get_mem_buffer (buffer, &packet_len);
 
-    if (pcrdr_socket_send_text_packet (conn, packet, packet_len) < 0) {
+    /* NOTE: a compressed packet is always sent as binary */
+    void *compressed = NULL;
+    if (conn->compression && packet_len >= PCRDR_MIN_SIZE_COMPRESSION) {
+        size_t sz_compressed;
+        compressed = pcrdr_compress_packet (packet, packet_len,
+                &sz_compressed);
+        if (compressed && sz_compressed < packet_len) {
+            packet = compressed;
+            packet_len = sz_compressed;
+        }
+    }
+
+    if (conn->binary_framing || packet == compressed)
+        ret = pcrdr_socket_send_binary_packet (conn, packet, packet_len);
+    else
+        ret = pcrdr_socket_send_text_packet (conn, packet, packet_len);
+    free (compressed);
+    if (ret < 0) {
         goto done;
     }
 
@@ -685,41 +768,16 @@ error:
     return -1;
 }
 
+/* NOTE: The addresses of the host are kept in the cache of the resolver,
+   and a warm connection made by $STREAM.preconnect() is taken if there is. */
 static int ws_open_connection(const char *host, const char *port)
 {
-    int fd = -1;
-    struct addrinfo *addrinfo;
-    struct addrinfo *p;
-    struct addrinfo hints = { 0 };
-
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    if (0 != getaddrinfo(host, port, &hints, &addrinfo)) {
-        PC_DEBUG ("Error while getting address info (%s:%s)\n",
-                host, port);
-        goto out;
-    }
-
-    for (p = addrinfo; p != NULL; p = p->ai_next) {
-        if((fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol)) == -1) {
-            continue;
-        }
-
-        if (connect(fd, p->ai_addr, p->ai_addrlen) == -1) {
-            close(fd);
-            continue;
-        }
-        break;
-    }
-    freeaddrinfo(addrinfo);
-
-    if (p == NULL) {
+    int fd = pcutils_resolver_connect(host, port);
+    if (fd < 0) {
         PC_DEBUG ("Connect to websocket server failed! (%s:%s)\n",
                 host, port);
-        goto out;
     }
 
-out:
     return fd;
 }
 
@@ -1231,7 +1289,40 @@ done:
     return err_code;
 }
 
-int pcrdr_socket_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_packet)
+/*
+ * Returns a buffer of @size bytes at least for a packet: the receive buffer
+ * of the connection grown if @reuse is true, or the buffer @buf reallocated
+ * otherwise.
+ */
+static char *
+get_packet_buffer(pcrdr_conn* conn, bool reuse, char *buf, size_t size)
+{
+    if (!reuse) {
+        char *new_buf = realloc (buf, size);
+        if (new_buf == NULL)
+            free (buf);
+        return new_buf;
+    }
+
+    if (conn->sz_recv_buf < size) {
+        size_t sz = pcutils_get_next_fibonacci_number (size);
+        char *new_buf = realloc (conn->recv_buf, sz);
+        if (new_buf == NULL)
+            return NULL;
+
+        conn->recv_buf = new_buf;
+        conn->sz_recv_buf = sz;
+    }
+
+    return conn->recv_buf;
+}
+
+/*
+ * Reads a packet into the receive buffer of the connection if @reuse is
+ * true, or into a new buffer otherwise.
+ */
+static int
+read_packet(pcrdr_conn* conn, bool reuse, void **packet, size_t *sz_packet)
 {
     char* packet_buf = NULL;
     int err_code = 0;
@@ -1297,7 +1388,8 @@ int pcrdr_socket_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_
                 left = 0;
             }
 
-            if ((packet_buf = malloc (total_len + 1)) == NULL) {
+            if ((packet_buf = get_packet_buffer (conn, reuse, NULL,
+                            total_len + 1)) == NULL) {
                 err_code = PCRDR_ERROR_NOMEM;
                 goto done;
             }
@@ -1420,19 +1512,14 @@ int pcrdr_socket_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_
                     goto done;
                 }
 
+                packet_buf = get_packet_buffer(conn, reuse, packet_buf,
+                        offset + nr_buf + 1);
                 if (packet_buf == NULL) {
-                    packet_buf = malloc(nr_buf + 1);
-                    p = packet_buf;
-                }
-                else {
-                    packet_buf = realloc(packet_buf, offset + nr_buf + 1);
-                    p = packet_buf + offset;
-                }
-
-                if (packet_buf == NULL) {
+                    free(buf);
                     err_code = PCRDR_ERROR_NOMEM;
                     goto done;
                 }
+                p = packet_buf + offset;
 
                 memcpy(p, buf, nr_buf);
                 free(buf);
@@ -1476,7 +1563,7 @@ int pcrdr_socket_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_
 
 done:
     if (err_code) {
-        if (packet_buf)
+        if (packet_buf && !reuse)
             free (packet_buf);
 
         *packet = NULL;
@@ -1488,50 +1575,72 @@ done:
     return 0;
 }
 
-int pcrdr_socket_send_text_packet (pcrdr_conn* conn, const char* text, size_t len)
+int pcrdr_socket_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_packet)
 {
-    int retv = 0;
+    return read_packet (conn, false, packet, sz_packet);
+}
 
-    if (conn->type == CT_UNIX_SOCKET) {
-        USFrameHeader header;
+/* the max number of frames gathered in a writev() call */
+#define US_GATHERED_FRAMES      16
 
-        if (len > PCRDR_MAX_FRAME_PAYLOAD_SIZE) {
-            size_t left = len;
+/*
+ * Sends a packet in frames via Unix socket: the headers and the slices of
+ * the payload are gathered and written by one writev() call for every
+ * US_GATHERED_FRAMES frames.
+ */
+static int
+us_send_data_packet(pcrdr_conn* conn, bool binary, const char* text, size_t len)
+{
+    USFrameHeader headers[US_GATHERED_FRAMES];
+    struct iovec iov[US_GATHERED_FRAMES * 2];
+    size_t left = len;
+    int retv = 0;
 
-            do {
-                if (left == len) {
-                    header.op = US_OPCODE_TEXT;
-                    header.fragmented = len;
-                    header.sz_payload = PCRDR_MAX_FRAME_PAYLOAD_SIZE;
-                    left -= PCRDR_MAX_FRAME_PAYLOAD_SIZE;
-                }
-                else if (left > PCRDR_MAX_FRAME_PAYLOAD_SIZE) {
-                    header.op = US_OPCODE_CONTINUATION;
-                    header.fragmented = 0;
-                    header.sz_payload = PCRDR_MAX_FRAME_PAYLOAD_SIZE;
-                    left -= PCRDR_MAX_FRAME_PAYLOAD_SIZE;
-                }
-                else {
-                    header.op = US_OPCODE_END;
-                    header.fragmented = 0;
-                    header.sz_payload = left;
-                    left = 0;
-                }
+    do {
+        int nr_frames = 0;
 
-                if (conn_write (conn->fd, &header, sizeof (USFrameHeader)) == 0) {
-                    retv = conn_write (conn->fd, text, header.sz_payload);
-                    text += header.sz_payload;
-                }
+        while (nr_frames < US_GATHERED_FRAMES && (left > 0 || len == 0)) {
+            USFrameHeader *header = headers + nr_frames;
+            size_t sz = (left > PCRDR_MAX_FRAME_PAYLOAD_SIZE) ?
+                PCRDR_MAX_FRAME_PAYLOAD_SIZE : left;
 
-            } while (left > 0 && retv == 0);
-        }
-        else {
-            header.op = US_OPCODE_TEXT;
-            header.fragmented = 0;
-            header.sz_payload = len;
-            if (conn_write (conn->fd, &header, sizeof (USFrameHeader)) == 0)
-                retv = conn_write (conn->fd, text, len);
+            if (left == len) {
+                header->op = binary ? US_OPCODE_BIN : US_OPCODE_TEXT;
+                header->fragmented = (len > PCRDR_MAX_FRAME_PAYLOAD_SIZE) ?
+                    len : 0;
+            }
+            else {
+                header->op = (left > PCRDR_MAX_FRAME_PAYLOAD_SIZE) ?
+                    US_OPCODE_CONTINUATION : US_OPCODE_END;
+                header->fragmented = 0;
+            }
+            header->sz_payload = sz;
+
+            iov[nr_frames * 2].iov_base = header;
+            iov[nr_frames * 2].iov_len = sizeof(USFrameHeader);
+            iov[nr_frames * 2 + 1].iov_base = (void *)text;
+            iov[nr_frames * 2 + 1].iov_len = sz;
+            nr_frames++;
+
+            text += sz;
+            left -= sz;
+            if (len == 0)
+                break;
         }
+
+        retv = conn_writev(conn->fd, iov, nr_frames * 2);
+    } while (left > 0 && retv == 0);
+
+    return retv;
+}
+
+static int
+send_data_packet(pcrdr_conn* conn, bool binary, const char* text, size_t len)
+{
+    int retv = 0;
+
+    if (conn->type == CT_UNIX_SOCKET) {
+        retv = us_send_data_packet(conn, binary, text, len);
     }
     else if (conn->type == CT_WEB_SOCKET) {
         if (len > PCRDR_MAX_INMEM_PAYLOAD_SIZE) {
@@ -1547,7 +1656,7 @@ int pcrdr_socket_send_text_packet (pcrdr_conn* conn, const char* text, size_t le
             do {
                 if (left == len) {
                     fin = 0;
-                    opcode = WS_OPCODE_TEXT;
+                    opcode = binary ? WS_OPCODE_BIN : WS_OPCODE_TEXT;
                     sz_payload = PCRDR_MAX_FRAME_PAYLOAD_SIZE;
                     left -= PCRDR_MAX_FRAME_PAYLOAD_SIZE;
                 }
@@ -1564,13 +1673,13 @@ int pcrdr_socket_send_text_packet (pcrdr_conn* conn, const char* text, size_t le
                     left = 0;
                 }
 
-                if(ws_send_data_frame(conn->fd, fin, opcode, text, sz_payload) == 0) {
-                    text += sz_payload;
-                }
+                retv = ws_send_data_frame(conn, fin, opcode, text, sz_payload);
+                text += sz_payload;
             } while (left > 0 && retv == 0);
         }
         else {
-            retv = ws_send_data_frame(conn->fd, 1, WS_OPCODE_TEXT, text, len);
+            retv = ws_send_data_frame(conn, 1,
+                    binary ? WS_OPCODE_BIN : WS_OPCODE_TEXT, text, len);
         }
     }
     else
@@ -1579,6 +1688,17 @@ int pcrdr_socket_send_text_packet (pcrdr_conn* conn, const char* text, size_t le
     return retv;
 }
 
+int pcrdr_socket_send_text_packet (pcrdr_conn* conn, const char* text, size_t len)
+{
+    return send_data_packet(conn, false, text, len);
+}
+
+int pcrdr_socket_send_binary_packet (pcrdr_conn* conn,
+        const void* data, size_t len)
+{
+    return send_data_packet(conn, true, data, len);
+}
+
 #define SCHEMA_UNIX_SOCKET  "unix://"
 
 pcrdr_msg *pcrdr_socket_connect(const char* renderer_uri,
@@ -0,0 +1,246 @@
+/*
+ * @file lock-stats.c
+ * @date 2026/10/14
+ * @brief The contention statistics of the mutexes and the rwlocks.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#if USE(PTHREADS)
+
+#include "purc-ports.h"
+#include "private/lock-stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if ENABLE(LOCK_STATS)
+
+#include <time.h>
+#include <unistd.h>
+#if OS(LINUX)
+#include <sys/syscall.h>
+#endif
+
+/* all locks with statistics; the lock protecting it can not be a purc_mutex,
+   which registers itself here. */
+static LIST_HEAD(registry);
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void pclock_stats_register(struct pclock_stats *stats, enum pclock_kind kind)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->kind = kind;
+    pthread_mutex_init(&stats->lock, NULL);
+
+    pthread_mutex_lock(&registry_lock);
+    list_add_tail(&stats->list, &registry);
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void pclock_stats_unregister(struct pclock_stats *stats)
+{
+    pthread_mutex_lock(&registry_lock);
+    list_del(&stats->list);
+    pthread_mutex_unlock(&registry_lock);
+
+    pthread_mutex_destroy(&stats->lock);
+}
+
+long pclock_self(void)
+{
+    /* NOTE: gettid() is a system call; cache it for the thread. */
+    static __thread long self;
+
+    if (self == 0) {
+#if OS(LINUX)
+        self = (long)syscall(SYS_gettid);
+#else
+        self = (long)(uintptr_t)pthread_self();
+#endif
+    }
+
+    return self;
+}
+
+uint64_t pclock_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void pclock_stats_record_wait(struct pclock_stats *stats, long blocker,
+        uint64_t ns)
+{
+    size_t bucket = 0;
+    for (uint64_t us = ns / 1000; us && bucket < PCLOCK_NR_WAIT_BUCKETS - 1;
+            us >>= 1)
+        bucket++;
+
+    pthread_mutex_lock(&stats->lock);
+
+    stats->nr_contended++;
+    stats->wait_ns += ns;
+    if (ns > stats->max_wait_ns)
+        stats->max_wait_ns = ns;
+    stats->buckets[bucket]++;
+
+    /* Keep the most frequent blockers: a new one replaces the least
+       frequent and inherits its count, so that it is not evicted at once. */
+    struct pclock_blocker *slot = &stats->blockers[0];
+    for (size_t i = 0; i < PCLOCK_NR_BLOCKERS; i++) {
+        struct pclock_blocker *b = &stats->blockers[i];
+        if (b->tid == blocker && (b->nr || blocker == 0)) {
+            slot = b;
+            break;
+        }
+        if (b->nr < slot->nr)
+            slot = b;
+    }
+    slot->tid = blocker;
+    slot->nr++;
+
+    pthread_mutex_unlock(&stats->lock);
+}
+
+static int cmp_wait_time(const void *a, const void *b)
+{
+    const struct pclock_stats *sa = *(const struct pclock_stats **)a;
+    const struct pclock_stats *sb = *(const struct pclock_stats **)b;
+
+    if (sa->wait_ns == sb->wait_ns)
+        return 0;
+    return (sa->wait_ns < sb->wait_ns) ? 1 : -1;
+}
+
+static void dump_one(FILE *fp, struct pclock_stats *stats)
+{
+    char name[32];
+    if (stats->name)
+        snprintf(name, sizeof(name), "%s", stats->name);
+    else
+        snprintf(name, sizeof(name), "%p", (void *)stats);
+
+    fprintf(fp, "%-24s %-6s %12llu %10llu %12.3f %10.1f ", name,
+            stats->kind == PCLOCK_KIND_MUTEX ? "mutex" : "rwlock",
+            (unsigned long long)atomic_load(&stats->nr_acquired),
+            (unsigned long long)stats->nr_contended,
+            stats->wait_ns / 1e6, stats->max_wait_ns / 1e3);
+
+    for (size_t i = 0; i < PCLOCK_NR_BLOCKERS; i++) {
+        const struct pclock_blocker *b = &stats->blockers[i];
+        if (b->nr == 0)
+            continue;
+        if (b->tid)
+            fprintf(fp, " %ld:%llu", b->tid, (unsigned long long)b->nr);
+        else
+            fprintf(fp, " readers:%llu", (unsigned long long)b->nr);
+    }
+    fputs("\n", fp);
+
+    if (stats->nr_contended == 0)
+        return;
+
+    fputs("    wait_us:", fp);
+    for (size_t i = 0; i < PCLOCK_NR_WAIT_BUCKETS; i++) {
+        if (stats->buckets[i] == 0)
+            continue;
+        if (i == PCLOCK_NR_WAIT_BUCKETS - 1)
+            fprintf(fp, " >=%lu:", 1UL << (i - 1));
+        else
+            fprintf(fp, " <%lu:", 1UL << i);
+        fprintf(fp, "%llu", (unsigned long long)stats->buckets[i]);
+    }
+    fputs("\n", fp);
+}
+
+static void reset_one(struct pclock_stats *stats)
+{
+    atomic_store(&stats->nr_acquired, 0);
+    stats->nr_contended = 0;
+    stats->wait_ns = 0;
+    stats->max_wait_ns = 0;
+    memset(stats->buckets, 0, sizeof(stats->buckets));
+    memset(stats->blockers, 0, sizeof(stats->blockers));
+}
+
+int purc_lock_stats_dump(FILE *fp, bool reset)
+{
+    struct pclock_stats **all = NULL;
+    size_t nr = 0, sz = 0;
+    struct pclock_stats *stats;
+
+    pthread_mutex_lock(&registry_lock);
+
+    list_for_each_entry(stats, &registry, list) {
+        /* the anonymous locks never contended are of no interest */
+        if (stats->name == NULL && stats->nr_contended == 0)
+            continue;
+
+        if (nr == sz) {
+            sz = sz ? sz * 2 : 32;
+            struct pclock_stats **p = realloc(all, sizeof(*all) * sz);
+            if (p == NULL)
+                break;
+            all = p;
+        }
+
+        /* NOTE: the lock is held until the dump is done */
+        pthread_mutex_lock(&stats->lock);
+        all[nr++] = stats;
+    }
+
+    qsort(all, nr, sizeof(*all), cmp_wait_time);
+
+    fprintf(fp, "%-24s %-6s %12s %10s %12s %10s  %s\n", "lock", "kind",
+            "acquired", "contended", "wait_ms", "max_us", "blockers");
+    for (size_t i = 0; i < nr; i++) {
+        dump_one(fp, all[i]);
+        if (reset)
+            reset_one(all[i]);
+        pthread_mutex_unlock(&all[i]->lock);
+    }
+
+    if (reset) {
+        list_for_each_entry(stats, &registry, list) {
+            atomic_store(&stats->nr_acquired, 0);
+        }
+    }
+
+    pthread_mutex_unlock(&registry_lock);
+
+    free(all);
+    return (int)nr;
+}
+
+#else   /* ENABLE(LOCK_STATS) */
+
+int purc_lock_stats_dump(FILE *fp, bool reset)
+{
+    (void)fp;
+    (void)reset;
+    return -1;
+}
+
+#endif  /* !ENABLE(LOCK_STATS) */
+
+#endif  /* USE(PTHREADS) */
@@ -27,44 +27,103 @@
 #if USE(PTHREADS)
 
 #include "purc-ports.h"
+#include "private/lock-stats.h"
 
 #include <stdlib.h>
 #include <pthread.h>
 
+/* NOTE: the native mutex is the first member of struct pclock_mutex. */
+#define NATIVE_MUTEX(mutex)     ((pthread_mutex_t *)(mutex)->native_impl)
+
+#if ENABLE(LOCK_STATS)
+#   define SIZE_OF_MUTEX        sizeof(struct pclock_mutex)
+#   define MUTEX_STATS(mutex)   \
+    (&((struct pclock_mutex *)(mutex)->native_impl)->stats)
+#else
+#   define SIZE_OF_MUTEX        sizeof(pthread_mutex_t)
+#endif
+
 void purc_mutex_init (purc_mutex  *mutex)
 {
-    mutex->native_impl = malloc (sizeof (pthread_mutex_t));
+    mutex->native_impl = malloc (SIZE_OF_MUTEX);
     if (mutex->native_impl) {
         if (pthread_mutex_init (mutex->native_impl, NULL) != 0) {
             pthread_mutex_destroy (mutex->native_impl);
             free (mutex->native_impl);
             mutex->native_impl = NULL;
         }
+#if ENABLE(LOCK_STATS)
+        else {
+            pclock_stats_register (MUTEX_STATS (mutex), PCLOCK_KIND_MUTEX);
+        }
+#endif
     }
 }
 
 void purc_mutex_clear (purc_mutex *mutex)
 {
+#if ENABLE(LOCK_STATS)
+    pclock_stats_unregister (MUTEX_STATS (mutex));
+#endif
     pthread_mutex_destroy (mutex->native_impl);
     free (mutex->native_impl);
     mutex->native_impl = NULL;
 }
 
+void purc_mutex_set_name (purc_mutex *mutex, const char *name)
+{
+#if ENABLE(LOCK_STATS)
+    MUTEX_STATS (mutex)->name = name;
+#else
+    (void)mutex;
+    (void)name;
+#endif
+}
+
 void purc_mutex_lock (purc_mutex *mutex)
 {
-    pthread_mutex_lock (mutex->native_impl);
+#if ENABLE(LOCK_STATS)
+    struct pclock_stats *stats = MUTEX_STATS (mutex);
+
+    /* only the contended acquisitions are timed */
+    if (pthread_mutex_trylock (NATIVE_MUTEX (mutex)) != 0) {
+        long blocker = atomic_load_explicit (&stats->holder,
+                memory_order_relaxed);
+        uint64_t t0 = pclock_now_ns ();
+        pthread_mutex_lock (NATIVE_MUTEX (mutex));
+        pclock_stats_record_wait (stats, blocker, pclock_now_ns () - t0);
+    }
+
+    atomic_store_explicit (&stats->holder, pclock_self (),
+            memory_order_relaxed);
+    atomic_fetch_add_explicit (&stats->nr_acquired, 1, memory_order_relaxed);
+#else
+    pthread_mutex_lock (NATIVE_MUTEX (mutex));
+#endif
 }
 
 bool purc_mutex_trylock (purc_mutex *mutex)
 {
-    if (pthread_mutex_trylock (mutex->native_impl) == 0)
+    if (pthread_mutex_trylock (NATIVE_MUTEX (mutex)) == 0) {
+#if ENABLE(LOCK_STATS)
+        struct pclock_stats *stats = MUTEX_STATS (mutex);
+        atomic_store_explicit (&stats->holder, pclock_self (),
+                memory_order_relaxed);
+        atomic_fetch_add_explicit (&stats->nr_acquired, 1,
+                memory_order_relaxed);
+#endif
         return true;
+    }
     return false;
 }
 
 void purc_mutex_unlock (purc_mutex *mutex)
 {
-    pthread_mutex_unlock (mutex->native_impl);
+#if ENABLE(LOCK_STATS)
+    atomic_store_explicit (&MUTEX_STATS (mutex)->holder, 0,
+            memory_order_relaxed);
+#endif
+    pthread_mutex_unlock (NATIVE_MUTEX (mutex));
 }
 
 #endif /* HAVE(PTHREADS) */
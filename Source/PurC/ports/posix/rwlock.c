@@ -27,61 +27,143 @@
 #if USE(PTHREADS)
 
 #include "purc-ports.h"
+#include "private/lock-stats.h"
 
 #include <stdlib.h>
 #include <pthread.h>
 
+/* NOTE: the native rwlock is the first member of struct pclock_rwlock. */
+#define NATIVE_RWLOCK(rw_lock)  ((pthread_rwlock_t *)(rw_lock)->native_impl)
+
+#if ENABLE(LOCK_STATS)
+#   define SIZE_OF_RWLOCK       sizeof(struct pclock_rwlock)
+#   define RWLOCK_STATS(rw_lock)   \
+    (&((struct pclock_rwlock *)(rw_lock)->native_impl)->stats)
+
+/* The holder is recorded for the writers only; a waiter blocked by the
+   readers records the blocker as 0. */
+static inline void
+acquired (struct pclock_stats *stats, bool writer)
+{
+    if (writer)
+        atomic_store_explicit (&stats->holder, pclock_self (),
+                memory_order_relaxed);
+    atomic_fetch_add_explicit (&stats->nr_acquired, 1, memory_order_relaxed);
+}
+
+#else
+#   define SIZE_OF_RWLOCK       sizeof(pthread_rwlock_t)
+#endif
+
 void purc_rwlock_init (purc_rwlock  *rw_lock)
 {
-    rw_lock->native_impl = malloc (sizeof (pthread_rwlock_t));
+    rw_lock->native_impl = malloc (SIZE_OF_RWLOCK);
     if (rw_lock->native_impl) {
         if (pthread_rwlock_init (rw_lock->native_impl, NULL)) {
             pthread_rwlock_destroy (rw_lock->native_impl);
             free (rw_lock->native_impl);
             rw_lock->native_impl = NULL;
         }
+#if ENABLE(LOCK_STATS)
+        else {
+            pclock_stats_register (RWLOCK_STATS (rw_lock),
+                    PCLOCK_KIND_RWLOCK);
+        }
+#endif
     }
 }
 
 void purc_rwlock_clear (purc_rwlock *rw_lock)
 {
+#if ENABLE(LOCK_STATS)
+    pclock_stats_unregister (RWLOCK_STATS (rw_lock));
+#endif
     pthread_rwlock_destroy (rw_lock->native_impl);
     free (rw_lock->native_impl);
     rw_lock->native_impl = NULL;
 }
 
+void purc_rwlock_set_name (purc_rwlock *rw_lock, const char *name)
+{
+#if ENABLE(LOCK_STATS)
+    RWLOCK_STATS (rw_lock)->name = name;
+#else
+    (void)rw_lock;
+    (void)name;
+#endif
+}
+
 void purc_rwlock_writer_lock (purc_rwlock *rw_lock)
 {
-    pthread_rwlock_wrlock (rw_lock->native_impl);
+#if ENABLE(LOCK_STATS)
+    struct pclock_stats *stats = RWLOCK_STATS (rw_lock);
+
+    /* only the contended acquisitions are timed */
+    if (pthread_rwlock_trywrlock (NATIVE_RWLOCK (rw_lock)) != 0) {
+        long blocker = atomic_load_explicit (&stats->holder,
+                memory_order_relaxed);
+        uint64_t t0 = pclock_now_ns ();
+        pthread_rwlock_wrlock (NATIVE_RWLOCK (rw_lock));
+        pclock_stats_record_wait (stats, blocker, pclock_now_ns () - t0);
+    }
+    acquired (stats, true);
+#else
+    pthread_rwlock_wrlock (NATIVE_RWLOCK (rw_lock));
+#endif
 }
 
 bool purc_rwlock_writer_trylock (purc_rwlock *rw_lock)
 {
-    if (pthread_rwlock_trywrlock (rw_lock->native_impl) == 0)
+    if (pthread_rwlock_trywrlock (NATIVE_RWLOCK (rw_lock)) == 0) {
+#if ENABLE(LOCK_STATS)
+        acquired (RWLOCK_STATS (rw_lock), true);
+#endif
         return true;
+    }
     return false;
 }
 
 void purc_rwlock_writer_unlock (purc_rwlock *rw_lock)
 {
-    pthread_rwlock_unlock (rw_lock->native_impl);
+#if ENABLE(LOCK_STATS)
+    atomic_store_explicit (&RWLOCK_STATS (rw_lock)->holder, 0,
+            memory_order_relaxed);
+#endif
+    pthread_rwlock_unlock (NATIVE_RWLOCK (rw_lock));
 }
 
 void purc_rwlock_reader_lock (purc_rwlock *rw_lock)
 {
-    pthread_rwlock_rdlock (rw_lock->native_impl);
+#if ENABLE(LOCK_STATS)
+    struct pclock_stats *stats = RWLOCK_STATS (rw_lock);
+
+    if (pthread_rwlock_tryrdlock (NATIVE_RWLOCK (rw_lock)) != 0) {
+        long blocker = atomic_load_explicit (&stats->holder,
+                memory_order_relaxed);
+        uint64_t t0 = pclock_now_ns ();
+        pthread_rwlock_rdlock (NATIVE_RWLOCK (rw_lock));
+        pclock_stats_record_wait (stats, blocker, pclock_now_ns () - t0);
+    }
+    acquired (stats, false);
+#else
+    pthread_rwlock_rdlock (NATIVE_RWLOCK (rw_lock));
+#endif
 }
 
 bool purc_rwlock_reader_trylock (purc_rwlock *rw_lock)
 {
-    if (pthread_rwlock_tryrdlock (rw_lock->native_impl) == 0)
+    if (pthread_rwlock_tryrdlock (NATIVE_RWLOCK (rw_lock)) == 0) {
+#if ENABLE(LOCK_STATS)
+        acquired (RWLOCK_STATS (rw_lock), false);
+#endif
         return true;
+    }
     return false;
 }
 
 void purc_rwlock_reader_unlock (purc_rwlock *rw_lock)
 {
-    pthread_rwlock_unlock (rw_lock->native_impl);
+    pthread_rwlock_unlock (NATIVE_RWLOCK (rw_lock));
 }
 
 #endif /* HAVE(PTHREADS) */
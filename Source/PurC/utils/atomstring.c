@@ -27,6 +27,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
 
 #include "purc-ports.h"
 #include "purc-utils.h"
@@ -34,17 +36,43 @@
 #include "private/instance.h"
 #include "private/map.h"
 #include "private/utils.h"
+#include "private/tls.h"
 
 #if PURC_ATOM_BUCKET_BITS > 16
 #error "Too many bits reserved for bucket"
 #endif
 
+/* NOTE: The lookups, i.e., purc_atom_try_string_ex() and
+   purc_atom_to_string(), are called constantly from all runner threads,
+   so they do not take any lock. The writers, i.e., the creation and the
+   removal of atoms, are serialized by `atom_mutex`; a writer publishes a new
+   entry, a new hash table, or a new quarks array with a release store,
+   and frees the memory replaced or removed only after a grace period, in
+   which all readers active at the time have left (see atom_synchronize()).
+
+   Every reader thread owns a record which is written by that thread only,
+   so the readers do not bounce a shared cache line like a rwlock does. */
+struct atom_entry {
+    struct atom_entry  *next;
+    uint32_t            hash;
+    purc_atom_t         atom;
+    char               *string;
+    bool                need_free;
+};
+
+struct atom_table {
+    size_t              size_mask;
+    struct atom_entry  *slots[0];
+};
+
 static struct atom_bucket {
     purc_atom_t     bucket_bits;
     purc_atom_t     atom_seq_id;
+    size_t          nr_entries;
 
-    pcutils_uomap   *atom_map;
+    struct atom_table  *table;
     char**          quarks;
+    size_t          sz_quarks;
 } atom_buckets[PURC_ATOM_BUCKETS_NR];
 
 #define ATOM_BITS_NR        (sizeof(purc_atom_t) << 3)
@@ -64,46 +92,249 @@ static struct atom_bucket {
 #define ATOM_BLOCK_SIZE         (1024 >> PURC_ATOM_BUCKET_BITS)
 #define ATOM_STRING_BLOCK_SIZE  (4096 - sizeof (size_t))
 
-static inline purc_atom_t
-atom_new(struct atom_bucket *bucket, char *string, bool need_free);
+/* the initial number of the slots of a hash table */
+#define ATOM_TABLE_SIZE         64
+
+struct atom_reader {
+    /* 0 if not reading; otherwise, the value of `atom_gp_ctr` when began */
+    unsigned long       ctr;
+    /* released when the owner thread exits, and can be taken by others */
+    int                 in_use;
+    struct atom_reader *next;
+};
+
+/* keep the records of the readers in different cache lines */
+#define ATOM_READER_ALIGN       128
+
+#define ATOM_GP_COUNT           1UL
+#define ATOM_GP_PHASE           (1UL << (sizeof(unsigned long) * 4))
+
+static unsigned long atom_gp_ctr = ATOM_GP_COUNT;
+static struct atom_reader *atom_readers;
+static pthread_key_t atom_reader_key;
+PURC_DEFINE_THREAD_LOCAL(struct atom_reader *, my_reader);
 
-static purc_rwlock atom_rwlock;
+static purc_mutex atom_mutex;
 static char *atom_block = NULL;
 static int  atom_block_offset = 0;
 
-static void atom_init_bucket(struct atom_bucket *bucket)
+static void atom_reader_release(void *value)
+{
+    struct atom_reader *reader = value;
+
+    struct atom_reader **tls = PURC_GET_THREAD_LOCAL(my_reader);
+    if (tls)
+        *tls = NULL;
+
+    __atomic_store_n(&reader->ctr, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&reader->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static struct atom_reader *atom_reader_register(void)
+{
+    struct atom_reader *reader;
+
+    /* take a record released by an exited thread first */
+    reader = __atomic_load_n(&atom_readers, __ATOMIC_ACQUIRE);
+    for (; reader; reader = reader->next) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&reader->in_use, &expected, 1,
+                    false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            goto done;
+    }
+
+    void *mem;
+    if (posix_memalign(&mem, ATOM_READER_ALIGN, ATOM_READER_ALIGN))
+        return NULL;
+
+    reader = mem;
+    reader->ctr = 0;
+    reader->in_use = 1;
+    reader->next = __atomic_load_n(&atom_readers, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&atom_readers, &reader->next, reader,
+                true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+done:
+    pthread_setspecific(atom_reader_key, reader);
+    return reader;
+}
+
+/* Returns NULL if the reader falls back to taking `atom_mutex`. */
+static inline struct atom_reader *atom_read_lock(void)
 {
-    assert (bucket->atom_seq_id == 0);
+    struct atom_reader **tls = PURC_GET_THREAD_LOCAL(my_reader);
+    if (UNLIKELY(tls == NULL))
+        goto fallback;
+
+    struct atom_reader *reader = *tls;
+    if (UNLIKELY(reader == NULL)) {
+        reader = atom_reader_register();
+        if (reader == NULL)
+            goto fallback;
+        *tls = reader;
+    }
+
+    __atomic_store_n(&reader->ctr,
+            __atomic_load_n(&atom_gp_ctr, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return reader;
 
-    bucket->atom_map = pcutils_uomap_create(NULL, NULL, NULL, NULL,
-            pchash_fnv1a_str_hash, comp_key_string, false, false);
-    bucket->quarks = (char **)malloc(sizeof(char *) * ATOM_BLOCK_SIZE);
-    bucket->quarks[0] = NULL;
-    bucket->atom_seq_id = 1;
+fallback:
+    purc_mutex_lock(&atom_mutex);
+    return NULL;
+}
 
-    assert(bucket->quarks != NULL);
+static inline void atom_read_unlock(struct atom_reader *reader)
+{
+    if (reader)
+        __atomic_store_n(&reader->ctr, 0, __ATOMIC_RELEASE);
+    else
+        purc_mutex_unlock(&atom_mutex);
+}
+
+/* Waits until all readers which may see the memory unpublished are gone;
+   flipping the phase twice makes sure that a reader which loaded the phase
+   just before the first flip is waited for too.
+   HOLDS: atom_mutex */
+static void atom_synchronize(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    for (int i = 0; i < 2; i++) {
+        unsigned long gp = atom_gp_ctr ^ ATOM_GP_PHASE;
+        __atomic_store_n(&atom_gp_ctr, gp, __ATOMIC_SEQ_CST);
+
+        struct atom_reader *reader;
+        reader = __atomic_load_n(&atom_readers, __ATOMIC_ACQUIRE);
+        for (; reader; reader = reader->next) {
+            for (;;) {
+                unsigned long ctr;
+                ctr = __atomic_load_n(&reader->ctr, __ATOMIC_ACQUIRE);
+                if (!(ctr & ATOM_GP_COUNT) || !((ctr ^ gp) & ATOM_GP_PHASE))
+                    break;
+                sched_yield();
+            }
+        }
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static struct atom_table *atom_table_new(size_t size)
+{
+    struct atom_table *table = calloc(1,
+            sizeof(*table) + sizeof(struct atom_entry *) * size);
+    if (table)
+        table->size_mask = size - 1;
+    return table;
 }
 
-static inline struct atom_bucket *atom_get_bucket(int bucket)
+static void atom_table_delete(struct atom_table *table, bool free_strings)
+{
+    for (size_t i = 0; i <= table->size_mask; i++) {
+        struct atom_entry *entry = table->slots[i];
+        while (entry) {
+            struct atom_entry *next = entry->next;
+            if (free_strings && entry->need_free)
+                free(entry->string);
+            free(entry);
+            entry = next;
+        }
+    }
+
+    free(table);
+}
+
+static struct atom_entry *
+atom_find(struct atom_table *table, const char *string, uint32_t hash)
+{
+    struct atom_entry *entry;
+
+    entry = __atomic_load_n(&table->slots[hash & table->size_mask],
+            __ATOMIC_ACQUIRE);
+    while (entry) {
+        if (entry->hash == hash && strcmp(entry->string, string) == 0)
+            return entry;
+        entry = __atomic_load_n(&entry->next, __ATOMIC_ACQUIRE);
+    }
+
+    return NULL;
+}
+
+/* HOLDS: atom_mutex */
+static void atom_table_link(struct atom_table *table, struct atom_entry *entry)
+{
+    struct atom_entry **slot = table->slots + (entry->hash & table->size_mask);
+    entry->next = *slot;
+    __atomic_store_n(slot, entry, __ATOMIC_RELEASE);
+}
+
+/* The entries are copied to the new table instead of being moved, so a
+   reader still walking a chain of the old table never wanders to another
+   chain.  HOLDS: atom_mutex */
+static void atom_table_grow(struct atom_bucket *bucket)
+{
+    struct atom_table *old = bucket->table;
+    struct atom_table *table = atom_table_new((old->size_mask + 1) << 1);
+    if (table == NULL)
+        return;
+
+    for (size_t i = 0; i <= old->size_mask; i++) {
+        for (struct atom_entry *entry = old->slots[i]; entry;
+                entry = entry->next) {
+            struct atom_entry *copy = malloc(sizeof(*copy));
+            if (copy == NULL) {
+                /* keep the longer chains */
+                atom_table_delete(table, false);
+                return;
+            }
+
+            *copy = *entry;
+            copy->next = table->slots[copy->hash & table->size_mask];
+            table->slots[copy->hash & table->size_mask] = copy;
+        }
+    }
+
+    __atomic_store_n(&bucket->table, table, __ATOMIC_RELEASE);
+    atom_synchronize();
+    atom_table_delete(old, false);
+}
+
+/* HOLDS: atom_mutex */
+static struct atom_bucket *atom_get_bucket(int bucket)
 {
     assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
 
     struct atom_bucket *atom_bucket = atom_buckets + bucket;
-    if (UNLIKELY(atom_bucket->atom_seq_id == 0)) {
-        atom_init_bucket(atom_bucket);
-        atom_bucket->bucket_bits = BUCKET_BITS(bucket);
+    if (LIKELY(atom_bucket->table))
+        return atom_bucket;
+
+    assert(atom_bucket->atom_seq_id == 0);
+
+    struct atom_table *table = atom_table_new(ATOM_TABLE_SIZE);
+    char **quarks = (char **)malloc(sizeof(char *) * ATOM_BLOCK_SIZE);
+    if (table == NULL || quarks == NULL) {
+        free(table);
+        free(quarks);
+        return NULL;
     }
 
+    quarks[0] = NULL;
+    atom_bucket->quarks = quarks;
+    atom_bucket->sz_quarks = ATOM_BLOCK_SIZE;
+    atom_bucket->bucket_bits = BUCKET_BITS(bucket);
+    __atomic_store_n(&atom_bucket->atom_seq_id, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&atom_bucket->table, table, __ATOMIC_RELEASE);
     return atom_bucket;
 }
 
-static inline void atom_put_bucket(int bucket)
+static void atom_put_bucket(int bucket)
 {
     assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
 
     struct atom_bucket *atom_bucket = atom_buckets + bucket;
-    if (LIKELY(atom_bucket->atom_map)) {
-        pcutils_uomap_destroy(atom_bucket->atom_map);
+    if (LIKELY(atom_bucket->table)) {
+        atom_table_delete(atom_bucket->table, true);
         free(atom_bucket->quarks);
         memset(atom_bucket, 0, sizeof(*atom_bucket));
     }
@@ -112,18 +343,24 @@ static inline void atom_put_bucket(int bucket)
 purc_atom_t
 purc_atom_try_string_ex(int bucket, const char *string)
 {
-    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
-    const pcutils_uomap_entry* entry = NULL;
     purc_atom_t atom = 0;
 
-    if (string == NULL || atom_bucket == NULL)
+    assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
+    if (string == NULL)
         return 0;
 
-    purc_rwlock_reader_lock(&atom_rwlock);
-    if ((entry = pcutils_uomap_find(atom_bucket->atom_map, string))) {
-        atom = (purc_atom_t)(uintptr_t)pcutils_uomap_entry_val(entry);
+    struct atom_bucket *atom_bucket = atom_buckets + bucket;
+    uint32_t hash = pchash_fnv1a_str_hash(string);
+
+    struct atom_reader *reader = atom_read_lock();
+    struct atom_table *table;
+    table = __atomic_load_n(&atom_bucket->table, __ATOMIC_ACQUIRE);
+    if (table) {
+        struct atom_entry *entry = atom_find(table, string, hash);
+        if (entry)
+            atom = entry->atom;
     }
-    purc_rwlock_reader_unlock(&atom_rwlock);
+    atom_read_unlock(reader);
 
     return atom;
 }
@@ -131,32 +368,46 @@ purc_atom_try_string_ex(int bucket, const char *string)
 bool
 purc_atom_remove_string_ex(int bucket, const char *string)
 {
-    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    bool ret = false;
 
-    if (string == NULL || atom_bucket == NULL)
+    assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
+    if (string == NULL)
         return false;
 
-    pcutils_uomap_entry* entry;
-    bool ret;
-    purc_atom_t atom;
-
-    purc_rwlock_writer_lock(&atom_rwlock);
-    if ((entry = pcutils_uomap_find(atom_bucket->atom_map, string))) {
-        atom = (purc_atom_t)(uintptr_t)pcutils_uomap_entry_val(entry);
-        pcutils_uomap_erase_entry_nolock(atom_bucket->atom_map, entry);
-        atom = ATOM_TO_SEQUENCE(atom);
-        atom_bucket->quarks[atom] = NULL;
-        ret = true;
-    }
-    else {
-        ret = false;
+    struct atom_bucket *atom_bucket = atom_buckets + bucket;
+    uint32_t hash = pchash_fnv1a_str_hash(string);
+
+    purc_mutex_lock(&atom_mutex);
+    struct atom_table *table = atom_bucket->table;
+    if (table) {
+        struct atom_entry **prev = table->slots + (hash & table->size_mask);
+        struct atom_entry *entry;
+        while ((entry = *prev)) {
+            if (entry->hash == hash && strcmp(entry->string, string) == 0)
+                break;
+            prev = &entry->next;
+        }
+
+        if (entry) {
+            __atomic_store_n(prev, entry->next, __ATOMIC_RELEASE);
+            __atomic_store_n(
+                    &atom_bucket->quarks[ATOM_TO_SEQUENCE(entry->atom)],
+                    NULL, __ATOMIC_RELEASE);
+            atom_bucket->nr_entries--;
+
+            atom_synchronize();
+            if (entry->need_free)
+                free(entry->string);
+            free(entry);
+            ret = true;
+        }
     }
-    purc_rwlock_writer_unlock(&atom_rwlock);
+    purc_mutex_unlock(&atom_mutex);
 
     return ret;
 }
 
-/* HOLDS: atom_rwlock_lock */
+/* HOLDS: atom_mutex */
 static char *
 atom_strdup(const char *string, bool *need_free)
 {
@@ -185,18 +436,98 @@ atom_strdup(const char *string, bool *need_free)
     return copy;
 }
 
-/* HOLDS: purc_atom_rwlock_writer_lock */
-static inline purc_atom_t
-atom_from_string(struct atom_bucket *bucket, const char *string,
+/* HOLDS: atom_mutex */
+static purc_atom_t
+atom_new(struct atom_bucket *bucket, char *string, uint32_t hash,
+        bool need_free)
+{
+    purc_atom_t atom;
+    struct atom_entry *entry;
+
+    entry = malloc(sizeof(*entry));
+    if (entry == NULL)
+        goto failed;
+
+    if (bucket->atom_seq_id == bucket->sz_quarks) {
+        char **atoms_new;
+        size_t sz_new = bucket->sz_quarks << 1;
+
+        atoms_new = (char **)malloc(sizeof (char *) * sz_new);
+        if (atoms_new == NULL)
+            goto failed;
+
+        memcpy(atoms_new, bucket->quarks,
+                sizeof (char *) * bucket->atom_seq_id);
+        memset(atoms_new + bucket->atom_seq_id, 0,
+                sizeof (char *) * (sz_new - bucket->atom_seq_id));
+
+        /*
+         * The implementation in glib did not free the old quarks array,
+         * so that the lookups can be lockless. We free the old quarks
+         * after all readers which may still see it are gone.
+         */
+        char **old = bucket->quarks;
+        __atomic_store_n(&bucket->quarks, atoms_new, __ATOMIC_RELEASE);
+        bucket->sz_quarks = sz_new;
+        atom_synchronize();
+        free(old);
+    }
+
+    atom = bucket->atom_seq_id;
+    __atomic_store_n(&bucket->quarks[atom], string, __ATOMIC_RELAXED);
+    atom |= bucket->bucket_bits;
+
+    entry->hash = hash;
+    entry->atom = atom;
+    entry->string = string;
+    entry->need_free = need_free;
+
+    /* publish the quark first for purc_atom_to_string() */
+    __atomic_store_n(&bucket->atom_seq_id, bucket->atom_seq_id + 1,
+            __ATOMIC_RELEASE);
+    atom_table_link(bucket->table, entry);
+
+    bucket->nr_entries++;
+    if (bucket->nr_entries > ((bucket->table->size_mask + 1) << 1))
+        atom_table_grow(bucket);
+
+    assert(IS_VALID_SEQ_ID(bucket->atom_seq_id));
+    return atom;
+
+failed:
+    free(entry);
+    if (need_free)
+        free(string);
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return 0;
+}
+
+static purc_atom_t
+atom_from_string(int bucket, const char *string,
         bool duplicate, bool *newly_created)
 {
-    purc_atom_t atom = 0;
-    pcutils_uomap_entry* entry;
+    purc_atom_t atom;
+
+    /* most atoms exist already */
+    if ((atom = purc_atom_try_string_ex(bucket, string))) {
+        if (newly_created)
+            *newly_created = false;
+        return atom;
+    }
+
+    uint32_t hash = pchash_fnv1a_str_hash(string);
+
+    purc_mutex_lock(&atom_mutex);
+    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    if (atom_bucket == NULL) {
+        purc_mutex_unlock(&atom_mutex);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return 0;
+    }
 
-    entry = pcutils_uomap_find(bucket->atom_map, string);
+    struct atom_entry *entry = atom_find(atom_bucket->table, string, hash);
     if (entry) {
-        atom = (purc_atom_t)(uintptr_t)pcutils_uomap_entry_val(entry);
-        assert(atom);
+        atom = entry->atom;
 
         if (newly_created)
             *newly_created = false;
@@ -207,23 +538,13 @@ atom_from_string(struct atom_bucket *bucket, const char *string,
             string = atom_strdup(string, &need_free);
         else
             need_free = false;
-        atom = atom_new(bucket, (char *)string, need_free);
+        atom = string ? atom_new(atom_bucket, (char *)string, hash,
+                need_free) : 0;
 
         if (newly_created)
-            *newly_created = true;
+            *newly_created = (atom != 0);
     }
-
-    return atom;
-}
-
-static inline purc_atom_t
-atom_from_string_locked(struct atom_bucket *bucket, const char *string,
-        bool duplicate, bool *newly_created)
-{
-    purc_atom_t atom = 0;
-    purc_rwlock_writer_lock(&atom_rwlock);
-    atom = atom_from_string(bucket, string, duplicate, newly_created);
-    purc_rwlock_writer_unlock(&atom_rwlock);
+    purc_mutex_unlock(&atom_mutex);
 
     return atom;
 }
@@ -234,8 +555,7 @@ purc_atom_from_string_ex2(int bucket, const char *string, bool *newly_created)
     if (!string)
         return 0;
 
-    return atom_from_string_locked(atom_get_bucket(bucket), string,
-            true, newly_created);
+    return atom_from_string(bucket, string, true, newly_created);
 }
 
 purc_atom_t
@@ -245,8 +565,7 @@ purc_atom_from_static_string_ex2(int bucket, const char *string,
     if (!string)
         return 0;
 
-    return atom_from_string_locked(atom_get_bucket(bucket), string,
-            false, newly_created);
+    return atom_from_string(bucket, string, false, newly_created);
 }
 
 const char *
@@ -259,63 +578,18 @@ purc_atom_to_string(purc_atom_t atom)
         return NULL;
 
     bucket = ATOM_TO_BUCKET(atom);
-    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    struct atom_bucket *atom_bucket = atom_buckets + bucket;
     atom = ATOM_TO_SEQUENCE(atom);
-    purc_rwlock_reader_lock(&atom_rwlock);
-    if (atom < atom_bucket->atom_seq_id)
-        result = atom_bucket->quarks[atom];
-    purc_rwlock_reader_unlock(&atom_rwlock);
 
-    return result;
-}
-
-static void free_dup_key(void *key, void *data)
-{
-    UNUSED_PARAM(data);
-    if (key)
-        free(key);
-}
-
-/* HOLDS: purc_atom_rwlock_writer_lock */
-static inline purc_atom_t
-atom_new(struct atom_bucket *bucket, char *string, bool need_free)
-{
-    purc_atom_t atom;
-    char **atoms_new;
-
-    if (bucket->atom_seq_id % ATOM_BLOCK_SIZE == 0) {
-        atoms_new = (char **)malloc(sizeof (char *) *
-                (bucket->atom_seq_id + ATOM_BLOCK_SIZE));
-        if (bucket->atom_seq_id != 0)
-            memcpy(atoms_new, bucket->quarks,
-                    sizeof (char *) * bucket->atom_seq_id);
-        memset(atoms_new + bucket->atom_seq_id, 0,
-                sizeof (char *) * ATOM_BLOCK_SIZE);
-
-        /*
-         * The implementation in glib did not free the old quarks array.
-         * The author said: `This leaks the old quarks array. Its unfortunate,
-         * but it allows us to do lockless lookup of the arrays, and there
-         * shouldn't be that many quarks in an app`.
-         *
-         * In our implementation, we do free the old quarks.
-         * Indeed, we can use realloc() instead of malloc() and memcpy()
-         */
-        free(bucket->quarks);
-        bucket->quarks = atoms_new;
+    struct atom_reader *reader = atom_read_lock();
+    if (atom < __atomic_load_n(&atom_bucket->atom_seq_id, __ATOMIC_ACQUIRE)) {
+        char **quarks = __atomic_load_n(&atom_bucket->quarks,
+                __ATOMIC_ACQUIRE);
+        result = __atomic_load_n(&quarks[atom], __ATOMIC_ACQUIRE);
     }
+    atom_read_unlock(reader);
 
-    atom = bucket->atom_seq_id;
-    bucket->quarks[atom] = string;
-    atom |= bucket->bucket_bits;
-    pcutils_uomap_insert_ex(bucket->atom_map,
-                string, (void *)(uintptr_t)atom,
-                need_free ? free_dup_key : NULL);
-    bucket->atom_seq_id++;
-
-    assert(IS_VALID_SEQ_ID(bucket->atom_seq_id));
-
-    return atom;
+    return result;
 }
 
 static void
@@ -327,8 +601,17 @@ atom_cleanup_once(void)
         atom_put_bucket(bucket);
     }
 
-    if (atom_rwlock.native_impl)
-        purc_rwlock_clear(&atom_rwlock);
+    struct atom_reader *reader = atom_readers;
+    while (reader) {
+        struct atom_reader *next = reader->next;
+        free(reader);
+        reader = next;
+    }
+    atom_readers = NULL;
+    pthread_key_delete(atom_reader_key);
+
+    if (atom_mutex.native_impl)
+        purc_mutex_clear(&atom_mutex);
     if (atom_block)
         free(atom_block);
 }
@@ -338,9 +621,13 @@ atom_init_once(void)
 {
     int r = 0;
 
-    purc_rwlock_init(&atom_rwlock);
-    if (atom_rwlock.native_impl == NULL)
+    purc_mutex_init(&atom_mutex);
+    if (atom_mutex.native_impl == NULL)
         goto fail_lock;
+    purc_mutex_set_name(&atom_mutex, "atom");
+
+    if (pthread_key_create(&atom_reader_key, atom_reader_release))
+        goto fail_key;
 
     /* init the default bucket only */
     if (!atom_get_bucket(0))
@@ -360,7 +647,10 @@ fail_atexit:
     }
 
 fail_atom:
-    purc_rwlock_clear(&atom_rwlock);
+    pthread_key_delete(atom_reader_key);
+
+fail_key:
+    purc_mutex_clear(&atom_mutex);
 
 fail_lock:
     return -1;
@@ -373,4 +663,3 @@ struct pcmodule _module_atom = {
     .init_once       = atom_init_once,
     .init_instance   = NULL,
 };
-
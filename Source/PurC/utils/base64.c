@@ -54,6 +54,8 @@
  * IF IBM IS APPRISED OF THE POSSIBILITY OF SUCH DAMAGES.
  */
 
+#include "config.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -62,10 +64,35 @@
 
 #include "private/utils.h"
 
+#if defined __GNUC__ && defined __x86_64__
+#include <immintrin.h>
+#define HAVE_X86_AVX2_BASE64 1
+#endif
+
 static const char Base64[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 static const char Pad64 = '=';
 
+/* the values of the base64 characters; 0xFF for the others */
+static const unsigned char Base64Values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
 /* (From RFC1521 and draft-ietf-dnssec-secext-03.txt)
    The following encoding technique is taken from RFC 1521 by Borenstein
    and Freed.  It is reproduced here in a slightly edited form for
@@ -129,50 +156,155 @@ static const char Pad64 = '=';
        characters followed by one "=" padding character.
    */
 
+#if HAVE(X86_AVX2_BASE64)
+/*
+ * The AVX2 implementations are based on the algorithms by Wojciech Muła
+ * and Daniel Lemire described in "Faster Base64 Encoding and Decoding
+ * using AVX2 Instructions" <https://arxiv.org/abs/1704.00605>.
+ */
+
+/* encodes 24 bytes into 32 characters for each round;
+   returns the number of the bytes encoded. */
+__attribute__((target("avx2")))
+static size_t b64_encode_avx2(const unsigned char *src, size_t srclength,
+        char *target)
+{
+    const unsigned char *start = src;
+
+    /* NOTE: 28 bytes are loaded for each round */
+    while (srclength >= 32) {
+        __m256i in = _mm256_set_m128i(
+                _mm_loadu_si128((const __m128i *)(src + 12)),
+                _mm_loadu_si128((const __m128i *)src));
+
+        /* split the 3-byte groups into 6-bit indices */
+        in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+        __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(t1, t3);
+
+        /* translate the indices to the characters by adding the offsets */
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result,
+                _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        const __m256i offsets = _mm256_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0,
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0);
+        result = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, result),
+                indices);
+
+        _mm256_storeu_si256((__m256i *)target, result);
+        src += 24;
+        srclength -= 24;
+        target += 32;
+    }
+
+    return src - start;
+}
+
+/* decodes 32 characters into 24 bytes (32 bytes are stored);
+   returns false if there is any non-base64 character. */
+__attribute__((target("avx2")))
+static bool b64_decode_avx2(const char *src, unsigned char *target)
+{
+    const __m256i lut_lo = _mm256_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+
+    __m256i in = _mm256_loadu_si256((const __m256i *)src);
+    __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask_2f);
+    __m256i lo_nibbles = _mm256_and_si256(in, mask_2f);
+    __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm256_testz_si256(lo, hi))
+        return false;
+
+    /* translate the characters to the values */
+    __m256i eq_2f = _mm256_cmpeq_epi8(in, mask_2f);
+    __m256i roll = _mm256_shuffle_epi8(lut_roll,
+            _mm256_add_epi8(eq_2f, hi_nibbles));
+    in = _mm256_add_epi8(in, roll);
+
+    /* pack the 6-bit values into the 3-byte groups */
+    __m256i merged = _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140));
+    __m256i out = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    out = _mm256_shuffle_epi8(out, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    out = _mm256_permutevar8x32_epi32(out,
+            _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1));
+
+    _mm256_storeu_si256((__m256i *)target, out);
+    return true;
+}
+#endif /* HAVE(X86_AVX2_BASE64) */
+
 ssize_t pcutils_b64_encode(const void *_src, size_t srclength,
            void *dest, size_t targsize)
 {
     const unsigned char *src = _src;
     char *target = dest;
     size_t datalength = 0;
-    u_char input[3] = {0};
-    u_char output[4];
-    size_t i;
 
     assert(dest && targsize > 0);
 
+    /* the encoded characters and the terminating null character */
+    if ((srclength + 2) / 3 * 4 >= targsize)
+        return (-1);
+
+#if HAVE(X86_AVX2_BASE64)
+    if (srclength >= 32 && (pcutils_cpu_features() & PCUTILS_CPU_AVX2)) {
+        size_t done = b64_encode_avx2(src, srclength, target);
+        src += done;
+        srclength -= done;
+        datalength = done / 3 * 4;
+    }
+#endif
+
     while (2 < srclength) {
-        input[0] = *src++;
-        input[1] = *src++;
-        input[2] = *src++;
+        uint32_t group = (src[0] << 16) | (src[1] << 8) | src[2];
+        src += 3;
         srclength -= 3;
 
-        output[0] = input[0] >> 2;
-        output[1] = ((input[0] & 0x03) << 4) + (input[1] >> 4);
-        output[2] = ((input[1] & 0x0f) << 2) + (input[2] >> 6);
-        output[3] = input[2] & 0x3f;
-
-        if (datalength + 4 > targsize)
-            return (-1);
-        target[datalength++] = Base64[output[0]];
-        target[datalength++] = Base64[output[1]];
-        target[datalength++] = Base64[output[2]];
-        target[datalength++] = Base64[output[3]];
+        target[datalength++] = Base64[group >> 18];
+        target[datalength++] = Base64[(group >> 12) & 0x3f];
+        target[datalength++] = Base64[(group >> 6) & 0x3f];
+        target[datalength++] = Base64[group & 0x3f];
     }
 
     /* Now we worry about padding. */
     if (0 != srclength) {
+        u_char input[3] = {0};
+        u_char output[3];
+
         /* Get what's left. */
-        input[0] = input[1] = input[2] = '\0';
-        for (i = 0; i < srclength; i++)
+        for (size_t i = 0; i < srclength; i++)
             input[i] = *src++;
 
         output[0] = input[0] >> 2;
         output[1] = ((input[0] & 0x03) << 4) + (input[1] >> 4);
         output[2] = ((input[1] & 0x0f) << 2) + (input[2] >> 6);
 
-        if (datalength + 4 > targsize)
-            return (-1);
         target[datalength++] = Base64[output[0]];
         target[datalength++] = Base64[output[1]];
         if (srclength == 1)
@@ -181,8 +313,6 @@ ssize_t pcutils_b64_encode(const void *_src, size_t srclength,
             target[datalength++] = Base64[output[2]];
         target[datalength++] = Pad64;
     }
-    if (datalength >= targsize)
-        return (-1);
     target[datalength] = '\0';    /* Returned value doesn't count \0. */
     return (datalength);
 }
@@ -213,22 +343,64 @@ ssize_t pcutils_b64_decode(const void *_src, void *dest, size_t targsize)
     int state, ch;
     size_t tarindex;
     u_char nextbyte;
-    char *pos;
+    int value;
 
     state = 0;
     tarindex = 0;
 
     assert(dest && targsize > 0);
 
-    while ((ch = (unsigned char)*src++) != '\0') {
+#if HAVE(X86_AVX2_BASE64)
+    /* the whole blocks of 32 characters without any whitespace are decoded
+       by AVX2 (the others by the loop below) */
+    const char *end = src, *next_block = src;
+    if (target && (pcutils_cpu_features() & PCUTILS_CPU_AVX2))
+        end = src + strlen(src);
+#endif
+
+    while (1) {
+#if HAVE(X86_AVX2_BASE64)
+        while (state == 0 && src >= next_block && end - src >= 32 &&
+                targsize - tarindex >= 32) {
+            if (!b64_decode_avx2(src, target + tarindex)) {
+                next_block = src + 32;
+                break;
+            }
+            src += 32;
+            tarindex += 24;
+        }
+#endif
+
+        /* the fast path for the whole groups */
+        while (state == 0 && target && targsize - tarindex >= 3) {
+            const unsigned char *s = (const unsigned char *)src;
+            uint32_t v0, v1, v2, v3;
+
+            /* NOTE: the null character is not a base64 character */
+            if ((v0 = Base64Values[s[0]]) == 0xFF ||
+                    (v1 = Base64Values[s[1]]) == 0xFF ||
+                    (v2 = Base64Values[s[2]]) == 0xFF ||
+                    (v3 = Base64Values[s[3]]) == 0xFF)
+                break;
+
+            uint32_t group = (v0 << 18) | (v1 << 12) | (v2 << 6) | v3;
+            target[tarindex++] = group >> 16;
+            target[tarindex++] = group >> 8;
+            target[tarindex++] = group;
+            src += 4;
+        }
+
+        if ((ch = (unsigned char)*src++) == '\0')
+            break;
+
         if (purc_isspace(ch))    /* Skip whitespace anywhere. */
             continue;
 
         if (ch == Pad64)
             break;
 
-        pos = strchr(Base64, ch);
-        if (pos == 0)        /* A non-base64 character. */
+        value = Base64Values[ch];
+        if (value == 0xFF)        /* A non-base64 character. */
             return (-1);
 
         switch (state) {
@@ -236,7 +408,7 @@ ssize_t pcutils_b64_decode(const void *_src, void *dest, size_t targsize)
             if (target) {
                 if (tarindex >= targsize)
                     return (-1);
-                target[tarindex] = (pos - Base64) << 2;
+                target[tarindex] = value << 2;
             }
             state = 1;
             break;
@@ -244,8 +416,8 @@ ssize_t pcutils_b64_decode(const void *_src, void *dest, size_t targsize)
             if (target) {
                 if (tarindex >= targsize)
                     return (-1);
-                target[tarindex]   |=  (pos - Base64) >> 4;
-                nextbyte = ((pos - Base64) & 0x0f) << 4;
+                target[tarindex]   |=  value >> 4;
+                nextbyte = (value & 0x0f) << 4;
                 if (tarindex + 1 < targsize)
                     target[tarindex+1] = nextbyte;
                 else if (nextbyte)
@@ -258,8 +430,8 @@ ssize_t pcutils_b64_decode(const void *_src, void *dest, size_t targsize)
             if (target) {
                 if (tarindex >= targsize)
                     return (-1);
-                target[tarindex]   |=  (pos - Base64) >> 2;
-                nextbyte = ((pos - Base64) & 0x03) << 6;
+                target[tarindex]   |=  value >> 2;
+                nextbyte = (value & 0x03) << 6;
                 if (tarindex + 1 < targsize)
                     target[tarindex+1] = nextbyte;
                 else if (nextbyte)
@@ -272,7 +444,7 @@ ssize_t pcutils_b64_decode(const void *_src, void *dest, size_t targsize)
             if (target) {
                 if (tarindex >= targsize)
                     return (-1);
-                target[tarindex] |= (pos - Base64);
+                target[tarindex] |= value;
             }
             tarindex++;
             state = 0;
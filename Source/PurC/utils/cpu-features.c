@@ -0,0 +1,87 @@
+/*
+ * @file cpu-features.c
+ * @date 2026/10/14
+ * @brief Detect the CPU features used by the accelerated utilities.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "private/utils.h"
+
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+#include <cpuid.h>
+#define HAVE_X86_CPUID 1
+#endif
+
+/* all bits set: not detected yet */
+static unsigned cpu_features = (unsigned)-1;
+
+static unsigned detect_cpu_features(void)
+{
+    unsigned features = 0;
+
+#if HAVE(X86_CPUID)
+    unsigned eax, ebx, ecx, edx;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        /* CPUID.01H:ECX: PCLMULQDQ[bit 1], SSE4.1[bit 19], SSE4.2[bit 20] */
+        if (ecx & (1U << 20))
+            features |= PCUTILS_CPU_SSE42;
+        if ((ecx & (1U << 1)) && (ecx & (1U << 19)))
+            features |= PCUTILS_CPU_PCLMUL;
+
+        /* the YMM states must be enabled by the OS (OSXSAVE[bit 27]) */
+        bool ymm_enabled = false;
+        if (ecx & (1U << 27)) {
+            unsigned xcr0_lo, xcr0_hi;
+            __asm__ volatile ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi)
+                    : "c" (0));
+            ymm_enabled = ((xcr0_lo & 0x06) == 0x06);
+        }
+
+        bool sse41 = (ecx & (1U << 19));
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            /* CPUID.(EAX=07H, ECX=0):EBX: AVX2[bit 5], SHA[bit 29] */
+            if (sse41 && (ebx & (1U << 29)))
+                features |= PCUTILS_CPU_SHA;
+            if (ymm_enabled && (ebx & (1U << 5)))
+                features |= PCUTILS_CPU_AVX2;
+        }
+    }
+#endif
+
+#if defined __ARM_FEATURE_CRC32
+    features |= PCUTILS_CPU_CRC32;
+#endif
+
+    return features;
+}
+
+unsigned pcutils_cpu_features(void)
+{
+    unsigned features = __atomic_load_n(&cpu_features, __ATOMIC_RELAXED);
+
+    if (features == (unsigned)-1) {
+        /* NOTE: the result is always the same if detected concurrently */
+        features = detect_cpu_features();
+        __atomic_store_n(&cpu_features, features, __ATOMIC_RELAXED);
+    }
+
+    return features;
+}
@@ -28,6 +28,16 @@
 #include "private/utils.h"
 #include "private/debug.h"
 
+#include <string.h>
+
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+#include <immintrin.h>
+#define HAVE_X86_CRC32 1
+#elif defined __ARM_FEATURE_CRC32 && CPU(LITTLE_ENDIAN)
+#include <arm_acle.h>
+#define HAVE_ARM_CRC32 1
+#endif
+
 /*
 
 // program to generate the crc32_table.
@@ -568,11 +578,186 @@ void pcutils_crc32_begin(pcutils_crc32_ctxt *ctxt, purc_crc32_algo_t algo)
     ctxt->crc32 = ctxt->init;
 }
 
+#if HAVE(X86_CRC32)
+/* CRC-32C (Castagnoli) with the CRC32 instruction of SSE4.2 */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *buf, size_t n)
+{
+#if defined __x86_64__
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc = (uint32_t)_mm_crc32_u64(crc, v);
+        buf += 8;
+        n -= 8;
+    }
+#endif
+
+    while (n >= 4) {
+        uint32_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc = _mm_crc32_u32(crc, v);
+        buf += 4;
+        n -= 4;
+    }
+
+    while (n--) {
+        crc = _mm_crc32_u8(crc, *buf++);
+    }
+
+    return crc;
+}
+
+/*
+ * CRC-32 (the reflected 0x04C11DB7) by folding with the carry-less
+ * multiplication, see "Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ Instruction" by Intel. The length must be a multiple of 16,
+ * and at least 64.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32_pclmul(uint32_t crc, const uint8_t *buf, size_t n)
+{
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    buf += 64;
+    n -= 64;
+
+    /* fold four blocks of 128 bits in parallel */
+    x0 = k1k2;
+    while (n >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                _mm_loadu_si128((const __m128i *)(buf + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                _mm_loadu_si128((const __m128i *)(buf + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                _mm_loadu_si128((const __m128i *)(buf + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                _mm_loadu_si128((const __m128i *)(buf + 0x30)));
+        buf += 64;
+        n -= 64;
+    }
+
+    /* fold into 128 bits */
+    x0 = k3k4;
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* fold the remaining blocks of 128 bits */
+    while (n >= 16) {
+        x2 = _mm_loadu_si128((const __m128i *)buf);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        buf += 16;
+        n -= 16;
+    }
+
+    /* fold 128 bits to 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+#endif /* HAVE(X86_CRC32) */
+
+#if HAVE(ARM_CRC32)
+/* CRC-32 or CRC-32C with the CRC32 instructions of ARMv8 */
+static uint32_t crc32_armv8(uint32_t crc, const uint8_t *buf, size_t n,
+        bool castagnoli)
+{
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc = castagnoli ? __crc32cd(crc, v) : __crc32d(crc, v);
+        buf += 8;
+        n -= 8;
+    }
+
+    while (n--) {
+        crc = castagnoli ? __crc32cb(crc, *buf) : __crc32b(crc, *buf);
+        buf++;
+    }
+
+    return crc;
+}
+#endif /* HAVE(ARM_CRC32) */
+
+/* the minimal length of the data to use the accelerated implementations */
+#define CRC32_ACCEL_MIN     64
+
 void pcutils_crc32_update(pcutils_crc32_ctxt *ctxt,
         const void *data, size_t n)
 {
     const uint8_t *buf = data;
 
+#if HAVE(X86_CRC32)
+    if (n >= CRC32_ACCEL_MIN) {
+        unsigned features = pcutils_cpu_features();
+
+        if (ctxt->table_static == crc32_table_1edc6f41_reflected &&
+                (features & PCUTILS_CPU_SSE42)) {
+            ctxt->crc32 = crc32c_sse42(ctxt->crc32, buf, n);
+            return;
+        }
+
+        if (ctxt->table_static == crc32_table_04c11db7_reflected &&
+                (features & PCUTILS_CPU_PCLMUL)) {
+            size_t m = n & ~(size_t)15;
+            ctxt->crc32 = crc32_pclmul(ctxt->crc32, buf, m);
+            buf += m;
+            n -= m;
+        }
+    }
+#elif HAVE(ARM_CRC32)
+    if (n >= CRC32_ACCEL_MIN) {
+        if (ctxt->table_static == crc32_table_1edc6f41_reflected) {
+            ctxt->crc32 = crc32_armv8(ctxt->crc32, buf, n, true);
+            return;
+        }
+
+        if (ctxt->table_static == crc32_table_04c11db7_reflected) {
+            ctxt->crc32 = crc32_armv8(ctxt->crc32, buf, n, false);
+            return;
+        }
+    }
+#endif
+
     while (n--) {
         uint8_t ch;
         ch = *buf;
@@ -0,0 +1,478 @@
+/*
+ * @file dtoa.c
+ * @date 2026/10/14
+ * @brief The shortest round-trip formatter and a fast parser for doubles.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "private/utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+/*
+ * The formatter uses the Grisu2 algorithm by Florian Loitsch ("Printing
+ * Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010).
+ * The digits it generates always read back to the same double, and they are
+ * the shortest ones for all but a tiny fraction of the inputs.
+ */
+
+#define DP_SIGNIFICAND_SIZE     52
+#define DP_EXPONENT_BIAS        (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_MIN_EXPONENT         (-DP_EXPONENT_BIAS)
+#define DP_EXPONENT_MASK        0x7FF0000000000000ULL
+#define DP_SIGNIFICAND_MASK     0x000FFFFFFFFFFFFFULL
+#define DP_HIDDEN_BIT           0x0010000000000000ULL
+
+struct diy_fp {
+    uint64_t    f;
+    int         e;
+};
+
+static inline struct diy_fp diy_fp_from_double(double d)
+{
+    union { double d; uint64_t u64; } u = { d };
+    struct diy_fp fp;
+
+    int biased_e = (int)((u.u64 & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+    uint64_t significand = u.u64 & DP_SIGNIFICAND_MASK;
+    if (biased_e != 0) {
+        fp.f = significand + DP_HIDDEN_BIT;
+        fp.e = biased_e - DP_EXPONENT_BIAS;
+    }
+    else {
+        fp.f = significand;
+        fp.e = DP_MIN_EXPONENT + 1;
+    }
+
+    return fp;
+}
+
+static inline struct diy_fp diy_fp_normalize(struct diy_fp fp)
+{
+    while (!(fp.f & (DP_HIDDEN_BIT << 1))) {
+        fp.f <<= 1;
+        fp.e--;
+    }
+
+    fp.f <<= (64 - DP_SIGNIFICAND_SIZE - 2);
+    fp.e -= (64 - DP_SIGNIFICAND_SIZE - 2);
+    return fp;
+}
+
+static inline struct diy_fp diy_fp_multiply(struct diy_fp x, struct diy_fp y)
+{
+    struct diy_fp r;
+
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = (unsigned __int128)x.f * y.f;
+    r.f = (uint64_t)(p >> 64);
+    if ((uint64_t)p & (1ULL << 63))
+        r.f++;      /* round */
+#else
+    const uint64_t M32 = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32, b = x.f & M32;
+    uint64_t c = y.f >> 32, d = y.f & M32;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+    tmp += 1ULL << 31;  /* round */
+    r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+#endif
+
+    r.e = x.e + y.e + 64;
+    return r;
+}
+
+/* the normalized boundaries m- and m+ of the double */
+static void normalized_boundaries(struct diy_fp v,
+        struct diy_fp *minus, struct diy_fp *plus)
+{
+    struct diy_fp pl = { (v.f << 1) + 1, v.e - 1 };
+    struct diy_fp mi;
+
+    pl = diy_fp_normalize(pl);
+    if (v.f == DP_HIDDEN_BIT) {
+        mi.f = (v.f << 2) - 1;
+        mi.e = v.e - 2;
+    }
+    else {
+        mi.f = (v.f << 1) - 1;
+        mi.e = v.e - 1;
+    }
+
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    *plus = pl;
+    *minus = mi;
+}
+
+/* 10^-348, 10^-340, ..., 10^340 normalized to 64-bit significands */
+static const uint64_t cached_powers_f[] = {
+    0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76,
+    0xcf42894a5dce35ea, 0x9a6bb0aa55653b2d, 0xe61acf033d1a45df,
+    0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f, 0xbe5691ef416bd60c,
+    0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+    0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57,
+    0xc21094364dfb5637, 0x9096ea6f3848984f, 0xd77485cb25823ac7,
+    0xa086cfcd97bf97f4, 0xef340a98172aace5, 0xb23867fb2a35b28e,
+    0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+    0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126,
+    0xb5b5ada8aaff80b8, 0x87625f056c7c4a8b, 0xc9bcff6034c13053,
+    0x964e858c91ba2655, 0xdff9772470297ebd, 0xa6dfbd9fb8e5b88f,
+    0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+    0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06,
+    0xaa242499697392d3, 0xfd87b5f28300ca0e, 0xbce5086492111aeb,
+    0x8cbccc096f5088cc, 0xd1b71758e219652c, 0x9c40000000000000,
+    0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+    0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068,
+    0x9f4f2726179a2245, 0xed63a231d4c4fb27, 0xb0de65388cc8ada8,
+    0x83c7088e1aab65db, 0xc45d1df942711d9a, 0x924d692ca61be758,
+    0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+    0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d,
+    0x952ab45cfa97a0b3, 0xde469fbd99a05fe3, 0xa59bc234db398c25,
+    0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece, 0x88fcf317f22241e2,
+    0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+    0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410,
+    0x8bab8eefb6409c1a, 0xd01fef10a657842c, 0x9b10a4e5e9913129,
+    0xe7109bfba19c0c9d, 0xac2820d9623bf429, 0x80444b5e7aa7cf85,
+    0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+    0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b,
+};
+
+static const int16_t cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static struct diy_fp cached_power(int e, int *K)
+{
+    /* dk = (-61 - e) * log10(2) + 347, which is always positive */
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    if (dk - k > 0.0)
+        k++;
+
+    unsigned index = (unsigned)((k >> 3) + 1);
+    struct diy_fp fp = { cached_powers_f[index], cached_powers_e[index] };
+
+    *K = -(-348 + (int)(index << 3));
+    return fp;
+}
+
+static const uint32_t pow10_u32[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static const uint64_t pow10_u64[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+static inline int count_decimal_digits(uint32_t n)
+{
+    int nr = 1;
+    while (nr < 10 && n >= pow10_u32[nr])
+        nr++;
+    return nr;
+}
+
+static inline void grisu_round(char *buf, int len, uint64_t delta,
+        uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+            (rest + ten_kappa < wp_w ||
+             wp_w - rest > rest + ten_kappa - wp_w)) {
+        buf[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static int digit_gen(struct diy_fp w, struct diy_fp mp, uint64_t delta,
+        char *buf, int *K)
+{
+    const struct diy_fp one = { 1ULL << -mp.e, mp.e };
+    const uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = count_decimal_digits(p1);
+    int len = 0;
+
+    while (kappa > 0) {
+        uint32_t d = p1 / pow10_u32[kappa - 1];
+        p1 %= pow10_u32[kappa - 1];
+        if (d || len)
+            buf[len++] = (char)('0' + d);
+        kappa--;
+
+        uint64_t tmp = ((uint64_t)p1 << -one.e) + p2;
+        if (tmp <= delta) {
+            *K += kappa;
+            grisu_round(buf, len, delta, tmp,
+                    (uint64_t)pow10_u32[kappa] << -one.e, wp_w);
+            return len;
+        }
+    }
+
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || len)
+            buf[len++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *K += kappa;
+            int index = -kappa;
+            grisu_round(buf, len, delta, p2, one.f,
+                    wp_w * (index < 20 ? pow10_u64[index] : 0));
+            return len;
+        }
+    }
+}
+
+/* generates the digits of a positive finite double; value = digits * 10^K */
+static int grisu2(double value, char *buf, int *K)
+{
+    struct diy_fp v = diy_fp_from_double(value);
+    struct diy_fp w_m, w_p;
+
+    normalized_boundaries(v, &w_m, &w_p);
+
+    struct diy_fp c_mk = cached_power(w_p.e, K);
+    struct diy_fp w = diy_fp_multiply(diy_fp_normalize(v), c_mk);
+    struct diy_fp wp = diy_fp_multiply(w_p, c_mk);
+    struct diy_fp wm = diy_fp_multiply(w_m, c_mk);
+
+    wm.f++;
+    wp.f--;
+    return digit_gen(w, wp, wp.f - wm.f, buf, K);
+}
+
+static int write_exponent(char *p, int exp)
+{
+    char *start = p;
+
+    *p++ = 'e';
+    if (exp < 0) {
+        *p++ = '-';
+        exp = -exp;
+    }
+    else {
+        *p++ = '+';
+    }
+
+    /* like printf(), use at least two digits */
+    if (exp >= 100) {
+        *p++ = (char)('0' + exp / 100);
+        exp %= 100;
+    }
+    *p++ = (char)('0' + exp / 10);
+    *p++ = (char)('0' + exp % 10);
+
+    return (int)(p - start);
+}
+
+int pcutils_dtoa_shortest(double d, int min_precision, char *buf)
+{
+    char *p = buf;
+
+    if (isnan(d)) {
+        strcpy(buf, "nan");
+        return 3;
+    }
+
+    if (signbit(d)) {
+        *p++ = '-';
+        d = -d;
+    }
+
+    if (isinf(d)) {
+        strcpy(p, "inf");
+        return (int)(p - buf) + 3;
+    }
+
+    if (d == 0) {
+        *p++ = '0';
+        *p = 0;
+        return (int)(p - buf);
+    }
+
+    char digits[20];
+    int K;
+    int len = grisu2(d, digits, &K);
+    while (len > 1 && digits[len - 1] == '0') {
+        len--;
+        K++;
+    }
+
+    if (min_precision < 1)
+        min_precision = 1;
+    else if (min_precision > 17)
+        min_precision = 17;
+
+    /* the decimal exponent in the scientific notation */
+    int exp = len + K - 1;
+    int precision = (len > min_precision) ? len : min_precision;
+
+    if (exp < -4 || exp >= precision) {
+        *p++ = digits[0];
+        if (len > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, len - 1);
+            p += len - 1;
+        }
+        p += write_exponent(p, exp);
+    }
+    else if (exp < 0) {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = exp + 1; i < 0; i++)
+            *p++ = '0';
+        memcpy(p, digits, len);
+        p += len;
+    }
+    else if (exp + 1 >= len) {
+        memcpy(p, digits, len);
+        p += len;
+        for (int i = len; i <= exp; i++)
+            *p++ = '0';
+    }
+    else {
+        memcpy(p, digits, exp + 1);
+        p += exp + 1;
+        *p++ = '.';
+        memcpy(p, digits + exp + 1, len - exp - 1);
+        p += len - exp - 1;
+    }
+
+    *p = 0;
+    return (int)(p - buf);
+}
+
+/* the powers of ten which can be represented exactly by a double */
+static const double exact_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+#define MAX_EXACT_POW10         22
+#define MAX_EXACT_MANTISSA      (1ULL << 53)
+
+double pcutils_strtod(const char *str, char **end)
+{
+    /*
+     * Clinger's fast path: when the decimal significand fits in 53 bits
+     * and the power of ten is exact, one multiplication or division gives
+     * the correctly rounded result. Anything else goes to strtod(3).
+     */
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    const char *p = str;
+    bool negative = false;
+
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    if (!purc_isdigit(*p) || (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')))
+        goto slow;
+
+    uint64_t mantissa = 0;
+    int nr_digits = 0;
+    int exp10 = 0;
+
+    while (purc_isdigit(*p)) {
+        if (nr_digits >= 19)
+            goto slow;
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa)
+            nr_digits++;
+        p++;
+    }
+
+    if (*p == '.') {
+        p++;
+        while (purc_isdigit(*p)) {
+            if (nr_digits >= 19)
+                goto slow;
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa)
+                nr_digits++;
+            exp10--;
+            p++;
+        }
+    }
+
+    if (*p == 'e' || *p == 'E') {
+        const char *q = p + 1;
+        bool exp_negative = false;
+        int e = 0;
+
+        if (*q == '-' || *q == '+') {
+            exp_negative = (*q == '-');
+            q++;
+        }
+
+        if (purc_isdigit(*q)) {
+            while (purc_isdigit(*q)) {
+                if (e > 1000)
+                    goto slow;
+                e = e * 10 + (*q - '0');
+                q++;
+            }
+            exp10 += exp_negative ? -e : e;
+            p = q;
+        }
+    }
+
+    if (mantissa > MAX_EXACT_MANTISSA ||
+            exp10 < -MAX_EXACT_POW10 || exp10 > MAX_EXACT_POW10)
+        goto slow;
+
+    double d = (double)mantissa;
+    if (exp10 < 0)
+        d /= exact_pow10[-exp10];
+    else
+        d *= exact_pow10[exp10];
+
+    if (end)
+        *end = (char *)p;
+    return negative ? -d : d;
+
+slow:
+#endif
+    return strtod(str, end);
+}
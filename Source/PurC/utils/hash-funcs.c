@@ -22,6 +22,7 @@
  */
 
 #include "config.h"
+#include "private/utils.h"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -517,3 +518,142 @@ uint32_t pchash_fnv1a_u32_hash(const void *ptr)
     return hval;
 }
 
+
+/*
+ * The hash function of wyhash (final version 4) by Wang Yi, Public Domain.
+ * <https://github.com/wangyi-fudan/wyhash>
+ *
+ * NOTE: the words are read in the native byte order, so the values differ
+ * between little-endian and big-endian machines.
+ */
+static const uint64_t wyhash_secret[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL,
+};
+
+static inline void wyhash_mum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = *a;
+    r *= *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t wyhash_mix(uint64_t a, uint64_t b)
+{
+    wyhash_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wyhash_r8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t wyhash_r4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t wyhash_r3(const uint8_t *p, size_t k)
+{
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+static inline uint64_t wyhash(const void *data, size_t len, uint64_t seed)
+{
+    const uint64_t *secret = wyhash_secret;
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t a, b;
+
+    seed ^= wyhash_mix(seed ^ secret[0], secret[1]);
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (wyhash_r4(p) << 32) | wyhash_r4(p + ((len >> 3) << 2));
+            b = (wyhash_r4(p + len - 4) << 32) |
+                wyhash_r4(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0) {
+            a = wyhash_r3(p, len);
+            b = 0;
+        }
+        else {
+            a = b = 0;
+        }
+    }
+    else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wyhash_mix(wyhash_r8(p) ^ secret[1],
+                        wyhash_r8(p + 8) ^ seed);
+                see1 = wyhash_mix(wyhash_r8(p + 16) ^ secret[2],
+                        wyhash_r8(p + 24) ^ see1);
+                see2 = wyhash_mix(wyhash_r8(p + 32) ^ secret[3],
+                        wyhash_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16) {
+            seed = wyhash_mix(wyhash_r8(p) ^ secret[1],
+                    wyhash_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = wyhash_r8(p + i - 16);
+        b = wyhash_r8(p + i - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    wyhash_mum(&a, &b);
+    return wyhash_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+uint64_t pcutils_hash_bytes(const void *data, size_t len, uint64_t seed)
+{
+    return wyhash(data, len, seed);
+}
+
+/* FNV-1a is faster than wyhash for the short strings (most of the keys),
+   so wyhash is only used for the strings not shorter than 16 bytes. */
+#define FAST_STR_HASH_SHORT     16
+
+uint32_t pchash_fast_str_hash(const void *k)
+{
+    const unsigned char *s = (const unsigned char *)k;
+    uint32_t hval = FNV_INIT;
+
+    for (size_t i = 0; i < FAST_STR_HASH_SHORT; i++) {
+        if (s[i] == 0)
+            return hval;
+
+        hval ^= (uint32_t)s[i];
+        hval *= FNV_PRIME;
+    }
+
+    size_t len = FAST_STR_HASH_SHORT +
+        strlen((const char *)s + FAST_STR_HASH_SHORT);
+    uint64_t v = wyhash(s, len, 0);
+    return (uint32_t)(v ^ (v >> 32));
+}
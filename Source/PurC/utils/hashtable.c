@@ -56,12 +56,13 @@
 #include <gmodule.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /** The minimum/default size of the hash table (must be larger than 4) */
 #define PCHASH_DEFAULT_SIZE     4
 
-/** Define this if you want to sort the entries in a slot */
-#define PCHASH_FLAG_SORTED      0x0001
-
 #define WRLOCK_INIT(t)                          \
         purc_rwlock_init(&(t)->rwlock)
 
@@ -125,25 +126,365 @@ static inline size_t normalize_size(size_t expected)
     return normalized;
 }
 
-struct pchash_table *pchash_table_new(size_t size,
+/*
+ * NOTE: The open-addressing table keeps the pointers to the entries in a
+ * flat array, so the entries never move and the handles returned by the
+ * lookup functions stay valid as in the chained table.
+ *
+ * Each slot has a control byte: CTRL_EMPTY, CTRL_DELETED, or the low 7 bits
+ * of the hash of the entry in it. The slots are probed a group at a time;
+ * the control bytes of a group are compared with SSE2 if it is available,
+ * or with the SWAR tricks on two 64-bit words otherwise.
+ *
+ * When the table needs to grow, the new slots are allocated, and the
+ * entries are moved from the old slots a few groups per insertion or
+ * erasure. The lookups check both of them until the moving is done.
+ */
+#define OPEN_GROUP_WIDTH        16
+#define OPEN_MIN_SIZE           OPEN_GROUP_WIDTH
+#define OPEN_MIGRATE_GROUPS     2
+
+#define CTRL_EMPTY              0x80
+#define CTRL_DELETED            0xFE
+
+/* the maximum load factor is 7/8 */
+static inline size_t open_capacity(size_t size)
+{
+    return size - size / 8;
+}
+
+static inline size_t open_normalize_size(size_t expected)
+{
+    size_t size = OPEN_MIN_SIZE;
+    while (open_capacity(size) < expected && size < ((size_t)1 << 31))
+        size <<= 1;
+    return size;
+}
+
+static inline uint8_t open_h2(uint32_t h)
+{
+    return (uint8_t)(h & 0x7F);
+}
+
+static inline size_t open_first_group(uint32_t h, size_t size)
+{
+    return (h >> 7) & (size / OPEN_GROUP_WIDTH - 1);
+}
+
+#if defined(__SSE2__)
+
+static inline uint32_t group_match(const uint8_t *ctrl, uint8_t h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+}
+
+static inline uint32_t group_match_empty(const uint8_t *ctrl)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group,
+                _mm_set1_epi8((char)CTRL_EMPTY)));
+}
+
+static inline uint32_t group_match_free(const uint8_t *ctrl)
+{
+    /* both CTRL_EMPTY and CTRL_DELETED have the highest bit set */
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(group);
+}
+
+#else   /* defined(__SSE2__) */
+
+#define SWAR_LSBS   UINT64_C(0x0101010101010101)
+#define SWAR_MSBS   UINT64_C(0x8080808080808080)
+
+static inline uint64_t swar_load(const uint8_t *ctrl)
+{
+    uint64_t word;
+    memcpy(&word, ctrl, sizeof(word));
+#if CPU(BIG_ENDIAN)
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+/* gathers the highest bits of the bytes to the lowest 8 bits */
+static inline uint32_t swar_mask(uint64_t msbs)
+{
+    return (uint32_t)(((msbs >> 7) * UINT64_C(0x0102040810204080)) >> 56);
+}
+
+/* NOTE: this may report false positives; the caller checks the entry. */
+static inline uint32_t swar_match(uint64_t word, uint8_t h2)
+{
+    uint64_t x = word ^ (SWAR_LSBS * h2);
+    return swar_mask((x - SWAR_LSBS) & ~x & SWAR_MSBS);
+}
+
+static inline uint32_t group_match(const uint8_t *ctrl, uint8_t h2)
+{
+    return swar_match(swar_load(ctrl), h2) |
+        (swar_match(swar_load(ctrl + 8), h2) << 8);
+}
+
+static inline uint32_t group_match_empty(const uint8_t *ctrl)
+{
+    /* CTRL_EMPTY is the only one with the highest bit set and
+       the second highest bit cleared */
+    uint64_t lo = swar_load(ctrl), hi = swar_load(ctrl + 8);
+    return swar_mask(lo & ~(lo << 1) & SWAR_MSBS) |
+        (swar_mask(hi & ~(hi << 1) & SWAR_MSBS) << 8);
+}
+
+static inline uint32_t group_match_free(const uint8_t *ctrl)
+{
+    return swar_mask(swar_load(ctrl) & SWAR_MSBS) |
+        (swar_mask(swar_load(ctrl + 8) & SWAR_MSBS) << 8);
+}
+
+#endif  /* !defined(__SSE2__) */
+
+static int open_alloc_slots(size_t size, uint8_t **ctrl,
+        struct pchash_entry ***slots)
+{
+    *ctrl = malloc(size);
+    *slots = calloc(size, sizeof(struct pchash_entry *));
+    if (*ctrl == NULL || *slots == NULL) {
+        free(*ctrl);
+        free(*slots);
+        return -1;
+    }
+
+    memset(*ctrl, CTRL_EMPTY, size);
+    return 0;
+}
+
+static pchash_entry_t open_find_in(struct pchash_table *t,
+        const uint8_t *ctrl, struct pchash_entry **slots, size_t size,
+        const void *k, uint32_t h)
+{
+    size_t mask = size / OPEN_GROUP_WIDTH - 1;
+    size_t g = open_first_group(h, size);
+    uint8_t h2 = open_h2(h);
+
+    for (size_t i = 1; ; i++) {
+        const uint8_t *group = ctrl + g * OPEN_GROUP_WIDTH;
+        uint32_t match = group_match(group, h2);
+        while (match) {
+            size_t idx = g * OPEN_GROUP_WIDTH + __builtin_ctz(match);
+            pchash_entry_t e = slots[idx];
+            if (e && e->hash == h && t->keycmp_fn(e->key, k) == 0)
+                return e;
+            match &= match - 1;
+        }
+
+        if (group_match_empty(group) || i > mask)
+            break;
+
+        /* the triangular probing visits all groups */
+        g = (g + i) & mask;
+    }
+
+    return NULL;
+}
+
+static pchash_entry_t open_find_entry(struct pchash_table *t,
+        const void *k, uint32_t h)
+{
+    pchash_entry_t e = open_find_in(t, t->ctrl, t->slots, t->size, k, h);
+    if (e == NULL && t->old_ctrl) {
+        e = open_find_in(t, t->old_ctrl, t->old_slots, t->old_size, k, h);
+    }
+
+    return e;
+}
+
+/* Returns the index of the first free slot on the probing sequence. */
+static size_t open_find_free(const uint8_t *ctrl, size_t size, uint32_t h)
+{
+    size_t mask = size / OPEN_GROUP_WIDTH - 1;
+    size_t g = open_first_group(h, size);
+
+    for (size_t i = 1; ; i++) {
+        uint32_t match = group_match_free(ctrl + g * OPEN_GROUP_WIDTH);
+        if (match)
+            return g * OPEN_GROUP_WIDTH + __builtin_ctz(match);
+
+        g = (g + i) & mask;
+    }
+}
+
+static void open_put_entry(struct pchash_table *t, pchash_entry *ent,
+        bool reserved)
+{
+    size_t idx = open_find_free(t->ctrl, t->size, ent->hash);
+    if (t->ctrl[idx] == CTRL_EMPTY && !reserved) {
+        assert(t->growth_left > 0);
+        t->growth_left--;
+    }
+
+    t->ctrl[idx] = open_h2(ent->hash);
+    t->slots[idx] = ent;
+    ent->slot = (uint32_t)idx;
+}
+
+static inline void open_add_entry(struct pchash_table *t, pchash_entry *ent)
+{
+    open_put_entry(t, ent, false);
+}
+
+/* Clears a slot; returns true if the slot becomes empty. */
+static bool open_clear_slot(uint8_t *ctrl, struct pchash_entry **slots,
+        size_t idx)
+{
+    size_t g = idx / OPEN_GROUP_WIDTH;
+
+    slots[idx] = NULL;
+    /* NOTE: It is safe to mark the slot empty if there is another empty
+       slot in the group, because no probing sequence ever passed this
+       group in that case. */
+    if (group_match_empty(ctrl + g * OPEN_GROUP_WIDTH)) {
+        ctrl[idx] = CTRL_EMPTY;
+        return true;
+    }
+
+    ctrl[idx] = CTRL_DELETED;
+    return false;
+}
+
+static void open_remove_entry(struct pchash_table *t, pchash_entry *e)
+{
+    if (t->old_ctrl && e->slot < t->old_size &&
+            t->old_slots[e->slot] == e) {
+        open_clear_slot(t->old_ctrl, t->old_slots, e->slot);
+        /* the space reserved in the new slots is not needed any more */
+        t->growth_left++;
+    }
+    else {
+        assert(e->slot < t->size && t->slots[e->slot] == e);
+        if (open_clear_slot(t->ctrl, t->slots, e->slot))
+            t->growth_left++;
+    }
+}
+
+static void open_free_old(struct pchash_table *t)
+{
+    free(t->old_ctrl);
+    free(t->old_slots);
+    t->old_ctrl = NULL;
+    t->old_slots = NULL;
+    t->old_size = 0;
+    t->migrated = 0;
+}
+
+/* Moves the entries in the next groups of the old slots to the new ones. */
+static void open_migrate(struct pchash_table *t, size_t nr_groups)
+{
+    size_t total = t->old_size / OPEN_GROUP_WIDTH;
+
+    while (nr_groups-- > 0 && t->migrated < total) {
+        size_t start = t->migrated * OPEN_GROUP_WIDTH;
+        for (size_t idx = start; idx < start + OPEN_GROUP_WIDTH; idx++) {
+            pchash_entry *ent = t->old_slots[idx];
+            if (ent) {
+                t->old_slots[idx] = NULL;
+                t->old_ctrl[idx] = CTRL_DELETED;
+                open_put_entry(t, ent, true);
+            }
+        }
+        t->migrated++;
+    }
+
+    if (t->migrated >= total)
+        open_free_old(t);
+}
+
+/* Starts moving the entries to the new slots of the size. */
+static int open_start_rehash(struct pchash_table *t, size_t size)
+{
+    uint8_t *ctrl;
+    struct pchash_entry **slots;
+
+    /* finish the last moving first */
+    if (t->old_ctrl)
+        open_migrate(t, SIZE_MAX);
+
+    if (open_alloc_slots(size, &ctrl, &slots))
+        return -1;
+
+    t->old_ctrl = t->ctrl;
+    t->old_slots = t->slots;
+    t->old_size = t->size;
+    t->migrated = 0;
+
+    t->ctrl = ctrl;
+    t->slots = slots;
+    t->size = size;
+    /* reserve the space for the entries in the old slots */
+    t->growth_left = open_capacity(size) - t->count;
+    return 0;
+}
+
+static int open_grow(struct pchash_table *t)
+{
+    size_t size = t->size;
+
+    /* reuse the size if more than a half of the used slots are deleted */
+    if (t->count >= open_capacity(size) / 2)
+        size <<= 1;
+
+    return open_start_rehash(t, size);
+}
+
+static int open_rehash(struct pchash_table *t, size_t size)
+{
+    if (size == t->size && t->old_ctrl == NULL)
+        return 0;
+
+    if (open_start_rehash(t, size))
+        return -1;
+
+    open_migrate(t, SIZE_MAX);
+    return 0;
+}
+
+struct pchash_table *pchash_table_new_ex(size_t size,
         pchash_copy_key_fn copy_key, pchash_free_key_fn free_key,
         pchash_copy_val_fn copy_val, pchash_free_val_fn free_val,
         pchash_hash_fn hash_fn, pchash_keycmp_fn keycmp_fn,
-        bool threads, bool sorted)
+        bool threads, unsigned flags)
 {
+    if ((flags & PCHASH_FLAG_OPEN) && (flags & PCHASH_FLAG_SORTED))
+        return NULL;
+
     struct pchash_table *t;
     t = (pchash_table *)calloc(1, sizeof(pchash_table));
     if (!t)
         return NULL;
 
-    if (sorted)
-        t->flags |= PCHASH_FLAG_SORTED;
+    t->flags = flags;
+    if (flags & PCHASH_FLAG_OPEN) {
+        list_head_init(&t->entries);
+        if (open_alloc_slots(open_normalize_size(size),
+                    &t->ctrl, &t->slots)) {
+            free(t);
+            return NULL;
+        }
+        t->size = open_normalize_size(size);
+        t->growth_left = open_capacity(t->size);
+    }
+    else {
+        t->size = normalize_size(size);
+        t->table = (struct list_head *)calloc(t->size,
+                sizeof(struct list_head));
+        if (!t->table) {
+            free(t);
+            return NULL;
+        }
 
-    t->size = normalize_size(size);
-    t->table = (struct list_head *)calloc(t->size, sizeof(struct list_head));
-    if (!t->table) {
-        free(t);
-        return NULL;
+        for (size_t i = 0; i < t->size; i++) {
+            list_head_init(t->table + i);
+        }
     }
 
     t->count = 0;
@@ -154,16 +495,22 @@ struct pchash_table *pchash_table_new(size_t size,
     t->hash_fn = hash_fn;
     t->keycmp_fn = keycmp_fn;
 
-    for (size_t i = 0; i < t->size; i++) {
-        list_head_init(t->table + i);
-    }
-
     if (threads)
         WRLOCK_INIT(t);
 
     return t;
 }
 
+struct pchash_table *pchash_table_new(size_t size,
+        pchash_copy_key_fn copy_key, pchash_free_key_fn free_key,
+        pchash_copy_val_fn copy_val, pchash_free_val_fn free_val,
+        pchash_hash_fn hash_fn, pchash_keycmp_fn keycmp_fn,
+        bool threads, bool sorted)
+{
+    return pchash_table_new_ex(size, copy_key, free_key, copy_val, free_val,
+            hash_fn, keycmp_fn, threads, sorted ? PCHASH_FLAG_SORTED : 0);
+}
+
 static void add_entry_sorted(struct pchash_table *t, pchash_entry *ent)
 {
     struct list_head *list;
@@ -199,11 +546,13 @@ static inline void add_entry(struct pchash_table *t, pchash_entry *ent)
 
 int pchash_table_resize(struct pchash_table *t, size_t new_size)
 {
+    if (t->flags & PCHASH_FLAG_OPEN) {
+        if (new_size < t->count)
+            new_size = t->count;
+        return open_rehash(t, open_normalize_size(new_size));
+    }
+
     size_t normalized = normalize_size(new_size);
-#ifndef NDEBUG
-    printf("curent: %u, expected: %u, normalized: %u\n",
-            (unsigned)t->size, (unsigned)new_size, (unsigned)normalized);
-#endif
     if (normalized == t->size) {
         return 0;
     }
@@ -244,27 +593,48 @@ int pchash_table_resize(struct pchash_table *t, size_t new_size)
     return 0;
 }
 
+static void free_entry_kv(struct pchash_table *t, pchash_entry *c)
+{
+    if (c->free_kv_alt) {
+        c->free_kv_alt(c->key, c->val);
+    }
+    else {
+        if (t->free_key) {
+            t->free_key(c->key);
+        }
+
+        if (t->free_val) {
+            t->free_val(c->val);
+        }
+    }
+}
+
 void pchash_table_reset(struct pchash_table *t)
 {
     struct pchash_entry *c;
 
+    if (t->flags & PCHASH_FLAG_OPEN) {
+        struct list_head *p, *n;
+        list_for_each_safe(p, n, &t->entries) {
+            c = list_entry(p, pchash_entry, list);
+            free_entry_kv(t, c);
+            list_del(&c->list);
+            free_entry(c);
+        }
+
+        open_free_old(t);
+        memset(t->ctrl, CTRL_EMPTY, t->size);
+        memset(t->slots, 0, sizeof(pchash_entry *) * t->size);
+        t->growth_left = open_capacity(t->size);
+        t->count = 0;
+        return;
+    }
+
     for (size_t i = 0; i < t->size; i++) {
         struct list_head *p, *n;
         list_for_each_safe(p, n, t->table + i) {
             c = list_entry(p, pchash_entry, list);
-            if (c->free_kv_alt) {
-                c->free_kv_alt(c->key, c->val);
-            }
-            else {
-                if (t->free_key) {
-                    t->free_key(c->key);
-                }
-
-                if (t->free_val) {
-                    t->free_val(c->val);
-                }
-            }
-
+            free_entry_kv(t, c);
             list_del(&c->list);
             free_entry(c);
         }
@@ -280,6 +650,8 @@ void pchash_table_delete(struct pchash_table *t)
     pchash_table_reset(t);
     WRLOCK_CLEAR(t);
     free(t->table);
+    free(t->ctrl);
+    free(t->slots);
     free(t);
 }
 
@@ -287,7 +659,13 @@ static int insert_entry(struct pchash_table *t,
         const void *k, const void *v, const uint32_t h,
         pchash_free_kv_fn free_kv_alt)
 {
-    if (pchash_table_resize(t, t->count + 1))
+    if (t->flags & PCHASH_FLAG_OPEN) {
+        if (t->old_ctrl)
+            open_migrate(t, OPEN_MIGRATE_GROUPS);
+        if (t->growth_left == 0 && open_grow(t))
+            return -1;
+    }
+    else if (pchash_table_resize(t, t->count + 1))
         return -1;
 
     pchash_entry *ent = alloc_entry_0();
@@ -298,6 +676,13 @@ static int insert_entry(struct pchash_table *t,
     ent->val = (t->copy_val != NULL) ? t->copy_val(v) : (void *)v;
     ent->free_kv_alt = free_kv_alt;
     ent->hash = h;
+    if (t->flags & PCHASH_FLAG_OPEN) {
+        open_add_entry(t, ent);
+        list_add_tail(&ent->list, &t->entries);
+        t->count++;
+        return 0;
+    }
+
     ent->slot = h % t->size;
     if (t->flags & PCHASH_FLAG_SORTED)
         add_entry_sorted(t, ent);
@@ -329,6 +714,9 @@ int pchash_table_insert_ex(struct pchash_table *t,
 static pchash_entry_t find_entry(struct pchash_table *t,
         const void *k, const uint32_t h)
 {
+    if (t->flags & PCHASH_FLAG_OPEN)
+        return open_find_entry(t, k, h);
+
     struct list_head *slot = t->table + h % t->size;
     struct pchash_entry *found = NULL;
 
@@ -415,21 +803,22 @@ bool pchash_table_lookup_ex(struct pchash_table *t, const void *k, void **v)
 
 static int erase_entry(struct pchash_table *t, pchash_entry_t e)
 {
-    assert(e->slot < t->size);
-
-    if (e->free_kv_alt) {
-        e->free_kv_alt(e->key, e->val);
+    if (t->flags & PCHASH_FLAG_OPEN) {
+        /* NOTE: the open-addressing table does not shrink. */
+        open_remove_entry(t, e);
+        free_entry_kv(t, e);
+        list_del(&e->list);
+        free_entry(e);
+        t->count--;
+
+        if (t->old_ctrl)
+            open_migrate(t, OPEN_MIGRATE_GROUPS);
+        return 0;
     }
-    else {
-        if (t->free_key) {
-            t->free_key(e->key);
-        }
 
-        if (t->free_val) {
-            t->free_val(e->val);
-        }
-    }
+    assert(e->slot < t->size);
 
+    free_entry_kv(t, e);
     list_del(&e->list);
     free_entry(e);
 
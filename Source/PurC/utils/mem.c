@@ -35,6 +35,225 @@
 #include "private/instance.h"
 #include "private/errors.h"
 #include "private/mem.h"
+#include "private/tls.h"
+#include "private/variant.h"
+
+#if ENABLE(ALLOC_STATS) && defined(__GLIBC__)
+
+/* The real allocators of glibc; the definitions below take precedence over
+   them for the whole process by the ELF symbol interposition. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+/* NOTE: the initial-exec model does not allocate on the first access. */
+static __thread struct pcutils_alloc_stat alloc_stat
+    __attribute__((tls_model("initial-exec")));
+
+void *malloc(size_t size)
+{
+    alloc_stat.nr_allocs++;
+    alloc_stat.sz_allocs += size;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    alloc_stat.nr_allocs++;
+    alloc_stat.sz_allocs += nmemb * size;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    alloc_stat.nr_allocs++;
+    alloc_stat.sz_allocs += size;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    if (ptr)
+        alloc_stat.nr_frees++;
+    __libc_free(ptr);
+}
+
+#define ALLOC_STATS_COUNTED     true
+
+#else
+
+static struct pcutils_alloc_stat alloc_stat;
+
+#define ALLOC_STATS_COUNTED     false
+
+#endif  /* ENABLE(ALLOC_STATS) && defined(__GLIBC__) */
+
+bool
+pcutils_alloc_stat_get(struct pcutils_alloc_stat *stat)
+{
+    struct pcinst *inst = pcinst_current();
+
+    *stat = alloc_stat;
+    stat->nr_variants = (inst && inst->variant_heap) ?
+        inst->variant_heap->nr_allocs : 0;
+    return ALLOC_STATS_COUNTED;
+}
+
+bool pcutils_allocator_hooked;
+
+static purc_allocator allocator;
+static bool allocator_frozen;
+
+struct allocator_tls {
+    void       *ctxt;       // NULL for the default one
+    struct pcutils_allocator_stat stat;
+};
+
+PURC_DEFINE_THREAD_LOCAL(struct allocator_tls, allocator_tls);
+
+bool
+purc_set_allocator(const purc_allocator *a)
+{
+    if (allocator_frozen)
+        return false;
+
+    if (a == NULL) {
+        memset(&allocator, 0, sizeof(allocator));
+        pcutils_allocator_hooked = false;
+        return true;
+    }
+
+    if (a->malloc == NULL || a->realloc == NULL || a->free == NULL)
+        return false;
+
+    allocator = *a;
+    pcutils_allocator_hooked = true;
+    return true;
+}
+
+void *
+purc_set_allocator_context(void *ctxt)
+{
+    struct allocator_tls *tls = PURC_GET_THREAD_LOCAL(allocator_tls);
+    if (tls == NULL)
+        return NULL;
+
+    void *old = tls->ctxt;
+    tls->ctxt = ctxt;
+    return old;
+}
+
+void
+pcutils_allocator_freeze(void)
+{
+    allocator_frozen = true;
+}
+
+bool
+pcutils_allocator_stat_get(struct pcutils_allocator_stat *stat)
+{
+    struct allocator_tls *tls = PURC_GET_THREAD_LOCAL(allocator_tls);
+
+    if (!pcutils_allocator_hooked || tls == NULL) {
+        memset(stat, 0, sizeof(*stat));
+        return false;
+    }
+
+    *stat = tls->stat;
+    return true;
+}
+
+static inline void *
+get_ctxt(struct allocator_tls *tls)
+{
+    return (tls && tls->ctxt) ? tls->ctxt : allocator.ctxt;
+}
+
+static inline void
+count_alloc(struct allocator_tls *tls, void *ctxt, void *ptr)
+{
+    if (tls == NULL || ptr == NULL)
+        return;
+
+    tls->stat.nr_allocs++;
+    if (allocator.size)
+        tls->stat.sz_allocated += allocator.size(ctxt, ptr);
+}
+
+static inline void
+count_free(struct allocator_tls *tls, void *ctxt, void *ptr)
+{
+    if (tls == NULL || ptr == NULL)
+        return;
+
+    tls->stat.nr_frees++;
+    if (allocator.size)
+        tls->stat.sz_freed += allocator.size(ctxt, ptr);
+}
+
+void *
+pcutils_hooked_malloc(size_t sz)
+{
+    struct allocator_tls *tls = PURC_GET_THREAD_LOCAL(allocator_tls);
+    void *ctxt = get_ctxt(tls);
+
+    void *ptr = allocator.malloc(ctxt, sz);
+    count_alloc(tls, ctxt, ptr);
+    return ptr;
+}
+
+void *
+pcutils_hooked_calloc(size_t n, size_t sz)
+{
+    struct allocator_tls *tls = PURC_GET_THREAD_LOCAL(allocator_tls);
+    void *ctxt = get_ctxt(tls);
+    void *ptr;
+
+    if (allocator.calloc) {
+        ptr = allocator.calloc(ctxt, n, sz);
+    }
+    else {
+        if (sz && n > SIZE_MAX / sz)
+            return NULL;
+        ptr = allocator.malloc(ctxt, n * sz);
+        if (ptr)
+            memset(ptr, 0, n * sz);
+    }
+
+    count_alloc(tls, ctxt, ptr);
+    return ptr;
+}
+
+void *
+pcutils_hooked_realloc(void *ptr, size_t sz)
+{
+    struct allocator_tls *tls = PURC_GET_THREAD_LOCAL(allocator_tls);
+    void *ctxt = get_ctxt(tls);
+    size_t sz_old = (ptr && allocator.size) ? allocator.size(ctxt, ptr) : 0;
+
+    void *new_ptr = allocator.realloc(ctxt, ptr, sz);
+    if (new_ptr && tls) {
+        /* counted as a free of the old block and an allocation */
+        if (ptr) {
+            tls->stat.nr_frees++;
+            tls->stat.sz_freed += sz_old;
+        }
+        count_alloc(tls, ctxt, new_ptr);
+    }
+
+    return new_ptr;
+}
+
+void
+pcutils_hooked_free(void *ptr)
+{
+    struct allocator_tls *tls = PURC_GET_THREAD_LOCAL(allocator_tls);
+    void *ctxt = get_ctxt(tls);
+
+    count_free(tls, ctxt, ptr);
+    allocator.free(ctxt, ptr);
+}
 
 
 pcutils_mem_t *
@@ -49,6 +49,9 @@
 #define pcutils_mraw_data_begin(data)                                           \
     &((uint8_t *) (data))[ pcutils_mraw_meta_size() ]
 
+/* the minimal size of the rest of a reused block to return to the cache */
+#define PCUTILS_MRAW_MIN_SPLIT_SIZE     (PCUTILS_MEM_ALIGN_STEP * 4)
+
 
 static inline void *
 pcutils_mraw_realloc_tail(pcutils_mraw_t *mraw, void *data, void *begin,
@@ -122,6 +125,35 @@ pcutils_mraw_destroy(pcutils_mraw_t *mraw, bool destroy_self)
     return mraw;
 }
 
+/*
+ * NOTE: A block reused from the cache may be much larger than wanted,
+ * e.g., the text of a subtree cleared is reused by a new element.
+ * Returns the rest of the block to the cache instead of wasting it.
+ */
+static inline void
+pcutils_mraw_split(pcutils_mraw_t *mraw, void *data, size_t size)
+{
+    size_t cur_size = pcutils_mraw_data_size(data);
+
+    if (cur_size < size + pcutils_mraw_meta_size()
+            + PCUTILS_MRAW_MIN_SPLIT_SIZE) {
+        return;
+    }
+
+    size_t rest = cur_size - size - pcutils_mraw_meta_size();
+    uint8_t *tail = &((uint8_t *) data)[size];
+
+    pcutils_mraw_data_size_set(data, size);
+    pcutils_mraw_meta_set(tail, &rest);
+
+#if defined(PCHTML_HAVE_ADDRESS_SANITIZER)
+    ASAN_POISON_MEMORY_REGION(tail, rest + pcutils_mraw_meta_size());
+#endif
+
+    pcutils_bst_insert(mraw->cache, pcutils_bst_root_ref(mraw->cache),
+                      rest, pcutils_mraw_data_begin(tail));
+}
+
 static inline void *
 pcutils_mraw_mem_alloc(pcutils_mraw_t *mraw, size_t length)
 {
@@ -223,6 +255,7 @@ pcutils_mraw_alloc(pcutils_mraw_t *mraw, size_t size)
                                         (cur_size + pcutils_mraw_meta_size()));
 #endif
 
+            pcutils_mraw_split(mraw, data, size);
             return data;
         }
     }
@@ -419,3 +452,32 @@ pcutils_mraw_free(pcutils_mraw_t *mraw, void *data)
 
     return NULL;
 }
+
+static void
+pcutils_mraw_stat_cache(pcutils_bst_entry_t *entry,
+                       struct pcutils_mraw_stat *stat)
+{
+    while (entry != NULL) {
+        for (pcutils_bst_entry_t *same = entry; same; same = same->next) {
+            stat->nr_free_blocks++;
+            stat->sz_free += same->size;
+        }
+
+        pcutils_mraw_stat_cache(entry->left, stat);
+        entry = entry->right;
+    }
+}
+
+void
+pcutils_mraw_get_stat(pcutils_mraw_t *mraw, struct pcutils_mraw_stat *stat)
+{
+    pcutils_mem_chunk_t *chunk;
+
+    for (chunk = mraw->mem->chunk_first; chunk != NULL; chunk = chunk->next) {
+        stat->nr_chunks++;
+        stat->sz_reserved += chunk->size;
+        stat->sz_allocated += chunk->length;
+    }
+
+    pcutils_mraw_stat_cache(pcutils_bst_root(mraw->cache), stat);
+}
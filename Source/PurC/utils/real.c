@@ -256,7 +256,7 @@ purc_dump_i64le(unsigned char *dst, purc_real_t real, bool force)
     dst[3] = HIBYTE(HIWORD(LODWORD(real.i64)));
     dst[4] = LOBYTE(LOWORD(HIDWORD(real.i64)));
     dst[5] = HIBYTE(LOWORD(HIDWORD(real.i64)));
-    dst[6] = HIBYTE(HIWORD(HIDWORD(real.i64)));
+    dst[6] = LOBYTE(HIWORD(HIDWORD(real.i64)));
     dst[7] = HIBYTE(HIWORD(HIDWORD(real.i64)));
     return true;
 }
@@ -353,7 +353,7 @@ purc_dump_i64be(unsigned char *dst, purc_real_t real, bool force)
     dst[4] = HIBYTE(HIWORD(LODWORD(real.i64)));
     dst[3] = LOBYTE(LOWORD(HIDWORD(real.i64)));
     dst[2] = HIBYTE(LOWORD(HIDWORD(real.i64)));
-    dst[1] = HIBYTE(HIWORD(HIDWORD(real.i64)));
+    dst[1] = LOBYTE(HIWORD(HIDWORD(real.i64)));
     dst[0] = HIBYTE(HIWORD(HIDWORD(real.i64)));
     return true;
 }
@@ -537,7 +537,7 @@ purc_dump_u64le(unsigned char *dst, purc_real_t real, bool force)
     dst[3] = HIBYTE(HIWORD(LODWORD(real.u64)));
     dst[4] = LOBYTE(LOWORD(HIDWORD(real.u64)));
     dst[5] = HIBYTE(LOWORD(HIDWORD(real.u64)));
-    dst[6] = HIBYTE(HIWORD(HIDWORD(real.u64)));
+    dst[6] = LOBYTE(HIWORD(HIDWORD(real.u64)));
     dst[7] = HIBYTE(HIWORD(HIDWORD(real.u64)));
     return true;
 }
@@ -622,7 +622,7 @@ purc_dump_u64be(unsigned char *dst, purc_real_t real, bool force)
     dst[4] = HIBYTE(HIWORD(LODWORD(real.u64)));
     dst[3] = LOBYTE(LOWORD(HIDWORD(real.u64)));
     dst[2] = HIBYTE(LOWORD(HIDWORD(real.u64)));
-    dst[1] = HIBYTE(HIWORD(HIDWORD(real.u64)));
+    dst[1] = LOBYTE(HIWORD(HIDWORD(real.u64)));
     dst[0] = HIBYTE(HIWORD(HIDWORD(real.u64)));
     return true;
 }
@@ -845,7 +845,7 @@ purc_dump_f32le(unsigned char *dst, purc_real_t real, bool force)
     dst[1] = src[1];
     dst[2] = src[2];
     dst[3] = src[3];
-    return false;
+    return true;
 }
 
 purc_real_t
@@ -873,7 +873,7 @@ purc_dump_f64le(unsigned char *dst, purc_real_t real, bool force)
         dst[i] = src[i];
     }
 
-    return false;
+    return true;
 }
 
 purc_real_t
@@ -990,7 +990,7 @@ purc_dump_f32be(unsigned char *dst, purc_real_t real, bool force)
     dst[2] = src[1];
     dst[1] = src[2];
     dst[0] = src[3];
-    return false;
+    return true;
 }
 
 purc_real_t
@@ -1015,10 +1015,10 @@ purc_dump_f64be(unsigned char *dst, purc_real_t real, bool force)
     uint8_t *src = (uint8_t *)&real.d;
 
     for (int i = 0; i < 8; i++) {
-        dst[i] = src[i];
+        dst[7 - i] = src[i];
     }
 
-    return false;
+    return true;
 }
 
 purc_real_t
@@ -26,12 +26,16 @@
 #include <stdint.h>
 #include <string.h>
 #include <errno.h>
+#include <assert.h>
 
 #include "config.h"
 #include "purc-utils.h"
 #include "purc-errors.h"
 #include "private/errors.h"
 #include "private/regex.h"
+#include "private/instance.h"
+#include "private/list.h"
+#include "private/debug.h"
 
 #if HAVE(GLIB)
 #include <glib.h>
@@ -468,3 +472,166 @@ void pcregex_match_info_destroy(struct pcregex_match_info *match_info)
 }
 
 #endif /* HAVA(GLIB) */
+
+/*
+ * NOTE: the POSIX regular expressions used by the attribute operators, the
+ * executors and the dynamic objects are compiled once per instance; the
+ * cache is small, so a list in LRU order is enough for the lookup.
+ */
+#define MAX_CACHED_REGEXES      32
+
+struct cached_regex {
+    /* keep this as the first member; see pcregex_cache_release() */
+    regex_t                 re;
+
+    struct list_head        ln;
+    char                   *pattern;
+    int                     cflags;
+    int                     refc;
+    bool                    cached;
+};
+
+static void
+free_cached_regex(struct cached_regex *entry)
+{
+    regfree(&entry->re);
+    free(entry->pattern);
+    free(entry);
+}
+
+static void
+uncache_regex(struct pcinst *inst, struct cached_regex *entry)
+{
+    list_del(&entry->ln);
+    inst->nr_regexes--;
+    entry->cached = false;
+
+    /* the entry being used is freed when it is released */
+    if (entry->refc == 0)
+        free_cached_regex(entry);
+}
+
+const regex_t *
+pcregex_cache_get(const char *pattern, int cflags, int *err)
+{
+    struct pcinst *inst = pcinst_current();
+    struct cached_regex *entry;
+
+    if (inst && inst->regexes.next) {
+        list_for_each_entry(entry, &inst->regexes, ln) {
+            if (entry->cflags == cflags &&
+                    strcmp(entry->pattern, pattern) == 0) {
+                list_move(&entry->ln, &inst->regexes);
+                inst->nr_regex_hits++;
+                entry->refc++;
+                return &entry->re;
+            }
+        }
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL || (entry->pattern = strdup(pattern)) == NULL) {
+        free(entry);
+        if (err)
+            *err = REG_ESPACE;
+        return NULL;
+    }
+
+    int r = regcomp(&entry->re, pattern, cflags);
+    if (r) {
+        free(entry->pattern);
+        free(entry);
+        if (err)
+            *err = r;
+        return NULL;
+    }
+
+    entry->cflags = cflags;
+    entry->refc = 1;
+    if (inst && inst->regexes.next) {
+        inst->nr_regex_misses++;
+        if (inst->nr_regexes >= MAX_CACHED_REGEXES) {
+            uncache_regex(inst,
+                    list_last_entry(&inst->regexes, struct cached_regex, ln));
+        }
+
+        list_add(&entry->ln, &inst->regexes);
+        inst->nr_regexes++;
+        entry->cached = true;
+    }
+
+    return &entry->re;
+}
+
+void
+pcregex_cache_release(const regex_t *re)
+{
+    if (re == NULL)
+        return;
+
+    struct cached_regex *entry = (struct cached_regex *)re;
+    assert(entry->refc > 0);
+    if (--entry->refc == 0 && !entry->cached)
+        free_cached_regex(entry);
+}
+
+size_t
+pcregex_cache_trim(size_t nr_keep)
+{
+    struct pcinst *inst = pcinst_current();
+    size_t nr_uncached = 0;
+
+    if (inst == NULL || inst->regexes.next == NULL)
+        return 0;
+
+    while (inst->nr_regexes > nr_keep) {
+        uncache_regex(inst,
+                list_last_entry(&inst->regexes, struct cached_regex, ln));
+        nr_uncached++;
+    }
+
+    return nr_uncached;
+}
+
+void
+pcregex_cache_get_stat(size_t *nr_hits, size_t *nr_misses)
+{
+    struct pcinst *inst = pcinst_current();
+    *nr_hits = inst ? inst->nr_regex_hits : 0;
+    *nr_misses = inst ? inst->nr_regex_misses : 0;
+}
+
+static int regex_init_instance(struct pcinst* inst,
+        const purc_instance_extra_info* extra_info)
+{
+    UNUSED_PARAM(extra_info);
+
+    list_head_init(&inst->regexes);
+    inst->nr_regexes = 0;
+    inst->nr_regex_hits = 0;
+    inst->nr_regex_misses = 0;
+    return 0;
+}
+
+static void regex_cleanup_instance(struct pcinst* inst)
+{
+    PC_DEBUG("Regular expressions got from the cache: %u hits, %u misses\n",
+            (unsigned)inst->nr_regex_hits, (unsigned)inst->nr_regex_misses);
+
+    struct cached_regex *entry, *tmp;
+    list_for_each_entry_safe(entry, tmp, &inst->regexes, ln) {
+        uncache_regex(inst, entry);
+    }
+
+    /* NOTE: the regexes compiled by the later cleanups are not cached */
+    inst->regexes.next = inst->regexes.prev = NULL;
+}
+
+struct pcmodule _module_regex = {
+    .id              = PURC_HAVE_UTILS,
+    .module_inited   = 0,
+
+    .init_once       = NULL,
+    .init_instance   = regex_init_instance,
+    .cleanup_instance = regex_cleanup_instance,
+};
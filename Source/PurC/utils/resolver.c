@@ -0,0 +1,429 @@
+/*
+ * @file resolver.c
+ * @date 2026/10/14
+ * @brief The host resolver with a cache and the warm connections.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "purc-helpers.h"
+#include "private/errors.h"
+#include "private/debug.h"
+#include "private/list.h"
+#include "private/resolver.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <netdb.h>
+
+#define MAX_HOST_ENTRIES        64
+
+/* NOTE: The resolver is shared by all instances. The addresses of a host
+   are kept for a fixed time, since getaddrinfo() does not tell the TTL of
+   the records. The lookups and the connections started by
+   pcutils_resolver_preconnect() run on detached worker threads, so the run
+   loop of an instance never waits for them. */
+struct resolved_addr {
+    int                     family;
+    int                     socktype;
+    int                     protocol;
+    socklen_t               len;
+    struct sockaddr_storage addr;
+};
+
+struct host_entry {
+    struct list_head        ln;
+    char                   *key;
+    time_t                  expires;
+
+    size_t                  nr_addrs;
+    struct resolved_addr   *addrs;
+};
+
+struct warm_conn {
+    struct list_head        ln;
+    char                   *key;
+    time_t                  expires;
+    int                     fd;
+};
+
+struct resolver_job {
+    char                   *host;
+    char                   *port;
+};
+
+static pthread_mutex_t s_resolver_lock = PTHREAD_MUTEX_INITIALIZER;
+static LIST_HEAD(s_hosts);
+static LIST_HEAD(s_warm_conns);
+static size_t s_nr_hosts;
+static size_t s_nr_warm_conns;
+
+static char *make_key(const char *host, const char *port)
+{
+    size_t len = strlen(host) + strlen(port) + 2;
+    char *key = malloc(len);
+    if (key) {
+        snprintf(key, len, "%s:%s", host, port);
+    }
+    return key;
+}
+
+static void destroy_host_entry(struct host_entry *entry)
+{
+    list_del(&entry->ln);
+    s_nr_hosts--;
+    free(entry->key);
+    free(entry->addrs);
+    free(entry);
+}
+
+static struct host_entry *find_host_entry(const char *key)
+{
+    struct host_entry *entry;
+    list_for_each_entry(entry, &s_hosts, ln) {
+        if (strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static struct host_entry *get_host_entry(const char *key)
+{
+    struct host_entry *entry = find_host_entry(key);
+    if (entry) {
+        return entry;
+    }
+
+    if (s_nr_hosts >= MAX_HOST_ENTRIES) {
+        /* evict the oldest one */
+        struct host_entry *oldest;
+        oldest = list_last_entry(&s_hosts, struct host_entry, ln);
+        destroy_host_entry(oldest);
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    entry->key = strdup(key);
+    if (entry->key == NULL) {
+        free(entry);
+        return NULL;
+    }
+
+    list_add(&entry->ln, &s_hosts);
+    s_nr_hosts++;
+    return entry;
+}
+
+/* Copies the addresses of the host if they are still fresh. */
+static struct resolved_addr *lookup_cache(const char *key, size_t *nr_addrs)
+{
+    struct resolved_addr *addrs = NULL;
+
+    pthread_mutex_lock(&s_resolver_lock);
+    struct host_entry *entry = find_host_entry(key);
+    if (entry && entry->nr_addrs > 0 &&
+            entry->expires > purc_get_monotoic_time()) {
+        addrs = malloc(sizeof(*addrs) * entry->nr_addrs);
+        if (addrs) {
+            memcpy(addrs, entry->addrs, sizeof(*addrs) * entry->nr_addrs);
+            *nr_addrs = entry->nr_addrs;
+        }
+    }
+    pthread_mutex_unlock(&s_resolver_lock);
+
+    return addrs;
+}
+
+static void forget_host(const char *key)
+{
+    pthread_mutex_lock(&s_resolver_lock);
+    struct host_entry *entry = find_host_entry(key);
+    if (entry) {
+        destroy_host_entry(entry);
+    }
+    pthread_mutex_unlock(&s_resolver_lock);
+}
+
+/* Resolves the host and keeps a copy of the addresses in the cache. */
+static struct resolved_addr *resolve(const char *host, const char *port,
+        const char *key, size_t *nr_addrs)
+{
+    struct addrinfo hints = { 0 };
+    struct addrinfo *addrinfo, *p;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &addrinfo) != 0) {
+        PC_DEBUG("Error while getting address info (%s:%s)\n", host, port);
+        return NULL;
+    }
+
+    size_t nr = 0;
+    for (p = addrinfo; p != NULL; p = p->ai_next) {
+        if (p->ai_addrlen <= sizeof(struct sockaddr_storage))
+            nr++;
+    }
+
+    struct resolved_addr *addrs = nr ? malloc(sizeof(*addrs) * nr) : NULL;
+    if (addrs == NULL) {
+        freeaddrinfo(addrinfo);
+        return NULL;
+    }
+
+    size_t i = 0;
+    for (p = addrinfo; p != NULL; p = p->ai_next) {
+        if (p->ai_addrlen > sizeof(struct sockaddr_storage))
+            continue;
+
+        addrs[i].family = p->ai_family;
+        addrs[i].socktype = p->ai_socktype;
+        addrs[i].protocol = p->ai_protocol;
+        addrs[i].len = p->ai_addrlen;
+        memcpy(&addrs[i].addr, p->ai_addr, p->ai_addrlen);
+        i++;
+    }
+    freeaddrinfo(addrinfo);
+
+    pthread_mutex_lock(&s_resolver_lock);
+    struct host_entry *entry = get_host_entry(key);
+    if (entry) {
+        struct resolved_addr *copy = malloc(sizeof(*addrs) * nr);
+        if (copy) {
+            memcpy(copy, addrs, sizeof(*addrs) * nr);
+            free(entry->addrs);
+            entry->addrs = copy;
+            entry->nr_addrs = nr;
+            entry->expires = purc_get_monotoic_time() + PCUTILS_RESOLVER_TTL;
+        }
+    }
+    pthread_mutex_unlock(&s_resolver_lock);
+
+    *nr_addrs = nr;
+    return addrs;
+}
+
+static int connect_addrs(const struct resolved_addr *addrs, size_t nr_addrs)
+{
+    for (size_t i = 0; i < nr_addrs; i++) {
+        int fd = socket(addrs[i].family, addrs[i].socktype, addrs[i].protocol);
+        if (fd == -1) {
+            continue;
+        }
+
+        if (connect(fd, (const struct sockaddr *)&addrs[i].addr,
+                    addrs[i].len) == 0) {
+            return fd;
+        }
+        close(fd);
+    }
+
+    return -1;
+}
+
+/* A warm connection is broken if it became readable or hung up before
+   anything was sent over it. */
+static bool is_conn_alive(int fd)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 0;
+}
+
+static int take_warm_conn(const char *key)
+{
+    int fd = -1;
+    time_t now = purc_get_monotoic_time();
+
+    pthread_mutex_lock(&s_resolver_lock);
+    struct warm_conn *p, *n;
+    list_for_each_entry_safe(p, n, &s_warm_conns, ln) {
+        bool expired = p->expires <= now;
+        if (!expired && fd < 0 && strcmp(p->key, key) == 0) {
+            if (is_conn_alive(p->fd)) {
+                fd = p->fd;
+                p->fd = -1;
+            }
+            expired = true;
+        }
+
+        if (expired) {
+            list_del(&p->ln);
+            s_nr_warm_conns--;
+            if (p->fd >= 0)
+                close(p->fd);
+            free(p->key);
+            free(p);
+        }
+    }
+    pthread_mutex_unlock(&s_resolver_lock);
+
+    return fd;
+}
+
+static void keep_warm_conn(char *key, int fd)
+{
+    struct warm_conn *conn = calloc(1, sizeof(*conn));
+    if (conn == NULL) {
+        free(key);
+        close(fd);
+        return;
+    }
+
+    conn->key = key;
+    conn->fd = fd;
+    conn->expires = purc_get_monotoic_time() + PCUTILS_RESOLVER_WARM_TIMEOUT;
+
+    pthread_mutex_lock(&s_resolver_lock);
+    if (s_nr_warm_conns >= PCUTILS_RESOLVER_MAX_WARM) {
+        struct warm_conn *oldest;
+        oldest = list_first_entry(&s_warm_conns, struct warm_conn, ln);
+        list_del(&oldest->ln);
+        s_nr_warm_conns--;
+        close(oldest->fd);
+        free(oldest->key);
+        free(oldest);
+    }
+    list_add_tail(&conn->ln, &s_warm_conns);
+    s_nr_warm_conns++;
+    pthread_mutex_unlock(&s_resolver_lock);
+}
+
+int pcutils_resolver_connect(const char *host, const char *port)
+{
+    char *key = make_key(host, port);
+    if (key == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    int fd = take_warm_conn(key);
+    if (fd >= 0) {
+        goto out;
+    }
+
+    size_t nr_addrs = 0;
+    struct resolved_addr *addrs = lookup_cache(key, &nr_addrs);
+    if (addrs) {
+        fd = connect_addrs(addrs, nr_addrs);
+        free(addrs);
+        if (fd >= 0) {
+            goto out;
+        }
+
+        /* the host may have moved */
+        forget_host(key);
+    }
+
+    addrs = resolve(host, port, key, &nr_addrs);
+    if (addrs) {
+        fd = connect_addrs(addrs, nr_addrs);
+        free(addrs);
+    }
+
+    if (fd < 0) {
+        PC_DEBUG("Failed to connect to %s:%s\n", host, port);
+    }
+
+out:
+    free(key);
+    return fd;
+}
+
+static void destroy_job(struct resolver_job *job)
+{
+    free(job->host);
+    free(job->port);
+    free(job);
+}
+
+static void *resolver_worker(void *arg)
+{
+    struct resolver_job *job = arg;
+    char *key = make_key(job->host, job->port);
+    if (key == NULL) {
+        goto done;
+    }
+
+    size_t nr_addrs = 0;
+    struct resolved_addr *addrs = lookup_cache(key, &nr_addrs);
+    if (addrs == NULL) {
+        addrs = resolve(job->host, job->port, key, &nr_addrs);
+    }
+
+    if (addrs) {
+        int fd = connect_addrs(addrs, nr_addrs);
+        if (fd >= 0) {
+            keep_warm_conn(key, fd);
+            key = NULL;
+        }
+    }
+
+    free(addrs);
+    free(key);
+
+done:
+    destroy_job(job);
+    return NULL;
+}
+
+int pcutils_resolver_preconnect(const char *host, const char *port)
+{
+    struct resolver_job *job = calloc(1, sizeof(*job));
+    if (job == NULL) {
+        goto failed;
+    }
+
+    job->host = strdup(host);
+    job->port = strdup(port);
+    if (job->host == NULL || job->port == NULL) {
+        destroy_job(job);
+        goto failed;
+    }
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = pthread_create(&thread, &attr, resolver_worker, job);
+    pthread_attr_destroy(&attr);
+    if (ret) {
+        destroy_job(job);
+        purc_set_error(PURC_ERROR_SYS_FAULT);
+        return -1;
+    }
+
+    return 0;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return -1;
+}
@@ -28,22 +28,28 @@
 #include "purc-utils.h"
 #include "private/errors.h"
 #include "private/instance.h"
+#include "private/stringbuilder.h"
+#include "private/rwstream.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <zlib.h>
 
 #if OS(UNIX)
 #include <sys/types.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #endif // 0S(UNIX)
 
 #include "rwstream_err_msgs.inc"
 
 #define BUFFER_SIZE 4096
 #define MIN_BUFFER_SIZE 32
+#define BUFFER_CHUNK_SIZE 16384
 
 /* Make sure the number of error messages matches the number of error codes */
 #define _COMPILE_TIME_ASSERT(name, x)               \
@@ -104,6 +110,9 @@ struct mem_rwstream
     uint8_t* base;
     uint8_t* here;
     uint8_t* stop;
+
+    pcrws_cb_release release;
+    void* release_ctxt;
 };
 
 struct buffer_rwstream
@@ -116,6 +125,9 @@ struct buffer_rwstream
     size_t sz;
     size_t sz_max;
 
+    /* the data appended beyond `end`, not flattened yet */
+    struct pcutils_stringbuilder tail;
+
     bool buff_reserved;
 };
 
@@ -125,6 +137,25 @@ struct fd_rwstream
     purc_rwstream rwstream;
     int fd;
 };
+
+/* NOTE: A buffered fd stream reads at most one block with one call of
+   read(), so a read never blocks once some bytes are in the buffer;
+   the written bytes are kept until the buffer is full, the stream is
+   flushed, sought, or destroyed. */
+struct fdbuf_rwstream
+{
+    purc_rwstream rwstream;
+    int fd;
+
+    uint8_t* rbuf;
+    size_t sz_rbuf;
+    size_t rpos;
+    size_t nr_rbytes;
+
+    uint8_t* wbuf;
+    size_t sz_wbuf;
+    size_t nr_wbytes;
+};
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
 static off_t stdio_seek (purc_rwstream_t rws, off_t offset, int whence);
@@ -163,6 +194,18 @@ static rwstream_funcs mem_funcs = {
     mem_get_mem_buffer
 };
 
+/* for the read-only memory, e.g., a file mapped by
+   purc_rwstream_new_from_mmap() */
+static rwstream_funcs mem_ro_funcs = {
+    mem_seek,
+    mem_tell,
+    mem_read,
+    NULL,
+    NULL,
+    mem_destroy,
+    mem_get_mem_buffer
+};
+
 static off_t buffer_seek (purc_rwstream_t rws, off_t offset, int whence);
 static off_t buffer_tell (purc_rwstream_t rws);
 static ssize_t buffer_read (purc_rwstream_t rws, void* buf, size_t count);
@@ -189,6 +232,7 @@ static off_t fd_seek (purc_rwstream_t rws, off_t offset, int whence);
 static off_t fd_tell (purc_rwstream_t rws);
 static ssize_t fd_read (purc_rwstream_t rws, void* buf, size_t count);
 static ssize_t fd_write (purc_rwstream_t rws, const void* buf, size_t count);
+static ssize_t fd_flush (purc_rwstream_t rws);
 static int fd_destroy (purc_rwstream_t rws);
 
 static rwstream_funcs fd_funcs = {
@@ -196,10 +240,28 @@ static rwstream_funcs fd_funcs = {
     fd_tell,
     fd_read,
     fd_write,
-    NULL,           // flush
+    fd_flush,
     fd_destroy,
     NULL,
 };
+
+static off_t fdbuf_seek (purc_rwstream_t rws, off_t offset, int whence);
+static off_t fdbuf_tell (purc_rwstream_t rws);
+static ssize_t fdbuf_read (purc_rwstream_t rws, void* buf, size_t count);
+static ssize_t fdbuf_write (purc_rwstream_t rws, const void* buf,
+        size_t count);
+static ssize_t fdbuf_flush (purc_rwstream_t rws);
+static int fdbuf_destroy (purc_rwstream_t rws);
+
+static rwstream_funcs fdbuf_funcs = {
+    fdbuf_seek,
+    fdbuf_tell,
+    fdbuf_read,
+    fdbuf_write,
+    fdbuf_flush,
+    fdbuf_destroy,
+    NULL,
+};
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
 static size_t get_min_size(size_t sz_min, size_t sz_max) {
@@ -236,6 +298,7 @@ purc_rwstream_t purc_rwstream_new_buffer (size_t sz_init, size_t sz_max)
     rws->end = rws->base + sz;
     rws->sz = sz;
     rws->sz_max = sz_max;
+    pcutils_stringbuilder_init(&rws->tail, BUFFER_CHUNK_SIZE);
 
     rws->buff_reserved = false;
 
@@ -255,6 +318,118 @@ purc_rwstream_t purc_rwstream_new_from_mem (void* mem, size_t sz)
     return (purc_rwstream_t)rws;
 }
 
+purc_rwstream_t purc_rwstream_new_from_mem_ex (void* mem, size_t sz,
+        pcrws_cb_release release, void *ctxt)
+{
+    if (mem == NULL) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    struct mem_rwstream* rws = (struct mem_rwstream*) calloc(
+            1, sizeof(struct mem_rwstream));
+    if (rws == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    rws->rwstream.funcs = &mem_funcs;
+    rws->base = mem;
+    rws->here = rws->base;
+    rws->stop = rws->base + sz;
+    rws->release = release;
+    rws->release_ctxt = ctxt;
+
+    return (purc_rwstream_t)rws;
+}
+
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+static void unmap_file (void *ctxt, void *mem, size_t sz)
+{
+    UNUSED_PARAM(ctxt);
+    munmap (mem, sz);
+}
+
+static purc_rwstream_t map_file (int fd, size_t sz)
+{
+    /* mmap() fails for an empty file */
+    if (sz == 0) {
+        static char empty[1];
+        purc_rwstream_t rws = purc_rwstream_new_from_mem (empty, 0);
+        if (rws)
+            rws->funcs = &mem_ro_funcs;
+        return rws;
+    }
+
+    void *mem = mmap (NULL, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mem == MAP_FAILED) {
+        pcinst_set_error (purc_error_from_errno (errno));
+        return NULL;
+    }
+
+    /* the contents are usually consumed from the start to the end */
+    madvise (mem, sz, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mem_ex (mem, sz,
+            unmap_file, NULL);
+    if (rws == NULL) {
+        munmap (mem, sz);
+        return NULL;
+    }
+
+    rws->funcs = &mem_ro_funcs;
+    return rws;
+}
+#endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
+
+purc_rwstream_t purc_rwstream_new_from_mmap (const char* file)
+{
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    int fd = open (file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        pcinst_set_error (purc_error_from_errno (errno));
+        return NULL;
+    }
+
+    purc_rwstream_t rws = NULL;
+    struct stat st;
+    if (fstat (fd, &st)) {
+        pcinst_set_error (purc_error_from_errno (errno));
+    }
+    else if (!S_ISREG (st.st_mode)) {
+        pcinst_set_error (PURC_ERROR_INVALID_VALUE);
+    }
+    else {
+        rws = map_file (fd, st.st_size);
+    }
+
+    /* the mapping stays valid after the file is closed */
+    close (fd);
+    return rws;
+#else
+    UNUSED_PARAM(file);
+    pcinst_set_error (PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+#endif
+}
+
+purc_rwstream_t pcrwstream_new_for_reading (const char *file)
+{
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    struct stat st;
+    if (stat (file, &st) == 0 && S_ISREG (st.st_mode) &&
+            st.st_size >= PCRWSTREAM_MMAP_MIN_SIZE) {
+        purc_rwstream_t rws = purc_rwstream_new_from_mmap (file);
+        if (rws) {
+            return rws;
+        }
+        purc_clr_error ();
+    }
+#endif
+
+    return purc_rwstream_new_from_file (file, "r");
+}
+
 purc_rwstream_t purc_rwstream_new_from_file (const char* file, const char* mode)
 {
     FILE* fp = fopen(file, mode);
@@ -296,6 +471,50 @@ purc_rwstream_t purc_rwstream_new_from_unix_fd (int fd)
 #endif
 }
 
+purc_rwstream_t
+purc_rwstream_new_from_unix_fd_buffered (int fd, size_t sz_rbuf, size_t sz_wbuf)
+{
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    struct fdbuf_rwstream* fd_rws = (struct fdbuf_rwstream*) calloc(
+            1, sizeof(struct fdbuf_rwstream));
+    if (fd_rws == NULL) {
+        goto failed;
+    }
+
+    if (sz_rbuf > 0) {
+        fd_rws->rbuf = (uint8_t*) malloc(sz_rbuf);
+        if (fd_rws->rbuf == NULL)
+            goto failed;
+        fd_rws->sz_rbuf = sz_rbuf;
+    }
+
+    if (sz_wbuf > 0) {
+        fd_rws->wbuf = (uint8_t*) malloc(sz_wbuf);
+        if (fd_rws->wbuf == NULL)
+            goto failed;
+        fd_rws->sz_wbuf = sz_wbuf;
+    }
+
+    fd_rws->rwstream.funcs = &fdbuf_funcs;
+    fd_rws->fd = fd;
+    return (purc_rwstream_t)fd_rws;
+
+failed:
+    if (fd_rws) {
+        free(fd_rws->rbuf);
+        free(fd_rws);
+    }
+    pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
+#else
+    UNUSED_PARAM(fd);
+    UNUSED_PARAM(sz_rbuf);
+    UNUSED_PARAM(sz_wbuf);
+    pcinst_set_error(PURC_ERROR_NOT_IMPLEMENTED);
+    return NULL;
+#endif
+}
+
 purc_rwstream_t purc_rwstream_new_from_win32_socket (int socket, size_t sz_buf)
 {
     UNUSED_PARAM(socket);
@@ -410,6 +629,404 @@ purc_rwstream_new_for_read (void *ctxt, pcrws_cb_read fn)
     return (purc_rwstream_t)rws;
 }
 
+/* NOTE: A filter stream keeps only one buffer of the encoded data; the
+   data read or written are transformed chunk by chunk, so a large file
+   is never loaded into memory as a whole. */
+#define FILTER_BUFFER_SIZE      4096
+#define B64_DECODED_SIZE        (FILTER_BUFFER_SIZE / 4 * 3)
+
+struct filter_rwstream
+{
+    purc_rwstream rwstream;
+    purc_rwstream_t base;
+    pcrws_filter_k type;
+    bool for_write;
+    bool eof;
+    bool in_member;
+    off_t pos;
+
+    /* the data read from or to be written to the base stream */
+    unsigned char buf[FILTER_BUFFER_SIZE];
+    size_t pos_buf;
+    size_t nr_buf;
+
+    /* for gzip */
+    z_stream zs;
+
+    /* for base64: the characters or the bytes of a partial group */
+    char group[FILTER_BUFFER_SIZE + 1];
+    size_t nr_group;
+    unsigned char decoded[B64_DECODED_SIZE];
+    size_t pos_decoded;
+    size_t nr_decoded;
+};
+
+static int filter_write_base (struct filter_rwstream *flt,
+        const void *buf, size_t count)
+{
+    const char *p = buf;
+    while (count > 0) {
+        ssize_t n = purc_rwstream_write (flt->base, p, count);
+        if (n <= 0)
+            return -1;
+        p += n;
+        count -= n;
+    }
+
+    return 0;
+}
+
+static void filter_flush_base (struct filter_rwstream *flt)
+{
+    if (flt->base->funcs->flush)
+        flt->base->funcs->flush (flt->base);
+}
+
+static int gzip_deflate (struct filter_rwstream *flt, int flush)
+{
+    z_stream *zs = &flt->zs;
+    int ret;
+
+    do {
+        zs->next_out = flt->buf;
+        zs->avail_out = sizeof(flt->buf);
+        ret = deflate (zs, flush);
+        if (ret == Z_STREAM_ERROR) {
+            pcinst_set_error (PURC_ERROR_INVALID_VALUE);
+            return -1;
+        }
+
+        size_t produced = sizeof(flt->buf) - zs->avail_out;
+        if (produced > 0 && filter_write_base (flt, flt->buf, produced))
+            return -1;
+    } while (zs->avail_out == 0 ||
+            (flush == Z_FINISH && ret != Z_STREAM_END));
+
+    return 0;
+}
+
+static ssize_t gzip_write (purc_rwstream_t rws, const void* buf, size_t count)
+{
+    struct filter_rwstream *flt = (struct filter_rwstream *)rws;
+
+    flt->zs.next_in = (Bytef *)buf;
+    flt->zs.avail_in = count;
+    if (gzip_deflate (flt, Z_NO_FLUSH))
+        return -1;
+
+    flt->pos += count;
+    return count;
+}
+
+static ssize_t gzip_read (purc_rwstream_t rws, void* buf, size_t count)
+{
+    struct filter_rwstream *flt = (struct filter_rwstream *)rws;
+    z_stream *zs = &flt->zs;
+    bool base_failed = false;
+
+    zs->next_out = buf;
+    zs->avail_out = count;
+    for (;;) {
+        int ret = inflate (zs, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            /* there may be another member after this one */
+            inflateReset (zs);
+            flt->in_member = false;
+        }
+        else if (ret == Z_OK) {
+            flt->in_member = true;
+        }
+        else if (ret != Z_BUF_ERROR) {
+            pcinst_set_error (PURC_ERROR_BAD_ENCODING);
+            return -1;
+        }
+
+        if (zs->avail_out == 0)
+            break;
+
+        if (zs->avail_in == 0) {
+            if (flt->eof)
+                break;
+
+            ssize_t n = purc_rwstream_read (flt->base, flt->buf,
+                    sizeof(flt->buf));
+            if (n <= 0) {
+                /* a non-blocking base stream may have no data for now */
+                if (n == 0)
+                    flt->eof = true;
+                else
+                    base_failed = true;
+                break;
+            }
+
+            zs->next_in = flt->buf;
+            zs->avail_in = n;
+        }
+    }
+
+    size_t produced = count - zs->avail_out;
+    if (produced == 0) {
+        if (base_failed)
+            return -1;
+        if (flt->eof && flt->in_member) {
+            /* truncated */
+            pcinst_set_error (PURC_ERROR_BAD_ENCODING);
+            return -1;
+        }
+    }
+
+    flt->pos += produced;
+    return produced;
+}
+
+static ssize_t b64_write (purc_rwstream_t rws, const void* buf, size_t count)
+{
+    struct filter_rwstream *flt = (struct filter_rwstream *)rws;
+    const unsigned char *p = buf;
+    size_t left = count;
+
+    /* complete the partial group first */
+    while (flt->nr_group > 0 && flt->nr_group < 3 && left > 0) {
+        flt->group[flt->nr_group++] = *p++;
+        left--;
+    }
+
+    if (flt->nr_group == 3) {
+        ssize_t n = pcutils_b64_encode (flt->group, 3,
+                flt->buf, sizeof(flt->buf));
+        if (n < 0 || filter_write_base (flt, flt->buf, n))
+            return -1;
+        flt->nr_group = 0;
+    }
+
+    while (left >= 3) {
+        /* keep a room for the terminating null character */
+        size_t chunk = (sizeof(flt->buf) / 4 - 1) * 3;
+        if (chunk > left)
+            chunk = left / 3 * 3;
+
+        ssize_t n = pcutils_b64_encode (p, chunk, flt->buf, sizeof(flt->buf));
+        if (n < 0 || filter_write_base (flt, flt->buf, n))
+            return -1;
+        p += chunk;
+        left -= chunk;
+    }
+
+    memcpy (flt->group + flt->nr_group, p, left);
+    flt->nr_group += left;
+
+    flt->pos += count;
+    return count;
+}
+
+static ssize_t b64_read (purc_rwstream_t rws, void* buf, size_t count)
+{
+    struct filter_rwstream *flt = (struct filter_rwstream *)rws;
+    unsigned char *p = buf;
+    size_t done = 0;
+    bool base_failed = false;
+
+    while (done < count) {
+        if (flt->pos_decoded < flt->nr_decoded) {
+            size_t n = flt->nr_decoded - flt->pos_decoded;
+            if (n > count - done)
+                n = count - done;
+            memcpy (p + done, flt->decoded + flt->pos_decoded, n);
+            flt->pos_decoded += n;
+            done += n;
+            continue;
+        }
+
+        /* collect the characters; read the base stream only if there is
+           not a whole group */
+        while (flt->nr_group < FILTER_BUFFER_SIZE) {
+            if (flt->pos_buf == flt->nr_buf) {
+                if (flt->eof || flt->nr_group >= 4)
+                    break;
+
+                ssize_t n = purc_rwstream_read (flt->base, flt->buf,
+                        sizeof(flt->buf));
+                if (n <= 0) {
+                    if (n == 0)
+                        flt->eof = true;
+                    else
+                        base_failed = true;
+                    break;
+                }
+                flt->pos_buf = 0;
+                flt->nr_buf = n;
+            }
+
+            int ch = flt->buf[flt->pos_buf++];
+            if (!purc_isspace (ch))
+                flt->group[flt->nr_group++] = ch;
+        }
+
+        size_t nr_chars = flt->nr_group / 4 * 4;
+        if (flt->eof && flt->pos_buf == flt->nr_buf)
+            nr_chars = flt->nr_group;
+        if (nr_chars == 0)
+            break;
+
+        char saved = flt->group[nr_chars];
+        flt->group[nr_chars] = '\0';
+        ssize_t n = pcutils_b64_decode (flt->group, flt->decoded,
+                sizeof(flt->decoded));
+        flt->group[nr_chars] = saved;
+        if (n < 0) {
+            pcinst_set_error (PURC_ERROR_BAD_ENCODING);
+            return -1;
+        }
+
+        flt->nr_group -= nr_chars;
+        memmove (flt->group, flt->group + nr_chars, flt->nr_group);
+        flt->pos_decoded = 0;
+        flt->nr_decoded = n;
+    }
+
+    if (done == 0 && base_failed)
+        return -1;
+
+    flt->pos += done;
+    return done;
+}
+
+static off_t filter_tell (purc_rwstream_t rws)
+{
+    struct filter_rwstream *flt = (struct filter_rwstream *)rws;
+
+    return flt->pos;
+}
+
+static ssize_t filter_flush (purc_rwstream_t rws)
+{
+    struct filter_rwstream *flt = (struct filter_rwstream *)rws;
+
+    if (flt->for_write && flt->type == PCRWS_FILTER_GZIP) {
+        flt->zs.next_in = NULL;
+        flt->zs.avail_in = 0;
+        if (gzip_deflate (flt, Z_SYNC_FLUSH))
+            return -1;
+    }
+
+    /* a partial group of base64 can only be written when destroying */
+    filter_flush_base (flt);
+    return 0;
+}
+
+static int filter_destroy (purc_rwstream_t rws)
+{
+    struct filter_rwstream *flt = (struct filter_rwstream *)rws;
+    int ret = 0;
+
+    if (flt->type == PCRWS_FILTER_GZIP) {
+        if (flt->for_write) {
+            flt->zs.next_in = NULL;
+            flt->zs.avail_in = 0;
+            ret = gzip_deflate (flt, Z_FINISH);
+            deflateEnd (&flt->zs);
+        }
+        else {
+            inflateEnd (&flt->zs);
+        }
+    }
+    else if (flt->for_write && flt->nr_group > 0) {
+        ssize_t n = pcutils_b64_encode (flt->group, flt->nr_group,
+                flt->buf, sizeof(flt->buf));
+        if (n < 0 || filter_write_base (flt, flt->buf, n))
+            ret = -1;
+    }
+
+    if (flt->for_write)
+        filter_flush_base (flt);
+    purc_rwstream_destroy (flt->base);
+    free (flt);
+    return ret;
+}
+
+static rwstream_funcs gzip_write_funcs = {
+    NULL,
+    filter_tell,
+    NULL,
+    gzip_write,
+    filter_flush,
+    filter_destroy,
+    NULL
+};
+
+static rwstream_funcs gzip_read_funcs = {
+    NULL,
+    filter_tell,
+    gzip_read,
+    NULL,
+    NULL,
+    filter_destroy,
+    NULL
+};
+
+static rwstream_funcs b64_write_funcs = {
+    NULL,
+    filter_tell,
+    NULL,
+    b64_write,
+    filter_flush,
+    filter_destroy,
+    NULL
+};
+
+static rwstream_funcs b64_read_funcs = {
+    NULL,
+    filter_tell,
+    b64_read,
+    NULL,
+    NULL,
+    filter_destroy,
+    NULL
+};
+
+purc_rwstream_t
+purc_rwstream_new_filter (purc_rwstream_t base, pcrws_filter_k filter,
+        bool for_write)
+{
+    if (base == NULL ||
+            (filter != PCRWS_FILTER_GZIP && filter != PCRWS_FILTER_BASE64)) {
+        pcinst_set_error (PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    struct filter_rwstream* rws = (struct filter_rwstream*) calloc(1,
+            sizeof (struct filter_rwstream));
+    if (rws == NULL) {
+        pcinst_set_error (PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    if (filter == PCRWS_FILTER_GZIP) {
+        int ret;
+        /* 16 for a gzip wrapper; 32 for detecting gzip or zlib wrapper */
+        if (for_write)
+            ret = deflateInit2 (&rws->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                    MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+        else
+            ret = inflateInit2 (&rws->zs, MAX_WBITS + 32);
+        if (ret != Z_OK) {
+            free (rws);
+            pcinst_set_error (PURC_ERROR_OUT_OF_MEMORY);
+            return NULL;
+        }
+
+        rws->rwstream.funcs = for_write ? &gzip_write_funcs : &gzip_read_funcs;
+    }
+    else {
+        rws->rwstream.funcs = for_write ? &b64_write_funcs : &b64_read_funcs;
+    }
+
+    rws->base = base;
+    rws->type = filter;
+    rws->for_write = for_write;
+    return (purc_rwstream_t)rws;
+}
+
 int purc_rwstream_destroy (purc_rwstream_t rws)
 {
     if (rws == NULL) {
@@ -635,6 +1252,43 @@ ssize_t purc_rwstream_dump_to_another (purc_rwstream_t in,
     return ret_count;
 }
 
+ssize_t purc_rwstream_write_base64 (purc_rwstream_t rws, const void *src,
+        size_t len)
+{
+    /* the encoded characters of a chunk and the terminating null byte */
+    char buffer[BUFFER_SIZE + 1];
+    const unsigned char *p = src;
+    ssize_t nr_written = 0;
+
+    if (rws == NULL || (src == NULL && len > 0)) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    while (len > 0) {
+        size_t chunk = BUFFER_SIZE / 4 * 3;
+        if (chunk > len)
+            chunk = len;
+
+        ssize_t n = pcutils_b64_encode (p, chunk, buffer, sizeof(buffer));
+
+        const char *q = buffer;
+        while (n > 0) {
+            ssize_t written = purc_rwstream_write (rws, q, n);
+            if (written <= 0)
+                return nr_written > 0 ? nr_written : -1;
+            q += written;
+            n -= written;
+            nr_written += written;
+        }
+
+        p += chunk;
+        len -= chunk;
+    }
+
+    return nr_written;
+}
+
 void* purc_rwstream_get_mem_buffer_ex (purc_rwstream_t rws,
         size_t *sz_content, size_t *sz_buffer, bool res_buff)
 {
@@ -777,6 +1431,9 @@ static ssize_t mem_flush (purc_rwstream_t rws)
 static int mem_destroy (purc_rwstream_t rws)
 {
     struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    if (mem->release) {
+        mem->release(mem->release_ctxt, mem->base, mem->stop - mem->base);
+    }
     mem->base = NULL;
     mem->here = NULL;
     mem->stop = NULL;
@@ -824,8 +1481,38 @@ static int buffer_extend (struct buffer_rwstream* buffer, size_t size)
     buffer->stop = buffer->base + stop_offset;
     buffer->end = buffer->base + new_size;
     buffer->sz = new_size;
+    *buffer->stop = 0;
+
+    return 0;
+}
+
+/* NOTE: The data written at the end of a buffer stream which go beyond the
+   allocated space are appended to a list of fixed-size chunks, instead of
+   reallocating and copying the buffer again and again. The chunks are
+   flattened into the buffer by one reallocation when the contents are
+   accessed, i.e., when reading, seeking, or getting the memory buffer.
+   While there are chunks not flattened, `here` is at the end of the
+   contents. */
+static int buffer_flatten (struct buffer_rwstream* buffer)
+{
+    size_t sz_tail = buffer->tail.total;
+    if (sz_tail == 0) {
+        return 0;
+    }
+
+    if (buffer->tail.oom ||
+            buffer_extend (buffer, buffer->stop - buffer->base + sz_tail)) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    pcutils_stringbuilder_copy (&buffer->tail, buffer->stop);
+    buffer->stop += sz_tail;
+    buffer->here = buffer->stop;
     *buffer->here = 0;
 
+    pcutils_stringbuilder_reset (&buffer->tail);
+    pcutils_stringbuilder_init (&buffer->tail, BUFFER_CHUNK_SIZE);
     return 0;
 }
 
@@ -834,6 +1521,9 @@ static off_t buffer_seek (purc_rwstream_t rws, off_t offset, int whence)
     struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
     uint8_t* newpos;
 
+    if (buffer_flatten (buffer))
+        return -1;
+
     switch (whence) {
         case SEEK_SET:
             newpos = buffer->base + offset;
@@ -861,12 +1551,15 @@ static off_t buffer_seek (purc_rwstream_t rws, off_t offset, int whence)
 static off_t buffer_tell (purc_rwstream_t rws)
 {
     struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
-    return (buffer->here - buffer->base);
+    return (buffer->here - buffer->base) + buffer->tail.total;
 }
 
 static ssize_t buffer_read (purc_rwstream_t rws, void* buf, size_t count)
 {
     struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+    if (buffer_flatten (buffer))
+        return -1;
+
     if ( (buffer->here + count) > buffer->stop )
     {
         count = buffer->stop - buffer->here;
@@ -876,10 +1569,43 @@ static ssize_t buffer_read (purc_rwstream_t rws, void* buf, size_t count)
     return count;
 }
 
+static ssize_t buffer_append (struct buffer_rwstream* buffer,
+        const void* buf, size_t count)
+{
+    size_t sz_content = buffer->stop - buffer->base + buffer->tail.total;
+    if (count > buffer->sz_max - sz_content) {
+        count = buffer->sz_max - sz_content;
+    }
+
+    /* fill the room left in the buffer first */
+    size_t room = buffer->end - buffer->stop;
+    if (room > count) {
+        room = count;
+    }
+    if (room > 0) {
+        memcpy(buffer->stop, buf, room);
+        buffer->stop += room;
+        buffer->here = buffer->stop;
+        *buffer->here = 0;
+    }
+
+    if (count > room && pcutils_stringbuilder_append (&buffer->tail,
+                (const uint8_t *)buf + room, count - room)) {
+        pcinst_set_error(PCRWSTREAM_ERROR_NO_SPACE);
+        return -1;
+    }
+
+    return count;
+}
+
 static ssize_t buffer_write (purc_rwstream_t rws, const void* buf, size_t count)
 {
     struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
     uint8_t* newpos = buffer->here + count;
+    if (buffer->here == buffer->stop && newpos > buffer->end) {
+        return buffer_append (buffer, buf, count);
+    }
+
     if ( newpos > buffer->stop ) {
         if (newpos <= buffer->end) {
             buffer->stop = newpos;
@@ -908,7 +1634,7 @@ static ssize_t buffer_write (purc_rwstream_t rws, const void* buf, size_t count)
     {
         memcpy(buffer->here, buf, count);
         buffer->here += count;
-        *buffer->here = 0;
+        *buffer->stop = 0;
         return count;
     }
     return 0;
@@ -926,6 +1652,7 @@ static int buffer_destroy (purc_rwstream_t rws)
     if (buffer->base && !buffer->buff_reserved) {
         free(buffer->base);
     }
+    pcutils_stringbuilder_reset(&buffer->tail);
     free(rws);
     return 0;
 }
@@ -935,6 +1662,9 @@ static void* buffer_get_mem_buffer (purc_rwstream_t rws,
 {
     struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
 
+    if (buffer_flatten (buffer))
+        return NULL;
+
     if (sz_content) {
         *sz_content = buffer->stop - buffer->base;
     }
@@ -990,10 +1720,152 @@ static ssize_t fd_write (purc_rwstream_t rws, const void* buf, size_t count)
     return ret;
 }
 
+static ssize_t fd_flush (purc_rwstream_t rws)
+{
+    UNUSED_PARAM(rws);
+    /* nothing is buffered */
+    return 0;
+}
+
 static int fd_destroy (purc_rwstream_t rws)
 {
     free(rws);
     return 0;
 }
 
+/* writes all bytes unless failed; returns the number of bytes written */
+static ssize_t fdbuf_write_all (int fd, const uint8_t* buf, size_t count)
+{
+    size_t done = 0;
+    while (done < count) {
+        ssize_t ret = write(fd, buf + done, count - done);
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            purc_set_error(purc_error_from_errno(errno));
+            break;
+        }
+        done += ret;
+    }
+
+    return done;
+}
+
+static ssize_t fdbuf_flush (purc_rwstream_t rws)
+{
+    struct fdbuf_rwstream* fd_rws = (struct fdbuf_rwstream *)rws;
+    if (fd_rws->nr_wbytes == 0)
+        return 0;
+
+    size_t done = fdbuf_write_all(fd_rws->fd, fd_rws->wbuf,
+            fd_rws->nr_wbytes);
+    if (done < fd_rws->nr_wbytes) {
+        /* keep the bytes not written for the next flush */
+        memmove(fd_rws->wbuf, fd_rws->wbuf + done, fd_rws->nr_wbytes - done);
+        fd_rws->nr_wbytes -= done;
+        return -1;
+    }
+
+    fd_rws->nr_wbytes = 0;
+    return done;
+}
+
+static off_t fdbuf_seek (purc_rwstream_t rws, off_t offset, int whence)
+{
+    struct fdbuf_rwstream* fd_rws = (struct fdbuf_rwstream *)rws;
+    if (fdbuf_flush(rws) == -1)
+        return -1;
+
+    /* the bytes in the read buffer are not consumed yet */
+    if (whence == SEEK_CUR)
+        offset -= fd_rws->nr_rbytes;
+
+    off_t ret = lseek(fd_rws->fd, offset, whence);
+    if (ret == -1) {
+        purc_set_error(purc_error_from_errno(errno));
+        return -1;
+    }
+
+    fd_rws->rpos = 0;
+    fd_rws->nr_rbytes = 0;
+    return ret;
+}
+
+static off_t fdbuf_tell (purc_rwstream_t rws)
+{
+    struct fdbuf_rwstream* fd_rws = (struct fdbuf_rwstream *)rws;
+    off_t ret = lseek(fd_rws->fd, 0, SEEK_CUR);
+    if (ret == -1) {
+        purc_set_error(purc_error_from_errno(errno));
+        return -1;
+    }
+    return ret - fd_rws->nr_rbytes + fd_rws->nr_wbytes;
+}
+
+static ssize_t fdbuf_read (purc_rwstream_t rws, void* buf, size_t count)
+{
+    struct fdbuf_rwstream* fd_rws = (struct fdbuf_rwstream *)rws;
+
+    if (fd_rws->nr_rbytes == 0) {
+        /* the peer may wait for what we have written */
+        if (fdbuf_flush(rws) == -1)
+            return -1;
+
+        ssize_t ret;
+        if (count >= fd_rws->sz_rbuf) {
+            ret = read(fd_rws->fd, buf, count);
+        }
+        else {
+            ret = read(fd_rws->fd, fd_rws->rbuf, fd_rws->sz_rbuf);
+        }
+
+        if (ret == -1) {
+            purc_set_error(purc_error_from_errno(errno));
+            return -1;
+        }
+        if (count >= fd_rws->sz_rbuf || ret == 0)
+            return ret;
+
+        fd_rws->rpos = 0;
+        fd_rws->nr_rbytes = ret;
+    }
+
+    if (count > fd_rws->nr_rbytes)
+        count = fd_rws->nr_rbytes;
+    memcpy(buf, fd_rws->rbuf + fd_rws->rpos, count);
+    fd_rws->rpos += count;
+    fd_rws->nr_rbytes -= count;
+    return count;
+}
+
+static ssize_t fdbuf_write (purc_rwstream_t rws, const void* buf,
+        size_t count)
+{
+    struct fdbuf_rwstream* fd_rws = (struct fdbuf_rwstream *)rws;
+
+    if (fd_rws->nr_wbytes + count > fd_rws->sz_wbuf) {
+        if (fdbuf_flush(rws) == -1)
+            return -1;
+    }
+
+    if (count >= fd_rws->sz_wbuf) {
+        size_t done = fdbuf_write_all(fd_rws->fd, buf, count);
+        return (done == 0 && count > 0) ? -1 : (ssize_t)done;
+    }
+
+    memcpy(fd_rws->wbuf + fd_rws->nr_wbytes, buf, count);
+    fd_rws->nr_wbytes += count;
+    return count;
+}
+
+static int fdbuf_destroy (purc_rwstream_t rws)
+{
+    struct fdbuf_rwstream* fd_rws = (struct fdbuf_rwstream *)rws;
+    fdbuf_flush(rws);
+    free(fd_rws->rbuf);
+    free(fd_rws->wbuf);
+    free(rws);
+    return 0;
+}
+
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
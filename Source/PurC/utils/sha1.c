@@ -39,7 +39,14 @@ A million repetitions of "a"
 
 #include "private/utils.h"
 
-/* #define SHA1HANDSOFF * Copies data before messing with it. */
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+#include <immintrin.h>
+#define HAVE_SHA_NI 1
+#endif
+
+/* NOTE: the data is copied to a local workspace before messing with it,
+   because the data passed to pcutils_sha1_hash() is constant. */
+#define SHA1HANDSOFF
 
 static void sha1_transform (uint32_t state[5], const uint8_t *buffer);
 
@@ -75,8 +82,8 @@ sha1_transform(uint32_t state[5], const uint8_t *buffer)
     } CHAR64LONG16;
     CHAR64LONG16 *block;
 #ifdef SHA1HANDSOFF
-    static uint8_t workspace[64];
-    block = (CHAR64LONG16 *) workspace;
+    CHAR64LONG16 workspace;
+    block = &workspace;
     memcpy (block, buffer, 64);
 #else
     block = (CHAR64LONG16 *) (void *) buffer;
@@ -178,6 +185,89 @@ sha1_transform(uint32_t state[5], const uint8_t *buffer)
     a = b = c = d = e = 0;
 }
 
+#if HAVE(SHA_NI)
+/* Hash the 512-bit blocks with the SHA extensions of x86 */
+__attribute__((target("sha,sse4.1")))
+static void
+sha1_blocks_ni(uint32_t state[5], const uint8_t *data, size_t nr_blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+            0x08090a0b0c0d0e0fULL);
+    __m128i abcd, abcd_save, e0, e0_save, e1, w[4];
+
+    abcd = _mm_loadu_si128((const __m128i *)state);
+    abcd = _mm_shuffle_epi32(abcd, 0x1B);
+    e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+    while (nr_blocks--) {
+        abcd_save = abcd;
+        e0_save = e0;
+
+        /* 20 groups of 4 rounds */
+        for (int i = 0; i < 20; i++) {
+            if (i < 4) {
+                w[i] = _mm_shuffle_epi8(
+                        _mm_loadu_si128((const __m128i *)(data + 16 * i)),
+                        mask);
+            }
+            else {
+                w[i & 3] = _mm_sha1msg2_epu32(
+                        _mm_xor_si128(
+                            _mm_sha1msg1_epu32(w[i & 3], w[(i + 1) & 3]),
+                            w[(i + 2) & 3]),
+                        w[(i + 3) & 3]);
+            }
+
+            if (i == 0)
+                e1 = _mm_add_epi32(e0, w[0]);
+            else
+                e1 = _mm_sha1nexte_epu32(e0, w[i & 3]);
+
+            /* the function of the rounds must be an immediate */
+            e0 = abcd;
+            switch (i / 5) {
+            case 0:
+                abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+                break;
+            case 1:
+                abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+                break;
+            case 2:
+                abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+                break;
+            default:
+                abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+                break;
+            }
+        }
+
+        e0 = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+        data += 64;
+    }
+
+    abcd = _mm_shuffle_epi32(abcd, 0x1B);
+    _mm_storeu_si128((__m128i *)state, abcd);
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+#endif
+
+static void
+sha1_blocks(uint32_t state[5], const uint8_t *data, size_t nr_blocks)
+{
+#if HAVE(SHA_NI)
+    if (pcutils_cpu_features() & PCUTILS_CPU_SHA) {
+        sha1_blocks_ni(state, data, nr_blocks);
+        return;
+    }
+#endif
+
+    while (nr_blocks--) {
+        sha1_transform(state, data);
+        data += 64;
+    }
+}
+
 /* Initialize new context */
 void
 pcutils_sha1_begin(pcutils_sha1_ctxt *context)
@@ -204,9 +294,10 @@ pcutils_sha1_hash(pcutils_sha1_ctxt *context, const void *data, size_t len)
     context->count[1] += (len >> 29);
     if ((j + len) > 63) {
         memcpy (&context->buffer[j], bytes, (i = 64 - j));
-        sha1_transform (context->state, context->buffer);
-        for (; i + 63 < len; i += 64) {
-            sha1_transform (context->state, &bytes[i]);
+        sha1_blocks (context->state, context->buffer, 1);
+        if (i + 63 < len) {
+            sha1_blocks (context->state, &bytes[i], (len - i) / 64);
+            i += (len - i) & ~(size_t)63;
         }
         j = 0;
     } else
@@ -240,8 +331,5 @@ pcutils_sha1_end(pcutils_sha1_ctxt *context, uint8_t* digest)
     memset (context->state, 0, 20);
     memset (context->count, 0, 8);
     memset (&finalcount, 0, 8);
-#ifdef SHA1HANDSOFF     /* make sha1_transform overwrite it's own static vars */
-    sha1_transform (context->state, context->buffer);
-#endif
 }
 
@@ -26,7 +26,14 @@
  *
  */
 
+#include "config.h"
 #include "purc-utils.h"
+#include "private/utils.h"
+
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+#include <immintrin.h>
+#define HAVE_SHA_NI 1
+#endif
 
 /*
  * MACROS
@@ -34,8 +41,6 @@
 
 #define ror(value, bits) (((value) >> (bits)) | ((value) << (32 - (bits))))
 
-#define MIN(x, y) ( ((x)<(y))?(x):(y) )
-
 #define STORE32H(x, y)                                                          \
      { (y)[0] = (uint8_t)(((x)>>24)&255); (y)[1] = (uint8_t)(((x)>>16)&255);    \
        (y)[2] = (uint8_t)(((x)>>8)&255); (y)[3] = (uint8_t)((x)&255); }
@@ -97,7 +102,7 @@ static const uint32_t K[64] = {
 
 // TransformFunction: Compress 512-bits
 static void
-TransformFunction (pcutils_sha256_ctxt* ctxt, uint8_t const* buff)
+TransformFunction (uint32_t *state, uint8_t const* buff)
 {
     uint32_t    S[8];
     uint32_t    W[64];
@@ -109,7 +114,7 @@ TransformFunction (pcutils_sha256_ctxt* ctxt, uint8_t const* buff)
     // Copy state into S
     for( i=0; i<8; i++ )
     {
-        S[i] = ctxt->state[i];
+        S[i] = state[i];
     }
 
     // Copy the state into 512-bits into W[0..15]
@@ -142,8 +147,88 @@ TransformFunction (pcutils_sha256_ctxt* ctxt, uint8_t const* buff)
     // Feedback
     for( i=0; i<8; i++ )
     {
-        ctxt->state[i] = ctxt->state[i] + S[i];
+        state[i] = state[i] + S[i];
+    }
+}
+
+static void
+sha256_blocks_c(uint32_t *state, const uint8_t *data, size_t nr_blocks)
+{
+    while (nr_blocks--) {
+        TransformFunction(state, data);
+        data += BLOCK_SIZE;
+    }
+}
+
+#if HAVE(SHA_NI)
+/* Compress the blocks with the SHA extensions of x86 */
+__attribute__((target("sha,sse4.1")))
+static void
+sha256_blocks_ni(uint32_t *state, const uint8_t *data, size_t nr_blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+            0x0405060700010203ULL);
+    __m128i state0, state1, tmp, msg, w[4], abef, cdgh;
+
+    tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+    state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);             /* CDAB */
+    state1 = _mm_shuffle_epi32(state1, 0x1B);       /* EFGH */
+    state0 = _mm_alignr_epi8(tmp, state1, 8);       /* ABEF */
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);    /* CDGH */
+
+    while (nr_blocks--) {
+        abef = state0;
+        cdgh = state1;
+
+        /* 16 groups of 4 rounds */
+        for (int i = 0; i < 16; i++) {
+            if (i < 4) {
+                w[i] = _mm_shuffle_epi8(
+                        _mm_loadu_si128((const __m128i *)(data + 16 * i)),
+                        mask);
+            }
+            else {
+                tmp = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+                tmp = _mm_add_epi32(tmp,
+                        _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+                w[i & 3] = _mm_sha256msg2_epu32(tmp, w[(i + 3) & 3]);
+            }
+
+            msg = _mm_add_epi32(w[i & 3],
+                    _mm_loadu_si128((const __m128i *)(K + 4 * i)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+        data += BLOCK_SIZE;
     }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);          /* FEBA */
+    state1 = _mm_shuffle_epi32(state1, 0xB1);       /* DCHG */
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);    /* DCBA */
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       /* HGFE */
+
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+#endif
+
+static void
+sha256_blocks(uint32_t *state, const uint8_t *data, size_t nr_blocks)
+{
+#if HAVE(SHA_NI)
+    if (pcutils_cpu_features() & PCUTILS_CPU_SHA) {
+        sha256_blocks_ni(state, data, nr_blocks);
+        return;
+    }
+#endif
+
+    sha256_blocks_c(state, data, nr_blocks);
 }
 
 /*
@@ -178,10 +263,11 @@ pcutils_sha256_hash(pcutils_sha256_ctxt *ctxt, const void *buff, size_t buff_sz)
     {
         if( ctxt->curlen == 0 && buff_sz >= BLOCK_SIZE )
         {
-           TransformFunction( ctxt, (uint8_t*)buff );
-           ctxt->length += BLOCK_SIZE * 8;
-           buff = (uint8_t*)buff + BLOCK_SIZE;
-           buff_sz -= BLOCK_SIZE;
+           n = buff_sz / BLOCK_SIZE;
+           sha256_blocks( ctxt->state, (uint8_t*)buff, n );
+           ctxt->length += n * BLOCK_SIZE * 8;
+           buff = (uint8_t*)buff + n * BLOCK_SIZE;
+           buff_sz -= n * BLOCK_SIZE;
         }
         else
         {
@@ -192,7 +278,7 @@ pcutils_sha256_hash(pcutils_sha256_ctxt *ctxt, const void *buff, size_t buff_sz)
            buff_sz -= n;
            if( ctxt->curlen == BLOCK_SIZE )
            {
-              TransformFunction( ctxt, ctxt->buf );
+              sha256_blocks( ctxt->state, ctxt->buf, 1 );
               ctxt->length += 8*BLOCK_SIZE;
               ctxt->curlen = 0;
            }
@@ -222,7 +308,7 @@ pcutils_sha256_end(pcutils_sha256_ctxt *ctxt, unsigned char *digest)
         while (ctxt->curlen < 64) {
             ctxt->buf[ctxt->curlen++] = (uint8_t)0;
         }
-        TransformFunction (ctxt, ctxt->buf);
+        sha256_blocks (ctxt->state, ctxt->buf, 1);
         ctxt->curlen = 0;
     }
 
@@ -233,7 +319,7 @@ pcutils_sha256_end(pcutils_sha256_ctxt *ctxt, unsigned char *digest)
 
     // Store length
     STORE64H (ctxt->length, ctxt->buf+56);
-    TransformFunction (ctxt, ctxt->buf);
+    sha256_blocks (ctxt->state, ctxt->buf, 1);
 
     // Copy output
     for (i=0; i<8; i++) {
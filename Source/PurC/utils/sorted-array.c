@@ -34,6 +34,46 @@ struct sorted_array_member {
     void    *data;
 };
 
+/*
+ * NOTE: When the number of members reaches SA_BTREE_THRESHOLD, the members
+ * are moved from the flat array to a counted B+tree: the leaves hold the
+ * members, and an inner node holds the number of members and the first
+ * sort value of every child, so the members can be located both by the
+ * sort value and by the index in O(log n), and an insertion or a deletion
+ * only moves the members of one leaf instead of the tail of the array.
+ * The members are moved back to the flat array when the number of members
+ * falls below SA_FLAT_THRESHOLD.
+ */
+#define SA_BTREE_THRESHOLD      256
+#define SA_FLAT_THRESHOLD       (SA_BTREE_THRESHOLD / 2)
+
+/* the maximal number of members or children of a node */
+#define SA_BTREE_ORDER          32
+#define SA_BTREE_MIN            (SA_BTREE_ORDER / 2)
+
+/* the number of members or children of a node made by bulk loading */
+#define SA_BTREE_FILL           (SA_BTREE_ORDER * 3 / 4)
+
+struct sa_btree_node {
+    /* the number of members in the subtree */
+    size_t                      count;
+
+    /* the number of members (leaf) or children (inner node) */
+    unsigned int                nr;
+    bool                        leaf;
+
+    union {
+        struct sorted_array_member members[SA_BTREE_ORDER];
+        struct {
+            struct sa_btree_node   *children[SA_BTREE_ORDER];
+            /* the number of members in the subtree of a child */
+            size_t                  counts[SA_BTREE_ORDER];
+            /* the first sort value in the subtree of a child */
+            void                   *lows[SA_BTREE_ORDER];
+        } in;
+    } u;
+};
+
 struct sorted_array {
     /* ascending order (true) or descending order (false) */
     unsigned int                flags;
@@ -44,9 +84,12 @@ struct sorted_array {
     /* the number of members */
     size_t                      nr_members;
 
-    /* the pointer to an array contains the members */
+    /* the pointer to an array contains the members; NULL if root is used */
     struct sorted_array_member *members;
 
+    /* the root of the B+tree contains the members; NULL if members is used */
+    struct sa_btree_node       *root;
+
     /* callback function to free member; nullable */
     sacb_free                   free_fn;
 
@@ -70,6 +113,523 @@ def_cmp(const void *sortv1, const void *sortv2)
     return 0;
 }
 
+/* compares two sort values in the order of the sorted array */
+static inline int
+sa_cmp(struct sorted_array *sa, const void *sortv1, const void *sortv2)
+{
+    int cmp = sa->cmp_fn(sortv1, sortv2);
+
+    if (sa->flags & SAFLAG_ORDER_DESC)
+        return (cmp < 0) - (cmp > 0);
+
+    return cmp;
+}
+
+static struct sa_btree_node *
+bt_new_node(bool leaf)
+{
+    struct sa_btree_node *node = malloc(sizeof(struct sa_btree_node));
+
+    if (node) {
+        node->count = 0;
+        node->nr = 0;
+        node->leaf = leaf;
+    }
+
+    return node;
+}
+
+static void
+bt_free_node(struct sorted_array *sa, struct sa_btree_node *node, bool members)
+{
+    unsigned int i;
+
+    if (node->leaf) {
+        if (members && sa->free_fn) {
+            for (i = 0; i < node->nr; i++) {
+                sa->free_fn(node->u.members[i].sortv, node->u.members[i].data);
+            }
+        }
+    }
+    else {
+        for (i = 0; i < node->nr; i++) {
+            bt_free_node(sa, node->u.in.children[i], members);
+        }
+    }
+
+    free(node);
+}
+
+static inline void *
+bt_first_sortv(struct sa_btree_node *node)
+{
+    return node->leaf ? node->u.members[0].sortv : node->u.in.lows[0];
+}
+
+/* refreshes the count and the first sort value of the child #i */
+static inline void
+bt_refresh_child(struct sa_btree_node *node, unsigned int i)
+{
+    struct sa_btree_node *child = node->u.in.children[i];
+
+    node->u.in.counts[i] = child->count;
+    node->u.in.lows[i] = bt_first_sortv(child);
+}
+
+static struct sorted_array_member *
+bt_get(struct sorted_array *sa, size_t idx)
+{
+    struct sa_btree_node *node = sa->root;
+
+    while (!node->leaf) {
+        unsigned int i = 0;
+
+        while (idx >= node->u.in.counts[i]) {
+            idx -= node->u.in.counts[i];
+            i++;
+        }
+
+        node = node->u.in.children[i];
+    }
+
+    return node->u.members + idx;
+}
+
+/*
+ * Returns the number of members which are before the sort value (`upper` is
+ * false), or before or equal to the sort value (`upper` is true). If it is
+ * in the same leaf, the member at the returned index is returned by `member`,
+ * otherwise `member` is set to NULL.
+ */
+static size_t
+bt_rank(struct sorted_array *sa, const void *sortv, bool upper,
+        struct sorted_array_member **member)
+{
+    struct sa_btree_node *node = sa->root;
+    size_t rank = 0;
+    unsigned int low, high, mid, i;
+
+    while (!node->leaf) {
+        /* find the last child whose first sort value is before sortv */
+        low = 1;
+        high = node->nr;
+        while (low < high) {
+            int cmp;
+
+            mid = (low + high) / 2;
+            cmp = sa_cmp(sa, node->u.in.lows[mid], sortv);
+            if (upper ? cmp <= 0 : cmp < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        for (i = 0; i < low - 1; i++) {
+            rank += node->u.in.counts[i];
+        }
+        node = node->u.in.children[low - 1];
+    }
+
+    low = 0;
+    high = node->nr;
+    while (low < high) {
+        int cmp;
+
+        mid = (low + high) / 2;
+        cmp = sa_cmp(sa, node->u.members[mid].sortv, sortv);
+        if (upper ? cmp <= 0 : cmp < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (member) {
+        *member = (low < node->nr) ? (node->u.members + low) : NULL;
+    }
+
+    return rank + low;
+}
+
+/* splits a full node; the upper half is moved to the returned node */
+static struct sa_btree_node *
+bt_split(struct sa_btree_node *node)
+{
+    struct sa_btree_node *sibling;
+    unsigned int half = node->nr / 2, i;
+
+    sibling = bt_new_node(node->leaf);
+    if (sibling == NULL)
+        return NULL;
+
+    sibling->nr = node->nr - half;
+    if (node->leaf) {
+        memcpy(sibling->u.members, node->u.members + half,
+                sizeof(struct sorted_array_member) * sibling->nr);
+        sibling->count = sibling->nr;
+    }
+    else {
+        memcpy(sibling->u.in.children, node->u.in.children + half,
+                sizeof(struct sa_btree_node *) * sibling->nr);
+        memcpy(sibling->u.in.counts, node->u.in.counts + half,
+                sizeof(size_t) * sibling->nr);
+        memcpy(sibling->u.in.lows, node->u.in.lows + half,
+                sizeof(void *) * sibling->nr);
+        for (i = 0; i < sibling->nr; i++) {
+            sibling->count += sibling->u.in.counts[i];
+        }
+    }
+
+    node->nr = half;
+    node->count -= sibling->count;
+    return sibling;
+}
+
+/* splits the full child #i of a node which is not full */
+static int
+bt_split_child(struct sa_btree_node *node, unsigned int i)
+{
+    struct sa_btree_node *sibling;
+
+    sibling = bt_split(node->u.in.children[i]);
+    if (sibling == NULL)
+        return -1;
+
+    i++;
+    memmove(node->u.in.children + i + 1, node->u.in.children + i,
+            sizeof(struct sa_btree_node *) * (node->nr - i));
+    memmove(node->u.in.counts + i + 1, node->u.in.counts + i,
+            sizeof(size_t) * (node->nr - i));
+    memmove(node->u.in.lows + i + 1, node->u.in.lows + i,
+            sizeof(void *) * (node->nr - i));
+    node->nr++;
+
+    node->u.in.children[i] = sibling;
+    bt_refresh_child(node, i - 1);
+    bt_refresh_child(node, i);
+    return 0;
+}
+
+/* the maximal height of the B+tree */
+#define SA_BTREE_MAX_HEIGHT     32
+
+/*
+ * Inserts a member at the index. The full nodes on the path are split
+ * before descending into them, so the tree is not changed if it fails.
+ */
+static int
+bt_insert(struct sorted_array *sa, size_t idx, void *sortv, void *data)
+{
+    struct sa_btree_node *path[SA_BTREE_MAX_HEIGHT];
+    unsigned int slots[SA_BTREE_MAX_HEIGHT];
+    struct sa_btree_node *node;
+    unsigned int depth = 0, i;
+
+    if (sa->root->nr == SA_BTREE_ORDER) {
+        node = bt_new_node(false);
+        if (node == NULL)
+            return -1;
+
+        node->nr = 1;
+        node->count = sa->root->count;
+        node->u.in.children[0] = sa->root;
+        bt_refresh_child(node, 0);
+        if (bt_split_child(node, 0)) {
+            free(node);
+            return -1;
+        }
+
+        sa->root = node;
+    }
+
+    node = sa->root;
+    while (!node->leaf) {
+        /* NOTE: append to the end of the left child on the boundary */
+        for (i = 0; i < node->nr - 1 && idx > node->u.in.counts[i]; i++) {
+            idx -= node->u.in.counts[i];
+        }
+
+        if (node->u.in.children[i]->nr == SA_BTREE_ORDER) {
+            if (bt_split_child(node, i))
+                return -1;
+
+            if (idx > node->u.in.counts[i]) {
+                idx -= node->u.in.counts[i];
+                i++;
+            }
+        }
+
+        assert(depth < SA_BTREE_MAX_HEIGHT);
+        path[depth] = node;
+        slots[depth] = i;
+        depth++;
+        node = node->u.in.children[i];
+    }
+
+    memmove(node->u.members + idx + 1, node->u.members + idx,
+            sizeof(struct sorted_array_member) * (node->nr - idx));
+    node->u.members[idx].sortv = sortv;
+    node->u.members[idx].data = data;
+    node->nr++;
+    node->count++;
+
+    while (depth > 0) {
+        depth--;
+        path[depth]->count++;
+        bt_refresh_child(path[depth], slots[depth]);
+    }
+
+    return 0;
+}
+
+/* moves one member or child from the node #from to the node #to */
+static void
+bt_move_one(struct sa_btree_node *to, unsigned int at_to,
+        struct sa_btree_node *from, unsigned int at_from)
+{
+    size_t count;
+
+    if (from->leaf) {
+        memmove(to->u.members + at_to + 1, to->u.members + at_to,
+                sizeof(struct sorted_array_member) * (to->nr - at_to));
+        to->u.members[at_to] = from->u.members[at_from];
+        memmove(from->u.members + at_from, from->u.members + at_from + 1,
+                sizeof(struct sorted_array_member) * (from->nr - at_from - 1));
+        count = 1;
+    }
+    else {
+        memmove(to->u.in.children + at_to + 1, to->u.in.children + at_to,
+                sizeof(struct sa_btree_node *) * (to->nr - at_to));
+        memmove(to->u.in.counts + at_to + 1, to->u.in.counts + at_to,
+                sizeof(size_t) * (to->nr - at_to));
+        memmove(to->u.in.lows + at_to + 1, to->u.in.lows + at_to,
+                sizeof(void *) * (to->nr - at_to));
+        to->u.in.children[at_to] = from->u.in.children[at_from];
+        to->u.in.counts[at_to] = from->u.in.counts[at_from];
+        to->u.in.lows[at_to] = from->u.in.lows[at_from];
+        count = from->u.in.counts[at_from];
+
+        memmove(from->u.in.children + at_from,
+                from->u.in.children + at_from + 1,
+                sizeof(struct sa_btree_node *) * (from->nr - at_from - 1));
+        memmove(from->u.in.counts + at_from, from->u.in.counts + at_from + 1,
+                sizeof(size_t) * (from->nr - at_from - 1));
+        memmove(from->u.in.lows + at_from, from->u.in.lows + at_from + 1,
+                sizeof(void *) * (from->nr - at_from - 1));
+    }
+
+    to->nr++;
+    to->count += count;
+    from->nr--;
+    from->count -= count;
+}
+
+/* merges the child #i with a sibling, or moves one member to it */
+static void
+bt_rebalance(struct sa_btree_node *node, unsigned int i)
+{
+    unsigned int l = (i > 0) ? (i - 1) : i, r = l + 1;
+    struct sa_btree_node *left = node->u.in.children[l];
+    struct sa_btree_node *right = node->u.in.children[r];
+
+    if (left->nr + right->nr < SA_BTREE_ORDER) {
+        if (left->leaf) {
+            memcpy(left->u.members + left->nr, right->u.members,
+                    sizeof(struct sorted_array_member) * right->nr);
+        }
+        else {
+            memcpy(left->u.in.children + left->nr, right->u.in.children,
+                    sizeof(struct sa_btree_node *) * right->nr);
+            memcpy(left->u.in.counts + left->nr, right->u.in.counts,
+                    sizeof(size_t) * right->nr);
+            memcpy(left->u.in.lows + left->nr, right->u.in.lows,
+                    sizeof(void *) * right->nr);
+        }
+        left->nr += right->nr;
+        left->count += right->count;
+        free(right);
+
+        node->nr--;
+        memmove(node->u.in.children + r, node->u.in.children + r + 1,
+                sizeof(struct sa_btree_node *) * (node->nr - r));
+        memmove(node->u.in.counts + r, node->u.in.counts + r + 1,
+                sizeof(size_t) * (node->nr - r));
+        memmove(node->u.in.lows + r, node->u.in.lows + r + 1,
+                sizeof(void *) * (node->nr - r));
+        bt_refresh_child(node, l);
+        return;
+    }
+
+    if (left->nr < right->nr)
+        bt_move_one(left, left->nr, right, 0);
+    else
+        bt_move_one(right, 0, left, left->nr - 1);
+
+    bt_refresh_child(node, l);
+    bt_refresh_child(node, r);
+}
+
+static void
+bt_delete_at(struct sa_btree_node *node, size_t idx,
+        struct sorted_array_member *member)
+{
+    struct sa_btree_node *child;
+    unsigned int i;
+
+    if (node->leaf) {
+        *member = node->u.members[idx];
+        node->nr--;
+        node->count--;
+        memmove(node->u.members + idx, node->u.members + idx + 1,
+                sizeof(struct sorted_array_member) * (node->nr - idx));
+        return;
+    }
+
+    for (i = 0; idx >= node->u.in.counts[i]; i++) {
+        idx -= node->u.in.counts[i];
+    }
+
+    child = node->u.in.children[i];
+    bt_delete_at(child, idx, member);
+    node->count--;
+    bt_refresh_child(node, i);
+    if (child->nr < SA_BTREE_MIN && node->nr > 1) {
+        bt_rebalance(node, i);
+    }
+}
+
+static void
+bt_collect(struct sa_btree_node *node, struct sorted_array_member *members,
+        size_t *pos)
+{
+    unsigned int i;
+
+    if (node->leaf) {
+        memcpy(members + *pos, node->u.members,
+                sizeof(struct sorted_array_member) * node->nr);
+        *pos += node->nr;
+    }
+    else {
+        for (i = 0; i < node->nr; i++) {
+            bt_collect(node->u.in.children[i], members, pos);
+        }
+    }
+}
+
+/* moves the members from the flat array to a new B+tree */
+static int
+sa_to_btree(struct sorted_array *sa)
+{
+    struct sa_btree_node **nodes, *node;
+    size_t n = sa->nr_members, nr_nodes, nr_parents, k, j, sz, from;
+
+    nr_nodes = (n + SA_BTREE_FILL - 1) / SA_BTREE_FILL;
+    nodes = malloc(sizeof(struct sa_btree_node *) * nr_nodes);
+    if (nodes == NULL)
+        return -1;
+
+    from = 0;
+    for (k = 0; k < nr_nodes; k++) {
+        node = bt_new_node(true);
+        if (node == NULL) {
+            from = nr_nodes;
+            goto failed;
+        }
+
+        sz = n / nr_nodes + ((k < n % nr_nodes) ? 1 : 0);
+        memcpy(node->u.members, sa->members + from,
+                sizeof(struct sorted_array_member) * sz);
+        node->nr = sz;
+        node->count = sz;
+        from += sz;
+        nodes[k] = node;
+    }
+
+    /* NOTE: the parents are stored in place of the children consumed */
+    while (nr_nodes > 1) {
+        nr_parents = (nr_nodes + SA_BTREE_FILL - 1) / SA_BTREE_FILL;
+        from = 0;
+        for (k = 0; k < nr_parents; k++) {
+            node = bt_new_node(false);
+            if (node == NULL)
+                goto failed;
+
+            sz = nr_nodes / nr_parents + ((k < nr_nodes % nr_parents) ? 1 : 0);
+            for (j = 0; j < sz; j++) {
+                node->u.in.children[j] = nodes[from + j];
+                bt_refresh_child(node, j);
+                node->count += node->u.in.counts[j];
+            }
+            node->nr = sz;
+            from += sz;
+            nodes[k] = node;
+        }
+
+        nr_nodes = nr_parents;
+    }
+
+    sa->root = nodes[0];
+    free(nodes);
+    free(sa->members);
+    sa->members = NULL;
+    sa->sz_array = 0;
+    return 0;
+
+failed:
+    for (j = 0; j < k; j++) {
+        bt_free_node(sa, nodes[j], false);
+    }
+    for (j = from; j < nr_nodes; j++) {
+        bt_free_node(sa, nodes[j], false);
+    }
+    free(nodes);
+    return -1;
+}
+
+/* moves the members from the B+tree back to a new flat array */
+static int
+sa_to_flat(struct sorted_array *sa)
+{
+    size_t pos = 0;
+
+    sa->members = malloc(sizeof(struct sorted_array_member) *
+            SA_BTREE_THRESHOLD);
+    if (sa->members == NULL)
+        return -1;
+
+    sa->sz_array = SA_BTREE_THRESHOLD;
+    bt_collect(sa->root, sa->members, &pos);
+    assert(pos == sa->nr_members);
+
+    bt_free_node(sa, sa->root, false);
+    sa->root = NULL;
+    return 0;
+}
+
+static void
+bt_delete(struct sorted_array *sa, size_t idx)
+{
+    struct sorted_array_member member;
+    struct sa_btree_node *root;
+
+    bt_delete_at(sa->root, idx, &member);
+    sa->nr_members--;
+
+    if (sa->free_fn) {
+        sa->free_fn(member.sortv, member.data);
+    }
+
+    while (!sa->root->leaf && sa->root->nr == 1) {
+        root = sa->root;
+        sa->root = root->u.in.children[0];
+        free(root);
+    }
+
+    if (sa->nr_members < SA_FLAT_THRESHOLD) {
+        /* keep the B+tree if failed */
+        sa_to_flat(sa);
+    }
+}
+
 struct sorted_array *
 pcutils_sorted_array_create(unsigned int flags, size_t sz_init,
         sacb_free free_fn, sacb_compare cmp_fn)
@@ -99,9 +659,12 @@ void pcutils_sorted_array_destroy(struct sorted_array *sa)
 {
     size_t idx;
 
-    assert (sa != NULL && sa->members != NULL);
+    assert (sa != NULL);
 
-    if (sa->free_fn) {
+    if (sa->root) {
+        bt_free_node(sa, sa->root, true);
+    }
+    else if (sa->free_fn) {
         for (idx = 0; idx < sa->nr_members; idx++) {
             sa->free_fn(sa->members[idx].sortv, sa->members[idx].data);
         }
@@ -127,6 +690,15 @@ int pcutils_sorted_array_add(struct sorted_array *sa, void *sortv, void *data,
         return -2;
     }
 
+    if (sa->root) {
+        /* NOTE: the new member is placed after the members equal to it */
+        idx = bt_rank(sa, sortv, true, NULL);
+        if (bt_insert(sa, idx, sortv, data))
+            return -3;
+
+        goto done;
+    }
+
     if ((sa->nr_members + 1) >= sa->sz_array) {
         size_t new_sz = sa->sz_array + SASZ_DEFAULT;
         struct sorted_array_member *old_members = sa->members;
@@ -184,7 +756,13 @@ int pcutils_sorted_array_add(struct sorted_array *sa, void *sortv, void *data,
     sa->members[idx].sortv = sortv;
     sa->members[idx].data = data;
 
+done:
     sa->nr_members++;
+    if (sa->root == NULL && sa->nr_members >= SA_BTREE_THRESHOLD) {
+        /* keep the flat array if failed */
+        sa_to_btree(sa);
+    }
+
     if (index) {
         *index = idx;
     }
@@ -196,6 +774,22 @@ bool pcutils_sorted_array_remove(struct sorted_array *sa, const void* sortv)
     ssize_t low, high, mid;
     size_t i;
 
+    if (sa->root) {
+        struct sorted_array_member *member;
+
+        i = bt_rank(sa, sortv, false, &member);
+        if (i >= sa->nr_members)
+            return false;
+
+        if (member == NULL)
+            member = bt_get(sa, i);
+        if (sa_cmp(sa, sortv, member->sortv))
+            return false;
+
+        bt_delete(sa, i);
+        return true;
+    }
+
     low = 0;
     high = sa->nr_members - 1;
     while (low <= high) {
@@ -246,6 +840,29 @@ bool pcutils_sorted_array_find(struct sorted_array *sa, const void *sortv,
 {
     ssize_t low, high, mid;
 
+    if (sa->root) {
+        struct sorted_array_member *member;
+
+        mid = (ssize_t)bt_rank(sa, sortv, false, &member);
+        if ((size_t)mid >= sa->nr_members)
+            return false;
+
+        if (member == NULL)
+            member = bt_get(sa, mid);
+        if (sa_cmp(sa, sortv, member->sortv))
+            return false;
+
+        if (data) {
+            *data = member->data;
+        }
+
+        if (index) {
+            *index = mid;
+        }
+
+        return true;
+    }
+
     low = 0;
     high = sa->nr_members - 1;
     while (low <= high) {
@@ -297,6 +914,16 @@ const void* pcutils_sorted_array_get(struct sorted_array *sa, size_t idx, void *
 {
     assert (idx < sa->nr_members);
 
+    if (sa->root) {
+        struct sorted_array_member *member = bt_get(sa, idx);
+
+        if (data) {
+            *data = member->data;
+        }
+
+        return member->sortv;
+    }
+
     if (data) {
         *data = sa->members[idx].data;
     }
@@ -310,6 +937,11 @@ void pcutils_sorted_array_delete(struct sorted_array *sa, size_t idx)
 
     assert (idx < sa->nr_members);
 
+    if (sa->root) {
+        bt_delete(sa, idx);
+        return;
+    }
+
     if (sa->free_fn) {
         sa->free_fn(sa->members[idx].sortv, sa->members[idx].data);
     }
@@ -38,25 +38,97 @@
 #include "config.h"
 #include "private/utf8.h"
 
-#if USE(GLIB)
-#include <glib.h>
+/* Returns true if the first @len bytes of @str are all ASCII characters;
+   checks eight bytes per iteration. */
+static bool
+is_ascii_string(const char *str, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)str;
+    const uint64_t high_bits = 0x8080808080808080ULL;
+
+    for (; len >= sizeof(uint64_t); p += sizeof(uint64_t),
+            len -= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        if (word & high_bits)
+            return false;
+    }
 
-char *pcutils_strtoupper(const char *str, ssize_t len, size_t *len_new)
+    for (; len > 0; p++, len--) {
+        if (*p >= 0x80)
+            return false;
+    }
+
+    return true;
+}
+
+/* the branch-free loops below are vectorized by the compilers */
+static char *
+ascii_strcase(const char *str, ssize_t len, size_t *len_new, bool upper)
 {
-    char *new_str = g_utf8_strup(str, len);
-    if (len_new)
-        *len_new = strlen(new_str);
+    size_t length;
+
+    if (len < 0)
+        length = strlen(str);
+    else
+        length = strnlen(str, (size_t)len);
+
+    char *new_str = malloc(length + 1);
+    if (new_str) {
+        const unsigned char from = upper ? 'a' : 'A';
+        for (size_t n = 0; n < length; n++) {
+            unsigned char c = (unsigned char)str[n];
+            new_str[n] = (char)(c ^ (((unsigned char)(c - from) < 26) << 5));
+        }
+        new_str[length] = '\0';
+
+        if (len_new)
+            *len_new = length;
+    }
+
     return new_str;
 }
 
-char *pcutils_strtolower(const char *str, ssize_t len, size_t *len_new)
+static char *
+ascii_strcasestr(const char *haystack, const char *needle)
 {
-    char *new_str = g_utf8_strdown(str, len);
-    if (len_new)
-        *len_new = strlen(new_str);
-    return new_str;
+    char* p = (char *)haystack;
+
+    while (*p) {
+
+        int lower1, lower2;
+
+        lower1 = purc_tolower(*p);
+        lower2 = purc_tolower(*needle);
+
+        if (lower1 == lower2) {
+            const char *p1 = p + 1, *p2 = needle + 1;
+            while (*p1 && *p2) {
+                if (purc_tolower(*p1) != purc_tolower(*p2))
+                    goto not_matched;
+
+                p1++;
+                p2++;
+            }
+
+            if (*p1 == 0 && *p2)    // end of haystack
+                goto done;
+
+            /* matched */
+            return p;
+        }
+
+not_matched:
+        p++;
+    }
+
+done:
+    return NULL;
 }
 
+#if USE(GLIB)
+#include <glib.h>
+
 typedef enum {
   LOCALE_NORMAL,
   LOCALE_TURKIC,
@@ -87,6 +159,36 @@ static locale_type get_locale_type(void)
     return LOCALE_NORMAL;
 }
 
+/* NOTE: only the Turkic locales map the ASCII letter I/i differently. */
+static inline bool
+is_ascii_case_applicable(const char *str, ssize_t len)
+{
+    return is_ascii_string(str, (len < 0) ? strlen(str) : (size_t)len) &&
+        get_locale_type() != LOCALE_TURKIC;
+}
+
+char *pcutils_strtoupper(const char *str, ssize_t len, size_t *len_new)
+{
+    if (is_ascii_case_applicable(str, len))
+        return ascii_strcase(str, len, len_new, true);
+
+    char *new_str = g_utf8_strup(str, len);
+    if (len_new)
+        *len_new = strlen(new_str);
+    return new_str;
+}
+
+char *pcutils_strtolower(const char *str, ssize_t len, size_t *len_new)
+{
+    if (is_ascii_case_applicable(str, len))
+        return ascii_strcase(str, len, len_new, false);
+
+    char *new_str = g_utf8_strdown(str, len);
+    if (len_new)
+        *len_new = strlen(new_str);
+    return new_str;
+}
+
 #define G_UNICHAR_FULLWIDTH_A 0xff21
 #define G_UNICHAR_FULLWIDTH_I 0xff29
 #define G_UNICHAR_FULLWIDTH_J 0xff2a
@@ -238,10 +340,14 @@ char *pcutils_strcasestr(const char *haystack, const char *needle)
     gunichar ucs1[MAX_LOWER_CHARS];
     gunichar ucs2[MAX_LOWER_CHARS];
 
+    if (lt != LOCALE_TURKIC && is_ascii_string(needle, strlen(needle)) &&
+            is_ascii_string(haystack, strlen(haystack)))
+        return ascii_strcasestr(haystack, needle);
+
     char* p = (char *)haystack;
     while (*p) {
 
-        size_t len1 = utf8_char_to_lower(lt, haystack, ucs1);
+        size_t len1 = utf8_char_to_lower(lt, p, ucs1);
         size_t len2 = utf8_char_to_lower(lt, needle, ucs2);
 
         int diff = memcmp(ucs1, ucs2, sizeof(ucs1));
@@ -276,95 +382,24 @@ done:
 
 #else /* USE(GLIB) */
 
-char *pcutils_strtoupper(const char *str, ssize_t len, size_t *len_new)
+int pcutils_strncasecmp(const char *s1, const char *s2, size_t n)
 {
-    size_t length;
-
-    if (len < 0)
-        length = strlen(str);
-    else
-        length = (size_t)len;
-
-    char *new_str = strndup(str, length);
-
-    if (new_str) {
-        size_t n;
-        for (n = 0; n < length && new_str[n] != '\0'; n++) {
-            if (purc_islower(new_str[n]))
-                new_str[n] = purc_toupper(new_str[n]);
-        }
-
-        if (len_new)
-            *len_new = n;
-    }
-
-    return new_str;
+    return strncasecmp(s1, s2, n);
 }
 
-char *pcutils_strtolower(const char *str, ssize_t len, size_t *len_new)
+char *pcutils_strtoupper(const char *str, ssize_t len, size_t *len_new)
 {
-    size_t length;
-
-    if (len < 0)
-        length = strlen(str);
-    else
-        length = (size_t)len;
-
-    char *new_str = strndup(str, length);
-
-    if (new_str) {
-        size_t n;
-        for (n = 0; n < length && new_str[n] != '\0'; n++) {
-            if (purc_isupper(new_str[n]))
-                new_str[n] = purc_tolower(new_str[n]);
-        }
-
-        if (len_new)
-            *len_new = n;
-    }
-
-    return new_str;
+    return ascii_strcase(str, len, len_new, true);
 }
 
-int pcutils_strncasecmp(const char *s1, const char *s2, size_t n)
+char *pcutils_strtolower(const char *str, ssize_t len, size_t *len_new)
 {
-    return strncasecmp(s1, s2, n);
+    return ascii_strcase(str, len, len_new, false);
 }
 
 char *pcutils_strcasestr(const char *haystack, const char *needle)
 {
-    char* p = (char *)haystack;
-
-    while (*p) {
-
-        int lower1, lower2;
-
-        lower1 = purc_tolower(*p);
-        lower2 = purc_tolower(*needle);
-
-        if (lower1 == lower2) {
-            const char *p1 = p + 1, *p2 = needle + 1;
-            while (*p1 && *p2) {
-                if (purc_tolower(*p1) != purc_tolower(*p2))
-                    goto not_matched;
-
-                p1++;
-                p2++;
-            }
-
-            if (*p1 == 0 && *p2)    // end of haystack
-                goto done;
-
-            /* matched */
-            return p;
-        }
-
-not_matched:
-        p++;
-    }
-
-done:
-    return NULL;
+    return ascii_strcasestr(haystack, needle);
 }
 
 #endif  /* !USE(GLIB) */
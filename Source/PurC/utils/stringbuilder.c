@@ -54,6 +54,23 @@ pcutils_stringbuilder_reset(struct pcutils_stringbuilder *sb)
     memset(sb, 0, sizeof(*sb));
 }
 
+static struct pcutils_buf *
+stringbuilder_add_buf(struct pcutils_stringbuilder *sb, size_t sz)
+{
+    struct pcutils_buf *buf;
+    buf = (struct pcutils_buf*)malloc(sizeof(*buf) + sz);
+    if (!buf)
+        return NULL;
+
+    buf->sz = sz;
+    buf->curr = 0;
+    buf->buf[0] = '\0';
+
+    list_add_tail(&buf->node, &sb->list);
+    sb->curr = buf;
+    return buf;
+}
+
 int
 pcutils_stringbuilder_keep(struct pcutils_stringbuilder *sb, size_t sz)
 {
@@ -70,21 +87,60 @@ pcutils_stringbuilder_keep(struct pcutils_stringbuilder *sb, size_t sz)
         }
     }
 
-    struct pcutils_buf *buf;
-    buf = (struct pcutils_buf*)malloc(sizeof(*buf) + sz);
-    if (!buf)
+    if (stringbuilder_add_buf(sb, sz) == NULL)
         return -1;
 
-    buf->sz = sz;
-    buf->curr = 0;
-    buf->buf[0] = '\0';
+    return 0;
+}
 
-    list_add_tail(&buf->node, &sb->list);
-    sb->curr = buf;
+int
+pcutils_stringbuilder_append(struct pcutils_stringbuilder *sb,
+        const void *data, size_t len)
+{
+    const char *p = (const char *)data;
+    size_t left = len;
+
+    if (sb->oom)
+        return -1;
+
+    while (left > 0) {
+        struct pcutils_buf *buf = sb->curr;
+        if (buf == NULL || buf->curr == buf->sz) {
+            /* a large piece goes into a chunk of its own */
+            size_t sz = left > sb->chunk ? left : sb->chunk;
+            buf = stringbuilder_add_buf(sb, sz);
+            if (buf == NULL) {
+                sb->oom = 1;
+                return -1;
+            }
+        }
 
+        size_t n = buf->sz - buf->curr;
+        if (n > left)
+            n = left;
+        memcpy(buf->buf + buf->curr, p, n);
+        buf->curr += n;
+        p += n;
+        left -= n;
+    }
+
+    sb->total += len;
     return 0;
 }
 
+void
+pcutils_stringbuilder_copy(struct pcutils_stringbuilder *sb, void *dst)
+{
+    char *s = (char *)dst;
+    struct list_head *p;
+    list_for_each(p, &sb->list) {
+        struct pcutils_buf *buf;
+        buf = container_of(p, struct pcutils_buf, node);
+        memcpy(s, buf->buf, buf->curr);
+        s += buf->curr;
+    }
+}
+
 int
 pcutils_stringbuilder_snprintf(struct pcutils_stringbuilder *sb,
         const char *fmt, ...)
@@ -159,15 +215,8 @@ pcutils_stringbuilder_build(struct pcutils_stringbuilder *sb)
     if (!buf)
         return NULL;
 
-    char *s = buf;
-    struct list_head *p, *n;
-    list_for_each_safe(p, n, &sb->list) {
-        struct pcutils_buf *buf;
-        buf = container_of(p, struct pcutils_buf, node);
-        int n = snprintf(s, sz, "%s", buf->buf);
-        sz -= n;
-        s  += n;
-    }
+    pcutils_stringbuilder_copy(sb, buf);
+    buf[sb->total] = '\0';
 
     return buf;
 }
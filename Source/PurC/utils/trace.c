@@ -0,0 +1,296 @@
+/*
+ * @file trace.c
+ * @date 2026/10/14
+ * @brief The tracing spans of the hot paths in Chrome trace format.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc.h"
+#include "private/errors.h"
+#include "private/instance.h"
+#include "private/debug.h"
+#include "private/trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define MAX_TRACE_EVENTS        (1024 * 1024)
+
+struct pctrace_event {
+    const char         *cat;
+    const char         *name;
+    uint64_t            ts_us;
+    uint64_t            dur_us;
+};
+
+/*
+ * Every instance runs in its own thread, so the ring buffer has only one
+ * writer and needs no lock; the oldest spans are overwritten when full.
+ */
+struct pctrace_ring {
+    size_t              capacity;
+    size_t              nr_recorded;
+    struct pctrace_event events[];
+};
+
+/* serializes the appending to the trace file by the instances */
+static purc_mutex       file_lock;
+
+static inline uint64_t
+get_monotonic_us(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec * 1000000ULL + (uint64_t)tp.tv_nsec / 1000;
+}
+
+uint64_t
+pctrace_begin(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->trace == NULL)
+        return 0;
+
+    return get_monotonic_us();
+}
+
+void
+pctrace_end(uint64_t begin, const char *cat, const char *name)
+{
+    if (begin == 0)
+        return;
+
+    struct pcinst *inst = pcinst_current();
+    struct pctrace_ring *ring = inst ? inst->trace : NULL;
+    if (ring == NULL)
+        return;
+
+    struct pctrace_event *ev;
+    ev = ring->events + (ring->nr_recorded % ring->capacity);
+    ev->cat = cat;
+    ev->name = name;
+    ev->ts_us = begin;
+    ev->dur_us = get_monotonic_us() - begin;
+    ring->nr_recorded++;
+}
+
+static struct pctrace_ring *
+ring_new(size_t capacity)
+{
+    if (capacity > MAX_TRACE_EVENTS)
+        capacity = MAX_TRACE_EVENTS;
+
+    struct pctrace_ring *ring;
+    ring = malloc(sizeof(*ring) + sizeof(struct pctrace_event) * capacity);
+    if (ring == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    ring->capacity = capacity;
+    ring->nr_recorded = 0;
+    return ring;
+}
+
+int
+purc_enable_tracing(size_t nr_events)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return -1;
+    }
+
+    struct pctrace_ring *ring = NULL;
+    if (nr_events > 0 && (ring = ring_new(nr_events)) == NULL)
+        return -1;
+
+    free(inst->trace);
+    inst->trace = ring;
+    return 0;
+}
+
+/*
+ * Writes the metadata of the thread and the spans in the oldest-first
+ * order, separated by commas; a comma is appended if @trailing is true.
+ */
+static void
+dump_events(struct pcinst *inst, purc_rwstream_t stm, bool trailing)
+{
+    const struct pctrace_ring *ring = inst->trace;
+    int pid = (int)getpid();
+    unsigned tid = (unsigned)inst->endpoint_atom;
+    char buf[256];
+    int n;
+
+    n = snprintf(buf, sizeof(buf),
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,"
+            "\"args\":{\"name\":\"%s\"}}", pid, tid, inst->endpoint_name);
+    purc_rwstream_write(stm, buf, n);
+
+    size_t first = 0, nr = ring->nr_recorded;
+    if (nr > ring->capacity) {
+        first = nr % ring->capacity;
+        nr = ring->capacity;
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        const struct pctrace_event *ev;
+        ev = ring->events + ((first + i) % ring->capacity);
+        n = snprintf(buf, sizeof(buf),
+                ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                "\"ts\":%llu,\"dur\":%llu,\"pid\":%d,\"tid\":%u}",
+                ev->name, ev->cat, (unsigned long long)ev->ts_us,
+                (unsigned long long)ev->dur_us, pid, tid);
+        purc_rwstream_write(stm, buf, n);
+    }
+
+    if (trailing)
+        purc_rwstream_write(stm, ",\n", 2);
+}
+
+int
+purc_dump_trace(purc_rwstream_t stm)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return -1;
+    }
+
+    if (stm == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    static const char head[] = "{\"traceEvents\":[\n";
+    static const char tail[] = "\n]}\n";
+
+    purc_rwstream_write(stm, head, sizeof(head) - 1);
+    if (inst->trace)
+        dump_events(inst, stm, false);
+    purc_rwstream_write(stm, tail, sizeof(tail) - 1);
+    return 0;
+}
+
+/*
+ * NOTE: the JSON array format of Chrome trace does not require the closing
+ * bracket, so the instances append their spans to the file independently.
+ */
+static void
+append_to_file(struct pcinst *inst, const char *file)
+{
+    purc_rwstream_t stm = purc_rwstream_new_buffer(4096, 0);
+    if (stm == NULL)
+        return;
+
+    dump_events(inst, stm, true);
+
+    size_t sz = 0;
+    const char *buf = purc_rwstream_get_mem_buffer(stm, &sz);
+
+    purc_mutex_lock(&file_lock);
+    int fd = open(file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size == 0 && write(fd, "[\n", 2)) {
+            // the opening bracket written
+        }
+
+        if (write(fd, buf, sz) < 0) {
+            PC_WARN("Failed to write the trace file: %s\n", file);
+        }
+        close(fd);
+    }
+    else {
+        PC_WARN("Failed to open the trace file: %s\n", file);
+    }
+    purc_mutex_unlock(&file_lock);
+
+    purc_rwstream_destroy(stm);
+}
+
+static void trace_cleanup_once(void)
+{
+    if (file_lock.native_impl)
+        purc_mutex_clear(&file_lock);
+}
+
+static int trace_init_once(void)
+{
+    purc_mutex_init(&file_lock);
+    if (file_lock.native_impl == NULL)
+        return -1;
+    purc_mutex_set_name(&file_lock, "trace-file");
+
+    if (atexit(trace_cleanup_once)) {
+        purc_mutex_clear(&file_lock);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int trace_init_instance(struct pcinst* inst,
+        const purc_instance_extra_info* extra_info)
+{
+    UNUSED_PARAM(extra_info);
+
+    inst->trace = NULL;
+
+    const char *env = getenv(PURC_ENVV_TRACE_EVENTS);
+    if (env) {
+        long nr = strtol(env, NULL, 10);
+        if (nr > 0 && (inst->trace = ring_new((size_t)nr)) == NULL)
+            return PURC_ERROR_OUT_OF_MEMORY;
+    }
+
+    return 0;
+}
+
+static void trace_cleanup_instance(struct pcinst* inst)
+{
+    if (inst->trace == NULL)
+        return;
+
+    PC_DEBUG("Tracing spans recorded: %u\n",
+            (unsigned)inst->trace->nr_recorded);
+
+    const char *file = getenv(PURC_ENVV_TRACE_FILE);
+    if (file && file[0])
+        append_to_file(inst, file);
+
+    free(inst->trace);
+    inst->trace = NULL;
+}
+
+struct pcmodule _module_trace = {
+    .id              = PURC_HAVE_UTILS,
+    .module_inited   = 0,
+
+    .init_once       = trace_init_once,
+    .init_instance   = trace_init_instance,
+    .cleanup_instance = trace_cleanup_instance,
+};
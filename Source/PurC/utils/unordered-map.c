@@ -31,6 +31,18 @@ int pcutils_uomap_traverse(pcutils_uomap *map, void *ud,
 {
     pchash_entry *entry;
 
+    if (pchash_table_is_open(map)) {
+        struct list_head *p, *n;
+        list_for_each_safe(p, n, &map->entries) {
+            entry = list_entry(p, pchash_entry, list);
+            int r = cb(entry->key, entry->val, ud);
+            if (r)
+                return r;
+        }
+
+        return 0;
+    }
+
     for (size_t i = 0; i < map->size; i++) {
         struct list_head *p, *n;
         list_for_each_safe(p, n, map->table + i) {
@@ -49,6 +61,12 @@ pcutils_uomap_it_begin_first(pcutils_uomap *map)
 {
     struct pcutils_uomap_iterator it = { map, NULL };
 
+    if (pchash_table_is_open(map)) {
+        if (!list_empty(&map->entries))
+            it.curr = list_first_entry(&map->entries, pchash_entry, list);
+        return it;
+    }
+
     for (size_t i = 0; i < map->size; i++) {
         if (!list_empty(map->table + i)) {
             it.curr = list_first_entry(map->table + i, pchash_entry, list);
@@ -64,6 +82,12 @@ pcutils_uomap_it_begin_last(pcutils_uomap *map)
 {
     struct pcutils_uomap_iterator it = { map, NULL };
 
+    if (pchash_table_is_open(map)) {
+        if (!list_empty(&map->entries))
+            it.curr = list_last_entry(&map->entries, pchash_entry, list);
+        return it;
+    }
+
     for (size_t i = map->size; i > 0; i--) {
         size_t slot = i - 1;
         if (!list_empty(map->table + slot)) {
@@ -84,6 +108,14 @@ pcutils_uomap_it_value(struct pcutils_uomap_iterator *it)
 pcutils_uomap_entry *
 pcutils_uomap_it_next(struct pcutils_uomap_iterator *it)
 {
+    if (pchash_table_is_open(it->map)) {
+        if (list_is_last(&it->curr->list, &it->map->entries))
+            it->curr = NULL;
+        else
+            it->curr = list_entry(it->curr->list.next, pchash_entry, list);
+        goto done;
+    }
+
     if (list_is_last(&it->curr->list, it->map->table + it->curr->slot)) {
         for (size_t i = it->curr->slot + 1; i < it->map->size; i++) {
             if (!list_empty(it->map->table + i)) {
@@ -106,6 +138,14 @@ done:
 pcutils_uomap_entry *
 pcutils_uomap_it_prev(struct pcutils_uomap_iterator *it)
 {
+    if (pchash_table_is_open(it->map)) {
+        if (list_is_first(&it->curr->list, &it->map->entries))
+            it->curr = NULL;
+        else
+            it->curr = list_entry(it->curr->list.prev, pchash_entry, list);
+        goto done;
+    }
+
     if (list_is_first(&it->curr->list, it->map->table + it->curr->slot)) {
         for (size_t i = it->curr->slot; i > 0; i--) {
             size_t slot = i - 1;
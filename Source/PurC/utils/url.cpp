@@ -188,12 +188,41 @@ static String percentEncodeCharacters(const unsigned char * data)
     return builder.toString();
 }
 
+/*
+ * The URLs parsed recently in this thread, that is, in this instance;
+ * the same URLs are broken down again and again when an HVML program opens
+ * streams or polls an API. The entries are replaced in turn.
+ */
+#define NR_PARSED_URLS          16
+
+struct parsed_url {
+    CString         source;
+    PurCWTF::URL    url;
+};
+
+static thread_local struct parsed_url parsed_urls[NR_PARSED_URLS];
+static thread_local unsigned next_parsed_url;
+
+static const PurCWTF::URL &parse_url(const char *url_string)
+{
+    for (size_t i = 0; i < NR_PARSED_URLS; i++) {
+        const CString &source = parsed_urls[i].source;
+        if (!source.isNull() && strcmp(source.data(), url_string) == 0)
+            return parsed_urls[i].url;
+    }
+
+    struct parsed_url &slot =
+        parsed_urls[next_parsed_url++ % NR_PARSED_URLS];
+    String encode_url = percentEncodeCharacters((const unsigned char *)url_string);
+    slot.source = CString(url_string);
+    slot.url = PurCWTF::URL(URL(), encode_url);
+    return slot.url;
+}
+
 bool pcutils_url_break_down(struct purc_broken_down_url *url_struct,
         const char *url_string)
 {
-    // std::unique_ptr<PurCWTF::URL> url = makeUnique<URL>(URL(), url_string);
-    String encode_url = percentEncodeCharacters((const unsigned char *)url_string);
-    PurCWTF::URL url(URL(), encode_url);
+    const PurCWTF::URL &url = parse_url(url_string);
 
     bool valid = url.isValid();
     size_t length = 0;
@@ -295,10 +324,7 @@ bool pcutils_url_break_down(struct purc_broken_down_url *url_struct,
 
 bool pcutils_url_is_valid(const char *url_string)
 {
-    String encode_url = percentEncodeCharacters((const unsigned char *)url_string);
-    PurCWTF::URL url(URL(), encode_url);
-
-    return url.isValid();
+    return parse_url(url_string).isValid();
 }
 
 #define PAIR_SEPERATOR      '&'
@@ -38,12 +38,104 @@
 #include <string.h>
 #include <assert.h>
 
+#if CPU(X86_SSE2)
+#include <emmintrin.h>
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
 #define VALIDATE_BYTE(mask, expect)                         \
 do {                                                        \
     if (UNLIKELY((*(uint8_t *)p & (mask)) != (expect)))     \
     goto error;                                             \
 } while (0)
 
+/*
+ * Returns the length of the leading run of the ASCII characters in the first
+ * @len bytes of @str; the run stops at a NUL byte unless @with_nulls is true.
+ * The callers handle the byte terminating the run one by one, so the SIMD
+ * loops only need to find it; SSE2 and NEON are the baseline of x86-64 and
+ * ARM64, so no runtime dispatch is needed.
+ */
+static size_t
+ascii_run_length(const char *str, size_t len, bool with_nulls)
+{
+    const unsigned char *p = (const unsigned char *)str;
+    size_t pos = 0;
+
+#if CPU(X86_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + pos));
+        int mask = _mm_movemask_epi8(v);
+        if (!with_nulls)
+            mask |= _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        if (mask)
+            return pos + __builtin_ctz((unsigned)mask);
+    }
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+    /* (c - 1) >= 0x7F iff c is NUL or not ASCII */
+    const uint8x16_t one = vdupq_n_u8(with_nulls ? 0x00 : 0x01);
+    const uint8x16_t limit = vdupq_n_u8(with_nulls ? 0x80 : 0x7F);
+    for (; pos + 16 <= len; pos += 16) {
+        uint8x16_t v = vsubq_u8(vld1q_u8(p + pos), one);
+        if (vmaxvq_u8(vcgeq_u8(v, limit)))
+            break;      /* locate the byte in the scalar loop below */
+    }
+#endif
+
+    for (; pos < len; pos++) {
+        if (p[pos] >= 0x80 || (p[pos] == 0 && !with_nulls))
+            break;
+    }
+
+    return pos;
+}
+
+/*
+ * The same as ascii_run_length() but for a null-terminated string. The SIMD
+ * loops use the aligned loads which never cross the boundary of a page, so
+ * the bytes after the terminating NUL byte can be read safely, but not for
+ * the address sanitizer.
+ */
+static size_t SUPPRESS_ASAN
+ascii_run_length_nt(const char *str)
+{
+    const unsigned char *p = (const unsigned char *)str;
+
+#if CPU(X86_SSE2) || (CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS))
+    for (; ((uintptr_t)p & 15) != 0; p++) {
+        if (*p == 0 || *p >= 0x80)
+            return p - (const unsigned char *)str;
+    }
+
+#if CPU(X86_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (;; p += 16) {
+        __m128i v = _mm_load_si128((const __m128i *)p);
+        int mask = _mm_movemask_epi8(v) |
+            _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        if (mask)
+            return p - (const unsigned char *)str +
+                __builtin_ctz((unsigned)mask);
+    }
+#else
+    const uint8x16_t one = vdupq_n_u8(0x01);
+    const uint8x16_t limit = vdupq_n_u8(0x7F);
+    for (;; p += 16) {
+        uint8x16_t v = vsubq_u8(vld1q_u8(p), one);
+        if (vmaxvq_u8(vcgeq_u8(v, limit)))
+            break;      /* locate the byte in the scalar loop below */
+    }
+#endif
+#endif
+
+    while (*p && *p < 0x80)
+        p++;
+
+    return p - (const unsigned char *)str;
+}
+
 /* see IETF RFC 3629 Section 4 */
 
 static const char *
@@ -54,7 +146,9 @@ fast_validate(const char *str, size_t *nr_chars)
 
     for (p = str; *p; p++) {
         if (*(uint8_t *)p < 128) {
-            n++;
+            size_t run = ascii_run_length_nt(p);
+            n += run;
+            p += run - 1;
         }
         else {
             const char *last;
@@ -127,7 +221,9 @@ fast_validate_len(const char *str, ssize_t max_len, size_t *nr_chars)
 
     for (p = str; ((p - str) < max_len) && *p; p++) {
         if (*(uint8_t *)p < 128) {
-            n++;
+            size_t run = ascii_run_length(p, max_len - (p - str), false);
+            n += run;
+            p += run - 1;
         }
         else {
             const char *last;
@@ -259,6 +355,13 @@ pcutils_string_utf8_chars(const char *p, ssize_t max)
 
     if (max < 0) {
         while (*p) {
+            size_t run = ascii_run_length_nt(p);
+            if (run) {
+                nr_chars += run;
+                p += run;
+                continue;
+            }
+
             p = pcutils_utf8_next_char(p);
             ++nr_chars;
         }
@@ -267,6 +370,13 @@ pcutils_string_utf8_chars(const char *p, ssize_t max)
         p = pcutils_utf8_next_char(p);
 
         while (p - start < max && *p) {
+            size_t run = ascii_run_length(p, max - (p - start), false);
+            if (run) {
+                nr_chars += run;
+                p += run;
+                continue;
+            }
+
             ++nr_chars;
             p = pcutils_utf8_next_char(p);
         }
@@ -292,6 +402,13 @@ pcutils_string_utf8_chars_with_nulls(const char *p, ssize_t len)
 
     if (len < 0) {
         while (*p) {
+            size_t run = ascii_run_length_nt(p);
+            if (run) {
+                nr_chars += run;
+                p += run;
+                continue;
+            }
+
             p = pcutils_utf8_next_char(p);
             ++nr_chars;
         }
@@ -300,6 +417,13 @@ pcutils_string_utf8_chars_with_nulls(const char *p, ssize_t len)
         p = pcutils_utf8_next_char(p);
 
         while (p - start < len) {
+            size_t run = ascii_run_length(p, len - (p - start), true);
+            if (run) {
+                nr_chars += run;
+                p += run;
+                continue;
+            }
+
             ++nr_chars;
             p = pcutils_utf8_next_char(p);
         }
@@ -219,7 +219,11 @@ purc_variant_make_string_ex(const char* str_utf8, size_t len,
         len = end - str_utf8;
     }
 
-    value = pcvariant_get (PURC_VARIANT_TYPE_STRING);
+    bool trailing = (len >= sz_bytes && len < PCVRNT_SZ_TRAILING);
+    if (trailing)
+        value = pcvariant_get_trailing (PURC_VARIANT_TYPE_STRING);
+    else
+        value = pcvariant_get (PURC_VARIANT_TYPE_STRING);
     if (value == NULL) {
         pcinst_set_error (PURC_ERROR_OUT_OF_MEMORY);
         return PURC_VARIANT_INVALID;
@@ -236,6 +240,15 @@ purc_variant_make_string_ex(const char* str_utf8, size_t len,
         // VWNOTE: always store the size including the terminating null byte.
         value->size = len + 1;
     }
+    else if (trailing) {
+        char *buf = pcvariant_trailing(value);
+
+        value->flags = PCVRNT_FLAG_EXTRA_SIZE | PCVRNT_FLAG_TRAILING;
+        value->sz_ptr[1] = (uintptr_t)buf;
+        memcpy(buf, str_utf8, len);
+        buf[len] = '\0';
+        pcvariant_stat_set_extra_size (value, len + 1);
+    }
     else {
         char* new_buf;
         new_buf = malloc(len + 1);
@@ -339,6 +352,184 @@ purc_variant_t purc_variant_make_string_static(const char* str_utf8,
     return value;
 }
 
+/* the limits for the strings interned by pcvariant_make_key_string() */
+#define MAX_INTERNED_STRINGS    4096
+#define MAX_LEN_INTERNED_KEY    64
+
+/*
+ * NOTE: like the constants, the interned string variants are owned by the
+ * heap: they are flagged with PCVRNT_FLAG_NOFREE, not counted in the
+ * statistics, and only released when the instance exits.
+ */
+static void interned_free_val(void *val)
+{
+    pcvariant_free((purc_variant_t)val);
+}
+
+static purc_variant_t
+new_interned(struct pcvariant_heap *heap, const char *interned,
+        size_t nr_chars, uint32_t hash)
+{
+    if (heap->interned == NULL) {
+        heap->interned = pcutils_uomap_create(NULL, NULL, NULL,
+                interned_free_val, pchash_fast_str_hash, comp_key_string,
+                false, false);
+        if (heap->interned == NULL)
+            return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t value = pcvariant_alloc_0();
+    if (value == NULL)
+        return PURC_VARIANT_INVALID;
+
+    value->type = PURC_VARIANT_TYPE_STRING;
+    value->flags = PCVRNT_FLAG_NOFREE | PCVRNT_FLAG_STRING_STATIC |
+        PCVRNT_FLAG_STRING_HASHED;
+    value->refc = 1;
+    value->str_hash = hash;
+    value->extra_size = nr_chars;
+    value->sz_ptr[0] = (uintptr_t)strlen(interned) + 1;
+    value->sz_ptr[1] = (uintptr_t)interned;
+
+    if (pchash_table_insert_w_hash(heap->interned, interned, value,
+                hash, NULL)) {
+        pcvariant_free(value);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return value;
+}
+
+static purc_variant_t
+make_string_interned(const char *str_utf8, bool check_encoding, bool limited)
+{
+    struct pcinst *inst = pcinst_current();
+    PC_ASSERT(inst);
+
+    /* the variants in the move heap are never cached */
+    struct pcvariant_heap *heap = inst->variant_heap;
+    bool cacheable = (heap == inst->org_vrt_heap);
+    uint32_t hash = pchash_fast_str_hash(str_utf8);
+
+    if (cacheable && heap->interned) {
+        pcutils_uomap_entry *entry;
+        entry = pchash_table_lookup_entry_w_hash(heap->interned,
+                str_utf8, hash);
+        if (entry) {
+            purc_variant_t value = pcutils_uomap_entry_val(entry);
+            /* NOTE: the reference count of a NOFREE variant may be 0 */
+            value->refc++;
+            return value;
+        }
+
+        if (limited && pcutils_uomap_get_size(heap->interned) >=
+                MAX_INTERNED_STRINGS)
+            cacheable = false;
+    }
+
+    if (limited && !cacheable)
+        return purc_variant_make_string(str_utf8, check_encoding);
+
+    size_t nr_chars;
+    if (check_encoding) {
+        if (!pcutils_string_check_utf8(str_utf8, -1, &nr_chars, NULL)) {
+            pcinst_set_error(PURC_ERROR_BAD_ENCODING);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+    else {
+        nr_chars = pcutils_string_utf8_chars(str_utf8, -1);
+    }
+
+    purc_atom_t atom = purc_atom_from_string(str_utf8);
+    if (atom == 0) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    const char *interned = purc_atom_to_string(atom);
+    purc_variant_t value = PURC_VARIANT_INVALID;
+    if (cacheable)
+        value = new_interned(heap, interned, nr_chars, hash);
+
+    if (value == PURC_VARIANT_INVALID) {
+        /* fall back to a normal static string sharing the atom string */
+        value = purc_variant_make_string_static(interned, false);
+        if (value) {
+            value->str_hash = hash;
+            value->flags |= PCVRNT_FLAG_STRING_HASHED;
+        }
+    }
+
+    return value;
+}
+
+purc_variant_t
+purc_variant_make_string_interned(const char *str_utf8, bool check_encoding)
+{
+    PCVRNT_CHECK_FAIL_RET(str_utf8, PURC_VARIANT_INVALID);
+
+    return make_string_interned(str_utf8, check_encoding, false);
+}
+
+purc_variant_t
+pcvariant_make_key_string(const char *str_utf8, bool check_encoding)
+{
+    PCVRNT_CHECK_FAIL_RET(str_utf8, PURC_VARIANT_INVALID);
+
+    if (strlen(str_utf8) > MAX_LEN_INTERNED_KEY)
+        return purc_variant_make_string(str_utf8, check_encoding);
+
+    return make_string_interned(str_utf8, check_encoding, true);
+}
+
+purc_variant_t
+purc_variant_make_string_view(purc_variant_t owner, const char* str_utf8,
+        size_t len, bool check_encoding)
+{
+    PCVRNT_CHECK_FAIL_RET(str_utf8, PURC_VARIANT_INVALID);
+
+    static const size_t sz_bytes = MAX(sizeof(long double), sizeof(void*) * 2);
+    if (len < sz_bytes || str_utf8[len] != '\0')
+        return purc_variant_make_string_ex(str_utf8, len, check_encoding);
+
+    size_t nr_chars;
+    if (check_encoding) {
+        if (!pcutils_string_check_utf8_len(str_utf8, len, &nr_chars, NULL)) {
+            pcinst_set_error(PURC_ERROR_BAD_ENCODING);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+    else {
+        nr_chars = pcutils_string_utf8_chars(str_utf8, len);
+    }
+
+    purc_variant_t value;
+    if (owner)
+        value = pcvariant_get_trailing(PURC_VARIANT_TYPE_STRING);
+    else
+        value = pcvariant_get(PURC_VARIANT_TYPE_STRING);
+    if (value == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    value->type = PURC_VARIANT_TYPE_STRING;
+    value->flags = PCVRNT_FLAG_STRING_STATIC;
+    value->refc = 1;
+    value->extra_size = nr_chars;
+    value->sz_ptr[0] = (uintptr_t)len + 1;
+    value->sz_ptr[1] = (uintptr_t)str_utf8;
+
+    if (owner) {
+        /* the owner is kept in the trailing space */
+        value->flags |= PCVRNT_FLAG_TRAILING | PCVRNT_FLAG_STRING_VIEW;
+        *(purc_variant_t *)pcvariant_trailing(value) = purc_variant_ref(owner);
+    }
+
+    return value;
+}
+
 const char* purc_variant_get_string_const_ex(purc_variant_t string,
         size_t *str_len)
 {
@@ -410,6 +601,19 @@ bool purc_variant_string_chars(purc_variant_t string, size_t *nr_chars)
     return false;
 }
 
+uint32_t pcvariant_string_hash(purc_variant_t string)
+{
+    PC_ASSERT(IS_TYPE(string, PURC_VARIANT_TYPE_STRING));
+
+    if (!(string->flags & PCVRNT_FLAG_STRING_HASHED)) {
+        string->str_hash = pchash_fast_str_hash(
+                purc_variant_get_string_const(string));
+        string->flags |= PCVRNT_FLAG_STRING_HASHED;
+    }
+
+    return string->str_hash;
+}
+
 void pcvariant_string_release (purc_variant_t string)
 {
     PC_ASSERT(string);
@@ -418,7 +622,11 @@ void pcvariant_string_release (purc_variant_t string)
         if (string->flags & PCVRNT_FLAG_EXTRA_SIZE) {
             // VWNOTE: sz_ptr[0] will be set in pcvariant_stat_set_extra_size
             pcvariant_stat_set_extra_size (string, 0);
-            free ((void *)string->sz_ptr[1]);
+            if (!(string->flags & PCVRNT_FLAG_TRAILING))
+                free ((void *)string->sz_ptr[1]);
+        }
+        else if (string->flags & PCVRNT_FLAG_STRING_VIEW) {
+            purc_variant_unref(*(purc_variant_t *)pcvariant_trailing(string));
         }
     }
     else
@@ -555,7 +763,12 @@ purc_variant_t purc_variant_make_byte_sequence(const void* bytes,
         PURC_VARIANT_INVALID);
 
     static const size_t sz_bytes = MAX(sizeof(long double), sizeof(void*) * 2);
-    purc_variant_t value = pcvariant_get(PURC_VARIANT_TYPE_BSEQUENCE);
+    bool trailing = (nr_bytes > sz_bytes && nr_bytes <= PCVRNT_SZ_TRAILING);
+    purc_variant_t value;
+    if (trailing)
+        value = pcvariant_get_trailing(PURC_VARIANT_TYPE_BSEQUENCE);
+    else
+        value = pcvariant_get(PURC_VARIANT_TYPE_BSEQUENCE);
 
     if (value == NULL) {
         pcinst_set_error (PURC_ERROR_OUT_OF_MEMORY);
@@ -570,6 +783,12 @@ purc_variant_t purc_variant_make_byte_sequence(const void* bytes,
         value->size = nr_bytes;
         memcpy (value->bytes, bytes, nr_bytes);
     }
+    else if (trailing) {
+        value->flags = PCVRNT_FLAG_EXTRA_SIZE | PCVRNT_FLAG_TRAILING;
+        value->sz_ptr[1] = (uintptr_t)pcvariant_trailing(value);
+        memcpy ((void *)value->sz_ptr[1], bytes, nr_bytes);
+        pcvariant_stat_set_extra_size (value, nr_bytes);
+    }
     else {
         value->flags = PCVRNT_FLAG_EXTRA_SIZE;
         value->sz_ptr[1] = (uintptr_t) malloc (nr_bytes);
@@ -611,6 +830,38 @@ purc_variant_t purc_variant_make_byte_sequence_static(const void* bytes,
     return value;
 }
 
+purc_variant_t
+purc_variant_make_byte_sequence_view(purc_variant_t owner, const void* bytes,
+        size_t nr_bytes)
+{
+    PCVRNT_CHECK_FAIL_RET((bytes != NULL && nr_bytes > 0),
+        PURC_VARIANT_INVALID);
+
+    purc_variant_t value;
+    if (owner)
+        value = pcvariant_get_trailing(PURC_VARIANT_TYPE_BSEQUENCE);
+    else
+        value = pcvariant_get(PURC_VARIANT_TYPE_BSEQUENCE);
+    if (value == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    value->type = PURC_VARIANT_TYPE_BSEQUENCE;
+    value->flags = PCVRNT_FLAG_STRING_STATIC;
+    value->refc = 1;
+    value->sz_ptr[0] = nr_bytes;
+    value->sz_ptr[1] = (uintptr_t)bytes;
+
+    if (owner) {
+        /* the owner is kept in the trailing space */
+        value->flags |= PCVRNT_FLAG_TRAILING | PCVRNT_FLAG_STRING_VIEW;
+        *(purc_variant_t *)pcvariant_trailing(value) = purc_variant_ref(owner);
+    }
+
+    return value;
+}
+
 purc_variant_t purc_variant_make_byte_sequence_reuse_buff(void* bytes,
         size_t nr_bytes, size_t sz_buff)
 {
@@ -719,7 +970,11 @@ void pcvariant_sequence_release(purc_variant_t sequence)
         if (sequence->flags & PCVRNT_FLAG_EXTRA_SIZE) {
             // VWNOTE: sz_ptr[0] will be set in pcvariant_stat_set_extra_size
             pcvariant_stat_set_extra_size (sequence, 0);
-            free((void *)sequence->sz_ptr[1]);
+            if (!(sequence->flags & PCVRNT_FLAG_TRAILING))
+                free((void *)sequence->sz_ptr[1]);
+        }
+        else if (sequence->flags & PCVRNT_FLAG_STRING_VIEW) {
+            purc_variant_unref(*(purc_variant_t *)pcvariant_trailing(sequence));
         }
     }
     else
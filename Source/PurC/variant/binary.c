@@ -0,0 +1,1160 @@
+/*
+ * @file binary.c
+ * @date 2026/10/14
+ * @brief The binary serialization of variants.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc-variant.h"
+#include "purc-rwstream.h"
+#include "purc-utils.h"
+#include "purc-ports.h"
+#include "private/variant.h"
+#include "private/atom-buckets.h"
+#include "private/errors.h"
+#include "private/debug.h"
+
+#include "variant-internals.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#if HAVE(MMAP)
+#include <sys/mman.h>
+#endif
+
+/*
+ * Every value is encoded as a tag byte followed by the payload of the tag.
+ * The lengths and the counts are unsigned LEB128 integers (`uint` below);
+ * the fixed-size numbers are in little endian.
+ *
+ *  BIN_UNDEFINED, BIN_NULL, BIN_FALSE, BIN_TRUE: no payload.
+ *  BIN_NUMBER, BIN_LONGINT, BIN_ULONGINT: 8 bytes.
+ *  BIN_LONGDOUBLE: a byte for sizeof(long double), then the bytes in
+ *      the native format; it can only be loaded on the same architecture.
+ *  BIN_EXCEPTION, BIN_ATOMSTRING, BIN_STRING, BIN_BSEQUENCE:
+ *      uint length, then the bytes (without the terminating null byte).
+ *  BIN_OBJECT: uint count, then count pairs of string bytes and value.
+ *  BIN_ARRAY, BIN_TUPLE: uint count, then count values.
+ *  BIN_PACKED_ARRAY: a byte for the packed type, uint count,
+ *      then count 8-byte elements.
+ *  BIN_SET: a byte for the flags (BIN_SET_CASELESS), the unique keys as
+ *      uint length and bytes (zero length for a generic set), uint count,
+ *      then count values.
+ *
+ * A dynamic or a native entity is meaningless out of its process;
+ * it is encoded as null.
+ *
+ * A snapshot is the magic `PURCSNAP` and a version byte, followed by a value
+ * in the same encoding except that every string (including the keys of
+ * objects, but not the unique keys of sets) is encoded as uint length,
+ * uint number of characters, the bytes, and a null byte. So the strings and
+ * the byte sequences can be used in place when the snapshot is mapped into
+ * memory, without copying or scanning them.
+ */
+enum {
+    BIN_UNDEFINED = 0x00,
+    BIN_NULL,
+    BIN_FALSE,
+    BIN_TRUE,
+    BIN_NUMBER,
+    BIN_LONGINT,
+    BIN_ULONGINT,
+    BIN_LONGDOUBLE,
+    BIN_EXCEPTION,
+    BIN_ATOMSTRING,
+    BIN_STRING,
+    BIN_BSEQUENCE,
+    BIN_OBJECT,
+    BIN_ARRAY,
+    BIN_PACKED_ARRAY,
+    BIN_SET,
+    BIN_TUPLE,
+};
+
+#define BIN_SET_CASELESS        0x01
+
+#define MAX_UINT_BYTES          10      /* for 64-bit */
+#define SZ_STACK_STRING         256
+
+#define SNAPSHOT_MAGIC          "PURCSNAP"
+#define SNAPSHOT_VERSION        1
+#define SZ_SNAPSHOT_HEADER      (sizeof(SNAPSHOT_MAGIC) - 1 + 1)
+
+struct bin_writer {
+    purc_rwstream_t rws;
+    ssize_t         nr_written;
+    bool            snapshot;
+    /* fails on the dynamic and native values instead of encoding null */
+    bool            strict;
+};
+
+/* reads from a stream, or from the memory of a snapshot if `mem` is set */
+struct bin_reader {
+    purc_rwstream_t rws;
+    const char     *mem;
+    size_t          left;
+};
+
+static int
+put_bytes(struct bin_writer *wr, const void *bytes, size_t n)
+{
+    const char *p = bytes;
+
+    while (n > 0) {
+        ssize_t r = purc_rwstream_write(wr->rws, p, n);
+        if (r <= 0) {
+            if (purc_get_last_error() == PURC_ERROR_OK)
+                purc_set_error(PURC_ERROR_OUTPUT);
+            return -1;
+        }
+
+        wr->nr_written += r;
+        p += r;
+        n -= r;
+    }
+
+    return 0;
+}
+
+static inline int
+put_tag(struct bin_writer *wr, uint8_t tag)
+{
+    return put_bytes(wr, &tag, 1);
+}
+
+static int
+put_uint(struct bin_writer *wr, uint64_t u64)
+{
+    uint8_t buf[MAX_UINT_BYTES];
+    size_t n = 0;
+
+    do {
+        uint8_t byte = u64 & 0x7F;
+        u64 >>= 7;
+        if (u64)
+            byte |= 0x80;
+        buf[n++] = byte;
+    } while (u64);
+
+    return put_bytes(wr, buf, n);
+}
+
+static int
+put_u64(struct bin_writer *wr, uint64_t u64)
+{
+    uint8_t buf[8];
+    for (int i = 0; i < 8; i++) {
+        buf[i] = (uint8_t)u64;
+        u64 >>= 8;
+    }
+
+    return put_bytes(wr, buf, sizeof(buf));
+}
+
+static int
+put_tagged_bytes(struct bin_writer *wr, uint8_t tag,
+        const void *bytes, size_t len)
+{
+    if (put_tag(wr, tag) || put_uint(wr, len))
+        return -1;
+    return put_bytes(wr, bytes, len);
+}
+
+static int
+put_string(struct bin_writer *wr, const char *str, size_t len)
+{
+    if (put_uint(wr, len))
+        return -1;
+
+    if (!wr->snapshot)
+        return put_bytes(wr, str, len);
+
+    if (put_uint(wr, pcutils_string_utf8_chars(str, len)) ||
+            put_bytes(wr, str, len))
+        return -1;
+    return put_bytes(wr, "", 1);
+}
+
+static inline int
+put_tagged_string(struct bin_writer *wr, uint8_t tag,
+        const char *str, size_t len)
+{
+    if (put_tag(wr, tag))
+        return -1;
+    return put_string(wr, str, len);
+}
+
+static int
+put_packed_array(struct bin_writer *wr, pcvrnt_packed_type_k type,
+        const void *elems, size_t nr)
+{
+    uint8_t packed_type = (uint8_t)type;
+    if (put_tag(wr, BIN_PACKED_ARRAY) ||
+            put_bytes(wr, &packed_type, 1) || put_uint(wr, nr))
+        return -1;
+
+#if CPU(LITTLE_ENDIAN)
+    return put_bytes(wr, elems, nr * sizeof(uint64_t));
+#else
+    const uint64_t *u64s = elems;
+    for (size_t i = 0; i < nr; i++) {
+        if (put_u64(wr, u64s[i]))
+            return -1;
+    }
+    return 0;
+#endif
+}
+
+static int
+put_value(struct bin_writer *wr, purc_variant_t value, int level)
+{
+    const char *str;
+    const unsigned char *bytes;
+    size_t len;
+
+    if (level > MAX_EMBEDDED_LEVELS) {
+        purc_set_error(PURC_ERROR_TOO_LARGE_ENTITY);
+        return -1;
+    }
+
+    switch (value->type) {
+    case PURC_VARIANT_TYPE_UNDEFINED:
+        return put_tag(wr, BIN_UNDEFINED);
+
+    case PURC_VARIANT_TYPE_DYNAMIC:
+    case PURC_VARIANT_TYPE_NATIVE:
+        if (wr->strict) {
+            purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+            return -1;
+        }
+        return put_tag(wr, BIN_NULL);
+
+    case PURC_VARIANT_TYPE_NULL:
+        return put_tag(wr, BIN_NULL);
+
+    case PURC_VARIANT_TYPE_BOOLEAN:
+        return put_tag(wr, value->b ? BIN_TRUE : BIN_FALSE);
+
+    case PURC_VARIANT_TYPE_NUMBER:
+    {
+        union { double d; uint64_t u64; } u = { value->d };
+        if (put_tag(wr, BIN_NUMBER))
+            return -1;
+        return put_u64(wr, u.u64);
+    }
+
+    case PURC_VARIANT_TYPE_LONGINT:
+        if (put_tag(wr, BIN_LONGINT))
+            return -1;
+        return put_u64(wr, (uint64_t)value->i64);
+
+    case PURC_VARIANT_TYPE_ULONGINT:
+        if (put_tag(wr, BIN_ULONGINT))
+            return -1;
+        return put_u64(wr, value->u64);
+
+    case PURC_VARIANT_TYPE_LONGDOUBLE:
+    {
+        uint8_t sz = (uint8_t)sizeof(long double);
+        if (put_tag(wr, BIN_LONGDOUBLE) || put_bytes(wr, &sz, 1))
+            return -1;
+        return put_bytes(wr, &value->ld, sizeof(long double));
+    }
+
+    case PURC_VARIANT_TYPE_EXCEPTION:
+        str = purc_variant_get_exception_string_const(value);
+        return put_tagged_string(wr, BIN_EXCEPTION, str, strlen(str));
+
+    case PURC_VARIANT_TYPE_ATOMSTRING:
+        str = purc_variant_get_string_const_ex(value, &len);
+        return put_tagged_string(wr, BIN_ATOMSTRING, str, len);
+
+    case PURC_VARIANT_TYPE_STRING:
+        str = purc_variant_get_string_const_ex(value, &len);
+        return put_tagged_string(wr, BIN_STRING, str, len);
+
+    case PURC_VARIANT_TYPE_BSEQUENCE:
+        bytes = purc_variant_get_bytes_const(value, &len);
+        return put_tagged_bytes(wr, BIN_BSEQUENCE, bytes, len);
+
+    case PURC_VARIANT_TYPE_OBJECT:
+    {
+        purc_variant_t k, v;
+
+        if (put_tag(wr, BIN_OBJECT) ||
+                put_uint(wr, purc_variant_object_get_size(value)))
+            return -1;
+
+        foreach_key_value_in_variant_object(value, k, v)
+            str = purc_variant_get_string_const_ex(k, &len);
+            if (put_string(wr, str, len) || put_value(wr, v, level + 1))
+                return -1;
+        end_foreach;
+        return 0;
+    }
+
+    case PURC_VARIANT_TYPE_ARRAY:
+    {
+        pcvrnt_packed_type_k type;
+        const void *packed = purc_variant_array_get_packed(value, &type, &len);
+        if (packed)
+            return put_packed_array(wr, type, packed, len);
+
+        variant_arr_t data = variant_array_get_data(value);
+        if (put_tag(wr, BIN_ARRAY) || put_uint(wr, data->nr))
+            return -1;
+
+        for (size_t i = 0; i < data->nr; i++) {
+            if (put_value(wr, data->vals[i], level + 1))
+                return -1;
+        }
+        return 0;
+    }
+
+    case PURC_VARIANT_TYPE_SET:
+    {
+        variant_set_t data = pcvar_set_get_data(value);
+        uint8_t flags = data->caseless ? BIN_SET_CASELESS : 0;
+        purc_variant_t v;
+
+        str = data->unique_key ? data->unique_key : "";
+        len = strlen(str);
+        if (put_tag(wr, BIN_SET) || put_bytes(wr, &flags, 1) ||
+                put_uint(wr, len) || put_bytes(wr, str, len) ||
+                put_uint(wr, pcutils_array_list_length(&data->al)))
+            return -1;
+
+        foreach_value_in_variant_set(value, v)
+            if (put_value(wr, v, level + 1))
+                return -1;
+        end_foreach;
+        return 0;
+    }
+
+    case PURC_VARIANT_TYPE_TUPLE:
+    {
+        purc_variant_t *members = tuple_members(value, &len);
+        if (put_tag(wr, BIN_TUPLE) || put_uint(wr, len))
+            return -1;
+
+        for (size_t i = 0; i < len; i++) {
+            if (put_value(wr, members[i], level + 1))
+                return -1;
+        }
+        return 0;
+    }
+
+    default:
+        break;
+    }
+
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return -1;
+}
+
+ssize_t
+purc_variant_serialize_binary(purc_variant_t value, purc_rwstream_t stream)
+{
+    struct bin_writer wr = { stream, 0, false, false };
+
+    if (value == PURC_VARIANT_INVALID || stream == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (put_value(&wr, value, 1))
+        return -1;
+
+    return wr.nr_written;
+}
+
+ssize_t
+pcvariant_serialize_binary_strict(purc_variant_t value, purc_rwstream_t stream)
+{
+    struct bin_writer wr = { stream, 0, false, true };
+
+    if (value == PURC_VARIANT_INVALID || stream == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (put_value(&wr, value, 1))
+        return -1;
+
+    return wr.nr_written;
+}
+
+/* returns the pointer to the next `n` bytes in the memory of a snapshot */
+static const char *
+get_mem(struct bin_reader *rd, size_t n)
+{
+    if (n > rd->left) {
+        purc_set_error(PURC_ERROR_NO_DATA);
+        return NULL;
+    }
+
+    const char *p = rd->mem;
+    rd->mem += n;
+    rd->left -= n;
+    return p;
+}
+
+static int
+get_bytes(struct bin_reader *rd, void *bytes, size_t n)
+{
+    char *p = bytes;
+
+    if (rd->mem) {
+        const char *src = get_mem(rd, n);
+        if (src == NULL)
+            return -1;
+        memcpy(p, src, n);
+        return 0;
+    }
+
+    while (n > 0) {
+        ssize_t r = purc_rwstream_read(rd->rws, p, n);
+        if (r <= 0) {
+            purc_set_error(PURC_ERROR_NO_DATA);
+            return -1;
+        }
+
+        p += r;
+        n -= r;
+    }
+
+    return 0;
+}
+
+static int
+get_uint(struct bin_reader *rd, uint64_t *u64)
+{
+    uint64_t v = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte;
+        if (get_bytes(rd, &byte, 1))
+            return -1;
+
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *u64 = v;
+            return 0;
+        }
+    }
+
+    purc_set_error(PURC_ERROR_INVALID_VALUE);
+    return -1;
+}
+
+static int
+get_size(struct bin_reader *rd, size_t *sz)
+{
+    uint64_t u64;
+    if (get_uint(rd, &u64))
+        return -1;
+
+    if (u64 >= SIZE_MAX) {
+        purc_set_error(PURC_ERROR_TOO_LARGE_ENTITY);
+        return -1;
+    }
+
+    *sz = (size_t)u64;
+    return 0;
+}
+
+static int
+get_u64(struct bin_reader *rd, uint64_t *u64)
+{
+    uint8_t buf[8];
+    if (get_bytes(rd, buf, sizeof(buf)))
+        return -1;
+
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--)
+        v = (v << 8) | buf[i];
+    *u64 = v;
+    return 0;
+}
+
+/* reads `len` bytes and a terminating null byte into a new buffer */
+static char *
+get_string(struct bin_reader *rd, size_t len)
+{
+    char *buf = malloc(len + 1);
+    if (buf == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    if (get_bytes(rd, buf, len)) {
+        free(buf);
+        return NULL;
+    }
+
+    buf[len] = 0;
+    return buf;
+}
+
+/* makes a string variant referring to the bytes in the snapshot */
+static purc_variant_t
+make_snapshot_string(const char *str, size_t len, size_t nr_chars)
+{
+    purc_variant_t v = pcvariant_get(PURC_VARIANT_TYPE_STRING);
+    if (v == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    v->type = PURC_VARIANT_TYPE_STRING;
+    v->flags = PCVRNT_FLAG_STRING_STATIC;
+    v->refc = 1;
+    v->extra_size = nr_chars;
+    v->sz_ptr[0] = (uintptr_t)len + 1;
+    v->sz_ptr[1] = (uintptr_t)str;
+    return v;
+}
+
+static purc_variant_t
+get_string_value(struct bin_reader *rd, uint8_t tag)
+{
+    purc_variant_t v = PURC_VARIANT_INVALID;
+    char stack_buf[SZ_STACK_STRING];
+    char *buf;
+    size_t len;
+
+    if (get_size(rd, &len))
+        return PURC_VARIANT_INVALID;
+
+    if (rd->mem) {
+        size_t nr_chars;
+        const char *str;
+
+        if (get_size(rd, &nr_chars) || len == SIZE_MAX ||
+                (str = get_mem(rd, len + 1)) == NULL)
+            return PURC_VARIANT_INVALID;
+
+        if (str[len] != 0 || memchr(str, 0, len) != NULL) {
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            return PURC_VARIANT_INVALID;
+        }
+
+        switch (tag) {
+        case BIN_EXCEPTION:
+        {
+            purc_atom_t atom = purc_atom_try_string_ex(ATOM_BUCKET_EXCEPT,
+                    str);
+            if (atom)
+                return purc_variant_make_exception(atom);
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            return PURC_VARIANT_INVALID;
+        }
+
+        case BIN_ATOMSTRING:
+            return purc_variant_make_atom_string(str, false);
+
+        default:
+            return make_snapshot_string(str, len, nr_chars);
+        }
+    }
+
+    if (len < sizeof(stack_buf)) {
+        if (get_bytes(rd, stack_buf, len))
+            return PURC_VARIANT_INVALID;
+        stack_buf[len] = 0;
+        buf = stack_buf;
+    }
+    else if ((buf = get_string(rd, len)) == NULL) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    switch (tag) {
+    case BIN_EXCEPTION:
+    {
+        purc_atom_t atom = purc_atom_try_string_ex(ATOM_BUCKET_EXCEPT, buf);
+        if (atom)
+            v = purc_variant_make_exception(atom);
+        else
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+        break;
+    }
+
+    case BIN_ATOMSTRING:
+        v = purc_variant_make_atom_string(buf, false);
+        break;
+
+    case BIN_STRING:
+        if (buf == stack_buf) {
+            v = purc_variant_make_string_ex(buf, len, false);
+        }
+        else {
+            v = purc_variant_make_string_reuse_buff(buf, len + 1, false);
+            if (v)
+                buf = stack_buf;    /* taken by the variant */
+        }
+        break;
+
+    default:
+        PC_ASSERT(0);
+        break;
+    }
+
+    if (buf != stack_buf)
+        free(buf);
+    return v;
+}
+
+static purc_variant_t
+get_bsequence(struct bin_reader *rd)
+{
+    size_t len;
+    if (get_size(rd, &len))
+        return PURC_VARIANT_INVALID;
+
+    if (len == 0)
+        return purc_variant_make_byte_sequence_empty();
+
+    if (rd->mem) {
+        const char *bytes = get_mem(rd, len);
+        if (bytes == NULL)
+            return PURC_VARIANT_INVALID;
+        return purc_variant_make_byte_sequence_static(bytes, len);
+    }
+
+    void *bytes = malloc(len);
+    if (bytes == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (get_bytes(rd, bytes, len)) {
+        free(bytes);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t v = purc_variant_make_byte_sequence_reuse_buff(bytes,
+            len, len);
+    if (v == PURC_VARIANT_INVALID)
+        free(bytes);
+    return v;
+}
+
+static purc_variant_t
+get_value(struct bin_reader *rd, int level);
+
+/* reads `nr` values into a new C array */
+static purc_variant_t *
+get_members(struct bin_reader *rd, size_t nr, int level)
+{
+    purc_variant_t *members = NULL;
+    size_t i, sz = 0;
+
+    for (i = 0; i < nr; i++) {
+        if (i == sz) {
+            /* do not trust the count before the members are read */
+            size_t new_sz = sz ? sz * 2 : 16;
+            if (new_sz > nr)
+                new_sz = nr;
+
+            purc_variant_t *p = realloc(members, sizeof(*p) * new_sz);
+            if (p == NULL) {
+                purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+                break;
+            }
+            members = p;
+            sz = new_sz;
+        }
+
+        members[i] = get_value(rd, level + 1);
+        if (members[i] == PURC_VARIANT_INVALID)
+            break;
+    }
+
+    if (i < nr) {
+        while (i > 0)
+            purc_variant_unref(members[--i]);
+        free(members);
+        return NULL;
+    }
+
+    if (members == NULL) {
+        /* no member at all */
+        members = malloc(sizeof(*members));
+        if (members == NULL)
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    }
+
+    return members;
+}
+
+static void
+release_members(purc_variant_t *members, size_t nr)
+{
+    for (size_t i = 0; i < nr; i++)
+        purc_variant_unref(members[i]);
+    free(members);
+}
+
+static purc_variant_t
+get_object(struct bin_reader *rd, int level)
+{
+    size_t nr;
+    if (get_size(rd, &nr))
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t k, v;
+
+        k = get_string_value(rd, BIN_STRING);
+        if (k == PURC_VARIANT_INVALID)
+            goto failed;
+
+        v = get_value(rd, level + 1);
+        if (v == PURC_VARIANT_INVALID) {
+            purc_variant_unref(k);
+            goto failed;
+        }
+
+        bool ok = purc_variant_object_set(obj, k, v);
+        purc_variant_unref(k);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
+    }
+
+    return obj;
+
+failed:
+    purc_variant_unref(obj);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+get_array(struct bin_reader *rd, int level)
+{
+    size_t nr;
+    if (get_size(rd, &nr))
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    if (arr == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = get_value(rd, level + 1);
+        if (v == PURC_VARIANT_INVALID)
+            goto failed;
+
+        bool ok = purc_variant_array_append(arr, v);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
+    }
+
+    return arr;
+
+failed:
+    purc_variant_unref(arr);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+get_packed_array(struct bin_reader *rd)
+{
+    uint8_t type;
+    size_t nr;
+
+    if (get_bytes(rd, &type, 1) || get_size(rd, &nr))
+        return PURC_VARIANT_INVALID;
+
+    if (type != PCVRNT_PACKED_NUMBER && type != PCVRNT_PACKED_LONGINT &&
+            type != PCVRNT_PACKED_ULONGINT) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (nr > SIZE_MAX / sizeof(uint64_t)) {
+        purc_set_error(PURC_ERROR_TOO_LARGE_ENTITY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    uint64_t *elems = malloc(nr ? nr * sizeof(uint64_t) : 1);
+    if (elems == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t v = PURC_VARIANT_INVALID;
+#if CPU(LITTLE_ENDIAN)
+    if (get_bytes(rd, elems, nr * sizeof(uint64_t)))
+        goto done;
+#else
+    for (size_t i = 0; i < nr; i++) {
+        if (get_u64(rd, elems + i))
+            goto done;
+    }
+#endif
+
+    v = purc_variant_make_packed_array((pcvrnt_packed_type_k)type, elems, nr);
+
+done:
+    free(elems);
+    return v;
+}
+
+static purc_variant_t
+get_set(struct bin_reader *rd, int level)
+{
+    purc_variant_t set = PURC_VARIANT_INVALID;
+    char *unique_key = NULL;
+    uint8_t flags;
+    size_t len, nr;
+
+    if (get_bytes(rd, &flags, 1) || get_size(rd, &len))
+        return PURC_VARIANT_INVALID;
+
+    if (len > 0 && (unique_key = get_string(rd, len)) == NULL)
+        return PURC_VARIANT_INVALID;
+
+    if (get_size(rd, &nr) == 0) {
+        purc_variant_t *members = get_members(rd, nr, level);
+        if (members) {
+            set = purc_variant_make_set_by_members(nr, unique_key,
+                    flags & BIN_SET_CASELESS, members);
+            release_members(members, nr);
+        }
+    }
+
+    free(unique_key);
+    return set;
+}
+
+static purc_variant_t
+get_tuple(struct bin_reader *rd, int level)
+{
+    size_t nr;
+    if (get_size(rd, &nr))
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t *members = get_members(rd, nr, level);
+    if (members == NULL)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t tuple = purc_variant_make_tuple(nr, members);
+    release_members(members, nr);
+    return tuple;
+}
+
+static purc_variant_t
+get_value(struct bin_reader *rd, int level)
+{
+    uint8_t tag;
+    uint64_t u64;
+
+    if (level > MAX_EMBEDDED_LEVELS) {
+        purc_set_error(PURC_ERROR_TOO_LARGE_ENTITY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (get_bytes(rd, &tag, 1))
+        return PURC_VARIANT_INVALID;
+
+    switch (tag) {
+    case BIN_UNDEFINED:
+        return purc_variant_make_undefined();
+
+    case BIN_NULL:
+        return purc_variant_make_null();
+
+    case BIN_FALSE:
+    case BIN_TRUE:
+        return purc_variant_make_boolean(tag == BIN_TRUE);
+
+    case BIN_NUMBER:
+    {
+        if (get_u64(rd, &u64))
+            return PURC_VARIANT_INVALID;
+
+        union { uint64_t u64; double d; } u = { u64 };
+        return purc_variant_make_number(u.d);
+    }
+
+    case BIN_LONGINT:
+        if (get_u64(rd, &u64))
+            return PURC_VARIANT_INVALID;
+        return purc_variant_make_longint((int64_t)u64);
+
+    case BIN_ULONGINT:
+        if (get_u64(rd, &u64))
+            return PURC_VARIANT_INVALID;
+        return purc_variant_make_ulongint(u64);
+
+    case BIN_LONGDOUBLE:
+    {
+        uint8_t sz;
+        long double ld;
+
+        if (get_bytes(rd, &sz, 1))
+            return PURC_VARIANT_INVALID;
+
+        if (sz != sizeof(long double)) {
+            purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+            return PURC_VARIANT_INVALID;
+        }
+
+        if (get_bytes(rd, &ld, sizeof(ld)))
+            return PURC_VARIANT_INVALID;
+        return purc_variant_make_longdouble(ld);
+    }
+
+    case BIN_EXCEPTION:
+    case BIN_ATOMSTRING:
+    case BIN_STRING:
+        return get_string_value(rd, tag);
+
+    case BIN_BSEQUENCE:
+        return get_bsequence(rd);
+
+    case BIN_OBJECT:
+        return get_object(rd, level);
+
+    case BIN_ARRAY:
+        return get_array(rd, level);
+
+    case BIN_PACKED_ARRAY:
+        return get_packed_array(rd);
+
+    case BIN_SET:
+        return get_set(rd, level);
+
+    case BIN_TUPLE:
+        return get_tuple(rd, level);
+
+    default:
+        break;
+    }
+
+    purc_set_error(PURC_ERROR_INVALID_VALUE);
+    return PURC_VARIANT_INVALID;
+}
+
+purc_variant_t
+purc_variant_load_from_binary(purc_rwstream_t stream)
+{
+    if (stream == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct bin_reader rd = { stream, NULL, 0 };
+    return get_value(&rd, 1);
+}
+
+ssize_t
+purc_variant_serialize_snapshot(purc_variant_t value, purc_rwstream_t stream)
+{
+    struct bin_writer wr = { stream, 0, true, false };
+    uint8_t version = SNAPSHOT_VERSION;
+
+    if (value == PURC_VARIANT_INVALID || stream == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (put_bytes(&wr, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC) - 1) ||
+            put_bytes(&wr, &version, 1) || put_value(&wr, value, 1))
+        return -1;
+
+    return wr.nr_written;
+}
+
+/*
+ * The variants loaded from a snapshot refer to the memory of the snapshot,
+ * and they may be moved to other instances. Therefore, a snapshot is kept
+ * mapped until the process exits, and a snapshot file which has not been
+ * changed is mapped only once in a process, so the instances share the
+ * same memory, which is also shared by the processes via the page cache.
+ */
+struct snapshot {
+    struct snapshot    *next;
+    dev_t               dev;
+    ino_t               ino;
+    off_t               size;
+    time_t              mtime;
+
+    void               *mem;
+    bool                mapped;
+};
+
+static purc_mutex       snapshots_lock;
+static struct snapshot *snapshots;
+
+static void snapshot_cleanup_once(void)
+{
+    struct snapshot *snap, *next;
+    for (snap = snapshots; snap; snap = next) {
+        next = snap->next;
+#if HAVE(MMAP)
+        if (snap->mapped)
+            munmap(snap->mem, snap->size);
+        else
+#endif
+            free(snap->mem);
+        free(snap);
+    }
+    snapshots = NULL;
+
+    if (snapshots_lock.native_impl)
+        purc_mutex_clear(&snapshots_lock);
+}
+
+int pcvariant_snapshot_init_once(void)
+{
+    purc_mutex_init(&snapshots_lock);
+    if (snapshots_lock.native_impl == NULL)
+        return -1;
+    purc_mutex_set_name(&snapshots_lock, "binary-snapshots");
+
+    if (atexit(snapshot_cleanup_once)) {
+        purc_mutex_clear(&snapshots_lock);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void *read_whole_file(int fd, size_t size)
+{
+    char *buf = malloc(size);
+    if (buf == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    size_t pos = 0;
+    while (pos < size) {
+        ssize_t n = read(fd, buf + pos, size - pos);
+        if (n <= 0) {
+            free(buf);
+            purc_set_error(PURC_ERROR_IO_FAILURE);
+            return NULL;
+        }
+        pos += n;
+    }
+
+    return buf;
+}
+
+static struct snapshot *open_snapshot(const char *file)
+{
+    struct snapshot *snap = NULL;
+    struct stat st;
+
+    int fd = open(file, O_RDONLY);
+    if (fd < 0) {
+        purc_set_error(purc_error_from_errno(errno));
+        return NULL;
+    }
+
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+        purc_set_error(PURC_ERROR_IO_FAILURE);
+        goto done;
+    }
+
+    if ((size_t)st.st_size <= SZ_SNAPSHOT_HEADER) {
+        purc_set_error(PURC_ERROR_NO_DATA);
+        goto done;
+    }
+
+    purc_mutex_lock(&snapshots_lock);
+    for (snap = snapshots; snap; snap = snap->next) {
+        if (snap->dev == st.st_dev && snap->ino == st.st_ino &&
+                snap->size == st.st_size &&
+                snap->mtime == st.st_mtime)
+            break;
+    }
+
+    if (snap == NULL && (snap = calloc(1, sizeof(*snap)))) {
+#if HAVE(MMAP)
+        snap->mem = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (snap->mem == MAP_FAILED)
+            snap->mem = NULL;
+        else
+            snap->mapped = true;
+#endif
+        if (snap->mem == NULL)
+            snap->mem = read_whole_file(fd, st.st_size);
+
+        if (snap->mem) {
+            snap->dev = st.st_dev;
+            snap->ino = st.st_ino;
+            snap->size = st.st_size;
+            snap->mtime = st.st_mtime;
+            snap->next = snapshots;
+            snapshots = snap;
+        }
+        else {
+            free(snap);
+            snap = NULL;
+        }
+    }
+    else if (snap == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    }
+    purc_mutex_unlock(&snapshots_lock);
+
+done:
+    close(fd);
+    return snap;
+}
+
+purc_variant_t
+purc_variant_load_snapshot(const char *file)
+{
+    if (file == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct snapshot *snap = open_snapshot(file);
+    if (snap == NULL)
+        return PURC_VARIANT_INVALID;
+
+    const char *mem = snap->mem;
+    if (memcmp(mem, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC) - 1) ||
+            mem[sizeof(SNAPSHOT_MAGIC) - 1] != SNAPSHOT_VERSION) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct bin_reader rd = { NULL, mem + SZ_SNAPSHOT_HEADER,
+        snap->size - SZ_SNAPSHOT_HEADER };
+    return get_value(&rd, 1);
+}
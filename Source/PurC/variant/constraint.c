@@ -25,6 +25,7 @@
 #include "purc-errors.h"
 #include "private/debug.h"
 #include "private/errors.h"
+#include "private/instance.h"
 #include "variant-internals.h"
 
 #include <stdlib.h>
@@ -70,12 +71,45 @@ comp(const void *key1, const void *key2)
     return k1 - k2;
 }
 
+/* unlike comp(), the pointers are not truncated */
+static int
+node_comp(const void *key1, const void *key2)
+{
+    uintptr_t k1 = (uintptr_t)key1;
+    uintptr_t k2 = (uintptr_t)key2;
+
+    return (k1 > k2) - (k1 < k2);
+}
+
+struct reverse_checker;
+
+typedef int (*on_member_fn)(struct reverse_checker *checker,
+        purc_variant_t set, struct set_node *node);
+
 struct reverse_checker {
     pcutils_map           *input;     // key/val: variant old /variant new
     pcutils_map           *cache;     // as above
     pcutils_map           *output;    // as above
+
+    // called on the member of a set when winding up
+    on_member_fn           on_member;
+    pcutils_map           *nodes;     // key/val: set_node / set
 };
 
+static inline struct pcvariant_heap *
+current_heap(void)
+{
+    struct pcinst *inst = pcinst_current();
+    return inst ? inst->variant_heap : NULL;
+}
+
+static inline bool
+revalidation_deferred(void)
+{
+    struct pcvariant_heap *heap = current_heap();
+    return heap && heap->defer_depth > 0;
+}
+
 static purc_variant_t
 rebuild_ex(purc_variant_t val, pcutils_map *cache);
 
@@ -397,6 +431,10 @@ unref(void *v)
 int
 pcvar_reverse_check(purc_variant_t _old, purc_variant_t _new)
 {
+    /* the sets will be checked when the deferred revalidation ends */
+    if (revalidation_deferred())
+        return 0;
+
     copy_key_fn copy_key = ref;
     free_key_fn free_key = unref;
     copy_val_fn copy_val = ref;
@@ -496,7 +534,7 @@ wind_up_val(purc_variant_t val, struct reverse_checker *checker)
         if (purc_variant_is_set(parent)) {
             struct set_node *node;
             node = (struct set_node*)entry->key;
-            r = pcvar_readjust_set(parent, node);
+            r = checker->on_member(checker, parent, node);
         }
         else {
             r = pcutils_map_replace_or_insert(checker->output,
@@ -540,8 +578,61 @@ wind_up(struct reverse_checker *checker)
     return r ? -1 : 0;
 }
 
-void
-pcvar_adjust_set_by_descendant(purc_variant_t val)
+static int
+readjust_member(struct reverse_checker *checker,
+        purc_variant_t set, struct set_node *node)
+{
+    UNUSED_PARAM(checker);
+    return pcvar_readjust_set(set, node);
+}
+
+static int
+mark_member(struct reverse_checker *checker,
+        purc_variant_t set, struct set_node *node)
+{
+    UNUSED_PARAM(checker);
+    UNUSED_PARAM(node);
+    pcvar_set_mark_deferred(set);
+    return 0;
+}
+
+static int
+collect_member(struct reverse_checker *checker,
+        purc_variant_t set, struct set_node *node)
+{
+    return pcutils_map_replace_or_insert(checker->nodes, node, set, NULL);
+}
+
+/* winds up from the values in the input of the checker to the sets */
+static int
+wind_up_all(struct reverse_checker *checker)
+{
+    int r = 0;
+
+    while (1) {
+        r = wind_up(checker);
+        if (r)
+            break;
+
+        // sanity check
+        size_t nr = pcutils_map_get_size(checker->input);
+        PC_ASSERT(nr == 0);
+
+        nr = pcutils_map_get_size(checker->output);
+        if (nr == 0)
+            break;
+
+        struct pcutils_map *tmp;
+        tmp = checker->input;
+        checker->input = checker->output;
+        checker->output = tmp;
+    }
+
+    return r;
+}
+
+static int
+wind_up_val_by(purc_variant_t val, on_member_fn on_member)
 {
     copy_key_fn copy_key = ref;
     free_key_fn free_key = unref;
@@ -549,7 +640,7 @@ pcvar_adjust_set_by_descendant(purc_variant_t val)
     free_val_fn free_val = unref;
     comp_key_fn comp_key = comp;
 
-    struct reverse_checker checker = {};
+    struct reverse_checker checker = { .on_member = on_member };
 
     bool threads = false;
     checker.input = pcutils_map_create(copy_key, free_key,
@@ -568,31 +659,173 @@ pcvar_adjust_set_by_descendant(purc_variant_t val)
         if (r)
             break;
 
-        while (1) {
-            r = wind_up(&checker);
-            if (r)
-                break;
+        r = wind_up_all(&checker);
+    } while (0);
 
-            // sanity check
-            size_t nr = pcutils_map_get_size(checker.input);
-            PC_ASSERT(nr == 0);
+    if (checker.output)
+        pcutils_map_destroy(checker.output);
+    if (checker.input)
+        pcutils_map_destroy(checker.input);
 
-            nr = pcutils_map_get_size(checker.output);
-            if (nr == 0)
-                break;
+    return r;
+}
+
+static int
+defer_adjusting(struct pcvariant_heap *heap, purc_variant_t val)
+{
+    if (heap->deferred == NULL) {
+        heap->deferred = pcutils_map_create(ref, unref, ref, unref,
+                comp, false);
+        if (heap->deferred == NULL)
+            return -1;
+    }
+
+    if (pcutils_map_replace_or_insert(heap->deferred, val, val, NULL))
+        return -1;
+
+    /* mark the sets so that they are revalidated before being looked up */
+    return wind_up_val_by(val, mark_member);
+}
+
+void
+pcvar_adjust_set_by_descendant(purc_variant_t val)
+{
+    /* fast path: nothing to adjust if the container is not in any set */
+    if (!pcvar_container_belongs_to_set(val))
+        return;
+
+    struct pcvariant_heap *heap = current_heap();
+    if (heap && heap->defer_depth > 0 && defer_adjusting(heap, val) == 0)
+        return;
+
+    int r = wind_up_val_by(val, readjust_member);
+    PC_ASSERT(r == 0);
+}
+
+/*
+ * Repositions the members of the sets mutated while the revalidation was
+ * deferred. All the members are unlinked from the sets first, so that the
+ * ones linked again are checked against the others in the correct order.
+ * A member conflicting with another one by the unique key is removed from
+ * the set, and -1 is returned.
+ */
+static int
+revalidate(pcutils_map *vals)
+{
+    struct reverse_checker checker = { .on_member = collect_member };
+
+    bool threads = false;
+    checker.input = vals;
+    checker.output = pcutils_map_create(ref, unref, ref, unref,
+            comp, threads);
+    checker.nodes = pcutils_map_create(NULL, NULL, ref, unref,
+            node_comp, threads);
+    pcutils_map *conflicts = pcutils_map_create(NULL, NULL, ref, unref,
+            node_comp, threads);
+
+    int r = -1;
+    do {
+        if (checker.output == NULL || checker.nodes == NULL ||
+                conflicts == NULL)
+            break;
+
+        r = wind_up_all(&checker);
+        if (r)
+            break;
+
+        struct pcutils_map_entry *entry;
+        struct pcutils_map_iterator it;
+
+        it = pcutils_map_it_begin_first(checker.nodes);
+        while ((entry = pcutils_map_it_value(&it))) {
+            pcvar_set_unlink_member((purc_variant_t)entry->val,
+                    (struct set_node *)entry->key);
+            pcutils_map_it_next(&it);
+        }
+        pcutils_map_it_end(&it);
+
+        it = pcutils_map_it_begin_first(checker.nodes);
+        while ((entry = pcutils_map_it_value(&it))) {
+            if (pcvar_set_relink_member((purc_variant_t)entry->val,
+                        (struct set_node *)entry->key)) {
+                r = pcutils_map_insert(conflicts, entry->key, entry->val);
+                if (r)
+                    break;
+            }
+            pcutils_map_it_next(&it);
+        }
+        pcutils_map_it_end(&it);
+        if (r)
+            break;
 
-            struct pcutils_map *tmp;
-            tmp = checker.input;
-            checker.input = checker.output;
-            checker.output = tmp;
+        it = pcutils_map_it_begin_first(conflicts);
+        while ((entry = pcutils_map_it_value(&it))) {
+            pcvar_set_drop_member((purc_variant_t)entry->val,
+                    (struct set_node *)entry->key);
+            pcutils_map_it_next(&it);
         }
+        pcutils_map_it_end(&it);
+
+        if (pcutils_map_get_size(conflicts) > 0)
+            r = -1;
     } while (0);
 
+    if (conflicts)
+        pcutils_map_destroy(conflicts);
+    if (checker.nodes)
+        pcutils_map_destroy(checker.nodes);
     if (checker.output)
         pcutils_map_destroy(checker.output);
-    if (checker.input)
-        pcutils_map_destroy(checker.input);
+    pcutils_map_destroy(checker.input);
 
-    PC_ASSERT(r == 0);
+    return r ? -1 : 0;
+}
+
+void
+pcvar_revalidate_deferred(void)
+{
+    struct pcvariant_heap *heap = current_heap();
+    if (heap == NULL || heap->deferred == NULL)
+        return;
+
+    /* NOTE: the mutations made meanwhile, e.g., removing a conflicting
+       member, are adjusted immediately. */
+    pcutils_map *vals = heap->deferred;
+    int depth = heap->defer_depth;
+    heap->deferred = NULL;
+    heap->defer_depth = 0;
+
+    if (revalidate(vals))
+        heap->defer_conflict = true;
+
+    heap->defer_depth = depth;
 }
 
+void
+pcvariant_begin_deferred_revalidation(void)
+{
+    struct pcvariant_heap *heap = current_heap();
+    if (heap)
+        heap->defer_depth++;
+}
+
+int
+pcvariant_end_deferred_revalidation(void)
+{
+    struct pcvariant_heap *heap = current_heap();
+    if (heap == NULL)
+        return 0;
+
+    PC_ASSERT(heap->defer_depth > 0);
+    if (--heap->defer_depth > 0)
+        return 0;
+
+    pcvar_revalidate_deferred();
+    if (heap->defer_conflict) {
+        heap->defer_conflict = false;
+        purc_set_error(PURC_ERROR_DUPLICATED);
+        return -1;
+    }
+
+    return 0;
+}
@@ -66,6 +66,8 @@ static void mvheap_cleanup_once(void)
 
     PC_ASSERT(stat->nr_total_values == 4);
     PC_ASSERT(stat->sz_total_mem == 4 * sizeof(purc_variant));
+
+    pcvariant_slab_detach(&move_heap);
 }
 
 static int mvheap_init_once(void)
@@ -108,9 +110,13 @@ static int mvheap_init_once(void)
     INIT_LIST_HEAD(&move_heap.v_reserved);
 #endif
 
+    if (pcvariant_slab_attach(&move_heap))
+        return -1;
+
     purc_mutex_init(&mh_lock);
     if (mh_lock.native_impl == NULL)
-        return -1;
+        goto fail_mutex;
+    purc_mutex_set_name(&mh_lock, "move-heap");
 
     int r;
     r = atexit(mvheap_cleanup_once);
@@ -122,6 +128,8 @@ static int mvheap_init_once(void)
 fail_atexit:
     purc_mutex_clear(&mh_lock);
 
+fail_mutex:
+    pcvariant_slab_detach(&move_heap);
     return -1;
 }
 
@@ -133,107 +141,199 @@ struct pcmodule _module_mvheap = {
     .init_instance   = NULL,
 };
 
+/*
+ * A variant is moved by relinking it rather than copying it if it is owned
+ * by the moving one only. Therefore, moving a variant does not touch the move
+ * heap in most cases except for the statistics and the reference counts of
+ * the constants. They are collected in the travel context, and applied to
+ * the move heap at once when the moving is done, so the global lock is only
+ * held for a short time, unless some variants have to be cloned in the move
+ * heap; in this case, the move heap is locked when the first clone is made.
+ */
+struct travel_context {
+    struct pcinst *inst;
+    struct pcutils_arrlist *vrts_to_unref;
+
+    /* the changes of the statistics of the move heap (in modular sums) */
+    struct purc_variant_stat delta;
+
+    /* the changes of the reference counts of the constants */
+    unsigned int refc_undefined;
+    unsigned int refc_null;
+    unsigned int refc_false;
+    unsigned int refc_true;
+
+    /* true if the move heap is locked and used as the current heap */
+    bool heap_locked;
+};
+
+static inline void
+travel_context_init(struct travel_context *ctxt)
+{
+    memset(ctxt, 0, sizeof(*ctxt));
+    ctxt->inst = pcinst_current();
+}
+
+/* locks and uses the move heap in order to make a clone in it */
+static inline void
+use_move_heap(struct travel_context *ctxt)
+{
+    if (!ctxt->heap_locked) {
+        pcvariant_use_move_heap();
+        ctxt->heap_locked = true;
+    }
+}
+
+/* applies the changes to the move heap, and uses the normal heap again */
+static void
+apply_changes(struct travel_context *ctxt)
+{
+    if (!ctxt->heap_locked)
+        purc_mutex_lock(&mh_lock);
+
+    struct purc_variant_stat *stat = &move_heap.stat;
+    for (int t = PURC_VARIANT_TYPE_FIRST; t < PURC_VARIANT_TYPE_LAST; t++) {
+        stat->nr_values[t] += ctxt->delta.nr_values[t];
+        stat->sz_mem[t] += ctxt->delta.sz_mem[t];
+    }
+    stat->nr_total_values += ctxt->delta.nr_total_values;
+    stat->sz_total_mem += ctxt->delta.sz_total_mem;
+
+    move_heap.v_undefined.refc += ctxt->refc_undefined;
+    move_heap.v_null.refc += ctxt->refc_null;
+    move_heap.v_false.refc += ctxt->refc_false;
+    move_heap.v_true.refc += ctxt->refc_true;
+
+    if (ctxt->heap_locked) {
+        pcvariant_use_norm_heap();
+        ctxt->heap_locked = false;
+    }
+    else {
+        purc_mutex_unlock(&mh_lock);
+    }
+}
+
+/* a packed array has no descendant variant, so it is moved as a whole */
+static inline bool
+is_packed_array(purc_variant_t arr)
+{
+    return pcvar_arr_get_data(arr)->packed != NULL;
+}
+
 static void
-move_variant_in(struct pcinst *inst, purc_variant_t v)
+move_variant_in(struct travel_context *ctxt, purc_variant_t v)
 {
     /* move directly and change the stat info */
+    struct pcvariant_heap *heap = ctxt->inst->org_vrt_heap;
 
     if (IS_CONTAINER(v->type) ||
             ((v->type == PURC_VARIANT_TYPE_STRING ||
                 v->type == PURC_VARIANT_TYPE_BSEQUENCE) &&
             (v->flags & PCVRNT_FLAG_EXTRA_SIZE))) {
-        inst->org_vrt_heap->stat.sz_mem[v->type] -= v->sz_ptr[0];
-        inst->org_vrt_heap->stat.sz_total_mem -= v->sz_ptr[0];
+        heap->stat.sz_mem[v->type] -= v->sz_ptr[0];
+        heap->stat.sz_total_mem -= v->sz_ptr[0];
 
-        move_heap.stat.sz_mem[v->type] += v->sz_ptr[0];
-        move_heap.stat.sz_total_mem += v->sz_ptr[0];
+        ctxt->delta.sz_mem[v->type] += v->sz_ptr[0];
+        ctxt->delta.sz_total_mem += v->sz_ptr[0];
     }
 
-    inst->org_vrt_heap->stat.nr_values[v->type]--;
-    inst->org_vrt_heap->stat.nr_total_values--;
-    move_heap.stat.nr_values[v->type]++;
-    move_heap.stat.nr_total_values++;
+    heap->stat.nr_values[v->type]--;
+    heap->stat.nr_total_values--;
+    ctxt->delta.nr_values[v->type]++;
+    ctxt->delta.nr_total_values++;
 
-    inst->org_vrt_heap->stat.sz_mem[v->type] -= sizeof(purc_variant);
-    inst->org_vrt_heap->stat.sz_total_mem -= sizeof(purc_variant);
-    move_heap.stat.sz_mem[v->type] += sizeof(purc_variant);
-    move_heap.stat.sz_total_mem += sizeof(purc_variant);
+    heap->stat.sz_mem[v->type] -= sizeof(purc_variant);
+    heap->stat.sz_total_mem -= sizeof(purc_variant);
+    ctxt->delta.sz_mem[v->type] += sizeof(purc_variant);
+    ctxt->delta.sz_total_mem += sizeof(purc_variant);
 }
 
 static purc_variant_t
-move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
+move_or_clone_immutable(struct travel_context *ctxt, purc_variant_t v)
 {
     purc_variant_t retv = PURC_VARIANT_INVALID;
+    struct pcvariant_heap *heap = ctxt->inst->org_vrt_heap;
 
     if (IS_CONTAINER(v->type))
         return retv;
 
-    if (v == &inst->org_vrt_heap->v_undefined) {
+    if (v == &heap->v_undefined) {
         retv = &move_heap.v_undefined;
         v->refc--;
-        retv->refc++;
+        ctxt->refc_undefined++;
     }
-    else if (v == &inst->org_vrt_heap->v_null) {
+    else if (v == &heap->v_null) {
         retv = &move_heap.v_null;
         v->refc--;
-        retv->refc++;
+        ctxt->refc_null++;
     }
-    else if (v == &inst->org_vrt_heap->v_false) {
+    else if (v == &heap->v_false) {
         retv = &move_heap.v_false;
         v->refc--;
-        retv->refc++;
+        ctxt->refc_false++;
     }
-    else if (v == &inst->org_vrt_heap->v_true) {
+    else if (v == &heap->v_true) {
         retv = &move_heap.v_true;
         v->refc--;
-        retv->refc++;
+        ctxt->refc_true++;
     }
-    else if (v->refc == 1) {
-        PC_DEBUG("Move in variant type %s (%u): %s\n",
+    else if (v->refc == 1 &&
+            !(v->flags & (PCVRNT_FLAG_NOFREE | PCVRNT_FLAG_STRING_VIEW))) {
+        PC_DEBUG("Move in variant type %s: %s\n",
                 purc_variant_typename(v->type),
-                (unsigned)move_heap.stat.nr_values[v->type],
                 purc_variant_is_string(v) ? purc_variant_get_string_const(v): NULL);
 
         retv = v;
-        move_variant_in(inst, v);
+        move_variant_in(ctxt, v);
     }
     else {
         // clone the immutable variant
-        PC_DEBUG("Clone a variant type %s (%u): %s\n",
+        PC_DEBUG("Clone a variant type %s: %s\n",
                 purc_variant_typename(v->type),
-                (unsigned)move_heap.stat.nr_values[v->type],
                 purc_variant_is_string(v) ? purc_variant_get_string_const(v): NULL);
 
+        use_move_heap(ctxt);
         retv = pcvariant_alloc();
         memcpy(retv, v, sizeof(*retv));
         retv->refc = 1;
+        /* the extra space of the clone is always allocated separately */
+        retv->flags &= ~PCVRNT_FLAG_TRAILING;
+
+        /* an interned string is owned by the heap; the clone is not */
+        if (v->flags & PCVRNT_FLAG_NOFREE) {
+            retv->flags &= ~PCVRNT_FLAG_NOFREE;
+            v->refc--;
+        }
+
+        /* the owner of a string view lives in the original heap,
+           so the clone holds a copy of the string instead */
+        if (v->flags & PCVRNT_FLAG_STRING_VIEW) {
+            retv->flags &= ~(PCVRNT_FLAG_STRING_STATIC |
+                    PCVRNT_FLAG_STRING_VIEW);
+            retv->flags |= PCVRNT_FLAG_EXTRA_SIZE;
+        }
 
         /* copy the extra space */
         if ((v->type == PURC_VARIANT_TYPE_STRING ||
                 v->type == PURC_VARIANT_TYPE_BSEQUENCE) &&
-                (v->flags & PCVRNT_FLAG_EXTRA_SIZE)) {
+                (retv->flags & PCVRNT_FLAG_EXTRA_SIZE)) {
 
             retv->sz_ptr[1] = (uintptr_t)malloc(v->sz_ptr[0]);
             memcpy((void *)retv->sz_ptr[1], (void *)v->sz_ptr[1], v->sz_ptr[0]);
 
-            move_heap.stat.sz_mem[v->type] += v->sz_ptr[0];
-            move_heap.stat.sz_total_mem += v->sz_ptr[0];
+            ctxt->delta.sz_mem[v->type] += v->sz_ptr[0];
+            ctxt->delta.sz_total_mem += v->sz_ptr[0];
         }
 
-        move_heap.stat.nr_values[v->type]++;
-        move_heap.stat.nr_total_values++;
-        move_heap.stat.sz_mem[v->type] += sizeof(purc_variant);
-        move_heap.stat.sz_total_mem += sizeof(purc_variant);
+        ctxt->delta.nr_values[v->type]++;
+        ctxt->delta.nr_total_values++;
+        ctxt->delta.sz_mem[v->type] += sizeof(purc_variant);
+        ctxt->delta.sz_total_mem += sizeof(purc_variant);
     }
 
     return retv;
 }
 
-struct travel_context {
-    struct pcinst *inst;
-    struct pcutils_arrlist *vrts_to_unref;
-};
-
 static bool
 move_keys_in_cloned_array(struct travel_context *ctxt, purc_variant_t arr);
 static bool
@@ -246,6 +346,13 @@ move_keys_in_cloned_tuple(struct travel_context *ctxt, purc_variant_t arr);
 static bool
 move_keys_in_cloned_array(struct travel_context *ctxt, purc_variant_t arr)
 {
+    if (is_packed_array(arr))
+        return true;
+
+    /* the elements shared with another array can not be moved */
+    if (pcvariant_array_writable_data(arr) == NULL)
+        return false;
+
     size_t idx;
     purc_variant_t v;
     foreach_value_in_variant_array(arr, v, idx) {
@@ -285,30 +392,35 @@ move_keys_in_cloned_object(struct travel_context *ctxt, purc_variant_t obj)
     foreach_key_value_in_variant_object(obj, k, v) {
 
         if (IS_CONTAINER(v->type)) {
-            PC_DEBUG("Move in a key %s (%u): %s\n",
+            PC_DEBUG("Move in a key %s: %s\n",
                     purc_variant_typename(k->type),
-                    (unsigned)move_heap.stat.nr_values[k->type],
                     purc_variant_get_string_const(k));
+
+            if (k->flags & PCVRNT_FLAG_NOFREE) {
+                /* an interned key is owned by the heap of the instance,
+                   so the cloned object holds a clone of it instead;
+                   the reference taken by the clone is released there */
+                _node->key = move_or_clone_immutable(ctxt, k);
+            }
+            else {
+                move_variant_in(ctxt, k);
+            }
         }
 
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
-            move_variant_in(ctxt->inst, k);
             move_keys_in_cloned_array(ctxt, v);
             break;
 
         case PURC_VARIANT_TYPE_OBJECT:
-            move_variant_in(ctxt->inst, k);
             move_keys_in_cloned_object(ctxt, v);
             break;
 
         case PURC_VARIANT_TYPE_SET:
-            move_variant_in(ctxt->inst, k);
             move_keys_in_cloned_set(ctxt, v);
             break;
 
         case PURC_VARIANT_TYPE_TUPLE:
-            move_variant_in(ctxt->inst, k);
             move_keys_in_cloned_tuple(ctxt, v);
             break;
 
@@ -438,6 +550,13 @@ static bool
 move_or_clone_mutable_descendants_in_array(struct travel_context *ctxt,
         purc_variant_t arr)
 {
+    if (is_packed_array(arr))
+        return true;
+
+    /* the elements shared with another array can not be moved */
+    if (pcvariant_array_writable_data(arr) == NULL)
+        return false;
+
     size_t idx;
     purc_variant_t v;
     foreach_value_in_variant_array(arr, v, idx) {
@@ -447,21 +566,21 @@ move_or_clone_mutable_descendants_in_array(struct travel_context *ctxt,
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_array(ctxt, v);
             }
             break;
 
         case PURC_VARIANT_TYPE_OBJECT:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_object(ctxt, v);
             }
             break;
 
         case PURC_VARIANT_TYPE_SET:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_set(ctxt, v);
             }
             break;
@@ -472,6 +591,7 @@ move_or_clone_mutable_descendants_in_array(struct travel_context *ctxt,
         }
 
         if (IS_CONTAINER(v->type) && v->refc > 1) {
+            use_move_heap(ctxt);
             retv = purc_variant_container_clone_recursively(v);
             if (retv == PURC_VARIANT_INVALID) {
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
@@ -480,7 +600,7 @@ move_or_clone_mutable_descendants_in_array(struct travel_context *ctxt,
 
             move_keys_in_cloned_container(ctxt, retv);
 
-            _p->val = retv;
+            _data->vals[_i] = retv;
             pcutils_arrlist_append(ctxt->vrts_to_unref, v);
         }
 
@@ -494,6 +614,8 @@ move_or_clone_mutable_descendants_in_object(struct travel_context *ctxt,
         purc_variant_t obj)
 {
     purc_variant_t k,v;
+    /* the members may be replaced */
+    pcvar_obj_get_data(obj)->gen++;
     foreach_key_value_in_variant_object(obj, k, v) {
         purc_variant_t retk, retv;
 
@@ -503,21 +625,21 @@ move_or_clone_mutable_descendants_in_object(struct travel_context *ctxt,
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_array(ctxt, v);
             }
             break;
 
         case PURC_VARIANT_TYPE_OBJECT:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_object(ctxt, v);
             }
             break;
 
         case PURC_VARIANT_TYPE_SET:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_set(ctxt, v);
             }
             break;
@@ -528,13 +650,17 @@ move_or_clone_mutable_descendants_in_object(struct travel_context *ctxt,
         }
 
         if (IS_CONTAINER(v->type)) {
-            retk = move_or_clone_immutable(ctxt->inst, k);
+            retk = move_or_clone_immutable(ctxt, k);
             if (retk != k) {
                 _node->key = retk;
-                pcutils_arrlist_append(ctxt->vrts_to_unref, k);
+                /* the reference of an interned key is released when
+                   it was cloned */
+                if (!(k->flags & PCVRNT_FLAG_NOFREE))
+                    pcutils_arrlist_append(ctxt->vrts_to_unref, k);
             }
 
             if (v->refc > 1) {
+                use_move_heap(ctxt);
                 retv = purc_variant_container_clone_recursively(v);
                 if (retv == PURC_VARIANT_INVALID) {
                     purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
@@ -571,21 +697,21 @@ move_or_clone_mutable_descendants_in_set(struct travel_context *ctxt,
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_array(ctxt, v);
             }
             break;
 
         case PURC_VARIANT_TYPE_OBJECT:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_object(ctxt, v);
             }
             break;
 
         case PURC_VARIANT_TYPE_SET:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_set(ctxt, v);
             }
             break;
@@ -596,6 +722,7 @@ move_or_clone_mutable_descendants_in_set(struct travel_context *ctxt,
         }
 
         if (IS_CONTAINER(v->type) && v->refc > 1) {
+            use_move_heap(ctxt);
             retv = purc_variant_container_clone_recursively(v);
             if (retv == PURC_VARIANT_INVALID) {
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
@@ -630,21 +757,21 @@ move_or_clone_mutable_descendants_in_tuple(struct travel_context *ctxt,
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_array(ctxt, v);
             }
             break;
 
         case PURC_VARIANT_TYPE_OBJECT:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_object(ctxt, v);
             }
             break;
 
         case PURC_VARIANT_TYPE_SET:
             if (v->refc == 1) {
-                move_variant_in(ctxt->inst, v);
+                move_variant_in(ctxt, v);
                 move_or_clone_mutable_descendants_in_set(ctxt, v);
             }
             break;
@@ -655,6 +782,7 @@ move_or_clone_mutable_descendants_in_tuple(struct travel_context *ctxt,
         }
 
         if (IS_CONTAINER(v->type) && v->refc > 1) {
+            use_move_heap(ctxt);
             retv = purc_variant_container_clone_recursively(v);
             if (retv == PURC_VARIANT_INVALID) {
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
@@ -708,6 +836,13 @@ static bool
 move_or_clone_immutable_descendants_in_array(struct travel_context *ctxt,
         purc_variant_t arr)
 {
+    if (is_packed_array(arr))
+        return true;
+
+    /* the elements shared with another array can not be moved */
+    if (pcvariant_array_writable_data(arr) == NULL)
+        return false;
+
     size_t idx;
     purc_variant_t v;
     foreach_value_in_variant_array(arr, v, idx) {
@@ -736,7 +871,7 @@ move_or_clone_immutable_descendants_in_array(struct travel_context *ctxt,
             break;
 
         default:
-            retv = move_or_clone_immutable(ctxt->inst, v);
+            retv = move_or_clone_immutable(ctxt, v);
             if (retv == PURC_VARIANT_INVALID) {
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
                 return false;
@@ -745,7 +880,7 @@ move_or_clone_immutable_descendants_in_array(struct travel_context *ctxt,
         }
 
         if (retv != v) {
-            _p->val = retv;
+            _data->vals[_i] = retv;
             if (!(v->flags & PCVRNT_FLAG_NOFREE))
                 pcutils_arrlist_append(ctxt->vrts_to_unref, v);
         }
@@ -760,6 +895,8 @@ move_or_clone_immutable_descendants_in_object(struct travel_context *ctxt,
         purc_variant_t obj)
 {
     purc_variant_t k,v;
+    /* the members may be replaced */
+    pcvar_obj_get_data(obj)->gen++;
     foreach_key_value_in_variant_object(obj, k, v) {
         purc_variant_t retk, retv;
 
@@ -781,13 +918,16 @@ move_or_clone_immutable_descendants_in_object(struct travel_context *ctxt,
             break;
 
         default:
-            retk = move_or_clone_immutable(ctxt->inst, k);
+            retk = move_or_clone_immutable(ctxt, k);
             if (retk != k) {
                 _node->key = retk;
-                pcutils_arrlist_append(ctxt->vrts_to_unref, k);
+                /* the reference of an interned key is released when
+                   it was cloned */
+                if (!(k->flags & PCVRNT_FLAG_NOFREE))
+                    pcutils_arrlist_append(ctxt->vrts_to_unref, k);
             }
 
-            retv = move_or_clone_immutable(ctxt->inst, v);
+            retv = move_or_clone_immutable(ctxt, v);
             if (retv != v) {
                 _node->val = retv;
                 if (!(v->flags & PCVRNT_FLAG_NOFREE))
@@ -831,7 +971,7 @@ move_or_clone_immutable_descendants_in_set(struct travel_context *ctxt,
             break;
 
         default:
-            retv = move_or_clone_immutable(ctxt->inst, v);
+            retv = move_or_clone_immutable(ctxt, v);
             if (retv == PURC_VARIANT_INVALID) {
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
                 return false;
@@ -886,7 +1026,7 @@ move_or_clone_immutable_descendants_in_tuple(struct travel_context *ctxt,
             break;
 
         default:
-            retv = move_or_clone_immutable(ctxt->inst, v);
+            retv = move_or_clone_immutable(ctxt, v);
             if (retv == PURC_VARIANT_INVALID) {
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
                 return false;
@@ -929,46 +1069,59 @@ static void cb_free_element(void *data)
     purc_variant_unref(data);
 }
 
+/* moves a container in; ctxt->vrts_to_unref must have been created */
+static purc_variant_t
+move_container_in(struct travel_context *ctxt, purc_variant_t v)
+{
+    purc_variant_t retv;
+
+    if (v->refc == 1) {
+        retv = v;
+        move_variant_in(ctxt, v);
+        move_or_clone_mutable_descendants(ctxt, v);
+    }
+    else {
+        use_move_heap(ctxt);
+        retv = purc_variant_container_clone_recursively(v);
+
+        /* XXX: for cloned container, we need to move in the cloned keys
+         * of descendant objects,
+         * cause purc_variant_container_clone_recursively() only
+         * references the keys */
+        move_keys_in_cloned_container(ctxt, retv);
+    }
+
+    move_or_clone_immutable_descendants(ctxt, retv);
+    return retv;
+}
+
 // move the variant from the current instance to the move heap.
 purc_variant_t pcvariant_move_heap_in(purc_variant_t v)
 {
     purc_variant_t retv = PURC_VARIANT_INVALID;
-    struct pcinst *inst = pcinst_current();
     struct travel_context ctxt;
 
-    ctxt.inst = pcinst_current();
+    travel_context_init(&ctxt);
+
+    /* the fast path for a scalar: no travel at all */
+    if (!IS_CONTAINER(v->type)) {
+        retv = move_or_clone_immutable(&ctxt, v);
+        apply_changes(&ctxt);
+
+        if (retv != v && !(v->flags & PCVRNT_FLAG_NOFREE))
+            purc_variant_unref(v);
+        return retv;
+    }
+
     ctxt.vrts_to_unref = pcutils_arrlist_new(cb_free_element);
     if (ctxt.vrts_to_unref == NULL) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return retv;
     }
 
-    pcvariant_use_move_heap();
-
-    if (IS_CONTAINER(v->type)) {
-        if (v->refc == 1) {
-            retv = v;
-            move_variant_in(inst, v);
-            move_or_clone_mutable_descendants(&ctxt, v);
-
-        }
-        else {
-            retv = purc_variant_container_clone_recursively(v);
+    retv = move_container_in(&ctxt, v);
 
-            /* XXX: for cloned container, we need to move in the cloned keys
-             * of descendant objects,
-             * cause purc_variant_container_clone_recursively() only
-             * references the keys */
-            move_keys_in_cloned_container(&ctxt, retv);
-        }
-
-        move_or_clone_immutable_descendants(&ctxt, retv);
-    }
-    else {
-        retv = move_or_clone_immutable(inst, v);
-    }
-
-    pcvariant_use_norm_heap();
+    apply_changes(&ctxt);
 
     if (retv != PURC_VARIANT_INVALID && retv != v &&
             !(v->flags & PCVRNT_FLAG_NOFREE)) {
@@ -981,292 +1134,255 @@ purc_variant_t pcvariant_move_heap_in(purc_variant_t v)
     return retv;
 }
 
-// move the variant from the move heap to the current instance.
-// we only need to update the stat information.
-static void move_container_self_out(purc_variant_t v)
+/*
+ * Moves the variants of a message in one travel, so the changes are applied
+ * to the move heap under the lock once rather than once for every variant.
+ * The original variants replaced by clones are released after the lock
+ * is released, together with the cloned immutable descendants.
+ */
+int pcvariant_move_heap_in_n(purc_variant_t *vs, size_t n)
 {
-    struct pcinst *inst = pcinst_current();
-
-    inst->org_vrt_heap->stat.sz_mem[v->type] += v->sz_ptr[0];
-    inst->org_vrt_heap->stat.sz_total_mem += v->sz_ptr[0];
+    struct travel_context ctxt;
 
-    move_heap.stat.sz_mem[v->type] -= v->sz_ptr[0];
-    move_heap.stat.sz_total_mem -= v->sz_ptr[0];
+    travel_context_init(&ctxt);
+    ctxt.vrts_to_unref = pcutils_arrlist_new(cb_free_element);
+    if (ctxt.vrts_to_unref == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
 
-    inst->org_vrt_heap->stat.nr_values[v->type]++;
-    inst->org_vrt_heap->stat.nr_total_values++;
+    int retv = 0;
+    for (size_t i = 0; i < n; i++) {
+        purc_variant_t v = vs[i];
+        if (v == PURC_VARIANT_INVALID)
+            continue;
+
+        if (IS_CONTAINER(v->type))
+            vs[i] = move_container_in(&ctxt, v);
+        else
+            vs[i] = move_or_clone_immutable(&ctxt, v);
+
+        if (vs[i] == PURC_VARIANT_INVALID)
+            retv = -1;
+        else if (vs[i] != v && !(v->flags & PCVRNT_FLAG_NOFREE))
+            pcutils_arrlist_append(ctxt.vrts_to_unref, v);
+    }
 
-    move_heap.stat.nr_values[v->type]--;
-    move_heap.stat.nr_total_values--;
+    apply_changes(&ctxt);
+    pcutils_arrlist_free(ctxt.vrts_to_unref);
 
-    inst->org_vrt_heap->stat.sz_mem[v->type] += sizeof(purc_variant);
-    inst->org_vrt_heap->stat.sz_total_mem += sizeof(purc_variant);
-    move_heap.stat.sz_mem[v->type] -= sizeof(purc_variant);
-    move_heap.stat.sz_total_mem -= sizeof(purc_variant);
+    return retv;
 }
 
-static purc_variant_t move_variant_out(purc_variant_t v);
-static purc_variant_t move_array_descendants_out(purc_variant_t v);
-static purc_variant_t move_object_descendants_out(purc_variant_t v);
-static purc_variant_t move_set_descendants_out(purc_variant_t v);
-static purc_variant_t move_tuple_descendants_out(purc_variant_t v);
-
-static purc_variant_t move_array_descendants_out(purc_variant_t arr)
+// move the variant from the move heap to the current instance.
+// we only need to update the stat information.
+static void move_container_self_out(struct travel_context *ctxt,
+        purc_variant_t v)
 {
-    size_t idx;
-    purc_variant_t v;
+    struct pcvariant_heap *heap = ctxt->inst->org_vrt_heap;
 
-    foreach_value_in_variant_array(arr, v, idx) {
-        purc_variant_t retv;
+    heap->stat.sz_mem[v->type] += v->sz_ptr[0];
+    heap->stat.sz_total_mem += v->sz_ptr[0];
 
-        UNUSED_PARAM(idx);
-        switch (v->type) {
-        case PURC_VARIANT_TYPE_ARRAY:
-            retv = move_array_descendants_out(v);
-            move_container_self_out(retv);
-            break;
+    ctxt->delta.sz_mem[v->type] -= v->sz_ptr[0];
+    ctxt->delta.sz_total_mem -= v->sz_ptr[0];
 
-        case PURC_VARIANT_TYPE_OBJECT:
-            retv = move_object_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_SET:
-            retv = move_set_descendants_out(v);
-            move_container_self_out(retv);
-            break;
+    heap->stat.nr_values[v->type]++;
+    heap->stat.nr_total_values++;
 
-        case PURC_VARIANT_TYPE_TUPLE:
-            retv = move_tuple_descendants_out(v);
-            move_container_self_out(retv);
-            break;
+    ctxt->delta.nr_values[v->type]--;
+    ctxt->delta.nr_total_values--;
 
-        default:
-            retv = move_variant_out(v);
-            break;
-        }
+    heap->stat.sz_mem[v->type] += sizeof(purc_variant);
+    heap->stat.sz_total_mem += sizeof(purc_variant);
+    pcvariant_stat_update_max_mem(&heap->stat);
+    ctxt->delta.sz_mem[v->type] -= sizeof(purc_variant);
+    ctxt->delta.sz_total_mem -= sizeof(purc_variant);
+}
 
-        _p->val = retv;
+static purc_variant_t move_variant_out(struct travel_context *ctxt,
+        purc_variant_t v);
+static void move_descendants_out(struct travel_context *ctxt,
+        purc_variant_t v);
 
-    } end_foreach;
+/* moves out a member of a container */
+static purc_variant_t move_member_out(struct travel_context *ctxt,
+        purc_variant_t v)
+{
+    if (IS_CONTAINER(v->type)) {
+        move_descendants_out(ctxt, v);
+        move_container_self_out(ctxt, v);
+        return v;
+    }
 
-    return arr;
+    return move_variant_out(ctxt, v);
 }
 
-static purc_variant_t move_object_descendants_out(purc_variant_t obj)
+static void move_array_descendants_out(struct travel_context *ctxt,
+        purc_variant_t arr)
 {
-    purc_variant_t k,v;
-    foreach_key_value_in_variant_object(obj, k, v) {
-        purc_variant_t retk, retv;
-
-        retk = move_variant_out(k);
-        switch (v->type) {
-        case PURC_VARIANT_TYPE_ARRAY:
-            retv = move_array_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_OBJECT:
-            retv = move_object_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_SET:
-            retv = move_set_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_TUPLE:
-            retv = move_tuple_descendants_out(v);
-            move_container_self_out(retv);
-            break;
+    if (is_packed_array(arr))
+        return;
 
-        default:
-            retv = move_variant_out(v);
-            break;
-        }
+    /* the arrays are made private when they are moved in */
+    PC_ASSERT(pcvar_arr_get_data(arr)->sharers == NULL);
 
-        _node->key = retk;
-        _node->val = retv;
+    size_t idx;
+    purc_variant_t v;
 
+    foreach_value_in_variant_array(arr, v, idx) {
+        UNUSED_PARAM(idx);
+        _data->vals[_i] = move_member_out(ctxt, v);
     } end_foreach;
+}
 
-    return obj;
+static void move_object_descendants_out(struct travel_context *ctxt,
+        purc_variant_t obj)
+{
+    purc_variant_t k,v;
+    /* the members may be replaced */
+    pcvar_obj_get_data(obj)->gen++;
+    foreach_key_value_in_variant_object(obj, k, v) {
+        _node->key = move_variant_out(ctxt, k);
+        _node->val = move_member_out(ctxt, v);
+    } end_foreach;
 }
 
-static purc_variant_t move_set_descendants_out(purc_variant_t set)
+static void move_set_descendants_out(struct travel_context *ctxt,
+        purc_variant_t set)
 {
     purc_variant_t v;
     foreach_value_in_variant_set(set, v) {
-        purc_variant_t retv;
-
-        switch (v->type) {
-        case PURC_VARIANT_TYPE_ARRAY:
-            retv = move_array_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_OBJECT:
-            retv = move_object_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_SET:
-            retv = move_set_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_TUPLE:
-            retv = move_tuple_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        default:
-            retv = move_variant_out(v);
-            break;
-        }
-
-        _sn->val = retv;
+        _sn->val = move_member_out(ctxt, v);
     } end_foreach;
-
-    return set;
 }
 
-static purc_variant_t move_tuple_descendants_out(purc_variant_t tuple)
+static void move_tuple_descendants_out(struct travel_context *ctxt,
+        purc_variant_t tuple)
 {
     size_t sz;
     purc_variant_t *members;
     members = tuple_members(tuple, &sz);
     assert(members);
 
-    purc_variant_t v;
     for (size_t idx = 0; idx < sz; idx++) {
-        v = members[idx];
-        purc_variant_t retv;
-
-        switch (v->type) {
-        case PURC_VARIANT_TYPE_ARRAY:
-            retv = move_array_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_OBJECT:
-            retv = move_object_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_SET:
-            retv = move_set_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        case PURC_VARIANT_TYPE_TUPLE:
-            retv = move_tuple_descendants_out(v);
-            move_container_self_out(retv);
-            break;
-
-        default:
-            retv = move_variant_out(v);
-            break;
-        }
-
+        members[idx] = move_member_out(ctxt, members[idx]);
     }
+}
 
-    return tuple;
+static void move_descendants_out(struct travel_context *ctxt,
+        purc_variant_t v)
+{
+    switch (v->type) {
+    case PURC_VARIANT_TYPE_ARRAY:
+        move_array_descendants_out(ctxt, v);
+        break;
+    case PURC_VARIANT_TYPE_OBJECT:
+        move_object_descendants_out(ctxt, v);
+        break;
+    case PURC_VARIANT_TYPE_SET:
+        move_set_descendants_out(ctxt, v);
+        break;
+    case PURC_VARIANT_TYPE_TUPLE:
+        move_tuple_descendants_out(ctxt, v);
+        break;
+    default:
+        break;
+    }
 }
 
-static purc_variant_t move_variant_out(purc_variant_t v)
+static purc_variant_t move_variant_out(struct travel_context *ctxt,
+        purc_variant_t v)
 {
     purc_variant_t retv = v;
-    struct pcinst *inst = pcinst_current();
+    struct pcvariant_heap *heap = ctxt->inst->org_vrt_heap;
 
     if (v == &move_heap.v_undefined) {
-        retv = &inst->org_vrt_heap->v_undefined;
-        v->refc--;
+        retv = &heap->v_undefined;
+        ctxt->refc_undefined--;
         retv->refc++;
         return retv;
     }
     else if (v == &move_heap.v_null) {
-        retv = &inst->org_vrt_heap->v_null;
-        v->refc--;
+        retv = &heap->v_null;
+        ctxt->refc_null--;
         retv->refc++;
         return retv;
     }
     else if (v == &move_heap.v_false) {
-        retv = &inst->org_vrt_heap->v_false;
-        v->refc--;
+        retv = &heap->v_false;
+        ctxt->refc_false--;
         retv->refc++;
         return retv;
     }
     else if (v == &move_heap.v_true) {
-        retv = &inst->org_vrt_heap->v_true;
-        v->refc--;
+        retv = &heap->v_true;
+        ctxt->refc_true--;
         retv->refc++;
         return retv;
     }
+    else if (IS_CONTAINER(v->type)) {
+        move_descendants_out(ctxt, v);
+        move_container_self_out(ctxt, v);
+        return retv;
+    }
     else if ((v->type == PURC_VARIANT_TYPE_STRING ||
                   v->type == PURC_VARIANT_TYPE_BSEQUENCE) &&
                  (v->flags & PCVRNT_FLAG_EXTRA_SIZE)) {
-        inst->org_vrt_heap->stat.sz_mem[v->type] += v->sz_ptr[0];
-        inst->org_vrt_heap->stat.sz_total_mem += v->sz_ptr[0];
+        heap->stat.sz_mem[v->type] += v->sz_ptr[0];
+        heap->stat.sz_total_mem += v->sz_ptr[0];
 
-        move_heap.stat.sz_mem[v->type] -= v->sz_ptr[0];
-        move_heap.stat.sz_total_mem -= v->sz_ptr[0];
-    }
-    else if (IS_CONTAINER(v->type)) {
-        inst->org_vrt_heap->stat.sz_mem[v->type] += v->sz_ptr[0];
-        inst->org_vrt_heap->stat.sz_total_mem += v->sz_ptr[0];
-
-        move_heap.stat.sz_mem[v->type] -= v->sz_ptr[0];
-        move_heap.stat.sz_total_mem -= v->sz_ptr[0];
-
-        if (v->type == PURC_VARIANT_TYPE_ARRAY) {
-            retv = move_array_descendants_out(v);
-        }
-        else if (v->type == PURC_VARIANT_TYPE_OBJECT) {
-            retv = move_object_descendants_out(v);
-        }
-        else if (v->type == PURC_VARIANT_TYPE_SET) {
-            retv = move_set_descendants_out(v);
-        }
-        else if (v->type == PURC_VARIANT_TYPE_TUPLE) {
-            retv = move_tuple_descendants_out(v);
-        }
+        ctxt->delta.sz_mem[v->type] -= v->sz_ptr[0];
+        ctxt->delta.sz_total_mem -= v->sz_ptr[0];
     }
 
-    inst->org_vrt_heap->stat.nr_values[v->type]++;
-    inst->org_vrt_heap->stat.nr_total_values++;
-
-    PC_DEBUG("Move out a variant type: %s (%u): %s\n",
+    PC_DEBUG("Move out a variant type: %s: %s\n",
             purc_variant_typename(v->type),
-            (unsigned)move_heap.stat.nr_values[v->type],
             purc_variant_is_string(v) ? purc_variant_get_string_const(v): NULL);
 
-    assert(move_heap.stat.nr_values[v->type] > 0);
-    assert(move_heap.stat.nr_total_values > 0);
+    heap->stat.nr_values[v->type]++;
+    heap->stat.nr_total_values++;
+    ctxt->delta.nr_values[v->type]--;
+    ctxt->delta.nr_total_values--;
 
-    move_heap.stat.nr_values[v->type]--;
-    move_heap.stat.nr_total_values--;
-
-    inst->org_vrt_heap->stat.sz_mem[v->type] += sizeof(purc_variant);
-    inst->org_vrt_heap->stat.sz_total_mem += sizeof(purc_variant);
-    move_heap.stat.sz_mem[v->type] -= sizeof(purc_variant);
-    move_heap.stat.sz_total_mem -= sizeof(purc_variant);
+    heap->stat.sz_mem[v->type] += sizeof(purc_variant);
+    heap->stat.sz_total_mem += sizeof(purc_variant);
+    pcvariant_stat_update_max_mem(&heap->stat);
+    ctxt->delta.sz_mem[v->type] -= sizeof(purc_variant);
+    ctxt->delta.sz_total_mem -= sizeof(purc_variant);
 
     return retv;
 }
 
+/*
+ * Nothing is allocated when moving a variant out of the move heap, and
+ * it is owned by the taker only; so only the changes of the move heap
+ * are applied under the lock.
+ */
 purc_variant_t pcvariant_move_heap_out(purc_variant_t v)
 {
-    purc_variant_t retv = PURC_VARIANT_INVALID;
+    struct travel_context ctxt;
 
-    pcvariant_use_move_heap();
-    retv = move_variant_out(v);
-    pcvariant_use_norm_heap();
+    travel_context_init(&ctxt);
+    purc_variant_t retv = move_variant_out(&ctxt, v);
+    apply_changes(&ctxt);
 
     return retv;
 }
 
+/* moves the variants of a message out in one travel */
+void pcvariant_move_heap_out_n(purc_variant_t *vs, size_t n)
+{
+    struct travel_context ctxt;
+
+    travel_context_init(&ctxt);
+    for (size_t i = 0; i < n; i++) {
+        if (vs[i])
+            vs[i] = move_variant_out(&ctxt, vs[i]);
+    }
+    apply_changes(&ctxt);
+}
+
 void pcvariant_use_move_heap(void)
 {
     struct pcinst *inst = pcinst_current();
@@ -22,6 +22,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "private/utils.h"
 #include "variant-internals.h"
 
 static double
@@ -31,7 +32,7 @@ _numerify_str(const char *s)
     if (!*s)
         return 0.0;
 
-    return strtod(s, NULL);
+    return pcutils_strtod(s, NULL);
 }
 
 double
@@ -54,6 +54,7 @@ register_listener(purc_variant_t v, unsigned int flags,
         list_add_tail(&listener->list_node, listeners);
     }
 
+    v->flags |= PCVRNT_FLAG_LISTENED;
     return listener;
 }
 
@@ -127,6 +128,8 @@ purc_variant_revoke_listener(purc_variant_t v,
 
         list_del(p);
         free(curr);
+        if (list_empty(listeners))
+            v->flags &= ~PCVRNT_FLAG_LISTENED;
         return true;
     }
 
@@ -140,6 +143,9 @@ bool pcvariant_on_pre_fired(
         purc_variant_t *argv    // the array of all relevant child variants.
         )
 {
+    if (!(source->flags & PCVRNT_FLAG_LISTENED))
+        return true;
+
     op &= PCVAR_OPERATION_ALL;
     PC_ASSERT(op != PCVAR_OPERATION_ALL);
 
@@ -171,6 +177,9 @@ void pcvariant_on_post_fired(
         purc_variant_t *argv    // the array of all relevant child variants.
         )
 {
+    if (!(source->flags & PCVRNT_FLAG_LISTENED))
+        return;
+
     op &= PCVAR_OPERATION_ALL;
     PC_ASSERT(op != PCVAR_OPERATION_ALL);
 
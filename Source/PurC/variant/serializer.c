@@ -46,6 +46,7 @@
 #include "private/instance.h"
 #include "private/errors.h"
 #include "private/debug.h"
+#include "private/utils.h"
 
 #include "variant/variant-internals.h"
 
@@ -56,6 +57,12 @@
 #include <float.h>
 #include <assert.h>
 
+#if CPU(X86_SSE2)
+#include <emmintrin.h>
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
 static const char *hex_chars = "0123456789abcdefABCDEF";
 
 #define MY_WRITE(rws, buff, count)                                      \
@@ -96,93 +103,110 @@ static const char *hex_chars = "0123456789abcdefABCDEF";
         }                                                               \
     } while (0)
 
-static ssize_t
-serialize_string(purc_rwstream_t rws, const char* str,
-        size_t len, unsigned int flags, size_t *len_expected)
+/*
+ * The escape character following the backslash for every byte which needs
+ * to be escaped in a JSON string; 'u' means the byte will be written as
+ * `\u00XX`, and zero means the byte can be written as is.
+ */
+static const char escape_chars[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    ['"'] = '"',
+    ['/'] = '/',
+    ['\\'] = '\\',
+};
+
+static inline bool
+need_escape(unsigned char c, bool escape_slash)
 {
-    int nr_written = 0;
-    size_t pos = 0, start_offset = 0;
-    unsigned char c;
-    char buff[3];
-
-    while (len--) {
-        c = str[pos];
-        switch (c) {
-        case '\b':
-        case '\n':
-        case '\r':
-        case '\t':
-        case '\f':
-        case '"':
-        case '\\':
-        case '/':
-            if ((flags & PCVRNT_SERIALIZE_OPT_NOSLASHESCAPE) && c == '/') {
-                pos++;
-                break;
-            }
-
-            if (pos - start_offset > 0)
-                MY_WRITE(rws, str + start_offset, pos - start_offset);
-
-            buff[0] = 0;
-            if (c == '\b') {
-                buff[0] = '\\';
-                buff[1] = 'b';
-            }
-            else if (c == '\n') {
-                buff[0] = '\\';
-                buff[1] = 'n';
-            }
-            else if (c == '\r') {
-                buff[0] = '\\';
-                buff[1] = 'r';
-            }
-            else if (c == '\t') {
-                buff[0] = '\\';
-                buff[1] = 't';
-            }
-            else if (c == '\f') {
-                buff[0] = '\\';
-                buff[1] = 'f';
-            }
-            else if (c == '"') {
-                buff[0] = '\\';
-                buff[1] = '\"';
-            }
-            else if (c == '\\') {
-                buff[0] = '\\';
-                buff[1] = '\\';
-            }
-            else if (c == '/') {
-                buff[0] = '\\';
-                buff[1] = '/';
-            }
+    return escape_chars[c] && (c != '/' || escape_slash);
+}
 
-            if (buff[0])
-                MY_WRITE(rws, buff, 2);
+/*
+ * Returns the length of the leading run of bytes in `str` which can be
+ * written without escaping. The SIMD paths check 16 bytes at a time; the
+ * tail (and the whole string on other CPUs) is checked byte by byte.
+ */
+static size_t
+clean_run_length(const unsigned char *str, size_t len, bool escape_slash)
+{
+    size_t pos = 0;
+
+#if CPU(X86_SSE2)
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i slash = _mm_set1_epi8(escape_slash ? '/' : '"');
+
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + pos));
+        /* v <= 0x1F (unsigned) iff min(v, 0x1F) == v */
+        __m128i m = _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl), v);
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, quote));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, bslash));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, slash));
+
+        int mask = _mm_movemask_epi8(m);
+        if (mask)
+            return pos + __builtin_ctz((unsigned)mask);
+    }
+#elif CPU(ARM64) && HAVE(ARM_NEON_INTRINSICS)
+    const uint8x16_t ctrl = vdupq_n_u8(0x20);
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t bslash = vdupq_n_u8('\\');
+    const uint8x16_t slash = vdupq_n_u8(escape_slash ? '/' : '"');
+
+    for (; pos + 16 <= len; pos += 16) {
+        uint8x16_t v = vld1q_u8(str + pos);
+        uint8x16_t m = vcltq_u8(v, ctrl);
+        m = vorrq_u8(m, vceqq_u8(v, quote));
+        m = vorrq_u8(m, vceqq_u8(v, bslash));
+        m = vorrq_u8(m, vceqq_u8(v, slash));
+
+        if (vmaxvq_u8(m))
+            break;      /* locate the byte in the scalar loop below */
+    }
+#endif
 
-            start_offset = ++pos;
+    for (; pos < len; pos++) {
+        if (need_escape(str[pos], escape_slash))
             break;
+    }
 
-        default:
-            if (c < ' ') {
-                char sbuf[7];
-                if (pos - start_offset > 0)
-                    MY_WRITE(rws, str + start_offset, pos - start_offset);
+    return pos;
+}
 
-                if (snprintf(sbuf, sizeof(sbuf), "\\u00%c%c",
-                            hex_chars[c >> 4], hex_chars[c & 0xf]) < 0)
-                    goto failed;
+static ssize_t
+serialize_string(purc_rwstream_t rws, const char* str,
+        size_t len, unsigned int flags, size_t *len_expected)
+{
+    int nr_written = 0;
+    size_t pos = 0;
+    bool escape_slash = !(flags & PCVRNT_SERIALIZE_OPT_NOSLASHESCAPE);
+
+    while (pos < len) {
+        size_t n = clean_run_length((const unsigned char *)str + pos,
+                len - pos, escape_slash);
+        if (n > 0) {
+            MY_WRITE(rws, str + pos, n);
+            pos += n;
+            if (pos == len)
+                break;
+        }
 
-                MY_WRITE(rws, sbuf, sizeof(sbuf) - 1);
-                start_offset = ++pos;
-            }
-            else
-                pos++;
+        unsigned char c = str[pos++];
+        if (escape_chars[c] == 'u') {
+            char sbuf[6] = { '\\', 'u', '0', '0',
+                hex_chars[c >> 4], hex_chars[c & 0xf] };
+            MY_WRITE(rws, sbuf, sizeof(sbuf));
+        }
+        else {
+            char buff[2] = { '\\', escape_chars[c] };
+            MY_WRITE(rws, buff, sizeof(buff));
         }
     }
-    if (pos - start_offset > 0)
-        MY_WRITE(rws, str + start_offset, pos - start_offset);
 
     return nr_written;
 
@@ -190,129 +214,21 @@ failed:
     return -1;
 }
 
-static const char base64_chars[] =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-static const char base64_pad = '=';
-
-/* (From RFC1521 and draft-ietf-dnssec-secext-03.txt)
-   The following encoding technique is taken from RFC 1521 by Borenstein
-   and Freed.  It is reproduced here in a slightly edited form for
-   convenience.
-
-   A 65-character subset of US-ASCII is used, enabling 6 bits to be
-   represented per printable character. (The extra 65th character, "=",
-   is used to signify a special processing function.)
-
-   The encoding process represents 24-bit groups of input bits as output
-   strings of 4 encoded characters. Proceeding from left to right, a
-   24-bit input group is formed by concatenating 3 8-bit input groups.
-   These 24 bits are then treated as 4 concatenated 6-bit groups, each
-   of which is translated into a single digit in the base64 alphabet.
-
-   Each 6-bit group is used as an index into an array of 64 printable
-   characters. The character referenced by the index is placed in the
-   output string.
-
-                         Table 1: The Base64 Alphabet
-
-      Value Encoding  Value Encoding  Value Encoding  Value Encoding
-          0 A            17 R            34 i            51 z
-          1 B            18 S            35 j            52 0
-          2 C            19 T            36 k            53 1
-          3 D            20 U            37 l            54 2
-          4 E            21 V            38 m            55 3
-          5 F            22 W            39 n            56 4
-          6 G            23 X            40 o            57 5
-          7 H            24 Y            41 p            58 6
-          8 I            25 Z            42 q            59 7
-          9 J            26 a            43 r            60 8
-         10 K            27 b            44 s            61 9
-         11 L            28 c            45 t            62 +
-         12 M            29 d            46 u            63 /
-         13 N            30 e            47 v
-         14 O            31 f            48 w         (pad) =
-         15 P            32 g            49 x
-         16 Q            33 h            50 y
-
-   Special processing is performed if fewer than 24 bits are available
-   at the end of the data being encoded.  A full encoding quantum is
-   always completed at the end of a quantity.  When fewer than 24 input
-   bits are available in an input group, zero bits are added (on the
-   right) to form an integral number of 6-bit groups.  Padding at the
-   end of the data is performed using the '=' character.
-
-   Since all base64 input is an integral number of octets, only the
-         -------------------------------------------------
-   following cases can arise:
-
-       (1) the final quantum of encoding input is an integral
-           multiple of 24 bits; here, the final unit of encoded
-       output will be an integral multiple of 4 characters
-       with no "=" padding,
-       (2) the final quantum of encoding input is exactly 8 bits;
-           here, the final unit of encoded output will be two
-       characters followed by two "=" padding characters, or
-       (3) the final quantum of encoding input is exactly 16 bits;
-           here, the final unit of encoded output will be three
-       characters followed by one "=" padding character.
-   */
-
+/* the bytes are encoded chunk by chunk; see purc_rwstream_write_base64() */
 static ssize_t serialize_bsequence_base64(purc_rwstream_t rws,
-        const void *_src, size_t srclength,
+        const void *src, size_t srclength,
         unsigned int flags, size_t *len_expected)
 {
-    const unsigned char *src = _src;
-    ssize_t nr_written = 0;
-    uint8_t input[3] = {0};
-    uint8_t output[4];
-    char buff[4];
-    size_t i;
-
-    while (2 < srclength) {
-        input[0] = *src++;
-        input[1] = *src++;
-        input[2] = *src++;
-        srclength -= 3;
-
-        output[0] = input[0] >> 2;
-        output[1] = ((input[0] & 0x03) << 4) + (input[1] >> 4);
-        output[2] = ((input[1] & 0x0f) << 2) + (input[2] >> 6);
-        output[3] = input[2] & 0x3f;
-
-        buff[0] = base64_chars[output[0]];
-        buff[1] = base64_chars[output[1]];
-        buff[2] = base64_chars[output[2]];
-        buff[3] = base64_chars[output[3]];
-
-        MY_WRITE(rws, buff, 4);
-    }
-
-    /* Now we worry about padding. */
-    if (0 != srclength) {
-        /* Get what's left. */
-        input[0] = input[1] = input[2] = '\0';
-        for (i = 0; i < srclength; i++)
-            input[i] = *src++;
-
-        output[0] = input[0] >> 2;
-        output[1] = ((input[0] & 0x03) << 4) + (input[1] >> 4);
-        output[2] = ((input[1] & 0x0f) << 2) + (input[2] >> 6);
-
-        buff[0] = base64_chars[output[0]];
-        buff[1] = base64_chars[output[1]];
-        if (srclength == 1)
-            buff[2] = base64_pad;
-        else
-            buff[2] = base64_chars[output[2]];
-        buff[3] = base64_pad;
+    size_t len = (srclength + 2) / 3 * 4;
+    if (len_expected)
+        *len_expected += len;
 
-        MY_WRITE(rws, buff, 4);
-    }
+    ssize_t nr_written = purc_rwstream_write_base64(rws, src, srclength);
+    if ((size_t)nr_written != len &&
+            !(flags & PCVRNT_SERIALIZE_OPT_IGNORE_ERRORS))
+        return -1;
 
     return nr_written;
-
-failed:
-    return -1;
 }
 
 static ssize_t
@@ -431,19 +347,23 @@ serialize_number(purc_rwstream_t rws, double d, size_t *len_expected)
         }
     }
     else {
-        double test;
+        /* only the integral numbers are formatted without decimals;
+           if not, return 0 and call serialize_double */
+        if (d != trunc(d))
+            return 0;
 
-        /* try to format the double without decimals */
-        size = snprintf(buf, sizeof(buf), "%.0f", d);
-        if (size < 0 || size >= (int)sizeof(buf)) {
-            pcinst_set_error(PURC_ERROR_TOO_SMALL_BUFF);
-            return -1;
+        if (fabs(d) < 1e18 && !(d == 0 && signbit(d))) {
+            size = snprintf(buf, sizeof(buf), "%lld", (long long)d);
+        }
+        else {
+            size = snprintf(buf, sizeof(buf), "%.0f", d);
+            if (size >= (int)sizeof(buf))
+                return 0;
         }
 
-        /* Check whether the original double can be recovered */
-        if ((sscanf(buf, "%lg", &test) != 1) || !equal_doubles(test, d)) {
-            /* If not, return 0 and call serialize_double */
-            return 0;
+        if (UNLIKELY(size < 0)) {
+            pcinst_set_error(PURC_ERROR_OUTPUT);
+            return -1;
         }
     }
 
@@ -459,19 +379,20 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
     char buf[128], *p, *q;
     int size;
 
-    static const char *std_format = "%.17g";
     int format_drops_decimals = 0;
     int looks_numeric = 0;
 
     if (!format) {
-        format = std_format;
+        /* the shortest digits which can be read back to the same double */
+        size = pcutils_dtoa_shortest(d, 17, buf);
     }
-
-    size = snprintf(buf, sizeof(buf), format, d);
-    // although unlikely, snprintf might fail
-    if (UNLIKELY(size < 0)) {
-        pcinst_set_error(PURC_ERROR_OUTPUT);
-        return -1;
+    else {
+        size = snprintf(buf, sizeof(buf), format, d);
+        // although unlikely, snprintf might fail
+        if (UNLIKELY(size < 0)) {
+            pcinst_set_error(PURC_ERROR_OUTPUT);
+            return -1;
+        }
     }
 
     p = strchr(buf, ',');
@@ -480,7 +401,7 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
     else
         p = strchr(buf, '.');
 
-    if (format == std_format || strstr(format, ".0f") == NULL)
+    if (format == NULL || strstr(format, ".0f") == NULL)
         format_drops_decimals = 1;
 
     looks_numeric = /* Looks like *some* kind of number */
@@ -662,6 +583,30 @@ static inline ssize_t print_space_no_pretty(purc_rwstream_t rws,
     return nr_written;
 }
 
+/* fills the variant on stack with the packed element */
+static purc_variant_t
+packed_member(struct purc_variant *elem, pcvrnt_packed_type_k type,
+        const void *packed, size_t idx)
+{
+    memset(elem, 0, sizeof(*elem));
+    switch (type) {
+    case PCVRNT_PACKED_NUMBER:
+        elem->type = PURC_VARIANT_TYPE_NUMBER;
+        elem->d = ((const double *)packed)[idx];
+        break;
+    case PCVRNT_PACKED_LONGINT:
+        elem->type = PURC_VARIANT_TYPE_LONGINT;
+        elem->i64 = ((const int64_t *)packed)[idx];
+        break;
+    default:
+        elem->type = PURC_VARIANT_TYPE_ULONGINT;
+        elem->u64 = ((const uint64_t *)packed)[idx];
+        break;
+    }
+
+    return elem;
+}
+
 ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
         int level, unsigned int flags, size_t *len_expected)
 {
@@ -675,6 +620,10 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
     char* format_double = NULL;
     char* format_long_double = NULL;
     variant_set_t data;
+    struct purc_variant elem;
+    pcvrnt_packed_type_k packed_type;
+    const void *packed;
+    size_t nr_members;
 
     purc_get_local_data(PURC_LDNAME_FORMAT_DOUBLE,
             (uintptr_t *)&format_double, NULL);
@@ -895,9 +844,18 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
             n = print_newline(rws, flags, len_expected);
             MY_CHECK(n);
 
-            i = 0;
-            foreach_value_in_variant_array(value, member, idx)
-                (void)idx;
+            /* serialize the packed numbers without boxing them */
+            packed = purc_variant_array_get_packed(value, &packed_type,
+                    &nr_members);
+            if (packed == NULL)
+                nr_members = purc_variant_array_get_size(value);
+
+            for (i = 0; i < nr_members; i++) {
+                if (packed)
+                    member = packed_member(&elem, packed_type, packed, i);
+                else
+                    member = purc_variant_array_get(value, i);
+
                 if (i > 0) {
                     MY_WRITE(rws, ",", 1);
                     n = print_newline(rws, flags, len_expected);
@@ -914,9 +872,7 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
                 n = purc_variant_serialize(member,
                         rws, level + 1, flags, len_expected);
                 MY_CHECK(n);
-
-                i++;
-            end_foreach;
+            }
 
             if (i > 0) {
                 n = print_newline(rws, flags, len_expected);
@@ -1070,3 +1026,473 @@ failed:
     return -1;
 }
 
+
+/*
+ * The incremental serializer.
+ *
+ * Instead of recursing into the containers, the serializer keeps an explicit
+ * stack of the containers being serialized, and every step produces a small
+ * piece of the output: the opening or the closing part of a container,
+ * a member (a key and a scalar value, or the opening part of a sub
+ * container), or a slice of a long string. The pieces go to an internal
+ * buffer which is drained by purc_variant_serializer_read(); therefore,
+ * the memory used does not depend on the size of the whole output.
+ *
+ * The output is exactly the same as the one of purc_variant_serialize().
+ */
+
+/* the maximal number of bytes of a long string serialized in one step */
+#define SZ_STRING_SLICE         4096
+
+enum {
+    SER_STATE_OPEN = 0,
+    SER_STATE_MEMBERS,
+};
+
+struct ser_frame {
+    purc_variant_t          value;
+    int                     level;
+    int                     state;
+
+    size_t                  idx;
+    size_t                  nr;
+
+    /* for object and set */
+    struct rb_node         *node;
+    /* for array */
+    const void             *packed;
+    pcvrnt_packed_type_k    packed_type;
+    /* for tuple */
+    purc_variant_t         *members;
+};
+
+struct purc_variant_serializer {
+    purc_variant_t          root;
+    unsigned int            flags;
+    bool                    started;
+
+    purc_rwstream_t         rws;
+
+    /* the pending output */
+    char                   *buf;
+    size_t                  sz_buf;
+    size_t                  len;
+    size_t                  off;
+
+    /* the long string being serialized in slices */
+    const char             *str;
+    size_t                  str_len;
+    size_t                  str_pos;
+
+    struct ser_frame       *frames;
+    size_t                  sz_frames;
+    size_t                  nr_frames;
+
+    /* the variant on stack for a packed element */
+    struct purc_variant     elem;
+};
+
+static ssize_t ser_write(void *ctxt, const void *buf, size_t count)
+{
+    struct purc_variant_serializer *ser = ctxt;
+
+    if (ser->len + count > ser->sz_buf) {
+        size_t sz = ser->sz_buf ? ser->sz_buf : SZ_STRING_SLICE;
+        while (sz < ser->len + count)
+            sz *= 2;
+
+        char *p = realloc(ser->buf, sz);
+        if (p == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        ser->buf = p;
+        ser->sz_buf = sz;
+    }
+
+    memcpy(ser->buf + ser->len, buf, count);
+    ser->len += count;
+    return count;
+}
+
+static bool is_container(purc_variant_t value)
+{
+    switch (value->type) {
+    case PURC_VARIANT_TYPE_OBJECT:
+    case PURC_VARIANT_TYPE_ARRAY:
+    case PURC_VARIANT_TYPE_SET:
+    case PURC_VARIANT_TYPE_TUPLE:
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+static int ser_push(struct purc_variant_serializer *ser,
+        purc_variant_t value, int level)
+{
+    if (ser->nr_frames == ser->sz_frames) {
+        size_t sz = ser->sz_frames ? ser->sz_frames * 2 : 8;
+        struct ser_frame *p = realloc(ser->frames, sizeof(*p) * sz);
+        if (p == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        ser->frames = p;
+        ser->sz_frames = sz;
+    }
+
+    struct ser_frame *frame = ser->frames + ser->nr_frames++;
+    memset(frame, 0, sizeof(*frame));
+    frame->value = value;
+    frame->level = level;
+    frame->state = SER_STATE_OPEN;
+
+    switch (value->type) {
+    case PURC_VARIANT_TYPE_OBJECT:
+        frame->node = pcutils_rbtree_first(&pcvar_obj_get_data(value)->kvs);
+        break;
+    case PURC_VARIANT_TYPE_SET:
+        frame->node = pcutils_rbtree_first(&pcvar_set_get_data(value)->elems);
+        break;
+    case PURC_VARIANT_TYPE_ARRAY:
+        frame->packed = purc_variant_array_get_packed(value,
+                &frame->packed_type, &frame->nr);
+        if (frame->packed == NULL)
+            frame->nr = purc_variant_array_get_size(value);
+        break;
+    case PURC_VARIANT_TYPE_TUPLE:
+        frame->members = tuple_members(value, &frame->nr);
+        break;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+/* starts to serialize a value: pushes a container, or writes a scalar */
+static int ser_begin_value(struct purc_variant_serializer *ser,
+        purc_variant_t value, int level)
+{
+    unsigned int flags = ser->flags;
+    size_t *len_expected = NULL;
+    ssize_t nr_written = 0;
+
+    if (is_container(value))
+        return ser_push(ser, value, level);
+
+    if (value->type == PURC_VARIANT_TYPE_STRING) {
+        size_t len;
+        const char *str = purc_variant_get_string_const_ex(value, &len);
+        if (len > SZ_STRING_SLICE) {
+            MY_WRITE(ser->rws, "\"", 1);
+            ser->str = str;
+            ser->str_len = len;
+            ser->str_pos = 0;
+            return 0;
+        }
+    }
+
+    if (purc_variant_serialize(value, ser->rws, level, flags, NULL) < 0)
+        goto failed;
+    return 0;
+
+failed:
+    return -1;
+}
+
+static int ser_string_slice(struct purc_variant_serializer *ser)
+{
+    unsigned int flags = ser->flags;
+    size_t *len_expected = NULL;
+    ssize_t nr_written = 0, n;
+
+    /* NOTE: serialize_string() escapes byte by byte, so a slice can end
+       in the middle of a multi-byte character. */
+    size_t len = ser->str_len - ser->str_pos;
+    if (len > SZ_STRING_SLICE)
+        len = SZ_STRING_SLICE;
+
+    n = serialize_string(ser->rws, ser->str + ser->str_pos, len,
+            flags, len_expected);
+    MY_CHECK(n);
+
+    ser->str_pos += len;
+    if (ser->str_pos == ser->str_len) {
+        MY_WRITE(ser->rws, "\"", 1);
+        ser->str = NULL;
+    }
+    return 0;
+
+failed:
+    return -1;
+}
+
+static int ser_open(struct purc_variant_serializer *ser,
+        struct ser_frame *frame)
+{
+    purc_rwstream_t rws = ser->rws;
+    unsigned int flags = ser->flags;
+    size_t *len_expected = NULL;
+    ssize_t nr_written = 0, n;
+
+    n = print_indent(rws, frame->level, flags, len_expected);
+    MY_CHECK(n);
+
+    switch (frame->value->type) {
+    case PURC_VARIANT_TYPE_OBJECT:
+        MY_WRITE(rws, "{", 1);
+        break;
+    case PURC_VARIANT_TYPE_SET:
+        if (flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS)
+            MY_WRITE(rws, "[!", 2);
+        else
+            MY_WRITE(rws, "[", 1);
+        break;
+    case PURC_VARIANT_TYPE_TUPLE:
+        if (flags & PCVRNT_SERIALIZE_OPT_TUPLE_EJSON)
+            MY_WRITE(rws, "[!", 2);
+        else
+            MY_WRITE(rws, "[", 1);
+        break;
+    default:
+        MY_WRITE(rws, "[", 1);
+        break;
+    }
+
+    n = print_newline(rws, flags, len_expected);
+    MY_CHECK(n);
+
+    if (frame->value->type == PURC_VARIANT_TYPE_SET &&
+            (flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS)) {
+        variant_set_t data = pcvar_set_get_data(frame->value);
+        for (size_t i = 0; data->keynames && i < data->nr_keynames; ++i) {
+            const char *sk = data->keynames[i];
+            if (i > 0)
+                MY_WRITE(rws, " ", 1);
+            MY_WRITE(rws, sk, strlen(sk));
+        }
+    }
+
+    frame->state = SER_STATE_MEMBERS;
+    return 0;
+
+failed:
+    return -1;
+}
+
+static int ser_close(struct purc_variant_serializer *ser,
+        struct ser_frame *frame)
+{
+    purc_rwstream_t rws = ser->rws;
+    unsigned int flags = ser->flags;
+    size_t *len_expected = NULL;
+    ssize_t nr_written = 0, n;
+
+    if (frame->idx > 0) {
+        n = print_newline(rws, flags, len_expected);
+        MY_CHECK(n);
+    }
+
+    n = print_indent(rws, frame->level, flags, len_expected);
+    MY_CHECK(n);
+
+    n = print_space_no_pretty(rws, flags, len_expected);
+    MY_CHECK(n);
+
+    if (frame->value->type == PURC_VARIANT_TYPE_OBJECT)
+        MY_WRITE(rws, "}", 1);
+    else
+        MY_WRITE(rws, "]", 1);
+
+    ser->nr_frames--;
+    return 0;
+
+failed:
+    return -1;
+}
+
+/* writes the next member of the container, or closes the container */
+static int ser_member(struct purc_variant_serializer *ser,
+        struct ser_frame *frame)
+{
+    purc_rwstream_t rws = ser->rws;
+    unsigned int flags = ser->flags;
+    size_t *len_expected = NULL;
+    ssize_t nr_written = 0, n;
+    purc_variant_t key = PURC_VARIANT_INVALID, member;
+
+    switch (frame->value->type) {
+    case PURC_VARIANT_TYPE_OBJECT:
+    {
+        if (frame->node == NULL)
+            return ser_close(ser, frame);
+
+        struct obj_node *on = container_of(frame->node, struct obj_node, node);
+        key = on->key;
+        member = on->val;
+        frame->node = pcutils_rbtree_next(frame->node);
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_SET:
+    {
+        if (frame->node == NULL)
+            return ser_close(ser, frame);
+
+        struct set_node *sn = container_of(frame->node, struct set_node,
+                rbnode);
+        member = sn->val;
+        frame->node = pcutils_rbtree_next(frame->node);
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_ARRAY:
+        if (frame->idx >= frame->nr)
+            return ser_close(ser, frame);
+
+        if (frame->packed)
+            member = packed_member(&ser->elem, frame->packed_type,
+                    frame->packed, frame->idx);
+        else
+            member = purc_variant_array_get(frame->value, frame->idx);
+        break;
+
+    default:
+        if (frame->idx >= frame->nr)
+            return ser_close(ser, frame);
+
+        member = frame->members[frame->idx];
+        break;
+    }
+
+    if (frame->idx > 0 || (frame->value->type == PURC_VARIANT_TYPE_SET &&
+                (flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS))) {
+        MY_WRITE(rws, ",", 1);
+        n = print_newline(rws, flags, len_expected);
+        MY_CHECK(n);
+    }
+    frame->idx++;
+
+    n = print_space_no_pretty(rws, flags, len_expected);
+    MY_CHECK(n);
+
+    n = print_indent(rws, frame->level + 1, flags, len_expected);
+    MY_CHECK(n);
+
+    if (key) {
+        size_t len;
+        const char *ks = purc_variant_get_string_const_ex(key, &len);
+
+        MY_WRITE(rws, "\"", 1);
+        n = serialize_string(rws, ks, len, flags, len_expected);
+        MY_CHECK(n);
+        MY_WRITE(rws, "\"", 1);
+
+        MY_WRITE(rws, ":", 1);
+        n = print_space(rws, flags, len_expected);
+        MY_CHECK(n);
+    }
+
+    /* NOTE: the frame may be moved by realloc() in ser_push() */
+    return ser_begin_value(ser, member, frame->level + 1);
+
+failed:
+    return -1;
+}
+
+/* returns 1 if all data have been serialized, 0 if not, or -1 on error */
+static int ser_step(struct purc_variant_serializer *ser)
+{
+    if (ser->str)
+        return ser_string_slice(ser);
+
+    if (ser->nr_frames == 0) {
+        if (ser->started)
+            return 1;
+
+        ser->started = true;
+        return ser_begin_value(ser, ser->root, 0);
+    }
+
+    struct ser_frame *frame = ser->frames + ser->nr_frames - 1;
+    if (frame->state == SER_STATE_OPEN)
+        return ser_open(ser, frame);
+
+    return ser_member(ser, frame);
+}
+
+purc_variant_serializer_t
+purc_variant_serializer_new(purc_variant_t value, unsigned int flags)
+{
+    struct purc_variant_serializer *ser;
+
+    PCVRNT_CHECK_FAIL_RET(value, NULL);
+
+    ser = calloc(1, sizeof(*ser));
+    if (ser == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    ser->rws = purc_rwstream_new_for_dump(ser, ser_write);
+    if (ser->rws == NULL) {
+        free(ser);
+        return NULL;
+    }
+
+    /* the incremental serializer does not count the expected length */
+    ser->flags = flags & ~PCVRNT_SERIALIZE_OPT_IGNORE_ERRORS;
+    ser->root = purc_variant_ref(value);
+    return ser;
+}
+
+ssize_t
+purc_variant_serializer_read(purc_variant_serializer_t ser,
+        void *buf, size_t sz)
+{
+    size_t nr_read = 0;
+
+    while (nr_read < sz) {
+        if (ser->off < ser->len) {
+            size_t n = ser->len - ser->off;
+            if (n > sz - nr_read)
+                n = sz - nr_read;
+
+            memcpy((char *)buf + nr_read, ser->buf + ser->off, n);
+            ser->off += n;
+            nr_read += n;
+            continue;
+        }
+
+        ser->off = ser->len = 0;
+
+        int ret = ser_step(ser);
+        if (ret < 0)
+            return -1;
+        if (ret > 0)
+            break;
+    }
+
+    return nr_read;
+}
+
+bool
+purc_variant_serializer_is_done(purc_variant_serializer_t ser)
+{
+    return ser->started && ser->nr_frames == 0 && ser->str == NULL &&
+        ser->off == ser->len;
+}
+
+void
+purc_variant_serializer_destroy(purc_variant_serializer_t ser)
+{
+    purc_rwstream_destroy(ser->rws);
+    purc_variant_unref(ser->root);
+    free(ser->frames);
+    free(ser->buf);
+    free(ser);
+}
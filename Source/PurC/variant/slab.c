@@ -0,0 +1,239 @@
+/*
+ * @file slab.c
+ * @date 2026/10/14
+ * @brief The slab allocator for the variants and the nodes of containers.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc-variant.h"
+#include "private/instance.h"
+#include "private/variant.h"
+#include "private/dobject.h"
+#include "private/debug.h"
+
+#include "variant-internals.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Every variant heap (one per instance, plus the move heap) owns a set of
+ * slabs, one for each kind of chunk. A chunk is always put back to the slab
+ * of the current heap, which may be not the one it was allocated from,
+ * because a variant can be moved to another instance via the move heap.
+ *
+ * Therefore, the memory of the slabs is never released when an instance
+ * exits; the slabs are kept in a global pool and handed to the next new
+ * heap, and they are destroyed only when the process exits.
+ */
+
+#define DEF_SLAB_SIZE           256
+#define MAX_SLAB_SIZE           65536
+
+struct pcvariant_slabs {
+    struct pcvariant_slabs *next;   // the next slabs in the pool
+    pcutils_dobject_t       dobjs[PCVARIANT_SLAB_NR];
+};
+
+static const size_t chunk_sizes[PCVARIANT_SLAB_NR] = {
+    sizeof(struct purc_variant),    // PCVARIANT_SLAB_VARIANT
+    sizeof(struct purc_variant) + PCVRNT_SZ_TRAILING,
+                                    // PCVARIANT_SLAB_VARIANT_EX
+    sizeof(struct obj_node),        // PCVARIANT_SLAB_OBJ_NODE
+    sizeof(struct set_node),        // PCVARIANT_SLAB_SET_NODE
+};
+
+/* the number of chunks in a slab block; zero means the slabs are disabled */
+static size_t                   slab_size;
+
+static struct purc_mutex        pool_lock;
+static struct pcvariant_slabs  *pool;
+
+static void slabs_destroy(struct pcvariant_slabs *slabs)
+{
+    for (int i = 0; i < PCVARIANT_SLAB_NR; i++) {
+        if (slabs->dobjs[i].mem)
+            pcutils_dobject_destroy(&slabs->dobjs[i], false);
+    }
+
+    pcutils_free(slabs);
+}
+
+static void slab_cleanup_once(void)
+{
+    struct pcvariant_slabs *slabs, *next;
+    for (slabs = pool; slabs; slabs = next) {
+        next = slabs->next;
+        slabs_destroy(slabs);
+    }
+    pool = NULL;
+
+    if (pool_lock.native_impl)
+        purc_mutex_clear(&pool_lock);
+}
+
+int pcvariant_slab_init_once(void)
+{
+    slab_size = DEF_SLAB_SIZE;
+
+    const char *env = getenv(PURC_ENVV_VARIANT_SLAB_SIZE);
+    if (env) {
+        long sz = strtol(env, NULL, 10);
+        if (sz <= 0)
+            slab_size = 0;
+        else if (sz > MAX_SLAB_SIZE)
+            slab_size = MAX_SLAB_SIZE;
+        else
+            slab_size = (size_t)sz;
+    }
+
+    if (slab_size == 0)
+        return 0;
+
+    purc_mutex_init(&pool_lock);
+    if (pool_lock.native_impl == NULL)
+        return -1;
+    purc_mutex_set_name(&pool_lock, "variant-slab-pool");
+
+    if (atexit(slab_cleanup_once)) {
+        purc_mutex_clear(&pool_lock);
+        return -1;
+    }
+
+    return 0;
+}
+
+int pcvariant_slab_attach(struct pcvariant_heap *heap)
+{
+    PC_ASSERT(heap->slabs == NULL);
+
+    if (slab_size == 0)
+        return 0;
+
+    struct pcvariant_slabs *slabs = NULL;
+
+    purc_mutex_lock(&pool_lock);
+    if (pool) {
+        slabs = pool;
+        pool = slabs->next;
+    }
+    purc_mutex_unlock(&pool_lock);
+
+    if (slabs == NULL) {
+        slabs = pcutils_calloc(1, sizeof(*slabs));
+        if (slabs == NULL)
+            return -1;
+
+        for (int i = 0; i < PCVARIANT_SLAB_NR; i++) {
+            if (pcutils_dobject_init(&slabs->dobjs[i],
+                        slab_size, chunk_sizes[i])) {
+                slabs_destroy(slabs);
+                return -1;
+            }
+        }
+    }
+
+    slabs->next = NULL;
+    heap->slabs = slabs;
+    return 0;
+}
+
+void pcvariant_slab_detach(struct pcvariant_heap *heap)
+{
+    struct pcvariant_slabs *slabs = heap->slabs;
+    if (slabs == NULL)
+        return;
+
+    heap->slabs = NULL;
+
+    purc_mutex_lock(&pool_lock);
+    slabs->next = pool;
+    pool = slabs;
+    purc_mutex_unlock(&pool_lock);
+}
+
+static inline struct pcvariant_slabs *current_slabs(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->variant_heap == NULL)
+        return NULL;
+
+    return inst->variant_heap->slabs;
+}
+
+void *pcvariant_slab_alloc(enum pcvariant_slab_kind kind)
+{
+    if (slab_size == 0)
+        return pcutils_malloc(chunk_sizes[kind]);
+
+    struct pcvariant_slabs *slabs = current_slabs();
+    PC_ASSERT(slabs);
+    return pcutils_dobject_alloc(&slabs->dobjs[kind]);
+}
+
+void *pcvariant_slab_alloc_0(enum pcvariant_slab_kind kind)
+{
+    if (slab_size == 0)
+        return pcutils_calloc(1, chunk_sizes[kind]);
+
+    struct pcvariant_slabs *slabs = current_slabs();
+    PC_ASSERT(slabs);
+    return pcutils_dobject_calloc(&slabs->dobjs[kind]);
+}
+
+void pcvariant_slab_free(enum pcvariant_slab_kind kind, void *chunk)
+{
+    if (slab_size == 0) {
+        pcutils_free(chunk);
+        return;
+    }
+
+    struct pcvariant_slabs *slabs = current_slabs();
+    PC_ASSERT(slabs);
+
+    /* NOTE: if failed to cache the chunk, it is lost in the slab block,
+       but it can not be freed by calling free(). */
+    pcutils_dobject_free(&slabs->dobjs[kind], chunk);
+}
+
+void pcvariant_slab_stat(struct pcvariant_heap *heap)
+{
+    struct purc_variant_stat *stat = &heap->stat;
+
+    stat->nr_slab_blocks = 0;
+    stat->sz_slab_mem = 0;
+    stat->nr_slab_cached = 0;
+
+    struct pcvariant_slabs *slabs = heap->slabs;
+    if (slabs == NULL)
+        return;
+
+    for (int i = 0; i < PCVARIANT_SLAB_NR; i++) {
+        pcutils_dobject_t *dobj = &slabs->dobjs[i];
+        pcutils_mem_chunk_t *chunk;
+
+        for (chunk = dobj->mem->chunk_first; chunk; chunk = chunk->next) {
+            stat->nr_slab_blocks++;
+            stat->sz_slab_mem += chunk->size;
+        }
+        stat->nr_slab_cached += pcutils_dobject_cache_length(dobj);
+    }
+}
@@ -0,0 +1,234 @@
+/**
+ * @file sort.c
+ * @date 2026/10/14
+ * @brief The sort engine of the linear containers by pre-extracted keys.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+
+#include "config.h"
+#include "private/variant.h"
+#include "private/errors.h"
+#include "private/utils.h"
+#include "variant-internals.h"
+#include "purc-errors.h"
+#include "purc-utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The keys of all members are extracted into a contiguous vector before
+ * sorting, so that a comparison neither numerifies nor stringifies the
+ * members again; the original position breaks the ties to keep the sort
+ * stable.
+ */
+struct sort_rec {
+    void                           *item;
+    size_t                          idx;
+    struct pcvariant_sort_key      *keys;
+};
+
+struct sort_ctxt {
+    size_t                          nr_keys;
+    unsigned int                    flags;
+};
+
+void
+pcvariant_sort_key_number(struct pcvariant_sort_key *key,
+        purc_variant_t value)
+{
+    key->type = PCVRNT_SORT_KEY_NUMBER;
+    key->d = value ? purc_variant_numerify(value) : 0.0;
+}
+
+int
+pcvariant_sort_key_string(struct pcvariant_sort_key *key,
+        purc_variant_t value)
+{
+    key->type = PCVRNT_SORT_KEY_NONE;
+    if (value == PURC_VARIANT_INVALID)
+        return 0;
+
+    if (purc_variant_stringify_alloc(&key->s, value) < 0) {
+        key->s = NULL;
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    key->type = PCVRNT_SORT_KEY_STRING;
+    return 0;
+}
+
+static int
+compare_keys(const struct pcvariant_sort_key *l,
+        const struct pcvariant_sort_key *r, unsigned int flags)
+{
+    if (l->type != r->type || l->type == PCVRNT_SORT_KEY_NONE)
+        return 0;
+
+    if (l->type == PCVRNT_SORT_KEY_NUMBER) {
+        if (pcutils_equal_doubles(l->d, r->d))
+            return 0;
+        return l->d < r->d ? -1 : 1;
+    }
+
+    if (flags & PCVRNT_SORT_CASELESS)
+        return pcutils_strcasecmp(l->s, r->s);
+    return strcmp(l->s, r->s);
+}
+
+#if OS(HURD) || OS(LINUX)
+static int compare_recs(const void *l, const void *r, void *ud)
+#elif OS(DARWIN) || OS(FREEBSD) || OS(NETBSD) || OS(OPENBSD) || OS(WINDOWS)
+static int compare_recs(void *ud, const void *l, const void *r)
+#else
+#error Unsupported operating system.
+#endif
+{
+    const struct sort_ctxt *ctxt = ud;
+    const struct sort_rec *rl = l;
+    const struct sort_rec *rr = r;
+
+    for (size_t i = 0; i < ctxt->nr_keys; i++) {
+        int ret = compare_keys(rl->keys + i, rr->keys + i, ctxt->flags);
+        if (ret) {
+            return (ctxt->flags & PCVRNT_SORT_DESC) ? -ret : ret;
+        }
+    }
+
+    return (rl->idx < rr->idx) ? -1 : (rl->idx > rr->idx);
+}
+
+int
+pcvariant_sort_items(void **items, size_t nr,
+        purc_variant_t (*member_of)(void *item), size_t nr_keys,
+        pcvariant_sort_key_f extract, void *ud, unsigned int flags)
+{
+    if (nr <= 1 || nr_keys == 0)
+        return 0;
+
+    int ret = -1;
+    struct sort_rec *recs = malloc(sizeof(*recs) * nr);
+    struct pcvariant_sort_key *keys = calloc(nr * nr_keys, sizeof(*keys));
+    if (recs == NULL || keys == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out;
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        recs[i].item = items[i];
+        recs[i].idx = i;
+        recs[i].keys = keys + i * nr_keys;
+        if (extract(member_of(items[i]), recs[i].keys, ud))
+            goto out;
+    }
+
+    struct sort_ctxt ctxt = { nr_keys, flags };
+#if OS(HURD) || OS(LINUX)
+    qsort_r(recs, nr, sizeof(*recs), compare_recs, &ctxt);
+#elif OS(DARWIN) || OS(FREEBSD) || OS(NETBSD) || OS(OPENBSD)
+    qsort_r(recs, nr, sizeof(*recs), &ctxt, compare_recs);
+#elif OS(WINDOWS)
+    qsort_s(recs, nr, sizeof(*recs), compare_recs, &ctxt);
+#endif
+
+    for (size_t i = 0; i < nr; i++) {
+        items[i] = recs[i].item;
+    }
+    ret = 0;
+
+out:
+    if (keys) {
+        for (size_t i = 0; i < nr * nr_keys; i++) {
+            free(keys[i].s);
+        }
+        free(keys);
+    }
+    free(recs);
+    return ret;
+}
+
+static int
+extract_number(purc_variant_t member, struct pcvariant_sort_key *keys,
+        void *ud)
+{
+    UNUSED_PARAM(ud);
+    pcvariant_sort_key_number(keys, member);
+    return 0;
+}
+
+static int
+extract_string(purc_variant_t member, struct pcvariant_sort_key *keys,
+        void *ud)
+{
+    UNUSED_PARAM(ud);
+    return pcvariant_sort_key_string(keys, member);
+}
+
+static bool
+is_number_type(purc_variant_t v)
+{
+    switch (v->type) {
+    case PURC_VARIANT_TYPE_NUMBER:
+    case PURC_VARIANT_TYPE_LONGINT:
+    case PURC_VARIANT_TYPE_ULONGINT:
+    case PURC_VARIANT_TYPE_LONGDOUBLE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+pcvariant_sort_key_f
+pcvariant_sort_default_extractor(void **items, size_t nr,
+        purc_variant_t (*member_of)(void *item), uintptr_t sort_flags)
+{
+    pcvrnt_compare_method_k cmpopt;
+    cmpopt = (pcvrnt_compare_method_k)(sort_flags & PCVRNT_CMPOPT_MASK);
+
+    switch (cmpopt) {
+    case PCVRNT_COMPARE_METHOD_NUMBER:
+        return extract_number;
+
+    case PCVRNT_COMPARE_METHOD_CASE:
+    case PCVRNT_COMPARE_METHOD_CASELESS:
+        return extract_string;
+
+    case PCVRNT_COMPARE_METHOD_AUTO:
+        break;
+    }
+
+    /* NOTE: the automatic method depends on the type of the left member,
+     * so only the members all in number types or all in other types can
+     * be compared by the keys. */
+    size_t nr_numbers = 0;
+    for (size_t i = 0; i < nr; i++) {
+        if (is_number_type(member_of(items[i])))
+            nr_numbers++;
+    }
+
+    if (nr_numbers == nr)
+        return extract_number;
+    if (nr_numbers == 0)
+        return extract_string;
+    return NULL;
+}
@@ -26,7 +26,9 @@
 
 #include "config.h"
 #include "private/variant.h"
+#include "private/instance.h"
 #include "private/errors.h"
+#include "private/mem.h"
 #include "variant-internals.h"
 #include "purc-errors.h"
 #include "purc-utils.h"
@@ -36,11 +38,94 @@
 #include <stdlib.h>
 #include <string.h>
 
+
+/* the minimal capacity of the vector of elements */
+#define ARR_MIN_CAPACITY        4
+
+/* the size of a packed element: double, int64_t, or uint64_t */
+#define PACKED_ELEM_SIZE        8
+
 static size_t
 variant_arr_length(variant_arr_t data)
 {
-    struct pcutils_array_list *al = &data->al;
-    return pcutils_array_list_length(al);
+    return data->nr;
+}
+
+/* makes sure there is room for `nr` more elements in the vector */
+static int
+variant_arr_reserve(variant_arr_t data, size_t nr)
+{
+    size_t needed = data->nr + nr;
+    if (needed <= data->sz)
+        return 0;
+
+    size_t sz = data->sz ? data->sz : ARR_MIN_CAPACITY;
+    while (sz < needed)
+        sz *= 2;
+
+    purc_variant_t *vals = pcutils_realloc(data->vals, sz * sizeof(*vals));
+    if (vals == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    data->vals = vals;
+    data->sz = sz;
+    return 0;
+}
+
+/* takes the element out of the vector; the reference is kept by caller */
+static purc_variant_t
+variant_arr_take(variant_arr_t data, size_t idx)
+{
+    purc_variant_t val = data->vals[idx];
+
+    data->nr--;
+    memmove(data->vals + idx, data->vals + idx + 1,
+            (data->nr - idx) * sizeof(*data->vals));
+    return val;
+}
+
+static bool
+variant_arr_contains(variant_arr_t data, purc_variant_t val)
+{
+    for (size_t i = 0; i < data->nr; i++) {
+        if (data->vals[i] == val)
+            return true;
+    }
+
+    return false;
+}
+
+/* makes the shared vector of elements private before changing it */
+static int
+variant_arr_unshare(variant_arr_t data)
+{
+    if (data->sharers == NULL)
+        return 0;
+
+    if (*data->sharers == 1) {
+        /* the other sharers have gone */
+        pcutils_free(data->sharers);
+        data->sharers = NULL;
+        return 0;
+    }
+
+    size_t sz = data->nr > ARR_MIN_CAPACITY ? data->nr : ARR_MIN_CAPACITY;
+    purc_variant_t *vals = pcutils_malloc(sz * sizeof(*vals));
+    if (vals == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    for (size_t i = 0; i < data->nr; i++)
+        vals[i] = purc_variant_ref(data->vals[i]);
+
+    (*data->sharers)--;
+    data->sharers = NULL;
+    data->vals = vals;
+    data->sz = sz;
+    return 0;
 }
 
 static inline bool
@@ -123,6 +208,7 @@ changed(purc_variant_t arr, purc_variant_t pos,
             PCA_TABLESIZE(vals), vals);
 }
 
+
 variant_arr_t
 pcvar_arr_get_data(purc_variant_t arr)
 {
@@ -130,82 +216,134 @@ pcvar_arr_get_data(purc_variant_t arr)
 }
 
 static void
-break_rev_update_chain(purc_variant_t arr, struct arr_node *node)
+refresh_extra(purc_variant_t arr)
 {
-    struct pcvar_rev_update_edge edge = {
-        .parent        = arr,
-        .arr_me        = node,
-    };
-
-    pcvar_break_edge_to_parent(node->val, &edge);
-    pcvar_break_rue_downward(node->val);
+    size_t extra = 0;
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    if (data) {
+        extra += sizeof(*data);
+        extra += data->sz * sizeof(*data->vals);
+        if (data->packed)
+            extra += data->nr * PACKED_ELEM_SIZE;
+    }
+    pcvariant_stat_set_extra_size(arr, extra);
 }
 
-static void
-arr_node_release(purc_variant_t arr, struct arr_node *node)
+static purc_variant_t
+make_packed_elem(pcvrnt_packed_type_k type, const void *packed, size_t idx)
 {
-    if (!node)
-        return;
-
-    break_rev_update_chain(arr, node);
+    switch (type) {
+    case PCVRNT_PACKED_NUMBER:
+        return purc_variant_make_number(((const double *)packed)[idx]);
+    case PCVRNT_PACKED_LONGINT:
+        return purc_variant_make_longint(((const int64_t *)packed)[idx]);
+    case PCVRNT_PACKED_ULONGINT:
+        return purc_variant_make_ulongint(((const uint64_t *)packed)[idx]);
+    default:
+        PC_ASSERT(0);
+        break;
+    }
 
-    if (node->node.idx != (size_t)-1) {
-        variant_arr_t data = pcvar_arr_get_data(arr);
-        PC_ASSERT(data);
+    return PURC_VARIANT_INVALID;
+}
 
-        struct pcutils_array_list *al = &data->al;
-        PC_ASSERT(al);
+static int
+variant_arr_box(purc_variant_t arr, variant_arr_t data)
+{
+    size_t nr = data->nr;
+    size_t sz = nr > ARR_MIN_CAPACITY ? nr : ARR_MIN_CAPACITY;
+    purc_variant_t *vals = pcutils_malloc(sz * sizeof(*vals));
+    if (vals == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
 
-        struct pcutils_array_list_node *p;
-        int r = pcutils_array_list_remove(al, node->node.idx, &p);
-        PC_ASSERT(r == 0);
-        PC_ASSERT(&node->node == p);
-        PC_ASSERT(node->node.idx == (size_t)-1);
+    for (size_t i = 0; i < nr; i++) {
+        vals[i] = make_packed_elem(data->packed_type, data->packed, i);
+        if (vals[i] == PURC_VARIANT_INVALID) {
+            while (i > 0)
+                purc_variant_unref(vals[--i]);
+            pcutils_free(vals);
+            return -1;
+        }
     }
 
-    PURC_VARIANT_SAFE_CLEAR(node->val);
+    pcutils_free(data->packed);
+    data->packed = NULL;
+    data->packed_type = PCVRNT_PACKED_NONE;
+    data->vals = vals;
+    data->sz = sz;
+
+    refresh_extra(arr);
+    return 0;
 }
 
-static void
-arr_node_destroy(purc_variant_t arr, struct arr_node *node)
+variant_arr_t
+pcvariant_array_boxed_data(purc_variant_t arr)
 {
-    if (!node)
-        return;
+    variant_arr_t data = pcvar_arr_get_data(arr);
 
-    arr_node_release(arr, node);
-    free(node);
+    if (UNLIKELY(data->packed) && variant_arr_box(arr, data)) {
+        /* NOTE: out of memory; drop the elements rather than
+           exposing the packed buffer as variants. */
+        pcutils_free(data->packed);
+        data->packed = NULL;
+        data->packed_type = PCVRNT_PACKED_NONE;
+        data->nr = 0;
+        refresh_extra(arr);
+    }
+
+    return data;
 }
 
-static purc_variant_t
-variant_arr_make_pos(variant_arr_t data, size_t idx)
+variant_arr_t
+pcvariant_array_writable_data(purc_variant_t arr)
 {
-    size_t len = variant_arr_length(data);
-    if (idx > len)
-        idx = len;
+    variant_arr_t data = pcvariant_array_boxed_data(arr);
+    if (variant_arr_unshare(data))
+        return NULL;
 
-    return purc_variant_make_longint(idx);
+    return data;
 }
 
-static struct arr_node*
-arr_node_create(purc_variant_t val)
+/* `check_dup`: keep the edge to the array if `val` still occurs in it */
+static void
+break_rev_update_chain(purc_variant_t arr, purc_variant_t val,
+        bool check_dup)
 {
-    struct arr_node *node;
-    node = (struct arr_node*)calloc(1, sizeof(*node));
-    if (!node) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return NULL;
+    if (!check_dup || !IS_CONTAINER(val->type) ||
+            !variant_arr_contains(pcvar_arr_get_data(arr), val)) {
+        struct pcvar_rev_update_edge edge = {
+            .parent        = arr,
+            .arr_me        = arr,
+        };
+
+        pcvar_break_edge_to_parent(val, &edge);
     }
 
-    node->node.idx = (size_t)-1;
+    pcvar_break_rue_downward(val);
+}
 
-    node->val = val;
-    purc_variant_ref(val);
+/* makes the position argument for the listeners; `*pos` is left invalid
+   if there is no listener or no need to check, and nothing to do */
+static int
+variant_arr_make_pos(purc_variant_t arr, variant_arr_t data, size_t idx,
+        bool check, purc_variant_t *pos)
+{
+    *pos = PURC_VARIANT_INVALID;
+    if (!check || !(arr->flags & PCVRNT_FLAG_LISTENED))
+        return 0;
 
-    return node;
+    size_t len = variant_arr_length(data);
+    if (idx > len)
+        idx = len;
+
+    *pos = purc_variant_make_longint(idx);
+    return (*pos == PURC_VARIANT_INVALID) ? -1 : 0;
 }
 
 static int
-build_rev_update_chain(purc_variant_t arr, struct arr_node *node)
+build_rev_update_chain(purc_variant_t arr, purc_variant_t val)
 {
     if (!pcvar_container_belongs_to_set(arr))
         return 0;
@@ -214,12 +352,12 @@ build_rev_update_chain(purc_variant_t arr, struct arr_node *node)
 
     struct pcvar_rev_update_edge edge = {
         .parent        = arr,
-        .arr_me        = node,
+        .arr_me        = arr,
     };
 
-    r = pcvar_build_edge_to_parent(node->val, &edge);
+    r = pcvar_build_edge_to_parent(val, &edge);
     if (r == 0) {
-        r = pcvar_build_rue_downward(node->val);
+        r = pcvar_build_rue_downward(val);
     }
 
     return r ? -1 : 0;
@@ -277,22 +415,17 @@ variant_arr_insert_before(purc_variant_t arr, size_t idx, purc_variant_t val,
         return 0;
     }
 
-    variant_arr_t data = pcvar_arr_get_data(arr);
+    variant_arr_t data = pcvariant_array_boxed_data(arr);
     PC_ASSERT(data);
 
-    struct pcutils_array_list *al = &data->al;
-    PC_ASSERT(al);
-
-    size_t nr = pcutils_array_list_length(al);
+    size_t nr = variant_arr_length(data);
     if (idx > nr)
         idx = nr;
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
+    purc_variant_t pos;
+    if (variant_arr_make_pos(arr, data, idx, check, &pos))
         return -1;
 
-    struct arr_node *node = NULL;
-
     do {
         if (check) {
             if (!grow(arr, pos, val, check))
@@ -302,60 +435,42 @@ variant_arr_insert_before(purc_variant_t arr, size_t idx, purc_variant_t val,
                 break;
         }
 
-        node = arr_node_create(val);
-        if (!node)
+        if (variant_arr_unshare(data) || variant_arr_reserve(data, 1))
             break;
 
-        int r;
-        PC_ASSERT(node->node.idx == (size_t)-1);
-        r = pcutils_array_list_insert_before(al, idx, &node->node);
-        if (r) {
-            PC_ASSERT(node->node.idx == (size_t)-1);
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            break;
-        }
-        PC_ASSERT(node->node.idx != (size_t)-1);
+        memmove(data->vals + idx + 1, data->vals + idx,
+                (nr - idx) * sizeof(*data->vals));
+        data->vals[idx] = purc_variant_ref(val);
+        data->nr++;
 
         if (check) {
-            if (build_rev_update_chain(arr, node))
+            if (build_rev_update_chain(arr, val)) {
+                variant_arr_take(data, idx);
+                break_rev_update_chain(arr, val, true);
+                purc_variant_unref(val);
                 break;
+            }
 
             pcvar_adjust_set_by_descendant(arr);
             grown(arr, pos, val, check);
         }
 
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
-    arr_node_destroy(arr, node);
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
 
-static void
-refresh_extra(purc_variant_t arr)
-{
-    size_t extra = 0;
-    variant_arr_t data = pcvar_arr_get_data(arr);
-    if (data) {
-        extra += sizeof(*data);
-        struct pcutils_array_list *al = &data->al;
-        extra += al->sz * sizeof(*al->nodes);
-        extra += al->nr * sizeof(struct arr_node);
-    }
-    pcvariant_stat_set_extra_size(arr, extra);
-}
-
 static int
 variant_arr_append(purc_variant_t arr, purc_variant_t val,
         bool check)
 {
     variant_arr_t data = pcvar_arr_get_data(arr);
-    struct pcutils_array_list *al = &data->al;
-    size_t nr = pcutils_array_list_length(al);
+    size_t nr = variant_arr_length(data);
     int r = variant_arr_insert_before(arr, nr, val, check);
     refresh_extra(arr);
     return r ? -1 : 0;
@@ -371,19 +486,14 @@ variant_arr_prepend(purc_variant_t arr, purc_variant_t val,
 static purc_variant_t
 variant_arr_get(variant_arr_t data, size_t idx)
 {
-    struct pcutils_array_list *al = &data->al;
-    struct pcutils_array_list_node *p;
-    p = pcutils_array_list_get(al, idx);
-    if (p == NULL)
+    if (idx >= data->nr)
         return PURC_VARIANT_INVALID;
 
-    struct arr_node *node;
-    node = (struct arr_node*)container_of(p, struct arr_node, node);
-    return node->val;
+    return data->vals[idx];
 }
 
 static int
-check_change(purc_variant_t arr, struct arr_node *node, purc_variant_t val)
+check_change(purc_variant_t arr, size_t idx, purc_variant_t val)
 {
     if (!pcvar_container_belongs_to_set(arr))
         return 0;
@@ -398,10 +508,10 @@ check_change(purc_variant_t arr, struct arr_node *node, purc_variant_t val)
         size_t i;
         purc_variant_t v;
         foreach_value_in_variant_array(arr, v, i) {
-            if (i == node->node.idx) {
+            if (i == idx) {
                 found = true;
             }
-            r = pcvar_arr_append(_new, i == node->node.idx ? val : v);
+            r = pcvar_arr_append(_new, i == idx ? val : v);
             if (r)
                 break;
         } end_foreach;
@@ -428,57 +538,51 @@ static int
 variant_arr_set(purc_variant_t arr, size_t idx, purc_variant_t val,
         bool check)
 {
-    variant_arr_t data = pcvar_arr_get_data(arr);
+    variant_arr_t data = pcvariant_array_boxed_data(arr);
     PC_ASSERT(data);
 
-    struct pcutils_array_list *al = &data->al;
-    PC_ASSERT(al);
-
-    size_t nr = pcutils_array_list_length(al);
+    size_t nr = variant_arr_length(data);
     if (idx >= nr) {
         purc_set_error(PURC_ERROR_OVERFLOW);
         return -1;
     }
 
-    struct pcutils_array_list_node *p;
-    p = pcutils_array_list_get(al, idx);
-    PC_ASSERT(p);
-
-    struct arr_node *old_node;
-    old_node = (struct arr_node*)container_of(p, struct arr_node, node);
-    PC_ASSERT(old_node->val != PURC_VARIANT_INVALID);
-    if (old_node->val == val) {
+    purc_variant_t old = data->vals[idx];
+    PC_ASSERT(old != PURC_VARIANT_INVALID);
+    if (old == val) {
         // NOTE: keep refc intact
         return 0;
     }
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
+    purc_variant_t pos;
+    if (variant_arr_make_pos(arr, data, idx, check, &pos))
         return -1;
 
     do {
-        purc_variant_t old = old_node->val;
-
         if (check) {
             if (!change(arr, pos, old, val, check))
                 break;
 
-            if (check_change(arr, old_node, val))
+            if (check_change(arr, idx, val))
                 break;
+        }
 
-            old_node->val = val;
+        if (variant_arr_unshare(data))
+            break;
 
-            if (build_rev_update_chain(arr, old_node)) {
-                break_rev_update_chain(arr, old_node);
-                old_node->val = old;
+        if (check) {
+            data->vals[idx] = val;
+
+            if (build_rev_update_chain(arr, val)) {
+                data->vals[idx] = old;
+                break_rev_update_chain(arr, val, true);
                 break;
             }
 
-            old_node->val = old;
-            break_rev_update_chain(arr, old_node);
+            break_rev_update_chain(arr, old, true);
         }
 
-        old_node->val = purc_variant_ref(val);
+        data->vals[idx] = purc_variant_ref(val);
 
         if (check) {
             pcvar_adjust_set_by_descendant(arr);
@@ -487,18 +591,18 @@ variant_arr_set(purc_variant_t arr, size_t idx, purc_variant_t val,
         }
 
         purc_variant_unref(old);
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
 
 static int
-check_shrink(purc_variant_t arr, struct arr_node *node)
+check_shrink(purc_variant_t arr, size_t idx)
 {
     if (!pcvar_container_belongs_to_set(arr))
         return 0;
@@ -513,7 +617,7 @@ check_shrink(purc_variant_t arr, struct arr_node *node)
         size_t i;
         purc_variant_t v;
         foreach_value_in_variant_array(arr, v, i) {
-            if (i == node->node.idx) {
+            if (i == idx) {
                 PC_ASSERT(!found);
                 found = true;
                 continue;
@@ -545,60 +649,50 @@ static int
 variant_arr_remove(purc_variant_t arr, size_t idx,
         bool check)
 {
-    variant_arr_t data = pcvar_arr_get_data(arr);
+    variant_arr_t data = pcvariant_array_boxed_data(arr);
     PC_ASSERT(data);
 
-    struct pcutils_array_list *al = &data->al;
-    PC_ASSERT(al);
-
-    size_t nr = pcutils_array_list_length(al);
+    size_t nr = variant_arr_length(data);
     if (idx >= nr) {
         // FIXME: failure or success???
         return 0;
     }
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
+    purc_variant_t pos;
+    if (variant_arr_make_pos(arr, data, idx, check, &pos))
         return -1;
 
-    struct pcutils_array_list_node *p, *n;
-    p = pcutils_array_list_get(al, idx);
-    PC_ASSERT(p);
-
-    struct arr_node *node;
-    node = (struct arr_node*)container_of(p, struct arr_node, node);
-    PC_ASSERT(node->val);
+    purc_variant_t val = data->vals[idx];
+    PC_ASSERT(val);
 
     do {
         if (check) {
-            if (!shrink(arr, pos, node->val, check))
+            if (!shrink(arr, pos, val, check))
                 break;
 
-            if (check_shrink(arr, node))
+            if (check_shrink(arr, idx))
                 break;
-
-            break_rev_update_chain(arr, node);
         }
 
-        PC_ASSERT(node->node.idx != (size_t)-1);
-        int r = pcutils_array_list_remove(al, idx, &n);
-        PC_ASSERT(r == 0);
-        PC_ASSERT(&node->node == n);
-        PC_ASSERT(node->node.idx == (size_t)-1);
+        if (variant_arr_unshare(data))
+            break;
+
+        variant_arr_take(data, idx);
+        break_rev_update_chain(arr, val, true);
 
         if (check) {
             pcvar_adjust_set_by_descendant(arr);
 
-            shrunk(arr, pos, node->val, check);
+            shrunk(arr, pos, val, check);
         }
 
-        arr_node_destroy(arr, node);
-        purc_variant_unref(pos);
+        purc_variant_unref(val);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
@@ -610,20 +704,33 @@ array_release (purc_variant_t arr)
     if (!data)
         return;
 
-    struct pcutils_array_list *al = &data->al;
-    struct arr_node *p, *n;
-    array_list_for_each_entry_reverse_safe(al, p, n, node) {
-        arr_node_destroy(arr, p);
-    };
+    /* the elements are owned by the last one of the sharers */
+    bool owner = true;
+    if (data->sharers) {
+        if (--(*data->sharers) > 0)
+            owner = false;
+        else
+            pcutils_free(data->sharers);
+        data->sharers = NULL;
+    }
+
+    while (data->nr > 0) {
+        purc_variant_t val = data->vals[--data->nr];
+        break_rev_update_chain(arr, val, false);
+        if (owner)
+            purc_variant_unref(val);
+    }
 
-    pcutils_array_list_reset(al);
+    if (owner)
+        pcutils_free(data->vals);
+    pcutils_free(data->packed);
 
     if (data->rev_update_chain) {
         pcvar_destroy_rev_update_chain(data->rev_update_chain);
         data->rev_update_chain = NULL;
     }
 
-    free(data);
+    pcutils_free(data);
     arr->sz_ptr[1] = (uintptr_t)NULL;
 
     pcvariant_stat_set_extra_size(arr, 0);
@@ -642,23 +749,14 @@ make_array(size_t sz)
         var->flags         = PCVRNT_FLAG_EXTRA_SIZE;
         var->refc          = 1;
 
-        size_t initial_size = ARRAY_LIST_DEFAULT_SIZE;
-        if (sz>initial_size)
-            initial_size = sz;
-
-        variant_arr_t data = (variant_arr_t)calloc(1, sizeof(*data));
+        variant_arr_t data = (variant_arr_t)pcutils_calloc(1, sizeof(*data));
         if (!data) {
             pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
             break;
         }
 
-        struct pcutils_array_list *al;
-        al = &data->al;
-        pcutils_array_list_init(al);
-        if (pcutils_array_list_expand(al, initial_size)) {
-            pcutils_array_list_reset(al);
-            free(data);
-            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        if (sz > 0 && variant_arr_reserve(data, sz)) {
+            pcutils_free(data);
             break;
         }
 
@@ -754,6 +852,62 @@ purc_variant_t purc_variant_make_array (size_t sz, purc_variant_t value0, ...)
     return v;
 }
 
+purc_variant_t
+purc_variant_make_packed_array(pcvrnt_packed_type_k type,
+        const void *elems, size_t nr)
+{
+    PCVRNT_CHECK_FAIL_RET(type > PCVRNT_PACKED_NONE &&
+            type <= PCVRNT_PACKED_ULONGINT, PURC_VARIANT_INVALID);
+
+    purc_variant_t var = make_array(0);
+    if (var == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (nr == 0)
+        return var;
+
+    variant_arr_t data = pcvar_arr_get_data(var);
+    if (elems) {
+        data->packed = pcutils_malloc(nr * PACKED_ELEM_SIZE);
+        if (data->packed)
+            memcpy(data->packed, elems, nr * PACKED_ELEM_SIZE);
+    }
+    else {
+        data->packed = pcutils_calloc(nr, PACKED_ELEM_SIZE);
+    }
+
+    if (data->packed == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        purc_variant_unref(var);
+        return PURC_VARIANT_INVALID;
+    }
+
+    data->packed_type = type;
+    data->nr = nr;
+    refresh_extra(var);
+
+    return var;
+}
+
+const void *
+purc_variant_array_get_packed(purc_variant_t arr,
+        pcvrnt_packed_type_k *type, size_t *nr)
+{
+    PC_ASSERT(type);
+    *type = PCVRNT_PACKED_NONE;
+
+    PCVRNT_CHECK_FAIL_RET(arr && arr->type==PVT(_ARRAY), NULL);
+
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    if (data->packed == NULL)
+        return NULL;
+
+    *type = data->packed_type;
+    if (nr)
+        *nr = data->nr;
+    return data->packed;
+}
+
 void pcvariant_array_release (purc_variant_t value)
 {
     pcvariant_on_post_fired(value, PCVAR_OPERATION_RELEASING, 0, NULL);
@@ -809,7 +963,7 @@ purc_variant_t purc_variant_array_get (purc_variant_t arr, size_t idx)
     PCVRNT_CHECK_FAIL_RET(arr && arr->type==PVT(_ARRAY),
         PURC_VARIANT_INVALID);
 
-    variant_arr_t data = pcvar_arr_get_data(arr);
+    variant_arr_t data = pcvariant_array_boxed_data(arr);
 
     return variant_arr_get(data, idx);
 }
@@ -871,16 +1025,16 @@ struct arr_user_data {
     void *ud;
 };
 
-static int
-sort_cmp(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
-        void *ud)
+#if OS(HURD) || OS(LINUX)
+static int sort_cmp(const void *l, const void *r, void *ud)
+#elif OS(DARWIN) || OS(FREEBSD) || OS(NETBSD) || OS(OPENBSD) || OS(WINDOWS)
+static int sort_cmp(void *ud, const void *l, const void *r)
+#else
+#error Unsupported operating system.
+#endif
 {
-    struct arr_node *l_n, *r_n;
-    l_n = container_of(l, struct arr_node, node);
-    r_n = container_of(r, struct arr_node, node);
-
     struct arr_user_data *d = (struct arr_user_data*)ud;
-    return d->cmp(l_n->val, r_n->val, d->ud);
+    return d->cmp(*(purc_variant_t *)l, *(purc_variant_t *)r, d->ud);
 }
 
 static int vrtcmp(purc_variant_t l, purc_variant_t r, void *ud)
@@ -897,13 +1051,32 @@ static int vrtcmp(purc_variant_t l, purc_variant_t r, void *ud)
     return retv;
 }
 
+static purc_variant_t array_member_of(void *item)
+{
+    return (purc_variant_t)item;
+}
+
 int pcvariant_array_sort(purc_variant_t arr, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud))
 {
     if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
         return -1;
 
-    variant_arr_t data = pcvar_arr_get_data(arr);
+    variant_arr_t data = pcvariant_array_writable_data(arr);
+    if (data == NULL)
+        return -1;
+
+    if (cmp == NULL) {
+        /* NOTE: the default comparisons are done on the extracted keys */
+        uintptr_t sort_flags = (uintptr_t)ud;
+        pcvariant_sort_key_f extract = pcvariant_sort_default_extractor(
+                (void **)data->vals, data->nr, array_member_of, sort_flags);
+        if (extract) {
+            return pcvariant_sort_items((void **)data->vals, data->nr,
+                    array_member_of, 1, extract, NULL,
+                    pcvariant_sort_flags_of(sort_flags));
+        }
+    }
 
     struct arr_user_data d = {
         .cmp = cmp,
@@ -914,15 +1087,100 @@ int pcvariant_array_sort(purc_variant_t arr, void *ud,
         d.cmp = vrtcmp;
     }
 
-    pcutils_array_list_sort(&data->al, &d, sort_cmp);
+#if OS(HURD) || OS(LINUX)
+    qsort_r(data->vals, data->nr, sizeof(*data->vals), sort_cmp, &d);
+#elif OS(DARWIN) || OS(FREEBSD) || OS(NETBSD) || OS(OPENBSD)
+    qsort_r(data->vals, data->nr, sizeof(*data->vals), &d, sort_cmp);
+#elif OS(WINDOWS)
+    qsort_s(data->vals, data->nr, sizeof(*data->vals), sort_cmp, &d);
+#endif
 
     return 0;
 }
 
+int pcvariant_array_sort_by_keys(purc_variant_t arr, size_t nr_keys,
+        pcvariant_sort_key_f extract, void *ud, unsigned int flags)
+{
+    if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
+        return -1;
+
+    variant_arr_t data = pcvariant_array_writable_data(arr);
+    if (data == NULL)
+        return -1;
+
+    return pcvariant_sort_items((void **)data->vals, data->nr,
+            array_member_of, nr_keys, extract, ud, flags);
+}
+
+/*
+ * A clone shares the vector of elements with the source array until one of
+ * them changes it. A recursive clone shares the elements only if there
+ * is no container among them, because a container element could be changed
+ * via its own handle without the knowledge of the array.
+ */
+static bool
+can_share_elements(variant_arr_t data, bool recursively)
+{
+    struct pcinst *inst = pcinst_current();
+
+    /* the variants in the move heap may be used by other instances */
+    if (data->nr == 0 || inst == NULL ||
+            inst->variant_heap != inst->org_vrt_heap)
+        return false;
+
+    if (recursively) {
+        for (size_t i = 0; i < data->nr; i++) {
+            if (IS_CONTAINER(data->vals[i]->type))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static purc_variant_t
+make_sharing_array(purc_variant_t arr)
+{
+    variant_arr_t data = pcvar_arr_get_data(arr);
+
+    if (data->sharers == NULL) {
+        data->sharers = pcutils_malloc(sizeof(*data->sharers));
+        if (data->sharers == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return PURC_VARIANT_INVALID;
+        }
+        *data->sharers = 1;
+    }
+
+    purc_variant_t var = make_array(0);
+    if (var == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    variant_arr_t cloned = pcvar_arr_get_data(var);
+    cloned->vals = data->vals;
+    cloned->nr = data->nr;
+    cloned->sz = data->sz;
+    cloned->sharers = data->sharers;
+    (*data->sharers)++;
+
+    refresh_extra(var);
+    return var;
+}
+
 purc_variant_t
 pcvariant_array_clone(purc_variant_t arr, bool recursively)
 {
     purc_variant_t var;
+
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    if (data->packed) {
+        return purc_variant_make_packed_array(data->packed_type,
+                data->packed, data->nr);
+    }
+
+    if (can_share_elements(data, recursively))
+        return make_sharing_array(arr);
+
     var = purc_variant_make_array(0, PURC_VARIANT_INVALID);
     if (var == PURC_VARIANT_INVALID)
         return PURC_VARIANT_INVALID;
@@ -961,17 +1219,17 @@ pcvar_array_break_rue_downward(purc_variant_t arr)
     PC_ASSERT(purc_variant_is_array(arr));
 
     variant_arr_t data = pcvar_arr_get_data(arr);
-    if (!data)
+    if (!data || data->packed)
         return;
 
-    struct arr_node *p;
-    foreach_in_variant_array(arr, p) {
-        struct pcvar_rev_update_edge edge = {
-            .parent         = arr,
-            .arr_me         = p,
-        };
-        pcvar_break_edge_to_parent(p->val, &edge);
-        pcvar_break_rue_downward(p->val);
+    struct pcvar_rev_update_edge edge = {
+        .parent         = arr,
+        .arr_me         = arr,
+    };
+
+    for (size_t i = 0; i < data->nr; i++) {
+        pcvar_break_edge_to_parent(data->vals[i], &edge);
+        pcvar_break_rue_downward(data->vals[i]);
     }
 }
 
@@ -996,19 +1254,19 @@ pcvar_array_build_rue_downward(purc_variant_t arr)
     PC_ASSERT(purc_variant_is_array(arr));
 
     variant_arr_t data = pcvar_arr_get_data(arr);
-    if (!data)
+    if (!data || data->packed)
         return 0;
 
-    struct arr_node *p;
-    foreach_in_variant_array(arr, p) {
-        struct pcvar_rev_update_edge edge = {
-            .parent         = arr,
-            .arr_me         = p,
-        };
-        int r = pcvar_build_edge_to_parent(p->val, &edge);
+    struct pcvar_rev_update_edge edge = {
+        .parent         = arr,
+        .arr_me         = arr,
+    };
+
+    for (size_t i = 0; i < data->nr; i++) {
+        int r = pcvar_build_edge_to_parent(data->vals[i], &edge);
         if (r)
             return -1;
-        r = pcvar_build_rue_downward(p->val);
+        r = pcvar_build_rue_downward(data->vals[i]);
         if (r)
             return -1;
     }
@@ -1043,67 +1301,19 @@ pcvar_array_build_edge_to_parent(purc_variant_t arr,
     return r ? -1 : 0;
 }
 
-static struct pcutils_array_list_node*
-next_node(struct pcutils_array_list *al, struct pcutils_array_list_node *node)
-{
-    if (!node)
-        return NULL;
-    size_t count = pcutils_array_list_length(al);
-    size_t idx = node->idx + 1;
-    if (idx >= count)
-        return NULL;
-
-    return pcutils_array_list_get(al, idx);
-}
-
-static struct pcutils_array_list_node*
-prev_node(struct pcutils_array_list *al, struct pcutils_array_list_node *node)
-{
-    if (!node)
-        return NULL;
-    if (node->idx == 0)
-        return NULL;
-
-    size_t count = pcutils_array_list_length(al);
-    size_t idx = node->idx - 1;
-    if (idx >= count)
-        return NULL;
-
-    return pcutils_array_list_get(al, idx);
-}
-
 static void
-it_refresh(struct arr_iterator *it,
-        struct pcutils_array_list *al,
-        struct pcutils_array_list_node *curr)
-{
-    struct pcutils_array_list_node *next  = NULL;
-    struct pcutils_array_list_node *prev  = NULL;
-    if (curr) {
-        next  = next_node(al, curr);
-        prev  = prev_node(al, curr);
-    }
+it_refresh(struct arr_iterator *it, size_t idx)
+{
+    variant_arr_t data = pcvariant_array_boxed_data(it->arr);
 
-    if (curr) {
-        it->curr = container_of(curr, struct arr_node, node);
+    if (idx < data->nr) {
+        it->idx = idx;
+        it->curr = data->vals[idx];
     }
     else {
+        it->idx = 0;
         it->curr = NULL;
     }
-
-    if (next) {
-        it->next = container_of(next, struct arr_node, node);
-    }
-    else {
-        it->next = NULL;
-    }
-
-    if (prev) {
-        it->prev = container_of(prev, struct arr_node, node);
-    }
-    else {
-        it->prev = NULL;
-    }
 }
 
 struct arr_iterator
@@ -1115,17 +1325,7 @@ pcvar_arr_it_first(purc_variant_t arr)
     if (arr == PURC_VARIANT_INVALID)
         return it;
 
-    variant_arr_t data = pcvar_arr_get_data(arr);
-    size_t count = variant_arr_length(data);
-    if (count == 0)
-        return it;
-
-    struct pcutils_array_list *al = &data->al;
-
-    struct pcutils_array_list_node *first;
-    first = pcutils_array_list_get_first(al);
-
-    it_refresh(&it, al, first);
+    it_refresh(&it, 0);
 
     return it;
 }
@@ -1139,17 +1339,9 @@ pcvar_arr_it_last(purc_variant_t arr)
     if (arr == PURC_VARIANT_INVALID)
         return it;
 
-    variant_arr_t data = pcvar_arr_get_data(arr);
-    size_t count = variant_arr_length(data);
-    if (count == 0)
-        return it;
-
-    struct pcutils_array_list *al = &data->al;
-
-    struct pcutils_array_list_node *last;
-    last = pcutils_array_list_get_last(al);
-
-    it_refresh(&it, al, last);
+    variant_arr_t data = pcvariant_array_boxed_data(arr);
+    if (data->nr > 0)
+        it_refresh(&it, data->nr - 1);
 
     return it;
 }
@@ -1160,20 +1352,7 @@ pcvar_arr_it_next(struct arr_iterator *it)
     if (it->curr == NULL)
         return;
 
-    if (it->next) {
-        variant_arr_t data = pcvar_arr_get_data(it->arr);
-        struct pcutils_array_list *al = &data->al;
-
-        struct pcutils_array_list_node *next;
-        next = &it->next->node;
-
-        it_refresh(it, al, next);
-    }
-    else {
-        it->curr = NULL;
-        it->next = NULL;
-        it->prev = NULL;
-    }
+    it_refresh(it, it->idx + 1);
 }
 
 void
@@ -1182,20 +1361,8 @@ pcvar_arr_it_prev(struct arr_iterator *it)
     if (it->curr == NULL)
         return;
 
-    if (it->prev) {
-        variant_arr_t data = pcvar_arr_get_data(it->arr);
-        struct pcutils_array_list *al = &data->al;
-
-        struct pcutils_array_list_node *prev;
-        prev = &it->prev->node;
-
-        it_refresh(it, al, prev);
-    }
-    else {
+    if (it->idx > 0)
+        it_refresh(it, it->idx - 1);
+    else
         it->curr = NULL;
-        it->next = NULL;
-        it->prev = NULL;
-    }
 }
-
-
@@ -49,6 +49,13 @@ extern "C" {
  */
 void pcvariant_stat_set_extra_size(purc_variant_t v, size_t sz) WTF_INTERNAL;
 
+/* Track the peak of the memory used; call it after sz_total_mem grew. */
+static inline void pcvariant_stat_update_max_mem(struct purc_variant_stat *stat)
+{
+    if (stat->sz_total_mem > stat->sz_max_mem)
+        stat->sz_max_mem = stat->sz_total_mem;
+}
+
 /* Allocate a variant for the specific type. */
 purc_variant_t pcvariant_get (enum purc_variant_type type) WTF_INTERNAL;
 
@@ -60,6 +67,41 @@ purc_variant_t pcvariant_get (enum purc_variant_type type) WTF_INTERNAL;
  */
 void pcvariant_put(purc_variant_t value) WTF_INTERNAL;
 
+/*
+ * Allocate a variant for the specific type, which is followed by
+ * PCVRNT_SZ_TRAILING bytes in the same chunk. The flag PCVRNT_FLAG_TRAILING
+ * is set in the new variant, and the caller should keep it.
+ */
+purc_variant_t pcvariant_get_trailing(enum purc_variant_type type) WTF_INTERNAL;
+
+static inline void *pcvariant_trailing(purc_variant_t value)
+{
+    return value + 1;
+}
+
+/*
+ * Sorts the items of a vector stably by the keys of their members; used by
+ * pcvariant_array_sort_by_keys() and pcvariant_set_sort_by_keys().
+ */
+int pcvariant_sort_items(void **items, size_t nr,
+        purc_variant_t (*member_of)(void *item), size_t nr_keys,
+        pcvariant_sort_key_f extract, void *ud,
+        unsigned int flags) WTF_INTERNAL;
+
+/* the flags of pcvariant_sort_items() for the sort_flags of a default sort */
+static inline unsigned int pcvariant_sort_flags_of(uintptr_t sort_flags)
+{
+    unsigned int flags = sort_flags & PCVRNT_SORT_DESC;
+    if ((sort_flags & PCVRNT_CMPOPT_MASK) == PCVRNT_COMPARE_METHOD_CASELESS)
+        flags |= PCVRNT_SORT_CASELESS;
+    return flags;
+}
+
+/* the extractor of the default comparison of the sort_flags */
+pcvariant_sort_key_f pcvariant_sort_default_extractor(void **items, size_t nr,
+        purc_variant_t (*member_of)(void *item),
+        uintptr_t sort_flags) WTF_INTERNAL;
+
 // for release the resource in a variant
 typedef void (* pcvariant_release_fn) (purc_variant_t value);
 
@@ -192,9 +234,8 @@ pcvar_obj_it_prev(struct obj_iterator *it);
 struct arr_iterator {
     purc_variant_t                arr;
 
-    struct arr_node              *curr;
-    struct arr_node              *next;
-    struct arr_node              *prev;
+    size_t                        idx;
+    purc_variant_t                curr;
 };
 
 struct arr_iterator
@@ -303,6 +344,23 @@ pcvar_set_add(purc_variant_t set, purc_variant_t val);
 int
 pcvar_readjust_set(purc_variant_t set, struct set_node *node);
 
+// for the deferred revalidation; see constraint.c
+void
+pcvar_revalidate_deferred(void);
+
+void
+pcvar_set_mark_deferred(purc_variant_t set);
+
+void
+pcvar_set_unlink_member(purc_variant_t set, struct set_node *node);
+
+// returns -1 if the member duplicates another one; it is linked anyway
+int
+pcvar_set_relink_member(purc_variant_t set, struct set_node *node);
+
+void
+pcvar_set_drop_member(purc_variant_t set, struct set_node *node);
+
 // compare both variant-type and variant-value
 // recursive-implementation, thus caller's responsible for enough stack space
 // except stack space, no extra memory is required
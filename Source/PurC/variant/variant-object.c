@@ -26,6 +26,7 @@
 #include "config.h"
 #include "private/variant.h"
 #include "private/errors.h"
+#include "private/mem.h"
 #include "purc-errors.h"
 #include "variant-internals.h"
 
@@ -35,8 +36,12 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define OBJ_EXTRA_SIZE(data) (sizeof(*data) + \
-        (data->size) * sizeof(struct obj_node))
+#define OBJ_EXTRA_SIZE(data) (sizeof(*data) +                    \
+        ((data->size > OBJ_INLINE_NODES) ?                          \
+         (data->size - OBJ_INLINE_NODES) * sizeof(struct obj_node) : 0))
+
+/* the number of properties from which the hash index will be used */
+#define OBJ_INDEX_THRESHOLD     32
 
 static inline bool
 grow(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
@@ -127,6 +132,127 @@ pcvar_obj_get_data(purc_variant_t obj)
     return data;
 }
 
+static void
+obj_index_destroy(variant_obj_t data)
+{
+    if (data->index) {
+        pcutils_uomap_destroy(data->index);
+        data->index = NULL;
+    }
+}
+
+static int
+obj_index_add(variant_obj_t data, struct obj_node *node)
+{
+    const char *sk = purc_variant_get_string_const(node->key);
+    if (pchash_table_insert_w_hash(data->index, sk, node,
+                pcvariant_string_hash(node->key), NULL)) {
+        /* the index is an accelerator: drop it instead of failing */
+        obj_index_destroy(data);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+obj_index_del(variant_obj_t data, struct obj_node *node)
+{
+    if (data->index == NULL)
+        return;
+
+    const char *sk = purc_variant_get_string_const(node->key);
+    pcutils_uomap_entry *entry = pchash_table_lookup_entry_w_hash(data->index,
+            sk, pcvariant_string_hash(node->key));
+    if (entry)
+        pcutils_uomap_erase_entry_nolock(data->index, entry);
+}
+
+/* called after a new node was linked to the tree */
+static void
+obj_index_grown(variant_obj_t data, struct obj_node *node)
+{
+    if (data->index) {
+        obj_index_add(data, node);
+        return;
+    }
+
+    if (data->size < OBJ_INDEX_THRESHOLD)
+        return;
+
+    data->index = pcutils_uomap_create(NULL, NULL, NULL, NULL,
+            pchash_fast_str_hash, comp_key_string, false, false);
+    if (data->index == NULL)
+        return;
+
+    struct rb_node *p = pcutils_rbtree_first(&data->kvs);
+    for (; p; p = pcutils_rbtree_next(p)) {
+        struct obj_node *on = container_of(p, struct obj_node, node);
+        if (obj_index_add(data, on))
+            break;
+    }
+}
+
+/* the key variant of the node was replaced by another one with same string */
+static void
+obj_index_rekeyed(variant_obj_t data, struct obj_node *node)
+{
+    if (data->index == NULL)
+        return;
+
+    const char *sk = purc_variant_get_string_const(node->key);
+    pcutils_uomap_entry *entry = pchash_table_lookup_entry_w_hash(data->index,
+            sk, pcvariant_string_hash(node->key));
+    PC_ASSERT(entry && pcutils_uomap_entry_val(entry) == node);
+    pcutils_uomap_entry_key(entry) = (void *)sk;
+}
+
+/* find the node by key (`kv` is the key variant and may be invalid);
+   if not found and `ppnode` is not NULL, returns the insertion position
+   in the tree via `ppnode` and `pparent` */
+static struct obj_node *
+obj_find_node(variant_obj_t data, purc_variant_t kv, const char *key,
+        struct rb_node ***ppnode, struct rb_node **pparent)
+{
+    if (data->index) {
+        uint32_t hash = (kv && kv->type == PVT(_STRING)) ?
+            pcvariant_string_hash(kv) : pchash_fast_str_hash(key);
+        pcutils_uomap_entry *entry;
+        entry = pchash_table_lookup_entry_w_hash(data->index, key, hash);
+        if (entry)
+            return (struct obj_node *)pcutils_uomap_entry_val(entry);
+        if (ppnode == NULL)
+            return NULL;
+    }
+
+    struct rb_root *root = &data->kvs;
+    struct rb_node **pnode = &root->rb_node;
+    struct rb_node *parent = NULL;
+    while (*pnode) {
+        struct obj_node *node;
+        node = container_of(*pnode, struct obj_node, node);
+        const char *sk = purc_variant_get_string_const(node->key);
+        /* the interned keys share the same string */
+        int ret = (key == sk) ? 0 : strcmp(key, sk);
+
+        parent = *pnode;
+
+        if (ret < 0)
+            pnode = &parent->rb_left;
+        else if (ret > 0)
+            pnode = &parent->rb_right;
+        else
+            return node;
+    }
+
+    if (ppnode) {
+        *ppnode = pnode;
+        *pparent = parent;
+    }
+
+    return NULL;
+}
+
 static purc_variant_t v_object_new_with_capacity(void)
 {
     purc_variant_t var = pcvariant_get(PVT(_OBJECT));
@@ -139,7 +265,7 @@ static purc_variant_t v_object_new_with_capacity(void)
     var->flags         = PCVRNT_FLAG_EXTRA_SIZE;
 
     variant_obj_t data;
-    data = (variant_obj_t)calloc(1, sizeof(*data));
+    data = (variant_obj_t)pcutils_calloc(1, sizeof(*data));
 
     if (!data) {
         pcvariant_put(var);
@@ -184,6 +310,8 @@ obj_node_release(purc_variant_t obj, struct obj_node *node)
     struct rb_root *root = &data->kvs;
     if (&node->node == root->rb_node || node->node.rb_parent) {
         --data->size;
+        data->gen++;
+        obj_index_del(data, node);
         pcutils_rbtree_erase(&node->node, root);
         node->node.rb_parent = NULL;
     }
@@ -200,22 +328,42 @@ obj_node_destroy(purc_variant_t obj, struct obj_node *node)
 
     obj_node_release(obj, node);
 
-    free(node);
+    variant_obj_t data = pcvar_obj_get_data(obj);
+    if (node >= data->inline_nodes &&
+            node < data->inline_nodes + OBJ_INLINE_NODES) {
+        unsigned slot = (unsigned)(node - data->inline_nodes);
+        data->inline_used &= ~(1U << slot);
+    }
+    else {
+        pcvariant_slab_free(PCVARIANT_SLAB_OBJ_NODE, node);
+    }
 }
 
 static struct obj_node*
-obj_node_create(purc_variant_t k, purc_variant_t v)
+obj_node_create(variant_obj_t data, purc_variant_t k, purc_variant_t v)
 {
     if (k->type != PVT(_STRING)) {
         pcinst_set_error(PURC_ERROR_INVALID_VALUE);
         return NULL;
     }
 
-    struct obj_node *node;
-    node = (struct obj_node*)calloc(1, sizeof(*node));
-    if (!node) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return NULL;
+    struct obj_node *node = NULL;
+    for (unsigned slot = 0; slot < OBJ_INLINE_NODES; slot++) {
+        if (!(data->inline_used & (1U << slot))) {
+            data->inline_used |= (1U << slot);
+            node = data->inline_nodes + slot;
+            memset(node, 0, sizeof(*node));
+            break;
+        }
+    }
+
+    if (node == NULL) {
+        node = (struct obj_node*)pcvariant_slab_alloc_0(
+                PCVARIANT_SLAB_OBJ_NODE);
+        if (!node) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return NULL;
+        }
     }
 
     node->key = purc_variant_ref(k);
@@ -296,28 +444,9 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
 {
     variant_obj_t data = pcvar_obj_get_data(obj);
     struct rb_root *root = &data->kvs;
-    struct rb_node **pnode = &root->rb_node;
-    struct rb_node *parent = NULL;
-    struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sk = purc_variant_get_string_const(node->key);
-        int ret = strcmp(key, sk);
-
-        parent = *pnode;
-
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
-        }
-    }
-
-    if (!entry) {
+    struct obj_node *node = obj_find_node(data, PURC_VARIANT_INVALID, key,
+            NULL, NULL);
+    if (!node) {
         if (silently)
             return 0;
 
@@ -325,8 +454,7 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
         return -1;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
+    struct rb_node *entry = &node->node;
     purc_variant_t k = node->key;
     purc_variant_t v = node->val;
 
@@ -342,7 +470,9 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
         }
 
         --data->size;
+        data->gen++;
         PC_ASSERT(entry == root->rb_node || entry->rb_parent);
+        obj_index_del(data, node);
         pcutils_rbtree_erase(entry, root);
         entry->rb_parent = NULL;
 
@@ -467,29 +597,14 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
     PC_ASSERT(data);
 
     struct rb_root *root = &data->kvs;
-    struct rb_node **pnode = &root->rb_node;
+    struct rb_node **pnode = NULL;
     struct rb_node *parent = NULL;
     struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sko = purc_variant_get_string_const(node->key);
-        int ret = strcmp(sk, sko);
+    struct obj_node *found = obj_find_node(data, key, sk,
+            &pnode, &parent);
 
-        parent = *pnode;
-
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
-        }
-    }
-
-    if (!entry) { //new the entry
-        struct obj_node *node = obj_node_create(key, val);
+    if (!found) { //new the entry
+        struct obj_node *node = obj_node_create(data, key, val);
         if (!node)
             return -1;
 
@@ -508,6 +623,8 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
             pcutils_rbtree_insert_color(entry, root);
 
             ++data->size;
+            data->gen++;
+            obj_index_grown(data, node);
 
             if (check) {
                 if (build_rev_update_chain(obj, node))
@@ -532,8 +649,7 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
         return -1;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
+    struct obj_node *node = found;
     if (node->val == val) {
         // NOTE: keep refc intact
         return 0;
@@ -566,6 +682,9 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
 
         node->key = purc_variant_ref(key);
         node->val = purc_variant_ref(val);
+        data->gen++;
+        if (ko != key)
+            obj_index_rekeyed(data, node);
 
         if (check) {
             pcvar_adjust_set_by_descendant(obj);
@@ -608,7 +727,7 @@ v_object_set_kvs_n(purc_variant_t obj, bool check, size_t nr_kv_pairs,
     while (i<nr_kv_pairs) {
         if (is_c) {
             const char *k_c = va_arg(ap, const char*);
-            k = purc_variant_make_string(k_c, true);
+            k = pcvariant_make_key_string(k_c, true);
             if (!k)
                 break;
         } else {
@@ -649,7 +768,7 @@ pv_make_object_by_static_ckey_n (bool check, size_t nr_kv_pairs,
     do {
         int r;
         if (nr_kv_pairs > 0) {
-            purc_variant_t k = purc_variant_make_string(key0, true);
+            purc_variant_t k = pcvariant_make_key_string(key0, true);
             purc_variant_t v = value0;
             r = v_object_set(obj, k, v, check);
             purc_variant_unref(k);
@@ -750,6 +869,9 @@ void pcvariant_object_release (purc_variant_t value)
 
     variant_obj_t data = pcvar_obj_get_data(value);
 
+    /* no need to maintain the index when destroying all nodes */
+    obj_index_destroy(data);
+
     struct rb_root *root = &data->kvs;
 
     struct rb_node *p, *n;
@@ -765,7 +887,7 @@ void pcvariant_object_release (purc_variant_t value)
         data->rev_update_chain = NULL;
     }
 
-    free(data);
+    pcutils_free(data);
 
     value->sz_ptr[1] = (uintptr_t)NULL; // say no to double free
 
@@ -802,38 +924,14 @@ purc_variant_object_get_by_ckey(purc_variant_t obj, const char* key)
         PURC_VARIANT_INVALID);
 
     variant_obj_t data = pcvar_obj_get_data(obj);
-    struct rb_root *root = &data->kvs;
-
-    struct rb_node **pnode = &root->rb_node;
-    struct rb_node *parent = NULL;
-    struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sk = purc_variant_get_string_const(node->key);
-
-        int ret = strcmp(key, sk);
-
-        parent = *pnode;
-
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
-        }
-    }
-
-    if (!entry) {
+    struct obj_node *node = obj_find_node(data, PURC_VARIANT_INVALID, key,
+            NULL, NULL);
+    if (!node) {
         pcinst_set_error(PCVRNT_ERROR_NO_SUCH_KEY);
 
         return PURC_VARIANT_INVALID;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
     return node->val;
 }
 
@@ -896,7 +994,7 @@ pcvrnt_object_iterator_create_begin (purc_variant_t object)
     }
 
     struct pcvrnt_object_iterator *it;
-    it = (struct pcvrnt_object_iterator*)malloc(sizeof(*it));
+    it = (struct pcvrnt_object_iterator*)pcutils_malloc(sizeof(*it));
     if (!it) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
@@ -920,7 +1018,7 @@ pcvrnt_object_iterator_create_end (purc_variant_t object) {
     }
 
     struct pcvrnt_object_iterator *it;
-    it = (struct pcvrnt_object_iterator*)malloc(sizeof(*it));
+    it = (struct pcvrnt_object_iterator*)pcutils_malloc(sizeof(*it));
     if (!it) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
@@ -942,7 +1040,7 @@ pcvrnt_object_iterator_release (struct pcvrnt_object_iterator* it)
     it->it.next = NULL;
     it->it.prev = NULL;
 
-    free(it);
+    pcutils_free(it);
 }
 
 bool
@@ -25,6 +25,7 @@
 #include "config.h"
 #include "private/variant.h"
 #include "private/list.h"
+#include "private/mem.h"
 #include "private/hashtable.h"
 #include "private/errors.h"
 #include "private/stringbuilder.h"
@@ -138,6 +139,7 @@ variant_set_get_extra_size(variant_set_t data)
 
     extra += sz_record * count;
     extra += sizeof(struct set_node*)*(data->al.nr);
+    extra += sizeof(struct set_node*)*(data->nr_buckets);
 
     return extra;
 }
@@ -236,7 +238,7 @@ variant_set_init(variant_set_t data, const char *unique_key, bool caseless)
     }
 
     size_t n = strlen(data->unique_key);
-    data->keynames = (const char**)calloc(n, sizeof(*data->keynames));
+    data->keynames = (const char**)pcutils_calloc(n, sizeof(*data->keynames));
     if (!data->keynames) {
         free(data->unique_key);
         data->unique_key = NULL;
@@ -279,7 +281,7 @@ pcv_set_new(void)
     set->type          = PVT(_SET);
     set->flags         = PCVRNT_FLAG_EXTRA_SIZE;
 
-    variant_set_t data  = (variant_set_t)calloc(1, sizeof(*data));
+    variant_set_t data  = (variant_set_t)pcutils_calloc(1, sizeof(*data));
     pcv_set_set_data(set, data);
 
     if (!data) {
@@ -434,6 +436,128 @@ _compare(purc_variant_t _new, purc_variant_t _old,
     return _compare_by_unique_keys(_new, _old, data);
 }
 
+/* the initial number of buckets of the hash index; must be a power of 2 */
+#define SET_INDEX_MIN_BUCKETS       16
+
+static uint32_t
+set_elem_hash(variant_set_t data, purc_variant_t val, bool *exact)
+{
+    uint32_t hash = 0x811c9dc5U;    /* FNV-1a offset basis */
+
+    *exact = true;
+    if (data->unique_key == NULL) {
+        // generic set
+        return pcvariant_compare_hash(val, hash, data->caseless, exact);
+    }
+
+    for (size_t i=0; i<data->nr_keynames; ++i) {
+        purc_variant_t v = _get_by_key(val, data->keynames[i]);
+        PC_ASSERT(v != PURC_VARIANT_INVALID);
+
+        hash = pcvariant_compare_hash(v, hash, data->caseless, exact);
+        purc_variant_unref(v);
+
+        /* separate the values of different keys */
+        hash ^= 0xFF;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static void
+set_index_link(variant_set_t data, struct set_node *node)
+{
+    node->hash = set_elem_hash(data, node->val, &node->hash_exact);
+    if (!node->hash_exact)
+        data->nr_inexact++;
+
+    if (data->buckets) {
+        size_t idx = node->hash & (data->nr_buckets - 1);
+        node->hnext = data->buckets[idx];
+        data->buckets[idx] = node;
+    }
+}
+
+static void
+set_index_unlink(variant_set_t data, struct set_node *node)
+{
+    if (!node->hash_exact)
+        data->nr_inexact--;
+
+    if (data->buckets) {
+        struct set_node **pp;
+        pp = &data->buckets[node->hash & (data->nr_buckets - 1)];
+        while (*pp) {
+            if (*pp == node) {
+                *pp = node->hnext;
+                break;
+            }
+            pp = &(*pp)->hnext;
+        }
+    }
+
+    node->hnext = NULL;
+}
+
+/* Rebuilds the index from all elements when the load factor exceeds 1.
+   If failed to allocate the buckets, the old index is kept; and if there
+   is no index, the lookup will fall back to the rbtree. */
+static void
+set_index_grow(variant_set_t data)
+{
+    size_t count = pcutils_array_list_length(&data->al);
+    if (count <= data->nr_buckets)
+        return;
+
+    size_t nr_buckets = data->nr_buckets ?
+        data->nr_buckets * 2 : SET_INDEX_MIN_BUCKETS;
+    while (nr_buckets < count)
+        nr_buckets *= 2;
+
+    struct set_node **buckets;
+    buckets = (struct set_node **)pcutils_calloc(nr_buckets, sizeof(*buckets));
+    if (!buckets)
+        return;
+
+    struct pcutils_array_list_node *p;
+    array_list_for_each(&data->al, p) {
+        struct set_node *node = container_of(p, struct set_node, alnode);
+        size_t idx = node->hash & (nr_buckets - 1);
+        node->hnext = buckets[idx];
+        buckets[idx] = node;
+    }
+
+    pcutils_free(data->buckets);
+    data->buckets = buckets;
+    data->nr_buckets = nr_buckets;
+}
+
+/* Returns the element equal to `kvs` if it is in the index. `*miss` will be
+   set to true if the index can tell the element does not exist, otherwise
+   the caller should search the rbtree. */
+static struct set_node*
+set_index_find(variant_set_t data, purc_variant_t kvs, bool *miss)
+{
+    *miss = false;
+    if (data->buckets == NULL)
+        return NULL;
+
+    bool exact;
+    uint32_t hash = set_elem_hash(data, kvs, &exact);
+
+    struct set_node *p = data->buckets[hash & (data->nr_buckets - 1)];
+    for (; p; p = p->hnext) {
+        if (p->hash == hash && _compare(kvs, p->val, data) == 0)
+            return p;
+    }
+
+    /* NOTE: under the caseless method, the equal values containing
+       non-ASCII characters may have different hash values. */
+    *miss = exact && data->nr_inexact == 0;
+    return NULL;
+}
+
 static void
 find_element_rb_node(struct element_rb_node *node,
         purc_variant_t set, purc_variant_t kvs)
@@ -443,22 +567,13 @@ find_element_rb_node(struct element_rb_node *node,
     struct rb_node **pnode = &root->rb_node;
     struct rb_node *parent = NULL;
     struct rb_node *entry = NULL;
-    char md5[33];
-    pcvariant_md5_by_set(md5, kvs, set);
 
+    /* NOTE: do not calculate the md5 of `kvs` here; it is expensive
+       and the elements are ordered by `_compare()`. */
     while (*pnode) {
         struct set_node *on;
         on = container_of(*pnode, struct set_node, rbnode);
-        int diff;
-        if (0) {
-            diff = variant_set_compare_by_set_keys(set, kvs, on->val);
-        }
-        else if (0) {
-            diff = pcvariant_diff_by_set(md5, kvs, on->md5, on->val, set);
-        }
-        else {
-            diff = _compare(kvs, on->val, data);
-        }
+        int diff = _compare(kvs, on->val, data);
 
         parent = *pnode;
 
@@ -479,9 +594,44 @@ find_element_rb_node(struct element_rb_node *node,
     node->entry  = entry;
 }
 
+/* Like find_element_rb_node(), but `pnode` and `parent` are only set
+   if the element does not exist. */
+static void
+locate_element(struct element_rb_node *node,
+        purc_variant_t set, purc_variant_t kvs)
+{
+    variant_set_t data = pcvar_set_get_data(set);
+    if (data->deferred) {
+        pcvar_revalidate_deferred();
+        data->deferred = false;
+    }
+
+    bool miss;
+    struct set_node *sn = set_index_find(data, kvs, &miss);
+    if (sn) {
+        node->pnode  = NULL;
+        node->parent = NULL;
+        node->entry  = &sn->rbnode;
+        return;
+    }
+
+    find_element_rb_node(node, set, kvs);
+}
+
 static struct set_node*
 find_element(purc_variant_t set, purc_variant_t kvs)
 {
+    variant_set_t data = pcvar_set_get_data(set);
+    if (data->deferred) {
+        pcvar_revalidate_deferred();
+        data->deferred = false;
+    }
+
+    bool miss;
+    struct set_node *sn = set_index_find(data, kvs, &miss);
+    if (sn || miss)
+        return sn;
+
     struct element_rb_node node;
     find_element_rb_node(&node, set, kvs);
 
@@ -574,6 +724,7 @@ elem_node_remove(purc_variant_t set, struct set_node *node)
     PC_ASSERT(data);
 
     pcutils_rbtree_erase(&node->rbnode, &data->elems);
+    set_index_unlink(data, node);
 
     int r;
     struct pcutils_array_list_node *old;
@@ -603,7 +754,7 @@ elem_node_destroy(purc_variant_t set, struct set_node *node)
         return;
 
     elem_node_release(set, node);
-    free(node);
+    pcvariant_slab_free(PCVARIANT_SLAB_SET_NODE, node);
 }
 
 static int
@@ -618,9 +769,13 @@ elem_node_replace(purc_variant_t set, struct set_node *node,
         elem_node_revoke_constraints(set, node);
     }
 
+    variant_set_t data = pcvar_set_get_data(set);
+    set_index_unlink(data, node);
+
     PURC_VARIANT_SAFE_CLEAR(node->val);
 
     node->val = val;
+    set_index_link(data, node);
 
     if (check) {
         if (!elem_node_setup_constraints(set, node))
@@ -646,6 +801,11 @@ variant_set_release_elems(purc_variant_t set, variant_set_t data)
     }
 
     pcutils_array_list_reset(&data->al);
+
+    pcutils_free(data->buckets);
+    data->buckets = NULL;
+    data->nr_buckets = 0;
+    data->nr_inexact = 0;
 }
 
 static void
@@ -658,7 +818,7 @@ variant_set_release(purc_variant_t set, variant_set_t data)
         data->rev_update_chain = NULL;
     }
 
-    free(data->keynames);
+    pcutils_free(data->keynames);
     data->keynames = NULL;
     data->nr_keynames = 0;
     free(data->unique_key);
@@ -709,7 +869,8 @@ variant_set_create_elem_node(purc_variant_t set, purc_variant_t val)
     variant_set_t data = pcvar_set_get_data(set);
     PC_ASSERT(data);
 
-    struct set_node *_new = (struct set_node*)calloc(1, sizeof(*_new));
+    struct set_node *_new;
+    _new = (struct set_node*)pcvariant_slab_alloc_0(PCVARIANT_SLAB_SET_NODE);
     if (!_new) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
@@ -873,6 +1034,9 @@ insert(purc_variant_t set, variant_set_t data,
         pcutils_rbtree_link_node(entry, parent, pnode);
         pcutils_rbtree_insert_color(entry, &data->elems);
 
+        set_index_link(data, node);
+        set_index_grow(data);
+
         if (check) {
             if (!elem_node_setup_constraints(set, node))
                 break;
@@ -897,7 +1061,7 @@ pcvar_set_add(purc_variant_t set, purc_variant_t val)
     PC_ASSERT(data);
 
     struct element_rb_node rbn;
-    find_element_rb_node(&rbn, set, val);
+    locate_element(&rbn, set, val);
 
     if (rbn.entry) {
         purc_set_error(PURC_ERROR_DUPLICATED);
@@ -962,7 +1126,7 @@ insert_or_replace(purc_variant_t set,
         bool check)
 {
     struct element_rb_node rbn;
-    find_element_rb_node(&rbn, set, val);
+    locate_element(&rbn, set, val);
 
     if (!rbn.entry) {
         int r = insert(set, data, val, rbn.parent, rbn.pnode, check);
@@ -1131,6 +1295,53 @@ purc_variant_make_set_by_ckey_ex(size_t sz, const char* unique_key,
     return v;
 }
 
+purc_variant_t
+purc_variant_make_set_by_members(size_t sz, const char *unique_key,
+        bool caseless, purc_variant_t *members)
+{
+    PCVRNT_CHECK_FAIL_RET(sz == 0 || members, PURC_VARIANT_INVALID);
+
+    purc_variant_t set = make_set_0(unique_key, caseless);
+    if (set == PURC_VARIANT_INVALID) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    do {
+        variant_set_t data = pcvar_set_get_data(set);
+
+        /* NOTE: the set is new and nobody is listening on it or refers to
+           it, so it is safe to add the members without checking, and build
+           the constraints once all the members are in place. */
+        bool check = false;
+        size_t i;
+        for (i = 0; i < sz; i++) {
+            if (-1 == variant_set_add_val(set, data, members[i],
+                        PCVRNT_CR_METHOD_OVERWRITE, check))
+                break;
+        }
+        if (i < sz)
+            break;
+
+        struct pcutils_array_list_node *p;
+        array_list_for_each(&data->al, p) {
+            struct set_node *node = container_of(p, struct set_node, alnode);
+            if (!elem_node_setup_constraints(set, node))
+                break;
+        }
+        if (p)
+            break;
+
+        size_t extra = variant_set_get_extra_size(data);
+        pcvariant_stat_set_extra_size(set, extra);
+        return set;
+    } while (0);
+
+    // cleanup
+    purc_variant_unref(set);
+
+    return PURC_VARIANT_INVALID;
+}
+
 ssize_t
 purc_variant_set_add(purc_variant_t set, purc_variant_t value,
         pcvrnt_cr_method_k cr_method)
@@ -1430,7 +1641,7 @@ pcvrnt_set_iterator_create_begin(purc_variant_t set)
     }
 
     struct pcvrnt_set_iterator *it;
-    it = (struct pcvrnt_set_iterator*)calloc(1, sizeof(*it));
+    it = (struct pcvrnt_set_iterator*)pcutils_calloc(1, sizeof(*it));
     if (!it) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
@@ -1463,7 +1674,7 @@ pcvrnt_set_iterator_create_end(purc_variant_t set)
     }
 
     struct pcvrnt_set_iterator *it;
-    it = (struct pcvrnt_set_iterator*)calloc(1, sizeof(*it));
+    it = (struct pcvrnt_set_iterator*)pcutils_calloc(1, sizeof(*it));
     if (!it) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
@@ -1485,7 +1696,7 @@ pcvrnt_set_iterator_release(struct pcvrnt_set_iterator* it)
 {
     if (!it)
         return;
-    free(it);
+    pcutils_free(it);
 }
 
 bool
@@ -1541,7 +1752,7 @@ pcvariant_set_release(purc_variant_t value)
     PC_ASSERT(data);
 
     variant_set_release(value, data);
-    free(data);
+    pcutils_free(data);
     pcv_set_set_data(value, NULL);
 
     pcvariant_stat_set_extra_size(value, 0);
@@ -1604,6 +1815,35 @@ cmp_f(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
     return d->cmp(nl->val, nr->val, d->ud);
 }
 
+static purc_variant_t
+set_member_of(void *item)
+{
+    struct pcutils_array_list_node *node = item;
+    return container_of(node, struct set_node, alnode)->val;
+}
+
+static int
+sort_nodes_by_keys(struct pcutils_array_list *al, size_t nr_keys,
+        pcvariant_sort_key_f extract, void *ud, unsigned int flags)
+{
+    int r = pcvariant_sort_items((void **)al->nodes, al->nr, set_member_of,
+            nr_keys, extract, ud, flags);
+
+    for (size_t i = 0; i < al->nr; ++i) {
+        al->nodes[i]->idx = i;
+    }
+    return r;
+}
+
+int pcvariant_set_sort_by_keys(purc_variant_t value, size_t nr_keys,
+        pcvariant_sort_key_f extract, void *ud, unsigned int flags)
+{
+    PC_ASSERT(value != PURC_VARIANT_INVALID);
+
+    variant_set_t data = pcvar_set_get_data(value);
+    return sort_nodes_by_keys(&data->al, nr_keys, extract, ud, flags);
+}
+
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud))
 {
@@ -1612,6 +1852,17 @@ int pcvariant_set_sort(purc_variant_t value, void *ud,
     variant_set_t data = pcvar_set_get_data(value);
     struct pcutils_array_list *al = &data->al;
 
+    if (cmp == NULL) {
+        /* NOTE: the default comparisons are done on the extracted keys */
+        uintptr_t sort_flags = (uintptr_t)ud;
+        pcvariant_sort_key_f extract = pcvariant_sort_default_extractor(
+                (void **)al->nodes, al->nr, set_member_of, sort_flags);
+        if (extract) {
+            return sort_nodes_by_keys(al, 1, extract, NULL,
+                    pcvariant_sort_flags_of(sort_flags));
+        }
+    }
+
     struct set_user_data d = {
         .cmp = cmp ? cmp : vrtcmp,
         .ud  = ud,
@@ -2127,6 +2378,7 @@ pcvar_readjust_set(purc_variant_t set, struct set_node *node)
     variant_set_t data = pcvar_set_get_data(set);
 
     pcutils_rbtree_erase(&node->rbnode, &data->elems);
+    set_index_unlink(data, node);
 
     struct element_rb_node rbn;
     find_element_rb_node(&rbn, set, node->val);
@@ -2136,10 +2388,71 @@ pcvar_readjust_set(purc_variant_t set, struct set_node *node)
 
     pcutils_rbtree_link_node(entry, rbn.parent, rbn.pnode);
     pcutils_rbtree_insert_color(entry, &data->elems);
+    set_index_link(data, node);
 
     return 0;
 }
 
+void
+pcvar_set_mark_deferred(purc_variant_t set)
+{
+    variant_set_t data = pcvar_set_get_data(set);
+    data->deferred = true;
+}
+
+void
+pcvar_set_unlink_member(purc_variant_t set, struct set_node *node)
+{
+    variant_set_t data = pcvar_set_get_data(set);
+
+    pcutils_rbtree_erase(&node->rbnode, &data->elems);
+    set_index_unlink(data, node);
+}
+
+int
+pcvar_set_relink_member(purc_variant_t set, struct set_node *node)
+{
+    variant_set_t data = pcvar_set_get_data(set);
+    data->deferred = false;
+
+    struct element_rb_node rbn;
+    find_element_rb_node(&rbn, set, node->val);
+
+    int r = 0;
+    if (rbn.entry) {
+        /* link it next to the equal one, so that the order is kept and
+           it can be removed as usual */
+        struct rb_node *p = rbn.entry;
+        if (p->rb_left == NULL) {
+            rbn.parent = p;
+            rbn.pnode = &p->rb_left;
+        }
+        else {
+            for (p = p->rb_left; p->rb_right; p = p->rb_right)
+                ;
+            rbn.parent = p;
+            rbn.pnode = &p->rb_right;
+        }
+        r = -1;
+    }
+
+    struct rb_node *entry = &node->rbnode;
+    pcutils_rbtree_link_node(entry, rbn.parent, rbn.pnode);
+    pcutils_rbtree_insert_color(entry, &data->elems);
+    set_index_link(data, node);
+
+    return r;
+}
+
+void
+pcvar_set_drop_member(purc_variant_t set, struct set_node *node)
+{
+    bool check = true;
+    if (set_remove(set, node, check)) {
+        PC_WARN("Failed to remove the conflicting member of set: %p\n", set);
+    }
+}
+
 ssize_t
 purc_variant_set_unite(purc_variant_t set, purc_variant_t value,
             pcvrnt_cr_method_k cr_method)
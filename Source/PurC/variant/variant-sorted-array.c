@@ -25,6 +25,7 @@
 #include "config.h"
 #include "private/variant.h"
 #include "private/errors.h"
+#include "private/mem.h"
 #include "private/sorted-array.h"
 #include "private/atom-buckets.h"
 #include "variant-internals.h"
@@ -122,7 +123,7 @@ void on_release(void *native_entity)
 
     struct sorted_array *sa = psa->sa;
     pcutils_sorted_array_destroy(sa);
-    free(psa);
+    pcutils_free(psa);
 }
 
 purc_variant_t
@@ -136,7 +137,7 @@ purc_variant_make_sorted_array(unsigned int flags, size_t sz_init,
     unsigned int sa_flags = 0;
     purc_variant_t ret_var = PURC_VARIANT_INVALID;
     struct pcvariant_sorted_array *data;
-    data = (struct pcvariant_sorted_array *)calloc(1, sizeof(*data));
+    data = (struct pcvariant_sorted_array *)pcutils_calloc(1, sizeof(*data));
 
     if (!data) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
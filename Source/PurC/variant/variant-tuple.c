@@ -25,6 +25,7 @@
 #include "config.h"
 #include "private/variant.h"
 #include "private/errors.h"
+#include "private/mem.h"
 #include "variant-internals.h"
 #include "purc-errors.h"
 #include "purc-utils.h"
@@ -113,16 +114,16 @@ purc_variant_t purc_variant_make_tuple(size_t argc, purc_variant_t *argv)
         return PURC_VARIANT_INVALID;
     }
 
-    variant_tuple_t data = (variant_tuple_t)calloc(1, sizeof(*data));
+    variant_tuple_t data = (variant_tuple_t)pcutils_calloc(1, sizeof(*data));
     if (!data) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return PURC_VARIANT_INVALID;
     }
 
-    data->members = calloc(argc, sizeof(purc_variant_t));
+    data->members = pcutils_calloc(argc, sizeof(purc_variant_t));
     if (data->members == NULL) {
         pcvariant_put(vrt);
-        free(data);
+        pcutils_free(data);
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return PURC_VARIANT_INVALID;
     }
@@ -191,16 +192,24 @@ bool purc_variant_tuple_set(purc_variant_t tuple,
 
 
     purc_variant_t old = purc_variant_ref(members[idx]);
-    purc_variant_t pos = purc_variant_make_longint(idx);
+    purc_variant_t pos = PURC_VARIANT_INVALID;
+    if (tuple->flags & PCVRNT_FLAG_LISTENED) {
+        pos = purc_variant_make_longint(idx);
+        if (pos == PURC_VARIANT_INVALID) {
+            purc_variant_unref(old);
+            return false;
+        }
+    }
+
     if (!change(tuple, pos, old, value, true)) {
         purc_variant_unref(old);
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
         return false;
     }
 
     if (check_change(tuple, idx, value)) {
         purc_variant_unref(old);
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
         return false;
     }
 
@@ -211,7 +220,7 @@ bool purc_variant_tuple_set(purc_variant_t tuple,
     changed(tuple, pos, old, value, true);
 
     purc_variant_unref(old);
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
     return true;
 }
 
@@ -267,8 +276,8 @@ void pcvariant_tuple_release(purc_variant_t tuple)
         data->rev_update_chain = NULL;
     }
 
-    free(data->members);
-    free(data);
+    pcutils_free(data->members);
+    pcutils_free(data);
 }
 
 static void
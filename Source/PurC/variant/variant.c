@@ -25,8 +25,10 @@
 #include "private/atom-buckets.h"
 #include "private/variant.h"
 #include "private/instance.h"
+#include "private/mem.h"
 #include "private/ejson.h"
 #include "private/vcm.h"
+#include "private/rwstream.h"
 #include "private/errors.h"
 #include "private/debug.h"
 #include "private/dvobjs.h"
@@ -43,6 +45,8 @@
     #include <dlfcn.h>
 #endif
 
+#include <pthread.h>
+
 #if HAVE(GLIB)
     #include <gmodule.h>
 #endif
@@ -86,32 +90,18 @@ static struct err_msg_seg _variant_err_msgs_seg = {
     variant_err_msgs
 };
 
-#if HAVE(GLIB)
 purc_variant *pcvariant_alloc(void) {
-    return (purc_variant *)g_slice_alloc(sizeof(purc_variant));
+    return (purc_variant *)pcvariant_slab_alloc(PCVARIANT_SLAB_VARIANT);
 }
 
 purc_variant *pcvariant_alloc_0(void) {
-    return (purc_variant *)g_slice_alloc0(sizeof(purc_variant));
+    return (purc_variant *)pcvariant_slab_alloc_0(PCVARIANT_SLAB_VARIANT);
 }
 
 void pcvariant_free(purc_variant *v) {
-    return g_slice_free1(sizeof(purc_variant), (gpointer)v);
-}
-#else
-purc_variant *pcvariant_alloc(void) {
-    return (purc_variant *)malloc(sizeof(purc_variant));
+    pcvariant_slab_free(PCVARIANT_SLAB_VARIANT, v);
 }
 
-purc_variant *pcvariant_alloc_0(void) {
-    return (purc_variant *)calloc(1, sizeof(purc_variant));
-}
-
-void pcvariant_free(purc_variant *v) {
-    return free(v);
-}
-#endif
-
 purc_atom_t pcvariant_atom_grow;
 purc_atom_t pcvariant_atom_shrink;
 purc_atom_t pcvariant_atom_change;
@@ -131,7 +121,10 @@ static int _init_once(void)
     pcvariant_atom_change = purc_atom_from_static_string_ex(ATOM_BUCKET_MSG,
         "change");
 
-    return 0;
+    if (pcvariant_slab_init_once())
+        return -1;
+
+    return pcvariant_snapshot_init_once();
 }
 
 static void _cleanup_instance(struct pcinst *inst)
@@ -156,6 +149,17 @@ static void _cleanup_instance(struct pcinst *inst)
     if (heap == NULL)
         return;
 
+    /* release the interned string variants owned by the heap */
+    if (heap->interned) {
+        pcutils_uomap_destroy(heap->interned);
+        heap->interned = NULL;
+    }
+
+    if (heap->deferred) {
+        pcutils_map_destroy(heap->deferred);
+        heap->deferred = NULL;
+    }
+
     /* VWNOTE: do not try to release the extra memory here. */
 #if USE(LOOP_BUFFER_FOR_RESERVED)
     for (int i = 0; i < MAX_RESERVED_VARIANTS; i++) {
@@ -181,7 +185,8 @@ static void _cleanup_instance(struct pcinst *inst)
     assert(heap->v_true.refc == 0);
     assert(heap->v_false.refc == 0);
 
-    free(heap);
+    pcvariant_slab_detach(heap);
+    pcutils_free(heap);
     inst->variant_heap = NULL;
     inst->org_vrt_heap = NULL;
 }
@@ -193,13 +198,20 @@ static int _init_instance(struct pcinst *curr_inst,
 
     struct pcinst *inst = curr_inst;
 
-    inst->variant_heap = calloc(1, sizeof(*inst->variant_heap));
+    inst->variant_heap = pcutils_calloc(1, sizeof(*inst->variant_heap));
     if (inst->variant_heap == NULL) {
         return PURC_ERROR_OUT_OF_MEMORY;
     }
 
     inst->org_vrt_heap = inst->variant_heap;
 
+    if (pcvariant_slab_attach(inst->variant_heap)) {
+        pcutils_free(inst->variant_heap);
+        inst->variant_heap = NULL;
+        inst->org_vrt_heap = NULL;
+        return PURC_ERROR_OUT_OF_MEMORY;
+    }
+
     // initialize const values in instance
     inst->variant_heap->v_undefined.type = PURC_VARIANT_TYPE_UNDEFINED;
     inst->variant_heap->v_undefined.refc = 0;
@@ -233,6 +245,7 @@ static int _init_instance(struct pcinst *curr_inst,
     stat->sz_mem[PURC_VARIANT_TYPE_BOOLEAN] = sizeof(purc_variant) * 2;
     stat->nr_total_values = 4;
     stat->sz_total_mem = 4 * sizeof(purc_variant);
+    stat->sz_max_mem = stat->sz_total_mem;
 
     stat->nr_reserved = 0;
     stat->nr_max_reserved = MAX_RESERVED_VARIANTS;
@@ -408,9 +421,59 @@ const struct purc_variant_stat *purc_variant_usage_stat(void)
     value = &(inst->variant_heap->v_false);
     inst->variant_heap->stat.nr_values[PURC_VARIANT_TYPE_BOOLEAN] += value->refc;
 
+    pcvariant_slab_stat(inst->variant_heap);
+
     return &inst->variant_heap->stat;
 }
 
+void pcvariant_set_usage(struct pcvariant_usage *usage)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst && inst->org_vrt_heap)
+        inst->org_vrt_heap->usage = usage;
+}
+
+struct pcvariant_usage *pcvariant_get_usage(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst && inst->org_vrt_heap)
+        return inst->org_vrt_heap->usage;
+    return NULL;
+}
+
+static void usage_charge(struct pcvariant_usage *usage, ssize_t nr, ssize_t sz)
+{
+    usage->nr_values += nr;
+    usage->sz_mem += sz;
+
+    if (usage->soft_limit == 0)
+        return;
+
+    if (usage->sz_mem < (ssize_t)usage->soft_limit) {
+        usage->soft_reached = false;
+    }
+    else if (!usage->soft_reached) {
+        /* NOTE: warn once every time the usage goes beyond the soft limit. */
+        usage->soft_reached = true;
+        PC_WARN("Memory usage of variants (%ld bytes) reached the soft limit "
+                "(%lu bytes) of the coroutine.\n",
+                (long)usage->sz_mem, (unsigned long)usage->soft_limit);
+    }
+}
+
+/* Fails with PURC_ERROR_OUT_OF_MEMORY if allocating `sz` bytes more will
+   exceed the hard limit; the error becomes an exception in the coroutine. */
+static bool usage_check(struct pcvariant_usage *usage, size_t sz)
+{
+    if (usage->hard_limit &&
+            usage->sz_mem + (ssize_t)sz > (ssize_t)usage->hard_limit) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    return true;
+}
+
 void pcvariant_stat_set_extra_size(purc_variant_t value, size_t extra_size)
 {
     struct pcinst *instance = pcinst_current();
@@ -425,10 +488,17 @@ void pcvariant_stat_set_extra_size(purc_variant_t value, size_t extra_size)
         stat->sz_mem[type] -= value->sz_ptr[0];
         stat->sz_total_mem -= value->sz_ptr[0];
 
+        struct pcvariant_usage *usage = instance->variant_heap->usage;
+        if (usage) {
+            usage_charge(usage, 0,
+                    (ssize_t)extra_size - (ssize_t)value->sz_ptr[0]);
+        }
+
         value->sz_ptr[0] = extra_size;
 
         stat->sz_mem[type] += extra_size;
         stat->sz_total_mem += extra_size;
+        pcvariant_stat_update_max_mem(stat);
     }
 }
 
@@ -439,6 +509,9 @@ purc_variant_t pcvariant_get(enum purc_variant_type type)
     struct pcvariant_heap *heap = instance->variant_heap;
     struct purc_variant_stat *stat = &(heap->stat);
 
+    if (heap->usage && !usage_check(heap->usage, sizeof(purc_variant)))
+        return PURC_VARIANT_INVALID;
+
 #if USE(LOOP_BUFFER_FOR_RESERVED)
     if (heap->headpos == heap->tailpos) {
         // no reserved, allocate one
@@ -448,6 +521,7 @@ purc_variant_t pcvariant_get(enum purc_variant_type type)
 
         stat->sz_mem[type] += sizeof(purc_variant);
         stat->sz_total_mem += sizeof(purc_variant);
+        pcvariant_stat_update_max_mem(stat);
     }
     else {
         value = heap->v_reserved[heap->tailpos];
@@ -469,6 +543,7 @@ purc_variant_t pcvariant_get(enum purc_variant_type type)
 
         stat->sz_mem[type] += sizeof(purc_variant);
         stat->sz_total_mem += sizeof(purc_variant);
+        pcvariant_stat_update_max_mem(stat);
     }
     else {
         value = list_first_entry(&heap->v_reserved, purc_variant, reserved);
@@ -484,9 +559,43 @@ purc_variant_t pcvariant_get(enum purc_variant_type type)
     // set stat information
     stat->nr_values[type]++;
     stat->nr_total_values++;
+    heap->nr_allocs++;
+    if (heap->usage)
+        usage_charge(heap->usage, 1, sizeof(purc_variant));
 
     // init listeners
     INIT_LIST_HEAD(&value->listeners);
+    value->flags &= ~PCVRNT_FLAG_LISTENED;
+
+    return value;
+}
+
+purc_variant_t pcvariant_get_trailing(enum purc_variant_type type)
+{
+    struct pcinst *instance = pcinst_current();
+    struct pcvariant_heap *heap = instance->variant_heap;
+    struct purc_variant_stat *stat = &(heap->stat);
+
+    if (heap->usage && !usage_check(heap->usage, sizeof(purc_variant)))
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t value;
+    value = pcvariant_slab_alloc_0(PCVARIANT_SLAB_VARIANT_EX);
+    if (value == NULL)
+        return PURC_VARIANT_INVALID;
+
+    // the trailing space is counted as the extra size
+    stat->sz_mem[type] += sizeof(purc_variant);
+    stat->sz_total_mem += sizeof(purc_variant);
+    pcvariant_stat_update_max_mem(stat);
+    stat->nr_values[type]++;
+    stat->nr_total_values++;
+    heap->nr_allocs++;
+    if (heap->usage)
+        usage_charge(heap->usage, 1, sizeof(purc_variant));
+
+    value->flags = PCVRNT_FLAG_TRAILING;
+    INIT_LIST_HEAD(&value->listeners);
 
     return value;
 }
@@ -505,6 +614,17 @@ void pcvariant_put(purc_variant_t value)
     // set stat information
     stat->nr_values[value->type]--;
     stat->nr_total_values--;
+    if (heap->usage)
+        usage_charge(heap->usage, -1, -(ssize_t)sizeof(purc_variant));
+
+    /* VWNOTE: never reserve a variant having trailing space. */
+    if (value->flags & PCVRNT_FLAG_TRAILING) {
+        stat->sz_mem[value->type] -= sizeof(purc_variant);
+        stat->sz_total_mem -= sizeof(purc_variant);
+
+        pcvariant_slab_free(PCVARIANT_SLAB_VARIANT_EX, value);
+        return;
+    }
 
 #if USE(LOOP_BUFFER_FOR_RESERVED)
     if ((heap->headpos + 1) % MAX_RESERVED_VARIANTS == heap->tailpos) {
@@ -536,6 +656,43 @@ void pcvariant_put(purc_variant_t value)
 #endif
 }
 
+size_t pcvariant_trim_reserved(size_t nr_keep)
+{
+    struct pcinst *instance = pcinst_current();
+    if (instance == NULL || instance->variant_heap == NULL)
+        return 0;
+
+    struct pcvariant_heap *heap = instance->variant_heap;
+    struct purc_variant_stat *stat = &(heap->stat);
+    size_t nr_freed = 0;
+
+    while (stat->nr_reserved > nr_keep) {
+        purc_variant_t value;
+#if USE(LOOP_BUFFER_FOR_RESERVED)
+        if (heap->headpos == heap->tailpos)
+            break;
+
+        value = heap->v_reserved[heap->tailpos];
+        heap->v_reserved[heap->tailpos] = NULL;
+        heap->tailpos = (heap->tailpos + 1) % MAX_RESERVED_VARIANTS;
+#else
+        if (list_empty(&heap->v_reserved))
+            break;
+
+        value = list_first_entry(&heap->v_reserved, purc_variant, reserved);
+        list_del(&value->reserved);
+#endif
+        stat->nr_reserved--;
+        stat->sz_mem[value->type] -= sizeof(purc_variant);
+        stat->sz_total_mem -= sizeof(purc_variant);
+
+        pcvariant_free(value);
+        nr_freed++;
+    }
+
+    return nr_freed * sizeof(purc_variant);
+}
+
 /* securely comparison of floating-point variables */
 static bool equal_doubles(double a, double b)
 {
@@ -710,7 +867,16 @@ bool purc_variant_is_equal_to(purc_variant_t v1, purc_variant_t v2)
                 len2 = v2->size;
             }
 
-            return (len1 == len2 && memcmp(str1, str2, len1) == 0);
+            if (len1 != len2)
+                return false;
+
+            /* both hashes cached: different hashes mean different strings */
+            if (v1->type == PURC_VARIANT_TYPE_STRING &&
+                    (v1->flags & v2->flags & PCVRNT_FLAG_STRING_HASHED) &&
+                    v1->str_hash != v2->str_hash)
+                return false;
+
+            return (str1 == str2 || memcmp(str1, str2, len1) == 0);
 
         case PURC_VARIANT_TYPE_DYNAMIC:
         case PURC_VARIANT_TYPE_NATIVE:
@@ -1591,6 +1757,37 @@ static int compare_string_method (purc_variant_t v1, purc_variant_t v2,
     return compare;
 }
 
+uint32_t
+pcvariant_compare_hash(purc_variant_t v, uint32_t hash,
+        bool caseless, bool *exact)
+{
+    char *buf;
+    char stackbuf[128];     /* must be same as compare_string_method() */
+
+    buf = compare_stringify (v, stackbuf, sizeof(stackbuf));
+    if (buf == NULL)
+        buf = stackbuf;
+
+    for (const unsigned char *p = (const unsigned char *)buf; *p; p++) {
+        unsigned char c = *p;
+        if (caseless) {
+            if (c >= 0x80)
+                *exact = false;
+            else
+                c = (unsigned char)purc_tolower(c);
+        }
+
+        /* FNV-1a */
+        hash ^= c;
+        hash *= 16777619U;
+    }
+
+    if (buf != stackbuf)
+        free (buf);
+
+    return hash;
+}
+
 int purc_variant_compare_ex (purc_variant_t v1,
         purc_variant_t v2, pcvrnt_compare_method_k opt)
 {
@@ -1646,6 +1843,11 @@ ret:
 purc_variant_t purc_variant_make_from_json_string(const char* json, size_t sz)
 {
     purc_variant_t value;
+
+    /* NOTE: plain JSON is built directly without the VCM tree */
+    if (pcejson_parse_plain(&value, json, sz, PCEJSON_DEFAULT_DEPTH) == 0)
+        return value;
+
     purc_rwstream_t rwstream = purc_rwstream_new_from_mem((void*)json, sz);
     if (rwstream == NULL)
         return PURC_VARIANT_INVALID;
@@ -1659,7 +1861,7 @@ purc_variant_t purc_variant_make_from_json_string(const char* json, size_t sz)
 purc_variant_t purc_variant_load_from_json_file(const char* file)
 {
     purc_variant_t value;
-    purc_rwstream_t rwstream = purc_rwstream_new_from_file(file, "r");
+    purc_rwstream_t rwstream = pcrwstream_new_for_reading(file);
     if (rwstream == NULL)
         return PURC_VARIANT_INVALID;
 
@@ -1669,44 +1871,67 @@ purc_variant_t purc_variant_load_from_json_file(const char* file)
     return value;
 }
 
-purc_variant_t purc_variant_load_dvobj_from_so (const char *so_name,
-        const char *var_name)
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+/*
+ * The shared libraries of the dynamic objects opened by the process. They
+ * are never closed, so the path search, dlopen(3) and dlsym(3) are done only
+ * once for a library, whichever instance loads it.
+ */
+struct pcvariant_dvobj_lib {
+    struct pcvariant_dvobj_lib *next;
+    void                       *handle;
+    pcvariant_dvobj_load_f      load;
+    char                        name[];
+};
+
+static struct pcvariant_dvobj_lib *dvobj_libs;
+static pthread_mutex_t dvobj_libs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct pcvariant_dvobj_lib *
+find_dvobj_lib(const char *name)
 {
-    PC_ASSERT(so_name || var_name);
+    struct pcvariant_dvobj_lib *lib;
 
-    purc_variant_t value = PURC_VARIANT_INVALID;
+    pthread_mutex_lock(&dvobj_libs_lock);
+    for (lib = dvobj_libs; lib; lib = lib->next) {
+        if (strcmp(lib->name, name) == 0)
+            break;
+    }
+    pthread_mutex_unlock(&dvobj_libs_lock);
 
-#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    return lib;
+}
+
+static void *
+dlopen_dvobj_lib(const char *so_name, const char *var_name,
+        char *so, size_t sz)
+{
     const char *ext = ".so";
 #   if OS(DARWIN)
     ext = ".dylib";
 #   endif
-    purc_variant_t val = PURC_VARIANT_INVALID;
-    int ver_code;
 
     void *library_handle = NULL;
-
-    char so[PATH_MAX+1];
     int n;
     do {
         if (so_name && strchr(so_name, '/')) {
             // let dlopen to handle path search
-            n = snprintf(so, sizeof(so), "%s", so_name);
-            PC_ASSERT(n>0 && (size_t)n<sizeof(so));
+            n = snprintf(so, sz, "%s", so_name);
+            PC_ASSERT(n>0 && (size_t)n<sz);
             library_handle = dlopen(so, RTLD_LAZY | RTLD_GLOBAL);
             break;
         }
         if (so_name && strchr(so_name, '.')) {
             // user specified dynamic library filename
-            n = snprintf(so, sizeof(so), "%s", so_name);
-            PC_ASSERT(n>0 && (size_t)n<sizeof(so));
+            n = snprintf(so, sz, "%s", so_name);
+            PC_ASSERT(n>0 && (size_t)n<sz);
         }
         else {
             // we build dynamic library filename
             // TODO: check validity of name!!!!
-            n = snprintf(so, sizeof(so), "libpurc-dvobj-%s%s",
+            n = snprintf(so, sz, "libpurc-dvobj-%s%s",
                     so_name ? so_name : var_name, ext);
-            PC_ASSERT(n>0 && (size_t)n<sizeof(so));
+            PC_ASSERT(n>0 && (size_t)n<sz);
         }
 
         /* XXX: the order of searching directories:
@@ -1732,10 +1957,10 @@ purc_variant_t purc_variant_load_dvobj_from_so (const char *so_name,
                     break;
                 }
 
-                n = snprintf(so, sizeof(so),
+                n = snprintf(so, sz,
                         "%s/libpurc-dvobj-%s%s",
                         dir, so_name ? so_name : var_name, ext);
-                PC_ASSERT(n>0 && (size_t)n<sizeof(so));
+                PC_ASSERT(n>0 && (size_t)n<sz);
                 library_handle = dlopen(so, RTLD_LAZY | RTLD_GLOBAL);
 
                 if (library_handle) {
@@ -1759,9 +1984,9 @@ purc_variant_t purc_variant_load_dvobj_from_so (const char *so_name,
         };
 
         for (size_t i = 0; i < PCA_TABLESIZE(other_tries); i++) {
-            n = snprintf(so, sizeof(so), other_tries[i],
+            n = snprintf(so, sz, other_tries[i],
                     ver, so_name ? so_name : var_name, ext);
-            PC_ASSERT(n>0 && (size_t)n<sizeof(so));
+            PC_ASSERT(n>0 && (size_t)n<sz);
             library_handle = dlopen(so, RTLD_LAZY | RTLD_GLOBAL);
             if (library_handle) {
                 break;
@@ -1770,57 +1995,151 @@ purc_variant_t purc_variant_load_dvobj_from_so (const char *so_name,
 
     } while (0);
 
-    if (!library_handle) {
+    return library_handle;
+}
+
+/* opens the library and adds it to the cache; does not set the error */
+static struct pcvariant_dvobj_lib *
+open_dvobj_lib(const char *so_name, const char *var_name,
+        char *so, size_t sz)
+{
+    const char *name = so_name ? so_name : var_name;
+    struct pcvariant_dvobj_lib *lib, *other;
+
+    lib = find_dvobj_lib(name);
+    if (lib)
+        return lib;
+
+    void *handle = dlopen_dvobj_lib(so_name, var_name, so, sz);
+    if (handle == NULL)
+        return NULL;
+
+    pcvariant_dvobj_load_f load;
+    load = (pcvariant_dvobj_load_f)dlsym(handle, EXOBJ_LOAD_ENTRY);
+    if (load == NULL) {
+        dlclose(handle);
+        return NULL;
+    }
+
+    size_t len = strlen(name);
+    lib = malloc(sizeof(*lib) + len + 1);
+    if (lib == NULL) {
+        dlclose(handle);
+        return NULL;
+    }
+    lib->handle = handle;
+    lib->load = load;
+    memcpy(lib->name, name, len + 1);
+
+    /* NOTE: another thread may have opened the library in the meantime */
+    pthread_mutex_lock(&dvobj_libs_lock);
+    for (other = dvobj_libs; other; other = other->next) {
+        if (strcmp(other->name, name) == 0)
+            break;
+    }
+    if (other == NULL) {
+        lib->next = dvobj_libs;
+        dvobj_libs = lib;
+    }
+    pthread_mutex_unlock(&dvobj_libs_lock);
+
+    if (other) {
+        free(lib);
+        dlclose(handle);
+        lib = other;
+    }
+
+    return lib;
+}
+#endif
+
+struct pcvariant_dvobj_lib *
+pcvariant_open_dvobj_lib(const char *so_name, const char *var_name)
+{
+    PC_ASSERT(so_name || var_name);
+
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    char so[PATH_MAX+1];
+
+    struct pcvariant_dvobj_lib *lib;
+    lib = open_dvobj_lib(so_name, var_name, so, sizeof(so));
+    if (lib == NULL) {
         purc_set_error_with_info(PURC_ERROR_BAD_SYSTEM_CALL,
                 "failed to load: %s", so);
-        return PURC_VARIANT_INVALID;
     }
 
-    purc_variant_t (* purcex_load_dynamic_variant)(const char *, int *);
+    return lib;
+#else
+    UNUSED_PARAM(so_name);
+    UNUSED_PARAM(var_name);
 
-    purcex_load_dynamic_variant = (purc_variant_t (*) (const char *, int *))
-        dlsym(library_handle, EXOBJ_LOAD_ENTRY);
-    if(dlerror() != NULL) {
-        pcinst_set_error (PURC_ERROR_BAD_SYSTEM_CALL);
-        dlclose(library_handle);
-        return PURC_VARIANT_INVALID;
-    }
+    // TODO: Add codes for other OS.
+    pcinst_set_error (PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+#endif
+}
 
-    value = purcex_load_dynamic_variant (var_name, &ver_code);
+bool
+pcvariant_preload_dvobj_lib(const char *so_name)
+{
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    char so[PATH_MAX+1];
+    return open_dvobj_lib(so_name, NULL, so, sizeof(so)) != NULL;
+#else
+    UNUSED_PARAM(so_name);
+    return false;
+#endif
+}
+
+purc_variant_t
+pcvariant_load_dvobj(struct pcvariant_dvobj_lib *lib, const char *var_name)
+{
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    purc_variant_t value, val;
+    int ver_code;
+
+    value = lib->load (var_name, &ver_code);
     if(value == PURC_VARIANT_INVALID) {
         pcinst_set_error (PURC_ERROR_BAD_SYSTEM_CALL);
-        dlclose(library_handle);
         return PURC_VARIANT_INVALID;
     }
 
     if (purc_variant_is_type (value, PURC_VARIANT_TYPE_OBJECT)) {
-        val = purc_variant_make_ulongint ((uint64_t)library_handle);
+        val = purc_variant_make_ulongint ((uint64_t)lib->handle);
         purc_variant_object_set_by_static_ckey (value,
                 EXOBJ_LOAD_HANDLE_KEY, val);
         purc_variant_unref (val);
     } else {
         pcinst_set_error (PURC_ERROR_BAD_SYSTEM_CALL);
         purc_variant_unref (value);
-        dlclose(library_handle);
         value = PURC_VARIANT_INVALID;
     }
 
+    return value;
 #else
-    UNUSED_PARAM(so_name);
+    UNUSED_PARAM(lib);
     UNUSED_PARAM(var_name);
 
-    // TODO: Add codes for other OS.
     pcinst_set_error (PURC_ERROR_NOT_SUPPORTED);
-    PC_ASSERT(0); // Not implemented yet
+    return PURC_VARIANT_INVALID;
 #endif
+}
 
-    return value;
+purc_variant_t purc_variant_load_dvobj_from_so (const char *so_name,
+        const char *var_name)
+{
+    PC_ASSERT(so_name || var_name);
+
+    struct pcvariant_dvobj_lib *lib;
+    lib = pcvariant_open_dvobj_lib(so_name, var_name);
+    if (lib == NULL)
+        return PURC_VARIANT_INVALID;
+
+    return pcvariant_load_dvobj(lib, var_name);
 }
 
 bool purc_variant_unload_dvobj (purc_variant_t dvobj)
 {
-    bool ret = true;
-
     if (dvobj == PURC_VARIANT_INVALID)  {
         pcinst_set_error (PURC_ERROR_ARGUMENT_MISSED);
         return false;
@@ -1844,23 +2163,14 @@ bool purc_variant_unload_dvobj (purc_variant_t dvobj)
         return false;
     }
 
-#if OS(LINUX) || OS(UNIX)
-    if (u64) {
-        purc_variant_unref (dvobj);
-        if (dlclose((void *)u64) != 0) {
-            pcinst_set_error (PURC_ERROR_BAD_SYSTEM_CALL);
-            ret = false;
-        }
-    } else {
+    if (u64 == 0) {
         pcinst_set_error (PURC_ERROR_BAD_SYSTEM_CALL);
-        ret = false;
+        return false;
     }
-#else
-    // TODO: Add codes for other OS.
-    pcinst_set_error (PURC_ERROR_NOT_SUPPORTED);
-#endif
 
-    return ret;
+    /* NOTE: the library is kept open in the cache; see open_dvobj_lib() */
+    purc_variant_unref (dvobj);
+    return true;
 }
 
 static double
@@ -1869,7 +2179,7 @@ numerify_str(const char *s)
     if (!s || !*s)
         return 0.0;
 
-    return strtod(s, NULL);
+    return pcutils_strtod(s, NULL);
 }
 
 static double
@@ -2335,7 +2645,7 @@ variant_stringify(struct stringify_arg *arg, purc_variant_t value)
             arg->cb(arg, &value->d, sizeof(double));
         }
         else {
-            snprintf(buf, sizeof(buf), "%g", value->d);
+            pcutils_dtoa_shortest(value->d, 6, buf);
             arg->cb(arg, buf, 0);
         }
         break;
@@ -2388,7 +2698,9 @@ variant_stringify(struct stringify_arg *arg, purc_variant_t value)
 
         bs = purc_variant_get_bytes_const(value, &nr);
         if (arg->flags & PCVRNT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES) {
-            arg->cb(arg, bs, nr);
+            /* NOTE: a zero length means a null-terminated string */
+            if (nr > 0)
+                arg->cb(arg, bs, nr);
         }
         else {
             stringify_bs(arg, bs, nr);
@@ -2420,33 +2732,70 @@ variant_stringify(struct stringify_arg *arg, purc_variant_t value)
     }
 }
 
-ssize_t
-purc_variant_stringify_buff(char *buf, size_t len, purc_variant_t value)
+struct stringify_buffer {
+    char                     *buf;
+    size_t                    sz_buf;   // not including the null byte
+    size_t                    accu;
+};
+
+static void
+do_stringify_buffer(struct stringify_arg *arg, const void *src, size_t len)
 {
-    PC_ASSERT(buf);
-    PC_ASSERT(len > 0);
+    struct stringify_buffer *ud;
+    ud = (struct stringify_buffer*)(arg->arg);
 
-    purc_rwstream_t stream;
-    stream = purc_rwstream_new_from_mem((void*)buf, len);
-    if (!stream)
-        return -1;
+    if (len == 0)
+        len = strlen(src);
 
-    unsigned int flags = 0;
-    ssize_t sz = purc_variant_stringify(stream, value, flags, NULL);
-    purc_rwstream_destroy(stream);
+    if (ud->accu < ud->sz_buf) {
+        size_t n = ud->sz_buf - ud->accu;
+        memcpy(ud->buf + ud->accu, src, (n < len) ? n : len);
+    }
 
-    if (sz == -1)
-        return -1;
+    ud->accu += len;
+}
 
-    PC_ASSERT((size_t)sz < len);
-    if ((size_t)sz < len) {
-        buf[sz] = '\0';
-    }
-    else {
-        buf[len-1] = '\0';
+ssize_t
+purc_variant_stringify_to_buff(char *buf, size_t sz_buf,
+        purc_variant_t value, unsigned int flags)
+{
+    if (value == PURC_VARIANT_INVALID || (buf == NULL && sz_buf > 0)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
     }
 
-    return sz;
+    struct stringify_buffer ud = {
+        .buf              = buf,
+        .sz_buf           = sz_buf ? sz_buf - 1 : 0,
+        .accu             = 0,
+    };
+
+    struct stringify_arg arg;
+    arg.cb    = do_stringify_buffer;
+    arg.arg   = &ud;
+    arg.flags = flags;
+
+    variant_stringify(&arg, value);
+
+    if (sz_buf > 0)
+        buf[(ud.accu < ud.sz_buf) ? ud.accu : ud.sz_buf] = '\0';
+
+    return ud.accu;
+}
+
+ssize_t
+purc_variant_stringify_length(purc_variant_t value, unsigned int flags)
+{
+    return purc_variant_stringify_to_buff(NULL, 0, value, flags);
+}
+
+ssize_t
+purc_variant_stringify_buff(char *buf, size_t len, purc_variant_t value)
+{
+    PC_ASSERT(buf);
+    PC_ASSERT(len > 0);
+
+    return purc_variant_stringify_to_buff(buf, len, value, 0);
 }
 
 struct stringify_stream {
@@ -2524,38 +2873,24 @@ purc_variant_stringify(purc_rwstream_t stream, purc_variant_t value,
 ssize_t
 purc_variant_stringify_alloc(char **strp, purc_variant_t value)
 {
-    purc_rwstream_t stream;
-    stream = purc_rwstream_new_buffer(0, 0);
-    if (!stream)
+    if (!strp)
         return -1;
 
-    unsigned int flags = 0;
-    ssize_t sz = purc_variant_stringify(stream, value, flags, NULL);
-    if (sz == -1) {
-        purc_rwstream_destroy(stream);
+    /* the first pass computes the exact length; no reallocation */
+    ssize_t len = purc_variant_stringify_length(value, 0);
+    if (len < 0)
         return -1;
-    }
 
-    if (!strp) {
-        purc_rwstream_destroy(stream);
+    char *p = malloc(len + 1);
+    if (p == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return -1;
     }
 
-    size_t sz_content, sz_buff;
-    bool res_buff = true;
-    char *p;
-    p = (char*)purc_rwstream_get_mem_buffer_ex(stream,
-            &sz_content, &sz_buff, res_buff);
-    purc_rwstream_destroy(stream);
-
-    PC_ASSERT(p);
-    PC_ASSERT(sz_buff >= 1);
-    PC_ASSERT(sz_content <= sz_buff);
-    p[sz_content] = '\0';
-
+    purc_variant_stringify_to_buff(p, len + 1, value, 0);
     *strp = p;
 
-    return sz_content;
+    return len;
 }
 
 ssize_t pcvariant_serialize(char *buf, size_t sz, purc_variant_t val)
@@ -2792,7 +3127,7 @@ struct purc_ejson_parsing_tree *
 purc_variant_ejson_parse_file(const char *fname)
 {
     struct purc_ejson_parsing_tree *ptree;
-    purc_rwstream_t rwstream = purc_rwstream_new_from_file(fname, "r");
+    purc_rwstream_t rwstream = pcrwstream_new_for_reading(fname);
     if (rwstream == NULL)
         return NULL;
 
@@ -2892,28 +3227,15 @@ cmp_by_arr(purc_variant_t l, purc_variant_t r,
     int diff;
 
     variant_arr_t ld, rd;
-    ld = (variant_arr_t)l->sz_ptr[1];
-    rd = (variant_arr_t)r->sz_ptr[1];
+    ld = variant_array_get_data(l);
+    rd = variant_array_get_data(r);
     PC_ASSERT(ld);
     PC_ASSERT(rd);
 
-    struct pcutils_array_list *la = &ld->al;
-    struct pcutils_array_list *ra = &rd->al;
-
-    struct pcutils_array_list_node *lnode = pcutils_array_list_get_first(la);
-    struct pcutils_array_list_node *rnode = pcutils_array_list_get_first(ra);
-
-    for (;
-        lnode && rnode;
-        lnode = pcutils_array_list_get(la, lnode->idx + 1),
-        rnode = pcutils_array_list_get(ra, rnode->idx + 1))
-    {
-        struct arr_node *lo, *ro;
-        lo = container_of(lnode, struct arr_node, node);
-        ro = container_of(rnode, struct arr_node, node);
-
-        purc_variant_t lv = lo->val;
-        purc_variant_t rv = ro->val;
+    size_t i;
+    for (i = 0; i < ld->nr && i < rd->nr; i++) {
+        purc_variant_t lv = ld->vals[i];
+        purc_variant_t rv = rd->vals[i];
         PC_ASSERT(lv != PURC_VARIANT_INVALID);
         PC_ASSERT(rv != PURC_VARIANT_INVALID);
 
@@ -2922,9 +3244,9 @@ cmp_by_arr(purc_variant_t l, purc_variant_t r,
             return diff;
     }
 
-    if (lnode)
+    if (i < ld->nr)
         return 1;
-    else if (rnode)
+    else if (i < rd->nr)
         return -1;
     else
         return 0;
@@ -3242,7 +3564,8 @@ stringify(char *buf, size_t len, purc_variant_t v)
             break;
 
         case PURC_VARIANT_TYPE_NUMBER:
-            nr = snprintf(buf, len, "%g", v->d);
+            PC_ASSERT(len >= PCUTILS_DTOA_BUFF_SIZE);
+            nr = pcutils_dtoa_shortest(v->d, 6, buf);
             break;
 
         case PURC_VARIANT_TYPE_LONGINT:
@@ -0,0 +1,356 @@
+/*
+ * @file bytecode.c
+ * @date 2026/10/14
+ * @brief The compiler and the interpreter of the flat bytecode of vcm.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+#include "purc-utils.h"
+#include "purc-errors.h"
+
+#include "private/errors.h"
+#include "private/interpreter.h"
+#include "private/utils.h"
+#include "private/vcm.h"
+
+#include "eval.h"
+#include "ops.h"
+
+/*
+ * A tree is compiled to the post-order sequence of its nodes: when the
+ * instruction of a node is executed, the results of all its children are
+ * ready in the evaluation nodes, just like the frames of eval_frame() leave
+ * them. So the instructions call the same `eval` operations of the nodes,
+ * but with a single frame reused for all nodes and without the recursion.
+ *
+ * Only the nodes evaluating all their children eagerly are compiled; a tree
+ * containing CJSONEE or setter calls is left to the frame interpreter.
+ *
+ * When an operation fails with PURC_ERROR_AGAIN, the frames from the root to
+ * the node are rebuilt, so that pcvcm_eval_again_full() can resume it with
+ * the frame interpreter.
+ */
+
+enum pcvcm_bc_op {
+    BC_OP_EVAL = 0,
+    BC_OP_ENTER_CONST,
+    BC_OP_END,
+};
+
+struct pcvcm_bc_inst {
+    struct pcvcm_eval_stack_frame_ops *ops;
+    uint32_t                op;
+    uint32_t                enode;      /* index of the evaluation node */
+    uint32_t                nr_params;
+    uint32_t                return_pos; /* position among the siblings */
+    uint32_t                jump;       /* the instruction after the subtree */
+};
+
+struct pcvcm_bc_link {
+    int32_t                 parent;     /* index of the parent node */
+    uint32_t                pos;        /* position among the siblings */
+};
+
+struct pcvcm_bytecode {
+    size_t                  nr_nodes;
+    size_t                  nr_insts;
+
+    /* the evaluation nodes as built by pcvcm_eval_build_nodes() */
+    struct pcvcm_eval_node *enodes;
+    struct pcvcm_bc_link   *links;
+    struct pcvcm_bc_inst   *insts;
+};
+
+void
+pcvcm_bytecode_destroy(struct pcvcm_bytecode *bc)
+{
+    if (bc == NULL || bc == PCVCM_BYTECODE_NONE)
+        return;
+
+    free(bc->enodes);
+    free(bc->links);
+    free(bc->insts);
+    free(bc);
+}
+
+static int
+emit_node(struct pcvcm_bytecode *bc, uint32_t idx, uint32_t return_pos,
+        bool in_const)
+{
+    struct pcvcm_eval_node *enode = bc->enodes + idx;
+    struct pcvcm_node *node = enode->node;
+
+    switch (node->type) {
+    case PCVCM_NODE_TYPE_FUNC_CALL_SETTER:
+    case PCVCM_NODE_TYPE_CJSONEE:
+    case PCVCM_NODE_TYPE_CJSONEE_OP_AND:
+    case PCVCM_NODE_TYPE_CJSONEE_OP_OR:
+    case PCVCM_NODE_TYPE_CJSONEE_OP_SEMICOLON:
+        return -1;
+
+    default:
+        break;
+    }
+
+    /* only the root of a constant subtree checks the cached value */
+    size_t enter = 0;
+    bool is_const = (node->const_state == PCVCM_NODE_CONST_YES);
+    bool is_cached = (is_const && !in_const && node->stamp);
+    if (is_cached) {
+        enter = bc->nr_insts++;
+        bc->insts[enter].op = BC_OP_ENTER_CONST;
+        bc->insts[enter].enode = idx;
+    }
+
+    uint32_t nr_params = pcvcm_node_children_count(node);
+    for (uint32_t i = 0; i < nr_params; i++) {
+        uint32_t child = enode->first_child_idx + i;
+        bc->links[child].parent = idx;
+        bc->links[child].pos = i;
+        if (emit_node(bc, child, i, is_const))
+            return -1;
+    }
+
+    struct pcvcm_bc_inst *inst = bc->insts + bc->nr_insts++;
+    inst->op = BC_OP_EVAL;
+    inst->ops = pcvcm_eval_get_ops_by_node(node);
+    inst->enode = idx;
+    inst->nr_params = nr_params;
+    inst->return_pos = return_pos;
+
+    if (is_cached) {
+        bc->insts[enter].jump = bc->nr_insts;
+    }
+    return 0;
+}
+
+struct pcvcm_bytecode *
+pcvcm_bytecode_compile(struct pcvcm_node *tree)
+{
+    PC_ASSERT(tree->nr_nodes > 0);
+
+    size_t nr_nodes = tree->nr_nodes;
+    struct pcvcm_bytecode *bc = calloc(1, sizeof(*bc));
+    if (bc == NULL)
+        goto failed;
+
+    bc->nr_nodes = nr_nodes;
+    bc->enodes = calloc(nr_nodes, sizeof(struct pcvcm_eval_node));
+    bc->links = calloc(nr_nodes, sizeof(struct pcvcm_bc_link));
+    /* one instruction per node, one per constant subtree, and the end */
+    bc->insts = calloc(nr_nodes * 2 + 1, sizeof(struct pcvcm_bc_inst));
+    if (bc->enodes == NULL || bc->links == NULL || bc->insts == NULL)
+        goto failed;
+
+    struct pcvcm_eval_ctxt ctxt = { 0 };
+    ctxt.eval_nodes = bc->enodes;
+    ctxt.nr_eval_nodes = nr_nodes;
+    pcvcm_eval_build_nodes(&ctxt, tree);
+
+    bc->links[0].parent = -1;
+    if (emit_node(bc, 0, 0, false))
+        goto failed;
+
+    bc->insts[bc->nr_insts++].op = BC_OP_END;
+    return bc;
+
+failed:
+    /* NOTE: not an error; the tree is simply left to the frame interpreter */
+    pcvcm_bytecode_destroy(bc);
+    return PCVCM_BYTECODE_NONE;
+}
+
+/* rebuild the frames from the root to the node as eval_frame() leaves them */
+static void
+rebuild_frames(struct pcvcm_bytecode *bc, struct pcvcm_eval_ctxt *ctxt,
+        int32_t idx)
+{
+    int32_t depth = 0;
+    for (int32_t i = idx; bc->links[i].parent >= 0; i = bc->links[i].parent)
+        depth++;
+
+    purc_variant_t args = ctxt->frames[0].args;
+    int32_t child = -1;
+    for (int32_t level = depth, i = idx; level >= 0; level--) {
+        struct pcvcm_eval_stack_frame *frame = ctxt->frames + level;
+        struct pcvcm_node *node = ctxt->eval_nodes[i].node;
+
+        frame->ops = pcvcm_eval_get_ops_by_node(node);
+        frame->node = node;
+        frame->args = PURC_VARIANT_INVALID;
+        frame->eval_node_idx = i;
+        frame->nr_params = pcvcm_node_children_count(node);
+        frame->return_pos = (level > 0) ? bc->links[i].pos : 0;
+        frame->idx = level;
+        if (child < 0) {
+            /* the node itself has been pushed and its params evaluated */
+            frame->pos = frame->nr_params;
+            frame->step = STEP_EVAL_VCM;
+        }
+        else {
+            frame->pos = bc->links[child].pos;
+            frame->step = STEP_AFTER_PUSH;
+        }
+
+        child = i;
+        i = bc->links[i].parent;
+    }
+
+    ctxt->frames[0].args = args;
+    ctxt->frame_idx = depth;
+}
+
+#if COMPILER(GCC_COMPATIBLE)
+#define BC_DISPATCH()       goto *dispatch_table[inst->op]
+#define BC_CASE(op)         label_ ## op
+#else
+#define BC_DISPATCH()       goto dispatch
+#define BC_CASE(op)         case op
+#endif
+
+purc_variant_t
+pcvcm_bytecode_eval(struct pcvcm_bytecode *bc, struct pcvcm_eval_ctxt *ctxt,
+        purc_variant_t args, find_var_fn find_var, void *find_var_ctxt,
+        bool silently)
+{
+#if COMPILER(GCC_COMPATIBLE)
+    static const void *dispatch_table[] = {
+        [BC_OP_EVAL] = &&label_BC_OP_EVAL,
+        [BC_OP_ENTER_CONST] = &&label_BC_OP_ENTER_CONST,
+        [BC_OP_END] = &&label_BC_OP_END,
+    };
+#endif
+
+    purc_variant_t result = PURC_VARIANT_INVALID;
+    const struct pcvcm_bc_inst *inst = bc->insts;
+    struct pcvcm_eval_node *enode;
+    purc_variant_t val;
+
+    ctxt->find_var = find_var;
+    ctxt->find_var_ctxt = find_var_ctxt;
+    if (silently) {
+        ctxt->flags |= PCVCM_EVAL_FLAG_SILENTLY;
+    }
+
+    memcpy(ctxt->eval_nodes, bc->enodes,
+            sizeof(struct pcvcm_eval_node) * bc->nr_nodes);
+    ctxt->eval_nodes_insert_pos = bc->nr_nodes;
+
+    /* the only frame, which is reused by all nodes and holds the args */
+    struct pcvcm_eval_stack_frame *frame = ctxt->frames;
+    ctxt->frame_idx = 0;
+    frame->idx = 0;
+    frame->args = args ? purc_variant_ref(args) : PURC_VARIANT_INVALID;
+
+#if COMPILER(GCC_COMPATIBLE)
+    BC_DISPATCH();
+#else
+dispatch:
+    switch (inst->op)
+#endif
+    {
+    BC_CASE(BC_OP_ENTER_CONST):
+        enode = ctxt->eval_nodes + inst->enode;
+        val = PURC_VARIANT_INVALID;
+        if (ctxt->consts) {
+            val = pcvcm_eval_get_const_value(ctxt, enode->node);
+        }
+        if (val == PURC_VARIANT_INVALID) {
+            inst++;
+            BC_DISPATCH();
+        }
+
+        /* skip to the instruction of the subtree root (the same node) */
+        inst = bc->insts + inst->jump - 1;
+        goto done_node;
+
+    BC_CASE(BC_OP_EVAL):
+        enode = ctxt->eval_nodes + inst->enode;
+        frame->ops = inst->ops;
+        frame->node = enode->node;
+        frame->eval_node_idx = inst->enode;
+        frame->nr_params = inst->nr_params;
+        frame->pos = inst->nr_params;
+        frame->return_pos = inst->return_pos;
+        frame->step = STEP_EVAL_VCM;
+
+        val = PURC_VARIANT_INVALID;
+        if (frame->ops->after_pushed(ctxt, frame) == PURC_ERROR_OK) {
+            const char *name = NULL;
+            val = frame->ops->eval(ctxt, frame, &name);
+        }
+
+        if (val == PURC_VARIANT_INVALID) {
+            goto failed;
+        }
+        if (enode->node->const_state == PCVCM_NODE_CONST_YES &&
+                enode->node->stamp && ctxt->consts) {
+            val = pcvcm_eval_cache_const_value(ctxt, enode->node, val);
+        }
+        goto done_node;
+
+    BC_CASE(BC_OP_END):
+        goto out;
+    }
+
+failed:
+    ctxt->err = purc_get_last_error();
+    if (ctxt->err == PURC_ERROR_AGAIN) {
+        rebuild_frames(bc, ctxt, inst->enode);
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* like eval_frame(), take the failed node as undefined silently */
+    if (!silently) {
+        goto out;
+    }
+    val = purc_variant_make_undefined();
+
+done_node:
+    /* the root result is not kept in the evaluation nodes */
+    if (inst->enode == 0) {
+        result = val;
+    }
+    else {
+        ctxt->eval_nodes[inst->enode].result = val;
+    }
+    inst++;
+    BC_DISPATCH();
+
+out:
+    if (frame->args) {
+        purc_variant_unref(frame->args);
+        frame->args = PURC_VARIANT_INVALID;
+    }
+    ctxt->frame_idx = -1;
+
+    ctxt->err = purc_get_last_error();
+    if (result) {
+        if (ctxt->result) {
+            purc_variant_unref(ctxt->result);
+        }
+        ctxt->result = purc_variant_ref(result);
+    }
+    return result;
+}
@@ -36,11 +36,14 @@
 #include "private/stack.h"
 #include "private/interpreter.h"
 #include "private/utils.h"
+#include "private/variant.h"
+#include "private/trace.h"
 
 #include "eval.h"
 #include "ops.h"
 
 #define PURC_ENVV_VCM_LOG_ENABLE    "PURC_VCM_LOG_ENABLE"
+#define PURC_ENVV_VCM_BYTECODE      "PURC_VCM_BYTECODE"
 
 static const char *stepnames[] = {
     STEP_NAME_AFTER_PUSH,
@@ -55,15 +58,132 @@ pcvcm_eval_stack_frame_step_name(enum pcvcm_eval_stack_frame_step type)
     return stepnames[type];
 }
 
+/*
+ * NOTE: the evaluation contexts kept on the heap, i.e. the ones duplicated
+ * for a suspended or failed evaluation by pcvcm_eval_ctxt_dup(), are
+ * recycled per coroutine: a destroyed context is reset and put back to the
+ * pool of the running coroutine along with its arrays, which are reused by
+ * the next context if they are large enough.
+ */
+#define NR_POOLED_CTXTS         16
+#define MAX_POOLED_NODES        1024
+
+struct pcvcm_eval_ctxt_pool {
+    struct pcvcm_eval_ctxt     *ctxts[NR_POOLED_CTXTS];
+    size_t                      nr_ctxts;
+    struct pcvcm_eval_pool_stat stat;
+};
+
+static struct pcvcm_eval_ctxt_pool *
+coroutine_ctxt_pool(bool create)
+{
+    pcintr_coroutine_t co = pcintr_get_coroutine();
+    if (co == NULL) {
+        return NULL;
+    }
+
+    if (co->vcm_ctxt_pool == NULL && create) {
+        co->vcm_ctxt_pool = calloc(1, sizeof(struct pcvcm_eval_ctxt_pool));
+    }
+    return co->vcm_ctxt_pool;
+}
+
+static void
+free_ctxt(struct pcvcm_eval_ctxt *ctxt)
+{
+    free(ctxt->eval_nodes);
+    free(ctxt->frames);
+#ifdef PCVCM_KEEP_NAME
+    free(ctxt->names);
+#endif
+    free(ctxt);
+}
+
+void
+pcvcm_eval_ctxt_pool_destroy(struct pcvcm_eval_ctxt_pool *pool)
+{
+    if (pool == NULL)
+        return;
+
+    PC_DEBUG("vcm eval contexts: %zu reused, %zu allocated\n",
+            pool->stat.nr_hits, pool->stat.nr_misses);
+    for (size_t i = 0; i < pool->nr_ctxts; i++) {
+        free_ctxt(pool->ctxts[i]);
+    }
+    free(pool);
+}
+
+int
+pcvcm_eval_get_pool_stat(struct pcvcm_eval_pool_stat *stat)
+{
+    struct pcvcm_eval_ctxt_pool *pool = coroutine_ctxt_pool(false);
+    if (pool == NULL) {
+        memset(stat, 0, sizeof(*stat));
+        return -1;
+    }
+
+    *stat = pool->stat;
+    return 0;
+}
+
+/* makes sure the arrays of a context on the heap are large enough */
+static int
+reserve_arrays(struct pcvcm_eval_ctxt *ctxt, size_t nr_eval_nodes,
+        size_t nr_frames)
+{
+    if (nr_eval_nodes > ctxt->sz_eval_nodes) {
+        struct pcvcm_eval_node *eval_nodes = realloc(ctxt->eval_nodes,
+                nr_eval_nodes * sizeof(struct pcvcm_eval_node));
+        if (eval_nodes == NULL) {
+            goto failed;
+        }
+        ctxt->eval_nodes = eval_nodes;
+        ctxt->sz_eval_nodes = nr_eval_nodes;
+    }
+
+    if (nr_frames > ctxt->sz_frames) {
+        struct pcvcm_eval_stack_frame *frames = realloc(ctxt->frames,
+                nr_frames * sizeof(struct pcvcm_eval_stack_frame));
+        if (frames == NULL) {
+            goto failed;
+        }
+        ctxt->frames = frames;
+
+#ifdef PCVCM_KEEP_NAME
+        const char **names = realloc(ctxt->names, nr_frames * sizeof(char *));
+        if (names == NULL) {
+            goto failed;
+        }
+        ctxt->names = names;
+#endif
+        ctxt->sz_frames = nr_frames;
+    }
+    return 0;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return -1;
+}
+
 struct pcvcm_eval_ctxt *
 pcvcm_eval_ctxt_create()
 {
     struct pcvcm_eval_ctxt *ctxt;
+    struct pcvcm_eval_ctxt_pool *pool = coroutine_ctxt_pool(true);
+    if (pool && pool->nr_ctxts) {
+        ctxt = pool->ctxts[--pool->nr_ctxts];
+        pool->stat.nr_hits++;
+        goto out;
+    }
+
     ctxt = (struct pcvcm_eval_ctxt*)calloc(1,sizeof(*ctxt));
     if (!ctxt) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto out;
     }
+    if (pool) {
+        pool->stat.nr_misses++;
+    }
 
     ctxt->free_on_destroy = 1;
 out:
@@ -77,19 +197,32 @@ pcvcm_eval_ctxt_dup(struct pcvcm_eval_ctxt *src)
     if (!ctxt) {
         goto out;
     }
+
+    if (reserve_arrays(ctxt, src->nr_eval_nodes, src->nr_frames)) {
+        free_ctxt(ctxt);
+        ctxt = NULL;
+        goto out;
+    }
+
+    /* keep the arrays of the new context */
+    struct pcvcm_eval_ctxt arrays = *ctxt;
     *ctxt = *src;
+    ctxt->eval_nodes = arrays.eval_nodes;
+    ctxt->sz_eval_nodes = arrays.sz_eval_nodes;
+    ctxt->frames = arrays.frames;
+    ctxt->sz_frames = arrays.sz_frames;
+#ifdef PCVCM_KEEP_NAME
+    ctxt->names = arrays.names;
+#endif
 
     size_t nr_bytes = ctxt->nr_eval_nodes * sizeof(struct pcvcm_eval_node);
-    ctxt->eval_nodes = (struct pcvcm_eval_node *) malloc(nr_bytes);
     memcpy(ctxt->eval_nodes, src->eval_nodes, nr_bytes);
 
     nr_bytes = ctxt->nr_frames * sizeof(struct pcvcm_eval_stack_frame);
-    ctxt->frames = (struct pcvcm_eval_stack_frame *) malloc(nr_bytes);
     memcpy(ctxt->frames, src->frames, nr_bytes);
 
 #ifdef PCVCM_KEEP_NAME
     nr_bytes = ctxt->nr_frames * sizeof(char *);
-    ctxt->names = (const char **) malloc (nr_bytes);
     memcpy(ctxt->names, src->names, nr_bytes);
 #endif
 
@@ -122,14 +255,29 @@ pcvcm_eval_ctxt_destroy(struct pcvcm_eval_ctxt *ctxt)
         }
     }
 
-    if (ctxt->free_on_destroy) {
-        free(ctxt->eval_nodes);
-        free(ctxt->frames);
+    if (!ctxt->free_on_destroy) {
+        return;
+    }
+
+    /* NOTE: never create the pool here; the coroutine may be released */
+    struct pcvcm_eval_ctxt_pool *pool = coroutine_ctxt_pool(false);
+    if (pool == NULL || pool->nr_ctxts >= NR_POOLED_CTXTS ||
+            ctxt->sz_eval_nodes > MAX_POOLED_NODES) {
+        free_ctxt(ctxt);
+        return;
+    }
+
+    struct pcvcm_eval_ctxt arrays = *ctxt;
+    memset(ctxt, 0, sizeof(*ctxt));
+    ctxt->eval_nodes = arrays.eval_nodes;
+    ctxt->sz_eval_nodes = arrays.sz_eval_nodes;
+    ctxt->frames = arrays.frames;
+    ctxt->sz_frames = arrays.sz_frames;
 #ifdef PCVCM_KEEP_NAME
-        free(ctxt->names);
+    ctxt->names = arrays.names;
 #endif
-        free(ctxt);
-    }
+    ctxt->free_on_destroy = 1;
+    pool->ctxts[pool->nr_ctxts++] = ctxt;
 }
 
 int
@@ -558,6 +706,217 @@ has_fatal_error(int err)
     return (err == PURC_ERROR_OUT_OF_MEMORY);
 }
 
+/*
+ * NOTE: the values of the constant nodes are cached per coroutine, and
+ * only for the trees evaluated repeatedly. An immutable value is shared by
+ * reference; a container is mutable, so a deep clone of the cached one is
+ * returned each time.
+ *
+ * The cache is keyed by the node; the stamp tells a node from the one of a
+ * destroyed tree which was at the same address.
+ */
+#define MAX_CONST_ENTRIES       1024
+
+struct const_entry {
+    uint64_t                stamp;
+    purc_variant_t          value;
+};
+
+static void
+free_const_entry(void *val)
+{
+    struct const_entry *entry = (struct const_entry *)val;
+    purc_variant_unref(entry->value);
+    free(entry);
+}
+
+static pcutils_uomap *
+coroutine_consts(void)
+{
+    pcintr_coroutine_t co = pcintr_get_coroutine();
+    if (co == NULL) {
+        return NULL;
+    }
+
+    if (co->vcm_consts == NULL) {
+        co->vcm_consts = pcutils_uomap_create(NULL, NULL, NULL,
+                free_const_entry, pchash_fnv1a_ptr_hash, pchash_ptr_equal,
+                false, false);
+    }
+    return co->vcm_consts;
+}
+
+purc_variant_t
+pcvcm_eval_get_const_value(struct pcvcm_eval_ctxt *ctxt,
+        struct pcvcm_node *node)
+{
+    pcutils_uomap_entry *entry = pcutils_uomap_find(ctxt->consts, node);
+    if (entry == NULL) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct const_entry *ce = (struct const_entry *)
+        pcutils_uomap_entry_val(entry);
+    if (ce->stamp != node->stamp) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (!pcvariant_is_mutable(ce->value)) {
+        return purc_variant_ref(ce->value);
+    }
+
+    purc_variant_t cloned = purc_variant_container_clone_recursively(
+            ce->value);
+    if (cloned == PURC_VARIANT_INVALID) {
+        /* not fatal; evaluate the node instead */
+        purc_clr_error();
+    }
+    return cloned;
+}
+
+purc_variant_t
+pcvcm_eval_cache_const_value(struct pcvcm_eval_ctxt *ctxt,
+        struct pcvcm_node *node, purc_variant_t result)
+{
+    purc_variant_t ret = result;
+    if (pcvariant_is_mutable(result)) {
+        ret = purc_variant_container_clone_recursively(result);
+        if (ret == PURC_VARIANT_INVALID) {
+            /* not fatal; just give up caching */
+            purc_clr_error();
+            return result;
+        }
+    }
+    else {
+        purc_variant_ref(result);
+    }
+
+    struct const_entry *entry = malloc(sizeof(*entry));
+    if (entry == NULL) {
+        purc_variant_unref(result);
+        return ret;
+    }
+    entry->stamp = node->stamp;
+    entry->value = result;
+
+    /* the entries for the nodes of destroyed trees are never hit again */
+    if (pcutils_uomap_get_size(ctxt->consts) >= MAX_CONST_ENTRIES) {
+        pcutils_uomap_clear(ctxt->consts);
+    }
+
+    if (pcutils_uomap_replace_or_insert(ctxt->consts, node, entry, NULL)) {
+        free_const_entry(entry);
+    }
+    return ret;
+}
+
+/*
+ * NOTE: the inline caches of the element getters with a constant key, such
+ * as `$DATA.count`, live in a direct-mapped table per coroutine, indexed by
+ * the stamp of the getter node.
+ *
+ * An entry keeps a reference to the receiver, so that another object can
+ * not take its address, and the generation of its members; the cached
+ * member is held by the receiver, and it is valid as long as the generation
+ * of the receiver is not changed.
+ */
+#define NR_INLINE_CACHES        64
+
+struct pcvcm_inline_cache {
+    uint64_t                stamp;      /* the stamp of the getter node */
+    purc_variant_t          receiver;
+    uint32_t                gen;
+    purc_variant_t          member;     /* not referenced */
+    purc_dvariant_method    getter;     /* the getter of a dynamic member */
+};
+
+void
+pcvcm_inline_caches_destroy(struct pcvcm_inline_cache *ics)
+{
+    if (ics == NULL)
+        return;
+
+    for (size_t i = 0; i < NR_INLINE_CACHES; i++) {
+        if (ics[i].receiver) {
+            purc_variant_unref(ics[i].receiver);
+        }
+    }
+    free(ics);
+}
+
+static struct pcvcm_inline_cache *
+coroutine_inline_caches(void)
+{
+    pcintr_coroutine_t co = pcintr_get_coroutine();
+    if (co == NULL) {
+        return NULL;
+    }
+
+    if (co->vcm_ics == NULL) {
+        co->vcm_ics = calloc(NR_INLINE_CACHES,
+                sizeof(struct pcvcm_inline_cache));
+    }
+    return co->vcm_ics;
+}
+
+/*
+ * NOTE: the resolutions of the variables are cached only if they are found
+ * in the stack of the running coroutine; see pcintr_find_named_var_cached().
+ */
+static struct pcintr_var_slot *
+coroutine_var_slots(void *find_var_ctxt)
+{
+    pcintr_coroutine_t co = pcintr_get_coroutine();
+    if (co == NULL || find_var_ctxt != &co->stack) {
+        return NULL;
+    }
+
+    return pcintr_get_var_slots(&co->stack);
+}
+
+purc_variant_t
+pcvcm_eval_ic_lookup(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_node *node,
+        purc_variant_t receiver, purc_dvariant_method *getter)
+{
+    if (ctxt->ics == NULL || node->stamp == 0) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct pcvcm_inline_cache *ic =
+        ctxt->ics + (node->stamp % NR_INLINE_CACHES);
+    if (ic->stamp != node->stamp || ic->receiver != receiver ||
+            ic->gen != pcvariant_object_generation(receiver)) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    *getter = ic->getter;
+    return ic->member;
+}
+
+void
+pcvcm_eval_ic_update(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_node *node,
+        purc_variant_t receiver, purc_variant_t member)
+{
+    if (ctxt->ics == NULL || node->stamp == 0) {
+        return;
+    }
+
+    struct pcvcm_inline_cache *ic =
+        ctxt->ics + (node->stamp % NR_INLINE_CACHES);
+    if (ic->receiver != receiver) {
+        if (ic->receiver) {
+            purc_variant_unref(ic->receiver);
+        }
+        ic->receiver = purc_variant_ref(receiver);
+    }
+
+    ic->stamp = node->stamp;
+    ic->gen = pcvariant_object_generation(receiver);
+    ic->member = member;
+    ic->getter = purc_variant_is_dynamic(member) ?
+        purc_variant_dynamic_get_getter(member) : NULL;
+}
+
 purc_variant_t
 eval_frame(struct pcvcm_eval_ctxt *ctxt, int32_t frame_idx, size_t return_pos,
         const char **name)
@@ -581,6 +940,16 @@ eval_frame(struct pcvcm_eval_ctxt *ctxt, int32_t frame_idx, size_t return_pos,
     while (frame->step != STEP_DONE) {
         switch (frame->step) {
             case STEP_AFTER_PUSH:
+                if (frame->node->const_state == PCVCM_NODE_CONST_YES &&
+                        frame->node->stamp && ctxt->consts) {
+                    result = pcvcm_eval_get_const_value(ctxt, frame->node);
+                    if (result) {
+                        frame->step = STEP_DONE;
+                        ctxt->frames[frame_idx] = frame_tmp;
+                        break;
+                    }
+                }
+
                 ret = frame->ops->after_pushed(ctxt, frame);
                 if (ret != PURC_ERROR_OK) {
                     goto out;
@@ -630,6 +999,11 @@ eval_frame(struct pcvcm_eval_ctxt *ctxt, int32_t frame_idx, size_t return_pos,
                 if (!result) {
                     goto out;
                 }
+                if (frame->node->const_state == PCVCM_NODE_CONST_YES &&
+                        frame->node->stamp && ctxt->consts) {
+                    result = pcvcm_eval_cache_const_value(ctxt, frame->node,
+                            result);
+                }
                 frame->step = STEP_DONE;
                 ctxt->frames[frame_idx] = frame_tmp;
                 break;
@@ -747,6 +1121,15 @@ static void assign_idx_cb(struct pctree_node *node,  void *data)
     n->idx = (*idx)++;
 }
 
+void
+pcvcm_node_prepare(struct pcvcm_node *tree)
+{
+    int idx = 0;
+    pctree_node_level_order_traversal(&tree->tree_node, assign_idx_cb, &idx);
+    pcvcm_node_compile(tree);
+    tree->nr_nodes = idx;
+}
+
 static void build_eval_nodes_cb(struct pctree_node *node, void *data)
 {
     struct pcvcm_eval_ctxt *ctxt = (struct pcvcm_eval_ctxt *) data;
@@ -778,7 +1161,7 @@ static void build_eval_node_children(struct pctree_node *node, void *data)
     pctree_node_children_for_each(node, build_eval_node_children, data);
 }
 
-static void build_eval_nodes(struct pcvcm_eval_ctxt *ctxt,
+void pcvcm_eval_build_nodes(struct pcvcm_eval_ctxt *ctxt,
         struct pcvcm_node *node)
 {
     struct pcvcm_eval_node *p = ctxt->eval_nodes + ctxt->eval_nodes_insert_pos;
@@ -806,6 +1189,46 @@ is_log_enable()
     return _enable_log;
 }
 
+static int _use_bytecode = -1;
+
+/* the bytecode is used unless PURC_VCM_BYTECODE is set to 0 or false */
+static bool
+is_bytecode_enable()
+{
+    if (_use_bytecode < 0) {
+        const char *env_value = getenv(PURC_ENVV_VCM_BYTECODE);
+        _use_bytecode = !(env_value && (*env_value == '0' ||
+                pcutils_strcasecmp(env_value, "false") == 0));
+    }
+    return _use_bytecode;
+}
+
+
+/*
+ * NOTE: a vdom may be shared by the instances, so the bytecode of a tree is
+ * published atomically, and the one compiled by a loser is destroyed.
+ */
+static struct pcvcm_bytecode *
+get_bytecode(struct pcvcm_node *tree)
+{
+#if COMPILER(GCC_COMPATIBLE)
+    struct pcvcm_bytecode *bc = __atomic_load_n(&tree->bytecode,
+            __ATOMIC_ACQUIRE);
+    if (bc == NULL) {
+        struct pcvcm_bytecode *expected = NULL;
+        bc = pcvcm_bytecode_compile(tree);
+        if (!__atomic_compare_exchange_n(&tree->bytecode, &expected, bc,
+                    false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            pcvcm_bytecode_destroy(bc);
+            bc = expected;
+        }
+    }
+    return (bc == PCVCM_BYTECODE_NONE) ? NULL : bc;
+#else
+    UNUSED_PARAM(tree);
+    return NULL;
+#endif
+}
 
 static int i = 0;
 purc_variant_t pcvcm_eval_full(struct pcvcm_node *tree,
@@ -817,8 +1240,11 @@ purc_variant_t pcvcm_eval_full(struct pcvcm_node *tree,
     struct pcvcm_eval_ctxt contxt = {0};
     struct pcvcm_eval_ctxt *ctxt = &contxt;
     unsigned int enable_log = is_log_enable();
+    struct pcvcm_bytecode *bytecode = NULL;
+    bool evaluated_before = false;
     int err;
     int32_t nr_nodes = 0;
+    uint64_t span = pctrace_begin();
 
     if (enable_log) {
         size_t len;
@@ -835,10 +1261,14 @@ purc_variant_t pcvcm_eval_full(struct pcvcm_node *tree,
     }
     else {
         if (tree->nr_nodes == -1) {
-            int idx = 0;
-            pctree_node_level_order_traversal(&tree->tree_node, assign_idx_cb,
-                    &idx);
-            tree->nr_nodes = idx;
+            pcvcm_node_prepare(tree);
+        }
+        else {
+            evaluated_before = true;
+            /* compile the tree when it is evaluated for the second time */
+            if (!enable_log && is_bytecode_enable()) {
+                bytecode = get_bytecode(tree);
+            }
         }
         nr_nodes = tree->nr_nodes;
     }
@@ -862,10 +1292,21 @@ purc_variant_t pcvcm_eval_full(struct pcvcm_node *tree,
         memset(names, 0, sizeof(names));
 #endif
 
-        build_eval_nodes(ctxt, tree);
+        if (evaluated_before) {
+            ctxt->consts = coroutine_consts();
+            ctxt->ics = coroutine_inline_caches();
+            ctxt->var_slots = coroutine_var_slots(find_var_ctxt);
+        }
 
-        result = eval_vcm(ctxt->eval_nodes, ctxt, args, find_var, find_var_ctxt, silently,
-                false, false);
+        if (bytecode) {
+            result = pcvcm_bytecode_eval(bytecode, ctxt, args,
+                    find_var, find_var_ctxt, silently);
+        }
+        else {
+            pcvcm_eval_build_nodes(ctxt, tree);
+            result = eval_vcm(ctxt->eval_nodes, ctxt, args, find_var,
+                    find_var_ctxt, silently, false, false);
+        }
     }
 
     err = purc_get_last_error();
@@ -907,6 +1348,8 @@ purc_variant_t pcvcm_eval_full(struct pcvcm_node *tree,
             *ctxt_out = NULL;
         }
     }
+
+    pctrace_end(span, PCTRACE_CAT_VCM, bytecode ? "eval_bytecode" : "eval");
     return result;
 }
 
@@ -917,6 +1360,7 @@ purc_variant_t pcvcm_eval_again_full(struct pcvcm_node *tree,
 {
     purc_variant_t result = PURC_VARIANT_INVALID;
     unsigned int enable_log = is_log_enable();
+    uint64_t span = pctrace_begin();
 
     if (enable_log) {
         size_t len;
@@ -928,10 +1372,7 @@ purc_variant_t pcvcm_eval_again_full(struct pcvcm_node *tree,
     if (ctxt) {
         ctxt->enable_log = enable_log;
         if (ctxt->node->nr_nodes == -1) {
-            int idx = 0;
-            pctree_node_level_order_traversal(&ctxt->node->tree_node, assign_idx_cb,
-                    &idx);
-            tree->nr_nodes = idx;
+            pcvcm_node_prepare(ctxt->node);
         }
 
         /* clear AGAIN error */
@@ -962,6 +1403,8 @@ purc_variant_t pcvcm_eval_again_full(struct pcvcm_node *tree,
         free(s);
         PLOG("end %d\n\n", i++);
     }
+
+    pctrace_end(span, PCTRACE_CAT_VCM, "eval_again");
     return result;
 }
 
@@ -978,30 +1421,20 @@ purc_variant_t pcvcm_eval_sub_expr_full(struct pcvcm_node *tree,
     }
     else {
         if (tree->nr_nodes == -1) {
-            int idx = 0;
-            pctree_node_level_order_traversal(&tree->tree_node, assign_idx_cb,
-                    &idx);
-            tree->nr_nodes = idx;
+            pcvcm_node_prepare(tree);
         }
 
-        ctxt->nr_eval_nodes = ctxt->nr_eval_nodes + tree->nr_nodes;
-        ctxt->eval_nodes = (struct pcvcm_eval_node *) realloc(ctxt->eval_nodes,
-                ctxt->nr_eval_nodes * sizeof(struct pcvcm_eval_node));
-
-
-        if (ctxt->nr_frames < ctxt->nr_eval_nodes) {
-            ctxt->nr_frames = ctxt->nr_eval_nodes;
-            ctxt->frames = (struct pcvcm_eval_stack_frame *) realloc(ctxt->frames,
-                    ctxt->nr_frames * sizeof(struct pcvcm_eval_stack_frame));
-
-#ifdef PCVCM_KEEP_NAME
-            ctxt->names = (const char **) realloc(ctxt->names,
-                    ctxt->nr_frames * sizeof(char *));
-#endif
+        size_t nr_eval_nodes = ctxt->nr_eval_nodes + tree->nr_nodes;
+        size_t nr_frames = ctxt->nr_frames < nr_eval_nodes ?
+            nr_eval_nodes : ctxt->nr_frames;
+        if (reserve_arrays(ctxt, nr_eval_nodes, nr_frames)) {
+            goto out;
         }
+        ctxt->nr_eval_nodes = nr_eval_nodes;
+        ctxt->nr_frames = nr_frames;
 
         size_t pos = ctxt->eval_nodes_insert_pos;
-        build_eval_nodes(ctxt, tree);
+        pcvcm_eval_build_nodes(ctxt, tree);
 
         struct pcvcm_eval_stack_frame *frame = push_frame(ctxt,
                 ctxt->eval_nodes + pos, 0);
@@ -32,6 +32,7 @@
 #include "private/debug.h"
 #include "private/tree.h"
 #include "private/list.h"
+#include "private/map.h"
 #include "private/vcm.h"
 #include "purc-variant.h"
 
@@ -116,6 +117,19 @@ struct pcvcm_eval_ctxt {
     size_t                  nr_frames;
     int32_t                 frame_idx;
 
+    /* the allocated sizes of the arrays; zero if they are on the stack */
+    size_t                  sz_eval_nodes;
+    size_t                  sz_frames;
+
+    /* the cache of constant values; NULL if not caching */
+    pcutils_uomap          *consts;
+
+    /* the inline caches of the element getters; NULL if not caching */
+    struct pcvcm_inline_cache *ics;
+
+    /* the resolved named variables in the stack; NULL if not caching */
+    struct pcintr_var_slot *var_slots;
+
 #ifdef PCVCM_KEEP_NAME
     const char            **names;
 #endif
@@ -199,6 +213,41 @@ purc_variant_t pcvcm_eval_again_full(struct pcvcm_node *tree,
 purc_variant_t pcvcm_eval_sub_expr_full(struct pcvcm_node *tree,
         struct pcvcm_eval_ctxt *ctxt, purc_variant_t args, bool silently);
 
+void
+pcvcm_eval_build_nodes(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_node *node);
+
+purc_variant_t
+pcvcm_eval_get_const_value(struct pcvcm_eval_ctxt *ctxt,
+        struct pcvcm_node *node);
+
+purc_variant_t
+pcvcm_eval_cache_const_value(struct pcvcm_eval_ctxt *ctxt,
+        struct pcvcm_node *node, purc_variant_t result);
+
+/* returns the cached member of the receiver,
+   or PURC_VARIANT_INVALID if missed */
+purc_variant_t
+pcvcm_eval_ic_lookup(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_node *node,
+        purc_variant_t receiver, purc_dvariant_method *getter);
+
+void
+pcvcm_eval_ic_update(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_node *node,
+        purc_variant_t receiver, purc_variant_t member);
+
+/* the tree can not be compiled to bytecode; see pcvcm_bytecode_compile() */
+#define PCVCM_BYTECODE_NONE     ((struct pcvcm_bytecode *)(intptr_t)-1)
+
+struct pcvcm_bytecode *
+pcvcm_bytecode_compile(struct pcvcm_node *tree);
+
+void
+pcvcm_bytecode_destroy(struct pcvcm_bytecode *bc);
+
+purc_variant_t
+pcvcm_bytecode_eval(struct pcvcm_bytecode *bc, struct pcvcm_eval_ctxt *ctxt,
+        purc_variant_t args, find_var_fn find_var, void *find_var_ctxt,
+        bool silently);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -41,9 +41,6 @@
 #include "../eval.h"
 #include "../ops.h"
 
-#define MIN_BUF_SIZE         32
-#define MAX_BUF_SIZE         SIZE_MAX
-
 static int
 after_pushed(struct pcvcm_eval_ctxt *ctxt,
         struct pcvcm_eval_stack_frame *frame)
@@ -61,45 +58,42 @@ eval(struct pcvcm_eval_ctxt *ctxt,
     UNUSED_PARAM(frame);
     UNUSED_PARAM(name);
     purc_variant_t ret = PURC_VARIANT_INVALID;
-    purc_rwstream_t rws = purc_rwstream_new_buffer(MIN_BUF_SIZE, MAX_BUF_SIZE);
-    if (!rws) {
+
+    /* the first pass computes the exact length of the concatenation, and
+       the second one stringifies the results into the buffer directly */
+    size_t len = 0;
+    for (size_t i = 0; i < frame->nr_params; i++) {
+        purc_variant_t v = pcvcm_get_frame_result(ctxt, frame->idx, i, NULL);
+
+        // FIXME: stringify or serialize
+        ssize_t n = purc_variant_stringify_length(v, 0);
+        if (n > 0)
+            len += n;
+    }
+
+    char *buf = malloc(len + 1);
+    if (buf == NULL) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto out;
     }
 
+    char *p = buf;
     for (size_t i = 0; i < frame->nr_params; i++) {
         purc_variant_t v = pcvcm_get_frame_result(ctxt, frame->idx, i, NULL);
 
-        // FIXME: stringify or serialize
-        char *buf = NULL;
-        int total = purc_variant_stringify_alloc(&buf, v);
-        if (total) {
-            purc_rwstream_write(rws, buf, total);
-        }
-        free(buf);
+        ssize_t n = purc_variant_stringify_to_buff(p, len + 1 - (p - buf),
+                v, 0);
+        if (n > 0)
+            p += n;
     }
+    *p = '\0';
 
-    // do not forget tailing-null-terminator
-    purc_rwstream_write(rws, "", 1);
-
-    size_t rw_size = 0;
-    size_t content_size = 0;
-    char *rw_string = purc_rwstream_get_mem_buffer_ex(rws,
-            &content_size, &rw_size, true);
-
-    if (rw_size && rw_string) {
-        ret = purc_variant_make_string_reuse_buff(rw_string,
-                content_size, false);
-        if (ret == PURC_VARIANT_INVALID) {
-            pcinst_set_error(PURC_ERROR_INVALID_VALUE);
-            ret = PURC_VARIANT_INVALID;
-        }
+    ret = purc_variant_make_string_reuse_buff(buf, len + 1, false);
+    if (ret == PURC_VARIANT_INVALID) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
     }
 
 out:
-    if (rws) {
-        purc_rwstream_destroy(rws);
-    }
     return ret;
 }
 
@@ -102,9 +102,18 @@ eval(struct pcvcm_eval_ctxt *ctxt,
     }
 
     if (purc_variant_is_object(caller_var)) {
-        purc_variant_t val = purc_variant_object_get(caller_var, param_var);
+        purc_dvariant_method getter = NULL;
+        purc_variant_t val = pcvcm_eval_ic_lookup(ctxt, frame->node,
+                caller_var, &getter);
         if (val == PURC_VARIANT_INVALID) {
-            goto out;
+            val = purc_variant_object_get(caller_var, param_var);
+            if (val == PURC_VARIANT_INVALID) {
+                goto out;
+            }
+            pcvcm_eval_ic_update(ctxt, frame->node, caller_var, val);
+            if (purc_variant_is_dynamic(val)) {
+                getter = purc_variant_dynamic_get_getter(val);
+            }
         }
 
         if (!purc_variant_is_dynamic(val)) {
@@ -119,8 +128,9 @@ eval(struct pcvcm_eval_ctxt *ctxt,
             goto out;
         }
 
-        ret_var = pcvcm_eval_call_dvariant_method(caller_var, val, 0, NULL,
-                GETTER_METHOD, call_flags);
+        if (getter) {
+            ret_var = getter(caller_var, 0, NULL, call_flags);
+        }
     }
     else if (purc_variant_is_array(caller_var)) {
         if (!has_index) {
@@ -99,7 +99,11 @@ eval(struct pcvcm_eval_ctxt *ctxt,
     }
 #endif
     ret = find_from_frame(ctxt, sname);
-    if (!ret) {
+    if (!ret && ctxt->var_slots && frame->node->stamp) {
+        ret = pcintr_find_named_var_cached(ctxt->find_var_ctxt, sname,
+                ctxt->var_slots, frame->node->stamp);
+    }
+    else if (!ret) {
         ret = ctxt->find_var(ctxt->find_var_ctxt, sname);
     }
 
@@ -37,6 +37,7 @@
 #include "private/interpreter.h"
 #include "private/utils.h"
 #include "private/vcm.h"
+#include "private/variant.h"
 
 #include "../eval.h"
 #include "../ops.h"
@@ -57,6 +58,14 @@ eval(struct pcvcm_eval_ctxt *ctxt,
     UNUSED_PARAM(ctxt);
     UNUSED_PARAM(name);
     struct pcvcm_node *node = frame->node;
+    struct pcvcm_node *parent = (struct pcvcm_node *)
+        pctree_node_parent(&node->tree_node);
+
+    /* the keys of objects are interned to share them among the objects */
+    if (parent && parent->type == PCVCM_NODE_TYPE_OBJECT &&
+            frame->return_pos % 2 == 0) {
+        return pcvariant_make_key_string((char*)node->sz_ptr[1], false);
+    }
     return purc_variant_make_string((char*)node->sz_ptr[1], false);
 }
 
@@ -500,6 +500,9 @@ pcvcm_node_destroy_callback(struct pctree_node *n,  void *data)
         ) && node->sz_ptr[1]) {
         free((void*)node->sz_ptr[1]);
     }
+    if (node->bytecode) {
+        pcvcm_bytecode_destroy(node->bytecode);
+    }
     free(node);
 }
 
@@ -511,6 +514,131 @@ void pcvcm_node_destroy(struct pcvcm_node *root)
     }
 }
 
+#if HAVE(STDATOMIC_H)
+
+#include <stdatomic.h>
+
+static uint64_t
+gen_stamp(void)
+{
+    static atomic_ullong atomic_accumulator = 1;
+    return atomic_fetch_add(&atomic_accumulator, 1);
+}
+
+#else /* HAVE(STDATOMIC_H) */
+
+static uint64_t
+gen_stamp(void)
+{
+    static uint64_t accumulator = 1;
+    return accumulator++;
+}
+
+#endif /* !HAVE(STDATOMIC_H) */
+
+/* whether the name of a variable is not a symbolized one like `$0<` */
+static bool
+is_plain_var_name(const char *name)
+{
+    if (name == NULL || name[0] == 0 || name[0] == '#' ||
+            purc_isdigit(name[0])) {
+        return false;
+    }
+
+    return !(name[1] == 0 && purc_ispunct(name[0]));
+}
+
+static void
+pcvcm_node_compile_callback(struct pctree_node *n,  void *data)
+{
+    UNUSED_PARAM(data);
+    struct pcvcm_node *node = (struct pcvcm_node*)n;
+    bool is_const;
+    bool worth_caching = false;
+
+    switch (node->type) {
+    /* making these again is cheaper than looking up the cache */
+    case PCVCM_NODE_TYPE_UNDEFINED:
+    case PCVCM_NODE_TYPE_NULL:
+    case PCVCM_NODE_TYPE_BOOLEAN:
+    case PCVCM_NODE_TYPE_NUMBER:
+    case PCVCM_NODE_TYPE_LONG_INT:
+    case PCVCM_NODE_TYPE_ULONG_INT:
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+        is_const = true;
+        break;
+
+    case PCVCM_NODE_TYPE_STRING:
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+        is_const = true;
+        worth_caching = true;
+        break;
+
+    /* constant only if all the members are constant (visited already) */
+    case PCVCM_NODE_TYPE_OBJECT:
+    case PCVCM_NODE_TYPE_ARRAY:
+    case PCVCM_NODE_TYPE_TUPLE:
+    case PCVCM_NODE_TYPE_FUNC_CONCAT_STRING:
+    {
+        is_const = true;
+        struct pctree_node *child = n->first_child;
+        while (child) {
+            if (((struct pcvcm_node *)child)->const_state !=
+                    PCVCM_NODE_CONST_YES) {
+                is_const = false;
+                break;
+            }
+            child = child->next;
+        }
+        worth_caching = is_const;
+        break;
+    }
+
+    case PCVCM_NODE_TYPE_FUNC_GET_ELEMENT:
+    {
+        /* an inline cache only for a constant key, like `$OBJ.name` */
+        struct pcvcm_node *key = (struct pcvcm_node *)n->last_child;
+        is_const = false;
+        worth_caching = (key && key->type == PCVCM_NODE_TYPE_STRING);
+        break;
+    }
+
+    case PCVCM_NODE_TYPE_FUNC_GET_VARIABLE:
+    {
+        /* a slot caching the resolution only for a plain name, like `$x` */
+        struct pcvcm_node *name = (struct pcvcm_node *)n->first_child;
+        is_const = false;
+        worth_caching = (name && name->type == PCVCM_NODE_TYPE_STRING &&
+                is_plain_var_name((const char *)name->sz_ptr[1]));
+        break;
+    }
+
+    default:
+        is_const = false;
+        break;
+    }
+
+    node->const_state = is_const ? PCVCM_NODE_CONST_YES : PCVCM_NODE_CONST_NO;
+    node->stamp = worth_caching ? gen_stamp() : 0;
+
+    /* only the root of a constant subtree is cached */
+    if (is_const) {
+        struct pctree_node *child = n->first_child;
+        while (child) {
+            ((struct pcvcm_node *)child)->stamp = 0;
+            child = child->next;
+        }
+    }
+}
+
+void pcvcm_node_compile(struct pcvcm_node *root)
+{
+    if (root) {
+        pctree_node_post_order_traversal((struct pctree_node*)root,
+                pcvcm_node_compile_callback, NULL);
+    }
+}
+
 static inline bool
 is_digit(char c)
 {
@@ -35,24 +35,16 @@
 const struct pchvml_attr_entry*
 pchvml_attr_static_search(const char* name, size_t length)
 {
-    unsigned int v = (unsigned char)purc_tolower(name[0])
-        * (unsigned char)purc_tolower(name[length-1]);
-    unsigned idx = v % PCHVML_ATTR_STATIC_SIZE;
+    uint32_t key = pcutils_perfect_hash_key(name, length);
+    size_t idx = pcutils_perfect_hash_slot(key, pchvml_attr_static_disps,
+            PCHVML_ATTR_STATIC_NR_DISPS, PCHVML_ATTR_STATIC_SIZE);
 
     const struct pchvml_attr_entry *entry = &pchvml_attr_static_list_index[idx];
-    while (entry) {
-        if (!entry->name) {
-            return NULL;
-        }
-        if (strncasecmp(name, entry->name, length)==0) {
-            return entry;
-        }
-        if (entry->next==0) {
-            return NULL;
-        }
-        idx = entry->next;
-        entry = &pchvml_attr_static_list_index[idx];
+    if (entry->name && strncasecmp(name, entry->name, length) == 0 &&
+            entry->name[length] == '\0') {
+        return entry;
     }
+
     return NULL;
 }
 
@@ -0,0 +1,714 @@
+/*
+ * @file vdom-binary.c
+ * @date 2026/10/14
+ * @brief The binary form of vdom, which can be loaded without parsing.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "private/instance.h"
+#include "private/errors.h"
+#include "private/debug.h"
+#include "private/utils.h"
+#include "private/vdom.h"
+
+#include "vdom-internal.h"
+
+#include <string.h>
+
+/*
+ * The binary form is a header followed by the nodes of the document in
+ * pre-order; every node is followed by the number of its children and the
+ * children. The numbers are stored in the native byte order, because the
+ * binary form is only a cache for the programs on the same machine: the
+ * header records the byte order and the size of `long double`, and a
+ * mismatched one is simply rejected.
+ *
+ * The tags and the attributes are stored by names, so that a binary form
+ * does not depend on the ids of the predefined ones.
+ */
+
+#define VDOM_BIN_MAGIC          "PCVDOMB"
+#define VDOM_BIN_VERSION        1
+#define VDOM_BIN_BYTE_ORDER     0x01020304
+
+/* the length of a null string */
+#define VDOM_BIN_NULL_LEN       UINT32_MAX
+
+/* the maximal depth of the nested nodes and the number of bodies accepted */
+#define VDOM_BIN_MAX_DEPTH      1024
+#define VDOM_BIN_MAX_BODIES     4096
+
+/* the flags of an element */
+#define ELEM_FLAG_SELF_CLOSING  0x01
+#define ELEM_FLAG_ROOT          0x02
+#define ELEM_FLAG_HEAD          0x04
+#define ELEM_FLAG_BODY          0x08    /* the current body of the document */
+
+struct bin_writer {
+    purc_rwstream_t         out;
+    int                     err;
+};
+
+struct bin_reader {
+    const uint8_t          *p;
+    const uint8_t          *end;
+    int                     err;
+};
+
+static void
+write_bytes(struct bin_writer *w, const void *buf, size_t len)
+{
+    if (w->err || len == 0)
+        return;
+
+    if (purc_rwstream_write(w->out, buf, len) != (ssize_t)len)
+        w->err = -1;
+}
+
+static inline void
+write_u8(struct bin_writer *w, uint8_t v)
+{
+    write_bytes(w, &v, sizeof(v));
+}
+
+static inline void
+write_u32(struct bin_writer *w, uint32_t v)
+{
+    write_bytes(w, &v, sizeof(v));
+}
+
+/* the terminating null byte is written as well for a string */
+static void
+write_blob(struct bin_writer *w, const void *buf, size_t len, bool is_str)
+{
+    if (buf == NULL && is_str) {
+        write_u32(w, VDOM_BIN_NULL_LEN);
+        return;
+    }
+
+    if (len >= VDOM_BIN_NULL_LEN) {
+        w->err = -1;
+        return;
+    }
+
+    write_u32(w, (uint32_t)len);
+    write_bytes(w, buf, len);
+    if (is_str)
+        write_u8(w, 0);
+}
+
+static inline void
+write_str(struct bin_writer *w, const char *str)
+{
+    write_blob(w, str, str ? strlen(str) : 0, true);
+}
+
+static bool
+read_bytes(struct bin_reader *r, void *buf, size_t len)
+{
+    if (r->err || (size_t)(r->end - r->p) < len) {
+        r->err = -1;
+        memset(buf, 0, len);
+        return false;
+    }
+
+    memcpy(buf, r->p, len);
+    r->p += len;
+    return true;
+}
+
+static inline uint8_t
+read_u8(struct bin_reader *r)
+{
+    uint8_t v;
+    read_bytes(r, &v, sizeof(v));
+    return v;
+}
+
+static inline uint32_t
+read_u32(struct bin_reader *r)
+{
+    uint32_t v;
+    read_bytes(r, &v, sizeof(v));
+    return v;
+}
+
+/* returns the pointer to the data in the buffer, or NULL for a null string */
+static const void *
+read_blob(struct bin_reader *r, size_t *len, bool is_str)
+{
+    uint32_t n = read_u32(r);
+    *len = 0;
+    if (r->err || (is_str && n == VDOM_BIN_NULL_LEN))
+        return NULL;
+
+    size_t sz = is_str ? (size_t)n + 1 : n;
+    if ((size_t)(r->end - r->p) < sz) {
+        r->err = -1;
+        return NULL;
+    }
+
+    const uint8_t *data = r->p;
+    if (is_str && data[n] != 0) {
+        r->err = -1;
+        return NULL;
+    }
+
+    r->p += sz;
+    *len = n;
+    return data;
+}
+
+static inline const char *
+read_str(struct bin_reader *r)
+{
+    size_t len;
+    return read_blob(r, &len, true);
+}
+
+static void
+write_vcm(struct bin_writer *w, struct pcvcm_node *node)
+{
+    write_u8(w, (uint8_t)node->type);
+    write_u32(w, node->extra);
+    write_u8(w, node->is_closed);
+
+    switch (node->type) {
+    case PCVCM_NODE_TYPE_STRING:
+        write_blob(w, (const void *)node->sz_ptr[1], node->sz_ptr[0], true);
+        break;
+
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+        write_blob(w, (const void *)node->sz_ptr[1], node->sz_ptr[0], false);
+        break;
+
+    case PCVCM_NODE_TYPE_BOOLEAN:
+        write_u8(w, node->b);
+        break;
+
+    case PCVCM_NODE_TYPE_NUMBER:
+        write_bytes(w, &node->d, sizeof(node->d));
+        break;
+
+    case PCVCM_NODE_TYPE_LONG_INT:
+        write_bytes(w, &node->i64, sizeof(node->i64));
+        break;
+
+    case PCVCM_NODE_TYPE_ULONG_INT:
+        write_bytes(w, &node->u64, sizeof(node->u64));
+        break;
+
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+        write_bytes(w, &node->ld, sizeof(node->ld));
+        break;
+
+    default:
+        break;
+    }
+
+    write_u32(w, (uint32_t)pcvcm_node_children_count(node));
+    struct pcvcm_node *child = pcvcm_node_first_child(node);
+    while (child) {
+        write_vcm(w, child);
+        child = (struct pcvcm_node *)pctree_node_next(&child->tree_node);
+    }
+}
+
+static struct pcvcm_node *
+read_vcm(struct bin_reader *r, int depth)
+{
+    struct pcvcm_node *node = NULL;
+    const void *data;
+    size_t len;
+
+    uint8_t type = read_u8(r);
+    uint32_t extra = read_u32(r);
+    uint8_t is_closed = read_u8(r);
+    if (r->err || depth > VDOM_BIN_MAX_DEPTH)
+        goto failed;
+
+    switch (type) {
+    case PCVCM_NODE_TYPE_UNDEFINED:
+        node = pcvcm_node_new_undefined();
+        break;
+
+    case PCVCM_NODE_TYPE_OBJECT:
+        node = pcvcm_node_new_object(0, NULL);
+        break;
+
+    case PCVCM_NODE_TYPE_ARRAY:
+        node = pcvcm_node_new_array(0, NULL);
+        break;
+
+    case PCVCM_NODE_TYPE_TUPLE:
+        node = pcvcm_node_new_tuple(0, NULL);
+        break;
+
+    case PCVCM_NODE_TYPE_STRING:
+        data = read_blob(r, &len, true);
+        if (data == NULL)
+            goto failed;
+        node = pcvcm_node_new_string(data);
+        break;
+
+    case PCVCM_NODE_TYPE_NULL:
+        node = pcvcm_node_new_null();
+        break;
+
+    case PCVCM_NODE_TYPE_BOOLEAN:
+        node = pcvcm_node_new_boolean(read_u8(r) != 0);
+        break;
+
+    case PCVCM_NODE_TYPE_NUMBER:
+    {
+        double d;
+        read_bytes(r, &d, sizeof(d));
+        node = pcvcm_node_new_number(d);
+        break;
+    }
+
+    case PCVCM_NODE_TYPE_LONG_INT:
+    {
+        int64_t i64;
+        read_bytes(r, &i64, sizeof(i64));
+        node = pcvcm_node_new_longint(i64);
+        break;
+    }
+
+    case PCVCM_NODE_TYPE_ULONG_INT:
+    {
+        uint64_t u64;
+        read_bytes(r, &u64, sizeof(u64));
+        node = pcvcm_node_new_ulongint(u64);
+        break;
+    }
+
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+    {
+        long double ld;
+        read_bytes(r, &ld, sizeof(ld));
+        node = pcvcm_node_new_longdouble(ld);
+        break;
+    }
+
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+        data = read_blob(r, &len, false);
+        if (r->err)
+            goto failed;
+        node = pcvcm_node_new_byte_sequence(data, len);
+        break;
+
+    case PCVCM_NODE_TYPE_FUNC_CONCAT_STRING:
+        node = pcvcm_node_new_concat_string(0, NULL);
+        break;
+
+    case PCVCM_NODE_TYPE_FUNC_GET_VARIABLE:
+        node = pcvcm_node_new_get_variable(NULL);
+        break;
+
+    case PCVCM_NODE_TYPE_FUNC_GET_ELEMENT:
+        node = pcvcm_node_new_get_element(NULL, NULL);
+        break;
+
+    case PCVCM_NODE_TYPE_FUNC_CALL_GETTER:
+        node = pcvcm_node_new_call_getter(NULL, 0, NULL);
+        break;
+
+    case PCVCM_NODE_TYPE_FUNC_CALL_SETTER:
+        node = pcvcm_node_new_call_setter(NULL, 0, NULL);
+        break;
+
+    case PCVCM_NODE_TYPE_CJSONEE:
+        node = pcvcm_node_new_cjsonee();
+        break;
+
+    case PCVCM_NODE_TYPE_CJSONEE_OP_AND:
+        node = pcvcm_node_new_cjsonee_op_and();
+        break;
+
+    case PCVCM_NODE_TYPE_CJSONEE_OP_OR:
+        node = pcvcm_node_new_cjsonee_op_or();
+        break;
+
+    case PCVCM_NODE_TYPE_CJSONEE_OP_SEMICOLON:
+        node = pcvcm_node_new_cjsonee_op_semicolon();
+        break;
+
+    case PCVCM_NODE_TYPE_CONSTANT:
+        node = pcvcm_node_new_constant(0, NULL);
+        break;
+
+    default:
+        r->err = -1;
+        break;
+    }
+
+    if (node == NULL || r->err)
+        goto failed;
+
+    node->extra = extra;
+    node->is_closed = is_closed;
+
+    uint32_t nr_children = read_u32(r);
+    for (uint32_t i = 0; i < nr_children && r->err == 0; i++) {
+        struct pcvcm_node *child = read_vcm(r, depth + 1);
+        if (child == NULL)
+            goto failed;
+        pcvcm_node_append_child(node, child);
+    }
+
+    if (r->err)
+        goto failed;
+    return node;
+
+failed:
+    r->err = -1;
+    if (node)
+        pcvcm_node_destroy(node);
+    return NULL;
+}
+
+static int
+body_index(struct pcvdom_document *doc, struct pcvdom_element *elem)
+{
+    size_t nr = pcutils_arrlist_length(doc->bodies);
+    for (size_t i = 0; i < nr; i++) {
+        if (pcutils_arrlist_get_idx(doc->bodies, i) == elem)
+            return (int)i;
+    }
+    return -1;
+}
+
+static void
+write_node(struct bin_writer *w, struct pcvdom_document *doc,
+        struct pcvdom_node *node)
+{
+    write_u8(w, (uint8_t)node->type);
+
+    switch (node->type) {
+    case PCVDOM_NODE_ELEMENT:
+    {
+        struct pcvdom_element *elem = PCVDOM_ELEMENT_FROM_NODE(node);
+        uint8_t flags = 0;
+        if (elem->self_closing)
+            flags |= ELEM_FLAG_SELF_CLOSING;
+        if (elem == doc->root)
+            flags |= ELEM_FLAG_ROOT;
+        if (elem == doc->head)
+            flags |= ELEM_FLAG_HEAD;
+        if (elem == doc->body)
+            flags |= ELEM_FLAG_BODY;
+
+        write_str(w, elem->tag_name);
+        write_u8(w, flags);
+        write_u32(w, (uint32_t)body_index(doc, elem));
+
+        size_t nr_attrs = pcutils_array_length(elem->attrs);
+        write_u32(w, (uint32_t)nr_attrs);
+        for (size_t i = 0; i < nr_attrs; i++) {
+            struct pcvdom_attr *attr = pcutils_array_get(elem->attrs, i);
+            write_str(w, attr->key);
+            write_u8(w, (uint8_t)attr->op);
+            write_u8(w, attr->val ? 1 : 0);
+            if (attr->val)
+                write_vcm(w, attr->val);
+        }
+        break;
+    }
+
+    case PCVDOM_NODE_CONTENT:
+        write_vcm(w, PCVDOM_CONTENT_FROM_NODE(node)->vcm);
+        break;
+
+    case PCVDOM_NODE_COMMENT:
+        write_str(w, PCVDOM_COMMENT_FROM_NODE(node)->text);
+        break;
+
+    default:
+        w->err = -1;
+        return;
+    }
+
+    write_u32(w, (uint32_t)pctree_node_children_number(&node->node));
+    struct pcvdom_node *child = pcvdom_node_first_child(node);
+    while (child) {
+        write_node(w, doc, child);
+        child = pcvdom_node_next_sibling(child);
+    }
+}
+
+int
+pcvdom_document_to_binary(struct pcvdom_document *doc, purc_rwstream_t out)
+{
+    if (!doc || !out) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    struct bin_writer w = { out, 0 };
+    write_bytes(&w, VDOM_BIN_MAGIC, sizeof(VDOM_BIN_MAGIC));
+    write_u32(&w, VDOM_BIN_VERSION);
+    write_u32(&w, VDOM_BIN_BYTE_ORDER);
+    write_u8(&w, (uint8_t)sizeof(long double));
+
+    write_str(&w, doc->doctype.name);
+    write_str(&w, doc->doctype.system_info);
+    write_u8(&w, doc->quirks);
+
+    struct pcvdom_node *node = pcvdom_node_from_document(doc);
+    write_u32(&w, (uint32_t)pctree_node_children_number(&node->node));
+    struct pcvdom_node *child = pcvdom_node_first_child(node);
+    while (child) {
+        write_node(&w, doc, child);
+        child = pcvdom_node_next_sibling(child);
+    }
+
+    if (w.err) {
+        purc_set_error(PURC_ERROR_OUTPUT);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+append_child(struct pcvdom_document *doc, struct pcvdom_element *parent,
+        struct pcvdom_node *node)
+{
+    switch (node->type) {
+    case PCVDOM_NODE_ELEMENT:
+        if (parent)
+            return pcvdom_element_append_element(parent,
+                    PCVDOM_ELEMENT_FROM_NODE(node));
+        return pcvdom_document_set_root(doc, PCVDOM_ELEMENT_FROM_NODE(node));
+
+    case PCVDOM_NODE_CONTENT:
+        if (parent)
+            return pcvdom_element_append_content(parent,
+                    PCVDOM_CONTENT_FROM_NODE(node));
+        return pcvdom_document_append_content(doc,
+                PCVDOM_CONTENT_FROM_NODE(node));
+
+    case PCVDOM_NODE_COMMENT:
+        if (parent)
+            return pcvdom_element_append_comment(parent,
+                    PCVDOM_COMMENT_FROM_NODE(node));
+        return pcvdom_document_append_comment(doc,
+                PCVDOM_COMMENT_FROM_NODE(node));
+
+    default:
+        break;
+    }
+
+    return -1;
+}
+
+static int read_children(struct bin_reader *r, struct pcvdom_document *doc,
+        struct pcvdom_element *parent, int depth);
+
+static struct pcvdom_element *
+read_element(struct bin_reader *r, struct pcvdom_document *doc,
+        struct pcvdom_element *parent)
+{
+    const char *tag_name = read_str(r);
+    uint8_t flags = read_u8(r);
+    int32_t idx = (int32_t)read_u32(r);
+    if (tag_name == NULL || r->err)
+        return NULL;
+
+    /* only the root is a child element of the document */
+    if ((parent == NULL) != ((flags & ELEM_FLAG_ROOT) != 0))
+        return NULL;
+
+    struct pcvdom_element *elem = pcvdom_document_create_element_c(doc, tag_name);
+    if (elem == NULL)
+        return NULL;
+
+    elem->self_closing = (flags & ELEM_FLAG_SELF_CLOSING) ? 1 : 0;
+
+    uint32_t nr_attrs = read_u32(r);
+    for (uint32_t i = 0; i < nr_attrs && r->err == 0; i++) {
+        const char *key = read_str(r);
+        uint8_t op = read_u8(r);
+        uint8_t has_val = read_u8(r);
+        if (key == NULL || r->err || op >= PCHVML_ATTRIBUTE_MAX)
+            goto failed;
+
+        struct pcvcm_node *val = NULL;
+        if (has_val && (val = read_vcm(r, 0)) == NULL)
+            goto failed;
+
+        struct pcvdom_attr *attr = pcvdom_document_create_attr(doc, key, op, val);
+        if (attr == NULL) {
+            pcvcm_node_destroy(val);
+            goto failed;
+        }
+
+        if (pcvdom_element_append_attr(elem, attr)) {
+            pcvdom_attr_destroy(attr);
+            goto failed;
+        }
+    }
+
+    if (r->err)
+        goto failed;
+
+    if (flags & ELEM_FLAG_HEAD)
+        doc->head = elem;
+    if (flags & ELEM_FLAG_BODY)
+        doc->body = elem;
+    if (idx >= VDOM_BIN_MAX_BODIES ||
+            (idx >= 0 && pcutils_arrlist_put_idx(doc->bodies, idx, elem)))
+        goto failed;
+
+    return elem;
+
+failed:
+    pcvdom_node_destroy(&elem->node);
+    return NULL;
+}
+
+static struct pcvdom_node *
+read_node(struct bin_reader *r, struct pcvdom_document *doc,
+        struct pcvdom_element *parent)
+{
+    uint8_t type = read_u8(r);
+    if (r->err)
+        return NULL;
+
+    switch (type) {
+    case PCVDOM_NODE_ELEMENT:
+    {
+        struct pcvdom_element *elem = read_element(r, doc, parent);
+        return elem ? &elem->node : NULL;
+    }
+
+    case PCVDOM_NODE_CONTENT:
+    {
+        struct pcvcm_node *vcm = read_vcm(r, 0);
+        if (vcm == NULL)
+            return NULL;
+
+        struct pcvdom_content *content = pcvdom_document_create_content(doc, vcm);
+        if (content == NULL) {
+            pcvcm_node_destroy(vcm);
+            return NULL;
+        }
+        return &content->node;
+    }
+
+    case PCVDOM_NODE_COMMENT:
+    {
+        const char *text = read_str(r);
+        if (text == NULL)
+            return NULL;
+
+        struct pcvdom_comment *comment = pcvdom_document_create_comment(doc, text);
+        return comment ? &comment->node : NULL;
+    }
+
+    default:
+        break;
+    }
+
+    return NULL;
+}
+
+static int
+read_children(struct bin_reader *r, struct pcvdom_document *doc,
+        struct pcvdom_element *parent, int depth)
+{
+    if (depth > VDOM_BIN_MAX_DEPTH)
+        return -1;
+
+    uint32_t nr_children = read_u32(r);
+    for (uint32_t i = 0; i < nr_children && r->err == 0; i++) {
+        struct pcvdom_node *node = read_node(r, doc, parent);
+        if (node == NULL)
+            return -1;
+
+        if (append_child(doc, parent, node)) {
+            pcvdom_node_destroy(node);
+            return -1;
+        }
+
+        struct pcvdom_element *elem = PCVDOM_ELEMENT_FROM_NODE(node);
+        if (elem) {
+            if (read_children(r, doc, elem, depth + 1))
+                return -1;
+        }
+        else if (read_u32(r) != 0) {
+            /* contents and comments have no child */
+            return -1;
+        }
+    }
+
+    return r->err ? -1 : 0;
+}
+
+struct pcvdom_document *
+pcvdom_document_from_binary(const void *buf, size_t len)
+{
+    struct bin_reader r = { buf, (const uint8_t *)buf + len, 0 };
+    struct pcvdom_document *doc = NULL;
+
+    char magic[sizeof(VDOM_BIN_MAGIC)];
+    read_bytes(&r, magic, sizeof(magic));
+    uint32_t version = read_u32(&r);
+    uint32_t byte_order = read_u32(&r);
+    uint8_t sz_long_double = read_u8(&r);
+    if (r.err || memcmp(magic, VDOM_BIN_MAGIC, sizeof(magic)) ||
+            version != VDOM_BIN_VERSION ||
+            byte_order != VDOM_BIN_BYTE_ORDER ||
+            sz_long_double != sizeof(long double))
+        goto failed;
+
+    const char *name = read_str(&r);
+    const char *system_info = read_str(&r);
+    uint8_t quirks = read_u8(&r);
+    if (r.err)
+        goto failed;
+
+    doc = pcvdom_document_create();
+    if (doc == NULL)
+        goto failed;
+
+    if (name && system_info &&
+            pcvdom_document_set_doctype(doc, name, system_info))
+        goto failed;
+    doc->quirks = quirks ? 1 : 0;
+
+    if (read_children(&r, doc, NULL, 0) || r.p != r.end)
+        goto failed;
+
+    /* all the bodies must have been read */
+    size_t nr = pcutils_arrlist_length(doc->bodies);
+    for (size_t i = 0; i < nr; i++) {
+        if (pcutils_arrlist_get_idx(doc->bodies, i) == NULL)
+            goto failed;
+    }
+
+    return doc;
+
+failed:
+    if (doc)
+        pcvdom_document_unref(doc);
+    purc_set_error(PURC_ERROR_BAD_ENCODING);
+    return NULL;
+}
@@ -33,6 +33,8 @@
 #error "Not implemented for this platform."
 #endif                          /* } */
 
+#include "private/mem.h"
+
 #define PCVDOM_NODE_IS_DOCUMENT(_n) \
     (((_n) && (_n)->type==PCVDOM_NODE_DOCUMENT))
 #define PCVDOM_NODE_IS_ELEMENT(_n) \
@@ -58,6 +60,8 @@
 struct pcvdom_node {
     struct pctree_node     node;
     enum pcvdom_nodetype   type;
+    // allocated in the arena of the document
+    unsigned int           in_arena:1;
     void (*remove_child)(struct pcvdom_node *me, struct pcvdom_node *child);
 };
 
@@ -81,6 +85,9 @@ struct pcvdom_document {
 
     atomic_ulong            refc;
 
+    // the arena of the nodes created by pcvdom_document_create_xxx()
+    pcutils_mem_t          *arena;
+
     unsigned int            quirks:1;
 };
 
@@ -89,13 +96,16 @@ struct pcvdom_attr {
 
     // NOTE for key:
     //   for those pre-defined attrs, static char * in pre_defined
-    //   for others, need to be free'd afterwards
+    //   for others, the string of the atom interned for it
     const struct pchvml_attr_entry  *pre_defined;
     char                     *key;
 
     // operator
     enum pchvml_attr_operator       op;
 
+    // allocated in the arena of the document
+    unsigned int              in_arena:1;
+
     // text/jsonnee/no-value
     struct pcvcm_node        *val;
 };
@@ -104,7 +114,7 @@ struct pcvdom_element {
     struct pcvdom_node      node;
 
     // for those non-pre-defined tags(UNDEF)
-    // tag_name shall be free'd afterwards in case when tag_id is tag(UNDEF)
+    // tag_name is the string of the atom interned for it
     pcvdom_tag_id           tag_id;
     char                   *tag_name;
 
@@ -29,6 +29,8 @@
 #include "private/utils.h"
 #include "private/vdom.h"
 #include "private/stringbuilder.h"
+#include "private/regex.h"
+#include "private/atom-buckets.h"
 
 #include "hvml-attr.h"
 
@@ -58,6 +60,9 @@ void pcvdom_cleanup_instance(struct pcinst* inst)
 #define VTT(x)     PCHVML_TAG_##x
 #define PAO(x)     PCHVML_ATTRIBUTE_##x
 
+/* the minimal size of the chunks in the arena of a document */
+#define VDOM_ARENA_CHUNK_SIZE   (8 * 1024)
+
 static void
 document_reset(struct pcvdom_document *doc);
 
@@ -78,7 +83,7 @@ static void
 element_destroy(struct pcvdom_element *elem);
 
 static struct pcvdom_element*
-element_create(void);
+element_create(struct pcvdom_document *doc);
 
 static void
 content_reset(struct pcvdom_content *doc);
@@ -87,7 +92,7 @@ static void
 content_destroy(struct pcvdom_content *doc);
 
 static struct pcvdom_content*
-content_create(struct pcvcm_node *vcm_content);
+content_create(struct pcvdom_document *doc, struct pcvcm_node *vcm_content);
 
 static void
 vdom_node_remove(struct pcvdom_node *node);
@@ -99,7 +104,7 @@ static void
 comment_destroy(struct pcvdom_comment *doc);
 
 static struct pcvdom_comment*
-comment_create(const char *text);
+comment_create(struct pcvdom_document *doc, const char *text);
 
 static void
 attr_reset(struct pcvdom_attr *doc);
@@ -108,11 +113,17 @@ static void
 attr_destroy(struct pcvdom_attr *doc);
 
 static struct pcvdom_attr*
-attr_create(void);
+attr_create(struct pcvdom_document *doc);
 
 static void
 vdom_node_destroy(struct pcvdom_node *node);
 
+static const char *
+intern_name(const char *name);
+
+static struct pcvdom_document *
+owner_document(struct pcvdom_node *node);
+
 struct pcvdom_document*
 pcvdom_document_ref(struct pcvdom_document *doc)
 {
@@ -149,7 +160,7 @@ pcvdom_element_create(pcvdom_tag_id tag)
         return NULL;
     }
 
-    struct pcvdom_element *elem = element_create();
+    struct pcvdom_element *elem = element_create(NULL);
     if (!elem) {
         return NULL;
     }
@@ -169,14 +180,15 @@ pcvdom_element_create(pcvdom_tag_id tag)
 }
 
 struct pcvdom_element*
-pcvdom_element_create_c(const char *tag_name)
+pcvdom_document_create_element_c(struct pcvdom_document *doc,
+        const char *tag_name)
 {
     if (!tag_name) {
         pcinst_set_error(PURC_ERROR_INVALID_VALUE);
         return NULL;
     }
 
-    struct pcvdom_element *elem = element_create();
+    struct pcvdom_element *elem = element_create(doc);
     if (!elem) {
         return NULL;
     }
@@ -187,9 +199,8 @@ pcvdom_element_create_c(const char *tag_name)
         elem->tag_id   = entry->id;
         elem->tag_name = (char*)entry->name;
     } else {
-        elem->tag_name = strdup(tag_name);
+        elem->tag_name = (char*)intern_name(tag_name);
         if (!elem->tag_name) {
-            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
             element_destroy(elem);
             return NULL;
         }
@@ -198,33 +209,52 @@ pcvdom_element_create_c(const char *tag_name)
     return elem;
 }
 
+struct pcvdom_element*
+pcvdom_element_create_c(const char *tag_name)
+{
+    return pcvdom_document_create_element_c(NULL, tag_name);
+}
+
 struct pcvdom_content*
-pcvdom_content_create(struct pcvcm_node *vcm_content)
+pcvdom_document_create_content(struct pcvdom_document *doc,
+        struct pcvcm_node *vcm_content)
 {
     if (!vcm_content) {
         pcinst_set_error(PURC_ERROR_INVALID_VALUE);
         return NULL;
     }
 
-    return content_create(vcm_content);
+    return content_create(doc, vcm_content);
+}
+
+struct pcvdom_content*
+pcvdom_content_create(struct pcvcm_node *vcm_content)
+{
+    return pcvdom_document_create_content(NULL, vcm_content);
 }
 
 struct pcvdom_comment*
-pcvdom_comment_create(const char *text)
+pcvdom_document_create_comment(struct pcvdom_document *doc,
+        const char *text)
 {
     if (!text) {
         pcinst_set_error(PURC_ERROR_INVALID_VALUE);
         return NULL;
     }
 
-    return comment_create(text);
+    return comment_create(doc, text);
+}
 
+struct pcvdom_comment*
+pcvdom_comment_create(const char *text)
+{
+    return pcvdom_document_create_comment(NULL, text);
 }
 
-// for modification operators, such as +=|-=|%=|~=|^=|$=
 struct pcvdom_attr*
-pcvdom_attr_create(const char *key, enum pchvml_attr_operator op,
-    struct pcvcm_node *vcm)
+pcvdom_document_create_attr(struct pcvdom_document *doc,
+        const char *key, enum pchvml_attr_operator op,
+        struct pcvcm_node *vcm)
 {
     if (!key) {
         pcinst_set_error(PURC_ERROR_INVALID_VALUE);
@@ -235,7 +265,7 @@ pcvdom_attr_create(const char *key, enum pchvml_attr_operator op,
         return NULL;
     }
 
-    struct pcvdom_attr *attr = attr_create();
+    struct pcvdom_attr *attr = attr_create(doc);
     if (!attr) {
         return NULL;
     }
@@ -246,9 +276,8 @@ pcvdom_attr_create(const char *key, enum pchvml_attr_operator op,
     if (attr->pre_defined) {
         attr->key = (char*)attr->pre_defined->name;
     } else {
-        attr->key = strdup(key);
+        attr->key = (char*)intern_name(key);
         if (!attr->key) {
-            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
             attr_destroy(attr);
             return NULL;
         }
@@ -259,6 +288,14 @@ pcvdom_attr_create(const char *key, enum pchvml_attr_operator op,
     return attr;
 }
 
+// for modification operators, such as +=|-=|%=|~=|^=|$=
+struct pcvdom_attr*
+pcvdom_attr_create(const char *key, enum pchvml_attr_operator op,
+    struct pcvcm_node *vcm)
+{
+    return pcvdom_document_create_attr(NULL, key, op, vcm);
+}
+
 void
 pcvdom_attr_destroy(struct pcvdom_attr *attr)
 {
@@ -460,7 +497,7 @@ pcvdom_element_set_vcm_content(struct pcvdom_element *elem,
     }
 
 normal:
-    content = content_create(vcm_content);
+    content = content_create(owner_document(&elem->node), vcm_content);
     if (!content) {
         goto out;
     }
@@ -672,6 +709,36 @@ pcvdom_node_traverse(struct pcvdom_node *node, void *ctx,
     return arg.abortion;
 }
 
+static int
+prepare_node(struct pcvdom_node *top, struct pcvdom_node *node, void *ctx)
+{
+    UNUSED_PARAM(top);
+    UNUSED_PARAM(ctx);
+
+    if (PCVDOM_NODE_IS_ELEMENT(node)) {
+        struct pcvdom_element *elem = PCVDOM_ELEMENT_FROM_NODE(node);
+        size_t nr = pcutils_array_length(elem->attrs);
+        for (size_t i = 0; i < nr; i++) {
+            struct pcvdom_attr *attr = pcutils_array_get(elem->attrs, i);
+            if (attr->val && attr->val->nr_nodes == -1)
+                pcvcm_node_prepare(attr->val);
+        }
+    }
+    else if (PCVDOM_NODE_IS_CONTENT(node)) {
+        struct pcvdom_content *content = PCVDOM_CONTENT_FROM_NODE(node);
+        if (content->vcm && content->vcm->nr_nodes == -1)
+            pcvcm_node_prepare(content->vcm);
+    }
+
+    return 0;
+}
+
+void
+pcvdom_document_prepare(struct pcvdom_document *doc)
+{
+    pcvdom_node_traverse(&doc->node, NULL, prepare_node);
+}
+
 // traverse all element
 struct element_arg {
     struct pcvdom_element    *top;
@@ -982,6 +1049,52 @@ pcvdom_util_node_serialize_ex(struct pcvdom_node *node,
 
 }
 
+static void *
+vdom_alloc(struct pcvdom_document *doc, size_t size)
+{
+    void *p;
+    if (doc)
+        p = pcutils_mem_calloc(doc->arena, size);
+    else
+        p = calloc(1, size);
+
+    if (!p)
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return p;
+}
+
+static inline void
+vdom_free(void *p, bool in_arena)
+{
+    /* the memory in the arena is released along with the document */
+    if (!in_arena)
+        free(p);
+}
+
+static const char *
+intern_name(const char *name)
+{
+    /* the atoms are shared by all vDOMs, and never freed */
+    purc_atom_t atom = purc_atom_from_string_ex(ATOM_BUCKET_HTML, name);
+    if (atom == 0) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    return purc_atom_to_string(atom);
+}
+
+static struct pcvdom_document *
+owner_document(struct pcvdom_node *node)
+{
+    struct pctree_node *p = &node->node;
+    while (p->parent)
+        p = p->parent;
+
+    node = container_of(p, struct pcvdom_node, node);
+    return PCVDOM_DOCUMENT_FROM_NODE(node);
+}
+
 static inline void
 doctype_reset(struct pcvdom_doctype *doctype)
 {
@@ -1020,6 +1133,7 @@ document_destroy(struct pcvdom_document *doc)
 {
     document_reset(doc);
     PC_ASSERT(doc->node.node.first_child == NULL);
+    pcutils_mem_destroy(doc->arena, true);
     free(doc);
 }
 
@@ -1053,6 +1167,16 @@ document_create(void)
         return NULL;
     }
 
+    doc->arena = pcutils_mem_create();
+    if (!doc->arena ||
+            pcutils_mem_init(doc->arena, VDOM_ARENA_CHUNK_SIZE)) {
+        pcutils_mem_destroy(doc->arena, true);
+        pcutils_arrlist_free(doc->bodies);
+        free(doc);
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
     doc->node.type = VDT(DOCUMENT);
     doc->node.remove_child = document_remove_child;
 
@@ -1083,9 +1207,6 @@ document_set_doctype(struct pcvdom_document *doc,
 static void
 element_reset(struct pcvdom_element *elem)
 {
-    if (elem->tag_id==VTT(_UNDEF) && elem->tag_name) {
-        free(elem->tag_name);
-    }
     elem->tag_name = NULL;
 
     while (elem->node.node.first_child) {
@@ -1102,7 +1223,7 @@ element_reset(struct pcvdom_element *elem)
             attr->parent = NULL;
             attr_destroy(attr);
         }
-        pcutils_array_destroy(elem->attrs, true);
+        pcutils_array_destroy(elem->attrs, !elem->node.in_arena);
         elem->attrs = NULL;
     }
 }
@@ -1112,25 +1233,29 @@ element_destroy(struct pcvdom_element *elem)
 {
     element_reset(elem);
     PC_ASSERT(elem->node.node.first_child == NULL);
-    free(elem);
+    vdom_free(elem, elem->node.in_arena);
 }
 
 static struct pcvdom_element*
-element_create(void)
+element_create(struct pcvdom_document *doc)
 {
     struct pcvdom_element *elem;
-    elem = (struct pcvdom_element*)calloc(1, sizeof(*elem));
+    elem = (struct pcvdom_element*)vdom_alloc(doc, sizeof(*elem));
     if (!elem) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
 
     elem->node.type = VDT(ELEMENT);
+    elem->node.in_arena = doc ? 1 : 0;
     elem->node.remove_child = NULL;
 
     elem->tag_id    = VTT(_UNDEF);
 
-    elem->attrs = pcutils_array_create();
+    /* the list of the attributes grows on the heap */
+    if (doc)
+        elem->attrs = vdom_alloc(doc, sizeof(pcutils_array_t));
+    else
+        elem->attrs = pcutils_array_create();
     if (!elem->attrs) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         element_destroy(elem);
@@ -1158,20 +1283,20 @@ content_destroy(struct pcvdom_content *content)
 {
     content_reset(content);
     PC_ASSERT(content->node.node.first_child == NULL);
-    free(content);
+    vdom_free(content, content->node.in_arena);
 }
 
 static struct pcvdom_content*
-content_create(struct pcvcm_node *vcm_content)
+content_create(struct pcvdom_document *doc, struct pcvcm_node *vcm_content)
 {
     struct pcvdom_content *content;
-    content = (struct pcvdom_content*)calloc(1, sizeof(*content));
+    content = (struct pcvdom_content*)vdom_alloc(doc, sizeof(*content));
     if (!content) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
 
     content->node.type = VDT(CONTENT);
+    content->node.in_arena = doc ? 1 : 0;
     content->node.remove_child = NULL;
 
     content->vcm = vcm_content;
@@ -1183,7 +1308,7 @@ static void
 comment_reset(struct pcvdom_comment *comment)
 {
     if (comment->text) {
-        free(comment->text);
+        vdom_free(comment->text, comment->node.in_arena);
         comment->text = NULL;
     }
 }
@@ -1193,28 +1318,29 @@ comment_destroy(struct pcvdom_comment *comment)
 {
     comment_reset(comment);
     PC_ASSERT(comment->node.node.first_child == NULL);
-    free(comment);
+    vdom_free(comment, comment->node.in_arena);
 }
 
 static struct pcvdom_comment*
-comment_create(const char *text)
+comment_create(struct pcvdom_document *doc, const char *text)
 {
     struct pcvdom_comment *comment;
-    comment = (struct pcvdom_comment*)calloc(1, sizeof(*comment));
+    comment = (struct pcvdom_comment*)vdom_alloc(doc, sizeof(*comment));
     if (!comment) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
 
     comment->node.type = VDT(COMMENT);
+    comment->node.in_arena = doc ? 1 : 0;
     comment->node.remove_child = NULL;
 
-    comment->text = strdup(text);
+    size_t len = strlen(text);
+    comment->text = vdom_alloc(doc, len + 1);
     if (!comment->text) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         comment_destroy(comment);
         return NULL;
     }
+    memcpy(comment->text, text, len);
 
     return comment;
 }
@@ -1222,9 +1348,6 @@ comment_create(const char *text)
 static void
 attr_reset(struct pcvdom_attr *attr)
 {
-    if (attr->pre_defined==NULL) {
-        free(attr->key);
-    }
     attr->pre_defined = NULL;
     attr->key = NULL;
 
@@ -1237,18 +1360,18 @@ attr_destroy(struct pcvdom_attr *attr)
 {
     PC_ASSERT(attr->parent==NULL);
     attr_reset(attr);
-    free(attr);
+    vdom_free(attr, attr->in_arena);
 }
 
 static struct pcvdom_attr*
-attr_create(void)
+attr_create(struct pcvdom_document *doc)
 {
     struct pcvdom_attr *attr;
-    attr = (struct pcvdom_attr*)calloc(1, sizeof(*attr));
+    attr = (struct pcvdom_attr*)vdom_alloc(doc, sizeof(*attr));
     if (!attr) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
+    attr->in_arena = doc ? 1 : 0;
 
     return attr;
 }
@@ -1728,7 +1851,7 @@ split_pattern_replace(const char *tokens,
 }
 
 static int
-split_re_replace(const char *tokens, regex_t *re,
+split_re_replace(const char *tokens, const regex_t **re,
         const char **replace, size_t *nr)
 {
     int r;
@@ -1779,9 +1902,9 @@ split_re_replace(const char *tokens, regex_t *re,
         return -1;
     }
 
-    r = regcomp(re, pattern.abuf, REG_EXTENDED|REG_NOSUB);
+    *re = pcregex_cache_get(pattern.abuf, REG_EXTENDED|REG_NOSUB, NULL);
     pcutils_string_reset(&pattern);
-    if (r) {
+    if (*re == NULL) {
         purc_set_error(PURC_ERROR_INVALID_OPERAND);
         return -1;
     }
@@ -1795,7 +1918,7 @@ split_re_replace(const char *tokens, regex_t *re,
 
 static purc_variant_t
 tokenwised_eval_attr_str_regex_re_replace(purc_variant_t ll,
-        regex_t *re, const char *replace, size_t nr)
+        const regex_t *re, const char *replace, size_t nr)
 {
     int r;
 
@@ -1870,7 +1993,7 @@ tokenwised_eval_attr_str_regex_replace(purc_variant_t ll,
     const char *s = purc_variant_get_string_const(rr);
     PC_ASSERT(s);
 
-    regex_t re;
+    const regex_t *re;
     const char *replace;
     size_t nr;
     r = split_re_replace(s, &re, &replace, &nr);
@@ -1878,8 +2001,8 @@ tokenwised_eval_attr_str_regex_replace(purc_variant_t ll,
         return PURC_VARIANT_INVALID;
 
     purc_variant_t v;
-    v = tokenwised_eval_attr_str_regex_re_replace(ll, &re, replace, nr);
-    regfree(&re);
+    v = tokenwised_eval_attr_str_regex_re_replace(ll, re, replace, nr);
+    pcregex_cache_release(re);
 
     return v;
 }
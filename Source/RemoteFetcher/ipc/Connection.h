@@ -252,6 +252,8 @@ private:
     bool platformCanSendOutgoingMessages() const;
     void sendOutgoingMessages();
     bool sendOutgoingMessage(std::unique_ptr<Encoder>);
+    std::unique_ptr<Encoder> takeOutgoingMessages();
+    void processIncomingBatchedMessages(Decoder&);
     void connectionDidClose();
 
     // Called on the listener thread.
@@ -116,6 +116,18 @@ std::unique_ptr<Decoder> Decoder::unwrapForTesting(Decoder& decoder)
     return Decoder::create(wrappedMessage.data(), wrappedMessage.size(), nullptr, WTFMove(attachments));
 }
 
+std::unique_ptr<Decoder> Decoder::unwrapBatched(Decoder& decoder)
+{
+    ASSERT(decoder.messageName() == MessageName::BatchedMessages);
+
+    // The batched messages have no attachment.
+    DataReference batchedMessage;
+    if (!decoder.decode(batchedMessage))
+        return nullptr;
+
+    return Decoder::create(batchedMessage.data(), batchedMessage.size(), nullptr, { });
+}
+
 static inline const uint8_t* roundUpToAlignment(const uint8_t* ptr, size_t alignment)
 {
     // Assert that the alignment is a power of 2.
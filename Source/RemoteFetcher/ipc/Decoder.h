@@ -58,6 +58,7 @@ public:
     bool shouldUseFullySynchronousModeForTesting() const;
 
     static std::unique_ptr<Decoder> unwrapForTesting(Decoder&);
+    static std::unique_ptr<Decoder> unwrapBatched(Decoder&);
 
     size_t length() const { return m_bufferEnd - m_buffer; }
 
@@ -62,6 +62,10 @@ public:
     void encodeFixedLengthData(const uint8_t* data, size_t, size_t alignment);
     void encodeVariableLengthByteArray(const DataReference&);
 
+    // Makes room for the given size of data to be encoded, so that the buffer
+    // is reallocated once rather than many times for a large argument.
+    void reserveCapacity(size_t size) { reserve(m_bufferSize + size); }
+
     template<typename T, std::enable_if_t<!std::is_enum<typename std::remove_const_t<std::remove_reference_t<T>>>::value && !std::is_arithmetic<typename std::remove_const_t<std::remove_reference_t<T>>>::value>* = nullptr>
     void encode(T&& t)
     {
@@ -94,6 +98,7 @@ public:
 
     void addAttachment(Attachment&&);
     Vector<Attachment> releaseAttachments();
+    bool hasAttachments() const { return !m_attachments.isEmpty(); }
 
     static const bool isIPCEncoder = true;
 
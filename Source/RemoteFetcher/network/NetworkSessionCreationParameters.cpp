@@ -62,6 +62,10 @@ void NetworkSessionCreationParameters::encode(IPC::Encoder& encoder) const
     encoder << requiresSecureHTTPSProxyConnection;
     encoder << preventsSystemHTTPProxyAuthentication;
     encoder << resourceLoadStatisticsParameters;
+    encoder << maxConnections;
+    encoder << maxConnectionsPerHost;
+    encoder << connectionIdleTimeout;
+    encoder << http2Enabled;
 }
 
 std::optional<NetworkSessionCreationParameters> NetworkSessionCreationParameters::decode(IPC::Decoder& decoder)
@@ -180,6 +184,26 @@ std::optional<NetworkSessionCreationParameters> NetworkSessionCreationParameters
     if (!resourceLoadStatisticsParameters)
         return std::nullopt;
 
+    std::optional<unsigned> maxConnections;
+    decoder >> maxConnections;
+    if (!maxConnections)
+        return std::nullopt;
+
+    std::optional<unsigned> maxConnectionsPerHost;
+    decoder >> maxConnectionsPerHost;
+    if (!maxConnectionsPerHost)
+        return std::nullopt;
+
+    std::optional<unsigned> connectionIdleTimeout;
+    decoder >> connectionIdleTimeout;
+    if (!connectionIdleTimeout)
+        return std::nullopt;
+
+    std::optional<bool> http2Enabled;
+    decoder >> http2Enabled;
+    if (!http2Enabled)
+        return std::nullopt;
+
     return {{
         *sessionID
         , WTFMove(*boundInterfaceIdentifier)
@@ -207,6 +231,10 @@ std::optional<NetworkSessionCreationParameters> NetworkSessionCreationParameters
         , WTFMove(*requiresSecureHTTPSProxyConnection)
         , WTFMove(*preventsSystemHTTPProxyAuthentication)
         , WTFMove(*resourceLoadStatisticsParameters)
+        , WTFMove(*maxConnections)
+        , WTFMove(*maxConnectionsPerHost)
+        , WTFMove(*connectionIdleTimeout)
+        , WTFMove(*http2Enabled)
     }};
 }
 
@@ -148,6 +148,10 @@ void NetworkDataTaskSoup::createRequest(ResourceRequest&& request, WasBlockingCo
     }
     soup_message_set_flags(m_soupMessage.get(), static_cast<SoupMessageFlags>(soup_message_get_flags(m_soupMessage.get()) | messageFlags));
     soup_message_set_priority(m_soupMessage.get(), toSoupMessagePriority(m_currentRequest.priority()));
+#if !USE(SOUP2)
+    if (!static_cast<NetworkSessionSoup&>(*m_session).soupNetworkSession().http2Enabled())
+        soup_message_set_force_http1(m_soupMessage.get(), TRUE);
+#endif
 
 #if ENABLE(RESOURCE_LOAD_STATISTICS)
     bool shouldBlockCookies = wasBlockingCookies == WasBlockingCookies::Yes ? true : m_storedCredentialsPolicy == StoredCredentialsPolicy::EphemeralStateless;
@@ -453,6 +457,26 @@ void NetworkDataTaskSoup::dispatchDidCompleteWithError(const ResourceError& erro
 {
     m_networkLoadMetrics.responseEnd = MonotonicTime::now() - m_startTime;
     m_networkLoadMetrics.markComplete();
+    // NOTE: No connecting event is emitted for a request sent over a kept-alive
+    // connection of the pool, so connectStart remains -1.
+    m_networkLoadMetrics.isReusedConnection = m_networkLoadMetrics.connectStart < 0_s;
+    if (m_soupMessage) {
+        switch (soup_message_get_http_version(m_soupMessage.get())) {
+        case SOUP_HTTP_1_0:
+            m_networkLoadMetrics.protocol = "http/1.0"_s;
+            break;
+        case SOUP_HTTP_1_1:
+            m_networkLoadMetrics.protocol = "http/1.1"_s;
+            break;
+#if !USE(SOUP2)
+        case SOUP_HTTP_2_0:
+            m_networkLoadMetrics.protocol = "h2"_s;
+            break;
+#endif
+        default:
+            break;
+        }
+    }
 
     m_client->didCompleteWithError(error, m_networkLoadMetrics);
 }
@@ -40,7 +40,7 @@ using namespace PurCFetcher;
 
 NetworkSessionSoup::NetworkSessionSoup(NetworkProcess& networkProcess, NetworkSessionCreationParameters&& parameters)
     : NetworkSession(networkProcess, parameters)
-    , m_networkSession(makeUnique<SoupNetworkSession>(m_sessionID))
+    , m_networkSession(makeUnique<SoupNetworkSession>(m_sessionID, parameters))
 {
     auto* storageSession = networkStorageSession();
     ASSERT(storageSession);
@@ -53,6 +53,11 @@ void ResourceResponse::updateFromSoupMessage(SoupMessage* soupMessage)
     case SOUP_HTTP_1_1:
         m_httpVersion = AtomString("HTTP/1.1", AtomString::ConstructFromLiteral);
         break;
+#if !USE(SOUP2)
+    case SOUP_HTTP_2_0:
+        m_httpVersion = AtomString("HTTP/2", AtomString::ConstructFromLiteral);
+        break;
+#endif
     default:
         break;
     }
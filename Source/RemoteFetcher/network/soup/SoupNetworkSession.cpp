@@ -32,6 +32,7 @@
 #include "AuthenticationChallenge.h"
 #include "GUniquePtrSoup.h"
 #include "Logging.h"
+#include "NetworkSessionCreationParameters.h"
 #include "SoupNetworkProxySettings.h"
 #include <glib/gstdio.h>
 #include <libsoup/soup.h>
@@ -117,26 +118,24 @@ static AllowedCertificatesMap& allowedCertificates()
 
 #define CACHE_STORAGE_DIR  "/tmp/fetcher/cache"
 
-SoupNetworkSession::SoupNetworkSession(PAL::SessionID sessionID)
-    : m_soupSession(adoptGRef(soup_session_new()))
+SoupNetworkSession::SoupNetworkSession(PAL::SessionID sessionID, const NetworkSessionCreationParameters& parameters)
+    : m_soupSession(adoptGRef(soup_session_new_with_options(
+        "max-conns", static_cast<int>(parameters.maxConnections),
+        "max-conns-per-host", static_cast<int>(parameters.maxConnectionsPerHost),
+        nullptr)))
     , m_sessionID(sessionID)
+    , m_http2Enabled(parameters.http2Enabled)
 {
-    // Values taken from http://www.browserscope.org/ following
-    // the rule "Do What Every Other Modern Browser Is Doing". They seem
-    // to significantly improve page loading time compared to soup's
-    // default values.
-#if USE(SOUP2)
-    static const int maxConnections = 17;
-    static const int maxConnectionsPerHost = 6;
-#endif
-
+    // The default limits are taken from http://www.browserscope.org/
+    // following the rule "Do What Every Other Modern Browser Is Doing".
+    // They seem to significantly improve page loading time compared to
+    // soup's default values. The limits are construct-only properties
+    // since libsoup 3, so they are passed to the constructor.
+    // NOTE: An idle connection is kept alive for reuse by the following
+    // requests to the same origin until the idle timeout if it is not zero.
     g_object_set(m_soupSession.get(),
-#if USE(SOUP2)
-        "max-conns", maxConnections,
-        "max-conns-per-host", maxConnectionsPerHost,
-#endif
         "timeout", 0,
-        "idle-timeout", 0,
+        "idle-timeout", parameters.connectionIdleTimeout,
         nullptr);
 
     soup_session_add_feature_by_type(m_soupSession.get(), SOUP_TYPE_CONTENT_SNIFFER);
@@ -43,15 +43,17 @@ namespace PurCFetcher {
 
 class CertificateInfo;
 class ResourceError;
+struct NetworkSessionCreationParameters;
 struct SoupNetworkProxySettings;
 
 class SoupNetworkSession {
     WTF_MAKE_NONCOPYABLE(SoupNetworkSession); WTF_MAKE_FAST_ALLOCATED;
 public:
-    explicit SoupNetworkSession(PAL::SessionID);
+    SoupNetworkSession(PAL::SessionID, const NetworkSessionCreationParameters&);
     ~SoupNetworkSession();
 
     SoupSession* soupSession() const { return m_soupSession.get(); }
+    bool http2Enabled() const { return m_http2Enabled; }
 
     void setCookieJar(SoupCookieJar*);
     SoupCookieJar* cookieJar() const;
@@ -81,6 +83,7 @@ private:
     GRefPtr<SoupSession> m_soupSession;
     GRefPtr<SoupCache> m_soupCache;
     PAL::SessionID m_sessionID;
+    bool m_http2Enabled { true };
 };
 
 } // namespace PurCFetcher
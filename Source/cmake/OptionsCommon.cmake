@@ -133,6 +133,7 @@ PURC_CHECK_HAVE_INCLUDE(HAVE_SYS_TIMEB_H sys/timeb.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_SYS_SYSMACROS_H sys/sysmacros.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_LINUX_MEMFD_H linux/memfd.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_LINUX_FS_H linux/fs.h)
+PURC_CHECK_HAVE_INCLUDE(HAVE_LINUX_MEMPOLICY_H linux/mempolicy.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_SYSLOG_H syslog.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_FCNTL_H fcntl.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_STROPTS_H stropts.h)
@@ -155,6 +156,7 @@ PURC_CHECK_HAVE_FUNCTION(HAVE_UTIMENSAT utimensat)
 PURC_CHECK_HAVE_FUNCTION(HAVE_RANDOM_R random_r)
 PURC_CHECK_HAVE_FUNCTION(HAVE_GET_PROCESS_STATS get_process_stats)
 PURC_CHECK_HAVE_FUNCTION(HAVE_POSIX_FALLOCATE posix_fallocate)
+PURC_CHECK_HAVE_FUNCTION(HAVE_PTHREAD_SETAFFINITY_NP pthread_setaffinity_np)
 
 # Check for symbols
 PURC_CHECK_HAVE_SYMBOL(HAVE_REGEX_H regexec regex.h)
@@ -91,6 +91,10 @@ macro(PURC_OPTION_BEGIN)
 
     PURC_OPTION_DEFINE(ENABLE_CHINESE_NAMES "Toggle support for variable and key names in Chinese (TEST only)" PUBLIC OFF)
     PURC_OPTION_DEFINE(ENABLE_SOCKET_STREAM "Toggle socket stream" PUBLIC ON)
+    PURC_OPTION_DEFINE(ENABLE_IO_URING "Toggle io_uring for the writes of streams (Linux only)" PUBLIC OFF)
+    PURC_OPTION_DEFINE(ENABLE_EPOLL_RUNLOOP "Toggle the native epoll backend for the fd monitors, the timers, and the dispatched functions of the run loop (Linux only)" PUBLIC OFF)
+    PURC_OPTION_DEFINE(ENABLE_ALLOC_STATS "Toggle counting of the allocations made by the C library (TEST only; glibc only)" PUBLIC OFF)
+    PURC_OPTION_DEFINE(ENABLE_LOCK_STATS "Toggle the contention statistics of purc_mutex and purc_rwlock" PUBLIC OFF)
     PURC_OPTION_DEFINE(ENABLE_RENDERER_FOIL "Toggle the builtin Foil renderer in `purc`" PUBLIC ON)
     PURC_OPTION_DEFINE(ENABLE_REMOTE_FETCHER "Toggle use of the remote PurC Fetcher" PUBLIC ON)
     PURC_OPTION_DEFINE(ENABLE_RDRCM_THREAD "Toggle the renderer communication method `thread`" PUBLIC ON)
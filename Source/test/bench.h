@@ -0,0 +1,241 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The helpers for the benchmarks (bench_ejson, bench_hvml, and others).
+ *
+ * Include this header in exactly one source file of a benchmark program:
+ * it defines malloc(), calloc(), and realloc() of the program to count
+ * the allocations made by PurC (only with glibc).
+ */
+
+#ifndef PURC_TEST_BENCH_H
+#define PURC_TEST_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <glob.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#define BENCH_COUNT_ALLOCS  1
+
+static std::atomic<size_t> bench_nr_allocs;
+
+extern "C" {
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    bench_nr_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    bench_nr_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    bench_nr_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+
+static inline size_t bench_get_nr_allocs(void)
+{
+    return bench_nr_allocs.load(std::memory_order_relaxed);
+}
+
+#else
+#define BENCH_COUNT_ALLOCS  0
+
+static inline size_t bench_get_nr_allocs(void)
+{
+    return 0;
+}
+
+#endif /* defined(__GLIBC__) */
+
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+enum { BENCH_FORMAT_TEXT, BENCH_FORMAT_JSON, BENCH_FORMAT_CSV };
+
+struct bench_options {
+    int         format;
+    const char *filter;
+    uint64_t    min_ns;
+    std::vector<std::string> files;     // the extra corpus files
+};
+
+/* parses the common options; returns false on a bad option */
+static inline bool
+bench_parse_options(int argc, char **argv, struct bench_options *opts)
+{
+    opts->format = BENCH_FORMAT_TEXT;
+    opts->filter = NULL;
+    opts->min_ns = 500 * 1000000ULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--format=json") == 0)
+            opts->format = BENCH_FORMAT_JSON;
+        else if (strcmp(argv[i], "--format=csv") == 0)
+            opts->format = BENCH_FORMAT_CSV;
+        else if (strcmp(argv[i], "--format=text") == 0)
+            opts->format = BENCH_FORMAT_TEXT;
+        else if (strncmp(argv[i], "--filter=", 9) == 0)
+            opts->filter = argv[i] + 9;
+        else if (strncmp(argv[i], "--min-time=", 11) == 0) {
+            long ms = atol(argv[i] + 11);
+            opts->min_ns = (ms > 0 ? ms : 1) * 1000000ULL;
+        }
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [--format=text|json|csv] "
+                    "[--filter=<substring>] [--min-time=<milliseconds>] "
+                    "[<corpus file>...]\n", argv[0]);
+            return false;
+        }
+        else
+            opts->files.push_back(argv[i]);
+    }
+
+    return true;
+}
+
+static inline bool bench_read_file(const char *file, std::string &contents)
+{
+    FILE *fp = fopen(file, "rb");
+    if (fp == NULL)
+        return false;
+
+    char buf[8192];
+    size_t n;
+    contents.clear();
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        contents.append(buf, n);
+    fclose(fp);
+    return true;
+}
+
+/* appends the files matching the pattern to `files` in sorted order */
+static inline void
+bench_glob_files(const char *pattern, std::vector<std::string> &files)
+{
+    glob_t g;
+    if (glob(pattern, 0, NULL, &g) == 0) {
+        for (size_t i = 0; i < g.gl_pathc; i++)
+            files.push_back(g.gl_pathv[i]);
+    }
+    globfree(&g);
+}
+
+static inline void bench_report_begin(const struct bench_options *opts)
+{
+    if (opts->format == BENCH_FORMAT_JSON)
+        printf("{\n  \"benchmarks\": [");
+    else if (opts->format == BENCH_FORMAT_CSV)
+        printf("name,corpus,bytes,iterations,mb_per_sec,allocs_per_mb\n");
+    else
+        printf("%-16s %-28s %10s %10s %10s %14s\n", "name", "corpus",
+                "bytes", "iterations", "MB/s", "allocs/MB");
+}
+
+static inline void bench_report_end(const struct bench_options *opts)
+{
+    if (opts->format == BENCH_FORMAT_JSON)
+        printf("\n  ]\n}\n");
+}
+
+/*
+ * Runs the parsing of `nr_bytes` bytes until the minimal time elapses,
+ * and reports the throughput. `parse` returns false on failure.
+ */
+static inline bool
+bench_run(const struct bench_options *opts, const char *name,
+        const char *corpus, size_t nr_bytes,
+        const std::function<bool(void)> &parse)
+{
+    static bool first = true;
+
+    if (opts->filter && strstr(name, opts->filter) == NULL &&
+            strstr(corpus, opts->filter) == NULL)
+        return true;
+
+    /* warm up, and make sure the corpus can be parsed */
+    if (!parse()) {
+        fprintf(stderr, "%s: failed to parse %s\n", name, corpus);
+        return false;
+    }
+
+    size_t iterations = 0;
+    size_t nr_allocs = bench_get_nr_allocs();
+    uint64_t start = bench_now_ns(), elapsed;
+    do {
+        parse();
+        iterations++;
+        elapsed = bench_now_ns() - start;
+    } while (elapsed < opts->min_ns);
+    nr_allocs = bench_get_nr_allocs() - nr_allocs;
+
+    double mb = (double)nr_bytes * iterations / (1024.0 * 1024.0);
+    double mb_per_sec = mb / (elapsed / 1e9);
+    double allocs_per_mb = BENCH_COUNT_ALLOCS ? nr_allocs / mb : -1;
+
+    switch (opts->format) {
+    case BENCH_FORMAT_JSON:
+        printf("%s\n    {\"name\": \"%s\", \"corpus\": \"%s\", "
+                "\"bytes\": %zu, \"iterations\": %zu, "
+                "\"mb_per_sec\": %.2f, \"allocs_per_mb\": %.1f}",
+                first ? "" : ",", name, corpus, nr_bytes, iterations,
+                mb_per_sec, allocs_per_mb);
+        break;
+
+    case BENCH_FORMAT_CSV:
+        printf("%s,%s,%zu,%zu,%.2f,%.1f\n", name, corpus, nr_bytes,
+                iterations, mb_per_sec, allocs_per_mb);
+        break;
+
+    default:
+        printf("%-16s %-28s %10zu %10zu %10.2f %14.1f\n", name, corpus,
+                nr_bytes, iterations, mb_per_sec, allocs_per_mb);
+        break;
+    }
+
+    first = false;
+    return true;
+}
+
+#endif /* PURC_TEST_BENCH_H */
+
@@ -22,6 +22,7 @@
 ** along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <purc/purc.h>
 #include <purc/purc-document.h>
 
 #include <stdio.h>
@@ -668,3 +669,365 @@ TEST(document, elem_coll_by_id)
 }
 
 
+
+static ssize_t count_selected(purc_document_t doc, const char *sel)
+{
+    pcdoc_selector_t selector = pcdoc_selector_new(sel);
+    if (selector == NULL)
+        return -1;
+
+    pcdoc_elem_coll_t coll = pcdoc_elem_coll_new_from_document(doc, selector);
+    ssize_t count = pcdoc_elem_coll_count(doc, coll);
+    pcdoc_elem_coll_delete(doc, coll);
+    pcdoc_selector_delete(selector);
+    return count;
+}
+
+TEST(document, select_with_indexes)
+{
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    // the indexes are built by the second selection in the same age
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(count_selected(doc, ".tocline1"), 26);
+        ASSERT_EQ(count_selected(doc, "li.TOCLINE1"), 26);
+        ASSERT_EQ(count_selected(doc, "ul.toc > li"), 26);
+        ASSERT_EQ(count_selected(doc, "li .tocxref"), 26);
+        ASSERT_EQ(count_selected(doc, "body#bar"), 1);
+        ASSERT_EQ(count_selected(doc, "li, .tocxref"), 52);
+        ASSERT_EQ(count_selected(doc, ".nonexistent"), 0);
+    }
+
+    pcdoc_element_t body = purc_document_special_elem(doc,
+            PCDOC_SPECIAL_ELEM_BODY);
+    ASSERT_NE(body, nullptr);
+
+    pcdoc_element_t elem = pcdoc_element_new_element(doc, body,
+            PCDOC_OP_APPEND, "li", false);
+    ASSERT_NE(elem, nullptr);
+    ASSERT_EQ(count_selected(doc, "li"), 27);
+    ASSERT_EQ(count_selected(doc, "li"), 27);
+
+    pcdoc_element_set_attribute(doc, elem, PCDOC_OP_DISPLACE,
+            "class", "tocline1 new", 0);
+    ASSERT_EQ(count_selected(doc, ".tocline1"), 27);
+    ASSERT_EQ(count_selected(doc, ".new"), 1);
+
+    // not an indexed attribute
+    pcdoc_element_set_attribute(doc, elem, PCDOC_OP_DISPLACE,
+            "title", "new", 0);
+    ASSERT_EQ(count_selected(doc, ".new"), 1);
+
+    pcdoc_element_set_attribute(doc, elem, PCDOC_OP_ERASE,
+            "class", NULL, 0);
+    ASSERT_EQ(count_selected(doc, ".new"), 0);
+    ASSERT_EQ(count_selected(doc, ".new"), 0);
+
+    pcdoc_element_erase(doc, elem);
+    ASSERT_EQ(count_selected(doc, "li"), 26);
+    ASSERT_EQ(count_selected(doc, "li"), 26);
+
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
+
+TEST(document, class_lists)
+{
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    pcdoc_element_t body = purc_document_special_elem(doc,
+            PCDOC_SPECIAL_ELEM_BODY);
+    ASSERT_NE(body, nullptr);
+
+    struct lwc_string_s * const *classes;
+    size_t nr_classes;
+    int ret = pcdoc_element_get_classes(doc, body, &classes, &nr_classes);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(nr_classes, 3);
+
+    bool found;
+    ret = pcdoc_element_has_class(doc, body, "FOOBAR", &found);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(found, true);
+
+    ret = pcdoc_element_has_class(doc, body, "fooba", &found);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(found, false);
+    ASSERT_EQ(count_selected(doc, ".fooba"), 0);
+    ASSERT_EQ(count_selected(doc, ".foobar"), 1);
+
+    // the cached class list is dropped when the attribute changes
+    pcdoc_element_set_attribute(doc, body, PCDOC_OP_DISPLACE,
+            "class", "fooba", 0);
+    ret = pcdoc_element_get_classes(doc, body, &classes, &nr_classes);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(nr_classes, 1);
+    ASSERT_EQ(count_selected(doc, ".fooba"), 1);
+    ASSERT_EQ(count_selected(doc, ".foobar"), 0);
+
+    pcdoc_element_t elem = pcdoc_element_new_element(doc, body,
+            PCDOC_OP_APPEND, "div", false);
+    ASSERT_NE(elem, nullptr);
+    ret = pcdoc_element_get_classes(doc, elem, &classes, &nr_classes);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(nr_classes, 0);
+
+    pcdoc_element_clear(doc, body);
+    ASSERT_EQ(count_selected(doc, ".tocline1"), 0);
+
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
+
+TEST(document, selector_cache)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_HTML, "cn.fmsoft.hvml.test",
+            "selector_cache", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    size_t nr_cached, nr_hits, nr_misses;
+    pcdoc_selector_t sel1 = pcdoc_selector_new("ul.toc > li");
+    ASSERT_NE(sel1, nullptr);
+    pcdoc_selector_t sel2 = pcdoc_selector_new("ul.toc > li");
+    ASSERT_EQ(sel1, sel2);
+    pcdoc_selector_t sel3 = pcdoc_selector_new("#bar");
+    ASSERT_NE(sel3, nullptr);
+    ASSERT_NE(sel1, sel3);
+
+    ret = pcdoc_selector_cache_get_stat(&nr_cached, &nr_hits, &nr_misses);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(nr_cached, 2);
+    ASSERT_EQ(nr_hits, 1);
+    ASSERT_EQ(nr_misses, 2);
+
+    // a collection holds the selector shared
+    pcdoc_elem_coll_t coll = pcdoc_elem_coll_new_from_document(doc, sel1);
+    ASSERT_EQ(pcdoc_elem_coll_count(doc, coll), 26);
+    pcdoc_selector_delete(sel1);
+    pcdoc_selector_delete(sel2);
+    pcdoc_selector_delete(sel3);
+
+    ASSERT_EQ(pcdoc_selector_new("a("), nullptr);
+
+    // evict the first selector while it is still in use
+    for (int i = 0; i < 64; i++) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), ".c%d", i);
+        pcdoc_selector_t sel = pcdoc_selector_new(buf);
+        ASSERT_NE(sel, nullptr);
+        pcdoc_selector_delete(sel);
+    }
+
+    ret = pcdoc_selector_cache_get_stat(&nr_cached, NULL, NULL);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(nr_cached, 32);
+    ASSERT_EQ(count_selected(doc, "ul.toc > li"), 26);
+    pcdoc_elem_coll_delete(doc, coll);
+
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+
+    purc_cleanup();
+}
+
+TEST(document, lazy_elem_coll)
+{
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    ssize_t nr_lines = count_selected(doc, "li.tocline1");
+    ASSERT_GT(nr_lines, 1);
+
+    pcdoc_selector_t selector = pcdoc_selector_new("li.tocline1");
+    ASSERT_NE(selector, nullptr);
+
+    // only the first element is looked for
+    pcdoc_elem_coll_t coll = pcdoc_elem_coll_new_from_document(doc, selector);
+    ASSERT_NE(coll, nullptr);
+    pcdoc_element_t first = pcdoc_elem_coll_get(doc, coll, 0);
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(pcdoc_elem_coll_get(doc, coll, 0), first);
+
+    // the pending collection keeps the snapshot when the document changes
+    pcdoc_element_t body = purc_document_special_elem(doc,
+            PCDOC_SPECIAL_ELEM_BODY);
+    pcdoc_element_t elem = pcdoc_element_new_element(doc, body,
+            PCDOC_OP_APPEND, "li", false);
+    ASSERT_NE(elem, nullptr);
+    pcdoc_element_set_attribute(doc, elem, PCDOC_OP_DISPLACE,
+            "class", "tocline1", 0);
+    ASSERT_EQ(pcdoc_elem_coll_count(doc, coll), nr_lines);
+    ASSERT_EQ(pcdoc_elem_coll_get(doc, coll, 0), first);
+    ASSERT_EQ(count_selected(doc, "li.tocline1"), nr_lines + 1);
+
+    pcdoc_elem_coll_delete(doc, coll);
+
+    // the elements are selected in the current age when accessed
+    coll = pcdoc_elem_coll_new_from_document(doc, selector);
+    ASSERT_NE(coll, nullptr);
+    ASSERT_EQ(pcdoc_elem_coll_get(doc, coll, 0), first);
+    ASSERT_EQ(pcdoc_elem_coll_get(doc, coll, nr_lines), elem);
+    ASSERT_EQ(pcdoc_elem_coll_count(doc, coll), nr_lines + 1);
+    pcdoc_elem_coll_delete(doc, coll);
+
+    // a pending collection deleted before being accessed
+    coll = pcdoc_elem_coll_new_from_document(doc, selector);
+    ASSERT_NE(coll, nullptr);
+    pcdoc_elem_coll_delete(doc, coll);
+    pcdoc_element_erase(doc, elem);
+    ASSERT_EQ(count_selected(doc, "li.tocline1"), nr_lines);
+
+    pcdoc_selector_delete(selector);
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
+
+TEST(document, mem_stat)
+{
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    struct purc_document_mem_stat stat;
+    int ret = purc_document_get_mem_stat(doc, &stat);
+    ASSERT_EQ(ret, 0);
+    ASSERT_GT(stat.nr_chunks, 0);
+    ASSERT_GE(stat.sz_reserved, stat.sz_allocated);
+
+    // the memory of the subtree cleared is kept for reuse
+    pcdoc_element_t body = purc_document_special_elem(doc,
+            PCDOC_SPECIAL_ELEM_BODY);
+    pcdoc_element_clear(doc, body);
+
+    struct purc_document_mem_stat cleared;
+    ret = purc_document_get_mem_stat(doc, &cleared);
+    ASSERT_EQ(ret, 0);
+    ASSERT_GT(cleared.nr_free_blocks, stat.nr_free_blocks);
+    ASSERT_GT(cleared.sz_free, stat.sz_free);
+
+    // and reused by the new nodes
+    for (int i = 0; i < 16; i++) {
+        pcdoc_element_t elem = pcdoc_element_new_element(doc, body,
+                PCDOC_OP_APPEND, "li", false);
+        ASSERT_NE(elem, nullptr);
+        pcdoc_element_new_text_content(doc, elem, PCDOC_OP_APPEND,
+                "item", 0);
+    }
+
+    struct purc_document_mem_stat reused;
+    ret = purc_document_get_mem_stat(doc, &reused);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(reused.nr_chunks, cleared.nr_chunks);
+    ASSERT_LT(reused.sz_free, cleared.sz_free);
+
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
+
+TEST(document, serialize_escaping)
+{
+    static const char *html =
+        "<!DOCTYPE html><html><body>"
+        "<p title='a\"b &amp; c'>The runs without any character to escape"
+        " x&lt;y &amp; z&gt;0\xC2\xA0w \xE2\x80\x9Cquoted\xE2\x80\x9D 'a'"
+        " and a long run again at the end</p>"
+        "</body></html>";
+
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html, strlen(html));
+    ASSERT_NE(doc, nullptr);
+
+    purc_rwstream_t stm = purc_rwstream_new_buffer(0, 0);
+    ASSERT_NE(stm, nullptr);
+
+    int ret = purc_document_serialize_contents_to_stream(doc,
+            PCDOC_SERIALIZE_OPT_SKIP_WS_NODES |
+            PCDOC_SERIALIZE_OPT_WITHOUT_TEXT_INDENT, stm);
+    ASSERT_EQ(ret, 0);
+    purc_rwstream_write(stm, "", 1);
+
+    size_t sz = 0;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(stm, &sz);
+    ASSERT_NE(strstr(buf, "title=\"a&quot;b &amp; c\""), nullptr);
+    ASSERT_NE(strstr(buf, "The runs without any character to escape"
+                " x&lt;y &amp; z&gt;0&nbsp;w \xE2\x80\x9Cquoted\xE2\x80\x9D 'a'"
+                " and a long run again at the end"), nullptr);
+
+    purc_rwstream_destroy(stm);
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
+
+static std::string serialize_element(purc_document_t doc, pcdoc_element_t elem)
+{
+    purc_rwstream_t stm = purc_rwstream_new_buffer(0, 0);
+    pcdoc_serialize_descendants_to_stream(doc, elem,
+            PCDOC_SERIALIZE_OPT_SKIP_WS_NODES |
+            PCDOC_SERIALIZE_OPT_WITHOUT_TEXT_INDENT, stm);
+
+    size_t sz = 0;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(stm, &sz);
+    std::string str(buf, sz);
+    purc_rwstream_destroy(stm);
+    return str;
+}
+
+TEST(document, simple_fragments)
+{
+    static const char *fragments[] = {
+        "<li class=\"row\" data-id=3>A &amp; B&#x41;&#66;<br/>"
+            "<span title='x &lt; y'>c</span></li>",
+        "<li><a href=\"#top\"><b>bold</b> <i>it</i></a></li>\n<li>2</li>",
+        "<li><ul><li>nested</li></ul></li><li hidden>x &copy y</li>",
+        "<li>a<p>b</li>",
+        "<li><p>a<div>b</div></p></li>",
+        "<li><my-item Foo=\"1\" foo=\"2\">custom</my-item></li>",
+        "<li><table><td>cell</td></table></li><!-- comment -->",
+        "<li>a</li></ul><li>b < c</li>",
+    };
+
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    pcdoc_element_t body = purc_document_special_elem(doc,
+            PCDOC_SPECIAL_ELEM_BODY);
+    ASSERT_NE(body, nullptr);
+
+    for (size_t i = 0; i < sizeof(fragments) / sizeof(fragments[0]); i++) {
+        // the fragments go to the fast path in ul, but not in dl
+        pcdoc_element_t ul = pcdoc_element_new_element(doc, body,
+                PCDOC_OP_APPEND, "ul", false);
+        pcdoc_element_t dl = pcdoc_element_new_element(doc, body,
+                PCDOC_OP_APPEND, "dl", false);
+        ASSERT_NE(ul, nullptr);
+        ASSERT_NE(dl, nullptr);
+
+        pcdoc_element_new_content(doc, ul, PCDOC_OP_APPEND, fragments[i], 0);
+        pcdoc_element_new_content(doc, dl, PCDOC_OP_APPEND, fragments[i], 0);
+
+        std::string fast = serialize_element(doc, ul);
+        std::string full = serialize_element(doc, dl);
+        size_t pos = full.find("<dl");
+        ASSERT_NE(pos, std::string::npos);
+        full.replace(pos, 3, "<ul");
+        pos = full.rfind("</dl>");
+        ASSERT_NE(pos, std::string::npos);
+        full.replace(pos, 5, "</ul>");
+
+        ASSERT_STREQ(fast.c_str(), full.c_str()) << fragments[i];
+    }
+
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
@@ -0,0 +1,408 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The benchmark of the CSS selection by CSSEng and the layout by DOMRuler.
+ *
+ * Usage: bench_domruler [--format=text|json|csv] [--filter=<substring>]
+ *          [--min-time=<milliseconds>] [<HTML file>...]
+ *
+ * Without any file, it lays out the built-in documents of about 10k
+ * elements each:
+ *
+ *  - page: sections of lists with links, in the shape of a real page;
+ *  - wide: 5000 sibling blocks, each with an inline child;
+ *  - deep: 40 chains of 250 nested blocks.
+ *
+ * The files given on the command line are laid out instead. All the
+ * documents are styled by the same generated style sheet of 1000 rules
+ * keyed by the classes, the identifiers, and the descendant and child
+ * combinators.
+ *
+ * The report for every document:
+ *
+ *  - select: the elements selected per second by css_select_style() for
+ *    the whole tree;
+ *  - layout: the elements laid out per second by domruler_layout(),
+ *    selection included;
+ *  - examined, matched: the selector chains examined and matched per
+ *    element, from the statistics of the selection context.
+ *
+ * This is written in C, unlike the benchmarks sharing test/bench.h,
+ * because the headers of CSSEng and DOMRuler are not for C++.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "purc/purc.h"
+
+#include <csseng/csseng.h>
+#include "domruler.h"
+#include "node.h"
+#include "select.h"
+#include "layout.h"
+
+#define NR_RULES        1000
+#define NR_CLASSES      200
+
+enum { FORMAT_TEXT, FORMAT_JSON, FORMAT_CSV };
+
+struct options {
+    int         format;
+    const char *filter;
+    uint64_t    min_ns;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static char *make_style_sheet(size_t nr_rules, size_t *len)
+{
+    char *css;
+    FILE *fp = open_memstream(&css, len);
+
+    fputs("html, body, section, div, ul, li, p, h2 { display: block; }\n"
+          "head, link, meta, script, style, title { display: none; }\n"
+          "span, a { display: inline-block; }\n", fp);
+
+    for (size_t i = 0; i < nr_rules; i++) {
+        size_t k = i % NR_CLASSES;
+        switch (i % 5) {
+        case 0:
+            fprintf(fp, ".c%zu { color: #%06zx; }\n",
+                    k, (size_t)(i * 2654435761U % 0xFFFFFF));
+            break;
+        case 1:
+            fprintf(fp, "#e%zu { margin: %zupx; }\n", i, i % 7);
+            break;
+        case 2:
+            fprintf(fp, "div.c%zu > span { padding: 1px; }\n", k);
+            break;
+        case 3:
+            fprintf(fp, "section .c%zu a { width: 50%%; }\n", k);
+            break;
+        default:
+            fprintf(fp, "ul li.c%zu { height: %zupx; }\n", k, 10 + i % 5);
+            break;
+        }
+    }
+
+    fclose(fp);
+    return css;
+}
+
+static char *make_page(size_t nr_sections, size_t nr_items, size_t *len)
+{
+    char *html;
+    FILE *fp = open_memstream(&html, len);
+    size_t id = 0;
+
+    fputs("<html><head><title>bench</title></head><body>", fp);
+    for (size_t i = 0; i < nr_sections; i++) {
+        fprintf(fp, "<section id=\"e%zu\"><h2>Section %zu</h2>"
+                "<div class=\"c%zu\"><ul>", id++, i, i % NR_CLASSES);
+        for (size_t j = 0; j < nr_items; j++) {
+            fprintf(fp, "<li class=\"c%zu\" id=\"e%zu\">"
+                    "<a href=\"#%zu\">Item %zu</a><span>%zu</span></li>",
+                    (i + j) % NR_CLASSES, id++, j, j, i * nr_items + j);
+        }
+        fputs("</ul></div></section>", fp);
+    }
+    fputs("</body></html>", fp);
+
+    fclose(fp);
+    return html;
+}
+
+static char *make_wide(size_t nr_blocks, size_t *len)
+{
+    char *html;
+    FILE *fp = open_memstream(&html, len);
+
+    fputs("<html><head></head><body>", fp);
+    for (size_t i = 0; i < nr_blocks; i++) {
+        fprintf(fp, "<div class=\"c%zu\" id=\"e%zu\"><span>%zu</span></div>",
+                i % NR_CLASSES, i, i);
+    }
+    fputs("</body></html>", fp);
+
+    fclose(fp);
+    return html;
+}
+
+static char *make_deep(size_t nr_chains, size_t depth, size_t *len)
+{
+    char *html;
+    FILE *fp = open_memstream(&html, len);
+
+    fputs("<html><head></head><body>", fp);
+    for (size_t i = 0; i < nr_chains; i++) {
+        for (size_t j = 0; j < depth; j++)
+            fprintf(fp, "<div class=\"c%zu\">", (i + j) % NR_CLASSES);
+        for (size_t j = 0; j < depth; j++)
+            fputs("</div>", fp);
+    }
+    fputs("</body></html>", fp);
+
+    fclose(fp);
+    return html;
+}
+
+static size_t count_elements(pcdom_node_t *node)
+{
+    size_t n = (node->type == PCDOM_NODE_TYPE_ELEMENT) ? 1 : 0;
+    for (pcdom_node_t *child = node->first_child; child; child = child->next)
+        n += count_elements(child);
+    return n;
+}
+
+static void report_begin(const struct options *opts)
+{
+    if (opts->format == FORMAT_JSON)
+        printf("{\n  \"benchmarks\": [");
+    else if (opts->format == FORMAT_CSV)
+        printf("corpus,elements,rules,select_elems_per_sec,"
+                "layout_elems_per_sec,examined_per_elem,matched_per_elem\n");
+    else
+        printf("%-20s %9s %6s %12s %12s %10s %10s\n", "corpus", "elements",
+                "rules", "select/s", "layout/s", "examined", "matched");
+}
+
+static void report_end(const struct options *opts)
+{
+    if (opts->format == FORMAT_JSON)
+        printf("\n  ]\n}\n");
+}
+
+static void report(const struct options *opts, const char *corpus,
+        size_t nr_elements, size_t nr_rules, double select_per_sec,
+        double layout_per_sec, double examined, double matched)
+{
+    static bool first = true;
+
+    switch (opts->format) {
+    case FORMAT_JSON:
+        printf("%s\n    {\"corpus\": \"%s\", \"elements\": %zu, "
+                "\"rules\": %zu, \"select_elems_per_sec\": %.1f, "
+                "\"layout_elems_per_sec\": %.1f, \"examined_per_elem\": %.1f, "
+                "\"matched_per_elem\": %.1f}",
+                first ? "" : ",", corpus, nr_elements, nr_rules,
+                select_per_sec, layout_per_sec, examined, matched);
+        break;
+
+    case FORMAT_CSV:
+        printf("%s,%zu,%zu,%.1f,%.1f,%.1f,%.1f\n", corpus, nr_elements,
+                nr_rules, select_per_sec, layout_per_sec, examined, matched);
+        break;
+
+    default:
+        printf("%-20s %9zu %6zu %12.1f %12.1f %10.1f %10.1f\n", corpus,
+                nr_elements, nr_rules, select_per_sec, layout_per_sec,
+                examined, matched);
+        break;
+    }
+
+    first = false;
+}
+
+/* selects the styles of the whole tree once; returns false on failure */
+static bool select_tree(struct DOMRulerCtxt *ctxt, HLLayoutNode *root,
+        css_select_stats *stats)
+{
+    css_media media;
+    memset(&media, 0, sizeof(media));
+    media.type = CSS_MEDIA_SCREEN;
+    /* kept by the last layout in the CSS pixels */
+    media.width = ctxt->vw;
+    media.height = ctxt->vh;
+
+    css_select_ctx *select_ctx = hl_css_select_ctx_create(ctxt->css);
+    if (select_ctx == NULL)
+        return false;
+
+    int ret = hl_select_child_style(&media, select_ctx, root);
+    if (stats)
+        css_select_ctx_get_stats(select_ctx, stats, false);
+    hl_css_select_ctx_destroy(select_ctx);
+    return ret == DOMRULER_OK;
+}
+
+static bool run_corpus(const struct options *opts, const char *name,
+        const char *html, size_t len, const char *css, size_t nr_css)
+{
+    if (opts->filter && strstr(name, opts->filter) == NULL)
+        return true;
+
+    pchtml_html_document_t *doc = pchtml_html_document_create();
+    if (doc == NULL || pchtml_html_document_parse_with_buf(doc,
+                (const unsigned char *)html, len)) {
+        fprintf(stderr, "%s: failed to parse the document\n", name);
+        if (doc)
+            pchtml_html_document_destroy(doc);
+        return false;
+    }
+
+    pcdom_element_t *root = pcdom_interface_document(doc)->element;
+    size_t nr_elements = count_elements(&root->node);
+
+    struct DOMRulerCtxt *ctxt = domruler_create(1280, 720, 72, 27);
+    bool ok = (ctxt != NULL &&
+            domruler_append_css(ctxt, css, nr_css) == DOMRULER_OK);
+
+    /* the first layout creates the layout nodes and checks the document */
+    if (ok && domruler_layout_pcdom_elements(ctxt, root) != DOMRULER_OK) {
+        fprintf(stderr, "%s: failed to lay out the document\n", name);
+        ok = false;
+    }
+
+    css_select_stats stats;
+    HLLayoutNode *layout_root = NULL;
+    if (ok) {
+        layout_root = hl_layout_node_from_origin_node(ctxt, root);
+        ok = select_tree(ctxt, layout_root, &stats);
+        if (!ok)
+            fprintf(stderr, "%s: failed to select the styles\n", name);
+    }
+
+    if (ok) {
+        size_t nr_selects = 0, nr_layouts = 0;
+        uint64_t start = now_ns(), select_ns, layout_ns;
+        do {
+            select_tree(ctxt, layout_root, NULL);
+            nr_selects++;
+            select_ns = now_ns() - start;
+        } while (select_ns < opts->min_ns);
+
+        start = now_ns();
+        do {
+            domruler_layout_pcdom_elements(ctxt, root);
+            nr_layouts++;
+            layout_ns = now_ns() - start;
+        } while (layout_ns < opts->min_ns);
+
+        double nr_selected = stats.n_elements ? (double)stats.n_elements : 1;
+        report(opts, name, nr_elements, NR_RULES,
+                nr_elements * nr_selects / (select_ns / 1e9),
+                nr_elements * nr_layouts / (layout_ns / 1e9),
+                stats.n_examined / nr_selected,
+                stats.n_matched / nr_selected);
+    }
+
+    if (ctxt)
+        domruler_destroy(ctxt);
+    pchtml_html_document_destroy(doc);
+    return ok;
+}
+
+static bool parse_options(int argc, char **argv, struct options *opts,
+        int *first_file)
+{
+    opts->format = FORMAT_TEXT;
+    opts->filter = NULL;
+    opts->min_ns = 500 * 1000000ULL;
+
+    int i;
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "--format=json") == 0)
+            opts->format = FORMAT_JSON;
+        else if (strcmp(argv[i], "--format=csv") == 0)
+            opts->format = FORMAT_CSV;
+        else if (strcmp(argv[i], "--format=text") == 0)
+            opts->format = FORMAT_TEXT;
+        else if (strncmp(argv[i], "--filter=", 9) == 0)
+            opts->filter = argv[i] + 9;
+        else if (strncmp(argv[i], "--min-time=", 11) == 0) {
+            long ms = atol(argv[i] + 11);
+            opts->min_ns = (ms > 0 ? ms : 1) * 1000000ULL;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--format=text|json|csv] "
+                    "[--filter=<substring>] [--min-time=<milliseconds>] "
+                    "[<HTML file>...]\n", argv[0]);
+            return false;
+        }
+    }
+
+    *first_file = i;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    struct options opts;
+    int first_file;
+    if (!parse_options(argc, argv, &opts, &first_file))
+        return EXIT_FAILURE;
+
+    int ret = purc_init_ex(PURC_MODULE_HTML, "cn.fmsoft.hvml.bench",
+            "bench_domruler", NULL);
+    if (ret != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize PurC: %d\n", ret);
+        return EXIT_FAILURE;
+    }
+
+    size_t nr_css;
+    char *css = make_style_sheet(NR_RULES, &nr_css);
+
+    bool ok = true;
+    report_begin(&opts);
+    if (first_file >= argc) {
+        static const char *names[] = { "page", "wide", "deep" };
+        char *html[3];
+        size_t len[3];
+
+        html[0] = make_page(360, 8, len + 0);
+        html[1] = make_wide(5000, len + 1);
+        html[2] = make_deep(40, 250, len + 2);
+        for (int i = 0; i < 3; i++) {
+            ok = run_corpus(&opts, names[i], html[i], len[i], css, nr_css)
+                && ok;
+            free(html[i]);
+        }
+    }
+    else {
+        for (int i = first_file; i < argc; i++) {
+            size_t len;
+            char *html = purc_load_file_contents(argv[i], &len);
+            if (html == NULL) {
+                fprintf(stderr, "Failed to read %s\n", argv[i]);
+                ok = false;
+                continue;
+            }
+
+            const char *name = strrchr(argv[i], '/');
+            name = name ? name + 1 : argv[i];
+            ok = run_corpus(&opts, name, html, len, css, nr_css) && ok;
+            free(html);
+        }
+    }
+    report_end(&opts);
+
+    free(css);
+    purc_cleanup();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -35,6 +35,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <math.h>
+#include <vector>
 #include <gtest/gtest.h>
 
 extern purc_variant_t get_variant (char *buf, size_t *length);
@@ -278,3 +279,78 @@ TEST(dvobjs, dvobjs_hvml_setter)
     free(cor);
     purc_cleanup ();
 }
+
+TEST(dvobjs, dvobjs_hvml_mem_quota)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    purc_coroutine_t cor = (pcintr_coroutine_t)calloc(1, sizeof(*cor));
+    ASSERT_NE(cor, nullptr);
+
+    purc_variant_t hvml = purc_dvobj_coroutine_new(cor);
+    ASSERT_NE(hvml, nullptr);
+
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey (hvml,
+            "memHardLimit");
+    ASSERT_NE(dynamic, nullptr);
+    purc_dvariant_method setter = purc_variant_dynamic_get_setter (dynamic);
+    ASSERT_NE(setter, nullptr);
+
+    purc_variant_t limit = purc_variant_make_ulongint(16384);
+    purc_variant_t ret_var = setter(hvml, 1, &limit, 0);
+    ASSERT_NE(ret_var, nullptr);
+    purc_variant_unref(ret_var);
+    purc_variant_unref(limit);
+    ASSERT_EQ(cor->vusage.hard_limit, 16384U);
+
+    // charge the variants to the coroutine until the hard limit is reached
+    pcvariant_set_usage(&cor->vusage);
+
+    char buf[256];
+    memset(buf, 'x', sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+
+    std::vector<purc_variant_t> values;
+    for (int i = 0; i < 1000; i++) {
+        purc_variant_t v = purc_variant_make_string(buf, false);
+        if (v == PURC_VARIANT_INVALID)
+            break;
+        values.push_back(v);
+    }
+
+    ASSERT_LT(values.size(), 1000U);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_OUT_OF_MEMORY);
+    ASSERT_LE(cor->vusage.sz_mem, 16384 + (ssize_t)sizeof(buf));
+
+    dynamic = purc_variant_object_get_by_ckey (hvml, "stats");
+    ASSERT_NE(dynamic, nullptr);
+    purc_dvariant_method getter = purc_variant_dynamic_get_getter (dynamic);
+    ASSERT_NE(getter, nullptr);
+
+    for (size_t i = 0; i < values.size(); i++)
+        purc_variant_unref(values[i]);
+    values.clear();
+
+    // nothing left after releasing the variants allocated by the coroutine
+    ASSERT_EQ(cor->vusage.nr_values, 0);
+    ASSERT_EQ(cor->vusage.sz_mem, 0);
+
+    purc_variant_t stats = getter(hvml, 0, NULL, 0);
+    ASSERT_NE(stats, nullptr);
+    int64_t nr_values = 0;
+    ASSERT_TRUE(purc_variant_cast_to_longint(
+                purc_variant_object_get_by_ckey(stats, "nrValues"),
+                &nr_values, false));
+    // the object of stats and its members are charged to the coroutine
+    ASSERT_GT(nr_values, 0);
+    purc_variant_unref(stats);
+
+    pcvariant_set_usage(NULL);
+
+    purc_variant_unref(hvml);
+    free(cor);
+    purc_cleanup ();
+}
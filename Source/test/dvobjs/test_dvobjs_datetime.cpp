@@ -508,6 +508,21 @@ purc_variant_t fmttime(purc_variant_t dvobj, const char* name)
         t = -3600;
         timezone = ":America/New_York";
     }
+    else if (strcmp(name, "dst-southern-summer") == 0) {
+        timeformat = "%Y-%m-%dT%H:%M:%S%z %Z";
+        t = 1705000000;
+        timezone = ":Australia/Sydney";
+    }
+    else if (strcmp(name, "dst-southern-winter") == 0) {
+        timeformat = "%Y-%m-%dT%H:%M:%S%z %Z";
+        t = 1720000000;
+        timezone = ":Australia/Sydney";
+    }
+    else if (strcmp(name, "dst-far-future") == 0) {
+        timeformat = "%Y-%m-%dT%H:%M:%S%z %Z";
+        t = 4118000000;
+        timezone = ":America/New_York";
+    }
     else {
         timeformat = name;
         t = time(NULL);
@@ -607,6 +622,16 @@ TEST(dvobjs, fmttime)
         { "{UTC}It is %H:%M now in UTC",
             "$DATETIME.fmttime('{UTC}It is %H:%M now in UTC')",
             fmttime, fmttime_vrtcmp, 0 },
+        { "dst-southern-summer",
+            "$DATETIME.fmttime('%Y-%m-%dT%H:%M:%S%z %Z', 1705000000, 'Australia/Sydney')",
+            fmttime, fmttime_vrtcmp, 0 },
+        { "dst-southern-winter",
+            "$DATETIME.fmttime('%Y-%m-%dT%H:%M:%S%z %Z', 1720000000, 'Australia/Sydney')",
+            fmttime, fmttime_vrtcmp, 0 },
+        /* after the last transition in the timezone file */
+        { "dst-far-future",
+            "$DATETIME.fmttime('%Y-%m-%dT%H:%M:%S%z %Z', 4118000000, 'America/New_York')",
+            fmttime, fmttime_vrtcmp, 0 },
     };
 
     int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsfot.hvml.test",
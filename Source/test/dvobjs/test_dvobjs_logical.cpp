@@ -455,3 +455,65 @@ TEST(dvobjs, dvobjs_logical_bc)
     purc_cleanup ();
 #endif
 }
+
+TEST(dvobjs, dvobjs_logical_eval_cached)
+{
+    PurCInstance purc(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test", "dvobjs");
+    ASSERT_TRUE(purc);
+
+    purc_variant_t logical = purc_dvobj_logical_new();
+    ASSERT_NE(logical, nullptr);
+
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey(logical, "eval");
+    ASSERT_NE(dynamic, nullptr);
+    purc_dvariant_method func = purc_variant_dynamic_get_getter(dynamic);
+    ASSERT_NE(func, nullptr);
+
+    /* the same expressions are evaluated with different parameters,
+       so the cached ones must not keep anything of the last evaluation */
+    purc_variant_t param[2];
+    param[0] = purc_variant_make_string("x >= 10 && (y < 5 || !z)", false);
+    purc_variant_t bad = purc_variant_make_string("x >=", false);
+
+    for (int i = 0; i < 100; i++) {
+        int x = i % 20, y = i % 7, z = i % 3;
+
+        param[1] = purc_variant_make_object_0();
+        purc_variant_t v = purc_variant_make_longint(x);
+        purc_variant_object_set_by_ckey(param[1], "x", v);
+        purc_variant_unref(v);
+        v = purc_variant_make_longint(y);
+        purc_variant_object_set_by_ckey(param[1], "y", v);
+        purc_variant_unref(v);
+        v = purc_variant_make_longint(z);
+        purc_variant_object_set_by_ckey(param[1], "z", v);
+        purc_variant_unref(v);
+
+        purc_variant_t ret = func(NULL, 2, param, 0);
+        ASSERT_NE(ret, nullptr);
+        ASSERT_TRUE(purc_variant_is_boolean(ret));
+        EXPECT_EQ(ret->b, x >= 10 && (y < 5 || !z)) << "at " << i;
+        purc_variant_unref(ret);
+
+        /* a bad expression is always false */
+        purc_variant_t args[2] = { bad, param[1] };
+        ret = func(NULL, 2, args, 0);
+        ASSERT_NE(ret, nullptr);
+        EXPECT_FALSE(ret->b);
+        purc_variant_unref(ret);
+
+        purc_variant_unref(param[1]);
+    }
+
+    /* a variable not given makes it false */
+    param[1] = purc_variant_make_object_0();
+    purc_variant_t ret = func(NULL, 2, param, 0);
+    ASSERT_NE(ret, nullptr);
+    EXPECT_FALSE(ret->b);
+    purc_variant_unref(ret);
+    purc_variant_unref(param[1]);
+
+    purc_variant_unref(bad);
+    purc_variant_unref(param[0]);
+    purc_variant_unref(logical);
+}
@@ -43,3 +43,9 @@ TEST(dvobjs, channel)
     tester.run_testcases_in_file("channel");
 }
 
+TEST(dvobjs, channel_shared)
+{
+    TestDVObj tester(true);
+    tester.run_testcases_in_file("channel_shared");
+}
+
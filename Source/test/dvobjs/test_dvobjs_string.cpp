@@ -2033,3 +2033,77 @@ TEST(dvobjs, dvobjs_string_substr)
     purc_cleanup ();
 }
 
+
+static purc_variant_t
+call_string_method(purc_variant_t string, const char *method,
+        size_t nr_args, purc_variant_t *argv)
+{
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey(string, method);
+    purc_dvariant_method func = purc_variant_dynamic_get_getter(dynamic);
+    return func(NULL, nr_args, argv, 0);
+}
+
+TEST(dvobjs, dvobjs_string_large_inputs)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_variant_t string = purc_dvobj_string_new();
+    ASSERT_NE(string, nullptr);
+
+    /* longer than the buffer of the stream used before */
+    std::string source, expected;
+    for (int i = 0; i < 4096; i++) {
+        source += "Abc,";
+        expected += "Abc--";
+    }
+    source += "Xyz";
+    expected += "Xyz";
+
+    purc_variant_t argv[3];
+    argv[0] = purc_variant_make_string(source.c_str(), false);
+    argv[1] = purc_variant_make_string_static(",", false);
+    argv[2] = purc_variant_make_string_static("--", false);
+
+    purc_variant_t result = call_string_method(string, "replace", 3, argv);
+    ASSERT_NE(result, nullptr);
+    ASSERT_STREQ(purc_variant_get_string_const(result), expected.c_str());
+    purc_variant_unref(result);
+
+    result = call_string_method(string, "explode", 2, argv);
+    ASSERT_NE(result, nullptr);
+    size_t sz = 0;
+    ASSERT_TRUE(purc_variant_array_size(result, &sz));
+    ASSERT_EQ(sz, 4097U);
+    ASSERT_STREQ(purc_variant_get_string_const(
+                purc_variant_array_get(result, 4096)), "Xyz");
+    purc_variant_unref(result);
+
+    result = call_string_method(string, "tolower", 1, argv);
+    ASSERT_NE(result, nullptr);
+    const char *lower = purc_variant_get_string_const(result);
+    ASSERT_EQ(strlen(lower), source.length());
+    ASSERT_EQ(strncmp(lower, "abc,abc,", 8), 0);
+    ASSERT_STREQ(lower + source.length() - 3, "xyz");
+    purc_variant_unref(result);
+
+    purc_variant_unref(argv[1]);
+    purc_variant_unref(argv[2]);
+    argv[1] = purc_variant_make_string_static("ABC,XYZ", false);
+    argv[2] = purc_variant_make_boolean(true);
+    result = call_string_method(string, "contains", 3, argv);
+    ASSERT_TRUE(purc_variant_booleanize(result));
+    purc_variant_unref(result);
+
+    result = call_string_method(string, "contains", 2, argv);
+    ASSERT_FALSE(purc_variant_booleanize(result));
+    purc_variant_unref(result);
+
+    for (int i = 0; i < 3; i++)
+        purc_variant_unref(argv[i]);
+
+    purc_variant_unref(string);
+    purc_cleanup();
+}
@@ -0,0 +1,270 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The throughput benchmark of the eJSON parser.
+ *
+ * Usage: bench_ejson [--format=text|json|csv] [--filter=<substring>]
+ *          [--min-time=<milliseconds>] [<JSON file>...]
+ *
+ * Without any file, it parses the built-in corpora generated in the
+ * shapes of the well-known JSON benchmark files:
+ *
+ *  - twitter: objects with many short strings, some of them non-ASCII;
+ *  - citm: objects with integer values keyed by the numeric strings;
+ *  - canada: deeply nested arrays of floating-point numbers.
+ *
+ * Give the real twitter.json, citm_catalog.json, or canada.json files
+ * on the command line to parse them instead.
+ *
+ * The benchmarks:
+ *
+ *  - vcm_mem: pcejson_parse() from a memory stream to a VCM tree;
+ *  - vcm_file: pcejson_parse() from a file stream to a VCM tree;
+ *  - variant: purc_variant_make_from_json_string() from memory.
+ */
+
+#include "purc/purc.h"
+
+#include "private/ejson.h"
+#include "private/vcm.h"
+#include "purc/purc-rwstream.h"
+
+#include "../bench.h"
+
+#include <unistd.h>
+
+#define MAX_DEPTH   64
+
+static std::string make_twitter_like(size_t nr_statuses)
+{
+    static const char *texts[] = {
+        "Just setting up my HVML app",
+        "\\u4eca\\u65e5\\u306f\\u3044\\u3044\\u5929\\u6c17\\u3067\\u3059",
+        "Purring Cat 0.9 is out! https://hvml.fmsoft.cn #HVML",
+        "\xe4\xb8\xad\xe6\x96\x87\xe6\xb5\x8b\xe8\xaf\x95\xef\xbc\x9a"
+            "\xe4\xbd\xa0\xe5\xa5\xbd\xe4\xb8\x96\xe7\x95\x8c",
+    };
+
+    std::string s = "{\"statuses\":[";
+    char buf[512];
+    for (size_t i = 0; i < nr_statuses; i++) {
+        snprintf(buf, sizeof(buf),
+                "%s{\"id\":%llu,\"id_str\":\"%llu\",\"text\":\"%s\","
+                "\"truncated\":false,\"favorited\":%s,"
+                "\"in_reply_to_status_id\":null,"
+                "\"user\":{\"id\":%llu,\"name\":\"user %zu\","
+                "\"screen_name\":\"u%zu\",\"followers_count\":%zu,"
+                "\"verified\":false,\"lang\":\"ja\"},"
+                "\"entities\":{\"hashtags\":[],\"urls\":[],"
+                "\"user_mentions\":[{\"id\":%llu,\"indices\":[0,9]}]},"
+                "\"retweet_count\":%zu,\"lang\":\"zh\"}",
+                i ? "," : "", 505874924095815681ULL + i,
+                505874924095815681ULL + i, texts[i % 4],
+                (i % 3) ? "true" : "false", 1186275104ULL + i, i, i,
+                i * 37 % 5000, 2000000000ULL + i, i % 17);
+        s += buf;
+    }
+    s += "],\"search_metadata\":{\"completed_in\":0.087,\"count\":";
+    s += std::to_string(nr_statuses);
+    s += "}}";
+    return s;
+}
+
+static std::string make_citm_like(size_t nr_events)
+{
+    std::string s = "{\"areaNames\":{";
+    char buf[256];
+    for (size_t i = 0; i < nr_events; i++) {
+        snprintf(buf, sizeof(buf), "%s\"%zu\":\"area %zu\"",
+                i ? "," : "", 205705993 + i, i);
+        s += buf;
+    }
+
+    s += "},\"events\":{";
+    for (size_t i = 0; i < nr_events; i++) {
+        snprintf(buf, sizeof(buf),
+                "%s\"%zu\":{\"description\":null,\"id\":%zu,"
+                "\"logo\":\"/images/UE0AAAAACEKo6QAAAAZDSVRN\","
+                "\"name\":\"event %zu\",\"subTopicIds\":[%zu,%zu,%zu],"
+                "\"topicIds\":[%zu,%zu]}",
+                i ? "," : "", 138586341 + i, 138586341 + i, i,
+                337184269 + i, 337184283 + i, 337184288 + i,
+                324846099 + i, 107888604 + i);
+        s += buf;
+    }
+    s += "}}";
+    return s;
+}
+
+static std::string make_canada_like(size_t nr_rings)
+{
+    std::string s = "{\"type\":\"FeatureCollection\",\"features\":[{"
+        "\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},"
+        "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[";
+    char buf[64];
+    for (size_t i = 0; i < nr_rings; i++) {
+        s += i ? ",[" : "[";
+        for (size_t j = 0; j < 64; j++) {
+            snprintf(buf, sizeof(buf), "%s[%.15g,%.15g]", j ? "," : "",
+                    -65.613616999999977 + i * 0.0001 + j * 1e-7,
+                    43.420273000000009 - j * 0.00003);
+            s += buf;
+        }
+        s += "]";
+    }
+    s += "]}}]}";
+    return s;
+}
+
+static bool parse_vcm_from_mem(const std::string &json)
+{
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)json.c_str(),
+            json.size());
+    struct pcvcm_node *root = NULL;
+    struct pcejson *parser = NULL;
+
+    pcejson_parse(&root, &parser, rws, MAX_DEPTH);
+    bool ok = (root != NULL);
+
+    if (root)
+        pcvcm_node_destroy(root);
+    pcejson_destroy(parser);
+    purc_rwstream_destroy(rws);
+    return ok;
+}
+
+static bool parse_vcm_from_file(const char *file)
+{
+    purc_rwstream_t rws = purc_rwstream_new_from_file(file, "r");
+    if (rws == NULL)
+        return false;
+
+    struct pcvcm_node *root = NULL;
+    struct pcejson *parser = NULL;
+
+    pcejson_parse(&root, &parser, rws, MAX_DEPTH);
+    bool ok = (root != NULL);
+
+    if (root)
+        pcvcm_node_destroy(root);
+    pcejson_destroy(parser);
+    purc_rwstream_destroy(rws);
+    return ok;
+}
+
+static bool parse_variant(const std::string &json)
+{
+    purc_variant_t v = purc_variant_make_from_json_string(json.c_str(),
+            json.size());
+    if (v == PURC_VARIANT_INVALID)
+        return false;
+
+    purc_variant_unref(v);
+    return true;
+}
+
+struct corpus {
+    std::string name;
+    std::string json;
+    std::string file;       // the file containing the JSON
+    bool        temp;       // whether the file is a temporary one
+};
+
+static bool write_temp_file(struct corpus &c)
+{
+    char path[] = "/tmp/bench_ejson-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return false;
+
+    bool ok = (write(fd, c.json.data(), c.json.size()) ==
+            (ssize_t)c.json.size());
+    close(fd);
+
+    c.file = path;
+    c.temp = true;
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    struct bench_options opts;
+    if (!bench_parse_options(argc, argv, &opts))
+        return EXIT_FAILURE;
+
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.bench",
+            "bench_ejson", NULL);
+    if (ret != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize PurC: %d\n", ret);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<struct corpus> corpora;
+    if (opts.files.empty()) {
+        corpora.push_back({ "twitter-like", make_twitter_like(400), "", false });
+        corpora.push_back({ "citm-like", make_citm_like(2000), "", false });
+        corpora.push_back({ "canada-like", make_canada_like(300), "", false });
+    }
+    else {
+        for (size_t i = 0; i < opts.files.size(); i++) {
+            struct corpus c = { opts.files[i], "", opts.files[i], false };
+            if (!bench_read_file(c.file.c_str(), c.json)) {
+                fprintf(stderr, "Failed to read %s\n", c.file.c_str());
+                return EXIT_FAILURE;
+            }
+
+            size_t slash = c.name.rfind('/');
+            if (slash != std::string::npos)
+                c.name = c.name.substr(slash + 1);
+            corpora.push_back(c);
+        }
+    }
+
+    bool ok = true;
+    bench_report_begin(&opts);
+    for (size_t i = 0; i < corpora.size(); i++) {
+        struct corpus &c = corpora[i];
+        const char *name = c.name.c_str();
+
+        ok = bench_run(&opts, "vcm_mem", name, c.json.size(),
+                [&c]() { return parse_vcm_from_mem(c.json); }) && ok;
+
+        if (c.file.empty() && !write_temp_file(c)) {
+            fprintf(stderr, "Failed to write the temporary file\n");
+            ok = false;
+        }
+        else {
+            const char *file = c.file.c_str();
+            ok = bench_run(&opts, "vcm_file", name, c.json.size(),
+                    [file]() { return parse_vcm_from_file(file); }) && ok;
+        }
+
+        ok = bench_run(&opts, "variant", name, c.json.size(),
+                [&c]() { return parse_variant(c.json); }) && ok;
+
+        if (c.temp)
+            unlink(c.file.c_str());
+    }
+    bench_report_end(&opts);
+
+    purc_cleanup();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
@@ -28,6 +28,9 @@
 #include <errno.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <string>
+
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -2236,3 +2239,269 @@ TEST(ejson_token, pcejson_parse_serial_empty_object)
 }
 #endif
 
+
+static purc_variant_t
+parse_by_vcm(const char *json)
+{
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)json,
+            strlen(json));
+    struct pcvcm_node* root = NULL;
+    struct pcejson* parser = NULL;
+    purc_variant_t v = PURC_VARIANT_INVALID;
+
+    if (pcejson_parse(&root, &parser, rws, PCEJSON_DEFAULT_DEPTH) == 0)
+        v = pcvcm_eval(root, NULL, false);
+
+    pcvcm_node_destroy(root);
+    pcejson_destroy(parser);
+    purc_rwstream_destroy(rws);
+    return v;
+}
+
+TEST(ejson, parse_plain)
+{
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+            "ejson", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    static const char *plains[] = {
+        "{}",
+        "[]",
+        " null ",
+        "true",
+        "-0.5e3",
+        "\"a\\tb\\u4e2d\\\"\"",
+        "{\"a\": [1, 2.5, {\"b\": false}], \"c\": \"\xe4\xb8\xad\"}",
+        "[[[]], {\"k\": {}}, \"\", 0]",
+        /* long runs for the block scanners */
+        "[\n                                    \"0123456789abcdef0123\","
+        "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+        "\"0123456789abcdef\xe4\xb8\xad\\n0123456789abcdef\\\\\"]",
+    };
+
+    for (size_t i = 0; i < PCA_TABLESIZE(plains); i++) {
+        purc_variant_t v1;
+        ASSERT_EQ(pcejson_parse_plain(&v1, plains[i], strlen(plains[i]),
+                    PCEJSON_DEFAULT_DEPTH), 0) << plains[i];
+
+        purc_variant_t v2 = parse_by_vcm(plains[i]);
+        ASSERT_NE(v2, PURC_VARIANT_INVALID) << plains[i];
+        ASSERT_TRUE(purc_variant_is_equal_to(v1, v2)) << plains[i];
+
+        purc_variant_unref(v1);
+        purc_variant_unref(v2);
+    }
+
+    /* the texts left to the full parser */
+    static const char *others[] = {
+        "{a: 1}",
+        "\"$x\"",
+        "[1L]",
+        "'single'",
+        "[1, 2,]",
+        "\"\\uD800\"",
+        "[1] x",
+        "[[[[[1]]]]]",
+        "\"0123456789abcdef0123456789abcdef$x\"",
+    };
+
+    for (size_t i = 0; i < PCA_TABLESIZE(others); i++) {
+        purc_variant_t v;
+        ASSERT_EQ(pcejson_parse_plain(&v, others[i], strlen(others[i]), 4),
+                -1) << others[i];
+        ASSERT_EQ(v, PURC_VARIANT_INVALID);
+    }
+
+    purc_cleanup();
+}
+
+struct sax_events {
+    std::string out;
+    bool suspend;
+};
+
+static int sax_start_object(void *ctxt)
+{
+    ((struct sax_events *)ctxt)->out += "{ ";
+    return 0;
+}
+
+static int sax_end_object(void *ctxt)
+{
+    ((struct sax_events *)ctxt)->out += "} ";
+    return 0;
+}
+
+static int sax_start_array(void *ctxt)
+{
+    ((struct sax_events *)ctxt)->out += "[ ";
+    return 0;
+}
+
+static int sax_end_array(void *ctxt)
+{
+    ((struct sax_events *)ctxt)->out += "] ";
+    return 0;
+}
+
+static int sax_key(void *ctxt, const char *key, size_t len)
+{
+    struct sax_events *events = (struct sax_events *)ctxt;
+    events->out += "key:";
+    events->out.append(key, len);
+    events->out += " ";
+    return 0;
+}
+
+static int sax_value(void *ctxt, purc_variant_t value)
+{
+    struct sax_events *events = (struct sax_events *)ctxt;
+    char *buf = NULL;
+    purc_variant_stringify_alloc(&buf, value);
+    events->out += buf;
+    events->out += " ";
+    free(buf);
+    return events->suspend ? 1 : 0;
+}
+
+static const struct pcejson_sax_handlers sax_handlers = {
+    sax_start_object,
+    sax_end_object,
+    sax_start_array,
+    sax_end_array,
+    sax_key,
+    sax_value,
+};
+
+TEST(ejson, sax)
+{
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+            "ejson", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *json = "{\"a\": [1, -2.5, true, null, \"x\\n\\u00e9$\"], "
+        "\"b\": {}, \"c\": \"\\ud83d\\ude00\"}";
+    const char *expected = "{ key:a [ 1 -2.5 true null x\n\xc3\xa9$ ] "
+        "key:b { } key:c \xf0\x9f\x98\x80 } ";
+
+    /* feed the text in pieces of every size */
+    for (size_t sz = 1; sz <= strlen(json); sz++) {
+        struct sax_events events = { "", false };
+        struct pcejson_sax *sax = pcejson_sax_new(&sax_handlers, &events,
+                PCEJSON_DEFAULT_DEPTH, 0);
+        ASSERT_NE(sax, nullptr);
+
+        for (size_t pos = 0; pos < strlen(json); pos += sz) {
+            size_t len = std::min(sz, strlen(json) - pos);
+            ASSERT_EQ(pcejson_sax_feed(sax, json + pos, len), (ssize_t)len);
+        }
+        ASSERT_EQ(pcejson_sax_end(sax), 0);
+        ASSERT_EQ(events.out, expected);
+        pcejson_sax_delete(sax);
+    }
+
+    /* suspend after every value of NDJSON */
+    const char *ndjson = "1\n{\"a\": 2}\n\"x\"\n3";
+    struct sax_events events = { "", true };
+    struct pcejson_sax *sax = pcejson_sax_new(&sax_handlers, &events,
+            PCEJSON_DEFAULT_DEPTH, PCEJSON_SAX_FLAG_MULTIPLE);
+    ASSERT_NE(sax, nullptr);
+
+    size_t pos = 0, len = strlen(ndjson);
+    int nr_feeds = 0;
+    while (pos < len) {
+        ssize_t n = pcejson_sax_feed(sax, ndjson + pos, len - pos);
+        ASSERT_GE(n, 0);
+        pos += n;
+        nr_feeds++;
+    }
+    ASSERT_EQ(pcejson_sax_end(sax), 0);
+    ASSERT_EQ(events.out, "1 { key:a 2 } x 3 ");
+    ASSERT_EQ(nr_feeds, 4);
+    pcejson_sax_delete(sax);
+
+    /* newline-delimited records */
+    static const struct {
+        const char *text;
+        bool good;
+    } lines[] = {
+        { "1\n{\"a\": 2}\r\n\n  [3]  \n\"x\"", true },
+        { "1 2\n", false },
+        { "[1,\n2]\n", false },
+        { "{\"a\":\n1}", false },
+    };
+    for (size_t i = 0; i < PCA_TABLESIZE(lines); i++) {
+        struct sax_events events = { "", false };
+        sax = pcejson_sax_new(&sax_handlers, &events,
+                PCEJSON_DEFAULT_DEPTH, PCEJSON_SAX_FLAG_LINES);
+        ssize_t n = pcejson_sax_feed(sax, lines[i].text,
+                strlen(lines[i].text));
+        bool good = (n == (ssize_t)strlen(lines[i].text) &&
+                pcejson_sax_end(sax) == 0);
+        ASSERT_EQ(good, lines[i].good) << lines[i].text;
+        if (good) {
+            ASSERT_EQ(events.out, "1 { key:a 2 } [ 3 ] x ");
+        }
+        pcejson_sax_delete(sax);
+    }
+
+    /* malformed texts */
+    static const char *bads[] = { "[1, 2", "{\"a\" 1}", "[1,]", "tru",
+        "01", "\"\\ud83dx\"", "[1}" };
+    for (size_t i = 0; i < PCA_TABLESIZE(bads); i++) {
+        struct sax_events events = { "", false };
+        sax = pcejson_sax_new(&sax_handlers, &events,
+                PCEJSON_DEFAULT_DEPTH, 0);
+        ssize_t n = pcejson_sax_feed(sax, bads[i], strlen(bads[i]));
+        ASSERT_TRUE(n < 0 || pcejson_sax_end(sax) < 0) << bads[i];
+        pcejson_sax_delete(sax);
+    }
+
+    purc_cleanup();
+}
+
+TEST(ejson, builder)
+{
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+            "ejson", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *json = "{\"a\": [1, true, null, \"x\"], \"b\": {\"c\": {}}}";
+
+    /* feed the text in pieces of every size */
+    for (size_t sz = 1; sz <= strlen(json); sz++) {
+        struct pcejson_builder *bld =
+            pcejson_builder_new(PCEJSON_DEFAULT_DEPTH);
+        ASSERT_NE(bld, nullptr);
+
+        for (size_t pos = 0; pos < strlen(json); pos += sz) {
+            size_t len = std::min(sz, strlen(json) - pos);
+            ASSERT_EQ(pcejson_builder_feed(bld, json + pos, len), 0);
+        }
+
+        purc_variant_t vt = pcejson_builder_end(bld);
+        ASSERT_NE(vt, PURC_VARIANT_INVALID);
+        pcejson_builder_delete(bld);
+
+        char buf[128];
+        purc_rwstream_t rws = purc_rwstream_new_from_mem(buf, sizeof(buf) - 1);
+        size_t len_expected = 0;
+        ssize_t n = purc_variant_serialize(vt, rws,
+                0, PCVRNT_SERIALIZE_OPT_PLAIN, &len_expected);
+        ASSERT_GT(n, 0);
+        buf[n] = 0;
+        ASSERT_STREQ(buf, "{\"a\":[1,true,null,\"x\"],\"b\":{\"c\":{}}}");
+        purc_rwstream_destroy(rws);
+        purc_variant_unref(vt);
+    }
+
+    /* a malformed text is reported when the builder ends */
+    struct pcejson_builder *bld = pcejson_builder_new(PCEJSON_DEFAULT_DEPTH);
+    ASSERT_NE(bld, nullptr);
+    pcejson_builder_feed(bld, "[1, ", 4);
+    pcejson_builder_feed(bld, "}", 1);
+    ASSERT_EQ(pcejson_builder_end(bld), PURC_VARIANT_INVALID);
+    pcejson_builder_delete(bld);
+
+    purc_cleanup();
+}
@@ -2964,3 +2964,105 @@ TEST(dvobjs, dvobjs_fs_open_dir)
 
     purc_cleanup ();
 }
+
+static size_t walk_all(purc_variant_t walker, const char *prefix)
+{
+    struct purc_native_ops *ops = purc_variant_native_get_ops(walker);
+    void *native = purc_variant_native_get_entity(walker);
+    purc_nvariant_method next = ops->property_getter(native,
+            PURC_NATIVE_PROP_NEXT);
+    if (next == NULL)
+        return 0;
+
+    size_t n = 0;
+    purc_variant_t entry;
+    while ((entry = next(native, PURC_NATIVE_PROP_NEXT, 0, NULL, 0))) {
+        if (purc_variant_is_null(entry)) {
+            purc_variant_unref(entry);
+            break;
+        }
+
+        purc_variant_t path = purc_variant_object_get_by_ckey(entry, "path");
+        const char *str = purc_variant_get_string_const(path);
+        printf("\t%s\n", str);
+        if (prefix == NULL || strncmp(str, prefix, strlen(prefix)) == 0)
+            n++;
+        purc_variant_unref(entry);
+    }
+
+    return n;
+}
+
+TEST(dvobjs, dvobjs_fs_walk)
+{
+    purc_variant_t param[MAX_PARAM_NR];
+    purc_variant_t walker = NULL;
+    size_t sz_total_mem_before = 0;
+    size_t sz_total_values_before = 0;
+    size_t nr_reserved_before = 0;
+    size_t sz_total_mem_after = 0;
+    size_t sz_total_values_after = 0;
+    size_t nr_reserved_after = 0;
+
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    get_variant_total_info (&sz_total_mem_before, &sz_total_values_before,
+            &nr_reserved_before);
+
+    setenv(PURC_ENVV_DVOBJS_PATH, SOPATH, 1);
+    purc_variant_t fs = purc_variant_load_dvobj_from_so (NULL, "FS");
+    ASSERT_NE(fs, nullptr);
+
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey (fs, "walk");
+    ASSERT_NE(dynamic, nullptr);
+    purc_dvariant_method func = purc_variant_dynamic_get_getter (dynamic);
+    ASSERT_NE(func, nullptr);
+
+    char file_path[PATH_MAX + NAME_MAX +1];
+    test_getpath_from_env_or_rel(file_path, sizeof(file_path),
+        "DVOBJS_TEST_PATH", "test_files");
+
+    printf ("TEST walk: nr_args = 0, param = NULL:\n");
+    walker = func (NULL, 0, param, 0);
+    ASSERT_EQ(walker, nullptr);
+
+    printf ("TEST walk: nr_args = 3, param[2] = bad option:\n");
+    param[0] = purc_variant_make_string (file_path, true);
+    param[1] = purc_variant_make_null ();
+    param[2] = purc_variant_make_string ("size bogus", true);
+    walker = func (NULL, 3, param, 0);
+    ASSERT_EQ(walker, nullptr);
+    purc_variant_unref(param[2]);
+
+    printf ("TEST walk: not recursive, param[1] = *.md:\n");
+    purc_variant_unref(param[1]);
+    param[1] = purc_variant_make_string ("*.md", true);
+    walker = func (NULL, 2, param, 0);
+    ASSERT_NE(walker, nullptr);
+    ASSERT_EQ(walk_all(walker, NULL), 0);
+    purc_variant_unref(walker);
+
+    printf ("TEST walk: recursive, param[1] = *.md:\n");
+    param[2] = purc_variant_make_string ("recursive type size", true);
+    walker = func (NULL, 3, param, 0);
+    ASSERT_NE(walker, nullptr);
+    ASSERT_EQ(walk_all(walker, "fs/wildcard"), 3);
+    purc_variant_unref(walker);
+
+    purc_variant_unref(param[0]);
+    purc_variant_unref(param[1]);
+    purc_variant_unref(param[2]);
+
+    purc_variant_unload_dvobj (fs);
+
+    get_variant_total_info (&sz_total_mem_after,
+            &sz_total_values_after, &nr_reserved_after);
+    ASSERT_EQ(sz_total_values_before, sz_total_values_after);
+    ASSERT_EQ(sz_total_mem_after, sz_total_mem_before + (nr_reserved_after -
+                nr_reserved_before) * sizeof(purc_variant));
+
+    purc_cleanup ();
+}
@@ -903,6 +903,358 @@ TEST(dvobjs, dvobjs_math_assignment)
     purc_cleanup ();
 }
 
+static purc_variant_t call_compiled(purc_variant_t compiled,
+        const char *property, size_t nr_args, purc_variant_t *argv)
+{
+    struct purc_native_ops *ops = purc_variant_native_get_ops(compiled);
+    void *entity = purc_variant_native_get_entity(compiled);
+    purc_nvariant_method method = ops->property_getter(entity, property);
+    if (method == NULL)
+        return PURC_VARIANT_INVALID;
+    return method(entity, property, nr_args, argv, 0);
+}
+
+TEST(dvobjs, dvobjs_math_compile)
+{
+    purc_variant_t param[MAX_PARAM_NR];
+    purc_variant_t ret_var = NULL;
+    double number;
+    long double numberl;
+    size_t sz_total_mem_before = 0;
+    size_t sz_total_values_before = 0;
+    size_t nr_reserved_before = 0;
+    size_t sz_total_mem_after = 0;
+    size_t sz_total_values_after = 0;
+    size_t nr_reserved_after = 0;
+
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    get_variant_total_info (&sz_total_mem_before, &sz_total_values_before,
+            &nr_reserved_before);
+
+    setenv(PURC_ENVV_DVOBJS_PATH, SOPATH, 1);
+    purc_variant_t math = purc_variant_load_dvobj_from_so (NULL, "MATH");
+    ASSERT_NE(math, nullptr);
+
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey (math, "compile");
+    ASSERT_NE(dynamic, nullptr);
+    purc_dvariant_method func = purc_variant_dynamic_get_getter (dynamic);
+    ASSERT_NE(func, nullptr);
+
+    param[0] = purc_variant_make_string ("x * x + y * 2 - PI", false);
+    purc_variant_t compiled = func (NULL, 1, param, false);
+    purc_variant_unref(param[0]);
+    ASSERT_NE(compiled, nullptr);
+    ASSERT_EQ(purc_variant_is_native (compiled), true);
+
+    /* the variables in the order of the positions */
+    ret_var = call_compiled(compiled, "vars", 0, NULL);
+    ASSERT_NE(ret_var, nullptr);
+    size_t sz = 0;
+    purc_variant_array_size(ret_var, &sz);
+    ASSERT_EQ(sz, 3U);
+    ASSERT_STREQ(purc_variant_get_string_const(
+                purc_variant_array_get(ret_var, 0)), "x");
+    ASSERT_STREQ(purc_variant_get_string_const(
+                purc_variant_array_get(ret_var, 1)), "y");
+    ASSERT_STREQ(purc_variant_get_string_const(
+                purc_variant_array_get(ret_var, 2)), "PI");
+    purc_variant_unref(ret_var);
+
+    /* bind by name; PI falls back to the constant */
+    param[0] = purc_variant_make_object (0, PURC_VARIANT_INVALID,
+                PURC_VARIANT_INVALID);
+    for (int i = 0; i < 3; i++) {
+        purc_variant_t x = purc_variant_make_number(i);
+        purc_variant_t y = purc_variant_make_number(1.5);
+        purc_variant_object_set_by_static_ckey (param[0], "x", x);
+        purc_variant_object_set_by_static_ckey (param[0], "y", y);
+        purc_variant_unref(x);
+        purc_variant_unref(y);
+
+        ret_var = call_compiled(compiled, NULL, 1, param);
+        ASSERT_NE(ret_var, nullptr);
+        purc_variant_cast_to_number (ret_var, &number, false);
+        ASSERT_DOUBLE_EQ(number, i * i + 3 - M_PI);
+        purc_variant_unref(ret_var);
+    }
+    purc_variant_unref(param[0]);
+
+    /* bind by position */
+    param[0] = purc_variant_make_array_0 ();
+    purc_variant_t v = purc_variant_make_number(2);
+    purc_variant_array_append(param[0], v);
+    purc_variant_array_append(param[0], v);
+    purc_variant_array_append(param[0], v);
+    purc_variant_unref(v);
+    ret_var = call_compiled(compiled, "eval", 1, param);
+    ASSERT_NE(ret_var, nullptr);
+    purc_variant_cast_to_number (ret_var, &number, false);
+    ASSERT_DOUBLE_EQ(number, 6.0);
+    purc_variant_unref(ret_var);
+    purc_variant_unref(param[0]);
+
+    /* a variable without value */
+    ret_var = call_compiled(compiled, NULL, 0, NULL);
+    ASSERT_EQ(ret_var, nullptr);
+    purc_variant_unref(compiled);
+
+    /* a bad expression can not be compiled */
+    param[0] = purc_variant_make_string ("(3 + ", false);
+    ASSERT_EQ(func (NULL, 1, param, false), nullptr);
+    purc_variant_unref(param[0]);
+
+    dynamic = purc_variant_object_get_by_ckey (math, "compile_l");
+    ASSERT_NE(dynamic, nullptr);
+    func = purc_variant_dynamic_get_getter (dynamic);
+    ASSERT_NE(func, nullptr);
+
+    param[0] = purc_variant_make_string ("(3 + 7) / r", false);
+    compiled = func (NULL, 1, param, false);
+    purc_variant_unref(param[0]);
+    ASSERT_NE(compiled, nullptr);
+
+    param[0] = purc_variant_make_array_0 ();
+    v = purc_variant_make_longdouble(4.0L);
+    purc_variant_array_append(param[0], v);
+    purc_variant_unref(v);
+    ret_var = call_compiled(compiled, NULL, 1, param);
+    ASSERT_NE(ret_var, nullptr);
+    ASSERT_EQ(purc_variant_is_type (ret_var, PURC_VARIANT_TYPE_LONGDOUBLE),
+            true);
+    purc_variant_cast_to_longdouble (ret_var, &numberl, false);
+    ASSERT_EQ(numberl, 2.5L);
+    purc_variant_unref(ret_var);
+    purc_variant_unref(param[0]);
+    purc_variant_unref(compiled);
+
+    purc_variant_unload_dvobj (math);
+
+    get_variant_total_info (&sz_total_mem_after,
+            &sz_total_values_after, &nr_reserved_after);
+    ASSERT_EQ(sz_total_values_before, sz_total_values_after);
+    ASSERT_EQ(sz_total_mem_after, sz_total_mem_before + (nr_reserved_after -
+                nr_reserved_before) * sizeof(purc_variant));
+
+    purc_cleanup ();
+}
+
+static purc_variant_t call_math(purc_variant_t math, const char *method,
+        size_t nr_args, purc_variant_t *argv)
+{
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey (math, method);
+    if (dynamic == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+    purc_dvariant_method func = purc_variant_dynamic_get_getter (dynamic);
+    return func (NULL, nr_args, argv, false);
+}
+
+TEST(dvobjs, dvobjs_math_vector)
+{
+    purc_variant_t param[MAX_PARAM_NR];
+    purc_variant_t ret_var = NULL;
+    double number;
+    size_t sz_total_mem_before = 0;
+    size_t sz_total_values_before = 0;
+    size_t nr_reserved_before = 0;
+    size_t sz_total_mem_after = 0;
+    size_t sz_total_values_after = 0;
+    size_t nr_reserved_after = 0;
+
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    get_variant_total_info (&sz_total_mem_before, &sz_total_values_before,
+            &nr_reserved_before);
+
+    setenv(PURC_ENVV_DVOBJS_PATH, SOPATH, 1);
+    purc_variant_t math = purc_variant_load_dvobj_from_so (NULL, "MATH");
+    ASSERT_NE(math, nullptr);
+
+    const double elems[] = { 1, 4, 9, 16, 25, 36, 49 };
+    const size_t nr = PCA_TABLESIZE(elems);
+    purc_variant_t packed = purc_variant_make_packed_array (
+            PCVRNT_PACKED_NUMBER, elems, nr);
+    ASSERT_NE(packed, nullptr);
+
+    /* an ordinary array made of the same numbers in mixed types */
+    purc_variant_t array = purc_variant_make_array_0 ();
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = (i % 2) ?
+            purc_variant_make_longint ((int64_t)elems[i]) :
+            purc_variant_make_number (elems[i]);
+        purc_variant_array_append (array, v);
+        purc_variant_unref (v);
+    }
+
+    /* element-wise over a packed array and an ordinary one */
+    param[0] = packed;
+    ret_var = call_math (math, "sqrt", 1, param);
+    ASSERT_NE(ret_var, nullptr);
+    ASSERT_EQ((size_t)purc_variant_array_get_size (ret_var), nr);
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_cast_to_number (purc_variant_array_get (ret_var, i),
+                &number, false);
+        ASSERT_DOUBLE_EQ(number, i + 1.0);
+    }
+    purc_variant_unref (ret_var);
+
+    /* vector and vector, vector and number */
+    param[0] = packed;
+    param[1] = array;
+    ret_var = call_math (math, "sub", 2, param);
+    ASSERT_NE(ret_var, nullptr);
+    ASSERT_EQ((size_t)purc_variant_array_get_size (ret_var), nr);
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_cast_to_number (purc_variant_array_get (ret_var, i),
+                &number, false);
+        ASSERT_DOUBLE_EQ(number, 0.0);
+    }
+    purc_variant_unref (ret_var);
+
+    param[0] = purc_variant_make_number (2.0);
+    param[1] = array;
+    ret_var = call_math (math, "mul", 2, param);
+    purc_variant_unref (param[0]);
+    ASSERT_NE(ret_var, nullptr);
+    purc_variant_cast_to_number (purc_variant_array_get (ret_var, 3),
+            &number, false);
+    ASSERT_DOUBLE_EQ(number, 32.0);
+    purc_variant_unref (ret_var);
+
+    /* reductions */
+    param[0] = array;
+    ret_var = call_math (math, "sum", 1, param);
+    ASSERT_NE(ret_var, nullptr);
+    purc_variant_cast_to_number (ret_var, &number, false);
+    ASSERT_DOUBLE_EQ(number, 140.0);
+    purc_variant_unref (ret_var);
+
+    ret_var = call_math (math, "mean", 1, param);
+    ASSERT_NE(ret_var, nullptr);
+    purc_variant_cast_to_number (ret_var, &number, false);
+    ASSERT_DOUBLE_EQ(number, 20.0);
+    purc_variant_unref (ret_var);
+
+    ret_var = call_math (math, "min", 1, param);
+    ASSERT_NE(ret_var, nullptr);
+    purc_variant_cast_to_number (ret_var, &number, false);
+    ASSERT_DOUBLE_EQ(number, 1.0);
+    purc_variant_unref (ret_var);
+
+    ret_var = call_math (math, "max", 1, param);
+    ASSERT_NE(ret_var, nullptr);
+    purc_variant_cast_to_number (ret_var, &number, false);
+    ASSERT_DOUBLE_EQ(number, 49.0);
+    purc_variant_unref (ret_var);
+
+    param[0] = packed;
+    param[1] = array;
+    ret_var = call_math (math, "dot", 2, param);
+    ASSERT_NE(ret_var, nullptr);
+    purc_variant_cast_to_number (ret_var, &number, false);
+    ASSERT_DOUBLE_EQ(number, 4676.0);
+    purc_variant_unref (ret_var);
+
+    /* the lengths do not match */
+    purc_variant_t shorter = purc_variant_make_packed_array (
+            PCVRNT_PACKED_NUMBER, elems, nr - 1);
+    param[0] = packed;
+    param[1] = shorter;
+    ASSERT_EQ(call_math (math, "add", 2, param), nullptr);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_INVALID_VALUE);
+    ASSERT_EQ(call_math (math, "dot", 2, param), nullptr);
+    purc_variant_unref (shorter);
+
+    /* not a number in the array */
+    purc_variant_t str = purc_variant_make_string ("foo", false);
+    purc_variant_array_append (array, str);
+    purc_variant_unref (str);
+    param[0] = array;
+    ASSERT_EQ(call_math (math, "sin", 1, param), nullptr);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_WRONG_DATA_TYPE);
+
+    /* sqrt of a negative number */
+    const double negative[] = { 4, -1 };
+    param[0] = purc_variant_make_packed_array (PCVRNT_PACKED_NUMBER,
+            negative, 2);
+    ASSERT_EQ(call_math (math, "sqrt", 1, param), nullptr);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_INVALID_FLOAT);
+    purc_variant_unref (param[0]);
+
+    purc_variant_unref (array);
+    purc_variant_unref (packed);
+    purc_variant_unload_dvobj (math);
+
+    get_variant_total_info (&sz_total_mem_after,
+            &sz_total_values_after, &nr_reserved_after);
+    ASSERT_EQ(sz_total_values_before, sz_total_values_after);
+    ASSERT_EQ(sz_total_mem_after, sz_total_mem_before + (nr_reserved_after -
+                nr_reserved_before) * sizeof(purc_variant));
+
+    purc_cleanup ();
+}
+
+static uint64_t get_dlhandle(purc_variant_t dvobj)
+{
+    uint64_t u64 = 0;
+    purc_variant_t val = purc_variant_object_get_by_ckey(dvobj,
+            EXOBJ_LOAD_HANDLE_KEY);
+    if (val)
+        purc_variant_cast_to_ulongint(val, &u64, false);
+    return u64;
+}
+
+TEST(dvobjs, dvobjs_math_cached_library)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    setenv(PURC_ENVV_DVOBJS_PATH, SOPATH, 1);
+    purc_variant_t math1 = purc_variant_load_dvobj_from_so (NULL, "MATH");
+    ASSERT_NE(math1, nullptr);
+    purc_variant_t math2 = purc_variant_load_dvobj_from_so ("MATH", "MATH");
+    ASSERT_NE(math2, nullptr);
+
+    /* the objects are different, but the library is opened only once */
+    ASSERT_NE(math1, math2);
+    uint64_t handle = get_dlhandle(math1);
+    ASSERT_NE(handle, 0U);
+    ASSERT_EQ(get_dlhandle(math2), handle);
+
+    ASSERT_TRUE(purc_variant_unload_dvobj (math1));
+    ASSERT_TRUE(purc_variant_unload_dvobj (math2));
+
+    ASSERT_EQ(purc_variant_load_dvobj_from_so ("NOT-EXISTED", "FOO"),
+            nullptr);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_BAD_SYSTEM_CALL);
+
+    purc_cleanup ();
+
+    /* the library is kept open for the next instance */
+    ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    purc_variant_t math = purc_variant_load_dvobj_from_so (NULL, "MATH");
+    ASSERT_NE(math, nullptr);
+    ASSERT_EQ(get_dlhandle(math), handle);
+
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey (math, "pi");
+    ASSERT_NE(dynamic, nullptr);
+    ASSERT_EQ(purc_variant_is_dynamic (dynamic), true);
+
+    ASSERT_TRUE(purc_variant_unload_dvobj (math));
+    purc_cleanup ();
+}
+
 struct test_sample {
     const char      *expr;
     const char      *result;
@@ -0,0 +1,193 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The throughput benchmark of the HVML parser.
+ *
+ * Usage: bench_hvml [--format=text|json|csv] [--filter=<substring>]
+ *          [--min-time=<milliseconds>] [<HVML file>...]
+ *
+ * Without any file, it parses two reference corpora: all HVML programs
+ * in Source/Samples/hvml/ (samples), and all HVML programs in
+ * Source/test/interpreter/comp/ (comp). Each corpus is parsed as a whole
+ * in one iteration. The files given on the command line form a third
+ * corpus (cmdline) instead.
+ *
+ * The benchmarks:
+ *
+ *  - tokenizer: pchvml_next_token() from a memory stream until EOF;
+ *  - vdom_mem: purc_load_hvml_from_string() to a vDOM tree;
+ *  - vdom_file: purc_load_hvml_from_file() to a vDOM tree.
+ */
+
+#include "purc/purc.h"
+
+#include "private/hvml.h"
+#include "private/vdom.h"
+#include "purc/purc-rwstream.h"
+#include "hvml/hvml-token.h"
+
+#include "../bench.h"
+
+#include <limits.h>
+#include <libgen.h>
+
+struct corpus {
+    std::string name;
+    std::vector<std::string> files;
+    std::vector<std::string> contents;
+    size_t nr_bytes;
+};
+
+static bool load_corpus(struct corpus &c)
+{
+    c.nr_bytes = 0;
+    for (size_t i = 0; i < c.files.size(); i++) {
+        std::string contents;
+        if (!bench_read_file(c.files[i].c_str(), contents)) {
+            fprintf(stderr, "Failed to read %s\n", c.files[i].c_str());
+            return false;
+        }
+
+        c.nr_bytes += contents.size();
+        c.contents.push_back(contents);
+    }
+
+    return !c.files.empty();
+}
+
+static bool tokenize(const std::string &hvml)
+{
+    struct pchvml_parser *parser = pchvml_create(0, 32);
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)hvml.c_str(),
+            hvml.size());
+
+    bool ok = false;
+    struct pchvml_token *token;
+    while ((token = pchvml_next_token(parser, rws)) != NULL) {
+        enum pchvml_token_type type = pchvml_token_get_type(token);
+        pchvml_token_destroy(token);
+        if (type == PCHVML_TOKEN_EOF) {
+            ok = true;
+            break;
+        }
+    }
+
+    purc_rwstream_destroy(rws);
+    pchvml_destroy(parser);
+    return ok;
+}
+
+static bool load_vdom_from_mem(const std::string &hvml)
+{
+    purc_vdom_t vdom = purc_load_hvml_from_string(hvml.c_str());
+    if (vdom == NULL)
+        return false;
+
+    pcvdom_document_unref(vdom);
+    return true;
+}
+
+static bool load_vdom_from_file(const std::string &file)
+{
+    purc_vdom_t vdom = purc_load_hvml_from_file(file.c_str());
+    if (vdom == NULL)
+        return false;
+
+    pcvdom_document_unref(vdom);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    struct bench_options opts;
+    if (!bench_parse_options(argc, argv, &opts))
+        return EXIT_FAILURE;
+
+    int ret = purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hvml.bench",
+            "bench_hvml", NULL);
+    if (ret != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize PurC: %d\n", ret);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<struct corpus> corpora;
+    if (opts.files.empty()) {
+        char tmp[PATH_MAX + 1];
+        snprintf(tmp, sizeof(tmp), "%s", __FILE__);
+        std::string folder = dirname(tmp);
+
+        struct corpus samples = { "samples", {}, {}, 0 };
+        bench_glob_files((folder + "/../../Samples/hvml/*.hvml").c_str(),
+                samples.files);
+        corpora.push_back(samples);
+
+        struct corpus comp = { "comp", {}, {}, 0 };
+        bench_glob_files((folder + "/../interpreter/comp/*.hvml").c_str(),
+                comp.files);
+        corpora.push_back(comp);
+    }
+    else {
+        corpora.push_back({ "cmdline", opts.files, {}, 0 });
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < corpora.size(); i++) {
+        if (!load_corpus(corpora[i])) {
+            fprintf(stderr, "No HVML file in corpus %s\n",
+                    corpora[i].name.c_str());
+            ok = false;
+        }
+    }
+
+    bench_report_begin(&opts);
+    for (size_t i = 0; ok && i < corpora.size(); i++) {
+        struct corpus &c = corpora[i];
+        const char *name = c.name.c_str();
+
+        ok = bench_run(&opts, "tokenizer", name, c.nr_bytes,
+                [&c]() {
+                    bool all = true;
+                    for (size_t j = 0; j < c.contents.size(); j++)
+                        all = tokenize(c.contents[j]) && all;
+                    return all;
+                }) && ok;
+
+        ok = bench_run(&opts, "vdom_mem", name, c.nr_bytes,
+                [&c]() {
+                    bool all = true;
+                    for (size_t j = 0; j < c.contents.size(); j++)
+                        all = load_vdom_from_mem(c.contents[j]) && all;
+                    return all;
+                }) && ok;
+
+        ok = bench_run(&opts, "vdom_file", name, c.nr_bytes,
+                [&c]() {
+                    bool all = true;
+                    for (size_t j = 0; j < c.files.size(); j++)
+                        all = load_vdom_from_file(c.files[j]) && all;
+                    return all;
+                }) && ok;
+    }
+    bench_report_end(&opts);
+
+    purc_cleanup();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
@@ -0,0 +1,804 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The round-trip benchmark of the PCRDR protocol.
+ *
+ * Usage: bench_pcrdr [--format=text|json|csv] [--filter=<substring>]
+ *          [--min-time=<milliseconds>]
+ *
+ * It measures pcrdr_send_request_and_wait_response() with `append`
+ * requests to the DOM carrying HTML fragments of 64B, 1KiB, 4KiB, and
+ * 32KiB (the in-memory payload of a socket packet is limited to
+ * PCRDR_MAX_INMEM_PAYLOAD_SIZE), over the transports:
+ *
+ *  - thread: a renderer thread reached by the move buffer;
+ *  - unix, unix_bin: a Unix socket, in the text and the binary framing;
+ *  - ws, ws_bin: a WebSocket on the loopback, in the text and the binary
+ *    framing.
+ *
+ * The renderers are the built-in echo servers running in their own
+ * threads: they parse every request and answer it with a void response
+ * of 200, so the figures cover the serialization and the transport only.
+ *
+ * The report: the round trips per second, the payload throughput, and
+ * the 50th and 99th percentiles of the round-trip latency in microseconds.
+ */
+
+#include "purc/purc.h"
+#include "purc/purc-pcrdr.h"
+#include "purc/purc-utils.h"
+#include "purc/purc-rwstream.h"
+
+#include "pcrdr/connect.h"
+
+#include "../bench.h"
+
+#include <errno.h>
+#include <endian.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <algorithm>
+
+#define BENCH_APP_NAME          "cn.fmsoft.hvml.bench"
+#define BENCH_RUN_NAME          "bench_pcrdr"
+#define RENDERER_RUN_NAME       "echoRenderer"
+
+#define WS_MAGIC_STR            "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+/* the frame header of the Unix socket; keep consistent with pcrdr/socket.c */
+struct us_frame_header {
+    int op;
+    unsigned int fragmented;
+    unsigned int sz_payload;
+};
+
+enum {
+    OPCODE_CONTINUATION = 0x00,
+    OPCODE_TEXT = 0x01,
+    OPCODE_BIN = 0x02,
+    OPCODE_END = 0x03,
+    OPCODE_CLOSE = 0x08,
+    OPCODE_PING = 0x09,
+    OPCODE_PONG = 0x0A,
+};
+
+enum transport {
+    TRANSPORT_THREAD,
+    TRANSPORT_UNIX,
+    TRANSPORT_WEBSOCKET,
+};
+
+struct renderer {
+    enum transport      transport;
+    int                 listener;
+    std::string         uri;
+    std::string         endpoint;   /* for the thread renderer */
+    std::atomic<bool>   ready;
+    pthread_t           th;
+};
+
+static bool read_fully(int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+static bool write_fully(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+/* reads a packet; returns false on error or when the peer closed */
+static bool us_read_packet(int fd, std::string &packet, bool *binary)
+{
+    struct us_frame_header header;
+
+    while (true) {
+        if (!read_fully(fd, &header, sizeof(header)))
+            return false;
+
+        if (header.op == OPCODE_PING) {
+            header.op = OPCODE_PONG;
+            header.sz_payload = 0;
+            if (!write_fully(fd, &header, sizeof(header)))
+                return false;
+        }
+        else if (header.op == OPCODE_TEXT || header.op == OPCODE_BIN) {
+            break;
+        }
+        else if (header.op != OPCODE_PONG) {
+            return false;
+        }
+    }
+
+    *binary = (header.op == OPCODE_BIN);
+    size_t total = header.fragmented > header.sz_payload ?
+        header.fragmented : header.sz_payload;
+    packet.resize(total);
+
+    size_t offset = header.sz_payload;
+    if (!read_fully(fd, &packet[0], header.sz_payload))
+        return false;
+
+    while (offset < total) {
+        if (!read_fully(fd, &header, sizeof(header)) ||
+                (header.op != OPCODE_CONTINUATION &&
+                 header.op != OPCODE_END) ||
+                header.sz_payload > total - offset ||
+                !read_fully(fd, &packet[offset], header.sz_payload))
+            return false;
+
+        offset += header.sz_payload;
+        if (header.op == OPCODE_END)
+            break;
+    }
+
+    packet.resize(offset);
+    return true;
+}
+
+static bool us_send_packet(int fd, const void *data, size_t len, bool binary)
+{
+    struct us_frame_header header;
+    header.op = binary ? OPCODE_BIN : OPCODE_TEXT;
+    header.fragmented = 0;
+    header.sz_payload = len;
+
+    return write_fully(fd, &header, sizeof(header)) &&
+        write_fully(fd, data, len);
+}
+
+/* sends an unmasked frame as a server does */
+static bool ws_send_frame(int fd, int opcode, const void *data, size_t len)
+{
+    unsigned char head[2 + 8];
+    size_t nr_head;
+
+    head[0] = 0x80 | opcode;
+    if (len > 0xffff) {
+        uint64_t v = htobe64(len);
+        head[1] = 127;
+        memcpy(head + 2, &v, 8);
+        nr_head = 2 + 8;
+    }
+    else if (len > 125) {
+        uint16_t v = htobe16(len);
+        head[1] = 126;
+        memcpy(head + 2, &v, 2);
+        nr_head = 2 + 2;
+    }
+    else {
+        head[1] = (unsigned char)len;
+        nr_head = 2;
+    }
+
+    return write_fully(fd, head, nr_head) &&
+        (len == 0 || write_fully(fd, data, len));
+}
+
+static bool ws_read_frame(int fd, int *opcode, bool *fin, std::string &payload)
+{
+    unsigned char head[2];
+    if (!read_fully(fd, head, 2))
+        return false;
+
+    *fin = (head[0] & 0x80) != 0;
+    *opcode = head[0] & 0x0F;
+
+    uint64_t len = head[1] & 0x7F;
+    if (len == 127) {
+        uint64_t v;
+        if (!read_fully(fd, &v, 8))
+            return false;
+        len = be64toh(v);
+    }
+    else if (len == 126) {
+        uint16_t v;
+        if (!read_fully(fd, &v, 2))
+            return false;
+        len = be16toh(v);
+    }
+
+    unsigned char mask[4] = { 0, 0, 0, 0 };
+    if ((head[1] & 0x80) && !read_fully(fd, mask, 4))
+        return false;
+
+    size_t offset = payload.size();
+    payload.resize(offset + len);
+    if (len > 0 && !read_fully(fd, &payload[offset], len))
+        return false;
+
+    for (uint64_t i = 0; i < len; i++)
+        payload[offset + i] ^= mask[i % 4];
+    return true;
+}
+
+static bool ws_read_packet(int fd, std::string &packet, bool *binary)
+{
+    int opcode;
+    bool fin;
+
+    while (true) {
+        packet.clear();
+        if (!ws_read_frame(fd, &opcode, &fin, packet))
+            return false;
+
+        if (opcode == OPCODE_PING) {
+            if (!ws_send_frame(fd, OPCODE_PONG, NULL, 0))
+                return false;
+        }
+        else if (opcode == OPCODE_TEXT || opcode == OPCODE_BIN) {
+            break;
+        }
+        else if (opcode != OPCODE_PONG) {
+            return false;
+        }
+    }
+
+    *binary = (opcode == OPCODE_BIN);
+    while (!fin) {
+        if (!ws_read_frame(fd, &opcode, &fin, packet) ||
+                opcode != OPCODE_CONTINUATION)
+            return false;
+    }
+
+    return true;
+}
+
+static bool ws_accept_handshake(int fd)
+{
+    std::string request;
+    char c;
+    while (request.size() < 4 ||
+            request.compare(request.size() - 4, 4, "\r\n\r\n") != 0) {
+        if (!read_fully(fd, &c, 1) || request.size() > 8192)
+            return false;
+        request += c;
+    }
+
+    static const char key_field[] = "Sec-WebSocket-Key: ";
+    size_t pos = request.find(key_field);
+    if (pos == std::string::npos)
+        return false;
+    pos += sizeof(key_field) - 1;
+    std::string key = request.substr(pos, request.find("\r\n", pos) - pos);
+    key += WS_MAGIC_STR;
+
+    pcutils_sha1_ctxt ctxt;
+    unsigned char digest[PCUTILS_SHA1_DIGEST_SIZE];
+    pcutils_sha1_begin(&ctxt);
+    pcutils_sha1_hash(&ctxt, key.c_str(), key.size());
+    pcutils_sha1_end(&ctxt, digest);
+
+    char *accept = pcutils_b64_encode_alloc(digest, sizeof(digest));
+    if (accept == NULL)
+        return false;
+
+    std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: ";
+    response += accept;
+    response += "\r\n\r\n";
+    free(accept);
+
+    return write_fully(fd, response.c_str(), response.size());
+}
+
+static bool send_message(int fd, enum transport transport,
+        const pcrdr_msg *msg, bool binary)
+{
+    purc_rwstream_t buffer = purc_rwstream_new_buffer(
+            PCRDR_MIN_PACKET_BUFF_SIZE, PCRDR_MAX_INMEM_PAYLOAD_SIZE);
+    if (buffer == NULL)
+        return false;
+
+    int ret;
+    if (binary)
+        ret = pcrdr_serialize_message_binary(msg,
+                (pcrdr_cb_write)purc_rwstream_write, buffer);
+    else
+        ret = pcrdr_serialize_message(msg,
+                (pcrdr_cb_write)purc_rwstream_write, buffer);
+
+    bool ok = false;
+    if (ret == 0) {
+        size_t len;
+        const char *packet = (const char *)purc_rwstream_get_mem_buffer(
+                buffer, &len);
+        if (transport == TRANSPORT_UNIX)
+            ok = us_send_packet(fd, packet, len, binary);
+        else
+            ok = ws_send_frame(fd, binary ? OPCODE_BIN : OPCODE_TEXT,
+                    packet, len);
+    }
+
+    purc_rwstream_destroy(buffer);
+    return ok;
+}
+
+/* the response to a request; NULL if the request wants no response */
+static pcrdr_msg *make_response(const pcrdr_msg *request)
+{
+    const char *request_id = purc_variant_get_string_const(request->requestId);
+    const char *op = purc_variant_get_string_const(request->operation);
+
+    if (request_id == NULL || strcmp(request_id, PCRDR_REQUESTID_NORETURN)
+            == 0 || (op && strcmp(op, PCRDR_OPERATION_ENDSESSION) == 0))
+        return NULL;
+
+    return pcrdr_make_response_message(request_id, NULL, PCRDR_SC_OK, 0,
+            PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+}
+
+static void serve_socket(struct renderer *rdr, int fd)
+{
+    if (rdr->transport == TRANSPORT_WEBSOCKET && !ws_accept_handshake(fd))
+        return;
+
+    pcrdr_msg *msg = pcrdr_make_response_message(PCRDR_REQUESTID_INITIAL,
+            NULL, PCRDR_SC_OK, 0, PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+    bool ok = send_message(fd, rdr->transport, msg, false);
+    pcrdr_release_message(msg);
+
+    std::string packet;
+    while (ok) {
+        bool binary;
+        if (rdr->transport == TRANSPORT_UNIX)
+            ok = us_read_packet(fd, packet, &binary);
+        else
+            ok = ws_read_packet(fd, packet, &binary);
+        if (!ok)
+            break;
+
+        msg = NULL;
+        if (binary) {
+            pcrdr_parse_binary_packet(packet.data(), packet.size(), &msg);
+        }
+        else {
+            /* the parser needs a null-terminated packet */
+            packet.push_back('\0');
+            pcrdr_parse_packet(&packet[0], packet.size() - 1, &msg);
+        }
+
+        if (msg == NULL)
+            break;
+
+        if (msg->type == PCRDR_MSG_TYPE_REQUEST) {
+            pcrdr_msg *response = make_response(msg);
+            if (response) {
+                ok = send_message(fd, rdr->transport, response, binary);
+                pcrdr_release_message(response);
+            }
+        }
+        pcrdr_release_message(msg);
+    }
+}
+
+static void serve_thread(void)
+{
+    purc_atom_t requester = 0;
+
+    while (true) {
+        size_t n;
+        if (purc_inst_holding_messages_count(&n))
+            break;
+
+        if (n == 0) {
+            usleep(100);
+            continue;
+        }
+
+        pcrdr_msg *msg = purc_inst_take_away_message(0);
+        if (msg == NULL)
+            break;
+        if (msg->type != PCRDR_MSG_TYPE_REQUEST) {
+            pcrdr_release_message(msg);
+            continue;
+        }
+
+        const char *op = purc_variant_get_string_const(msg->operation);
+        bool bye = (strcmp(op, PCRDR_THREAD_OPERATION_BYE) == 0);
+        if (strcmp(op, PCRDR_THREAD_OPERATION_HELLO) == 0 || bye) {
+            /* the requests from the client carry no source URI but these */
+            requester = purc_atom_try_string_ex(PURC_ATOM_BUCKET_DEF,
+                    purc_variant_get_string_const(msg->sourceURI));
+        }
+
+        pcrdr_msg *response = bye ?
+            pcrdr_make_response_message(PCRDR_REQUESTID_NORETURN, NULL,
+                PCRDR_SC_OK, 0, PCRDR_MSG_DATA_TYPE_VOID, NULL, 0) :
+            make_response(msg);
+        if (response) {
+            if (requester)
+                purc_inst_move_message(requester, response);
+            pcrdr_release_message(response);
+        }
+        pcrdr_release_message(msg);
+
+        if (bye)
+            break;
+    }
+
+}
+
+static void *renderer_entry(void *arg)
+{
+    struct renderer *rdr = (struct renderer *)arg;
+
+    int ret = purc_init_ex(PURC_MODULE_EJSON, BENCH_APP_NAME,
+            RENDERER_RUN_NAME, NULL);
+    if (ret != PURC_ERROR_OK) {
+        rdr->ready = true;
+        return NULL;
+    }
+
+    if (rdr->transport == TRANSPORT_THREAD) {
+        if (purc_inst_create_move_buffer(PCINST_MOVE_BUFFER_BROADCAST, 16))
+            rdr->endpoint = purc_get_endpoint(NULL);
+        rdr->ready = true;
+        if (!rdr->endpoint.empty())
+            serve_thread();
+    }
+    else {
+        rdr->ready = true;
+        int fd = accept(rdr->listener, NULL, NULL);
+        if (fd >= 0) {
+            serve_socket(rdr, fd);
+            close(fd);
+        }
+    }
+
+    purc_cleanup();
+    return NULL;
+}
+
+static bool start_renderer(struct renderer *rdr, enum transport transport)
+{
+    char buf[128];
+
+    rdr->transport = transport;
+    rdr->listener = -1;
+    rdr->ready = false;
+
+    if (transport == TRANSPORT_UNIX) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path),
+                "/tmp/bench_pcrdr-%d.sock", (int)getpid());
+        unlink(addr.sun_path);
+
+        rdr->listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (rdr->listener < 0 || bind(rdr->listener,
+                    (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+                listen(rdr->listener, 1) < 0)
+            goto failed;
+
+        snprintf(buf, sizeof(buf), "unix://%s", addr.sun_path);
+        rdr->uri = buf;
+    }
+    else if (transport == TRANSPORT_WEBSOCKET) {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+
+        rdr->listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (rdr->listener < 0 || bind(rdr->listener,
+                    (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+                listen(rdr->listener, 1) < 0 ||
+                getsockname(rdr->listener, (struct sockaddr *)&addr, &len) < 0)
+            goto failed;
+
+        snprintf(buf, sizeof(buf), "ws://127.0.0.1:%d", ntohs(addr.sin_port));
+        rdr->uri = buf;
+    }
+
+    if (pthread_create(&rdr->th, NULL, renderer_entry, rdr))
+        goto failed;
+
+    while (!rdr->ready)
+        usleep(1000);
+
+    if (transport == TRANSPORT_THREAD) {
+        if (rdr->endpoint.empty()) {
+            pthread_join(rdr->th, NULL);
+            goto failed;
+        }
+        rdr->uri = rdr->endpoint;
+    }
+    return true;
+
+failed:
+    if (rdr->listener >= 0)
+        close(rdr->listener);
+    rdr->listener = -1;
+    return false;
+}
+
+static void stop_renderer(struct renderer *rdr)
+{
+    /* the renderer exits once the client disconnected */
+    pthread_join(rdr->th, NULL);
+
+    if (rdr->listener >= 0) {
+        close(rdr->listener);
+        if (rdr->transport == TRANSPORT_UNIX)
+            unlink(rdr->uri.c_str() + sizeof("unix://") - 1);
+    }
+}
+
+static pcrdr_conn *connect_to_renderer(const struct renderer *rdr)
+{
+    pcrdr_conn *conn = NULL;
+    pcrdr_msg *msg;
+
+    switch (rdr->transport) {
+    case TRANSPORT_THREAD:
+        msg = pcrdr_thread_connect(rdr->uri.c_str(), BENCH_APP_NAME,
+                BENCH_RUN_NAME, &conn);
+        break;
+    case TRANSPORT_UNIX:
+        msg = pcrdr_socket_connect(rdr->uri.c_str(), BENCH_APP_NAME,
+                BENCH_RUN_NAME, &conn);
+        break;
+    default:
+        msg = pcrdr_websocket_connect(rdr->uri.c_str(), BENCH_APP_NAME,
+                BENCH_RUN_NAME, &conn);
+        break;
+    }
+
+    if (msg == NULL)
+        return NULL;
+
+    pcrdr_release_message(msg);
+    return conn;
+}
+
+/* one round trip of an `append` request carrying the fragment */
+static bool round_trip(pcrdr_conn *conn, const std::string &fragment)
+{
+    pcrdr_msg *request = pcrdr_make_request_message(
+            PCRDR_MSG_TARGET_DOM, 0x1234, PCRDR_OPERATION_APPEND, NULL,
+            NULL, PCRDR_MSG_ELEMENT_TYPE_HANDLE, "5678", NULL,
+            PCRDR_MSG_DATA_TYPE_HTML, fragment.c_str(), fragment.size());
+    if (request == NULL)
+        return false;
+
+    pcrdr_msg *response = NULL;
+    int ret = pcrdr_send_request_and_wait_response(conn, request,
+            PCRDR_DEF_TIME_EXPECTED, &response);
+    pcrdr_release_message(request);
+
+    bool ok = (ret == 0 && response && response->retCode == PCRDR_SC_OK);
+    if (response)
+        pcrdr_release_message(response);
+    return ok;
+}
+
+static std::string make_fragment(size_t size)
+{
+    static const char item[] = "<li class=\"item\">Purring Cat</li>";
+
+    std::string s = "<ul>";
+    while (s.size() + sizeof(item) - 1 + 5 <= size)
+        s += item;
+    s += "</ul>";
+    s.resize(size, ' ');
+    return s;
+}
+
+static double percentile(std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)];
+}
+
+static void report_begin(const struct bench_options *opts)
+{
+    if (opts->format == BENCH_FORMAT_JSON)
+        printf("{\n  \"benchmarks\": [");
+    else if (opts->format == BENCH_FORMAT_CSV)
+        printf("name,payload,round_trips,round_trips_per_sec,mb_per_sec,"
+                "p50_us,p99_us\n");
+    else
+        printf("%-12s %8s %12s %12s %10s %10s %10s\n", "name", "payload",
+                "round trips", "rt/s", "MB/s", "p50_us", "p99_us");
+}
+
+static void report(const struct bench_options *opts, const char *name,
+        size_t payload, size_t nr_round_trips, double round_trips_per_sec,
+        double mb_per_sec, double p50, double p99)
+{
+    static bool first = true;
+
+    switch (opts->format) {
+    case BENCH_FORMAT_JSON:
+        printf("%s\n    {\"name\": \"%s\", \"payload\": %zu, "
+                "\"round_trips\": %zu, \"round_trips_per_sec\": %.1f, "
+                "\"mb_per_sec\": %.2f, \"p50_us\": %.1f, \"p99_us\": %.1f}",
+                first ? "" : ",", name, payload, nr_round_trips,
+                round_trips_per_sec, mb_per_sec, p50, p99);
+        break;
+
+    case BENCH_FORMAT_CSV:
+        printf("%s,%zu,%zu,%.1f,%.2f,%.1f,%.1f\n", name, payload,
+                nr_round_trips, round_trips_per_sec, mb_per_sec, p50, p99);
+        break;
+
+    default:
+        printf("%-12s %8zu %12zu %12.1f %10.2f %10.1f %10.1f\n", name,
+                payload, nr_round_trips, round_trips_per_sec, mb_per_sec,
+                p50, p99);
+        break;
+    }
+
+    first = false;
+}
+
+static bool run_payload(const struct bench_options *opts, const char *name,
+        pcrdr_conn *conn, size_t payload)
+{
+    std::string fragment = make_fragment(payload);
+
+    /* warm up, and make sure the renderer answers */
+    if (!round_trip(conn, fragment)) {
+        fprintf(stderr, "%s: round trip of %zu bytes failed\n", name, payload);
+        return false;
+    }
+
+    std::vector<double> latencies;
+    uint64_t start = bench_now_ns(), elapsed;
+    do {
+        uint64_t t = bench_now_ns();
+        if (!round_trip(conn, fragment)) {
+            fprintf(stderr, "%s: round trip of %zu bytes failed\n",
+                    name, payload);
+            return false;
+        }
+        latencies.push_back((bench_now_ns() - t) / 1000.0);
+        elapsed = bench_now_ns() - start;
+    } while (elapsed < opts->min_ns);
+
+    std::sort(latencies.begin(), latencies.end());
+    double secs = elapsed / 1e9;
+    report(opts, name, payload, latencies.size(), latencies.size() / secs,
+            payload * latencies.size() / (1024.0 * 1024.0) / secs,
+            percentile(latencies, 0.50), percentile(latencies, 0.99));
+    return true;
+}
+
+static const size_t payloads[] = { 64, 1024, 4096, 32768 };
+
+static bool run_transport(const struct bench_options *opts,
+        enum transport transport)
+{
+    static const char *names[][2] = {
+        { "thread", NULL },
+        { "unix", "unix_bin" },
+        { "ws", "ws_bin" },
+    };
+
+    bool wanted = false;
+    for (int framing = 0; framing < 2; framing++) {
+        const char *name = names[transport][framing];
+        if (name && (opts->filter == NULL || strstr(name, opts->filter)))
+            wanted = true;
+    }
+    if (!wanted)
+        return true;
+
+    struct renderer rdr;
+    if (!start_renderer(&rdr, transport)) {
+        fprintf(stderr, "%s: failed to start the renderer\n",
+                names[transport][0]);
+        return false;
+    }
+
+    pcrdr_conn *conn = connect_to_renderer(&rdr);
+    if (conn == NULL) {
+        fprintf(stderr, "%s: failed to connect to %s\n",
+                names[transport][0], rdr.uri.c_str());
+        if (rdr.listener >= 0)
+            shutdown(rdr.listener, SHUT_RDWR);
+        stop_renderer(&rdr);
+        return false;
+    }
+
+    bool ok = true;
+    for (int framing = 0; ok && framing < 2; framing++) {
+        const char *name = names[transport][framing];
+        if (name == NULL ||
+                (opts->filter && strstr(name, opts->filter) == NULL))
+            continue;
+
+        conn->binary_framing = framing;
+        for (size_t i = 0; ok && i < PCA_TABLESIZE(payloads); i++)
+            ok = run_payload(opts, name, conn, payloads[i]);
+    }
+
+    pcrdr_disconnect(conn);
+    stop_renderer(&rdr);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    struct bench_options opts;
+    if (!bench_parse_options(argc, argv, &opts))
+        return EXIT_FAILURE;
+
+    /* a write to a renderer which went away should fail, not kill us */
+    signal(SIGPIPE, SIG_IGN);
+
+    int ret = purc_init_ex(PURC_MODULE_EJSON, BENCH_APP_NAME,
+            BENCH_RUN_NAME, NULL);
+    if (ret != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize PurC: %d\n", ret);
+        return EXIT_FAILURE;
+    }
+
+    purc_enable_log(false, false);
+    if (purc_inst_create_move_buffer(PCINST_MOVE_BUFFER_BROADCAST, 16) == 0) {
+        fprintf(stderr, "Failed to create the move buffer\n");
+        purc_cleanup();
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+    report_begin(&opts);
+    ok = run_transport(&opts, TRANSPORT_THREAD) && ok;
+    ok = run_transport(&opts, TRANSPORT_UNIX) && ok;
+    ok = run_transport(&opts, TRANSPORT_WEBSOCKET) && ok;
+    bench_report_end(&opts);
+
+    purc_cleanup();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -58,3 +58,50 @@ TEST(interpreter, purc_init)
 }
 
 
+
+TEST(instance, lazy_dvobjs)
+{
+    int ret = purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hvml.test",
+            "lazy_dvobjs", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    /* made on the first access */
+    purc_variant_t sys = purc_get_runner_variable(PURC_PREDEF_VARNAME_SYS);
+    ASSERT_NE(sys, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_is_object(sys));
+    ASSERT_NE(purc_variant_object_get_by_ckey(sys, "locale"), nullptr);
+    ASSERT_EQ(purc_get_runner_variable(PURC_PREDEF_VARNAME_SYS), sys);
+
+    /* not made if rebound before the first access */
+    purc_variant_t v = purc_variant_make_string_static("foo", false);
+    ASSERT_TRUE(purc_bind_runner_variable(PURC_PREDEF_VARNAME_DATA, v));
+    ASSERT_EQ(purc_get_runner_variable(PURC_PREDEF_VARNAME_DATA), v);
+    purc_variant_unref(v);
+
+    ASSERT_EQ(purc_get_runner_variable("NOT_BOUND"), PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_get_last_error(), PCVRNT_ERROR_NOT_FOUND);
+
+    purc_cleanup();
+}
+
+TEST(instance, init_time)
+{
+    const char *env = getenv("NR_INSTANCES");
+    size_t nr = env ? strtoul(env, NULL, 10) : 0;
+    if (nr == 0)
+        nr = 100;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < nr; i++) {
+        ASSERT_EQ(purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hvml.test",
+                    "init_time", NULL), PURC_ERROR_OK);
+        purc_cleanup();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ms = (end.tv_sec - start.tv_sec) * 1000.0 +
+        (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    fprintf(stderr, "%u instances initialized and cleaned up: %.3f ms each\n",
+            (unsigned)nr, ms / nr);
+}
@@ -0,0 +1,174 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc/purc.h"
+
+#include <stdio.h>
+#include <pthread.h>
+#include <gtest/gtest.h>
+
+#define NR_PRODUCERS        4
+#define NR_MSGS_PER_PRODUCER 200
+#define NR_MSGS_TOTAL       (NR_PRODUCERS * NR_MSGS_PER_PRODUCER)
+
+#define MSG_VALUE(producer, seq)    (((uint64_t)(producer) << 16) | (seq))
+#define MSG_PRODUCER(value)         ((int)((value) >> 16))
+#define MSG_SEQ(value)              ((int)((value) & 0xFFFF))
+
+static purc_atom_t consumer;
+
+struct producer_arg {
+    pthread_t   th;
+    int         nr;
+    size_t      nr_moved;
+};
+
+static pcrdr_msg *make_event(uint64_t value)
+{
+    return pcrdr_make_event_message(PCRDR_MSG_TARGET_INSTANCE, value,
+            "test", NULL, PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+            PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+}
+
+static void *producer_entry(void *arg)
+{
+    struct producer_arg *my_arg = (struct producer_arg *)arg;
+    char runner_name[32];
+
+    snprintf(runner_name, sizeof(runner_name), "producer%d", my_arg->nr);
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.purc.test",
+            runner_name, NULL);
+    if (ret != PURC_ERROR_OK)
+        return NULL;
+
+    for (int i = 0; i < NR_MSGS_PER_PRODUCER; i++) {
+        pcrdr_msg *msg = make_event(MSG_VALUE(my_arg->nr, i));
+        my_arg->nr_moved += purc_inst_move_message(consumer, msg);
+        pcrdr_release_message(msg);
+    }
+
+    purc_cleanup();
+    return NULL;
+}
+
+/* the producers push to the inbox concurrently; the consumer gets all
+   messages, and the messages of every producer in the order of sending */
+TEST(move_buffer, concurrent_producers)
+{
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.purc.test",
+            "move_buffer", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    consumer = purc_inst_create_move_buffer(PCINST_MOVE_BUFFER_FLAG_NONE,
+            NR_MSGS_TOTAL);
+    ASSERT_NE(consumer, 0);
+
+    struct producer_arg args[NR_PRODUCERS];
+    for (int i = 0; i < NR_PRODUCERS; i++) {
+        args[i].nr = i;
+        args[i].nr_moved = 0;
+        ASSERT_EQ(pthread_create(&args[i].th, NULL, producer_entry,
+                    args + i), 0);
+    }
+
+    for (int i = 0; i < NR_PRODUCERS; i++) {
+        pthread_join(args[i].th, NULL);
+        ASSERT_EQ(args[i].nr_moved, NR_MSGS_PER_PRODUCER);
+    }
+
+    size_t n;
+    ASSERT_EQ(purc_inst_holding_messages_count(&n), 0);
+    ASSERT_EQ(n, NR_MSGS_TOTAL);
+
+    /* retrieving does not take the message away */
+    const pcrdr_msg *first = purc_inst_retrieve_message(0);
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(MSG_SEQ(first->targetValue), 0);
+    ASSERT_EQ(purc_inst_holding_messages_count(&n), 0);
+    ASSERT_EQ(n, NR_MSGS_TOTAL);
+
+    int next_seq[NR_PRODUCERS] = { };
+    for (int i = 0; i < NR_MSGS_TOTAL; i++) {
+        pcrdr_msg *msg = purc_inst_take_away_message(0);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(msg->target, PCRDR_MSG_TARGET_INSTANCE);
+
+        int producer = MSG_PRODUCER(msg->targetValue);
+        ASSERT_LT(producer, NR_PRODUCERS);
+        ASSERT_EQ(MSG_SEQ(msg->targetValue), next_seq[producer]);
+        next_seq[producer]++;
+        pcrdr_release_message(msg);
+    }
+
+    ASSERT_EQ(purc_inst_take_away_message(0), nullptr);
+    ASSERT_EQ(purc_inst_holding_messages_count(&n), 0);
+    ASSERT_EQ(n, 0);
+
+    ASSERT_EQ(purc_inst_destroy_move_buffer(), 0);
+    purc_cleanup();
+}
+
+/* a full inbox refuses new messages until one is taken away */
+TEST(move_buffer, full_and_indexed)
+{
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.purc.test",
+            "move_buffer", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    consumer = purc_inst_create_move_buffer(PCINST_MOVE_BUFFER_FLAG_NONE, 3);
+    ASSERT_NE(consumer, 0);
+
+    for (uint64_t i = 0; i < 4; i++) {
+        pcrdr_msg *msg = make_event(i);
+        size_t nr = purc_inst_move_message(consumer, msg);
+        pcrdr_release_message(msg);
+
+        if (i < 3) {
+            ASSERT_EQ(nr, 1);
+        }
+        else {
+            ASSERT_EQ(nr, 0);
+            ASSERT_EQ(purc_get_last_error(), PURC_ERROR_TOO_SMALL_BUFF);
+        }
+    }
+
+    /* the slow path: take away the message in the middle */
+    pcrdr_msg *msg = purc_inst_take_away_message(1);
+    ASSERT_NE(msg, nullptr);
+    ASSERT_EQ(msg->targetValue, 1);
+    pcrdr_release_message(msg);
+
+    msg = make_event(3);
+    ASSERT_EQ(purc_inst_move_message(consumer, msg), 1);
+    pcrdr_release_message(msg);
+
+    const uint64_t expected[] = { 0, 2, 3 };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        msg = purc_inst_take_away_message(0);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(msg->targetValue, expected[i]);
+        pcrdr_release_message(msg);
+    }
+
+    ASSERT_EQ(purc_inst_take_away_message(3), nullptr);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_NOT_EXISTS);
+
+    ASSERT_EQ(purc_inst_destroy_move_buffer(), 0);
+    purc_cleanup();
+}
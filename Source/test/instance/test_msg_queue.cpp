@@ -0,0 +1,119 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc/purc.h"
+#include "private/msg-queue.h"
+
+#include <gtest/gtest.h>
+
+static pcrdr_msg *
+make_event(const char *name, const char *element)
+{
+    pcrdr_msg *msg = pcrdr_make_event_message(PCRDR_MSG_TARGET_COROUTINE, 1,
+            name, NULL, PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+            PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+    if (msg && element) {
+        msg->elementType = PCRDR_MSG_ELEMENT_TYPE_VARIANT;
+        msg->elementValue = purc_variant_make_string(element, false);
+    }
+    return msg;
+}
+
+static const char *
+event_name(const pcrdr_msg *msg)
+{
+    return purc_variant_get_string_const(msg->eventName);
+}
+
+TEST(msg_queue, input_lane_first)
+{
+    const purc_instance_extra_info extra_info = {};
+    int r = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "msg_queue", &extra_info);
+    ASSERT_EQ(r, 0);
+
+    struct pcinst_msg_queue *queue = pcinst_msg_queue_create();
+    ASSERT_NE(queue, nullptr);
+
+    pcinst_msg_queue_append(queue, make_event("change:attached", "$data"));
+    pcinst_msg_queue_append(queue, make_event("grow", "$data"));
+    pcinst_msg_queue_append(queue, make_event("expired:clock", "clock"));
+    pcinst_msg_queue_append(queue, make_event("click", "#button"));
+
+    ASSERT_EQ(pcinst_msg_queue_count(queue), 4);
+    ASSERT_EQ(queue->nr_events[PCINST_MSG_LANE_INPUT], 1);
+    ASSERT_EQ(queue->nr_events[PCINST_MSG_LANE_TIMER], 1);
+    ASSERT_EQ(queue->nr_events[PCINST_MSG_LANE_DATA], 2);
+    ASSERT_EQ(queue->max_events[PCINST_MSG_LANE_DATA], 2);
+
+    /* the input event is taken before the earlier events */
+    const char *expected[] = { "click", "expired:clock",
+        "change:attached", "grow" };
+    for (size_t i = 0; i < PCA_TABLESIZE(expected); i++) {
+        pcrdr_msg *msg = pcinst_msg_queue_get_msg(queue);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_STREQ(event_name(msg), expected[i]);
+        pcrdr_release_message(msg);
+    }
+
+    ASSERT_EQ(pcinst_msg_queue_get_msg(queue), nullptr);
+    ASSERT_EQ(pcinst_msg_queue_count(queue), 0);
+    for (int i = 0; i < PCINST_MSG_LANE_NR; i++) {
+        ASSERT_EQ(queue->nr_events[i], 0);
+    }
+    ASSERT_EQ(queue->max_events[PCINST_MSG_LANE_DATA], 2);
+
+    pcinst_msg_queue_destroy(queue);
+    purc_cleanup();
+}
+
+TEST(msg_queue, get_event_by_element)
+{
+    const purc_instance_extra_info extra_info = {};
+    int r = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "msg_queue", &extra_info);
+    ASSERT_EQ(r, 0);
+
+    struct pcinst_msg_queue *queue = pcinst_msg_queue_create();
+    ASSERT_NE(queue, nullptr);
+
+    pcinst_msg_queue_append(queue, make_event("change", "$data"));
+    pcinst_msg_queue_append(queue, make_event("click", "#button"));
+    ASSERT_EQ(pcinst_msg_queue_count(queue), 2);
+
+    purc_variant_t element = purc_variant_make_string("$data", false);
+    purc_variant_t name = purc_variant_make_string("change", false);
+    pcrdr_msg *msg = pcinst_msg_queue_get_event_by_element(queue,
+            PURC_VARIANT_INVALID, element, name);
+    purc_variant_unref(element);
+    purc_variant_unref(name);
+
+    ASSERT_NE(msg, nullptr);
+    pcrdr_release_message(msg);
+    ASSERT_EQ(pcinst_msg_queue_count(queue), 1);
+    ASSERT_EQ(queue->nr_events[PCINST_MSG_LANE_DATA], 0);
+
+    msg = pcinst_msg_queue_get_msg(queue);
+    ASSERT_NE(msg, nullptr);
+    ASSERT_STREQ(event_name(msg), "click");
+    pcrdr_release_message(msg);
+
+    pcinst_msg_queue_destroy(queue);
+    purc_cleanup();
+}
@@ -20,7 +20,11 @@
 #include "purc/purc.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <errno.h>
+#include <limits.h>
+#include <unistd.h>
 #include <gtest/gtest.h>
 
 #define ATOM_BITS_NR        (sizeof(purc_atom_t) << 3)
@@ -62,3 +66,58 @@ TEST(instance, mylog)
     purc_cleanup();
 }
 
+
+TEST(instance, mylog_async)
+{
+    char path[PATH_MAX + 1];
+    snprintf(path, sizeof(path), PURC_LOG_FILE_PATH_FORMAT,
+            "cn.fmsoft.hvml.purc", "test_async");
+    unlink(path);
+
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hvml.purc",
+            "test_async", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    ASSERT_TRUE(purc_enable_log_ex(PURC_LOG_MASK_ALL, PURC_LOG_FACILITY_FILE));
+    ASSERT_TRUE(purc_enable_log_async(true, 0));
+
+    for (int i = 0; i < 100; i++) {
+        purc_log_debug("async message #%d\n", i);
+    }
+
+    size_t nr_limited;
+    size_t nr_dropped = purc_get_log_dropped(&nr_limited);
+    ASSERT_EQ(nr_limited, 0);
+
+    /* at most 10 messages with the same tag in a second */
+    ASSERT_TRUE(purc_enable_log_async(true, 10));
+    for (int i = 100; i < 200; i++) {
+        purc_log_info("async message #%d\n", i);
+    }
+
+    nr_dropped = purc_get_log_dropped(&nr_limited);
+    ASSERT_GE(nr_limited, 80);
+
+    // the pending messages are written when cleaning up the instance
+    purc_cleanup();
+
+    FILE *fp = fopen(path, "r");
+    ASSERT_NE(fp, nullptr);
+
+    char line[256];
+    size_t nr_lines = 0;
+    int last = -1;
+    while (fgets(line, sizeof(line), fp)) {
+        const char *msg = strstr(line, "async message #");
+        if (msg) {
+            int n = atoi(msg + sizeof("async message #") - 1);
+            ASSERT_GT(n, last);
+            last = n;
+            nr_lines++;
+        }
+    }
+    fclose(fp);
+    unlink(path);
+
+    ASSERT_EQ(nr_lines + nr_dropped + nr_limited, 200);
+}
@@ -288,3 +288,215 @@ TEST(instance, threads)
     purc_cleanup();
 }
 
+
+// to test: move a message to the instance itself via the move heap
+TEST(instance, move_to_self)
+{
+    int ret;
+
+    ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.purc.test", "self",
+            NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_atom_t self = purc_inst_create_move_buffer(0, 16);
+    ASSERT_NE(self, 0);
+
+    size_t nr_values = purc_variant_usage_stat()->nr_total_values;
+
+    static const double ds[] = { 1.0, 2.0, 3.0 };
+    purc_variant_t packed = purc_variant_make_packed_array(
+            PCVRNT_PACKED_NUMBER, ds, 3);
+    purc_variant_t shared = purc_variant_make_string("shared", false);
+    purc_variant_t null = purc_variant_make_null();
+    purc_variant_t tuple = purc_variant_make_tuple(1, &null);
+    purc_variant_t data = purc_variant_make_object_by_static_ckey(4,
+            "packed", packed, "shared", shared, "null", null,
+            "tuple", tuple);
+    purc_variant_unref(packed);
+    purc_variant_unref(null);
+    purc_variant_unref(tuple);
+
+    char *expected;
+    ASSERT_GT(purc_variant_stringify_alloc(&expected, data), 0);
+
+    pcrdr_msg *msg = pcrdr_make_event_message(
+            PCRDR_MSG_TARGET_INSTANCE, 1, "test", NULL,
+            PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+            PCRDR_MSG_DATA_TYPE_JSON, NULL, 0);
+    msg->data = data;
+    ASSERT_EQ(purc_inst_move_message(self, msg), 1);
+    pcrdr_release_message(msg);
+
+    msg = purc_inst_take_away_message(0);
+    ASSERT_NE(msg, nullptr);
+
+    char *result;
+    ASSERT_GT(purc_variant_stringify_alloc(&result, msg->data), 0);
+    ASSERT_STREQ(result, expected);
+    free(result);
+    free(expected);
+
+    pcrdr_release_message(msg);
+    purc_variant_unref(shared);
+
+    /* all values are moved back and released */
+    ASSERT_EQ(purc_variant_usage_stat()->nr_total_values, nr_values);
+
+    purc_inst_destroy_move_buffer();
+    purc_cleanup();
+}
+
+#define NR_RECEIVERS        4
+
+static const char *broadcast_json =
+    "{ name: 'PurC', os: ['Linux', 'macOS', 'HybridOS', 'Windows'], "
+    "version: [0, 9, 22], nested: { emptyArray: [], emptyObject: {} } }";
+static char *broadcast_expected;
+
+static void* receiver_thread_entry(void* arg)
+{
+    struct thread_arg *my_arg = (struct thread_arg *)arg;
+    char runner_name[32];
+
+    snprintf(runner_name, sizeof(runner_name), "receiver%d", my_arg->nr);
+    int th_no = my_arg->nr;
+
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.purc.test",
+            runner_name, NULL);
+    assert(ret == PURC_ERROR_OK);
+
+    if (ret == PURC_ERROR_OK) {
+        purc_enable_log(false, false);
+        other_inst[th_no] =
+            purc_inst_create_move_buffer(PCINST_MOVE_BUFFER_BROADCAST, 16);
+    }
+    sem_post(my_arg->wait);
+
+    size_t n;
+    do {
+        ret = purc_inst_holding_messages_count(&n);
+        if (ret == 0 && n > 0) {
+            pcrdr_msg *msg = purc_inst_take_away_message(0);
+
+            /* every receiver gets its own copy of the data */
+            char *result = NULL;
+            purc_variant_stringify_alloc(&result, msg->data);
+            bool same = result && strcmp(result, broadcast_expected) == 0;
+            free(result);
+
+            purc_variant_t extra = purc_variant_make_ulongint(th_no);
+            purc_variant_object_set_by_static_ckey(msg->data, "receiver",
+                    extra);
+            purc_variant_unref(extra);
+
+            pcrdr_msg *reply = pcrdr_make_event_message(
+                    PCRDR_MSG_TARGET_INSTANCE, 2, "reply", NULL,
+                    PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+                    PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+            reply->resultValue = same ? 1 : 0;
+            purc_inst_move_message(main_inst, reply);
+            pcrdr_release_message(reply);
+            pcrdr_release_message(msg);
+            break;
+        }
+        else {
+            usleep(10000);  // 10m
+        }
+
+    } while (true);
+
+    purc_inst_destroy_move_buffer();
+    purc_cleanup();
+    return NULL;
+}
+
+static int create_receiver_thread(int nr)
+{
+    struct thread_arg arg;
+    pthread_t th;
+
+    arg.nr = nr;
+ALLOW_DEPRECATED_DECLARATIONS_BEGIN
+    sem_unlink("sync");
+    arg.wait = sem_open("sync", O_CREAT | O_EXCL, 0644, 0);
+    if (arg.wait == SEM_FAILED) {
+        purc_log_error("failed to create semaphore: %s\n", strerror(errno));
+        return -1;
+    }
+    int ret = pthread_create(&th, NULL, receiver_thread_entry, &arg);
+    if (ret) {
+        sem_close(arg.wait);
+        purc_log_error("failed to create thread: %d\n", nr);
+        return -1;
+    }
+
+    sem_wait(arg.wait);
+    sem_close(arg.wait);
+ALLOW_DEPRECATED_DECLARATIONS_END
+
+    other_threads[nr] = th;
+    return 0;
+}
+
+// to test: broadcast a message with a container as the data
+TEST(instance, broadcast_data)
+{
+    int ret;
+
+    ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.purc.test", "broadcaster",
+            NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    /* the broadcaster does not receive its own message */
+    main_inst = purc_inst_create_move_buffer(0, 16);
+    ASSERT_NE(main_inst, 0);
+
+    purc_variant_t data = purc_variant_make_from_json_string(broadcast_json,
+            strlen(broadcast_json));
+    ASSERT_NE(data, nullptr);
+    ASSERT_GT(purc_variant_stringify_alloc(&broadcast_expected, data), 0);
+
+    for (int i = 0; i < NR_RECEIVERS; i++) {
+        ASSERT_EQ(create_receiver_thread(i), 0);
+        ASSERT_NE(other_inst[i], 0);
+    }
+
+    pcrdr_msg *event = pcrdr_make_event_message(
+            PCRDR_MSG_TARGET_INSTANCE, 1, "test", NULL,
+            PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+            PCRDR_MSG_DATA_TYPE_JSON, NULL, 0);
+    event->data = data;
+    ASSERT_EQ(purc_inst_move_message(PURC_EVENT_TARGET_BROADCAST, event),
+            (size_t)NR_RECEIVERS);
+    pcrdr_release_message(event);
+
+    size_t n;
+    int nr_got = 0, nr_same = 0;
+    do {
+        ret = purc_inst_holding_messages_count(&n);
+        ASSERT_EQ(ret, 0);
+        if (n > 0) {
+            pcrdr_msg *msg = purc_inst_take_away_message(0);
+            ASSERT_NE(msg, nullptr);
+            if (msg->resultValue)
+                nr_same++;
+            pcrdr_release_message(msg);
+            nr_got++;
+        }
+        else {
+            usleep(10000);  // 10m
+        }
+    } while (nr_got < NR_RECEIVERS);
+
+    ASSERT_EQ(nr_same, NR_RECEIVERS);
+
+    for (int i = 0; i < NR_RECEIVERS; i++) {
+        pthread_join(other_threads[i], NULL);
+    }
+
+    free(broadcast_expected);
+    broadcast_expected = NULL;
+
+    purc_inst_destroy_move_buffer();
+    purc_cleanup();
+}
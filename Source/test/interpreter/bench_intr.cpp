@@ -0,0 +1,408 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The end-to-end benchmark of the interpreter.
+ *
+ * Usage: bench_intr [--format=text|json|csv] [--filter=<substring>]
+ *          [--min-time=<milliseconds>] [<HVML file>...]
+ *
+ * Every workload runs in a fresh instance connected to the headless
+ * renderer in the null mode: the program is scheduled again and again
+ * until the minimal time elapses. The built-in workloads:
+ *
+ *  - iterate: a loop-heavy program with `iterate` and `test`;
+ *  - update: a program generating the DOM with `iterate` and `update`;
+ *  - observe: an event is fired on a variable and observed by eight
+ *    observers; the next one is fired once the last was handled;
+ *  - call: synchronous `call`s of an operation group in another runner.
+ *
+ * The HVML files given on the command line are run instead.
+ *
+ * The report:
+ *
+ *  - steps/s: the interpreter steps run per second (the `steps` metric);
+ *  - events/s, p50_us, p99_us: the events handled per second and their
+ *    latencies in microseconds; a program reports the events by exiting
+ *    with an array of `[<sent time>, <handled time>]` pairs of $SYS.time_us;
+ *  - peak_kb: the peak memory of the variants of the instance
+ *    (`sz_max_mem` of purc_variant_usage_stat()).
+ */
+
+#include "purc/purc.h"
+
+#include "../bench.h"
+
+#include <algorithm>
+
+#include <unistd.h>
+
+#define APP_NAME            "cn.fmsoft.hvml.bench"
+#define WORKER_NAME         "benchWorker"
+#define NULL_RENDERER_URI   "file:///dev/null?" PCRDR_HEADLESS_NULL_MODE_OPTION
+
+struct workload {
+    std::string name;
+    std::string hvml;
+    std::string request;    // $REQ in JSON
+    bool        html;       // whether it needs a page in the renderer
+    bool        worker;     // whether it calls the worker runner
+};
+
+static const char *iterate_hvml =
+    "<!DOCTYPE hvml>"
+    "<hvml target=\"void\">"
+    "  <body>"
+    "    <iterate on 0L onlyif $L.lt($0<, $REQ.n)"
+    "        with $DATA.arith('+', $0<, 1) nosetotail >"
+    "      <test with $DATA.arith('%', $?, 2) >"
+    "        <init as \"odd\" with $? />"
+    "      </test>"
+    "    </iterate>"
+    "    <exit with $REQ.n />"
+    "  </body>"
+    "</hvml>";
+
+static const char *update_hvml =
+    "<!DOCTYPE hvml>"
+    "<hvml target=\"html\">"
+    "  <body>"
+    "    <p id=\"counter\">0</p>"
+    "    <ul id=\"list\">"
+    "      <iterate on 0L onlyif $L.lt($0<, $REQ.n)"
+    "          with $DATA.arith('+', $0<, 1) nosetotail >"
+    "        <li class=\"item\">item $?</li>"
+    "        <update on \"#counter\" at \"textContent\" with $? />"
+    "      </iterate>"
+    "    </ul>"
+    "    <update on \"#list\" at \"attr.class\" with \"done\" />"
+    "    <exit with $REQ.n />"
+    "  </body>"
+    "</hvml>";
+
+/* NOTE: `fire` ignores an event while the same one is still pending,
+   so the events are fired one by one instead of in a burst. */
+static const char *observe_hvml =
+    "<!DOCTYPE hvml>"
+    "<hvml target=\"void\">"
+    "  <body>"
+    "    <init as \"vs\" with [\"bench\"] />"
+    "    <init as \"samples\" with [] />"
+    "    <init as \"state\" with { \"fired\": 1L } />"
+    ""
+    "    <iterate on 0L onlyif $L.lt($0<, $REQ.fanout)"
+    "        with $DATA.arith('+', $0<, 1) nosetotail >"
+    "      <observe on $vs for \"bench:ping\" >"
+    "        <update on $samples to \"append\" with [$?, $SYS.time_us] />"
+    "      </observe>"
+    "    </iterate>"
+    ""
+    "    <observe on $vs for \"bench:ping\" >"
+    "      <test with $L.lt($state.fired, $REQ.n) >"
+    "        <update on $state at \".fired\""
+    "            with $DATA.arith('+', $state.fired, 1) />"
+    "        <fire on $vs for \"bench:ping\" with $SYS.time_us />"
+    "        <differ>"
+    "          <fire on $vs for \"bench:done\" with 0 />"
+    "        </differ>"
+    "      </test>"
+    "    </observe>"
+    ""
+    "    <observe on $vs for \"bench:done\" >"
+    "      <exit with $samples />"
+    "    </observe>"
+    ""
+    "    <fire on $vs for \"bench:ping\" with $SYS.time_us />"
+    "  </body>"
+    "</hvml>";
+
+static const char *call_hvml =
+    "<!DOCTYPE hvml>"
+    "<hvml target=\"void\">"
+    "  <body>"
+    "    <define as \"echo\">"
+    "      <return with $? />"
+    "    </define>"
+    ""
+    "    <init as \"samples\" with [] />"
+    "    <iterate on 0L onlyif $L.lt($0<, $REQ.n)"
+    "        with $DATA.arith('+', $0<, 1) nosetotail >"
+    "      <call on $echo within $REQ.runner with $SYS.time_us"
+    "          concurrently synchronously >"
+    "        <update on $samples to \"append\" with [$?, $SYS.time_us] />"
+    "      </call>"
+    "    </iterate>"
+    "    <exit with $samples />"
+    "  </body>"
+    "</hvml>";
+
+struct run_stats {
+    size_t              nr_exited;
+    size_t              nr_terminated;
+    std::vector<double> latencies;  // in microseconds
+};
+
+static struct run_stats *current_stats;
+
+/* collects the latencies from the `[<sent>, <handled>]` pairs */
+static void collect_samples(purc_variant_t result,
+        std::vector<double> &latencies)
+{
+    size_t nr_samples;
+    if (result == PURC_VARIANT_INVALID || !purc_variant_is_array(result) ||
+            !purc_variant_array_size(result, &nr_samples))
+        return;
+
+    for (size_t i = 0; i < nr_samples; i++) {
+        purc_variant_t pair = purc_variant_array_get(result, i);
+        long double sent, handled;
+        size_t sz;
+
+        if (purc_variant_is_array(pair) &&
+                purc_variant_array_size(pair, &sz) && sz == 2 &&
+                purc_variant_cast_to_longdouble(
+                    purc_variant_array_get(pair, 0), &sent, false) &&
+                purc_variant_cast_to_longdouble(
+                    purc_variant_array_get(pair, 1), &handled, false)) {
+            latencies.push_back((double)((handled - sent) * 1000000));
+        }
+    }
+}
+
+static int cond_handler(purc_cond_k event, void *arg, void *data)
+{
+    (void)arg;
+
+    if (event == PURC_COND_COR_EXITED) {
+        struct purc_cor_exit_info *info = (struct purc_cor_exit_info *)data;
+        collect_samples(info->result, current_stats->latencies);
+        current_stats->nr_exited++;
+    }
+    else if (event == PURC_COND_COR_TERMINATED) {
+        current_stats->nr_terminated++;
+    }
+
+    return 0;
+}
+
+static uint64_t get_nr_steps(void)
+{
+    uint64_t nr_steps = 0;
+    purc_variant_t metrics = purc_get_instance_metrics();
+    if (metrics) {
+        purc_variant_t v = purc_variant_object_get_by_ckey(metrics, "steps");
+        if (v)
+            purc_variant_cast_to_ulongint(v, &nr_steps, false);
+        purc_variant_unref(metrics);
+    }
+
+    return nr_steps;
+}
+
+static double percentile(std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)];
+}
+
+static void report_begin(const struct bench_options *opts)
+{
+    if (opts->format == BENCH_FORMAT_JSON)
+        printf("{\n  \"benchmarks\": [");
+    else if (opts->format == BENCH_FORMAT_CSV)
+        printf("name,runs,steps_per_sec,events_per_sec,p50_us,p99_us,"
+                "peak_kb\n");
+    else
+        printf("%-20s %8s %12s %12s %10s %10s %10s\n", "name", "runs",
+                "steps/s", "events/s", "p50_us", "p99_us", "peak_kb");
+}
+
+static void report(const struct bench_options *opts, const char *name,
+        size_t nr_runs, double steps_per_sec, double events_per_sec,
+        double p50, double p99, double peak_kb)
+{
+    static bool first = true;
+
+    switch (opts->format) {
+    case BENCH_FORMAT_JSON:
+        printf("%s\n    {\"name\": \"%s\", \"runs\": %zu, "
+                "\"steps_per_sec\": %.1f, \"events_per_sec\": %.1f, "
+                "\"p50_us\": %.1f, \"p99_us\": %.1f, \"peak_kb\": %.1f}",
+                first ? "" : ",", name, nr_runs, steps_per_sec,
+                events_per_sec, p50, p99, peak_kb);
+        break;
+
+    case BENCH_FORMAT_CSV:
+        printf("%s,%zu,%.1f,%.1f,%.1f,%.1f,%.1f\n", name, nr_runs,
+                steps_per_sec, events_per_sec, p50, p99, peak_kb);
+        break;
+
+    default:
+        printf("%-20s %8zu %12.1f %12.1f %10.1f %10.1f %10.1f\n", name,
+                nr_runs, steps_per_sec, events_per_sec, p50, p99, peak_kb);
+        break;
+    }
+
+    first = false;
+}
+
+static void wait_for_termination(purc_atom_t inst)
+{
+    purc_inst_ask_to_shutdown(inst);
+    for (int i = 0; i < 500 && purc_atom_to_string(inst); i++)
+        usleep(10000);
+}
+
+static bool run_workload(const struct bench_options *opts,
+        const struct workload &w)
+{
+    struct purc_instance_extra_info info = {};
+    info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+    info.renderer_uri = NULL_RENDERER_URI;
+    info.workspace_name = "main";
+
+    int ret = purc_init_ex(PURC_MODULE_HVML & ~PURC_HAVE_FETCHER, APP_NAME,
+            "bench_intr", &info);
+    if (ret != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize PurC: %d\n", ret);
+        return false;
+    }
+
+    bool ok = false;
+    purc_atom_t worker = 0;
+    purc_variant_t request = PURC_VARIANT_INVALID;
+    purc_vdom_t vdom = purc_load_hvml_from_string(w.hvml.c_str());
+    if (vdom == NULL) {
+        fprintf(stderr, "%s: failed to load the program\n", w.name.c_str());
+        goto done;
+    }
+
+    if (!w.request.empty()) {
+        request = purc_variant_make_from_json_string(w.request.c_str(),
+                w.request.size());
+        if (request == PURC_VARIANT_INVALID)
+            goto done;
+    }
+
+    if (w.worker) {
+        worker = purc_inst_create_or_get(APP_NAME, WORKER_NAME, NULL, &info);
+        if (worker == 0) {
+            fprintf(stderr, "%s: failed to create the worker\n",
+                    w.name.c_str());
+            goto done;
+        }
+    }
+
+    {
+        struct run_stats stats = {};
+        current_stats = &stats;
+
+        size_t nr_runs = 0;
+        uint64_t start = bench_now_ns(), elapsed;
+        do {
+            purc_renderer_extra_info rdr_info = {};
+            rdr_info.title = "bench";
+
+            purc_coroutine_t co = purc_schedule_vdom(vdom, 0, request,
+                    w.html ? PCRDR_PAGE_TYPE_PLAINWIN : PCRDR_PAGE_TYPE_NULL,
+                    "main", NULL, w.html ? "bench" : NULL,
+                    &rdr_info, NULL, NULL);
+            if (co == NULL)
+                break;
+
+            purc_run(cond_handler);
+            nr_runs++;
+            elapsed = bench_now_ns() - start;
+        } while (elapsed < opts->min_ns);
+
+        current_stats = NULL;
+        if (stats.nr_terminated > 0 || stats.nr_exited < nr_runs ||
+                nr_runs == 0) {
+            fprintf(stderr, "%s: %zu of %zu runs did not exit normally\n",
+                    w.name.c_str(), nr_runs - stats.nr_exited, nr_runs);
+            goto done;
+        }
+
+        std::sort(stats.latencies.begin(), stats.latencies.end());
+        double secs = elapsed / 1e9;
+        report(opts, w.name.c_str(), nr_runs, get_nr_steps() / secs,
+                stats.latencies.size() / secs,
+                percentile(stats.latencies, 0.50),
+                percentile(stats.latencies, 0.99),
+                purc_variant_usage_stat()->sz_max_mem / 1024.0);
+        ok = true;
+    }
+
+done:
+    if (worker)
+        wait_for_termination(worker);
+    if (request)
+        purc_variant_unref(request);
+    purc_cleanup();
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    struct bench_options opts;
+    if (!bench_parse_options(argc, argv, &opts))
+        return EXIT_FAILURE;
+
+    std::vector<struct workload> workloads;
+    if (opts.files.empty()) {
+        workloads.push_back({ "iterate", iterate_hvml,
+                "{ \"n\": 10000 }", false, false });
+        workloads.push_back({ "update", update_hvml,
+                "{ \"n\": 1000 }", true, false });
+        workloads.push_back({ "observe", observe_hvml,
+                "{ \"n\": 1000, \"fanout\": 8 }", false, false });
+        workloads.push_back({ "call", call_hvml,
+                "{ \"n\": 100, \"runner\": \"" WORKER_NAME "\" }",
+                false, true });
+    }
+    else {
+        for (size_t i = 0; i < opts.files.size(); i++) {
+            struct workload w = { opts.files[i], "", "", true, false };
+            if (!bench_read_file(opts.files[i].c_str(), w.hvml)) {
+                fprintf(stderr, "Failed to read %s\n", opts.files[i].c_str());
+                return EXIT_FAILURE;
+            }
+
+            size_t slash = w.name.rfind('/');
+            if (slash != std::string::npos)
+                w.name = w.name.substr(slash + 1);
+            workloads.push_back(w);
+        }
+    }
+
+    bool ok = true;
+    report_begin(&opts);
+    for (size_t i = 0; i < workloads.size(); i++) {
+        if (opts.filter &&
+                strstr(workloads[i].name.c_str(), opts.filter) == NULL)
+            continue;
+
+        ok = run_workload(&opts, workloads[i]) && ok;
+    }
+    bench_report_end(&opts);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
@@ -639,3 +639,40 @@ TEST(interpreter, basic)
     purc_run(NULL);
 }
 
+
+TEST(interpreter, null_renderer)
+{
+    unsigned int modules = (PURC_MODULE_HVML | PURC_MODULE_PCRDR) & ~PURC_HAVE_FETCHER;
+
+    struct purc_instance_extra_info info = { };
+    info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+    info.renderer_uri = "file:///dev/null?" PCRDR_HEADLESS_NULL_MODE_OPTION;
+    info.workspace_name = "main";
+
+    PurCInstance purc(modules, "cn.fmsoft.hybridos.test", "test_null_rdr",
+            &info);
+    ASSERT_TRUE(purc);
+
+    purc_vdom_t vdom = purc_load_hvml_from_string(calculator_1);
+    ASSERT_NE(vdom, nullptr);
+
+    purc_renderer_extra_info extra_info = {};
+    extra_info.title = "def_page_title";
+    purc_coroutine_t co = purc_schedule_vdom(vdom,
+            0, PURC_VARIANT_INVALID, PCRDR_PAGE_TYPE_PLAINWIN,
+            "main",         /* target_workspace */
+            NULL,           /* target_group */
+            "def_page",     /* page_name */
+            &extra_info, NULL, NULL);
+    ASSERT_NE(co, nullptr);
+
+    purc_run(NULL);
+
+    const uint64_t *counts;
+    counts = pcrdr_headless_request_counts(purc_get_conn_to_renderer());
+    ASSERT_NE(counts, nullptr);
+    ASSERT_EQ(counts[PCRDR_K_OPERATION_STARTSESSION], 1U);
+    ASSERT_EQ(counts[PCRDR_K_OPERATION_CREATEPLAINWINDOW], 1U);
+    ASSERT_EQ(counts[PCRDR_K_OPERATION_LOAD] +
+            counts[PCRDR_K_OPERATION_WRITEBEGIN], 1U);
+}
@@ -895,3 +895,56 @@ TEST(interpreter, basic)
     purc_run(NULL);
 }
 
+
+static uint64_t get_frame_pool_counter(purc_variant_t metrics,
+        const char *key)
+{
+    uint64_t u = 0;
+    purc_variant_t pool = purc_variant_object_get_by_ckey(metrics,
+            "framePool");
+    if (pool && purc_variant_is_object(pool)) {
+        purc_variant_t v = purc_variant_object_get_by_ckey(pool, key);
+        if (v)
+            purc_variant_cast_to_ulongint(v, &u, false);
+    }
+    return u;
+}
+
+TEST(interpreter, frame_pool)
+{
+    static const char hvml[] =
+        "<!DOCTYPE hvml>"
+        "<hvml target=\"void\">"
+        "  <body>"
+        "    <iterate on 0L onlyif $L.lt($0<, 50L)"
+        "        with $DATA.arith('+', $0<, 1) nosetotail >"
+        "      <test with $DATA.arith('%', $?, 2) >"
+        "        <init as \"odd\" with $? />"
+        "      </test>"
+        "    </iterate>"
+        "  </body>"
+        "</hvml>";
+
+    PurCInstance purc("cn.fmsoft.hybridos.test", "interpreter", false);
+    ASSERT_TRUE(purc);
+
+    purc_vdom_t vdom = purc_load_hvml_from_string(hvml);
+    ASSERT_NE(vdom, nullptr);
+    ASSERT_NE(purc_schedule_vdom_null(vdom), nullptr);
+    purc_run(NULL);
+
+    purc_variant_t metrics = purc_get_instance_metrics();
+    ASSERT_NE(metrics, nullptr);
+
+    uint64_t nr_allocs = get_frame_pool_counter(metrics, "allocs");
+    uint64_t nr_reused = get_frame_pool_counter(metrics, "reused");
+    ASSERT_GT(nr_allocs, 0U);
+    /* the frames of the iterations are reused */
+    ASSERT_GT(nr_reused, 0U);
+    ASSERT_LE(nr_reused, nr_allocs);
+    ASSERT_EQ(get_frame_pool_counter(metrics, "inUse"), 0U);
+    ASSERT_GT(get_frame_pool_counter(metrics, "peakInUse"), 0U);
+    ASSERT_GT(get_frame_pool_counter(metrics, "cached"), 0U);
+
+    purc_variant_unref(metrics);
+}
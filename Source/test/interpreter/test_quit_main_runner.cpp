@@ -46,6 +46,8 @@ static struct purc_instance_extra_info worker_info = {
     "<html></html>",            // workspace_layout
     0,                          // allow_switching_rdr (since 0.9.18)
     0,                          // allow_scaling_by_denisty
+    NULL,                       // cpu_affinity
+    NULL,                       // numa_node
 };
 
 static const char *cond_names[] = {
@@ -138,6 +140,7 @@ static purc_atom_t start_worker(purc_atom_t curator, purc_vdom_t vdom, int idx,
         "worker transitionStyle",
         toolkit_style,
         "<section></section>",
+        PURC_CRTN_PRIORITY_NORMAL,  // priority
     };
 
     purc_variant_t worker_no = purc_variant_make_number(idx);
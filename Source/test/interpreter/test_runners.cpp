@@ -8,6 +8,8 @@
  *      - purc_get_rid_by_cid()
  *      - purc_inst_ask_to_shutdown()
  *      - purc_schedule_vdom()
+ *      - purc_inst_pool_prepare()/purc_inst_pool_take()
+ *      - the recycling of the runner-level channels of a pooled instance
  *      - Instance Manager/Move Buffer
  *
  * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
@@ -31,6 +33,7 @@
 #undef NDEBUG
 
 #include "purc/purc.h"
+#include "private/channel.h"
 #include "../helpers.h"
 
 #include <gtest/gtest.h>
@@ -47,6 +50,8 @@ static struct purc_instance_extra_info worker_info = {
     "<html></html>",            // workspace_layout
     0,                          // allow_switching_rdr
     0,                          // allow_scaling_by_denisty
+    NULL,                       // cpu_affinity
+    NULL,                       // numa_node
 };
 
 static const char *cond_names[] = {
@@ -139,6 +144,7 @@ static purc_atom_t start_worker(purc_atom_t curator, purc_vdom_t vdom, int idx,
         "worker transitionStyle",
         toolkit_style,
         "<section></section>",
+        PURC_CRTN_PRIORITY_NORMAL,  // priority
     };
 
     purc_variant_t worker_no = purc_variant_make_number(idx);
@@ -226,3 +232,146 @@ TEST(interpreter, runners)
     purc_variant_unref(toolkit_style);
 }
 
+
+static int wait_for_idle_instances(size_t min_idle, size_t max_idle,
+        int expected)
+{
+    int n = -1;
+    for (int i = 0; i < 100; i++) {
+        n = purc_inst_pool_prepare(min_idle, max_idle, NULL, &worker_info);
+        if (n == expected)
+            break;
+        usleep(100000);
+    }
+
+    return n;
+}
+
+TEST(interpreter, inst_pool)
+{
+    struct purc_instance_extra_info inst_info = { };
+    inst_info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+    inst_info.workspace_name = "main";
+
+    PurCInstance purc(PURC_MODULE_HVML, APP_NAME, "main", &inst_info);
+    ASSERT_TRUE(purc);
+
+    /* not prepared yet */
+    ASSERT_EQ(purc_inst_pool_take(), 0);
+
+    ASSERT_EQ(purc_inst_pool_prepare(2, 4, NULL, &worker_info), 2);
+
+    purc_vdom_t vdom = purc_load_hvml_from_string(
+            "<hvml><body><init as=\"pooled\" at=\"_runner\" with=\"yes\" />"
+            "</body></hvml>");
+    ASSERT_NE(vdom, nullptr);
+
+    purc_atom_t inst = purc_inst_pool_take();
+    ASSERT_NE(inst, 0);
+
+    const char *endpoint = purc_atom_to_string(inst);
+    ASSERT_NE(endpoint, nullptr);
+    char run_name[PURC_LEN_RUNNER_NAME + 1];
+    purc_extract_runner_name(endpoint, run_name);
+    ASSERT_EQ(strncmp(run_name, "_inst", 5), 0);
+
+    purc_atom_t cor = purc_inst_schedule_vdom(inst, vdom, 0,
+            PURC_VARIANT_INVALID, PCRDR_PAGE_TYPE_NULL, "main",
+            NULL, NULL, NULL, NULL);
+    ASSERT_NE(cor, 0);
+
+    /* the pool is refilled, and the instance goes back to the pool
+       after the coroutine exited, instead of being cleaned up */
+    ASSERT_EQ(wait_for_idle_instances(2, 4, 3), 3);
+    ASSERT_NE(purc_atom_to_string(inst), nullptr);
+
+    /* the most recently used instance is taken first */
+    ASSERT_EQ(purc_inst_pool_take(), inst);
+    cor = purc_inst_schedule_vdom(inst, vdom, 0,
+            PURC_VARIANT_INVALID, PCRDR_PAGE_TYPE_NULL, "main",
+            NULL, NULL, NULL, NULL);
+    ASSERT_NE(cor, 0);
+    ASSERT_EQ(wait_for_idle_instances(2, 4, 3), 3);
+
+    /* ask all idle instances to shutdown */
+    ASSERT_EQ(purc_inst_pool_prepare(0, 0, NULL, &worker_info), 0);
+
+    unsigned int seconds = 0;
+    while (purc_atom_to_string(inst)) {
+        purc_log_info("Wait for termination of the pooled instance...\n");
+        sleep(1);
+        seconds++;
+        ASSERT_LT(seconds, 10);
+    }
+}
+
+/* the first session leaves a local channel with a queued value behind */
+static const char *leftover_hvml =
+    "<hvml><body>"
+    "  <init as=\"leftover\" with=$RUNNER.chan(! 'leftover', 4) />"
+    "  <inherit with=$RUNNER.chan('leftover').send('stale') />"
+    "  <init as=\"report\" with=$RUNNER.chan(! 'report', 4, 'shared') />"
+    "  <inherit with=$RUNNER.chan('report').send('opened') />"
+    "</body></hvml>";
+
+/* the second session reports only if the channel has gone */
+static const char *check_hvml =
+    "<hvml><body>"
+    "  <init as=\"report\" with=$RUNNER.chan(! 'report', 4, 'shared') />"
+    "  <init as=\"leftover\" with=$RUNNER.chan('leftover') silently />"
+    "  <test with=$DATA.type($leftover) >"
+    "    <match for=\"AS 'undefined'\" exclusively>"
+    "      <inherit with=$RUNNER.chan('report').send('gone') />"
+    "    </match>"
+    "  </test>"
+    "</body></hvml>";
+
+TEST(interpreter, inst_pool_recycle_channels)
+{
+    struct purc_instance_extra_info inst_info = { };
+    inst_info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+    inst_info.workspace_name = "main";
+
+    PurCInstance purc(PURC_MODULE_HVML, APP_NAME, "main", &inst_info);
+    ASSERT_TRUE(purc);
+
+    /* the sessions report to the main instance via a shared channel */
+    pcchan_t report = pcchan_open_shared("report", 4);
+    ASSERT_NE(report, nullptr);
+
+    ASSERT_EQ(purc_inst_pool_prepare(1, 2, NULL, &worker_info), 1);
+
+    purc_vdom_t vdom = purc_load_hvml_from_string(leftover_hvml);
+    ASSERT_NE(vdom, nullptr);
+
+    purc_atom_t inst = purc_inst_pool_take();
+    ASSERT_NE(inst, 0);
+    purc_atom_t cor = purc_inst_schedule_vdom(inst, vdom, 0,
+            PURC_VARIANT_INVALID, PCRDR_PAGE_TYPE_NULL, "main",
+            NULL, NULL, NULL, NULL);
+    ASSERT_NE(cor, 0);
+    ASSERT_EQ(wait_for_idle_instances(1, 2, 2), 2);
+    ASSERT_EQ(pcchan_length(report), 1);
+
+    /* the recycled instance is taken again */
+    vdom = purc_load_hvml_from_string(check_hvml);
+    ASSERT_NE(vdom, nullptr);
+
+    ASSERT_EQ(purc_inst_pool_take(), inst);
+    cor = purc_inst_schedule_vdom(inst, vdom, 0,
+            PURC_VARIANT_INVALID, PCRDR_PAGE_TYPE_NULL, "main",
+            NULL, NULL, NULL, NULL);
+    ASSERT_NE(cor, 0);
+    ASSERT_EQ(wait_for_idle_instances(1, 2, 2), 2);
+    ASSERT_EQ(pcchan_length(report), 2);
+
+    ASSERT_EQ(purc_inst_pool_prepare(0, 0, NULL, &worker_info), 0);
+
+    unsigned int seconds = 0;
+    while (purc_atom_to_string(inst)) {
+        purc_log_info("Wait for termination of the pooled instance...\n");
+        sleep(1);
+        seconds++;
+        ASSERT_LT(seconds, 10);
+    }
+}
@@ -479,6 +479,49 @@ TEST(samples, samples)
     run_tests(samples, PCA_TABLESIZE(samples), 0);
 }
 
+/* the archetypes are compiled to the static pieces and the slots; the values
+   which would change the markup must give the same result as parsing. */
+TEST(samples, archetype_slots)
+{
+    PurCInstance purc(false);
+
+    ASSERT_TRUE(purc);
+
+    struct sample_data samples[] = {
+        {
+            "<!DOCTYPE hvml>"
+            "<hvml target=\"html\">"
+            "<head>"
+            "<init as=\"items\">"
+            "["
+            "{ \"cls\": \"x y\", \"name\": \"first\" },"
+            "{ \"cls\": \"z\", \"name\": \"say \\\"hi\\\"\" },"
+            "{ \"cls\": \"\", \"name\": \"\" }"
+            "]"
+            "</init>"
+            "</head>"
+            "<body>"
+            "<archetype name=\"row\">"
+            "<li class=\"$?.cls\" title=\"$?.name\"><b>$?.name</b> &amp; more</li>"
+            "</archetype>"
+            "<ul><iterate on=\"$items\">"
+            "<update on=\"$@\" to=\"append\" with=\"$row\" />"
+            "</iterate></ul>"
+            "</body>"
+            "</hvml>",
+
+            "<!DOCTYPE html>"
+            "<html><head></head><body><ul>"
+            "<li class=\"x y\" title=\"first\"><b>first</b> &amp; more</li>"
+            "<li class=\"z\" title=\"say \"hi\"\"><b>say \"hi\"</b> &amp; more</li>"
+            "<li class=\"\" title=\"\"><b></b> &amp; more</li>"
+            "</ul></body></html>",
+        },
+    };
+
+    run_tests(samples, PCA_TABLESIZE(samples), 0);
+}
+
 TEST(samples, foo)
 {
     do {
@@ -0,0 +1,129 @@
+/*
+ * @file test_sched_priority.cpp
+ * @date 2026/10/14
+ * @brief The program to test the scheduling of the coroutines by priority.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#include "purc/purc.h"
+#include "private/utils.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+
+#include "../helpers.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/* a busy coroutine which never stops until it has iterated so many times */
+#define BUSY_HVML(n)                                                    \
+    "<!DOCTYPE hvml>"                                                   \
+    "<hvml target=\"void\">"                                            \
+    "  <body>"                                                          \
+    "    <iterate on 0L onlyif $L.lt($0<, " #n "L)"                     \
+    "        with $DATA.arith('+', $0<, 1) nosetotail >"                \
+    "    </iterate>"                                                    \
+    "  </body>"                                                         \
+    "</hvml>"
+
+static const char *long_hvml = BUSY_HVML(20000);
+static const char *short_hvml = BUSY_HVML(500);
+
+static std::vector<std::string> exited;
+
+static int cond_handler(purc_cond_k event, purc_coroutine_t cor, void *data)
+{
+    (void)data;
+
+    if (event == PURC_COND_COR_EXITED) {
+        const char *name = (const char *)purc_coroutine_get_user_data(cor);
+        if (name)
+            exited.push_back(name);
+    }
+
+    return 0;
+}
+
+static bool
+schedule(const char *hvml, int priority, const char *name)
+{
+    purc_vdom_t vdom = purc_load_hvml_from_string(hvml);
+    if (vdom == NULL)
+        return false;
+
+    purc_renderer_extra_info extra_info = {};
+    extra_info.priority = priority;
+
+    purc_coroutine_t cor = purc_schedule_vdom(vdom, 0, PURC_VARIANT_INVALID,
+            PCRDR_PAGE_TYPE_NULL, NULL, NULL, NULL, &extra_info, NULL,
+            (void *)name);
+    return cor != NULL;
+}
+
+static size_t
+exit_order(const char *name)
+{
+    for (size_t i = 0; i < exited.size(); i++) {
+        if (exited[i] == name)
+            return i;
+    }
+
+    return SIZE_MAX;
+}
+
+/* the coroutine of a higher priority gets more time in a round */
+TEST(sched_priority, ordering)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    exited.clear();
+    ASSERT_TRUE(schedule(long_hvml, PURC_CRTN_PRIORITY_NORMAL, "normal"));
+    ASSERT_TRUE(schedule(long_hvml, PURC_CRTN_PRIORITY_HIGH, "high"));
+    purc_run((purc_cond_handler)cond_handler);
+
+    ASSERT_EQ(exited.size(), 2);
+    ASSERT_LT(exit_order("high"), exit_order("normal"));
+
+    const struct pcintr_sched_stat *stat;
+    stat = pcintr_get_sched_stat(pcinst_current(), PURC_CRTN_PRIORITY_HIGH);
+    ASSERT_NE(stat, nullptr);
+    ASSERT_GT(stat->nr_samples, 0);
+}
+
+/* the busy coroutines of a higher priority never starve the others */
+TEST(sched_priority, fairness)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    exited.clear();
+    ASSERT_TRUE(schedule(long_hvml, PURC_CRTN_PRIORITY_HIGH, "high1"));
+    ASSERT_TRUE(schedule(long_hvml, PURC_CRTN_PRIORITY_HIGH, "high2"));
+    ASSERT_TRUE(schedule(short_hvml, PURC_CRTN_PRIORITY_NORMAL, "normal"));
+    purc_run((purc_cond_handler)cond_handler);
+
+    ASSERT_EQ(exited.size(), 3);
+    ASSERT_LT(exit_order("normal"), exit_order("high1"));
+    ASSERT_LT(exit_order("normal"), exit_order("high2"));
+}
@@ -215,6 +215,86 @@ TEST(void_doc, hello)
     purc_run((purc_cond_handler)my_cond_handler);
 }
 
+TEST(void_doc, profiler)
+{
+    PurCInstance purc(false);
+
+    ASSERT_EQ(purc_enable_profiler(true), 0);
+
+    struct sample_data sample = {
+        .input_hvml = hello_hvml,
+        .expected_result = NULL,
+    };
+
+    add_sample(&sample);
+    purc_run((purc_cond_handler)my_cond_handler);
+
+    purc_rwstream_t stm = purc_rwstream_new_buffer(1024, 1024 * 1024);
+    ASSERT_NE(stm, nullptr);
+    ASSERT_EQ(purc_dump_profile(stm, PURC_PROFILE_ALLOCS), 0);
+
+    size_t sz = 0;
+    const char *profile = (const char *)purc_rwstream_get_mem_buffer(stm, &sz);
+    std::string folded(profile, sz);
+    ASSERT_NE(folded.find("hvml;head"), std::string::npos) << folded;
+
+    purc_reset_profile();
+    purc_rwstream_destroy(stm);
+
+    stm = purc_rwstream_new_buffer(1024, 1024 * 1024);
+    ASSERT_EQ(purc_dump_profile(stm, PURC_PROFILE_ALLOCS), 0);
+    purc_rwstream_get_mem_buffer(stm, &sz);
+    ASSERT_EQ(sz, 0U);
+    purc_rwstream_destroy(stm);
+
+    ASSERT_EQ(purc_enable_profiler(false), 0);
+}
+
+static const char *loop_hvml = ""
+"<!DOCTYPE hvml>"
+"<hvml target='void'>"
+"  <body>"
+"    <iterate on 0L onlyif $L.lt($0<, 10L)"
+"        with $DATA.arith('+', $0<, 1) nosetotail >"
+"      <init as 'last' with $? />"
+"    </iterate>"
+"  </body>"
+"</hvml>";
+
+TEST(void_doc, profiler_elements)
+{
+    PurCInstance purc(false);
+
+    ASSERT_EQ(purc_enable_profiler(true), 0);
+
+    struct sample_data sample = {
+        .input_hvml = loop_hvml,
+        .expected_result = NULL,
+    };
+
+    add_sample(&sample);
+    purc_run((purc_cond_handler)my_cond_handler);
+
+    purc_rwstream_t stm = purc_rwstream_new_buffer(1024, 1024 * 1024);
+    ASSERT_NE(stm, nullptr);
+    ASSERT_EQ(purc_dump_profile(stm, PURC_PROFILE_ELEMENTS), 0);
+
+    size_t sz = 0;
+    const char *profile = (const char *)purc_rwstream_get_mem_buffer(stm, &sz);
+    std::string report(profile, sz);
+    purc_rwstream_destroy(stm);
+
+    /* the `init` in the loop is executed once per iteration */
+    size_t pos = report.find("hvml;body;iterate;init ");
+    ASSERT_NE(pos, std::string::npos) << report;
+    size_t bol = report.rfind('\n', pos);
+    unsigned long long nr_execs = 0;
+    ASSERT_EQ(sscanf(report.c_str() + bol + 1, "%llu", &nr_execs), 1);
+    ASSERT_EQ(nr_execs, 10ULL) << report;
+
+    ASSERT_EQ(purc_enable_profiler(false), 0);
+}
+
 TEST(void_doc, files)
 {
     PurCInstance purc(false);
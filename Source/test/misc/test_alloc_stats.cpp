@@ -0,0 +1,345 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The allocation regression tests of the hot paths: the variant creation,
+ * the JSON parsing, and the scheduler steps. Every case counts the
+ * allocations of a fixed workload and compares them with the baseline
+ * stored in alloc-baselines.json; it fails if any counter grows beyond
+ * the threshold.
+ *
+ * The allocations are counted only if PurC is built with ENABLE_ALLOC_STATS;
+ * otherwise the cases are skipped. In such a build, a case without baseline
+ * fails, so a hot path can not lose its check silently.
+ *
+ * Environment variables:
+ *  - PURC_TEST_ALLOC_BASELINES: the path to the baseline file; the one
+ *    beside this file by default.
+ *  - PURC_TEST_ALLOC_THRESHOLD: the threshold in percent (10 by default).
+ *  - PURC_TEST_ALLOC_UPDATE: write the baselines with the current counters
+ *    to the path given by PURC_TEST_ALLOC_BASELINES, or to
+ *    alloc-baselines.json in the working directory (the build directory
+ *    under ctest); the file in the source tree is never written.
+ *
+ * To record or refresh the baselines after an intended change:
+ *
+ *  $ cmake <source-dir> -DENABLE_ALLOC_STATS=ON
+ *  $ make test_alloc_stats
+ *  $ PURC_TEST_ALLOC_UPDATE=1 ./Source/test/misc/test_alloc_stats
+ *  $ cp alloc-baselines.json <source-dir>/Source/test/misc/
+ *
+ * Record them with a build of the same type as the one running the tests,
+ * since the counters depend on the build type and on the C library.
+ */
+
+#include "purc/purc.h"
+#include "private/mem.h"
+#include "private/variant.h"
+
+#include "../helpers.h"
+
+#include <string>
+#include <map>
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <libgen.h>
+#include <gtest/gtest.h>
+
+#define BASELINES_ENV       "PURC_TEST_ALLOC_BASELINES"
+#define BASELINES_FILE      "alloc-baselines.json"
+#define THRESHOLD_ENV       "PURC_TEST_ALLOC_THRESHOLD"
+#define UPDATE_ENV          "PURC_TEST_ALLOC_UPDATE"
+
+#define DEF_THRESHOLD       10.0
+
+struct alloc_sample {
+    double allocs;
+    double bytes;
+    double variants;
+};
+
+static std::map<std::string, alloc_sample> baselines;
+static bool baselines_loaded;
+static char baselines_path[PATH_MAX + 1];
+
+static double get_number(purc_variant_t obj, const char *key)
+{
+    double d = 0;
+    purc_variant_t v = purc_variant_object_get_by_ckey(obj, key);
+    if (v)
+        purc_variant_cast_to_number(v, &d, false);
+    return d;
+}
+
+static void load_baselines(void)
+{
+    if (baselines_loaded)
+        return;
+    baselines_loaded = true;
+
+    test_getpath_from_env_or_rel(baselines_path, sizeof(baselines_path),
+            BASELINES_ENV, BASELINES_FILE);
+
+    size_t len;
+    char *json = purc_load_file_contents(baselines_path, &len);
+    if (json == NULL)
+        return;
+
+    purc_variant_t root = purc_variant_make_from_json_string(json, len);
+    free(json);
+    if (root == PURC_VARIANT_INVALID || !purc_variant_is_object(root)) {
+        if (root)
+            purc_variant_unref(root);
+        return;
+    }
+
+    purc_variant_t k, v;
+    foreach_key_value_in_variant_object(root, k, v)
+        alloc_sample sample;
+        sample.allocs = get_number(v, "allocs");
+        sample.bytes = get_number(v, "bytes");
+        sample.variants = get_number(v, "variants");
+        baselines[purc_variant_get_string_const(k)] = sample;
+    end_foreach;
+
+    purc_variant_unref(root);
+}
+
+static const char *get_output_path(void)
+{
+    const char *path = getenv(BASELINES_ENV);
+    return path ? path : BASELINES_FILE;
+}
+
+static bool save_baselines(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL)
+        return false;
+
+    fprintf(fp, "{");
+    bool first = true;
+    for (const auto &it : baselines) {
+        fprintf(fp, "%s\n  \"%s\": {\"allocs\": %.1f, \"bytes\": %.1f, "
+                "\"variants\": %.1f}", first ? "" : ",", it.first.c_str(),
+                it.second.allocs, it.second.bytes, it.second.variants);
+        first = false;
+    }
+    fprintf(fp, "\n}\n");
+    fclose(fp);
+    return true;
+}
+
+static void check_counter(const char *name, const char *counter,
+        double current, double baseline, double threshold)
+{
+    double limit = baseline * (1 + threshold / 100);
+    EXPECT_LE(current, limit) << name << ": " << counter << " grew from "
+        << baseline << " to " << current << " (threshold: " << threshold
+        << "%)";
+}
+
+static void check_baseline(const char *name, const alloc_sample &current)
+{
+    load_baselines();
+
+    PRINTF("%s: %.1f allocations, %.1f bytes, %.1f variants\n", name,
+            current.allocs, current.bytes, current.variants);
+
+    if (test_getbool_from_env_or_default(UPDATE_ENV, false)) {
+        const char *path = get_output_path();
+        baselines[name] = current;
+        ASSERT_TRUE(save_baselines(path)) << "Failed to write " << path;
+        PRINTF("%s: baseline recorded in %s\n", name, path);
+        return;
+    }
+
+    auto it = baselines.find(name);
+    if (it == baselines.end()) {
+        FAIL() << "No baseline for " << name << " in " << baselines_path
+            << "; run with " UPDATE_ENV "=1 to record one";
+    }
+
+    double threshold = DEF_THRESHOLD;
+    const char *env = getenv(THRESHOLD_ENV);
+    if (env)
+        threshold = strtod(env, NULL);
+
+    check_counter(name, "allocations", current.allocs, it->second.allocs,
+            threshold);
+    check_counter(name, "bytes", current.bytes, it->second.bytes, threshold);
+    check_counter(name, "variants", current.variants, it->second.variants,
+            threshold);
+}
+
+static alloc_sample diff(const struct pcutils_alloc_stat &from,
+        const struct pcutils_alloc_stat &to, double divisor = 1)
+{
+    alloc_sample sample;
+    sample.allocs = (to.nr_allocs - from.nr_allocs) / divisor;
+    sample.bytes = (to.sz_allocs - from.sz_allocs) / divisor;
+    sample.variants = (to.nr_variants - from.nr_variants) / divisor;
+    return sample;
+}
+
+static void make_variants(void)
+{
+    purc_variant_t array = purc_variant_make_array_0();
+    purc_variant_t object = purc_variant_make_object_0();
+
+    for (int i = 0; i < 100; i++) {
+        char key[32];
+        snprintf(key, sizeof(key), "key-%d", i);
+
+        purc_variant_t v = purc_variant_make_longint(i);
+        purc_variant_array_append(array, v);
+        purc_variant_unref(v);
+
+        v = purc_variant_make_string(key, false);
+        purc_variant_object_set_by_ckey(object, key, v);
+        purc_variant_unref(v);
+
+        v = purc_variant_make_string("a string longer than the space "
+                "in the variant structure", false);
+        purc_variant_array_append(array, v);
+        purc_variant_unref(v);
+    }
+
+    purc_variant_unref(array);
+    purc_variant_unref(object);
+}
+
+TEST(alloc_stats, variant_creation)
+{
+    PurCInstance purc(PURC_MODULE_VARIANT, APP_NAME, "alloc_stats");
+    ASSERT_TRUE(purc);
+
+    struct pcutils_alloc_stat from, to;
+    if (!pcutils_alloc_stat_get(&from))
+        GTEST_SKIP() << "PurC is not built with ENABLE_ALLOC_STATS";
+
+    /* warm up the reserved variants and the slabs */
+    make_variants();
+
+    pcutils_alloc_stat_get(&from);
+    make_variants();
+    pcutils_alloc_stat_get(&to);
+
+    check_baseline("variant_creation", diff(from, to));
+}
+
+static const char json_doc[] =
+    "{"
+    "  \"name\": \"PurC\","
+    "  \"version\": [0, 9, 22],"
+    "  \"features\": {\"html\": true, \"xml\": false, \"ratio\": 0.75},"
+    "  \"items\": ["
+    "    {\"id\": 1, \"tags\": [\"a\", \"b\"], \"text\": \"The first item\"},"
+    "    {\"id\": 2, \"tags\": [\"c\"], \"text\": \"The second item\"},"
+    "    {\"id\": 3, \"tags\": [], \"text\": \"The third item with a "
+    "longer text to be stored out of the variant structure\"}"
+    "  ],"
+    "  \"nothing\": null"
+    "}";
+
+static void parse_json(void)
+{
+    for (int i = 0; i < 100; i++) {
+        purc_variant_t v = purc_variant_make_from_json_string(json_doc,
+                sizeof(json_doc) - 1);
+        ASSERT_NE(v, PURC_VARIANT_INVALID);
+        purc_variant_unref(v);
+    }
+}
+
+TEST(alloc_stats, json_parse)
+{
+    PurCInstance purc(PURC_MODULE_EJSON, APP_NAME, "alloc_stats");
+    ASSERT_TRUE(purc);
+
+    struct pcutils_alloc_stat from, to;
+    if (!pcutils_alloc_stat_get(&from))
+        GTEST_SKIP() << "PurC is not built with ENABLE_ALLOC_STATS";
+
+    parse_json();
+
+    pcutils_alloc_stat_get(&from);
+    parse_json();
+    pcutils_alloc_stat_get(&to);
+
+    check_baseline("json_parse", diff(from, to));
+}
+
+static const char hvml_program[] =
+    "<!DOCTYPE hvml>"
+    "<hvml target=\"void\">"
+    "  <body>"
+    "    <iterate on 0L onlyif $L.lt($0<, 100L)"
+    "        with $DATA.arith('+', $0<, 1) nosetotail >"
+    "      <test with $DATA.arith('%', $?, 2) >"
+    "        <init as \"odd\" with $? />"
+    "      </test>"
+    "    </iterate>"
+    "    <exit with 100L />"
+    "  </body>"
+    "</hvml>";
+
+static uint64_t get_nr_steps(void)
+{
+    uint64_t nr_steps = 0;
+    purc_variant_t metrics = purc_get_instance_metrics();
+    if (metrics) {
+        purc_variant_t v = purc_variant_object_get_by_ckey(metrics, "steps");
+        if (v)
+            purc_variant_cast_to_ulongint(v, &nr_steps, false);
+        purc_variant_unref(metrics);
+    }
+
+    return nr_steps;
+}
+
+TEST(alloc_stats, scheduler_step)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    struct pcutils_alloc_stat from, to;
+    if (!pcutils_alloc_stat_get(&from))
+        GTEST_SKIP() << "PurC is not built with ENABLE_ALLOC_STATS";
+
+    purc_vdom_t vdom = purc_load_hvml_from_string(hvml_program);
+    ASSERT_NE(vdom, nullptr);
+
+    /* warm up the scheduler */
+    ASSERT_NE(purc_schedule_vdom_null(vdom), nullptr);
+    purc_run(NULL);
+
+    uint64_t nr_steps = get_nr_steps();
+    pcutils_alloc_stat_get(&from);
+    ASSERT_NE(purc_schedule_vdom_null(vdom), nullptr);
+    purc_run(NULL);
+    pcutils_alloc_stat_get(&to);
+    nr_steps = get_nr_steps() - nr_steps;
+    ASSERT_GT(nr_steps, 0UL);
+
+    /* the allocations per step */
+    check_baseline("scheduler_step", diff(from, to, nr_steps));
+}
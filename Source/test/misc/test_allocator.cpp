@@ -0,0 +1,192 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The tests of the allocator set by purc_set_allocator(); they run in
+ * their own program, for the allocator can only be set before the first
+ * instance is initialized in the process.
+ */
+
+#include "purc/purc.h"
+#include "private/mem.h"
+
+#include "../helpers.h"
+
+#include <atomic>
+
+#include <stdlib.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <gtest/gtest.h>
+
+static std::atomic<size_t> nr_mallocs;
+static std::atomic<size_t> nr_frees;
+static std::atomic<void *> last_ctxt;
+
+static int default_ctxt;
+
+static void *test_malloc(void *ctxt, size_t size)
+{
+    last_ctxt = ctxt;
+    nr_mallocs++;
+    return malloc(size);
+}
+
+static void *test_realloc(void *ctxt, void *ptr, size_t size)
+{
+    last_ctxt = ctxt;
+    nr_mallocs++;
+    return realloc(ptr, size);
+}
+
+static void test_free(void *ctxt, void *ptr)
+{
+    last_ctxt = ctxt;
+    if (ptr)
+        nr_frees++;
+    free(ptr);
+}
+
+#if defined(__GLIBC__)
+static size_t test_size(void *ctxt, const void *ptr)
+{
+    (void)ctxt;
+    return malloc_usable_size((void *)ptr);
+}
+#endif
+
+static void install_allocator(void)
+{
+    static bool installed;
+    if (installed)
+        return;
+
+    purc_allocator allocator = { };
+    allocator.malloc = test_malloc;
+    allocator.realloc = test_realloc;
+    allocator.free = test_free;
+#if defined(__GLIBC__)
+    allocator.size = test_size;
+#endif
+    allocator.ctxt = &default_ctxt;
+
+    /* the mandatory hooks must be given */
+    purc_allocator incomplete = allocator;
+    incomplete.free = NULL;
+    ASSERT_FALSE(purc_set_allocator(&incomplete));
+
+    ASSERT_TRUE(purc_set_allocator(&allocator));
+    installed = true;
+}
+
+static double get_number(purc_variant_t obj, const char *key)
+{
+    double d = 0;
+    purc_variant_t v = purc_variant_object_get_by_ckey(obj, key);
+    if (v)
+        purc_variant_cast_to_number(v, &d, false);
+    return d;
+}
+
+TEST(allocator, variants)
+{
+    install_allocator();
+
+    PurCInstance purc(PURC_MODULE_VARIANT, APP_NAME, "allocator");
+    ASSERT_TRUE(purc);
+
+    /* the allocator can not be changed once an instance is initialized */
+    ASSERT_FALSE(purc_set_allocator(NULL));
+
+    size_t mallocs = nr_mallocs, frees = nr_frees;
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    for (int i = 0; i < 100; i++) {
+        purc_variant_t v = purc_variant_make_number(i);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    ASSERT_NE(obj, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_object_set_by_static_ckey(obj, "arr", arr));
+
+    ASSERT_GT(nr_mallocs, mallocs);
+    ASSERT_EQ(last_ctxt, &default_ctxt);
+
+    purc_variant_unref(arr);
+    purc_variant_unref(obj);
+    ASSERT_GT(nr_frees, frees);
+}
+
+TEST(allocator, thread_context)
+{
+    install_allocator();
+
+    PurCInstance purc(PURC_MODULE_VARIANT, APP_NAME, "allocator");
+    ASSERT_TRUE(purc);
+
+    int arena;
+    ASSERT_EQ(purc_set_allocator_context(&arena), nullptr);
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    ASSERT_EQ(last_ctxt, &arena);
+    purc_variant_unref(arr);
+
+    ASSERT_EQ(purc_set_allocator_context(NULL), &arena);
+
+    arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    ASSERT_EQ(last_ctxt, &default_ctxt);
+    purc_variant_unref(arr);
+}
+
+TEST(allocator, metrics)
+{
+    install_allocator();
+
+    PurCInstance purc(PURC_MODULE_HVML, APP_NAME, "allocator");
+    ASSERT_TRUE(purc);
+
+    struct pcutils_allocator_stat from, to;
+    ASSERT_TRUE(pcutils_allocator_stat_get(&from));
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    purc_variant_unref(arr);
+
+    ASSERT_TRUE(pcutils_allocator_stat_get(&to));
+    ASSERT_GT(to.nr_allocs, from.nr_allocs);
+    ASSERT_GT(to.nr_frees, from.nr_frees);
+#if defined(__GLIBC__)
+    ASSERT_GT(to.sz_allocated, from.sz_allocated);
+#endif
+
+    purc_variant_t metrics = purc_get_instance_metrics();
+    ASSERT_NE(metrics, PURC_VARIANT_INVALID);
+    purc_variant_t stat = purc_variant_object_get_by_ckey(metrics,
+            "allocator");
+    ASSERT_NE(stat, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_is_object(stat));
+    ASSERT_GE(get_number(stat, "allocs"), (double)to.nr_allocs);
+    purc_variant_unref(metrics);
+}
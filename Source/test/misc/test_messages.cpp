@@ -18,6 +18,7 @@
 */
 
 #include "purc/purc.h"
+#include "private/pcrdr.h"
 
 #include <stdio.h>
 #include <errno.h>
@@ -93,3 +94,109 @@ TEST(instance, messages)
     purc_cleanup();
 }
 
+
+TEST(instance, binary_messages)
+{
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, NULL, NULL, NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    pcrdr_msg *msgs[2];
+    msgs[0] = pcrdr_make_request_message(PCRDR_MSG_TARGET_DOM,
+            random(), "update", NULL, "request-id",
+            PCRDR_MSG_ELEMENT_TYPE_HANDLE, "8f00", "textContent",
+            PCRDR_MSG_DATA_TYPE_JSON, "{\"a\":1, \"b\":[true, \"str\"]}", 0);
+    msgs[1] = pcrdr_make_response_message("request-id", NULL,
+            PCRDR_SC_OK, random(), PCRDR_MSG_DATA_TYPE_PLAIN, "The data", 0);
+
+    for (size_t i = 0; i < sizeof(msgs) / sizeof(msgs[0]); i++) {
+        pcrdr_msg *msg_parsed = NULL;
+        struct buff_info info = { buffer_a, sizeof (buffer_a), 0 };
+
+        ret = pcrdr_serialize_message_binary(msgs[i], write_to_buf, &info);
+        ASSERT_EQ(ret, 0);
+        ASSERT_TRUE(pcrdr_is_binary_packet(buffer_a, info.pos));
+
+        ret = pcrdr_parse_binary_packet(buffer_a, info.pos, &msg_parsed);
+        ASSERT_EQ(ret, 0);
+
+        if (msgs[i]->dataType == PCRDR_MSG_DATA_TYPE_JSON) {
+            /* pcrdr_compare_messages() only compares the string data */
+            ASSERT_TRUE(purc_variant_is_equal_to(msgs[i]->data,
+                        msg_parsed->data));
+            purc_variant_unref(msg_parsed->data);
+            msg_parsed->data = purc_variant_ref(msgs[i]->data);
+        }
+
+        ret = pcrdr_compare_messages(msgs[i], msg_parsed);
+        ASSERT_EQ(ret, 0);
+
+        /* a truncated packet */
+        pcrdr_msg *msg_bad = NULL;
+        ret = pcrdr_parse_binary_packet(buffer_a, info.pos - 1, &msg_bad);
+        ASSERT_EQ(ret, -1);
+
+        pcrdr_release_message(msg_parsed);
+        pcrdr_release_message(msgs[i]);
+    }
+
+    purc_cleanup();
+}
+
+TEST(instance, compressed_packets)
+{
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, NULL, NULL, NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    std::string html("<html><body>");
+    while (html.length() < PCRDR_MIN_SIZE_COMPRESSION)
+        html += "<p class=\"para\">Hello, world!</p>";
+    html += "</body></html>";
+
+    pcrdr_msg *msg = pcrdr_make_request_message(PCRDR_MSG_TARGET_DOM,
+            random(), "load", NULL, "request-id",
+            PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+            PCRDR_MSG_DATA_TYPE_HTML, html.c_str(), html.length());
+
+    char *packet = NULL;
+    size_t sz_packet = 0;
+    purc_rwstream_t stm = purc_rwstream_new_buffer(PCRDR_MIN_PACKET_BUFF_SIZE,
+            PCRDR_MAX_INMEM_PAYLOAD_SIZE);
+    ret = pcrdr_serialize_message(msg, (pcrdr_cb_write)purc_rwstream_write,
+            stm);
+    ASSERT_EQ(ret, 0);
+    packet = (char *)purc_rwstream_get_mem_buffer(stm, &sz_packet);
+    ASSERT_FALSE(pcrdr_is_compressed_packet(packet, sz_packet));
+
+    size_t sz_compressed = 0;
+    void *compressed = pcrdr_compress_packet(packet, sz_packet,
+            &sz_compressed);
+    ASSERT_NE(compressed, nullptr);
+    ASSERT_LT(sz_compressed, sz_packet);
+    ASSERT_TRUE(pcrdr_is_compressed_packet(compressed, sz_compressed));
+
+    size_t sz_original = 0;
+    char *original = pcrdr_decompress_packet(compressed, sz_compressed,
+            &sz_original);
+    ASSERT_NE(original, nullptr);
+    ASSERT_EQ(sz_original, sz_packet);
+    ASSERT_EQ(memcmp(original, packet, sz_packet), 0);
+
+    pcrdr_msg *msg_parsed = NULL;
+    ret = pcrdr_parse_packet(original, sz_original, &msg_parsed);
+    ASSERT_EQ(ret, 0);
+    ret = pcrdr_compare_messages(msg, msg_parsed);
+    ASSERT_EQ(ret, 0);
+    pcrdr_release_message(msg_parsed);
+    free(original);
+
+    /* a truncated packet */
+    original = pcrdr_decompress_packet(compressed, sz_compressed - 1,
+            &sz_original);
+    ASSERT_EQ(original, nullptr);
+
+    free(compressed);
+    purc_rwstream_destroy(stm);
+    pcrdr_release_message(msg);
+
+    purc_cleanup();
+}
@@ -0,0 +1,297 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+#
+# This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Records the performance of the test programs, and compares two records.
+
+    perf_tests.py record <dataset.json> <test_program> [args ...]
+
+        Runs the test program PERF_REPEAT times (3 by default), and merges
+        the wall time, the CPU time, and the peak RSS of every run, along
+        with the time of every gtest case, into the dataset. The exit code
+        is the one of the first run. This is what `run_all_tests.sh` calls
+        when PERF_RECORD is set.
+
+    perf_tests.py compare [options] <baseline.json> <current.json>
+
+        Reports the test programs and the gtest cases which got slower
+        significantly: the mean grows by more than `--min-ratio` (5% by
+        default), and Welch's t-test rejects the equality of the means
+        at the level of `--alpha` (0.05 by default). Exits with 1 if any
+        slowdown is found.
+"""
+
+import json
+import math
+import os
+import platform
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+DATASET_VERSION = 1
+
+
+def load_dataset(path):
+    try:
+        with open(path) as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return None
+
+
+def new_dataset():
+    commit = None
+    try:
+        commit = subprocess.run(['git', 'rev-parse', 'HEAD'],
+                capture_output=True, text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        pass
+
+    return {
+        'version': DATASET_VERSION,
+        'date': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+        'host': platform.node(),
+        'machine': platform.machine(),
+        'commit': commit,
+        'programs': {},
+    }
+
+
+def load_gtest_cases(path, cases):
+    """Appends the time in milliseconds of every case in a gtest JSON file."""
+    report = load_dataset(path)
+    if not report:
+        return
+
+    for suite in report.get('testsuites', []):
+        for case in suite.get('testsuite', []):
+            if case.get('status') != 'RUN' or case.get('result') == 'SKIPPED':
+                continue
+            name = suite['name'] + '.' + case['name']
+            # the time is given as "0.012s"
+            secs = float(case.get('time', '0s').rstrip('s'))
+            cases.setdefault(name, []).append(secs * 1000)
+
+
+def run_once(argv, record):
+    fd, gtest_json = tempfile.mkstemp(suffix='.json')
+    os.close(fd)
+    env = dict(os.environ, GTEST_OUTPUT='json:' + gtest_json)
+
+    usage = resource.getrusage(resource.RUSAGE_CHILDREN)
+    start = time.monotonic()
+    result = subprocess.call(argv, env=env)
+    wall = time.monotonic() - start
+    if result < 0:
+        # killed by a signal; report it as the shell does
+        result = 128 - result
+    after = resource.getrusage(resource.RUSAGE_CHILDREN)
+
+    record['wall'].append(wall)
+    record['cpu'].append((after.ru_utime - usage.ru_utime) +
+            (after.ru_stime - usage.ru_stime))
+    # NOTE: ru_maxrss of the children is the maximum of all children so far;
+    # run the program in a fresh process for every run to get its own.
+    record['maxrss'].append(after.ru_maxrss)
+
+    load_gtest_cases(gtest_json, record['cases'])
+    os.unlink(gtest_json)
+    return result
+
+
+def cmd_record(args):
+    if len(args) < 2:
+        sys.exit(__doc__)
+
+    dataset_path, argv = args[0], args[1:]
+    if argv[0] == '--child':
+        # run in a fresh process, so that ru_maxrss is of this run only
+        record = {'wall': [], 'cpu': [], 'maxrss': [], 'cases': {}}
+        result = run_once(argv[1:], record)
+        with open(dataset_path, 'w') as f:
+            json.dump(record, f)
+        return result
+
+    repeat = int(os.environ.get('PERF_REPEAT', '3'))
+    record = {'wall': [], 'cpu': [], 'maxrss': [], 'cases': {}, 'result': 0}
+    for i in range(repeat):
+        fd, run_path = tempfile.mkstemp(suffix='.json')
+        os.close(fd)
+        result = subprocess.call([sys.executable, __file__, 'record',
+                run_path, '--child'] + argv)
+        run = load_dataset(run_path) or {}
+        os.unlink(run_path)
+
+        for key in ('wall', 'cpu', 'maxrss'):
+            record[key] += run.get(key, [])
+        for name, samples in run.get('cases', {}).items():
+            record['cases'].setdefault(name, []).extend(samples)
+
+        if i == 0:
+            record['result'] = result
+
+    dataset = load_dataset(dataset_path) or new_dataset()
+    dataset['programs'][os.path.normpath(argv[0])] = record
+    with open(dataset_path, 'w') as f:
+        json.dump(dataset, f, indent=1, sort_keys=True)
+
+    return record['result']
+
+
+def mean(samples):
+    return sum(samples) / len(samples)
+
+
+def variance(samples):
+    m = mean(samples)
+    return sum((x - m) ** 2 for x in samples) / (len(samples) - 1)
+
+
+def betacf(a, b, x):
+    """The continued fraction of the incomplete beta function."""
+    qab, qap, qam = a + b, a + 1, a - 1
+    c, d = 1.0, 1 - qab * x / qap
+    d = 1 / (d if abs(d) > 1e-30 else 1e-30)
+    h = d
+    for m in range(1, 200):
+        m2 = 2 * m
+        aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+        d = 1 + aa * d
+        d = 1 / (d if abs(d) > 1e-30 else 1e-30)
+        c = 1 + aa / c
+        c = c if abs(c) > 1e-30 else 1e-30
+        h *= d * c
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+        d = 1 + aa * d
+        d = 1 / (d if abs(d) > 1e-30 else 1e-30)
+        c = 1 + aa / c
+        c = c if abs(c) > 1e-30 else 1e-30
+        delta = d * c
+        h *= delta
+        if abs(delta - 1) < 3e-12:
+            break
+    return h
+
+
+def betai(a, b, x):
+    """The regularized incomplete beta function I_x(a, b)."""
+    if x <= 0:
+        return 0.0
+    if x >= 1:
+        return 1.0
+    bt = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) +
+            a * math.log(x) + b * math.log(1 - x))
+    if x < (a + 1) / (a + b + 2):
+        return bt * betacf(a, b, x) / a
+    return 1 - bt * betacf(b, a, 1 - x) / b
+
+
+def welch_p_value(old, new):
+    """The one-sided p-value of Welch's t-test for mean(new) > mean(old)."""
+    if len(old) < 2 or len(new) < 2:
+        return None
+
+    vo, vn = variance(old) / len(old), variance(new) / len(new)
+    if vo + vn == 0:
+        return 0.0 if mean(new) > mean(old) else 1.0
+
+    t = (mean(new) - mean(old)) / math.sqrt(vo + vn)
+    df = (vo + vn) ** 2 / (vo ** 2 / (len(old) - 1) + vn ** 2 / (len(new) - 1))
+    p_two = betai(df / 2, 0.5, df / (df + t * t))
+    return p_two / 2 if t > 0 else 1 - p_two / 2
+
+
+def check(name, metric, old, new, opts, slowdowns):
+    if not old or not new:
+        return
+
+    mo, mn = mean(old), mean(new)
+    if mo <= 0 or mn <= mo * (1 + opts['min_ratio']):
+        return
+
+    p = welch_p_value(old, new)
+    if p is None or p >= opts['alpha']:
+        return
+
+    slowdowns.append((mn / mo - 1, name, metric, mo, mn, p))
+
+
+def cmd_compare(args):
+    opts = {'min_ratio': 0.05, 'alpha': 0.05}
+    paths = []
+    while args:
+        arg = args.pop(0)
+        if arg == '--min-ratio':
+            opts['min_ratio'] = float(args.pop(0))
+        elif arg == '--alpha':
+            opts['alpha'] = float(args.pop(0))
+        else:
+            paths.append(arg)
+
+    if len(paths) != 2:
+        sys.exit(__doc__)
+
+    baseline, current = load_dataset(paths[0]), load_dataset(paths[1])
+    if baseline is None or current is None:
+        sys.exit('Failed to load the datasets')
+
+    slowdowns = []
+    for prog, new in sorted(current['programs'].items()):
+        old = baseline['programs'].get(prog)
+        if old is None:
+            continue
+
+        check(prog, 'wall', old['wall'], new['wall'], opts, slowdowns)
+        check(prog, 'cpu', old['cpu'], new['cpu'], opts, slowdowns)
+        check(prog, 'maxrss', old['maxrss'], new['maxrss'], opts, slowdowns)
+        for case, samples in sorted(new['cases'].items()):
+            check(prog + ':' + case, 'time', old['cases'].get(case),
+                    samples, opts, slowdowns)
+
+    print('Baseline: %s (%s)' % (baseline.get('commit'), baseline.get('date')))
+    print('Current:  %s (%s)' % (current.get('commit'), current.get('date')))
+    if baseline.get('host') != current.get('host'):
+        print('WARNING: the datasets were recorded on different hosts')
+
+    if not slowdowns:
+        print('No significant slowdown found.')
+        return 0
+
+    print('%8s  %-7s %12s %12s %8s  %s' % ('slower', 'metric', 'baseline',
+            'current', 'p', 'test'))
+    for ratio, name, metric, mo, mn, p in sorted(slowdowns, reverse=True):
+        print('%7.1f%%  %-7s %12.3f %12.3f %8.4f  %s' % (ratio * 100, metric,
+                mo, mn, p, name))
+    return 1
+
+
+def main():
+    if len(sys.argv) < 2 or sys.argv[1] not in ('record', 'compare'):
+        sys.exit(__doc__)
+
+    if sys.argv[1] == 'record':
+        return cmd_record(sys.argv[2:])
+    return cmd_compare(sys.argv[2:])
+
+
+if __name__ == '__main__':
+    sys.exit(main())
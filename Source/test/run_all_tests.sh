@@ -5,6 +5,12 @@ export PURC_DVOBJS_PATH=`pwd`/lib
 
 SHOW_STDERR=${SHOW_STDERR:-0}
 USE_VALGRIND=${USE_VALGRIND:-0}
+# Set PERF_RECORD to a JSON file to record the wall time, the CPU time, and
+# the peak RSS of every test program, and the time of every gtest case;
+# PERF_REPEAT gives the runs per program (3 by default). Compare two records
+# with `Source/test/perf_tests.py compare <baseline.json> <current.json>`.
+PERF_RECORD=${PERF_RECORD:-}
+PERF_TESTS="python3 `dirname $0`/perf_tests.py record ${PERF_RECORD}"
 TEST_PROGS=`find ${1:-Source/test} -name test_* -perm -0111 -type f`
 VALGRIND="valgrind --leak-check=full --num-callers=100 --error-exitcode=1"
 VALGRIND="${VALGRIND} --exit-on-first-error=yes"
@@ -22,17 +28,23 @@ test_crashed=""
 
 truncate -s 0 /var/tmp/purc-tests.log
 
+if test -n "$PERF_RECORD"; then
+    rm -f $PERF_RECORD
+else
+    PERF_TESTS=""
+fi
+
 for x in $TEST_PROGS; do
     echo ">> Start of $x"
     if test $USE_VALGRIND -eq 0; then
         if test $SHOW_STDERR -eq 0; then
             echo ">> STDERR OF $x" >> /var/tmp/purc-tests.log
-            ./$x 2>> /var/tmp/purc-tests.log
+            ${PERF_TESTS} ./$x 2>> /var/tmp/purc-tests.log
             RESULT=$?
             echo "<< END OF STDERR OF $x" >> /var/tmp/purc-tests.log
             echo "" >> /var/tmp/purc-tests.log
         else
-            ./$x
+            ${PERF_TESTS} ./$x
             RESULT=$?
         fi
     else
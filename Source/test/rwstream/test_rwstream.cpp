@@ -26,6 +26,9 @@
 #include <stdio.h>
 #include <errno.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -336,6 +339,35 @@ TEST(mem_rwstream, new_destroy)
     ASSERT_EQ(ret, 0);
 }
 
+static void release_mem(void *ctxt, void *mem, size_t sz)
+{
+    char **released = (char **)ctxt;
+    *released = (char *)mem;
+    memset(mem, 0, sz);
+}
+
+TEST(mem_rwstream, release)
+{
+    char buf[] = "This is test file. 这是测试文件。";
+    size_t buf_len = strlen(buf);
+    char *released = NULL;
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mem_ex (buf, buf_len,
+            release_mem, &released);
+    ASSERT_NE(rws, nullptr);
+
+    size_t sz = 0;
+    char* mem_buffer = (char*)purc_rwstream_get_mem_buffer (rws, &sz);
+    ASSERT_EQ(mem_buffer, buf);
+    ASSERT_EQ(sz, buf_len);
+    ASSERT_EQ(released, nullptr);
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(released, buf);
+    ASSERT_EQ(buf[0], 0);
+}
+
 TEST(mem_rwstream, read_char)
 {
     char buf[] = "This is test file. 这是测试文件。";
@@ -564,6 +596,40 @@ TEST(mem_rwstream, seek_read)
     ASSERT_EQ(ret, 0);
 }
 
+/* test mmap rwstream */
+TEST(mmap_rwstream, read_seek)
+{
+    char tmp_file[] = "/tmp/rwstream_mmap.txt";
+    char buf[] = "This is test file. 这是测试文件。";
+    size_t buf_len = strlen(buf);
+    create_temp_file(tmp_file, buf, buf_len);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mmap(tmp_file);
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[64] = {0};
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, sizeof(read_buf)),
+            (ssize_t)buf_len);
+    ASSERT_STREQ(read_buf, buf);
+    ASSERT_EQ(purc_rwstream_write(rws, "x", 1), -1);
+
+    ASSERT_EQ(purc_rwstream_seek(rws, 5, SEEK_SET), 5);
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 2), 2);
+    ASSERT_EQ(0, strncmp(read_buf, "is", 2));
+
+    ASSERT_EQ(purc_rwstream_destroy(rws), 0);
+
+    create_temp_file(tmp_file, buf, 0);
+    rws = purc_rwstream_new_from_mmap(tmp_file);
+    ASSERT_NE(rws, nullptr);
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, sizeof(read_buf)), 0);
+    ASSERT_EQ(purc_rwstream_destroy(rws), 0);
+    remove_temp_file(tmp_file);
+
+    ASSERT_EQ(purc_rwstream_new_from_mmap("/tmp"), nullptr);
+    ASSERT_EQ(purc_rwstream_new_from_mmap("/tmp/not-existing-file"), nullptr);
+}
+
 /* test buffer rwstream */
 TEST(buffer_rwstream, new_destroy)
 {
@@ -671,6 +737,40 @@ TEST(buffer_rwstream, extend_memory)
 }
 
 
+TEST(buffer_rwstream, chunked_growth)
+{
+    char buf[] = "This is test file. 这是测试文件。";
+    size_t buf_len = strlen(buf);
+    std::string expected;
+
+    purc_rwstream_t rws = purc_rwstream_new_buffer (0, 0);
+    ASSERT_NE(rws, nullptr);
+
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_EQ(purc_rwstream_write (rws, buf, buf_len), (ssize_t)buf_len);
+        expected += buf;
+    }
+    ASSERT_EQ(purc_rwstream_tell (rws), (off_t)expected.size());
+
+    /* overwrite in the middle after the chunks are flattened */
+    ASSERT_EQ(purc_rwstream_seek (rws, 5, SEEK_SET), 5);
+    ASSERT_EQ(purc_rwstream_write (rws, "IS", 2), 2);
+    expected.replace(5, 2, "IS");
+
+    char out[16];
+    ASSERT_EQ(purc_rwstream_read (rws, out, 5), 5);
+    ASSERT_EQ(0, strncmp(out, " test", 5));
+
+    size_t sz = 0;
+    char* mem_buffer = (char*)purc_rwstream_get_mem_buffer (rws, &sz);
+    ASSERT_NE(mem_buffer, nullptr);
+    ASSERT_EQ(sz, expected.size());
+    ASSERT_STREQ(mem_buffer, expected.c_str());
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+}
+
 TEST(buffer_rwstream, read_utf8_char)
 {
     char buf[] = "This这 is 测。";
@@ -1166,6 +1266,7 @@ TEST(gio_rwstream, seek_read)
 
     remove_temp_file(tmp_file);
 }
+
 #endif
 
 
@@ -1176,6 +1277,74 @@ off_t filesize(const char* filename)
     return statbuf.st_size;
 }
 
+TEST(fd_rwstream, buffered)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    char buf[] = "This这 is 测。";
+    size_t buf_len = strlen(buf);
+    create_temp_file(tmp_file, buf, buf_len);
+
+    int fd = open(tmp_file, O_RDWR, S_IRGRP | S_IWGRP | S_IRUSR
+            | S_IWUSR | S_IROTH);
+
+    /* the read buffer holds a part of a character */
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd_buffered (fd, 5, 8);
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[100] = {0};
+    uint32_t wc = 0;
+    int read_len = 0;
+
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 1);
+    ASSERT_STREQ(read_buf, "T");
+
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read (rws, read_buf, 3);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_STREQ(read_buf, "his");
+
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_EQ(wc, 0x8FD9);
+    ASSERT_STREQ(read_buf, "这");
+
+    /* some bytes are still in the read buffer */
+    ASSERT_EQ(purc_rwstream_tell (rws), 7);
+    off_t pos = purc_rwstream_seek (rws, 1, SEEK_CUR);
+    ASSERT_EQ(pos, 8);
+
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read (rws, read_buf, 2);
+    ASSERT_EQ(read_len, 2);
+    ASSERT_STREQ(read_buf, "is");
+
+    /* the written bytes are kept until flushed */
+    pos = purc_rwstream_seek (rws, 0, SEEK_END);
+    ASSERT_EQ(pos, (off_t)buf_len);
+
+    ASSERT_EQ(purc_rwstream_write (rws, "abc", 3), 3);
+    ASSERT_EQ(purc_rwstream_write (rws, "def", 3), 3);
+    ASSERT_EQ(purc_rwstream_tell (rws), (off_t)buf_len + 6);
+    ASSERT_EQ(filesize(tmp_file), (off_t)buf_len);
+
+    ASSERT_EQ(purc_rwstream_flush (rws), 6);
+    ASSERT_EQ(filesize(tmp_file), (off_t)buf_len + 6);
+
+    /* larger than the write buffer, so written directly */
+    ASSERT_EQ(purc_rwstream_write (rws, "ghijklmnop", 10), 10);
+    ASSERT_EQ(filesize(tmp_file), (off_t)buf_len + 16);
+
+    ASSERT_EQ(purc_rwstream_write (rws, "q", 1), 1);
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(filesize(tmp_file), (off_t)buf_len + 17);
+
+    close(fd);
+    remove_temp_file(tmp_file);
+}
+
 TEST(dump_rwstream, stdio)
 {
     char in_file[] = "/bin/ls";
@@ -1353,3 +1522,126 @@ TEST(dump_rwstream, mem_buffer)
     ret = purc_rwstream_destroy (rws);
     ASSERT_EQ(ret, 0);
 }
+
+/* test filter rwstream */
+static ssize_t append_to_string(void *ctxt, const void *buf, size_t count)
+{
+    std::string *str = (std::string *)ctxt;
+    str->append((const char *)buf, count);
+    return count;
+}
+
+static std::string read_all(purc_rwstream_t rws, size_t chunk)
+{
+    std::string str;
+    std::string buf(chunk, '\0');
+    ssize_t n;
+    while ((n = purc_rwstream_read(rws, &buf[0], chunk)) > 0)
+        str.append(buf, 0, n);
+    return str;
+}
+
+TEST(filter_rwstream, base64)
+{
+    std::string encoded;
+    purc_rwstream_t rws = purc_rwstream_new_filter(
+            purc_rwstream_new_for_dump(&encoded, append_to_string),
+            PCRWS_FILTER_BASE64, true);
+    ASSERT_NE(rws, nullptr);
+
+    ASSERT_EQ(purc_rwstream_write(rws, "he", 2), 2);
+    ASSERT_EQ(purc_rwstream_write(rws, "llo", 3), 3);
+    ASSERT_EQ(purc_rwstream_tell(rws), 5);
+    ASSERT_EQ(purc_rwstream_seek(rws, 0, SEEK_SET), -1);
+    ASSERT_EQ(purc_rwstream_destroy(rws), 0);
+    ASSERT_EQ(encoded, "aGVsbG8=");
+
+    char text[] = "aGVs\nbG8g\nd29y bGQ=\n";
+    rws = purc_rwstream_new_filter(
+            purc_rwstream_new_from_mem(text, sizeof(text) - 1),
+            PCRWS_FILTER_BASE64, false);
+    ASSERT_NE(rws, nullptr);
+    ASSERT_EQ(read_all(rws, 1), "hello world");
+    ASSERT_EQ(purc_rwstream_destroy(rws), 0);
+
+    char bad[] = "aGV!";
+    rws = purc_rwstream_new_filter(
+            purc_rwstream_new_from_mem(bad, sizeof(bad) - 1),
+            PCRWS_FILTER_BASE64, false);
+    ASSERT_NE(rws, nullptr);
+    char buf[8];
+    ASSERT_EQ(purc_rwstream_read(rws, buf, sizeof(buf)), -1);
+    purc_rwstream_destroy(rws);
+}
+
+TEST(rwstream, write_base64)
+{
+    std::string bytes;
+    for (int i = 0; i < 10000; i++)
+        bytes += (char)(i * 7 + (i >> 8));
+
+    /* more than one chunk; and all the sizes of the last group */
+    for (size_t len = bytes.size() - 2; len <= bytes.size(); len++) {
+        std::string encoded;
+        purc_rwstream_t rws = purc_rwstream_new_for_dump(&encoded,
+                append_to_string);
+        ASSERT_NE(rws, nullptr);
+        ASSERT_EQ(purc_rwstream_write_base64(rws, bytes.data(), len),
+                (ssize_t)((len + 2) / 3 * 4));
+        purc_rwstream_destroy(rws);
+
+        char *expected = pcutils_b64_encode_alloc(bytes.data(), len);
+        ASSERT_EQ(encoded, expected);
+        free(expected);
+
+        std::vector<unsigned char> decoded(len + 1);
+        ASSERT_EQ(pcutils_b64_decode(encoded.c_str(), decoded.data(),
+                    decoded.size()), (ssize_t)len);
+        ASSERT_EQ(memcmp(decoded.data(), bytes.data(), len), 0);
+    }
+
+    /* the characters written if the stream is full */
+    char buf[10];
+    purc_rwstream_t rws = purc_rwstream_new_from_mem(buf, sizeof(buf));
+    ASSERT_NE(rws, nullptr);
+    ASSERT_EQ(purc_rwstream_write_base64(rws, "hello world", 11), 10);
+    ASSERT_EQ(memcmp(buf, "aGVsbG8gd2", 10), 0);
+    ASSERT_EQ(purc_rwstream_write_base64(rws, "hello", 5), -1);
+    purc_rwstream_destroy(rws);
+}
+
+TEST(filter_rwstream, gzip_stacked)
+{
+    std::string plain;
+    for (int i = 0; i < 10000; i++) {
+        plain += "This is test file. 这是测试文件。";
+        plain += std::to_string(i);
+    }
+
+    /* compress and then encode in base64 */
+    std::string encoded;
+    purc_rwstream_t rws = purc_rwstream_new_filter(
+            purc_rwstream_new_for_dump(&encoded, append_to_string),
+            PCRWS_FILTER_BASE64, true);
+    ASSERT_NE(rws, nullptr);
+    rws = purc_rwstream_new_filter(rws, PCRWS_FILTER_GZIP, true);
+    ASSERT_NE(rws, nullptr);
+
+    for (size_t i = 0; i < plain.size(); i += 1000) {
+        size_t n = std::min((size_t)1000, plain.size() - i);
+        ASSERT_EQ(purc_rwstream_write(rws, plain.data() + i, n), (ssize_t)n);
+    }
+    ASSERT_EQ(purc_rwstream_flush(rws), 0);
+    ASSERT_EQ(purc_rwstream_destroy(rws), 0);
+    ASSERT_LT(encoded.size(), plain.size());
+
+    rws = purc_rwstream_new_filter(
+            purc_rwstream_new_from_mem((void *)encoded.data(), encoded.size()),
+            PCRWS_FILTER_BASE64, false);
+    ASSERT_NE(rws, nullptr);
+    rws = purc_rwstream_new_filter(rws, PCRWS_FILTER_GZIP, false);
+    ASSERT_NE(rws, nullptr);
+    ASSERT_EQ(read_all(rws, 333), plain);
+    ASSERT_EQ(purc_rwstream_tell(rws), (off_t)plain.size());
+    ASSERT_EQ(purc_rwstream_destroy(rws), 0);
+}
@@ -147,3 +147,50 @@ TEST(regex, match_info)
     pcregex_destroy(regex);
 }
 
+
+TEST(regex, cache)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_UTILS, "cn.fmsoft.hvml.test",
+            "regex_cache", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    size_t nr_hits, nr_misses;
+    const regex_t *re1 = pcregex_cache_get("^a+b$", REG_EXTENDED, NULL);
+    ASSERT_NE(re1, nullptr);
+    ASSERT_EQ(regexec(re1, "aab", 0, NULL, 0), 0);
+
+    const regex_t *re2 = pcregex_cache_get("^a+b$", REG_EXTENDED, NULL);
+    ASSERT_EQ(re1, re2);
+
+    const regex_t *re3 = pcregex_cache_get("^a+b$",
+            REG_EXTENDED | REG_ICASE, NULL);
+    ASSERT_NE(re3, nullptr);
+    ASSERT_NE(re1, re3);
+    ASSERT_EQ(regexec(re3, "AAB", 0, NULL, 0), 0);
+
+    pcregex_cache_get_stat(&nr_hits, &nr_misses);
+    ASSERT_EQ(nr_hits, 1);
+    ASSERT_EQ(nr_misses, 2);
+
+    pcregex_cache_release(re1);
+    pcregex_cache_release(re2);
+    pcregex_cache_release(re3);
+
+    int err = 0;
+    const regex_t *bad = pcregex_cache_get("a(", REG_EXTENDED, &err);
+    ASSERT_EQ(bad, nullptr);
+    ASSERT_NE(err, 0);
+
+    /* evict the first regex while it is still in use */
+    re1 = pcregex_cache_get("^a+b$", REG_EXTENDED, NULL);
+    for (int i = 0; i < 64; i++) {
+        char pattern[16];
+        snprintf(pattern, sizeof(pattern), "x%d", i);
+        pcregex_cache_release(pcregex_cache_get(pattern, REG_EXTENDED, NULL));
+    }
+    ASSERT_EQ(regexec(re1, "ab", 0, NULL, 0), 0);
+    pcregex_cache_release(re1);
+
+    purc_cleanup();
+}
@@ -28,6 +28,9 @@
 #include "private/atom-buckets.h"
 #include "private/sorted-array.h"
 #include "private/url.h"
+#include "private/utils.h"
+#include "private/trace.h"
+#include "private/resolver.h"
 
 #include "../helpers.h"
 
@@ -35,8 +38,15 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 #define ATOM_BUCKET     1
 
 static struct atom_info {
@@ -354,6 +364,118 @@ TEST(utils, atom_buckets)
     purc_cleanup ();
 }
 
+#define NR_STABLE_ATOMS     64
+#define NR_ATOM_READERS     4
+#define NR_ATOM_WRITERS     2
+#define NR_WRITER_ATOMS     2000
+
+static purc_atom_t stable_atoms[NR_STABLE_ATOMS];
+static volatile bool atom_writers_done;
+
+static void *read_atoms(void *arg)
+{
+    size_t *nr_bad = (size_t *)arg;
+    char str[32];
+
+    /* keep reading until all writers have grown and shrunk the tables */
+    do {
+        for (size_t i = 0; i < NR_STABLE_ATOMS; i++) {
+            snprintf(str, sizeof(str), "stable-%u", (unsigned)i);
+            if (purc_atom_try_string_ex(ATOM_BUCKET, str) != stable_atoms[i])
+                (*nr_bad)++;
+
+            const char *s = purc_atom_to_string(stable_atoms[i]);
+            if (s == NULL || strcmp(s, str))
+                (*nr_bad)++;
+
+            /* an atom being created or removed maps to its own string only */
+            snprintf(str, sizeof(str), "volatile-0-%u", (unsigned)i);
+            purc_atom_t atom = purc_atom_try_string_ex(ATOM_BUCKET, str);
+            if (atom) {
+                s = purc_atom_to_string(atom);
+                if (s && strcmp(s, str))
+                    (*nr_bad)++;
+            }
+        }
+    } while (!atom_writers_done);
+
+    return NULL;
+}
+
+static void *write_atoms(void *arg)
+{
+    unsigned id = (unsigned)(uintptr_t)arg;
+    char str[32];
+
+    for (unsigned i = 0; i < NR_WRITER_ATOMS; i++) {
+        snprintf(str, sizeof(str), "volatile-%u-%u", id, i);
+        purc_atom_from_string_ex(ATOM_BUCKET, str);
+    }
+
+    for (unsigned i = 0; i < NR_WRITER_ATOMS; i += 2) {
+        snprintf(str, sizeof(str), "volatile-%u-%u", id, i);
+        purc_atom_remove_string_ex(ATOM_BUCKET, str);
+    }
+
+    return NULL;
+}
+
+// to test the lock-free lookups while other threads create and remove atoms
+TEST(utils, atom_concurrent)
+{
+    int ret = purc_init_ex(PURC_MODULE_UTILS, "cn.fmsoft.hybridos.test",
+            "utils", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    char str[32];
+    for (size_t i = 0; i < NR_STABLE_ATOMS; i++) {
+        snprintf(str, sizeof(str), "stable-%u", (unsigned)i);
+        stable_atoms[i] = purc_atom_from_string_ex(ATOM_BUCKET, str);
+        ASSERT_NE(stable_atoms[i], 0);
+    }
+
+    /* run twice to reuse the reader records of the exited threads */
+    for (int round = 0; round < 2; round++) {
+        pthread_t readers[NR_ATOM_READERS];
+        pthread_t writers[NR_ATOM_WRITERS];
+        size_t nr_bad[NR_ATOM_READERS] = { };
+
+        atom_writers_done = false;
+        for (size_t i = 0; i < NR_ATOM_READERS; i++)
+            ASSERT_EQ(pthread_create(&readers[i], NULL, read_atoms,
+                        &nr_bad[i]), 0);
+        for (size_t i = 0; i < NR_ATOM_WRITERS; i++)
+            ASSERT_EQ(pthread_create(&writers[i], NULL, write_atoms,
+                        (void *)(uintptr_t)(round * NR_ATOM_WRITERS + i)), 0);
+
+        for (size_t i = 0; i < NR_ATOM_WRITERS; i++)
+            pthread_join(writers[i], NULL);
+        atom_writers_done = true;
+        for (size_t i = 0; i < NR_ATOM_READERS; i++) {
+            pthread_join(readers[i], NULL);
+            ASSERT_EQ(nr_bad[i], 0);
+        }
+
+        /* the odd ones survive, the even ones are gone */
+        for (size_t i = 0; i < NR_ATOM_WRITERS; i++) {
+            unsigned id = round * NR_ATOM_WRITERS + i;
+            for (unsigned j = 0; j < NR_WRITER_ATOMS; j++) {
+                snprintf(str, sizeof(str), "volatile-%u-%u", id, j);
+                purc_atom_t atom = purc_atom_try_string_ex(ATOM_BUCKET, str);
+                if (j % 2) {
+                    ASSERT_NE(atom, 0);
+                    ASSERT_STREQ(purc_atom_to_string(atom), str);
+                }
+                else {
+                    ASSERT_EQ(atom, 0);
+                }
+            }
+        }
+    }
+
+    purc_cleanup ();
+}
+
 // to test sorted array
 static int sortv[10] = { 1, 8, 7, 5, 4, 6, 9, 0, 2, 3 };
 
@@ -473,12 +595,206 @@ TEST(utils, pcutils_sorted_array_desc)
     pcutils_sorted_array_destroy(sa);
 }
 
+static size_t nr_sa_freed;
+
+static void
+sa_count_free(void *sortv, void *data)
+{
+    (void)sortv;
+    (void)data;
+    nr_sa_freed++;
+}
+
+/* the members are moved to a B+tree and back with many members */
+TEST(utils, pcutils_sorted_array_large)
+{
+    const int nr = 20011;   /* a prime */
+    struct sorted_array *sa;
+    ssize_t idx;
+    void *data;
+    bool found;
+    int n;
+
+    for (int desc = 0; desc < 2; desc++) {
+        nr_sa_freed = 0;
+        sa = pcutils_sorted_array_create(desc ? SAFLAG_ORDER_DESC : 0, 0,
+                sa_count_free, intcmp);
+
+        for (int i = 0; i < nr; i++) {
+            int v = (int)((i * 7919L) % nr);
+            int ret = pcutils_sorted_array_add (sa, (void *)(intptr_t)v,
+                    (void *)(intptr_t)(v + 100), NULL);
+            ASSERT_EQ(ret, 0);
+        }
+
+        ASSERT_EQ(pcutils_sorted_array_add (sa, (void *)(intptr_t)7,
+                    NULL, NULL), -1);
+        n = (int)pcutils_sorted_array_count (sa);
+        ASSERT_EQ(n, nr);
+
+        for (int i = 0; i < n; i++) {
+            int sortv = (int)(intptr_t)pcutils_sorted_array_get (sa, i, &data);
+
+            ASSERT_EQ((int)(intptr_t)data, sortv + 100);
+            ASSERT_EQ(sortv, desc ? (nr - 1 - i) : i);
+        }
+
+        /* remove the even members */
+        for (int i = 0; i < nr; i += 2) {
+            ASSERT_EQ(pcutils_sorted_array_remove (sa, (void *)(intptr_t)i),
+                    true);
+        }
+        ASSERT_EQ(pcutils_sorted_array_remove (sa, (void *)(intptr_t)0),
+                false);
+
+        n = (int)pcutils_sorted_array_count (sa);
+        ASSERT_EQ(n, nr / 2);
+        for (int i = 0; i < nr; i++) {
+            found = pcutils_sorted_array_find (sa, (void *)(intptr_t)i,
+                    &data, &idx);
+            ASSERT_EQ(found, (i % 2) == 1);
+            if (found) {
+                ASSERT_EQ((int)(intptr_t)data, i + 100);
+                ASSERT_EQ(idx, desc ? (nr / 2 - 1 - i / 2) : i / 2);
+            }
+        }
+
+        /* delete from the middle until only a few members are left */
+        while (pcutils_sorted_array_count (sa) > 10) {
+            pcutils_sorted_array_delete (sa,
+                    pcutils_sorted_array_count (sa) / 3);
+        }
+
+        int last = desc ? nr : -1;
+        for (int i = 0; i < 10; i++) {
+            int sortv = (int)(intptr_t)pcutils_sorted_array_get (sa, i, &data);
+
+            ASSERT_EQ((int)(intptr_t)data, sortv + 100);
+            ASSERT_EQ(sortv % 2, 1);
+            ASSERT_TRUE(desc ? (sortv < last) : (sortv > last));
+            last = sortv;
+        }
+
+        pcutils_sorted_array_destroy(sa);
+        ASSERT_EQ(nr_sa_freed, (size_t)nr);
+    }
+}
+
 struct node
 {
     struct list_head          node;
     int                       v;
 };
 
+static void sha1_hex(const void *data, size_t len, size_t chunk, char *hex)
+{
+    pcutils_sha1_ctxt ctxt;
+    unsigned char digest[PCUTILS_SHA1_DIGEST_SIZE];
+
+    pcutils_sha1_begin(&ctxt);
+    for (size_t off = 0; off < len; off += chunk)
+        pcutils_sha1_hash(&ctxt, (const char *)data + off,
+                MIN(chunk, len - off));
+    pcutils_sha1_end(&ctxt, digest);
+    pcutils_bin2hex(digest, sizeof(digest), hex, false);
+}
+
+static void sha256_hex(const void *data, size_t len, size_t chunk, char *hex)
+{
+    pcutils_sha256_ctxt ctxt;
+    unsigned char digest[PCUTILS_SHA256_DIGEST_SIZE];
+
+    pcutils_sha256_begin(&ctxt);
+    for (size_t off = 0; off < len; off += chunk)
+        pcutils_sha256_hash(&ctxt, (const char *)data + off,
+                MIN(chunk, len - off));
+    pcutils_sha256_end(&ctxt, digest);
+    pcutils_bin2hex(digest, sizeof(digest), hex, false);
+}
+
+static uint32_t crc32_of(purc_crc32_algo_t algo, const void *data, size_t len,
+        size_t chunk)
+{
+    pcutils_crc32_ctxt ctxt;
+    uint32_t crc32;
+
+    pcutils_crc32_begin(&ctxt, algo);
+    for (size_t off = 0; off < len; off += chunk)
+        pcutils_crc32_update(&ctxt, (const char *)data + off,
+                MIN(chunk, len - off));
+    pcutils_crc32_end(&ctxt, &crc32);
+    return crc32;
+}
+
+/* the accelerated paths are taken for long data if the CPU supports them */
+TEST(utils, digests)
+{
+    char hex[PCUTILS_SHA256_DIGEST_SIZE * 2 + 1];
+
+    sha1_hex("abc", 3, 3, hex);
+    ASSERT_STREQ(hex, "a9993e364706816aba3e25717850c26c9cd0d89d");
+    sha256_hex("abc", 3, 3, hex);
+    ASSERT_STREQ(hex,
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+    std::string million(1000000, 'a');
+    const size_t chunks[] = { 1, 63, 64, 1000, million.size() };
+    for (size_t i = 0; i < PCA_TABLESIZE(chunks); i++) {
+        sha1_hex(million.data(), million.size(), chunks[i], hex);
+        ASSERT_STREQ(hex, "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+        sha256_hex(million.data(), million.size(), chunks[i], hex);
+        ASSERT_STREQ(hex,
+            "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+
+    ASSERT_EQ(crc32_of(PURC_K_ALGO_CRC32, "123456789", 9, 9), 0xcbf43926U);
+    ASSERT_EQ(crc32_of(PURC_K_ALGO_CRC32C, "123456789", 9, 9), 0xe3069283U);
+    ASSERT_EQ(crc32_of(PURC_K_ALGO_CRC32_JAMCRC, "123456789", 9, 9),
+            0x340bc6d9U);
+
+    /* the byte-wise updates always use the lookup tables */
+    std::vector<unsigned char> buf(100003);
+    for (size_t i = 0; i < buf.size(); i++)
+        buf[i] = (unsigned char)(i * 131 + (i >> 7));
+
+    const purc_crc32_algo_t algos[] = { PURC_K_ALGO_CRC32,
+        PURC_K_ALGO_CRC32C, PURC_K_ALGO_CRC32_JAMCRC, PURC_K_ALGO_CRC32_BZIP2 };
+    const size_t lens[] = { 15, 64, 65, 127, 1000, buf.size() - 3 };
+    for (size_t a = 0; a < PCA_TABLESIZE(algos); a++) {
+        for (size_t l = 0; l < PCA_TABLESIZE(lens); l++) {
+            for (size_t off = 0; off < 3; off++) {
+                uint32_t expected = crc32_of(algos[a], &buf[off], lens[l], 1);
+                ASSERT_EQ(crc32_of(algos[a], &buf[off], lens[l], lens[l]),
+                        expected);
+                ASSERT_EQ(crc32_of(algos[a], &buf[off], lens[l], 100),
+                        expected);
+            }
+        }
+    }
+}
+
+TEST(utils, hash_bytes)
+{
+    std::string str(100, 'x');
+
+    /* all the tail bytes and the seed contribute to the hash value */
+    for (size_t len = 1; len <= str.size(); len++) {
+        uint64_t v = pcutils_hash_bytes(str.data(), len, 0);
+        ASSERT_EQ(v, pcutils_hash_bytes(str.c_str(), len, 0));
+        ASSERT_NE(v, pcutils_hash_bytes(str.data(), len - 1, 0));
+        ASSERT_NE(v, pcutils_hash_bytes(str.data(), len, 1));
+
+        str[len - 1] = 'y';
+        ASSERT_NE(v, pcutils_hash_bytes(str.data(), len, 0));
+        str[len - 1] = 'x';
+    }
+
+    /* the short strings are hashed by FNV-1a */
+    ASSERT_EQ(pchash_fast_str_hash("hvml"), pchash_fnv1a_str_hash("hvml"));
+    ASSERT_NE(pchash_fast_str_hash(str.c_str()),
+            pchash_fast_str_hash(str.c_str() + 1));
+}
+
 TEST(utils, list_head)
 {
     struct list_head list;
@@ -703,6 +1019,131 @@ TEST(hashtable, double_free)
     ASSERT_EQ(_hash_table_items_free, 2);
 }
 
+TEST(hashtable, open_addressing)
+{
+    char keys[1000][16];
+    struct pchash_table *ht = pchash_table_new_ex(0,
+            NULL, NULL, NULL, NULL, pchash_fnv1a_str_hash, pchash_str_equal,
+            false, PCHASH_FLAG_OPEN);
+    ASSERT_NE(ht, nullptr);
+    ASSERT_TRUE(pchash_table_is_open(ht));
+
+    for (size_t i = 0; i < PCA_TABLESIZE(keys); i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key-%u", (unsigned)i);
+        ASSERT_EQ(pchash_table_insert(ht, keys[i], keys[i]), 0);
+    }
+    ASSERT_EQ(pchash_table_length(ht), PCA_TABLESIZE(keys));
+
+    /* the entries do not move while the table grows */
+    pchash_entry_t first = pchash_table_lookup_entry(ht, "key-0");
+    ASSERT_NE(first, nullptr);
+    for (size_t i = 0; i < PCA_TABLESIZE(keys); i++) {
+        pchash_entry_t e = pchash_table_lookup_entry(ht, keys[i]);
+        ASSERT_NE(e, nullptr);
+        ASSERT_EQ(pchash_entry_val(e), keys[i]);
+    }
+    ASSERT_EQ(pchash_table_lookup_entry(ht, "key-0"), first);
+    ASSERT_EQ(pchash_table_lookup_entry(ht, "foo"), nullptr);
+
+    /* erase the odd ones */
+    for (size_t i = 1; i < PCA_TABLESIZE(keys); i += 2) {
+        ASSERT_EQ(pchash_table_erase(ht, keys[i]), 0);
+    }
+    ASSERT_EQ(pchash_table_erase(ht, keys[1]), -1);
+    ASSERT_EQ(pchash_table_length(ht), PCA_TABLESIZE(keys) / 2);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(keys); i++) {
+        bool found = pchash_table_lookup_ex(ht, keys[i], NULL);
+        ASSERT_EQ(found, (i % 2) == 0);
+    }
+
+    /* the iterators visit the entries in the order of insertion */
+    size_t n = 0;
+    struct pcutils_uomap_iterator it = pcutils_uomap_it_begin_first(ht);
+    for (pcutils_uomap_entry *e = pcutils_uomap_it_value(&it); e;
+            e = pcutils_uomap_it_next(&it)) {
+        ASSERT_STREQ((const char *)pcutils_uomap_entry_key(e), keys[n * 2]);
+        n++;
+    }
+    ASSERT_EQ(n, PCA_TABLESIZE(keys) / 2);
+
+    ASSERT_EQ(pchash_table_replace_or_insert(ht, keys[0], keys[1], NULL), 0);
+    ASSERT_EQ(pchash_table_lookup_entry(ht, keys[0]), first);
+    ASSERT_EQ(pchash_entry_val(first), keys[1]);
+
+    pchash_table_reset(ht);
+    ASSERT_EQ(pchash_table_length(ht), 0);
+    ASSERT_EQ(pchash_table_lookup_entry(ht, keys[0]), nullptr);
+    pchash_table_delete(ht);
+
+    /* an open-addressing table can not be sorted */
+    ht = pchash_table_new_ex(0, NULL, NULL, NULL, NULL,
+            pchash_fnv1a_str_hash, pchash_str_equal, false,
+            PCHASH_FLAG_OPEN | PCHASH_FLAG_SORTED);
+    ASSERT_EQ(ht, nullptr);
+}
+
+static double hashtable_elapsed(const struct timespec *from)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - from->tv_sec) * 1000.0 +
+        (now.tv_nsec - from->tv_nsec) / 1000000.0;
+}
+
+/* compares the open-addressing table with the chained one */
+TEST(hashtable, perf)
+{
+    const char *env = getenv("NR_ENTRIES");
+    size_t nr = env ? strtoul(env, NULL, 10) : 0;
+    if (nr == 0)
+        nr = 200000;
+
+    std::vector<std::string> keys(nr);
+    for (size_t i = 0; i < nr; i++) {
+        keys[i] = "key-" + std::to_string(i * 2654435761UL);
+    }
+
+    const unsigned kinds[] = { 0, PCHASH_FLAG_OPEN };
+    for (size_t k = 0; k < PCA_TABLESIZE(kinds); k++) {
+        struct pchash_table *ht = pchash_table_new_ex(0,
+                NULL, NULL, NULL, NULL,
+                pchash_fnv1a_str_hash, pchash_str_equal, false, kinds[k]);
+        ASSERT_NE(ht, nullptr);
+
+        struct timespec start, one;
+        double max_insert = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t i = 0; i < nr; i++) {
+            clock_gettime(CLOCK_MONOTONIC, &one);
+            ASSERT_EQ(pchash_table_insert(ht, keys[i].c_str(), NULL), 0);
+            double t = hashtable_elapsed(&one);
+            if (t > max_insert)
+                max_insert = t;
+        }
+        double insert = hashtable_elapsed(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t i = 0; i < nr; i++) {
+            ASSERT_NE(pchash_table_lookup_entry(ht, keys[i].c_str()),
+                    nullptr);
+        }
+        double lookup = hashtable_elapsed(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t i = 0; i < nr; i++) {
+            ASSERT_EQ(pchash_table_erase(ht, keys[i].c_str()), 0);
+        }
+        double erase = hashtable_elapsed(&start);
+
+        fprintf(stderr, "%s table with %u entries: insert %.2f ms "
+                "(max %.3f ms), lookup %.2f ms, erase %.2f ms\n",
+                kinds[k] ? "open-addressing" : "chained", (unsigned)nr,
+                insert, max_insert, lookup, erase);
+        pchash_table_delete(ht);
+    }
+}
+
 TEST(uomap, basic)
 {
     int r;
@@ -1954,6 +2395,46 @@ TEST(utils, url)
     }
 }
 
+TEST(utils, url_cached)
+{
+    /* the parsed URLs are cached; break down more URLs than kept in the
+       cache, again and again, so that some are reused and some evicted */
+    char urls[40][64];
+    for (size_t i = 0; i < 40; i++) {
+        snprintf(urls[i], sizeof(urls[i]),
+                "http://host%u:%u/path/%u?key1=value%u#frag",
+                (unsigned)(i % 3), (unsigned)(8000 + i),
+                (unsigned)i, (unsigned)i);
+    }
+
+    for (int round = 0; round < 3; round++) {
+        for (size_t i = 0; i < 40; i++) {
+            /* reuse the URLs early in the list more frequently */
+            size_t n = (round == 1) ? (i % 5) : i;
+            struct purc_broken_down_url broken_down;
+            memset(&broken_down, 0, sizeof(broken_down));
+
+            ASSERT_TRUE(pcutils_url_break_down(&broken_down, urls[n]));
+            ASSERT_STREQ(broken_down.schema, "http");
+            ASSERT_EQ(broken_down.port, 8000 + n);
+
+            char path[16];
+            snprintf(path, sizeof(path), "/path/%u", (unsigned)n);
+            ASSERT_STREQ(broken_down.path, path);
+
+            char value[16], expected[16];
+            snprintf(expected, sizeof(expected), "value%u", (unsigned)n);
+            ASSERT_TRUE(pcutils_url_get_query_value(&broken_down,
+                        "key1", value));
+            ASSERT_STREQ(value, expected);
+
+            pcutils_broken_down_url_clear(&broken_down);
+        }
+
+        ASSERT_FALSE(pcutils_url_is_valid("http://"));
+    }
+}
+
 purc_variant_t
 ejson_to_variant(const char *ejson)
 {
@@ -2315,3 +2796,311 @@ TEST(valid_css_identifier, normal)
     r = purc_is_valid_css_identifier(id);
     ASSERT_EQ(r, false);
 }
+
+TEST(utils, dtoa_shortest)
+{
+    static const struct {
+        double      d;
+        int         min_precision;
+        const char *expected;
+    } cases[] = {
+        { 0.0,              17, "0" },
+        { -0.0,             17, "-0" },
+        { 0.1,              17, "0.1" },
+        { -0.1,             6,  "-0.1" },
+        { 100.0,            17, "100" },
+        { 100.0,            1,  "1e+02" },
+        { 1e16,             17, "10000000000000000" },
+        { 1.5e17,           17, "1.5e+17" },
+        { 0.0001,           17, "0.0001" },
+        { 1.234e-5,         17, "1.234e-05" },
+        { 5e-324,           17, "5e-324" },
+        { 1.7976931348623157e308, 17, "1.7976931348623157e+308" },
+        { 3.1415926,        6,  "3.1415926" },
+        { 1234567.0,        6,  "1234567" },
+        { 1000000.0,        6,  "1e+06" },
+    };
+
+    char buf[PCUTILS_DTOA_BUFF_SIZE];
+    for (size_t i = 0; i < PCA_TABLESIZE(cases); i++) {
+        int n = pcutils_dtoa_shortest(cases[i].d, cases[i].min_precision, buf);
+        ASSERT_EQ(n, (int)strlen(cases[i].expected));
+        ASSERT_STREQ(buf, cases[i].expected);
+        ASSERT_EQ(strtod(buf, NULL), cases[i].d);
+    }
+
+    /* every formatted double must be read back to itself */
+    srand(1);
+    for (int i = 0; i < 100000; i++) {
+        uint64_t u64 = ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^
+            (uint64_t)rand();
+        double d;
+        memcpy(&d, &u64, sizeof(d));
+        if (!isfinite(d))
+            continue;
+
+        pcutils_dtoa_shortest(d, 17, buf);
+        ASSERT_EQ(strtod(buf, NULL), d) << buf;
+        ASSERT_EQ(pcutils_strtod(buf, NULL), d) << buf;
+    }
+}
+
+TEST(utils, strtod)
+{
+    static const char *cases[] = {
+        "0", "-0", "1.5", "123.", "00012.50e-2", "1e22", "1e23",
+        "9007199254740993", "1.5e3x", "1e", "1e+", "0x10", "  5", ".5",
+        "-inf", "nan", "2.5e-22", "123456789012345678901234567890",
+    };
+
+    for (size_t i = 0; i < PCA_TABLESIZE(cases); i++) {
+        char *end1, *end2;
+        double d1 = pcutils_strtod(cases[i], &end1);
+        double d2 = strtod(cases[i], &end2);
+
+        ASSERT_EQ(memcmp(&d1, &d2, sizeof(double)), 0) << cases[i];
+        ASSERT_EQ(end1, end2) << cases[i];
+    }
+}
+
+TEST(utils, trace)
+{
+    PurCInstance purc;
+
+    ASSERT_EQ(pctrace_begin(), 0U);
+    ASSERT_EQ(purc_enable_tracing(2), 0);
+
+    for (int i = 0; i < 3; i++) {
+        uint64_t span = pctrace_begin();
+        ASSERT_NE(span, 0U);
+        pctrace_end(span, PCTRACE_CAT_SCHED, i ? "later" : "first");
+    }
+
+    purc_rwstream_t stm = purc_rwstream_new_buffer(1024, 1024 * 1024);
+    ASSERT_EQ(purc_dump_trace(stm), 0);
+
+    size_t sz = 0;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(stm, &sz);
+    std::string json(buf, sz);
+    purc_rwstream_destroy(stm);
+
+    /* the oldest span was overwritten */
+    ASSERT_EQ(json.find("\"first\""), std::string::npos) << json;
+    size_t pos = json.find("\"later\"");
+    ASSERT_NE(pos, std::string::npos) << json;
+    ASSERT_NE(json.find("\"later\"", pos + 1), std::string::npos) << json;
+
+    purc_variant_t v = purc_variant_make_from_json_string(json.c_str(),
+            json.length());
+    ASSERT_NE(v, nullptr) << json;
+    purc_variant_unref(v);
+
+    ASSERT_EQ(purc_enable_tracing(0), 0);
+    ASSERT_EQ(pctrace_begin(), 0U);
+}
+
+TEST(utils, instance_metrics)
+{
+    PurCInstance purc;
+
+    purc_variant_t metrics = purc_get_instance_metrics();
+    ASSERT_NE(metrics, nullptr);
+    ASSERT_TRUE(purc_variant_is_object(metrics));
+
+    purc_variant_t crtns = purc_variant_object_get_by_ckey(metrics,
+            "coroutines");
+    ASSERT_NE(crtns, nullptr);
+
+    uint64_t u = 1;
+    purc_variant_t v = purc_variant_object_get_by_ckey(crtns, "total");
+    ASSERT_TRUE(purc_variant_cast_to_ulongint(v, &u, false));
+    ASSERT_EQ(u, 0U);
+
+    v = purc_variant_object_get_by_ckey(metrics, "steps");
+    ASSERT_TRUE(purc_variant_cast_to_ulongint(v, &u, false));
+    ASSERT_EQ(u, 0U);
+
+    purc_variant_t variants = purc_variant_object_get_by_ckey(metrics,
+            "variants");
+    ASSERT_NE(variants, nullptr);
+    v = purc_variant_object_get_by_ckey(variants, "values");
+    ASSERT_TRUE(purc_variant_cast_to_ulongint(v, &u, false));
+    ASSERT_GT(u, 0U);
+
+    uint64_t peak = 0;
+    v = purc_variant_object_get_by_ckey(variants, "memory");
+    ASSERT_TRUE(purc_variant_cast_to_ulongint(v, &u, false));
+    v = purc_variant_object_get_by_ckey(variants, "peakMemory");
+    ASSERT_TRUE(purc_variant_cast_to_ulongint(v, &peak, false));
+    ASSERT_GE(peak, u);
+    ASSERT_EQ(peak, purc_variant_usage_stat()->sz_max_mem);
+
+    ASSERT_NE(purc_variant_object_get_by_ckey(metrics, "timers"), nullptr);
+    ASSERT_NE(purc_variant_object_get_by_ckey(metrics, "fetcherRequests"),
+            nullptr);
+    ASSERT_NE(purc_variant_object_get_by_ckey(metrics, "fetcherOrigins"),
+            nullptr);
+    ASSERT_NE(purc_variant_object_get_by_ckey(metrics, "selectorCache"),
+            nullptr);
+    purc_variant_unref(metrics);
+}
+
+TEST(utils, utf8_ascii_runs)
+{
+    char buf[80];
+
+    for (size_t k = 1; k < 70; k++) {
+        /* a two-byte character at k */
+        memset(buf, 'a', sizeof(buf));
+        buf[k] = (char)0xC3;
+        buf[k + 1] = (char)0xA9;
+        buf[sizeof(buf) - 1] = 0;
+
+        size_t nr_chars = 0;
+        const char *end = NULL;
+        ASSERT_TRUE(pcutils_string_check_utf8(buf, -1, &nr_chars, &end));
+        ASSERT_EQ(nr_chars, sizeof(buf) - 2);
+        ASSERT_EQ(end, buf + sizeof(buf) - 1);
+
+        ASSERT_TRUE(pcutils_string_check_utf8(buf, sizeof(buf) - 1,
+                    &nr_chars, NULL));
+        ASSERT_EQ(nr_chars, sizeof(buf) - 2);
+
+        ASSERT_EQ(pcutils_string_utf8_chars(buf, -1), sizeof(buf) - 2);
+        ASSERT_EQ(pcutils_string_utf8_chars(buf, sizeof(buf) - 1),
+                sizeof(buf) - 2);
+
+        /* an invalid byte at k */
+        buf[k] = (char)0xFF;
+        ASSERT_FALSE(pcutils_string_check_utf8(buf, -1, &nr_chars, &end));
+        ASSERT_EQ(nr_chars, k);
+        ASSERT_EQ(end, buf + k);
+
+        ASSERT_FALSE(pcutils_string_check_utf8(buf + 1, sizeof(buf) - 2,
+                    &nr_chars, &end));
+        ASSERT_EQ(end, buf + k);
+
+        /* a NUL byte at k */
+        memset(buf, 'a', sizeof(buf));
+        buf[k] = 0;
+        ASSERT_EQ(pcutils_string_utf8_chars(buf, sizeof(buf)), k);
+        ASSERT_EQ(pcutils_string_utf8_chars_with_nulls(buf, sizeof(buf)),
+                sizeof(buf));
+        ASSERT_FALSE(pcutils_string_check_utf8_len(buf, sizeof(buf),
+                    &nr_chars, &end));
+        ASSERT_EQ(nr_chars, k);
+        ASSERT_EQ(end, buf + k);
+    }
+}
+
+TEST(utils, resolver)
+{
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+
+    struct sockaddr_in addr = { };
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, (struct sockaddr *)&addr, sizeof(addr)), 0);
+    ASSERT_EQ(listen(listener, 4), 0);
+
+    socklen_t len = sizeof(addr);
+    ASSERT_EQ(getsockname(listener, (struct sockaddr *)&addr, &len), 0);
+    char port[10];
+    snprintf(port, sizeof(port), "%d", ntohs(addr.sin_port));
+
+    int fd = pcutils_resolver_connect("127.0.0.1", port);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    close(accept(listener, NULL, NULL));
+
+    /* the warm connection is made in background */
+    ASSERT_EQ(pcutils_resolver_preconnect("127.0.0.1", port), 0);
+    struct pollfd pfd = { listener, POLLIN, 0 };
+    ASSERT_EQ(poll(&pfd, 1, 5000), 1);
+    int peer = accept(listener, NULL, NULL);
+    ASSERT_GE(peer, 0);
+
+    /* and taken without a new connection */
+    for (int i = 0; i < 50; i++) {
+        fd = pcutils_resolver_connect("127.0.0.1", port);
+        ASSERT_GE(fd, 0);
+
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 0) == 0)
+            break;
+
+        /* the worker has not kept the connection yet */
+        close(fd);
+        close(accept(listener, NULL, NULL));
+        fd = -1;
+        usleep(10000);
+    }
+    ASSERT_GE(fd, 0);
+
+    close(fd);
+    close(peer);
+    close(listener);
+}
+
+static void *hold_mutex(void *arg)
+{
+    purc_mutex *mutex = (purc_mutex *)arg;
+    for (int i = 0; i < 1000; i++) {
+        purc_mutex_lock(mutex);
+        usleep(10);
+        purc_mutex_unlock(mutex);
+    }
+    return NULL;
+}
+
+TEST(utils, lock_stats)
+{
+    purc_mutex mutex;
+    purc_mutex_init(&mutex);
+    ASSERT_NE(mutex.native_impl, nullptr);
+    purc_mutex_set_name(&mutex, "test-lock-stats");
+
+    pthread_t threads[2];
+    for (size_t i = 0; i < PCA_TABLESIZE(threads); i++)
+        ASSERT_EQ(pthread_create(&threads[i], NULL, hold_mutex, &mutex), 0);
+    for (size_t i = 0; i < PCA_TABLESIZE(threads); i++)
+        pthread_join(threads[i], NULL);
+
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *fp = open_memstream(&buf, &len);
+    ASSERT_NE(fp, nullptr);
+    int nr = purc_lock_stats_dump(fp, true);
+    fclose(fp);
+
+    if (nr < 0) {
+        free(buf);
+        purc_mutex_clear(&mutex);
+        GTEST_SKIP() << "PurC is not built with ENABLE_LOCK_STATS";
+    }
+
+    ASSERT_GT(nr, 0);
+    const char *line = strstr(buf, "test-lock-stats");
+    ASSERT_NE(line, nullptr);
+
+    char name[32], kind[8];
+    unsigned long long nr_acquired;
+    ASSERT_EQ(sscanf(line, "%31s %7s %llu", name, kind, &nr_acquired), 3);
+    ASSERT_STREQ(kind, "mutex");
+    ASSERT_EQ(nr_acquired, 2000ULL);
+    free(buf);
+
+    /* the statistics were reset */
+    fp = open_memstream(&buf, &len);
+    ASSERT_NE(fp, nullptr);
+    purc_lock_stats_dump(fp, false);
+    fclose(fp);
+    line = strstr(buf, "test-lock-stats");
+    ASSERT_NE(line, nullptr);
+    ASSERT_EQ(sscanf(line, "%31s %7s %llu", name, kind, &nr_acquired), 3);
+    ASSERT_EQ(nr_acquired, 0ULL);
+    free(buf);
+
+    purc_mutex_clear(&mutex);
+}
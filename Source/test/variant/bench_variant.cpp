@@ -0,0 +1,644 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The microbenchmarks of the variant module.
+ *
+ * Usage: bench_variant [--format=text|json|csv] [--filter=<substring>]
+ *          [--min-time=<milliseconds>]
+ *
+ * Every benchmark runs its body repeatedly for at least the minimal time,
+ * and reports the average nanoseconds per operation. Use the JSON or CSV
+ * format to track regressions across releases; the fields are stable:
+ * name, size, iterations, ns_per_op.
+ */
+
+#include "purc/purc.h"
+#include "purc/purc-variant.h"
+#include "private/variant.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#define MIN_BUFFER     1024
+#define MAX_BUFFER     1024 * 1024 * 1024
+
+/* the state of a running benchmark; see BENCH_LOOP() */
+struct bench_state {
+    size_t      size;           // the size of the data set
+    size_t      iterations;     // the iterations to run
+    uint64_t    elapsed_ns;     // the time spent in timing
+    uint64_t    started_ns;
+    bool        timing;
+};
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* excludes the setup or cleanup code in the loop from the timing */
+static inline void bench_pause(struct bench_state *st)
+{
+    st->elapsed_ns += now_ns() - st->started_ns;
+    st->timing = false;
+}
+
+static inline void bench_resume(struct bench_state *st)
+{
+    st->timing = true;
+    st->started_ns = now_ns();
+}
+
+static inline size_t bench_start(struct bench_state *st)
+{
+    st->elapsed_ns = 0;
+    bench_resume(st);
+    return 0;
+}
+
+static inline bool bench_stop(struct bench_state *st)
+{
+    if (st->timing)
+        bench_pause(st);
+    return false;
+}
+
+/* runs the body for `st->iterations` times; `_i` is the iteration index */
+#define BENCH_LOOP(st)                                                  \
+    for (size_t _i = bench_start(st);                                   \
+            _i < (st)->iterations || bench_stop(st); _i++)
+
+/* prevents the compiler from optimizing the result away */
+static volatile uintptr_t bench_sink;
+#define BENCH_KEEP(v)   (bench_sink ^= (uintptr_t)(v))
+
+typedef void (*bench_func)(struct bench_state *st);
+
+struct bench_case {
+    const char *name;
+    bench_func  func;
+    size_t      sizes[4];       // zero-terminated; {0} for no size
+};
+
+static std::vector<std::string> make_keys(size_t n)
+{
+    std::vector<std::string> keys;
+    char buf[32];
+
+    keys.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        snprintf(buf, sizeof(buf), "key-%zu", i);
+        keys.push_back(buf);
+    }
+
+    return keys;
+}
+
+static purc_variant_t make_object(const std::vector<std::string> &keys)
+{
+    purc_variant_t obj = purc_variant_make_object_0();
+    for (size_t i = 0; i < keys.size(); i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i);
+        purc_variant_object_set_by_ckey(obj, keys[i].c_str(), v);
+        purc_variant_unref(v);
+    }
+
+    return obj;
+}
+
+static purc_variant_t make_record(const std::string &id, size_t i)
+{
+    purc_variant_t rec = purc_variant_make_object_0();
+    purc_variant_t v = purc_variant_make_string(id.c_str(), false);
+    purc_variant_object_set_by_ckey(rec, "id", v);
+    purc_variant_unref(v);
+
+    v = purc_variant_make_ulongint(i);
+    purc_variant_object_set_by_ckey(rec, "value", v);
+    purc_variant_unref(v);
+    return rec;
+}
+
+static purc_variant_t make_set(const std::vector<std::string> &keys)
+{
+    purc_variant_t set = purc_variant_make_set_by_ckey_ex(0, "id", false,
+            PURC_VARIANT_INVALID);
+    for (size_t i = 0; i < keys.size(); i++) {
+        purc_variant_t rec = make_record(keys[i], i);
+        purc_variant_set_add(set, rec, PCVRNT_CR_METHOD_OVERWRITE);
+        purc_variant_unref(rec);
+    }
+
+    return set;
+}
+
+static purc_variant_t make_array(size_t n)
+{
+    purc_variant_t arr = purc_variant_make_array_0();
+    for (size_t i = 0; i < n; i++) {
+        purc_variant_t v = purc_variant_make_number((double)i);
+        purc_variant_array_append(arr, v);
+        purc_variant_unref(v);
+    }
+
+    return arr;
+}
+
+/* an array of records, like the data of a table */
+static purc_variant_t make_document(size_t n)
+{
+    purc_variant_t arr = purc_variant_make_array_0();
+    std::vector<std::string> keys = make_keys(n);
+    for (size_t i = 0; i < n; i++) {
+        purc_variant_t rec = make_record(keys[i], i);
+        purc_variant_array_append(arr, rec);
+        purc_variant_unref(rec);
+    }
+
+    return arr;
+}
+
+static std::string serialize(purc_variant_t v)
+{
+    purc_rwstream_t rws = purc_rwstream_new_buffer(MIN_BUFFER, MAX_BUFFER);
+    purc_variant_serialize(v, rws, 0, PCVRNT_SERIALIZE_OPT_PLAIN, NULL);
+
+    size_t len = 0;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(rws, &len);
+    std::string s(buf, len);
+    purc_rwstream_destroy(rws);
+    return s;
+}
+
+/* make and unref the scalar variants */
+
+static void bench_make_null(struct bench_state *st)
+{
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_null();
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_boolean(struct bench_state *st)
+{
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_boolean(_i & 1);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_number(struct bench_state *st)
+{
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_number((double)_i);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_longint(struct bench_state *st)
+{
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_longint((int64_t)_i);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_ulongint(struct bench_state *st)
+{
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_ulongint(_i);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_longdouble(struct bench_state *st)
+{
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_longdouble((long double)_i);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_string(struct bench_state *st)
+{
+    std::string str(st->size, 'x');
+
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_string(str.c_str(), false);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_string_checked(struct bench_state *st)
+{
+    std::string str(st->size, 'x');
+
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_string(str.c_str(), true);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_atom_string(struct bench_state *st)
+{
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_atom_string_static("bench",
+                false);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_byte_sequence(struct bench_state *st)
+{
+    std::string bytes(st->size, '\x5a');
+
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_byte_sequence(bytes.data(),
+                bytes.size());
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_native(struct bench_state *st)
+{
+    static struct purc_native_ops ops = { };
+
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_native(st, &ops);
+        purc_variant_unref(v);
+    }
+}
+
+static void bench_make_tuple(struct bench_state *st)
+{
+    purc_variant_t members[4];
+    for (size_t i = 0; i < 4; i++)
+        members[i] = purc_variant_make_ulongint(i);
+
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_tuple(4, members);
+        purc_variant_unref(v);
+    }
+
+    for (size_t i = 0; i < 4; i++)
+        purc_variant_unref(members[i]);
+}
+
+static void bench_ref_unref(struct bench_state *st)
+{
+    purc_variant_t v = purc_variant_make_string("a string to share", false);
+
+    BENCH_LOOP(st) {
+        purc_variant_ref(v);
+        purc_variant_unref(v);
+    }
+
+    purc_variant_unref(v);
+}
+
+/* containers */
+
+static void bench_make_object(struct bench_state *st)
+{
+    std::vector<std::string> keys = make_keys(st->size);
+
+    BENCH_LOOP(st) {
+        purc_variant_t obj = make_object(keys);
+        purc_variant_unref(obj);
+    }
+}
+
+static void bench_object_get(struct bench_state *st)
+{
+    std::vector<std::string> keys = make_keys(st->size);
+    purc_variant_t obj = make_object(keys);
+
+    BENCH_LOOP(st) {
+        purc_variant_t v;
+        v = purc_variant_object_get_by_ckey(obj,
+                keys[_i % keys.size()].c_str());
+        BENCH_KEEP(v);
+    }
+
+    purc_variant_unref(obj);
+}
+
+static void bench_object_set(struct bench_state *st)
+{
+    std::vector<std::string> keys = make_keys(st->size);
+    purc_variant_t obj = make_object(keys);
+    purc_variant_t v = purc_variant_make_boolean(true);
+
+    /* overwrites the existing properties */
+    BENCH_LOOP(st) {
+        purc_variant_object_set_by_ckey(obj, keys[_i % keys.size()].c_str(), v);
+    }
+
+    purc_variant_unref(v);
+    purc_variant_unref(obj);
+}
+
+static void bench_set_add(struct bench_state *st)
+{
+    std::vector<std::string> keys = make_keys(st->size);
+    std::vector<purc_variant_t> recs;
+    for (size_t i = 0; i < keys.size(); i++)
+        recs.push_back(make_record(keys[i], i));
+
+    /* one operation is adding all records to an empty set */
+    BENCH_LOOP(st) {
+        purc_variant_t set = purc_variant_make_set_by_ckey_ex(0, "id", false,
+                PURC_VARIANT_INVALID);
+        for (size_t i = 0; i < recs.size(); i++)
+            purc_variant_set_add(set, recs[i], PCVRNT_CR_METHOD_OVERWRITE);
+
+        bench_pause(st);
+        purc_variant_unref(set);
+        bench_resume(st);
+    }
+
+    for (size_t i = 0; i < recs.size(); i++)
+        purc_variant_unref(recs[i]);
+}
+
+static void bench_set_find(struct bench_state *st)
+{
+    std::vector<std::string> keys = make_keys(st->size);
+    purc_variant_t set = make_set(keys);
+    std::vector<purc_variant_t> ids;
+    for (size_t i = 0; i < keys.size(); i++)
+        ids.push_back(purc_variant_make_string(keys[i].c_str(), false));
+
+    BENCH_LOOP(st) {
+        purc_variant_t v;
+        v = purc_variant_set_get_member_by_key_values(set,
+                ids[_i % ids.size()]);
+        BENCH_KEEP(v);
+    }
+
+    for (size_t i = 0; i < ids.size(); i++)
+        purc_variant_unref(ids[i]);
+    purc_variant_unref(set);
+}
+
+static void bench_array_append(struct bench_state *st)
+{
+    purc_variant_t v = purc_variant_make_null();
+
+    /* one operation is appending the members to an empty array */
+    BENCH_LOOP(st) {
+        purc_variant_t arr = purc_variant_make_array_0();
+        for (size_t i = 0; i < st->size; i++)
+            purc_variant_array_append(arr, v);
+
+        bench_pause(st);
+        purc_variant_unref(arr);
+        bench_resume(st);
+    }
+
+    purc_variant_unref(v);
+}
+
+static void bench_array_iterate(struct bench_state *st)
+{
+    purc_variant_t arr = make_array(st->size);
+
+    /* one operation is visiting all members */
+    BENCH_LOOP(st) {
+        size_t sz = purc_variant_linear_container_get_size(arr);
+        for (size_t i = 0; i < sz; i++)
+            BENCH_KEEP(purc_variant_linear_container_get(arr, i));
+    }
+
+    purc_variant_unref(arr);
+}
+
+static void bench_clone(struct bench_state *st)
+{
+    purc_variant_t doc = make_document(st->size);
+
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_container_clone_recursively(doc);
+        bench_pause(st);
+        purc_variant_unref(v);
+        bench_resume(st);
+    }
+
+    purc_variant_unref(doc);
+}
+
+static void bench_diff(struct bench_state *st)
+{
+    purc_variant_t doc = make_document(st->size);
+    purc_variant_t cloned = purc_variant_container_clone_recursively(doc);
+
+    /* compares two equal documents: the worst case */
+    BENCH_LOOP(st) {
+        BENCH_KEEP(pcvariant_diff(doc, cloned));
+    }
+
+    purc_variant_unref(cloned);
+    purc_variant_unref(doc);
+}
+
+static void bench_serialize(struct bench_state *st)
+{
+    purc_variant_t doc = make_document(st->size);
+    purc_rwstream_t rws = purc_rwstream_new_buffer(MIN_BUFFER, MAX_BUFFER);
+
+    BENCH_LOOP(st) {
+        purc_rwstream_seek(rws, 0, SEEK_SET);
+        purc_variant_serialize(doc, rws, 0, PCVRNT_SERIALIZE_OPT_PLAIN, NULL);
+    }
+
+    purc_rwstream_destroy(rws);
+    purc_variant_unref(doc);
+}
+
+static void bench_parse_json(struct bench_state *st)
+{
+    purc_variant_t doc = make_document(st->size);
+    std::string json = serialize(doc);
+    purc_variant_unref(doc);
+
+    BENCH_LOOP(st) {
+        purc_variant_t v = purc_variant_make_from_json_string(json.c_str(),
+                json.size());
+        bench_pause(st);
+        purc_variant_unref(v);
+        bench_resume(st);
+    }
+}
+
+static const struct bench_case bench_cases[] = {
+    { "make_null",              bench_make_null,            { 0 } },
+    { "make_boolean",           bench_make_boolean,         { 0 } },
+    { "make_number",            bench_make_number,          { 0 } },
+    { "make_longint",           bench_make_longint,         { 0 } },
+    { "make_ulongint",          bench_make_ulongint,        { 0 } },
+    { "make_longdouble",        bench_make_longdouble,      { 0 } },
+    { "make_string",            bench_make_string,          { 8, 64, 4096 } },
+    { "make_string_checked",    bench_make_string_checked,  { 8, 64, 4096 } },
+    { "make_atom_string",       bench_make_atom_string,     { 0 } },
+    { "make_byte_sequence",     bench_make_byte_sequence,   { 8, 64, 4096 } },
+    { "make_native",            bench_make_native,          { 0 } },
+    { "make_tuple",             bench_make_tuple,           { 0 } },
+    { "ref_unref",              bench_ref_unref,            { 0 } },
+    { "make_object",            bench_make_object,          { 4, 64, 1024 } },
+    { "object_get",             bench_object_get,           { 4, 64, 1024 } },
+    { "object_set",             bench_object_set,           { 4, 64, 1024 } },
+    { "set_add",                bench_set_add,              { 16, 256, 4096 } },
+    { "set_find",               bench_set_find,             { 16, 256, 4096 } },
+    { "array_append",           bench_array_append,         { 16, 256, 4096 } },
+    { "array_iterate",          bench_array_iterate,        { 16, 256, 4096 } },
+    { "clone",                  bench_clone,                { 16, 256 } },
+    { "diff",                   bench_diff,                 { 16, 256 } },
+    { "serialize",              bench_serialize,            { 16, 256 } },
+    { "parse_json",             bench_parse_json,           { 16, 256 } },
+};
+
+enum { FORMAT_TEXT, FORMAT_JSON, FORMAT_CSV };
+
+static void report(int format, bool first, const char *name, size_t size,
+        size_t iterations, double ns_per_op)
+{
+    switch (format) {
+    case FORMAT_JSON:
+        printf("%s\n    {\"name\": \"%s\", \"size\": %zu, "
+                "\"iterations\": %zu, \"ns_per_op\": %.2f}",
+                first ? "" : ",", name, size, iterations, ns_per_op);
+        break;
+
+    case FORMAT_CSV:
+        printf("%s,%zu,%zu,%.2f\n", name, size, iterations, ns_per_op);
+        break;
+
+    default:
+        printf("%-24s %8zu %12zu %14.2f\n", name, size, iterations, ns_per_op);
+        break;
+    }
+}
+
+/* increases the iterations until the benchmark runs long enough */
+static void run_case(const struct bench_case *bc, size_t size,
+        uint64_t min_ns, size_t *iterations, double *ns_per_op)
+{
+    struct bench_state st = { };
+    st.size = size;
+    st.iterations = 1;
+
+    while (true) {
+        bc->func(&st);
+        if (st.elapsed_ns >= min_ns || st.iterations >= (1UL << 30))
+            break;
+
+        size_t next;
+        if (st.elapsed_ns == 0)
+            next = st.iterations * 100;
+        else
+            next = (size_t)(st.iterations * 1.4 * min_ns / st.elapsed_ns);
+        if (next <= st.iterations)
+            next = st.iterations + 1;
+        if (next > st.iterations * 100)
+            next = st.iterations * 100;
+        st.iterations = next;
+    }
+
+    *iterations = st.iterations;
+    *ns_per_op = (double)st.elapsed_ns / st.iterations;
+}
+
+int main(int argc, char **argv)
+{
+    int format = FORMAT_TEXT;
+    const char *filter = NULL;
+    long min_ms = 200;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--format=json") == 0)
+            format = FORMAT_JSON;
+        else if (strcmp(argv[i], "--format=csv") == 0)
+            format = FORMAT_CSV;
+        else if (strcmp(argv[i], "--format=text") == 0)
+            format = FORMAT_TEXT;
+        else if (strncmp(argv[i], "--filter=", 9) == 0)
+            filter = argv[i] + 9;
+        else if (strncmp(argv[i], "--min-time=", 11) == 0)
+            min_ms = atol(argv[i] + 11);
+        else {
+            fprintf(stderr, "Usage: %s [--format=text|json|csv] "
+                    "[--filter=<substring>] [--min-time=<milliseconds>]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (min_ms <= 0)
+        min_ms = 1;
+
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hvml.bench",
+            "bench_variant", &info);
+    if (ret != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize PurC: %d\n", ret);
+        return EXIT_FAILURE;
+    }
+
+    if (format == FORMAT_JSON)
+        printf("{\n  \"benchmarks\": [");
+    else if (format == FORMAT_CSV)
+        printf("name,size,iterations,ns_per_op\n");
+    else
+        printf("%-24s %8s %12s %14s\n", "name", "size", "iterations",
+                "ns/op");
+
+    bool first = true;
+    for (size_t i = 0; i < PCA_TABLESIZE(bench_cases); i++) {
+        const struct bench_case *bc = bench_cases + i;
+        if (filter && strstr(bc->name, filter) == NULL)
+            continue;
+
+        for (size_t j = 0; j == 0 || (j < 4 && bc->sizes[j]); j++) {
+            size_t iterations;
+            double ns_per_op;
+
+            run_case(bc, bc->sizes[j], min_ms * 1000000ULL,
+                    &iterations, &ns_per_op);
+            report(format, first, bc->name, bc->sizes[j],
+                    iterations, ns_per_op);
+            first = false;
+        }
+    }
+
+    if (format == FORMAT_JSON)
+        printf("\n  ]\n}\n");
+
+    purc_cleanup();
+    return EXIT_SUCCESS;
+}
+
@@ -1132,3 +1132,95 @@ TEST(constraint, set_change)
     map_destroy();
 }
 
+
+static bool
+set_in_order(purc_variant_t set, const char *key)
+{
+    bool ok = true;
+    double last = 0;
+    bool first = true;
+    purc_variant_t v;
+    foreach_value_in_variant_set_order(set, v) {
+        double d = 0;
+        purc_variant_t k = purc_variant_object_get_by_ckey(v, key);
+        purc_variant_cast_to_number(k, &d, false);
+        if (!first && d <= last)
+            ok = false;
+        first = false;
+        last = d;
+    } end_foreach;
+    return ok;
+}
+
+TEST(constraint, deferred_revalidation)
+{
+    PurCInstance purc;
+
+    const char *s = "[!id, {id:3, val:c}, {id:1, val:a}, {id:2, val:b}]";
+    purc_variant_t set = pcejson_parser_parse_string(s, 0, 0);
+    ASSERT_NE(set, nullptr);
+    ASSERT_TRUE(set_in_order(set, "id"));
+
+    purc_variant_t members[3];
+    for (size_t i = 0; i < 3; i++) {
+        members[i] = purc_variant_set_get_by_index(set, i);
+        ASSERT_NE(members[i], nullptr);
+    }
+
+    // swap the ids of the first and the last ones, conflicting in between
+    pcvariant_begin_deferred_revalidation();
+    for (size_t i = 0; i < 3; i++) {
+        double d = 0;
+        purc_variant_t k = purc_variant_object_get_by_ckey(members[i], "id");
+        purc_variant_cast_to_number(k, &d, false);
+        purc_variant_t id = purc_variant_make_number(4 - d);
+        bool ok = purc_variant_object_set_by_static_ckey(members[i], "id", id);
+        purc_variant_unref(id);
+        ASSERT_TRUE(ok);
+    }
+    ASSERT_EQ(pcvariant_end_deferred_revalidation(), 0);
+
+    ASSERT_EQ(purc_variant_set_get_size(set), 3);
+    ASSERT_TRUE(set_in_order(set, "id"));
+
+    purc_variant_t id = purc_variant_make_number(1);
+    purc_variant_t v = purc_variant_set_get_member_by_key_values(set, id);
+    purc_variant_unref(id);
+    ASSERT_NE(v, nullptr);
+    ASSERT_STREQ(purc_variant_get_string_const(
+                purc_variant_object_get_by_ckey(v, "val")), "c");
+
+    PURC_VARIANT_SAFE_CLEAR(set);
+}
+
+TEST(constraint, deferred_revalidation_conflict)
+{
+    PurCInstance purc;
+
+    const char *s = "[!id, {id:1, val:a}, {id:2, val:b}, {id:3, val:c}]";
+    purc_variant_t set = pcejson_parser_parse_string(s, 0, 0);
+    ASSERT_NE(set, nullptr);
+
+    purc_variant_t id = purc_variant_make_number(2);
+    purc_variant_t v = purc_variant_set_get_member_by_key_values(set, id);
+    ASSERT_NE(v, nullptr);
+    purc_variant_unref(id);
+
+    id = purc_variant_make_number(3);
+    pcvariant_begin_deferred_revalidation();
+    bool ok = purc_variant_object_set_by_static_ckey(v, "id", id);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(pcvariant_end_deferred_revalidation(), -1);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_DUPLICATED);
+
+    // the conflicting member is removed
+    ASSERT_EQ(purc_variant_set_get_size(set), 2);
+    ASSERT_TRUE(set_in_order(set, "id"));
+    v = purc_variant_set_get_member_by_key_values(set, id);
+    ASSERT_NE(v, nullptr);
+    ASSERT_STREQ(purc_variant_get_string_const(
+                purc_variant_object_get_by_ckey(v, "val")), "c");
+    purc_variant_unref(id);
+
+    PURC_VARIANT_SAFE_CLEAR(set);
+}
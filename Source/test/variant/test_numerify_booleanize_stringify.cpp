@@ -278,6 +278,57 @@ TEST(variant, stringify_alloc)
     ASSERT_EQ (cleanup, true);
 }
 
+static inline void
+do_stringify_to_buff(struct stringify_record *p)
+{
+    purc_variant_t v;
+    v = load_variant(p->str);
+    if (v == PURC_VARIANT_INVALID) {
+        EXPECT_NE(v,PURC_VARIANT_INVALID)
+            << "Failed to load variant: [" << p->str << "]";
+        return;
+    }
+
+    size_t len = strlen(p->chk);
+    ssize_t r = purc_variant_stringify_length(v, 0);
+    ASSERT_EQ(r, (ssize_t)len) << "[" << p->str << "]";
+
+    char buf[8192];
+    r = purc_variant_stringify_to_buff(buf, len + 1, v, 0);
+    ASSERT_EQ(r, (ssize_t)len) << "[" << p->str << "]";
+    ASSERT_STREQ(buf, p->chk) << "[" << p->str << "]";
+
+    /* truncated like snprintf() */
+    if (len > 0) {
+        r = purc_variant_stringify_to_buff(buf, len, v, 0);
+        ASSERT_EQ(r, (ssize_t)len) << "[" << p->str << "]";
+        ASSERT_EQ(strncmp(buf, p->chk, len - 1), 0) << "[" << p->str << "]";
+        ASSERT_EQ(buf[len - 1], '\0') << "[" << p->str << "]";
+    }
+
+    purc_variant_unref(v);
+}
+
+TEST(variant, stringify_to_buff)
+{
+    purc_instance_extra_info info = {};
+    int ret;
+    bool cleanup;
+
+    // initial purc
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    for (size_t i=0; i<PCA_TABLESIZE(records); ++i) {
+        struct stringify_record *p = records + i;
+        do_stringify_to_buff(p);
+    }
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
 struct stringify_bs_record
 {
     const char                *str;
@@ -23,6 +23,9 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 static inline int my_puts(const char* str)
@@ -262,6 +265,21 @@ TEST(variant, serialize_number)
     ASSERT_STREQ(buf, "1.123456");
     purc_variant_unref(my_variant);
 
+    /* case 5: the shortest digits which round-trip */
+    purc_remove_local_data("format-double");
+    my_variant = purc_variant_make_number(-0.1);
+    ASSERT_NE(my_variant, PURC_VARIANT_INVALID);
+
+    len_expected = 0;
+    purc_rwstream_seek(my_rws, 0, SEEK_SET);
+    n = purc_variant_serialize(my_variant, my_rws,
+            0, PCVRNT_SERIALIZE_OPT_PLAIN, &len_expected);
+    ASSERT_GT(n, 0);
+
+    buf[n] = 0;
+    ASSERT_STREQ(buf, "-0.1");
+    purc_variant_unref(my_variant);
+
     purc_rwstream_destroy(my_rws);
 
     purc_cleanup ();
@@ -633,6 +651,49 @@ TEST(variant, serialize_string)
     purc_cleanup ();
 }
 
+TEST(variant, serialize_long_string)
+{
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "variant", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    /* the escapes fall on both sides of the 16-byte blocks */
+    const char *str = "0123456789abcde\"0123456789abcdef\\"
+        "0123456789/abcdef0123456789abcdef\x01tail";
+    const char *escaped = "\"0123456789abcde\\\"0123456789abcdef\\\\"
+        "0123456789\\/abcdef0123456789abcdef\\u0001tail\"";
+    const char *noslash = "\"0123456789abcde\\\"0123456789abcdef\\\\"
+        "0123456789/abcdef0123456789abcdef\\u0001tail\"";
+
+    purc_variant_t my_variant = purc_variant_make_string(str, false);
+    ASSERT_NE(my_variant, PURC_VARIANT_INVALID);
+
+    char buf[128] = { };
+    purc_rwstream_t my_rws = purc_rwstream_new_from_mem(buf, sizeof(buf) - 1);
+    ASSERT_NE(my_rws, nullptr);
+
+    size_t len_expected = 0;
+    ssize_t n = purc_variant_serialize(my_variant, my_rws,
+            0, PCVRNT_SERIALIZE_OPT_PLAIN, &len_expected);
+    ASSERT_EQ(n, (ssize_t)strlen(escaped));
+    ASSERT_EQ(len_expected, strlen(escaped));
+    buf[n] = 0;
+    ASSERT_STREQ(buf, escaped);
+
+    purc_rwstream_seek(my_rws, 0, SEEK_SET);
+    n = purc_variant_serialize(my_variant, my_rws, 0,
+            PCVRNT_SERIALIZE_OPT_PLAIN | PCVRNT_SERIALIZE_OPT_NOSLASHESCAPE,
+            NULL);
+    ASSERT_EQ(n, (ssize_t)strlen(noslash));
+    buf[n] = 0;
+    ASSERT_STREQ(buf, noslash);
+
+    purc_variant_unref(my_variant);
+    purc_rwstream_destroy(my_rws);
+
+    purc_cleanup ();
+}
+
 // to test: serialize a byte sequence
 TEST(variant, serialize_bsequence)
 {
@@ -995,3 +1056,256 @@ TEST(variant, serialize_object_with_empty_key2)
 
     purc_cleanup ();
 }
+
+TEST(variant, serialize_binary)
+{
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "variant", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    static const int64_t i64s[] = { -1, 0, INT64_MAX };
+    purc_variant_t packed = purc_variant_make_packed_array(
+            PCVRNT_PACKED_LONGINT, i64s, 3);
+    purc_variant_t members[] = {
+        purc_variant_make_longint(-5),
+        purc_variant_make_ulongint(UINT64_MAX),
+        purc_variant_make_longdouble(1.5L),
+        purc_variant_make_byte_sequence("\x00\x01\x02", 3),
+        purc_variant_make_atom_string("atom", false),
+        packed,
+    };
+    purc_variant_t tuple = purc_variant_make_tuple(PCA_TABLESIZE(members),
+            members);
+    for (size_t i = 0; i < PCA_TABLESIZE(members); i++)
+        purc_variant_unref(members[i]);
+
+    purc_variant_t id1 = purc_variant_make_string("a", false);
+    purc_variant_t id2 = purc_variant_make_string("B", false);
+    purc_variant_t num = purc_variant_make_number(0.1);
+    purc_variant_t obj1 = purc_variant_make_object_by_static_ckey(2,
+            "id", id1, "v", num);
+    purc_variant_t obj2 = purc_variant_make_object_by_static_ckey(1,
+            "id", id2);
+    purc_variant_t set = purc_variant_make_set_by_ckey_ex(2, "id", true,
+            obj1, obj2);
+    purc_variant_unref(obj1);
+    purc_variant_unref(obj2);
+    purc_variant_unref(id1);
+    purc_variant_unref(id2);
+    purc_variant_unref(num);
+
+    purc_variant_t src = purc_variant_make_array(2, tuple, set);
+    purc_variant_unref(tuple);
+    purc_variant_unref(set);
+    ASSERT_NE(src, PURC_VARIANT_INVALID);
+
+    purc_rwstream_t rws = purc_rwstream_new_buffer(32, 0);
+    ssize_t n = purc_variant_serialize_binary(src, rws);
+    ASSERT_GT(n, 0);
+
+    size_t sz_content;
+    void *buf = purc_rwstream_get_mem_buffer(rws, &sz_content);
+    ASSERT_EQ((size_t)n, sz_content);
+
+    purc_rwstream_t in = purc_rwstream_new_from_mem(buf, sz_content);
+    purc_variant_t dst = purc_variant_load_from_binary(in);
+    ASSERT_NE(dst, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_is_equal_to(src, dst));
+
+    purc_variant_t v = purc_variant_array_get(dst, 0);
+    ASSERT_TRUE(purc_variant_is_tuple(v));
+    ASSERT_TRUE(purc_variant_is_longint(purc_variant_tuple_get(v, 0)));
+    ASSERT_TRUE(purc_variant_is_ulongint(purc_variant_tuple_get(v, 1)));
+    ASSERT_TRUE(purc_variant_is_longdouble(purc_variant_tuple_get(v, 2)));
+    ASSERT_TRUE(purc_variant_is_bsequence(purc_variant_tuple_get(v, 3)));
+    ASSERT_TRUE(purc_variant_is_atomstring(purc_variant_tuple_get(v, 4)));
+
+    pcvrnt_packed_type_k type;
+    size_t nr;
+    ASSERT_NE(purc_variant_array_get_packed(purc_variant_tuple_get(v, 5),
+                &type, &nr), nullptr);
+    ASSERT_EQ(type, PCVRNT_PACKED_LONGINT);
+    ASSERT_EQ(nr, 3);
+
+    v = purc_variant_array_get(dst, 1);
+    const char *unique_keys = NULL;
+    ASSERT_TRUE(purc_variant_set_unique_keys(v, &unique_keys));
+    ASSERT_STREQ(unique_keys, "id");
+    /* the set is still caseless */
+    id1 = purc_variant_make_string("b", false);
+    obj1 = purc_variant_make_object_by_static_ckey(1, "id", id1);
+    ASSERT_EQ(purc_variant_set_add(v, obj1, PCVRNT_CR_METHOD_IGNORE), 0);
+    purc_variant_unref(obj1);
+    purc_variant_unref(id1);
+
+    purc_variant_unref(dst);
+    purc_rwstream_destroy(in);
+
+    /* truncated data */
+    in = purc_rwstream_new_from_mem(buf, sz_content - 1);
+    dst = purc_variant_load_from_binary(in);
+    ASSERT_EQ(dst, PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_NO_DATA);
+    purc_rwstream_destroy(in);
+
+    purc_rwstream_destroy(rws);
+    purc_variant_unref(src);
+
+    purc_cleanup ();
+}
+
+// to test: the incremental serializer yields the same data in chunks
+TEST(variant, serializer_chunked)
+{
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "variant", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    std::string long_str(10000, 'x');
+    long_str[4095] = '"';
+    long_str[4096] = '\n';
+    long_str[9999] = '/';
+
+    static const double ds[] = { 1.0, 0.5, -3.0 };
+    purc_variant_t packed = purc_variant_make_packed_array(
+            PCVRNT_PACKED_NUMBER, ds, 3);
+    purc_variant_t str = purc_variant_make_string(long_str.c_str(), false);
+    purc_variant_t empty = purc_variant_make_array_0();
+    purc_variant_t tuple = purc_variant_make_tuple(2, NULL);
+    purc_variant_t id1 = purc_variant_make_string("a", false);
+    purc_variant_t id2 = purc_variant_make_string("b", false);
+    purc_variant_t obj1 = purc_variant_make_object_by_static_ckey(2,
+            "id", id1, "packed", packed);
+    purc_variant_t obj2 = purc_variant_make_object_by_static_ckey(2,
+            "id", id2, "empty", empty);
+    purc_variant_t set = purc_variant_make_set_by_ckey(2, "id", obj1, obj2);
+    purc_variant_t src = purc_variant_make_object_by_static_ckey(3,
+            "set", set, "str", str, "tuple", tuple);
+    purc_variant_unref(packed);
+    purc_variant_unref(str);
+    purc_variant_unref(empty);
+    purc_variant_unref(tuple);
+    purc_variant_unref(id1);
+    purc_variant_unref(id2);
+    purc_variant_unref(obj1);
+    purc_variant_unref(obj2);
+    purc_variant_unref(set);
+    ASSERT_NE(src, PURC_VARIANT_INVALID);
+
+    static const unsigned int flags[] = {
+        PCVRNT_SERIALIZE_OPT_PLAIN,
+        PCVRNT_SERIALIZE_OPT_SPACED,
+        PCVRNT_SERIALIZE_OPT_PRETTY | PCVRNT_SERIALIZE_OPT_UNIQKEYS,
+        PCVRNT_SERIALIZE_OPT_PRETTY | PCVRNT_SERIALIZE_OPT_PRETTY_TAB |
+            PCVRNT_SERIALIZE_OPT_TUPLE_EJSON,
+    };
+    static const size_t chunk_sizes[] = { 1, 7, 4096, 100000 };
+
+    for (size_t i = 0; i < PCA_TABLESIZE(flags); i++) {
+        purc_rwstream_t rws = purc_rwstream_new_buffer(32, 0);
+        ASSERT_GT(purc_variant_serialize(src, rws, 0, flags[i], NULL), 0);
+
+        size_t sz_expected;
+        const char *expected = (const char *)purc_rwstream_get_mem_buffer(
+                rws, &sz_expected);
+
+        for (size_t j = 0; j < PCA_TABLESIZE(chunk_sizes); j++) {
+            purc_variant_serializer_t ser;
+            ser = purc_variant_serializer_new(src, flags[i]);
+            ASSERT_NE(ser, nullptr);
+
+            std::string result;
+            std::vector<char> buf(chunk_sizes[j]);
+            ssize_t n;
+            while ((n = purc_variant_serializer_read(ser, buf.data(),
+                            buf.size())) > 0) {
+                ASSERT_LE((size_t)n, buf.size());
+                result.append(buf.data(), n);
+                if ((size_t)n < buf.size()) {
+                    ASSERT_TRUE(purc_variant_serializer_is_done(ser));
+                }
+            }
+            ASSERT_EQ(n, 0);
+            ASSERT_TRUE(purc_variant_serializer_is_done(ser));
+            ASSERT_EQ(result, std::string(expected, sz_expected));
+
+            purc_variant_serializer_destroy(ser);
+        }
+
+        purc_rwstream_destroy(rws);
+    }
+
+    /* a scalar */
+    purc_variant_t num = purc_variant_make_longint(123);
+    purc_variant_serializer_t ser = purc_variant_serializer_new(num, 0);
+    char buf[8];
+    ASSERT_EQ(purc_variant_serializer_read(ser, buf, sizeof(buf)), 3);
+    ASSERT_EQ(memcmp(buf, "123", 3), 0);
+    ASSERT_EQ(purc_variant_serializer_read(ser, buf, sizeof(buf)), 0);
+    purc_variant_serializer_destroy(ser);
+    purc_variant_unref(num);
+
+    purc_variant_unref(src);
+
+    purc_cleanup ();
+}
+
+// to test: the strings loaded from a snapshot refer to the mapped file
+TEST(variant, snapshot)
+{
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "variant", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    purc_variant_t name = purc_variant_make_string("名字", false);
+    purc_variant_t bytes = purc_variant_make_byte_sequence("\x01\x02", 2);
+    purc_variant_t num = purc_variant_make_number(1.5);
+    purc_variant_t item = purc_variant_make_object_by_static_ckey(3,
+            "name", name, "bytes", bytes, "num", num);
+    purc_variant_t src = purc_variant_make_array(1, item);
+    purc_variant_unref(name);
+    purc_variant_unref(bytes);
+    purc_variant_unref(num);
+    purc_variant_unref(item);
+    ASSERT_NE(src, PURC_VARIANT_INVALID);
+
+    char path[] = "/tmp/purc-snapshot-XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_file(path, "w");
+    ASSERT_NE(rws, nullptr);
+    ASSERT_GT(purc_variant_serialize_snapshot(src, rws), 0);
+    purc_rwstream_destroy(rws);
+
+    purc_variant_t dst1 = purc_variant_load_snapshot(path);
+    ASSERT_NE(dst1, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_is_equal_to(src, dst1));
+
+    purc_variant_t v = purc_variant_array_get(dst1, 0);
+    v = purc_variant_object_get_by_ckey(v, "name");
+    ASSERT_TRUE(v->flags & PCVRNT_FLAG_STRING_STATIC);
+    size_t nr_chars;
+    ASSERT_TRUE(purc_variant_string_chars(v, &nr_chars));
+    ASSERT_EQ(nr_chars, 2);
+    const char *str1 = purc_variant_get_string_const(v);
+
+    /* the snapshot is mapped only once */
+    purc_variant_t dst2 = purc_variant_load_snapshot(path);
+    ASSERT_NE(dst2, PURC_VARIANT_INVALID);
+    v = purc_variant_array_get(dst2, 0);
+    v = purc_variant_object_get_by_ckey(v, "name");
+    ASSERT_EQ(purc_variant_get_string_const(v), str1);
+
+    purc_variant_unref(dst1);
+    purc_variant_unref(dst2);
+    unlink(path);
+
+    /* not a snapshot */
+    ASSERT_EQ(purc_variant_load_snapshot("/dev/null"), PURC_VARIANT_INVALID);
+
+    purc_variant_unref(src);
+
+    purc_cleanup ();
+}
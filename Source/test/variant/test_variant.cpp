@@ -115,6 +115,65 @@ TEST(variant, pcvariant_init_10_times)
     }
 }
 
+TEST(variant, slab_stat)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test", "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const struct purc_variant_stat * stat = purc_variant_usage_stat ();
+    ASSERT_NE(stat, nullptr);
+    if (stat->nr_slab_blocks == 0) {
+        // the slab allocator is disabled by the environment variable
+        EXPECT_EQ (stat->sz_slab_mem, 0);
+        cleanup = purc_cleanup ();
+        ASSERT_EQ (cleanup, true);
+        return;
+    }
+
+    const size_t nr = 1000;
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, nullptr);
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i);
+        ASSERT_NE(v, nullptr);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+
+    stat = purc_variant_usage_stat ();
+    size_t nr_blocks = stat->nr_slab_blocks;
+    size_t sz_mem = stat->sz_slab_mem;
+    EXPECT_GT (nr_blocks, 1);
+    EXPECT_GE (sz_mem, nr * sizeof(purc_variant));
+
+    purc_variant_unref(arr);
+
+    // the chunks are cached for reusing
+    stat = purc_variant_usage_stat ();
+    EXPECT_EQ (stat->nr_slab_blocks, nr_blocks);
+    EXPECT_GE (stat->nr_slab_cached, nr + 1 - MAX_RESERVED_VARIANTS);
+
+    arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, nullptr);
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i);
+        ASSERT_NE(v, nullptr);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+    stat = purc_variant_usage_stat ();
+    EXPECT_EQ (stat->nr_slab_blocks, nr_blocks);
+    EXPECT_EQ (stat->sz_slab_mem, sz_mem);
+    purc_variant_unref(arr);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
 // to test: only one instance of null variant type.
 // purc_variant_make_null
 TEST(variant, pcvariant_null)
@@ -1593,3 +1652,267 @@ TEST(variant, reuse_buff)
     purc_cleanup ();
 }
 
+
+TEST(variant, string_hash)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test",
+            "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const char *strs[] = {
+        "",
+        "short",
+        "a string longer than the inline space of a variant",
+    };
+
+    for (size_t i = 0; i < PCA_TABLESIZE(strs); i++) {
+        purc_variant_t v1 = purc_variant_make_string(strs[i], false);
+        purc_variant_t v2 = purc_variant_make_string_static(strs[i], false);
+
+        ASSERT_EQ(pcvariant_string_hash(v1), pchash_fnv1a_str_hash(strs[i]));
+        ASSERT_EQ(pcvariant_string_hash(v1), pcvariant_string_hash(v2));
+        ASSERT_TRUE(purc_variant_is_equal_to(v1, v2));
+
+        purc_variant_t v3 = purc_variant_make_string("another", false);
+        pcvariant_string_hash(v3);
+        ASSERT_FALSE(purc_variant_is_equal_to(v1, v3));
+
+        purc_variant_unref(v1);
+        purc_variant_unref(v2);
+        purc_variant_unref(v3);
+    }
+
+    purc_cleanup ();
+}
+
+TEST(variant, trailing_string)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test",
+            "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const struct purc_variant_stat *stat = purc_variant_usage_stat ();
+    size_t sz_string = stat->sz_mem[PURC_VARIANT_TYPE_STRING];
+
+    const char *strs[] = {
+        "sixteen chars...",
+        "a string with thirty chars....",
+        "a string with forty-seven chars fits trailing..",
+        "a string with forty-eight chars is out of chunk.",
+    };
+
+    for (size_t i = 0; i < PCA_TABLESIZE(strs); i++) {
+        size_t len = strlen(strs[i]);
+        purc_variant_t v = purc_variant_make_string(strs[i], false);
+        ASSERT_NE(v, nullptr);
+
+        size_t sz;
+        const char *s = purc_variant_get_string_const_ex(v, &sz);
+        ASSERT_STREQ(s, strs[i]);
+        ASSERT_EQ(sz, len);
+
+        stat = purc_variant_usage_stat ();
+        ASSERT_EQ(stat->sz_mem[PURC_VARIANT_TYPE_STRING],
+                sz_string + sizeof(purc_variant) + len + 1);
+        purc_variant_unref(v);
+
+        stat = purc_variant_usage_stat ();
+        ASSERT_EQ(stat->sz_mem[PURC_VARIANT_TYPE_STRING], sz_string);
+    }
+
+    unsigned char bytes[40];
+    for (size_t i = 0; i < sizeof(bytes); i++)
+        bytes[i] = (unsigned char)i;
+
+    purc_variant_t v = purc_variant_make_byte_sequence(bytes, sizeof(bytes));
+    ASSERT_NE(v, nullptr);
+
+    size_t nr_bytes;
+    const unsigned char *p = purc_variant_get_bytes_const(v, &nr_bytes);
+    ASSERT_EQ(nr_bytes, sizeof(bytes));
+    ASSERT_EQ(memcmp(p, bytes, sizeof(bytes)), 0);
+    purc_variant_unref(v);
+
+    purc_cleanup ();
+}
+
+TEST(variant, interned_string)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test",
+            "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const struct purc_variant_stat *stat = purc_variant_usage_stat ();
+    size_t nr_strings = stat->nr_values[PURC_VARIANT_TYPE_STRING];
+
+    purc_variant_t v1 = purc_variant_make_string_interned("name", true);
+    purc_variant_t v2 = purc_variant_make_string_interned("name", false);
+    purc_variant_t v3 = purc_variant_make_string("name", false);
+    ASSERT_NE(v1, nullptr);
+    ASSERT_EQ(v1, v2);
+    ASSERT_NE(v1, v3);
+    ASSERT_STREQ(purc_variant_get_string_const(v1), "name");
+    ASSERT_TRUE(purc_variant_is_equal_to(v1, v3));
+    ASSERT_EQ(pcvariant_string_hash(v1), pcvariant_string_hash(v3));
+
+    // the interned strings are owned by the heap
+    stat = purc_variant_usage_stat ();
+    ASSERT_EQ(stat->nr_values[PURC_VARIANT_TYPE_STRING], nr_strings + 1);
+
+    purc_variant_unref(v1);
+    purc_variant_unref(v2);
+    purc_variant_unref(v3);
+
+    v1 = purc_variant_make_string_interned("name", false);
+    ASSERT_EQ(v1, v2);
+    purc_variant_unref(v1);
+
+    // the keys of objects from JSON are shared
+    const char *json = "[{\"id\":1, \"name\":\"foo\"}, {\"id\":2, \"name\":\"bar\"}]";
+    purc_variant_t arr = purc_variant_make_from_json_string(json, strlen(json));
+    ASSERT_NE(arr, nullptr);
+
+    purc_variant_t keys[2];
+    for (size_t i = 0; i < 2; i++) {
+        purc_variant_t obj = purc_variant_array_get(arr, i);
+        ASSERT_TRUE(purc_variant_is_object(obj));
+
+        struct pcvrnt_object_iterator *it;
+        it = pcvrnt_object_iterator_create_begin(obj);
+        ASSERT_NE(it, nullptr);
+        keys[i] = pcvrnt_object_iterator_get_key(it);
+        pcvrnt_object_iterator_release(it);
+    }
+    ASSERT_EQ(keys[0], keys[1]);
+    ASSERT_EQ(purc_variant_object_get_by_ckey(
+                purc_variant_array_get(arr, 1), "name") != nullptr, true);
+    purc_variant_unref(arr);
+
+    stat = purc_variant_usage_stat ();
+    ASSERT_EQ(stat->nr_values[PURC_VARIANT_TYPE_STRING], nr_strings);
+
+    purc_cleanup ();
+}
+
+static purc_variant_t
+first_key(purc_variant_t obj)
+{
+    struct pcvrnt_object_iterator *it;
+    it = pcvrnt_object_iterator_create_begin(obj);
+    if (it == NULL)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t k = pcvrnt_object_iterator_get_key(it);
+    pcvrnt_object_iterator_release(it);
+    return k;
+}
+
+TEST(variant, move_interned_keys)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test",
+            "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    purc_variant_t key1 = purc_variant_make_string_interned("key1", false);
+    purc_variant_t key2 = purc_variant_make_string_interned("key2", false);
+    unsigned refc1 = key1->refc;
+    unsigned refc2 = key2->refc;
+
+    // a key of a container and a key of a scalar
+    purc_variant_t sub = purc_variant_make_array_0();
+    purc_variant_t num = purc_variant_make_longint(1);
+    purc_variant_t obj1 = purc_variant_make_object(1, key1, sub);
+    purc_variant_t obj2 = purc_variant_make_object(1, key2, num);
+    purc_variant_unref(sub);
+    purc_variant_unref(num);
+    ASSERT_EQ(first_key(obj1), key1);
+    ASSERT_EQ(first_key(obj2), key2);
+
+    // the objects are still referenced, so they are cloned when moved
+    purc_variant_t arr = purc_variant_make_array(2, obj1, obj2);
+    purc_variant_t moved = pcvariant_move_heap_in(arr);
+    ASSERT_NE(moved, nullptr);
+    moved = pcvariant_move_heap_out(moved);
+    ASSERT_NE(moved, nullptr);
+
+    // the clones do not share the interned keys of this instance
+    purc_variant_t k = first_key(purc_variant_array_get(moved, 0));
+    ASSERT_NE(k, key1);
+    ASSERT_FALSE(k->flags & PCVRNT_FLAG_NOFREE);
+    ASSERT_STREQ(purc_variant_get_string_const(k), "key1");
+    k = first_key(purc_variant_array_get(moved, 1));
+    ASSERT_NE(k, key2);
+    ASSERT_FALSE(k->flags & PCVRNT_FLAG_NOFREE);
+    ASSERT_STREQ(purc_variant_get_string_const(k), "key2");
+
+    purc_variant_unref(moved);
+    ASSERT_EQ(key1->refc, refc1 + 1);
+    ASSERT_EQ(key2->refc, refc2 + 1);
+
+    purc_variant_unref(obj1);
+    purc_variant_unref(obj2);
+    ASSERT_EQ(key1->refc, refc1);
+    ASSERT_EQ(key2->refc, refc2);
+
+    purc_variant_unref(key1);
+    purc_variant_unref(key2);
+
+    purc_cleanup ();
+}
+
+TEST(variant, string_view)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test",
+            "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    char buf[100];
+    memset(buf, 'a', sizeof(buf));
+    buf[sizeof(buf) - 1] = '\0';
+
+    purc_variant_t owner = purc_variant_make_byte_sequence(buf, sizeof(buf));
+    ASSERT_NE(owner, nullptr);
+
+    size_t nr_bytes;
+    const char *bytes =
+        (const char *)purc_variant_get_bytes_const(owner, &nr_bytes);
+
+    // refers to the tail of the buffer
+    purc_variant_t v = purc_variant_make_string_view(owner, bytes + 10,
+            nr_bytes - 11, true);
+    ASSERT_NE(v, nullptr);
+    ASSERT_EQ(purc_variant_ref_count(owner), 2);
+
+    size_t len;
+    const char *str = purc_variant_get_string_const_ex(v, &len);
+    ASSERT_EQ(str, bytes + 10);
+    ASSERT_EQ(len, nr_bytes - 11);
+
+    purc_variant_t v2 = purc_variant_make_string(str, false);
+    ASSERT_TRUE(purc_variant_is_equal_to(v, v2));
+    purc_variant_unref(v2);
+
+    // the owner is kept alive by the view
+    purc_variant_unref(owner);
+    ASSERT_EQ(purc_variant_ref_count(owner), 1);
+    ASSERT_STREQ(purc_variant_get_string_const(v), buf + 10);
+    purc_variant_unref(v);
+
+    // not null-terminated: a copy made
+    owner = purc_variant_make_byte_sequence(buf, sizeof(buf));
+    bytes = (const char *)purc_variant_get_bytes_const(owner, &nr_bytes);
+    v = purc_variant_make_string_view(owner, bytes, 50, false);
+    ASSERT_NE(v, nullptr);
+    ASSERT_EQ(purc_variant_ref_count(owner), 1);
+    ASSERT_NE(purc_variant_get_string_const_ex(v, &len), bytes);
+    ASSERT_EQ(len, 50);
+    purc_variant_unref(v);
+    purc_variant_unref(owner);
+
+    purc_cleanup ();
+}
@@ -533,3 +533,344 @@ TEST(variant_array, sort)
     ASSERT_STREQ(inbuf, outbuf);
 }
 
+static int
+extract_name_age(purc_variant_t member, struct pcvariant_sort_key *keys,
+        void *ud)
+{
+    (void)ud;
+    pcvariant_sort_key_string(keys,
+            purc_variant_object_get_by_ckey(member, "name"));
+    pcvariant_sort_key_number(keys + 1,
+            purc_variant_object_get_by_ckey(member, "age"));
+    return 0;
+}
+
+TEST(variant_array, sort_by_keys)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *json = "["
+        "{\"name\":\"b\",\"age\":2,\"id\":0},"
+        "{\"name\":\"A\",\"age\":3,\"id\":1},"
+        "{\"name\":\"b\",\"age\":1,\"id\":2},"
+        "{\"name\":\"a\",\"age\":3,\"id\":3}"
+    "]";
+    purc_variant_t arr = purc_variant_make_from_json_string(json,
+            strlen(json));
+    ASSERT_NE(arr, nullptr);
+
+    /* the equal members keep their original order */
+    int r = pcvariant_array_sort_by_keys(arr, 2, extract_name_age, NULL,
+            PCVRNT_SORT_CASELESS);
+    ASSERT_EQ(r, 0);
+
+    const int ids[] = { 1, 3, 2, 0 };
+    for (size_t i = 0; i < PCA_TABLESIZE(ids); i++) {
+        purc_variant_t id = purc_variant_object_get_by_ckey(
+                purc_variant_array_get(arr, i), "id");
+        ASSERT_EQ(purc_variant_numerify(id), ids[i]);
+    }
+
+    r = pcvariant_array_sort_by_keys(arr, 2, extract_name_age, NULL,
+            PCVRNT_SORT_DESC);
+    ASSERT_EQ(r, 0);
+
+    const int desc_ids[] = { 0, 2, 3, 1 };
+    for (size_t i = 0; i < PCA_TABLESIZE(desc_ids); i++) {
+        purc_variant_t id = purc_variant_object_get_by_ckey(
+                purc_variant_array_get(arr, i), "id");
+        ASSERT_EQ(purc_variant_numerify(id), desc_ids[i]);
+    }
+
+    purc_variant_unref(arr);
+
+    bool cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
+
+TEST(variant_array, insert_set_remove_in_middle)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+    const struct purc_variant_stat *stat;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    stat = purc_variant_usage_stat();
+    ASSERT_NE(stat, nullptr);
+
+    purc_variant_t arr = purc_variant_make_array(0, NULL);
+    ASSERT_NE(arr, nullptr);
+
+    // 0, 2, 4, ..., 998
+    const size_t count = 500;
+    for (size_t i = 0; i < count; i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i * 2);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+
+    // 0, 1, 2, 3, ..., 998, 999
+    for (size_t i = 0; i < count; i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i * 2 + 1);
+        ASSERT_TRUE(purc_variant_array_insert_after(arr, i * 2, v));
+        purc_variant_unref(v);
+    }
+    ASSERT_EQ(purc_variant_array_get_size(arr), count * 2);
+
+    uint64_t u;
+    purc_variant_t val;
+    size_t idx;
+    foreach_value_in_variant_array(arr, val, idx)
+        ASSERT_TRUE(purc_variant_cast_to_ulongint(val, &u, false));
+        ASSERT_EQ(u, idx);
+    end_foreach;
+
+    // the array can hold the same container more than once
+    purc_variant_t obj = purc_variant_make_object_0();
+    ASSERT_TRUE(purc_variant_array_set(arr, 10, obj));
+    ASSERT_TRUE(purc_variant_array_set(arr, 20, obj));
+    ASSERT_EQ(obj->refc, 3);
+    ASSERT_EQ(purc_variant_array_get(arr, 10), obj);
+    ASSERT_EQ(purc_variant_array_get(arr, 20), obj);
+
+    ASSERT_TRUE(purc_variant_array_remove(arr, 10));
+    ASSERT_EQ(obj->refc, 2);
+    ASSERT_EQ(purc_variant_array_get(arr, 19), obj);
+    purc_variant_unref(obj);
+
+    // remove the elements at odd positions
+    foreach_value_in_variant_array_reverse_safe(arr, val, idx)
+        if (idx % 2) {
+            ASSERT_TRUE(purc_variant_array_remove(arr, idx));
+        }
+    end_foreach;
+    ASSERT_EQ(purc_variant_array_get_size(arr), count);
+
+    purc_variant_unref(arr);
+    ASSERT_EQ(stat->nr_values[PVT(_ARRAY)], 0);
+    ASSERT_EQ(stat->nr_values[PVT(_OBJECT)], 0);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
+static ssize_t
+serialize(purc_variant_t v, char *buf, size_t sz)
+{
+    purc_rwstream_t rws = purc_rwstream_new_from_mem(buf, sz - 1);
+    ssize_t n = purc_variant_serialize(v, rws, 0,
+            PCVRNT_SERIALIZE_OPT_PLAIN, NULL);
+    purc_rwstream_destroy(rws);
+    if (n >= 0)
+        buf[n] = 0;
+    return n;
+}
+
+TEST(variant_array, packed)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+    const struct purc_variant_stat *stat;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    stat = purc_variant_usage_stat();
+    ASSERT_NE(stat, nullptr);
+
+    const double dbls[] = { 1.0, 2.5, -3.0, 1e10, 0.125 };
+    const size_t nr = PCA_TABLESIZE(dbls);
+
+    purc_variant_t packed;
+    packed = purc_variant_make_packed_array(PCVRNT_PACKED_NUMBER, dbls, nr);
+    ASSERT_NE(packed, nullptr);
+    ASSERT_EQ(purc_variant_array_get_size(packed), nr);
+    ASSERT_EQ(stat->nr_values[PVT(_NUMBER)], 0);
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_number(dbls[i]);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+
+    // serializing does not box the elements
+    char buf1[256], buf2[256];
+    ASSERT_GT(serialize(packed, buf1, sizeof(buf1)), 0);
+    ASSERT_GT(serialize(arr, buf2, sizeof(buf2)), 0);
+    ASSERT_STREQ(buf1, buf2);
+
+    pcvrnt_packed_type_k type;
+    size_t n;
+    const double *elems = (const double *)
+        purc_variant_array_get_packed(packed, &type, &n);
+    ASSERT_NE(elems, nullptr);
+    ASSERT_EQ(type, PCVRNT_PACKED_NUMBER);
+    ASSERT_EQ(n, nr);
+    ASSERT_EQ(elems[1], 2.5);
+
+    // cloning keeps the elements packed
+    purc_variant_t cloned = purc_variant_container_clone(packed);
+    ASSERT_NE(purc_variant_array_get_packed(cloned, &type, NULL), nullptr);
+    purc_variant_unref(cloned);
+
+    // accessing by element boxes the elements
+    purc_variant_t v = purc_variant_array_get(packed, 3);
+    ASSERT_NE(v, nullptr);
+    ASSERT_EQ(v->type, PVT(_NUMBER));
+    ASSERT_EQ(v->d, 1e10);
+    ASSERT_EQ(purc_variant_array_get_packed(packed, &type, NULL), nullptr);
+    ASSERT_EQ(type, PCVRNT_PACKED_NONE);
+    ASSERT_EQ(stat->nr_values[PVT(_NUMBER)], nr * 2);
+    ASSERT_TRUE(purc_variant_is_equal_to(packed, arr));
+
+    purc_variant_unref(packed);
+    purc_variant_unref(arr);
+
+    const int64_t i64s[] = { -1, 0, 1 };
+    packed = purc_variant_make_packed_array(PCVRNT_PACKED_LONGINT, i64s, 3);
+    ASSERT_GT(serialize(packed, buf1, sizeof(buf1)), 0);
+    ASSERT_STREQ(buf1, "[-1,0,1]");
+    purc_variant_unref(packed);
+
+    ASSERT_EQ(stat->nr_values[PVT(_ARRAY)], 0);
+    ASSERT_EQ(stat->nr_values[PVT(_NUMBER)], 0);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
+TEST(variant_array, copy_on_write_clone)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+    const struct purc_variant_stat *stat;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    stat = purc_variant_usage_stat();
+    ASSERT_NE(stat, nullptr);
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    for (int i = 0; i < 10; i++) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+
+    // the clone shares the elements
+    purc_variant_t first = purc_variant_array_get(arr, 0);
+    purc_variant_t cloned = purc_variant_container_clone_recursively(arr);
+    ASSERT_NE(cloned, nullptr);
+    ASSERT_EQ(first->refc, 1);
+    ASSERT_EQ(purc_variant_array_get(cloned, 0), first);
+    ASSERT_TRUE(purc_variant_is_equal_to(arr, cloned));
+
+    // changing the clone does not affect the source
+    purc_variant_t v = purc_variant_make_string("changed", false);
+    ASSERT_TRUE(purc_variant_array_set(cloned, 0, v));
+    purc_variant_unref(v);
+    ASSERT_EQ(purc_variant_array_get(arr, 0), first);
+    ASSERT_EQ(first->refc, 1);
+    ASSERT_TRUE(purc_variant_array_remove(cloned, 9));
+    ASSERT_EQ(purc_variant_array_get_size(arr), 10);
+    ASSERT_EQ(purc_variant_array_get_size(cloned), 9);
+    purc_variant_unref(cloned);
+
+    // changing the source does not affect the clone
+    cloned = purc_variant_container_clone(arr);
+    ASSERT_TRUE(purc_variant_array_remove(arr, 0));
+    ASSERT_EQ(purc_variant_array_get(cloned, 0), first);
+    ASSERT_EQ(purc_variant_array_get_size(cloned), 10);
+    purc_variant_unref(arr);
+    ASSERT_EQ(stat->nr_values[PVT(_LONGINT)], 10);
+    purc_variant_unref(cloned);
+
+    ASSERT_EQ(stat->nr_values[PVT(_ARRAY)], 0);
+    ASSERT_EQ(stat->nr_values[PVT(_LONGINT)], 0);
+
+    // an array with container elements is copied deeply
+    purc_variant_t obj = purc_variant_make_object_0();
+    arr = purc_variant_make_array(1, obj);
+    cloned = purc_variant_container_clone_recursively(arr);
+    ASSERT_NE(purc_variant_array_get(cloned, 0), obj);
+    purc_variant_unref(cloned);
+    purc_variant_unref(arr);
+    purc_variant_unref(obj);
+    ASSERT_EQ(stat->nr_values[PVT(_OBJECT)], 0);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
+static bool
+on_arr_grown(purc_variant_t src, pcvar_op_t op, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    (void)src;
+    (void)op;
+    EXPECT_EQ(nr_args, 2);
+
+    size_t *nr_fired = (size_t *)ctxt;
+    int64_t pos;
+    EXPECT_TRUE(purc_variant_cast_to_longint(argv[0], &pos, false));
+    EXPECT_EQ((size_t)pos, *nr_fired);
+    (*nr_fired)++;
+    return true;
+}
+
+TEST(variant_array, listener_fast_path)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+    const struct purc_variant_stat *stat;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    stat = purc_variant_usage_stat();
+    ASSERT_NE(stat, nullptr);
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    purc_variant_t v = purc_variant_make_null();
+
+    size_t nr_fired = 0;
+    struct pcvar_listener *listener;
+    listener = purc_variant_register_post_listener(arr,
+            PCVAR_OPERATION_GROW, on_arr_grown, &nr_fired);
+    ASSERT_NE(listener, nullptr);
+
+    ASSERT_TRUE(purc_variant_array_append(arr, v));
+    ASSERT_TRUE(purc_variant_array_append(arr, v));
+    ASSERT_EQ(nr_fired, 2);
+
+    ASSERT_TRUE(purc_variant_revoke_listener(arr, listener));
+
+    // not fired any more
+    ASSERT_TRUE(purc_variant_array_append(arr, v));
+    ASSERT_TRUE(purc_variant_array_remove(arr, 0));
+    ASSERT_EQ(nr_fired, 2);
+    ASSERT_EQ(purc_variant_array_get_size(arr), 2);
+
+    purc_variant_unref(v);
+    purc_variant_unref(arr);
+    ASSERT_EQ(stat->nr_values[PVT(_ARRAY)], 0);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
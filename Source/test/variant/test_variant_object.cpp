@@ -467,3 +467,109 @@ TEST(object, compare)
     purc_variant_unref(obj2);
 }
 
+
+TEST(object, many_keys)
+{
+    PurCInstance purc;
+
+    const int nr_keys = 1000;
+    char key[32];
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    ASSERT_NE(obj, nullptr);
+
+    for (int i = 0; i < nr_keys; i++) {
+        snprintf(key, sizeof(key), "key%04d", i);
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_TRUE(purc_variant_object_set_by_static_ckey(obj, key, v));
+        purc_variant_unref(v);
+    }
+    ASSERT_EQ(purc_variant_object_get_size(obj), nr_keys);
+
+    // overwrite with new key variants holding the same strings
+    for (int i = 0; i < nr_keys; i += 2) {
+        snprintf(key, sizeof(key), "key%04d", i);
+        purc_variant_t k = purc_variant_make_string(key, false);
+        purc_variant_t v = purc_variant_make_longint(-i);
+        ASSERT_TRUE(purc_variant_object_set(obj, k, v));
+        purc_variant_unref(k);
+        purc_variant_unref(v);
+    }
+
+    for (int i = 0; i < nr_keys; i += 3) {
+        snprintf(key, sizeof(key), "key%04d", i);
+        ASSERT_TRUE(purc_variant_object_remove_by_ckey(obj, key, false));
+    }
+
+    size_t nr = 0;
+    for (int i = 0; i < nr_keys; i++) {
+        snprintf(key, sizeof(key), "key%04d", i);
+        purc_variant_t v = purc_variant_object_get_by_ckey(obj, key);
+        if (i % 3 == 0) {
+            ASSERT_EQ(v, nullptr);
+            purc_clr_error();
+            continue;
+        }
+
+        int64_t i64;
+        ASSERT_NE(v, nullptr);
+        ASSERT_TRUE(purc_variant_cast_to_longint(v, &i64, false));
+        ASSERT_EQ(i64, (i % 2) ? i : -i);
+        nr++;
+    }
+    ASSERT_EQ(purc_variant_object_get_size(obj), nr);
+
+    // the traversal keeps the order of keys
+    const char *prev = NULL;
+    purc_variant_t k, v;
+    foreach_key_value_in_variant_object(obj, k, v) {
+        (void)v;
+        const char *sk = purc_variant_get_string_const(k);
+        if (prev) {
+            ASSERT_LT(strcmp(prev, sk), 0);
+        }
+        prev = sk;
+    } end_foreach;
+
+    purc_variant_unref(obj);
+}
+
+TEST(object, reuse_inline_nodes)
+{
+    PurCInstance purc;
+
+    const char *keys[] = { "a", "b", "c", "d", "e", "f", "g", "h", "i", "j" };
+    purc_variant_t obj = purc_variant_make_object_0();
+    ASSERT_NE(obj, nullptr);
+
+    for (int round = 0; round < 3; round++) {
+        for (size_t i = 0; i < PCA_TABLESIZE(keys); i++) {
+            purc_variant_t v = purc_variant_make_ulongint(i);
+            ASSERT_TRUE(purc_variant_object_set_by_static_ckey(obj,
+                        keys[i], v));
+            purc_variant_unref(v);
+        }
+        ASSERT_EQ(purc_variant_object_get_size(obj), PCA_TABLESIZE(keys));
+
+        for (size_t i = round; i < PCA_TABLESIZE(keys); i += 2) {
+            ASSERT_TRUE(purc_variant_object_remove_by_ckey(obj,
+                        keys[i], false));
+        }
+
+        for (size_t i = 0; i < PCA_TABLESIZE(keys); i++) {
+            purc_variant_t v = purc_variant_object_get_by_ckey(obj, keys[i]);
+            if ((i % 2) == (size_t)(round % 2) && i >= (size_t)round) {
+                ASSERT_EQ(v, nullptr);
+                purc_clr_error();
+            }
+            else {
+                uint64_t u64;
+                ASSERT_NE(v, nullptr);
+                ASSERT_TRUE(purc_variant_cast_to_ulongint(v, &u64, false));
+                ASSERT_EQ(u64, i);
+            }
+        }
+    }
+
+    purc_variant_unref(obj);
+}
@@ -410,6 +410,157 @@ TEST(variant_set, dup)
     ASSERT_EQ (cleanup, true);
 }
 
+static purc_variant_t
+make_record(int64_t id, const char *name)
+{
+    purc_variant_t i = purc_variant_make_longint(id);
+    purc_variant_t n = purc_variant_make_string(name, false);
+    purc_variant_t o = purc_variant_make_object_by_static_ckey(2,
+            "id", i, "name", n);
+    purc_variant_unref(i);
+    purc_variant_unref(n);
+    return o;
+}
+
+TEST(variant_set, many_records)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const size_t nr = 1000;
+    purc_variant_t set = purc_variant_make_set_by_ckey_ex(0, "id name",
+            true, PURC_VARIANT_INVALID);
+    ASSERT_NE(set, nullptr);
+
+    char name[32];
+    for (size_t i = 0; i < nr; i++) {
+        snprintf(name, sizeof(name), "name-%zu", i % 10);
+        purc_variant_t v = make_record(i, name);
+        ASSERT_NE(v, nullptr);
+        ssize_t r = purc_variant_set_add(set, v, PCVRNT_CR_METHOD_COMPLAIN);
+        purc_variant_unref(v);
+        ASSERT_EQ(r, 1);
+    }
+
+    size_t sz;
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, nr);
+
+    // duplicated records under the caseless method
+    for (size_t i = 0; i < nr; i += 7) {
+        snprintf(name, sizeof(name), "NAME-%zu", i % 10);
+        purc_variant_t v = make_record(i, name);
+        ASSERT_NE(v, nullptr);
+        ssize_t r = purc_variant_set_add(set, v, PCVRNT_CR_METHOD_COMPLAIN);
+        ASSERT_EQ(r, -1);
+        r = purc_variant_set_add(set, v, PCVRNT_CR_METHOD_OVERWRITE);
+        purc_variant_unref(v);
+        ASSERT_EQ(r, 1);
+    }
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, nr);
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t id = purc_variant_make_longint(i);
+        snprintf(name, sizeof(name), "Name-%zu", i % 10);
+        purc_variant_t n = purc_variant_make_string(name, false);
+        purc_variant_t v;
+        v = purc_variant_set_get_member_by_key_values(set, id, n);
+        ASSERT_NE(v, nullptr);
+
+        snprintf(name, sizeof(name), "name-%zu", (i + 1) % 10);
+        purc_variant_unref(n);
+        n = purc_variant_make_string(name, false);
+        v = purc_variant_set_get_member_by_key_values(set, id, n);
+        ASSERT_EQ(v, nullptr);
+
+        purc_variant_unref(id);
+        purc_variant_unref(n);
+    }
+
+    for (size_t i = 0; i < nr; i += 2) {
+        snprintf(name, sizeof(name), "name-%zu", i % 10);
+        purc_variant_t v = make_record(i, name);
+        ASSERT_NE(v, nullptr);
+        ssize_t r = purc_variant_set_remove(set, v, PCVRNT_NR_METHOD_COMPLAIN);
+        ASSERT_EQ(r, 1);
+        r = purc_variant_set_remove(set, v, PCVRNT_NR_METHOD_IGNORE);
+        purc_variant_unref(v);
+        ASSERT_EQ(r, 0);
+    }
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, nr / 2);
+    ASSERT_TRUE(sanity_check(set));
+
+    purc_variant_unref(set);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
+TEST(variant_set, make_by_members)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const size_t nr = 200;
+    purc_variant_t members[nr];
+    char name[32];
+    for (size_t i = 0; i < nr; i++) {
+        // every id appears twice
+        snprintf(name, sizeof(name), "name-%zu", i);
+        members[i] = make_record(i % (nr / 2), name);
+        ASSERT_NE(members[i], nullptr);
+    }
+
+    purc_variant_t set = purc_variant_make_set_by_members(nr, "id",
+            false, members);
+    ASSERT_NE(set, nullptr);
+
+    size_t sz;
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, nr / 2);
+    ASSERT_TRUE(sanity_check(set));
+
+    // the later member overwrites the earlier one
+    for (size_t i = 0; i < nr / 2; i++) {
+        purc_variant_t id = purc_variant_make_longint(i);
+        purc_variant_t v;
+        v = purc_variant_set_get_member_by_key_values(set, id);
+        purc_variant_unref(id);
+        ASSERT_EQ(v, members[i + nr / 2]);
+    }
+
+    // the members are still constrained by the set
+    purc_variant_t id = purc_variant_make_longint(0);
+    ASSERT_FALSE(purc_variant_object_set_by_static_ckey(members[nr - 1],
+                "id", id));
+    purc_variant_unref(id);
+
+    for (size_t i = 0; i < nr; i++)
+        purc_variant_unref(members[i]);
+    purc_variant_unref(set);
+
+    set = purc_variant_make_set_by_members(0, NULL, false, NULL);
+    ASSERT_NE(set, nullptr);
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, 0);
+    purc_variant_unref(set);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
 static inline purc_variant_t
 make_set(const int *vals, size_t nr)
 {
@@ -341,3 +341,153 @@ TEST(vcm, again_ex)
 
     purc_cleanup();
 }
+
+TEST(vcm, const_folding)
+{
+    const char *ejson = "[1, 'hello', {k: [true, 2.0]}]";
+    size_t sz = strlen(ejson);
+
+    purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+            "vcm_eval", NULL);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void*)ejson, sz);
+    ASSERT_NE(rws, nullptr);
+
+    struct purc_ejson_parsing_tree *tree = purc_variant_ejson_parse_stream(rws);
+    ASSERT_NE(tree, nullptr);
+
+    struct pcvcm_node *root = (struct pcvcm_node *)tree;
+    purc_variant_t first = pcvcm_eval_ex(root, NULL, find_var, NULL, false);
+    ASSERT_NE(first, PURC_VARIANT_INVALID);
+    ASSERT_EQ(root->const_state, PCVCM_NODE_CONST_YES);
+    ASSERT_NE(root->stamp, 0);
+
+    /* only the root of a constant subtree is cached */
+    struct pcvcm_node *str = (struct pcvcm_node *)
+        pctree_node_child(&root->tree_node)->next;
+    ASSERT_EQ(str->type, PCVCM_NODE_TYPE_STRING);
+    ASSERT_EQ(str->const_state, PCVCM_NODE_CONST_YES);
+    ASSERT_EQ(str->stamp, 0);
+
+    /* a mutation of an evaluated result must not affect the later ones */
+    purc_variant_t v = purc_variant_make_null();
+    ASSERT_TRUE(purc_variant_array_append(first, v));
+    purc_variant_unref(v);
+
+    for (int i = 0; i < 3; i++) {
+        v = pcvcm_eval_ex(root, NULL, find_var, NULL, false);
+        ASSERT_NE(v, PURC_VARIANT_INVALID);
+        ASSERT_NE(v, first);
+        ASSERT_EQ(purc_variant_array_get_size(v), 3);
+
+        purc_variant_t s = purc_variant_array_get(v, 1);
+        ASSERT_STREQ(purc_variant_get_string_const(s), "hello");
+
+        /* mutate it as well */
+        ASSERT_TRUE(purc_variant_array_append(v, s));
+        purc_variant_unref(v);
+    }
+
+    purc_variant_unref(first);
+    purc_ejson_parsing_tree_destroy(tree);
+    purc_rwstream_destroy(rws);
+
+    /* any variable reference makes the enclosing nodes non-constant */
+    ejson = "[1, $AGAIN]";
+    rws = purc_rwstream_new_from_mem((void*)ejson, strlen(ejson));
+    ASSERT_NE(rws, nullptr);
+    tree = purc_variant_ejson_parse_stream(rws);
+    ASSERT_NE(tree, nullptr);
+
+    purc_variant_t nv = purc_variant_make_string("again", false);
+    root = (struct pcvcm_node *)tree;
+    v = pcvcm_eval_ex(root, NULL, find_var, nv, false);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    ASSERT_EQ(root->const_state, PCVCM_NODE_CONST_NO);
+    ASSERT_EQ(root->stamp, 0);
+    ASSERT_EQ(pcvcm_node_first_child(root)->const_state,
+            PCVCM_NODE_CONST_YES);
+    purc_variant_unref(v);
+
+    purc_variant_unref(nv);
+    purc_ejson_parsing_tree_destroy(tree);
+    purc_rwstream_destroy(rws);
+
+    purc_cleanup();
+}
+
+TEST(vcm, bytecode)
+{
+    purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+            "vcm_eval", NULL);
+
+    /* the tree is compiled when it is evaluated for the second time */
+    const char *ejson = "[$OBJ.a.b, $OBJ.a, 'x', {k: $OBJ.a.b}]";
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void*)ejson,
+            strlen(ejson));
+    ASSERT_NE(rws, nullptr);
+    struct purc_ejson_parsing_tree *tree = purc_variant_ejson_parse_stream(rws);
+    ASSERT_NE(tree, nullptr);
+
+    purc_variant_t obj = purc_variant_make_from_json_string(
+            "{\"a\": {\"b\": 10}}", 16);
+    ASSERT_NE(obj, nullptr);
+
+    struct pcvcm_node *root = (struct pcvcm_node *)tree;
+    purc_variant_t first = pcvcm_eval_ex(root, NULL, find_var, obj, false);
+    ASSERT_NE(first, PURC_VARIANT_INVALID);
+    ASSERT_EQ(root->bytecode, nullptr);
+
+    for (int i = 0; i < 3; i++) {
+        purc_variant_t v = pcvcm_eval_ex(root, NULL, find_var, obj, false);
+        ASSERT_NE(v, PURC_VARIANT_INVALID);
+        ASSERT_NE(root->bytecode, nullptr);
+        ASSERT_TRUE(purc_variant_is_equal_to(v, first));
+        purc_variant_unref(v);
+    }
+
+    purc_variant_unref(first);
+    purc_variant_unref(obj);
+    purc_ejson_parsing_tree_destroy(tree);
+    purc_rwstream_destroy(rws);
+
+    /* an AGAIN error in the bytecode is resumed by the frame interpreter */
+    ejson = "{name:[$AGAIN.name]}";
+    rws = purc_rwstream_new_from_mem((void*)ejson, strlen(ejson));
+    ASSERT_NE(rws, nullptr);
+    tree = purc_variant_ejson_parse_stream(rws);
+    ASSERT_NE(tree, nullptr);
+
+    purc_variant_t nv = vcm_again_variant_create();
+    ASSERT_NE(nv, nullptr);
+
+    for (int i = 0; i < 3; i++) {
+        struct pcvcm_eval_ctxt *ctxt = NULL;
+        purc_variant_t v = pcvcm_eval_ex((struct pcvcm_node*)tree, &ctxt,
+                find_var, nv, false);
+        ASSERT_EQ(v, PURC_VARIANT_INVALID);
+        ASSERT_NE(ctxt, nullptr);
+        ASSERT_EQ(purc_get_last_error(), PURC_ERROR_AGAIN);
+
+        v = pcvcm_eval_again_ex((struct pcvcm_node *)tree,
+                ctxt, find_var, nv, false, false);
+        ASSERT_NE(v, PURC_VARIANT_INVALID);
+        ASSERT_TRUE(purc_variant_is_object(v));
+
+        purc_variant_t name = purc_variant_object_get_by_ckey(v, "name");
+        ASSERT_NE(name, PURC_VARIANT_INVALID);
+        ASSERT_EQ(purc_variant_array_get_size(name), 1);
+        ASSERT_STREQ(purc_variant_get_string_const(
+                    purc_variant_array_get(name, 0)), VCM_AGAIN_NAME);
+
+        pcvcm_eval_ctxt_destroy(ctxt);
+        purc_variant_unref(v);
+    }
+    ASSERT_NE(((struct pcvcm_node *)tree)->bytecode, nullptr);
+
+    purc_variant_unref(nv);
+    purc_ejson_parsing_tree_destroy(tree);
+    purc_rwstream_destroy(rws);
+
+    purc_cleanup();
+}
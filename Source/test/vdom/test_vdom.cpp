@@ -23,6 +23,7 @@
 #include "../helpers.h"
 
 #include <gtest/gtest.h>
+#include <pthread.h>
 
 static int _element_count(struct pcvdom_element *top,
     struct pcvdom_element *elem, void *ctx)
@@ -129,6 +130,72 @@ TEST(vdom, basic)
     pcvdom_document_unref(doc);
 }
 
+TEST(vdom, arena)
+{
+    PurCInstance purc("cn.fmsoft.hybridos.test", "test_init", false);
+
+    struct pcvdom_document *doc;
+    doc = pcvdom_document_create_with_doctype("hvml", "v: MATH FS");
+    ASSERT_NE(doc, nullptr);
+
+    struct pcvdom_element *root;
+    root = pcvdom_document_create_element_c(doc, "hvml");
+    ASSERT_NE(root, nullptr);
+    EXPECT_EQ(0, pcvdom_document_set_root(doc, root));
+
+    struct pcvdom_element *elem1, *elem2;
+    elem1 = pcvdom_document_create_element_c(doc, "foo-bar");
+    ASSERT_NE(elem1, nullptr);
+    EXPECT_EQ(0, pcvdom_element_append_element(root, elem1));
+    elem2 = pcvdom_document_create_element_c(doc, "foo-bar");
+    ASSERT_NE(elem2, nullptr);
+    EXPECT_EQ(0, pcvdom_element_append_element(root, elem2));
+
+    /* the names not pre-defined are interned */
+    EXPECT_STREQ(pcvdom_element_get_tagname(elem1), "foo-bar");
+    EXPECT_EQ(pcvdom_element_get_tagname(elem1),
+            pcvdom_element_get_tagname(elem2));
+
+    struct pcvdom_element *heap = pcvdom_element_create_c("foo-bar");
+    ASSERT_NE(heap, nullptr);
+    EXPECT_EQ(pcvdom_element_get_tagname(heap),
+            pcvdom_element_get_tagname(elem1));
+    pcvdom_node_destroy(pcvdom_node_from_element(heap));
+
+    struct pcvdom_attr *attr;
+    attr = pcvdom_document_create_attr(doc, "data-foo",
+            PCHVML_ATTRIBUTE_OPERATOR, NULL);
+    ASSERT_NE(attr, nullptr);
+    ASSERT_EQ(0, pcvdom_element_append_attr(elem1, attr));
+    attr = pcvdom_document_create_attr(doc, "for",
+            PCHVML_ATTRIBUTE_OPERATOR, NULL);
+    ASSERT_NE(attr, nullptr);
+    ASSERT_EQ(0, pcvdom_element_append_attr(elem1, attr));
+    EXPECT_NE(pcvdom_element_get_attr_c(elem1, "data-foo"), nullptr);
+    EXPECT_NE(pcvdom_element_get_attr_c(elem1, "for"), nullptr);
+    EXPECT_EQ(pcvdom_element_get_attr_c(elem2, "for"), nullptr);
+
+    struct pcvdom_comment *comment;
+    comment = pcvdom_document_create_comment(doc, "hello world");
+    ASSERT_NE(comment, nullptr);
+    EXPECT_EQ(0, pcvdom_element_append_comment(elem2, comment));
+
+    /* a node in the arena can still be removed and destroyed alone */
+    struct pcvdom_element *elem3;
+    elem3 = pcvdom_document_create_element_c(doc, "div");
+    ASSERT_NE(elem3, nullptr);
+    EXPECT_EQ(0, pcvdom_element_append_element(root, elem3));
+    pcvdom_node_remove(pcvdom_node_from_element(elem3));
+    pcvdom_node_destroy(pcvdom_node_from_element(elem3));
+
+    int nodes = 0;
+    struct pcvdom_node *node = pcvdom_node_from_document(doc);
+    EXPECT_EQ(0, pcvdom_node_traverse(node, &nodes, _node_count));
+    EXPECT_EQ(nodes, 5);
+
+    pcvdom_document_unref(doc);
+}
+
 TEST(vdom, fragment)
 {
     PurCInstance purc("cn.fmsoft.hybridos.test", "test_init", false);
@@ -143,3 +210,43 @@ TEST(vdom, fragment)
     }
 }
 
+
+#define NR_SHARING_THREADS      4
+
+static const char *shared_hvml =
+    "<hvml><body><p>$SYS.time</p></body></hvml>";
+
+static void *_load_shared(void *arg)
+{
+    purc_vdom_t *vdom = (purc_vdom_t *)arg;
+    char runner[32];
+
+    snprintf(runner, sizeof(runner), "loader%p", arg);
+    if (purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hybridos.test",
+                runner, NULL) != PURC_ERROR_OK)
+        return NULL;
+
+    *vdom = purc_load_hvml_from_string(shared_hvml);
+    purc_cleanup();
+    return NULL;
+}
+
+TEST(vdom, shared_cache)
+{
+    pthread_t threads[NR_SHARING_THREADS];
+    purc_vdom_t vdoms[NR_SHARING_THREADS] = { };
+
+    for (int i = 0; i < NR_SHARING_THREADS; i++) {
+        ASSERT_EQ(pthread_create(threads + i, NULL, _load_shared, vdoms + i),
+                0);
+    }
+    for (int i = 0; i < NR_SHARING_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* all instances in the process share the vDOM of the same program */
+    ASSERT_NE(vdoms[0], nullptr);
+    for (int i = 1; i < NR_SHARING_THREADS; i++) {
+        EXPECT_EQ(vdoms[i], vdoms[0]);
+    }
+}
@@ -46,6 +46,40 @@ end:
         pcvdom_document_unref(doc);
 }
 
+static int
+_append_to_string(const char *buf, size_t len, void *ctxt)
+{
+    std::string *str = (std::string *)ctxt;
+    str->append(buf, len);
+    return 0;
+}
+
+static void
+_check_binary_form(struct pcvdom_document *doc, const char *fn)
+{
+    purc_rwstream_t out = purc_rwstream_new_buffer(1024, 0);
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(pcvdom_document_to_binary(doc, out), 0) << fn;
+
+    size_t sz = 0;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(out, &sz);
+    struct pcvdom_document *loaded = pcvdom_document_from_binary(buf, sz);
+    ASSERT_NE(loaded, nullptr) << fn;
+
+    std::string orig, rebuilt;
+    pcvdom_util_node_serialize(pcvdom_node_from_document(doc),
+            _append_to_string, &orig);
+    pcvdom_util_node_serialize(pcvdom_node_from_document(loaded),
+            _append_to_string, &rebuilt);
+    EXPECT_EQ(orig, rebuilt) << fn;
+
+    /* a truncated binary form is rejected */
+    EXPECT_EQ(pcvdom_document_from_binary(buf, sz - 1), nullptr) << fn;
+
+    pcvdom_document_unref(loaded);
+    purc_rwstream_destroy(out);
+}
+
 static int
 _process_file(const char *fn)
 {
@@ -95,6 +129,7 @@ _process_file(const char *fn)
     }
     else {
         PRINT_VDOM_NODE(pcvdom_node_from_document(doc));
+        _check_binary_form(doc, fn);
     }
     int r = 0;
     if (doc && neg) {